@@ -0,0 +1,245 @@
+#include <benchmark/benchmark.h>
+
+#include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/LinearProgramming.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/SparseCooperativeQLearning.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/Utils/FactoredLP.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/UCVE.hpp>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "../MDP/Utils/RandomModels.hpp"
+#include "../../test/Factored/Utils/SysAdmin.hpp"
+
+// These benchmarks measure how the factored algorithms scale with the number
+// of agents and with the structure of the problem. MDP benchmarks run on the
+// SysAdmin problem, with the topology (0 = unidirectional ring, 1 =
+// bidirectional ring, 2 = star) as first argument and the number of agents as
+// second. Bandit benchmarks run on random coordination graphs, with the number
+// of agents, the number of actions per agent and the number of neighbors each
+// agent is connected to as arguments.
+//
+// All problems are generated from a fixed seed, so that results are
+// comparable across commits.
+
+enum Topology { UniRing = 0, BiRing, Star };
+
+afm::CooperativeModel makeSysAdmin(const benchmark::State & state) {
+    const unsigned agents = state.range(1);
+    switch (state.range(0)) {
+        case UniRing: return makeSysAdminUniRing(agents, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+        case BiRing:  return makeSysAdminBiRing (agents, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+        default:      return makeSysAdminStar   (agents, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    }
+}
+
+// The 9 indicator bases over the status and load of each agent.
+aif::FactoredVector makeSysAdminBases(const aif::State & S) {
+    aif::FactoredVector h;
+    for (size_t s = 0; s < S.size(); s += 2) {
+        for (size_t i = 0; i < 9; ++i) {
+            h.bases.emplace_back(aif::BasisFunction{{s, s+1}, ai::Vector(9)});
+            h.bases.back().values.setZero();
+            h.bases.back().values[i] = 1.0;
+        }
+    }
+    return h;
+}
+
+void setMDPCounters(benchmark::State & state, const afm::CooperativeModel & model) {
+    // The largest number of parents of any state factor, over all actions.
+    size_t parents = 0;
+    for (const auto & node : model.getTransitionFunction().nodes)
+        for (const auto & n : node.nodes)
+            parents = std::max(parents, n.tag.size());
+
+    state.counters["topology"] = state.range(0);
+    state.counters["agents"] = state.range(1);
+    state.counters["factors"] = model.getS().size();
+    state.counters["max_parents"] = parents;
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+// Each agent i is connected to agents i+1, ..., i+degree (modulo the number
+// of agents), and each pair has a random payoff for every joint action. The
+// induced width of such a graph grows with the degree.
+std::vector<aif::PartialKeys> makeCoordinationGraph(const benchmark::State & state) {
+    const size_t agents = state.range(0), degree = state.range(2);
+
+    std::vector<aif::PartialKeys> edges;
+    for (size_t i = 0; i < agents; ++i) {
+        for (size_t d = 1; d <= degree; ++d) {
+            const size_t j = (i + d) % agents;
+            if (i == j) continue;
+            edges.push_back({std::min(i, j), std::max(i, j)});
+        }
+    }
+    std::sort(std::begin(edges), std::end(edges));
+    edges.erase(std::unique(std::begin(edges), std::end(edges)), std::end(edges));
+    return edges;
+}
+
+void setBanditCounters(benchmark::State & state, const size_t rules) {
+    state.counters["agents"] = state.range(0);
+    state.counters["actions"] = state.range(1);
+    state.counters["degree"] = state.range(2);
+    state.counters["rules"] = rules;
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+// Time to solve the SysAdmin problem with the indicator bases.
+void BM_LinearProgrammingSolve(benchmark::State & state) {
+    const auto model = makeSysAdmin(state);
+    const auto h = makeSysAdminBases(model.getS());
+
+    afm::LinearProgramming solver;
+    for ( auto _ : state ) {
+        try {
+            benchmark::DoNotOptimize(solver(model, h));
+        } catch (const std::runtime_error & e) {
+            state.SkipWithError(e.what());
+            break;
+        }
+    }
+
+    setMDPCounters(state, model);
+}
+
+// Time to solve the factored LP which finds the closest approximation of the
+// sum of the SysAdmin rewards of each agent with the indicator bases.
+void BM_FactoredLPSolve(benchmark::State & state) {
+    const auto model = makeSysAdmin(state);
+    const auto C = makeSysAdminBases(model.getS());
+
+    aif::FactoredVector b;
+    std::mt19937 rand(0);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    for (const auto & basis : C.bases) {
+        b.bases.push_back(basis);
+        for (auto & v : b.bases.back().values) v = dist(rand);
+    }
+
+    for ( auto _ : state ) {
+        // Construct a new instance every time, so the LP is not reused.
+        afm::FactoredLP lp(model.getS());
+        benchmark::DoNotOptimize(lp(C, b, true));
+    }
+
+    setMDPCounters(state, model);
+}
+
+// Time for a single SparseCooperativeQLearning update, with one rule per
+// joint action of each agent and its neighbors, on sampled transitions.
+void BM_SparseCooperativeQLearningStep(benchmark::State & state) {
+    const auto model = makeSysAdmin(state);
+    const auto & S = model.getS();
+    const auto & A = model.getA();
+
+    afm::SparseCooperativeQLearning solver(S, A, model.getDiscount(), 0.1);
+    for (size_t a = 0; a < A.size(); ++a) {
+        const auto & node = model.getTransitionFunction()[a * 2];
+        // Rules over the status of the agent's neighbors and its action.
+        const auto & tag = node.nodes[0].tag;
+        aif::PartialFactorsEnumerator e(S, tag);
+        for (; e.isValid(); e.advance())
+            for (size_t aa = 0; aa < A[a]; ++aa)
+                solver.insertRule({*e, {{a}, {aa}}, 0.0});
+    }
+
+    std::mt19937 rand(0);
+    aif::State s(S.size(), 0);
+    aif::Action a(A.size());
+    for ( auto _ : state ) {
+        state.PauseTiming();
+        for (size_t i = 0; i < A.size(); ++i)
+            a[i] = std::uniform_int_distribution<size_t>(0, A[i] - 1)(rand);
+        const auto [next, r] = model.sampleSR(s, a);
+        aif::Rewards rew(A.size());
+        rew.fill(r / A.size());
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(solver.stepUpdateQ(s, a, next, rew));
+        s = next;
+    }
+
+    setMDPCounters(state, model);
+    state.counters["rules"] = solver.rulesSize();
+}
+
+// Time to sample a single transition and reward.
+void BM_CooperativeModelSampleSR(benchmark::State & state) {
+    const auto model = makeSysAdmin(state);
+    const auto & S = model.getS();
+    const auto & A = model.getA();
+
+    aif::State s(S.size(), 0), s1(S.size());
+    aif::Action a(A.size(), 0);
+    for ( auto _ : state ) {
+        benchmark::DoNotOptimize(model.sampleSR(s, a, &s1));
+        std::swap(s, s1);
+    }
+
+    setMDPCounters(state, model);
+}
+
+// Time to find the best joint action of a random coordination graph.
+void BM_VariableElimination(benchmark::State & state) {
+    const aif::Action A(state.range(0), state.range(1));
+
+    std::mt19937 rand(0);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    std::vector<aif::Bandit::QFunctionRule> rules;
+    for (const auto & edge : makeCoordinationGraph(state)) {
+        aif::PartialFactorsEnumerator e(A, edge);
+        for (; e.isValid(); e.advance())
+            rules.emplace_back(*e, dist(rand));
+    }
+
+    aif::Bandit::VariableElimination ve(A);
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(ve(rules));
+
+    setBanditCounters(state, rules.size());
+}
+
+// Time to find the joint action with the highest upper confidence bound in a
+// random coordination graph.
+void BM_UCVE(benchmark::State & state) {
+    const aif::Action A(state.range(0), state.range(1));
+
+    std::mt19937 rand(0);
+    std::uniform_real_distribution<double> vDist(0.0, 1.0), bDist(0.0001, 0.05);
+
+    aif::Bandit::UCVE::Entries entries;
+    for (const auto & edge : makeCoordinationGraph(state)) {
+        aif::PartialFactorsEnumerator e(A, edge);
+        for (; e.isValid(); e.advance())
+            entries.emplace_back(*e, aif::Bandit::UCVE::V{vDist(rand), bDist(rand)});
+    }
+
+    aif::Bandit::UCVE ucve(A, 10.0);
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(ucve(entries));
+
+    setBanditCounters(state, entries.size());
+}
+
+// The star's server depends on all agents, so it is kept smaller.
+#define SYSADMIN_SIZES ArgsProduct({{UniRing, BiRing}, {4, 8, 16, 32}})->ArgsProduct({{Star}, {4, 6, 8}})
+#define BANDIT_SIZES ArgsProduct({{8, 16, 32, 64}, {2, 4}, {1, 2, 3}})
+
+// The LPs grow quickly, so we only test small problems.
+BENCHMARK(BM_LinearProgrammingSolve)->ArgsProduct({{UniRing, BiRing}, {4, 8, 12}})->ArgsProduct({{Star}, {4, 6}});
+BENCHMARK(BM_FactoredLPSolve)->ArgsProduct({{UniRing, BiRing}, {4, 8, 12}})->ArgsProduct({{Star}, {4, 6}});
+BENCHMARK(BM_SparseCooperativeQLearningStep)->SYSADMIN_SIZES;
+BENCHMARK(BM_CooperativeModelSampleSR)->SYSADMIN_SIZES;
+BENCHMARK(BM_VariableElimination)->BANDIT_SIZES;
+// UCVE keeps many candidates per joint action, so it scales much worse with
+// the number of actions and the degree.
+BENCHMARK(BM_UCVE)->ArgsProduct({{8, 16, 32, 64}, {2}, {1, 2, 3}})->ArgsProduct({{8, 16, 32}, {4}, {1, 2}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,174 @@
+#include <benchmark/benchmark.h>
+
+#include <AIToolbox/MDP/Algorithms/QLearning.hpp>
+#include <AIToolbox/MDP/Algorithms/SARSAL.hpp>
+#include <AIToolbox/MDP/Algorithms/RetraceL.hpp>
+#include <AIToolbox/MDP/Algorithms/DynaQ.hpp>
+#include <AIToolbox/MDP/Algorithms/Dyna2.hpp>
+#include <AIToolbox/MDP/Algorithms/PrioritizedSweeping.hpp>
+#include <AIToolbox/MDP/Policies/RandomPolicy.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "Utils/RandomModels.hpp"
+
+// These benchmarks measure the rate at which the model-free and Dyna-style
+// learners consume experience. Each benchmark takes the number of states and
+// actions as its first two arguments; the ones using eligibility traces take
+// the expected length of the traces as third argument.
+//
+// All learners are fed the same fixed trajectory, sampled with random
+// actions from a sparse random model, and report the number of transitions
+// processed per second. The learners are not reset between iterations, so
+// traces are measured at their steady-state length.
+
+constexpr double Discount = 0.95;
+constexpr double Tolerance = 0.001;
+constexpr size_t TrajectoryLength = 10000;
+
+struct Step {
+    size_t s, a, s1, a1;
+    double rew;
+};
+
+std::vector<Step> makeTrajectory(const AIToolbox::MDP::SparseModel & model) {
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<size_t> action(0, model.getA() - 1);
+
+    std::vector<Step> trajectory(TrajectoryLength);
+    size_t s = 0, a = action(rand);
+    for ( auto & step : trajectory ) {
+        const auto [s1, rew] = model.sampleSR(s, a);
+        const auto a1 = action(rand);
+        step = Step{s, a, s1, a1, rew};
+        s = s1;
+        a = a1;
+    }
+    return trajectory;
+}
+
+// The lambda for which traces are cut by the tolerance after the input
+// number of steps.
+double getLambda(const size_t traceLength) {
+    return std::min(1.0, std::pow(Tolerance, 1.0 / traceLength) / Discount);
+}
+
+void setCounters(benchmark::State & state) {
+    state.counters["S"] = state.range(0);
+    state.counters["A"] = state.range(1);
+    state.counters["transitions_per_second"] = benchmark::Counter(
+            state.iterations() * TrajectoryLength, benchmark::Counter::kIsRate);
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+void setTraceCounters(benchmark::State & state) {
+    setCounters(state);
+    state.counters["trace_length"] = state.range(2);
+}
+
+void BM_QLearning(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::QLearning solver(model.getS(), model.getA(), Discount, 0.1);
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory )
+            solver.stepUpdateQ(t.s, t.a, t.s1, t.rew);
+        benchmark::DoNotOptimize(solver.getQFunction().data());
+    }
+
+    setCounters(state);
+}
+
+void BM_SARSAL(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::SARSAL solver(model.getS(), model.getA(), Discount, 0.1, getLambda(state.range(2)), Tolerance);
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory )
+            solver.stepUpdateQ(t.s, t.a, t.s1, t.a1, t.rew);
+        benchmark::DoNotOptimize(solver.getQFunction().data());
+    }
+
+    setTraceCounters(state);
+}
+
+void BM_RetraceL(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::RandomPolicy behaviour(model.getS(), model.getA());
+    AIToolbox::MDP::RetraceL solver(behaviour, Discount, 0.1, getLambda(state.range(2)), Tolerance);
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory )
+            solver.stepUpdateQ(t.s, t.a, t.s1, t.rew);
+        benchmark::DoNotOptimize(solver.getQFunction().data());
+    }
+
+    setTraceCounters(state);
+}
+
+// Each real transition is followed by the planning updates, with the
+// number of planning steps as third argument.
+void BM_DynaQ(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::DynaQ solver(model, 0.1, state.range(2));
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory ) {
+            solver.stepUpdateQ(t.s, t.a, t.s1, t.rew);
+            solver.batchUpdateQ();
+        }
+        benchmark::DoNotOptimize(solver.getQFunction().data());
+    }
+
+    setCounters(state);
+    state.counters["planning_steps"] = state.range(2);
+}
+
+void BM_Dyna2(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::Dyna2 solver(model, 0.1, getLambda(state.range(2)), Tolerance, 10);
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory ) {
+            solver.stepUpdateQ(t.s, t.a, t.s1, t.a1, t.rew);
+            solver.batchUpdateQ(t.s1);
+        }
+        benchmark::DoNotOptimize(solver.getPermanentQFunction().data());
+    }
+
+    setTraceCounters(state);
+}
+
+void BM_PrioritizedSweeping(benchmark::State & state) {
+    const auto model = makeRandomSparseModel(state.range(0), state.range(1));
+    const auto trajectory = makeTrajectory(model);
+
+    AIToolbox::MDP::PrioritizedSweeping solver(model, 0.0, 10);
+    for ( auto _ : state ) {
+        for ( const auto & t : trajectory ) {
+            solver.stepUpdateQ(t.s, t.a);
+            solver.batchUpdateQ();
+        }
+        benchmark::DoNotOptimize(solver.getQFunction().data());
+    }
+
+    setCounters(state);
+}
+
+#define SIZES ArgsProduct({{64, 1024, 16384}, {4, 16}})
+#define TRACE_SIZES ArgsProduct({{64, 1024, 16384}, {4, 16}, {4, 32, 128}})
+
+BENCHMARK(BM_QLearning)->SIZES;
+BENCHMARK(BM_SARSAL)->TRACE_SIZES;
+BENCHMARK(BM_RetraceL)->TRACE_SIZES;
+BENCHMARK(BM_DynaQ)->ArgsProduct({{64, 1024, 16384}, {4, 16}, {10}});
+BENCHMARK(BM_Dyna2)->TRACE_SIZES;
+BENCHMARK(BM_PrioritizedSweeping)->SIZES;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/MDP/Algorithms/PolicyIteration.hpp>
+#include <AIToolbox/MDP/Algorithms/PrioritizedSweeping.hpp>
+#include <AIToolbox/MDP/Algorithms/LinearProgramming.hpp>
+#include <AIToolbox/MDP/Algorithms/MCTS.hpp>
+
+#include "Utils/RandomModels.hpp"
+
+// All benchmarks take the number of states and actions as their first two
+// arguments. Each benchmark reports the peak memory of the process as a
+// counter; note that since the memory is never returned, this is a high
+// watermark over all benchmarks run so far in the same process. Use
+// --benchmark_filter to measure a single configuration.
+
+template <typename M>
+M makeModel(const benchmark::State & state) {
+    if constexpr (std::is_same_v<M, AIToolbox::MDP::Model>)
+        return makeRandomDenseModel(state.range(0), state.range(1));
+    else
+        return makeRandomSparseModel(state.range(0), state.range(1));
+}
+
+void setCounters(benchmark::State & state) {
+    state.counters["S"] = state.range(0);
+    state.counters["A"] = state.range(1);
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+// Time for a single Bellman sweep over the whole model.
+template <typename M>
+void BM_ValueIterationSweep(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    AIToolbox::MDP::ValueIteration solver(1, 0.0);
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(solver(model));
+
+    setCounters(state);
+}
+
+// Time to converge within tolerance.
+template <typename M>
+void BM_ValueIterationSolve(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    AIToolbox::MDP::ValueIteration solver(1000000, 0.001);
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(solver(model));
+
+    setCounters(state);
+}
+
+// Time to converge within tolerance, with the evaluation horizon as third
+// argument.
+template <typename M>
+void BM_PolicyIterationSolve(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    AIToolbox::MDP::PolicyIteration solver(state.range(2), 0.001);
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(solver(model));
+
+    setCounters(state);
+}
+
+// Time for a single batch update, after seeding the queue with all
+// state-action pairs.
+template <typename M, typename Queue = AIToolbox::IndexedDaryHeap<>>
+void BM_PrioritizedSweepingBatch(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    for ( auto _ : state ) {
+        state.PauseTiming();
+        AIToolbox::MDP::PrioritizedSweeping<M, Queue> solver(model, 0.0, 1000);
+        for ( size_t s = 0; s < model.getS(); ++s )
+            for ( size_t a = 0; a < model.getA(); ++a )
+                solver.stepUpdateQ(s, a);
+        state.ResumeTiming();
+
+        solver.batchUpdateQ();
+        benchmark::DoNotOptimize(solver.getQFunction());
+    }
+
+    setCounters(state);
+}
+
+// Time to solve the model exactly.
+template <typename M>
+void BM_LinearProgrammingSolve(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    AIToolbox::MDP::LinearProgramming solver;
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(solver(model));
+
+    setCounters(state);
+}
+
+// Time for a full MCTS search from scratch, with the horizon as third
+// argument. Also reports the rate at which tree nodes are created. With many
+// actions, most of the time is spent selecting actions with the bonus.
+template <typename M, typename Bonus = AIToolbox::UCB1>
+void BM_MCTSSearch(benchmark::State & state) {
+    const auto model = makeModel<M>(state);
+
+    AIToolbox::MDP::MCTS<M, Bonus> solver(model, 1000, 1.0);
+    size_t nodes = 0;
+    for ( auto _ : state ) {
+        benchmark::DoNotOptimize(solver.sampleAction(0, state.range(2)));
+        nodes += solver.getGraph().size();
+    }
+
+    setCounters(state);
+    state.counters["nodes_per_second"] = benchmark::Counter(nodes, benchmark::Counter::kIsRate);
+}
+
+using AIToolbox::MDP::Model;
+using AIToolbox::MDP::SparseModel;
+
+#define SIZES ArgsProduct({{64, 256, 1024}, {4, 16}})
+
+BENCHMARK_TEMPLATE(BM_ValueIterationSweep, Model)->SIZES;
+BENCHMARK_TEMPLATE(BM_ValueIterationSweep, SparseModel)->SIZES;
+BENCHMARK_TEMPLATE(BM_ValueIterationSolve, Model)->SIZES;
+BENCHMARK_TEMPLATE(BM_ValueIterationSolve, SparseModel)->SIZES;
+BENCHMARK_TEMPLATE(BM_PolicyIterationSolve, Model)->ArgsProduct({{64, 256}, {4, 16}, {5, 1000}});
+BENCHMARK_TEMPLATE(BM_PolicyIterationSolve, SparseModel)->ArgsProduct({{64, 256, 1024}, {4, 16}, {5, 1000}});
+BENCHMARK_TEMPLATE(BM_PrioritizedSweepingBatch, Model)->SIZES;
+BENCHMARK_TEMPLATE(BM_PrioritizedSweepingBatch, SparseModel)->SIZES;
+BENCHMARK_TEMPLATE(BM_PrioritizedSweepingBatch, SparseModel, AIToolbox::IndexedFibonacciHeap)->SIZES;
+// The LP grows quickly, so we only test small models.
+BENCHMARK_TEMPLATE(BM_MCTSSearch, Model)->ArgsProduct({{64, 1024}, {4}, {10}});
+BENCHMARK_TEMPLATE(BM_MCTSSearch, Model)->ArgsProduct({{64}, {200}, {10}});
+BENCHMARK_TEMPLATE(BM_MCTSSearch, Model, AIToolbox::PUCT)->ArgsProduct({{64}, {200}, {10}});
+BENCHMARK_TEMPLATE(BM_MCTSSearch, Model, AIToolbox::UCBTuned)->ArgsProduct({{64}, {200}, {10}});
+BENCHMARK_TEMPLATE(BM_MCTSSearch, SparseModel)->ArgsProduct({{64, 1024}, {4}, {10}});
+
+BENCHMARK_TEMPLATE(BM_LinearProgrammingSolve, Model)->ArgsProduct({{16, 64}, {4}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#ifndef AI_TOOLBOX_BENCHMARKS_RANDOM_MODELS_HEADER_FILE
+#define AI_TOOLBOX_BENCHMARKS_RANDOM_MODELS_HEADER_FILE
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include <random>
+#include <algorithm>
+#include <numeric>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// These functions build random models directly from Eigen matrices, so that
+// setup does not dominate the benchmarks for large state spaces. Models are
+// always generated from a fixed seed, so that results are comparable across
+// commits.
+
+inline AIToolbox::Matrix2D makeRandomRewards(const size_t S, const size_t A, std::mt19937 & rand) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    AIToolbox::Matrix2D rewards(S, A);
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+            rewards(s, a) = dist(rand);
+
+    return rewards;
+}
+
+inline AIToolbox::MDP::Model makeRandomDenseModel(const size_t S, const size_t A, const unsigned seed = 0) {
+    std::mt19937 rand(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    AIToolbox::MDP::Model::TransitionMatrix transitions(A, AIToolbox::Matrix2D(S, S));
+    for ( size_t a = 0; a < A; ++a ) {
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t s1 = 0; s1 < S; ++s1 )
+                transitions[a](s, s1) = dist(rand);
+            transitions[a].row(s) /= transitions[a].row(s).sum();
+        }
+    }
+
+    return AIToolbox::MDP::Model(AIToolbox::NO_CHECK, S, A, std::move(transitions), makeRandomRewards(S, A, rand), 0.95);
+}
+
+inline AIToolbox::MDP::SparseModel makeRandomSparseModel(const size_t S, const size_t A, const size_t branching = 8, const unsigned seed = 0) {
+    std::mt19937 rand(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    const size_t B = std::min(S, branching);
+
+    std::vector<size_t> states(S);
+    std::iota(std::begin(states), std::end(states), 0);
+
+    AIToolbox::MDP::SparseModel::TransitionMatrix transitions(A, AIToolbox::SparseMatrix2D(S, S));
+    for ( size_t a = 0; a < A; ++a ) {
+        transitions[a].reserve(Eigen::VectorXi::Constant(S, B));
+        for ( size_t s = 0; s < S; ++s ) {
+            // Partial shuffle to pick B distinct successors.
+            for ( size_t i = 0; i < B; ++i )
+                std::swap(states[i], states[std::uniform_int_distribution<size_t>(i, S - 1)(rand)]);
+
+            std::vector<double> probs(B);
+            for ( auto & p : probs ) p = dist(rand);
+            const double sum = std::accumulate(std::begin(probs), std::end(probs), 0.0);
+
+            for ( size_t i = 0; i < B; ++i )
+                transitions[a].insert(s, states[i]) = probs[i] / sum;
+        }
+        transitions[a].makeCompressed();
+    }
+
+    return AIToolbox::MDP::SparseModel(AIToolbox::NO_CHECK, S, A, std::move(transitions), AIToolbox::SparseMatrix2D(makeRandomRewards(S, A, rand).sparseView()), 0.95);
+}
+
+// Returns the peak resident memory of the process in KB, or 0 if unknown.
+inline double getPeakMemoryKB() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024.0;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0.0;
+#endif
+}
+
+#endif
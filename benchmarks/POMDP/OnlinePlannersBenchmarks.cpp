@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <AIToolbox/MDP/Algorithms/MCTS.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/Algorithms/POMCP.hpp>
+#include <AIToolbox/POMDP/Algorithms/rPOMCP.hpp>
+
+#include "../MDP/Utils/RandomModels.hpp"
+
+// These benchmarks measure the throughput of the online planners on random
+// generative models. Each benchmark takes the number of states, actions and
+// observations (for POMDPs) as arguments, followed by the search horizon.
+//
+// Every iteration is a full search from the same root, with a fixed number
+// of simulations. The benchmarks report the simulations and the nodes
+// created per second, together with the average memory used by each node
+// of the search tree.
+
+constexpr unsigned Iterations = 1000;
+constexpr size_t BeliefSize = 1000;
+
+using PModel = AIToolbox::POMDP::Model<AIToolbox::MDP::Model>;
+
+PModel makeRandomPOMDP(const size_t S, const size_t A, const size_t O) {
+    std::mt19937 rand(0);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    PModel::ObservationMatrix observations(A, AIToolbox::Matrix2D(S, O));
+    for ( size_t a = 0; a < A; ++a ) {
+        for ( size_t s1 = 0; s1 < S; ++s1 ) {
+            for ( size_t o = 0; o < O; ++o )
+                observations[a](s1, o) = dist(rand);
+            observations[a].row(s1) /= observations[a].row(s1).sum();
+        }
+    }
+
+    PModel model(AIToolbox::NO_CHECK, O, std::move(observations), makeRandomDenseModel(S, A));
+    model.setAliasSampling(true);
+    model.setObservationAliasSampling(true);
+    return model;
+}
+
+void setCounters(benchmark::State & state, const size_t simulations, const size_t nodes) {
+    state.counters["S"] = state.range(0);
+    state.counters["A"] = state.range(1);
+    state.counters["simulations_per_second"] = benchmark::Counter(simulations, benchmark::Counter::kIsRate);
+    state.counters["nodes_per_second"] = benchmark::Counter(nodes, benchmark::Counter::kIsRate);
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+void setTreeCounters(benchmark::State & state, const AIToolbox::SearchStatistics & stats, const size_t simulations, const size_t nodes) {
+    setCounters(state, simulations, nodes);
+    if (stats.nodes)
+        state.counters["bytes_per_node"] = static_cast<double>(stats.memoryUsage) / stats.nodes;
+}
+
+void BM_MCTS(benchmark::State & state) {
+    auto model = makeRandomDenseModel(state.range(0), state.range(1));
+    model.setAliasSampling(true);
+
+    AIToolbox::MDP::MCTS<AIToolbox::MDP::Model> solver(model, Iterations, 1.0);
+    size_t simulations = 0, nodes = 0;
+    for ( auto _ : state ) {
+        benchmark::DoNotOptimize(solver.sampleAction(0, state.range(2)));
+        simulations += solver.getSearchStatistics().rollouts;
+        nodes += solver.getSearchStatistics().nodesAdded;
+    }
+
+    setTreeCounters(state, solver.getSearchStatistics(), simulations, nodes);
+}
+
+void BM_POMCP(benchmark::State & state) {
+    const auto model = makeRandomPOMDP(state.range(0), state.range(1), state.range(2));
+    const AIToolbox::POMDP::Belief belief = AIToolbox::Vector::Constant(model.getS(), 1.0 / model.getS());
+
+    AIToolbox::POMDP::POMCP<PModel> solver(model, BeliefSize, Iterations, 1.0);
+    size_t simulations = 0, nodes = 0;
+    for ( auto _ : state ) {
+        benchmark::DoNotOptimize(solver.sampleAction(belief, state.range(3)));
+        simulations += solver.getSearchStatistics().rollouts;
+        nodes += solver.getSearchStatistics().nodesAdded;
+    }
+
+    setTreeCounters(state, solver.getSearchStatistics(), simulations, nodes);
+    state.counters["O"] = state.range(2);
+}
+
+// rPOMCP does not keep search statistics, and its graph is not stored in a
+// SearchTree, so we count its belief nodes by walking it, and do not report
+// the memory per node.
+size_t countBeliefNodes(const AIToolbox::POMDP::BeliefNode<false> & node) {
+    size_t retval = 1;
+    for ( const auto & aNode : node.children )
+        for ( const auto & [o, child] : aNode.children )
+            retval += countBeliefNodes(child);
+    return retval;
+}
+
+void BM_rPOMCP(benchmark::State & state) {
+    const auto model = makeRandomPOMDP(state.range(0), state.range(1), state.range(2));
+    const AIToolbox::POMDP::Belief belief = AIToolbox::Vector::Constant(model.getS(), 1.0 / model.getS());
+
+    AIToolbox::POMDP::rPOMCP<PModel, false> solver(model, BeliefSize, Iterations, 1.0);
+    size_t simulations = 0, nodes = 0;
+    for ( auto _ : state ) {
+        benchmark::DoNotOptimize(solver.sampleAction(belief, state.range(3)));
+        simulations += Iterations;
+        nodes += countBeliefNodes(solver.getGraph());
+    }
+
+    setCounters(state, simulations, nodes);
+    state.counters["O"] = state.range(2);
+}
+
+BENCHMARK(BM_MCTS)->ArgsProduct({{64, 1024}, {4, 16}, {10, 50}});
+BENCHMARK(BM_POMCP)->ArgsProduct({{64, 1024}, {4, 16}, {4, 16}, {10, 50}});
+BENCHMARK(BM_rPOMCP)->ArgsProduct({{64, 1024}, {4, 16}, {4, 16}, {10}});
+
+BENCHMARK_MAIN();
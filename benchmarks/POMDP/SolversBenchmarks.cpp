@@ -0,0 +1,195 @@
+#include <benchmark/benchmark.h>
+
+#include <AIToolbox/POMDP/IO.hpp>
+#include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
+#include <AIToolbox/POMDP/Algorithms/Witness.hpp>
+#include <AIToolbox/POMDP/Algorithms/LinearSupport.hpp>
+#include <AIToolbox/POMDP/Algorithms/PBVI.hpp>
+#include <AIToolbox/POMDP/Algorithms/PERSEUS.hpp>
+#include <AIToolbox/POMDP/Algorithms/GapMin.hpp>
+#include <AIToolbox/POMDP/Algorithms/FastInformedBound.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../MDP/Utils/RandomModels.hpp"
+
+// These benchmarks run the POMDP solvers on a corpus of Cassandra models.
+// The corpus always contains the models in test/data; more can be added by
+// setting the AI_BENCHMARK_POMDPS environment variable to a ':' separated
+// list of paths, for example to the larger standard models from Cassandra's
+// website (tiger-grid, hallway, ...):
+//
+//     AI_BENCHMARK_POMDPS=hallway.POMDP:4x4.95.POMDP ./POMDP_SolversBenchmarks
+//
+// Benchmarks are named Solver/model/horizon. Exact and point-based solvers
+// are run for each horizon in a range, so that the time of each horizon step
+// is the difference between consecutive results.
+//
+// Since the point-based and bound solvers need a discount lower than 1 to
+// converge, models which are undiscounted are solved with a discount of 0.95.
+//
+// All benchmarks report the peak memory of the process as a counter; note
+// that since the memory is never returned, this is a high watermark over all
+// benchmarks run so far in the same process. Use --benchmark_filter to
+// measure a single configuration.
+
+using PModel = AIToolbox::POMDP::Model<AIToolbox::MDP::Model>;
+
+void setCounters(benchmark::State & state, const PModel & model) {
+    state.counters["S"] = model.getS();
+    state.counters["A"] = model.getA();
+    state.counters["O"] = model.getO();
+    state.counters["peak_memory_kb"] = getPeakMemoryKB();
+}
+
+// Counters for solvers which return a ValueFunction, one VList per horizon.
+void setValueFunctionCounters(benchmark::State & state, const PModel & model, const AIToolbox::POMDP::ValueFunction & vf) {
+    setCounters(state, model);
+    const auto steps = vf.size() - 1;
+
+    state.counters["horizon"] = steps;
+    state.counters["seconds_per_step"] = benchmark::Counter(steps, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    state.counters["vlist_size"] = vf.back().size();
+}
+
+// Time to solve exactly for a given horizon.
+template <typename Solver>
+void BM_ExactSolve(benchmark::State & state, const PModel & model) {
+    Solver solver(state.range(0), 0.0);
+
+    AIToolbox::POMDP::ValueFunction vf;
+    for ( auto _ : state ) {
+        vf = std::get<1>(solver(model));
+        benchmark::DoNotOptimize(vf);
+    }
+
+    setValueFunctionCounters(state, model, vf);
+    // The number of VEntries which the exhaustive cross-sum generates for
+    // the last step, before any pruning.
+    const auto steps = vf.size() - 1;
+    state.counters["unpruned_size"] = model.getA() * std::pow(static_cast<double>(vf[steps - 1].size()), model.getO());
+}
+
+// Time to solve with a fixed set of beliefs for a given horizon.
+void BM_PBVISolve(benchmark::State & state, const PModel & model) {
+    AIToolbox::POMDP::PBVI solver(100, state.range(0), 0.0);
+
+    AIToolbox::POMDP::ValueFunction vf;
+    for ( auto _ : state ) {
+        vf = std::get<1>(solver(model));
+        benchmark::DoNotOptimize(vf);
+    }
+
+    setValueFunctionCounters(state, model, vf);
+}
+
+void BM_PERSEUSSolve(benchmark::State & state, const PModel & model) {
+    AIToolbox::POMDP::PERSEUS solver(100, state.range(0), 0.0);
+    const double minReward = model.getRewardFunction().minCoeff();
+
+    AIToolbox::POMDP::ValueFunction vf;
+    for ( auto _ : state ) {
+        vf = std::get<1>(solver(model, minReward));
+        benchmark::DoNotOptimize(vf);
+    }
+
+    setValueFunctionCounters(state, model, vf);
+}
+
+// Time to bound the value of the uniform belief within tolerance.
+void BM_GapMinSolve(benchmark::State & state, const PModel & model) {
+    AIToolbox::POMDP::GapMin solver(0.005, 3);
+
+    AIToolbox::POMDP::Belief belief(model.getS());
+    belief.fill(1.0 / model.getS());
+
+    double lb = 0.0, ub = 0.0;
+    size_t vlistSize = 0;
+    for ( auto _ : state ) {
+        auto [l, u, vlist, qfun] = solver(model, belief);
+        benchmark::DoNotOptimize(qfun);
+        lb = l, ub = u, vlistSize = vlist.size();
+    }
+
+    setCounters(state, model);
+    state.counters["gap"] = ub - lb;
+    state.counters["vlist_size"] = vlistSize;
+}
+
+// Time to compute the bound for a given horizon.
+void BM_FastInformedBoundSolve(benchmark::State & state, const PModel & model) {
+    AIToolbox::POMDP::FastInformedBound solver(state.range(0), 0.0);
+
+    for ( auto _ : state )
+        benchmark::DoNotOptimize(solver(model));
+
+    setCounters(state, model);
+    state.counters["horizon"] = state.range(0);
+    state.counters["seconds_per_step"] = benchmark::Counter(state.range(0), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+PModel loadModel(const std::string & filename) {
+    std::ifstream file(filename);
+    if ( !file ) throw std::runtime_error("Could not open " + filename);
+
+    auto model = AIToolbox::POMDP::parseCassandra(file);
+    if ( model.getDiscount() >= 1.0 ) model.setDiscount(0.95);
+    return model;
+}
+
+std::string modelName(const std::string & filename) {
+    const auto begin = filename.find_last_of('/') + 1;
+    return filename.substr(begin, filename.find_last_of('.') - begin);
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> filenames = {
+        AI_BENCHMARK_DATA_DIR "/cheng.D3-5.POMDP",
+        AI_BENCHMARK_DATA_DIR "/ejs4.POMDP",
+    };
+    if ( const char * extra = std::getenv("AI_BENCHMARK_POMDPS") ) {
+        std::istringstream paths(extra);
+        for (std::string path; std::getline(paths, path, ':'); )
+            if ( !path.empty() ) filenames.push_back(path);
+    }
+
+    // The models must outlive the benchmarks, which keep them by reference.
+    std::vector<PModel> models;
+    models.reserve(filenames.size());
+    for ( const auto & filename : filenames ) {
+        try {
+            models.emplace_back(loadModel(filename));
+        } catch ( const std::exception & e ) {
+            std::cerr << "Skipping " << filename << ": " << e.what() << '\n';
+            continue;
+        }
+        const auto & model = models.back();
+        const auto name = modelName(filename);
+
+        const auto reg = [&](const std::string & solver, auto bm) {
+            return benchmark::RegisterBenchmark((solver + "/" + name).c_str(), bm, std::cref(model));
+        };
+
+        // The number of VEntries of the exact solvers grows quickly with the
+        // horizon, so we only test short ones.
+        reg("IncrementalPruning", BM_ExactSolve<AIToolbox::POMDP::IncrementalPruning>)->DenseRange(1, 6);
+        reg("Witness",            BM_ExactSolve<AIToolbox::POMDP::Witness>)->DenseRange(1, 6);
+        reg("LinearSupport",      BM_ExactSolve<AIToolbox::POMDP::LinearSupport>)->DenseRange(1, 6);
+        reg("PBVI",               BM_PBVISolve)->RangeMultiplier(2)->Range(1, 64);
+        reg("PERSEUS",            BM_PERSEUSSolve)->RangeMultiplier(2)->Range(1, 64);
+        reg("GapMin",             BM_GapMinSolve)->Unit(benchmark::kMillisecond);
+        reg("FastInformedBound",  BM_FastInformedBoundSolve)->RangeMultiplier(2)->Range(1, 64);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if ( benchmark::ReportUnrecognizedArguments(argc, argv) ) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
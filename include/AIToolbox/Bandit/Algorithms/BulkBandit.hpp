@@ -0,0 +1,171 @@
+#ifndef AI_TOOLBOX_BANDIT_BULK_BANDIT_HEADER_FILE
+#define AI_TOOLBOX_BANDIT_BULK_BANDIT_HEADER_FILE
+
+#include <cstdint>
+#include <vector>
+
+#include <AIToolbox/Bandit/Types.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+namespace AIToolbox::Bandit {
+    /**
+     * @brief This class stores and updates many independent small bandits.
+     *
+     * Using one RollingAverage and one policy per bandit, when there are
+     * millions of them (for example one per user), spreads their data
+     * over millions of small allocations. This class instead keeps the
+     * averages of all bandits in a single matrix, one row per bandit, and
+     * their counts in a single array with the same layout.
+     *
+     * Updates and action selections are done in batches, where each
+     * element refers to a bandit. If a ThreadPool is passed, batches are
+     * split between its threads. Updates are grouped by bandit, so that
+     * each bandit is updated by a single thread, in the order of the
+     * batch; the results are thus the same as applying the updates one
+     * by one.
+     *
+     * Action selections use the same rules as QGreedyPolicy,
+     * QSoftmaxPolicy and ThompsonSamplingPolicy. Each block of BlockSize
+     * elements of a batch uses its own random engine (see
+     * makeEngineStream()), identified by the number of batches sampled
+     * before and by the block; the selected actions thus only depend on
+     * the seed and on the calls made, and not on the number of threads.
+     */
+    class BulkBandit {
+        public:
+            /// The number of batch elements processed together by a thread.
+            static constexpr size_t BlockSize = 1024;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param N The number of bandits.
+             * @param A The size of the action space of each bandit.
+             */
+            BulkBandit(size_t N, size_t A);
+
+            /**
+             * @brief This function updates the average and count of a single bandit.
+             *
+             * @param i The bandit to update.
+             * @param a The action taken.
+             * @param rew The reward obtained.
+             */
+            void stepUpdateQ(size_t i, size_t a, double rew);
+
+            /**
+             * @brief This function updates the averages and counts of a batch of bandits.
+             *
+             * A bandit may appear multiple times in the batch; its updates
+             * are applied in order.
+             *
+             * This function throws std::invalid_argument if the inputs
+             * have different sizes.
+             *
+             * @param bandits The bandit updated by each element.
+             * @param actions The action taken by each element.
+             * @param rewards The reward obtained by each element.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void stepUpdateQ(const std::vector<size_t> & bandits, const std::vector<size_t> & actions, const std::vector<double> & rewards, ThreadPool * pool = nullptr);
+
+            /**
+             * @brief This function selects greedy actions for a batch of bandits.
+             *
+             * Ties are broken randomly, as in QGreedyPolicy.
+             *
+             * @param bandits The bandits to select an action for.
+             * @param actions The output selected actions, one per bandit.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void sampleGreedyActions(const std::vector<size_t> & bandits, std::vector<size_t> * actions, ThreadPool * pool = nullptr);
+
+            /**
+             * @brief This function selects softmax actions for a batch of bandits.
+             *
+             * Actions are selected as in QSoftmaxPolicy. This function
+             * throws std::invalid_argument if the temperature is negative.
+             *
+             * @param bandits The bandits to select an action for.
+             * @param temperature The temperature of the softmax.
+             * @param actions The output selected actions, one per bandit.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void sampleSoftmaxActions(const std::vector<size_t> & bandits, double temperature, std::vector<size_t> * actions, ThreadPool * pool = nullptr);
+
+            /**
+             * @brief This function selects Thompson sampling actions for a batch of bandits.
+             *
+             * Actions are selected as in ThompsonSamplingPolicy, so the
+             * rewards are assumed to be in [0,1].
+             *
+             * @param bandits The bandits to select an action for.
+             * @param actions The output selected actions, one per bandit.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void sampleThompsonActions(const std::vector<size_t> & bandits, std::vector<size_t> * actions, ThreadPool * pool = nullptr);
+
+            /**
+             * @brief This function resets the averages and counts of a single bandit to zero.
+             *
+             * @param i The bandit to reset.
+             */
+            void reset(size_t i);
+
+            /**
+             * @brief This function resets the averages and counts of all bandits to zero.
+             */
+            void reset();
+
+            /**
+             * @brief This function returns the number of bandits.
+             *
+             * @return The number of bandits.
+             */
+            size_t getN() const;
+
+            /**
+             * @brief This function returns the size of the action space of each bandit.
+             *
+             * @return The size of the action space.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the averages of all bandits, one per row.
+             *
+             * @return The averages of the bandits.
+             */
+            const Matrix2D & getQFunctions() const;
+
+            /**
+             * @brief This function returns the counts of all bandits.
+             *
+             * The count of action a of bandit i is at index i * A + a.
+             *
+             * @return The counts of the bandits.
+             */
+            const std::vector<unsigned> & getCounts() const;
+
+        private:
+            /**
+             * @brief This function runs a selection function over blocks of a batch.
+             *
+             * @param size The size of the batch.
+             * @param pool The ThreadPool to use, or nullptr.
+             * @param f A function taking a block's engine, begin and end.
+             */
+            template <typename F>
+            void forEachBlock(size_t size, ThreadPool * pool, F && f);
+
+            size_t N, A;
+            Matrix2D q_;
+            std::vector<unsigned> counts_;
+
+            unsigned seed_;
+            // The number of batches sampled, to give each its own engines.
+            std::uint64_t batches_;
+    };
+}
+
+#endif
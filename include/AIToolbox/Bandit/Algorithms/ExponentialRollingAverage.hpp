@@ -0,0 +1,108 @@
+#ifndef AI_TOOLBOX_BANDIT_EXPONENTIAL_ROLLING_AVERAGE_HEADER_FILE
+#define AI_TOOLBOX_BANDIT_EXPONENTIAL_ROLLING_AVERAGE_HEADER_FILE
+
+#include <AIToolbox/Bandit/Types.hpp>
+
+namespace AIToolbox::Bandit {
+    /**
+     * @brief This class computes exponentially weighted averages for a Bandit problem.
+     *
+     * This class is a variant of RollingAverage for non-stationary
+     * problems: each time an action is updated, all its past rewards are
+     * discounted by a decay factor, so that recent rewards weight more in
+     * the average.
+     *
+     * The average is bias-corrected, i.e. the weights are normalized by
+     * their sum, so that early estimates are not biased towards zero. With
+     * a decay of 1.0 this class computes the same averages as
+     * RollingAverage.
+     *
+     * The counts returned are the effective number of samples of each
+     * action (the sum of their weights), truncated to an integer. These
+     * are bounded by 1 / (1 - decay), so that policies which use them as
+     * confidence (like ThompsonSamplingPolicy) never become overconfident
+     * in an old estimate.
+     *
+     * The QFunction and counts have the same layout as the ones in
+     * RollingAverage, so this class can be used with the same policies.
+     */
+    class ExponentialRollingAverage {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The decay must be in (0.0, 1.0], otherwise the constructor
+             * will throw an std::invalid_argument.
+             *
+             * @param A The size of the action space.
+             * @param decay The factor past rewards are multiplied by at each update.
+             */
+            ExponentialRollingAverage(size_t A, double decay);
+
+            /**
+             * @brief This function updates the QFunction and counts.
+             *
+             * @param a The action taken.
+             * @param rew The reward obtained.
+             */
+            void stepUpdateQ(size_t a, double rew);
+
+            /**
+             * @brief This function resets the QFunction and counts to zero.
+             */
+            void reset();
+
+            /**
+             * @brief This function sets the decay factor.
+             *
+             * The decay must be in (0.0, 1.0], otherwise the function will
+             * throw an std::invalid_argument.
+             *
+             * @param decay The new decay factor.
+             */
+            void setDecay(double decay);
+
+            /**
+             * @brief This function returns the current decay factor.
+             *
+             * @return The current decay factor.
+             */
+            double getDecay() const;
+
+            /**
+             * @brief This function returns the size of the action space.
+             *
+             * @return The size of the action space.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns a reference to the internal QFunction.
+             *
+             * @return A reference to the internal QFunction.
+             */
+            const QFunction & getQFunction() const;
+
+            /**
+             * @brief This function returns a reference for the effective counts for the actions.
+             *
+             * @return A reference to the effective counts of the actions.
+             */
+            const std::vector<unsigned> & getCounts() const;
+
+            /**
+             * @brief This function returns the exact effective number of samples of each action.
+             *
+             * @return A reference to the sum of the weights of each action.
+             */
+            const Vector & getWeights() const;
+
+        private:
+            double decay_;
+            QFunction q_;
+            Vector weights_;
+            std::vector<unsigned> counts_;
+    };
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef AI_TOOLBOX_BANDIT_WINDOWED_ROLLING_AVERAGE_HEADER_FILE
+#define AI_TOOLBOX_BANDIT_WINDOWED_ROLLING_AVERAGE_HEADER_FILE
+
+#include <AIToolbox/Bandit/Types.hpp>
+
+namespace AIToolbox::Bandit {
+    /**
+     * @brief This class computes sliding window averages for a Bandit problem.
+     *
+     * This class is a variant of RollingAverage for non-stationary
+     * problems: the average of each action is computed only over its last
+     * `window` rewards, so that old rewards are completely forgotten.
+     *
+     * The rewards of each action are kept in a ring buffer, together with
+     * their sum, so that each update is O(1). Every time a buffer wraps
+     * around its sum is recomputed from scratch, so that floating point
+     * errors from the subtractions do not accumulate.
+     *
+     * The counts returned are the number of rewards currently in the
+     * window of each action, which are at most `window`. The QFunction and
+     * counts have the same layout as the ones in RollingAverage, so this
+     * class can be used with the same policies.
+     */
+    class WindowedRollingAverage {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The window must be > 0, otherwise the constructor will throw
+             * an std::invalid_argument.
+             *
+             * @param A The size of the action space.
+             * @param window The maximum number of rewards to average for each action.
+             */
+            WindowedRollingAverage(size_t A, unsigned window);
+
+            /**
+             * @brief This function updates the QFunction and counts.
+             *
+             * If the window of the action is full, its oldest reward is
+             * dropped.
+             *
+             * @param a The action taken.
+             * @param rew The reward obtained.
+             */
+            void stepUpdateQ(size_t a, double rew);
+
+            /**
+             * @brief This function resets the QFunction and counts to zero.
+             */
+            void reset();
+
+            /**
+             * @brief This function returns the size of the window.
+             *
+             * @return The maximum number of rewards averaged for each action.
+             */
+            unsigned getWindow() const;
+
+            /**
+             * @brief This function returns the size of the action space.
+             *
+             * @return The size of the action space.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns a reference to the internal QFunction.
+             *
+             * @return A reference to the internal QFunction.
+             */
+            const QFunction & getQFunction() const;
+
+            /**
+             * @brief This function returns a reference for the counts for the actions.
+             *
+             * @return A reference to the number of rewards in the window of each action.
+             */
+            const std::vector<unsigned> & getCounts() const;
+
+        private:
+            unsigned window_;
+            QFunction q_;
+            Vector sums_;
+            std::vector<unsigned> counts_;
+
+            // Row a contains the ring buffer of action a, and heads_[a]
+            // the position where its next reward will be written.
+            Matrix2D rewards_;
+            std::vector<unsigned> heads_;
+    };
+}
+
+#endif
@@ -164,6 +164,11 @@ namespace AIToolbox::Bandit {
             virtual Vector getPolicy() const override;
 
         private:
+            /**
+             * @brief This function resets the allowed actions to all actions.
+             */
+            void allowAll();
+
             // Whether we have learned enough to start exploiting.
             bool exploit_;
             size_t bestAction_;
@@ -175,8 +180,9 @@ namespace AIToolbox::Bandit {
 
             // Values obtained for all actions.
             Vector values_;
-            // Allowed actions in the current exploration phase.
-            std::vector<size_t> allowedActions_;
+            // Allowed actions in the current exploration phase, and the
+            // position of each action in it (or A if it is not allowed).
+            std::vector<size_t> allowedActions_, positions_;
             // Exploration learning policy to learn Nash equilibria.
             LRPPolicy lri_;
     };
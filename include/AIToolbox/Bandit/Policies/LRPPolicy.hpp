@@ -28,6 +28,11 @@ namespace AIToolbox::Bandit {
      *     p(t + 1) = (1 - b) * p(t)                 // For the action taken
      *     p(t + 1) = b / (|A| - 1) + (1 - b) * p(t) // For all other actions
      *
+     * Both updates scale all probabilities by the same factor, and shift
+     * all of them but one by the same amount. Thus, we store the policy as
+     * p = scale * w + offset, which makes each update O(1) regardless of
+     * the number of actions. The weights are folded back into the
+     * probabilities only when the scale becomes too small.
      */
     class LRPPolicy : public PolicyInterface {
         public:
@@ -62,6 +67,8 @@ namespace AIToolbox::Bandit {
              * with a probability equal to the reward. The result is equivalent
              * to the original reward function.
              *
+             * This function runs in constant time.
+             *
              * @param a The action taken.
              * @param result Whether the action taken was a success, or not.
              */
@@ -125,8 +132,15 @@ namespace AIToolbox::Bandit {
             virtual Vector getPolicy() const override;
 
         private:
+            /**
+             * @brief This function folds the scale and offset into the weights.
+             */
+            void normalize();
+
             double a_, invB_, divB_;
-            Vector policy_;
+            // The policy is scale_ * weights_ + offset_.
+            Vector weights_;
+            double scale_, offset_;
     };
 }
 
@@ -2,6 +2,7 @@
 #define AI_TOOLBOX_BANDIT_THOMPSON_SAMPLING_POLICY_HEADER_FILE
 
 #include <random>
+#include <vector>
 
 #include <AIToolbox/Bandit/Types.hpp>
 #include <AIToolbox/Bandit/Policies/PolicyInterface.hpp>
@@ -35,20 +36,31 @@ namespace AIToolbox::Bandit {
             /**
              * @brief This function chooses an action using Thompson sampling.
              *
+             * The values of all arms are drawn from a single standard
+             * Normal distribution, which is then shifted and scaled for
+             * each arm in one vectorized pass.
+             *
              * @return The chosen action.
              */
             virtual size_t sampleAction() const override;
 
+            /**
+             * @brief This function chooses multiple independent actions using Thompson sampling.
+             *
+             * This is equivalent to calling sampleAction() n times, but
+             * the standard deviations of the arms are computed only once
+             * for the whole batch.
+             *
+             * @param n The number of actions to sample.
+             * @param actions The output sampled actions.
+             */
+            void sampleActions(size_t n, std::vector<size_t> * actions) const;
+
             /**
              * @brief This function returns the probability of taking the specified action.
              *
-             * WARNING: In this class the only way to compute the true
-             * probability of selecting the input action is via numerical
-             * integration, since we're dealing with |A| Normal random
-             * variables. To avoid having to do this, we simply sample a lot
-             * and return an approximation of the times the input action was
-             * actually selected. This makes this function very very SLOW. Do
-             * not call at will!!
+             * This function simply returns the appropriate entry of
+             * getPolicy(), so the same considerations apply.
              *
              * @param a The selected action.
              *
@@ -59,20 +71,54 @@ namespace AIToolbox::Bandit {
             /**
              * @brief This function returns a vector containing all probabilities of the policy.
              *
-             * Ideally this function can be called only when there is a
-             * repeated need to access the same policy values in an
-             * efficient manner.
+             * The probability of choosing an arm is the probability that
+             * its sampled value is the highest, i.e.:
+             *
+             * \f[
+             *      P(a) = \int_{-\infty}^{+\infty} \phi_a(x) \prod_{b \neq a} \Phi_b(x) dx
+             * \f]
+             *
+             * where \f$\phi\f$ and \f$\Phi\f$ are the PDF and CDF of the Normal
+             * distribution of each arm. We compute this integral
+             * numerically on a grid, which is fine enough to resolve the
+             * narrowest distribution involved.
+             *
+             * To keep this fast with many arms, we first discard all arms
+             * whose value is almost surely (6 standard deviations) below
+             * the value of some other arm, as they have probability
+             * practically zero of being selected. The CDF products are then
+             * computed once per grid point in log-space, so the cost is
+             * linear in the number of remaining arms.
              *
-             * WARNING: This can be really expensive, as it does pretty much
-             * the same work as getActionProbability(). It shouldn't be slower
-             * than that call though, so if you do need the overall policy,
-             * do call this method.
+             * The result is cached, together with the QFunction and counts
+             * it was computed from. Calling this function again without
+             * changes to them only costs a comparison.
              */
             virtual Vector getPolicy() const override;
 
         private:
+            /**
+             * @brief This function computes the standard deviations of all arms into the internal buffer.
+             */
+            void computeStdDevs() const;
+
+            /**
+             * @brief This function samples an action, assuming the standard deviations are up to date.
+             */
+            size_t sampleWithStdDevs() const;
+
             const QFunction & q_;
             const std::vector<unsigned> & counts_;
+
+            // Persistent state for sampling, to avoid reallocations.
+            mutable std::normal_distribution<double> normal_;
+            mutable Vector stdDevs_, values_;
+
+            // The last computed policy, and what it was computed from.
+            mutable bool cached_;
+            mutable QFunction cachedQ_;
+            mutable std::vector<unsigned> cachedCounts_;
+            mutable Vector cachedPolicy_;
     };
 }
 
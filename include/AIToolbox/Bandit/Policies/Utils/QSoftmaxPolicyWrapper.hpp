@@ -1,7 +1,9 @@
 #ifndef AI_TOOLBOX_BANDIT_Q_SOFTMAX_POLICY_WRAPPER_HEADER_FILE
 #define AI_TOOLBOX_BANDIT_Q_SOFTMAX_POLICY_WRAPPER_HEADER_FILE
 
+#include <AIToolbox/Kernels.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/TypeTraits.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Bandit/Policies/Utils/QGreedyPolicyWrapper.hpp>
 
@@ -46,6 +48,10 @@ namespace AIToolbox::Bandit {
              * where t is the temperature. This value is not cached anywhere, so
              * continuous sampling may not be extremely fast.
              *
+             * The exponentials are computed in a single vectorized pass, and
+             * the values are never normalized: we scale the sampled
+             * probability by their sum instead.
+             *
              * @return The chosen action.
              */
             size_t sampleAction();
@@ -72,6 +78,11 @@ namespace AIToolbox::Bandit {
             void getPolicy(P && p) const;
 
         private:
+            /**
+             * @brief This function writes the exponentials of the scaled QFunction in the value buffer, and returns their sum.
+             */
+            double computeExponentials() const;
+
             double temperature_;
             V q_;
             Vector & valueBuffer_;
@@ -101,23 +112,40 @@ namespace AIToolbox::Bandit {
             return wrap.sampleAction();
         }
 
-        valueBuffer_ = (q_ / temperature_).array().exp();
-
-        unsigned infinities = 0;
-        for ( size_t a = 0; a < buffer_.size(); ++a )
-            if ( std::isinf(valueBuffer_(a)) )
-                buffer_[infinities++] = a;
+        // A single reduction tells us whether any value overflowed, so we
+        // only look for infinities when we need to.
+        const double sum = computeExponentials();
+        if ( std::isinf(sum) ) {
+            unsigned infinities = 0;
+            for ( size_t a = 0; a < buffer_.size(); ++a )
+                if ( std::isinf(valueBuffer_(a)) )
+                    buffer_[infinities++] = a;
+
+            // The sum can overflow even if all values are finite.
+            if ( !infinities ) {
+                valueBuffer_ /= valueBuffer_.maxCoeff();
+                valueBuffer_ /= valueBuffer_.sum();
+                return sampleProbability(buffer_.size(), valueBuffer_, rand_);
+            }
 
-        if (infinities) {
             auto pickDistribution = std::uniform_int_distribution<unsigned>(0, infinities-1);
             unsigned selection = pickDistribution(rand_);
 
             return buffer_[selection];
-        } else {
-            valueBuffer_ /= valueBuffer_.sum();
+        }
+        if ( checkEqualSmall(sum, 0.0) ) {
+            auto pickDistribution = std::uniform_int_distribution<size_t>(0, buffer_.size()-1);
+            return pickDistribution(rand_);
+        }
 
-            return sampleProbability(buffer_.size(), valueBuffer_, rand_);
+        // We scale the sampled probability rather than normalizing the
+        // values, which avoids a pass over them.
+        double p = probabilityDistribution(rand_) * sum;
+        for ( size_t a = 0; a < buffer_.size(); ++a ) {
+            if ( valueBuffer_(a) > p ) return a;
+            p -= valueBuffer_(a);
         }
+        return buffer_.size() - 1;
     }
 
     template <typename V, typename Gen>
@@ -127,21 +155,42 @@ namespace AIToolbox::Bandit {
             return wrap.getActionProbability(a);
         }
 
-        valueBuffer_ = (q_ / temperature_).array().exp();
-
-        bool isAInfinite = false;
-        unsigned infinities = 0;
-        for ( size_t aa = 0; aa < buffer_.size(); ++aa ) {
-            if ( std::isinf(valueBuffer_(aa)) ) {
-                infinities++;
-                isAInfinite |= (aa == a);
+        const double sum = computeExponentials();
+        if ( std::isinf(sum) ) {
+            bool isAInfinite = false;
+            unsigned infinities = 0;
+            for ( size_t aa = 0; aa < buffer_.size(); ++aa ) {
+                if ( std::isinf(valueBuffer_(aa)) ) {
+                    infinities++;
+                    isAInfinite |= (aa == a);
+                }
+            }
+            if ( infinities ) {
+                if ( isAInfinite ) return 1.0 / infinities;
+                return 0.0;
             }
+            const double max = valueBuffer_.maxCoeff();
+            return (valueBuffer_(a) / max) / (valueBuffer_ / max).sum();
         }
-        if ( infinities ) {
-            if ( isAInfinite ) return 1.0 / infinities;
-            return 0.0;
+        if ( checkEqualSmall(sum, 0.0) )
+            return 1.0 / buffer_.size();
+
+        return valueBuffer_(a) / sum;
+    }
+
+    template <typename V, typename Gen>
+    double QSoftmaxPolicyWrapper<V, Gen>::computeExponentials() const {
+        // Contiguous QFunctions with many actions use the vectorized kernels.
+        using VT = remove_cv_ref_t<V>;
+        if constexpr(bool(VT::Flags & Eigen::DirectAccessBit) && VT::InnerStrideAtCompileTime == 1) {
+            const size_t size = q_.size();
+            if ( size >= Kernels::MinSize ) {
+                valueBuffer_.resize(size);
+                return getKernels().expScaled(size, q_.data(), 1.0 / temperature_, valueBuffer_.data());
+            }
         }
-        return valueBuffer_(a) / valueBuffer_.sum();
+        valueBuffer_ = (q_ / temperature_).array().exp();
+        return valueBuffer_.sum();
     }
 
     template <typename V, typename Gen>
@@ -3,6 +3,7 @@
 
 #include <AIToolbox/Factored/Bandit/Types.hpp>
 #include <AIToolbox/Factored/Utils/FactoredContainer.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
 
 namespace AIToolbox::Factored::Bandit {
     /**
@@ -75,21 +76,23 @@ namespace AIToolbox::Factored::Bandit {
             FactoredContainer<QFunctionRule> getQFunctionRules() const;
 
         private:
-            struct Average {
-                double value = 0.0;
-                unsigned count = 0;
-            };
-
             /// The action space
             Action A;
             /// The number of actions allowed at any one time (always 1)
             unsigned L;
             /// The current timestep, to compute the UCB1 value
             unsigned timestep_;
-            /// A vector containing all averages and counts for all local joint actions.
-            std::vector<Average> averages_;
+            /// The agents of each dependency group, the strides of their actions, and the id of the first rule of the group.
+            std::vector<PartialKeys> groupKeys_;
+            std::vector<std::vector<size_t>> groupStrides_;
+            std::vector<size_t> groupOffsets_;
+            /// The averages and counts for all local joint actions, in the same order as the rules.
+            std::vector<double> means_;
+            std::vector<unsigned> counts_;
             /// A container for all QFunctionRules we have.
             FactoredContainer<QFunctionRule> rules_;
+            /// The VariableElimination instance, kept to reuse its graph between timesteps.
+            VariableElimination ve_;
     };
 }
 
@@ -95,22 +95,24 @@ namespace AIToolbox::Factored::Bandit {
             FactoredContainer<QFunctionRule> getQFunctionRules() const;
 
         private:
-            struct Average {
-                double value;
-                unsigned count;
-                double rangeSquared;
-            };
-
             /// The action space
             Action A;
             /// The current timestep, used to compute logtA
             unsigned timestep_;
-            /// The graph containing the averages and ranges for the agents.
-            FactoredContainer<Average> averages_;
+            /// The agents of each dependency group, the strides of their actions, and the id of the first rule of the group.
+            std::vector<PartialKeys> groupKeys_;
+            std::vector<std::vector<size_t>> groupStrides_;
+            std::vector<size_t> groupOffsets_;
+            /// The averages, counts and squared reward ranges for all local joint actions, in the same order as the rules.
+            std::vector<double> means_;
+            std::vector<unsigned> counts_;
+            std::vector<double> rangesSquared_;
             /// The rules to pass to UCVE at each timestep.
             std::vector<UCVE::Entry> rules_;
             /// Precomputed logA since it won't change.
             double logA_;
+            /// The UCVE instance, kept to reuse its graph between timesteps.
+            UCVE ucve_;
     };
 }
 
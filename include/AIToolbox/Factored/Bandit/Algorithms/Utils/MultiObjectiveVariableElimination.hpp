@@ -4,6 +4,8 @@
 #include "AIToolbox/Factored/Bandit/Types.hpp"
 #include "AIToolbox/Factored/Utils/Core.hpp"
 #include "AIToolbox/Factored/Utils/FactorGraph.hpp"
+#include "AIToolbox/Factored/Utils/EliminationOrder.hpp"
+#include "AIToolbox/Utils/ThreadPool.hpp"
 
 #include <AIToolbox/Utils/Core.hpp>
 
@@ -33,6 +35,19 @@ namespace AIToolbox::Factored::Bandit {
      * considering the full factored Action at any one time, it is usually
      * much faster than a brute-force approach.
      *
+     * Entries which are dominated on all objectives by another entry for
+     * the same joint action can never be part of the final Pareto front,
+     * so they are pruned as soon as they are created. With two objectives
+     * this is done with a sorted sweep; with more, entries are sorted by
+     * the sum of their objectives, so that each only needs to be checked
+     * against the non-dominated ones found before it.
+     *
+     * How large the created factors get depends on the order in which
+     * agents are eliminated, which can be chosen with
+     * setEliminationHeuristic(). The graph is reset after each call, so
+     * that the same instance can be reused, keeping its cached order
+     * and the memory of its factors.
+     *
      * WARNING: This process only considers rules that have been explicitly
      * passed to it. This may create problems if some of your values have
      * negative values in it, since the elimination process will not
@@ -76,7 +91,6 @@ namespace AIToolbox::Factored::Bandit {
              */
             template <typename Iterable>
             Results operator()(const Iterable & inputRules) {
-                // Should we reset the graph?
                 for (const auto & rule : inputRules) {
                     auto & rules = graph_.getFactor(rule.action.first)->getData().rules;
                     rules.emplace_back(rule.action.second, Entries{std::make_tuple(PartialAction(), rule.values)});
@@ -84,6 +98,49 @@ namespace AIToolbox::Factored::Bandit {
                 return start();
             }
 
+            /**
+             * @brief This function sets the heuristic used to order the elimination of the agents.
+             *
+             * The order is cached, and only recomputed when the rules
+             * passed to this instance involve different groups of agents
+             * than in the previous call.
+             *
+             * \sa EliminationOrder
+             *
+             * @param heuristic The new heuristic.
+             */
+            void setEliminationHeuristic(EliminationOrder::Heuristic heuristic);
+
+            /**
+             * @brief This function returns the heuristic used to order the elimination of the agents.
+             *
+             * @return The currently set heuristic.
+             */
+            EliminationOrder::Heuristic getEliminationHeuristic() const;
+
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize the elimination.
+             *
+             * When eliminating an agent, the joint actions of its
+             * neighbors are split between the threads, if there are
+             * enough of them. The result does not depend on the number of
+             * threads.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
             /**
              * @brief This function performs the actual agent elimination process.
@@ -119,7 +176,9 @@ namespace AIToolbox::Factored::Bandit {
 
             Action A;
             Graph graph_;
+            EliminationOrder order_;
             std::vector<Entries> finalFactors_;
+            ThreadPool * pool_;
     };
 }
 
@@ -3,6 +3,8 @@
 
 #include "AIToolbox/Factored/Bandit/Types.hpp"
 #include "AIToolbox/Factored/Utils/FactorGraph.hpp"
+#include "AIToolbox/Factored/Utils/EliminationOrder.hpp"
+#include "AIToolbox/Utils/ThreadPool.hpp"
 
 namespace AIToolbox::Factored::Bandit {
     /**
@@ -21,9 +23,10 @@ namespace AIToolbox::Factored::Bandit {
      * agent, in order to remove actions which cannot possibly be optimal
      * from the search.
      *
-     * As this class doesn't really do much cleanup after solving a
-     * process, it's probably best to create a separate instance for each
-     * solving process.
+     * The order in which agents are eliminated can be chosen with
+     * setEliminationHeuristic(). The graph is reset after each solving
+     * process, so the same instance can be reused with its cached order
+     * and the memory of its factors, updating logtA with setLogtA().
      */
     class UCVE {
         public:
@@ -78,6 +81,63 @@ namespace AIToolbox::Factored::Bandit {
                 return start();
             }
 
+            /**
+             * @brief This function sets the heuristic used to order the elimination of the agents.
+             *
+             * The order is cached, and only recomputed when the rules
+             * passed to this instance involve different groups of agents
+             * than in the previous call.
+             *
+             * \sa EliminationOrder
+             *
+             * @param heuristic The new heuristic.
+             */
+            void setEliminationHeuristic(EliminationOrder::Heuristic heuristic);
+
+            /**
+             * @brief This function returns the heuristic used to order the elimination of the agents.
+             *
+             * @return The currently set heuristic.
+             */
+            EliminationOrder::Heuristic getEliminationHeuristic() const;
+
+            /**
+             * @brief This function sets the logtA to use in the next solving process.
+             *
+             * @param logtA The new logtA.
+             */
+            void setLogtA(double logtA);
+
+            /**
+             * @brief This function returns the currently set logtA.
+             *
+             * @return The currently set logtA.
+             */
+            double getLogtA() const;
+
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize the elimination.
+             *
+             * When eliminating an agent, the joint actions of its
+             * neighbors are split between the threads, if there are
+             * enough of them. The result does not depend on the number of
+             * threads.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
             /**
              * @brief This function performs the actual agent elimination process.
@@ -131,8 +191,10 @@ namespace AIToolbox::Factored::Bandit {
 
             Action A;
             Graph graph_;
+            EliminationOrder order_;
             std::vector<Entries> finalFactors_;
             double logtA_;
+            ThreadPool * pool_;
     };
 }
 
@@ -1,8 +1,13 @@
 #ifndef AI_TOOLBOX_FACTORED_BANDIT_VARIABLE_ELIMINATION_HEADER_FILE
 #define AI_TOOLBOX_FACTORED_BANDIT_VARIABLE_ELIMINATION_HEADER_FILE
 
+#include <deque>
+
 #include "AIToolbox/Factored/Bandit/Types.hpp"
 #include "AIToolbox/Factored/Utils/FactorGraph.hpp"
+#include "AIToolbox/Factored/Utils/FactoredMatrix.hpp"
+#include "AIToolbox/Factored/Utils/EliminationOrder.hpp"
+#include "AIToolbox/Utils/ThreadPool.hpp"
 
 namespace AIToolbox::Factored::Bandit {
     /**
@@ -29,6 +34,18 @@ namespace AIToolbox::Factored::Bandit {
      * considering the full factored Action at any one time, it is usually
      * much faster than a brute-force approach.
      *
+     * How large the created factors get depends on the order in which
+     * agents are eliminated, which can be chosen with
+     * setEliminationHeuristic(). The graph is reset after each call, so
+     * that the same instance can be reused, keeping its cached order
+     * and the memory of its factors.
+     *
+     * If a ThreadPool is set, the connected components of the graph are
+     * eliminated in parallel, each in its own graph. When the graph has a
+     * single component, the joint actions enumerated while eliminating
+     * each agent are instead split between the threads, if there are
+     * enough of them.
+     *
      * WARNING: This process only considers rules that have been explicitly
      * passed to it. This may create problems if some of your values have
      * negative values in it, since the elimination process will not
@@ -48,8 +65,20 @@ namespace AIToolbox::Factored::Bandit {
 
             using Result = std::tuple<Action, double>;
 
+            /**
+             * @brief This struct contains the rules of a factor.
+             *
+             * Rules can be stored either as a list, or in a dense table
+             * with one value and tag per joint action of the agents of the
+             * factor, indexed as by toIndexPartial(). Joint actions
+             * without a rule in the table have value zero and an empty
+             * tag. A factor can use both forms at once, in which case the
+             * payoff of a joint action is the sum of the two.
+             */
             struct Factor {
                 Rules rules;
+                std::vector<double> values;
+                std::vector<PartialAction> tags;
             };
 
             using Graph = FactorGraph<Factor>;
@@ -73,7 +102,6 @@ namespace AIToolbox::Factored::Bandit {
              */
             template <typename Iterable>
             Result operator()(const Iterable & inputRules) {
-                // Should we reset the graph?
                 for (const auto & rule : inputRules) {
                     auto it = graph_.getFactor(rule.action.first);
                     it->getData().rules.emplace_back(rule.action.second, Entry{rule.value, PartialAction()});
@@ -81,6 +109,90 @@ namespace AIToolbox::Factored::Bandit {
                 return start();
             }
 
+            /**
+             * @brief This function finds the best Action-value pair for the provided dense factors.
+             *
+             * Each basis of the input contains one value for each joint
+             * action of the agents in its tag, indexed as by
+             * toIndexPartial(). The values are copied directly into the
+             * dense tables of the factors, without going through rules.
+             * Bases over the same agents are summed.
+             *
+             * This is useful when the payoffs are already stored as
+             * tables, as it avoids both creating and matching rules.
+             *
+             * @param q The dense payoffs over the agents.
+             *
+             * @return A tuple containing the best Action and its value over the input factors.
+             */
+            Result operator()(const FactoredVector & q);
+
+            /**
+             * @brief This function sets the fill ratio above which factors are stored as dense tables.
+             *
+             * Looking up a joint action in a list of rules requires
+             * matching it against all of them, while looking it up in a
+             * dense table takes constant time. When an agent is
+             * eliminated, each adjacent factor whose number of rules
+             * is at least this fraction of its joint actions is first
+             * converted to a dense table.
+             *
+             * The factors created by elimination contain a rule for each
+             * joint action of their agents, so they are always dense.
+             *
+             * A ratio of 0 converts all factors, whatever their size,
+             * while a ratio higher than 1 only converts factors with
+             * multiple rules for the same joint actions.
+             *
+             * @param ratio The new ratio.
+             */
+            void setDenseFillRatio(double ratio);
+
+            /**
+             * @brief This function returns the fill ratio above which factors are stored as dense tables.
+             *
+             * @return The currently set ratio.
+             */
+            double getDenseFillRatio() const;
+
+            /**
+             * @brief This function sets the heuristic used to order the elimination of the agents.
+             *
+             * The order is cached, and only recomputed when the rules
+             * passed to this instance involve different groups of agents
+             * than in the previous call.
+             *
+             * \sa EliminationOrder
+             *
+             * @param heuristic The new heuristic.
+             */
+            void setEliminationHeuristic(EliminationOrder::Heuristic heuristic);
+
+            /**
+             * @brief This function returns the heuristic used to order the elimination of the agents.
+             *
+             * @return The currently set heuristic.
+             */
+            EliminationOrder::Heuristic getEliminationHeuristic() const;
+
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize the elimination.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
             /**
              * @brief This function performs the actual agent elimination process.
@@ -104,20 +216,52 @@ namespace AIToolbox::Factored::Bandit {
             Result start();
 
             /**
-             * @brief This function performs the elimination of a single agent (and all factors next to it) from the internal graph.
+             * @brief This function finds the connected components of the internal graph.
+             *
+             * Components are numbered in order of their lowest agent.
+             * Agents without factors are assigned the number of
+             * components as their id.
+             *
+             * @param components The output component of each agent.
+             *
+             * @return The number of components.
+             */
+            size_t findComponents(std::vector<size_t> * components) const;
+
+            /**
+             * @brief This function performs the elimination of a single agent (and all factors next to it) from a graph.
              *
              * This function adds the resulting best rules which do not
-             * depend on the eliminated action to the remaining factors.
+             * depend on the eliminated action to the remaining factors,
+             * as a dense table. If the agent was the last one of its
+             * factor, the result is added to the final factors instead.
              *
              * \sa start()
              *
+             * @param graph The graph to remove the agent from.
+             * @param finalFactors The final factors of the graph.
              * @param agent The index of the agent to be removed from the graph.
+             * @param pool The ThreadPool to split the joint actions with, or nullptr.
+             */
+            void removeAgent(Graph & graph, std::vector<Entry> & finalFactors, size_t agent, ThreadPool * pool);
+
+            /**
+             * @brief This function adds the rules of a factor to its dense table.
+             *
+             * If the factor has no table, one is created.
+             *
+             * @param factor The factor to convert.
              */
-            void removeAgent(size_t agent);
+            void makeDense(Graph::FactorIt factor);
 
             Action A;
             Graph graph_;
+            EliminationOrder order_;
+            double denseFillRatio_;
+            ThreadPool * pool_;
             std::vector<Entry> finalFactors_;
+            // Kept to reuse their factors between calls.
+            std::deque<Graph> componentGraphs_;
     };
 }
 
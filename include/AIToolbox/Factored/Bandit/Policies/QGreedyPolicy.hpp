@@ -4,6 +4,7 @@
 #include <AIToolbox/Factored/Bandit/Policies/PolicyInterface.hpp>
 #include <AIToolbox/Factored/Bandit/Types.hpp>
 #include <AIToolbox/Factored/Utils/FactoredContainer.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
 
 namespace AIToolbox::Factored::Bandit {
     /**
@@ -14,6 +15,16 @@ namespace AIToolbox::Factored::Bandit {
      * action, or a given action probability the QGreedyPolicy must run
      * VariableElimination on the stored rules, so the process can get a
      * bit expensive.
+     *
+     * To avoid this cost when the policy is queried many times between
+     * updates, the greedy action and its value are cached, and reused
+     * until the user calls invalidate() after modifying the rules (as in
+     * the MDP QSoftmaxPolicy).
+     *
+     * The cache is kept separately for each group of agents which are
+     * connected by the rules. If only the values of some rules have been
+     * modified, calling invalidate(const PartialKeys &) with their agents
+     * re-runs VariableElimination only on the groups containing them.
      */
     class QGreedyPolicy : public PolicyInterface {
         public:
@@ -43,8 +54,52 @@ namespace AIToolbox::Factored::Bandit {
              */
             virtual double getActionProbability(const Action & a) const override;
 
+            /**
+             * @brief This function returns the value of the greediest action.
+             *
+             * @return The sum of the values of the rules matching the action returned by sampleAction().
+             */
+            double getGreedyValue() const;
+
+            /**
+             * @brief This function invalidates the cached greedy action.
+             *
+             * This function must be called whenever the underlying rules
+             * are modified, and always when rules are added or removed.
+             */
+            void invalidate();
+
+            /**
+             * @brief This function invalidates the cached greedy action for the input agents.
+             *
+             * This function can be called instead of invalidate() when
+             * only the values of existing rules have been modified. The
+             * input must contain at least one agent of each modified rule;
+             * only the groups of agents connected to them will be
+             * recomputed.
+             *
+             * @param agents The agents of the modified rules.
+             */
+            void invalidate(const PartialKeys & agents);
+
         private:
+            /**
+             * @brief This function recomputes the invalid parts of the cache.
+             */
+            void update() const;
+
             const FactoredContainer<QFunctionRule> & q_;
+
+            mutable VariableElimination ve_;
+            // Whether the groups are valid; if not, everything is recomputed.
+            mutable bool valid_;
+            // The group of each agent; agents without rules are in none.
+            mutable std::vector<size_t> groups_;
+            mutable std::vector<char> dirty_;
+            mutable std::vector<double> values_;
+            mutable std::vector<std::vector<QFunctionRule>> buffers_;
+            mutable Action action_;
+            mutable double value_;
     };
 }
 
@@ -0,0 +1,172 @@
+#ifndef AI_TOOLBOX_FACTORED_MDP_APPROXIMATE_POLICY_ITERATION_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_MDP_APPROXIMATE_POLICY_ITERATION_HEADER_FILE
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
+#include <AIToolbox/Factored/MDP/Types.hpp>
+#include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/Utils/FactoredLP.hpp>
+
+namespace AIToolbox { class ThreadPool; }
+
+namespace AIToolbox::Factored::MDP {
+    /**
+     * @brief This class solves a factored MDP with approximate policy iteration.
+     *
+     * This algorithm alternates between evaluating a policy, approximating
+     * its ValueFunction with the input basis functions, and improving the
+     * policy with respect to the QFunction computed from that
+     * approximation.
+     *
+     * Policies are represented locally: each action factor picks its
+     * action from a table indexed by the values of a subset of the state
+     * factors (its LocalPolicy). Under such a policy the back-projections
+     * of the basis functions and the rewards remain factored, over their
+     * own scopes joined with the scopes of the local policies of the
+     * action factors they depend on.
+     *
+     * Each evaluation finds the weights minimizing the max-norm of the
+     * Bellman error of the policy, following Guestrin et al.:
+     *
+     *     min_w max_s | sum_k w_k * (h_k(s) - discount * g_k(s, pi(s))) - R(s, pi(s)) |
+     *
+     * This is done with a FactoredLP. Since the scopes of the local
+     * policies never change, all evaluations have the same structure: the
+     * LP is built once, and each following iteration only rewrites its
+     * coefficients and re-solves it starting from the previous solution.
+     *
+     * Each improvement step updates all local policies at once, each
+     * against the previous policy of the other action factors. For each
+     * value of its scope, an action factor picks the action with the
+     * highest QFunction, averaged uniformly over the state factors it does
+     * not observe. Since the action factors are improved independently,
+     * these steps are split between the threads of the ThreadPool, if one
+     * is set; the result does not depend on the number of threads.
+     *
+     * The process stops when the policy does not change anymore, or after a
+     * maximum number of iterations.
+     */
+    class ApproximatePolicyIteration {
+        public:
+            /**
+             * @brief This struct represents the policy of a single action factor.
+             */
+            struct LocalPolicy {
+                /// The state factors the action depends on.
+                PartialKeys tag;
+                /// The action for each value of the tag, with factorSpacePartial(tag, S) elements.
+                std::vector<size_t> actions;
+            };
+            using Policy = std::vector<LocalPolicy>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param maxIterations The maximum number of iterations to perform, or 0 for no limit.
+             */
+            ApproximatePolicyIteration(unsigned maxIterations = 100);
+
+            /**
+             * @brief This function solves the input MDP using approximate policy iteration.
+             *
+             * The input policy contains one LocalPolicy per action factor,
+             * and is used as the starting policy. Its tags determine the
+             * scopes of all policies considered.
+             *
+             * This function throws std::invalid_argument if the policy
+             * does not match the model, and std::runtime_error if an LP
+             * could not be solved.
+             *
+             * @param m The MDP that needs to be solved.
+             * @param h The basis functions to use to approximate the ValueFunctions.
+             * @param policy The initial policy.
+             *
+             * @return A tuple containing the weights for the basis functions, the equivalent QFunction, and the last policy evaluated.
+             */
+            std::tuple<Vector, QFunction, Policy> operator()(const CooperativeModel & m, const FactoredVector & h, Policy policy);
+
+            /**
+             * @brief This function sets the maximum number of iterations to perform.
+             *
+             * @param maxIterations The maximum number of iterations, or 0 for no limit.
+             */
+            void setMaxIterations(unsigned maxIterations);
+
+            /**
+             * @brief This function returns the maximum number of iterations to perform.
+             *
+             * @return The maximum number of iterations.
+             */
+            unsigned getMaxIterations() const;
+
+            /**
+             * @brief This function returns the number of iterations performed by the last call.
+             *
+             * @return The number of policies evaluated.
+             */
+            unsigned getIterations() const;
+
+            /**
+             * @brief This function returns the number of times the structure of the LP has been built.
+             *
+             * Iterations which reuse the previous LP are not counted.
+             *
+             * @return The number of LPs built.
+             */
+            size_t getLPBuildCount() const;
+
+            /**
+             * @brief This function sets the ThreadPool to use.
+             *
+             * The ThreadPool is used to back-project the basis functions,
+             * to build the LP, and to improve the local policies. It is
+             * not owned by this class, and must outlive it or be unset
+             * before being destroyed.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+        private:
+            /**
+             * @brief This function computes the inputs of the FactoredLP evaluating the input policy.
+             *
+             * @param m The model to solve.
+             * @param h The basis functions.
+             * @param g The back-projections of the basis functions.
+             * @param policy The policy to evaluate.
+             * @param C The output basis functions, h - discount * g under the policy.
+             * @param b The output rewards under the policy.
+             */
+            void makeEvaluation(const CooperativeModel & m, const FactoredVector & h, const FactoredMatrix2D & g, const Policy & policy, FactoredVector * C, FactoredVector * b) const;
+
+            /**
+             * @brief This function computes the improved local policy of an action factor.
+             *
+             * @param m The model to solve.
+             * @param q The QFunction of the previous policy.
+             * @param policy The previous policy.
+             * @param j The action factor to improve.
+             *
+             * @return The improved actions of the action factor.
+             */
+            std::vector<size_t> improve(const CooperativeModel & m, const QFunction & q, const Policy & policy, size_t j) const;
+
+            unsigned maxIterations_, iterations_;
+            ThreadPool * pool_;
+            std::unique_ptr<FactoredLP> lp_;
+    };
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef AI_TOOLBOX_FACTORED_MDP_COOPERATIVE_QLEARNING_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_MDP_COOPERATIVE_QLEARNING_HEADER_FILE
+
+#include <AIToolbox/Factored/MDP/Types.hpp>
+
+#include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+
+namespace AIToolbox::Factored::MDP {
+    /**
+     * @brief This class represents the Cooperative QLearning algorithm over dense tables.
+     *
+     * This algorithm performs the same updates as
+     * SparseCooperativeQLearning, but rather than keeping the QFunction as
+     * a set of QFunctionRules, it stores it as a QFunction: one dense table
+     * per group of state factors and agents.
+     *
+     * This is the better choice when the tables are small enough to be
+     * fully represented, as the rules to update can then be found by
+     * simply indexing the tables, rather than by filtering a
+     * FactoredContainer. In the same way, the best next action is computed
+     * by passing the table rows for the next state directly to
+     * VariableElimination.
+     *
+     * Each rule of SparseCooperativeQLearning corresponds to a single cell
+     * of the tables, so if the rules cover exactly all the cells, the two
+     * algorithms learn the same values.
+     */
+    class CooperativeQLearning {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The bases of the input QFunction determine the state
+             * factors and agents each table is defined over, and their
+             * values are used as the initial values of the tables. Each
+             * table must have a row for each value of its state factors,
+             * and a column for each joint action of its agents;
+             * otherwise this constructor throws an std::invalid_argument.
+             *
+             * @param S The factored state space of the environment.
+             * @param A The factored action space for the agent.
+             * @param q The initial QFunction.
+             * @param discount The discount for future rewards.
+             * @param alpha The learning parameter.
+             */
+            CooperativeQLearning(State S, Action A, QFunction q, double discount, double alpha);
+
+            /**
+             * @brief This function sets the learning rate parameter.
+             *
+             * The learning rate parameter must be > 0.0 and <= 1.0,
+             * otherwise the function will throw an std::invalid_argument.
+             *
+             * \sa SparseCooperativeQLearning::setLearningRate(double)
+             *
+             * @param a The new learning rate parameter.
+             */
+            void setLearningRate(double a);
+
+            /**
+             * @brief This function will return the current set learning rate parameter.
+             *
+             * @return The currently set learning rate parameter.
+             */
+            double getLearningRate() const;
+
+            /**
+             * @brief This function sets the new discount parameter.
+             *
+             * The discount parameter must be > 0.0 and <= 1.0,
+             * otherwise the function will throw an std::invalid_argument.
+             *
+             * \sa SparseCooperativeQLearning::setDiscount(double)
+             *
+             * @param d The new discount factor.
+             */
+            void setDiscount(double d);
+
+            /**
+             * @brief This function returns the currently set discount parameter.
+             *
+             * @return The currently set discount parameter.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function updates the internal QFunction based on experience.
+             *
+             * This function takes a single experience point and uses it to
+             * update the QFunction. Since in order to do this we have to
+             * compute the best possible action for the next timestep, we
+             * return it in case it is needed.
+             *
+             * Note: this algorithm expects one reward per factored action
+             * (i.e. the size of the action input and the rewards input
+             * should be the same)!
+             *
+             * @param s The previous state.
+             * @param a The action performed.
+             * @param s1 The new state.
+             * @param rew The reward obtained.
+             *
+             * @return The best action to be performed in the next timestep.
+             */
+            Action stepUpdateQ(const State & s, const Action & a, const State & s1, const Rewards & rew);
+
+            /**
+             * @brief This function returns the state space on which CooperativeQLearning is working.
+             *
+             * @return The number of states.
+             */
+            const State & getS() const;
+
+            /**
+             * @brief This function returns the action space on which CooperativeQLearning is working.
+             *
+             * @return The number of actions.
+             */
+            const Action & getA() const;
+
+            /**
+             * @brief This function returns a reference to the internal QFunction.
+             *
+             * @return The internal QFunction.
+             */
+            const QFunction & getQFunction() const;
+
+        private:
+            State S;
+            Action A;
+            double discount_, alpha_;
+            QFunction q_;
+
+            // Reused between updates to avoid allocations.
+            Bandit::VariableElimination ve_;
+            FactoredVector rows_;
+            std::vector<double> before_, after_;
+    };
+}
+
+#endif
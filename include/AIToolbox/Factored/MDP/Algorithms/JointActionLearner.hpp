@@ -8,6 +8,8 @@
 
 #include <AIToolbox/MDP/Algorithms/QLearning.hpp>
 
+#include <unordered_map>
+
 namespace AIToolbox::Factored::MDP {
     /**
      * @brief This class represents a single Joint Action Learner agent.
@@ -17,8 +19,27 @@ namespace AIToolbox::Factored::MDP {
      *
      * In order to reason about its own QFunction, a JAL keeps a model of the
      * policies of the other agents. This is done by keeping counters for each
-     * actions that other agents have performed, and performing a maximum
-     * likelihood computation in order to estimate their policies.
+     * action that the other agents have performed, and performing a
+     * maximum likelihood computation in order to estimate their policies.
+     * The policies of the other agents are assumed independent, so the
+     * probability of a joint action of theirs is the product of the
+     * probabilities of its single actions.
+     *
+     * The expected value of each of our actions over these policies is
+     * computed by taking the expectation over one other agent at a time,
+     * which costs O(|A|) per step. With only two agents, it is instead
+     * kept up to date incrementally: since each step only changes a single
+     * count and a single value of the joint QFunction, updating it only
+     * costs O(A_i).
+     *
+     * Optionally (see setJointOpponentModel()), the other agents can be
+     * modeled with the empirical distribution of their joint actions
+     * instead, which captures correlations between their policies. The
+     * counts of their joint actions are stored sparsely, so that only the
+     * joint actions actually observed in each state take memory, and the
+     * expected values are always updated incrementally in O(A_i). To avoid
+     * accumulating rounding errors, they are periodically recomputed from
+     * the counts.
      *
      * While internally a QFunction is kept for the full joint action space,
      * after using the policy models the output will be a normal
@@ -123,6 +144,29 @@ namespace AIToolbox::Factored::MDP {
              */
             double getDiscount() const;
 
+            /**
+             * @brief This function sets whether the other agents are modeled with their joint distribution.
+             *
+             * By default, the policies of the other agents are estimated
+             * independently, and their joint policy is the product of
+             * them. When this is enabled, the empirical distribution of
+             * their joint actions is used instead.
+             *
+             * Counts for both models are always kept, so this can be
+             * changed at any time; the single QFunction is recomputed for
+             * all states.
+             *
+             * @param joint Whether to use the joint distribution of the other agents.
+             */
+            void setJointOpponentModel(bool joint);
+
+            /**
+             * @brief This function returns whether the other agents are modeled with their joint distribution.
+             *
+             * @return Whether the joint distribution of the other agents is used.
+             */
+            bool getJointOpponentModel() const;
+
             /**
              * @brief This function returns the number of states on which JointActionLearner is working.
              *
@@ -145,14 +189,43 @@ namespace AIToolbox::Factored::MDP {
             size_t getId() const;
 
         private:
+            /**
+             * @brief This function recomputes the sum of the joint QFunction over the joint counts of a state.
+             *
+             * @param s The state to recompute.
+             */
+            void refreshExpectedQ(size_t s);
+
+            /**
+             * @brief This function recomputes the single QFunction of a state.
+             *
+             * @param s The state to recompute.
+             */
+            void updateSingleQ(size_t s);
+
             Action A;
             size_t id_;
+            bool joint_;
 
-            std::vector<unsigned> stateCounters_;
-            boost::multi_array<std::vector<unsigned>, 2> stateActionCounts_;
+            size_t idStride_;
 
+            std::vector<unsigned> stateCounters_;
+            // For each state, the counts of the actions of each agent, one
+            // agent after the other (ours are not used).
+            std::vector<size_t> agentOffsets_;
+            std::vector<unsigned> agentCounts_;
+            // For each state, the counts of the joint actions of the other
+            // agents, indexed as the joint action where we take action 0.
+            std::vector<std::unordered_map<size_t, unsigned>> stateActionCounts_;
+
+            // The sum of the joint QFunction over the joint counts; dividing
+            // it by the state counter gives the single QFunction for the
+            // joint model.
+            AIToolbox::MDP::QFunction expectedQ_;
             AIToolbox::MDP::QFunction singleQFun_;
-            PartialFactorsEnumerator jointActions_;
+
+            // Workspaces to take the expectation over one agent at a time.
+            Vector buffer_, buffer2_;
 
             AIToolbox::MDP::QLearning qLearning_;
     };
@@ -7,7 +7,7 @@
 #include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
 #include <AIToolbox/Factored/Utils/FactorGraph.hpp>
 
-namespace AIToolbox { class LP; }
+namespace AIToolbox { class LP; class ThreadPool; }
 
 namespace AIToolbox::Factored::MDP {
     /**
@@ -27,9 +27,20 @@ namespace AIToolbox::Factored::MDP {
      * This results in a method that can very approximate very well the optimal
      * ValueFunction for environments with trillion or more states and actions,
      * in a reasonable amount of time.
+     *
+     * Optionally, a ThreadPool can be set so that the back-projection of the
+     * basis functions and the matching of the rules during the variable
+     * elimination are split between its threads. The LP itself is always
+     * built and solved serially, so the result does not depend on the
+     * number of threads.
      */
     class LinearProgramming {
         public:
+            /**
+             * @brief Basic constructor.
+             */
+            LinearProgramming();
+
             /**
              * @brief This function solves the input MDP using linear programming.
              *
@@ -40,6 +51,23 @@ namespace AIToolbox::Factored::MDP {
              */
             std::tuple<Vector, QFunction> operator()(const CooperativeModel & m, const FactoredVector & h) const;
 
+            /**
+             * @brief This function sets the ThreadPool to use to build the LP.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it or be unset before being destroyed.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
             using Rule = std::pair<PartialValues, size_t>;
             using Rules = std::vector<Rule>;
@@ -69,6 +97,8 @@ namespace AIToolbox::Factored::MDP {
              * @param finalFactors The variable where to store the final rules' ids.
              */
             void removeState(const Factors & F, Graph & graph, size_t s, LP & lp, std::vector<size_t> & finalFactors) const;
+
+            ThreadPool * pool_;
     };
 }
 
@@ -0,0 +1,285 @@
+#ifndef AI_TOOLBOX_FACTORED_MDP_MCTS_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_MDP_MCTS_HEADER_FILE
+
+#include <AIToolbox/Factored/MDP/Types.hpp>
+#include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
+#include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+#include <AIToolbox/Utils/SearchTree.hpp>
+#include <AIToolbox/Utils/SearchBudget.hpp>
+#include <AIToolbox/Utils/UCB.hpp>
+
+namespace AIToolbox::Factored::MDP {
+    /**
+     * @brief This class represents an MCTS online planner for multi-agent factored MDPs.
+     *
+     * AIToolbox::MDP::MCTS keeps statistics for every action of each node,
+     * which for a factored problem means one for each joint action: a
+     * number exponential in the number of agents.
+     *
+     * This class instead keeps, in each node, separate UCB1 statistics
+     * for each group of agents, over the local joint actions of the group
+     * (the factored statistics of Factored-Value MCTS, Amato & Oliehoek
+     * 2015). Each basis of the reward function is assigned to a group:
+     * the first one containing all its agents, or otherwise the one
+     * sharing the most agents with it. Every simulation then updates, for
+     * each group, the statistics of the local joint action it took with
+     * the local return of the group, i.e. the discounted sum of the
+     * rewards of its bases only. The value of a joint action is
+     * approximated as the sum of the values of its local actions.
+     *
+     * The joint action to try in each node is then the one maximizing the
+     * sum of the local UCB1 scores, which is found with
+     * VariableElimination over one dense factor per group. The cost per
+     * node is thus exponential only in the induced width of the graph of
+     * the groups, rather than in the number of agents. The action
+     * returned by sampleAction() maximizes the sum of the local means in
+     * the same way.
+     *
+     * The local statistics of each node are stored as the action nodes of
+     * a SearchTree, one per local joint action of each group, one group
+     * after the other. Children are keyed by a hash of the joint action
+     * and the next state; different pairs are assumed to have different
+     * hashes.
+     *
+     * Outside the tree, rollouts select the action of each agent
+     * uniformly at random.
+     */
+    class MCTS {
+        public:
+            using Graph = SearchTree<>;
+            using NodeId = Graph::NodeId;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * The groups of agents are the agents of the bases of the
+             * reward function of the model; agents not in any of them
+             * get their own group.
+             *
+             * @param m The model that MCTS will operate upon.
+             * @param iterations The number of episodes to run before completion.
+             * @param exp The exploration constant.
+             */
+            MCTS(const CooperativeModel & m, unsigned iterations, double exp);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * Each group must be a non-empty, sorted list of agents,
+             * otherwise this constructor throws an std::invalid_argument.
+             * Agents not in any group get their own group.
+             *
+             * @param m The model that MCTS will operate upon.
+             * @param groups The groups of agents to keep statistics for.
+             * @param iterations The number of episodes to run before completion.
+             * @param exp The exploration constant.
+             */
+            MCTS(const CooperativeModel & m, std::vector<PartialKeys> groups, unsigned iterations, double exp);
+
+            /**
+             * @brief This function resets the internal graph and samples for the provided state and horizon.
+             *
+             * @param s The initial state for the environment.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best joint action.
+             */
+            Action sampleAction(const State & s, unsigned horizon);
+
+            /**
+             * @brief This function uses the internal graph to plan.
+             *
+             * If the input joint action and state have been experienced
+             * in the previous search, the corresponding branch becomes
+             * the new root, and the search continues from it. Otherwise
+             * the graph is reset.
+             *
+             * @param a The joint action taken in the last timestep.
+             * @param s1 The state experienced after the action was taken.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best joint action.
+             */
+            Action sampleAction(const Action & a, const State & s1, unsigned horizon);
+
+            /**
+             * @brief This function sets the number of performed rollouts in MCTS.
+             *
+             * @param iter The new number of rollouts.
+             */
+            void setIterations(unsigned iter);
+
+            /**
+             * @brief This function sets the new exploration constant for MCTS.
+             *
+             * \sa AIToolbox::MDP::MCTS::setExploration(double)
+             *
+             * @param exp The new exploration constant.
+             */
+            void setExploration(double exp);
+
+            /**
+             * @brief This function sets the memory limit of the search tree, in bytes.
+             *
+             * \sa AIToolbox::MDP::MCTS::setMaxMemory(size_t)
+             *
+             * @param bytes The maximum memory used by the tree, or zero for no limit.
+             */
+            void setMaxMemory(size_t bytes);
+
+            /**
+             * @brief This function returns the model the MCTS is operating on.
+             *
+             * @return The model.
+             */
+            const CooperativeModel & getModel() const;
+
+            /**
+             * @brief This function returns the groups of agents whose statistics are kept.
+             *
+             * @return The groups of agents.
+             */
+            const std::vector<PartialKeys> & getGroups() const;
+
+            /**
+             * @brief This function returns the index of the first local statistic of a group within each node.
+             *
+             * The statistics of the local joint actions of each group are
+             * stored contiguously, indexed as by toIndexPartial().
+             *
+             * @param g The group.
+             *
+             * @return The offset of the group.
+             */
+            size_t getGroupOffset(size_t g) const;
+
+            /**
+             * @brief This function returns a reference to the internal graph structure holding the results of rollouts.
+             *
+             * @return The internal graph.
+             */
+            const Graph & getGraph() const;
+
+            /**
+             * @brief This function returns the number of iterations performed to plan for an action.
+             *
+             * @return The number of iterations.
+             */
+            unsigned getIterations() const;
+
+            /**
+             * @brief This function returns the currently set exploration constant.
+             *
+             * @return The exploration constant.
+             */
+            double getExploration() const;
+
+            /**
+             * @brief This function returns the memory limit of the search tree.
+             *
+             * @return The maximum memory used by the tree, or zero if unlimited.
+             */
+            size_t getMaxMemory() const;
+
+            /**
+             * @brief This function returns statistics about the last call to sampleAction().
+             *
+             * @return The statistics of the last search.
+             */
+            const SearchStatistics & getSearchStatistics() const;
+
+        private:
+            /**
+             * @brief This function runs the simulations from the root.
+             *
+             * @param s The state of the root.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best joint action of the root.
+             */
+            Action runSimulation(const State & s, unsigned horizon);
+
+            /**
+             * @brief This function simulates an episode from a node within the tree.
+             *
+             * @param b The id of the node.
+             * @param s The state of the node.
+             * @param depth The depth of the node.
+             *
+             * @return The discounted local return of each group for the episode.
+             */
+            Vector simulate(NodeId b, const State & s, unsigned depth);
+
+            /**
+             * @brief This function performs a random rollout from a new leaf.
+             *
+             * @param s The state of the leaf.
+             * @param depth The depth of the leaf.
+             *
+             * @return The discounted local return of each group for the rollout.
+             */
+            Vector rollout(State s, unsigned depth);
+
+            /**
+             * @brief This function adds the local reward of each group for the input state and joint action.
+             *
+             * @param s The state.
+             * @param a The joint action.
+             * @param gamma The discount to apply to the rewards.
+             * @param rew The local returns to add the rewards to.
+             */
+            void addLocalRewards(const State & s, const Action & a, double gamma, Vector & rew) const;
+
+            /**
+             * @brief This function selects the joint action maximizing the sum of the local UCB1 scores of a node.
+             *
+             * @param b The id of the node.
+             * @param count The number of visits of the node.
+             *
+             * @return The selected joint action.
+             */
+            Action findBestBonusA(NodeId b, unsigned count);
+
+            /**
+             * @brief This function selects the joint action maximizing the sum of the local means of a node.
+             *
+             * @param b The id of the node.
+             *
+             * @return The selected joint action.
+             */
+            Action findBestA(NodeId b);
+
+            /**
+             * @brief This function returns the key of the child reached with the input joint action and state.
+             *
+             * @param a The joint action.
+             * @param s1 The next state.
+             *
+             * @return The key of the child.
+             */
+            static size_t getChildKey(const Action & a, const State & s1);
+
+            const CooperativeModel & model_;
+            std::vector<PartialKeys> groups_;
+            std::vector<size_t> offsets_;
+            // The group each reward basis is assigned to.
+            std::vector<size_t> rewardGroups_;
+            unsigned iterations_, maxDepth_;
+            double exploration_;
+            size_t maxMemory_;
+
+            Graph graph_;
+            SearchStatistics stats_;
+
+            Bandit::VariableElimination ve_;
+            // One dense basis per group, refilled for each selection.
+            FactoredVector scores_;
+            std::vector<double> buffer_;
+            UCB1 bonus_;
+
+            mutable RandomEngine rand_;
+    };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <AIToolbox/Factored/MDP/Types.hpp>
 
 #include <AIToolbox/Factored/Utils/FactoredContainer.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
 
 namespace AIToolbox::Factored::MDP {
     /**
@@ -143,6 +144,36 @@ namespace AIToolbox::Factored::MDP {
              */
             Action stepUpdateQ(const State & s, const Action & a, const State & s1, const Rewards & rew);
 
+            /**
+             * @brief This function updates the internal QFunctionRules based on a batch of experience.
+             *
+             * All transitions of the batch are computed against the
+             * QFunctionRules as they are when this function is called:
+             * first the best next action of each transition is found, and
+             * the update of each rule is computed as in stepUpdateQ().
+             * Only after all transitions have been processed the updates
+             * are applied, in the order of the transitions of the batch.
+             *
+             * This is different from calling stepUpdateQ() for each
+             * transition, since later transitions do not see the updates
+             * from earlier ones. In exchange, this allows the
+             * maximizations, which are the most expensive part of the
+             * update, to be performed in parallel.
+             *
+             * The states, actions and nextStates of the batch must
+             * contain N full states and actions. The rewards must contain
+             * one reward per agent for each transition, stored in the same
+             * layout as the actions.
+             *
+             * If a ThreadPool is passed, the transitions are split
+             * between its threads. The result does not depend on the
+             * number of threads.
+             *
+             * @param batch The transitions to learn from.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void batchUpdateQ(const TransitionBatch & batch, ThreadPool * pool = nullptr);
+
             /**
              * @brief This function returns the state space on which SparseCooperativeQLearning is working.
              *
@@ -164,11 +195,32 @@ namespace AIToolbox::Factored::MDP {
              */
             const FactoredContainer<QFunctionRule> & getQFunctionRules() const;
 
+            /**
+             * @brief This function returns the version of the QFunctionRules.
+             *
+             * The version is increased every time the rules are modified,
+             * by inserting a rule or learning from experience. The
+             * returned reference stays valid as long as this object, so
+             * that it can be linked to a QGreedyPolicy to invalidate its
+             * cache of greedy actions.
+             *
+             * \sa QGreedyPolicy::setCacheSize(size_t, const unsigned long *)
+             *
+             * @return A reference to the version of the rules.
+             */
+            const unsigned long & getVersion() const;
+
         private:
             State S;
             Action A;
             double discount_, alpha_;
             FactoredContainer<QFunctionRule> rules_;
+            unsigned long version_;
+
+            // Reused between updates to avoid allocations.
+            Bandit::VariableElimination ve_;
+            std::vector<size_t> rulesIds_, beforeIds_, afterIds_;
+            std::vector<double> updates_;
     };
 }
 
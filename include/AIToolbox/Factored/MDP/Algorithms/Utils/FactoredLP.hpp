@@ -1,13 +1,14 @@
 #ifndef AI_TOOLBOX_FACTORED_MDP_FACTORED_LP_HEADER_FILE
 #define AI_TOOLBOX_FACTORED_MDP_FACTORED_LP_HEADER_FILE
 
+#include <memory>
 #include <utility>
 
 #include <AIToolbox/Factored/MDP/Types.hpp>
 #include <AIToolbox/Factored/Utils/FactorGraph.hpp>
 #include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
 
-namespace AIToolbox { class LP; }
+namespace AIToolbox { class LP; class ThreadPool; }
 
 namespace AIToolbox::Factored::MDP {
     /**
@@ -35,6 +36,20 @@ namespace AIToolbox::Factored::MDP {
      * Function. Once that's done, the basis functions can be summed and the
      * approximate Value Function constructed in order to continue whatever
      * algorithm is being executed.
+     *
+     * The LP is built in two phases. The symbolic phase runs the variable
+     * elimination, fixing the structure of the LP, and only depends on the
+     * scopes of the input functions. The numeric phase writes the values of
+     * the input functions in the LP. The LP is kept between calls, and if
+     * the scopes of the inputs have not changed only the numeric phase is
+     * repeated, and the LP is re-solved with LP::resolve().
+     * This is useful for algorithms that repeatedly approximate functions
+     * with the same structure, as approximate value and policy iteration.
+     *
+     * Optionally, a ThreadPool can be set so that the matching of the rules
+     * during the variable elimination is split between its threads. The LP
+     * itself is always built and solved serially, so the result does not
+     * depend on the number of threads.
      */
     class FactoredLP {
         public:
@@ -46,7 +61,14 @@ namespace AIToolbox::Factored::MDP {
              *
              * @param s The state space of the problem.
              */
-            FactoredLP(State s) : S(std::move(s)) {}
+            FactoredLP(State s);
+
+            /**
+             * @brief Basic destructor.
+             *
+             * This is needed since LP is an incomplete type here.
+             */
+            ~FactoredLP();
 
             /**
              * @brief This function finds the coefficients to approximate a Value Function.
@@ -71,6 +93,9 @@ namespace AIToolbox::Factored::MDP {
              * return value will contain an additional coefficient at the end
              * for the constant basis.
              *
+             * If the scopes of C and b, and addConstantBasis, are the same
+             * as in the previous call, the LP built then is reused.
+             *
              * @param C The basis functions used to approximate the Value Function.
              * @param b The Value Function to approximate.
              * @param addConstantBasis Whether we should include an impled constant basis for C.
@@ -79,11 +104,58 @@ namespace AIToolbox::Factored::MDP {
              */
             std::optional<Vector> operator()(const FactoredVector & C, const FactoredVector & b, bool addConstantBasis = false);
 
+            /**
+             * @brief This function sets the ThreadPool to use to build the LP.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it or be unset before being destroyed.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function returns the number of times the structure of the LP has been built.
+             *
+             * Calls which reuse the previous LP are not counted.
+             *
+             * @return The number of LPs built.
+             */
+            size_t getBuildCount() const;
+
         private:
             using Rule = std::pair<PartialValues, size_t>;
             using Rules = std::vector<Rule>;
             using Graph = FactorGraph<Rules>;
 
+            /**
+             * @brief This function builds the LP for the input functions.
+             *
+             * @param C The basis functions used to approximate the Value Function.
+             * @param b The Value Function to approximate.
+             * @param addConstantBasis Whether we should include an impled constant basis for C.
+             */
+            void buildLP(const FactoredVector & C, const FactoredVector & b, bool addConstantBasis);
+
+            /**
+             * @brief This function writes the rules which depend on the values of the input functions.
+             *
+             * These are the first rows of the LP, so they can be either
+             * pushed while building it, or replaced in place afterwards.
+             *
+             * @param C The basis functions used to approximate the Value Function.
+             * @param b The Value Function to approximate.
+             * @param push Whether the rows should be pushed, or replaced.
+             */
+            void setRules(const FactoredVector & C, const FactoredVector & b, bool push);
+
             /**
              * @brief This function performs a step in the variable elimination process.
              *
@@ -98,6 +170,13 @@ namespace AIToolbox::Factored::MDP {
             void removeState(Graph & graph, size_t s, LP & lp, std::vector<size_t> & finalFactors);
 
             State S;
+            ThreadPool * pool_;
+
+            // The LP of the last call, and the scopes it was built for.
+            std::unique_ptr<LP> lp_;
+            std::vector<PartialKeys> cTags_, bTags_;
+            bool constantBasis_;
+            size_t builds_;
     };
 }
 
@@ -0,0 +1,69 @@
+#ifndef AI_TOOLBOX_FACTORED_MDP_BINARY_IO_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_MDP_BINARY_IO_HEADER_FILE
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace AIToolbox::Factored::MDP {
+    class CooperativeExperience;
+
+    /**
+     * @brief The version of the binary format written by writeExperienceTable().
+     *
+     * Files with a different version are rejected when read.
+     */
+    inline constexpr std::uint32_t BinaryFormatVersion = 1;
+
+    /**
+     * @brief This function writes the visits and rewards of a CooperativeExperience as a columnar table.
+     *
+     * The table contains one row per visited entry of the DDN of the
+     * experience, sorted by state factor, action and parent index. Its
+     * columns are the state factor, the action index and the parent index
+     * within the DDN node of the factor, the value of the next state
+     * factor (all as 64 bit unsigned integers), the visits (as 64 bit
+     * signed integers) and the sum of the rewards obtained (as doubles).
+     * The sums over all next values are not stored, as they are
+     * recomputed when read.
+     *
+     * The file starts with a 64 byte header, whose 64 bit integers at
+     * offsets 24, 32, 40 and 48 are the number of state factors, action
+     * factors, rows and columns. The sizes of the state and action
+     * factors follow as two 64 bit unsigned integer arrays, and then each
+     * column as a raw array. Each array starts at a 64 byte boundary, so
+     * that the columns can be mapped directly (for example, by
+     * numpy.memmap) without any parsing.
+     *
+     * Values are stored in the native byte order.
+     *
+     * The stream should be opened in binary mode.
+     *
+     * @param os The output stream.
+     * @param exp The experience to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeExperienceTable(std::ostream & os, const CooperativeExperience & exp);
+
+    /**
+     * @brief This function adds all entries in a columnar table to a CooperativeExperience.
+     *
+     * The CooperativeExperience must have been built with the same state
+     * and action spaces and the same structure as the one that wrote the
+     * table. The visits and rewards are added to the ones already in the
+     * experience, as if each transition was recorded in turn, and all
+     * updated indeces are marked as dirty.
+     *
+     * If the table is invalid, was written for different spaces, or
+     * contains an out of range row, the failbit of the stream is set and
+     * the experience is not modified.
+     *
+     * @param is The input stream.
+     * @param exp The experience to record the table into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readExperienceTable(std::istream & is, CooperativeExperience & exp);
+}
+
+#endif
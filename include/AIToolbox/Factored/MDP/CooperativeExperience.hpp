@@ -1,6 +1,8 @@
 #ifndef AI_TOOLBOX_FACTORED_MDP_COOPERATIVE_EXPERIENCE_HEADER_FILE
 #define AI_TOOLBOX_FACTORED_MDP_COOPERATIVE_EXPERIENCE_HEADER_FILE
 
+#include <iosfwd>
+
 #include <AIToolbox/Factored/MDP/Types.hpp>
 #include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
 
@@ -35,6 +37,9 @@ namespace AIToolbox::Factored::MDP {
             // Used to avoid recomputation when doing sync in RL.
             using Indeces = std::vector<std::pair<size_t, size_t>>;
 
+            // For each state factor, the indeces updated since the last clearDirty().
+            using DirtyIndeces = std::vector<Indeces>;
+
             /**
              * @brief Basic constructor.
              *
@@ -70,9 +75,35 @@ namespace AIToolbox::Factored::MDP {
 
             /**
              * @brief This function resets all experienced rewards and transitions.
+             *
+             * This also clears the dirty indeces.
              */
             void reset();
 
+            /**
+             * @brief This function returns the indeces updated since the last call to clearDirty().
+             *
+             * Each call to record() marks the indeces it updates as dirty.
+             * For each state factor, each pair of action and parent
+             * indeces is stored only once, in the order in which it was
+             * first updated, no matter how many times it was recorded.
+             *
+             * This allows to sync a CooperativeRLModel after many calls
+             * to record(), updating each changed row only once.
+             *
+             * \sa CooperativeRLModel::syncDirty(ThreadPool *)
+             *
+             * @return The dirty indeces for each state factor.
+             */
+            const DirtyIndeces & getDirtyIndeces() const;
+
+            /**
+             * @brief This function clears the dirty indeces.
+             *
+             * This only costs as much as the number of dirty indeces.
+             */
+            void clearDirty();
+
             /**
              * @brief This function returns the visits table for inspection.
              *
@@ -108,6 +139,12 @@ namespace AIToolbox::Factored::MDP {
             VisitTable visits_;
             RewardMatrix rewards_;
             std::vector<std::pair<size_t, size_t>> indeces_;
+
+            // For each state factor and action, whether each parent row is dirty.
+            std::vector<std::vector<std::vector<char>>> dirtyRows_;
+            DirtyIndeces dirty_;
+
+            friend std::istream& readExperienceTable(std::istream &is, CooperativeExperience &);
     };
 }
 
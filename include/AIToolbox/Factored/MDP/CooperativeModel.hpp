@@ -4,6 +4,9 @@
 #include <AIToolbox/Factored/MDP/Types.hpp>
 #include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
 #include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+
+namespace AIToolbox { class ThreadPool; }
 
 namespace AIToolbox::Factored::MDP {
     /**
@@ -67,6 +70,50 @@ namespace AIToolbox::Factored::MDP {
              */
             double sampleSR(const State & s, const Action & a, State * s1) const;
 
+            /**
+             * @brief This function samples the MDP for a batch of state action pairs.
+             *
+             * This function is equivalent to calling sampleSR(const State
+             * &, const Action &, State *) for each transition of the batch,
+             * but samples each factor of all transitions at once, using
+             * precomputed strides to find the parents of each factor.
+             *
+             * The states and actions of the batch must contain N full
+             * states and actions; the nextStates and rewards are resized
+             * and overwritten.
+             *
+             * The batch is split in chunks, each sampled with its own
+             * random engine seeded from the internal one. If a ThreadPool
+             * is passed, the chunks are split between its threads; the
+             * result does not depend on the number of threads.
+             *
+             * NO CHECKS for nullptr are done.
+             *
+             * @param batch The batch to sample.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void sampleSR(TransitionBatch * batch, ThreadPool * pool = nullptr) const;
+
+            /**
+             * @brief This function sets whether sampling uses alias sampling.
+             *
+             * By default new state factors are sampled with a linear scan
+             * of the row of their transition matrix. When alias sampling
+             * is enabled, the Model builds a VoseAliasTable for each state
+             * factor, so that each sample becomes O(1). This costs as much
+             * memory as the transition function.
+             *
+             * @param enable Whether to use alias sampling.
+             */
+            void setAliasSampling(bool enable);
+
+            /**
+             * @brief This function returns whether sampling uses alias sampling.
+             *
+             * @return Whether alias sampling is enabled.
+             */
+            bool getAliasSampling() const;
+
             /**
              * @brief This function sets a new discount factor for the Model.
              *
@@ -117,6 +164,23 @@ namespace AIToolbox::Factored::MDP {
              */
             double getExpectedReward(const State & s, const Action & a, const State & s1) const;
 
+            /**
+             * @brief This function computes the expected rewards for a batch of state action pairs.
+             *
+             * This function is equivalent to calling getExpectedReward()
+             * for each transition of the batch, but evaluates each reward
+             * basis for all transitions at once.
+             *
+             * The states and actions of the batch must contain N full
+             * states and actions; the rewards are resized and overwritten.
+             * The next states are not used.
+             *
+             * NO CHECKS for nullptr are done.
+             *
+             * @param batch The batch to compute the rewards of.
+             */
+            void getExpectedRewards(TransitionBatch * batch) const;
+
             /**
              * @brief This function returns the transition function of the MDP.
              *
@@ -140,6 +204,31 @@ namespace AIToolbox::Factored::MDP {
             FactoredMatrix2D rewards_;
 
             mutable RandomEngine rand_;
+
+            void computeRewards(TransitionBatch & batch, size_t N, size_t begin, size_t end) const;
+
+            // The strides of the action tag of each factor, and of the
+            // parents of each of its nodes.
+            std::vector<std::vector<size_t>> actionStrides_;
+            std::vector<std::vector<std::vector<size_t>>> parentStrides_;
+
+            // The reward bases, flattened. The values of all bases are
+            // stored contiguously, and the scope of each basis is a range of
+            // (factor, stride) pairs: first its state factors, then its
+            // action factors. The strides index directly the values of the
+            // basis, starting from its offset.
+            struct RewardBasis {
+                size_t offset;
+                size_t scopeBegin, stateEnd, actionEnd;
+            };
+            std::vector<RewardBasis> rewardBases_;
+            std::vector<std::pair<size_t, size_t>> rewardScopes_;
+            std::vector<double> rewardValues_;
+
+            // One table per factor, containing the rows of all its nodes.
+            bool aliasSampling_;
+            std::vector<VoseAliasTable> samplers_;
+            std::vector<std::vector<size_t>> samplerOffsets_;
     };
 }
 
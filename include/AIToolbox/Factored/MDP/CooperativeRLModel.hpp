@@ -4,6 +4,8 @@
 #include <AIToolbox/Factored/MDP/CooperativeExperience.hpp>
 #include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
 
+namespace AIToolbox { class ThreadPool; }
+
 namespace AIToolbox::Factored::MDP {
     class CooperativeRLModel {
         public:
@@ -81,6 +83,27 @@ namespace AIToolbox::Factored::MDP {
              */
             void sync(const CooperativeExperience::Indeces & indeces);
 
+            /**
+             * @brief This function syncs all dirty indeces of the underlying CooperativeExperience.
+             *
+             * This function updates each row changed since the last
+             * CooperativeExperience::clearDirty() exactly once. This is
+             * much cheaper than calling sync(const
+             * CooperativeExperience::Indeces &) after every record() when
+             * the same rows are visited often, and than sync() when only
+             * a small part of the rows has been visited.
+             *
+             * The dirty indeces are not cleared, since the
+             * CooperativeExperience may be shared between multiple models;
+             * this must be done by the caller once all models are synced.
+             *
+             * If a ThreadPool is passed, the state factors are split
+             * between its threads.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void syncDirty(ThreadPool * pool = nullptr);
+
             /**
              * @brief This function samples the MDP for the specified state action pair.
              *
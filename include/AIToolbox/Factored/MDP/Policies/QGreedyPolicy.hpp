@@ -1,6 +1,11 @@
 #ifndef AI_TOOLBOX_FACTORED_MDP_Q_GREEDY_POLICY_HEADER_FILE
 #define AI_TOOLBOX_FACTORED_MDP_Q_GREEDY_POLICY_HEADER_FILE
 
+#include <list>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
 #include <AIToolbox/PolicyInterface.hpp>
 #include <AIToolbox/Factored/MDP/Types.hpp>
 #include <AIToolbox/Factored/Utils/FactoredContainer.hpp>
@@ -15,6 +20,15 @@ namespace AIToolbox::Factored::MDP {
      * In order to compute the best action or a given action probability the
      * QGreedyPolicy must run VariableElimination on the stored rules, so the
      * process can get a bit expensive.
+     *
+     * When the same states are queried many times, the greedy actions can
+     * be cached with setCacheSize(). The cache is bounded, and evicts the
+     * least recently used state when full. Since the policy cannot know
+     * when the underlying rules change, the cache can be linked to a
+     * version counter (as the one of SparseCooperativeQLearning), and is
+     * cleared whenever the counter changes; otherwise it must be cleared
+     * manually with clearCache(). As queries modify the cache, a policy
+     * with caching enabled cannot be queried from multiple threads at once.
      */
     class QGreedyPolicy : public PolicyInterface<State, State, Action> {
         public:
@@ -57,9 +71,65 @@ namespace AIToolbox::Factored::MDP {
              */
             virtual double getActionProbability(const State & s, const Action & a) const override;
 
+            /**
+             * @brief This function sets the maximum number of greedy actions cached.
+             *
+             * The cache is cleared. If a version counter is given, the
+             * cache is also cleared every time a query sees that the
+             * counter has changed. The counter must outlive this policy,
+             * or be unlinked with another call to this function.
+             *
+             * \sa SparseCooperativeQLearning::getVersion()
+             *
+             * @param maxSize The maximum number of states cached, or zero to disable the cache.
+             * @param version A pointer to the version of the rules, or nullptr.
+             */
+            void setCacheSize(size_t maxSize, const unsigned long * version = nullptr);
+
+            /**
+             * @brief This function returns the maximum number of greedy actions cached.
+             *
+             * @return The maximum size of the cache, or zero if disabled.
+             */
+            size_t getCacheSize() const;
+
+            /**
+             * @brief This function removes all cached greedy actions.
+             *
+             * This function must be called whenever the underlying rules
+             * are modified, if the cache is enabled and not linked to a
+             * version counter.
+             */
+            void clearCache();
+
+            /**
+             * @brief This function returns the number of queries answered from the cache since the last clear.
+             *
+             * @return The number of cache hits.
+             */
+            size_t getCacheHits() const;
+
         private:
+            /**
+             * @brief This function computes the greediest action for state s.
+             */
+            Action computeAction(const State & s) const;
+
             const FactoredContainer<QFunctionRule> * qc_;
             const FactoredMatrix2D * qm_;
+
+            size_t maxCacheSize_;
+            const unsigned long * version_;
+
+            struct CacheEntry {
+                Action action;
+                std::list<State>::iterator lru;
+            };
+
+            mutable unsigned long cacheVersion_;
+            mutable size_t hits_;
+            mutable std::unordered_map<State, CacheEntry, boost::hash<State>> cache_;
+            mutable std::list<State> lru_;
     };
 }
 
@@ -73,6 +73,25 @@ namespace AIToolbox::Factored::MDP {
         MOQFunctionRule(PartialState s, PartialAction a, Rewards vs) :
                 state(std::move(s)), action(std::move(a)), values(std::move(vs)) {}
     };
+
+    /**
+     * @brief This struct represents a batch of factored transitions.
+     *
+     * The factors are stored as a structure of arrays: all values of a
+     * factor are contiguous, so that factor i of transition n is at index
+     * i * N + n, where N is the number of transitions in the batch. This
+     * allows to process a single factor of all transitions at once.
+     *
+     * The rewards contain a single value per transition. In cooperative
+     * problems with one reward per agent, they are instead stored in the
+     * same layout as the actions.
+     */
+    struct TransitionBatch {
+        std::vector<size_t> states;
+        std::vector<size_t> actions;
+        std::vector<size_t> nextStates;
+        std::vector<double> rewards;
+    };
 }
 
 #endif
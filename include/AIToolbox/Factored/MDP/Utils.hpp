@@ -15,6 +15,22 @@ namespace AIToolbox::Factored::MDP {
      * @return The QFunction resulting from the backup.
      */
     QFunction bellmanBackup(const CooperativeModel & m, const ValueFunction & v);
+
+    /**
+     * @brief This function applies a one-step backup on the input ValueFunction, reusing cached back-projections.
+     *
+     * The cache must have been created for the transition function of
+     * the model. Repeated backups of ValueFunctions with the same basis
+     * tags, like in factored value iteration, only compute the
+     * back-projections once.
+     *
+     * @param m The model used to do the backup.
+     * @param v The ValueFunction to backup.
+     * @param cache The BackProjectionCache for the model's transition function.
+     *
+     * @return The QFunction resulting from the backup.
+     */
+    QFunction bellmanBackup(const CooperativeModel & m, const ValueFunction & v, BackProjectionCache & cache);
 }
 
 #endif
@@ -0,0 +1,220 @@
+#ifndef AI_TOOLBOX_FACTORED_POMDP_FACTORED_BELIEF_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_POMDP_FACTORED_BELIEF_HEADER_FILE
+
+#include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Factored/Types.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
+
+namespace AIToolbox::Factored::POMDP {
+    /**
+     * @brief This class represents an approximate belief over a factored state space.
+     *
+     * A flat POMDP belief contains one probability per state, and updating
+     * it costs O(S^2). When the state is composed of many variables this
+     * is not feasible, since S grows exponentially with them.
+     *
+     * This class instead stores the belief as a product of independent
+     * distributions over disjoint clusters of state variables, as in the
+     * Boyen-Koller algorithm. In the simplest case each cluster contains a
+     * single variable, and the belief is the product of its marginals.
+     *
+     * Updates are done through the structure of the transition and
+     * observation DBNs. After each step, the exact posterior (which in
+     * general would couple all variables) is projected back onto the
+     * clusters, by keeping only the marginal of each. The cost of an update
+     * is linear in the number of variables, and exponential only in the
+     * size of the clusters and of the parent sets of the DBN nodes. The
+     * approximation error introduced by the projection does not accumulate
+     * over time, as long as the process mixes (see Boyen and Koller, 1998).
+     *
+     * The transition DBN maps the previous state variables to each new one.
+     * The observation DBN contains one node per observation variable: its
+     * tag contains the new state variables it depends on, and its matrix
+     * the probability of each value of the observation variable.
+     *
+     * This class can be used with POMCP-style planners by sampling states
+     * from it with sampleState(), and filling a particle belief with them.
+     */
+    class FactoredBelief {
+        public:
+            /**
+             * @brief This struct represents the distribution over a single cluster of variables.
+             *
+             * The values are indexed as in toIndexPartial(tag, space, s).
+             */
+            struct Cluster {
+                PartialKeys tag;
+                Vector values;
+            };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor creates a uniform belief where each state
+             * variable is its own cluster.
+             *
+             * @param space The factored state space.
+             */
+            FactoredBelief(Factors space);
+
+            /**
+             * @brief Cluster constructor.
+             *
+             * This constructor creates a uniform belief over the input
+             * clusters. The clusters must be sorted, and must contain each
+             * state variable exactly once; otherwise this constructor
+             * throws std::invalid_argument.
+             *
+             * @param space The factored state space.
+             * @param clusters The variables in each cluster.
+             */
+            FactoredBelief(Factors space, const std::vector<PartialKeys> & clusters);
+
+            /**
+             * @brief This function sets the distribution of a cluster.
+             *
+             * This function throws std::invalid_argument if the input is
+             * not a probability distribution over the cluster.
+             *
+             * @param i The cluster to modify.
+             * @param values The new distribution of the cluster.
+             */
+            void setDistribution(size_t i, const Vector & values);
+
+            /**
+             * @brief This function performs the transition step of the belief update.
+             *
+             * @param transitions The transition DBN of the action taken.
+             */
+            void predict(const DBN & transitions);
+
+            /**
+             * @brief This function performs the transition step of the belief update.
+             *
+             * This allows to use the DBNRef created by a CompactDDN.
+             *
+             * @param transitions The transition DBN of the action taken.
+             */
+            void predict(const DBNRef & transitions);
+
+            /**
+             * @brief This function performs the transition step of the belief update for a factored action.
+             *
+             * @param actions The factored action space.
+             * @param ddn The transition FactoredDDN.
+             * @param a The action taken.
+             */
+            void predict(const Factors & actions, const FactoredDDN & ddn, const Factors & a);
+
+            /**
+             * @brief This function conditions the belief on an observation.
+             *
+             * Each observation variable is incorporated in turn: the
+             * clusters it depends on are combined, multiplied by the
+             * likelihood of the observed value, and projected back.
+             *
+             * If the observation is impossible under the current belief,
+             * the belief is not modified and zero is returned.
+             *
+             * @param observations The observation DBN.
+             * @param o The observation received.
+             *
+             * @return The approximate probability of the observation under the belief.
+             */
+            double observe(const DBN & observations, const Factors & o);
+
+            /**
+             * @brief This function performs a full belief update.
+             *
+             * This is equivalent to predict() followed by observe().
+             *
+             * @param transitions The transition DBN of the action taken.
+             * @param observations The observation DBN.
+             * @param o The observation received.
+             *
+             * @return The approximate probability of the observation.
+             */
+            double update(const DBN & transitions, const DBN & observations, const Factors & o);
+
+            /**
+             * @brief This function returns the probability of a state.
+             *
+             * @param s The state to check.
+             *
+             * @return The probability of the state.
+             */
+            double getProbability(const Factors & s) const;
+
+            /**
+             * @brief This function returns the joint distribution over a subset of the state variables.
+             *
+             * The cost is proportional to the size of the joint space of
+             * the clusters containing the input variables.
+             *
+             * @param tag The sorted state variables to consider.
+             *
+             * @return The distribution, indexed as in toIndexPartial(tag, space, s).
+             */
+            Vector getMarginal(const PartialKeys & tag) const;
+
+            /**
+             * @brief This function samples a state from the belief.
+             *
+             * @param rnd The random engine to use.
+             *
+             * @return A state sampled from the belief.
+             */
+            template <typename Gen>
+            Factors sampleState(Gen & rnd) const;
+
+            /**
+             * @brief This function returns the factored state space.
+             */
+            const Factors & getS() const;
+
+            /**
+             * @brief This function returns the clusters of the belief.
+             */
+            const std::vector<Cluster> & getClusters() const;
+
+            /**
+             * @brief This function returns the cluster containing the input state variable.
+             *
+             * @param factor The state variable.
+             *
+             * @return The index of the cluster.
+             */
+            size_t getClusterOf(size_t factor) const;
+
+        private:
+            template <typename DBNType>
+            void predictImpl(const DBNType & transitions);
+
+            // Returns the product of the input clusters over the union of
+            // their variables, which is written in keys.
+            Vector joinClusters(const std::vector<size_t> & clusters, PartialKeys * keys) const;
+            // Returns the sorted clusters which contain any of the input variables.
+            std::vector<size_t> findClusters(const PartialKeys & tag) const;
+
+            Factors S;
+            std::vector<Cluster> clusters_;
+            std::vector<size_t> clusterOf_;
+    };
+
+    template <typename Gen>
+    Factors FactoredBelief::sampleState(Gen & rnd) const {
+        Factors s(S.size());
+        PartialValues values;
+        for (const auto & c : clusters_) {
+            const auto id = sampleProbability(c.values.size(), c.values, rnd);
+            values.resize(c.tag.size());
+            FactorSpace(S, c.tag).toFactors(id, &values);
+            for (size_t i = 0; i < c.tag.size(); ++i)
+                s[c.tag[i]] = values[i];
+        }
+        return s;
+    }
+}
+
+#endif
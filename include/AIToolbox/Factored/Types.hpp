@@ -6,6 +6,20 @@
 #include <vector>
 #include <utility>
 
+#ifdef AI_SMALL_FACTORS
+#include <boost/container/small_vector.hpp>
+#include <boost/container_hash/hash.hpp>
+
+namespace boost::container {
+    // Boost does not provide hashing for its small_vector, so we need
+    // this to use Factors as keys.
+    template <typename T, std::size_t N>
+    std::size_t hash_value(const small_vector<T, N> & v) {
+        return boost::hash_range(std::begin(v), std::end(v));
+    }
+}
+#endif
+
 namespace AIToolbox::Factored {
     /**
      * @name Factored Basic Types
@@ -59,9 +73,16 @@ namespace AIToolbox::Factored {
      * @{
      */
 
+    // Factors are usually small, so storing them inline avoids allocating
+    // memory for most of them. Note that this changes the ABI of the
+    // library, so it must be set equally for the library and its users.
+#ifdef AI_SMALL_FACTORS
+    using Factors = boost::container::small_vector<size_t, 8>;
+#else
     using Factors = std::vector<size_t>;
-    using PartialKeys = std::vector<size_t>;
-    using PartialValues = std::vector<size_t>;
+#endif
+    using PartialKeys = Factors;
+    using PartialValues = Factors;
     using PartialFactors = std::pair<PartialKeys, PartialValues>;
 
     using State = Factors;
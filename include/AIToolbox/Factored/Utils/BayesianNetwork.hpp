@@ -1,10 +1,14 @@
 #ifndef AI_TOOLBOX_FACTORED_UTILS_BAYESIAN_NETWORK_HEADER_FILE
 #define AI_TOOLBOX_FACTORED_UTILS_BAYESIAN_NETWORK_HEADER_FILE
 
+#include <map>
+
 #include <AIToolbox/Factored/Types.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
 #include <AIToolbox/Factored/Utils/FactoredMatrix.hpp>
 
+namespace AIToolbox { class ThreadPool; }
+
 namespace AIToolbox::Factored {
     /**
      * @brief This struct represents a Dynamic Bayesian Network.
@@ -59,6 +63,38 @@ namespace AIToolbox::Factored {
          */
         double getTransitionProbability(const Factors & space, const PartialFactors & s, const PartialFactors & s1) const;
 
+        /**
+         * @brief This function returns the probabilities of the transitions from one state to many others.
+         *
+         * The entry of each node which applies to the initial state is
+         * computed only once, and then used for all final states. This
+         * is much faster than calling getTransitionProbability() for each
+         * final state.
+         *
+         * @param space The factor space to use.
+         * @param s The initial factors to start with.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the probability of each transition.
+         */
+        Vector getTransitionProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const;
+
+        /**
+         * @brief This function returns the log-probabilities of the transitions from one state to many others.
+         *
+         * This function works as getTransitionProbabilities(), but sums
+         * the logarithms of the probabilities of each node. This avoids
+         * underflow for states with many factors. Impossible transitions
+         * have a log-probability of minus infinity.
+         *
+         * @param space The factor space to use.
+         * @param s The initial factors to start with.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the log-probability of each transition.
+         */
+        Vector getTransitionLogProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const;
+
         /**
          * @brief This function returns a reference to the ith DynamicBayesianNode in the network.
          *
@@ -106,6 +142,38 @@ namespace AIToolbox::Factored {
          */
         double getTransitionProbability(const Factors & space, const PartialFactors & s, const PartialFactors & s1) const;
 
+        /**
+         * @brief This function returns the probabilities of the transitions from one state to many others.
+         *
+         * The entry of each node which applies to the initial state is
+         * computed only once, and then used for all final states. This
+         * is much faster than calling getTransitionProbability() for each
+         * final state.
+         *
+         * @param space The factor space to use.
+         * @param s The initial factors to start with.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the probability of each transition.
+         */
+        Vector getTransitionProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const;
+
+        /**
+         * @brief This function returns the log-probabilities of the transitions from one state to many others.
+         *
+         * This function works as getTransitionProbabilities(), but sums
+         * the logarithms of the probabilities of each node. This avoids
+         * underflow for states with many factors. Impossible transitions
+         * have a log-probability of minus infinity.
+         *
+         * @param space The factor space to use.
+         * @param s The initial factors to start with.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the log-probability of each transition.
+         */
+        Vector getTransitionLogProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const;
+
         /**
          * @brief This function returns a reference to the ith DynamicBayesianNode in the network.
          *
@@ -132,7 +200,8 @@ namespace AIToolbox::Factored {
      *
      * We actually produce a DynamicBayesianNetworkRef which contains
      * references to the nodes, so that the construction does not require too
-     * much time nor space.
+     * much time nor space. The networks of all actions are built once, at
+     * construction, so that requesting them does not allocate.
      */
     class CompactDynamicDecisionNetwork {
         public:
@@ -164,17 +233,42 @@ namespace AIToolbox::Factored {
             );
 
             /**
-             * @brief This function constructs a DynamicBayesianNetworkRef for the specified action.
+             * @brief Copy constructor.
+             *
+             * The networks of the copy reference its own nodes.
+             *
+             * @param other The CompactDynamicDecisionNetwork to copy.
+             */
+            CompactDynamicDecisionNetwork(const CompactDynamicDecisionNetwork & other);
+
+            /**
+             * @brief Copy assignment operator.
+             *
+             * The networks of this instance are rebuilt to reference its
+             * own nodes.
+             *
+             * @param other The CompactDynamicDecisionNetwork to copy.
+             *
+             * @return This instance.
+             */
+            CompactDynamicDecisionNetwork & operator=(const CompactDynamicDecisionNetwork & other);
+
+            CompactDynamicDecisionNetwork(CompactDynamicDecisionNetwork &&) = default;
+            CompactDynamicDecisionNetwork & operator=(CompactDynamicDecisionNetwork &&) = default;
+
+            /**
+             * @brief This function returns the DynamicBayesianNetworkRef for the specified action.
              *
              * The output is a network that contains references to nodes owned
-             * by this class. Thus it is (relatively) cheap to create and to
-             * copy, but its lifetime depends on the instance that created it.
+             * by this class. It is built at construction, so this function
+             * is free, but its lifetime depends on the instance that created
+             * it.
              *
              * @param a The desired action to use.
              *
              * @return The DynamicBayesianNetworkRef for the specified action.
              */
-            DBNRef makeDiffTransition(const size_t a) const;
+            const DBNRef & makeDiffTransition(const size_t a) const;
 
             /**
              * @brief This function returns the default transition model.
@@ -189,8 +283,11 @@ namespace AIToolbox::Factored {
             const std::vector<std::vector<Node>> & getDiffNodes() const;
 
         private:
+            void buildTransitions();
+
             std::vector<std::vector<Node>> diffs_;
             DBN defaultTransition_;
+            std::vector<DBNRef> transitions_;
     };
 
     using CompactDDN = CompactDynamicDecisionNetwork;
@@ -246,6 +343,42 @@ namespace AIToolbox::Factored {
          */
         double getTransitionProbability(const Factors & space, const Factors & actions, const PartialFactors & s, const PartialFactors & a, const PartialFactors & s1) const;
 
+        /**
+         * @brief This function returns the probabilities of the transitions from one state to many others with the given action.
+         *
+         * The entry of each node which applies to the initial state and
+         * action is computed only once, and then used for all final
+         * states. This is much faster than calling
+         * getTransitionProbability() for each final state.
+         *
+         * @param space The factor space to use.
+         * @param actions The action space to use.
+         * @param s The initial factors to start with.
+         * @param a The selected action for the transition.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the probability of each transition.
+         */
+        Vector getTransitionProbabilities(const Factors & space, const Factors & actions, const Factors & s, const Factors & a, const std::vector<Factors> & s1s) const;
+
+        /**
+         * @brief This function returns the log-probabilities of the transitions from one state to many others with the given action.
+         *
+         * This function works as getTransitionProbabilities(), but sums
+         * the logarithms of the probabilities of each node. This avoids
+         * underflow for states with many factors. Impossible transitions
+         * have a log-probability of minus infinity.
+         *
+         * @param space The factor space to use.
+         * @param actions The action space to use.
+         * @param s The initial factors to start with.
+         * @param a The selected action for the transition.
+         * @param s1s The factors we could end up with.
+         *
+         * @return A Vector with the log-probability of each transition.
+         */
+        Vector getTransitionLogProbabilities(const Factors & space, const Factors & actions, const Factors & s, const Factors & a, const std::vector<Factors> & s1s) const;
+
         /**
          * @brief This function returns a reference to the ith DynamicBayesianNode in the network.
          *
@@ -260,10 +393,112 @@ namespace AIToolbox::Factored {
 
     BasisFunction backProject(const Factors & space, const DBN & dbn, const BasisFunction & bf);
     BasisFunction backProject(const Factors & space, const DBNRef & dbn, const BasisFunction & bf);
-    FactoredVector backProject(const Factors & space, const DBN & dbn, const FactoredVector & fv);
-    FactoredVector backProject(const Factors & space, const DBNRef & dbn, const FactoredVector & fv);
     BasisMatrix backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const BasisFunction & bf);
-    FactoredMatrix2D backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const FactoredVector & fv);
+
+    // The bases of a FactoredVector are back-projected independently. If a
+    // ThreadPool is passed, they are split between its threads; the result
+    // does not depend on the number of threads.
+    FactoredVector backProject(const Factors & space, const DBN & dbn, const FactoredVector & fv, ThreadPool * pool = nullptr);
+    FactoredVector backProject(const Factors & space, const DBNRef & dbn, const FactoredVector & fv, ThreadPool * pool = nullptr);
+    FactoredMatrix2D backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const FactoredVector & fv, ThreadPool * pool = nullptr);
+
+    // This back-projects a FactoredVector through the network of each action
+    // of a CompactDDN, and returns one FactoredVector per action. Bases which
+    // do not contain any of the nodes changed by an action are back-projected
+    // once through the default transition, and the result is shared between
+    // all these actions.
+    std::vector<FactoredVector> backProject(const Factors & space, const CompactDDN & ddn, const FactoredVector & fv, ThreadPool * pool = nullptr);
+
+    /**
+     * @brief This class caches the back-projections of BasisFunctions through a FactoredDDN.
+     *
+     * The back-projection of a BasisFunction is linear in its values, and
+     * its structure only depends on the tag of the basis and on the DDN
+     * nodes of the factors in it. This class computes, once per tag, the
+     * matrix which maps the values of a basis to the values of its
+     * back-projection. Further back-projections of bases with the same
+     * tag, whatever their values, only cost a matrix-vector product.
+     *
+     * This is useful when the same bases are back-projected many times
+     * with different values, as in factored value iteration.
+     *
+     * The cache keeps a reference to the DDN. If the DDN is modified, the
+     * cache must be notified with invalidate() or clear(), otherwise it
+     * will return stale results.
+     */
+    class BackProjectionCache {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The spaces are copied, while the DDN is referenced and must
+             * outlive this instance.
+             *
+             * @param space The factor space to use.
+             * @param actions The action space to use.
+             * @param ddn The FactoredDDN to back-project through.
+             */
+            BackProjectionCache(Factors space, Factors actions, const FactoredDDN & ddn);
+
+            /**
+             * @brief This function returns the back-projection of the input BasisFunction.
+             *
+             * The result is equal, up to floating point rounding, to
+             * backProject(space, actions, ddn, bf).
+             *
+             * @param bf The BasisFunction to back-project.
+             *
+             * @return The back-projected BasisMatrix.
+             */
+            BasisMatrix operator()(const BasisFunction & bf);
+
+            /**
+             * @brief This function returns the back-projection of each basis of the input FactoredVector.
+             *
+             * @param fv The FactoredVector to back-project.
+             *
+             * @return The back-projected FactoredMatrix2D.
+             */
+            FactoredMatrix2D operator()(const FactoredVector & fv);
+
+            /**
+             * @brief This function removes the cached entries which depend on the input state factor.
+             *
+             * This must be called after modifying the DDN node of the
+             * factor.
+             *
+             * @param factor The state factor whose DDN node has changed.
+             */
+            void invalidate(size_t factor);
+
+            /**
+             * @brief This function removes all cached entries.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the number of cached tags.
+             *
+             * @return The number of cached tags.
+             */
+            size_t size() const;
+
+        private:
+            struct Entry {
+                PartialKeys tag;
+                PartialKeys actionTag;
+                // Maps the values of a basis to the values of its
+                // back-projection, flattened in row-major order.
+                Matrix2D projection;
+                size_t actionSize;
+            };
+
+            const Entry & getEntry(const PartialKeys & tag);
+
+            Factors space_, actions_;
+            const FactoredDDN & ddn_;
+            std::map<PartialKeys, Entry> cache_;
+    };
 }
 
 #endif
@@ -431,6 +431,100 @@ namespace AIToolbox::Factored {
      */
     size_t toIndexPartial(const Factors & space, const PartialFactors & f);
 
+    /**
+     * @brief This class caches the strides needed to convert factors of a space to indeces.
+     *
+     * The toIndex() and toIndexPartial() functions recompute the stride of
+     * each factor at every call, and toIndexPartial() must additionally
+     * search the keys of its PartialFactors input. When many factors with
+     * the same keys need to be converted, as when enumerating a space, this
+     * class computes the strides once.
+     *
+     * The class is built from the keys which take part in the index, and
+     * from a second, sorted, superset of keys the inputs are aligned with.
+     * Inputs can then be passed as plain vectors of values for those keys,
+     * for example the values of a PartialFactorsEnumerator over them.
+     * Keys which do not take part in the index have a stride of zero.
+     *
+     * Indeces are the same as returned by toIndexPartial(const PartialKeys &,
+     * const Factors &, const PartialFactors &), i.e. the lowest key
+     * varies fastest.
+     */
+    class FactorSpace {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor aligns the input on all factors of the space.
+             *
+             * @param space The factor space.
+             */
+            FactorSpace(const Factors & space);
+
+            /**
+             * @brief This constructor aligns the input on the same keys which take part in the index.
+             *
+             * @param space The factor space.
+             * @param keys The sorted keys which take part in the index.
+             */
+            FactorSpace(const Factors & space, const PartialKeys & keys);
+
+            /**
+             * @brief This constructor aligns the input on a superset of the keys which take part in the index.
+             *
+             * @param space The factor space.
+             * @param keys The sorted keys which take part in the index.
+             * @param inputKeys The sorted keys of the input values, which must include all keys.
+             */
+            FactorSpace(const Factors & space, const PartialKeys & keys, const PartialKeys & inputKeys);
+
+            /**
+             * @brief This function converts the input values to an unique index.
+             *
+             * @param values The values of the input keys.
+             *
+             * @return An integer which uniquely identifies the values for the keys.
+             */
+            size_t toIndex(const PartialValues & values) const;
+
+            /**
+             * @brief This function converts an unique index back to values.
+             *
+             * This function is the inverse of toIndex(). Values of input
+             * keys which do not take part in the index are not modified.
+             *
+             * @param id The index to convert.
+             * @param values The output values, which must have one element per input key.
+             */
+            void toFactors(size_t id, PartialValues * values) const;
+
+            /**
+             * @brief This function returns the number of possible indeces.
+             *
+             * @return The size of the space restricted to the keys.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the stride of each input key.
+             *
+             * @return The strides, zero for keys which do not take part in the index.
+             */
+            const std::vector<size_t> & getStrides() const;
+
+        private:
+            Factors space_;
+            std::vector<size_t> strides_;
+            size_t size_;
+    };
+
+    inline size_t FactorSpace::toIndex(const PartialValues & values) const {
+        size_t result = 0;
+        for (size_t i = 0; i < strides_.size(); ++i)
+            result += strides_[i] * values[i];
+        return result;
+    }
+
     /**
      * @brief This class enumerates all possible values for a PartialFactors.
      *
@@ -448,6 +542,16 @@ namespace AIToolbox::Factored {
      * (1,1)
      * (0,2)
      * (1,2)
+     *
+     * The enumerator can additionally keep track of the indeces of the
+     * current values in any number of subspaces of the enumerated keys
+     * (see addTarget()). Since each advance() changes on average less than
+     * two values, these indeces are updated in constant amortized time,
+     * rather than being recomputed from the values at each step.
+     *
+     * Finally, the enumeration can be restricted to a contiguous range of
+     * its steps (see setRange()), so that a large enumeration can be split
+     * in chunks and processed in parallel, each by its own enumerator.
      */
     class PartialFactorsEnumerator {
         public:
@@ -541,10 +645,74 @@ namespace AIToolbox::Factored {
             /**
              * @brief This function returns the number of times that advance() can be called from the initial state.
              *
+             * This does not take into account the range set with
+             * setRange(), if any.
+             *
              * Warning: This operation is *NOT* cheap, as this number needs to be computed.
              */
             size_t size() const;
 
+            /**
+             * @brief This function restricts the enumeration to the steps in [begin, end).
+             *
+             * Steps are numbered in the order in which they are normally
+             * enumerated, starting from zero. After this call, the
+             * enumerator is positioned on step begin, as if advance() had
+             * been called begin times after a reset(), and it becomes
+             * invalid once it reaches step end. The end is clamped to
+             * size(). The factorToSkip, if any, is set to zero. Further
+             * calls to reset() return to step begin.
+             *
+             * This allows to split an enumeration between threads, by
+             * giving each a copy of the enumerator with a different range.
+             *
+             * @param begin The first step to enumerate.
+             * @param end The step after the last one to enumerate.
+             */
+            void setRange(size_t begin, size_t end);
+
+            /**
+             * @brief This function returns the number of the current step of the enumeration.
+             *
+             * This is the number of times advance() has been called since
+             * the beginning of the enumeration, plus the beginning of the
+             * range if one has been set.
+             *
+             * @return The current step.
+             */
+            size_t getStep() const;
+
+            /**
+             * @brief This function adds a subspace whose index is kept updated during the enumeration.
+             *
+             * The keys must be sorted, and a subset of the keys being
+             * enumerated. The index of the current values in the subspace
+             * of the keys is the same as the one returned by
+             * toIndexPartial(keys, f, **this), and can be read with
+             * getIndex().
+             *
+             * The index includes the value of the factorToSkip, if it is
+             * in the keys, even if it has been edited by the client.
+             * Edits to other values are not tracked.
+             *
+             * @param keys The keys of the subspace.
+             *
+             * @return The id of the new target, to pass to getIndex().
+             */
+            size_t addTarget(const PartialKeys & keys);
+
+            /**
+             * @brief This function returns the index of the current values in a target subspace.
+             *
+             * This operator can be called only if isValid() is true.
+             * Otherwise behavior is undefined.
+             *
+             * @param target The id of the target returned by addTarget().
+             *
+             * @return The index of the current values in the target subspace.
+             */
+            size_t getIndex(size_t target) const;
+
             /**
              * @brief This operator returns the current iteration in the values of the PartialFactors.
              *
@@ -580,10 +748,28 @@ namespace AIToolbox::Factored {
             PartialFactors* operator->();
 
         private:
+            /**
+             * @brief This function sets the values and target indeces to the input step.
+             */
+            void seek(size_t step);
+
             Factors F;
             PartialFactors factors_;
             size_t factorToSkipId_;
+
+            size_t step_, begin_, end_;
+            // For each target, the stride of each enumerated value.
+            std::vector<std::vector<size_t>> strides_;
+            // For each target, its index without the factorToSkip.
+            std::vector<size_t> indeces_;
     };
+
+    inline size_t PartialFactorsEnumerator::getIndex(const size_t target) const {
+        const auto & values = factors_.second;
+        if (factorToSkipId_ < values.size())
+            return indeces_[target] + strides_[target][factorToSkipId_] * values[factorToSkipId_];
+        return indeces_[target];
+    }
 }
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef AI_TOOLBOX_FACTORED_ELIMINATION_ORDER_HEADER_FILE
+#define AI_TOOLBOX_FACTORED_ELIMINATION_ORDER_HEADER_FILE
+
+#include <vector>
+
+#include <AIToolbox/Factored/Types.hpp>
+#include <AIToolbox/Factored/Utils/FactorGraph.hpp>
+
+namespace AIToolbox::Factored {
+    /**
+     * @brief This class computes the order in which to eliminate the variables of a FactorGraph.
+     *
+     * Eliminating a variable joins all factors adjacent to it into a single
+     * factor over all its neighbors. The cost of variable elimination is
+     * exponential in the size of the largest factor created this way, which
+     * depends heavily on the order in which variables are eliminated.
+     *
+     * Finding the best order is NP-hard, so this class uses one of several
+     * greedy heuristics. At each step the variable with the lowest score is
+     * eliminated, and the score is:
+     *
+     * - Reverse: no score, variables are eliminated from the last to the
+     *   first. This is the fastest to compute.
+     * - MinDegree: the number of neighbors of the variable.
+     * - MinFill: the number of pairs of neighbors which are not already
+     *   neighbors of each other, i.e. the number of edges that the
+     *   elimination adds to the graph.
+     * - WeightedMinFill: as MinFill, but each added edge is weighted by the
+     *   product of the sizes of the two variables it joins.
+     *
+     * Ties are broken in favour of the variable with the highest index.
+     *
+     * The order only depends on which variables each factor is adjacent to.
+     * The last computed order is cached together with this topology, so that
+     * repeated calls on graphs with the same topology are free.
+     */
+    class EliminationOrder {
+        public:
+            enum class Heuristic { Reverse, MinDegree, MinFill, WeightedMinFill };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param sizes The size of each variable, which is used by the WeightedMinFill heuristic.
+             * @param heuristic The heuristic to use.
+             */
+            EliminationOrder(Factors sizes, Heuristic heuristic = Heuristic::Reverse);
+
+            /**
+             * @brief This function returns the elimination order for the input graph.
+             *
+             * The graph must contain all variables it was constructed
+             * with, i.e. no variable must have been erased.
+             *
+             * @param graph The graph to compute the order for.
+             *
+             * @return The variables in the order they should be eliminated.
+             */
+            template <typename Factor>
+            const std::vector<size_t> & operator()(const FactorGraph<Factor> & graph);
+
+            /**
+             * @brief This function returns the elimination order for the input topology.
+             *
+             * @param factors The variables adjacent to each factor, sorted.
+             *
+             * @return The variables in the order they should be eliminated.
+             */
+            const std::vector<size_t> & operator()(std::vector<PartialKeys> factors);
+
+            /**
+             * @brief This function sets the heuristic to use.
+             *
+             * This clears the cached order.
+             *
+             * @param heuristic The new heuristic.
+             */
+            void setHeuristic(Heuristic heuristic);
+
+            /**
+             * @brief This function returns the currently set heuristic.
+             *
+             * @return The currently set heuristic.
+             */
+            Heuristic getHeuristic() const;
+
+            /**
+             * @brief This function returns the sizes of the variables.
+             *
+             * @return The sizes of the variables.
+             */
+            const Factors & getSizes() const;
+
+            /**
+             * @brief This function returns the number of orders computed so far.
+             *
+             * Calls which return the cached order are not counted.
+             *
+             * @return The number of orders computed.
+             */
+            size_t getComputeCount() const;
+
+        private:
+            /**
+             * @brief This function computes the order for the cached topology.
+             */
+            void compute();
+
+            Factors sizes_;
+            Heuristic heuristic_;
+
+            std::vector<PartialKeys> topology_;
+            std::vector<size_t> order_;
+            size_t computes_;
+    };
+
+    template <typename Factor>
+    const std::vector<size_t> & EliminationOrder::operator()(const FactorGraph<Factor> & graph) {
+        std::vector<PartialKeys> factors;
+        factors.reserve(graph.factorSize());
+        for (const auto & f : graph)
+            factors.push_back(f.getVariables());
+
+        return (*this)(std::move(factors));
+    }
+}
+
+#endif
@@ -23,6 +23,12 @@ namespace AIToolbox::Factored {
      * variables. When multiple factors are needed, a single Factor containing
      * a vector of data should suffice.
      *
+     * Factors are never deallocated while the graph exists. Erased factors
+     * are moved to an internal pool, and are reused when a factor with the
+     * same variables is requested again. Together with reset(), this allows
+     * to build and tear down graphs with the same topology repeatedly
+     * without allocating list nodes or lookup entries each time.
+     *
      * @tparam Factor The Factor class that is stored for each factor.
      */
     template <typename Factor>
@@ -38,6 +44,7 @@ namespace AIToolbox::Factored {
 
                 Factor f_;
                 Variables variables_;
+                size_t generation_;
 
                 public:
                     const Variables & getVariables() const { return variables_; }
@@ -120,7 +127,10 @@ namespace AIToolbox::Factored {
              * times with the same input, as only one factor will be
              * created.
              *
-             * As factors are kept in a list, insertion is O(1).
+             * As factors are kept in a list, insertion is O(1). If a
+             * factor with the same variables was created and then erased
+             * (or reset()) before, its memory is reused, and its data is
+             * reset to a default constructed Factor.
              *
              * @param variables The variables the factor returned should be adjacent of.
              *
@@ -132,7 +142,8 @@ namespace AIToolbox::Factored {
              * @brief This function removes a factor from the graph.
              *
              * This function is very fast as the factors are kept in a
-             * list, so removal is O(1).
+             * list, so removal is O(1). The factor is not deallocated,
+             * but kept for reuse by getFactor(const Variables &).
              *
              * @param it An iterator to the factor to be removed.
              */
@@ -174,6 +185,19 @@ namespace AIToolbox::Factored {
              */
             size_t variableSize() const;
 
+            /**
+             * @brief This function restores the graph to its state after construction.
+             *
+             * All factors are removed, and all variables are restored.
+             * No memory is freed: the removed factors are kept so they can
+             * be reused by getFactor(const Variables &), so that graphs
+             * with the same topology can be rebuilt without allocations.
+             *
+             * Removing the factors is O(1), while restoring the variables
+             * is linear in their number.
+             */
+            void reset();
+
             /**
              * @brief This function returns the number of factors still in the graph.
              *
@@ -233,14 +257,18 @@ namespace AIToolbox::Factored {
 
         private:
             FactorList factorAdjacencies_;
+            // Erased factors, kept for reuse. A factor is in the graph only
+            // if its generation matches the one of the graph.
+            FactorList factorPool_;
             std::unordered_map<Variables, FactorIt, boost::hash<Variables>> factorByVariables_;
+            size_t generation_;
 
             VariableList variableAdjacencies_;
             size_t activeVariables_;
     };
 
     template <typename Factor>
-    FactorGraph<Factor>::FactorGraph(size_t variables) : variableAdjacencies_(variables), activeVariables_(variables) {}
+    FactorGraph<Factor>::FactorGraph(size_t variables) : generation_(1), variableAdjacencies_(variables), activeVariables_(variables) {}
 
     template <typename Factor>
     const typename FactorGraph<Factor>::FactorItList & FactorGraph<Factor>::getNeighbors(const size_t variable) const {
@@ -272,18 +300,27 @@ namespace AIToolbox::Factored {
 
     template <typename Factor>
     typename FactorGraph<Factor>::FactorIt FactorGraph<Factor>::getFactor(const Variables & variables) {
+        FactorIt it;
         const auto found = factorByVariables_.find(variables);
-        if (found != factorByVariables_.end())
-            return found->second;
-
-        factorAdjacencies_.emplace_back(FactorNode());
-        auto it = --factorAdjacencies_.end();
-
-        it->variables_ = variables;
+        if (found != factorByVariables_.end()) {
+            it = found->second;
+            if (it->generation_ == generation_)
+                return it;
+
+            // Reuse the erased factor.
+            factorAdjacencies_.splice(std::end(factorAdjacencies_), factorPool_, it);
+            it->f_ = Factor();
+        } else {
+            factorAdjacencies_.emplace_back(FactorNode());
+            it = --factorAdjacencies_.end();
+
+            it->variables_ = variables;
+            factorByVariables_.emplace(variables, it);
+        }
+        it->generation_ = generation_;
         for (const auto a : variables)
             variableAdjacencies_[a].factors_.push_back(it);
 
-        factorByVariables_[variables] = it;
         return it;
     }
 
@@ -294,8 +331,8 @@ namespace AIToolbox::Factored {
             const auto foundIt = std::find(std::begin(factors), std::end(factors), it);
             if (foundIt != std::end(factors)) factors.erase(foundIt);
         }
-        factorByVariables_.erase(it->variables_);
-        factorAdjacencies_.erase(it);
+        it->generation_ = 0;
+        factorPool_.splice(std::end(factorPool_), factorAdjacencies_, it);
     }
 
     template <typename Factor>
@@ -304,6 +341,17 @@ namespace AIToolbox::Factored {
         --activeVariables_;
     }
 
+    template <typename Factor>
+    void FactorGraph<Factor>::reset() {
+        // Bumping the generation marks all factors as erased at once.
+        ++generation_;
+        factorPool_.splice(std::end(factorPool_), factorAdjacencies_);
+
+        for (auto & v : variableAdjacencies_)
+            v.factors_.clear();
+        activeVariables_ = variableAdjacencies_.size();
+    }
+
     template <typename Factor>
     size_t FactorGraph<Factor>::variableSize() const  { return activeVariables_; }
     template <typename Factor>
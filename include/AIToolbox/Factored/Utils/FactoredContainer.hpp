@@ -3,6 +3,7 @@
 
 #include <AIToolbox/Factored/Types.hpp>
 #include <AIToolbox/Utils/IndexMap.hpp>
+#include <AIToolbox/Utils/MemoryUsage.hpp>
 
 namespace AIToolbox::Factored {
     /**
@@ -20,6 +21,12 @@ namespace AIToolbox::Factored {
      * This data structure can then be filtered by Factors, and it will
      * match the Factors against all the PartialFactors that completely
      * match it.
+     *
+     * For each factor, the ids of all keys are stored in a single array,
+     * grouped by the value of the key at that factor (with keys that do
+     * not specify it at the end). Filtering intersects one or two
+     * contiguous ranges per factor, so when the results are written in a
+     * caller-provided buffer no memory needs to be allocated.
      */
     class Trie {
         public:
@@ -76,6 +83,13 @@ namespace AIToolbox::Factored {
              */
             size_t size() const;
 
+            /**
+             * @brief This function returns the heap memory used by the Trie, in bytes.
+             *
+             * @return The memory allocated by the Trie.
+             */
+            size_t getMemoryUsage() const;
+
             /**
              * @brief This function returns all ids where their key matches the input Factors.
              *
@@ -124,6 +138,31 @@ namespace AIToolbox::Factored {
              */
             std::vector<size_t> filter(const PartialFactors & pf) const;
 
+            /**
+             * @brief This function writes all ids where their key matches the input Factors in the input buffer.
+             *
+             * This function is equivalent to filter(const Factors &, size_t),
+             * but reuses the memory of the buffer. The buffer is cleared
+             * before writing into it.
+             *
+             * @param f The Factors used as filter in the trie.
+             * @param offset The offset for each factor in the input.
+             * @param ids The output buffer for the matching ids.
+             */
+            void filter(const Factors & f, size_t offset, std::vector<size_t> * ids) const;
+
+            /**
+             * @brief This function writes all ids where their key matches the input PartialFactors in the input buffer.
+             *
+             * This function is equivalent to filter(const PartialFactors &),
+             * but reuses the memory of the buffer. The buffer is cleared
+             * before writing into it.
+             *
+             * @param pf The PartialFactors used as filter in the trie.
+             * @param ids The output buffer for the matching ids.
+             */
+            void filter(const PartialFactors & pf, std::vector<size_t> * ids) const;
+
         private:
             Factors F;
             size_t counter_;
@@ -148,6 +187,8 @@ namespace AIToolbox::Factored {
             using ItemsContainer = std::vector<T>;
             using Iterable = IndexMap<std::vector<size_t>, ItemsContainer>;
             using ConstIterable = IndexMap<std::vector<size_t>, const ItemsContainer>;
+            using BufferedIterable = IndexSpan<ItemsContainer>;
+            using ConstBufferedIterable = IndexSpan<const ItemsContainer>;
 
             /**
              * @brief Basic constructor.
@@ -266,6 +307,79 @@ namespace AIToolbox::Factored {
                 return ConstIterable(ids_.filter(pf), items_);
             }
 
+            /**
+             * @brief This function creates an iterable object over all values matching the input key, using the input buffer.
+             *
+             * The ids of the matching values are written in the buffer,
+             * which is referenced by the returned object. This avoids
+             * allocating memory if the buffer is reused between calls.
+             * The buffer must outlive the returned object, and must not
+             * be modified while the object is in use.
+             *
+             * The returned IndexSpan iterates directly over the buffer,
+             * without any bound checks, since the ids written by the Trie
+             * are always valid. Its items can also be copied in
+             * contiguous memory with gather().
+             *
+             * \sa Trie::filter(const Factors&, size_t, std::vector<size_t>*)
+             *
+             * @param f The key that must be matched.
+             * @param offset The offset of the key, if smaller than the factor space.
+             * @param buffer The buffer where to store the ids of the matching values.
+             *
+             * @return An iterable object over all values matching the input.
+             */
+            BufferedIterable filter(const Factors & f, size_t offset, std::vector<size_t> * buffer) {
+                ids_.filter(f, offset, buffer);
+                return BufferedIterable(*buffer, items_);
+            }
+
+            /**
+             * @brief This function creates an iterable object over all values matching the input key, using the input buffer.
+             *
+             * \sa filter(const Factors&, size_t, std::vector<size_t>*)
+             *
+             * @param f The key that must be matched.
+             * @param offset The offset of the key, if smaller than the factor space.
+             * @param buffer The buffer where to store the ids of the matching values.
+             *
+             * @return An iterable object over all values matching the input.
+             */
+            ConstBufferedIterable filter(const Factors & f, size_t offset, std::vector<size_t> * buffer) const {
+                ids_.filter(f, offset, buffer);
+                return ConstBufferedIterable(*buffer, items_);
+            }
+
+            /**
+             * @brief This function creates an iterable object over all values matching the input key, using the input buffer.
+             *
+             * \sa filter(const Factors&, size_t, std::vector<size_t>*)
+             *
+             * @param pf The key that must be matched.
+             * @param buffer The buffer where to store the ids of the matching values.
+             *
+             * @return An iterable object over all values matching the input.
+             */
+            BufferedIterable filter(const PartialFactors & pf, std::vector<size_t> * buffer) {
+                ids_.filter(pf, buffer);
+                return BufferedIterable(*buffer, items_);
+            }
+
+            /**
+             * @brief This function creates an iterable object over all values matching the input key, using the input buffer.
+             *
+             * \sa filter(const Factors&, size_t, std::vector<size_t>*)
+             *
+             * @param pf The key that must be matched.
+             * @param buffer The buffer where to store the ids of the matching values.
+             *
+             * @return An iterable object over all values matching the input.
+             */
+            ConstBufferedIterable filter(const PartialFactors & pf, std::vector<size_t> * buffer) const {
+                ids_.filter(pf, buffer);
+                return ConstBufferedIterable(*buffer, items_);
+            }
+
             /**
              * @brief This function reserves the specified space to avoid reallocations.
              *
@@ -374,6 +488,18 @@ namespace AIToolbox::Factored {
                 return ids_;
             }
 
+            /**
+             * @brief This function returns the heap memory used by the container, in bytes.
+             *
+             * This includes the underlying Trie, and the heap memory of
+             * the items if their type is known to heapUsage().
+             *
+             * @return The memory allocated by the container.
+             */
+            size_t getMemoryUsage() const {
+                return ids_.getMemoryUsage() + heapUsage(items_);
+            }
+
         private:
             Trie ids_;
             ItemsContainer items_;
@@ -1,25 +1,44 @@
 #ifndef AI_TOOLBOX_IMPL_CASSANDRA_PARSER_HEADER_FILE
 #define AI_TOOLBOX_IMPL_CASSANDRA_PARSER_HEADER_FILE
 
+#include <AIToolbox/Types.hpp>
+
+#include <iosfwd>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 #include <unordered_map>
-#include <functional>
 
 namespace AIToolbox::Impl {
+    /**
+     * @brief This class parses MDPs and POMDPs in Cassandra's format.
+     *
+     * The input is processed one line at a time: lines are split into
+     * std::string_view tokens without copying them, and numbers are read
+     * directly from the tokens, without going through streams. Entries are
+     * stored as sparse triplets, one list per action and function, so that
+     * memory is proportional to the number of values actually written in
+     * the input, rather than to the size of the dense tables.
+     *
+     * Entries can overwrite previous ones, as the format prescribes. Zero
+     * values are thus kept when they may overwrite something, and only
+     * removed when the final sparse matrices are built.
+     *
+     * The preamble (states, actions, observations, discount) should come
+     * before any entry; lines found before it is complete are buffered
+     * until the sizes of the problem are known.
+     */
     class CassandraParser {
         private:
-            using DumbMatrix1D = std::vector<double>;
-            using DumbMatrix2D = std::vector<DumbMatrix1D>;
-            using DumbMatrix3D = std::vector<DumbMatrix2D>;
-
             using IDMap = std::unordered_map<std::string, size_t>;
-            using ActionMap = std::unordered_map<std::string, std::function<void(const std::string &)>>;
-
-            using MDPVals = std::tuple<size_t, size_t, const DumbMatrix3D &, const DumbMatrix3D &, double>;
-            using POMDPVals = std::tuple<size_t, size_t, size_t, const DumbMatrix3D &, const DumbMatrix3D &, const DumbMatrix3D &, double>;
+            using Triplets = std::vector<Eigen::Triplet<double>>;
+            using Tokens = std::vector<std::string_view>;
 
-            using Tokens = std::vector<std::string>;
+            // Functions are returned one matrix per action: T[a](s, s1),
+            // R[a](s, s1), W[a](s1, o).
+            using MDPVals = std::tuple<size_t, size_t, SparseMatrix3D, SparseMatrix3D, double>;
+            using POMDPVals = std::tuple<size_t, size_t, size_t, SparseMatrix3D, SparseMatrix3D, SparseMatrix3D, double>;
 
         public:
             /**
@@ -37,7 +56,7 @@ namespace AIToolbox::Impl {
              * Any problems during parsing result in an std::runtime_error.
              *
              * The output is returned as a set of values which if needed can be
-             * used to build an MDP::Model.
+             * used to build an MDP::Model or MDP::SparseModel.
              *
              * No checks are done here regarding the consistency of the read
              * data (transition probabilities, etc).
@@ -58,7 +77,7 @@ namespace AIToolbox::Impl {
              * Any problems during parsing result in an std::runtime_error.
              *
              * The output is returned as a set of values which if needed can be
-             * used to build an POMDP::Model.
+             * used to build an POMDP::Model or POMDP::SparseModel.
              *
              * No checks are done here regarding the consistency of the read
              * data (transition probabilities, etc).
@@ -69,25 +88,46 @@ namespace AIToolbox::Impl {
              */
             POMDPVals parsePOMDP(std::istream & input);
 
-        private:
             /**
-             * @brief This function parses the preamble from the input.
+             * @brief This function checks that all rows of the input matrices are probability distributions.
+             *
+             * This function throws an std::invalid_argument with the input
+             * message if any row does not sum to one or contains negative
+             * values.
              *
-             * This function is called for both MDPs and POMDPs, and parses all it can, without caring what it finds and what it does not.
+             * @param M The matrices to check.
+             * @param message The message of the exception.
+             */
+            static void checkProbabilities(const SparseMatrix3D & M, const char * message);
+
+        private:
+            /**
+             * @brief This function parses the whole input.
              *
              * @param input The input stream to parse.
+             * @param pomdp Whether we are parsing a POMDP.
              */
-            void parseModelInfo(std::istream & input);
+            void parse(std::istream & input, bool pomdp);
 
             /**
-             * @brief This function zeroes an input dumb matrix to the given dimensions.
+             * @brief This function reads the next non-empty line.
+             *
+             * The returned view is valid until the next call.
+             *
+             * @param line The output line, trimmed.
+             *
+             * @return Whether a line was found.
              */
-            void initMatrix(DumbMatrix3D & M, size_t D1, size_t D2, size_t D3);
+            bool nextLine(std::string_view * line);
 
             /**
-             * @brief This function zeroes the local function matrices from read data.
+             * @brief This function processes the line if it belongs to the preamble.
+             *
+             * @param line The line to process.
+             *
+             * @return Whether the line belonged to the preamble.
              */
-            void initMatrices();
+            bool processPreamble(std::string_view line);
 
             /**
              * @brief This function extracts ids from numbers or string tokens.
@@ -97,17 +137,25 @@ namespace AIToolbox::Impl {
              *
              * @return The number of tokens parsed.
              */
-            size_t extractIDs(const std::string & line, IDMap & map);
+            size_t extractIDs(std::string_view line, IDMap & map);
 
             /**
              * @brief This function splits the input string into tokens, divided by the input character list.
              *
              * @param str The string to split.
              * @param list The list of characters to split tokens.
+             * @param tokens The output tokens, which are cleared first.
+             */
+            static void tokenize(std::string_view str, const char * list, Tokens * tokens);
+
+            /**
+             * @brief This function parses a number, which must span the whole string.
              *
-             * @return The list of obtained tokens.
+             * @param str The string containing only the number.
+             *
+             * @return The parsed number.
              */
-            Tokens tokenize(const std::string & str, const char * list);
+            static double parseNumber(std::string_view str);
 
             /**
              * @brief This function returns which indeces to set when parsing matrix declarations.
@@ -115,39 +163,33 @@ namespace AIToolbox::Impl {
              * It can handle both '*' specifications, and string specifications
              * which use named tokens declared in the preamble.
              *
+             * Since an entry either refers to a single index or to all of
+             * them, the result is returned as a [begin, end) range.
+             *
              * @param str The string that contains the indeces.
              * @param map The map that contains the string representations of the tokens.
              * @param max The max number that is allowed to be parsed.
              *
-             * @return The list of indeces that apply.
+             * @return The range of indeces that apply.
              */
-            std::vector<size_t> parseIndeces(const std::string & str, const IDMap & map, size_t max);
+            static std::pair<size_t, size_t> parseIndeces(std::string_view str, const IDMap & map, size_t max);
 
             /**
-             * @brief This function parses a vector of length N from the inputs.
-             *
-             * This function does a simple conversion of token to double.
+             * @brief This function parses a vector of length N from the input tokens.
              *
              * @param begin The beginning of the range.
              * @param end The end of the range.
              * @param N The number of tokens to parse.
-             *
-             * @return A vector with the parsed numbers.
              */
-            DumbMatrix1D parseVector(Tokens::const_iterator begin, Tokens::const_iterator end, size_t N);
+            void parseVector(Tokens::const_iterator begin, Tokens::const_iterator end, size_t N);
 
             /**
-             * @brief This function parses a vector of length N from the input string.
-             *
-             * This function assumes that the elements of the vector are
-             * separated by space.
+             * @brief This function adds a value to the triplets of the input action.
              *
-             * @param str The string to be parsed.
-             * @param N The number of tokens to extract.
-             *
-             * @return The parsed vector.
+             * Zeroes are skipped if the triplets were empty before the
+             * current entry, as they can't overwrite anything.
              */
-            DumbMatrix1D parseVector(const std::string & str, size_t N);
+            void addValue(std::vector<Triplets> & M, size_t a, size_t d1, size_t d3, double val);
 
             /**
              * @brief This function parses an entry for a specific matrix.
@@ -158,33 +200,61 @@ namespace AIToolbox::Impl {
              * Since both are indexed by action in the same way, we don't need
              * input for that.
              *
-             * @param M The matrix to be read in.
+             * @param line The first line of the entry.
+             * @param M The triplets to be written.
+             * @param D1 The size of the first dimension of the matrix.
+             * @param D3 The size of the last dimension of the matrix.
              * @param d1map The list of id string tokens for the first dimension of the matrix.
-             * @param d3map The list of id string tokens for the first dimension of the matrix.
+             * @param d3map The list of id string tokens for the last dimension of the matrix.
              */
-            void processMatrix(DumbMatrix3D & M, const IDMap & d1map, const IDMap & d3map);
+            void processMatrix(std::string_view line, std::vector<Triplets> & M, size_t D1, size_t D3, const IDMap & d1map, const IDMap & d3map);
 
             /**
              * @brief This function processes a reward function entry.
              *
              * We only support entries that do not specify observations, and
              * thus, per syntax, must specify values one by one.
+             *
+             * @param line The line of the entry.
              */
-            void processReward();
+            void processReward(std::string_view line);
 
-            // Storage for lines which are not empty and not used in the preamble.
-            std::vector<std::string> lines_;
-            size_t i_;
+            /**
+             * @brief This function marks the start of a new entry.
+             *
+             * This records which triplet lists already contained values, so
+             * that addValue() knows whether it can skip zeroes.
+             */
+            void startEntry(const std::vector<Triplets> & M);
+
+            /**
+             * @brief This function builds the sparse matrices from the input triplets.
+             *
+             * Duplicate entries are resolved by keeping the last one, and
+             * zeroes are removed.
+             */
+            static SparseMatrix3D makeMatrices(std::vector<Triplets> & M, size_t D1, size_t D3);
+
+            // The stream being parsed, and the current line.
+            std::istream * input_;
+            std::string line_;
+            // Lines found before the preamble was complete.
+            std::vector<std::string> pending_;
+            size_t nextPending_;
+
+            // Storage for tokens, reused between lines.
+            Tokens tokens_, vectorTokens_;
+            // Storage for vectors parsed from the input.
+            std::vector<double> vector_;
+            // Which triplet lists were empty at the start of the current entry.
+            std::vector<char> wasEmpty_;
 
             // Storage for input preamble.
             size_t S, A, O;
             double discount;
 
             // Storage for input matrices.
-            DumbMatrix3D T, R, W;
-
-            // These are actions to perform for the preamble.
-            ActionMap initMap_;
+            std::vector<Triplets> T, R, W;
 
             // These contain the stringToken->id maps.
             IDMap stateMap_;
@@ -37,10 +37,22 @@
  *
  * Logs do *not* contain newlines. Logs do *not* contain file/line information.
  *
- * The max length of logs is capped at compile time. The variable `logBuffer`
- * is a char array which temporarily contains the message before it is passed
- * to your function. By default, the length of this array is 500. If you need
- * longer logs, feel free to change the length of the array and recompile.
+ * Messages with a severity lower than AIToolbox::AILoggerMinSeverity are
+ * discarded before being formatted, so that verbose logs cost a single
+ * comparison when they are not wanted. This can be changed at runtime, and
+ * defaults to AI_SEVERITY_DEBUG (i.e. all logs are passed).
+ *
+ * ## Threads ##
+ *
+ * Each thread formats its messages in its own buffer, so the library can
+ * log from multiple threads at once. Your function, however, can be called
+ * concurrently from these threads, so it must be thread-safe. If your
+ * function is slow (for example, because it writes to a file), you can use
+ * an AIToolbox::AsyncLogger to move the writes to a background thread.
+ *
+ * The max length of logs is capped at compile time by the size of the
+ * per-thread buffer, AIToolbox::Impl::LogBufferSize. By default, this is
+ * 500. Longer messages are truncated.
  */
 
 #ifndef AI_TOOLBOX_IMPL_LOGGING_HEADER_FILE
@@ -57,7 +69,9 @@
 
 #if AI_LOGGING_ENABLED == 1
 
-#include <sstream>
+#include <atomic>
+#include <ostream>
+#include <streambuf>
 
 namespace AIToolbox {
     using AILoggerFun = void(int, const char *);
@@ -69,9 +83,51 @@ namespace AIToolbox {
      */
     inline AILoggerFun * AILogger = nullptr;
 
+    /**
+     * @brief The minimum severity of the messages passed to AILogger.
+     *
+     * \sa \ref Logging
+     */
+    inline std::atomic<int> AILoggerMinSeverity{AI_SEVERITY_DEBUG};
+
     namespace Impl {
-        // We use this to dump logs in.
-        inline char logBuffer[500] = {0};
+        inline constexpr size_t LogBufferSize = 500;
+
+        /**
+         * @brief This class formats log messages in a fixed buffer.
+         *
+         * Each thread has its own instance, which is reused for all its
+         * messages, so that logging neither allocates nor constructs a
+         * new stream each time.
+         */
+        class LogStream : private std::streambuf, public std::ostream {
+            public:
+                LogStream() : std::ostream(this) { reset(); }
+
+                /**
+                 * @brief This function clears the buffer for a new message.
+                 */
+                void reset() {
+                    clear();
+                    setp(buffer_, buffer_ + LogBufferSize - 1);
+                }
+
+                /**
+                 * @brief This function terminates the current message and returns it.
+                 */
+                const char * message() {
+                    *pptr() = '\0';
+                    return buffer_;
+                }
+
+            private:
+                char buffer_[LogBufferSize];
+        };
+
+        inline LogStream & getLogStream() {
+            thread_local LogStream stream;
+            return stream;
+        }
     }
 }
 
@@ -91,14 +147,15 @@ namespace AIToolbox::Impl {
 // Actual logging if logging is enabled.
 #define AI_LOGGER(SEV, ARGS)                                \
     do {                                                    \
-        if (AILogger) {                                     \
-            std::stringstream internal_stringstream_;       \
-            internal_stringstream_.rdbuf()->pubsetbuf(      \
-                AIToolbox::Impl::logBuffer,                 \
-                sizeof(AIToolbox::Impl::logBuffer) - 1      \
-            );                                              \
-            internal_stringstream_ << ARGS << '\0';         \
-            AILogger(SEV, AIToolbox::Impl::logBuffer);      \
+        if (AIToolbox::AILogger && (SEV) >=                 \
+                AIToolbox::AILoggerMinSeverity.load(        \
+                    std::memory_order_relaxed)) {           \
+            auto & internal_stream_ =                       \
+                AIToolbox::Impl::getLogStream();            \
+            internal_stream_.reset();                       \
+            internal_stream_ << ARGS;                       \
+            AIToolbox::AILogger(SEV,                        \
+                internal_stream_.message());                \
         }                                                   \
     } while(0)
 
@@ -0,0 +1,26 @@
+#ifndef AI_TOOLBOX_IMPL_PARSING_HEADER_FILE
+#define AI_TOOLBOX_IMPL_PARSING_HEADER_FILE
+
+namespace AIToolbox::Impl {
+    /**
+     * @brief This function parses a double at the start of the input range.
+     *
+     * Floating point std::from_chars is not available in all the standard
+     * libraries we support, so this function uses std::strtod on a
+     * NUL-terminated copy of the input, which is thus never read past its
+     * end.
+     *
+     * As with std::strtod, leading whitespace and an explicit plus sign
+     * are accepted. Values which are out of range for a double are
+     * rejected.
+     *
+     * @param begin The start of the input; on success, it is moved past the parsed number.
+     * @param end The end of the input.
+     * @param val The output value.
+     *
+     * @return True if a number was parsed, false otherwise.
+     */
+    bool parseDouble(const char *& begin, const char * end, double & val);
+}
+
+#endif
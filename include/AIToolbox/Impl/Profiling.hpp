@@ -0,0 +1,184 @@
+/**
+ * @page Profiling How to profile AIToolbox online planners.
+ *
+ * Online planners like MDP::MCTS and POMDP::POMCP report statistics about
+ * each search in a SearchStatistics struct, which can be retrieved after
+ * each call to sampleAction(). Some of these statistics, like the number
+ * of rollouts or the size of the tree, are always collected, as they cost
+ * close to nothing.
+ *
+ * ## Enabling Profiling ##
+ *
+ * Other statistics require work in the innermost loops of the search, like
+ * reading the clock, and are only collected if the AI_PROFILING_ENABLED
+ * macro is set to 1 (you can do this via CMake). These are:
+ *
+ * - The time spent selecting actions, expanding the tree and performing
+ *   rollouts or evaluating leaves.
+ * - The histogram of the depths at which simulations left the tree.
+ *
+ * As with logging, the macro must be set before including any AIToolbox
+ * header files in your project. When it is not set, the corresponding
+ * fields of SearchStatistics are left empty, and the profiling code is
+ * compiled away entirely.
+ *
+ * ## Metrics ##
+ *
+ * When profiling is enabled, the library also reports the internals of
+ * its solvers to the global AIToolbox::MetricsRegistry, which can be read
+ * at any time with MetricsRegistry::snapshot(), and exported with
+ * MetricsSnapshot::toJSON(). These include:
+ *
+ * - "MDP::ValueIteration::sweep", a timer for each sweep over the states.
+ * - "Pruner::prune", a timer for each call to Pruner, and the
+ *   "Pruner::inputSize" histogram of the number of hyperplanes it got.
+ * - "WitnessLP::findWitness", a timer for each LP solved while pruning.
+ * - "POMDP::Projecter::project", a timer for each projection of a VList.
+ * - "Factored::Bandit::VariableElimination::solve" and "::eliminate",
+ *   timers for each call and for each eliminated agent.
+ * - "MDP::MCTS::rollouts" and "POMDP::POMCP::rollouts", counters of the
+ *   rollouts performed, and the "::search" timers of each search.
+ *
+ * Your code can record its own metrics with the same macros:
+ *
+ * - AI_METRIC_COUNT(NAME, N) adds N to a counter.
+ * - AI_METRIC_RECORD(NAME, V) records V in a histogram.
+ * - AI_METRIC_TIME(NAME) times the rest of the enclosing scope.
+ * - AI_METRIC_ADD_TIME(NAME, D) adds the duration D to a timer.
+ *
+ * Each macro looks up its metric only the first time it runs, so after
+ * that it only costs an atomic addition (and reading the clock, for
+ * timers).
+ */
+
+#ifndef AI_TOOLBOX_IMPL_PROFILING_HEADER_FILE
+#define AI_TOOLBOX_IMPL_PROFILING_HEADER_FILE
+
+#ifndef AI_PROFILING_ENABLED
+#define AI_PROFILING_ENABLED 0
+#endif
+
+#if AI_PROFILING_ENABLED == 1
+
+#include <chrono>
+
+#include <AIToolbox/Utils/Metrics.hpp>
+
+namespace AIToolbox::Impl {
+    /**
+     * @brief This class adds the time elapsed during its lifetime to a total.
+     */
+    class ScopedTimer {
+        public:
+            ScopedTimer(std::chrono::nanoseconds & total) :
+                    total_(total), start_(std::chrono::steady_clock::now()) {}
+
+            ~ScopedTimer() {
+                total_ += std::chrono::steady_clock::now() - start_;
+            }
+
+        private:
+            std::chrono::nanoseconds & total_;
+            std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * @brief This class adds the time elapsed during its lifetime to a MetricTimer.
+     */
+    class ScopedMetricTimer {
+        public:
+            ScopedMetricTimer(MetricTimer & timer) :
+                    timer_(timer), start_(std::chrono::steady_clock::now()) {}
+
+            ~ScopedMetricTimer() {
+                timer_.add(std::chrono::steady_clock::now() - start_);
+            }
+
+        private:
+            MetricTimer & timer_;
+            std::chrono::steady_clock::time_point start_;
+    };
+}
+
+#define AI_PROFILE_CONCAT_IMPL(X, Y) X##Y
+#define AI_PROFILE_CONCAT(X, Y) AI_PROFILE_CONCAT_IMPL(X, Y)
+
+// Times the rest of the enclosing scope, adding it to TOTAL.
+#define AI_PROFILE_SCOPE(TOTAL) \
+    AIToolbox::Impl::ScopedTimer AI_PROFILE_CONCAT(internal_profile_timer_, __LINE__)(TOTAL)
+
+// Runs STATEMENT only when profiling.
+#define AI_PROFILE(STATEMENT)   \
+    do {                        \
+        STATEMENT;              \
+    } while(0)
+
+// Adds N to the registry counter NAME.
+#define AI_METRIC_COUNT(NAME, N)                                        \
+    do {                                                                \
+        static auto & internal_metric_ =                                \
+            AIToolbox::MetricsRegistry::instance().counter(NAME);       \
+        internal_metric_.add(N);                                        \
+    } while(0)
+
+// Records V in the registry histogram NAME.
+#define AI_METRIC_RECORD(NAME, V)                                       \
+    do {                                                                \
+        static auto & internal_metric_ =                                \
+            AIToolbox::MetricsRegistry::instance().histogram(NAME);     \
+        internal_metric_.record(V);                                     \
+    } while(0)
+
+// Adds the duration D, as a single call, to the registry timer NAME.
+#define AI_METRIC_ADD_TIME(NAME, D)                                     \
+    do {                                                                \
+        static auto & internal_metric_ =                                \
+            AIToolbox::MetricsRegistry::instance().timer(NAME);         \
+        internal_metric_.add(D);                                        \
+    } while(0)
+
+// Times the rest of the enclosing scope, adding it to the registry timer NAME.
+#define AI_METRIC_TIME(NAME)                                            \
+    static auto & AI_PROFILE_CONCAT(internal_metric_timer_ref_, __LINE__) = \
+        AIToolbox::MetricsRegistry::instance().timer(NAME);             \
+    AIToolbox::Impl::ScopedMetricTimer                                  \
+        AI_PROFILE_CONCAT(internal_metric_timer_, __LINE__)(            \
+            AI_PROFILE_CONCAT(internal_metric_timer_ref_, __LINE__))
+
+#else
+// Statements to enable static checks on inputs if profiling is disabled.
+#define AI_PROFILE_SCOPE(TOTAL) \
+    while (0) {                 \
+        (void)(TOTAL);          \
+    }
+
+#define AI_PROFILE(STATEMENT)   \
+    while (0) {                 \
+        STATEMENT;              \
+    }
+
+#define AI_METRIC_COUNT(NAME, N) \
+    while (0) {                 \
+        (void)(NAME);           \
+        (void)(N);              \
+    }
+
+#define AI_METRIC_RECORD(NAME, V) \
+    while (0) {                 \
+        (void)(NAME);           \
+        (void)(V);              \
+    }
+
+#define AI_METRIC_ADD_TIME(NAME, D) \
+    while (0) {                 \
+        (void)(NAME);           \
+        (void)(D);              \
+    }
+
+#define AI_METRIC_TIME(NAME)    \
+    while (0) {                 \
+        (void)(NAME);           \
+    }
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef AI_TOOLBOX_KERNELS_HEADER_FILE
+#define AI_TOOLBOX_KERNELS_HEADER_FILE
+
+#include <cstddef>
+
+namespace AIToolbox {
+    /**
+     * @brief This struct contains the dense kernels used in the hottest loops of the library.
+     *
+     * When the library is compiled for a generic target, Eigen can only use
+     * the baseline instruction set of the platform (SSE2 on x86-64), even
+     * when the library runs on machines which support much wider vectors.
+     *
+     * To avoid needing a separate build for each machine, the few kernels
+     * which dominate the runtime of the planners (Bellman backups, belief
+     * updates, alpha-vector dot products and softmax exponentials) are
+     * compiled once per instruction set, each in its own translation unit
+     * in src/Kernels. At startup the library picks the widest variant which
+     * the CPU supports, and code calls it through the table returned by
+     * getKernels().
+     *
+     * The available variants are:
+     *
+     * - Generic, compiled with the flags of the rest of the library. This
+     *   is always available, and on ARM64 it already uses NEON.
+     * - AVX2, compiled on x86-64 with AVX2 and FMA enabled.
+     * - AVX512, compiled on x86-64 with AVX-512F enabled.
+     *
+     * All variants perform the same operations in the same order, so they
+     * return identical results.
+     *
+     * All matrices are row-major, and no function allocates memory. The
+     * kernels are meant for large inputs: for vectors shorter than
+     * MinSize the indirect call costs more than it saves, and callers
+     * should use Eigen directly.
+     */
+    struct Kernels {
+        enum class ISA { Generic, AVX2, AVX512 };
+
+        /**
+         * @brief The minimum vector size for which the library uses the kernels.
+         */
+        static constexpr size_t MinSize = 32;
+
+        /**
+         * @brief The instruction set this table was compiled for.
+         */
+        ISA isa;
+
+        /**
+         * @brief This function returns the dot product of two vectors of size n.
+         */
+        double (*dot)(const double * a, const double * b, size_t n);
+
+        /**
+         * @brief This function adds the product of an m x n matrix with a vector to a strided vector.
+         *
+         * For each row i, y[i * incy] += a.row(i) * x.
+         */
+        void (*gemv)(size_t m, size_t n, const double * a, const double * x, double * y, size_t incy);
+
+        /**
+         * @brief This function computes the product of a transposed m x n matrix with a vector.
+         *
+         * The output y, of size n, is overwritten with a^T * x. Rows
+         * multiplied by zero are skipped entirely, which makes this fast
+         * for sparse beliefs.
+         */
+        void (*gemvT)(size_t m, size_t n, const double * a, const double * x, double * y);
+
+        /**
+         * @brief This function computes y[i] = exp(x[i] * scale), and returns the sum of y.
+         *
+         * Outputs which would be smaller than about 1e-307 are flushed to
+         * zero, and inputs which would overflow produce infinity.
+         */
+        double (*expScaled)(size_t n, const double * x, double scale, double * y);
+    };
+
+    /**
+     * @brief This function returns the kernels used by the library.
+     *
+     * The first call selects the widest variant supported by the CPU.
+     */
+    const Kernels & getKernels();
+
+    /**
+     * @brief This function returns whether the input variant was compiled and is supported by the CPU.
+     *
+     * @param isa The variant to check.
+     */
+    bool isKernelsISASupported(Kernels::ISA isa);
+
+    /**
+     * @brief This function changes the kernels used by the library.
+     *
+     * This is mostly useful for testing and benchmarking. This function
+     * throws std::invalid_argument if the variant is not supported.
+     *
+     * @param isa The variant to use.
+     */
+    void setKernelsISA(Kernels::ISA isa);
+}
+
+#endif
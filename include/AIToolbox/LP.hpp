@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <AIToolbox/Types.hpp>
 
@@ -96,11 +97,42 @@ namespace AIToolbox {
              */
             void pushRow(Constraint c, double value);
 
+            /**
+             * @brief This function adds a sparse constraint to the LP.
+             *
+             * This function is equivalent to pushRow(Constraint, double),
+             * but only the elements of `row` at the input ids are read,
+             * and all other coefficients are considered zero. For rows
+             * with few non-zero elements this avoids reading (and for
+             * some backends, scanning) the whole row.
+             *
+             * The ids must be distinct.
+             *
+             * @param ids The ids of the non-zero coefficients of the row.
+             * @param c The type of constraint that should be enforced.
+             * @param value The value on the other side of the constraint equation.
+             */
+            void pushRow(const std::vector<size_t> & ids, Constraint c, double value);
+
             /**
              * @brief This function removes the last pushed constraint.
              */
             void popRow();
 
+            /**
+             * @brief This function replaces an existing constraint with the current contents of `row`.
+             *
+             * Rows are numbered from zero in the order they were pushed.
+             * Changing a row in place, rather than popping and pushing it,
+             * keeps the structure of the LP intact, so that resolve() can
+             * restart from the previous solution if warm starts are enabled.
+             *
+             * @param n The id of the row to replace.
+             * @param c The type of constraint that should be enforced.
+             * @param value The value on the other side of the constraint equation.
+             */
+            void setRow(size_t n, Constraint c, double value);
+
             /**
              * @brief This function adds a new column to the LP.
              *
@@ -132,6 +164,40 @@ namespace AIToolbox {
              */
             std::optional<Vector> solve(size_t variables, double * objective = nullptr);
 
+            /**
+             * @brief This function solves the LP, possibly starting from the basis of the previous solve.
+             *
+             * This function is meant to be called after small changes to
+             * the LP, like appending a row or changing one with setRow().
+             * In those cases the previous optimal basis is generally only a
+             * few dual simplex iterations away from the new one.
+             *
+             * Unless warm starts have been enabled with setWarmStart(), this
+             * function is equivalent to solve().
+             *
+             * When they are enabled, the warm-started result is only
+             * accepted if it is optimal. For any other outcome (suboptimal,
+             * infeasible, unbounded or a failure), the LP is solved again
+             * from the default basis with solve().
+             *
+             * @param variables The number of variables one wants the solution of.
+             * @param objective A pointer where to store the result value of the objective.
+             *
+             * @return A Vector if the solving process succeeded.
+             */
+            std::optional<Vector> resolve(size_t variables, double * objective = nullptr);
+
+            /**
+             * @brief This function sets whether resolve() starts from the previous basis.
+             *
+             * Warm starts are disabled by default, as lp_solve has been
+             * observed to return wrong results when bootstrapping from a
+             * previous solution.
+             *
+             * @param warmStart Whether resolve() should reuse the previous basis.
+             */
+            void setWarmStart(bool warmStart);
+
             /**
              * @brief This function resizes the underlying LP.
              *
@@ -179,6 +245,7 @@ namespace AIToolbox {
         private:
             size_t varNumber_;
             bool maximize_;
+            bool warmStart_;
     };
 }
 
@@ -0,0 +1,450 @@
+#ifndef AI_TOOLBOX_MDP_DISTRIBUTED_VALUE_ITERATION_HEADER_FILE
+#define AI_TOOLBOX_MDP_DISTRIBUTED_VALUE_ITERATION_HEADER_FILE
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class contains the part of an MDP owned by a single node.
+     *
+     * When an MDP is too large to fit in the memory of a single machine,
+     * its state space can be split in contiguous ranges, one per node.
+     * Each node then only stores the transition rows and immediate rewards
+     * of the states it owns.
+     *
+     * The transition matrices are given with their columns indexed by
+     * global state. This class renumbers them so that the owned states
+     * come first, followed by the "ghost" states: the states owned by
+     * other nodes which can be reached from the owned ones. Only the
+     * values of the ghost states need to be received from other nodes at
+     * each sweep of DistributedValueIteration.
+     */
+    class ModelPartition {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The transition function must contain A matrices, each with
+             * (end - begin) rows and S columns, where row i contains the
+             * transition probabilities of global state begin + i. The
+             * rewards must be a (end - begin) x A matrix of immediate
+             * rewards, as computeImmediateRewards() would return for the
+             * owned rows.
+             *
+             * This constructor throws an std::invalid_argument if the sizes
+             * are inconsistent.
+             *
+             * @param S The number of states of the whole MDP.
+             * @param begin The first state owned by this partition.
+             * @param end One past the last state owned by this partition.
+             * @param t The owned rows of the transition function.
+             * @param ir The owned rows of the immediate rewards.
+             * @param discount The discount of the MDP.
+             */
+            ModelPartition(size_t S, size_t begin, size_t end, const SparseMatrix3D & t, const Matrix2D & ir, double discount);
+
+            /**
+             * @brief This function returns the number of states of the whole MDP.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of actions of the MDP.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the first state owned by this partition.
+             */
+            size_t getBegin() const;
+
+            /**
+             * @brief This function returns one past the last state owned by this partition.
+             */
+            size_t getEnd() const;
+
+            /**
+             * @brief This function returns the discount of the MDP.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the ghost states of this partition, in increasing order.
+             */
+            const std::vector<size_t> & getGhosts() const;
+
+            /**
+             * @brief This function returns the renumbered transition matrix for the input action.
+             *
+             * Columns [0, end - begin) refer to the owned states, and the
+             * following ones to the ghost states, in order.
+             *
+             * @param a The action requested.
+             */
+            const SparseMatrix2D & getTransitionFunction(size_t a) const;
+
+            /**
+             * @brief This function returns the immediate rewards of the owned states.
+             */
+            const Matrix2D & getRewardFunction() const;
+
+        private:
+            size_t S, A, begin_, end_;
+            double discount_;
+            std::vector<size_t> ghosts_;
+            SparseMatrix3D transitions_;
+            Matrix2D rewards_;
+    };
+
+    /**
+     * @brief This function creates a ModelPartition from the rows of an existing model.
+     *
+     * This function is mostly useful for testing, or when the full model
+     * can be loaded on one machine just to be split.
+     *
+     * @param model The model to split.
+     * @param begin The first state of the partition.
+     * @param end One past the last state of the partition.
+     *
+     * @return The partition of the model.
+     */
+    template <typename M, std::enable_if_t<is_model_eigen_v<M>, int> = 0>
+    ModelPartition makeModelPartition(const M & model, size_t begin, size_t end);
+
+    /**
+     * @brief This struct represents the required interface for a DistributedValueIteration transport.
+     *
+     * A transport connects the nodes participating in a distributed
+     * computation, each with its own rank in [0, getNodes()). All
+     * functions are collective: they must be called by all nodes in the
+     * same order, and they return only when all nodes have called them.
+     *
+     * - exchange() sends send[j] to node j, and writes in recv[j] what
+     *   node j sent to the caller (so recv is resized to getNodes()).
+     * - allReduceMax() returns the maximum of the inputs of all nodes.
+     *
+     * An MPI transport can implement exchange() with MPI_Alltoall (for
+     * the sizes) and MPI_Alltoallv, and allReduceMax() with MPI_Allreduce
+     * and MPI_MAX.
+     *
+     * @tparam T The class to test for the interface.
+     */
+    template <typename T>
+    struct is_value_transport {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<size_t (Z::*)() const>                                                                          (&Z::getRank),
+                    static_cast<size_t (Z::*)() const>                                                                          (&Z::getNodes),
+                    static_cast<void (Z::*)(const std::vector<std::vector<size_t>> &, std::vector<std::vector<size_t>> *)>      (&Z::exchange),
+                    static_cast<void (Z::*)(const std::vector<std::vector<double>> &, std::vector<std::vector<double>> *)>      (&Z::exchange),
+                    static_cast<double (Z::*)(double)>                                                                          (&Z::allReduceMax),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = test<T>(0) };
+    };
+    template <typename T>
+    inline constexpr bool is_value_transport_v = is_value_transport<T>::value;
+
+    /**
+     * @brief This class connects LocalTransport instances within a single process.
+     *
+     * This class allows to run DistributedValueIteration with multiple
+     * nodes as threads of the same process, which is useful for testing
+     * and to debug transports for actual clusters.
+     */
+    class LocalHub {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param nodes The number of nodes that will connect to this hub.
+             */
+            LocalHub(size_t nodes);
+
+            /**
+             * @brief This function returns the number of nodes of this hub.
+             */
+            size_t getNodes() const;
+
+        private:
+            friend class LocalTransport;
+
+            void barrier();
+
+            template <typename T>
+            void exchange(size_t rank, std::vector<std::vector<std::vector<T>>> & boxes,
+                          const std::vector<std::vector<T>> & send, std::vector<std::vector<T>> * recv);
+
+            size_t nodes_;
+
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            size_t waiting_, generation_;
+
+            // boxes[to][from] contains the last message sent between the two nodes.
+            std::vector<std::vector<std::vector<size_t>>> indeces_;
+            std::vector<std::vector<std::vector<double>>> values_;
+            std::vector<double> reduce_;
+    };
+
+    /**
+     * @brief This class is a transport between threads of the same process.
+     *
+     * Each node must use its own LocalTransport, with a different rank, on
+     * its own thread.
+     */
+    class LocalTransport {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::invalid_argument if the rank
+             * is not less than the number of nodes of the hub.
+             *
+             * @param hub The hub connecting the nodes; it must outlive this class.
+             * @param rank The rank of this node.
+             */
+            LocalTransport(LocalHub & hub, size_t rank);
+
+            /**
+             * @brief This function returns the rank of this node.
+             */
+            size_t getRank() const;
+
+            /**
+             * @brief This function returns the number of nodes connected to the hub.
+             */
+            size_t getNodes() const;
+
+            /**
+             * @brief This function sends send[j] to node j, and receives in recv[j] the message of node j.
+             *
+             * @param send The messages to send, one per node.
+             * @param recv The output messages, one per node.
+             */
+            void exchange(const std::vector<std::vector<size_t>> & send, std::vector<std::vector<size_t>> * recv);
+
+            /**
+             * @brief This function sends send[j] to node j, and receives in recv[j] the message of node j.
+             *
+             * @param send The messages to send, one per node.
+             * @param recv The output messages, one per node.
+             */
+            void exchange(const std::vector<std::vector<double>> & send, std::vector<std::vector<double>> * recv);
+
+            /**
+             * @brief This function returns the maximum of the input values of all nodes.
+             *
+             * @param value The value of this node.
+             */
+            double allReduceMax(double value);
+
+        private:
+            LocalHub & hub_;
+            size_t rank_;
+    };
+
+    /**
+     * @brief This class applies value iteration on an MDP split between multiple nodes.
+     *
+     * Each node calls operator() with its own ModelPartition and its own
+     * transport. At each timestep, each node sends to the others only the
+     * values they need (the ghost states of their partitions), computes
+     * the QFunction of its own states and applies the Bellman operator on
+     * them. Convergence is checked with an all-reduce of the maximum
+     * variation, so all nodes stop at the same timestep.
+     *
+     * Each timestep performs exactly the same operations as a Jacobi sweep
+     * of ValueIteration, so the results only differ from it by floating
+     * point rounding.
+     *
+     * The partitions of the nodes must be contiguous ranges that together
+     * cover the whole state space, with increasing ranks owning increasing
+     * ranges.
+     */
+    class DistributedValueIteration {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The tolerance parameter must be >= 0.0, otherwise the
+             * constructor will throw an std::invalid_argument. It has the
+             * same meaning as in ValueIteration.
+             *
+             * @param horizon The maximum number of iterations to perform.
+             * @param tolerance The tolerance factor to stop the value iteration loop.
+             */
+            DistributedValueIteration(unsigned horizon, double tolerance = 0.001);
+
+            /**
+             * @brief This function applies value iteration on the partition of this node.
+             *
+             * This function must be called by all nodes at the same time.
+             * It throws an std::runtime_error if the partitions of the
+             * nodes are not consistent; in that case all nodes throw.
+             *
+             * @param model The partition of the MDP owned by this node.
+             * @param transport The transport connecting this node to the others.
+             *
+             * @return A tuple containing the maximum variation over all
+             *         nodes, and the ValueFunction and QFunction of the
+             *         owned states (indexed from 0).
+             */
+            template <typename T, typename = std::enable_if_t<is_value_transport_v<T>>>
+            std::tuple<double, ValueFunction, QFunction> operator()(const ModelPartition & model, T & transport);
+
+            /**
+             * @brief This function sets the tolerance parameter.
+             *
+             * @param t The new tolerance parameter.
+             */
+            void setTolerance(double t);
+
+            /**
+             * @brief This function sets the horizon parameter.
+             *
+             * @param h The new horizon parameter.
+             */
+            void setHorizon(unsigned h);
+
+            /**
+             * @brief This function returns the currently set tolerance parameter.
+             */
+            double getTolerance() const;
+
+            /**
+             * @brief This function returns the currently set horizon parameter.
+             */
+            unsigned getHorizon() const;
+
+        private:
+            double tolerance_;
+            unsigned horizon_;
+    };
+
+    template <typename M, std::enable_if_t<is_model_eigen_v<M>, int>>
+    ModelPartition makeModelPartition(const M & model, const size_t begin, const size_t end) {
+        const size_t A = model.getA();
+        if (begin > end || end > model.getS())
+            throw std::invalid_argument("Invalid partition range for the model");
+
+        SparseMatrix3D t(A);
+        for (size_t a = 0; a < A; ++a) {
+            const auto rows = model.getTransitionFunction(a).middleRows(begin, end - begin).template cast<double>();
+            if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<remove_cv_ref_t<decltype(model.getTransitionFunction(a))>>,
+                                            remove_cv_ref_t<decltype(model.getTransitionFunction(a))>>)
+                t[a] = rows;
+            else
+                t[a] = rows.sparseView();
+        }
+
+        const Matrix2D ir = computeImmediateRewards(model).middleRows(begin, end - begin);
+        return ModelPartition(model.getS(), begin, end, t, ir, model.getDiscount());
+    }
+
+    template <typename T, typename>
+    std::tuple<double, ValueFunction, QFunction> DistributedValueIteration::operator()(const ModelPartition & model, T & transport) {
+        const size_t nodes = transport.getNodes();
+        const size_t A = model.getA();
+        const size_t N = model.getEnd() - model.getBegin();
+        const auto & ghosts = model.getGhosts();
+
+        // First we learn the ranges of all nodes, so we know who owns the
+        // ghost states, and we check that they make sense. All nodes see
+        // the same ranges, so they all throw together.
+        std::vector<std::vector<size_t>> sendIds(nodes, {model.getBegin(), model.getEnd(), model.getS()});
+        std::vector<std::vector<size_t>> ranges;
+        transport.exchange(sendIds, &ranges);
+
+        std::vector<size_t> begins(nodes);
+        for (size_t j = 0; j < nodes; ++j) {
+            const auto & r = ranges[j];
+            if (r.size() != 3 || r[2] != model.getS() || r[0] != (j ? ranges[j-1][1] : 0) || (j + 1 == nodes && r[1] != r[2]))
+                throw std::runtime_error("Partitions of the nodes do not cover the state space contiguously");
+            begins[j] = r[0];
+        }
+
+        // Then we tell each node which of its values we need. Since the
+        // ghosts are sorted, so are the owners, and the values received
+        // in order of rank are already in the order of the ghosts.
+        for (auto & v : sendIds) v.clear();
+        for (const auto g : ghosts) {
+            const size_t owner = std::upper_bound(std::begin(begins), std::end(begins), g) - std::begin(begins) - 1;
+            sendIds[owner].push_back(g - begins[owner]);
+        }
+        // Since the ranges are consistent, all requested states are
+        // within our partition.
+        std::vector<std::vector<size_t>> requested;
+        transport.exchange(sendIds, &requested);
+
+        // Workspaces: the owned values followed by the ghost values.
+        ValueFunction v1 = makeValueFunction(N);
+        Values val0(N), v(N + ghosts.size());
+        QFunction q = makeQFunction(N, A);
+        std::vector<std::vector<double>> sendValues(nodes), recvValues;
+
+        unsigned timestep = 0;
+        double variation = tolerance_ * 2; // Make it bigger
+        const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
+
+        while ( timestep < horizon_ && (!useTolerance || variation > tolerance_) ) {
+            ++timestep;
+            AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+            AI_METRIC_TIME("MDP::DistributedValueIteration::sweep");
+
+            for (size_t j = 0; j < nodes; ++j) {
+                sendValues[j].resize(requested[j].size());
+                for (size_t i = 0; i < requested[j].size(); ++i)
+                    sendValues[j][i] = v1.values[requested[j][i]];
+            }
+            transport.exchange(sendValues, &recvValues);
+
+            val0 = v1.values;
+            v.head(N) = v1.values;
+            size_t g = N;
+            for (const auto & r : recvValues)
+                for (const auto value : r)
+                    v[g++] = value;
+            assert(g == static_cast<size_t>(v.size()));
+
+            // We apply the discount directly on the values vector.
+            v *= model.getDiscount();
+
+            q = model.getRewardFunction();
+            for (size_t a = 0; a < A; ++a)
+                q.col(a).noalias() += model.getTransitionFunction(a) * v;
+
+            bellmanOperatorInline(q, &v1);
+
+            // All nodes always participate in the reduction, so that they
+            // stay in lockstep.
+            variation = N ? (v1.values - val0).cwiseAbs().maxCoeff() : 0.0;
+            variation = transport.allReduceMax(variation);
+        }
+
+        return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1), std::move(q));
+    }
+}
+
+#endif
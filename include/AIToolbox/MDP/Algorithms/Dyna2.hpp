@@ -1,6 +1,9 @@
 #ifndef AI_TOOLBOX_MDP_DYNA2_HEADER_FILE
 #define AI_TOOLBOX_MDP_DYNA2_HEADER_FILE
 
+#include <utility>
+#include <vector>
+
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Algorithms/SARSAL.hpp>
@@ -79,6 +82,10 @@ namespace AIToolbox::MDP {
 
             /**
              * @brief This function resets the transient QFunction to the permanent one.
+             *
+             * Dyna2 keeps track of which entries of the two QFunctions
+             * have been modified since the last reset, so this function
+             * only copies those, rather than the whole QFunction.
              */
             void resetTransientLearning();
 
@@ -199,11 +206,26 @@ namespace AIToolbox::MDP {
             const M & getModel() const;
 
         private:
+            /**
+             * @brief This function marks the state-action pairs of the input traces as diverged.
+             *
+             * SARSAL only modifies the QFunction entries which have an
+             * active trace after an update, so these are all the entries
+             * that might differ between the two QFunctions.
+             *
+             * @param traces The traces of the SARSAL that was just updated.
+             */
+            void markDiverged(const SARSAL::Traces & traces);
+
             unsigned N;
             const M & model_;
             SARSAL permanentLearning_;
             SARSAL transientLearning_;
             std::unique_ptr<PolicyInterface> internalPolicy_;
+
+            // Entries where the transient QFunction may differ from the permanent one.
+            std::vector<std::pair<size_t, size_t>> diverged_;
+            std::vector<bool> isDiverged_;
     };
 
     template <typename M>
@@ -211,7 +233,8 @@ namespace AIToolbox::MDP {
             N(n), model_(m),
             permanentLearning_(model_, alpha, lambda, tolerance),
             transientLearning_(model_, alpha, lambda, tolerance),
-            internalPolicy_(new RandomPolicy(model_.getS(), model_.getA()))
+            internalPolicy_(new RandomPolicy(model_.getS(), model_.getA())),
+            isDiverged_(model_.getS() * model_.getA(), false)
     {
     }
 
@@ -236,6 +259,8 @@ namespace AIToolbox::MDP {
         transientLearning_.setTraces(permanentLearning_.getTraces());
         permanentLearning_.stepUpdateQ(s, a, s1, a1, rew);
         transientLearning_.stepUpdateQ(s, a, s1, a1, rew);
+
+        markDiverged(permanentLearning_.getTraces());
     }
 
     template <typename M>
@@ -253,6 +278,7 @@ namespace AIToolbox::MDP {
             const size_t a1 = internalPolicy_->sampleAction(s1);
 
             transientLearning_.stepUpdateQ(s, a, s1, a1, rew);
+            markDiverged(transientLearning_.getTraces());
 
             if (model_.isTerminal(s1)) {
                 s = initS;
@@ -266,7 +292,24 @@ namespace AIToolbox::MDP {
 
     template <typename M>
     void Dyna2<M>::resetTransientLearning() {
-        transientLearning_.setQFunction(permanentLearning_.getQFunction());
+        const auto & q = permanentLearning_.getQFunction();
+        for ( const auto & [s, a] : diverged_ ) {
+            transientLearning_.setQValue(s, a, q(s, a));
+            isDiverged_[s * model_.getA() + a] = false;
+        }
+        diverged_.clear();
+    }
+
+    template <typename M>
+    void Dyna2<M>::markDiverged(const SARSAL::Traces & traces) {
+        const size_t A = model_.getA();
+        for ( const auto & t : traces ) {
+            const size_t s = std::get<0>(t), a = std::get<1>(t);
+            if ( !isDiverged_[s * A + a] ) {
+                isDiverged_[s * A + a] = true;
+                diverged_.emplace_back(s, a);
+            }
+        }
     }
     template <typename M>
     void Dyna2<M>::setInternalPolicy(PolicyInterface * p) {
@@ -4,9 +4,11 @@
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Algorithms/QLearning.hpp>
+#include <AIToolbox/MDP/ReplayBuffer.hpp>
 #include <AIToolbox/Impl/Seeder.hpp>
 
 #include <boost/functional/hash.hpp>
+#include <tuple>
 #include <utility>
 #include <unordered_set>
 #include <vector>
@@ -29,6 +31,24 @@ namespace AIToolbox::MDP {
      *
      * The algorithm selects randomly which state action pairs to try again
      * from.
+     *
+     * Optionally, a ThreadPool can be set to parallelize the QFunction
+     * updates of the planning phase. Note that the model is still sampled
+     * serially (models are generally not safe to sample concurrently), and
+     * that parallel planning bootstraps from the QFunction as it was at
+     * the start of each batchUpdateQ(), so its results differ from the
+     * serial version. See QLearning::batchUpdateQ(const TransitionBatch &, ThreadPool &).
+     *
+     * If the model can sample whole batches (see
+     * is_generative_model_batch), all samples of a planning phase are
+     * requested with a single call, with or without a ThreadPool.
+     *
+     * Optionally, a ReplayBuffer can be set. In that case each real
+     * transition is also recorded in the buffer, and the state-action
+     * pairs to plan on are sampled from it rather than uniformly from all
+     * visited pairs. With a prioritized buffer, planning thus focuses on
+     * the pairs whose values are changing the most, and the priorities
+     * are updated with the TD errors of the planning updates.
      */
     template <typename M>
     class DynaQ {
@@ -76,9 +96,48 @@ namespace AIToolbox::MDP {
              * explored, we know that whose pairs are actually possible. Thus we
              * use the generative model to sample them again, and obtain a better
              * estimate of the QFunction.
+             *
+             * If a ThreadPool is set, all samples are drawn first, and the
+             * updates are then applied in parallel.
              */
             void batchUpdateQ();
 
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize planning updates.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to batchUpdateQ(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function sets the ReplayBuffer to use to select planning updates.
+             *
+             * The ReplayBuffer is not owned by this class, and must outlive
+             * any calls to stepUpdateQ() and batchUpdateQ(). A nullptr (the
+             * default) restores uniform sampling of the visited pairs.
+             *
+             * @param buffer The ReplayBuffer to use, or nullptr.
+             */
+            void setReplayBuffer(ReplayBuffer * buffer);
+
+            /**
+             * @brief This function returns the currently set ReplayBuffer.
+             *
+             * @return The currently set ReplayBuffer, or nullptr.
+             */
+            ReplayBuffer * getReplayBuffer() const;
+
             /**
              * @brief This function sets the learning rate parameter.
              *
@@ -128,6 +187,8 @@ namespace AIToolbox::MDP {
             unsigned N;
             const M & model_;
             QLearning qLearning_;
+            ThreadPool * pool_;
+            ReplayBuffer * buffer_;
 
             // We use two structures because generally S*A is not THAT big, and we can definitely use
             // the O(1) insertion and O(1) sampling time.
@@ -136,11 +197,15 @@ namespace AIToolbox::MDP {
 
             // Stuff for batch update
             mutable RandomEngine rand_;
+            TransitionBatch samples_;
+            std::vector<size_t> ids_;
+            std::vector<double> tdErrors_;
     };
 
     template <typename M>
     DynaQ<M>::DynaQ(const M & m, const double alpha, const unsigned n) :
-            N(n), model_(m), qLearning_(model_, alpha), rand_(Impl::Seeder::getSeed())
+            N(n), model_(m), qLearning_(model_, alpha), pool_(nullptr), buffer_(nullptr),
+            rand_(Impl::Seeder::getSeed())
     {
         visitedStatesActionsInserter_.reserve(model_.getS()*model_.getA());
         visitedStatesActionsSampler_.reserve(model_.getS()*model_.getA());
@@ -149,6 +214,7 @@ namespace AIToolbox::MDP {
     template <typename M>
     void DynaQ<M>::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
         qLearning_.stepUpdateQ(s, a, s1, rew);
+        if ( buffer_ ) buffer_->record(s, a, s1, rew);
         // O(1) insertion...
         const auto result = visitedStatesActionsInserter_.insert(std::make_pair(s,a));
         if ( std::get<1>(result) )
@@ -157,18 +223,101 @@ namespace AIToolbox::MDP {
 
     template <typename M>
     void DynaQ<M>::batchUpdateQ() {
+        if ( buffer_ ) {
+            // The buffer selects which pairs to plan on, and the model is
+            // sampled again for them as usual.
+            buffer_->sampleBatch(N, &samples_, &ids_);
+            if ( samples_.states.empty() ) return;
+
+            if constexpr (is_generative_model_batch_v<M>) {
+                model_.sampleSRBatch(&samples_);
+            } else {
+                for ( size_t i = 0; i < samples_.states.size(); ++i )
+                    std::tie(samples_.nextStates[i], samples_.rewards[i]) = model_.sampleSR(samples_.states[i], samples_.actions[i]);
+            }
+
+            if ( pool_ ) qLearning_.batchUpdateQ(samples_, *pool_, &tdErrors_);
+            else         qLearning_.batchUpdateQ(samples_, &tdErrors_);
+
+            buffer_->updatePriorities(ids_, tdErrors_);
+            return;
+        }
+
         if ( ! visitedStatesActionsSampler_.size() ) return;
         std::uniform_int_distribution<size_t> sampleDistribution_(0, visitedStatesActionsSampler_.size()-1);
 
+        if ( pool_ ) {
+            samples_.states.resize(N);
+            samples_.actions.resize(N);
+            samples_.nextStates.resize(N);
+            samples_.rewards.resize(N);
+
+            if constexpr (is_generative_model_batch_v<M>) {
+                for ( unsigned i = 0; i < N; ++i )
+                    std::tie(samples_.states[i], samples_.actions[i]) = visitedStatesActionsSampler_[sampleDistribution_(rand_)];
+
+                model_.sampleSRBatch(&samples_);
+            } else {
+                for ( unsigned i = 0; i < N; ++i ) {
+                    const auto [s,a] = visitedStatesActionsSampler_[sampleDistribution_(rand_)];
+                    const auto [s1, rew] = model_.sampleSR(s, a);
+
+                    samples_.states[i] = s;
+                    samples_.actions[i] = a;
+                    samples_.nextStates[i] = s1;
+                    samples_.rewards[i] = rew;
+                }
+            }
+            qLearning_.batchUpdateQ(samples_, *pool_);
+            return;
+        }
+
+        if constexpr (is_generative_model_batch_v<M>) {
+            // The samples do not depend on the updates, so we can request
+            // them all at once and then apply the updates in order.
+            samples_.states.resize(N);
+            samples_.actions.resize(N);
+            samples_.nextStates.resize(N);
+            samples_.rewards.resize(N);
+            for ( unsigned i = 0; i < N; ++i )
+                std::tie(samples_.states[i], samples_.actions[i]) = visitedStatesActionsSampler_[sampleDistribution_(rand_)];
+
+            model_.sampleSRBatch(&samples_);
+
+            for ( unsigned i = 0; i < N; ++i )
+                qLearning_.stepUpdateQ(samples_.states[i], samples_.actions[i], samples_.nextStates[i], samples_.rewards[i]);
+            return;
+        }
+
         for ( unsigned i = 0; i < N; ++i ) {
             // O(1) sampling...
             const auto [s,a] = visitedStatesActionsSampler_[sampleDistribution_(rand_)];
-            const auto [s1, rew] = model_.sample(s, a);
+            const auto [s1, rew] = model_.sampleSR(s, a);
 
             qLearning_.stepUpdateQ(s, a, s1, rew);
         }
     }
 
+    template <typename M>
+    void DynaQ<M>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    template <typename M>
+    ThreadPool * DynaQ<M>::getThreadPool() const {
+        return pool_;
+    }
+
+    template <typename M>
+    void DynaQ<M>::setReplayBuffer(ReplayBuffer * buffer) {
+        buffer_ = buffer;
+    }
+
+    template <typename M>
+    ReplayBuffer * DynaQ<M>::getReplayBuffer() const {
+        return buffer_;
+    }
+
     template <typename M>
     unsigned DynaQ<M>::getN() const {
         return N;
@@ -170,6 +170,20 @@ namespace AIToolbox::MDP {
              */
             void stepUpdateQ(size_t s, size_t a, size_t s1, double rew);
 
+            /**
+             * @brief This function updates the internal QFunction with a batch of transitions.
+             *
+             * This function is equivalent to calling stepUpdateQ() on each
+             * transition of the batch in order, but avoids the per-call
+             * overhead when ingesting large logs of experience.
+             *
+             * This function throws an std::invalid_argument if the arrays
+             * of the batch do not all have the same size.
+             *
+             * @param batch The transitions to learn from.
+             */
+            void batchUpdateQ(const TransitionBatch & batch);
+
             /**
              * @brief This function returns the number of states on which HystereticQLearning is working.
              *
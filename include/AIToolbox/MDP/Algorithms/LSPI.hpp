@@ -0,0 +1,291 @@
+#ifndef AI_TOOLBOX_MDP_LSPI_HEADER_FILE
+#define AI_TOOLBOX_MDP_LSPI_HEADER_FILE
+
+#include <tuple>
+#include <vector>
+#include <type_traits>
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class implements Least-Squares Policy Iteration over a linear approximation of the QFunction.
+     *
+     * When the state space is very large, even storing a QFunction is not
+     * possible. This class instead approximates it with a linear
+     * combination of user-provided features of the states:
+     *
+     *     Q(s, a) = phi(s) * w_a
+     *
+     * where phi(s) is the s-th row of an S x k sparse feature matrix, and
+     * w_a is a vector of k weights, one per action. This is the flat
+     * counterpart of Factored::MDP::LinearProgramming.
+     *
+     * Each iteration evaluates the greedy policy of the current weights
+     * with LSTDQ: the Bellman equations of all samples are accumulated in
+     * a single (kA) x (kA) linear system, which is then solved in one
+     * batch. The weights of the evaluated policy become the new weights,
+     * and the process is repeated until they stop changing, or until the
+     * maximum number of iterations is reached.
+     *
+     * The memory used is O((kA)^2) for the system, plus the samples
+     * themselves; in particular it does not depend on S, as no value is
+     * ever stored per state.
+     *
+     * Samples can come from a TransitionBatch (for example drawn from a
+     * ReplayBuffer), from an Experience, where each recorded transition is
+     * weighted by its number of visits, or from a model, where each
+     * transition is weighted by its probability. In the last case the
+     * operator() computes the exact projected fixed point for all the
+     * state-action pairs weighted uniformly.
+     *
+     * The accumulation of the system can be parallelized with a
+     * user-provided ThreadPool (see setThreadPool()). Each thread fills the
+     * rows of a subset of the actions, so the results are identical to the
+     * serial ones.
+     *
+     * Note that LSPI is not guaranteed to converge, and the policies found
+     * can oscillate; the quality of the result depends on how well the
+     * features can represent the QFunctions of the policies encountered.
+     */
+    class LSPI {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param features The S x k feature matrix.
+             * @param A The number of actions.
+             * @param discount The discount to use for samples and experiences.
+             * @param maxIterations The maximum number of policy iterations.
+             * @param tolerance The maximum weight change to consider the weights converged.
+             * @param regularization The ridge term added to the diagonal of the system.
+             */
+            LSPI(SparseMatrix2D features, size_t A, double discount, unsigned maxIterations = 20, double tolerance = 1e-6, double regularization = 1e-6);
+
+            /**
+             * @brief This function runs LSPI on a batch of transitions.
+             *
+             * The nextActions field of the batch is ignored, as the next
+             * actions are always chosen by the policy being evaluated.
+             *
+             * @param batch The transitions to learn from.
+             *
+             * @return A tuple containing the last weight change and the weights.
+             */
+            std::tuple<double, Vector> operator()(const TransitionBatch & batch);
+
+            /**
+             * @brief This function runs LSPI on the transitions recorded in an Experience.
+             *
+             * Each transition is weighted by its number of visits.
+             *
+             * @param exp The Experience to learn from.
+             *
+             * @return A tuple containing the last weight change and the weights.
+             */
+            template <typename E, std::enable_if_t<is_experience_v<E>, int> = 0>
+            std::tuple<double, Vector> operator()(const E & exp);
+
+            /**
+             * @brief This function runs LSPI on all transitions of a model.
+             *
+             * Each transition is weighted by its probability, and rewards
+             * are taken from the model. The discount used is the one of
+             * the model.
+             *
+             * @param m The model to learn from.
+             *
+             * @return A tuple containing the last weight change and the weights.
+             */
+            template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+            std::tuple<double, Vector> operator()(const M & m);
+
+            /**
+             * @brief This function returns the approximate value of a state-action pair.
+             *
+             * @param s The state.
+             * @param a The action.
+             */
+            double getQValue(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the approximate values of all actions in a state.
+             *
+             * @param s The state.
+             */
+            Vector getQValues(size_t s) const;
+
+            /**
+             * @brief This function returns the action with the highest approximate value in a state.
+             *
+             * Ties are broken in favor of the lowest action.
+             *
+             * @param s The state.
+             */
+            size_t getGreedyAction(size_t s) const;
+
+            /**
+             * @brief This function sets the weights, for example to warm-start the algorithm.
+             *
+             * The weights of action a are in the block [a*k, (a+1)*k).
+             *
+             * @param w The new weights, of size k*A.
+             */
+            void setWeights(const Vector & w);
+
+            /**
+             * @brief This function returns the current weights.
+             *
+             * The weights of action a are in the block [a*k, (a+1)*k).
+             */
+            const Vector & getWeights() const;
+
+            /**
+             * @brief This function sets the discount used for samples and experiences.
+             *
+             * The discount must be in (0, 1] or the function will throw.
+             */
+            void setDiscount(double d);
+
+            /**
+             * @brief This function sets the maximum number of policy iterations.
+             */
+            void setMaxIterations(unsigned maxIterations);
+
+            /**
+             * @brief This function sets the tolerance parameter.
+             *
+             * The tolerance parameter must be >= 0 or the function will throw.
+             */
+            void setTolerance(double t);
+
+            /**
+             * @brief This function sets the ridge term added to the diagonal of the system.
+             *
+             * The regularization must be >= 0 or the function will throw.
+             * A small positive value keeps the system solvable when some
+             * feature is never active for some action in the samples.
+             */
+            void setRegularization(double r);
+
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize the accumulation of the system.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the feature matrix.
+             */
+            const SparseMatrix2D & getFeatures() const;
+
+            /**
+             * @brief This function returns the number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the discount used for samples and experiences.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the maximum number of policy iterations.
+             */
+            unsigned getMaxIterations() const;
+
+            /**
+             * @brief This function returns the currently set tolerance parameter.
+             */
+            double getTolerance() const;
+
+            /**
+             * @brief This function returns the ridge term added to the diagonal of the system.
+             */
+            double getRegularization() const;
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             */
+            ThreadPool * getThreadPool() const;
+
+        private:
+            // A weighted transition; the reward is the total one, already
+            // multiplied by the weight.
+            struct Sample {
+                size_t s, a, s1;
+                double weight, reward;
+            };
+
+            std::tuple<double, Vector> solve(const std::vector<Sample> & samples, double discount);
+
+            SparseMatrix2D features_;
+            size_t A_;
+            double discount_;
+            unsigned maxIterations_;
+            double tolerance_, regularization_;
+            ThreadPool * pool_;
+
+            Vector weights_;
+    };
+
+    template <typename E, std::enable_if_t<is_experience_v<E>, int>>
+    std::tuple<double, Vector> LSPI::operator()(const E & exp) {
+        const auto S = exp.getS();
+        const auto A = exp.getA();
+
+        std::vector<Sample> samples;
+        using VT = std::remove_cv_t<std::remove_reference_t<decltype(exp.getVisitTable())>>;
+        if constexpr (std::is_same_v<VT, SparseTable3D>) {
+            const auto & visits = exp.getVisitTable();
+            for (size_t a = 0; a < A; ++a)
+                for (size_t s = 0; s < S; ++s)
+                    for (SparseTable2D::InnerIterator it(visits[a], s); it; ++it)
+                        if (it.value() > 0)
+                            samples.push_back({s, a, size_t(it.col()), double(it.value()), exp.getReward(s, a, it.col())});
+        } else {
+            for (size_t s = 0; s < S; ++s)
+                for (size_t a = 0; a < A; ++a)
+                    for (size_t s1 = 0; s1 < S; ++s1)
+                        if (const auto v = exp.getVisits(s, a, s1); v > 0)
+                            samples.push_back({s, a, s1, double(v), exp.getReward(s, a, s1)});
+        }
+        return solve(samples, discount_);
+    }
+
+    template <typename M, std::enable_if_t<is_model_v<M>, int>>
+    std::tuple<double, Vector> LSPI::operator()(const M & m) {
+        const auto S = m.getS();
+        const auto A = m.getA();
+
+        std::vector<Sample> samples;
+        for (size_t s = 0; s < S; ++s) {
+            for (size_t a = 0; a < A; ++a) {
+                const auto add = [&](const size_t s1, const double p) {
+                    if (p > 0.0) samples.push_back({s, a, s1, p, p * m.getExpectedReward(s, a, s1)});
+                };
+                if constexpr (is_model_eigen_v<M>) {
+                    using T = std::remove_cv_t<std::remove_reference_t<decltype(m.getTransitionFunction(a))>>;
+                    if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<T>, T>) {
+                        for (typename T::InnerIterator it(m.getTransitionFunction(a), s); it; ++it)
+                            add(it.col(), it.value());
+                        continue;
+                    }
+                }
+                for (size_t s1 = 0; s1 < S; ++s1)
+                    add(s1, m.getTransitionProbability(s, a, s1));
+            }
+        }
+        return solve(samples, m.getDiscount());
+    }
+}
+
+#endif
@@ -7,7 +7,13 @@
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
 
-#include <iostream>
+#include <Eigen/SparseLU>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
 
 namespace AIToolbox::MDP {
     /**
@@ -17,16 +23,50 @@ namespace AIToolbox::MDP {
      * programming. The solution can only be computed for infinite horizons,
      * and the precision is the ones used by the underlying LP library.
      *
-     * It creates a set of |S| variables and |S|*|A| constraints, which when
-     * solved obtain the optimal ValueFunction values.
+     * Two formulations are available.
+     *
+     * The primal formulation creates a set of |S| variables and |S|*|A|
+     * constraints, which when solved obtain the optimal ValueFunction
+     * values.
+     *
+     * The dual formulation creates |S|*|A| variables, the discounted
+     * occupancy of each state-action pair starting from a uniform
+     * distribution over states, and |S| flow constraints. The optimal
+     * policy selects in each state the action with the highest occupancy,
+     * and its values are then computed by solving the |S| linear Bellman
+     * equations of the policy, which requires a discount lower than 1.
+     * The LP of the last solve is kept: if the next model has the same
+     * transition function (for example only its rewards have changed),
+     * only the objective is updated and the LP is re-solved with
+     * LP::resolve().
+     *
+     * In both cases, only the non-zero transition probabilities of the
+     * model are emitted to the LP, so that sparse models result in sparse
+     * LPs.
      *
      * From there we compute the optimal QFunction, and we return them.
      */
     class LinearProgramming {
         public:
+            /**
+             * @brief The LP formulations that can be solved.
+             */
+            enum class Formulation { Primal, Dual };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param formulation The LP formulation to use.
+             */
+            LinearProgramming(Formulation formulation = Formulation::Primal);
+
             /**
              * @brief This function solves the input MDP using linear programming.
              *
+             * With the dual formulation the discount of the model must be
+             * lower than 1, as the Bellman equations of the policy cannot
+             * be solved otherwise.
+             *
              * @tparam M The type of the solvable MDP.
              * @param m The MDP that needs to be solved.
              *
@@ -36,13 +76,70 @@ namespace AIToolbox::MDP {
              */
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction, QFunction> operator()(const M & m);
+
+            /**
+             * @brief This function sets the LP formulation to use.
+             *
+             * @param formulation The new formulation.
+             */
+            void setFormulation(Formulation formulation);
+
+            /**
+             * @brief This function returns the LP formulation used.
+             *
+             * @return The current formulation.
+             */
+            Formulation getFormulation() const;
+
+        private:
+            template <typename M>
+            std::optional<Values> solvePrimal(const M & model);
+
+            template <typename M>
+            std::optional<Values> solveDual(const M & model);
+
+            Formulation formulation_;
+
+            // The dual LP of the last solve, and its constraint
+            // coefficients (one row per state, one column per
+            // state-action pair).
+            std::unique_ptr<LP> dualLP_;
+            SparseMatrix2D dualConstraints_;
     };
 
     template <typename M, typename>
     std::tuple<double, ValueFunction, QFunction> LinearProgramming::operator()(const M & model) {
+        const size_t S = model.getS();
+
+        auto values = formulation_ == Formulation::Primal ? solvePrimal(model) : solveDual(model);
+
+        if (!values)
+            throw std::runtime_error("Could not solve the LP for this MDP");
+
+        // We have the values, but we also want the optimal actions. So while
+        // we're at it, we also build Q.
+        const auto & ir = [&]{
+            if constexpr (is_model_eigen_v<M>) return model.getRewardFunction();
+            else return computeImmediateRewards(model);
+        }();
+
+        auto q = computeQFunction(model, model.getDiscount() * (*values), ir);
+
+        ValueFunction v;
+        v.values = std::move(*values);
+        v.actions.resize(S);
+        for (size_t s = 0; s < S; ++s)
+            q.row(s).maxCoeff(&v.actions[s]);
+
+        return std::make_tuple(LP::getPrecision(), std::move(v), std::move(q));
+    }
+
+    template <typename M>
+    std::optional<Values> LinearProgramming::solvePrimal(const M & model) {
         // Extract necessary knowledge from model so we don't have to pass it around
         const size_t S = model.getS();
         const size_t A = model.getA();
+        const double discount = model.getDiscount();
 
         // Here we solve an LP to determine the optimal value function for the
         // infinite horizon. In particular, for every state, we represent its
@@ -60,7 +157,8 @@ namespace AIToolbox::MDP {
         //
         //     V(s) - sum_s' gamma * T(s,a,s') * V*(s') >= sum_s' T(s,a,s') * R(s,a,s')
         //
-        // and we merge the V(s) with its appropriate V*(s') element.
+        // and we merge the V(s) with its appropriate V*(s') element. Only
+        // the successors of s (and s itself) are set in each row.
         LP lp(S);
         lp.resize(S * A);
 
@@ -68,52 +166,155 @@ namespace AIToolbox::MDP {
         lp.row.fill(1.0 / S);
         lp.setObjective(false);
 
+        std::vector<size_t> ids;
         for (size_t s = 0; s < S; ++s) {
             // For every variable, we set it as unbounded (as its value can be
             // anything).
             lp.setUnbounded(s);
             for (size_t a = 0; a < A; ++a) {
-                double rhs;
-                if constexpr(is_model_eigen_v<M>) {
-                    lp.row = -model.getDiscount() * model.getTransitionFunction(a).row(s);
-                    rhs = model.getRewardFunction()(s, a);
+                double rhs = 0.0;
+                bool self = false;
+                ids.clear();
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    ids.push_back(s1);
+                    lp.row[s1] = -discount * p;
+                    if (s1 == s) self = true;
+                    if constexpr (!is_model_eigen_v<M>)
+                        rhs += p * model.getExpectedReward(s, a, s1);
+                });
+                if constexpr (is_model_eigen_v<M>)
+                    rhs = model.getRewardFunction().coeff(s, a);
+
+                // Finally we add the V(s) at its place.
+                if (self) {
+                    lp.row[s] += 1.0;
                 } else {
-                    // For each constraint, we compute the RHS, while at the same
-                    // time setting the coefficients for the various variables.
-                    rhs = 0.0;
-                    for (size_t s1 = 0; s1 < S; ++s1) {
-                        lp.row[s1] = -model.getDiscount() * model.getTransitionProbability(s, a, s1);
-                        rhs += model.getTransitionProbability(s, a, s1) * model.getExpectedReward(s, a, s1);
-                    }
+                    ids.push_back(s);
+                    lp.row[s] = 1.0;
                 }
-                // Finally we add the V(s) at its place.
-                lp.row[s] += 1.0;
-                lp.pushRow(LP::Constraint::GreaterEqual, rhs);
+                lp.pushRow(ids, LP::Constraint::GreaterEqual, rhs);
             }
         }
 
         // We solve the LP, and get V*
-        auto values = lp.solve(S);
+        return lp.solve(S);
+    }
 
-        if (!values)
-            throw std::runtime_error("Could not solve the LP for this MDP");
+    template <typename M>
+    std::optional<Values> LinearProgramming::solveDual(const M & model) {
+        const size_t S = model.getS();
+        const size_t A = model.getA();
+        const double discount = model.getDiscount();
 
-        // We have the values, but we also want the optimal actions. So while
-        // we're at it, we also build Q.
-        const auto & ir = [&]{
-            if constexpr (is_model_eigen_v<M>) return model.getRewardFunction();
-            else return computeImmediateRewards(model);
-        }();
+        // With no discount I - gamma * T_pi is singular, so we could not
+        // compute the values of the policy.
+        if (discount == 1.0)
+            throw std::invalid_argument("The model cannot have a discount of 1 with the dual formulation of LinearProgramming!");
 
-        auto q = computeQFunction(model, model.getDiscount() * (*values), ir);
+        // Here we solve the dual of the primal LP. The variables x(s,a)
+        // (at s * A + a) are the discounted number of times each action is
+        // taken in each state, and we maximize the obtained reward:
+        //
+        //     max sum_s,a x(s,a) * R(s,a)
+        //
+        // subject to the flow of each state:
+        //
+        //     sum_a x(s',a) - gamma * sum_s,a T(s,a,s') * x(s,a) = 1 / |S|
+        //
+        // and x(s,a) >= 0. We first compute the constraint coefficients, to
+        // check whether we can reuse the LP of the previous solve.
+        SparseMatrix2D constraints(S, S * A);
+        {
+            std::vector<Eigen::Triplet<double>> triplets;
+            for (size_t s = 0; s < S; ++s) {
+                for (size_t a = 0; a < A; ++a) {
+                    triplets.emplace_back(s, s * A + a, 1.0);
+                    forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                        triplets.emplace_back(s1, s * A + a, -discount * p);
+                    });
+                }
+            }
+            // Duplicates (self-transitions) are summed.
+            constraints.setFromTriplets(std::begin(triplets), std::end(triplets));
+            constraints.makeCompressed();
+        }
 
-        ValueFunction v;
-        v.values = std::move(*values);
-        v.actions.resize(S);
-        for (size_t s = 0; s < S; ++s)
-            q.row(s).maxCoeff(&v.actions[s]);
+        const bool reuse = dualLP_ && dualConstraints_.rows() == constraints.rows() &&
+                           dualConstraints_.cols() == constraints.cols() &&
+                           dualConstraints_.nonZeros() == constraints.nonZeros() &&
+                           std::equal(dualConstraints_.outerIndexPtr(), dualConstraints_.outerIndexPtr() + S + 1, constraints.outerIndexPtr()) &&
+                           std::equal(dualConstraints_.innerIndexPtr(), dualConstraints_.innerIndexPtr() + constraints.nonZeros(), constraints.innerIndexPtr()) &&
+                           std::equal(dualConstraints_.valuePtr(), dualConstraints_.valuePtr() + constraints.nonZeros(), constraints.valuePtr());
+
+        if (!reuse) {
+            dualLP_ = std::make_unique<LP>(S * A);
+            dualLP_->resize(S);
+
+            std::vector<size_t> ids;
+            for (size_t s1 = 0; s1 < S; ++s1) {
+                ids.clear();
+                for (SparseMatrix2D::InnerIterator it(constraints, s1); it; ++it) {
+                    ids.push_back(it.col());
+                    dualLP_->row[it.col()] = it.value();
+                }
+                dualLP_->pushRow(ids, LP::Constraint::Equal, 1.0 / S);
+            }
+            dualConstraints_ = std::move(constraints);
+        }
+
+        auto & lp = *dualLP_;
+        for (size_t s = 0; s < S; ++s) {
+            for (size_t a = 0; a < A; ++a) {
+                if constexpr (is_model_eigen_v<M>) {
+                    lp.row[s * A + a] = model.getRewardFunction().coeff(s, a);
+                } else {
+                    double rew = 0.0;
+                    forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                        rew += p * model.getExpectedReward(s, a, s1);
+                    });
+                    lp.row[s * A + a] = rew;
+                }
+            }
+        }
+        const Vector ir = lp.row;
+        lp.setObjective(true);
+
+        auto occupancies = reuse ? lp.resolve(S * A) : lp.solve(S * A);
+        if (!occupancies) {
+            dualLP_.reset();
+            return std::nullopt;
+        }
+
+        // The optimal policy takes the action with the highest occupancy
+        // in each state (every state has at least 1 / |S|). Its values
+        // solve V = R_pi + gamma * T_pi * V.
+        Values rewards(S);
+        SparseMatrix2D system(S, S);
+        {
+            std::vector<Eigen::Triplet<double>> triplets;
+            for (size_t s = 0; s < S; ++s) {
+                size_t a;
+                occupancies->segment(s * A, A).maxCoeff(&a);
+                rewards[s] = ir[s * A + a];
+
+                triplets.emplace_back(s, s, 1.0);
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    triplets.emplace_back(s, s1, -discount * p);
+                });
+            }
+            system.setFromTriplets(std::begin(triplets), std::end(triplets));
+        }
+
+        Eigen::SparseMatrix<double> colSystem = system;
+        Eigen::SparseLU<Eigen::SparseMatrix<double>> solver(colSystem);
+        if (solver.info() != Eigen::Success)
+            return std::nullopt;
+
+        Values values = solver.solve(rewards);
+        if (solver.info() != Eigen::Success)
+            return std::nullopt;
 
-        return std::make_tuple(lp.getPrecision(), std::move(v), std::move(q));
+        return values;
     }
 }
 
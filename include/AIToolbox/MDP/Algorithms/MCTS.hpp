@@ -3,10 +3,18 @@
 
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/SearchTree.hpp>
+#include <AIToolbox/Utils/SearchBudget.hpp>
+#include <AIToolbox/Utils/LeafBatch.hpp>
+#include <AIToolbox/Utils/RolloutCache.hpp>
+#include <AIToolbox/Utils/TranspositionTable.hpp>
+#include <AIToolbox/Utils/UCB.hpp>
 #include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
 
-#include <unordered_map>
+#include <boost/functional/hash.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -42,29 +50,50 @@ namespace AIToolbox::MDP {
      * for the action that has been performed and its respective new state.
      * Then it simply makes that root branch the new root, and starts
      * again.
+     *
+     * The tree is stored in a SearchTree, which keeps all nodes in flat
+     * arrays. This avoids an allocation per node, and allows resetting
+     * the tree in O(1) between calls to sampleAction().
+     *
+     * The random rollouts can be replaced by a BatchEvaluator (see
+     * setLeafEvaluator()). In that case simulations stop at the new leaf
+     * and are queued, and the queued leaves are evaluated together once
+     * enough of them are available; see LeafBatch.
+     *
+     * If the model can sample whole batches of transitions (see
+     * is_generative_model_batch), the queued leaves can also be evaluated
+     * with random rollouts, which are then performed together and sampled
+     * with a single sampleSRBatch() call per timestep; see
+     * setLeafEvaluator().
+     *
+     * The same state is often reached by many leaves of the tree, and
+     * each rolls out from scratch. A RolloutCache can be set (see
+     * setRolloutCache()) to reuse the returns of previous rollouts from the
+     * same state and remaining horizon.
+     *
+     * When many paths lead to the same states, a TranspositionTable can be
+     * set (see setTranspositionTable()) so that these paths share a single
+     * node for each state and depth (or state alone), together with its
+     * statistics, rather than each growing its own subtree.
+     *
+     * The memory used by the tree can be capped with setMaxMemory(), so
+     * that many planners can share a host without running out of memory.
+     *
+     * Actions within the tree are selected with the UCB1 exploration bonus
+     * by default. Other bonuses, like PUCT or UCBTuned, can be selected
+     * with the Bonus template parameter; see UCB1 for their interface.
      */
-    template <typename M>
+    template <typename M, typename Bonus = UCB1>
     class MCTS {
         static_assert(is_generative_model_v<M>, "This class only works for generative MDP models!");
 
         public:
             using SampleBelief = std::vector<size_t>;
 
-            struct StateNode;
-            using StateNodes = std::unordered_map<size_t, StateNode>;
-
-            struct ActionNode {
-                StateNodes children;
-                double V = 0.0;
-                unsigned N = 0;
-            };
-            using ActionNodes = std::vector<ActionNode>;
-
-            struct StateNode {
-                StateNode() : N(0) {}
-                ActionNodes children;
-                unsigned N;
-            };
+            using Graph = SearchTree<>;
+            using NodeId = Graph::NodeId;
+            using StateNode = Graph::Node;
+            using ActionNode = Graph::ActionNode;
 
             /**
              * @brief Basic constructor.
@@ -95,7 +124,12 @@ namespace AIToolbox::MDP {
              * If a graph is already present though, this function will
              * select the branch defined by the input action and
              * observation, and prune the rest. The search will be started
-             * using the existing graph: this should make search faster.
+             * using the existing graph: this should make search faster,
+             * and allows using fewer iterations per step for the same
+             * quality.
+             *
+             * The selected branch is promoted to root in O(1), without
+             * copying it; see SearchTree::reroot().
              *
              * @param a The action taken in the last timestep.
              * @param s1 The state experienced after the action was taken.
@@ -105,6 +139,41 @@ namespace AIToolbox::MDP {
              */
             size_t sampleAction(size_t a, size_t s1, unsigned horizon);
 
+            /**
+             * @brief This function resets the internal graph and samples for the provided state and horizon, within a time budget.
+             *
+             * Rather than performing a fixed number of rollouts, this
+             * function keeps performing rollouts until the input budget
+             * has been used up, and then returns the best action found so
+             * far. At least one rollout is always performed.
+             *
+             * \sa SearchDeadline
+             *
+             * @param s The initial state for the environment.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(size_t s, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
+            /**
+             * @brief This function uses the internal graph to plan, within a time budget.
+             *
+             * \sa sampleAction(size_t, size_t, unsigned)
+             * \sa sampleAction(size_t, unsigned, std::chrono::duration<Rep, Period>)
+             *
+             * @param a The action taken in the last timestep.
+             * @param s1 The state experienced after the action was taken.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(size_t a, size_t s1, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
             /**
              * @brief This function sets the number of performed rollouts in MCTS.
              *
@@ -125,6 +194,79 @@ namespace AIToolbox::MDP {
              */
             void setExploration(double exp);
 
+            /**
+             * @brief This function sets the evaluator used in place of rollouts for new leaves.
+             *
+             * When an evaluator is set, simulations are queued at their
+             * leaves until batchSize of them are available, and the
+             * leaves are then evaluated together. Remaining simulations
+             * are evaluated at the end of each search. An empty evaluator
+             * restores random rollouts.
+             *
+             * If the model can sample whole batches (see
+             * is_generative_model_batch), an empty evaluator with a
+             * batchSize greater than one still queues the leaves, and
+             * evaluates them with random rollouts performed in lockstep
+             * (see rolloutBatch()).
+             *
+             * Note that the search is still performed on a single thread;
+             * the evaluator is free to parallelize each batch.
+             *
+             * @param eval The new leaf evaluator.
+             * @param batchSize The number of simulations to queue before evaluating them.
+             */
+            void setLeafEvaluator(BatchEvaluator eval, size_t batchSize);
+
+            /**
+             * @brief This function sets the cache used to skip rollouts from already seen states.
+             *
+             * Rollout returns are cached by state and remaining horizon.
+             * The remaining horizons are grouped in buckets of
+             * depthBucket steps, so that entries are shared between
+             * close depths. The cache is kept between searches.
+             *
+             * The cache is not used when leaves are queued (see
+             * setLeafEvaluator()). A
+             * disabled cache (the default) restores plain rollouts.
+             *
+             * @param cache The new rollout cache.
+             * @param depthBucket The number of remaining steps grouped in each entry.
+             */
+            void setRolloutCache(RolloutCache cache, unsigned depthBucket = 1);
+
+            /**
+             * @brief This function sets the table used to merge the nodes of the same states.
+             *
+             * When a path reaches a state without a node in its parent,
+             * the table is searched for a node of the same state, which is
+             * then shared rather than creating a new one. If useDepth is
+             * true, nodes are only shared between the same state at the
+             * same depth, so that the graph stays acyclic and each node
+             * has a single remaining horizon; otherwise nodes are shared
+             * by state alone, which suits infinite-horizon problems.
+             *
+             * The table is cleared on each new search; when useDepth is
+             * true it is also cleared when the tree is reused, as depths
+             * change. A disabled table (the default) restores the tree.
+             *
+             * @param table The new transposition table.
+             * @param useDepth Whether to key nodes on their depth as well as their state.
+             */
+            void setTranspositionTable(TranspositionTable table, bool useDepth = true);
+
+            /**
+             * @brief This function sets the memory limit of the search tree, in bytes.
+             *
+             * Once the nodes in the tree use this much memory (see
+             * SearchTree::getUsedMemory()), the search stops adding and
+             * expanding nodes, and simulations which would do so roll out
+             * from there instead; the tree keeps being refined within its
+             * current shape. A limit of zero (the default) disables it.
+             *
+             * @param bytes The maximum memory used by the tree.
+             */
+            void setMaxMemory(size_t bytes);
+
             /**
              * @brief This function returns the MDP generative model being used.
              *
@@ -135,9 +277,12 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function returns a reference to the internal graph structure holding the results of rollouts.
              *
+             * The root of the graph is the state for which we last planned.
+             * Children of each action node are keyed by state.
+             *
              * @return The internal graph.
              */
-            const StateNode& getGraph() const;
+            const Graph& getGraph() const;
 
             /**
              * @brief This function returns the number of iterations performed to plan for an action.
@@ -153,123 +298,289 @@ namespace AIToolbox::MDP {
              */
             double getExploration() const;
 
+            /**
+             * @brief This function returns the number of simulations queued before evaluating their leaves.
+             *
+             * @return The leaf batch size.
+             */
+            size_t getLeafBatchSize() const;
+
+            /**
+             * @brief This function returns the cache used to skip rollouts.
+             *
+             * @return The rollout cache.
+             */
+            const RolloutCache & getRolloutCache() const;
+
+            /**
+             * @brief This function returns the number of remaining steps grouped in each entry of the rollout cache.
+             *
+             * @return The depth bucket.
+             */
+            unsigned getRolloutCacheDepthBucket() const;
+
+            /**
+             * @brief This function returns the table used to merge the nodes of the same states.
+             *
+             * @return The transposition table.
+             */
+            const TranspositionTable & getTranspositionTable() const;
+
+            /**
+             * @brief This function returns whether nodes are merged by depth as well as state.
+             *
+             * @return Whether the transposition table is keyed on depth.
+             */
+            bool getTranspositionUsesDepth() const;
+
+            /**
+             * @brief This function returns the memory limit of the search tree.
+             *
+             * @return The maximum memory used by the tree, or zero if unlimited.
+             */
+            size_t getMaxMemory() const;
+
+            /**
+             * @brief This function returns statistics about the last call to sampleAction().
+             *
+             * Timings and the depth histogram are only collected when
+             * profiling is enabled; see \ref Profiling.
+             *
+             * @return The statistics of the last search.
+             */
+            const SearchStatistics & getSearchStatistics() const;
+
         private:
             const M& model_;
             size_t S, A;
             unsigned iterations_, maxDepth_;
             double exploration_;
 
-            StateNode graph_;
+            Graph graph_;
+            SearchStatistics stats_;
+
+            BatchEvaluator evaluator_;
+            size_t batchSize_;
+            LeafBatch<Graph> batch_;
+            TransitionBatch rolloutSamples_;
+
+            RolloutCache rolloutCache_;
+            unsigned depthBucket_;
+
+            TranspositionTable transpositions_;
+            bool transpositionDepth_;
+
+            size_t maxMemory_;
+
+            Bonus bonus_;
+            std::vector<double> scores_;
 
             mutable RandomEngine rand_;
 
             // Private Methods
-            size_t runSimulation(size_t s, unsigned horizon);
-            double simulate(StateNode & sn, size_t s, unsigned horizon);
+            void resetGraph();
+            void reuseGraph(size_t a, size_t s1);
+            size_t runSimulation(size_t s, unsigned horizon, const SearchDeadline * deadline);
+            double simulate(NodeId sn, size_t s, unsigned horizon);
+            void simulateToLeaf(NodeId sn, size_t s);
             double rollout(size_t s, unsigned horizon);
-
-            template <typename Iterator>
-            Iterator findBestA(Iterator begin, Iterator end);
-
-            template <typename Iterator>
-            Iterator findBestBonusA(Iterator begin, Iterator end, unsigned count);
+            std::pair<NodeId, bool> expandChild(NodeId sn, size_t a, size_t s1, unsigned depth);
+            size_t getTranspositionKey(size_t s, unsigned depth) const;
+            bool isMemoryFull() const;
+            bool isQueueingLeaves() const;
+            void flushBatch();
+
+            size_t findBestA(NodeId id) const;
+            size_t findBestBonusA(NodeId id, unsigned count);
     };
 
-    template <typename M>
-    MCTS<M>::MCTS(const M& m, const unsigned iter, const double exp) :
+    template <typename M, typename Bonus>
+    MCTS<M, Bonus>::MCTS(const M& m, const unsigned iter, const double exp) :
             model_(m), S(model_.getS()), A(model_.getA()), iterations_(iter),
-            exploration_(exp), graph_(), rand_(Impl::Seeder::getSeed()) {}
+            exploration_(exp), graph_(A), batchSize_(1), depthBucket_(1),
+            transpositionDepth_(true), maxMemory_(0), rand_(Impl::Seeder::getSeed()) {}
+
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::sampleAction(const size_t s, const unsigned horizon) {
+        resetGraph();
+        return runSimulation(s, horizon, nullptr);
+    }
+
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::sampleAction(const size_t a, const size_t s1, const unsigned horizon) {
+        reuseGraph(a, s1);
+        return runSimulation(s1, horizon, nullptr);
+    }
 
-    template <typename M>
-    size_t MCTS<M>::sampleAction(const size_t s, const unsigned horizon) {
-        // Reset graph
-        graph_ = StateNode();
-        graph_.children.resize(A);
+    template <typename M, typename Bonus>
+    template <typename Rep, typename Period>
+    size_t MCTS<M, Bonus>::sampleAction(const size_t s, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
 
-        return runSimulation(s, horizon);
+        resetGraph();
+        return runSimulation(s, horizon, &deadline);
     }
 
-    template <typename M>
-    size_t MCTS<M>::sampleAction(const size_t a, const size_t s1, const unsigned horizon) {
-        auto & states = graph_.children[a].children;
+    template <typename M, typename Bonus>
+    template <typename Rep, typename Period>
+    size_t MCTS<M, Bonus>::sampleAction(const size_t a, const size_t s1, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
 
-        auto it = states.find(s1);
-        if ( it == states.end() )
-            return sampleAction(s1, horizon);
+        reuseGraph(a, s1);
+        return runSimulation(s1, horizon, &deadline);
+    }
 
-        // Here we need an additional step, because *it is contained by graph_.
-        // If we just move assign, graph_ is first going to delete everything it
-        // contains (included *it), and then we are going to move unallocated memory
-        // into graph_! So we move *it outside of the graph_ hierarchy, so that
-        // we can then assign safely.
-        { auto tmp = std::move(it->second); graph_ = std::move(tmp); }
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::resetGraph() {
+        graph_.reset();
+        graph_.expand(graph_.getRoot());
+        transpositions_.clear();
+    }
 
-        // We resize here in case we didn't have time to sample the new
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::reuseGraph(const size_t a, const size_t s1) {
+        const auto child = graph_.getChild(graph_.getRoot(), a, s1);
+        if ( child == Graph::NoNode ) {
+            resetGraph();
+            return;
+        }
+        // Compactions change all ids, while reusing the tree changes
+        // the depth of all nodes.
+        if ( graph_.reroot(child) || transpositionDepth_ )
+            transpositions_.clear();
+
+        // We expand here in case we didn't have time to sample the new
         // head node. In this case, the new head may not have children.
         // This would break the UCT call.
-        graph_.children.resize(A);
-
-        return runSimulation(s1, horizon);
+        graph_.expand(graph_.getRoot());
     }
 
-    template <typename M>
-    size_t MCTS<M>::runSimulation(const size_t s, const unsigned horizon) {
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::runSimulation(const size_t s, const unsigned horizon, const SearchDeadline * deadline) {
+        stats_ = SearchStatistics();
         if ( !horizon ) return 0;
 
+        const auto start = std::chrono::steady_clock::now();
         maxDepth_ = horizon;
 
-        for (unsigned i = 0; i < iterations_; ++i )
-            simulate(graph_, s, 0);
+        const auto root = graph_.getRoot();
+        if ( transpositions_.isEnabled() )
+            transpositions_.insert(getTranspositionKey(s, 0), root);
+
+        const bool queue = isQueueingLeaves();
+        const auto step = [this, root, s, queue]{
+            if ( !queue ) {
+                simulate(root, s, 0);
+                return;
+            }
+            simulateToLeaf(root, s);
+            if ( batch_.size() >= batchSize_ )
+                flushBatch();
+        };
+
+        if ( deadline ) {
+            do step();
+            while ( !deadline->expired(++stats_.rollouts) );
+        } else {
+            for (unsigned i = 0; i < iterations_; ++i )
+                step();
+            stats_.rollouts = iterations_;
+        }
+        if ( queue ) flushBatch();
+
+        stats_.nodes = graph_.size();
+        stats_.memoryUsage = graph_.getMemoryUsage();
+        stats_.elapsed = std::chrono::steady_clock::now() - start;
+
+        AI_METRIC_COUNT("MDP::MCTS::rollouts", stats_.rollouts);
+        AI_METRIC_ADD_TIME("MDP::MCTS::search", stats_.elapsed);
 
-        auto begin = std::begin(graph_.children);
-        return std::distance(begin, findBestA(begin, std::end(graph_.children)));
+        return findBestA(root);
     }
 
-    template <typename M>
-    double MCTS<M>::simulate(StateNode & sn, const size_t s, const unsigned depth) {
+    template <typename M, typename Bonus>
+    double MCTS<M, Bonus>::simulate(const NodeId sn, const size_t s, const unsigned depth) {
         // Head update
-        sn.N++;
+        const auto count = ++graph_.getNode(sn).N;
+        if ( depth > stats_.maxDepth ) stats_.maxDepth = depth;
 
-        auto begin = std::begin(sn.children);
-        const size_t a = std::distance(begin, findBestBonusA(begin, std::end(sn.children), sn.N));
+        const size_t a = findBestBonusA(sn, count);
 
         auto [s1, rew] = model_.sampleSR(s, a);
 
-        auto & aNode = sn.children[a];
-
         // We only go deeper if needed (maxDepth_ is always at least 1).
         if ( depth + 1 < maxDepth_ && !model_.isTerminal(s1) ) {
-            const auto end = std::end(aNode.children);
-            auto it = aNode.children.find(s1);
+            // Touch node to create it
+            const auto [child, added] = expandChild(sn, a, s1, depth + 1);
 
             double futureRew;
-            if ( it == end ) {
-                // Touch node to create it
-                aNode.children[s1];
+            if ( added ) {
+                if ( child != Graph::NoNode ) ++stats_.nodesAdded;
+                AI_PROFILE(stats_.addLeafDepth(depth));
                 futureRew = rollout(s1, depth + 1);
             }
             else {
-                // Since most memory is allocated on the leaves,
-                // we do not allocate on node creation but only when
-                // we are actually descending into a node. If the node
-                // already has memory this should not do anything in
-                // any case.
-                it->second.children.resize(A);
-                futureRew = simulate( it->second, s1, depth + 1 );
+                futureRew = simulate( child, s1, depth + 1 );
             }
 
             rew += model_.getDiscount() * futureRew;
+        } else {
+            AI_PROFILE(stats_.addLeafDepth(depth));
         }
 
-        // Action update
-        aNode.N++;
-        aNode.V += ( rew - aNode.V ) / static_cast<double>(aNode.N);
+        // Action update. Note that the graph may have grown while
+        // simulating, so we cannot keep references to its nodes.
+        graph_.update(sn, a, rew);
 
         return rew;
     }
 
-    template <typename M>
-    double MCTS<M>::rollout(size_t s, unsigned depth) {
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::simulateToLeaf(NodeId sn, size_t s) {
+        // This follows the same path as simulate(), but it queues the
+        // leaf rather than performing a rollout; values are updated once
+        // the batch is evaluated.
+        for ( unsigned depth = 0; ; ++depth ) {
+            const auto count = ++graph_.getNode(sn).N;
+            if ( depth > stats_.maxDepth ) stats_.maxDepth = depth;
+
+            const size_t a = findBestBonusA(sn, count);
+
+            const auto [s1, rew] = model_.sampleSR(s, a);
+            batch_.push(graph_, sn, a, rew);
+
+            if ( depth + 1 >= maxDepth_ || model_.isTerminal(s1) ) {
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                batch_.finish();
+                return;
+            }
+
+            const auto [child, added] = expandChild(sn, a, s1, depth + 1);
+            if ( added ) {
+                if ( child != Graph::NoNode ) ++stats_.nodesAdded;
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                batch_.finish(s1, maxDepth_ - depth - 1);
+                return;
+            }
+            sn = child;
+            s = s1;
+        }
+    }
+
+    template <typename M, typename Bonus>
+    double MCTS<M, Bonus>::rollout(size_t s, unsigned depth) {
+        AI_PROFILE_SCOPE(stats_.rolloutTime);
+
+        size_t key = 0;
+        if ( rolloutCache_.isEnabled() ) {
+            boost::hash_combine(key, s);
+            boost::hash_combine(key, (maxDepth_ - depth) / depthBucket_);
+            if ( const auto value = rolloutCache_.lookup(key) ) {
+                ++stats_.rolloutCacheHits;
+                return *value;
+            }
+        }
+
         double rew = 0.0, totalRew = 0.0, gamma = 1.0;
 
         std::uniform_int_distribution<size_t> generator(0, A-1);
@@ -278,74 +589,177 @@ namespace AIToolbox::MDP {
             totalRew += gamma * rew;
 
             if (model_.isTerminal(s))
-                return totalRew;
+                break;
 
             gamma *= model_.getDiscount();
         }
+
+        if ( rolloutCache_.isEnabled() ) rolloutCache_.update(key, totalRew);
         return totalRew;
     }
 
-    template <typename M>
-    template <typename Iterator>
-    Iterator MCTS<M>::findBestA(Iterator begin, Iterator end) {
-        return std::max_element(begin, end, [](const ActionNode & lhs, const ActionNode & rhs){ return lhs.V < rhs.V; });
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::findBestA(const NodeId id) const {
+        const auto values = graph_.getValues(id);
+        return std::distance(values, std::max_element(values, values + A));
     }
 
-    template <typename M>
-    template <typename Iterator>
-    Iterator MCTS<M>::findBestBonusA(Iterator begin, Iterator end, const unsigned count) {
-        // Count here can be as low as 1.
-        // Since log(1) = 0, and 0/0 = error, we add 1.0.
-        const double logCount = std::log(count + 1.0);
-        // We use this function to produce a score for each action. This can be easily
-        // substituted with something else to produce different POMCP variants.
-        const auto evaluationFunction = [this, logCount](const ActionNode & an){
-            return an.V + exploration_ * std::sqrt( logCount / an.N );
-        };
+    template <typename M, typename Bonus>
+    std::pair<typename MCTS<M, Bonus>::NodeId, bool> MCTS<M, Bonus>::expandChild(const NodeId sn, const size_t a, const size_t s1, const unsigned depth) {
+        AI_PROFILE_SCOPE(stats_.expansionTime);
+        if ( isMemoryFull() ) {
+            // The tree cannot grow, so we can only descend into nodes
+            // which already have their actions; all others become leaves.
+            const auto child = graph_.getChild(sn, a, s1);
+            if ( child != Graph::NoNode && graph_.isExpanded(child) ) return {child, false};
+            ++stats_.memoryLimited;
+            return {Graph::NoNode, true};
+        }
+        if ( transpositions_.isEnabled() && graph_.getChild(sn, a, s1) == Graph::NoNode ) {
+            const auto key = getTranspositionKey(s1, depth);
+            if ( const auto node = transpositions_.lookup(key); node != TranspositionTable::NoNode ) {
+                ++stats_.transpositions;
+                graph_.linkChild(sn, a, s1, node);
+                graph_.expand(node);
+                return {node, false};
+            }
+            const auto retval = graph_.addChild(sn, a, s1);
+            transpositions_.insert(key, retval.first);
+            return retval;
+        }
+        const auto retval = graph_.addChild(sn, a, s1);
+        // Since most memory is allocated on the leaves, we do not
+        // allocate on node creation but only when we are actually
+        // descending into a node. If the node already has memory this
+        // should not do anything in any case.
+        if ( !retval.second ) graph_.expand(retval.first);
+        return retval;
+    }
 
-        auto bestIterator = begin++;
-        double bestValue = evaluationFunction(*bestIterator);
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::getTranspositionKey(const size_t s, const unsigned depth) const {
+        return transpositionDepth_ ? s * (maxDepth_ + 1) + depth : s;
+    }
+
+    template <typename M, typename Bonus>
+    bool MCTS<M, Bonus>::isMemoryFull() const {
+        return maxMemory_ && graph_.getUsedMemory() >= maxMemory_;
+    }
+
+    template <typename M, typename Bonus>
+    bool MCTS<M, Bonus>::isQueueingLeaves() const {
+        if ( evaluator_ ) return true;
+        if constexpr (is_generative_model_batch_v<M>) return batchSize_ > 1;
+        return false;
+    }
 
-        for ( ; begin < end; ++begin ) {
-            double actionValue = evaluationFunction(*begin);
-            if ( actionValue > bestValue ) {
-                bestValue = actionValue;
-                bestIterator = begin;
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::flushBatch() {
+        AI_PROFILE_SCOPE(stats_.rolloutTime);
+        if constexpr (is_generative_model_batch_v<M>) {
+            if ( !evaluator_ ) {
+                batch_.flush(graph_, [this](const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values) {
+                    rolloutBatch(model_, states, horizons, values, &rolloutSamples_, rand_);
+                }, model_.getDiscount());
+                return;
             }
         }
+        batch_.flush(graph_, evaluator_, model_.getDiscount());
+    }
 
-        return bestIterator;
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::findBestBonusA(const NodeId id, const unsigned count) {
+        AI_PROFILE_SCOPE(stats_.selectionTime);
+        return selectBonusAction(bonus_, exploration_, count, graph_.getValues(id), graph_.getCounts(id), graph_.getSquares(id), A, scores_);
     }
 
-    template <typename M>
-    void MCTS<M>::setIterations(const unsigned iter) {
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setIterations(const unsigned iter) {
         iterations_ = iter;
     }
 
-    template <typename M>
-    void MCTS<M>::setExploration(const double exp) {
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setExploration(const double exp) {
         exploration_ = exp;
     }
 
-    template <typename M>
-    const M& MCTS<M>::getModel() const {
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setLeafEvaluator(BatchEvaluator eval, const size_t batchSize) {
+        evaluator_ = std::move(eval);
+        batchSize_ = batchSize;
+    }
+
+    template <typename M, typename Bonus>
+    const M& MCTS<M, Bonus>::getModel() const {
         return model_;
     }
 
-    template <typename M>
-    const typename MCTS<M>::StateNode& MCTS<M>::getGraph() const {
+    template <typename M, typename Bonus>
+    const typename MCTS<M, Bonus>::Graph& MCTS<M, Bonus>::getGraph() const {
         return graph_;
     }
 
-    template <typename M>
-    unsigned MCTS<M>::getIterations() const {
+    template <typename M, typename Bonus>
+    unsigned MCTS<M, Bonus>::getIterations() const {
         return iterations_;
     }
 
-    template <typename M>
-    double MCTS<M>::getExploration() const {
+    template <typename M, typename Bonus>
+    double MCTS<M, Bonus>::getExploration() const {
         return exploration_;
     }
+
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::getLeafBatchSize() const {
+        return batchSize_;
+    }
+
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setRolloutCache(RolloutCache cache, const unsigned depthBucket) {
+        rolloutCache_ = std::move(cache);
+        depthBucket_ = std::max(1u, depthBucket);
+    }
+
+    template <typename M, typename Bonus>
+    const RolloutCache & MCTS<M, Bonus>::getRolloutCache() const {
+        return rolloutCache_;
+    }
+
+    template <typename M, typename Bonus>
+    unsigned MCTS<M, Bonus>::getRolloutCacheDepthBucket() const {
+        return depthBucket_;
+    }
+
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setTranspositionTable(TranspositionTable table, const bool useDepth) {
+        transpositions_ = std::move(table);
+        transpositionDepth_ = useDepth;
+    }
+
+    template <typename M, typename Bonus>
+    const TranspositionTable & MCTS<M, Bonus>::getTranspositionTable() const {
+        return transpositions_;
+    }
+
+    template <typename M, typename Bonus>
+    bool MCTS<M, Bonus>::getTranspositionUsesDepth() const {
+        return transpositionDepth_;
+    }
+
+    template <typename M, typename Bonus>
+    void MCTS<M, Bonus>::setMaxMemory(const size_t bytes) {
+        maxMemory_ = bytes;
+    }
+
+    template <typename M, typename Bonus>
+    size_t MCTS<M, Bonus>::getMaxMemory() const {
+        return maxMemory_;
+    }
+
+    template <typename M, typename Bonus>
+    const SearchStatistics & MCTS<M, Bonus>::getSearchStatistics() const {
+        return stats_;
+    }
 }
 
 #endif
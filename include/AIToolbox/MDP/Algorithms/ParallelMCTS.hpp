@@ -0,0 +1,584 @@
+#ifndef AI_TOOLBOX_MDP_PARALLEL_MCTS_HEADER_FILE
+#define AI_TOOLBOX_MDP_PARALLEL_MCTS_HEADER_FILE
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents the MCTS online planner using UCB1, parallelized over multiple threads.
+     *
+     * This class implements the same algorithm as MCTS, but splits the
+     * rollouts between the threads of a ThreadPool. Two parallelization
+     * schemes are supported:
+     *
+     * - Mode::Root: each thread grows its own independent tree, using its
+     *   share of the rollouts. At the end of the search, the statistics of
+     *   the root actions of all trees are merged, weighting the value of
+     *   each action by its visit counts. Threads never synchronize during
+     *   the search.
+     *
+     * - Mode::Tree: all threads grow a single shared tree. Each state node
+     *   is protected by its own lock, which is only held while selecting
+     *   an action and while updating the statistics, so that threads
+     *   working on different parts of the tree do not contend. To keep
+     *   threads from all following the same path, each thread which is
+     *   currently descending through an action applies a virtual loss to
+     *   it: the action is temporarily counted as visited once more, with
+     *   a return equal to minus the virtual loss. This is undone when the
+     *   thread backs up its result.
+     *
+     * Each search draws a seed from the internal RandomEngine, which is
+     * seeded from Impl::Seeder, and each worker uses the stream of that
+     * seed identified by its index (see makeEngineStream()). If the
+     * RandomEngine is counter-based (see AI_COUNTER_BASED_RNG), with tree
+     * parallelism each rollout rather uses the stream identified by its
+     * iteration number, which is cheap to create. If the model supports
+     * sampling with an external random engine (see
+     * is_generative_model_rng), each thread samples it independently.
+     * Otherwise, calls to the model's sampleSR() are serialized, which is
+     * correct but limits scaling.
+     *
+     * If no ThreadPool is set, this class runs all rollouts in the calling
+     * thread, and behaves like MCTS.
+     *
+     * Root parallelism is thus reproducible given the seed of the
+     * Impl::Seeder and the number of workers, regardless of how threads
+     * are scheduled. With tree parallelism each rollout samples the same
+     * random numbers, but since threads interleave nondeterministically
+     * the tree they see, and thus the results, are not reproducible
+     * between runs unless a single thread is used.
+     */
+    template <typename M>
+    class ParallelMCTS {
+        static_assert(is_generative_model_v<M>, "This class only works for generative MDP models!");
+
+        public:
+            enum class Mode { Root, Tree };
+
+            struct StateNode;
+            using StateNodes = std::unordered_map<size_t, StateNode>;
+
+            struct ActionNode {
+                StateNodes children;
+                double V = 0.0;
+                unsigned N = 0;
+                // Number of threads currently descending through this action.
+                unsigned pending = 0;
+            };
+            using ActionNodes = std::vector<ActionNode>;
+
+            struct StateNode {
+                StateNode() : N(0) {}
+                // Nodes are only moved while no search is running, so
+                // their lock does not need to be moved.
+                StateNode(StateNode && other) noexcept : children(std::move(other.children)), N(other.N) {}
+                StateNode & operator=(StateNode && other) noexcept {
+                    children = std::move(other.children);
+                    N = other.N;
+                    return *this;
+                }
+
+                ActionNodes children;
+                unsigned N;
+                std::mutex mutex;
+            };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * @param m The MDP model that ParallelMCTS will operate upon.
+             * @param iterations The number of episodes to run before completion.
+             * @param exp The exploration constant. This parameter is VERY important to determine the final MCTS performance.
+             * @param mode The parallelization scheme to use.
+             * @param pool The ThreadPool to use, or nullptr.
+             * @param virtualLoss The virtual loss applied to actions being explored by other threads.
+             */
+            ParallelMCTS(const M& m, unsigned iterations, double exp, Mode mode = Mode::Tree, ThreadPool * pool = nullptr, double virtualLoss = 1.0);
+
+            /**
+             * @brief This function resets the internal graph and samples for the provided state and horizon.
+             *
+             * @param s The initial state for the environment.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best action.
+             */
+            size_t sampleAction(size_t s, unsigned horizon);
+
+            /**
+             * @brief This function uses the internal graph to plan.
+             *
+             * \sa MCTS::sampleAction(size_t, size_t, unsigned)
+             *
+             * With root parallelism, each thread's tree is pruned
+             * independently.
+             *
+             * @param a The action taken in the last timestep.
+             * @param s1 The state experienced after the action was taken.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best action.
+             */
+            size_t sampleAction(size_t a, size_t s1, unsigned horizon);
+
+            /**
+             * @brief This function sets the number of performed rollouts in ParallelMCTS.
+             *
+             * This is the total number of rollouts, which are split
+             * between all threads.
+             *
+             * @param iter The new number of rollouts.
+             */
+            void setIterations(unsigned iter);
+
+            /**
+             * @brief This function sets the new exploration constant for ParallelMCTS.
+             *
+             * \sa MCTS::setExploration(double)
+             *
+             * @param exp The new exploration constant.
+             */
+            void setExploration(double exp);
+
+            /**
+             * @brief This function sets the virtual loss used with tree parallelism.
+             *
+             * Higher values push threads to explore different branches of
+             * the tree. The virtual loss should be on the same scale as the
+             * returns of the problem.
+             *
+             * @param virtualLoss The new virtual loss.
+             */
+            void setVirtualLoss(double virtualLoss);
+
+            /**
+             * @brief This function sets the ThreadPool to use.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * Changing the ThreadPool resets the internal graph.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the MDP generative model being used.
+             *
+             * @return The MDP generative model.
+             */
+            const M& getModel() const;
+
+            /**
+             * @brief This function returns a reference to the internal graph structure holding the results of rollouts.
+             *
+             * With tree parallelism, this is the shared tree. With root
+             * parallelism, this only contains the merged statistics of the
+             * root actions, without any children.
+             *
+             * @return The internal graph.
+             */
+            const StateNode& getGraph() const;
+
+            /**
+             * @brief This function returns the number of iterations performed to plan for an action.
+             *
+             * @return The number of iterations.
+             */
+            unsigned getIterations() const;
+
+            /**
+             * @brief This function returns the currently set exploration constant.
+             *
+             * @return The exploration constant.
+             */
+            double getExploration() const;
+
+            /**
+             * @brief This function returns the currently set virtual loss.
+             *
+             * @return The virtual loss.
+             */
+            double getVirtualLoss() const;
+
+            /**
+             * @brief This function returns the parallelization scheme used.
+             *
+             * @return The parallelization mode.
+             */
+            Mode getMode() const;
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+        private:
+            struct Worker {
+                // Only used with root parallelism.
+                StateNode graph;
+                // Reseeded at the start of each search.
+                RandomEngine rand;
+            };
+
+            const M& model_;
+            size_t S, A;
+            unsigned iterations_, maxDepth_;
+            double exploration_, virtualLoss_;
+            Mode mode_;
+            ThreadPool * pool_;
+
+            StateNode graph_;
+            std::vector<Worker> workers_;
+
+            std::atomic<unsigned> nextIteration_;
+            mutable std::mutex modelMutex_;
+
+            // Only used to seed the workers, from the calling thread.
+            RandomEngine rand_;
+
+            // Private Methods
+            size_t runSimulation(size_t s, unsigned horizon);
+            void mergeRoots();
+
+            template <bool Shared>
+            double simulate(StateNode & sn, size_t s, unsigned depth, RandomEngine & rnd);
+            double rollout(size_t s, unsigned depth, RandomEngine & rnd);
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a, RandomEngine & rnd) const;
+
+            static void resetNode(StateNode & sn, size_t A);
+            static void pruneNode(StateNode & sn, size_t a, size_t s1, size_t A);
+
+            template <typename Iterator>
+            Iterator findBestA(Iterator begin, Iterator end);
+
+            template <typename Iterator>
+            Iterator findBestBonusA(Iterator begin, Iterator end, unsigned count);
+    };
+
+    template <typename M>
+    ParallelMCTS<M>::ParallelMCTS(const M& m, const unsigned iter, const double exp, const Mode mode, ThreadPool * pool, const double virtualLoss) :
+            model_(m), S(model_.getS()), A(model_.getA()), iterations_(iter),
+            exploration_(exp), virtualLoss_(virtualLoss), mode_(mode), pool_(nullptr), graph_(),
+            rand_(Impl::Seeder::getSeed())
+    {
+        setThreadPool(pool);
+    }
+
+    template <typename M>
+    size_t ParallelMCTS<M>::sampleAction(const size_t s, const unsigned horizon) {
+        resetNode(graph_, A);
+        if ( mode_ == Mode::Root )
+            for ( auto & w : workers_ )
+                resetNode(w.graph, A);
+
+        return runSimulation(s, horizon);
+    }
+
+    template <typename M>
+    size_t ParallelMCTS<M>::sampleAction(const size_t a, const size_t s1, const unsigned horizon) {
+        if ( mode_ == Mode::Tree ) {
+            if ( graph_.children[a].children.find(s1) == graph_.children[a].children.end() )
+                return sampleAction(s1, horizon);
+
+            pruneNode(graph_, a, s1, A);
+        } else {
+            for ( auto & w : workers_ )
+                pruneNode(w.graph, a, s1, A);
+        }
+
+        return runSimulation(s1, horizon);
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::resetNode(StateNode & sn, const size_t A) {
+        sn = StateNode();
+        sn.children.resize(A);
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::pruneNode(StateNode & sn, const size_t a, const size_t s1, const size_t A) {
+        auto & states = sn.children[a].children;
+
+        auto it = states.find(s1);
+        if ( it == states.end() ) {
+            resetNode(sn, A);
+            return;
+        }
+        // Here we need an additional step, because *it is contained by sn.
+        // If we just move assign, sn is first going to delete everything it
+        // contains (included *it), so we move *it outside first.
+        { auto tmp = std::move(it->second); sn = std::move(tmp); }
+
+        sn.children.resize(A);
+    }
+
+    template <typename M>
+    size_t ParallelMCTS<M>::runSimulation(const size_t s, const unsigned horizon) {
+        if ( !horizon ) return 0;
+
+        maxDepth_ = horizon;
+
+        const size_t W = workers_.size();
+        const unsigned seed = rand_();
+
+        if ( mode_ == Mode::Tree ) {
+            nextIteration_.store(0, std::memory_order_relaxed);
+
+            const auto work = [this, s, seed](const size_t begin, const size_t end) {
+                for ( size_t w = begin; w < end; ++w ) {
+                    auto & rnd = workers_[w].rand;
+                    if constexpr (!is_counter_based_engine_v<RandomEngine>)
+                        rnd = makeEngineStream<RandomEngine>(seed, w);
+
+                    unsigned i;
+                    while ( ( i = nextIteration_.fetch_add(1, std::memory_order_relaxed) ) < iterations_ ) {
+                        if constexpr (is_counter_based_engine_v<RandomEngine>)
+                            rnd = makeEngineStream<RandomEngine>(seed, i);
+                        simulate<true>(graph_, s, 0, rnd);
+                    }
+                }
+            };
+            if ( pool_ ) pool_->parallelFor(W, work);
+            else work(0, W);
+        } else {
+            const auto work = [this, s, W, seed](const size_t begin, const size_t end) {
+                for ( size_t w = begin; w < end; ++w ) {
+                    const unsigned iters = (w + 1) * iterations_ / W - w * iterations_ / W;
+                    auto & worker = workers_[w];
+                    worker.rand = makeEngineStream<RandomEngine>(seed, w);
+                    for ( unsigned i = 0; i < iters; ++i )
+                        simulate<false>(worker.graph, s, 0, worker.rand);
+                }
+            };
+            if ( pool_ ) pool_->parallelFor(W, work);
+            else work(0, W);
+
+            mergeRoots();
+        }
+
+        auto begin = std::begin(graph_.children);
+        return std::distance(begin, findBestA(begin, std::end(graph_.children)));
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::mergeRoots() {
+        resetNode(graph_, A);
+
+        for ( const auto & w : workers_ ) {
+            graph_.N += w.graph.N;
+            for ( size_t a = 0; a < A; ++a ) {
+                const auto & an = w.graph.children[a];
+                auto & merged = graph_.children[a];
+                // Here V temporarily holds the sum of the returns.
+                merged.N += an.N;
+                merged.V += an.V * an.N;
+            }
+        }
+        for ( auto & merged : graph_.children )
+            if ( merged.N ) merged.V /= merged.N;
+    }
+
+    template <typename M>
+    template <bool Shared>
+    double ParallelMCTS<M>::simulate(StateNode & sn, const size_t s, const unsigned depth, RandomEngine & rnd) {
+        std::unique_lock lock(sn.mutex, std::defer_lock);
+
+        // Head update
+        if constexpr (Shared) lock.lock();
+
+        // Since most memory is allocated on the leaves, we do not
+        // allocate on node creation but only when we are actually
+        // descending into a node. This must be done under the lock, as
+        // other threads might be descending here too.
+        sn.children.resize(A);
+        sn.N++;
+
+        auto begin = std::begin(sn.children);
+        const size_t a = std::distance(begin, findBestBonusA(begin, std::end(sn.children), sn.N));
+
+        auto & aNode = sn.children[a];
+        if constexpr (Shared) {
+            aNode.pending++;
+            lock.unlock();
+        }
+
+        auto [s1, rew] = sampleSR(s, a, rnd);
+
+        // We only go deeper if needed (maxDepth_ is always at least 1).
+        if ( depth + 1 < maxDepth_ && !model_.isTerminal(s1) ) {
+            StateNode * child = nullptr;
+            {
+                if constexpr (Shared) lock.lock();
+
+                auto it = aNode.children.find(s1);
+                // Touch node to create it. The references to elements of
+                // an unordered_map are stable, so we can keep using child
+                // after releasing the lock.
+                if ( it == aNode.children.end() ) aNode.children[s1];
+                else                              child = &it->second;
+
+                if constexpr (Shared) lock.unlock();
+            }
+
+            const double futureRew = child ? simulate<Shared>(*child, s1, depth + 1, rnd)
+                                           : rollout(s1, depth + 1, rnd);
+
+            rew += model_.getDiscount() * futureRew;
+        }
+
+        // Action update
+        if constexpr (Shared) {
+            lock.lock();
+            aNode.pending--;
+        }
+        aNode.N++;
+        aNode.V += ( rew - aNode.V ) / static_cast<double>(aNode.N);
+
+        return rew;
+    }
+
+    template <typename M>
+    double ParallelMCTS<M>::rollout(size_t s, unsigned depth, RandomEngine & rnd) {
+        double rew = 0.0, totalRew = 0.0, gamma = 1.0;
+
+        std::uniform_int_distribution<size_t> generator(0, A-1);
+        for ( ; depth < maxDepth_; ++depth ) {
+            std::tie( s, rew ) = sampleSR( s, generator(rnd), rnd );
+            totalRew += gamma * rew;
+
+            if (model_.isTerminal(s))
+                return totalRew;
+
+            gamma *= model_.getDiscount();
+        }
+        return totalRew;
+    }
+
+    template <typename M>
+    std::tuple<size_t, double> ParallelMCTS<M>::sampleSR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        if constexpr (is_generative_model_rng_v<M>) {
+            return model_.sampleSR(s, a, rnd);
+        } else {
+            std::lock_guard lock(modelMutex_);
+            return model_.sampleSR(s, a);
+        }
+    }
+
+    template <typename M>
+    template <typename Iterator>
+    Iterator ParallelMCTS<M>::findBestA(Iterator begin, Iterator end) {
+        return std::max_element(begin, end, [](const ActionNode & lhs, const ActionNode & rhs){ return lhs.V < rhs.V; });
+    }
+
+    template <typename M>
+    template <typename Iterator>
+    Iterator ParallelMCTS<M>::findBestBonusA(Iterator begin, Iterator end, const unsigned count) {
+        // Count here can be as low as 1.
+        // Since log(1) = 0, and 0/0 = error, we add 1.0.
+        const double logCount = std::log(count + 1.0);
+        // Pending visits count as visits with a return of -virtualLoss_.
+        // Without other threads this is the same score used in MCTS.
+        const auto evaluationFunction = [this, logCount](const ActionNode & an){
+            if ( !an.pending )
+                return an.V + exploration_ * std::sqrt( logCount / an.N );
+
+            const double n = an.N + an.pending;
+            const double v = ( an.V * an.N - virtualLoss_ * an.pending ) / n;
+            return v + exploration_ * std::sqrt( logCount / n );
+        };
+
+        auto bestIterator = begin++;
+        double bestValue = evaluationFunction(*bestIterator);
+
+        for ( ; begin < end; ++begin ) {
+            double actionValue = evaluationFunction(*begin);
+            if ( actionValue > bestValue ) {
+                bestValue = actionValue;
+                bestIterator = begin;
+            }
+        }
+
+        return bestIterator;
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::setIterations(const unsigned iter) {
+        iterations_ = iter;
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::setExploration(const double exp) {
+        exploration_ = exp;
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::setVirtualLoss(const double virtualLoss) {
+        virtualLoss_ = virtualLoss;
+    }
+
+    template <typename M>
+    void ParallelMCTS<M>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+
+        workers_.clear();
+        workers_.resize(pool_ ? pool_->getThreadNumber() : 1);
+
+        resetNode(graph_, A);
+        for ( auto & w : workers_ )
+            resetNode(w.graph, A);
+    }
+
+    template <typename M>
+    const M& ParallelMCTS<M>::getModel() const {
+        return model_;
+    }
+
+    template <typename M>
+    const typename ParallelMCTS<M>::StateNode& ParallelMCTS<M>::getGraph() const {
+        return graph_;
+    }
+
+    template <typename M>
+    unsigned ParallelMCTS<M>::getIterations() const {
+        return iterations_;
+    }
+
+    template <typename M>
+    double ParallelMCTS<M>::getExploration() const {
+        return exploration_;
+    }
+
+    template <typename M>
+    double ParallelMCTS<M>::getVirtualLoss() const {
+        return virtualLoss_;
+    }
+
+    template <typename M>
+    typename ParallelMCTS<M>::Mode ParallelMCTS<M>::getMode() const {
+        return mode_;
+    }
+
+    template <typename M>
+    ThreadPool * ParallelMCTS<M>::getThreadPool() const {
+        return pool_;
+    }
+}
+
+#endif
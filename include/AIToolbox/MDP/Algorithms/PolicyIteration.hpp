@@ -21,16 +21,36 @@ namespace AIToolbox::MDP {
      *
      * When the policy does not change anymore, it is guaranteed to be
      * optimal, and the found QFunction is returned.
+     *
+     * The horizon parameter bounds the number of evaluation sweeps done for
+     * each policy. Using a small horizon results in the modified policy
+     * iteration algorithm: each policy is only partially evaluated before
+     * being improved, and the values are carried over from one iteration
+     * to the next. This is often much faster than fully evaluating every
+     * policy, as most of the early policies are discarded anyway.
+     *
+     * With a truncated evaluation the policy may become stable before its
+     * values have converged. If the modified mode is enabled (see
+     * setModified()) and the model is discounted, the algorithm then also
+     * requires the last evaluation to have converged within the tolerance
+     * before stopping. Otherwise, it stops as soon as the policy is stable.
+     *
+     * In all cases, the number of policy evaluations can be bounded with
+     * the maxIterations parameter.
+     *
+     * The evaluation sweeps can be parallelized with a user-provided
+     * ThreadPool (see setThreadPool()).
      */
     class PolicyIteration {
         public:
             /**
              * @brief Basic constructor.
              *
-             * @param horizon The horizon parameter to use during the PolicyEvaluation phase.
+             * @param horizon The maximum number of evaluation sweeps for each policy.
              * @param tolerance The tolerance parameter to use during the PolicyEvaluation phase.
+             * @param maxIterations The maximum number of policies to evaluate, or 0 for no limit.
              */
-            PolicyIteration(unsigned horizon, double tolerance = 0.001);
+            PolicyIteration(unsigned horizon, double tolerance = 0.001, unsigned maxIterations = 0);
 
             /**
              * @brief This function applies policy iteration on an MDP to solve it.
@@ -55,6 +75,37 @@ namespace AIToolbox::MDP {
              */
             void setHorizon(unsigned h);
 
+            /**
+             * @brief This function sets the maximum number of policies to evaluate.
+             *
+             * @param maxIterations The maximum number of iterations, or 0 for no limit.
+             */
+            void setMaxIterations(unsigned maxIterations);
+
+            /**
+             * @brief This function sets whether to run modified policy iteration.
+             *
+             * In the modified mode, with a discount lower than 1, the
+             * algorithm does not stop when the policy is stable until the
+             * last evaluation has also converged within the tolerance.
+             * Without discount the evaluation is not guaranteed to
+             * converge, so this check is skipped.
+             *
+             * @param modified Whether to require the values to converge.
+             */
+            void setModified(bool modified);
+
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize the evaluation sweeps.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function returns the currently set tolerance parameter.
              */
@@ -65,9 +116,27 @@ namespace AIToolbox::MDP {
              */
             unsigned getHorizon() const;
 
+            /**
+             * @brief This function returns the currently set maximum number of iterations.
+             */
+            unsigned getMaxIterations() const;
+
+            /**
+             * @brief This function returns whether modified policy iteration is enabled.
+             */
+            bool isModified() const;
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
             unsigned horizon_;
             double tolerance_;
+            unsigned maxIterations_;
+            bool modified_;
+            ThreadPool * pool_;
     };
 
     template <typename M, typename>
@@ -76,28 +145,41 @@ namespace AIToolbox::MDP {
         const auto A = m.getA();
 
         PolicyEvaluation<M> eval(m, horizon_, tolerance_);
+        eval.setThreadPool(pool_);
 
         auto qfun = makeQFunction(m.getS(), m.getA());
         QGreedyPolicy p(qfun);
         auto matrix = p.getPolicy();
+        Matrix2D newMatrix;
 
-        {
-nextLoop:
+        // Without discount the truncated evaluations never converge.
+        const bool checkValues = modified_ && m.getDiscount() < 1.0;
+
+        unsigned iteration = 0;
+        while (true) {
             auto [bound, v, q] = eval(p);
-            (void)bound;
 
             eval.setValues(std::move(v));
             qfun = std::move(q);
 
-            auto newMatrix = p.getPolicy();
-            for (size_t s = 0; s < S; ++s) {
-                for (size_t a = 0; a < A; ++a) {
-                    if (checkDifferentSmall(matrix(s,a), newMatrix(s,a))) {
-                        matrix = std::move(newMatrix);
-                        goto nextLoop;
-                    }
-                }
+            if (maxIterations_ && ++iteration >= maxIterations_)
+                break;
+
+            // We swap the two matrices, so that no iteration allocates.
+            p.getPolicyInto(&newMatrix);
+            bool changed = false;
+            for (size_t s = 0; s < S && !changed; ++s)
+                for (size_t a = 0; a < A && !changed; ++a)
+                    changed = checkDifferentSmall(matrix(s,a), newMatrix(s,a));
+
+            if (changed) {
+                matrix.swap(newMatrix);
+                continue;
             }
+            // With a truncated evaluation the policy may be stable before
+            // its values have converged, so we keep going until they do.
+            if (!checkValues || bound <= tolerance_)
+                break;
         }
 
         return std::move(qfun);
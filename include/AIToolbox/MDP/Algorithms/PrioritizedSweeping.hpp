@@ -1,16 +1,17 @@
 #ifndef AI_TOOLBOX_MDP_PRIORITIZED_SWEEPING_HEADER_FILE
 #define AI_TOOLBOX_MDP_PRIORITIZED_SWEEPING_HEADER_FILE
 
+#include <algorithm>
 #include <tuple>
-#include <unordered_map>
-
-#include <boost/heap/fibonacci_heap.hpp>
+#include <utility>
+#include <vector>
 
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
 
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/IndexedHeap.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -39,8 +40,26 @@ namespace AIToolbox::MDP {
      *
      * Given how this algorithm updates the QFunction, the only problems
      * supported by this approach are ones with an infinite horizon.
+     *
+     * To find the pairs leading to each state extracted from the queue,
+     * this class keeps a reverse index of the transitions of the model,
+     * from each state to the sorted list of state-action pairs which can
+     * lead to it. The index is built on construction, and each call to
+     * stepUpdateQ() adds the transitions of its pair that the model has
+     * gained since, so that it stays up to date with learned models like
+     * RLModel and SparseRLModel as long as each synced pair is then
+     * updated. Transitions which disappear from the model are removed
+     * lazily. This way, each state extracted from the queue only costs its
+     * number of predecessors, rather than a scan of all S*A pairs.
+     *
+     * The queue type can be selected via the Queue template parameter. It
+     * must be a max-priority queue over the states, with the interface of
+     * IndexedDaryHeap (the default), such as IndexedFibonacciHeap.
+     *
+     * @tparam M The type of the model.
+     * @tparam Queue The type of the priority queue of states.
      */
-    template <typename M>
+    template <typename M, typename Queue = IndexedDaryHeap<>>
     class PrioritizedSweeping {
         static_assert(is_model_v<M>, "This class only works for MDP models!");
 
@@ -61,6 +80,9 @@ namespace AIToolbox::MDP {
              * whether any parent couple that can lead to this state is worth pushing
              * into the queue.
              *
+             * The transitions of the pair are also added to the index of
+             * predecessors, if they were not there already.
+             *
              * @param s The previous state.
              * @param a The action performed.
              */
@@ -77,6 +99,41 @@ namespace AIToolbox::MDP {
              */
             void batchUpdateQ();
 
+            /**
+             * @brief This function updates a QFunction based on simulated experience, using an index of predecessors.
+             *
+             * This function is equivalent to batchUpdateQ(), but instead
+             * of scanning all state-action pairs of the model to find the
+             * ones leading to each extracted state, it reads them from the
+             * input index. This is much faster when the transition
+             * function is sparse.
+             *
+             * For each state s1, predecessors[s1] must be a range of
+             * (s, a) pairs containing all the pairs with a non-zero
+             * probability of transitioning to s1. If the pairs are sorted,
+             * the result is the same as batchUpdateQ().
+             *
+             * @param predecessors The index of predecessors of each state.
+             */
+            template <typename P>
+            void batchUpdateQ(const P & predecessors);
+
+            /**
+             * @brief This function rebuilds the index of predecessors from the model.
+             *
+             * This is only needed if the model has changed in pairs which
+             * have not been passed to stepUpdateQ() since.
+             */
+            void rebuildPredecessors();
+
+            /**
+             * @brief This function returns the index of predecessors.
+             *
+             * The index may contain pairs whose transition has since
+             * disappeared from the model.
+             */
+            const std::vector<std::vector<std::pair<size_t, size_t>>> & getPredecessors() const;
+
             /**
              * @brief This function sets the theta parameter.
              *
@@ -148,6 +205,8 @@ namespace AIToolbox::MDP {
             const ValueFunction & getValueFunction() const;
 
         private:
+            void addPredecessor(size_t s, size_t a, size_t s1);
+
             size_t S, A;
             unsigned N;
             double theta_;
@@ -156,37 +215,43 @@ namespace AIToolbox::MDP {
             QFunction qfun_;
             ValueFunction vfun_;
 
-            using PriorityQueueElement = std::tuple<double, size_t>;
-            enum {
-                PRIORITY = 0,
-                STATE    = 1,
-            };
+            Queue queue_;
 
-            class PriorityTupleLess {
-                public:
-                    bool operator() (const PriorityQueueElement& arg1, const PriorityQueueElement& arg2) const;
-            };
-
-            using QueueType = boost::heap::fibonacci_heap<PriorityQueueElement, boost::heap::compare<PriorityTupleLess>>;
-
-            QueueType queue_;
-
-            std::unordered_map<size_t, typename QueueType::handle_type> queueHandles_;
+            std::vector<std::vector<std::pair<size_t, size_t>>> predecessors_;
+            std::vector<std::pair<size_t, size_t>> toUpdate_;
     };
 
-    template <typename M>
-    bool PrioritizedSweeping<M>::PriorityTupleLess::operator() (const PriorityQueueElement& arg1, const PriorityQueueElement& arg2) const
+    template <typename M, typename Queue>
+    PrioritizedSweeping<M, Queue>::PrioritizedSweeping(const M & m, const double theta, const unsigned n) :
+            S(m.getS()), A(m.getA()), N(n), theta_(theta), model_(m),
+            qfun_(makeQFunction(S,A)), vfun_(makeValueFunction(S)), queue_(S)
     {
-        return std::get<PRIORITY>(arg1) < std::get<PRIORITY>(arg2);
+        rebuildPredecessors();
     }
 
-    template <typename M>
-    PrioritizedSweeping<M>::PrioritizedSweeping(const M & m, const double theta, const unsigned n) :
-            S(m.getS()), A(m.getA()), N(n), theta_(theta), model_(m),
-            qfun_(makeQFunction(S,A)), vfun_(makeValueFunction(S)) {}
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::addPredecessor(const size_t s, const size_t a, const size_t s1) {
+        const std::pair<size_t, size_t> pair(s, a);
+        auto & preds = predecessors_[s1];
+        const auto it = std::lower_bound(std::begin(preds), std::end(preds), pair);
+        if ( it == std::end(preds) || *it != pair )
+            preds.insert(it, pair);
+    }
+
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::rebuildPredecessors() {
+        predecessors_.clear();
+        predecessors_.resize(S);
+        // Visiting pairs in order keeps each list sorted.
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                forEachSuccessor(model_, s, a, [&](const size_t s1, const double p) {
+                    if ( checkDifferentSmall( p, 0.0 ) ) predecessors_[s1].emplace_back(s, a);
+                });
+    }
 
-    template <typename M>
-    void PrioritizedSweeping<M>::stepUpdateQ(const size_t s, const size_t a) {
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::stepUpdateQ(const size_t s, const size_t a) {
         auto & values = vfun_.values;
 
         // Update q[s][a]
@@ -202,6 +267,10 @@ namespace AIToolbox::MDP {
             qfun_(s, a) = newQValue;
         }
 
+        forEachSuccessor(model_, s, a, [&](const size_t s1, const double p) {
+            if ( checkDifferentSmall( p, 0.0 ) ) addPredecessor(s, a, s1);
+        });
+
         double p = values[s];
         {
             // Update value and action
@@ -212,78 +281,98 @@ namespace AIToolbox::MDP {
 
         // If it changed enough, we're going to update its parents.
         if ( p > theta_ ) {
-            auto it = queueHandles_.find(s);
-
-            if ( it != std::end(queueHandles_) && std::get<PRIORITY>(*(it->second)) < p )
-                queue_.increase(it->second, std::make_tuple(p, s));
-            else
-                queueHandles_[s] = queue_.push(std::make_tuple(p, s));
+            if ( !queue_.contains(s) )
+                queue_.push(s, p);
+            else if ( queue_.getPriority(s) < p )
+                queue_.increase(s, p);
         }
     }
 
-    template <typename M>
-    void PrioritizedSweeping<M>::batchUpdateQ() {
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::batchUpdateQ() {
         for ( unsigned i = 0; i < N; ++i ) {
             if ( queue_.empty() ) return;
 
             // The state we extract has been processed already
             // So it is the future we have to backtrack from.
-            size_t s1;
-            std::tie(std::ignore, s1) = queue_.top();
+            const size_t s1 = queue_.top();
+            queue_.pop();
+
+            // Drop the transitions which are not in the model anymore.
+            auto & preds = predecessors_[s1];
+            preds.erase(std::remove_if(std::begin(preds), std::end(preds), [&](const auto & pair) {
+                return !checkDifferentSmall(model_.getTransitionProbability(pair.first, pair.second, s1), 0.0);
+            }), std::end(preds));
+
+            // We copy the list as stepUpdateQ() can modify the index.
+            toUpdate_.assign(std::begin(preds), std::end(preds));
+            for ( const auto & [s, a] : toUpdate_ )
+                stepUpdateQ(s, a);
+        }
+    }
 
+    template <typename M, typename Queue>
+    template <typename P>
+    void PrioritizedSweeping<M, Queue>::batchUpdateQ(const P & predecessors) {
+        for ( unsigned i = 0; i < N; ++i ) {
+            if ( queue_.empty() ) return;
+
+            const size_t s1 = queue_.top();
             queue_.pop();
-            queueHandles_.erase(s1);
 
-            for ( size_t s = 0; s < S; ++s )
-                for ( size_t a = 0; a < A; ++a )
-                    if ( checkDifferentSmall(model_.getTransitionProbability(s,a,s1), 0.0) )
-                        stepUpdateQ(s, a);
+            for ( const auto & [s, a] : predecessors[s1] )
+                stepUpdateQ(s, a);
         }
     }
 
-    template <typename M>
-    void PrioritizedSweeping<M>::setN(const unsigned n) {
+    template <typename M, typename Queue>
+    const std::vector<std::vector<std::pair<size_t, size_t>>> & PrioritizedSweeping<M, Queue>::getPredecessors() const {
+        return predecessors_;
+    }
+
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::setN(const unsigned n) {
         N = n;
     }
 
-    template <typename M>
-    unsigned PrioritizedSweeping<M>::getN() const {
+    template <typename M, typename Queue>
+    unsigned PrioritizedSweeping<M, Queue>::getN() const {
         return N;
     }
 
-    template <typename M>
-    void PrioritizedSweeping<M>::setQueueThreshold(const double t) {
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::setQueueThreshold(const double t) {
         if ( t < 0.0 ) throw std::invalid_argument("Theta parameter must be >= 0");
         theta_ = t;
     }
 
-    template <typename M>
-    double PrioritizedSweeping<M>::getQueueThreshold() const {
+    template <typename M, typename Queue>
+    double PrioritizedSweeping<M, Queue>::getQueueThreshold() const {
         return theta_;
     }
 
-    template <typename M>
-    size_t PrioritizedSweeping<M>::getQueueLength() const {
+    template <typename M, typename Queue>
+    size_t PrioritizedSweeping<M, Queue>::getQueueLength() const {
         return queue_.size();
     }
 
-    template <typename M>
-    const M & PrioritizedSweeping<M>::getModel() const {
+    template <typename M, typename Queue>
+    const M & PrioritizedSweeping<M, Queue>::getModel() const {
         return model_;
     }
 
-    template <typename M>
-    const QFunction & PrioritizedSweeping<M>::getQFunction() const {
+    template <typename M, typename Queue>
+    const QFunction & PrioritizedSweeping<M, Queue>::getQFunction() const {
         return qfun_;
     }
 
-    template <typename M>
-    void PrioritizedSweeping<M>::setQFunction(const QFunction & qfun) {
+    template <typename M, typename Queue>
+    void PrioritizedSweeping<M, Queue>::setQFunction(const QFunction & qfun) {
         qfun_ = qfun;
     }
 
-    template <typename M>
-    const ValueFunction & PrioritizedSweeping<M>::getValueFunction() const {
+    template <typename M, typename Queue>
+    const ValueFunction & PrioritizedSweeping<M, Queue>::getValueFunction() const {
         return vfun_;
     }
 }
@@ -0,0 +1,176 @@
+#ifndef AI_TOOLBOX_MDP_PRIORITIZED_SWEEPING_PIPELINE_HEADER_FILE
+#define AI_TOOLBOX_MDP_PRIORITIZED_SWEEPING_PIPELINE_HEADER_FILE
+
+#include <stdexcept>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/SparseRLModel.hpp>
+#include <AIToolbox/MDP/Algorithms/PrioritizedSweeping.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class fuses the SparseExperience, SparseRLModel and PrioritizedSweeping of an online model-based learner.
+     *
+     * Learning online with PrioritizedSweeping requires, for each
+     * transition, to record it in a SparseExperience, sync the
+     * SparseRLModel, and call stepUpdateQ() and batchUpdateQ() on the
+     * solver, in this exact order.
+     *
+     * This class owns all three, and updates them together from single
+     * transitions or from whole batches. For each batch, the transitions
+     * are recorded, each touched state-action pair is synced and updated
+     * exactly once (which also keeps the index of predecessors of
+     * PrioritizedSweeping up to date), and only then the queue is
+     * processed.
+     *
+     * @tparam Queue The type of the priority queue of PrioritizedSweeping.
+     */
+    template <typename Queue = IndexedDaryHeap<>>
+    class PrioritizedSweepingPipeline {
+        public:
+            using Model = SparseRLModel<SparseExperience>;
+            using Solver = PrioritizedSweeping<Model, Queue>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param S The number of states.
+             * @param A The number of actions.
+             * @param discount The discount of the learned model.
+             * @param theta The queue threshold of PrioritizedSweeping.
+             * @param n The number of states processed from the queue after each update.
+             */
+            PrioritizedSweepingPipeline(size_t S, size_t A, double discount = 1.0, double theta = 0.5, unsigned n = 50);
+
+            // The model and solver hold references to the experience and model.
+            PrioritizedSweepingPipeline(const PrioritizedSweepingPipeline &) = delete;
+            PrioritizedSweepingPipeline & operator=(const PrioritizedSweepingPipeline &) = delete;
+
+            /**
+             * @brief This function learns from a single transition.
+             *
+             * @param s The initial state.
+             * @param a The action performed.
+             * @param s1 The final state.
+             * @param rew The reward obtained.
+             */
+            void stepUpdateQ(size_t s, size_t a, size_t s1, double rew);
+
+            /**
+             * @brief This function learns from a batch of transitions.
+             *
+             * The nextActions field of the batch is ignored.
+             *
+             * @param batch The transitions to learn from.
+             */
+            void batchUpdateQ(const TransitionBatch & batch);
+
+            /**
+             * @brief This function returns the underlying SparseExperience.
+             */
+            const SparseExperience & getExperience() const;
+
+            /**
+             * @brief This function returns the underlying SparseRLModel.
+             */
+            const Model & getModel() const;
+
+            /**
+             * @brief This function returns the underlying PrioritizedSweeping.
+             *
+             * This can be used to change its parameters, or to set its
+             * QFunction.
+             */
+            Solver & getSolver();
+
+            /**
+             * @brief This function returns the underlying PrioritizedSweeping.
+             */
+            const Solver & getSolver() const;
+
+            /**
+             * @brief This function returns the learned QFunction.
+             */
+            const QFunction & getQFunction() const;
+
+            /**
+             * @brief This function returns the learned ValueFunction.
+             */
+            const ValueFunction & getValueFunction() const;
+
+        private:
+            void update();
+
+            size_t S, A;
+
+            SparseExperience exp_;
+            Model model_;
+            Solver solver_;
+    };
+
+    template <typename Queue>
+    PrioritizedSweepingPipeline<Queue>::PrioritizedSweepingPipeline(const size_t s, const size_t a, const double discount, const double theta, const unsigned n) :
+            S(s), A(a), exp_(S, A), model_(exp_, discount), solver_(model_, theta, n) {}
+
+    template <typename Queue>
+    void PrioritizedSweepingPipeline<Queue>::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
+        exp_.record(s, a, s1, rew);
+        update();
+    }
+
+    template <typename Queue>
+    void PrioritizedSweepingPipeline<Queue>::batchUpdateQ(const TransitionBatch & batch) {
+        const auto N = batch.states.size();
+        if ( batch.actions.size() != N || batch.nextStates.size() != N || batch.rewards.size() != N )
+            throw std::invalid_argument("TransitionBatch fields have different sizes");
+
+        for ( size_t i = 0; i < N; ++i )
+            exp_.record(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+        update();
+    }
+
+    template <typename Queue>
+    void PrioritizedSweepingPipeline<Queue>::update() {
+        const auto & dirty = exp_.getDirtyPairs();
+        for ( const auto & [s, a] : dirty ) {
+            model_.sync(s, a);
+            solver_.stepUpdateQ(s, a);
+        }
+        exp_.clearDirtyPairs();
+
+        solver_.batchUpdateQ();
+    }
+
+    template <typename Queue>
+    const SparseExperience & PrioritizedSweepingPipeline<Queue>::getExperience() const {
+        return exp_;
+    }
+
+    template <typename Queue>
+    const typename PrioritizedSweepingPipeline<Queue>::Model & PrioritizedSweepingPipeline<Queue>::getModel() const {
+        return model_;
+    }
+
+    template <typename Queue>
+    typename PrioritizedSweepingPipeline<Queue>::Solver & PrioritizedSweepingPipeline<Queue>::getSolver() {
+        return solver_;
+    }
+
+    template <typename Queue>
+    const typename PrioritizedSweepingPipeline<Queue>::Solver & PrioritizedSweepingPipeline<Queue>::getSolver() const {
+        return solver_;
+    }
+
+    template <typename Queue>
+    const QFunction & PrioritizedSweepingPipeline<Queue>::getQFunction() const {
+        return solver_.getQFunction();
+    }
+
+    template <typename Queue>
+    const ValueFunction & PrioritizedSweepingPipeline<Queue>::getValueFunction() const {
+        return solver_.getValueFunction();
+    }
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/Utils/StripedSpinLock.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -131,6 +132,11 @@ namespace AIToolbox::MDP {
              * update the QFunction. This is a very efficient method to
              * keep the QFunction up to date with the latest experience.
              *
+             * If concurrent updates are enabled, this function can be
+             * called by multiple threads at once.
+             *
+             * \sa setConcurrentUpdates(size_t)
+             *
              * @param s The previous state.
              * @param a The action performed.
              * @param s1 The new state.
@@ -138,6 +144,83 @@ namespace AIToolbox::MDP {
              */
             void stepUpdateQ(size_t s, size_t a, size_t s1, double rew);
 
+            /**
+             * @brief This function enables concurrent calls to stepUpdateQ().
+             *
+             * This allows multiple threads, each with its own environment,
+             * to learn into the same QFunction. The rows of the QFunction
+             * are guarded by the input number of spinlocks, striped over
+             * the states, and each update holds at most one of them at a
+             * time. Threads updating different stripes never wait for each
+             * other.
+             *
+             * Each single read and write of a row is atomic, but an update
+             * is not: the maximum of the next state is read first, and the
+             * new value is written later. Thus, an update may bootstrap from
+             * a value that another thread is changing, as in Hogwild-style
+             * learners, and the results depend on the interleaving of the
+             * threads. With a single thread, the results are the same as
+             * without locks.
+             *
+             * All other member functions (including getQFunction() and
+             * batchUpdateQ()) must not be called while other threads are
+             * updating.
+             *
+             * @param stripes The number of spinlocks, or zero to disable concurrent updates.
+             */
+            void setConcurrentUpdates(size_t stripes);
+
+            /**
+             * @brief This function returns the number of spinlocks guarding concurrent updates.
+             *
+             * @return The number of spinlocks, or zero if concurrent updates are disabled.
+             */
+            size_t getConcurrentUpdates() const;
+
+            /**
+             * @brief This function updates the internal QFunction with a batch of transitions.
+             *
+             * This function is equivalent to calling stepUpdateQ() on each
+             * transition of the batch in order, but avoids the per-call
+             * overhead when ingesting large logs of experience.
+             *
+             * This function throws an std::invalid_argument if the arrays
+             * of the batch do not all have the same size.
+             *
+             * Optionally, the TD error of each transition (computed right
+             * before its update) can be written in an output vector. This
+             * can be used to update the priorities of a ReplayBuffer.
+             *
+             * @param batch The transitions to learn from.
+             * @param tdErrors If not null, the TD error of each transition is written here.
+             */
+            void batchUpdateQ(const TransitionBatch & batch, std::vector<double> * tdErrors = nullptr);
+
+            /**
+             * @brief This function updates the internal QFunction with a batch of transitions in parallel.
+             *
+             * This function splits the states between the threads of the
+             * input ThreadPool, and each thread applies in order the
+             * updates for the transitions starting from its states. The
+             * transitions are grouped by thread beforehand, so that each
+             * thread only visits its own.
+             *
+             * To avoid threads reading rows of the QFunction that other
+             * threads are writing, all updates bootstrap from the values
+             * the QFunction had at the start of the batch, rather than from
+             * the values updated during the batch. Thus the results differ
+             * from batchUpdateQ(const TransitionBatch &), but they are
+             * deterministic and do not depend on the number of threads.
+             *
+             * This function throws an std::invalid_argument if the arrays
+             * of the batch do not all have the same size.
+             *
+             * @param batch The transitions to learn from.
+             * @param pool The ThreadPool to use.
+             * @param tdErrors If not null, the TD error of each transition is written here.
+             */
+            void batchUpdateQ(const TransitionBatch & batch, ThreadPool & pool, std::vector<double> * tdErrors = nullptr);
+
             /**
              * @brief This function returns the number of states on which QLearning is working.
              *
@@ -168,6 +251,7 @@ namespace AIToolbox::MDP {
             double discount_;
 
             QFunction q_;
+            StripedSpinLock locks_;
     };
 
     template <typename M, typename>
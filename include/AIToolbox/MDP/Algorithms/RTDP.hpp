@@ -0,0 +1,436 @@
+#ifndef AI_TOOLBOX_MDP_RTDP_HEADER_FILE
+#define AI_TOOLBOX_MDP_RTDP_HEADER_FILE
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents the Real-Time Dynamic Programming algorithm.
+     *
+     * ValueIteration and PolicyIteration update every state of the model
+     * at every sweep. When the agent always starts from a known state,
+     * most of that work is wasted on states that the optimal policy never
+     * visits.
+     *
+     * RTDP instead runs simulated trials from the start state. At each
+     * step of a trial the current state is backed up with the Bellman
+     * equation, the greedy action is selected from the resulting
+     * QFunction, and the next state is sampled from the model via
+     * sampleSR(). Trials end when a terminal state is reached, or after
+     * a maximum number of steps.
+     *
+     * If the initial values are an admissible heuristic (i.e. they are
+     * never lower than the true optimal values, as we maximize rewards),
+     * the values of the states visited by the greedy policy converge to
+     * their optimal values, while states which are never visited are
+     * never backed up. By default all values start at zero, which is
+     * admissible for problems with non-positive rewards, like shortest
+     * path problems. A better heuristic can be set with setHeuristic().
+     *
+     * Terminal states, as reported by the model, have value zero.
+     *
+     * Plain RTDP has no convergence test: this class stops when a whole
+     * trial changes no value by more than epsilon, or after the maximum
+     * number of trials. See LRTDP for a version with a proper stopping
+     * criterion.
+     *
+     * @tparam M The type of the model.
+     */
+    template <typename M>
+    class RTDP {
+        static_assert(is_model_v<M>, "This class only works for MDP models!");
+
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param m The model to solve.
+             * @param epsilon The residual under which a value is considered converged.
+             * @param maxTrials The maximum number of trials to run on each call.
+             * @param maxDepth The maximum number of steps of each trial.
+             */
+            RTDP(const M & m, double epsilon = 0.001, unsigned maxTrials = 10000, unsigned maxDepth = 1000);
+
+            /**
+             * @brief This function runs trials from the input state.
+             *
+             * Values computed in previous calls are kept, so this function
+             * can be called multiple times, possibly from different
+             * states.
+             *
+             * @param s The state from which to start the trials.
+             *
+             * @return The number of trials performed.
+             */
+            unsigned operator()(size_t s);
+
+            /**
+             * @brief This function sets the initial values of all states.
+             *
+             * The heuristic should be admissible, i.e. higher or equal
+             * than the optimal values, otherwise the algorithm may
+             * converge to a suboptimal policy.
+             *
+             * This resets the QFunction and ValueFunction. Terminal states
+             * are always set to zero.
+             *
+             * This function throws std::invalid_argument if the size of
+             * the input does not match the number of states.
+             *
+             * @param h The heuristic values.
+             */
+            void setHeuristic(const Values & h);
+
+            /**
+             * @brief This function sets the residual under which a value is considered converged.
+             *
+             * @param e The new epsilon, which must be > 0.
+             */
+            void setEpsilon(double e);
+
+            /**
+             * @brief This function returns the currently set epsilon.
+             */
+            double getEpsilon() const;
+
+            /**
+             * @brief This function sets the maximum number of trials for each call.
+             *
+             * @param t The new maximum number of trials.
+             */
+            void setMaxTrials(unsigned t);
+
+            /**
+             * @brief This function returns the currently set maximum number of trials.
+             */
+            unsigned getMaxTrials() const;
+
+            /**
+             * @brief This function sets the maximum number of steps of each trial.
+             *
+             * @param d The new maximum depth.
+             */
+            void setMaxDepth(unsigned d);
+
+            /**
+             * @brief This function returns the currently set maximum depth.
+             */
+            unsigned getMaxDepth() const;
+
+            /**
+             * @brief This function returns a reference to the referenced Model.
+             */
+            const M & getModel() const;
+
+            /**
+             * @brief This function returns a reference to the internal QFunction.
+             *
+             * Only rows of states that have been backed up contain
+             * meaningful values; the others contain the heuristic.
+             */
+            const QFunction & getQFunction() const;
+
+            /**
+             * @brief This function returns a reference to the internal ValueFunction.
+             */
+            const ValueFunction & getValueFunction() const;
+
+        protected:
+            /**
+             * @brief This function backs up the input state.
+             *
+             * @param s The state to update.
+             *
+             * @return The absolute change in the value of the state.
+             */
+            double update(size_t s);
+
+            /**
+             * @brief This function computes the residual of a state without modifying it.
+             *
+             * @param s The state to check.
+             *
+             * @return The absolute change a backup would cause.
+             */
+            double residual(size_t s) const;
+
+            /**
+             * @brief This function computes the Bellman backup of a state-action pair.
+             */
+            double computeQ(size_t s, size_t a) const;
+
+            size_t S, A;
+            double epsilon_;
+            unsigned maxTrials_, maxDepth_;
+
+            const M & model_;
+            QFunction qfun_;
+            ValueFunction vfun_;
+    };
+
+    /**
+     * @brief This class represents the Labeled Real-Time Dynamic Programming algorithm.
+     *
+     * LRTDP extends RTDP by labeling states as solved. A state is solved
+     * when its residual, and the residuals of all states reachable from it
+     * through the greedy policy, are lower than epsilon. Trials stop as
+     * soon as they reach a solved state, and after each trial the visited
+     * states are checked in reverse order to find new solved ones.
+     *
+     * This gives both a faster convergence than RTDP, as converged parts
+     * of the state space are not visited again, and a proper stopping
+     * criterion: operator() returns as soon as the start state is solved.
+     *
+     * @tparam M The type of the model.
+     */
+    template <typename M>
+    class LRTDP : public RTDP<M> {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param m The model to solve.
+             * @param epsilon The residual under which a value is considered converged.
+             * @param maxTrials The maximum number of trials to run on each call.
+             * @param maxDepth The maximum number of steps of each trial.
+             */
+            LRTDP(const M & m, double epsilon = 0.001, unsigned maxTrials = 10000, unsigned maxDepth = 1000);
+
+            /**
+             * @brief This function runs trials from the input state until it is solved.
+             *
+             * @param s The state from which to start the trials.
+             *
+             * @return The number of trials performed.
+             */
+            unsigned operator()(size_t s);
+
+            /**
+             * @brief This function sets the initial values of all states.
+             *
+             * This also clears all solved labels.
+             *
+             * @param h The heuristic values.
+             */
+            void setHeuristic(const Values & h);
+
+            /**
+             * @brief This function returns whether the input state has been labeled as solved.
+             *
+             * @param s The state to check.
+             */
+            bool isSolved(size_t s) const;
+
+        private:
+            /**
+             * @brief This function checks whether the input state can be labeled as solved.
+             *
+             * If it can, all states reachable from it through the greedy
+             * policy are labeled as well. Otherwise, the visited states
+             * are backed up.
+             */
+            bool checkSolved(size_t s);
+
+            using Base = RTDP<M>;
+
+            std::vector<char> solved_;
+            // Temporary storage for checkSolved().
+            std::vector<char> marked_;
+            std::vector<size_t> open_, closed_;
+    };
+
+    template <typename M>
+    RTDP<M>::RTDP(const M & m, const double epsilon, const unsigned maxTrials, const unsigned maxDepth) :
+            S(m.getS()), A(m.getA()), maxTrials_(maxTrials), maxDepth_(maxDepth), model_(m),
+            qfun_(makeQFunction(S, A)), vfun_(makeValueFunction(S))
+    {
+        setEpsilon(epsilon);
+    }
+
+    template <typename M>
+    unsigned RTDP<M>::operator()(const size_t start) {
+        for (unsigned trial = 0; trial < maxTrials_; ++trial) {
+            double maxResidual = 0.0;
+            size_t s = start;
+            for (unsigned depth = 0; depth < maxDepth_ && !model_.isTerminal(s); ++depth) {
+                maxResidual = std::max(maxResidual, update(s));
+                s = std::get<0>(model_.sampleSR(s, vfun_.actions[s]));
+            }
+            if (maxResidual < epsilon_) return trial + 1;
+        }
+        return maxTrials_;
+    }
+
+    template <typename M>
+    void RTDP<M>::setHeuristic(const Values & h) {
+        if (static_cast<size_t>(h.size()) != S)
+            throw std::invalid_argument("Heuristic size does not match the number of states");
+
+        vfun_.values = h;
+        for (size_t s = 0; s < S; ++s) {
+            if (model_.isTerminal(s)) vfun_.values[s] = 0.0;
+            qfun_.row(s).fill(vfun_.values[s]);
+            vfun_.actions[s] = 0;
+        }
+    }
+
+    template <typename M>
+    double RTDP<M>::update(const size_t s) {
+        if (model_.isTerminal(s)) return 0.0;
+
+        for (size_t a = 0; a < A; ++a)
+            qfun_(s, a) = computeQ(s, a);
+
+        const double old = vfun_.values[s];
+        vfun_.values[s] = qfun_.row(s).maxCoeff(&vfun_.actions[s]);
+        return std::fabs(vfun_.values[s] - old);
+    }
+
+    template <typename M>
+    double RTDP<M>::residual(const size_t s) const {
+        if (model_.isTerminal(s)) return 0.0;
+
+        double best = computeQ(s, 0);
+        for (size_t a = 1; a < A; ++a)
+            best = std::max(best, computeQ(s, a));
+        return std::fabs(best - vfun_.values[s]);
+    }
+
+    template <typename M>
+    double RTDP<M>::computeQ(const size_t s, const size_t a) const {
+        if constexpr (is_model_eigen_v<M>) {
+            return model_.getRewardFunction().coeff(s, a) +
+                   model_.getDiscount() * model_.getTransitionFunction(a).row(s).dot(vfun_.values);
+        } else {
+            double q = 0.0;
+            forEachSuccessor(model_, s, a, [&](const size_t s1, const double p) {
+                q += p * (model_.getExpectedReward(s, a, s1) + model_.getDiscount() * vfun_.values[s1]);
+            });
+            return q;
+        }
+    }
+
+    template <typename M>
+    void RTDP<M>::setEpsilon(const double e) {
+        if (e <= 0.0) throw std::invalid_argument("Epsilon must be > 0");
+        epsilon_ = e;
+    }
+
+    template <typename M>
+    double RTDP<M>::getEpsilon() const { return epsilon_; }
+
+    template <typename M>
+    void RTDP<M>::setMaxTrials(const unsigned t) { maxTrials_ = t; }
+
+    template <typename M>
+    unsigned RTDP<M>::getMaxTrials() const { return maxTrials_; }
+
+    template <typename M>
+    void RTDP<M>::setMaxDepth(const unsigned d) { maxDepth_ = d; }
+
+    template <typename M>
+    unsigned RTDP<M>::getMaxDepth() const { return maxDepth_; }
+
+    template <typename M>
+    const M & RTDP<M>::getModel() const { return model_; }
+
+    template <typename M>
+    const QFunction & RTDP<M>::getQFunction() const { return qfun_; }
+
+    template <typename M>
+    const ValueFunction & RTDP<M>::getValueFunction() const { return vfun_; }
+
+    template <typename M>
+    LRTDP<M>::LRTDP(const M & m, const double epsilon, const unsigned maxTrials, const unsigned maxDepth) :
+            Base(m, epsilon, maxTrials, maxDepth), solved_(this->S, false), marked_(this->S, false) {}
+
+    template <typename M>
+    unsigned LRTDP<M>::operator()(const size_t start) {
+        std::vector<size_t> visited;
+        for (unsigned trial = 0; trial < this->maxTrials_; ++trial) {
+            if (solved_[start]) return trial;
+
+            visited.clear();
+            size_t s = start;
+            for (unsigned depth = 0; depth < this->maxDepth_ && !solved_[s]; ++depth) {
+                visited.push_back(s);
+                if (this->model_.isTerminal(s)) break;
+
+                this->update(s);
+                s = std::get<0>(this->model_.sampleSR(s, this->vfun_.actions[s]));
+            }
+
+            while (!visited.empty()) {
+                const auto v = visited.back();
+                visited.pop_back();
+                if (!checkSolved(v)) break;
+            }
+        }
+        return this->maxTrials_;
+    }
+
+    template <typename M>
+    bool LRTDP<M>::checkSolved(const size_t s) {
+        if (solved_[s]) return true;
+
+        bool retval = true;
+        open_.clear();
+        closed_.clear();
+
+        open_.push_back(s);
+        marked_[s] = true;
+
+        while (!open_.empty()) {
+            const auto s1 = open_.back();
+            open_.pop_back();
+            closed_.push_back(s1);
+
+            if (this->model_.isTerminal(s1)) continue;
+            if (this->residual(s1) > this->epsilon_) {
+                retval = false;
+                continue;
+            }
+
+            // We make sure the action we follow is the current greedy one.
+            this->update(s1);
+            forEachSuccessor(this->model_, s1, this->vfun_.actions[s1], [this](const size_t s2, double) {
+                if (solved_[s2] || marked_[s2]) return;
+                marked_[s2] = true;
+                open_.push_back(s2);
+            });
+        }
+
+        for (const auto c : closed_) marked_[c] = false;
+        for (const auto o : open_) marked_[o] = false;
+
+        if (retval) {
+            for (const auto c : closed_) solved_[c] = true;
+        } else {
+            while (!closed_.empty()) {
+                this->update(closed_.back());
+                closed_.pop_back();
+            }
+        }
+        return retval;
+    }
+
+    template <typename M>
+    void LRTDP<M>::setHeuristic(const Values & h) {
+        Base::setHeuristic(h);
+        std::fill(std::begin(solved_), std::end(solved_), false);
+    }
+
+    template <typename M>
+    bool LRTDP<M>::isSolved(const size_t s) const { return solved_[s]; }
+}
+
+#endif
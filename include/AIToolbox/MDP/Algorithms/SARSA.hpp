@@ -6,6 +6,7 @@
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/Utils/StripedSpinLock.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -140,6 +141,11 @@ namespace AIToolbox::MDP {
              * two consecutive state-action pairs, in order to correctly
              * relate how the policy acts from state to state.
              *
+             * If concurrent updates are enabled, this function can be
+             * called by multiple threads at once.
+             *
+             * \sa setConcurrentUpdates(size_t)
+             *
              * @param s The previous state.
              * @param a The action performed.
              * @param s1 The new state.
@@ -148,6 +154,46 @@ namespace AIToolbox::MDP {
              */
             void stepUpdateQ(size_t s, size_t a, size_t s1, size_t a1, double rew);
 
+            /**
+             * @brief This function enables concurrent calls to stepUpdateQ().
+             *
+             * The rows of the QFunction are guarded by the input number of
+             * spinlocks, striped over the states. Reading the value of the
+             * next state-action pair and writing the updated one are each
+             * atomic, but the update as a whole is not, so it may bootstrap
+             * from a value that another thread is changing.
+             *
+             * All other member functions must not be called while other
+             * threads are updating.
+             *
+             * \sa QLearning::setConcurrentUpdates(size_t)
+             *
+             * @param stripes The number of spinlocks, or zero to disable concurrent updates.
+             */
+            void setConcurrentUpdates(size_t stripes);
+
+            /**
+             * @brief This function returns the number of spinlocks guarding concurrent updates.
+             *
+             * @return The number of spinlocks, or zero if concurrent updates are disabled.
+             */
+            size_t getConcurrentUpdates() const;
+
+            /**
+             * @brief This function updates the internal QFunction with a batch of transitions.
+             *
+             * This function is equivalent to calling stepUpdateQ() on each
+             * transition of the batch in order, but avoids the per-call
+             * overhead when ingesting large logs of experience.
+             *
+             * This function throws an std::invalid_argument if the arrays
+             * of the batch do not all have the same size.
+             * The nextActions array of the batch is required.
+             *
+             * @param batch The transitions to learn from.
+             */
+            void batchUpdateQ(const TransitionBatch & batch);
+
             /**
              * @brief This function returns the number of states on which QLearning is working.
              *
@@ -178,6 +224,7 @@ namespace AIToolbox::MDP {
             double discount_;
 
             QFunction q_;
+            StripedSpinLock locks_;
     };
 
     template <typename M, typename>
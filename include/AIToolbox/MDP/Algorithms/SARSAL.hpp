@@ -208,10 +208,38 @@ namespace AIToolbox::MDP {
              * the internal traces. You generally don't unless you are building
              * on top of SARSAL in order to do something more complicated.
              *
+             * If trace indexing is enabled, the index is updated only for
+             * the old and new traces, so this function costs O(traces)
+             * rather than O(S*A).
+             *
              * @param t The currently set traces.
              */
             void setTraces(const Traces & t);
 
+            /**
+             * @brief This function sets whether the traces are indexed by state-action pair.
+             *
+             * By default, traces are kept in an unordered list, which is
+             * scanned in full at every update to find whether the current
+             * state-action pair is already present. When indexing is
+             * enabled, an additional SxA table maps each pair to its
+             * position in the list, so that lookups are O(1) and only the
+             * active traces are ever touched.
+             *
+             * This costs S*A indices of memory, which is why it is
+             * disabled by default. Results are identical in both modes.
+             *
+             * @param index Whether to index the traces.
+             */
+            void setTraceIndexing(bool index);
+
+            /**
+             * @brief This function returns whether the traces are indexed by state-action pair.
+             *
+             * @return Whether the traces are indexed.
+             */
+            bool getTraceIndexing() const;
+
             /**
              * @brief This function returns the number of states on which QLearning is working.
              *
@@ -249,6 +277,19 @@ namespace AIToolbox::MDP {
              */
             void setQFunction(const QFunction & qfun);
 
+            /**
+             * @brief This function sets a single value of the internal QFunction.
+             *
+             * This allows to modify a few entries of the QFunction without
+             * copying it all, for example to reset only the entries which
+             * have diverged from another QFunction.
+             *
+             * @param s The state of the value to set.
+             * @param a The action of the value to set.
+             * @param v The new value.
+             */
+            void setQValue(size_t s, size_t a, double v);
+
         private:
             size_t S, A;
             double alpha_;
@@ -259,6 +300,8 @@ namespace AIToolbox::MDP {
 
             QFunction q_;
             Traces traces_;
+            // Maps each state-action pair to its position in traces_, if enabled.
+            std::vector<size_t> traceIndex_;
     };
 
     template <typename M, typename>
@@ -0,0 +1,144 @@
+#ifndef AI_TOOLBOX_MDP_SPARSE_QLEARNING_HEADER_FILE
+#define AI_TOOLBOX_MDP_SPARSE_QLEARNING_HEADER_FILE
+
+#include <stddef.h>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/SparseQFunction.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents the QLearning algorithm over a SparseQFunction.
+     *
+     * This class is equivalent to QLearning, but it stores its values in
+     * a SparseQFunction, so that its memory grows with the number of
+     * updated states rather than with the size of the state space. This
+     * allows learning over huge state spaces (for example hashed
+     * features) of which only a small part is ever visited.
+     *
+     * Reading the value of a next state which has never been updated
+     * does not store it.
+     */
+    class SparseQLearning {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The learning rate must be > 0.0 and <= 1.0, otherwise the
+             * constructor will throw an std::invalid_argument.
+             *
+             * @param S The size of the state space.
+             * @param A The size of the action space.
+             * @param discount The discount to use when learning.
+             * @param alpha The learning rate.
+             * @param initialValue The value of all state-action pairs before they are updated.
+             */
+            SparseQLearning(size_t S, size_t A, double discount = 1.0, double alpha = 0.1, double initialValue = 0.0);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor copies the S and A and discount parameters
+             * from the supplied model.
+             *
+             * @param model The MDP model to use as a base.
+             * @param alpha The learning rate.
+             * @param initialValue The value of all state-action pairs before they are updated.
+             */
+            template <typename M, typename = std::enable_if_t<is_generative_model_v<M>>>
+            SparseQLearning(const M& model, double alpha = 0.1, double initialValue = 0.0);
+
+            /**
+             * @brief This function sets the learning rate parameter.
+             *
+             * The learning rate parameter must be > 0.0 and <= 1.0,
+             * otherwise the function will throw an std::invalid_argument.
+             *
+             * @param a The new learning rate parameter.
+             */
+            void setLearningRate(double a);
+
+            /**
+             * @brief This function will return the current set learning rate parameter.
+             *
+             * @return The currently set learning rate parameter.
+             */
+            double getLearningRate() const;
+
+            /**
+             * @brief This function sets the new discount parameter.
+             *
+             * @param d The new discount factor.
+             */
+            void setDiscount(double d);
+
+            /**
+             * @brief This function returns the currently set discount parameter.
+             *
+             * @return The currently set discount parameter.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function updates the internal SparseQFunction with a single transition.
+             *
+             * @param s The previous state.
+             * @param a The action performed.
+             * @param s1 The new state.
+             * @param rew The reward obtained.
+             */
+            void stepUpdateQ(size_t s, size_t a, size_t s1, double rew);
+
+            /**
+             * @brief This function updates the internal SparseQFunction with a batch of transitions.
+             *
+             * This function is equivalent to calling stepUpdateQ() on each
+             * transition of the batch in order.
+             *
+             * This function throws an std::invalid_argument if the arrays
+             * of the batch do not all have the same size.
+             *
+             * @param batch The transitions to learn from.
+             * @param tdErrors If not null, the TD error of each transition is written here.
+             */
+            void batchUpdateQ(const TransitionBatch & batch, std::vector<double> * tdErrors = nullptr);
+
+            /**
+             * @brief This function returns the number of states.
+             *
+             * @return The number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of actions.
+             *
+             * @return The number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns a reference to the internal SparseQFunction.
+             *
+             * The returned reference can be used to build a
+             * SparseQGreedyPolicy.
+             *
+             * @return The internal SparseQFunction.
+             */
+            const SparseQFunction & getQFunction() const;
+
+        private:
+            size_t S, A;
+            double alpha_;
+            double discount_;
+
+            SparseQFunction q_;
+    };
+
+    template <typename M, typename>
+    SparseQLearning::SparseQLearning(const M& model, const double alpha, const double initialValue) :
+            SparseQLearning(model.getS(), model.getA(), model.getDiscount(), alpha, initialValue) {}
+}
+
+#endif
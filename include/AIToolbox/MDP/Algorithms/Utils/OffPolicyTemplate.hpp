@@ -101,9 +101,12 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function returns the currently set traces.
              *
+             * Internally traces are stored as separate arrays, so this
+             * function builds a copy of them.
+             *
              * @return The currently set traces.
              */
-            const Traces & getTraces() const;
+            Traces getTraces() const;
 
             /**
              * @brief This function sets the currently set traces.
@@ -116,6 +119,30 @@ namespace AIToolbox::MDP {
              */
             void setTraces(const Traces & t);
 
+            /**
+             * @brief This function sets whether the traces are indexed by state-action pair.
+             *
+             * By default, traces are kept in an unordered list, which is
+             * scanned in full at every update to find whether the current
+             * state-action pair is already present. When indexing is
+             * enabled, an additional SxA table maps each pair to its
+             * position in the list, so that lookups are O(1) and only the
+             * active traces are ever touched.
+             *
+             * This costs S*A indices of memory, which is why it is
+             * disabled by default. Results are identical in both modes.
+             *
+             * @param index Whether to index the traces.
+             */
+            void setTraceIndexing(bool index);
+
+            /**
+             * @brief This function returns whether the traces are indexed by state-action pair.
+             *
+             * @return Whether the traces are indexed.
+             */
+            bool getTraceIndexing() const;
+
             /**
              * @brief This function returns the number of states on which QLearning is working.
              *
@@ -169,7 +196,11 @@ namespace AIToolbox::MDP {
             void updateTraces(size_t s, size_t a, double error, double traceDiscount);
 
             QFunction q_;
-            Traces traces_;
+            // Traces as a structure of arrays: flat s * A + a ids and eligibilities.
+            std::vector<size_t> traceIds_;
+            std::vector<double> traceValues_;
+            // Maps each state-action pair to its position in the traces, if enabled.
+            std::vector<size_t> traceIndex_;
     };
 
     /**
@@ -243,6 +274,9 @@ namespace AIToolbox::MDP {
 
         protected:
             const PolicyInterface & target_;
+
+            // The action probabilities of the target policy in the next state.
+            Vector probabilities_;
     };
 
     /**
@@ -351,9 +385,8 @@ namespace AIToolbox::MDP {
 
     template <typename Derived>
     void OffPolicyEvaluation<Derived>::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
-        auto expectedQ = 0.0;
-        for (size_t a = 0; a < A; ++a)
-            expectedQ += q_(s1, a) * target_.getActionProbability(s1, a);
+        target_.getActionProbabilities(s1, &probabilities_);
+        const auto expectedQ = q_.row(s1).dot(probabilities_);
 
         const auto error = alpha_ * ( rew + discount_ * expectedQ - q_(s, a) );
         const auto traceDiscount = discount_ * static_cast<Derived*>(this)->getTraceDiscount(s, a, s1, rew);
@@ -395,7 +428,7 @@ namespace AIToolbox::MDP {
         const double discount, const double alpha, const double tolerance
     ) :
         Parent(target.getS(), target.getA(), discount, alpha, tolerance),
-        target_(target) {}
+        target_(target), probabilities_(A) {}
 
     template <typename Derived>
     OffPolicyControl<Derived>::OffPolicyControl(
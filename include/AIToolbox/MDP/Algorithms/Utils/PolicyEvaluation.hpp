@@ -2,7 +2,10 @@
 #define AI_TOOLBOX_MDP_POLICY_EVALUATION_HEADER_FILE
 
 #include <tuple>
+#include <vector>
+#include <numeric>
 #include <iterator>
+#include <algorithm>
 
 #include <AIToolbox/Impl/Logging.hpp>
 #include <AIToolbox/MDP/Types.hpp>
@@ -10,6 +13,7 @@
 #include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/MDP/Policies/PolicyInterface.hpp>
+#include <AIToolbox/MDP/Policies/PolicyWrapper.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -22,6 +26,17 @@ namespace AIToolbox::MDP {
      * using the same Model, so that no redundant computations have to be
      * performed.
      *
+     * Each sweep can be split between the threads of a user-provided
+     * ThreadPool (see setThreadPool()). The parallel sweeps produce
+     * exactly the same results as the serial ones.
+     *
+     * Many policies can also be evaluated together, passing either their
+     * SxA matrices or, for deterministic policies, their action vectors.
+     * Their values are stacked as the columns of a single matrix, so that
+     * each sweep needs a single matrix-matrix product per action for all
+     * of them, rather than one matrix-vector product per policy. With a
+     * ThreadPool the policies are split between the threads.
+     *
      * @tparam M The type of model that is solved by the algorithm.
      */
     template <typename M>
@@ -64,6 +79,33 @@ namespace AIToolbox::MDP {
              */
             std::tuple<double, Values, QFunction> operator()(const PolicyInterface & p);
 
+            /**
+             * @brief This function applies policy evaluation on many stochastic policies at once.
+             *
+             * Each policy is an SxA matrix, where each row contains the
+             * probabilities of the actions in that state. Each policy
+             * stops as soon as its own values converge, so the results
+             * are the same as evaluating each policy on its own, up to
+             * rounding.
+             *
+             * @param policies The policies to be evaluated.
+             * @return A vector containing, for each policy, the same tuple
+             *         returned by operator()(const PolicyInterface &).
+             */
+            std::vector<std::tuple<double, Values, QFunction>> operator()(const std::vector<Matrix2D> & policies);
+
+            /**
+             * @brief This function applies policy evaluation on many deterministic policies at once.
+             *
+             * Each policy is a vector containing the action taken in each
+             * state. This avoids building the SxA matrix of each policy.
+             *
+             * @param policies The policies to be evaluated.
+             * @return A vector containing, for each policy, the same tuple
+             *         returned by operator()(const PolicyInterface &).
+             */
+            std::vector<std::tuple<double, Values, QFunction>> operator()(const std::vector<Actions> & policies);
+
             /**
              * @brief This function sets the tolerance parameter.
              *
@@ -98,6 +140,17 @@ namespace AIToolbox::MDP {
              */
             void setValues(Values v);
 
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize each sweep.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function will return the currently set tolerance parameter.
              *
@@ -119,22 +172,34 @@ namespace AIToolbox::MDP {
              */
             const Values & getValues() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
+            template <typename Backup>
+            std::vector<std::tuple<double, Values, QFunction>> evaluateMany(size_t K, Backup backup);
+
             // Parameters
             double tolerance_;
             unsigned horizon_;
             Values vParameter_;
             const M & model_;
+            ThreadPool * pool_;
 
             // Internals
             QFunction immediateRewards_;
             Values v1_;
+            Matrix2D policyMatrix_;
             size_t S, A;
     };
 
     template <typename M>
     PolicyEvaluation<M>::PolicyEvaluation(const M & m, const unsigned horizon, const double tolerance, Values v) :
-            horizon_(horizon), vParameter_(std::move(v)), model_(m), S(0), A(0)
+            horizon_(horizon), vParameter_(std::move(v)), model_(m), pool_(nullptr), S(0), A(0)
     {
         setTolerance(tolerance);
 
@@ -142,9 +207,9 @@ namespace AIToolbox::MDP {
         S = model_.getS();
         A = model_.getA();
 
-        // Only compute the immediate rewards if we need them.
-        if constexpr (!is_model_eigen_v<M>)
-            immediateRewards_ = computeImmediateRewards(m);
+        // We convert the immediate rewards to a dense QFunction once, so
+        // that each sweep can simply copy them in the workspace.
+        immediateRewards_ = computeImmediateRewards(m);
     }
 
     template <typename M>
@@ -167,9 +232,25 @@ namespace AIToolbox::MDP {
         unsigned timestep = 0;
         double variation = tolerance_ * 2; // Make it bigger
 
-        Values val0;
+        // These are the workspaces we reuse at every sweep, so that the
+        // main loop does not allocate.
+        Values val0(S);
         QFunction q = makeQFunction(S, A);
-        const auto p = policy.getPolicy();
+        // Policies which wrap a matrix can be read directly; for the
+        // others we reuse our workspace, so repeated evaluations (as in
+        // PolicyIteration) do not reallocate it.
+        const Matrix2D * pp = &policyMatrix_;
+        if ( const auto wrapper = dynamic_cast<const PolicyWrapper *>(&policy) )
+            pp = &wrapper->getPolicyMatrix();
+        else
+            policy.getPolicyInto(&policyMatrix_);
+        const auto & p = *pp;
+
+        // Compute the values for this policy
+        const auto evaluate = [&](const size_t begin, const size_t end) {
+            for ( size_t s = begin; s < end; ++s )
+                v1_(s) = q.row(s).dot(p.row(s));
+        };
 
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
         while ( timestep < horizon_ && (!useTolerance || variation > tolerance_) ) {
@@ -180,16 +261,14 @@ namespace AIToolbox::MDP {
 
             // We apply the discount directly on the values vector.
             v1_ *= model_.getDiscount();
-            // We use the implicit reward function if it is available,
-            // otherwise we use the one we computed beforehand.
-            if constexpr(is_model_eigen_v<M>)
-                q = computeQFunction(model_, v1_, model_.getRewardFunction());
-            else
-                q = computeQFunction(model_, v1_, immediateRewards_);
 
-            // Compute the values for this policy
-            for ( size_t s = 0; s < S; ++s )
-                v1_(s) = q.row(s) * p.row(s).transpose();
+            if ( pool_ ) {
+                computeQFunctionInline(model_, v1_, immediateRewards_, &q, *pool_);
+                pool_->parallelFor(S, evaluate);
+            } else {
+                computeQFunctionInline(model_, v1_, immediateRewards_, &q);
+                evaluate(0, S);
+            }
 
             // We do this only if the tolerance specified is positive,
             // otherwise we continue for all the timesteps.
@@ -202,6 +281,127 @@ namespace AIToolbox::MDP {
         return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1_), std::move(q));
     }
 
+    template <typename M>
+    std::vector<std::tuple<double, Values, QFunction>> PolicyEvaluation<M>::operator()(const std::vector<Matrix2D> & policies) {
+        for ( const auto & p : policies )
+            if ( static_cast<size_t>(p.rows()) != S || static_cast<size_t>(p.cols()) != A )
+                throw std::invalid_argument("Policy matrices must be SxA");
+
+        return evaluateMany(policies.size(), [&](const size_t k, const size_t s, const QFunction & q) {
+            return q.row(s).dot(policies[k].row(s));
+        });
+    }
+
+    template <typename M>
+    std::vector<std::tuple<double, Values, QFunction>> PolicyEvaluation<M>::operator()(const std::vector<Actions> & policies) {
+        for ( const auto & p : policies ) {
+            if ( p.size() != S )
+                throw std::invalid_argument("Policy action vectors must have size S");
+            for ( const auto a : p )
+                if ( a >= A ) throw std::invalid_argument("Policy action out of range");
+        }
+
+        return evaluateMany(policies.size(), [&](const size_t k, const size_t s, const QFunction & q) {
+            return q(s, policies[k][s]);
+        });
+    }
+
+    template <typename M>
+    template <typename Backup>
+    std::vector<std::tuple<double, Values, QFunction>> PolicyEvaluation<M>::evaluateMany(const size_t K, Backup backup) {
+        // All policies start from the same values, as in operator().
+        Matrix2D values(S, K);
+        {
+            const size_t size = vParameter_.size();
+            if ( size != S && size != 0 ) {
+                AI_LOGGER(AI_SEVERITY_WARNING, "Size of starting value function is incorrect, ignoring...");
+            }
+            for ( size_t k = 0; k < K; ++k ) {
+                if ( size == S ) values.col(k) = vParameter_;
+                else values.col(k).setZero();
+            }
+        }
+
+        std::vector<QFunction> qs(K, makeQFunction(S, A));
+        std::vector<double> variations(K, tolerance_ * 2);
+
+        const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
+        const double discount = model_.getDiscount();
+
+        // The policies which have not converged yet.
+        std::vector<size_t> active(K);
+        std::iota(std::begin(active), std::end(active), 0);
+
+        // Each call processes a contiguous block of the active policies,
+        // so that the products are done on all their values at once.
+        const auto sweep = [&](const size_t begin, const size_t end) {
+            const size_t n = end - begin;
+            Matrix2D discounted(S, n);
+            for ( size_t i = 0; i < n; ++i )
+                discounted.col(i) = values.col(active[begin + i]) * discount;
+
+            if constexpr (is_model_fused_v<M>) {
+                const Matrix2D future = model_.getTransitionFunction() * discounted;
+                for ( size_t i = 0; i < n; ++i ) {
+                    auto & q = qs[active[begin + i]];
+                    for ( size_t s = 0; s < S; ++s )
+                        for ( size_t a = 0; a < A; ++a )
+                            q(s, a) = immediateRewards_(s, a) + future(s * A + a, i);
+                }
+            } else if constexpr (is_model_eigen_v<M>) {
+                Matrix2D future;
+                for ( size_t a = 0; a < A; ++a ) {
+                    future.noalias() = model_.getTransitionFunction(a).template cast<double>() * discounted;
+                    for ( size_t i = 0; i < n; ++i )
+                        qs[active[begin + i]].col(a) = immediateRewards_.col(a) + future.col(i);
+                }
+            } else {
+                Vector future(n);
+                for ( size_t s = 0; s < S; ++s ) {
+                    for ( size_t a = 0; a < A; ++a ) {
+                        future.setZero();
+                        forEachSuccessor(model_, s, a, [&](const size_t s1, const double p) {
+                            future += p * discounted.row(s1).transpose();
+                        });
+                        for ( size_t i = 0; i < n; ++i )
+                            qs[active[begin + i]](s, a) = immediateRewards_(s, a) + future[i];
+                    }
+                }
+            }
+
+            for ( size_t i = begin; i < end; ++i ) {
+                const auto k = active[i];
+                double variation = 0.0;
+                for ( size_t s = 0; s < S; ++s ) {
+                    const double v = backup(k, s, qs[k]);
+                    variation = std::max(variation, std::fabs(v - values(s, k)));
+                    values(s, k) = v;
+                }
+                variations[k] = variation;
+            }
+        };
+
+        unsigned timestep = 0;
+        while ( timestep < horizon_ && !active.empty() ) {
+            ++timestep;
+            AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+
+            if ( pool_ ) pool_->parallelFor(active.size(), sweep);
+            else         sweep(0, active.size());
+
+            if ( useTolerance )
+                active.erase(std::remove_if(std::begin(active), std::end(active), [&](const size_t k) {
+                    return variations[k] <= tolerance_;
+                }), std::end(active));
+        }
+
+        std::vector<std::tuple<double, Values, QFunction>> retval;
+        retval.reserve(K);
+        for ( size_t k = 0; k < K; ++k )
+            retval.emplace_back(useTolerance ? variations[k] : 0.0, values.col(k), std::move(qs[k]));
+        return retval;
+    }
+
     template <typename M>
     void PolicyEvaluation<M>::setTolerance(const double t) {
         if ( t < 0.0 ) throw std::invalid_argument("Tolerance must be >= 0");
@@ -218,6 +418,11 @@ namespace AIToolbox::MDP {
         vParameter_ = std::move(v);
     }
 
+    template <typename M>
+    void PolicyEvaluation<M>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     template <typename M>
     double PolicyEvaluation<M>::getTolerance()   const { return tolerance_; }
 
@@ -226,6 +431,9 @@ namespace AIToolbox::MDP {
 
     template <typename M>
     const Values & PolicyEvaluation<M>::getValues() const { return vParameter_; }
+
+    template <typename M>
+    ThreadPool * PolicyEvaluation<M>::getThreadPool() const { return pool_; }
 }
 
 #endif
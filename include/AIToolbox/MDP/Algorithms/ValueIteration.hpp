@@ -1,13 +1,40 @@
 #ifndef AI_TOOLBOX_MDP_VALUE_ITERATION_HEADER_FILE
 #define AI_TOOLBOX_MDP_VALUE_ITERATION_HEADER_FILE
 
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <vector>
+
 #include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/IndexedHeap.hpp>
 
 namespace AIToolbox::MDP {
+    /**
+     * @brief This struct contains the state of a ValueIteration run between two timesteps.
+     *
+     * A checkpoint can be stored with writeBinary(), and passed back to
+     * ValueIteration to continue the run from where it was taken, so that
+     * the work done is not lost if the process is interrupted.
+     */
+    struct ValueIterationCheckpoint {
+        unsigned timestep;
+        double variation;
+        ValueFunction v;
+        // The Bellman residuals of the last timestep, only used by
+        // prioritized sweeps.
+        Values residuals;
+    };
+
     /**
      * @brief This class applies the value iteration algorithm on a Model.
      *
@@ -23,9 +50,89 @@ namespace AIToolbox::MDP {
      *
      * This implementation in particular is ported from the MATLAB
      * MDPToolbox (although it is simplified).
+     *
+     * Optionally, a ThreadPool can be set so that the computation of the
+     * QFunction and the Bellman operator at each timestep are split
+     * between multiple threads. The results are identical to the serial
+     * version.
+     *
+     * By default each timestep computes the new ValueFunction only from
+     * the values of the previous timestep (Jacobi sweeps). Alternatively,
+     * states can be updated in place (Gauss-Seidel sweeps), so that each
+     * backup already uses the new values of the states updated before it
+     * in the same sweep. This generally reduces the number of sweeps
+     * needed to converge. The order in which states are updated can be
+     * either their natural order, or by decreasing Bellman residual of
+     * the previous sweep, so that the states which changed the most are
+     * propagated first.
+     *
+     * Note that in-place sweeps are inherently serial, so the ThreadPool
+     * is ignored for them.
+     *
+     * Finally, topological sweeps split the transition graph of the model
+     * (over all actions) in strongly connected components, and solve them
+     * one at a time, in-place, in reverse topological order: each
+     * component is only solved after all components it can reach have
+     * converged, so that it needs no more sweeps than it would alone.
+     * Components made of a single state without self-loops, as in
+     * acyclic models, are solved with a single backup. Components at the
+     * same depth of the graph of components are independent, and are
+     * split between the threads of the ThreadPool, if one is set. In this
+     * mode the horizon bounds the number of sweeps of each component,
+     * and no checkpoints are emitted.
+     *
+     * Models that support streaming (see is_model_streamed), as a
+     * MappedSparseModel with a streaming block set, are processed in
+     * blocks of rows during Jacobi sweeps, reading each block from disk
+     * while the previous one is being computed. This allows to solve
+     * models larger than the available memory.
+     *
+     * When many small models need to be solved, it is more efficient to
+     * use solveBatch(), which distributes whole models between the
+     * threads of the ThreadPool rather than splitting each timestep.
+     * When instead the same transitions need to be solved with many
+     * reward functions or discounts, solveRewards() solves all of them at
+     * once, reading the transitions only once per timestep.
+     *
+     * Long runs can be checkpointed with setCheckpointCallback(), and
+     * resumed from any checkpoint.
+     *
+     * When a model already solved changes in only a few state-action
+     * pairs (as an RLModel after syncing some of them), resolve() updates
+     * the old solution by propagating the changes backwards through the
+     * model in priority order, rather than sweeping over all states.
+     *
+     * When the model has many actions but only few of them are ever
+     * competitive, action elimination can be enabled with
+     * setActionElimination(). After each Jacobi sweep the change in
+     * values bounds the optimal ValueFunction from above and below
+     * (MacQueen's bounds), and each state-action pair whose value is
+     * provably below the optimal value of its state is permanently
+     * dropped. Later sweeps only compute the surviving pairs; the
+     * returned QFunction is still complete, as the dropped pairs are
+     * computed one last time at the end. This requires a discount below
+     * 1, and is not applied to in-place sweeps nor to streamed models.
+     * Since the bounds are on the infinite-horizon solution, it is also
+     * only applied when the tolerance is not zero: finite-horizon solves
+     * (with zero tolerance) always compute all pairs, as a pair
+     * suboptimal in the limit may still be optimal at a finite horizon.
      */
     class ValueIteration {
         public:
+            using CheckpointCallback = std::function<void(const ValueIterationCheckpoint &)>;
+
+            /**
+             * @brief This enum represents how states are updated during a timestep.
+             *
+             * - Jacobi: all states are updated from the previous values.
+             * - GaussSeidel: states are updated in place, in order.
+             * - Prioritized: states are updated in place, by decreasing
+             *   Bellman residual of the previous timestep.
+             * - Topological: strongly connected components are solved in
+             *   place one at a time, in reverse topological order.
+             */
+            enum class Sweep { Jacobi, GaussSeidel, Prioritized, Topological };
+
             /**
              * @brief Basic constructor.
              *
@@ -63,6 +170,129 @@ namespace AIToolbox::MDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction, QFunction> operator()(const M & m);
 
+            /**
+             * @brief This function resumes value iteration from a checkpoint.
+             *
+             * The run continues from the timestep of the checkpoint, with
+             * the currently set parameters, and returns the same results
+             * that the original run would have returned. The starting value
+             * function parameter is ignored.
+             *
+             * This function throws an std::invalid_argument if the
+             * checkpoint does not match the size of the model.
+             *
+             * @tparam M The type of the solvable MDP.
+             * @param m The MDP that needs to be solved.
+             * @param checkpoint The checkpoint to resume from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction, the ValueFunction and the QFunction for
+             *         the Model.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction, QFunction> operator()(const M & m, const ValueIterationCheckpoint & checkpoint);
+
+            /**
+             * @brief This function applies value iteration on a range of MDPs.
+             *
+             * Each model is solved exactly as operator() would, with the
+             * currently set parameters. If a ThreadPool is set, the range
+             * is split in contiguous blocks of models, one per thread, and
+             * each thread solves its models serially with its own
+             * workspaces. This avoids synchronizing threads at every
+             * timestep, which for small models would dominate the cost of
+             * the work itself.
+             *
+             * The results are identical to calling operator() on each
+             * model in turn. The input range must not be modified while
+             * this function is running. No checkpoints are emitted.
+             *
+             * @tparam It The type of the iterators; must be random access.
+             * @param begin The beginning of the range of models to solve.
+             * @param end The end of the range of models to solve.
+             *
+             * @return A vector containing, for each input model in order,
+             *         the result that operator() would have returned.
+             */
+            template <typename It, typename = std::enable_if_t<is_model_v<typename std::iterator_traits<It>::value_type>>>
+            std::vector<std::tuple<double, ValueFunction, QFunction>> solveBatch(It begin, It end);
+
+            /**
+             * @brief This function applies value iteration on the transitions of a model with multiple reward functions.
+             *
+             * This function solves K problems which share the transition
+             * function of the input model, but each have their own
+             * immediate rewards, and possibly their own discount. The
+             * rewards of the model itself are ignored.
+             *
+             * Instead of K separate matrix-vector products per action,
+             * the K value functions are stacked as the columns of a
+             * single matrix, so that each timestep computes a single
+             * matrix-matrix product per action (or a single one for fused
+             * models), reading the transitions only once. If a ThreadPool
+             * is set, actions are split between its threads.
+             *
+             * Each problem stops independently once it converges, and
+             * stops taking part in the products, so each result matches
+             * (up to floating point rounding) what operator() would return
+             * on a model with those rewards and discount. Jacobi sweeps
+             * are always used, and no checkpoints are emitted.
+             *
+             * This function throws std::invalid_argument if any reward
+             * matrix is not SxA, if the number of discounts is not 0, 1
+             * or K, or if any discount is not in (0,1].
+             *
+             * @param model The model containing the shared transition function.
+             * @param rewards The K SxA immediate reward matrices.
+             * @param discounts The discounts of the problems: none to use the one of the model, one for all problems, or one per problem.
+             *
+             * @return A vector containing, for each reward function in order, the variation, ValueFunction and QFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::vector<std::tuple<double, ValueFunction, QFunction>> solveRewards(const M & model, const Matrix3D & rewards, const std::vector<double> & discounts = {});
+
+            /**
+             * @brief This function updates a solution after some state-action pairs of the model have changed.
+             *
+             * The input ValueFunction should be a solution of the model as
+             * it was before the change, for example returned by a previous
+             * call to operator(). Only the states of the changed pairs can
+             * have a Bellman residual above the tolerance, so these are
+             * put in a priority queue, as in PrioritizedSweeping. The state
+             * with the highest priority is backed up in place, and its
+             * predecessors are queued with a priority equal to a bound on
+             * how much their own residual may have grown. This continues
+             * until no queued state can have a residual above the
+             * tolerance, so states which are not affected by the change
+             * are never touched.
+             *
+             * The horizon bounds the number of backups to horizon * S,
+             * the same number a full run would do. The predecessors are
+             * indexed once per call, which requires reading the
+             * transitions once.
+             *
+             * Finally, a single Jacobi timestep computes the returned
+             * QFunction and ValueFunction from the updated values; the
+             * returned variation is the one of this last timestep, and so
+             * an upper bound on the Bellman residual of the values
+             * before it. The starting value function parameter and the
+             * sweep mode are ignored, and no checkpoints are emitted.
+             *
+             * This function throws std::invalid_argument if the
+             * ValueFunction does not match the size of the model, or if
+             * any changed pair is out of bounds.
+             *
+             * @param model The MDP after the change.
+             * @param v The solution of the MDP before the change.
+             * @param changed The state-action pairs that have changed.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction, the ValueFunction and the QFunction for
+             *         the Model.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction, QFunction> resolve(const M & model, ValueFunction v, const std::vector<std::pair<size_t, size_t>> & changed);
+
             /**
              * @brief This function sets the tolerance parameter.
              *
@@ -97,6 +327,48 @@ namespace AIToolbox::MDP {
              */
             void setValueFunction(ValueFunction v);
 
+            /**
+             * @brief This function sets the ThreadPool to use to parallelize each timestep.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function sets how states are updated at each timestep.
+             *
+             * @param sweep The new sweep mode.
+             */
+            void setSweep(Sweep sweep);
+
+            /**
+             * @brief This function sets the callback that receives checkpoints.
+             *
+             * The callback is called at the end of every interval
+             * timesteps, with the state needed to resume the run. It is
+             * called from the thread running operator(). An empty callback
+             * (the default) disables checkpointing.
+             *
+             * @param callback The function to call with each checkpoint.
+             * @param interval The number of timesteps between checkpoints; must be > 0.
+             */
+            void setCheckpointCallback(CheckpointCallback callback, unsigned interval = 1);
+
+            /**
+             * @brief This function sets whether suboptimal actions are eliminated during Jacobi sweeps.
+             *
+             * Elimination only happens when converging to the
+             * infinite-horizon solution, i.e. with a non-zero tolerance
+             * and a discount below 1.
+             *
+             * @param eliminate Whether to eliminate actions.
+             */
+            void setActionElimination(bool eliminate);
+
             /**
              * @brief This function will return the currently set tolerance parameter.
              *
@@ -118,11 +390,65 @@ namespace AIToolbox::MDP {
              */
             const ValueFunction & getValueFunction() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function returns the currently set sweep mode.
+             *
+             * @return The currently set sweep mode.
+             */
+            Sweep getSweep() const;
+
+            /**
+             * @brief This function returns the number of timesteps between checkpoints.
+             *
+             * @return The currently set checkpoint interval.
+             */
+            unsigned getCheckpointInterval() const;
+
+            /**
+             * @brief This function returns whether suboptimal actions are eliminated during Jacobi sweeps.
+             *
+             * @return Whether action elimination is enabled.
+             */
+            bool getActionElimination() const;
+
+            /**
+             * @brief This function returns the number of state-action pairs eliminated during the last run.
+             *
+             * @return The number of pairs which were not computed by the last sweeps.
+             */
+            size_t getEliminatedPairs() const;
+
         private:
+            /**
+             * @brief This function runs value iteration from the input state.
+             *
+             * The starting value function must already be in v1_.
+             */
+            template <typename M>
+            std::tuple<double, ValueFunction, QFunction> solve(const M & model, unsigned timestep, double variation, Values residuals);
+
+            /**
+             * @brief This function emits a checkpoint if one is due at the input timestep.
+             */
+            void checkpoint(unsigned timestep, double variation, const Values & residuals) const;
+
             // Parameters
             double tolerance_;
             unsigned horizon_;
             ValueFunction vParameter_;
+            ThreadPool * pool_;
+            Sweep sweep_;
+            CheckpointCallback checkpoint_;
+            unsigned checkpointInterval_;
+            bool actionElimination_;
+            size_t eliminated_;
 
             // Internals
             ValueFunction v1_;
@@ -132,7 +458,6 @@ namespace AIToolbox::MDP {
     std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const M & model) {
         // Extract necessary knowledge from model so we don't have to pass it around
         const size_t S = model.getS();
-        const size_t A = model.getA();
 
         {
             // Verify that parameter value function is compatible.
@@ -148,42 +473,513 @@ namespace AIToolbox::MDP {
                 v1_ = vParameter_;
         }
 
-        const auto & ir = [&]{
-            if constexpr (is_model_eigen_v<M>) return model.getRewardFunction();
+        return solve(model, 0, tolerance_ * 2, Values()); // Make variation bigger
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const M & model, const ValueIterationCheckpoint & c) {
+        const size_t S = model.getS();
+        if ( static_cast<size_t>(c.v.values.size()) != S || c.v.actions.size() != S ||
+             (c.residuals.size() != 0 && static_cast<size_t>(c.residuals.size()) != S) )
+            throw std::invalid_argument("The checkpoint does not match the size of the model.");
+
+        v1_ = c.v;
+        return solve(model, c.timestep, c.variation, c.residuals);
+    }
+
+    template <typename M>
+    std::tuple<double, ValueFunction, QFunction> ValueIteration::solve(const M & model, unsigned timestep, double variation, Values residuals) {
+        const size_t S = model.getS();
+        const size_t A = model.getA();
+
+        // We convert the immediate rewards to a dense QFunction once, so
+        // that each timestep can simply copy them in the workspace.
+        const QFunction ir = [&]{
+            if constexpr (is_model_eigen_v<M>) return QFunction(model.getRewardFunction());
             else return computeImmediateRewards(model);
         }();
 
-        unsigned timestep = 0;
-        double variation = tolerance_ * 2; // Make it bigger
-
-        Values val0;
+        // These are the workspaces we reuse at every timestep, so that the
+        // main loop does not allocate.
+        Values val0(S);
         auto & val1 = v1_.values;
         QFunction q = makeQFunction(S, A);
 
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
+        const double discount = model.getDiscount();
+
+        // Computes the expected value of the next state for a single pair.
+        const auto future = [&model, S, A](const size_t s, const size_t a, const Values & values) {
+            if constexpr (is_model_fused_v<M>) {
+                return model.getTransitionFunction().row(s * A + a).dot(values);
+            } else if constexpr (is_model_eigen_v<M>) {
+                return model.getTransitionFunction(a).row(s).template cast<double>().dot(values);
+            } else {
+                double retval = 0.0;
+                for ( size_t s1 = 0; s1 < S; ++s1 )
+                    retval += model.getTransitionProbability(s, a, s1) * values[s1];
+                return retval;
+            }
+        };
+
+        eliminated_ = 0;
+        if constexpr (!is_model_streamed_v<M>) {
+            // MacQueen's bounds are on V*, so they can only be used when
+            // we are converging to it.
+            if ( actionElimination_ && useTolerance && sweep_ == Sweep::Jacobi && discount < 1.0 ) {
+                auto & actions = v1_.actions;
+                std::vector<char> alive(S * A, true);
+                const double factor = discount / (1.0 - discount);
+
+                while ( timestep < horizon_ && (!useTolerance || variation > tolerance_) ) {
+                    ++timestep;
+                    AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+                    AI_METRIC_TIME("MDP::ValueIteration::sweep");
+
+                    val0 = val1;
+
+                    auto sweep = [&](const size_t begin, const size_t end) {
+                        for ( size_t s = begin; s < end; ++s ) {
+                            double best = -std::numeric_limits<double>::infinity();
+                            for ( size_t a = 0; a < A; ++a ) {
+                                if ( !alive[s * A + a] ) continue;
+                                q(s, a) = ir(s, a) + discount * future(s, a, val0);
+                                if ( q(s, a) > best ) {
+                                    best = q(s, a);
+                                    actions[s] = a;
+                                }
+                            }
+                            val1[s] = best;
+                        }
+                    };
+                    if ( pool_ ) pool_->parallelFor(S, sweep);
+                    else         sweep(0, S);
+
+                    const auto delta = (val1 - val0).eval();
+                    variation = delta.cwiseAbs().maxCoeff();
+
+                    // V* is within [V + f * min(delta), V + f * max(delta)],
+                    // and Q* within the same shift of Q; a pair can never be
+                    // optimal once its upper bound is below the lower bound
+                    // of the value of its state.
+                    const double threshold = factor * (delta.maxCoeff() - delta.minCoeff()) + equalToleranceSmall;
+                    for ( size_t s = 0; s < S; ++s ) {
+                        for ( size_t a = 0; a < A; ++a ) {
+                            if ( alive[s * A + a] && val1[s] - q(s, a) > threshold ) {
+                                alive[s * A + a] = false;
+                                ++eliminated_;
+                            }
+                        }
+                    }
+                    checkpoint(timestep, variation, residuals);
+                }
+
+                // Fill in the pairs we stopped computing, with the same
+                // values as the last sweep.
+                for ( size_t s = 0; s < S; ++s )
+                    for ( size_t a = 0; a < A; ++a )
+                        if ( !alive[s * A + a] )
+                            q(s, a) = ir(s, a) + discount * future(s, a, val0);
+
+                return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1_), std::move(q));
+            }
+        }
+
+        if ( sweep_ == Sweep::Topological ) {
+            auto & actions = v1_.actions;
+            const auto components = computeStronglyConnectedComponents(model);
+            const size_t C = components.size();
+
+            std::vector<size_t> componentOf(S);
+            for ( size_t c = 0; c < C; ++c )
+                for ( const auto s : components[c] )
+                    componentOf[s] = c;
+
+            // The level of a component is one more than the highest level
+            // of the components it can reach. Successors always come first
+            // in the list, so a single pass is enough.
+            std::vector<size_t> level(C, 0);
+            std::vector<char> cyclic(C, false);
+            std::vector<std::vector<size_t>> levels;
+            for ( size_t c = 0; c < C; ++c ) {
+                cyclic[c] = components[c].size() > 1;
+                for ( const auto s : components[c] ) {
+                    for ( size_t a = 0; a < A; ++a ) {
+                        forEachSuccessor(model, s, a, [&](const size_t s1, double) {
+                            const auto c1 = componentOf[s1];
+                            if ( c1 == c ) cyclic[c] = true;
+                            else level[c] = std::max(level[c], level[c1] + 1);
+                        });
+                    }
+                }
+                if ( levels.size() <= level[c] ) levels.resize(level[c] + 1);
+                levels[level[c]].push_back(c);
+            }
+
+            std::vector<double> componentVariation(C, 0.0);
+            const auto solveComponent = [&](const size_t c) {
+                const auto & states = components[c];
+                double residual = 0.0;
+                for ( unsigned sweep = 0; sweep < horizon_; ++sweep ) {
+                    residual = 0.0;
+                    for ( const auto s : states ) {
+                        for ( size_t a = 0; a < A; ++a )
+                            q(s, a) = ir(s, a) + discount * future(s, a, val1);
+                        const double oldValue = val1[s];
+                        val1[s] = q.row(s).maxCoeff(&actions[s]);
+                        residual = std::max(residual, std::fabs(val1[s] - oldValue));
+                    }
+                    // Without cycles the values are already final.
+                    if ( !cyclic[c] ) { residual = 0.0; break; }
+                    if ( useTolerance && residual <= tolerance_ ) break;
+                }
+                componentVariation[c] = residual;
+            };
+
+            for ( const auto & cs : levels ) {
+                AI_METRIC_TIME("MDP::ValueIteration::sweep");
+                const auto solveBlock = [&](const size_t begin, const size_t end) {
+                    for ( size_t i = begin; i < end; ++i )
+                        solveComponent(cs[i]);
+                };
+                if ( pool_ ) pool_->parallelFor(cs.size(), solveBlock);
+                else         solveBlock(0, cs.size());
+            }
+
+            variation = 0.0;
+            for ( const auto v : componentVariation )
+                variation = std::max(variation, v);
+
+            return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1_), std::move(q));
+        }
+
+        if ( sweep_ != Sweep::Jacobi ) {
+            auto & actions = v1_.actions;
+
+            std::vector<size_t> order(S);
+            std::iota(std::begin(order), std::end(order), 0);
+
+            if ( residuals.size() != static_cast<Eigen::Index>(S) ) {
+                residuals.resize(S);
+                residuals.setZero();
+            }
+
+            while ( timestep < horizon_ && (!useTolerance || variation > tolerance_) ) {
+                ++timestep;
+                AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+                AI_METRIC_TIME("MDP::ValueIteration::sweep");
+
+                // On the first timestep we don't have residuals, so we use
+                // the natural order. Ties are always broken by state, so
+                // that the order only depends on the residuals.
+                if ( sweep_ == Sweep::Prioritized && timestep > 1 ) {
+                    std::iota(std::begin(order), std::end(order), 0);
+                    std::stable_sort(std::begin(order), std::end(order), [&residuals](const size_t lhs, const size_t rhs) {
+                        return residuals[lhs] > residuals[rhs];
+                    });
+                }
+
+                variation = 0.0;
+                for ( const auto s : order ) {
+                    for ( size_t a = 0; a < A; ++a )
+                        q(s, a) = ir(s, a) + discount * future(s, a, val1);
+                    const double oldValue = val1[s];
+                    val1[s] = q.row(s).maxCoeff(&actions[s]);
+
+                    residuals[s] = std::fabs(val1[s] - oldValue);
+                    variation = std::max(variation, residuals[s]);
+                }
+                checkpoint(timestep, variation, residuals);
+            }
+
+            return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1_), std::move(q));
+        }
+
         while ( timestep < horizon_ && (!useTolerance || variation > tolerance_) ) {
             ++timestep;
             AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+            AI_METRIC_TIME("MDP::ValueIteration::sweep");
 
             val0 = val1;
 
             // We apply the discount directly on the values vector.
             val1 *= model.getDiscount();
-            q = computeQFunction(model, val1, ir);
 
             // Compute the new value function (note that also val1 is overwritten)
-            bellmanOperatorInline(q, &v1_);
+            bool streamed = false;
+            if constexpr (is_model_streamed_v<M>) {
+                if ( model.getStreamingBlock() > 0 ) {
+                    computeQFunctionStreamedInline(model, val1, ir, &q, pool_);
+                    streamed = true;
+                }
+            }
+            if ( pool_ ) {
+                if ( !streamed ) computeQFunctionInline(model, val1, ir, &q, *pool_);
+                bellmanOperatorInline(q, &v1_, *pool_);
+            } else {
+                if ( !streamed ) computeQFunctionInline(model, val1, ir, &q);
+                bellmanOperatorInline(q, &v1_);
+            }
 
             // We do this only if the tolerance specified is positive, otherwise we
             // continue for all the timesteps.
             if ( useTolerance )
                 variation = (val1 - val0).cwiseAbs().maxCoeff();
+
+            checkpoint(timestep, variation, residuals);
         }
 
         // We do not guarantee that the Value/QFunctions are the perfect ones,
         // as we stop as within the given tolerance.
         return std::make_tuple(useTolerance ? variation : 0.0, std::move(v1_), std::move(q));
     }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction, QFunction> ValueIteration::resolve(const M & model, ValueFunction v, const std::vector<std::pair<size_t, size_t>> & changed) {
+        const size_t S = model.getS();
+        const size_t A = model.getA();
+
+        if ( static_cast<size_t>(v.values.size()) != S || v.actions.size() != S )
+            throw std::invalid_argument("The ValueFunction does not match the size of the model.");
+        for ( const auto & [s, a] : changed )
+            if ( s >= S || a >= A )
+                throw std::invalid_argument("Changed state-action pair out of bounds.");
+
+        const double discount = model.getDiscount();
+        const QFunction ir = [&]{
+            if constexpr (is_model_eigen_v<M>) return QFunction(model.getRewardFunction());
+            else return computeImmediateRewards(model);
+        }();
+
+        // For each state, the states which can reach it with the highest
+        // probability of any of their actions. A change of d in the value
+        // of a state changes the backup of each of its predecessors by at
+        // most discount * p * d.
+        std::vector<std::vector<std::pair<size_t, double>>> predecessors(S);
+        {
+            std::vector<size_t> lastSource(S, S);
+            for ( size_t s = 0; s < S; ++s ) {
+                for ( size_t a = 0; a < A; ++a ) {
+                    forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                        auto & preds = predecessors[s1];
+                        if ( lastSource[s1] != s ) {
+                            lastSource[s1] = s;
+                            preds.emplace_back(s, p);
+                        } else {
+                            preds.back().second = std::max(preds.back().second, p);
+                        }
+                    });
+                }
+            }
+        }
+
+        auto & values = v.values;
+        const auto backup = [&](const size_t s, size_t * action) {
+            double best = std::numeric_limits<double>::lowest();
+            for ( size_t a = 0; a < A; ++a ) {
+                double value = 0.0;
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    value += p * values[s1];
+                });
+                value = ir(s, a) + discount * value;
+                if ( value > best ) {
+                    best = value;
+                    *action = a;
+                }
+            }
+            return best;
+        };
+
+        const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
+        const auto push = [&](IndexedDaryHeap<> & queue, const size_t s, const double p) {
+            if ( useTolerance && p <= tolerance_ ) return;
+            if ( !queue.contains(s) ) queue.push(s, p);
+            else if ( queue.getPriority(s) < p ) queue.increase(s, p);
+        };
+
+        IndexedDaryHeap<> queue(S);
+        for ( const auto & [s, a] : changed ) {
+            if ( queue.contains(s) ) continue;
+            size_t action;
+            push(queue, s, std::fabs(backup(s, &action) - values[s]));
+        }
+
+        const size_t maxBackups = static_cast<size_t>(horizon_) * S;
+        size_t backups = 0;
+        while ( !queue.empty() && backups < maxBackups ) {
+            const size_t s = queue.top();
+            queue.pop();
+            ++backups;
+
+            const double oldValue = values[s];
+            values[s] = backup(s, &v.actions[s]);
+            const double delta = std::fabs(values[s] - oldValue);
+            if ( delta == 0.0 ) continue;
+
+            for ( const auto & [p, prob] : predecessors[s] ) {
+                // Bounds add up until the predecessor is backed up.
+                const double bound = (queue.contains(p) ? queue.getPriority(p) : 0.0) + discount * prob * delta;
+                push(queue, p, bound);
+            }
+        }
+        AI_LOGGER(AI_SEVERITY_DEBUG, "Incremental re-solve performed " << backups << " backups");
+
+        // A last full timestep gives the QFunction and the variation.
+        const Values old = values;
+        QFunction q = makeQFunction(S, A);
+        const Values discounted = values * discount;
+        if ( pool_ ) {
+            computeQFunctionInline(model, discounted, ir, &q, *pool_);
+            bellmanOperatorInline(q, &v, *pool_);
+        } else {
+            computeQFunctionInline(model, discounted, ir, &q);
+            bellmanOperatorInline(q, &v);
+        }
+        const double variation = (v.values - old).cwiseAbs().maxCoeff();
+
+        return std::make_tuple(useTolerance ? variation : 0.0, std::move(v), std::move(q));
+    }
+
+    template <typename It, typename>
+    std::vector<std::tuple<double, ValueFunction, QFunction>> ValueIteration::solveBatch(It begin, It end) {
+        const size_t N = std::distance(begin, end);
+
+        std::vector<std::tuple<double, ValueFunction, QFunction>> retval(N);
+
+        // Each block gets its own copy of the solver, so that workspaces
+        // are not shared between threads and no pool is used recursively.
+        auto solveBlock = [this, begin, &retval](const size_t from, const size_t to) {
+            ValueIteration solver(*this);
+            solver.pool_ = nullptr;
+            solver.checkpoint_ = nullptr;
+            for ( size_t i = from; i < to; ++i )
+                retval[i] = solver(*(begin + i));
+        };
+
+        if ( pool_ ) pool_->parallelFor(N, solveBlock);
+        else         solveBlock(0, N);
+
+        return retval;
+    }
+
+    template <typename M, typename>
+    std::vector<std::tuple<double, ValueFunction, QFunction>> ValueIteration::solveRewards(const M & model, const Matrix3D & rewards, const std::vector<double> & discounts) {
+        const size_t S = model.getS();
+        const size_t A = model.getA();
+        const size_t K = rewards.size();
+
+        for ( const auto & r : rewards )
+            if ( static_cast<size_t>(r.rows()) != S || static_cast<size_t>(r.cols()) != A )
+                throw std::invalid_argument("Reward matrices must be SxA");
+        if ( discounts.size() > 1 && discounts.size() != K )
+            throw std::invalid_argument("The number of discounts must be 0, 1 or equal to the number of reward matrices");
+        for ( const auto d : discounts )
+            if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+
+        std::vector<double> gamma(K, model.getDiscount());
+        if ( discounts.size() == 1 ) std::fill(std::begin(gamma), std::end(gamma), discounts[0]);
+        else if ( discounts.size() == K ) gamma = discounts;
+
+        // All problems start from the same values, as in operator().
+        Matrix2D values(S, K);
+        {
+            const bool useParameter = static_cast<size_t>(vParameter_.values.size()) == S;
+            if ( !useParameter && vParameter_.values.size() != 0 ) {
+                AI_LOGGER(AI_SEVERITY_WARNING, "Size of starting value function is incorrect, ignoring...");
+            }
+            for ( size_t k = 0; k < K; ++k ) {
+                if ( useParameter ) values.col(k) = vParameter_.values;
+                else values.col(k).setZero();
+            }
+        }
+
+        std::vector<QFunction> qs(K, makeQFunction(S, A));
+        std::vector<Actions> actions(K, Actions(S, 0));
+        std::vector<double> variations(K, tolerance_ * 2);
+
+        const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
+
+        // The problems which have not converged yet.
+        std::vector<size_t> active(K);
+        std::iota(std::begin(active), std::end(active), 0);
+
+        Matrix2D discounted;
+        unsigned timestep = 0;
+        while ( timestep < horizon_ && !active.empty() ) {
+            ++timestep;
+            AI_LOGGER(AI_SEVERITY_DEBUG, "Processing timestep " << timestep);
+            AI_METRIC_TIME("MDP::ValueIteration::sweep");
+
+            const size_t KA = active.size();
+            discounted.resize(S, KA);
+            for ( size_t i = 0; i < KA; ++i )
+                discounted.col(i) = values.col(active[i]) * gamma[active[i]];
+
+            if constexpr (is_model_fused_v<M>) {
+                const Matrix2D future = model.getTransitionFunction() * discounted;
+                for ( size_t i = 0; i < KA; ++i ) {
+                    const auto k = active[i];
+                    for ( size_t s = 0; s < S; ++s )
+                        for ( size_t a = 0; a < A; ++a )
+                            qs[k](s, a) = rewards[k](s, a) + future(s * A + a, i);
+                }
+            } else if constexpr (is_model_eigen_v<M>) {
+                const auto computeActions = [&](const size_t begin, const size_t end) {
+                    Matrix2D future;
+                    for ( size_t a = begin; a < end; ++a ) {
+                        future.noalias() = model.getTransitionFunction(a).template cast<double>() * discounted;
+                        for ( size_t i = 0; i < KA; ++i )
+                            qs[active[i]].col(a) = rewards[active[i]].col(a) + future.col(i);
+                    }
+                };
+                if ( pool_ ) pool_->parallelFor(A, computeActions);
+                else         computeActions(0, A);
+            } else {
+                const auto computeActions = [&](const size_t begin, const size_t end) {
+                    Vector future(KA);
+                    for ( size_t a = begin; a < end; ++a ) {
+                        for ( size_t s = 0; s < S; ++s ) {
+                            future.setZero();
+                            forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                                future += p * discounted.row(s1).transpose();
+                            });
+                            for ( size_t i = 0; i < KA; ++i )
+                                qs[active[i]](s, a) = rewards[active[i]](s, a) + future[i];
+                        }
+                    }
+                };
+                if ( pool_ ) pool_->parallelFor(A, computeActions);
+                else         computeActions(0, A);
+            }
+
+            for ( const auto k : active ) {
+                double variation = 0.0;
+                for ( size_t s = 0; s < S; ++s ) {
+                    const double v = qs[k].row(s).maxCoeff(&actions[k][s]);
+                    variation = std::max(variation, std::fabs(v - values(s, k)));
+                    values(s, k) = v;
+                }
+                variations[k] = variation;
+            }
+
+            if ( useTolerance )
+                active.erase(std::remove_if(std::begin(active), std::end(active), [&](const size_t k) {
+                    return variations[k] <= tolerance_;
+                }), std::end(active));
+        }
+
+        std::vector<std::tuple<double, ValueFunction, QFunction>> retval;
+        retval.reserve(K);
+        for ( size_t k = 0; k < K; ++k )
+            retval.emplace_back(useTolerance ? variations[k] : 0.0,
+                                ValueFunction{values.col(k), std::move(actions[k])},
+                                std::move(qs[k]));
+        return retval;
+    }
+
+    // The solver is compiled in the library for the common models.
+    extern template std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const Model &);
+    extern template std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const SparseModel &);
 }
 
 #endif
@@ -0,0 +1,756 @@
+#ifndef AI_TOOLBOX_MDP_BINARY_IO_HEADER_FILE
+#define AI_TOOLBOX_MDP_BINARY_IO_HEADER_FILE
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+
+namespace AIToolbox::MDP {
+    template <typename Scalar> class BasicModel;
+    template <typename Scalar> class BasicSparseModel;
+    using Model = BasicModel<double>;
+    using SparseModel = BasicSparseModel<double>;
+    class Experience;
+    class SparseExperience;
+    struct ValueIterationCheckpoint;
+
+    /**
+     * @brief The version of the binary format written by writeBinary().
+     *
+     * Files with a different version are rejected when read.
+     */
+    inline constexpr std::uint32_t BinaryFormatVersion = 1;
+
+    /**
+     * @brief The kinds of objects that can be stored in the binary format.
+     */
+    enum class BinaryType : std::uint32_t {
+        Model = 1,
+        SparseModel = 2,
+        Experience = 3,
+        SparseExperience = 4,
+        ValueIterationCheckpoint = 5,
+        TransitionTable = 6,
+        ExperienceTable = 7,
+    };
+
+    /**
+     * @brief This function writes a Model to a stream in binary format.
+     *
+     * The text operator<< writes every value in decimal, so large files
+     * are slow to read and write. The binary format instead stores a
+     * versioned header followed by the raw matrices of the object. Each
+     * matrix starts at a 64 byte boundary.
+     *
+     * A file in this format can be read back with readBinary(). It can
+     * also be memory-mapped and used directly with MappedModel, without
+     * any copy.
+     *
+     * Values are stored in the native byte order. This is checked when
+     * the file is read, so files cannot be moved between machines with a
+     * different byte order.
+     *
+     * The stream should be opened in binary mode.
+     *
+     * @param os The output stream.
+     * @param model The model to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const Model & model);
+
+    /**
+     * @brief This function writes a SparseModel to a stream in binary format.
+     *
+     * Each transition matrix is stored in compressed (CSR) form, so that
+     * the file can be mapped with MappedSparseModel.
+     *
+     * \sa writeBinary(std::ostream &, const Model &)
+     *
+     * @param os The output stream.
+     * @param model The model to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const SparseModel & model);
+
+    /**
+     * @brief This function writes an Experience to a stream in binary format.
+     *
+     * \sa writeBinary(std::ostream &, const Model &)
+     *
+     * @param os The output stream.
+     * @param exp The experience to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const Experience & exp);
+
+    /**
+     * @brief This function writes a SparseExperience to a stream in binary format.
+     *
+     * \sa writeBinary(std::ostream &, const Model &)
+     *
+     * @param os The output stream.
+     * @param exp The experience to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const SparseExperience & exp);
+
+    /**
+     * @brief This function writes a ValueIteration checkpoint to a stream in binary format.
+     *
+     * \sa writeBinary(std::ostream &, const Model &)
+     *
+     * @param os The output stream.
+     * @param checkpoint The checkpoint to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const ValueIterationCheckpoint & checkpoint);
+
+    /**
+     * @brief This function reads a Model from a stream in binary format.
+     *
+     * The whole object is read with one read per matrix, directly into
+     * its final storage.
+     *
+     * The object is replaced with the one in the file, including its
+     * size and discount. If the file is invalid, was written for a
+     * different type, or does not contain a valid model (as checked by
+     * the model constructors), the failbit of the stream is set and the
+     * input object is left untouched.
+     *
+     * @param is The input stream.
+     * @param model The model to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, Model & model);
+
+    /**
+     * @brief This function reads a SparseModel from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, Model &)
+     *
+     * @param is The input stream.
+     * @param model The model to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, SparseModel & model);
+
+    /**
+     * @brief This function reads an Experience from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, Model &)
+     *
+     * @param is The input stream.
+     * @param exp The experience to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, Experience & exp);
+
+    /**
+     * @brief This function reads a SparseExperience from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, Model &)
+     *
+     * @param is The input stream.
+     * @param exp The experience to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, SparseExperience & exp);
+
+    /**
+     * @brief This function reads a ValueIteration checkpoint from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, Model &)
+     *
+     * @param is The input stream.
+     * @param checkpoint The checkpoint to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, ValueIterationCheckpoint & checkpoint);
+
+    /**
+     * @brief This function writes a TransitionBatch to a stream as a columnar table.
+     *
+     * Tables store each field in its own contiguous column, so that other
+     * tools can use them without parsing. After the usual binary header
+     * (with S and A set to zero) there is a 64 byte table header, whose
+     * first two 64 bit integers are the number of rows and columns. Each
+     * column then follows as a raw array, starting at a 64 byte boundary.
+     *
+     * The columns of a TransitionBatch are, in order, the states, actions
+     * and next states (as 64 bit unsigned integers), the rewards (as
+     * doubles) and, only if present, the next actions. For example, the
+     * rewards can be read without any copy in Python with
+     *
+     *     numpy.memmap(filename, numpy.float64, 'r', 128 + 3 * padded, (rows,))
+     *
+     * where padded is rows * 8 rounded up to a multiple of 64.
+     *
+     * This function throws an std::invalid_argument if the arrays of the
+     * batch have different sizes.
+     *
+     * @param os The output stream.
+     * @param batch The batch to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const TransitionBatch & batch);
+
+    /**
+     * @brief This function reads a TransitionBatch from a columnar table.
+     *
+     * \sa writeBinary(std::ostream &, const TransitionBatch &)
+     *
+     * @param is The input stream.
+     * @param batch The batch to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, TransitionBatch & batch);
+
+    /**
+     * @brief This function writes the visits and rewards of an Experience as a columnar table.
+     *
+     * The table contains one row per transition with at least one visit,
+     * sorted by state, action and next state. Its columns are the states,
+     * actions and next states (as 64 bit unsigned integers), the visits
+     * (as 64 bit signed integers) and the sum of the rewards obtained (as
+     * doubles). The header stores the S and A of the Experience.
+     *
+     * This is the same data stored by writeBinary(std::ostream &, const
+     * Experience &), in a form that can be directly loaded as a data
+     * frame, and whose size depends on the number of visited transitions
+     * rather than on the size of the problem.
+     *
+     * \sa writeBinary(std::ostream &, const TransitionBatch &)
+     *
+     * @param os The output stream.
+     * @param exp The experience to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeExperienceTable(std::ostream & os, const Experience & exp);
+
+    /**
+     * @brief This function writes the visits and rewards of a SparseExperience as a columnar table.
+     *
+     * \sa writeExperienceTable(std::ostream &, const Experience &)
+     *
+     * @param os The output stream.
+     * @param exp The experience to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeExperienceTable(std::ostream & os, const SparseExperience & exp);
+
+    /**
+     * @brief This function adds all transitions in a columnar table to an Experience.
+     *
+     * The table can be written by writeExperienceTable(), or by any other
+     * tool using the same layout; rows for the same transition are
+     * summed. Unlike readBinary(), the visits and rewards are added to the
+     * ones already in the Experience, as if each transition was recorded
+     * in turn, and all recorded state-action pairs are marked as dirty.
+     *
+     * If the table is invalid, was written for different S or A, or
+     * contains an out of range row, the failbit of the stream is set and
+     * the Experience is not modified.
+     *
+     * @param is The input stream.
+     * @param exp The experience to record the transitions into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readExperienceTable(std::istream & is, Experience & exp);
+
+    /**
+     * @brief This function adds all transitions in a columnar table to a SparseExperience.
+     *
+     * \sa readExperienceTable(std::istream &, Experience &)
+     *
+     * @param is The input stream.
+     * @param exp The experience to record the transitions into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readExperienceTable(std::istream & is, SparseExperience & exp);
+
+    /**
+     * @brief This class maps a whole file in memory, read-only.
+     *
+     * The pages of a mapped file are shared between all processes
+     * mapping the same file. They are only loaded from disk when they are
+     * first accessed.
+     */
+    class MappedFile {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::runtime_error if the file
+             * cannot be opened or mapped.
+             *
+             * @param filename The file to map.
+             */
+            MappedFile(const std::string & filename);
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile & operator=(const MappedFile &) = delete;
+
+            /**
+             * @brief Basic destructor.
+             *
+             * This unmaps the file, so all pointers to its data become
+             * invalid.
+             */
+            ~MappedFile();
+
+            /**
+             * @brief This function returns a pointer to the start of the mapped file.
+             *
+             * @return A pointer to the mapped data.
+             */
+            const char * data() const;
+
+            /**
+             * @brief This function returns the size of the mapped file.
+             *
+             * @return The size of the file in bytes.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function asks the OS to start reading the input range from disk.
+             *
+             * This function returns immediately, while the pages are read
+             * in the background, so that reading can overlap with
+             * computation on other parts of the file. The range is
+             * extended to whole pages, and clamped to the file.
+             *
+             * @param p A pointer within the mapped file.
+             * @param bytes The size of the range.
+             */
+            void prefetch(const void * p, size_t bytes) const;
+
+            /**
+             * @brief This function tells the OS that the input range is not needed anymore.
+             *
+             * The pages of the range are removed from the memory of this
+             * process; they will be read again from the file if accessed.
+             * Only pages entirely within the range are evicted, so that
+             * adjacent data is not affected.
+             *
+             * @param p A pointer within the mapped file.
+             * @param bytes The size of the range.
+             */
+            void evict(const void * p, size_t bytes) const;
+
+        private:
+            const char * data_;
+            size_t size_;
+    };
+
+    /**
+     * @brief This class is a read-only Model backed by a memory-mapped binary file.
+     *
+     * The transition and reward matrices are Eigen::Maps over the mapped
+     * file, so opening a model does not read or copy its data. This class
+     * satisfies the is_model_eigen interface, so it can be used directly
+     * with all planning algorithms.
+     *
+     * The file must have been written with writeBinary(std::ostream &, const Model &).
+     *
+     * Copies of this class share the same mapped file, which is unmapped
+     * when the last copy is destroyed.
+     */
+    class MappedModel {
+        public:
+            using TransitionMatrix = std::vector<Eigen::Map<const Matrix2D>>;
+            using RewardMatrix     = Eigen::Map<const Matrix2D>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::runtime_error if the file
+             * does not contain a Model in binary format.
+             *
+             * To avoid reading the whole file, the transitions are not
+             * checked to be probabilities, so the file must be trusted.
+             *
+             * @param file The mapped file to use.
+             */
+            MappedModel(std::shared_ptr<const MappedFile> file);
+
+            /**
+             * @brief This constructor maps the input file and uses it.
+             *
+             * @param filename The file to map.
+             */
+            MappedModel(const std::string & filename);
+
+            /**
+             * @brief This function samples the MDP for the specified state action pair.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the discount factor stored in the file.
+             *
+             * @return The discount factor.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the stored transition probability for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The probability of the specified transition.
+             */
+            double getTransitionProbability(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the stored expected reward for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The expected reward of the specified transition.
+             */
+            double getExpectedReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the transition function for a given action.
+             *
+             * @param a The action requested.
+             *
+             * @return The transition function for the input action.
+             */
+            const Eigen::Map<const Matrix2D> & getTransitionFunction(size_t a) const;
+
+            /**
+             * @brief This function returns the rewards matrix for inspection.
+             *
+             * @return The rewards matrix.
+             */
+            const RewardMatrix & getRewardFunction() const;
+
+            /**
+             * @brief This function returns whether a given state is a terminal.
+             *
+             * @param s The state examined.
+             *
+             * @return True if the input state is a terminal, false otherwise.
+             */
+            bool isTerminal(size_t s) const;
+
+        private:
+            std::shared_ptr<const MappedFile> file_;
+
+            size_t S, A;
+            double discount_;
+
+            TransitionMatrix transitions_;
+            RewardMatrix rewards_;
+
+            mutable RandomEngine rand_;
+    };
+
+    /**
+     * @brief This class is a read-only SparseModel backed by a memory-mapped binary file.
+     *
+     * This class is the sparse equivalent of MappedModel: the transition
+     * and reward matrices are Eigen::Maps of compressed sparse matrices
+     * stored in the mapped file.
+     *
+     * The file must have been written with writeBinary(std::ostream &, const SparseModel &).
+     *
+     * For models larger than the available memory, streaming can be
+     * enabled with setStreamingBlock(). Algorithms that support it (as
+     * ValueIteration) then process the transition matrices in blocks of
+     * contiguous rows, asking the OS to read the next block while they
+     * compute on the current one, and evicting each block once done. This
+     * keeps the memory used by the model bounded by a few blocks.
+     */
+    class MappedSparseModel {
+        public:
+            using TransitionMatrix = std::vector<Eigen::Map<const SparseMatrix2D>>;
+            using RewardMatrix     = Eigen::Map<const SparseMatrix2D>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::runtime_error if the file
+             * does not contain a SparseModel in binary format, or if the
+             * indices of its sparse matrices are inconsistent.
+             *
+             * To avoid reading the whole file, the transitions are not
+             * checked to be probabilities, so the file must be trusted.
+             *
+             * @param file The mapped file to use.
+             */
+            MappedSparseModel(std::shared_ptr<const MappedFile> file);
+
+            /**
+             * @brief This constructor maps the input file and uses it.
+             *
+             * @param filename The file to map.
+             */
+            MappedSparseModel(const std::string & filename);
+
+            /**
+             * @brief This function samples the MDP for the specified state action pair.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the discount factor stored in the file.
+             *
+             * @return The discount factor.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the stored transition probability for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The probability of the specified transition.
+             */
+            double getTransitionProbability(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the stored expected reward for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The expected reward of the specified transition.
+             */
+            double getExpectedReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the transition function for a given action.
+             *
+             * @param a The action requested.
+             *
+             * @return The transition function for the input action.
+             */
+            const Eigen::Map<const SparseMatrix2D> & getTransitionFunction(size_t a) const;
+
+            /**
+             * @brief This function returns the rewards matrix for inspection.
+             *
+             * @return The rewards matrix.
+             */
+            const RewardMatrix & getRewardFunction() const;
+
+            /**
+             * @brief This function returns whether a given state is a terminal.
+             *
+             * @param s The state examined.
+             *
+             * @return True if the input state is a terminal, false otherwise.
+             */
+            bool isTerminal(size_t s) const;
+
+            /**
+             * @brief This function sets the number of rows of the blocks streamed by algorithms.
+             *
+             * A value of zero (the default) disables streaming, so that
+             * algorithms access the model as any other sparse model.
+             *
+             * @param rows The number of rows per block.
+             */
+            void setStreamingBlock(size_t rows);
+
+            /**
+             * @brief This function returns the number of rows of the blocks streamed by algorithms.
+             *
+             * @return The number of rows per block, or zero if streaming is disabled.
+             */
+            size_t getStreamingBlock() const;
+
+            /**
+             * @brief This function starts reading the input rows of a transition matrix in the background.
+             *
+             * @param a The action of the transition matrix.
+             * @param begin The first row to read.
+             * @param end One past the last row to read.
+             */
+            void prefetchRows(size_t a, size_t begin, size_t end) const;
+
+            /**
+             * @brief This function evicts the input rows of a transition matrix from memory.
+             *
+             * @param a The action of the transition matrix.
+             * @param begin The first row to evict.
+             * @param end One past the last row to evict.
+             */
+            void evictRows(size_t a, size_t begin, size_t end) const;
+
+        private:
+            std::shared_ptr<const MappedFile> file_;
+
+            size_t S, A;
+            double discount_;
+            size_t streamingBlock_;
+
+            TransitionMatrix transitions_;
+            RewardMatrix rewards_;
+
+            mutable RandomEngine rand_;
+    };
+
+    /**
+     * @brief This class is a read-only Experience backed by a memory-mapped binary file.
+     *
+     * This class satisfies the is_experience interface, so it can be
+     * used for example to build an RLModel from a large snapshot without
+     * loading it in memory.
+     *
+     * The file must have been written with writeBinary(std::ostream &, const Experience &).
+     */
+    class MappedExperience {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::runtime_error if the file
+             * does not contain an Experience in binary format.
+             *
+             * @param file The mapped file to use.
+             */
+            MappedExperience(std::shared_ptr<const MappedFile> file);
+
+            /**
+             * @brief This constructor maps the input file and uses it.
+             *
+             * @param filename The file to map.
+             */
+            MappedExperience(const std::string & filename);
+
+            /**
+             * @brief This function returns the current recorded visits for a transitions.
+             *
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             */
+            unsigned long getVisits(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the number of transitions recorded that start with the specified state and action.
+             *
+             * @param s     The initial state.
+             * @param a     Performed action.
+             *
+             * @return The total number of transitions that start with the specified state-action pair.
+             */
+            unsigned long getVisitsSum(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the cumulative rewards obtained from a specific transition.
+             *
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             */
+            double getReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the total reward obtained from transitions that start with the specified state and action.
+             *
+             * @param s     The initial state.
+             * @param a     Performed action.
+             *
+             * @return The total reward of the transitions that start with the specified state-action pair.
+             */
+            double getRewardSum(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+        private:
+            std::shared_ptr<const MappedFile> file_;
+
+            size_t S, A;
+
+            const long * visits_;
+            const long * visitsSum_;
+            const double * rewards_;
+            const double * rewardsSum_;
+    };
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef AI_TOOLBOX_MDP_COMPACT_EXPERIENCE_HEADER_FILE
+#define AI_TOOLBOX_MDP_COMPACT_EXPERIENCE_HEADER_FILE
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <AIToolbox/Types.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class keeps track of registered events and rewards, using as little memory as possible.
+     *
+     * This class has the same interface as MDP::Experience, and can be
+     * used in its place (for example with RLModel). The differences are
+     * in how the data is stored.
+     *
+     * The per-transition visit counts are stored as integers of type C,
+     * rather than as long. Since in most problems almost all counts are
+     * small, a 16 or 32 bit type is usually enough, and it halves or more
+     * the memory needed by the visits table. If a count would overflow,
+     * record() throws an std::overflow_error.
+     *
+     * The per state-action totals (visits and reward sums) are kept
+     * together in a single header per state-action pair, so that
+     * recording a transition touches a single cache line for them rather
+     * than two separate tables.
+     *
+     * Optionally, this class can also track the variance of the rewards
+     * obtained from each state-action pair, using Welford's online
+     * algorithm.
+     *
+     * @tparam C The unsigned integer type used to store visit counts.
+     */
+    template <typename C = std::uint32_t>
+    class CompactExperience {
+        static_assert(std::is_integral_v<C> && std::is_unsigned_v<C>, "The count type must be an unsigned integer!");
+
+        public:
+            using CountType = C;
+            using DirtyPairs = std::vector<std::pair<size_t, size_t>>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param trackVariance Whether to track the variance of the rewards of each state-action pair.
+             */
+            CompactExperience(size_t s, size_t a, bool trackVariance = false);
+
+            /**
+             * @brief This function adds a new event to the recordings.
+             *
+             * If the state-action pair was not already dirty, it is
+             * added to the dirty pairs. See getDirtyPairs().
+             *
+             * This function throws an std::overflow_error if the visits
+             * of the transition cannot be stored in the count type. In
+             * that case nothing is recorded.
+             *
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             * @param rew   Obtained reward.
+             */
+            void record(size_t s, size_t a, size_t s1, double rew);
+
+            /**
+             * @brief This function resets all experienced rewards and transitions.
+             */
+            void reset();
+
+            /**
+             * @brief This function returns the state-action pairs recorded since the last clear.
+             *
+             * \sa Experience::getDirtyPairs()
+             *
+             * @return The dirty state-action pairs.
+             */
+            const DirtyPairs & getDirtyPairs() const;
+
+            /**
+             * @brief This function clears the dirty state-action pairs.
+             */
+            void clearDirtyPairs();
+
+            /**
+             * @brief This function returns the current recorded visits for a transitions.
+             *
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             */
+            unsigned long getVisits(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the number of transitions recorded that start with the specified state and action.
+             *
+             * @param s     The initial state.
+             * @param a     Performed action.
+             *
+             * @return The total number of transitions that start with the specified state-action pair.
+             */
+            unsigned long getVisitsSum(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the cumulative rewards obtained from a specific transition.
+             *
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             */
+            double getReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the total reward obtained from transitions that start with the specified state and action.
+             *
+             * @param s     The initial state.
+             * @param a     Performed action.
+             *
+             * @return The total reward of the transitions that start with the specified state-action pair.
+             */
+            double getRewardSum(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the sample variance of the rewards obtained from the specified state and action.
+             *
+             * If variance tracking is disabled, or if the state-action
+             * pair has been visited less than twice, this function
+             * returns 0.
+             *
+             * @param s     The initial state.
+             * @param a     Performed action.
+             *
+             * @return The sample variance of the rewards of the state-action pair.
+             */
+            double getRewardVariance(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns whether the variance of the rewards is being tracked.
+             *
+             * @return True if the variance is tracked, false otherwise.
+             */
+            bool getTrackVariance() const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+        private:
+            struct Header {
+                unsigned long visitsSum;
+                double rewardSum;
+                // Only used when tracking the variance.
+                double rewardMean;
+                double rewardM2;
+            };
+
+            size_t S, A;
+            bool trackVariance_;
+
+            std::vector<Header> headers_;
+            std::vector<C> visits_;
+            std::vector<double> rewards_;
+
+            DirtyPairs dirty_;
+            std::vector<bool> isDirty_;
+    };
+
+    template <typename C>
+    CompactExperience<C>::CompactExperience(const size_t s, const size_t a, const bool trackVariance) :
+            S(s), A(a), trackVariance_(trackVariance), headers_(S * A, Header{0ul, 0.0, 0.0, 0.0}),
+            visits_(S * A * S, 0), rewards_(S * A * S, 0.0), isDirty_(S * A, false) {}
+
+    template <typename C>
+    void CompactExperience<C>::record(const size_t s, const size_t a, const size_t s1, const double rew) {
+        const size_t sa = s * A + a;
+        const size_t i = sa * S + s1;
+
+        if ( visits_[i] == std::numeric_limits<C>::max() )
+            throw std::overflow_error("Visits count does not fit in the count type of CompactExperience.");
+
+        visits_[i]  += 1;
+        rewards_[i] += rew;
+
+        auto & h = headers_[sa];
+        h.visitsSum += 1;
+        h.rewardSum += rew;
+
+        if ( trackVariance_ ) {
+            const double delta = rew - h.rewardMean;
+            h.rewardMean += delta / h.visitsSum;
+            h.rewardM2   += delta * (rew - h.rewardMean);
+        }
+
+        if ( !isDirty_[sa] ) {
+            isDirty_[sa] = true;
+            dirty_.emplace_back(s, a);
+        }
+    }
+
+    template <typename C>
+    void CompactExperience<C>::reset() {
+        std::fill(std::begin(headers_), std::end(headers_), Header{0ul, 0.0, 0.0, 0.0});
+        std::fill(std::begin(visits_), std::end(visits_), 0);
+        std::fill(std::begin(rewards_), std::end(rewards_), 0.0);
+        clearDirtyPairs();
+    }
+
+    template <typename C>
+    const typename CompactExperience<C>::DirtyPairs & CompactExperience<C>::getDirtyPairs() const {
+        return dirty_;
+    }
+
+    template <typename C>
+    void CompactExperience<C>::clearDirtyPairs() {
+        for ( const auto & [s, a] : dirty_ )
+            isDirty_[s * A + a] = false;
+        dirty_.clear();
+    }
+
+    template <typename C>
+    unsigned long CompactExperience<C>::getVisits(const size_t s, const size_t a, const size_t s1) const {
+        return visits_[(s * A + a) * S + s1];
+    }
+
+    template <typename C>
+    unsigned long CompactExperience<C>::getVisitsSum(const size_t s, const size_t a) const {
+        return headers_[s * A + a].visitsSum;
+    }
+
+    template <typename C>
+    double CompactExperience<C>::getReward(const size_t s, const size_t a, const size_t s1) const {
+        return rewards_[(s * A + a) * S + s1];
+    }
+
+    template <typename C>
+    double CompactExperience<C>::getRewardSum(const size_t s, const size_t a) const {
+        return headers_[s * A + a].rewardSum;
+    }
+
+    template <typename C>
+    double CompactExperience<C>::getRewardVariance(const size_t s, const size_t a) const {
+        const auto & h = headers_[s * A + a];
+        if ( !trackVariance_ || h.visitsSum < 2 ) return 0.0;
+        return h.rewardM2 / (h.visitsSum - 1);
+    }
+
+    template <typename C>
+    bool CompactExperience<C>::getTrackVariance() const { return trackVariance_; }
+
+    template <typename C>
+    size_t CompactExperience<C>::getS() const { return S; }
+
+    template <typename C>
+    size_t CompactExperience<C>::getA() const { return A; }
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef AI_TOOLBOX_MDP_CONCURRENT_RECORDER_HEADER_FILE
+#define AI_TOOLBOX_MDP_CONCURRENT_RECORDER_HEADER_FILE
+
+#include <mutex>
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class collects transitions from multiple threads, to be merged into a single Experience.
+     *
+     * Neither Experience nor SparseExperience can be written from
+     * multiple threads. Protecting them with a single mutex makes all
+     * actors contend on every transition recorded.
+     *
+     * This class splits recording into shards instead. Each actor thread
+     * writes to its own shard, which buffers its transitions. Each shard
+     * has its own lock, so actors using different shards never contend
+     * with each other.
+     *
+     * The learner periodically calls merge(), which swaps out each shard's
+     * buffer and replays its transitions into an Experience (or any class
+     * with a compatible record() method). Each swap holds the shard's lock
+     * for constant time, so actors are never stopped while the learner
+     * works. Since only the learner writes to the merged Experience,
+     * between merges it is a consistent snapshot. It can be resynced into
+     * a model via its dirty pairs:
+     *
+     * \code{.cpp}
+     * recorder.merge(exp);
+     * model.sync(exp.getDirtyPairs());
+     * exp.clearDirtyPairs();
+     * \endcode
+     *
+     * Buffers are reused across merges, so in steady state recording
+     * does not allocate.
+     */
+    class ConcurrentRecorder {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param shards The number of shards, usually the number of actor threads.
+             */
+            ConcurrentRecorder(size_t s, size_t a, size_t shards);
+
+            /**
+             * @brief This function records a new transition in the specified shard.
+             *
+             * This function can be called concurrently with any other
+             * function of this class. Each actor thread should use its own
+             * shard.
+             *
+             * @param shard The shard to record into.
+             * @param s     Old state.
+             * @param a     Performed action.
+             * @param s1    New state.
+             * @param rew   Obtained reward.
+             */
+            void record(size_t shard, size_t s, size_t a, size_t s1, double rew);
+
+            /**
+             * @brief This function moves all buffered transitions into the input experience.
+             *
+             * The transitions of each shard are replayed in the order in
+             * which they were recorded. Transitions recorded concurrently
+             * with this call may be merged now or in the next merge.
+             *
+             * The experience must not be accessed by other threads during
+             * this call.
+             *
+             * @param exp The experience to merge the transitions into.
+             *
+             * @return The number of transitions merged.
+             */
+            template <typename E, typename = std::enable_if_t<is_experience_v<E>>>
+            size_t merge(E & exp);
+
+            /**
+             * @brief This function returns the number of shards.
+             *
+             * @return The number of shards.
+             */
+            size_t getShards() const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+        private:
+            /**
+             * @brief This function swaps out the buffer of a shard, leaving it empty.
+             *
+             * @param shard The shard to swap.
+             */
+            void swapShard(size_t shard);
+
+            // Shards are aligned to avoid false sharing between actors.
+            struct alignas(64) Shard {
+                std::mutex mutex;
+                TransitionBatch buffer;
+            };
+
+            size_t S, A;
+            std::vector<Shard> shards_;
+            TransitionBatch merging_;
+    };
+
+    template <typename E, typename>
+    size_t ConcurrentRecorder::merge(E & exp) {
+        size_t merged = 0;
+        for ( size_t i = 0; i < shards_.size(); ++i ) {
+            swapShard(i);
+
+            const size_t N = merging_.states.size();
+            for ( size_t j = 0; j < N; ++j )
+                exp.record(merging_.states[j], merging_.actions[j], merging_.nextStates[j], merging_.rewards[j]);
+            merged += N;
+        }
+        return merged;
+    }
+}
+
+#endif
@@ -2,10 +2,15 @@
 #define AI_TOOLBOX_MDP_EXPERIENCE_HEADER_FILE
 
 #include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 
+namespace AIToolbox { class ThreadPool; }
+
 namespace AIToolbox::MDP {
     /**
      * @brief This class keeps track of registered events and rewards.
@@ -22,6 +27,7 @@ namespace AIToolbox::MDP {
             using VisitSumTable = DumbTable2D;
             using RewardMatrix = DumbMatrix3D;
             using RewardSumMatrix = DumbMatrix2D;
+            using DirtyPairs = std::vector<std::pair<size_t, size_t>>;
 
             /**
              * @brief Basic constructor.
@@ -86,6 +92,9 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function adds a new event to the recordings.
              *
+             * If the state-action pair was not already dirty, it is
+             * added to the dirty pairs. See getDirtyPairs().
+             *
              * @param s     Old state.
              * @param a     Performed action.
              * @param s1    New state.
@@ -98,6 +107,30 @@ namespace AIToolbox::MDP {
              */
             void reset();
 
+            /**
+             * @brief This function returns the state-action pairs recorded since the last clear.
+             *
+             * Each pair appears at most once, in the order in which it
+             * was first recorded. This allows to resync a model only
+             * for the pairs that have actually changed, for example via
+             * the batch overload of RLModel::sync(), without scanning the
+             * whole state-action space.
+             *
+             * Only record() marks pairs as dirty; setVisits() and
+             * setRewards() do not, as they change the whole Experience.
+             *
+             * @return The dirty state-action pairs.
+             */
+            const DirtyPairs & getDirtyPairs() const;
+
+            /**
+             * @brief This function clears the dirty state-action pairs.
+             *
+             * The storage of the pairs is kept, so that recording after
+             * a clear does not allocate.
+             */
+            void clearDirtyPairs();
+
             /**
              * @brief This function returns the current recorded visits for a transitions.
              *
@@ -164,6 +197,16 @@ namespace AIToolbox::MDP {
              */
             size_t getA() const;
 
+            /**
+             * @brief This function returns the heap memory used by the experience, in bytes.
+             *
+             * This includes the visit and reward tables, and the list of
+             * dirty pairs.
+             *
+             * @return The memory allocated by the experience.
+             */
+            size_t getMemoryUsage() const;
+
         private:
             size_t S, A;
 
@@ -173,7 +216,13 @@ namespace AIToolbox::MDP {
             RewardMatrix rewards_;
             RewardSumMatrix rewardsSum_;
 
+            DirtyPairs dirty_;
+            std::vector<bool> isDirty_;
+
             friend std::istream& operator>>(std::istream &is, Experience &);
+            friend std::istream& readBinary(std::istream &is, Experience &);
+            friend std::istream& readExperienceTable(std::istream &is, Experience &);
+            friend size_t readTransitionLog(const std::string & filename, Experience & exp, ThreadPool * pool);
     };
 
     template <typename V>
@@ -0,0 +1,380 @@
+#ifndef AI_TOOLBOX_MDP_FIXED_MODEL_HEADER_FILE
+#define AI_TOOLBOX_MDP_FIXED_MODEL_HEADER_FILE
+
+#include <array>
+#include <stdexcept>
+#include <tuple>
+
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents an MDP whose sizes are known at compile time.
+     *
+     * This class is equivalent to MDP::Model, but it stores its transition
+     * and reward functions in fixed-size Eigen matrices. For tiny problems
+     * this removes all heap allocations and indirections: the whole model
+     * lives inside the object, and all products computed by the solvers
+     * with its matrices have sizes known to the compiler, so they are
+     * fully unrolled and kept on the stack.
+     *
+     * Since the matrices are stored inline, this class should only be used
+     * for small state and action spaces (a few tens of states at most).
+     *
+     * This class satisfies is_model_eigen, so it can be used with all
+     * solvers that work with MDP::Model.
+     *
+     * @tparam S The number of states of the world.
+     * @tparam A The number of actions available to the agent.
+     */
+    template <size_t S, size_t A>
+    class FixedModel {
+        static_assert(S > 0 && A > 0, "FixedModel needs at least one state and one action!");
+
+        public:
+            using TransitionFunction = FixedMatrix2D<int(S), int(S)>;
+            using TransitionMatrix   = std::array<TransitionFunction, A>;
+            using RewardMatrix       = FixedMatrix2D<int(S), int(A)>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor initializes the FixedModel so that all
+             * transitions happen with probability 0 but for transitions
+             * that bring back to the same state, no matter the action.
+             *
+             * All rewards are set to 0.
+             *
+             * @param discount The discount factor for the MDP.
+             */
+            FixedModel(double discount = 1.0);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor takes two arbitrary three dimensional
+             * containers and tries to copy their contents into the
+             * transitions and rewards matrices respectively.
+             *
+             * The containers need to support data access through
+             * operator[], with dimensions S,A,S.
+             *
+             * This constructor throws an std::invalid_argument if the
+             * transition container does not contain valid probabilities,
+             * or if the discount is not in (0,1].
+             *
+             * @tparam T The external transition container type.
+             * @tparam R The external rewards container type.
+             * @param t The external transitions container.
+             * @param r The external rewards container.
+             * @param d The discount factor for the MDP.
+             */
+            template <typename T, typename R>
+            FixedModel(const T & t, const R & r, double d = 1.0);
+
+            /**
+             * @brief Copy constructor from any valid MDP model.
+             *
+             * This constructor throws an std::invalid_argument if the
+             * sizes of the input model do not match the ones of this
+             * class, or if it does not contain valid probabilities.
+             *
+             * @tparam M The type of the other model.
+             * @param model The model that needs to be copied.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            FixedModel(const M& model);
+
+            /**
+             * @brief This function replaces the transition function with the one provided.
+             *
+             * The container needs to support data access through
+             * operator[], with dimensions S,A,S.
+             *
+             * This function will throw a std::invalid_argument if the
+             * container does not contain valid probabilities.
+             *
+             * @tparam T The external transition container type.
+             * @param t The external transitions container.
+             */
+            template <typename T>
+            void setTransitionFunction(const T & t);
+
+            /**
+             * @brief This function sets the transition function using fixed-size Eigen matrices.
+             *
+             * This function will throw a std::invalid_argument if the
+             * matrices do not contain valid probabilities.
+             *
+             * @param t The input transition function, one SxS' matrix per action.
+             */
+            void setTransitionFunction(const TransitionMatrix & t);
+
+            /**
+             * @brief This function replaces the reward function with the one provided.
+             *
+             * The container needs to support data access through
+             * operator[], with dimensions S,A,S. The rewards are stored
+             * as their expectation over the current transition function.
+             *
+             * @tparam R The external rewards container type.
+             * @param r The external rewards container.
+             */
+            template <typename R>
+            void setRewardFunction(const R & r);
+
+            /**
+             * @brief This function sets the reward function using a fixed-size Eigen matrix.
+             *
+             * @param r The input reward function, as an SxA matrix.
+             */
+            void setRewardFunction(const RewardMatrix & r);
+
+            /**
+             * @brief This function sets a new discount factor for the Model.
+             *
+             * @param d The new discount factor for the Model.
+             */
+            void setDiscount(double d);
+
+            /**
+             * @brief This function samples the MDP with the specified state action pair.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
+
+            /**
+             * @brief This function samples the MDP with the input random engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a, RandomEngine & rnd) const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the currently set discount factor.
+             *
+             * @return The currently set discount factor.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the stored transition probability for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The probability of the specified transition.
+             */
+            double getTransitionProbability(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the stored expected reward for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The expected reward of the specified transition.
+             */
+            double getExpectedReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the transition matrix for inspection.
+             *
+             * @return The transition matrix.
+             */
+            const TransitionMatrix & getTransitionFunction() const;
+
+            /**
+             * @brief This function returns the transition function for a given action.
+             *
+             * @param a The action requested.
+             *
+             * @return The transition function for the input action.
+             */
+            const TransitionFunction & getTransitionFunction(size_t a) const;
+
+            /**
+             * @brief This function returns the rewards matrix for inspection.
+             *
+             * @return The rewards matrix.
+             */
+            const RewardMatrix & getRewardFunction() const;
+
+            /**
+             * @brief This function returns whether a given state is a terminal.
+             *
+             * @param s The state examined.
+             *
+             * @return True if the input state is a terminal, false otherwise.
+             */
+            bool isTerminal(size_t s) const;
+
+        private:
+            double discount_;
+
+            TransitionMatrix transitions_;
+            RewardMatrix rewards_;
+
+            mutable RandomEngine rand_;
+    };
+
+    template <size_t S, size_t A>
+    FixedModel<S, A>::FixedModel(const double discount) :
+            rand_(Impl::Seeder::getSeed())
+    {
+        setDiscount(discount);
+        for ( auto & t : transitions_ )
+            t.setIdentity();
+        rewards_.setZero();
+    }
+
+    template <size_t S, size_t A>
+    template <typename T, typename R>
+    FixedModel<S, A>::FixedModel(const T & t, const R & r, const double d) :
+            rand_(Impl::Seeder::getSeed())
+    {
+        setDiscount(d);
+        setTransitionFunction(t);
+        setRewardFunction(r);
+    }
+
+    template <size_t S, size_t A>
+    template <typename M, typename>
+    FixedModel<S, A>::FixedModel(const M& model) :
+            rand_(Impl::Seeder::getSeed())
+    {
+        if ( model.getS() != S || model.getA() != A )
+            throw std::invalid_argument("Input model has different sizes than the FixedModel.");
+
+        setDiscount(model.getDiscount());
+        rewards_.setZero();
+        for ( size_t a = 0; a < A; ++a )
+            for ( size_t s = 0; s < S; ++s ) {
+                for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                    transitions_[a](s, s1) = model.getTransitionProbability(s, a, s1);
+                    rewards_(s, a) += model.getExpectedReward(s, a, s1) * transitions_[a](s, s1);
+                }
+                if ( !isProbability(S, transitions_[a].row(s)) )
+                    throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+            }
+    }
+
+    template <size_t S, size_t A>
+    template <typename T>
+    void FixedModel<S, A>::setTransitionFunction(const T & t) {
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                if ( !isProbability(S, t[s][a]) )
+                    throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                for ( size_t s1 = 0; s1 < S; ++s1 )
+                    transitions_[a](s, s1) = t[s][a][s1];
+    }
+
+    template <size_t S, size_t A>
+    void FixedModel<S, A>::setTransitionFunction(const TransitionMatrix & t) {
+        for ( size_t a = 0; a < A; ++a )
+            for ( size_t s = 0; s < S; ++s )
+                if ( t[a].row(s).minCoeff() < 0.0 || !checkEqualSmall(1.0, t[a].row(s).sum()) )
+                    throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+
+        transitions_ = t;
+    }
+
+    template <size_t S, size_t A>
+    template <typename R>
+    void FixedModel<S, A>::setRewardFunction(const R & r) {
+        rewards_.setZero();
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                for ( size_t s1 = 0; s1 < S; ++s1 )
+                    rewards_(s, a) += r[s][a][s1] * transitions_[a](s, s1);
+    }
+
+    template <size_t S, size_t A>
+    void FixedModel<S, A>::setRewardFunction(const RewardMatrix & r) {
+        rewards_ = r;
+    }
+
+    template <size_t S, size_t A>
+    void FixedModel<S, A>::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    template <size_t S, size_t A>
+    std::tuple<size_t, double> FixedModel<S, A>::sampleSR(const size_t s, const size_t a) const {
+        return sampleSR(s, a, rand_);
+    }
+
+    template <size_t S, size_t A>
+    std::tuple<size_t, double> FixedModel<S, A>::sampleSR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const size_t s1 = sampleProbability(S, transitions_[a].row(s), rnd);
+        return std::make_tuple(s1, rewards_(s, a));
+    }
+
+    template <size_t S, size_t A>
+    size_t FixedModel<S, A>::getS() const { return S; }
+    template <size_t S, size_t A>
+    size_t FixedModel<S, A>::getA() const { return A; }
+    template <size_t S, size_t A>
+    double FixedModel<S, A>::getDiscount() const { return discount_; }
+
+    template <size_t S, size_t A>
+    double FixedModel<S, A>::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+        return transitions_[a](s, s1);
+    }
+
+    template <size_t S, size_t A>
+    double FixedModel<S, A>::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+        return rewards_(s, a);
+    }
+
+    template <size_t S, size_t A>
+    const typename FixedModel<S, A>::TransitionMatrix & FixedModel<S, A>::getTransitionFunction() const { return transitions_; }
+    template <size_t S, size_t A>
+    const typename FixedModel<S, A>::TransitionFunction & FixedModel<S, A>::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    template <size_t S, size_t A>
+    const typename FixedModel<S, A>::RewardMatrix & FixedModel<S, A>::getRewardFunction() const { return rewards_; }
+
+    template <size_t S, size_t A>
+    bool FixedModel<S, A>::isTerminal(const size_t s) const {
+        for ( size_t a = 0; a < A; ++a )
+            if ( !checkEqualSmall(1.0, transitions_[a](s, s)) )
+                return false;
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef AI_TOOLBOX_MDP_FUSED_SPARSE_MODEL_HEADER_FILE
+#define AI_TOOLBOX_MDP_FUSED_SPARSE_MODEL_HEADER_FILE
+
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+
+#include <AIToolbox/Utils/Probability.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents a sparse Markov Decision Process with all actions fused in a single matrix.
+     *
+     * This class is equivalent to MDP::SparseModel, but stores its
+     * transition function differently. Rather than keeping a separate
+     * sparse matrix for each action, all transitions are kept in a single
+     * (S*A)xS row-major sparse matrix, where the row s*A + a contains the
+     * distribution of the next state for the state-action pair (s, a).
+     *
+     * This layout matches the one of a QFunction (which is SxA row-major),
+     * so that a full Bellman backup becomes a single sparse matrix-vector
+     * product which writes directly into the QFunction, touching a single
+     * set of contiguous index and value arrays.
+     *
+     * In addition, this class precomputes the cumulative distribution of
+     * each row. Thus sampleSR() can find the next state with a binary
+     * search, rather than with a linear scan of the row.
+     *
+     * The downside is that the transition function of a single action
+     * cannot be accessed as a matrix: this class does not satisfy the
+     * is_model_eigen interface, and is instead recognized via
+     * is_model_fused by the algorithms that can exploit it.
+     *
+     * The reward function is stored as a dense SxA matrix.
+     */
+    class FusedSparseModel {
+        public:
+            using TransitionMatrix   = SparseMatrix2D;
+            using RewardMatrix       = Matrix2D;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor initializes the FusedSparseModel so that
+             * all transitions happen with probability 0 but for
+             * transitions that bring back to the same state, no matter the
+             * action.
+             *
+             * All rewards are set to 0. The discount parameter is set to
+             * 1.
+             *
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param discount The discount factor for the MDP.
+             */
+            FusedSparseModel(size_t s, size_t a, double discount = 1.0);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor takes two arbitrary three dimensional
+             * containers and tries to copy their contents into the
+             * transitions and rewards matrices respectively.
+             *
+             * The containers need to support data access through
+             * operator[]. In addition, the dimensions of the containers
+             * must match the ones provided as arguments (for three
+             * dimensions: S,A,S).
+             *
+             * This is important, as this constructor DOES NOT perform any
+             * size checks on the external containers.
+             *
+             * Internal values of the containers will be converted to
+             * double, so these conversions must be possible.
+             *
+             * In addition, the transition container must contain a valid
+             * transition function.
+             *
+             * The discount parameter must be between 0 and 1 included,
+             * otherwise the constructor will throw an
+             * std::invalid_argument.
+             *
+             * @tparam T The external transition container type.
+             * @tparam R The external rewards container type.
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param t The external transitions container.
+             * @param r The external rewards container.
+             * @param d The discount factor for the MDP.
+             */
+            template <typename T, typename R>
+            FusedSparseModel(size_t s, size_t a, const T & t, const R & r, double d = 1.0);
+
+            /**
+             * @brief Copy constructor from any valid MDP model.
+             *
+             * This allows to copy from any other model. In particular, it
+             * can be used to convert an existing MDP::SparseModel into
+             * this layout.
+             *
+             * @tparam M The type of the other model.
+             * @param model The model that needs to be copied.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            FusedSparseModel(const M& model);
+
+            /**
+             * @brief Unchecked constructor.
+             *
+             * This constructor takes ownership of the data that it is passed
+             * to it to avoid any sorts of copies and additional work (sanity
+             * checks), in order to speed up as much as possible the process of
+             * building a new Model.
+             *
+             * The cumulative distributions of the transition function are
+             * still computed, so the input matrix must be (S*A)xS.
+             *
+             * Note that to use it you have to explicitly use the NO_CHECK tag
+             * parameter first.
+             *
+             * @param s The state space of the FusedSparseModel.
+             * @param a The action space of the FusedSparseModel.
+             * @param t The transition function to be used in the FusedSparseModel.
+             * @param r The reward function to be used in the FusedSparseModel.
+             * @param d The discount factor for the FusedSparseModel.
+             */
+            FusedSparseModel(NoCheck, size_t s, size_t a, TransitionMatrix && t, RewardMatrix && r, double d);
+
+            /**
+             * @brief This function replaces the transition function with the one provided.
+             *
+             * This function will throw a std::invalid_argument if the
+             * matrix provided does not contain valid probabilities.
+             *
+             * The container needs to support data access through
+             * operator[]. In addition, the dimensions of the container
+             * must match the ones provided as arguments (for three
+             * dimensions: S,A,S).
+             *
+             * This is important, as this function DOES NOT perform any
+             * size checks on the external container.
+             *
+             * @tparam T The external transition container type.
+             * @param t The external transitions container.
+             */
+            template <typename T>
+            void setTransitionFunction(const T & t);
+
+            /**
+             * @brief This function sets the transition function using a fused Eigen sparse matrix.
+             *
+             * This function will throw a std::invalid_argument if the
+             * matrix provided does not contain valid probabilities, or if
+             * it is not (S*A)xS.
+             *
+             * The row s*A + a of the input matrix must contain the
+             * transition probabilities for the state-action pair (s, a).
+             *
+             * @param t The external transitions container.
+             */
+            void setTransitionFunction(const TransitionMatrix & t);
+
+            /**
+             * @brief This function replaces the reward function with the one provided.
+             *
+             * The container needs to support data access through
+             * operator[]. In addition, the dimensions of the containers
+             * must match the ones provided as arguments (for three
+             * dimensions: S,A,S).
+             *
+             * This is important, as this function DOES NOT perform any
+             * size checks on the external containers.
+             *
+             * @tparam R The external rewards container type.
+             * @param r The external rewards container.
+             */
+            template <typename R>
+            void setRewardFunction(const R & r);
+
+            /**
+             * @brief This function replaces the reward function with the one provided.
+             *
+             * The dimensions of the container must match the ones provided
+             * as arguments (for two dimensions: S, A). BE CAREFUL.
+             *
+             * This function does DOES NOT perform any size checks on the
+             * input.
+             *
+             * @param r The external rewards container.
+             */
+            void setRewardFunction(const RewardMatrix & r);
+
+            /**
+             * @brief This function sets a new discount factor for the FusedSparseModel.
+             *
+             * @param d The new discount factor for the FusedSparseModel.
+             */
+            void setDiscount(double d);
+
+            /**
+             * @brief This function samples the MDP for the specified state action pair.
+             *
+             * This function samples the model for simulated experience.
+             * The new state is found with a binary search over the
+             * precomputed cumulative distribution of the transition row,
+             * and the reward is the corresponding reward contained in the
+             * reward function.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the currently set discount factor.
+             *
+             * @return The currently set discount factor.
+             */
+            double getDiscount() const;
+
+            /**
+             * @brief This function returns the stored transition probability for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The probability of the specified transition.
+             */
+            double getTransitionProbability(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the stored expected reward for the specified transition.
+             *
+             * @param s The initial state of the transition.
+             * @param a The action performed in the transition.
+             * @param s1 The final state of the transition.
+             *
+             * @return The expected reward of the specified transition.
+             */
+            double getExpectedReward(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the fused (S*A)xS transition matrix.
+             *
+             * @return The transition matrix.
+             */
+            const TransitionMatrix & getTransitionFunction() const;
+
+            /**
+             * @brief This function returns the rewards matrix for inspection.
+             *
+             * @return The rewards matrix.
+             */
+            const RewardMatrix & getRewardFunction() const;
+
+            /**
+             * @brief This function returns whether a given state is a terminal.
+             *
+             * @param s The state examined.
+             *
+             * @return True if the input state is a terminal, false otherwise.
+             */
+            bool isTerminal(size_t s) const;
+
+        private:
+            /**
+             * @brief This function recomputes the cumulative distributions of the transition rows.
+             */
+            void computeCumulatives();
+
+            size_t S, A;
+            double discount_;
+
+            TransitionMatrix transitions_;
+            Vector cumulatives_;
+            RewardMatrix rewards_;
+
+            mutable RandomEngine rand_;
+    };
+
+    template <typename T, typename R>
+    FusedSparseModel::FusedSparseModel(const size_t s, const size_t a, const T & t, const R & r, const double d) :
+            S(s), A(a), transitions_(S * A, S),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    {
+        setDiscount(d);
+        setTransitionFunction(t);
+        setRewardFunction(r);
+    }
+
+    template <typename M, typename>
+    FusedSparseModel::FusedSparseModel(const M& model) :
+            S(model.getS()), A(model.getA()), transitions_(S * A, S),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    {
+        setDiscount(model.getDiscount());
+        rewards_.setZero();
+        for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a ) {
+            const size_t row = s * A + a;
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                const double p = model.getTransitionProbability(s, a, s1);
+                if ( p < 0.0 || p > 1.0 )
+                    throw std::invalid_argument("Input transition matrix contains an invalid value.");
+
+                if ( checkDifferentSmall(0.0, p) ) transitions_.insert(row, s1) = p;
+                const double r = model.getExpectedReward(s, a, s1);
+                if ( checkDifferentSmall(0.0, r) ) rewards_(s, a) += r * p;
+            }
+            if ( checkDifferentSmall(1.0, transitions_.row(row).sum()) )
+                throw std::invalid_argument("Input transition matrix contains an invalid row.");
+        }
+        transitions_.makeCompressed();
+        computeCumulatives();
+    }
+
+    template <typename T>
+    void FusedSparseModel::setTransitionFunction(const T & t) {
+        // First we verify data, without modifying anything...
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                if ( !isProbability(S, t[s][a]) )
+                    throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+
+        // Then we copy. Rows are filled in order, so insertion is cheap.
+        transitions_.setZero();
+        for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+        for ( size_t s1 = 0; s1 < S; ++s1 ) {
+            const double p = t[s][a][s1];
+            if ( checkDifferentSmall(0.0, p) ) transitions_.insert(s * A + a, s1) = p;
+        }
+        transitions_.makeCompressed();
+        computeCumulatives();
+    }
+
+    template <typename R>
+    void FusedSparseModel::setRewardFunction( const R & r ) {
+        rewards_.setZero();
+        for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+        for ( SparseMatrix2D::InnerIterator it(transitions_, s * A + a); it; ++it )
+            rewards_(s, a) += r[s][a][it.col()] * it.value();
+    }
+}
+
+#endif
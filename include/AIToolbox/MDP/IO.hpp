@@ -3,10 +3,14 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 
 #include <AIToolbox/MDP/Policies/PolicyInterface.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+namespace AIToolbox { class ThreadPool; }
 
 namespace AIToolbox::MDP {
     /**
@@ -21,6 +25,22 @@ namespace AIToolbox::MDP {
      */
     Model parseCassandra(std::istream & input);
 
+    /**
+     * @brief This function parses a sparse MDP from a Cassandra formatted stream.
+     *
+     * The model is built directly from the sparse representation read by
+     * the parser, so that no dense S*S*A table is ever allocated.
+     *
+     * This function may throw std::runtime_errors depending on whether the
+     * input is correctly formed or not, and std::invalid_argument if the
+     * parsed transition function is invalid.
+     *
+     * @param input The input stream.
+     *
+     * @return The parsed model.
+     */
+    SparseModel parseCassandraSparse(std::istream & input);
+
     /**
      * @brief This function prints any MDP model to a file.
      *
@@ -125,7 +145,55 @@ namespace AIToolbox::MDP {
      */
     std::istream& operator>>(std::istream &is, SparseExperience & e);
 
-    class Model;
+    /**
+     * @brief This function adds all transitions in a text log file to an Experience.
+     *
+     * The log contains one transition per line, written as
+     *
+     *     <state> <action> <next-state> <reward>
+     *
+     * separated by whitespace. Empty lines are skipped.
+     *
+     * Calling Experience::record() once per line through iostreams is too
+     * slow for large logs. This function instead splits the file into one
+     * byte range per thread of the pool; each thread reads the lines that
+     * start in its range, parses them without going through streams, and counts
+     * them into its own shard, keyed on the observed transitions. The
+     * shards are then merged into the Experience, so the memory used is
+     * proportional to the number of distinct transitions in the log, and
+     * not to its length.
+     *
+     * The result is the same as recording each transition in turn,
+     * except that rewards may be summed in a different order. All
+     * recorded state-action pairs are marked as dirty.
+     *
+     * If the file cannot be read, or a line is malformed or out of range,
+     * this function throws an std::runtime_error, and the Experience is
+     * not modified.
+     *
+     * @param filename The name of the log file.
+     * @param exp The Experience to record the transitions into.
+     * @param pool An optional pool to parse the file in parallel.
+     *
+     * @return The number of transitions read.
+     */
+    size_t readTransitionLog(const std::string & filename, Experience & exp, ThreadPool * pool = nullptr);
+
+    /**
+     * @brief This function adds all transitions in a text log file to a SparseExperience.
+     *
+     * This function works like the Experience overload. The merged
+     * counts of each action are added to the SparseExperience as whole
+     * sparse matrices, rather than inserted one by one.
+     *
+     * @param filename The name of the log file.
+     * @param exp The SparseExperience to record the transitions into.
+     * @param pool An optional pool to parse the file in parallel.
+     *
+     * @return The number of transitions read.
+     */
+    size_t readTransitionLog(const std::string & filename, SparseExperience & exp, ThreadPool * pool = nullptr);
+
     /**
      * @brief This function implements input from stream for the MDP::Model class.
      *
@@ -0,0 +1,101 @@
+#ifndef AI_TOOLBOX_MDP_MATERIALIZE_HEADER_FILE
+#define AI_TOOLBOX_MDP_MATERIALIZE_HEADER_FILE
+
+#include <utility>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This function returns the fraction of non-zero transitions of a model.
+     *
+     * The result is the number of (s, a, s1) triples with a non-zero
+     * transition probability, divided by S*A*S.
+     *
+     * For models which satisfy is_model_eigen_v this only looks at the
+     * stored matrices, while for other models all transition
+     * probabilities are queried once.
+     *
+     * @param model The model to inspect.
+     *
+     * @return The density of the transition function, in [0, 1].
+     */
+    template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+    double computeTransitionDensity(const M & model) {
+        const size_t S = model.getS(), A = model.getA();
+
+        size_t nonZeros = 0;
+        for ( size_t a = 0; a < A; ++a ) {
+            if constexpr (is_model_eigen_v<M>) {
+                const auto & t = model.getTransitionFunction(a);
+                // Dense matrices count all their entries as stored, so we
+                // count explicitly.
+                if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<remove_cv_ref_t<decltype(t)>>, remove_cv_ref_t<decltype(t)>>)
+                    nonZeros += t.nonZeros();
+                else
+                    nonZeros += (t.array() != 0).count();
+            } else {
+                for ( size_t s = 0; s < S; ++s )
+                    for ( size_t s1 = 0; s1 < S; ++s1 )
+                        if ( checkDifferentSmall(0.0, model.getTransitionProbability(s, a, s1)) )
+                            ++nonZeros;
+            }
+        }
+        return static_cast<double>(nonZeros) / (S * A * S);
+    }
+
+    /**
+     * @brief This function calls a function with an Eigen version of the input model.
+     *
+     * Models which do not satisfy is_model_eigen_v (for example custom
+     * adapters, or models wrapping external code) can only be accessed
+     * through getTransitionProbability() and getExpectedReward(), which
+     * makes each Bellman backup much slower than the matrix products
+     * used for Eigen models.
+     *
+     * This function copies such a model into an Eigen model, and then
+     * calls the input function with the snapshot, so that each
+     * transition probability is queried only a couple of times rather
+     * than at every backup. The snapshot is a SparseModel if the
+     * density of the transition function is at most the input threshold,
+     * and a Model otherwise. Models which already satisfy
+     * is_model_eigen_v are passed directly without copies.
+     *
+     * Since the type of the model is only known at runtime, the input
+     * function must be callable with both Model and SparseModel, and must
+     * return the same type for both. A generic lambda is usually the
+     * simplest choice:
+     *
+     * \code{.cpp}
+     * ValueIteration vi(1000, 0.001);
+     * auto solution = withEigenModel(myModel, [&](const auto & m) { return vi(m); });
+     * \endcode
+     *
+     * Note that the snapshot is destroyed when this function returns, so
+     * the input function must not return references to it.
+     *
+     * @param model The model to snapshot.
+     * @param f The function to call with the snapshot.
+     * @param maxSparseDensity The maximum density for which a SparseModel is used.
+     *
+     * @return The value returned by the input function.
+     */
+    template <typename M, typename F, typename = std::enable_if_t<is_model_v<M>>>
+    auto withEigenModel(const M & model, F && f, const double maxSparseDensity = 0.1) {
+        if constexpr (is_model_eigen_v<M>) {
+            return std::forward<F>(f)(model);
+        } else {
+            // We avoid going through a dense copy, as for large sparse
+            // models it might not even fit in memory.
+            if ( computeTransitionDensity(model) <= maxSparseDensity )
+                return std::forward<F>(f)(SparseModel(model));
+
+            return std::forward<F>(f)(Model(model));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef AI_TOOLBOX_MDP_MINIMIZED_MODEL_HEADER_FILE
+#define AI_TOOLBOX_MDP_MINIMIZED_MODEL_HEADER_FILE
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This function computes a bisimulation partition of the states of a model.
+     *
+     * Two states are bisimilar if, for every action, they have the same
+     * immediate reward and the same probability of transitioning into each
+     * block of bisimilar states. Bisimilar states have the same optimal
+     * values, so they can be merged without changing the solution.
+     *
+     * The partition is computed by iterative refinement: starting from a
+     * single block, each state is given a signature made of its block,
+     * its immediate rewards and, for each action, its probability of
+     * reaching each block; states with different signatures are split.
+     * This is repeated until no block is split anymore, which takes at
+     * most S iterations, each linear in the number of non-zero
+     * transitions (up to a logarithmic factor).
+     *
+     * Rewards and probabilities are compared after rounding them to
+     * multiples of epsilon. For small epsilon this only absorbs floating
+     * point errors; larger values compute an approximate partition, where
+     * states in the same block differ by less than epsilon in each
+     * reward and block probability of the last refinement.
+     *
+     * Blocks are numbered in order of their lowest state.
+     *
+     * This function throws std::invalid_argument if epsilon is not
+     * positive.
+     *
+     * @param model The model to partition.
+     * @param epsilon The resolution used to compare rewards and probabilities.
+     *
+     * @return The block of each state.
+     */
+    template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+    std::vector<size_t> computeBisimulation(const M & model, const double epsilon = 1e-9) {
+        if (epsilon <= 0.0) throw std::invalid_argument("Epsilon must be > 0");
+
+        const size_t S = model.getS(), A = model.getA();
+        const Matrix2D rewards = computeImmediateRewards(model);
+        const auto round = [epsilon](const double x) { return std::round(x / epsilon); };
+
+        std::vector<size_t> blocks(S, 0);
+        size_t blocksNum = S ? 1 : 0;
+
+        std::vector<double> signature;
+        std::vector<double> mass;
+        std::vector<size_t> touched;
+        std::vector<char> isTouched;
+        while (true) {
+            std::map<std::vector<double>, size_t> ids;
+            std::vector<size_t> newBlocks(S);
+            mass.assign(blocksNum, 0.0);
+            isTouched.assign(blocksNum, false);
+
+            for (size_t s = 0; s < S; ++s) {
+                signature.clear();
+                signature.push_back(blocks[s]);
+                for (size_t a = 0; a < A; ++a)
+                    signature.push_back(round(rewards(s, a)));
+
+                for (size_t a = 0; a < A; ++a) {
+                    forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                        const auto b = blocks[s1];
+                        if (!isTouched[b]) {
+                            isTouched[b] = true;
+                            touched.push_back(b);
+                        }
+                        mass[b] += p;
+                    });
+                    std::sort(std::begin(touched), std::end(touched));
+
+                    // The separator keeps the signatures of different
+                    // actions apart; block ids are never negative.
+                    signature.push_back(-1.0);
+                    for (const auto b : touched) {
+                        const auto p = round(mass[b]);
+                        if (p != 0.0) {
+                            signature.push_back(b);
+                            signature.push_back(p);
+                        }
+                        mass[b] = 0.0;
+                        isTouched[b] = false;
+                    }
+                    touched.clear();
+                }
+                newBlocks[s] = ids.try_emplace(signature, ids.size()).first->second;
+            }
+
+            const bool stable = ids.size() == blocksNum;
+            blocks = std::move(newBlocks);
+            blocksNum = ids.size();
+            if (stable) break;
+        }
+        return blocks;
+    }
+
+    /**
+     * @brief This class merges the bisimilar states of a model.
+     *
+     * Many models contain large sets of states which behave in exactly
+     * the same way: they have the same rewards, and the same probability
+     * of reaching each set of equivalent states. Solving such a model
+     * wastes time, as each sweep computes the same values over and over.
+     *
+     * This class computes the bisimulation partition of the model (see
+     * computeBisimulation()), and builds a SparseModel with one state per
+     * block. The transitions and rewards of each block are taken from its
+     * lowest state (its representative). With an exact partition the
+     * solution of the minimized model is exactly the solution of the
+     * original one, mapped through the blocks; with an approximate
+     * partition the error depends on epsilon.
+     *
+     * Any solver can then be run on getModel(), and its results can be
+     * mapped back to the original state space with the expand() functions.
+     *
+     * \code{.cpp}
+     * MinimizedModel minimized(model);
+     * ValueIteration vi(1000, 0.001);
+     * auto [bound, vf, q] = vi(minimized.getModel());
+     * const auto fullQ = minimized.expand(q);
+     * \endcode
+     */
+    class MinimizedModel {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws std::invalid_argument if epsilon is
+             * not positive.
+             *
+             * @param model The model to minimize.
+             * @param epsilon The resolution used to compare rewards and probabilities.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            MinimizedModel(const M & model, double epsilon = 1e-9);
+
+            /**
+             * @brief This function returns the minimized model.
+             */
+            const SparseModel & getModel() const;
+
+            /**
+             * @brief This function returns the number of states of the original model.
+             */
+            size_t getOriginalS() const;
+
+            /**
+             * @brief This function returns the block of each original state.
+             *
+             * The block of a state is its state in the minimized model.
+             */
+            const std::vector<size_t> & getBlocks() const;
+
+            /**
+             * @brief This function returns the block of an original state.
+             *
+             * @param s The original state.
+             */
+            size_t getBlock(size_t s) const;
+
+            /**
+             * @brief This function returns the lowest original state of each block.
+             *
+             * The minimized state i takes its transitions and rewards from
+             * the original state getRepresentatives()[i].
+             */
+            const std::vector<size_t> & getRepresentatives() const;
+
+            /**
+             * @brief This function maps a ValueFunction of the minimized model to the original state space.
+             *
+             * @param vf The ValueFunction of the minimized model.
+             *
+             * @return The ValueFunction over the original states.
+             */
+            ValueFunction expand(const ValueFunction & vf) const;
+
+            /**
+             * @brief This function maps a QFunction of the minimized model to the original state space.
+             *
+             * @param q The QFunction of the minimized model.
+             *
+             * @return The QFunction over the original states.
+             */
+            QFunction expand(const QFunction & q) const;
+
+            /**
+             * @brief This function restricts a ValueFunction of the original model to the representatives.
+             *
+             * This can be used to warm-start a solver on the minimized model.
+             *
+             * @param vf The ValueFunction over the original states.
+             *
+             * @return The ValueFunction of the minimized model.
+             */
+            ValueFunction compact(const ValueFunction & vf) const;
+
+        private:
+            std::vector<size_t> blocks_;
+            std::vector<size_t> representatives_;
+            SparseModel model_;
+    };
+
+    template <typename M, typename>
+    MinimizedModel::MinimizedModel(const M & model, const double epsilon) :
+            blocks_(computeBisimulation(model, epsilon)), model_(1, model.getA())
+    {
+        const size_t A = model.getA();
+        for (size_t s = 0; s < blocks_.size(); ++s)
+            if (blocks_[s] == representatives_.size())
+                representatives_.push_back(s);
+
+        const size_t B = representatives_.size();
+        const Matrix2D rewards = computeImmediateRewards(model);
+
+        SparseModel::TransitionMatrix t(A, SparseMatrix2D(B, B));
+        SparseModel::RewardMatrix r(B, A);
+        for (size_t a = 0; a < A; ++a) {
+            std::vector<Eigen::Triplet<double>> triplets;
+            for (size_t i = 0; i < B; ++i) {
+                const auto s = representatives_[i];
+                // Duplicates are summed by setFromTriplets.
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    triplets.emplace_back(i, blocks_[s1], p);
+                });
+                if (checkDifferentSmall(0.0, rewards(s, a))) r.insert(i, a) = rewards(s, a);
+            }
+            t[a].setFromTriplets(std::begin(triplets), std::end(triplets));
+            t[a].makeCompressed();
+        }
+        r.makeCompressed();
+
+        // Each row sums to the row of its representative.
+        model_ = SparseModel(NO_CHECK, B, A, std::move(t), std::move(r), model.getDiscount());
+    }
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 
@@ -66,10 +67,21 @@ namespace AIToolbox::MDP {
      *
      * Since so much information can be extracted from the QFunction, lots
      * of methods (mostly in Reinforcement Learning) try to learn it.
+     *
+     * The Scalar template parameter selects the type used to store the
+     * transition function, which is by far the largest part of the model.
+     * Storing it in float halves its memory footprint, so that bigger
+     * problems fit in cache; solvers then compute their products with the
+     * transition function in that precision. Rewards, discount and all
+     * returned values remain doubles. The MDP::Model alias refers to the
+     * double version, which is the one used throughout the library.
+     *
+     * @tparam Scalar The type used to store the transition probabilities.
      */
-    class Model {
+    template <typename Scalar>
+    class BasicModel {
         public:
-            using TransitionMatrix   = Matrix3D;
+            using TransitionMatrix   = std::vector<BasicMatrix2D<Scalar>>;
             using RewardMatrix       = Matrix2D;
 
             /**
@@ -86,7 +98,7 @@ namespace AIToolbox::MDP {
              * @param a The number of actions available to the agent.
              * @param discount The discount factor for the MDP.
              */
-            Model(size_t s, size_t a, double discount = 1.0);
+            BasicModel(size_t s, size_t a, double discount = 1.0);
 
             /**
              * @brief Basic constructor.
@@ -124,7 +136,7 @@ namespace AIToolbox::MDP {
              * @param d The discount factor for the MDP.
              */
             template <typename T, typename R>
-            Model(size_t s, size_t a, const T & t, const R & r, double d = 1.0);
+            BasicModel(size_t s, size_t a, const T & t, const R & r, double d = 1.0);
 
             /**
              * @brief Copy constructor from any valid MDP model.
@@ -139,7 +151,7 @@ namespace AIToolbox::MDP {
              * @param model The model that needs to be copied.
              */
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
-            Model(const M& model);
+            BasicModel(const M& model);
 
             /**
              * @brief Unchecked constructor.
@@ -158,7 +170,7 @@ namespace AIToolbox::MDP {
              * @param r The reward function to be used in the Model.
              * @param d The discount factor for the Model.
              */
-            Model(NoCheck, size_t s, size_t a, TransitionMatrix && t, RewardMatrix && r, double d);
+            BasicModel(NoCheck, size_t s, size_t a, TransitionMatrix && t, RewardMatrix && r, double d);
 
             /**
              * @brief This function replaces the Model transition function with the one provided.
@@ -234,6 +246,30 @@ namespace AIToolbox::MDP {
              */
             void setRewardFunction(const RewardMatrix & r);
 
+            /**
+             * @brief This function sets whether sampleSR() uses alias sampling.
+             *
+             * By default sampleSR() samples new states with a linear scan
+             * of the transition row, which is O(S). When alias sampling is
+             * enabled, the Model builds a VoseAliasSampler for each
+             * state-action pair, so that each sample becomes O(1). This is
+             * worth it when the Model is sampled many times (e.g. by MCTS
+             * rollouts), but costs O(SxAxS) memory and time to build.
+             *
+             * The samplers are rebuilt every time the transition function
+             * is changed.
+             *
+             * @param enable Whether to use alias sampling.
+             */
+            void setAliasSampling(bool enable);
+
+            /**
+             * @brief This function returns whether sampleSR() uses alias sampling.
+             *
+             * @return Whether alias sampling is enabled.
+             */
+            bool getAliasSampling() const;
+
             /**
              * @brief This function sets a new discount factor for the Model.
              *
@@ -261,6 +297,22 @@ namespace AIToolbox::MDP {
              */
             std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
 
+            /**
+             * @brief This function samples the MDP with the input random engine.
+             *
+             * This function is equivalent to sampleSR(size_t, size_t), but
+             * does not touch the internal random engine of the model. This
+             * allows multiple threads to sample the same model at the same
+             * time, as long as each uses its own engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a, RandomEngine & rnd) const;
+
             /**
              * @brief This function returns the number of states of the world.
              *
@@ -318,7 +370,7 @@ namespace AIToolbox::MDP {
              *
              * @return The transition function for the input action.
              */
-            const Matrix2D & getTransitionFunction(size_t a) const;
+            const BasicMatrix2D<Scalar> & getTransitionFunction(size_t a) const;
 
             /**
              * @brief This function returns the rewards matrix for inspection.
@@ -336,6 +388,16 @@ namespace AIToolbox::MDP {
              */
             bool isTerminal(size_t s) const;
 
+            /**
+             * @brief This function returns the heap memory used by the model, in bytes.
+             *
+             * This includes the transition and reward tables, and the
+             * alias tables if alias sampling is enabled.
+             *
+             * @return The memory allocated by the model.
+             */
+            size_t getMemoryUsage() const;
+
         private:
             size_t S, A;
             double discount_;
@@ -345,39 +407,51 @@ namespace AIToolbox::MDP {
 
             mutable RandomEngine rand_;
 
-            friend std::istream& operator>>(std::istream &is, Model &);
+            bool aliasSampling_;
+            VoseAliasTable samplers_;
+
+            friend std::istream& operator>>(std::istream &is, BasicModel<double> &);
     };
 
+    template <typename Scalar>
     template <typename T, typename R>
-    Model::Model(const size_t s, const size_t a, const T & t, const R & r, const double d) :
-            S(s), A(a), transitions_(A, Matrix2D(S, S)),
-            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    BasicModel<Scalar>::BasicModel(const size_t s, const size_t a, const T & t, const R & r, const double d) :
+            S(s), A(a), transitions_(A, BasicMatrix2D<Scalar>(S, S)),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed()), aliasSampling_(false)
     {
         setDiscount(d);
         setTransitionFunction(t);
         setRewardFunction(r);
     }
 
+    template <typename Scalar>
     template <typename M, typename>
-    Model::Model(const M& model) :
-            S(model.getS()), A(model.getA()), transitions_(A, Matrix2D(S, S)),
-            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    BasicModel<Scalar>::BasicModel(const M& model) :
+            S(model.getS()), A(model.getA()), transitions_(A, BasicMatrix2D<Scalar>(S, S)),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed()), aliasSampling_(false)
     {
         setDiscount(model.getDiscount());
         rewards_.setZero();
+        // We check each row in double precision, before converting it to
+        // our storage type. Only non-zero transitions are queried, which
+        // for sparse models avoids a lookup per (s, a, s1).
+        Vector row(S);
         for ( size_t a = 0; a < A; ++a )
             for ( size_t s = 0; s < S; ++s ) {
-                for ( size_t s1 = 0; s1 < S; ++s1 ) {
-                    transitions_[a](s, s1) = model.getTransitionProbability(s, a, s1);
-                    rewards_    (s, a)     += model.getExpectedReward       (s, a, s1) * transitions_[a](s, s1);
-                }
-                if ( !isProbability(S, transitions_[a].row(s)) )
+                row.setZero();
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    row[s1]       = p;
+                    rewards_(s, a) += model.getExpectedReward(s, a, s1) * p;
+                });
+                if ( !isProbability(S, row) )
                     throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+                transitions_[a].row(s) = row.transpose().template cast<Scalar>();
             }
     }
 
+    template <typename Scalar>
     template <typename T>
-    void Model::setTransitionFunction(const T & t) {
+    void BasicModel<Scalar>::setTransitionFunction(const T & t) {
         // First we check, then we set if it is good.
         for ( size_t s = 0; s < S; ++s )
             for ( size_t a = 0; a < A; ++a )
@@ -388,16 +462,33 @@ namespace AIToolbox::MDP {
             for ( size_t a = 0; a < A; ++a )
                 for ( size_t s1 = 0; s1 < S; ++s1 )
                     transitions_[a](s, s1) = t[s][a][s1];
+
+        if ( aliasSampling_ ) samplers_ = VoseAliasTable(transitions_);
     }
 
+    template <typename Scalar>
     template <typename R>
-    void Model::setRewardFunction(const R & r) {
+    void BasicModel<Scalar>::setRewardFunction(const R & r) {
         rewards_.setZero();
         for ( size_t s = 0; s < S; ++s )
             for ( size_t a = 0; a < A; ++a )
                 for ( size_t s1 = 0; s1 < S; ++s1 )
                     rewards_(s, a) += r[s][a][s1] * transitions_[a](s, s1);
     }
+
+    /**
+     * @brief The default MDP model, which stores its transitions in double precision.
+     */
+    using Model = BasicModel<double>;
+
+    /**
+     * @brief An MDP model which stores its transitions in single precision.
+     */
+    using FloatModel = BasicModel<float>;
+
+    // Both versions are compiled in the library.
+    extern template class BasicModel<double>;
+    extern template class BasicModel<float>;
 }
 
 #endif
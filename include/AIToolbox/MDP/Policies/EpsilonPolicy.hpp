@@ -36,6 +36,52 @@ namespace AIToolbox::MDP {
              */
             virtual Matrix2D getPolicy() const override;
 
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
+            /**
+             * @brief This function samples an action for each of the input states.
+             *
+             * The actions of the wrapped policy are sampled in a single
+             * batch, and then replaced by random actions with probability
+             * epsilon.
+             *
+             * @param states The states to sample actions for.
+             * @param actions The output sampled actions, one per state.
+             */
+            virtual void sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const override;
+
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe as long as the same function
+             * of the wrapped policy is.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
         protected:
             /**
              * @brief This function returns a random action in the Action space.
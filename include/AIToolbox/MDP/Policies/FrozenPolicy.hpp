@@ -0,0 +1,156 @@
+#ifndef AI_TOOLBOX_MDP_FROZEN_POLICY_HEADER_FILE
+#define AI_TOOLBOX_MDP_FROZEN_POLICY_HEADER_FILE
+
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/Policies/PolicyInterface.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents a fixed MDP policy optimized for sampling.
+     *
+     * This class stores a copy of a policy which is not going to change,
+     * in a form that is fast to sample from and compact for sparse
+     * policies.
+     *
+     * For each state only the actions with non-zero probability are
+     * stored, together with their exact probabilities and a cumulative
+     * distribution in single precision. Sampling searches the cumulative
+     * distribution of the state, which is linear for states with few
+     * actions and logarithmic otherwise. Thus, sampling does not depend on
+     * the total number of actions, and memory only grows with the number
+     * of non-zero entries of the policy.
+     *
+     * A cumulative distribution with a binary search is used, rather than
+     * the O(1) VoseAliasSampler, as it is meant for sparse rows. It only
+     * takes a float per entry, stored in one flat array for all states,
+     * while each VoseAliasSampler keeps its own allocations and a double
+     * and a size_t per entry. For rows with few actions, the scan is as
+     * fast as rolling an alias coin. Policies with many non-zero actions
+     * per state may sample faster with one VoseAliasSampler per state.
+     *
+     * getActionProbability() returns the exact probabilities of the
+     * original policy. The cumulative distributions are only used for
+     * sampling, so the sampled frequencies can be different from the exact
+     * probabilities by single precision rounding errors.
+     */
+    class FrozenPolicy : public PolicyInterface {
+        public:
+            using PolicyMatrix = Matrix2D;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor copies the policy from the getPolicy()
+             * function of the input.
+             *
+             * @param p The policy to freeze.
+             */
+            FrozenPolicy(const PolicyInterface & p);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor checks whether the input is a valid set of
+             * probabilities. If not, it will throw an std::invalid_argument
+             * exception.
+             *
+             * @param p The policy matrix to freeze.
+             */
+            FrozenPolicy(const PolicyMatrix & p);
+
+            /**
+             * @brief This function chooses a random action for state s, following the policy distribution.
+             *
+             * @param s The sampled state of the policy.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleAction(const size_t & s) const override;
+
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+            /**
+             * @brief This function samples an action for each of the input states.
+             *
+             * This is equivalent to calling sampleAction() for each
+             * state, but avoids the per-call overhead.
+             *
+             * @param states The states to sample actions for.
+             * @param actions The output sampled actions, one per state.
+             */
+            virtual void sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const override;
+
+            /**
+             * @brief This function returns the probability of taking the specified action in the specified state.
+             *
+             * @param s The selected state.
+             * @param a The selected action.
+             *
+             * @return The probability of taking the selected action in the specified state.
+             */
+            virtual double getActionProbability(const size_t & s, const size_t & a) const override;
+
+            /**
+             * @brief This function returns a matrix containing all probabilities of the policy.
+             *
+             * The matrix is rebuilt from the sparse representation, so
+             * this function is expensive.
+             */
+            virtual Matrix2D getPolicy() const override;
+
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
+            /**
+             * @brief This function returns the number of non-zero entries stored.
+             *
+             * @return The number of actions with non-zero probability, over all states.
+             */
+            size_t getNonZeros() const;
+
+        private:
+            void build(const PolicyMatrix & p);
+
+            template <typename G>
+            size_t sample(size_t s, G & gen) const;
+
+            // The entries of state s are in [rows_[s], rows_[s+1]).
+            std::vector<size_t> rows_;
+            std::vector<unsigned> actions_;
+            std::vector<double> probs_;
+            std::vector<float> cdf_;
+    };
+}
+
+#endif
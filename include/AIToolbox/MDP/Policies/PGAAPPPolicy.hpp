@@ -1,6 +1,8 @@
 #ifndef AI_TOOLBOX_MDP_PGA_APP_POLICY_HEADER_FILE
 #define AI_TOOLBOX_MDP_PGA_APP_POLICY_HEADER_FILE
 
+#include <vector>
+
 #include <AIToolbox/MDP/Policies/QPolicyInterface.hpp>
 #include <AIToolbox/MDP/Policies/PolicyWrapper.hpp>
 
@@ -19,6 +21,8 @@ namespace AIToolbox::MDP {
      */
     class PGAAPPPolicy : public QPolicyInterface {
         public:
+            using DirtyStates = std::vector<size_t>;
+
             /**
              * @brief Basic constructor.
              *
@@ -37,6 +41,9 @@ namespace AIToolbox::MDP {
              * last time with the provided input state. It then uses these
              * changes in order to update the policy.
              *
+             * The state is added to the dirty states, if it was not
+             * already there. See getDirtyStates().
+             *
              * @param s The state that needs to be updated.
              */
             void stepUpdateP(size_t s);
@@ -53,6 +60,20 @@ namespace AIToolbox::MDP {
              */
             virtual size_t sampleAction(const size_t & s) const override;
 
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+
             /**
              * @brief This function returns the probability of taking the specified action in the specified state.
              *
@@ -69,9 +90,64 @@ namespace AIToolbox::MDP {
              * Ideally this function can be called only when there is a
              * repeated need to access the same policy values in an
              * efficient manner.
+             *
+             * This is a copy of the current policy; see getPolicyMatrix()
+             * to access it without copying.
              */
             virtual Matrix2D getPolicy() const override;
 
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
+            /**
+             * @brief This function returns a reference to the current policy.
+             *
+             * This does not copy the policy, unlike getPolicy(). The
+             * reference is valid for the lifetime of this instance, and
+             * reflects all later calls to stepUpdateP().
+             *
+             * @return A constant reference to the current policy.
+             */
+            const PolicyWrapper::PolicyMatrix & getPolicyMatrix() const;
+
+            /**
+             * @brief This function returns the states updated since the last clear.
+             *
+             * Each state appears at most once, in the order in which it
+             * was first updated. This allows consumers to only read the
+             * rows of the policy that have actually changed, rather than
+             * the whole table.
+             *
+             * @return The dirty states.
+             */
+            const DirtyStates & getDirtyStates() const;
+
+            /**
+             * @brief This function clears the dirty states.
+             *
+             * The storage of the states is kept, so that updating after
+             * a clear does not allocate.
+             */
+            void clearDirtyStates();
+
             /**
              * @brief This function sets the new learning rate.
              *
@@ -105,9 +181,14 @@ namespace AIToolbox::MDP {
             double getPredictionLength() const;
 
         private:
+            void markDirty(size_t s);
+
             double lRate_, predictionLength_;
             PolicyWrapper::PolicyMatrix policyMatrix_;
             PolicyWrapper policy_;
+
+            DirtyStates dirty_;
+            std::vector<bool> isDirty_;
     };
 }
 
@@ -1,6 +1,9 @@
 #ifndef AI_TOOLBOX_MDP_POLICY_INTERFACE_HEADER_FILE
 #define AI_TOOLBOX_MDP_POLICY_INTERFACE_HEADER_FILE
 
+#include <random>
+#include <vector>
+
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/PolicyInterface.hpp>
 
@@ -24,6 +27,97 @@ namespace AIToolbox::MDP {
              * efficient manner.
              */
             virtual Matrix2D getPolicy() const = 0;
+
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * This is equivalent to getPolicy(), but the output is only
+             * reallocated if it does not already have size S x A. Code
+             * that repeatedly needs the policy matrix (for example when
+             * evaluating it) can thus keep a single workspace, rather than
+             * allocating a new one each time.
+             *
+             * The default implementation fills the matrix through
+             * getActionProbability(). Policies override this with faster
+             * versions.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const {
+                out->resize(S, A);
+                for (size_t s = 0; s < S; ++s)
+                    for (size_t a = 0; a < A; ++a)
+                        (*out)(s, a) = getActionProbability(s, a);
+            }
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * This is equivalent to calling getActionProbability() for
+             * each action, but only requires a single virtual call, and
+             * lets policies compute the whole distribution once (softmax
+             * policies, for example, need all the QFunction row to compute
+             * the probability of even a single action).
+             *
+             * The output is only reallocated if it does not already have
+             * size A.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const {
+                out->resize(A);
+                for (size_t a = 0; a < A; ++a)
+                    (*out)[a] = getActionProbability(s, a);
+            }
+
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * Differently from sampleAction(), this function does not use
+             * the generator of the policy, nor any other internal mutable
+             * state. As long as each thread uses its own generator, a
+             * single policy can thus be sampled from many threads at
+             * once, without copying it.
+             *
+             * The default implementation samples the action from the
+             * probabilities returned by getActionProbability(), so it is
+             * only thread-safe if that is.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const {
+                const double p = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+                double sum = 0.0;
+                for (size_t a = 0; a < A - 1; ++a) {
+                    sum += getActionProbability(s, a);
+                    if (p < sum) return a;
+                }
+                return A - 1;
+            }
+
+            /**
+             * @brief This function samples an action for each of the input states.
+             *
+             * This is equivalent to calling sampleAction() for each state,
+             * but only requires a single virtual call for the whole batch.
+             * Policies override this to hoist per-call setup out of the
+             * loop, so that simulation loops can sample the actions of many
+             * states (or many steps) at once.
+             *
+             * The output is resized to the number of input states.
+             *
+             * @param states The states to sample actions for.
+             * @param actions The output sampled actions, one per state.
+             */
+            virtual void sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+                actions->resize(states.size());
+                for (size_t i = 0; i < states.size(); ++i)
+                    (*actions)[i] = sampleAction(states[i]);
+            }
     };
 }
 
@@ -48,6 +48,32 @@ namespace AIToolbox::MDP {
              */
             virtual size_t sampleAction(const size_t & s) const override;
 
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+
+            /**
+             * @brief This function samples an action for each of the input states.
+             *
+             * This is equivalent to calling sampleAction() for each
+             * state, but avoids the per-call overhead.
+             *
+             * @param states The states to sample actions for.
+             * @param actions The output sampled actions, one per state.
+             */
+            virtual void sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const override;
+
+
             /**
              * @brief This function returns the probability of taking the specified action in the specified state.
              *
@@ -74,6 +100,27 @@ namespace AIToolbox::MDP {
              */
             virtual Matrix2D getPolicy() const override;
 
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
         private:
             const PolicyMatrix & policy_;
     };
@@ -17,6 +17,15 @@ namespace AIToolbox::MDP {
      * As the epsilon-policy, this type of policy is useful to force the agent
      * to explore an unknown model, in order to gain new information to refine
      * it and thus gain more reward.
+     *
+     * Computing the softmax requires an exponential per action, so when the
+     * QFunction changes rarely with respect to how often we sample (for
+     * example, when evaluating a learned policy) the probabilities of each
+     * state can be cached with setCaching(). Since the QFunction is only
+     * referenced, this class cannot know when it changes: it is up to the
+     * user to call invalidate() after modifying it. Invalidating the whole
+     * cache is O(1), as it simply increases a version counter which is
+     * compared against the version each state was cached with.
      */
     class QSoftmaxPolicy : public QPolicyInterface {
         public:
@@ -42,8 +51,8 @@ namespace AIToolbox::MDP {
              *      P(a) = \frac{e^{(Q(s,a)/t)})}{\sum_b{e^{(Q(s,b)/t)}}}
              * \f]
              *
-             * where t is the temperature. This value is not cached anywhere, so
-             * continuous sampling may not be extremely fast.
+             * where t is the temperature. Unless caching is enabled, this
+             * value is recomputed at every call.
              *
              * @param s The sampled state of the policy.
              *
@@ -51,6 +60,33 @@ namespace AIToolbox::MDP {
              */
             virtual size_t sampleAction(const size_t & s) const override;
 
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator and thread-local buffers. For the same reason, it
+             * never reads nor writes the cache.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+
+            /**
+             * @brief This function samples an action for each of the input states.
+             *
+             * This is equivalent to calling sampleAction() for each
+             * state, but avoids the per-call overhead.
+             *
+             * @param states The states to sample actions for.
+             * @param actions The output sampled actions, one per state.
+             */
+            virtual void sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const override;
+
+
             /**
              * @brief This function returns the probability of taking the specified action in the specified state.
              *
@@ -76,6 +112,27 @@ namespace AIToolbox::MDP {
              */
             virtual Matrix2D getPolicy() const override;
 
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
             /**
              * @brief This function sets the temperature parameter.
              *
@@ -101,8 +158,53 @@ namespace AIToolbox::MDP {
              */
             double getTemperature() const;
 
+            /**
+             * @brief This function enables or disables caching of the action probabilities.
+             *
+             * When caching is enabled, the probabilities of each state are
+             * computed the first time they are needed, and reused until
+             * invalidated. Disabling caching drops any cached values.
+             *
+             * @param caching Whether to cache the action probabilities.
+             */
+            void setCaching(bool caching);
+
+            /**
+             * @brief This function returns whether the action probabilities are cached.
+             *
+             * @return Whether caching is enabled.
+             */
+            bool isCaching() const;
+
+            /**
+             * @brief This function invalidates the cached probabilities of all states.
+             *
+             * This function must be called whenever the underlying
+             * QFunction is modified while caching is enabled.
+             */
+            void invalidate();
+
+            /**
+             * @brief This function invalidates the cached probabilities of a single state.
+             *
+             * @param s The state whose QFunction row has been modified.
+             */
+            void invalidate(size_t s);
+
         private:
+            /**
+             * @brief This function returns the cached probabilities of a state, updating them if needed.
+             */
+            Matrix2D::ConstRowXpr getCachedRow(size_t s) const;
+
             double temperature_;
+
+            bool caching_;
+            // Each cached row is valid only if its version matches version_.
+            unsigned long version_;
+            mutable std::vector<unsigned long> cacheVersions_;
+            mutable Matrix2D cache_;
+
             // To avoid reallocating a vector every time for sampling.
             mutable std::vector<size_t> bestActions_;
             mutable Vector vbuffer_;
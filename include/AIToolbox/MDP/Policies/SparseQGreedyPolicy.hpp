@@ -0,0 +1,106 @@
+#ifndef AI_TOOLBOX_MDP_SPARSE_Q_GREEDY_POLICY_HEADER_FILE
+#define AI_TOOLBOX_MDP_SPARSE_Q_GREEDY_POLICY_HEADER_FILE
+
+#include <AIToolbox/MDP/Policies/PolicyInterface.hpp>
+#include <AIToolbox/MDP/SparseQFunction.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class models a greedy policy through a SparseQFunction.
+     *
+     * This class is equivalent to QGreedyPolicy, but reads the values
+     * from a SparseQFunction. States which are not stored have all their
+     * actions tied, so a random action is selected.
+     *
+     * It can be wrapped in an EpsilonPolicy to obtain an epsilon-greedy
+     * policy.
+     */
+    class SparseQGreedyPolicy : public PolicyInterface {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param q The SparseQFunction this policy is linked with.
+             */
+            SparseQGreedyPolicy(const SparseQFunction & q);
+
+            /**
+             * @brief This function chooses the greediest action for state s.
+             *
+             * If multiple actions would be equally as greedy, a random one
+             * is returned.
+             *
+             * @param s The sampled state of the policy.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleAction(const size_t & s) const override;
+
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator and a thread-local buffer.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+            /**
+             * @brief This function returns the probability of taking the specified action in the specified state.
+             *
+             * @param s The selected state.
+             * @param a The selected action.
+             *
+             * @return This function returns 0 if the action is not greedy, and 1/the number of greedy actions otherwise.
+             */
+            virtual double getActionProbability(const size_t & s, const size_t & a) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
+            /**
+             * @brief This function returns a matrix containing all probabilities of the policy.
+             *
+             * This allocates an S x A matrix, so it should only be used
+             * when the state space is small.
+             */
+            virtual Matrix2D getPolicy() const override;
+
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function returns the underlying SparseQFunction reference.
+             *
+             * @return The underlying SparseQFunction reference.
+             */
+            const SparseQFunction & getQFunction() const;
+
+        private:
+            const SparseQFunction & q_;
+
+            // To avoid reallocating a vector every time for sampling.
+            mutable std::vector<size_t> bestActions_;
+    };
+}
+
+#endif
@@ -24,6 +24,8 @@ namespace AIToolbox::MDP {
      */
     class WoLFPolicy : public QPolicyInterface {
         public:
+            using DirtyStates = std::vector<size_t>;
+
             /**
              * @brief Basic constructor.
              *
@@ -42,6 +44,9 @@ namespace AIToolbox::MDP {
              * This function should be called between agent's actions,
              * using the agent's current state.
              *
+             * The state is added to the dirty states, if it was not
+             * already there. See getDirtyStates().
+             *
              * @param s The state that needs to be updated.
              */
             void stepUpdateP(size_t s);
@@ -58,6 +63,20 @@ namespace AIToolbox::MDP {
              */
             virtual size_t sampleAction(const size_t & s) const override;
 
+            /**
+             * @brief This function chooses an action for state s using the input generator.
+             *
+             * This function is thread-safe, as it only uses the input
+             * generator.
+             *
+             * @param s The sampled state of the policy.
+             * @param gen The generator to use.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleActionWith(const size_t & s, RandomEngine & gen) const override;
+
+
             /**
              * @brief This function returns the probability of taking the specified action in the specified state.
              *
@@ -74,9 +93,81 @@ namespace AIToolbox::MDP {
              * Ideally this function can be called only when there is a
              * repeated need to access the same policy values in an
              * efficient manner.
+             *
+             * This is a copy of the current policy; see getPolicyMatrix()
+             * to access it without copying.
              */
             virtual Matrix2D getPolicy() const override;
 
+            /**
+             * @brief This function writes all probabilities of the policy in the input matrix.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param out The output matrix.
+             */
+            virtual void getPolicyInto(Matrix2D * out) const override;
+
+            /**
+             * @brief This function writes the probabilities of all actions in the input state.
+             *
+             * The output is only reallocated if it does not have the right
+             * size.
+             *
+             * @param s The selected state.
+             * @param out The output vector.
+             */
+            virtual void getActionProbabilities(const size_t & s, Vector * out) const override;
+
+            /**
+             * @brief This function returns a reference to the current policy.
+             *
+             * This does not copy the policy, unlike getPolicy(). The
+             * reference is valid for the lifetime of this instance, and
+             * reflects all later calls to stepUpdateP().
+             *
+             * @return A constant reference to the current policy.
+             */
+            const PolicyWrapper::PolicyMatrix & getPolicyMatrix() const;
+
+            /**
+             * @brief This function returns a reference to the average policy.
+             *
+             * The average policy is the one WoLF compares the current
+             * policy against to determine whether it is winning.
+             *
+             * @return A constant reference to the average policy.
+             */
+            const PolicyWrapper::PolicyMatrix & getAveragePolicyMatrix() const;
+
+            /**
+             * @brief This function returns the number of updates done for each state.
+             *
+             * @return The number of calls to stepUpdateP() for each state.
+             */
+            const std::vector<unsigned> & getUpdateCounts() const;
+
+            /**
+             * @brief This function returns the states updated since the last clear.
+             *
+             * Each state appears at most once, in the order in which it
+             * was first updated. This allows consumers to only read the
+             * rows of the policy that have actually changed, rather than
+             * the whole table.
+             *
+             * @return The dirty states.
+             */
+            const DirtyStates & getDirtyStates() const;
+
+            /**
+             * @brief This function clears the dirty states.
+             *
+             * The storage of the states is kept, so that updating after
+             * a clear does not allocate.
+             */
+            void clearDirtyStates();
+
             /**
              * @brief This function sets the new learning rate if winning.
              *
@@ -136,11 +227,17 @@ namespace AIToolbox::MDP {
             double getScaling() const;
 
         private:
+            void markDirty(size_t s);
+
             double deltaW_, deltaL_, scaling_;
 
             std::vector<unsigned> c_;
             PolicyWrapper::PolicyMatrix avgPolicyMatrix_, actualPolicyMatrix_;
             PolicyWrapper avgPolicy_, actualPolicy_;
+
+            std::vector<size_t> bestActions_;
+            DirtyStates dirty_;
+            std::vector<bool> isDirty_;
     };
 }
 
@@ -0,0 +1,193 @@
+#ifndef AI_TOOLBOX_MDP_QFUNCTION_PUBLISHER_HEADER_FILE
+#define AI_TOOLBOX_MDP_QFUNCTION_PUBLISHER_HEADER_FILE
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class publishes snapshots of a QFunction to be read from other threads.
+     *
+     * Learners own their QFunction, and policies read it by reference.
+     * Thus, it is not safe to sample from a policy in one thread while
+     * another thread updates the QFunction it is reading.
+     *
+     * This class allows a learner to periodically publish immutable copies
+     * of its QFunction, which can then be read concurrently by any number
+     * of threads through a QFunctionReader. The learner keeps updating its
+     * own QFunction freely, and calls stepUpdate() after each update; once
+     * every `cadence` calls a new snapshot is published.
+     *
+     * \code{.cpp}
+     * // Learner thread
+     * QFunctionPublisher publisher(solver.getQFunction(), 100);
+     * ...
+     * solver.stepUpdateQ(s, a, s1, rew);
+     * publisher.stepUpdate();
+     *
+     * // Serving thread
+     * QFunctionReader reader(publisher);
+     * QGreedyPolicy policy(reader.getQFunction());
+     * ...
+     * reader.refresh();
+     * policy.sampleAction(s);
+     * \endcode
+     *
+     * Snapshots are reference counted, and their buffers are reused once
+     * no reader is copying from them anymore, so that in steady state
+     * publishing does not allocate.
+     *
+     * All functions of this class, except getSnapshot() and getVersion(),
+     * must only be called from the learner thread.
+     */
+    class QFunctionPublisher {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The input QFunction is immediately published as the first
+             * snapshot.
+             *
+             * The cadence must be > 0, otherwise the constructor will throw
+             * an std::invalid_argument.
+             *
+             * @param q The QFunction to publish, usually owned by a learner.
+             * @param cadence How many calls to stepUpdate() happen between publications.
+             */
+            QFunctionPublisher(const QFunction & q, unsigned cadence = 1);
+
+            /**
+             * @brief This function notifies the publisher that the QFunction has been updated.
+             *
+             * Every `cadence` calls, the QFunction is published.
+             *
+             * @return True if a new snapshot was published, false otherwise.
+             */
+            bool stepUpdate();
+
+            /**
+             * @brief This function immediately publishes a copy of the current QFunction.
+             *
+             * This also resets the count of updates until the next
+             * publication.
+             */
+            void publish();
+
+            /**
+             * @brief This function returns the latest published snapshot.
+             *
+             * This function can be called from any thread. The returned
+             * snapshot is never modified, and stays valid as long as it
+             * is held.
+             *
+             * @return The latest published QFunction.
+             */
+            std::shared_ptr<const QFunction> getSnapshot() const;
+
+            /**
+             * @brief This function returns the number of snapshots published so far.
+             *
+             * This function can be called from any thread, and only
+             * performs an atomic load.
+             *
+             * @return The version of the latest published snapshot.
+             */
+            unsigned long getVersion() const;
+
+            /**
+             * @brief This function sets the number of updates between publications.
+             *
+             * The cadence must be > 0, otherwise the function will throw
+             * an std::invalid_argument.
+             *
+             * @param cadence The new cadence.
+             */
+            void setCadence(unsigned cadence);
+
+            /**
+             * @brief This function returns the number of updates between publications.
+             *
+             * @return The current cadence.
+             */
+            unsigned getCadence() const;
+
+            /**
+             * @brief This function returns the underlying QFunction reference.
+             *
+             * @return The underlying QFunction reference.
+             */
+            const QFunction & getQFunction() const;
+
+        private:
+            const QFunction & q_;
+            unsigned cadence_, steps_;
+
+            // Only accessed through std::atomic_load and std::atomic_store.
+            std::shared_ptr<const QFunction> current_;
+            std::atomic<unsigned long> version_;
+
+            // All snapshot buffers ever allocated; the ones held only
+            // here are free to be reused.
+            std::vector<std::shared_ptr<QFunction>> buffers_;
+    };
+
+    /**
+     * @brief This class keeps a local copy of the QFunction published by a QFunctionPublisher.
+     *
+     * Policies reference their QFunction, and so cannot directly switch
+     * between snapshots. This class provides a QFunction owned by a
+     * single serving thread, which policies can reference, and which is
+     * updated to the latest snapshot only when refresh() is called.
+     *
+     * Between refreshes the local copy is never modified, so policies can
+     * sample from it without any synchronization.
+     */
+    class QFunctionReader {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The reader is initialized with the latest published snapshot.
+             *
+             * @param publisher The publisher to read from.
+             */
+            QFunctionReader(const QFunctionPublisher & publisher);
+
+            /**
+             * @brief This function updates the local QFunction to the latest published snapshot.
+             *
+             * If nothing has been published since the last refresh, this
+             * function only performs an atomic load.
+             *
+             * @return True if the local QFunction was updated, false otherwise.
+             */
+            bool refresh();
+
+            /**
+             * @brief This function returns the local copy of the QFunction.
+             *
+             * The reference is stable for the lifetime of this instance,
+             * so it can be given to policies.
+             *
+             * @return The local QFunction.
+             */
+            const QFunction & getQFunction() const;
+
+            /**
+             * @brief This function returns the version of the local copy.
+             *
+             * @return The version of the snapshot the local copy was last updated from.
+             */
+            unsigned long getVersion() const;
+
+        private:
+            const QFunctionPublisher & publisher_;
+            unsigned long version_;
+            QFunction q_;
+    };
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define AI_TOOLBOX_MDP_RLMODEL_HEADER_FILE
 
 #include <tuple>
+#include <utility>
+#include <vector>
 #include <random>
 
 #include <AIToolbox/Types.hpp>
@@ -11,6 +13,9 @@
 #include <AIToolbox/Utils/Probability.hpp>
 
 namespace AIToolbox::MDP {
+    class Experience;
+    class SparseExperience;
+
     /**
      * @brief This class models Experience as a Markov Decision Process.
      *
@@ -146,6 +151,26 @@ namespace AIToolbox::MDP {
              */
             void sync(size_t s, size_t a, size_t s1);
 
+            /**
+             * @brief This function syncs a set of state action pairs in the RLModel to the underlying Experience.
+             *
+             * This function is equivalent to calling sync(s, a) for each
+             * input pair. It is meant to be used together with
+             * Experience::getDirtyPairs(), so that when experience is
+             * streamed in continuously only the state action pairs which
+             * have actually changed are resynced:
+             *
+             * \code{.cpp}
+             * model.sync(exp.getDirtyPairs());
+             * exp.clearDirtyPairs();
+             * \endcode
+             *
+             * This function does not allocate memory.
+             *
+             * @param pairs The state action pairs that need to be synced.
+             */
+            void sync(const std::vector<std::pair<size_t, size_t>> & pairs);
+
             /**
              * @brief This function samples the MDP for the specified state action pair.
              *
@@ -267,6 +292,8 @@ namespace AIToolbox::MDP {
         rewards_.setZero();
 
         if ( toSync ) {
+            for ( size_t a = 0; a < A; ++a )
+                transitions_[a].setZero();
             sync();
             // Sync does not touch state-action pairs which have never been
             // seen. To keep the model consistent we set all of them as
@@ -306,9 +333,23 @@ namespace AIToolbox::MDP {
         const double visitSumReciprocal = 1.0 / visitSum;
 
         // Normalize
-        for ( size_t s1 = 0; s1 < S; ++s1 ) {
-            const auto visits = experience_.getVisits(s, a, s1);
-            transitions_[a](s, s1) = static_cast<double>(visits) * visitSumReciprocal;
+        auto row = transitions_[a].row(s);
+        if constexpr (std::is_same_v<E, Experience>) {
+            // The visits of a state-action pair are contiguous, so we
+            // read them directly rather than one call at a time.
+            const auto visits = experience_.getVisitTable()[s][a].origin();
+            for ( size_t s1 = 0; s1 < S; ++s1 )
+                row[s1] = static_cast<double>(visits[s1]) * visitSumReciprocal;
+        } else if constexpr (std::is_same_v<E, SparseExperience>) {
+            // We only need to look at the transitions actually visited.
+            row.setZero();
+            for ( SparseTable2D::InnerIterator it(experience_.getVisitTable()[a], s); it; ++it )
+                row[it.col()] = static_cast<double>(it.value()) * visitSumReciprocal;
+        } else {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                const auto visits = experience_.getVisits(s, a, s1);
+                row[s1] = static_cast<double>(visits) * visitSumReciprocal;
+            }
         }
         rewards_(s, a) = experience_.getRewardSum(s, a) * visitSumReciprocal;
     }
@@ -340,6 +381,12 @@ namespace AIToolbox::MDP {
         }
     }
 
+    template <typename E>
+    void RLModel<E>::sync(const std::vector<std::pair<size_t, size_t>> & pairs) {
+        for ( const auto & [s, a] : pairs )
+            sync(s, a);
+    }
+
     template <typename E>
     std::tuple<size_t, double> RLModel<E>::sampleSR(const size_t s, const size_t a) const {
         const size_t s1 = sampleProbability(S, transitions_[a].row(s), rand_);
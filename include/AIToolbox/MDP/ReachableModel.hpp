@@ -0,0 +1,242 @@
+#ifndef AI_TOOLBOX_MDP_REACHABLE_MODEL_HEADER_FILE
+#define AI_TOOLBOX_MDP_REACHABLE_MODEL_HEADER_FILE
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This function computes the states reachable from the input ones.
+     *
+     * A state is reachable if there is a sequence of actions which leads
+     * to it from one of the initial states with non-zero probability. The
+     * initial states are always reachable.
+     *
+     * For models which satisfy is_model_eigen_v only the non-zero entries
+     * of the sparse transition matrices are visited, so the cost is
+     * proportional to the number of reachable transitions. Other models
+     * are queried through getTransitionProbability(), once for each
+     * reachable (s, a, s1) triple.
+     *
+     * @param model The model to inspect.
+     * @param initialStates The states from which to start.
+     *
+     * @return The reachable states, in increasing order.
+     */
+    template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+    std::vector<size_t> findReachableStates(const M & model, const std::vector<size_t> & initialStates) {
+        const size_t S = model.getS(), A = model.getA();
+
+        std::vector<char> seen(S, false);
+        std::vector<size_t> stack;
+        stack.reserve(initialStates.size());
+
+        const auto visit = [&](const size_t s1) {
+            if (seen[s1]) return;
+            seen[s1] = true;
+            stack.push_back(s1);
+        };
+
+        for (const auto s : initialStates) {
+            if (s >= S) throw std::invalid_argument("Initial state is out of range");
+            visit(s);
+        }
+
+        while (!stack.empty()) {
+            const auto s = stack.back();
+            stack.pop_back();
+
+            for (size_t a = 0; a < A; ++a) {
+                if constexpr (is_model_eigen_v<M>) {
+                    using TMatrix = remove_cv_ref_t<decltype(model.getTransitionFunction(a))>;
+                    if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<TMatrix>, TMatrix>) {
+                        for (typename TMatrix::InnerIterator it(model.getTransitionFunction(a), s); it; ++it)
+                            if (it.value() > 0.0) visit(it.col());
+                        continue;
+                    }
+                }
+                for (size_t s1 = 0; s1 < S; ++s1)
+                    if (checkDifferentSmall(0.0, model.getTransitionProbability(s, a, s1)))
+                        visit(s1);
+            }
+        }
+
+        std::vector<size_t> retval;
+        for (size_t s = 0; s < S; ++s)
+            if (seen[s]) retval.push_back(s);
+        return retval;
+    }
+
+    /**
+     * @brief This class restricts a model to the states reachable from a set of initial states.
+     *
+     * In many problems only a small fraction of the state space can be
+     * reached from the states where an episode may start. Solving the full
+     * model wastes both memory (the ValueFunction and QFunction are dense)
+     * and time (each sweep goes through all states).
+     *
+     * This class computes the reachable set (see findReachableStates()),
+     * and builds a SparseModel which only contains those states, renumbered
+     * in increasing order. Since the set is closed under the transition
+     * function, the compacted model is a valid MDP, and its solution is
+     * exactly the solution of the original model on the reachable states.
+     *
+     * Any solver can then be run on getModel(), and its results can be
+     * mapped back to the original state space with the expand() functions.
+     *
+     * \code{.cpp}
+     * ReachableModel reachable(model, {startState});
+     * ValueIteration vi(1000, 0.001);
+     * auto [bound, vf, q] = vi(reachable.getModel());
+     * const auto fullQ = reachable.expand(q);
+     * \endcode
+     *
+     * This works with any model, but is cheapest with sparse models
+     * (SparseModel, SparseRLModel), since then only the non-zero
+     * transitions of the reachable states are ever visited.
+     */
+    class ReachableModel {
+        public:
+            /**
+             * @brief This value marks states which are not reachable.
+             */
+            static constexpr size_t Unreachable = std::numeric_limits<size_t>::max();
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws std::invalid_argument if no initial
+             * states are given, or if any of them is out of range.
+             *
+             * @param model The model to compact.
+             * @param initialStates The states from which episodes may start.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            ReachableModel(const M & model, const std::vector<size_t> & initialStates);
+
+            /**
+             * @brief This function returns the compacted model.
+             */
+            const SparseModel & getModel() const;
+
+            /**
+             * @brief This function returns the number of states of the original model.
+             */
+            size_t getOriginalS() const;
+
+            /**
+             * @brief This function returns the reachable states, in increasing order.
+             *
+             * The compacted state i corresponds to the original state getStates()[i].
+             */
+            const std::vector<size_t> & getStates() const;
+
+            /**
+             * @brief This function returns the compacted index of an original state.
+             *
+             * @param s The original state.
+             *
+             * @return The compacted state, or Unreachable.
+             */
+            size_t getCompactState(size_t s) const;
+
+            /**
+             * @brief This function maps a ValueFunction of the compacted model to the original state space.
+             *
+             * Unreachable states are given value 0 and action 0.
+             *
+             * @param vf The ValueFunction of the compacted model.
+             *
+             * @return The ValueFunction over the original states.
+             */
+            ValueFunction expand(const ValueFunction & vf) const;
+
+            /**
+             * @brief This function maps a QFunction of the compacted model to the original state space.
+             *
+             * Rows of unreachable states are set to 0.
+             *
+             * @param q The QFunction of the compacted model.
+             *
+             * @return The QFunction over the original states.
+             */
+            QFunction expand(const QFunction & q) const;
+
+            /**
+             * @brief This function restricts a ValueFunction of the original model to the reachable states.
+             *
+             * This can be used to warm-start a solver on the compacted model.
+             *
+             * @param vf The ValueFunction over the original states.
+             *
+             * @return The ValueFunction of the compacted model.
+             */
+            ValueFunction compact(const ValueFunction & vf) const;
+
+        private:
+            size_t originalS_;
+            std::vector<size_t> states_;
+            std::vector<size_t> index_;
+            SparseModel model_;
+    };
+
+    template <typename M, typename>
+    ReachableModel::ReachableModel(const M & model, const std::vector<size_t> & initialStates) :
+            originalS_(model.getS()), states_(findReachableStates(model, initialStates)),
+            index_(originalS_, Unreachable), model_(1, model.getA())
+    {
+        if (initialStates.empty())
+            throw std::invalid_argument("ReachableModel needs at least one initial state");
+
+        const size_t S = states_.size(), A = model.getA();
+        for (size_t i = 0; i < S; ++i)
+            index_[states_[i]] = i;
+
+        SparseModel::TransitionMatrix t(A, SparseMatrix2D(S, S));
+        SparseModel::RewardMatrix r(S, A);
+
+        for (size_t a = 0; a < A; ++a) {
+            std::vector<Eigen::Triplet<double>> triplets;
+            for (size_t i = 0; i < S; ++i) {
+                const auto s = states_[i];
+                double reward = 0.0;
+                if constexpr (is_model_eigen_v<M>) {
+                    using TMatrix = remove_cv_ref_t<decltype(model.getTransitionFunction(a))>;
+                    if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<TMatrix>, TMatrix>) {
+                        for (typename TMatrix::InnerIterator it(model.getTransitionFunction(a), s); it; ++it)
+                            if (it.value() > 0.0)
+                                triplets.emplace_back(i, index_[it.col()], it.value());
+                    } else {
+                        const auto & row = model.getTransitionFunction(a).row(s);
+                        for (size_t s1 = 0; s1 < originalS_; ++s1)
+                            if (row[s1] > 0.0)
+                                triplets.emplace_back(i, index_[s1], row[s1]);
+                    }
+                    reward = model.getRewardFunction().coeff(s, a);
+                } else {
+                    for (size_t s1 = 0; s1 < originalS_; ++s1) {
+                        const double p = model.getTransitionProbability(s, a, s1);
+                        if (!checkDifferentSmall(0.0, p)) continue;
+                        triplets.emplace_back(i, index_[s1], p);
+                        reward += p * model.getExpectedReward(s, a, s1);
+                    }
+                }
+                if (checkDifferentSmall(0.0, reward)) r.insert(i, a) = reward;
+            }
+            t[a].setFromTriplets(std::begin(triplets), std::end(triplets));
+            t[a].makeCompressed();
+        }
+        r.makeCompressed();
+
+        // The reachable set is closed, so all rows are still distributions.
+        model_ = SparseModel(NO_CHECK, S, A, std::move(t), std::move(r), model.getDiscount());
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef AI_TOOLBOX_MDP_REPLAY_BUFFER_HEADER_FILE
+#define AI_TOOLBOX_MDP_REPLAY_BUFFER_HEADER_FILE
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/Utils/SumTree.hpp>
+
+#include <tuple>
+#include <vector>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class stores the most recent transitions experienced, to learn from them again.
+     *
+     * The buffer is a ring of fixed capacity: once full, each new
+     * transition overwrites the oldest one. Transitions are stored as
+     * separate arrays, and batches are sampled directly in the
+     * TransitionBatch format, so that they can be fed to the batch
+     * updates of the learning algorithms (as QLearning::batchUpdateQ()).
+     *
+     * By default transitions are sampled uniformly. With a positive
+     * priority exponent, the buffer instead samples transitions
+     * proportionally to (|delta| + epsilon)^exponent, where delta is the
+     * last TD error reported for the transition with updatePriorities()
+     * (prioritized experience replay). New transitions get the highest
+     * priority seen so far, so that they are sampled at least once soon.
+     * Priorities are kept in a SumTree, so sampling and updating them is
+     * O(log N).
+     *
+     * Since prioritized sampling changes the distribution of the updates,
+     * getProbability() can be used to compute importance sampling
+     * weights if needed.
+     */
+    class ReplayBuffer {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor throws an std::invalid_argument if the
+             * capacity is zero, the exponent is negative or the epsilon is
+             * not positive.
+             *
+             * @param capacity The maximum number of transitions stored.
+             * @param exponent The priority exponent; zero means uniform sampling.
+             * @param epsilon The value added to TD errors so that no transition has zero priority.
+             */
+            ReplayBuffer(size_t capacity, double exponent = 0.0, double epsilon = 1e-6);
+
+            /**
+             * @brief This function adds a transition to the buffer.
+             *
+             * If the buffer is full, the oldest transition is overwritten.
+             *
+             * @param s The initial state.
+             * @param a The action performed.
+             * @param s1 The final state.
+             * @param rew The reward obtained.
+             *
+             * @return The id of the transition in the buffer.
+             */
+            size_t record(size_t s, size_t a, size_t s1, double rew);
+
+            /**
+             * @brief This function samples a batch of transitions from the buffer.
+             *
+             * With prioritized sampling, the transitions are drawn with
+             * stratified sampling: the total priority is split in n equal
+             * segments and one transition is drawn from each, which
+             * reduces the variance of the batch.
+             *
+             * The batch is overwritten. Its nextActions array is cleared.
+             * If the buffer is empty, the batch is left empty.
+             *
+             * @param n The number of transitions to sample.
+             * @param batch The output batch.
+             * @param ids If not null, the ids of the sampled transitions are written here.
+             */
+            void sampleBatch(size_t n, TransitionBatch * batch, std::vector<size_t> * ids = nullptr);
+
+            /**
+             * @brief This function updates the priorities of the input transitions.
+             *
+             * This function does nothing if the buffer is not prioritized.
+             * It throws an std::invalid_argument if the two inputs have
+             * different sizes.
+             *
+             * @param ids The ids of the transitions, as returned by sampleBatch().
+             * @param tdErrors The new TD errors of the transitions.
+             */
+            void updatePriorities(const std::vector<size_t> & ids, const std::vector<double> & tdErrors);
+
+            /**
+             * @brief This function returns the probability of sampling a transition in a single draw.
+             *
+             * @param id The id of the transition.
+             *
+             * @return The probability of sampling the transition.
+             */
+            double getProbability(size_t id) const;
+
+            /**
+             * @brief This function removes all transitions from the buffer.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the number of transitions in the buffer.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the maximum number of transitions in the buffer.
+             */
+            size_t getCapacity() const;
+
+            /**
+             * @brief This function returns the priority exponent.
+             */
+            double getExponent() const;
+
+            /**
+             * @brief This function returns whether the buffer samples by priority.
+             */
+            bool isPrioritized() const;
+
+            /**
+             * @brief This function returns the transition with the input id.
+             *
+             * @param id The id of the transition.
+             *
+             * @return A tuple containing the initial state, action, final state and reward.
+             */
+            std::tuple<size_t, size_t, size_t, double> getTransition(size_t id) const;
+
+        private:
+            size_t capacity_, size_, next_;
+            double exponent_, epsilon_, maxPriority_;
+
+            std::vector<size_t> states_, actions_, nextStates_;
+            std::vector<double> rewards_;
+            SumTree priorities_;
+
+            RandomEngine rand_;
+    };
+}
+
+#endif
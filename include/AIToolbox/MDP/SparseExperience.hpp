@@ -2,10 +2,16 @@
 #define AI_TOOLBOX_MDP_SPARSE_EXPERIENCE_HEADER_FILE
 
 #include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 
+namespace AIToolbox { class ThreadPool; }
+
 namespace AIToolbox::MDP {
     /**
      * @brief This class keeps track of registered events and rewards.
@@ -22,6 +28,16 @@ namespace AIToolbox::MDP {
      * environment being logged is very high but only a small subset of
      * the states are really possible, at the cost of some efficiency
      * (possibly offset by cache savings).
+     *
+     * Inserting a new element in a sparse matrix requires shifting all the
+     * elements after it, so record() does not write to the matrices
+     * directly. Instead, it adds the new event to a hash table of staged
+     * increments, which are merged into the matrices in bulk by flush().
+     * The single value getters include the staged increments, while the
+     * functions returning whole tables (getVisitTable() and
+     * getRewardMatrix()) flush them first. Since these are const
+     * functions, they must not be called concurrently while there are
+     * staged increments; calling flush() first makes them safe.
      */
     class SparseExperience {
         public:
@@ -29,6 +45,7 @@ namespace AIToolbox::MDP {
             using VisitSumTable = SparseTable2D;
             using RewardMatrix = SparseMatrix3D;
             using RewardSumMatrix = SparseMatrix2D;
+            using DirtyPairs = std::vector<std::pair<size_t, size_t>>;
 
             /**
              * @brief Basic constructor.
@@ -105,6 +122,9 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function adds a new event to the recordings.
              *
+             * If the state-action pair was not already dirty, it is
+             * added to the dirty pairs. See getDirtyPairs().
+             *
              * @param s     Old state.
              * @param a     Performed action.
              * @param s1    New state.
@@ -112,11 +132,48 @@ namespace AIToolbox::MDP {
              */
             void record(size_t s, size_t a, size_t s1, double rew);
 
+            /**
+             * @brief This function merges all staged increments into the sparse matrices.
+             *
+             * When only a few increments are staged, they are added to
+             * the matrices one by one; otherwise, each matrix is rebuilt
+             * once in compressed form together with its increments.
+             *
+             * This function does nothing if there are no staged
+             * increments. It is called automatically by all functions
+             * which need the whole matrices.
+             */
+            void flush() const;
+
             /**
              * @brief This function resets all experienced rewards and transitions.
              */
             void reset();
 
+            /**
+             * @brief This function returns the state-action pairs recorded since the last clear.
+             *
+             * Each pair appears at most once, in the order in which it
+             * was first recorded. This allows to resync a model only
+             * for the pairs that have actually changed, for example via
+             * the batch overload of RLModel::sync(), without scanning the
+             * whole state-action space.
+             *
+             * Only record() marks pairs as dirty; setVisits() and
+             * setRewards() do not, as they change the whole Experience.
+             *
+             * @return The dirty state-action pairs.
+             */
+            const DirtyPairs & getDirtyPairs() const;
+
+            /**
+             * @brief This function clears the dirty state-action pairs.
+             *
+             * The storage of the pairs is kept, so that recording after
+             * a clear does not allocate.
+             */
+            void clearDirtyPairs();
+
             /**
              * @brief This function returns the current recorded visits for a transitions.
              *
@@ -158,6 +215,8 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function returns the visits table for inspection.
              *
+             * The staged increments are flushed first.
+             *
              * @return The visits table.
              */
             const VisitTable & getVisitTable() const;
@@ -165,6 +224,8 @@ namespace AIToolbox::MDP {
             /**
              * @brief This function returns the rewards matrix for inspection.
              *
+             * The staged increments are flushed first.
+             *
              * @return The rewards matrix.
              */
             const RewardMatrix & getRewardMatrix() const;
@@ -183,20 +244,48 @@ namespace AIToolbox::MDP {
              */
             size_t getA() const;
 
+            /**
+             * @brief This function returns the heap memory used by the experience, in bytes.
+             *
+             * This includes the reserved but unused space of the sparse
+             * visit and reward tables, the staged increments, and the list
+             * of dirty pairs.
+             *
+             * @return The memory allocated by the experience.
+             */
+            size_t getMemoryUsage() const;
+
         private:
+            struct Staged {
+                long visits;
+                double reward;
+            };
+            using StagingTable = std::unordered_map<size_t, Staged>;
+
             size_t S, A;
 
-            VisitTable visits_;
-            VisitSumTable visitsSum_;
+            mutable VisitTable visits_;
+            mutable VisitSumTable visitsSum_;
+
+            mutable RewardMatrix rewards_;
+            mutable RewardSumMatrix rewardsSum_;
+
+            // The staged increments of each transition (keyed on (a, s, s1))
+            // and of their sums (keyed on (s, a)).
+            mutable StagingTable staged_, stagedSums_;
 
-            RewardMatrix rewards_;
-            RewardSumMatrix rewardsSum_;
+            DirtyPairs dirty_;
+            std::vector<bool> isDirty_;
 
             friend std::istream& operator>>(std::istream &is, SparseExperience &);
+            friend std::istream& readBinary(std::istream &is, SparseExperience &);
+            friend std::istream& readExperienceTable(std::istream &is, SparseExperience &);
+            friend size_t readTransitionLog(const std::string & filename, SparseExperience & exp, ThreadPool * pool);
     };
 
     template <typename V>
     void SparseExperience::setVisits(const V & v) {
+        flush();
         for ( size_t a = 0; a < A; ++a )
             visits_[a].setZero();
         visitsSum_.setZero();
@@ -216,6 +305,7 @@ namespace AIToolbox::MDP {
 
     template <typename R>
     void SparseExperience::setRewards(const R & r) {
+        flush();
         for ( size_t a = 0; a < A; ++a )
             rewards_[a].setZero();
         rewardsSum_.setZero();
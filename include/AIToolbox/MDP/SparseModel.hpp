@@ -5,6 +5,7 @@
 
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
 
 #include <AIToolbox/Utils/Probability.hpp>
 
@@ -73,11 +74,20 @@ namespace AIToolbox::MDP {
      * SxAxS. It also of course incredibly reduces memory consumption in
      * such cases, which may also improve speed by effect of improved
      * caching.
+     *
+     * The Scalar template parameter selects the type used to store the
+     * transition function, as in MDP::BasicModel. The MDP::SparseModel
+     * alias refers to the double version.
+     *
+     * @tparam Scalar The type used to store the transition probabilities.
      */
-    class SparseModel {
+    template <typename Scalar>
+    class BasicSparseModel {
         public:
-            using TransitionMatrix   = SparseMatrix3D;
+            using TransitionMatrix   = std::vector<BasicSparseMatrix2D<Scalar>>;
             using RewardMatrix       = SparseMatrix2D;
+            using TransitionTriplets = std::vector<std::vector<Eigen::Triplet<Scalar>>>;
+            using RewardTriplets     = std::vector<Eigen::Triplet<double>>;
 
             /**
              * @brief Basic constructor.
@@ -93,7 +103,7 @@ namespace AIToolbox::MDP {
              * @param a The number of actions available to the agent.
              * @param discount The discount factor for the MDP.
              */
-            SparseModel(size_t s, size_t a, double discount = 1.0);
+            BasicSparseModel(size_t s, size_t a, double discount = 1.0);
 
             /**
              * @brief Basic constructor.
@@ -139,7 +149,39 @@ namespace AIToolbox::MDP {
              * @param d The discount factor for the MDP.
              */
             template <typename T, typename R>
-            SparseModel(size_t s, size_t a, const T & t, const R & r, double d = 1.0);
+            BasicSparseModel(size_t s, size_t a, const T & t, const R & r, double d = 1.0);
+
+            /**
+             * @brief Bulk constructor from lists of non-zero entries.
+             *
+             * This constructor is the fastest way to build a large model
+             * from scratch. The transitions are passed as one list of
+             * (s, s1, probability) triplets per action, and the rewards as
+             * a single list of (s, a, reward) triplets. Lists can be
+             * filled in any order, for example by different threads, and
+             * duplicate entries are summed. Each matrix is then built at
+             * once, rather than inserting one element at a time.
+             *
+             * States which have no transitions for an action are given a
+             * self-loop, as in the default constructor, so that only the
+             * rows which differ from it need to be listed.
+             *
+             * If a ThreadPool is passed, the matrices of different actions
+             * are built and checked in parallel.
+             *
+             * This constructor throws std::invalid_argument if the number
+             * of transition lists is not A, if any triplet is out of
+             * bounds, if the transition rows do not contain valid
+             * probabilities, or if the discount is not in (0,1].
+             *
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param t The transition triplets of each action.
+             * @param r The reward triplets.
+             * @param d The discount factor for the MDP.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            BasicSparseModel(size_t s, size_t a, const TransitionTriplets & t, const RewardTriplets & r, double d = 1.0, ThreadPool * pool = nullptr);
 
             /**
              * @brief Copy constructor from any valid MDP model.
@@ -154,7 +196,7 @@ namespace AIToolbox::MDP {
              * @param model The model that needs to be copied.
              */
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
-            SparseModel(const M& model);
+            BasicSparseModel(const M& model);
 
             /**
              * @brief Unchecked constructor.
@@ -173,7 +215,7 @@ namespace AIToolbox::MDP {
              * @param r The reward function to be used in the SparseModel.
              * @param d The discount factor for the SparseModel.
              */
-            SparseModel(NoCheck, size_t s, size_t a, TransitionMatrix && t, RewardMatrix && r, double d);
+            BasicSparseModel(NoCheck, size_t s, size_t a, TransitionMatrix && t, RewardMatrix && r, double d);
 
             /**
              * @brief This function replaces the transition function with the one provided.
@@ -292,6 +334,22 @@ namespace AIToolbox::MDP {
              */
             std::tuple<size_t, double> sampleSR(size_t s, size_t a) const;
 
+            /**
+             * @brief This function samples the MDP with the input random engine.
+             *
+             * This function is equivalent to sampleSR(size_t, size_t), but
+             * does not touch the internal random engine of the model. This
+             * allows multiple threads to sample the same model at the same
+             * time, as long as each uses its own engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state and a reward.
+             */
+            std::tuple<size_t, double> sampleSR(size_t s, size_t a, RandomEngine & rnd) const;
+
             /**
              * @brief This function returns the number of states of the world.
              *
@@ -349,7 +407,7 @@ namespace AIToolbox::MDP {
              *
              * @return The transition function for the input action.
              */
-            const SparseMatrix2D & getTransitionFunction(size_t a) const;
+            const BasicSparseMatrix2D<Scalar> & getTransitionFunction(size_t a) const;
 
             /**
              * @brief This function returns the rewards matrix for inspection.
@@ -367,6 +425,16 @@ namespace AIToolbox::MDP {
              */
             bool isTerminal(size_t s) const;
 
+            /**
+             * @brief This function returns the heap memory used by the model, in bytes.
+             *
+             * This includes the reserved but unused space of the sparse
+             * transition and reward matrices.
+             *
+             * @return The memory allocated by the model.
+             */
+            size_t getMemoryUsage() const;
+
         private:
             size_t S, A;
             double discount_;
@@ -376,12 +444,13 @@ namespace AIToolbox::MDP {
 
             mutable RandomEngine rand_;
 
-            friend std::istream& operator>>(std::istream &is, SparseModel &);
+            friend std::istream& operator>>(std::istream &is, BasicSparseModel<double> &);
     };
 
+    template <typename Scalar>
     template <typename T, typename R>
-    SparseModel::SparseModel(const size_t s, const size_t a, const T & t, const R & r, const double d) :
-            S(s), A(a), transitions_(A, SparseMatrix2D(S, S)),
+    BasicSparseModel<Scalar>::BasicSparseModel(const size_t s, const size_t a, const T & t, const R & r, const double d) :
+            S(s), A(a), transitions_(A, BasicSparseMatrix2D<Scalar>(S, S)),
             rewards_(S, A), rand_(Impl::Seeder::getSeed())
     {
         setDiscount(d);
@@ -389,34 +458,49 @@ namespace AIToolbox::MDP {
         setRewardFunction(r);
     }
 
+    template <typename Scalar>
     template <typename M, typename>
-    SparseModel::SparseModel(const M& model) :
-            S(model.getS()), A(model.getA()), transitions_(A, SparseMatrix2D(S, S)),
+    BasicSparseModel<Scalar>::BasicSparseModel(const M& model) :
+            S(model.getS()), A(model.getA()), transitions_(A, BasicSparseMatrix2D<Scalar>(S, S)),
             rewards_(S, A), rand_(Impl::Seeder::getSeed())
     {
         setDiscount(model.getDiscount());
-        for ( size_t s = 0; s < S; ++s )
+
+        // Sparse models only give us their non-zero entries, so copying
+        // them does not scan all SxAxS triplets.
+        RewardTriplets rewards;
+        std::vector<Eigen::Triplet<Scalar>> triplets;
         for ( size_t a = 0; a < A; ++a ) {
-            for ( size_t s1 = 0; s1 < S; ++s1 ) {
-                const double p = model.getTransitionProbability(s, a, s1);
-                if ( p < 0.0 || p > 1.0 )
+            triplets.clear();
+            for ( size_t s = 0; s < S; ++s ) {
+                double sum = 0.0, reward = 0.0;
+                bool valid = true;
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    if ( p < 0.0 || p > 1.0 ) valid = false;
+
+                    const double r = model.getExpectedReward(s, a, s1);
+                    if ( checkDifferentSmall(0.0, r) ) reward += r * p;
+
+                    if ( !checkDifferentSmall(0.0, p) ) return;
+                    triplets.emplace_back(s, s1, p);
+                    sum += static_cast<Scalar>(p);
+                });
+                if ( !valid )
                     throw std::invalid_argument("Input transition matrix contains an invalid value.");
-
-                if ( checkDifferentSmall(0.0, p) ) transitions_[a].insert(s, s1) = p;
-                const double r = model.getExpectedReward(s, a, s1);
-                if ( checkDifferentSmall(0.0, r) ) rewards_.coeffRef(s, a) += r * p;
+                if ( checkDifferentSmall(1.0, sum) )
+                    throw std::invalid_argument("Input transition matrix contains an invalid row.");
+                if ( reward != 0.0 ) rewards.emplace_back(s, a, reward);
             }
-            if ( checkDifferentSmall(1.0, transitions_[a].row(s).sum()) )
-                throw std::invalid_argument("Input transition matrix contains an invalid row.");
-        }
-
-        for ( size_t a = 0; a < A; ++a )
+            transitions_[a].setFromTriplets(std::begin(triplets), std::end(triplets));
             transitions_[a].makeCompressed();
+        }
+        rewards_.setFromTriplets(std::begin(rewards), std::end(rewards));
         rewards_.makeCompressed();
     }
 
+    template <typename Scalar>
     template <typename T>
-    void SparseModel::setTransitionFunction(const T & t) {
+    void BasicSparseModel<Scalar>::setTransitionFunction(const T & t) {
         // First we verify data, without modifying anything...
         for ( size_t s = 0; s < S; ++s )
             for ( size_t a = 0; a < A; ++a )
@@ -424,32 +508,52 @@ namespace AIToolbox::MDP {
                     throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
 
         // Then we copy.
+        std::vector<Eigen::Triplet<Scalar>> triplets;
         for ( size_t a = 0; a < A; ++a ) {
-            transitions_[a].setZero();
-
+            triplets.clear();
             for ( size_t s = 0; s < S; ++s )
             for ( size_t s1 = 0; s1 < S; ++s1 ) {
                 const double p = t[s][a][s1];
-                if ( checkDifferentSmall(0.0, p) ) transitions_[a].insert(s, s1) = p;
+                if ( checkDifferentSmall(0.0, p) ) triplets.emplace_back(s, s1, p);
             }
+            transitions_[a].setFromTriplets(std::begin(triplets), std::end(triplets));
             transitions_[a].makeCompressed();
         }
     }
 
+    template <typename Scalar>
     template <typename R>
-    void SparseModel::setRewardFunction( const R & r ) {
-        rewards_.setZero();
+    void BasicSparseModel<Scalar>::setRewardFunction( const R & r ) {
+        // We only need the rewards of the non-zero transitions.
+        RewardTriplets triplets;
         for ( size_t a = 0; a < A; ++a ) {
-            for ( size_t s = 0; s < S; ++s )
-            for ( size_t s1 = 0; s1 < S; ++s1 ) {
-                const double w = r[s][a][s1];
-                const double p = transitions_[a].coeff(s, s1);
-                if ( checkDifferentSmall(0.0, w) && checkDifferentSmall(0.0, p) ) rewards_.coeffRef(s, a) += w * p;
+            for ( size_t s = 0; s < S; ++s ) {
+                double reward = 0.0;
+                for ( typename BasicSparseMatrix2D<Scalar>::InnerIterator it(transitions_[a], s); it; ++it ) {
+                    const double w = r[s][a][it.col()];
+                    const double p = it.value();
+                    if ( checkDifferentSmall(0.0, w) && checkDifferentSmall(0.0, p) ) reward += w * p;
+                }
+                if ( reward != 0.0 ) triplets.emplace_back(s, a, reward);
             }
         }
+        rewards_.setFromTriplets(std::begin(triplets), std::end(triplets));
         rewards_.makeCompressed();
     }
+
+    /**
+     * @brief The default sparse MDP model, which stores its transitions in double precision.
+     */
+    using SparseModel = BasicSparseModel<double>;
+
+    /**
+     * @brief A sparse MDP model which stores its transitions in single precision.
+     */
+    using FloatSparseModel = BasicSparseModel<float>;
+
+    // Both versions are compiled in the library.
+    extern template class BasicSparseModel<double>;
+    extern template class BasicSparseModel<float>;
 }
 
 #endif
-
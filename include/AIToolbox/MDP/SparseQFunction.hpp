@@ -0,0 +1,194 @@
+#ifndef AI_TOOLBOX_MDP_SPARSE_QFUNCTION_HEADER_FILE
+#define AI_TOOLBOX_MDP_SPARSE_QFUNCTION_HEADER_FILE
+
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This class represents a QFunction which only stores the visited states.
+     *
+     * A QFunction is a dense S x A matrix, which cannot be allocated when
+     * the state space is huge (for example when states are hashes of
+     * features), even if only a small fraction of the states is ever
+     * visited.
+     *
+     * This class stores the rows of the visited states in an open
+     * addressing hash table (with linear probing), so that the memory used
+     * grows with the number of visited states. All rows are stored in a
+     * single contiguous array, A values per table slot. States which have
+     * not been stored return a row where all actions have the initial
+     * value.
+     *
+     * Rows are only stored when written through getRowRef() or
+     * getValueRef(). The table grows when it becomes half full: this moves
+     * all rows, so references and Maps to rows obtained before inserting a
+     * new state are invalidated.
+     */
+    class SparseQFunction {
+        public:
+            using ConstRow = Eigen::Map<const Vector>;
+            using Row = Eigen::Map<Vector>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param S The size of the state space.
+             * @param A The size of the action space.
+             * @param initialValue The value of all actions in states not stored.
+             */
+            SparseQFunction(size_t S, size_t A, double initialValue = 0.0);
+
+            /**
+             * @brief This function returns the values of the input state.
+             *
+             * If the state is not stored, the returned row contains the
+             * initial value for all actions.
+             *
+             * @param s The state to read.
+             *
+             * @return The values of all actions in the state.
+             */
+            ConstRow getRow(size_t s) const;
+
+            /**
+             * @brief This function returns a modifiable row for the input state, storing it if needed.
+             *
+             * @param s The state to read or write.
+             *
+             * @return The values of all actions in the state.
+             */
+            Row getRowRef(size_t s);
+
+            /**
+             * @brief This function returns the value of a state-action pair.
+             *
+             * @param s The state.
+             * @param a The action.
+             *
+             * @return The value of the pair.
+             */
+            double getValue(size_t s, size_t a) const;
+
+            /**
+             * @brief This function returns a modifiable value for a state-action pair, storing the state if needed.
+             *
+             * @param s The state.
+             * @param a The action.
+             *
+             * @return A reference to the value of the pair.
+             */
+            double & getValueRef(size_t s, size_t a);
+
+            /**
+             * @brief This function returns whether a state is stored.
+             *
+             * @param s The state to check.
+             *
+             * @return Whether the state has been stored.
+             */
+            bool contains(size_t s) const;
+
+            /**
+             * @brief This function reserves space for the input number of states.
+             *
+             * @param states The number of states to reserve space for.
+             */
+            void reserve(size_t states);
+
+            /**
+             * @brief This function removes all stored states.
+             *
+             * The allocated memory is kept.
+             */
+            void clear();
+
+            /**
+             * @brief This function calls the input function for each stored state.
+             *
+             * The function is called as f(s, row), in no particular order.
+             *
+             * @param f The function to call.
+             */
+            template <typename F>
+            void forEachRow(F && f) const;
+
+            /**
+             * @brief This function returns the equivalent dense QFunction.
+             *
+             * This allocates an S x A matrix, so it should only be used
+             * when the state space is small.
+             *
+             * @return The dense QFunction.
+             */
+            QFunction toDense() const;
+
+            /**
+             * @brief This function returns the number of stored states.
+             *
+             * @return The number of stored states.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the number of bytes allocated for the table.
+             *
+             * @return The memory used by the table.
+             */
+            size_t getMemoryUsage() const;
+
+            /**
+             * @brief This function returns the value of the actions of states not stored.
+             *
+             * @return The initial value.
+             */
+            double getInitialValue() const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The total number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of available actions to the agent.
+             *
+             * @return The total number of actions.
+             */
+            size_t getA() const;
+
+        private:
+            // Marks empty slots; no valid state can have this id.
+            static constexpr size_t Empty = static_cast<size_t>(-1);
+
+            /**
+             * @brief This function returns the slot of a state, or of the empty slot where it would go.
+             */
+            size_t findSlot(size_t s) const;
+
+            /**
+             * @brief This function resizes the table, rehashing all stored states.
+             */
+            void rehash(size_t capacity);
+
+            size_t S, A;
+            double initialValue_;
+
+            size_t size_, mask_;
+            std::vector<size_t> keys_;
+            std::vector<double> values_;
+            // The row returned for states not stored.
+            Vector defaultRow_;
+    };
+
+    template <typename F>
+    void SparseQFunction::forEachRow(F && f) const {
+        for (size_t i = 0; i < keys_.size(); ++i)
+            if (keys_[i] != Empty)
+                f(keys_[i], ConstRow(values_.data() + i * A, A));
+    }
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define AI_TOOLBOX_MDP_SPARSE_RLMODEL_HEADER_FILE
 
 #include <tuple>
+#include <utility>
+#include <vector>
 #include <random>
 
 #include <AIToolbox/Impl/Seeder.hpp>
@@ -11,6 +13,9 @@
 #include <AIToolbox/MDP/TypeTraits.hpp>
 
 namespace AIToolbox::MDP {
+    class Experience;
+    class SparseExperience;
+
     /**
      * @brief This class models Experience as a Markov Decision Process.
      *
@@ -155,6 +160,26 @@ namespace AIToolbox::MDP {
              */
             void sync(size_t s, size_t a, size_t s1);
 
+            /**
+             * @brief This function syncs a set of state action pairs in the SparseRLModel to the underlying Experience.
+             *
+             * This function is equivalent to calling sync(s, a) for each
+             * input pair. It is meant to be used together with
+             * Experience::getDirtyPairs(), so that when experience is
+             * streamed in continuously only the state action pairs which
+             * have actually changed are resynced:
+             *
+             * \code{.cpp}
+             * model.sync(exp.getDirtyPairs());
+             * exp.clearDirtyPairs();
+             * \endcode
+             *
+             * This function does not allocate memory.
+             *
+             * @param pairs The state action pairs that need to be synced.
+             */
+            void sync(const std::vector<std::pair<size_t, size_t>> & pairs);
+
             /**
              * @brief This function samples the MDP for the specified state action pair.
              *
@@ -256,6 +281,23 @@ namespace AIToolbox::MDP {
             bool isTerminal(size_t s) const;
 
         private:
+            /**
+             * @brief This function reserves free space in each row of the transition and reward matrices.
+             *
+             * Inserting an element in a compressed Eigen sparse matrix
+             * requires moving all the elements after it. Instead, we keep
+             * the matrices uncompressed with some free space in each row,
+             * so that a new transition only moves the elements in its own
+             * row. When a row runs out of space Eigen doubles it, so the
+             * cost of moving the rest of the matrix is amortized.
+             *
+             * The matrices are never compressed again, as they are bound
+             * to change as more experience is recorded.
+             */
+            void reserveSlack();
+
+            static constexpr int RowSlack = 4;
+
             size_t S, A;
             double discount_;
 
@@ -275,6 +317,7 @@ namespace AIToolbox::MDP {
         setDiscount(discount);
 
         if ( toSync ) {
+            reserveSlack();
             sync();
             // Sync does not touch state-action pairs which have never been
             // seen. To keep the model consistent we set all of them as
@@ -283,8 +326,6 @@ namespace AIToolbox::MDP {
                 for ( size_t s = 0; s < S; ++s )
                     if ( experience_.getVisitsSum(s, a) == 0ul )
                         transitions_[a].insert(s, s) = 1.0;
-                // We don't bother making it compressed since it is bound
-                // to change eventually anyway
             }
         }
         else {
@@ -292,6 +333,15 @@ namespace AIToolbox::MDP {
             for ( size_t a = 0; a < A; ++a )
                 transitions_[a].setIdentity();
         }
+        reserveSlack();
+    }
+
+    template <typename E>
+    void SparseRLModel<E>::reserveSlack() {
+        const auto slack = Eigen::VectorXi::Constant(S, RowSlack);
+        for ( auto & t : transitions_ )
+            t.reserve(slack);
+        rewards_.reserve(slack);
     }
 
     template <typename E>
@@ -312,18 +362,26 @@ namespace AIToolbox::MDP {
         // Nothing to do
         const auto visitSum = experience_.getVisitsSum(s, a);
         if ( visitSum == 0ul ) return;
-        // Clear beginning's identity matrix
-        if ( visitSum == 1ul )
-            transitions_[a].coeffRef(s, s) = 0.0;
+        // Clear the old row, including the beginning's identity matrix
+        // (which may still be there if we have never synced this pair).
+        for ( SparseMatrix2D::InnerIterator it(transitions_[a], s); it; ++it )
+            it.valueRef() = 0.0;
 
         // Create reciprocal for fast division
         const double visitSumReciprocal = 1.0 / visitSum;
 
         // Normalize
-        for ( size_t s1 = 0; s1 < S; ++s1 ) {
-            const auto visits = experience_.getVisits(s, a, s1);
-            if (visits > 0)
-                transitions_[a].coeffRef(s, s1) = static_cast<double>(visits) * visitSumReciprocal;
+        if constexpr (std::is_same_v<E, SparseExperience>) {
+            // We only need to look at the transitions actually visited.
+            for ( SparseTable2D::InnerIterator it(experience_.getVisitTable()[a], s); it; ++it )
+                if ( it.value() > 0 )
+                    transitions_[a].coeffRef(s, it.col()) = static_cast<double>(it.value()) * visitSumReciprocal;
+        } else {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                const auto visits = experience_.getVisits(s, a, s1);
+                if (visits > 0)
+                    transitions_[a].coeffRef(s, s1) = static_cast<double>(visits) * visitSumReciprocal;
+            }
         }
 
         const double rewValue = experience_.getRewardSum(s, a) * visitSumReciprocal;
@@ -360,6 +418,12 @@ namespace AIToolbox::MDP {
         }
     }
 
+    template <typename E>
+    void SparseRLModel<E>::sync(const std::vector<std::pair<size_t, size_t>> & pairs) {
+        for ( const auto & [s, a] : pairs )
+            sync(s, a);
+    }
+
     template <typename E>
     std::tuple<size_t, double> SparseRLModel<E>::sampleSR(const size_t s, const size_t a) const {
         const size_t s1 = sampleProbability(S, transitions_[a].row(s), rand_);
@@ -0,0 +1,114 @@
+#ifndef AI_TOOLBOX_MDP_SPARSIFY_HEADER_FILE
+#define AI_TOOLBOX_MDP_SPARSIFY_HEADER_FILE
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+namespace AIToolbox::MDP {
+    /**
+     * @brief This function converts a model to a SparseModel, dropping its least likely transitions.
+     *
+     * Models learned from data, as RLModel, often have transition rows
+     * where most of the probability mass is in a few successors, and the
+     * rest is spread in many tiny probabilities. Storing these in a
+     * SparseModel gives little benefit, as most entries are non-zero.
+     *
+     * This function keeps, in each row, only the successors with
+     * probability at least the input threshold and, if maxSuccessors is
+     * not zero, at most the maxSuccessors most likely ones. The most
+     * likely successor is always kept, and the kept probabilities are
+     * renormalized. The immediate rewards are the ones of the original
+     * model, so they are not affected.
+     *
+     * Together with the model, this function returns a bound on how much
+     * the optimal (or any policy's) values of the sparse model can differ
+     * from the original ones. If d is the largest mass dropped from any
+     * row, each row moves by at most 2d in L1 norm, and
+     *
+     *     |V - V'| <= discount * d * (maxR - minR) / (1 - discount)^2
+     *
+     * where maxR and minR are the largest and smallest immediate rewards.
+     * The bound is infinite if the discount is 1 and some mass has been
+     * dropped.
+     *
+     * This function throws std::invalid_argument if the threshold is
+     * negative.
+     *
+     * @param model The model to sparsify.
+     * @param threshold The minimum probability of the successors to keep.
+     * @param maxSuccessors The maximum number of successors to keep per row, or 0 for no limit.
+     *
+     * @return A tuple containing the sparse model, the bound on the value error, and the largest mass dropped from a row.
+     */
+    template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+    std::tuple<SparseModel, double, double> sparsifyModel(const M & model, const double threshold, const size_t maxSuccessors = 0) {
+        if ( threshold < 0.0 ) throw std::invalid_argument("Threshold must be >= 0");
+
+        const size_t S = model.getS(), A = model.getA();
+        const double discount = model.getDiscount();
+        const Matrix2D rewards = computeImmediateRewards(model);
+
+        SparseModel::TransitionMatrix t(A, SparseMatrix2D(S, S));
+        SparseModel::RewardMatrix r(S, A);
+
+        double maxDropped = 0.0;
+        std::vector<std::pair<size_t, double>> row;
+        for ( size_t a = 0; a < A; ++a ) {
+            std::vector<Eigen::Triplet<double>> triplets;
+            for ( size_t s = 0; s < S; ++s ) {
+                row.clear();
+                double total = 0.0;
+                forEachSuccessor(model, s, a, [&](const size_t s1, const double p) {
+                    row.emplace_back(s1, p);
+                    total += p;
+                });
+
+                // Most likely first; ties by state so results do not
+                // depend on the sort.
+                std::sort(std::begin(row), std::end(row), [](const auto & lhs, const auto & rhs) {
+                    return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+                });
+                size_t keep = 0;
+                while ( keep < row.size() && (keep == 0 || row[keep].second >= threshold) &&
+                        (maxSuccessors == 0 || keep < maxSuccessors) )
+                    ++keep;
+
+                double kept = 0.0;
+                for ( size_t i = 0; i < keep; ++i )
+                    kept += row[i].second;
+                maxDropped = std::max(maxDropped, total - kept);
+
+                for ( size_t i = 0; i < keep; ++i )
+                    triplets.emplace_back(s, row[i].first, row[i].second / kept);
+
+                if ( checkDifferentSmall(0.0, rewards(s, a)) ) r.insert(s, a) = rewards(s, a);
+            }
+            t[a].setFromTriplets(std::begin(triplets), std::end(triplets));
+            t[a].makeCompressed();
+        }
+        r.makeCompressed();
+
+        double bound = 0.0;
+        if ( maxDropped > 0.0 && S > 0 && A > 0 ) {
+            const double span = rewards.maxCoeff() - rewards.minCoeff();
+            if ( discount < 1.0 )
+                bound = discount * maxDropped * span / ((1.0 - discount) * (1.0 - discount));
+            else if ( span > 0.0 )
+                bound = std::numeric_limits<double>::infinity();
+        }
+
+        // Rows are renormalized, so they are still distributions.
+        return std::make_tuple(SparseModel(NO_CHECK, S, A, std::move(t), std::move(r), discount), bound, maxDropped);
+    }
+}
+
+#endif
@@ -46,6 +46,74 @@ namespace AIToolbox::MDP {
     template <typename M>
     inline constexpr bool is_generative_model_v = is_generative_model<M>::value;
 
+    /**
+     * @brief This struct represents the required interface for a generative MDP which can be sampled with external random engines.
+     *
+     * This struct is used to check whether the model can be sampled using
+     * a random engine provided by the caller, rather than its own internal
+     * one. These models can be sampled concurrently by multiple threads, as
+     * long as each uses its own engine. The interface is the following:
+     *
+     * - std::tuple<size_t, double> sampleSR(size_t s, size_t a, RandomEngine & rnd) const : Returns a sampled state-reward pair from (s,a) using rnd
+     *
+     * This is in addition to the is_generative_model interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_generative_model_rng {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<std::tuple<size_t, double> (Z::*)(size_t,size_t,RandomEngine&) const>   (&Z::sampleSR),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_generative_model_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_generative_model_rng_v = is_generative_model_rng<M>::value;
+
+    /**
+     * @brief This struct represents the required interface for a generative MDP which can sample many transitions at once.
+     *
+     * This struct is used to check whether the model can sample a whole
+     * batch of transitions in a single call. This is useful for models
+     * which have a high fixed cost per call (like models implemented in
+     * Python), so that algorithms which need many independent samples can
+     * amortize it. The interface is the following:
+     *
+     * - void sampleSRBatch(TransitionBatch * batch) const : Samples a new state and reward for each state-action pair in the batch, overwriting its nextStates and rewards
+     *
+     * The output arrays are always resized to the number of pairs before
+     * the call. This is in addition to the is_generative_model interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_generative_model_batch {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<void (Z::*)(TransitionBatch *) const>                       (&Z::sampleSRBatch),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_generative_model_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_generative_model_batch_v = is_generative_model_batch<M>::value;
+
     /**
      * @brief This struct represents the required interface for a full MDP.
      *
@@ -164,6 +232,77 @@ namespace AIToolbox::MDP {
     template <typename M>
     inline constexpr bool is_model_not_eigen_v = is_model_not_eigen<M>::value;
 
+    /**
+     * @brief This struct represents the required interface for a model with a fused transition matrix.
+     *
+     * This struct is used to check whether the model stores all of its
+     * transitions in a single (S*A)xS sparse matrix, where the row s*A + a
+     * contains the transition probabilities for the state-action pair (s,
+     * a). This layout matches the one of a QFunction, so algorithms can
+     * perform a full backup with a single matrix-vector product.
+     *
+     * This is in addition to the is_model interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_model_fused {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<const SparseMatrix2D & (Z::*)() const>  (&Z::getTransitionFunction),
+                    static_cast<const Matrix2D &       (Z::*)() const>  (&Z::getRewardFunction),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_model_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_model_fused_v = is_model_fused<M>::value;
+
+    /**
+     * @brief This struct represents the required interface for a model whose transitions can be streamed.
+     *
+     * This struct is used to check whether the model can be processed in
+     * blocks of contiguous rows of its transition matrices, with the
+     * ability to read the next block in the background and to release
+     * the blocks already processed. This is useful for models stored on
+     * disk that do not fit in memory. The interface is the following:
+     *
+     * - size_t getStreamingBlock() const : Returns the number of rows per block, or zero if streaming is disabled.
+     * - void prefetchRows(size_t a, size_t begin, size_t end) const : Starts loading the rows [begin, end) of action a.
+     * - void evictRows(size_t a, size_t begin, size_t end) const : Releases the rows [begin, end) of action a.
+     *
+     * This is in addition to the is_model_eigen interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_model_streamed {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<size_t (Z::*)() const>                      (&Z::getStreamingBlock),
+                    static_cast<void (Z::*)(size_t, size_t, size_t) const>  (&Z::prefetchRows),
+                    static_cast<void (Z::*)(size_t, size_t, size_t) const>  (&Z::evictRows),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_model_eigen_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_model_streamed_v = is_model_streamed<M>::value;
+
     /**
      * @brief This struct represents the required interface for an experience recorder.
      *
@@ -56,6 +56,24 @@ namespace AIToolbox::MDP {
     using QFunction = Matrix2D;
 
     /** @}  */
+
+    /**
+     * @brief This struct represents a batch of transitions.
+     *
+     * Transitions are stored as a structure of arrays, so that large logs
+     * of experience can be passed to the learning algorithms in bulk. The
+     * i-th transition is made of the i-th element of each array.
+     *
+     * The nextActions array is only needed by algorithms which learn from
+     * (s, a, s1, a1) tuples (like SARSA), and can be left empty otherwise.
+     */
+    struct TransitionBatch {
+        std::vector<size_t> states;
+        std::vector<size_t> actions;
+        std::vector<size_t> nextStates;
+        std::vector<size_t> nextActions;
+        std::vector<double> rewards;
+    };
 }
 
 #endif
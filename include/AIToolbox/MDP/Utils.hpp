@@ -2,8 +2,17 @@
 #define AI_TOOLBOX_MDP_UTILS_HEADER_FILE
 
 #include <stddef.h>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <AIToolbox/Kernels.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::MDP {
     /**
@@ -50,6 +59,11 @@ namespace AIToolbox::MDP {
      * operations inline. The input ValueFunction MUST already be sized
      * appropriately for the input QFunction.
      *
+     * For QFunctions with up to 16 actions, the max and argmax are
+     * computed by kernels specialized on the number of actions, which
+     * process blocks of states at once. Ties are always resolved in favour
+     * of the lowest action.
+     *
      * NOTE: This function DOES NOT perform any checks whatsoever on both
      * the validity of the input pointer and on the size of the input
      * ValueFunction. It assumes everything is already correct.
@@ -59,6 +73,54 @@ namespace AIToolbox::MDP {
      */
     void bellmanOperatorInline(const QFunction & q, ValueFunction * v);
 
+    /**
+     * @brief This function converts a QFunction into the equivalent optimal ValueFunction in parallel.
+     *
+     * This function is the same as bellmanOperatorInline(const QFunction &,
+     * ValueFunction *), but splits the states between the threads of the
+     * input ThreadPool. The result is identical to the serial version.
+     *
+     * @param q The QFunction to convert.
+     * @param v A pre-allocated ValueFunction to populate with the optimal values.
+     * @param pool The ThreadPool to use.
+     */
+    void bellmanOperatorInline(const QFunction & q, ValueFunction * v, ThreadPool & pool);
+
+    /**
+     * @brief This function verifies that the arrays of a TransitionBatch are consistent.
+     *
+     * This function throws an std::invalid_argument if the arrays of the
+     * batch do not all have the same size. The nextActions array is only
+     * checked if requested, and otherwise ignored.
+     *
+     * @param batch The batch to check.
+     * @param withNextActions Whether the nextActions array is needed.
+     *
+     * @return The number of transitions in the batch.
+     */
+    size_t checkTransitionBatch(const TransitionBatch & batch, bool withNextActions = false);
+
+    /**
+     * @brief This function sorts a TransitionBatch by state and action.
+     *
+     * Sorting a batch before passing it to a learning algorithm groups all
+     * updates to the same QFunction row together, which improves cache
+     * locality when the batch is large and comes from many different
+     * states. The sort is stable, so the relative order of transitions
+     * from the same state-action pair is preserved.
+     *
+     * Note that for bootstrapping algorithms the order of the updates
+     * matters, so the results will generally differ from ingesting the
+     * unsorted batch. This is only advisable when the order of the log is
+     * not meaningful (as with experience replay).
+     *
+     * This function throws an std::invalid_argument if the batch arrays are
+     * not consistent.
+     *
+     * @param batch The batch to sort.
+     */
+    void sortTransitionBatch(TransitionBatch * batch);
+
     /**
      * @brief This function computes all immediate rewards (state and action) of the MDP once for improved speed.
      *
@@ -75,7 +137,7 @@ namespace AIToolbox::MDP {
      */
     template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
     Matrix2D computeImmediateRewards(const M & model) {
-        if constexpr(is_model_eigen_v<M>) {
+        if constexpr(is_model_eigen_v<M> || is_model_fused_v<M>) {
             return model.getRewardFunction();
         } else {
             const auto S = model.getS();
@@ -92,32 +154,407 @@ namespace AIToolbox::MDP {
     }
 
     /**
-     * @brief This function computes the Model's QFunction from the values of a ValueFunction.
+     * @brief This function computes the Model's QFunction from the values of a ValueFunction, inline.
+     *
+     * This function writes the QFunction into a caller-provided buffer, so
+     * that repeated calls (as in ValueIteration) do not allocate. The
+     * output must already be sized SxA. The immediate rewards are copied
+     * into the output first, so `ir` and `q` may be the same object.
      *
      * Note that this function is more efficient with eigen models.
      *
      * @param model The MDP that needs to be solved.
      * @param v The values of the ValueFunction for the future of the QFunction.
      * @param ir The immediate rewards of the model, as created by computeImmediateRewards()
-     *
-     * @return A new QFunction.
+     * @param q A pre-allocated QFunction where to write the output.
      */
     template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
-    QFunction computeQFunction(const M & model, const Values & v, QFunction ir) {
+    void computeQFunctionInline(const M & model, const Values & v, const QFunction & ir, QFunction * q) {
+        assert(q);
         const auto A = model.getA();
 
-        if constexpr(is_model_eigen_v<M>) {
+        if ( q != &ir ) q->noalias() = ir;
+
+        if constexpr(is_model_fused_v<M>) {
+            // The fused transition matrix has a row per state-action pair,
+            // in the same order as the (row-major) QFunction, so we can do
+            // the whole backup with a single product.
+            const auto S = model.getS();
+            Eigen::Map<Vector> qv(q->data(), S * A);
+            qv.noalias() += model.getTransitionFunction() * v;
+        } else if constexpr(is_model_eigen_v<M>) {
+            using TMatrix = remove_cv_ref_t<decltype(model.getTransitionFunction(0))>;
+            if constexpr(std::is_same_v<TMatrix, Matrix2D>) {
+                // Large dense models use the vectorized kernels. The
+                // QFunction is row-major, so its columns have stride A.
+                const auto S = model.getS();
+                if ( S >= Kernels::MinSize ) {
+                    const auto & kernels = getKernels();
+                    for ( size_t a = 0; a < A; ++a )
+                        kernels.gemv(S, S, model.getTransitionFunction(a).data(), v.data(), q->data() + a, A);
+                    return;
+                }
+            }
+            // Models may store their transitions with a scalar other than
+            // double (e.g. MDP::FloatModel); in that case the products are
+            // done in that precision. For double models the casts are no-ops.
+            using TScalar = typename TMatrix::Scalar;
             for ( size_t a = 0; a < A; ++a )
-                ir.col(a).noalias() += model.getTransitionFunction(a) * v;
+                q->col(a).noalias() += (model.getTransitionFunction(a) * v.template cast<TScalar>()).template cast<double>();
         } else {
             const auto S = model.getS();
             for ( size_t s = 0; s < S; ++s )
                 for ( size_t a = 0; a < A; ++a )
                     for ( size_t s1 = 0; s1 < S; ++s1 )
-                        ir(s, a) += model.getTransitionProbability(s,a,s1) * v[s1];
+                        (*q)(s, a) += model.getTransitionProbability(s,a,s1) * v[s1];
+        }
+    }
+
+    /**
+     * @brief This function computes the Model's QFunction from the values of a ValueFunction, streaming the transitions.
+     *
+     * This function is the same as computeQFunctionInline(const M &, const
+     * Values &, const QFunction &, QFunction *), but it processes each
+     * transition matrix in blocks of model.getStreamingBlock() contiguous
+     * rows, in order. Before computing on a block, it asks the model to
+     * load the next one, so that reading from disk overlaps with
+     * computation; after it is done with a block, it asks the model to
+     * evict it.
+     *
+     * If a ThreadPool is passed, the rows of each block are split between
+     * its threads.
+     *
+     * Since each row is computed in the same way as in the non-streamed
+     * version, the result is identical to it.
+     *
+     * @param model The MDP that needs to be solved; streaming must be enabled.
+     * @param v The values of the ValueFunction for the future of the QFunction.
+     * @param ir The immediate rewards of the model, as created by computeImmediateRewards()
+     * @param q A pre-allocated QFunction where to write the output.
+     * @param pool The ThreadPool to use, or nullptr.
+     */
+    template <typename M, std::enable_if_t<is_model_streamed_v<M>, int> = 0>
+    void computeQFunctionStreamedInline(const M & model, const Values & v, const QFunction & ir, QFunction * q, ThreadPool * pool = nullptr) {
+        assert(q);
+        assert(model.getStreamingBlock() > 0);
+        const auto S = model.getS();
+        const auto A = model.getA();
+        const auto B = model.getStreamingBlock();
+
+        if ( q != &ir ) q->noalias() = ir;
+
+        if ( S == 0 ) return;
+        model.prefetchRows(0, 0, std::min(B, S));
+        for ( size_t a = 0; a < A; ++a ) {
+            const auto & T = model.getTransitionFunction(a);
+            for ( size_t begin = 0; begin < S; begin += B ) {
+                const auto end = std::min(S, begin + B);
+
+                // Read-ahead of the next block, possibly of the next action.
+                if ( end < S )           model.prefetchRows(a, end, std::min(S, end + B));
+                else if ( a + 1 < A )    model.prefetchRows(a + 1, 0, std::min(B, S));
+
+                const auto compute = [&](const size_t from, const size_t to) {
+                    q->col(a).segment(begin + from, to - from).noalias() += T.middleRows(begin + from, to - from) * v;
+                };
+                if ( pool ) pool->parallelFor(end - begin, compute);
+                else        compute(0, end - begin);
+
+                model.evictRows(a, begin, end);
+            }
         }
+    }
+
+    /**
+     * @brief This function computes the Model's QFunction from the values of a ValueFunction.
+     *
+     * Note that this function is more efficient with eigen models.
+     *
+     * @param model The MDP that needs to be solved.
+     * @param v The values of the ValueFunction for the future of the QFunction.
+     * @param ir The immediate rewards of the model, as created by computeImmediateRewards()
+     *
+     * @return A new QFunction.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    QFunction computeQFunction(const M & model, const Values & v, QFunction ir) {
+        computeQFunctionInline(model, v, ir, &ir);
         return ir;
     }
+
+    /**
+     * @brief This function computes the Model's QFunction from the values of a ValueFunction in parallel, inline.
+     *
+     * This function is the same as computeQFunctionInline(const M &, const
+     * Values &, const QFunction &, QFunction *), but splits the work
+     * between the threads of the input ThreadPool. For Eigen models each
+     * thread computes the products of a block of actions; otherwise each
+     * thread processes a block of states.
+     *
+     * Since each entry of the output is computed by a single thread in the
+     * same order as the serial version, the result is identical to it.
+     *
+     * @param model The MDP that needs to be solved.
+     * @param v The values of the ValueFunction for the future of the QFunction.
+     * @param ir The immediate rewards of the model, as created by computeImmediateRewards()
+     * @param q A pre-allocated QFunction where to write the output.
+     * @param pool The ThreadPool to use.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    void computeQFunctionInline(const M & model, const Values & v, const QFunction & ir, QFunction * q, ThreadPool & pool) {
+        assert(q);
+        const auto S = model.getS();
+        const auto A = model.getA();
+
+        if constexpr(is_model_fused_v<M>) {
+            pool.parallelFor(S, [&](const size_t begin, const size_t end) {
+                const auto rows = (end - begin) * A;
+                if ( q != &ir ) q->middleRows(begin, end - begin).noalias() = ir.middleRows(begin, end - begin);
+                Eigen::Map<Vector> qv(q->row(begin).data(), rows);
+                qv.noalias() += model.getTransitionFunction().middleRows(begin * A, rows) * v;
+            });
+        } else if constexpr(is_model_eigen_v<M>) {
+            using TMatrix = remove_cv_ref_t<decltype(model.getTransitionFunction(0))>;
+            using TScalar = typename TMatrix::Scalar;
+            // Same as in the serial version, so that results are identical.
+            const bool useKernels = std::is_same_v<TMatrix, Matrix2D> && S >= Kernels::MinSize;
+            const auto & kernels = getKernels();
+            pool.parallelFor(A, [&](const size_t begin, const size_t end) {
+                for ( size_t a = begin; a < end; ++a ) {
+                    if ( q != &ir ) q->col(a).noalias() = ir.col(a);
+                    if constexpr(std::is_same_v<TMatrix, Matrix2D>) {
+                        if ( useKernels ) {
+                            kernels.gemv(S, S, model.getTransitionFunction(a).data(), v.data(), q->data() + a, A);
+                            continue;
+                        }
+                    }
+                    q->col(a).noalias() += (model.getTransitionFunction(a) * v.template cast<TScalar>()).template cast<double>();
+                }
+            });
+        } else {
+            pool.parallelFor(S, [&](const size_t begin, const size_t end) {
+                for ( size_t s = begin; s < end; ++s ) {
+                    if ( q != &ir ) q->row(s).noalias() = ir.row(s);
+                    for ( size_t a = 0; a < A; ++a )
+                        for ( size_t s1 = 0; s1 < S; ++s1 )
+                            (*q)(s, a) += model.getTransitionProbability(s,a,s1) * v[s1];
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief This function computes the Model's QFunction from the values of a ValueFunction in parallel.
+     *
+     * This function is the same as computeQFunction(const M &, const Values
+     * &, QFunction), but splits the work between the threads of the input
+     * ThreadPool. The result is identical to the serial version.
+     *
+     * @param model The MDP that needs to be solved.
+     * @param v The values of the ValueFunction for the future of the QFunction.
+     * @param ir The immediate rewards of the model, as created by computeImmediateRewards()
+     * @param pool The ThreadPool to use.
+     *
+     * @return A new QFunction.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    QFunction computeQFunction(const M & model, const Values & v, QFunction ir, ThreadPool & pool) {
+        computeQFunctionInline(model, v, ir, &ir, pool);
+        return ir;
+    }
+
+    /**
+     * @brief This function calls the input function for each possible successor of a state-action pair.
+     *
+     * The function is called as f(s1, p) for each state s1 with a
+     * non-zero transition probability p, in increasing order of s1. Sparse
+     * and fused models only visit their stored entries, while other models
+     * are scanned over all states.
+     *
+     * @param model The model to inspect.
+     * @param s The initial state.
+     * @param a The action.
+     * @param f The function to call.
+     */
+    template <typename M, typename F, std::enable_if_t<is_model_v<M>, int> = 0>
+    void forEachSuccessor(const M & model, const size_t s, const size_t a, F && f) {
+        if constexpr (is_model_fused_v<M>) {
+            for ( SparseMatrix2D::InnerIterator it(model.getTransitionFunction(), s * model.getA() + a); it; ++it )
+                if ( it.value() != 0.0 )
+                    f(static_cast<size_t>(it.col()), static_cast<double>(it.value()));
+            return;
+        } else if constexpr (is_model_eigen_v<M>) {
+            const auto & t = model.getTransitionFunction(a);
+            using T = std::remove_cv_t<std::remove_reference_t<decltype(t)>>;
+            if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<T>, T>) {
+                for ( typename T::InnerIterator it(t, s); it; ++it )
+                    if ( it.value() != 0.0 )
+                        f(static_cast<size_t>(it.col()), static_cast<double>(it.value()));
+                return;
+            }
+        }
+        for ( size_t s1 = 0; s1 < model.getS(); ++s1 ) {
+            const double p = model.getTransitionProbability(s, a, s1);
+            if ( p != 0.0 ) f(s1, p);
+        }
+    }
+
+    /**
+     * @brief This function performs uniformly random rollouts from many states at once.
+     *
+     * All rollouts are advanced in lockstep, so that each timestep is
+     * sampled with a single call to the model's sampleSRBatch(). Rollouts
+     * which reach a terminal state, or the end of their horizon, are
+     * removed from the following batches.
+     *
+     * The signature matches a BatchEvaluator, so that this function can
+     * replace the single rollouts of online planners when their leaves
+     * are queued in a LeafBatch.
+     *
+     * @param model The model to sample.
+     * @param states The states to start the rollouts from.
+     * @param horizons The number of timesteps of each rollout.
+     * @param values The output discounted returns, already resized to the number of states.
+     * @param batch A buffer for the samples of each timestep.
+     * @param rnd The random engine used to sample the actions.
+     */
+    template <typename M, typename Gen>
+    void rolloutBatch(const M & model, const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values, TransitionBatch * batch, Gen & rnd) {
+        static_assert(is_generative_model_batch_v<M>, "This function only works for generative MDP models which can sample batches!");
+        assert(batch);
+
+        std::uniform_int_distribution<size_t> generator(0, model.getA() - 1);
+
+        // We track the index, remaining horizon and discount of each
+        // running rollout; finished ones are compacted away.
+        std::vector<size_t> ids;
+        std::vector<unsigned> left;
+        std::vector<double> gammas;
+
+        batch->states.clear();
+        for ( size_t i = 0; i < states.size(); ++i ) {
+            values[i] = 0.0;
+            if ( !horizons[i] ) continue;
+            ids.push_back(i);
+            left.push_back(horizons[i]);
+            gammas.push_back(1.0);
+            batch->states.push_back(states[i]);
+        }
+
+        while ( ids.size() ) {
+            const size_t N = ids.size();
+            batch->actions.resize(N);
+            batch->nextStates.resize(N);
+            batch->rewards.resize(N);
+            for ( auto & a : batch->actions )
+                a = generator(rnd);
+
+            model.sampleSRBatch(batch);
+
+            size_t j = 0;
+            for ( size_t i = 0; i < N; ++i ) {
+                values[ids[i]] += gammas[i] * batch->rewards[i];
+
+                const auto s1 = batch->nextStates[i];
+                if ( !--left[i] || model.isTerminal(s1) ) continue;
+
+                ids[j] = ids[i];
+                left[j] = left[i];
+                gammas[j] = gammas[i] * model.getDiscount();
+                batch->states[j] = s1;
+                ++j;
+            }
+            ids.resize(j);
+            left.resize(j);
+            gammas.resize(j);
+            batch->states.resize(j);
+        }
+    }
+
+    /**
+     * @brief This function computes the strongly connected components of the transition graph of a model.
+     *
+     * The graph has an edge from s to s1 if any action can lead from s
+     * to s1. The components are returned in reverse topological order:
+     * every transition out of a component leads to a component which
+     * comes before it. The states of each component are sorted.
+     *
+     * This uses an iterative version of Tarjan's algorithm, and takes
+     * time linear in the number of non-zero transitions.
+     *
+     * @param model The model to inspect.
+     *
+     * @return The components of the model.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    std::vector<std::vector<size_t>> computeStronglyConnectedComponents(const M & model) {
+        const size_t S = model.getS();
+        const size_t A = model.getA();
+
+        // Successor lists merged over all actions, without duplicates.
+        std::vector<size_t> offsets(S + 1), edges;
+        {
+            std::vector<size_t> lastSource(S, S);
+            for ( size_t s = 0; s < S; ++s ) {
+                offsets[s] = edges.size();
+                for ( size_t a = 0; a < A; ++a ) {
+                    forEachSuccessor(model, s, a, [&](const size_t s1, double) {
+                        if ( lastSource[s1] == s ) return;
+                        lastSource[s1] = s;
+                        edges.push_back(s1);
+                    });
+                }
+            }
+            offsets[S] = edges.size();
+        }
+
+        constexpr auto unvisited = std::numeric_limits<size_t>::max();
+        std::vector<size_t> index(S, unvisited), low(S), stack;
+        std::vector<char> onStack(S, false);
+        // Each frame contains a state and the position of its next edge.
+        std::vector<std::pair<size_t, size_t>> frames;
+        size_t counter = 0;
+
+        std::vector<std::vector<size_t>> retval;
+        const auto visit = [&](const size_t s) {
+            index[s] = low[s] = counter++;
+            stack.push_back(s);
+            onStack[s] = true;
+            frames.emplace_back(s, offsets[s]);
+        };
+        for ( size_t root = 0; root < S; ++root ) {
+            if ( index[root] != unvisited ) continue;
+            visit(root);
+            while ( !frames.empty() ) {
+                const size_t s = frames.back().first;
+                if ( frames.back().second < offsets[s + 1] ) {
+                    const size_t s1 = edges[frames.back().second++];
+                    if ( index[s1] == unvisited )
+                        visit(s1);
+                    else if ( onStack[s1] )
+                        low[s] = std::min(low[s], index[s1]);
+                    continue;
+                }
+                frames.pop_back();
+                if ( !frames.empty() ) {
+                    const size_t parent = frames.back().first;
+                    low[parent] = std::min(low[parent], low[s]);
+                }
+                if ( low[s] == index[s] ) {
+                    auto & component = retval.emplace_back();
+                    size_t s1;
+                    do {
+                        s1 = stack.back();
+                        stack.pop_back();
+                        onStack[s1] = false;
+                        component.push_back(s1);
+                    } while ( s1 != s );
+                    std::sort(std::begin(component), std::end(component));
+                }
+            }
+        }
+        return retval;
+    }
 }
 
 #endif
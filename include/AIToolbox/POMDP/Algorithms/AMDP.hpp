@@ -2,6 +2,7 @@
 #define AI_TOOLBOX_POMDP_AMDP_HEADER_FILE
 
 #include <cmath>
+#include <vector>
 
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
@@ -10,6 +11,7 @@
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/POMDP/Algorithms/Utils/BeliefGenerator.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::POMDP {
     /**
@@ -47,8 +49,9 @@ namespace AIToolbox::POMDP {
              *
              * @param nBeliefs The number of beliefs to sample from when building the MDP model.
              * @param entropyBuckets The number of buckets into which discretize entropy.
+             * @param pool The ThreadPool to use to build the model, or nullptr.
              */
-            AMDP(size_t nBeliefs, size_t entropyBuckets);
+            AMDP(size_t nBeliefs, size_t entropyBuckets, ThreadPool * pool = nullptr);
 
 
             /**
@@ -65,6 +68,20 @@ namespace AIToolbox::POMDP {
              */
             void setEntropyBuckets(size_t buckets);
 
+            /**
+             * @brief This function sets the ThreadPool to use to build the model.
+             *
+             * The sampled beliefs are split in blocks, which are processed
+             * in parallel. The resulting model does not depend on the
+             * number of threads.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function returns the currently set number of sampled beliefs.
              *
@@ -79,6 +96,13 @@ namespace AIToolbox::POMDP {
              */
             size_t getEntropyBuckets() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
             /**
              * @brief This function constructs an approximate *dense* MDP of the provided POMDP model.
              *
@@ -102,104 +126,152 @@ namespace AIToolbox::POMDP {
             std::tuple<MDP::SparseModel, Discretizer> discretizeSparse(const M& model);
 
         private:
+            using Triplet = Eigen::Triplet<double>;
+            using Triplets = std::vector<Triplet>;
+
+            /**
+             * @brief This struct contains the normalized transitions and rewards of the AMDP.
+             *
+             * Triplets may contain duplicate entries, which must be summed.
+             */
+            struct Transitions {
+                std::vector<Triplets> T;
+                Triplets R;
+            };
+
+            /**
+             * @brief This function computes the transition and reward entries of the AMDP.
+             *
+             * If a ThreadPool is set, the sampled beliefs are split in
+             * blocks which are processed in parallel.
+             *
+             * @param model The POMDP model to be approximated.
+             * @param discretizer The discretizer of the beliefs.
+             *
+             * @return The entries of the AMDP.
+             */
+            template <typename M>
+            Transitions computeTransitions(const M& model, const Discretizer & discretizer) const;
+
             Discretizer makeDiscretizer(size_t S);
 
             size_t beliefSize_, buckets_;
+            ThreadPool * pool_;
     };
 
-    template <typename M, typename>
-    std::tuple<MDP::Model, AMDP::Discretizer> AMDP::discretizeDense(const M& model) {
+    template <typename M>
+    AMDP::Transitions AMDP::computeTransitions(const M& model, const Discretizer & discretizer) const {
         const size_t S = model.getS(), A = model.getA(), O = model.getO();
         const size_t S1 = S * buckets_;
 
-        BeliefGenerator bGen(model);
+        BeliefGenerator<M> bGen(model);
         const auto beliefs = bGen(beliefSize_);
 
-        auto T = MDP::Model::TransitionMatrix(A, Matrix2D::Zero(S1, S1));
-        auto R = MDP::Model::RewardMatrix    (S1, A);
-        R.setZero();
+        // Each block of beliefs is processed independently into its own
+        // triplet lists. Blocks have a fixed size, and are merged in
+        // order, so the result does not depend on the number of threads.
+        constexpr size_t grain = 64;
+        struct Block {
+            std::vector<Triplets> T;
+            Triplets R;
+        };
+        std::vector<Block> blocks((beliefs.size() + grain - 1) / grain);
+
+        const auto work = [&](const size_t begin, const size_t end) {
+            auto & block = blocks[begin / grain];
+            block.T.resize(A);
+
+            Belief b1(S);
+            for ( size_t i = begin; i < end; ++i ) {
+                const auto & b = beliefs[i];
+                const size_t s = discretizer(b);
+
+                for ( size_t a = 0; a < A; ++a ) {
+                    const double r = beliefExpectedReward(model, b, a);
+
+                    for ( size_t o = 0; o < O; ++o ) {
+                        updateBeliefUnnormalized(model, b, a, o, &b1);
+                        const auto p = b1.sum();
+                        if (checkDifferentSmall(0.0, p)) {
+                            b1 /= p;
+                            block.T[a].emplace_back(s, discretizer(b1), p);
+                            if (checkDifferentSmall(0.0, r))
+                                block.R.emplace_back(s, a, p * r);
+                        }
+                    }
+                }
+            }
+        };
+        if ( pool_ ) pool_->parallelFor(beliefs.size(), grain, work);
+        else for ( size_t b = 0; b < beliefs.size(); b += grain )
+            work(b, std::min(beliefs.size(), b + grain));
+
+        Transitions retval;
+        retval.T.resize(A);
+        std::vector<double> rowSums(A * S1, 0.0);
+        for ( auto & block : blocks ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                for ( const auto & t : block.T[a] )
+                    rowSums[a * S1 + t.row()] += t.value();
+                retval.T[a].insert(std::end(retval.T[a]), std::begin(block.T[a]), std::end(block.T[a]));
+            }
+            retval.R.insert(std::end(retval.R), std::begin(block.R), std::end(block.R));
+            // Free memory as we go, as blocks can be large.
+            block = Block();
+        }
 
-        const auto discretizer = makeDiscretizer(S);
+        // Normalize transitions and rewards by the total probability mass
+        // of each row; rows that were never reached become self-loops.
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( auto & t : retval.T[a] )
+                t = Triplet(t.row(), t.col(), t.value() / rowSums[a * S1 + t.row()]);
+            for ( size_t s = 0; s < S1; ++s )
+                if ( checkEqualSmall(rowSums[a * S1 + s], 0.0) )
+                    retval.T[a].emplace_back(s, s, 1.0);
+        }
+        for ( auto & r : retval.R )
+            r = Triplet(r.row(), r.col(), r.value() / rowSums[r.col() * S1 + r.row()]);
 
-        Belief b1(S);
-        for ( const auto & b : beliefs ) {
-            const size_t s = discretizer(b);
+        return retval;
+    }
 
-            for ( size_t a = 0; a < A; ++a ) {
-                const double r = beliefExpectedReward(model, b, a);
+    template <typename M, typename>
+    std::tuple<MDP::Model, AMDP::Discretizer> AMDP::discretizeDense(const M& model) {
+        const size_t S1 = model.getS() * buckets_, A = model.getA();
 
-                for ( size_t o = 0; o < O; ++o ) {
-                    updateBeliefUnnormalized(model, b, a, o, &b1);
-                    const auto p = b1.sum();
-                    if (checkDifferentSmall(0.0, p)) {
-                        b1 /= p;
-                        const size_t s1 = discretizer(b1);
+        const auto discretizer = makeDiscretizer(model.getS());
+        const auto [Ts, Rs] = computeTransitions(model, discretizer);
 
-                        T[a](s, s1) += p;
-                        R(s, a)     += p * r;
-                    }
-                }
-            }
-        }
+        auto T = MDP::Model::TransitionMatrix(A, Matrix2D::Zero(S1, S1));
+        auto R = MDP::Model::RewardMatrix    (S1, A);
+        R.setZero();
 
         for ( size_t a = 0; a < A; ++a )
-            for ( size_t s = 0; s < S1; ++s ) {
-                R(s, a) /= T[a].row(s).sum();
-
-                const double sum = T[a].row(s).sum();
-                if ( checkEqualSmall(sum, 0.0) ) T[a](s, s) = 1.0;
-                else T[a].row(s) /= sum;
-            }
+            for ( const auto & t : Ts[a] )
+                T[a](t.row(), t.col()) += t.value();
+        for ( const auto & r : Rs )
+            R(r.row(), r.col()) += r.value();
 
         return std::make_tuple(MDP::Model(NO_CHECK, S1, A, std::move(T), std::move(R), model.getDiscount()), std::move(discretizer));
     }
 
     template <typename M, typename>
     std::tuple<MDP::SparseModel, AMDP::Discretizer> AMDP::discretizeSparse(const M& model) {
-        const size_t S = model.getS(), A = model.getA(), O = model.getO();
-        const size_t S1 = S * buckets_;
+        const size_t S1 = model.getS() * buckets_, A = model.getA();
 
-        BeliefGenerator<M> bGen(model);
-        const auto beliefs = bGen(beliefSize_);
+        auto discretizer = makeDiscretizer(model.getS());
+        auto [Ts, Rs] = computeTransitions(model, discretizer);
 
         auto T = MDP::SparseModel::TransitionMatrix(A, SparseMatrix2D(S1, S1));
         auto R = MDP::SparseModel::RewardMatrix    (S1, A);
 
-        auto discretizer = makeDiscretizer(S);
-
-        Belief b1(S);
-        for ( const auto & b : beliefs ) {
-            const size_t s = discretizer(b);
-
-            for ( size_t a = 0; a < A; ++a ) {
-                const double r = beliefExpectedReward(model, b, a);
-
-                for ( size_t o = 0; o < O; ++o ) {
-                    updateBeliefUnnormalized(model, b, a, o, &b1);
-                    const auto p = b1.sum();
-                    if (checkDifferentSmall(0.0, p)) {
-                        b1 /= p;
-                        const size_t s1 = discretizer(b1);
-
-                        T[a].coeffRef(s, s1) += p;
-                        if (checkDifferentSmall(0.0, r))
-                            R.coeffRef(s, a) += p * r;
-                    }
-                }
-            }
-        }
-
+        // Duplicate entries are summed.
         for ( size_t a = 0; a < A; ++a ) {
-            for ( size_t s = 0; s < S1; ++s ) {
-                if (checkDifferentSmall(0.0, R.coeff(s, a)))
-                    R.coeffRef(s, a) /= T[a].row(s).sum();
-
-                const double sum = T[a].row(s).sum();
-                if ( checkEqualSmall(sum, 0.0) ) T[a].coeffRef(s, s) = 1.0;
-                else T[a].row(s) /= sum;
-            }
+            T[a].setFromTriplets(std::begin(Ts[a]), std::end(Ts[a]));
+            Triplets().swap(Ts[a]);
             T[a].makeCompressed();
         }
+        R.setFromTriplets(std::begin(Rs), std::end(Rs));
         R.makeCompressed();
 
         return std::make_tuple(MDP::SparseModel(NO_CHECK, S1, A, std::move(T), std::move(R), model.getDiscount()), std::move(discretizer));
@@ -5,10 +5,12 @@
 
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/Prune.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/ModelContext.hpp>
 
 namespace AIToolbox::POMDP {
     /**
@@ -26,6 +28,11 @@ namespace AIToolbox::POMDP {
      * dominated, but we leave the pruning to the clients as maybe the
      * additional per-action information may be useful to somebody (and also
      * makes for easier testing ;) )
+     *
+     * The bound of each action only depends on the transition function of
+     * that action, so the actions are solved independently. If a
+     * ThreadPool is set (see setThreadPool()), they are split between its
+     * threads. The results do not depend on the number of threads.
      */
     class BlindStrategies {
         public:
@@ -69,6 +76,27 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, VList> operator()(const M & m, bool fasterConvergence);
 
+            /**
+             * @brief This function computes the blind strategies for the input POMDP, reusing a ModelContext.
+             *
+             * This function is the same as operator()(const M &, bool),
+             * but takes the immediate rewards of the model from the
+             * input context.
+             *
+             * This function throws std::invalid_argument if the context
+             * does not match the size of the model.
+             *
+             * @param m The POMDP to be solved.
+             * @param fasterConvergence Whether to initialize the internal
+             *        vector for faster convergence.
+             * @param context The ModelContext of the input POMDP.
+             *
+             * @return A tuple containing the maximum variation over all
+             *         actions and the VList containing the found bounds.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, VList> operator()(const M & m, bool fasterConvergence, const ModelContext & context);
+
             /**
              * @brief This function sets the tolerance parameter.
              *
@@ -91,6 +119,17 @@ namespace AIToolbox::POMDP {
              */
             void setHorizon(unsigned h);
 
+            /**
+             * @brief This function sets the ThreadPool to use to solve actions in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function returns the currently set toleranc parameter.
              *
@@ -105,9 +144,23 @@ namespace AIToolbox::POMDP {
              */
             unsigned getHorizon() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
+            /**
+             * @brief This function computes the blind strategies given the transposed immediate rewards.
+             */
+            template <typename M>
+            std::tuple<double, VList> solve(const M & m, const Matrix2D & ir, bool fasterConvergence);
+
             size_t horizon_;
             double tolerance_;
+            ThreadPool * pool_;
     };
 
 
@@ -117,50 +170,76 @@ namespace AIToolbox::POMDP {
             if constexpr(MDP::is_model_eigen_v<M>) return m.getRewardFunction().transpose();
             else return MDP::computeImmediateRewards(m).transpose();
         }();
+        return solve(m, ir, fasterConvergence);
+    }
+
+    template <typename M, typename>
+    std::tuple<double, VList> BlindStrategies::operator()(const M & m, const bool fasterConvergence, const ModelContext & context) {
+        if ( context.getS() != m.getS() || context.getA() != m.getA() || context.getO() != m.getO() )
+            throw std::invalid_argument("The ModelContext does not match the model.");
+
+        return solve(m, context.getImmediateRewards().transpose(), fasterConvergence);
+    }
+
+    template <typename M>
+    std::tuple<double, VList> BlindStrategies::solve(const M & m, const Matrix2D & ir, const bool fasterConvergence) {
         // This function produces a very simple lower bound for the POMDP. The
         // bound for each action is computed assuming to take the same action forever
         // (so the bound for action 0 assumes to forever take action 0, the bound for
         // action 1 assumes to take action 1, etc.).
-        VList retval;
+        const size_t A = m.getA();
+        std::vector<Vector> alphas(A);
+        std::vector<double> variations(A);
 
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
 
-        double maxVariation = 0.0;
-        for (size_t a = 0; a < m.getA(); ++a) {
-            auto newAlpha = Vector(m.getS());
-            auto oldAlpha = Vector(m.getS());
-            // Note that here we can take the minimum for each action
-            // separately, since the implied policy will take that action
-            // forever anyway so there cannot be "cross-pollination" between
-            // different actions.
-            if (fasterConvergence)
-                oldAlpha.fill(ir.row(a).minCoeff() / std::max(0.0001, 1.0 - m.getDiscount()));
-            else
-                oldAlpha = ir.row(a);
-
-            unsigned timestep = 0;
-            double variation = tolerance_ * 2; // Make it bigger
-            while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) ) {
-                ++timestep;
-                if constexpr(is_model_eigen_v<M>) {
-                    newAlpha = ir.row(a) + (m.getDiscount() * m.getTransitionFunction(a) * oldAlpha).transpose();
-                } else {
-                    newAlpha = ir.row(a);
-                    for (size_t s = 0; s < m.getS(); ++s) {
-                        double sum = 0.0;
-                        for (size_t s1 = 0; s1 < m.getS(); ++s1)
-                            sum += m.getTransitionProbability(s, a, s1) * oldAlpha[s1];
-                        newAlpha[s] += m.getDiscount() * sum;
+        const auto solveActions = [&](const size_t begin, const size_t end) {
+            for (size_t a = begin; a < end; ++a) {
+                auto newAlpha = Vector(m.getS());
+                auto oldAlpha = Vector(m.getS());
+                // Note that here we can take the minimum for each action
+                // separately, since the implied policy will take that action
+                // forever anyway so there cannot be "cross-pollination" between
+                // different actions.
+                if (fasterConvergence)
+                    oldAlpha.fill(ir.row(a).minCoeff() / std::max(0.0001, 1.0 - m.getDiscount()));
+                else
+                    oldAlpha = ir.row(a);
+
+                unsigned timestep = 0;
+                double variation = tolerance_ * 2; // Make it bigger
+                while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) ) {
+                    ++timestep;
+                    if constexpr(is_model_eigen_v<M>) {
+                        newAlpha = ir.row(a) + (m.getDiscount() * m.getTransitionFunction(a) * oldAlpha).transpose();
+                    } else {
+                        newAlpha = ir.row(a);
+                        for (size_t s = 0; s < m.getS(); ++s) {
+                            double sum = 0.0;
+                            for (size_t s1 = 0; s1 < m.getS(); ++s1)
+                                sum += m.getTransitionProbability(s, a, s1) * oldAlpha[s1];
+                            newAlpha[s] += m.getDiscount() * sum;
+                        }
                     }
-                }
 
-                if (useTolerance)
-                    variation = (oldAlpha - newAlpha).cwiseAbs().maxCoeff();
+                    if (useTolerance)
+                        variation = (oldAlpha - newAlpha).cwiseAbs().maxCoeff();
 
-                oldAlpha = std::move(newAlpha);
+                    oldAlpha = std::move(newAlpha);
+                }
+                variations[a] = variation;
+                alphas[a] = std::move(oldAlpha);
             }
-            maxVariation = std::max(maxVariation, variation);
-            retval.emplace_back(std::move(oldAlpha), a, VObs(0));
+        };
+        if ( pool_ ) pool_->parallelFor(A, solveActions);
+        else         solveActions(0, A);
+
+        VList retval;
+        retval.reserve(A);
+        double maxVariation = 0.0;
+        for (size_t a = 0; a < A; ++a) {
+            maxVariation = std::max(maxVariation, variations[a]);
+            retval.emplace_back(std::move(alphas[a]), a, VObs(0));
         }
         return std::make_tuple(useTolerance ? maxVariation : 0.0, std::move(retval));
     }
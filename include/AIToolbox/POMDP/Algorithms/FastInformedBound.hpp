@@ -2,11 +2,14 @@
 #define AI_TOOLBOX_POMDP_FAST_INFORMED_BOUND_HEADER_FILE
 
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/POMDP/SOSACache.hpp>
+#include <AIToolbox/POMDP/ModelContext.hpp>
 
 namespace AIToolbox::POMDP {
     /**
@@ -77,6 +80,11 @@ namespace AIToolbox::POMDP {
      *     Q(s,a) = R(s,a) + gamma * Sum_o max_a' Sum_s' P(s',o|s,a) * Q(s',a')
      *
      * Which is the update we're doing in the code.
+     *
+     * The terms of each action and observation are independent, so if a
+     * ThreadPool is set (see setThreadPool()) they are computed in
+     * parallel, and then summed in the same order as in the serial case.
+     * The results do not depend on the number of threads.
      */
     class FastInformedBound {
         public:
@@ -96,7 +104,7 @@ namespace AIToolbox::POMDP {
              * QMDP which can transform it into a VList, and from there into a
              * ValueFunction.
              *
-             * This method creates a SOSA matrix for the input model, and uses
+             * This method creates a SOSACache for the input model, and uses
              * it to create the bound.
              *
              * @param m The POMDP to be solved.
@@ -122,10 +130,11 @@ namespace AIToolbox::POMDP {
              * and don't need to recompute it, you can call this method
              * directly.
              *
-             * You can use both sparse and dense Matrix4D for this method.
+             * You can use both sparse and dense Matrix4D for this method, or
+             * a SOSACache shared with other algorithms.
              *
              * @param m The POMDP to be solved.
-             * @param sosa The SOSA matrix of the input POMDP.
+             * @param sosa The SOSA matrix of the input POMDP, or its SOSACache.
              * @param oldQ The QFunction to start iterating from.
              *
              * @return A tuple containing the maximum variation for the
@@ -134,6 +143,25 @@ namespace AIToolbox::POMDP {
             template <typename M, typename SOSA, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, MDP::QFunction> operator()(const M & m, const SOSA & sosa, MDP::QFunction oldQ = {});
 
+            /**
+             * @brief This function computes the Fast Informed Bound for the input POMDP, reusing a ModelContext.
+             *
+             * Both the SOSA matrices and the immediate rewards of the
+             * model are taken from the input context.
+             *
+             * This function throws std::invalid_argument if the context
+             * does not match the size of the model.
+             *
+             * @param m The POMDP to be solved.
+             * @param context The ModelContext of the input POMDP.
+             * @param oldQ The QFunction to start iterating from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         QFunction and the computed QFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, MDP::QFunction> operator()(const M & m, const ModelContext & context, MDP::QFunction oldQ = {});
+
             /**
              * @brief This function sets the tolerance parameter.
              *
@@ -156,6 +184,17 @@ namespace AIToolbox::POMDP {
              */
             void setHorizon(unsigned h);
 
+            /**
+             * @brief This function sets the ThreadPool to use to compute the bound in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function returns the currently set tolerance parameter.
              *
@@ -170,14 +209,28 @@ namespace AIToolbox::POMDP {
              */
             unsigned getHorizon() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
+            /**
+             * @brief This function computes the Fast Informed Bound given the SOSA matrices and immediate rewards.
+             */
+            template <typename M, typename SOSA, typename IR>
+            std::tuple<double, MDP::QFunction> solve(const M & m, const SOSA & sosa, const IR & ir, MDP::QFunction oldQ);
+
             size_t horizon_;
             double tolerance_;
+            ThreadPool * pool_;
     };
 
     template <typename M, typename>
     std::tuple<double, MDP::QFunction> FastInformedBound::operator()(const M & m, const MDP::QFunction & oldQ) {
-        return operator()(m, makeSOSA(m), oldQ);
+        return operator()(m, SOSACache(m), oldQ);
     }
 
     template <typename M, typename SOSA, typename>
@@ -186,6 +239,19 @@ namespace AIToolbox::POMDP {
             if constexpr (is_model_eigen_v<M>) return m.getRewardFunction();
             else return computeImmediateRewards(m);
         }();
+        return solve(m, sosa, ir, std::move(oldQ));
+    }
+
+    template <typename M, typename>
+    std::tuple<double, MDP::QFunction> FastInformedBound::operator()(const M & m, const ModelContext & context, MDP::QFunction oldQ) {
+        if ( context.getS() != m.getS() || context.getA() != m.getA() || context.getO() != m.getO() )
+            throw std::invalid_argument("The ModelContext does not match the model.");
+
+        return solve(m, context.getSOSA(), context.getImmediateRewards(), std::move(oldQ));
+    }
+
+    template <typename M, typename SOSA, typename IR>
+    std::tuple<double, MDP::QFunction> FastInformedBound::solve(const M & m, const SOSA & sosa, const IR & ir, MDP::QFunction oldQ) {
         auto newQ = MDP::QFunction(m.getS(), m.getA());
 
         if (oldQ.size() == 0) {
@@ -204,6 +270,19 @@ namespace AIToolbox::POMDP {
             oldQ.fill(max / std::max(0.0001, 1.0 - m.getDiscount()));
         }
 
+        // Sum_s' P(s',o|s,a) * Q(s',a'), maximized over a'.
+        const auto term = [&](const size_t a, const size_t o) -> Vector {
+            if constexpr (std::is_same_v<SOSA, SOSACache>)
+                return sosa.apply(a, o, [&](const auto & block) -> Vector { return (block * oldQ).rowwise().maxCoeff(); });
+            else
+                return (sosa[a][o] * oldQ).rowwise().maxCoeff();
+        };
+
+        const size_t A = m.getA(), O = m.getO();
+        // In parallel, the term of each (a,o) pair is stored in a row.
+        Matrix2D terms;
+        if ( pool_ ) terms.resize(A * O, m.getS());
+
         unsigned timestep = 0;
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
         double variation = tolerance_ * 2; // Make it bigger
@@ -211,9 +290,19 @@ namespace AIToolbox::POMDP {
             ++timestep;
             newQ.setZero();
             // Q(s,a) = R(s,a) + gamma * Sum_o max_a' Sum_s' P(s',o|s,a) * Q(s',a')
-            for (size_t a = 0; a < m.getA(); ++a)
-                for (size_t o = 0; o < m.getO(); ++o)
-                    newQ.col(a) += (sosa[a][o] * oldQ).rowwise().maxCoeff();
+            if ( pool_ ) {
+                pool_->parallelFor(A * O, [&](const size_t begin, const size_t end) {
+                    for ( size_t i = begin; i < end; ++i )
+                        terms.row(i) = term(i / O, i % O).transpose();
+                });
+                for (size_t a = 0; a < A; ++a)
+                    for (size_t o = 0; o < O; ++o)
+                        newQ.col(a) += terms.row(a * O + o).transpose();
+            } else {
+                for (size_t a = 0; a < A; ++a)
+                    for (size_t o = 0; o < O; ++o)
+                        newQ.col(a) += term(a, o);
+            }
             newQ *= m.getDiscount();
             newQ += ir;
 
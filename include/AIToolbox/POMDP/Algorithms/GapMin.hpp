@@ -2,22 +2,49 @@
 #define AI_TOOLBOX_POMDP_GAPMIN_HEADER_FILE
 
 #include <algorithm>
+#include <functional>
 
 #include <boost/heap/fibonacci_heap.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Utils/SolverControl.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SOSACache.hpp>
+#include <AIToolbox/POMDP/ModelContext.hpp>
 
 #include <AIToolbox/POMDP/Algorithms/BlindStrategies.hpp>
 #include <AIToolbox/POMDP/Algorithms/FastInformedBound.hpp>
 #include <AIToolbox/POMDP/Algorithms/PBVI.hpp>
 
 namespace AIToolbox::POMDP {
+    /**
+     * @brief This struct contains the state of a GapMin run between two iterations.
+     *
+     * A checkpoint contains both bounds: the lower bound VList with its
+     * supporting beliefs, and the upper bound QFunction with its
+     * belief-value pairs and their alphavectors. It can be stored with
+     * writeBinary(), and passed back to GapMin to continue the run from
+     * where it was taken.
+     */
+    struct GapMinCheckpoint {
+        unsigned iteration;
+        Belief initialBelief;
+        double lb, ub;
+        VList lbVList;
+        std::vector<Belief> lbBeliefs;
+        MDP::QFunction ubQ;
+        std::vector<Belief> ubBeliefs;
+        std::vector<double> ubValues;
+        // One row per state, and then one per upper bound belief.
+        Matrix2D fibQ;
+    };
+
     /**
      * @brief This class implements the GapMin algorithm.
      *
@@ -47,9 +74,35 @@ namespace AIToolbox::POMDP {
      * In order to act, the output lower bound should be used (as it's the only
      * one that gives an actual guarantee), but for this just using PBVI may be
      * more useful.
+     *
+     * The value of the upper bound at a belief is interpolated from the
+     * belief-value pairs, either exactly with an LP or with the faster but
+     * looser sawtooth approximation (see setInterpolation()). Many beliefs
+     * are evaluated at once, so if a ThreadPool is set (see
+     * setThreadPool()) their evaluations are run in parallel. The pool is
+     * also used by the FastInformedBound and PBVI solvers run internally.
+     *
+     * Long runs can be checkpointed with setCheckpointCallback(), and
+     * resumed from any checkpoint. Their progress (with the gap between
+     * the bounds at the initial belief) can be followed, and they can be
+     * cancelled, through SolverControl; cancelling also stops the
+     * internal PBVI solves.
      */
-    class GapMin {
+    class GapMin : public SolverControl {
         public:
+            using CheckpointCallback = std::function<void(const GapMinCheckpoint &)>;
+
+            /**
+             * @brief This enum represents how the upper bound is interpolated between belief-value pairs.
+             *
+             * - LP: an LP per belief finds the lowest interpolation of all
+             *   compatible belief-value pairs.
+             * - Sawtooth: each compatible belief-value pair is interpolated
+             *   with the corners on its own, and the lowest is taken. This
+             *   needs no LP, but gives a looser bound.
+             */
+            enum class Interpolation { LP, Sawtooth };
+
             /**
              * @brief Basic constructor.
              *
@@ -122,6 +175,62 @@ namespace AIToolbox::POMDP {
              */
             unsigned getPrecisionDigits() const;
 
+            /**
+             * @brief This function sets how the upper bound is interpolated between belief-value pairs.
+             *
+             * The sawtooth interpolation is still a valid upper bound, but
+             * since it is looser GapMin may need more iterations, or stop
+             * with a larger gap.
+             *
+             * @param interpolation The new interpolation.
+             */
+            void setInterpolation(Interpolation interpolation);
+
+            /**
+             * @brief This function returns the currently set interpolation.
+             *
+             * @return The currently set interpolation.
+             */
+            Interpolation getInterpolation() const;
+
+            /**
+             * @brief This function sets the ThreadPool used by GapMin and its internal solvers.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function sets the callback that receives checkpoints.
+             *
+             * The callback is called at the end of every interval
+             * iterations that do not terminate the run, with the state
+             * needed to resume it. An empty callback (the default)
+             * disables checkpointing.
+             *
+             * @param callback The function to call with each checkpoint.
+             * @param interval The number of iterations between checkpoints; must be > 0.
+             */
+            void setCheckpointCallback(CheckpointCallback callback, unsigned interval = 1);
+
+            /**
+             * @brief This function returns the number of iterations between checkpoints.
+             *
+             * @return The currently set checkpoint interval.
+             */
+            unsigned getCheckpointInterval() const;
+
             /**
              * @brief This function efficiently computes bounds for the optimal value of the input belief for the input POMDP.
              *
@@ -133,6 +242,44 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, double, VList, MDP::QFunction> operator()(const M & model, const Belief & initialBelief);
 
+            /**
+             * @brief This function computes bounds for the input belief, reusing a ModelContext.
+             *
+             * The SOSA matrices and immediate rewards used by GapMin and its
+             * internal BlindStrategies and FastInformedBound runs are taken
+             * from the input context, so they are computed only once across
+             * multiple calls, or across different algorithms sharing the
+             * context.
+             *
+             * This function throws std::invalid_argument if the context
+             * does not match the size of the model.
+             *
+             * @param model The model to compute the gap for.
+             * @param initialBelief The belief to compute the gap for.
+             * @param context The ModelContext of the input model.
+             *
+             * @return The lower and upper gap bounds, the lower bound VList, and the upper bound QFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, double, VList, MDP::QFunction> operator()(const M & model, const Belief & initialBelief, const ModelContext & context);
+
+            /**
+             * @brief This function resumes computing the bounds from a checkpoint.
+             *
+             * The run continues with the bounds of the checkpoint, for its
+             * initial belief, and with the currently set parameters.
+             *
+             * This function throws an std::invalid_argument if the
+             * checkpoint is not consistent with the model.
+             *
+             * @param model The model to compute the gap for.
+             * @param checkpoint The checkpoint to resume from.
+             *
+             * @return The lower and upper gap bounds, the lower bound VList, and the upper bound QFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, double, VList, MDP::QFunction> operator()(const M & model, const GapMinCheckpoint & checkpoint);
+
         private:
             using UbVType = std::pair<std::vector<Belief>, std::vector<double>>;
             using IntermediatePOMDP = Model<MDP::Model>;
@@ -146,6 +293,18 @@ namespace AIToolbox::POMDP {
 
             using QueueType = boost::heap::fibonacci_heap<QueueElement, boost::heap::compare<QueueElementLess>>;
 
+            /**
+             * @brief This function refines the bounds contained in the input checkpoint until convergence.
+             *
+             * @param model The model to compute the gap for.
+             * @param sosa The SOSACache of the model.
+             * @param state The bounds to start from.
+             *
+             * @return The lower and upper gap bounds, the lower bound VList, and the upper bound QFunction.
+             */
+            template <typename M>
+            std::tuple<double, double, VList, MDP::QFunction> solve(const M & model, const SOSACache & sosa, GapMinCheckpoint state);
+
             /**
              * @brief This function collects beliefs in order to reduce the gap.
              *
@@ -191,13 +350,14 @@ namespace AIToolbox::POMDP {
              * the upper bound of the input.
              *
              * @param model The POMDP model to look beliefs for.
+             * @param sosa The SOSACache of the model.
              * @param ubQ The QFunction containing the upper bound.
              * @param ubV The belief-value pairs for the upper bound.
              *
              * @return A pair with a reward-function only POMDP, and its associated SOSA matrix.
              */
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
-            std::tuple<IntermediatePOMDP, SparseMatrix4D> makeNewPomdp(const M& model, const MDP::QFunction & ubQ, const UbVType & ubV);
+            std::tuple<IntermediatePOMDP, SparseMatrix4D> makeNewPomdp(const M& model, const SOSACache & sosa, const MDP::QFunction & ubQ, const UbVType & ubV);
 
             /**
              * @brief This function obtains the best action with respect to the input QFunction and UbV.
@@ -251,15 +411,41 @@ namespace AIToolbox::POMDP {
              *
              * @return The value of the belief, and a vector containing the proportion in which each belief contributes to the upper bound.
              */
-            std::tuple<double, Vector> UB(const Belief & belief, const MDP::QFunction & ubQ, const UbVType & ubV);
+            std::tuple<double, Vector> UB(const Belief & belief, const MDP::QFunction & ubQ, const UbVType & ubV) const;
+
+            /**
+             * @brief This function computes the upper bound of multiple beliefs.
+             *
+             * This function is equivalent to calling UB() for each belief,
+             * but runs the calls in parallel if a ThreadPool is set.
+             *
+             * @param beliefs The beliefs to compute the upper bound of.
+             * @param ubQ The current QFunction.
+             * @param ubV The current belief-value pairs.
+             *
+             * @return The values and proportions of each belief, in order.
+             */
+            std::vector<std::tuple<double, Vector>> UB(const std::vector<Belief> & beliefs, const MDP::QFunction & ubQ, const UbVType & ubV) const;
 
             double tolerance_;
             double initialTolerance_;
             unsigned precisionDigits_;
+            Interpolation interpolation_;
+            ThreadPool * pool_;
+            CheckpointCallback checkpoint_;
+            unsigned checkpointInterval_;
     };
 
     template <typename M, typename>
     std::tuple<double, double, VList, MDP::QFunction> GapMin::operator()(const M & pomdp, const Belief & initialBelief) {
+        return operator()(pomdp, initialBelief, ModelContext(pomdp));
+    }
+
+    template <typename M, typename>
+    std::tuple<double, double, VList, MDP::QFunction> GapMin::operator()(const M & pomdp, const Belief & initialBelief, const ModelContext & context) {
+        if ( context.getS() != pomdp.getS() || context.getA() != pomdp.getA() || context.getO() != pomdp.getO() )
+            throw std::invalid_argument("The ModelContext does not match the model.");
+
         constexpr unsigned infiniteHorizon = 1000000;
 
         // Reset tolerance to set parameter;
@@ -267,12 +453,17 @@ namespace AIToolbox::POMDP {
 
         // Helper methods
         BlindStrategies bs(infiniteHorizon, tolerance_);
+        bs.setThreadPool(pool_);
         FastInformedBound fib(infiniteHorizon, tolerance_);
-        PBVI pbvi(0, infiniteHorizon, tolerance_);
+        fib.setThreadPool(pool_);
+
+        // The SOSA matrices of the model are used by most of the steps
+        // below, so we take them from the context.
+        const auto & sosa = context.getSOSA();
 
         // Here we use the BlindStrategies in order to obtain a very simple
         // initial lower bound.
-        VList lbVList = std::get<1>(bs(pomdp, true));
+        VList lbVList = std::get<1>(bs(pomdp, true, context));
         {
             const auto rbegin = boost::make_transform_iterator(std::begin(lbVList), unwrap);
             const auto rend   = boost::make_transform_iterator(std::end  (lbVList), unwrap);
@@ -282,7 +473,7 @@ namespace AIToolbox::POMDP {
         auto lbBeliefs = std::vector<Belief>{initialBelief};
 
         // The same we do here with FIB for the input POMDP.
-        MDP::QFunction ubQ = std::get<1>(fib(pomdp));
+        MDP::QFunction ubQ = std::get<1>(fib(pomdp, context));
         AI_LOGGER(AI_SEVERITY_DEBUG, "Initial QFunction:\n" << ubQ);
 
         // At the same time, we start initializing fibQ, which will be our
@@ -318,7 +509,56 @@ namespace AIToolbox::POMDP {
 
         AI_LOGGER(AI_SEVERITY_INFO, "Initial bounds: " << lb << ", " << ub);
 
-        while (true) {
+        return solve(pomdp, sosa, GapMinCheckpoint{
+            0, initialBelief, lb, ub,
+            std::move(lbVList), std::move(lbBeliefs),
+            std::move(ubQ), std::move(ubV.first), std::move(ubV.second), std::move(fibQ)
+        });
+    }
+
+    template <typename M, typename>
+    std::tuple<double, double, VList, MDP::QFunction> GapMin::operator()(const M & pomdp, const GapMinCheckpoint & c) {
+        const size_t S = pomdp.getS(), A = pomdp.getA();
+
+        const auto wrongSize = [S](const auto & b) { return static_cast<size_t>(b.size()) != S; };
+        if ( wrongSize(c.initialBelief) || c.lbVList.empty() || wrongSize(c.lbVList[0].values) ||
+             std::any_of(std::begin(c.lbBeliefs), std::end(c.lbBeliefs), wrongSize) ||
+             std::any_of(std::begin(c.ubBeliefs), std::end(c.ubBeliefs), wrongSize) ||
+             c.ubBeliefs.empty() || c.ubBeliefs.size() != c.ubValues.size() ||
+             static_cast<size_t>(c.ubQ.rows()) != S || static_cast<size_t>(c.ubQ.cols()) != A ||
+             static_cast<size_t>(c.fibQ.rows()) != S + c.ubBeliefs.size() || static_cast<size_t>(c.fibQ.cols()) != A )
+            throw std::invalid_argument("The checkpoint is not consistent with the model.");
+
+        const SOSACache sosa(pomdp);
+        return solve(pomdp, sosa, c);
+    }
+
+    template <typename M>
+    std::tuple<double, double, VList, MDP::QFunction> GapMin::solve(const M & pomdp, const SOSACache & sosa, GapMinCheckpoint state) {
+        constexpr unsigned infiniteHorizon = 1000000;
+
+        // Reset tolerance to set parameter;
+        tolerance_ = initialTolerance_;
+
+        // Helper methods
+        FastInformedBound fib(infiniteHorizon, tolerance_);
+        PBVI pbvi(0, infiniteHorizon, tolerance_);
+        fib.setThreadPool(pool_);
+        pbvi.setThreadPool(pool_);
+        // So that cancellations also stop the lower bound solves.
+        pbvi.setCancellationToken(getCancellationToken());
+
+        const auto & initialBelief = state.initialBelief;
+        auto & lbVList = state.lbVList;
+        auto & lbBeliefs = state.lbBeliefs;
+        auto & ubQ = state.ubQ;
+        auto & fibQ = state.fibQ;
+        auto & lb = state.lb;
+        auto & ub = state.ub;
+        UbVType ubV{std::move(state.ubBeliefs), std::move(state.ubValues)};
+
+        startProgress();
+        while (!isCancelled()) {
             double threshold = std::pow(10, std::ceil(std::log10(std::max(std::fabs(ub), std::fabs(lb))))-precisionDigits_);
             auto var = ub - lb;
 
@@ -344,7 +584,7 @@ namespace AIToolbox::POMDP {
                 {
                     // Then we remove all beliefs which don't actively support any
                     // alphaVectors.
-                    auto sol = pbvi(pomdp, lbBeliefs, ValueFunction{std::move(lbVList)});
+                    auto sol = pbvi(pomdp, lbBeliefs, ValueFunction{std::move(lbVList)}, &sosa);
 
                     lbVList = std::move(std::get<1>(sol).back());
 
@@ -354,7 +594,7 @@ namespace AIToolbox::POMDP {
                     lbBeliefs.erase(
                         extractBestUsefulPoints(
                             std::begin(lbBeliefs), std::end(lbBeliefs),
-                            rbegin, rend
+                            rbegin, rend, pool_
                         ),
                         std::end(lbBeliefs)
                     );
@@ -385,7 +625,7 @@ namespace AIToolbox::POMDP {
                 }
 
                 // We create a new POMDP where each state is a belief.
-                auto [newPOMDP, newPOMDPSOSA] = makeNewPomdp(pomdp, ubQ, ubV);
+                auto [newPOMDP, newPOMDPSOSA] = makeNewPomdp(pomdp, sosa, ubQ, ubV);
                 // And we approximate its upper bound.
                 fibQ = std::get<1>(fib(newPOMDP, newPOMDPSOSA, std::move(fibQ)));
                 // We extract from the found upper bound the part for the
@@ -411,12 +651,18 @@ namespace AIToolbox::POMDP {
             // Stop if we didn't find anything new, or if we have converged the bounds.
             if (newLbBeliefsSize + newUbBeliefsSize == 0 || std::fabs(var - oldVar) < tolerance_ * 5)
                 break;
+
+            ++state.iteration;
+            if (checkpoint_ && state.iteration % checkpointInterval_ == 0)
+                checkpoint_(GapMinCheckpoint{state.iteration, initialBelief, lb, ub, lbVList, lbBeliefs, ubQ, ubV.first, ubV.second, fibQ});
+
+            reportProgress(state.iteration, var, lbVList.size());
         }
         return std::make_tuple(lb, ub, lbVList, ubQ);
     }
 
     template <typename M, typename>
-    std::tuple<GapMin::IntermediatePOMDP, SparseMatrix4D> GapMin::makeNewPomdp(const M& model, const MDP::QFunction & ubQ, const UbVType & ubV) {
+    std::tuple<GapMin::IntermediatePOMDP, SparseMatrix4D> GapMin::makeNewPomdp(const M& model, const SOSACache & sosa, const MDP::QFunction & ubQ, const UbVType & ubV) {
         size_t S = model.getS() + ubV.first.size();
 
         // First we build the new reward function. For normal states, this is
@@ -439,40 +685,54 @@ namespace AIToolbox::POMDP {
         //
         // This is done through the UB function, although I must admit I don't
         // fully understand the math behind of why it works.
-        Belief helper(model.getS()), corner(model.getS());
-        corner.setZero();
-
-        SparseMatrix4D sosa( boost::extents[model.getA()][model.getO()] );
-        const auto updateMatrix = [&](SparseMatrix2D & m, const Belief & b, size_t a, size_t o, size_t index) {
-            updateBeliefUnnormalized(model, b, a, o, &helper);
+        //
+        // The unnormalized updates of the beliefs are read from the SOSA
+        // matrices of the model: each corner update is just one of their
+        // rows. The updates of each action/observation pair are bounded
+        // together, so that their UBs can be run in parallel.
+        std::vector<Belief> helpers;
+        std::vector<size_t> indeces;
+        helpers.reserve(S);
+        indeces.reserve(S);
+
+        SparseMatrix4D newSosa( boost::extents[model.getA()][model.getO()] );
+        const auto addHelper = [&](Belief helper, size_t index) {
             auto sum = helper.sum();
             if (checkDifferentSmall(sum, 0.0)) {
                 // Note that we do not normalize helper since we'd also have to
                 // multiply `dist` by the same probability. Instead we don't
                 // normalize, and we don't multiply, so we save some work.
-                Vector dist = std::get<1>(UB(helper, ubQ, ubV));
-                for (size_t i = 0; i < S; ++i)
-                    if (checkDifferentSmall(dist[i], 0.0))
-                        m.insert(index, i) = dist[i];
+                helpers.emplace_back(std::move(helper));
+                indeces.push_back(index);
             }
         };
 
         for (size_t a = 0; a < model.getA(); ++a) {
             for (size_t o = 0; o < model.getO(); ++o) {
+                helpers.clear();
+                indeces.clear();
+                sosa.apply(a, o, [&](const auto & block) {
+                    for (size_t s = 0; s < model.getS(); ++s)
+                        addHelper(block.row(s).transpose(), s);
+
+                    for (size_t b = 0; b < ubV.first.size(); ++b)
+                        addHelper((ubV.first[b].transpose() * block).transpose(), model.getS() + b);
+                });
+
+                const auto ubs = UB(helpers, ubQ, ubV);
+
                 SparseMatrix2D m(S, S);
-                for (size_t s = 0; s < model.getS(); ++s) {
-                    corner[s] = 1.0;
-                    updateMatrix(m, corner, a, o, s);
-                    corner[s] = 0.0;
+                for (size_t h = 0; h < helpers.size(); ++h) {
+                    const auto & dist = std::get<1>(ubs[h]);
+                    for (size_t i = 0; i < S; ++i)
+                        if (checkDifferentSmall(dist[i], 0.0))
+                            m.insert(indeces[h], i) = dist[i];
                 }
 
-                for (size_t b = 0; b < ubV.first.size(); ++b)
-                    updateMatrix(m, ubV.first[b], a, o, model.getS() + b);
-
                 // After updating all rows of the matrix, we put it inside the
                 // SOSA matrix.
-                sosa[a][o] = std::move(m);
-                sosa[a][o].makeCompressed();
+                newSosa[a][o] = std::move(m);
+                newSosa[a][o].makeCompressed();
             }
         }
 
@@ -486,7 +746,7 @@ namespace AIToolbox::POMDP {
                 NO_CHECK, model.getO(), Matrix3D(),
                 NO_CHECK, S, model.getA(), Matrix3D(), std::move(R), model.getDiscount()
             ),
-            std::move(sosa)
+            std::move(newSosa)
         );
     }
 
@@ -508,7 +768,7 @@ namespace AIToolbox::POMDP {
      * @return The best action in the input belief with respect to the input VList.
      */
     template <typename M, typename = std::enable_if_t<is_model_v<M>>>
-    std::tuple<size_t, double> bestConservativeAction(const M & pomdp, const Belief & initialBelief, const VList & lbVList) {
+    std::tuple<size_t, double> bestConservativeAction(const M & pomdp, const Belief & initialBelief, const PackedVList & lbVList) {
         MDP::QFunction ir = [&]{
             if constexpr (MDP::is_model_eigen_v<M>)
                 return pomdp.getRewardFunction();
@@ -530,11 +790,9 @@ namespace AIToolbox::POMDP {
                 // Now normalized
                 nextBelief /= nextBeliefProbability;
 
-                const auto rbegin = boost::make_transform_iterator(std::begin(lbVList), unwrap);
-                const auto rend   = boost::make_transform_iterator(std::end  (lbVList), unwrap);
-                auto it = findBestAtPoint(nextBelief, rbegin, rend).base();
+                const auto best = lbVList.findBestAtBelief(nextBelief);
 
-                bpAlpha += pomdp.getObservationFunction(a).col(o).cwiseProduct(it->values);
+                bpAlpha += pomdp.getObservationFunction(a).col(o).cwiseProduct(lbVList.getValues(best).transpose());
             }
             ir.col(a) += pomdp.getDiscount() * pomdp.getTransitionFunction(a) * bpAlpha;
         }
@@ -554,9 +812,15 @@ namespace AIToolbox::POMDP {
                 return computeImmediateRewards(pomdp);
         }();
 
+        // We first collect all reachable beliefs, so that their UBs can be
+        // run in parallel.
+        std::vector<Belief> nextBeliefs;
+        std::vector<size_t> actions;
+        nextBeliefs.reserve(pomdp.getA() * pomdp.getO());
+        actions.reserve(pomdp.getA() * pomdp.getO());
+
         for (size_t a = 0; a < pomdp.getA(); ++a) {
             const Belief intermediateBelief = updateBeliefPartial(pomdp, belief, a);
-            double sum = 0.0;
             for (size_t o = 0; o < pomdp.getO(); ++o) {
                 Belief nextBelief = updateBeliefPartialUnnormalized(pomdp, intermediateBelief, a, o);
 
@@ -566,10 +830,18 @@ namespace AIToolbox::POMDP {
                 // have to multiply the result by the same probability. Instead
                 // we don't normalize, and we don't multiply, so we save some
                 // work.
-                sum += std::get<0>(UB(nextBelief, ubQ, ubV));
+                nextBeliefs.emplace_back(std::move(nextBelief));
+                actions.push_back(a);
             }
-            qvals[a] += pomdp.getDiscount() * sum;
         }
+
+        // The values are summed in order, as in the serial loop.
+        const auto ubs = UB(nextBeliefs, ubQ, ubV);
+        Vector sums = Vector::Zero(pomdp.getA());
+        for (size_t i = 0; i < ubs.size(); ++i)
+            sums[actions[i]] += std::get<0>(ubs[i]);
+        qvals += pomdp.getDiscount() * sums;
+
         size_t bestAction;
         double bestValue = qvals.maxCoeff(&bestAction);
 
@@ -595,12 +867,13 @@ namespace AIToolbox::POMDP {
         // From the original code, a limitation on how many new beliefs we find.
         const auto maxNewBeliefs = std::max(20lu, (ubV.first.size() + lbVList.size()) / 5lu);
 
+        // We pack the lower bound, since we search it for many beliefs.
+        const PackedVList lbPacked(pomdp.getS(), lbVList);
+
         // We initialize the queue with the initial belief.
         {
             double currentLowerBound;
-            const auto rbegin = boost::make_transform_iterator(std::begin(lbVList), unwrap);
-            const auto rend   = boost::make_transform_iterator(std::end  (lbVList), unwrap);
-            findBestAtPoint(initialBelief, rbegin, rend, &currentLowerBound);
+            lbPacked.findBestAtBelief(initialBelief, &currentLowerBound);
             const double currentUpperBound = std::get<0>(UB(initialBelief, ubQ, ubV));
             queue.emplace(QueueElement(initialBelief, 0.0, 1.0, currentLowerBound, currentUpperBound, 1, {}));
         }
@@ -631,7 +904,7 @@ namespace AIToolbox::POMDP {
             // (the belief updates step), but it seems that doing so actually
             // slows the code down - probably cache problems.
             const auto [ubAction, ubActionValue] = bestPromisingAction(pomdp, belief, ubQ, ubV);
-            const auto [lbAction, lbActionValue] = bestConservativeAction(pomdp, belief, lbVList);
+            const auto [lbAction, lbActionValue] = bestConservativeAction(pomdp, belief, lbPacked);
 
             (void)lbAction; // ignore lbAction
 
@@ -666,12 +939,14 @@ namespace AIToolbox::POMDP {
 
                 // Find all beliefs that brought us here we didn't already have.
                 // Again, we don't consider corners.
-                for (const auto & p : path) {
-                    if (validForUb(p)) {
+                const auto first = newUbBeliefs.size();
+                for (const auto & p : path)
+                    if (validForUb(p))
                         newUbBeliefs.push_back(p);
-                        newUbValues.push_back(std::get<0>(UB(p, ubQ, ubV)));
-                    }
-                }
+
+                const std::vector<Belief> pathBeliefs(std::begin(newUbBeliefs) + first, std::end(newUbBeliefs));
+                for (const auto & ubp : UB(pathBeliefs, ubQ, ubV))
+                    newUbValues.push_back(std::get<0>(ubp));
                 // Note we only count a single belief even if we added more via
                 // the path (as per original code).
                 ++newBeliefs;
@@ -727,7 +1002,11 @@ namespace AIToolbox::POMDP {
 
             // For each new possible belief, we look if we've already visited
             // it. If not, we compute the gap at that point, and we add it to
-            // the queue.
+            // the queue. The UBs of all new beliefs are computed first, so
+            // that they can be run in parallel.
+            std::vector<Belief> nextBeliefs;
+            std::vector<double> nextBeliefProbabilities;
+
             const Belief intermediateBelief = updateBeliefPartial(pomdp, belief, ubAction);
             for (size_t o = 0; o < pomdp.getO(); ++o) {
                 Belief nextBelief = updateBeliefPartialUnnormalized(pomdp, intermediateBelief, ubAction, o);
@@ -740,13 +1019,18 @@ namespace AIToolbox::POMDP {
                 auto it = std::find_if(std::begin(visitedBeliefs), std::end(visitedBeliefs), check);
                 if (it != std::end(visitedBeliefs)) continue;
 
-                const double ubValue = std::get<0>(UB(nextBelief, ubQ, ubV));
+                nextBeliefs.emplace_back(std::move(nextBelief));
+                nextBeliefProbabilities.push_back(nextBeliefProbability);
+            }
+
+            const auto ubs = UB(nextBeliefs, ubQ, ubV);
+            for (size_t i = 0; i < nextBeliefs.size(); ++i) {
+                auto & nextBelief = nextBeliefs[i];
+                const auto nextBeliefProbability = nextBeliefProbabilities[i];
+
+                const double ubValue = std::get<0>(ubs[i]);
                 double lbValue;
-                {
-                    const auto rbegin = boost::make_transform_iterator(std::begin(lbVList), unwrap);
-                    const auto rend   = boost::make_transform_iterator(std::end  (lbVList), unwrap);
-                    findBestAtPoint(nextBelief, rbegin, rend, &lbValue);
-                }
+                lbPacked.findBestAtBelief(nextBelief, &lbValue);
 
                 if ((ubValue - lbValue) * std::pow(pomdp.getDiscount(), depth) > tolerance_ * 20) {
                     const auto nextBeliefOverallProbability = nextBeliefProbability * beliefProbability * pomdp.getDiscount();
@@ -1,18 +1,33 @@
 #ifndef AI_TOOLBOX_POMDP_INCREMENTAL_PRUNING_HEADER_FILE
 #define AI_TOOLBOX_POMDP_INCREMENTAL_PRUNING_HEADER_FILE
 
+#include <functional>
 #include <limits>
 
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Utils/Prune.hpp>
+#include <AIToolbox/Utils/SolverControl.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
 #include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
 
 namespace AIToolbox::POMDP {
+    /**
+     * @brief This struct contains the state of an IncrementalPruning run between two timesteps.
+     *
+     * A checkpoint can be stored with writeBinary(), and passed back to
+     * IncrementalPruning to continue the run from where it was taken.
+     */
+    struct IncrementalPruningCheckpoint {
+        unsigned timestep;
+        double variation;
+        ValueFunction v;
+    };
+
     /**
      * @brief This class implements the Incremental Pruning algorithm.
      *
@@ -42,9 +57,22 @@ namespace AIToolbox::POMDP {
      * of code and managing memory by ourselves, we use its API. It would
      * be nice if one day we could port directly into the code a fast lp
      * implementation; for now we do what we can.
+     *
+     * The projections of each action are cross-summed and pruned
+     * independently from the others, until all actions are merged at the
+     * end of each timestep. If a ThreadPool is set (see setThreadPool()),
+     * the actions are split between its threads, each with its own
+     * Pruner (and thus its own linear programming instance). The results
+     * do not depend on the number of threads.
+     *
+     * Long runs can be checkpointed with setCheckpointCallback(), and
+     * resumed from any checkpoint. Their progress can be followed, and
+     * they can be cancelled, through SolverControl.
      */
-    class IncrementalPruning {
+    class IncrementalPruning : public SolverControl {
         public:
+            using CheckpointCallback = std::function<void(const IncrementalPruningCheckpoint &)>;
+
             /**
              * @brief Basic constructor.
              *
@@ -85,6 +113,29 @@ namespace AIToolbox::POMDP {
              */
             void setHorizon(unsigned h);
 
+            /**
+             * @brief This function sets the ThreadPool to use to process actions in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function sets the callback that receives checkpoints.
+             *
+             * The callback is called at the end of every interval
+             * timesteps, with the state needed to resume the run. An empty
+             * callback (the default) disables checkpointing.
+             *
+             * @param callback The function to call with each checkpoint.
+             * @param interval The number of timesteps between checkpoints; must be > 0.
+             */
+            void setCheckpointCallback(CheckpointCallback callback, unsigned interval = 1);
+
             /**
              * @brief This function will return the currently set tolerance parameter.
              *
@@ -99,6 +150,20 @@ namespace AIToolbox::POMDP {
              */
             unsigned getHorizon() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function returns the number of timesteps between checkpoints.
+             *
+             * @return The currently set checkpoint interval.
+             */
+            unsigned getCheckpointInterval() const;
+
             /**
              * @brief This function solves a POMDP::Model completely.
              *
@@ -118,9 +183,56 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction> operator()(const M & model);
 
+            /**
+             * @brief This function solves a POMDP::Model starting from an initial VList.
+             *
+             * The initial VList is used in place of the horizon 0
+             * solution, and the solver performs up to horizon more
+             * backups from it. Starting from a solution to a shorter
+             * horizon, or to a slightly different model, can save most of
+             * the iterations needed to converge. To continue from a whole
+             * ValueFunction, pass its last VList.
+             *
+             * Only the values of the initial VEntries are used.
+             *
+             * This function throws an std::invalid_argument if the VList
+             * is empty, or its values do not match the model.
+             *
+             * @tparam M The type of POMDP model that needs to be solved.
+             *
+             * @param model The POMDP model that needs to be solved.
+             * @param initial The VList to start from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction and the computed ValueFunction, whose
+             *         first element is the initial VList.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction> operator()(const M & model, const VList & initial);
+
+            /**
+             * @brief This function resumes solving a POMDP::Model from a checkpoint.
+             *
+             * The run continues from the timestep of the checkpoint, with
+             * the currently set parameters.
+             *
+             * This function throws an std::invalid_argument if the
+             * checkpoint is not consistent with the model.
+             *
+             * @tparam M The type of POMDP model that needs to be solved.
+             *
+             * @param model The POMDP model that needs to be solved.
+             * @param checkpoint The checkpoint to resume from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction and the computed ValueFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction> operator()(const M & model, const IncrementalPruningCheckpoint & checkpoint);
+
         private:
             /**
-             * @brief This function computes a VList composed of all possible combinations of sums of the VLists provided.
+             * @brief This function computes the pruned VList of all possible combinations of sums of the VLists provided.
              *
              * This function performs the job of accumulating the
              * information required to obtain the final policy. Cross-sums
@@ -130,38 +242,83 @@ namespace AIToolbox::POMDP {
              * second one. This parameter is needed due to the order in
              * which we cross-sum all vectors.
              *
+             * Most of the cross-sums are discarded by the prune, so they
+             * are not created as VEntries. Their values are written as the
+             * rows of the input arena, which is only grown when needed
+             * and so is reused between calls, and the prune only moves
+             * their indices. Only the surviving entries are then built,
+             * in the same order as if all of them had been.
+             *
              * @param l1 The "main" parent list.
              * @param l2 The list being cross-summed to l1.
              * @param a The action that this cross-sum is about.
              * @param order Which list comes before the other to merge
              *              observations. True for the first, false otherwise.
+             * @param prune The Pruner to use.
+             * @param arena The workspace for the values of all cross-sums.
              *
-             * @return The cross-sum between l1 and l2.
+             * @return The pruned cross-sum between l1 and l2.
              */
-            VList crossSum(const VList & l1, const VList & l2, size_t a, bool order);
+            VList crossSum(const VList & l1, const VList & l2, size_t a, bool order, Pruner & prune, Matrix2D & arena);
+
+            /**
+             * @brief This function prunes and cross-sums all projections of an action.
+             *
+             * The result is left in the first element of the input row.
+             *
+             * @param prune The Pruner to use.
+             * @param projs The projections of the action, one per observation.
+             * @param a The action that the projections are about.
+             */
+            template <typename Row>
+            void crossSumAction(Pruner & prune, Matrix2D & arena, Row && projs, size_t a);
 
             size_t S, A, O;
             unsigned horizon_;
             double tolerance_;
+            ThreadPool * pool_;
+            CheckpointCallback checkpoint_;
+            unsigned checkpointInterval_;
     };
 
     template <typename M, typename>
     std::tuple<double, ValueFunction> IncrementalPruning::operator()(const M & model) {
+        // Make the variation bigger so that we start.
+        return operator()(model, IncrementalPruningCheckpoint{0, tolerance_ * 2, makeValueFunction(model.getS())});
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction> IncrementalPruning::operator()(const M & model, const VList & initial) {
+        if ( initial.empty() )
+            throw std::invalid_argument("The initial VList must not be empty.");
+        for ( const auto & entry : initial )
+            if ( static_cast<size_t>(entry.values.size()) != model.getS() )
+                throw std::invalid_argument("The initial VList is not consistent with the model.");
+
+        return operator()(model, IncrementalPruningCheckpoint{0, tolerance_ * 2, ValueFunction{initial}});
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction> IncrementalPruning::operator()(const M & model, const IncrementalPruningCheckpoint & checkpoint) {
         // Initialize "global" variables
         S = model.getS();
         A = model.getA();
         O = model.getO();
 
-        auto v = makeValueFunction(S); // TODO: May take user input
+        if ( checkpoint.v.size() != checkpoint.timestep + 1 || !checkpoint.v.back().size() ||
+             static_cast<size_t>(checkpoint.v.back()[0].values.size()) != S )
+            throw std::invalid_argument("The checkpoint is not consistent with the model.");
 
-        unsigned timestep = 0;
+        auto v = checkpoint.v;
+        unsigned timestep = checkpoint.timestep;
 
         Pruner prune(S);
         Projecter projecter(model);
 
+        startProgress();
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
-        double variation = tolerance_ * 2; // Make it bigger
-        while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) ) {
+        double variation = checkpoint.variation;
+        while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) && !isCancelled() ) {
             ++timestep;
 
             // Compute all possible outcomes, from our previous results.
@@ -170,66 +327,23 @@ namespace AIToolbox::POMDP {
             // of entries in our initial vector w.
             auto projs = projecter(v[timestep-1]);
 
-            size_t finalWSize = 0;
             // In this method we split the work by action, which will then
-            // be joined again at the end of the loop.
-            for ( size_t a = 0; a < A; ++a ) {
-                // We prune each outcome separately to be sure
-                // we do not replicate work later.
-                for ( size_t o = 0; o < O; ++o ) {
-                    const auto begin = boost::make_transform_iterator(std::begin(projs[a][o]), unwrap);
-                    const auto end   = boost::make_transform_iterator(std::end  (projs[a][o]), unwrap);
-                    projs[a][o].erase(prune(begin, end).base(), std::end(projs[a][o]));
-                }
-
-                // Here we reduce at the minimum the cross-summing, by alternating
-                // merges. We pick matches like a reverse binary tree, so that
-                // we always pick lists that have been merged the least.
-                //
-                // Example for O==7:
-                //
-                //  0 <- 1    2 <- 3    4 <- 5    6
-                //  0 ------> 2         4 ------> 6
-                //            2 <---------------- 6
-                //
-                // In particular, the variables are:
-                //
-                // - oddOld:   Whether our starting step has an odd number of elements.
-                //             If so, we skip the last one.
-                // - front:    The id of the element at the "front" of our current pass.
-                //             note that since passes can be backwards this can be high.
-                // - back:     Opposite of front, which excludes the last element if we
-                //             have odd elements.
-                // - stepsize: The space between each "first" of each new merge.
-                // - diff:     The space between each "first" and its match to merge.
-                // - elements: The number of elements we have left to merge.
-
-                bool oddOld = O % 2;
-                int i, front = 0, back = O - oddOld, stepsize = 2, diff = 1, elements = O;
-                while ( elements > 1 ) {
-                    for ( i = front; i != back; i += stepsize ) {
-                        projs[a][i] = crossSum(projs[a][i], projs[a][i + diff], a, stepsize > 0);
-                        const auto begin = boost::make_transform_iterator(std::begin(projs[a][i]), unwrap);
-                        const auto end   = boost::make_transform_iterator(std::end  (projs[a][i]), unwrap);
-                        projs[a][i].erase(prune(begin, end).base(), std::end(projs[a][i]));
-                        --elements;
-                    }
-
-                    const bool oddNew = elements % 2;
-
-                    const int tmp   = back;
-                    back      = front - ( oddNew ? 0 : stepsize );
-                    front     = tmp   - ( oddOld ? 0 : stepsize );
-                    stepsize *= -2;
-                    diff     *= -2;
-
-                    oddOld = oddNew;
-                }
-                // Put the result where we can find it
-                if (front != 0)
-                    projs[a][0] = std::move(projs[a][front]);
+            // be joined again at the end of the loop. Each block of actions
+            // uses its own Pruner, as they cannot be shared between threads,
+            // and its own arena for the cross-sums, freed at the end.
+            const auto crossSumActions = [this, &projs](const size_t begin, const size_t end) {
+                Pruner prune(S);
+                Matrix2D arena;
+                for ( size_t a = begin; a < end; ++a )
+                    crossSumAction(prune, arena, projs[a], a);
+            };
+            if ( pool_ ) pool_->parallelFor(A, crossSumActions);
+            else         crossSumActions(0, A);
+
+            size_t finalWSize = 0;
+            for ( size_t a = 0; a < A; ++a )
                 finalWSize += projs[a][0].size();
-            }
+
             VList w;
             w.reserve(finalWSize);
 
@@ -247,11 +361,71 @@ namespace AIToolbox::POMDP {
 
             // Check convergence
             if ( useTolerance )
-                variation = weakBoundDistance(v[timestep-1], v[timestep]);
+                variation = weakBoundDistance(v[timestep-1], v[timestep], pool_);
+
+            if ( checkpoint_ && timestep % checkpointInterval_ == 0 )
+                checkpoint_(IncrementalPruningCheckpoint{timestep, variation, v});
+
+            reportProgress(timestep, variation, v.back().size());
         }
 
         return std::make_tuple(useTolerance ? variation : 0.0, v);
     }
+
+    template <typename Row>
+    void IncrementalPruning::crossSumAction(Pruner & prune, Matrix2D & arena, Row && projs, const size_t a) {
+        // We prune each outcome separately to be sure
+        // we do not replicate work later.
+        for ( size_t o = 0; o < O; ++o ) {
+            const auto begin = boost::make_transform_iterator(std::begin(projs[o]), unwrap);
+            const auto end   = boost::make_transform_iterator(std::end  (projs[o]), unwrap);
+            projs[o].erase(prune(begin, end).base(), std::end(projs[o]));
+        }
+
+        // Here we reduce at the minimum the cross-summing, by alternating
+        // merges. We pick matches like a reverse binary tree, so that
+        // we always pick lists that have been merged the least.
+        //
+        // Example for O==7:
+        //
+        //  0 <- 1    2 <- 3    4 <- 5    6
+        //  0 ------> 2         4 ------> 6
+        //            2 <---------------- 6
+        //
+        // In particular, the variables are:
+        //
+        // - oddOld:   Whether our starting step has an odd number of elements.
+        //             If so, we skip the last one.
+        // - front:    The id of the element at the "front" of our current pass.
+        //             note that since passes can be backwards this can be high.
+        // - back:     Opposite of front, which excludes the last element if we
+        //             have odd elements.
+        // - stepsize: The space between each "first" of each new merge.
+        // - diff:     The space between each "first" and its match to merge.
+        // - elements: The number of elements we have left to merge.
+
+        bool oddOld = O % 2;
+        int i, front = 0, back = O - oddOld, stepsize = 2, diff = 1, elements = O;
+        while ( elements > 1 ) {
+            for ( i = front; i != back; i += stepsize ) {
+                projs[i] = crossSum(projs[i], projs[i + diff], a, stepsize > 0, prune, arena);
+                --elements;
+            }
+
+            const bool oddNew = elements % 2;
+
+            const int tmp   = back;
+            back      = front - ( oddNew ? 0 : stepsize );
+            front     = tmp   - ( oddOld ? 0 : stepsize );
+            stepsize *= -2;
+            diff     *= -2;
+
+            oddOld = oddNew;
+        }
+        // Put the result where we can find it
+        if (front != 0)
+            projs[0] = std::move(projs[front]);
+    }
 }
 
 #endif
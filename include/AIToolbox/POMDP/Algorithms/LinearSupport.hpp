@@ -9,10 +9,10 @@
 #include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
 
 #include <unordered_set>
-#include <boost/iterator/transform_iterator.hpp>
 #include <boost/functional/hash.hpp>
 
 #include <AIToolbox/Utils/Polytope.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include <AIToolbox/Impl/Logging.hpp>
 
@@ -48,6 +48,15 @@ namespace AIToolbox::POMDP {
      * Even if there is limited time to compute the solution, the algorithm is
      * guaranteed to work in the areas with high error first, allowing one to
      * compute good approximations even without a lot of resources.
+     *
+     * The vertices of the surface are kept up to date incrementally with a
+     * VertexEnumerator, so that adding an alphavector only costs a
+     * polynomial in the number of current vertices, rather than an
+     * exponential in the number of states.
+     *
+     * If a ThreadPool is set (see setThreadPool()), the evaluation of the
+     * true value of each new vertex is split between its threads. The
+     * results do not depend on the number of threads.
      */
     class LinearSupport {
         public:
@@ -91,6 +100,17 @@ namespace AIToolbox::POMDP {
              */
             void setHorizon(unsigned h);
 
+            /**
+             * @brief This function sets the ThreadPool to use to evaluate vertices in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function will return the currently set tolerance parameter.
              *
@@ -105,6 +125,13 @@ namespace AIToolbox::POMDP {
              */
             unsigned getHorizon() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
             /**
              * @brief This function solves a POMDP::Model completely.
              *
@@ -123,9 +150,37 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction> operator()(const M & model);
 
+            /**
+             * @brief This function solves a POMDP::Model starting from an initial VList.
+             *
+             * The initial VList is used in place of the horizon 0
+             * solution, and the solver performs up to horizon more
+             * backups from it. Starting from a solution to a shorter
+             * horizon, or to a slightly different model, can save most of
+             * the iterations needed to converge. To continue from a whole
+             * ValueFunction, pass its last VList.
+             *
+             * Only the values of the initial VEntries are used.
+             *
+             * This function throws an std::invalid_argument if the VList
+             * is empty, or its values do not match the model.
+             *
+             * @tparam M The type of POMDP model that needs to be solved.
+             *
+             * @param model The POMDP model that needs to be solved.
+             * @param initial The VList to start from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction and the computed ValueFunction, whose
+             *         first element is the initial VList.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction> operator()(const M & model, const VList & initial);
+
         private:
             unsigned horizon_;
             double tolerance_;
+            ThreadPool * pool_;
 
             using SupportSet = std::unordered_set<VEntry, boost::hash<VEntry>>;
             struct Vertex;
@@ -148,11 +203,22 @@ namespace AIToolbox::POMDP {
     };
 
     template <typename M, typename>
-    std::tuple<double, ValueFunction> LinearSupport::operator()(const M& model) {
+    std::tuple<double, ValueFunction> LinearSupport::operator()(const M & model) {
+        return operator()(model, makeValueFunction(model.getS())[0]);
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction> LinearSupport::operator()(const M & model, const VList & initial) {
+        if ( initial.empty() )
+            throw std::invalid_argument("The initial VList must not be empty.");
+        for ( const auto & entry : initial )
+            if ( static_cast<size_t>(entry.values.size()) != model.getS() )
+                throw std::invalid_argument("The initial VList is not consistent with the model.");
+
         const auto S = model.getS();
 
         Projecter project(model);
-        auto v = makeValueFunction(S); // TODO: May take user input
+        auto v = ValueFunction{initial};
 
         unsigned timestep = 0;
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
@@ -175,6 +241,11 @@ namespace AIToolbox::POMDP {
             std::vector<std::pair<Belief, double>> vertices;
             std::unordered_set<Belief, boost::hash<Belief>> triedVertices;
 
+            // Buffers for the evaluation of new vertices.
+            std::vector<size_t> toEvaluate;
+            VList supports;
+            std::vector<double> trueValues, currentValues;
+
             // For each corner belief, find its value and alphavector. Add the
             // alphavectors in a separate list, remove duplicates. Note: In theory
             // we must be able to find all alphas for each corner, not just a
@@ -193,21 +264,10 @@ namespace AIToolbox::POMDP {
             // Now we find for all the alphavectors we have found, the vertices of
             // the polytope that they created. These vertices will bootstrap the
             // algorithm.
-            auto goodBegin = boost::make_transform_iterator(goodSupports.cbegin(), unwrap);
-            for (size_t i = 0; i < goodSupports.size(); ++i, ++goodBegin) {
-                // For each alpha, we find its vertices against the others.
-                IndexSkipMap map({i}, goodSupports);
-                const auto cbegin = boost::make_transform_iterator(map.cbegin(), unwrap);
-                const auto cend   = boost::make_transform_iterator(map.cend(), unwrap);
-
-                // Note that the range we pass here is made by a single vector.
-                auto newVertices = findVerticesNaive(goodBegin, goodBegin + 1, cbegin, cend);
-
-                vertices.insert(std::end(vertices),
-                        std::make_move_iterator(std::begin(newVertices)),
-                        std::make_move_iterator(std::end(newVertices))
-                );
-            }
+            VertexEnumerator enumerator(S);
+            for (const auto & support : goodSupports)
+                enumerator.addHyperplane(support.values);
+            vertices = enumerator.getVertices();
 
             do {
                 // For each corner, we find its true alphas and its best possible value.
@@ -215,34 +275,40 @@ namespace AIToolbox::POMDP {
                 // what we can do with the optimal alphas we already have.
                 // If the error is low enough, we don't need them. Otherwise we add
                 // them to the priority queue.
-                for (auto & vertex : vertices) {
-                    if (triedVertices.find(vertex.first) != std::end(triedVertices))
-                        continue;
-
-                    double trueValue;
-                    auto support = crossSumBestAtBelief(vertex.first, projections, &trueValue);
-
-                    double currentValue = vertex.second;
-                    // FIXME: As long as we use the naive way to find vertices,
-                    // we can't really trust the values that come out as they
-                    // may be lower than what we actually have. So we are
-                    // forced to recompute their value.
-                    const auto gsBegin = boost::make_transform_iterator(std::cbegin(goodSupports), unwrap);
-                    const auto gsEnd   = boost::make_transform_iterator(std::cend(goodSupports),   unwrap);
-                    findBestAtPoint(vertex.first, gsBegin, gsEnd, &currentValue);
-
-                    auto diff = trueValue - currentValue;
+                // We first select the vertices we have not seen yet, so that
+                // their values can be computed independently of each other.
+                toEvaluate.clear();
+                for (size_t i = 0; i < vertices.size(); ++i)
+                    if (triedVertices.insert(vertices[i].first).second)
+                        toEvaluate.push_back(i);
+
+                supports.resize(toEvaluate.size());
+                trueValues.resize(toEvaluate.size());
+                currentValues.resize(toEvaluate.size());
+
+                // The values of the vertices are the ones of the whole
+                // current surface, so we only need their true values.
+                const auto evaluateVertices = [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        const auto & vertex = vertices[toEvaluate[i]];
+                        supports[i] = crossSumBestAtBelief(vertex.first, projections, &trueValues[i]);
+                        currentValues[i] = vertex.second;
+                    }
+                };
+                if ( pool_ ) pool_->parallelFor(toEvaluate.size(), evaluateVertices);
+                else         evaluateVertices(0, toEvaluate.size());
+
+                for (size_t i = 0; i < toEvaluate.size(); ++i) {
+                    auto diff = trueValues[i] - currentValues[i];
                     if (diff > tolerance_ && checkDifferentGeneral(diff, tolerance_)) {
-                        auto it = allSupports.insert(std::move(support));
+                        auto it = allSupports.insert(std::move(supports[i]));
                         Vertex newVertex;
-                        newVertex.belief = vertex.first;
-                        newVertex.currentValue = currentValue;
+                        newVertex.belief = std::move(vertices[toEvaluate[i]].first);
+                        newVertex.currentValue = currentValues[i];
                         newVertex.support = it.first;
                         newVertex.error = diff;
                         agenda_.push(std::move(newVertex));
                     }
-
-                    triedVertices.insert(std::move(vertex.first));
                 }
 
                 if (agenda_.size() == 0)
@@ -270,14 +336,9 @@ namespace AIToolbox::POMDP {
                     agenda_.erase(h);
                 }
 
-                // Find vertices between the best support of this belief and the list
-                // we already have.
-                const auto bestAddr = &(*best.support);
-                const auto supBegin = boost::make_transform_iterator(bestAddr,                  unwrap);
-                const auto supEnd   = boost::make_transform_iterator(bestAddr + 1,              unwrap);
-                const auto chkBegin = boost::make_transform_iterator(std::cbegin(goodSupports), unwrap);
-                const auto chkEnd   = boost::make_transform_iterator(std::cend(goodSupports),   unwrap);
-                vertices = findVerticesNaive(supBegin, supEnd, chkBegin, chkEnd);
+                // Find the vertices created by the best support of this
+                // belief on the surface we already have.
+                vertices = enumerator.addHyperplane(best.support->values);
 
                 // We now can add the support for this vertex to the main list.  We
                 // don't need checks here because we are guaranteed that we are
@@ -290,7 +351,7 @@ namespace AIToolbox::POMDP {
 
             // Check convergence
             if ( useTolerance ) {
-                variation = weakBoundDistance(v[timestep-1], v[timestep]);
+                variation = weakBoundDistance(v[timestep-1], v[timestep], pool_);
             }
         }
 
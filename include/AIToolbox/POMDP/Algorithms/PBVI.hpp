@@ -4,9 +4,16 @@
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <AIToolbox/Utils/Prune.hpp>
+#include <AIToolbox/Utils/SolverControl.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/SOSACache.hpp>
 #include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
 #include <AIToolbox/POMDP/Algorithms/Utils/BeliefGenerator.hpp>
 
@@ -41,8 +48,15 @@ namespace AIToolbox::POMDP {
      *
      * There is no convergence guarantee of this method, but the error is
      * bounded.
+     *
+     * If a ThreadPool is set (see setThreadPool()), the backups of the
+     * beliefs are split between its threads. The results do not depend on
+     * the number of threads.
+     *
+     * The progress of a solve can be followed, and it can be cancelled,
+     * through SolverControl.
      */
-    class PBVI {
+    class PBVI : public SolverControl {
         public:
             /**
              * @brief Basic constructor.
@@ -86,6 +100,17 @@ namespace AIToolbox::POMDP {
              */
             void setBeliefSize(size_t nBeliefs);
 
+            /**
+             * @brief This function sets the ThreadPool to use to back up beliefs in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
             /**
              * @brief This function returns the currently set tolerance parameter.
              *
@@ -107,6 +132,13 @@ namespace AIToolbox::POMDP {
              */
             size_t getBeliefSize() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
             /**
              * @brief This function solves a POMDP::Model approximately.
              *
@@ -154,12 +186,13 @@ namespace AIToolbox::POMDP {
              * @param model The POMDP model that needs to be solved.
              * @param beliefs The list of beliefs to evaluate.
              * @param v The ValueFunction to startup the process from, if needed.
+             * @param sosa An optional SOSACache of the model, to share with other algorithms.
              *
              * @return A tuple containing the maximum variation for the
              *         ValueFunction and the computed ValueFunction.
              */
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
-            std::tuple<double, ValueFunction> operator()(const M & model, const std::vector<Belief> & bList, ValueFunction v = {});
+            std::tuple<double, ValueFunction> operator()(const M & model, const std::vector<Belief> & bList, ValueFunction v = {}, const SOSACache * sosa = nullptr);
 
         private:
             /**
@@ -177,16 +210,17 @@ namespace AIToolbox::POMDP {
              * @param ProjectionsRow The type containing the projections to process.
              * @param projs A 1d container containing O elements: each a VList of projections for the respective observation.
              * @param a The action that this cross-sum is about.
-             * @param bl The beliefs for which we are trying to find VEntries.
+             * @param beliefs The beliefs for which we are trying to find VEntries, one per row.
              *
-             * @return The optimal cross-sum list for the given projections and BeliefList.
+             * @return The optimal cross-sum list for the given projections and beliefs.
              */
             template <typename ProjectionsRow>
-            VList crossSum(const ProjectionsRow & projs, size_t a, const std::vector<Belief> & bl);
+            VList crossSum(const ProjectionsRow & projs, size_t a, const Matrix2D & beliefs);
 
             size_t S, A, O, beliefSize_;
             unsigned horizon_;
             double tolerance_;
+            ThreadPool * pool_;
 
             mutable RandomEngine rand_;
     };
@@ -204,7 +238,7 @@ namespace AIToolbox::POMDP {
     }
 
     template <typename M, typename>
-    std::tuple<double, ValueFunction> PBVI::operator()(const M & model, const std::vector<Belief> & beliefs, ValueFunction v) {
+    std::tuple<double, ValueFunction> PBVI::operator()(const M & model, const std::vector<Belief> & beliefs, ValueFunction v, const SOSACache * sosa) {
         // Initialize "global" variables
         S = model.getS();
         A = model.getA();
@@ -215,12 +249,19 @@ namespace AIToolbox::POMDP {
 
         unsigned timestep = 0;
 
-        Projecter projecter(model);
+        Projecter projecter(model, sosa);
+
+        // We pack the beliefs in a matrix, so that we can compute the
+        // values of all entries at all beliefs in a single product.
+        Matrix2D beliefsMatrix(beliefs.size(), S);
+        for ( size_t i = 0; i < beliefs.size(); ++i )
+            beliefsMatrix.row(i) = beliefs[i].transpose();
 
         // And off we go
+        startProgress();
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
         double variation = tolerance_ * 2; // Make it bigger
-        while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) ) {
+        while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) && !isCancelled() ) {
             ++timestep;
 
             // Compute all possible outcomes, from our previous results.
@@ -235,7 +276,7 @@ namespace AIToolbox::POMDP {
             // but there does not seem to be a speed boost by not doing
             // so (not that I found one, if there is one I'd like to know!)
             for ( size_t a = 0; a < A; ++a ) {
-                projs[a][0] = crossSum( projs[a], a, beliefs );
+                projs[a][0] = crossSum( projs[a], a, beliefsMatrix );
                 finalWSize += projs[a][0].size();
             }
             VList w;
@@ -246,9 +287,7 @@ namespace AIToolbox::POMDP {
 
             auto begin = boost::make_transform_iterator(std::begin(w), unwrap);
             auto end   = boost::make_transform_iterator(std::end(w),   unwrap);
-            auto bound = begin;
-            for ( const auto & belief : beliefs )
-                bound = extractBestAtPoint(belief, begin, bound, end);
+            auto bound = extractBestAtPoints(beliefsMatrix, begin, begin, end);
 
             w.erase(bound.base(), std::end(w));
 
@@ -261,19 +300,40 @@ namespace AIToolbox::POMDP {
 
             // Check convergence
             if ( useTolerance )
-                variation = weakBoundDistance(v[v.size()-2], v.back());
+                variation = weakBoundDistance(v[v.size()-2], v.back(), pool_);
+
+            reportProgress(timestep, variation, v.back().size());
         }
 
         return std::make_tuple(useTolerance ? variation : 0.0, v);
     }
 
     template <typename ProjectionsRow>
-    VList PBVI::crossSum(const ProjectionsRow & projs, const size_t a, const std::vector<Belief> & bl) {
-        VList result;
-        result.reserve(bl.size());
-
-        for ( const auto & b : bl )
-            result.emplace_back(crossSumBestAtBelief(b, projs, a));
+    VList PBVI::crossSum(const ProjectionsRow & projs, const size_t a, const Matrix2D & beliefs) {
+        const size_t N = beliefs.rows();
+        VList result(N);
+
+        // We pack the projections once, since we search them for every belief.
+        std::vector<PackedVList> packed;
+        packed.reserve(O);
+        for ( const auto & proj : projs )
+            packed.emplace_back(S, proj);
+
+        // Each belief is backed up independently from the others. We do
+        // it in blocks of beliefs, each with a matrix product per
+        // observation. The blocks do not depend on the number of threads,
+        // so neither do the results.
+        constexpr size_t BlockSize = 64;
+        const size_t blocks = (N + BlockSize - 1) / BlockSize;
+        const auto backup = [&](const size_t begin, const size_t end) {
+            for ( size_t k = begin; k < end; ++k ) {
+                const size_t first = k * BlockSize;
+                auto entries = crossSumBestAtBeliefs(beliefs.middleRows(first, std::min(BlockSize, N - first)), packed, a);
+                std::move(std::begin(entries), std::end(entries), std::begin(result) + first);
+            }
+        };
+        if ( pool_ ) pool_->parallelFor(blocks, backup);
+        else         backup(0, blocks);
 
         const auto rbegin = boost::make_transform_iterator(std::begin(result), unwrap);
         const auto rend   = boost::make_transform_iterator(std::end  (result), unwrap);
@@ -282,6 +342,10 @@ namespace AIToolbox::POMDP {
 
         return result;
     }
+
+    // The solver is compiled in the library for the common models.
+    extern template std::tuple<double, ValueFunction> PBVI::operator()(const Model<MDP::Model> &, ValueFunction);
+    extern template std::tuple<double, ValueFunction> PBVI::operator()(const SparseModel<MDP::SparseModel> &, ValueFunction);
 }
 
 #endif
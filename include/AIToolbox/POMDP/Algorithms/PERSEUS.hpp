@@ -1,9 +1,12 @@
 #ifndef AI_TOOLBOX_POMDP_PERSEUS_HEADER_FILE
 #define AI_TOOLBOX_POMDP_PERSEUS_HEADER_FILE
 
+#include <functional>
+
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <AIToolbox/Utils/Prune.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
@@ -11,6 +14,21 @@
 #include <AIToolbox/POMDP/Algorithms/Utils/BeliefGenerator.hpp>
 
 namespace AIToolbox::POMDP {
+    /**
+     * @brief This struct contains the state of a PERSEUS run between two timesteps.
+     *
+     * Since PERSEUS samples its beliefs at the start of a run, they are
+     * stored together with the ValueFunction. A checkpoint can be stored
+     * with writeBinary(), and passed back to PERSEUS to continue the run
+     * from where it was taken.
+     */
+    struct PERSEUSCheckpoint {
+        unsigned timestep;
+        double variation;
+        std::vector<Belief> beliefs;
+        ValueFunction v;
+    };
+
     /**
      * @brief This class implements the PERSEUS algorithm.
      *
@@ -32,9 +50,19 @@ namespace AIToolbox::POMDP {
      *
      * This method works best when it is allowed to iterate until convergence,
      * and thus shouldn't be used on problems with finite horizons.
+     *
+     * If a ThreadPool is set (see setThreadPool()), the beliefs are backed
+     * up in batches split between its threads. The VEntries found are the
+     * same as when backing up one belief at a time, so that the results do
+     * not depend on the number of threads.
+     *
+     * Long runs can be checkpointed with setCheckpointCallback(), and
+     * resumed from any checkpoint.
      */
     class PERSEUS {
         public:
+            using CheckpointCallback = std::function<void(const PERSEUSCheckpoint &)>;
+
             /**
              * @brief Basic constructor.
              *
@@ -77,6 +105,29 @@ namespace AIToolbox::POMDP {
              */
             void setBeliefSize(size_t nBeliefs);
 
+            /**
+             * @brief This function sets the ThreadPool to use to back up beliefs in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). A nullptr (the default) disables
+             * parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function sets the callback that receives checkpoints.
+             *
+             * The callback is called at the end of every interval
+             * timesteps, with the state needed to resume the run. An empty
+             * callback (the default) disables checkpointing.
+             *
+             * @param callback The function to call with each checkpoint.
+             * @param interval The number of timesteps between checkpoints; must be > 0.
+             */
+            void setCheckpointCallback(CheckpointCallback callback, unsigned interval = 1);
+
             /**
              * @brief This function returns the currently set tolerance parameter.
              *
@@ -98,6 +149,20 @@ namespace AIToolbox::POMDP {
              */
             size_t getBeliefSize() const;
 
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function returns the number of timesteps between checkpoints.
+             *
+             * @return The currently set checkpoint interval.
+             */
+            unsigned getCheckpointInterval() const;
+
             /**
              * @brief This function solves a POMDP::Model approximately.
              *
@@ -125,6 +190,27 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction> operator()(const M & model, double minReward);
 
+            /**
+             * @brief This function resumes solving a POMDP::Model from a checkpoint.
+             *
+             * The run continues from the timestep of the checkpoint, with
+             * its beliefs and the currently set parameters. The belief
+             * size parameter is ignored.
+             *
+             * This function throws an std::invalid_argument if the
+             * checkpoint is not consistent with the model.
+             *
+             * @tparam M The type of POMDP model that needs to be solved.
+             *
+             * @param model The POMDP model that needs to be solved.
+             * @param checkpoint The checkpoint to resume from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction and the computed ValueFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction> operator()(const M & model, const PERSEUSCheckpoint & checkpoint);
+
         private:
 
             /**
@@ -153,6 +239,9 @@ namespace AIToolbox::POMDP {
             size_t S, A, O, beliefSize_;
             unsigned horizon_;
             double tolerance_;
+            ThreadPool * pool_;
+            CheckpointCallback checkpoint_;
+            unsigned checkpointInterval_;
 
             mutable RandomEngine rand_;
     };
@@ -160,10 +249,6 @@ namespace AIToolbox::POMDP {
     template <typename M, typename>
     std::tuple<double, ValueFunction> PERSEUS::operator()(const M & model, const double minReward) {
         if ( model.getDiscount() == 1 ) throw std::invalid_argument("The model cannot have a discount of 1 in PERSEUS!");
-        // Initialize "global" variables
-        S = model.getS();
-        A = model.getA();
-        O = model.getO();
 
         // In this implementation we compute all beliefs in advance. This
         // is mostly due to the fact that I prefer counter parameters (how
@@ -172,20 +257,39 @@ namespace AIToolbox::POMDP {
         // can be called multiple times to increase the size of the belief
         // vector.
         BeliefGenerator bGen(model);
-        const auto beliefs = bGen(beliefSize_);
 
         // We initialize the ValueFunction to the "worst" case scenario.
-        ValueFunction v = makeValueFunction(S);
+        ValueFunction v = makeValueFunction(model.getS());
 
         v[0][0].values.fill(minReward / (1.0 - model.getDiscount()));
 
-        unsigned timestep = 0;
+        // Make the variation bigger so that we start.
+        return operator()(model, PERSEUSCheckpoint{0, tolerance_ * 2, bGen(beliefSize_), std::move(v)});
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction> PERSEUS::operator()(const M & model, const PERSEUSCheckpoint & checkpoint) {
+        // Initialize "global" variables
+        S = model.getS();
+        A = model.getA();
+        O = model.getO();
+
+        if ( checkpoint.v.size() != checkpoint.timestep + 1 || !checkpoint.v.back().size() ||
+             static_cast<size_t>(checkpoint.v.back()[0].values.size()) != S )
+            throw std::invalid_argument("The checkpoint is not consistent with the model.");
+        for ( const auto & b : checkpoint.beliefs )
+            if ( static_cast<size_t>(b.size()) != S )
+                throw std::invalid_argument("The checkpoint is not consistent with the model.");
+
+        const auto & beliefs = checkpoint.beliefs;
+        ValueFunction v = checkpoint.v;
+        unsigned timestep = checkpoint.timestep;
 
         Projecter projecter(model);
 
         // And off we go
         const bool useTolerance = checkDifferentSmall(tolerance_, 0.0);
-        double variation = tolerance_ * 2; // Make it bigger
+        double variation = checkpoint.variation;
         while ( timestep < horizon_ && ( !useTolerance || variation > tolerance_ ) ) {
             ++timestep;
             // Compute all possible outcomes, from our previous results.
@@ -199,7 +303,10 @@ namespace AIToolbox::POMDP {
 
             // Check convergence
             if ( useTolerance )
-                variation = weakBoundDistance(v[timestep-1], v[timestep]);
+                variation = weakBoundDistance(v[timestep-1], v[timestep], pool_);
+
+            if ( checkpoint_ && timestep % checkpointInterval_ == 0 )
+                checkpoint_(PERSEUSCheckpoint{timestep, variation, beliefs, v});
         }
 
         return std::make_tuple(useTolerance ? variation : 0.0, v);
@@ -207,33 +314,89 @@ namespace AIToolbox::POMDP {
 
     template <typename ProjectionsTable>
     VList PERSEUS::crossSum(const ProjectionsTable & projs, const std::vector<Belief> & bl, const VList & oldV) {
-        VList result, helper;
-        result.reserve(bl.size());
-        helper.reserve(A);
-        bool start = true;
-        double currentValue, oldValue;
-
-        auto rbegin = boost::make_transform_iterator(std::begin(result), unwrap);
-        auto rend   = boost::make_transform_iterator(std::end  (result), unwrap);
-        const auto obegin = boost::make_transform_iterator(std::begin(oldV), unwrap);
-        const auto oend   = boost::make_transform_iterator(std::end  (oldV), unwrap);
-
-        for ( const auto & b : bl ) {
-            if ( !start ) {
-                // If we have already improved this belief, skip it
-                findBestAtPoint( b, rbegin, rend, &currentValue );
-                findBestAtPoint( b, obegin, oend,   &oldValue   );
-                if ( currentValue >= oldValue ) continue;
+        VList result;
+
+        // We pack all lists once, since we search them for every belief.
+        std::vector<std::vector<PackedVList>> packed(A);
+        for ( size_t a = 0; a < A; ++a ) {
+            packed[a].reserve(O);
+            for ( size_t o = 0; o < O; ++o )
+                packed[a].emplace_back(S, projs[a][o]);
+        }
+        const PackedVList oldPacked(S, oldV);
+
+        const size_t N = bl.size();
+        const auto run = [this](const size_t n, const auto & f) {
+            if ( pool_ ) pool_->parallelFor(n, f);
+            else         f(0, n);
+        };
+
+        // The values of the beliefs with the old VList, which we need to
+        // improve upon. We compute them in blocks of beliefs, each with a
+        // single matrix product.
+        constexpr size_t BlockSize = 64;
+        Matrix2D beliefs(N, S);
+        for ( size_t i = 0; i < N; ++i )
+            beliefs.row(i) = bl[i].transpose();
+
+        Vector oldValues(N);
+        run((N + BlockSize - 1) / BlockSize, [&](const size_t begin, const size_t end) {
+            Vector values;
+            for ( size_t k = begin; k < end; ++k ) {
+                const size_t first = k * BlockSize, n = std::min(BlockSize, N - first);
+                oldPacked.findBestAtBeliefs(beliefs.middleRows(first, n), &values);
+                oldValues.segment(first, n) = values;
             }
-
-            result.emplace_back(crossSumBestAtBelief(b, projs));
-
-            rbegin = boost::make_transform_iterator(std::begin(result), unwrap);
-            rend   = boost::make_transform_iterator(std::end  (result), unwrap);
-
-            start = false;
+        });
+
+        // Whether each belief has already been improved by the VEntries
+        // we have found. Threads only write disjoint elements, so we use
+        // chars rather than a std::vector<bool>.
+        std::vector<char> covered(N, false);
+
+        // We go through the beliefs in order, and back up each one which
+        // has not been improved yet. To do this in parallel, we take the
+        // next batch of uncovered beliefs and back them all up at once.
+        // Then, for each in order, we only keep its VEntry if it is not
+        // improved by the ones kept before it in the batch. Thus, the
+        // result is the same as if we went through them one at a time,
+        // and does not depend on the number of threads.
+        const size_t batchSize = pool_ ? pool_->getThreadNumber() : 1;
+        std::vector<size_t> batch;
+        VList backups(batchSize);
+
+        size_t next = 0;
+        while ( true ) {
+            batch.clear();
+            for ( ; next < N && batch.size() < batchSize; ++next )
+                if ( !covered[next] ) batch.push_back(next);
+            if ( batch.empty() ) break;
+
+            run(batch.size(), [&](const size_t begin, const size_t end) {
+                for ( size_t j = begin; j < end; ++j )
+                    backups[j] = crossSumBestAtBelief(bl[batch[j]], packed);
+            });
+
+            const size_t first = result.size();
+            const auto improves = [&](const size_t i) {
+                for ( size_t k = first; k < result.size(); ++k )
+                    if ( result[k].values.dot(bl[i]) >= oldValues[i] ) return true;
+                return false;
+            };
+            for ( size_t j = 0; j < batch.size(); ++j )
+                if ( !improves(batch[j]) ) result.push_back(std::move(backups[j]));
+
+            // Finally we mark all remaining beliefs improved by the new
+            // VEntries.
+            run(N - next, [&](const size_t begin, const size_t end) {
+                for ( size_t i = next + begin; i < next + end; ++i )
+                    if ( !covered[i] ) covered[i] = improves(i);
+            });
         }
 
+        const auto rbegin = boost::make_transform_iterator(std::begin(result), unwrap);
+        const auto rend   = boost::make_transform_iterator(std::end  (result), unwrap);
+
         result.erase(extractDominated(S, rbegin, rend).base(), std::end(result));
 
         return result;
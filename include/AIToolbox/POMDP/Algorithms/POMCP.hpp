@@ -1,13 +1,27 @@
 #ifndef AI_TOOLBOX_POMDP_POMCP_HEADER_FILE
 #define AI_TOOLBOX_POMDP_POMCP_HEADER_FILE
 
-#include <unordered_map>
-
 #include <AIToolbox/Impl/Logging.hpp>
 #include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/SearchTree.hpp>
+#include <AIToolbox/Utils/SearchBudget.hpp>
+#include <AIToolbox/Utils/LeafBatch.hpp>
+#include <AIToolbox/Utils/RolloutCache.hpp>
+#include <AIToolbox/Utils/UCB.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Algorithms/Utils/ParticleBelief.hpp>
+
+#include <boost/functional/hash.hpp>
+
+#include <cmath>
 
 namespace AIToolbox::POMDP {
     /**
@@ -48,40 +62,66 @@ namespace AIToolbox::POMDP {
      * In order to avoid performing belief updates between each
      * action/observation pair, which can be expensive, POMCP uses particle
      * beliefs. These approximate the beliefs at every step, and are used
-     * to select states in the rollouts.
+     * to select states in the rollouts. Particles are stored as
+     * (state, count) pairs, and the number of distinct states kept in each
+     * node can be capped, so that deep trees do not store a copy of a
+     * state for every visit.
+     *
+     * A weakness of particle beliefs is that, as every particle
+     * approximation of continuous values, they lose particles in time. To
+     * fight this POMCP can reinvigorate the belief of the new root when
+     * reusing the tree: if it contains too few particles, new ones are
+     * generated by sampling transitions from the particles of the old
+     * root, and keeping the ones that produce the observation actually
+     * received.
+     *
+     * The tree is stored in a SearchTree, which keeps all nodes in flat
+     * arrays. This avoids an allocation per node, and allows resetting
+     * the tree in O(1) between calls to sampleAction(). The memory of the
+     * particle beliefs is also reused between searches. The memory used
+     * by the tree can be capped with setMaxMemory().
      *
-     * A weakness of this implementation is that, as every particle
-     * approximation of continuous values, it will lose particles in time.
-     * To fight this a possibility is to implement a particle
-     * reinvigoration method, which would introduce noise in the particle
-     * beliefs in order to keep them "fresh" (possibly using domain
-     * knowledge).
+     * The random rollouts can be replaced by a BatchEvaluator (see
+     * setLeafEvaluator()). In that case simulations stop at the new leaf
+     * and are queued, and the queued leaves are evaluated together once
+     * enough of them are available; see LeafBatch.
+     *
+     * Models which can sample whole batches of transitions are used in
+     * batches where the samples are independent. If the model provides
+     * MDP::is_generative_model_batch, the queued leaves can be evaluated
+     * with random rollouts performed together (see setLeafEvaluator()).
+     * If it provides is_generative_model_batch, the particles needed to
+     * reinvigorate a belief (see setMinParticles()) are sampled together.
+     *
+     * Leaves reached through the same recent actions and observations
+     * estimate similar values, but each rolls out from scratch. A
+     * RolloutCache can be set (see setRolloutCache()) to reuse the returns
+     * of previous rollouts from leaves with the same recent history.
+     *
+     * Actions within the tree are selected with the UCB1 exploration bonus
+     * by default. Other bonuses, like PUCT or UCBTuned, can be selected
+     * with the Bonus template parameter; see UCB1 for their interface.
      */
-    template <typename M>
+    template <typename M, typename Bonus = UCB1>
     class POMCP {
         static_assert(is_generative_model_v<M>, "This class only works for generative POMDP models!");
 
         public:
-            using SampleBelief = std::vector<size_t>;
-
-            struct BeliefNode;
-            using BeliefNodes = std::unordered_map<size_t, BeliefNode>;
+            using SampleBelief = ParticleBelief;
 
-            struct ActionNode {
-                BeliefNodes children;
-                double V = 0.0;
-                unsigned N = 0;
-            };
-            using ActionNodes = std::vector<ActionNode>;
-
-            struct BeliefNode {
-                BeliefNode() : N(0) {}
-                BeliefNode(size_t s) : belief(1, s), N(0) {}
-                ActionNodes children;
+            struct BeliefData {
+                void clear() { belief.clear(); }
                 SampleBelief belief;
-                unsigned N;
             };
 
+            using Graph = SearchTree<BeliefData>;
+            using NodeId = typename Graph::NodeId;
+            using BeliefNode = typename Graph::Node;
+            using ActionNode = typename Graph::ActionNode;
+
+            /// The maximum number of transitions sampled per missing particle during reinvigoration.
+            static constexpr unsigned ReinvigorationAttempts = 100;
+
             /**
              * @brief Basic constructor.
              *
@@ -106,6 +146,23 @@ namespace AIToolbox::POMDP {
              */
             size_t sampleAction(const Belief& b, unsigned horizon);
 
+            /**
+             * @brief This function resets the internal graph to the provided particle belief and samples for the given horizon.
+             *
+             * This allows to plan from beliefs which are not stored as a
+             * flat Belief, for example by filling the particle belief
+             * with states sampled from a Factored::POMDP::FactoredBelief.
+             *
+             * This function throws std::invalid_argument if the input
+             * belief is empty.
+             *
+             * @param b The initial particle belief for the environment.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best action.
+             */
+            size_t sampleAction(const SampleBelief& b, unsigned horizon);
+
             /**
              * @brief This function uses the internal graph to plan.
              *
@@ -119,9 +176,13 @@ namespace AIToolbox::POMDP {
              * using the existing graph: this should make search faster,
              * and also not require any belief updates.
              *
-             * NOTE: Currently there is no particle reinvigoration
-             * implemented, so for long horizons you can expect
-             * progressively degrading performances.
+             * If the minimum number of particles is set (see
+             * setMinParticles()), the belief of the selected branch is
+             * reinvigorated before searching when it contains fewer
+             * particles than that. This also allows to recover branches
+             * that were never sampled during the previous search.
+             * Otherwise, or if reinvigoration fails, the search is
+             * restarted from a uniform belief.
              *
              * @param a The action taken in the last timestep.
              * @param o The observation received in the last timestep.
@@ -131,6 +192,41 @@ namespace AIToolbox::POMDP {
              */
             size_t sampleAction(size_t a, size_t o, unsigned horizon);
 
+            /**
+             * @brief This function resets the internal graph and samples for the provided belief and horizon, within a time budget.
+             *
+             * Rather than performing a fixed number of rollouts, this
+             * function keeps performing rollouts until the input budget
+             * has been used up, and then returns the best action found so
+             * far. At least one rollout is always performed.
+             *
+             * \sa SearchDeadline
+             *
+             * @param b The initial belief for the environment.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(const Belief& b, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
+            /**
+             * @brief This function uses the internal graph to plan, within a time budget.
+             *
+             * \sa sampleAction(size_t, size_t, unsigned)
+             * \sa sampleAction(const Belief&, unsigned, std::chrono::duration<Rep, Period>)
+             *
+             * @param a The action taken in the last timestep.
+             * @param o The observation received in the last timestep.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(size_t a, size_t o, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
             /**
              * @brief This function sets the new size for initial beliefs created from sampleAction().
              *
@@ -142,6 +238,31 @@ namespace AIToolbox::POMDP {
              */
             void setBeliefSize(size_t beliefSize);
 
+            /**
+             * @brief This function sets the maximum number of distinct states stored in each particle belief within the tree.
+             *
+             * Once a node's belief contains this many distinct states,
+             * further particles for new states are merged with the stored
+             * ones without biasing the belief (see ParticleBelief). Beliefs
+             * of nodes already in the tree are not affected.
+             *
+             * @param maxParticles The new maximum number of distinct states, or zero for no limit.
+             */
+            void setMaxParticles(size_t maxParticles);
+
+            /**
+             * @brief This function sets the minimum number of particles below which the new root belief is reinvigorated.
+             *
+             * Reinvigoration samples states from the old root belief,
+             * samples transitions from them with the action taken, and
+             * keeps the resulting states that produce the observation
+             * received. At most ReinvigorationAttempts transitions are
+             * sampled per requested particle.
+             *
+             * @param minParticles The new minimum number of particles, or zero to disable reinvigoration.
+             */
+            void setMinParticles(size_t minParticles);
+
             /**
              * @brief This function sets the number of performed rollouts in POMCP.
              *
@@ -162,6 +283,101 @@ namespace AIToolbox::POMDP {
              */
             void setExploration(double exp);
 
+            /**
+             * @brief This function sets the evaluator used in place of rollouts for new leaves.
+             *
+             * When an evaluator is set, simulations are queued at their
+             * leaves until batchSize of them are available, and the
+             * leaves are then evaluated together. Remaining simulations
+             * are evaluated at the end of each search. An empty evaluator
+             * restores random rollouts.
+             *
+             * If the model can sample whole batches (see
+             * MDP::is_generative_model_batch), an empty evaluator with a
+             * batchSize greater than one still queues the leaves, and
+             * evaluates them with random rollouts performed in lockstep
+             * (see MDP::rolloutBatch()).
+             *
+             * Note that the search is still performed on a single thread;
+             * the evaluator is free to parallelize each batch.
+             *
+             * @param eval The new leaf evaluator.
+             * @param batchSize The number of simulations to queue before evaluating them.
+             */
+            void setLeafEvaluator(BatchEvaluator eval, size_t batchSize);
+
+            /**
+             * @brief This function sets the cache used to skip rollouts from already seen histories.
+             *
+             * Rollout returns are cached by the last historyLength
+             * action-observation pairs taken within the tree to reach the
+             * new leaf, and by the remaining horizon. Leaves sharing the
+             * same recent history thus share their rollouts, which is
+             * useful for long horizons with few distinct observations.
+             * A longer history makes the estimates more specific, but
+             * reduces the number of hits.
+             *
+             * The remaining horizons are grouped in buckets of
+             * depthBucket steps, so that entries are shared between close
+             * depths. The cache is kept between searches.
+             *
+             * The cache is not used when leaves are queued (see
+             * setLeafEvaluator()). A
+             * disabled cache (the default) restores plain rollouts.
+             *
+             * @param cache The new rollout cache.
+             * @param historyLength The number of action-observation pairs in each key.
+             * @param depthBucket The number of remaining steps grouped in each entry.
+             */
+            void setRolloutCache(RolloutCache cache, unsigned historyLength = 2, unsigned depthBucket = 1);
+
+            /**
+             * @brief This function sets the progressive widening of the observation branches.
+             *
+             * With many observations, most samples produce a new child,
+             * so that each child holds a single particle and the tree
+             * never grows deeper than one step. Progressive widening
+             * limits the children of each action node to k * N^alpha,
+             * where N is the number of times the action was tried. A
+             * sample with an observation without a child, once the limit
+             * is reached, is merged into the child with the closest
+             * observation index, and the simulation continues from it.
+             *
+             * Observation indeces are assumed to be ordered, so that
+             * close indeces denote similar observations, as when they
+             * discretize a continuous signal. Merged particles are kept
+             * in the child, which thus approximates the beliefs of all
+             * the observations it absorbed.
+             *
+             * When the real observation has no child after a search, the
+             * closest child is also used as the new root, unless
+             * reinvigoration is enabled (see setMinParticles()), in which
+             * case a new child is reinvigorated for the exact observation.
+             *
+             * A k of zero (the default) disables widening.
+             *
+             * @param k The multiplier of the number of children.
+             * @param alpha The exponent of the number of action visits, usually in [0, 1].
+             */
+            void setProgressiveWidening(double k, double alpha = 0.5);
+
+            /**
+             * @brief This function sets the memory limit of the search tree, in bytes.
+             *
+             * Once the nodes in the tree use this much memory (see
+             * SearchTree::getUsedMemory()), the search stops adding and
+             * expanding nodes, and simulations which would do so roll out
+             * from there instead; the tree keeps being refined within its
+             * current shape. A limit of zero (the default) disables it.
+             *
+             * The particles of the beliefs are not counted, as they are
+             * bounded by the maximum number of particles of each node
+             * (see setMaxParticles()).
+             *
+             * @param bytes The maximum memory used by the tree.
+             */
+            void setMaxMemory(size_t bytes);
+
             /**
              * @brief This function returns the POMDP generative model being used.
              *
@@ -172,9 +388,13 @@ namespace AIToolbox::POMDP {
             /**
              * @brief This function returns a reference to the internal graph structure holding the results of rollouts.
              *
+             * The root of the graph is the belief for which we last
+             * planned. Children of each action node are keyed by
+             * observation.
+             *
              * @return The internal graph.
              */
-            const BeliefNode& getGraph() const;
+            const Graph& getGraph() const;
 
             /**
              * @brief This function returns the initial particle size for converted Beliefs.
@@ -183,6 +403,20 @@ namespace AIToolbox::POMDP {
              */
             size_t getBeliefSize() const;
 
+            /**
+             * @brief This function returns the maximum number of distinct states stored in each particle belief within the tree.
+             *
+             * @return The maximum number of distinct states, or zero for no limit.
+             */
+            size_t getMaxParticles() const;
+
+            /**
+             * @brief This function returns the minimum number of particles below which the new root belief is reinvigorated.
+             *
+             * @return The minimum number of particles, or zero if reinvigoration is disabled.
+             */
+            size_t getMinParticles() const;
+
             /**
              * @brief This function returns the number of iterations performed to plan for an action.
              *
@@ -197,31 +431,138 @@ namespace AIToolbox::POMDP {
              */
             double getExploration() const;
 
+            /**
+             * @brief This function returns the number of simulations queued before evaluating their leaves.
+             *
+             * @return The leaf batch size.
+             */
+            size_t getLeafBatchSize() const;
+
+            /**
+             * @brief This function returns the cache used to skip rollouts.
+             *
+             * @return The rollout cache.
+             */
+            const RolloutCache & getRolloutCache() const;
+
+            /**
+             * @brief This function returns the number of action-observation pairs in each key of the rollout cache.
+             *
+             * @return The history length.
+             */
+            unsigned getRolloutCacheHistoryLength() const;
+
+            /**
+             * @brief This function returns the number of remaining steps grouped in each entry of the rollout cache.
+             *
+             * @return The depth bucket.
+             */
+            unsigned getRolloutCacheDepthBucket() const;
+
+            /**
+             * @brief This function returns the multiplier of the progressive widening.
+             *
+             * @return The widening multiplier, or zero if widening is disabled.
+             */
+            double getWideningFactor() const;
+
+            /**
+             * @brief This function returns the exponent of the progressive widening.
+             *
+             * @return The widening exponent.
+             */
+            double getWideningExponent() const;
+
+            /**
+             * @brief This function returns the memory limit of the search tree.
+             *
+             * @return The maximum memory used by the tree, or zero if unlimited.
+             */
+            size_t getMaxMemory() const;
+
+            /**
+             * @brief This function returns statistics about the last call to sampleAction().
+             *
+             * Timings and the depth histogram are only collected when
+             * profiling is enabled; see \ref Profiling.
+             *
+             * @return The statistics of the last search.
+             */
+            const SearchStatistics & getSearchStatistics() const;
+
         private:
             const M& model_;
-            size_t S, A, beliefSize_;
+            size_t S, A, beliefSize_, maxParticles_, minParticles_;
             unsigned iterations_, maxDepth_;
-            double exploration_;
+            double exploration_, wideningK_, wideningAlpha_;
+            size_t maxMemory_;
 
             SampleBelief sampleBelief_;
-            BeliefNode graph_;
+            Graph graph_;
+            SearchStatistics stats_;
+
+            BatchEvaluator evaluator_;
+            size_t batchSize_;
+            LeafBatch<Graph> batch_;
+            MDP::TransitionBatch rolloutSamples_;
+            TransitionBatch reinvigorationSamples_;
+
+            RolloutCache rolloutCache_;
+            unsigned historyLength_, depthBucket_;
+            // The action-observation pairs from the root to the current node.
+            std::vector<std::pair<size_t, size_t>> history_;
+
+            Bonus bonus_;
+            std::vector<double> scores_;
 
             mutable RandomEngine rand_;
 
+            /**
+             * @brief This function resets the graph to the input belief.
+             *
+             * @param b The belief to use as the root of the graph.
+             */
+            void resetGraph(const Belief & b);
+
+            /**
+             * @brief This function makes the branch of the input action and observation the new root.
+             *
+             * The belief of the branch is reinvigorated if needed. If the
+             * branch does not exist, or has lost its particles, the graph
+             * is reset with a uniform belief.
+             *
+             * @param a The action taken in the last timestep.
+             * @param o The observation received in the last timestep.
+             */
+            void reuseGraph(size_t a, size_t o);
+
+            /**
+             * @brief This function adds particles to the belief of the input branch of the root.
+             *
+             * The branch is created if it does not exist.
+             *
+             * @param a The action taken in the last timestep.
+             * @param o The observation received in the last timestep.
+             *
+             * @return The node of the branch.
+             */
+            NodeId reinvigorate(size_t a, size_t o);
+
             /**
              * @brief This function starts the simulation process.
              *
              * This function simply calls simulate() for the number of
-             * times specified by POMCP's parameters. While doing so it
-             * builds a tree of explored outcomes, from which POMCP will
-             * then extract the best expected action for the current
-             * belief.
+             * times specified by POMCP's parameters, or until the input
+             * deadline expires. While doing so it builds a tree of
+             * explored outcomes, from which POMCP will then extract the
+             * best expected action for the current belief.
              *
              * @param horizon The horizon for which to plan.
+             * @param deadline The deadline of the search, or nullptr to use the number of iterations.
              *
              * @return The best action to take given the final built tree.
              */
-            size_t runSimulation(unsigned horizon);
+            size_t runSimulation(unsigned horizon, const SearchDeadline * deadline);
 
             /**
              * @brief This function recursively simulates the model while building the tree.
@@ -245,7 +586,21 @@ namespace AIToolbox::POMDP {
              *
              * @return The discounted reward obtained from the simulation performed from here to the end.
              */
-            double simulate(BeliefNode & b, size_t s, unsigned horizon);
+            double simulate(NodeId b, size_t s, unsigned horizon);
+
+            /**
+             * @brief This function simulates the model from the root until a new leaf, and queues it for evaluation.
+             *
+             * This function follows the same path as simulate(), and
+             * updates the particle beliefs in the same way. However,
+             * rather than performing a rollout from the new leaf, it
+             * queues the simulation in the leaf batch; the values of the
+             * action nodes are updated once the batch is evaluated.
+             *
+             * @param b The tree node to simulate from.
+             * @param s The state from which we are simulating.
+             */
+            void simulateToLeaf(NodeId b, size_t s);
 
             /**
              * @brief This function implements the rollout policy for POMCP.
@@ -273,35 +628,85 @@ namespace AIToolbox::POMDP {
              */
             double rollout(size_t s, unsigned horizon);
 
+            /**
+             * @brief This function adds a particle to the child of a node, adding the child if needed.
+             *
+             * @param b The id of the parent node.
+             * @param a The action taken.
+             * @param o The observation obtained.
+             * @param s1 The state of the particle.
+             *
+             * @return The id of the child, and whether it was added.
+             */
+            std::pair<NodeId, bool> addParticle(NodeId b, size_t a, size_t o, size_t s1);
 
             /**
-             * @brief This function finds the best action based on value.
+             * @brief This function returns the child of an action node with the observation closest to the input one.
+             *
+             * Ties are broken towards the lower observation.
              *
-             * @tparam Iterator An iterator to an ActionNode.
-             * @param begin The beginning of a list of ActionNodes.
-             * @param end The end of the list.
+             * @param b The id of the parent node.
+             * @param a The action taken.
+             * @param o The observation obtained.
              *
-             * @return The iterator to the ActionNode with the best value.
+             * @return The id of the closest child, or NoNode if the action has no children.
              */
-            template <typename Iterator>
-            Iterator findBestA(Iterator begin, Iterator end);
+            NodeId findClosestChild(NodeId b, size_t a, size_t o) const;
 
             /**
-             * @brief This function finds the best action based on UCT.
+             * @brief This function allocates the action nodes of a node we are descending into.
              *
-             * UCT gives a bonus to actions that have been tried very few
+             * If the node has no action nodes and the tree has reached
+             * its memory limit, the node is left as it is.
+             *
+             * @param b The id of the node.
+             *
+             * @return Whether the node has its action nodes.
+             */
+            bool expand(NodeId b);
+
+            /**
+             * @brief This function evaluates the queued leaves and backs up their values.
+             */
+            void flushBatch();
+
+            /**
+             * @brief This function returns whether simulations are queued at their leaves.
+             *
+             * @return True if a leaf evaluator is set, or if rollouts are batched.
+             */
+            bool isQueueingLeaves() const;
+
+            /**
+             * @brief This function returns whether the tree has reached its memory limit.
+             *
+             * @return True if a limit is set and the tree uses at least that much memory.
+             */
+            bool isMemoryFull() const;
+
+
+            /**
+             * @brief This function finds the best action of a node based on value.
+             *
+             * @param id The id of the node.
+             *
+             * @return The action with the best value.
+             */
+            size_t findBestA(NodeId id) const;
+
+            /**
+             * @brief This function finds the action of a node to try next, based on the exploration bonus.
+             *
+             * The bonus favours actions that have been tried very few
              * times, in order to void thinking that a bad action is bad
              * just because it got unlucky the few times that it tried it.
              *
-             * @tparam Iterator An iterator to an ActionNode.
-             * @param begin The beginning of a list of ActionNodes.
-             * @param end The end of the list.
-             * @param count The sum of all action counts.
+             * @param id The id of the node.
+             * @param count The number of visits of the node.
              *
-             * @return The iterator to the ActionNode to be selected based on UCT.
+             * @return The action to be selected based on the bonus.
              */
-            template <typename Iterator>
-            Iterator findBestBonusA(Iterator begin, Iterator end, unsigned count);
+            size_t findBestBonusA(NodeId id, unsigned count);
 
             /**
              * @brief This function samples a given belief in order to produce a particle approximation of it.
@@ -313,116 +718,278 @@ namespace AIToolbox::POMDP {
             SampleBelief makeSampledBelief(const Belief & b);
     };
 
-    template <typename M>
-    POMCP<M>::POMCP(const M& m, const size_t beliefSize, const unsigned iter, const double exp) :
+    template <typename M, typename Bonus>
+    POMCP<M, Bonus>::POMCP(const M& m, const size_t beliefSize, const unsigned iter, const double exp) :
             model_(m), S(model_.getS()), A(model_.getA()), beliefSize_(beliefSize),
-            iterations_(iter), exploration_(exp), graph_(), rand_(Impl::Seeder::getSeed()) {}
+            maxParticles_(beliefSize), minParticles_(0), iterations_(iter), exploration_(exp),
+            wideningK_(0.0), wideningAlpha_(0.5), maxMemory_(0),
+            graph_(A), batchSize_(1), historyLength_(2), depthBucket_(1), rand_(Impl::Seeder::getSeed()) {}
+
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::sampleAction(const Belief& b, const unsigned horizon) {
+        resetGraph(b);
+        return runSimulation(horizon, nullptr);
+    }
 
-    template <typename M>
-    size_t POMCP<M>::sampleAction(const Belief& b, const unsigned horizon) {
-        // Reset graph
-        graph_ = BeliefNode(A);
-        graph_.children.resize(A);
-        graph_.belief = makeSampledBelief(b);
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::sampleAction(const SampleBelief& b, const unsigned horizon) {
+        if ( b.empty() ) throw std::invalid_argument("POMCP cannot plan from an empty particle belief");
 
-        return runSimulation(horizon);
+        graph_.reset();
+        graph_.expand(graph_.getRoot());
+        graph_.getNode(graph_.getRoot()).belief = b;
+        return runSimulation(horizon, nullptr);
     }
 
-    template <typename M>
-    size_t POMCP<M>::sampleAction(const size_t a, const size_t o, const unsigned horizon) {
-        const auto & obs = graph_.children[a].children;
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::sampleAction(const size_t a, const size_t o, const unsigned horizon) {
+        reuseGraph(a, o);
+        return runSimulation(horizon, nullptr);
+    }
+
+    template <typename M, typename Bonus>
+    template <typename Rep, typename Period>
+    size_t POMCP<M, Bonus>::sampleAction(const Belief& b, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
+
+        resetGraph(b);
+        return runSimulation(horizon, &deadline);
+    }
+
+    template <typename M, typename Bonus>
+    template <typename Rep, typename Period>
+    size_t POMCP<M, Bonus>::sampleAction(const size_t a, const size_t o, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
+
+        reuseGraph(a, o);
+        return runSimulation(horizon, &deadline);
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::resetGraph(const Belief & b) {
+        graph_.reset();
+        graph_.expand(graph_.getRoot());
+        graph_.getNode(graph_.getRoot()).belief = makeSampledBelief(b);
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::reuseGraph(const size_t a, const size_t o) {
+        auto child = graph_.getChild(graph_.getRoot(), a, o);
+        if ( child == Graph::NoNode && wideningK_ > 0.0 && !minParticles_ )
+            child = findClosestChild(graph_.getRoot(), a, o);
+        if ( minParticles_ && ( child == Graph::NoNode || graph_.getNode(child).belief.getCount() < minParticles_ ) )
+            child = reinvigorate(a, o);
 
-        auto it = obs.find(o);
-        if ( it == obs.end() ) {
+        if ( child == Graph::NoNode ) {
             AI_LOGGER(AI_SEVERITY_WARNING, "Observation " << o << " never experienced in simulation, restarting with uniform belief..");
             auto b = Belief(S); b.fill(1.0/S);
-            return sampleAction(b, horizon);
+            resetGraph(b);
+            return;
         }
 
-        // Here we need an additional step, because *it is contained by graph_.
-        // If we just move assign, graph_ is first going to delete everything it
-        // contains (included *it), and then we are going to move unallocated memory
-        // into graph_! So we move *it outside of the graph_ hierarchy, so that
-        // we can then assign safely.
-        { auto tmp = std::move(it->second); graph_ = std::move(tmp); }
+        graph_.reroot(child);
 
-        if ( ! graph_.belief.size() ) {
+        if ( graph_.getNode(graph_.getRoot()).belief.empty() ) {
             AI_LOGGER(AI_SEVERITY_WARNING, "POMCP lost track of the belief, restarting with uniform..");
             auto b = Belief(S); b.fill(1.0/S);
-            return sampleAction(b, horizon);
+            resetGraph(b);
+            return;
         }
 
-        // We resize here in case we didn't have time to sample the new
+        // We expand here in case we didn't have time to sample the new
         // head node. In this case, the new head may not have children.
         // This would break the UCT call.
-        graph_.children.resize(A);
+        graph_.expand(graph_.getRoot());
+    }
 
-        return runSimulation(horizon);
+    template <typename M, typename Bonus>
+    typename POMCP<M, Bonus>::NodeId POMCP<M, Bonus>::reinvigorate(const size_t a, const size_t o) {
+        const auto root = graph_.getRoot();
+        const auto [child, added] = graph_.addChild(root, a, o);
+
+        // The child has been added already, so these references stay valid.
+        const auto & source = graph_.getNode(root).belief;
+        auto & belief = graph_.getNode(child).belief;
+        if ( added ) belief.setMaxSize(maxParticles_);
+        if ( source.empty() ) return child;
+
+        const size_t attempts = minParticles_ * ReinvigorationAttempts;
+        if constexpr (is_generative_model_batch_v<M>) {
+            // Each batch only asks for as many samples as the particles
+            // still missing, so no more samples are taken than when
+            // sampling one at a time.
+            auto & samples = reinvigorationSamples_;
+            for ( size_t i = 0; i < attempts && belief.getCount() < minParticles_; ) {
+                const size_t N = std::min(minParticles_ - belief.getCount(), attempts - i);
+                samples.states.resize(N);
+                samples.actions.assign(N, a);
+                samples.nextStates.resize(N);
+                samples.observations.resize(N);
+                samples.rewards.resize(N);
+                for ( auto & s : samples.states )
+                    s = source.sample(rand_);
+
+                model_.sampleSORBatch(&samples);
+
+                for ( size_t j = 0; j < N; ++j )
+                    if ( samples.observations[j] == o ) belief.add(samples.nextStates[j], 1, rand_);
+                i += N;
+            }
+        } else {
+            size_t s1, o1;
+            for ( size_t i = 0; i < attempts && belief.getCount() < minParticles_; ++i ) {
+                std::tie(s1, o1, std::ignore) = model_.sampleSOR(source.sample(rand_), a);
+                if ( o1 == o ) belief.add(s1, 1, rand_);
+            }
+        }
+        return child;
     }
 
-    template <typename M>
-    size_t POMCP<M>::runSimulation(const unsigned horizon) {
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::runSimulation(const unsigned horizon, const SearchDeadline * deadline) {
+        stats_ = SearchStatistics();
+        history_.clear();
         if ( !horizon ) return 0;
 
+        const auto start = std::chrono::steady_clock::now();
         maxDepth_ = horizon;
-        std::uniform_int_distribution<size_t> generator(0, graph_.belief.size()-1);
+        const auto root = graph_.getRoot();
+        const bool queue = isQueueingLeaves();
+        const auto step = [this, root, queue]{
+            const auto s = graph_.getNode(root).belief.sample(rand_);
+            if ( !queue ) {
+                simulate(root, s, 0);
+                return;
+            }
+            simulateToLeaf(root, s);
+            if ( batch_.size() >= batchSize_ )
+                flushBatch();
+        };
 
-        for (unsigned i = 0; i < iterations_; ++i )
-            simulate(graph_, graph_.belief.at(generator(rand_)), 0);
+        if ( deadline ) {
+            do step();
+            while ( !deadline->expired(++stats_.rollouts) );
+        } else {
+            for (unsigned i = 0; i < iterations_; ++i )
+                step();
+            stats_.rollouts = iterations_;
+        }
+        if ( queue ) flushBatch();
+
+        stats_.nodes = graph_.size();
+        stats_.memoryUsage = graph_.getMemoryUsage();
+        stats_.elapsed = std::chrono::steady_clock::now() - start;
+
+        AI_METRIC_COUNT("POMDP::POMCP::rollouts", stats_.rollouts);
+        AI_METRIC_ADD_TIME("POMDP::POMCP::search", stats_.elapsed);
 
-        auto begin = std::begin(graph_.children);
-        return std::distance(begin, findBestA(begin, std::end(graph_.children)));
+        return findBestA(root);
     }
 
-    template <typename M>
-    double POMCP<M>::simulate(BeliefNode & b, const size_t s, const unsigned depth) {
-        b.N++;
+    template <typename M, typename Bonus>
+    double POMCP<M, Bonus>::simulate(const NodeId b, const size_t s, const unsigned depth) {
+        const auto count = ++graph_.getNode(b).N;
+        if ( depth > stats_.maxDepth ) stats_.maxDepth = depth;
 
-        auto begin = std::begin(b.children);
-        const size_t a = std::distance(begin, findBestBonusA(begin, std::end(b.children), b.N));
+        const size_t a = findBestBonusA(b, count);
 
         auto [s1, o, rew] = model_.sampleSOR(s, a);
-
-        auto & aNode = b.children[a];
+        if ( rolloutCache_.isEnabled() ) history_.emplace_back(a, o);
 
         {
             double futureRew = 0.0;
             // We need to append the node anyway to perform the belief
             // update for the next timestep.
-            auto ot = aNode.children.find(o);
-            if ( ot == std::end(aNode.children) ) {
-                aNode.children.emplace(std::piecewise_construct,
-                                       std::forward_as_tuple(o),
-                                       std::forward_as_tuple(s1));
+            const auto [child, added] = addParticle(b, a, o, s1);
+
+            if ( added ) {
+                if ( child != Graph::NoNode ) ++stats_.nodesAdded;
+                AI_PROFILE(stats_.addLeafDepth(depth));
                 // This stops automatically if we go out of depth
                 futureRew = rollout(s1, depth + 1);
             }
             else {
-                ot->second.belief.push_back(s1);
                 // We only go deeper if needed (maxDepth_ is always at least 1).
                 if ( depth + 1 < maxDepth_ && !model_.isTerminal(s1) ) {
-                    // Since most memory is allocated on the leaves,
-                    // we do not allocate on node creation but only when
-                    // we are actually descending into a node. If the node
-                    // already has memory this should not do anything in
-                    // any case.
-                    ot->second.children.resize(A);
-                    futureRew = simulate( ot->second, s1, depth + 1 );
+                    if ( expand(child) ) {
+                        futureRew = simulate( child, s1, depth + 1 );
+                    } else {
+                        AI_PROFILE(stats_.addLeafDepth(depth));
+                        futureRew = rollout(s1, depth + 1);
+                    }
+                } else {
+                    AI_PROFILE(stats_.addLeafDepth(depth));
                 }
             }
 
             rew += model_.getDiscount() * futureRew;
         }
+        if ( rolloutCache_.isEnabled() ) history_.pop_back();
 
-        // Action update
-        aNode.N++;
-        aNode.V += ( rew - aNode.V ) / static_cast<double>(aNode.N);
+        // Action update. Note that the graph may have grown while
+        // simulating, so we cannot keep references to its nodes.
+        graph_.update(b, a, rew);
 
         return rew;
     }
 
-    template <typename M>
-    double POMCP<M>::rollout(size_t s, unsigned depth) {
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::simulateToLeaf(NodeId b, size_t s) {
+        for ( unsigned depth = 0; ; ++depth ) {
+            const auto count = ++graph_.getNode(b).N;
+            if ( depth > stats_.maxDepth ) stats_.maxDepth = depth;
+
+            const size_t a = findBestBonusA(b, count);
+
+            const auto [s1, o, rew] = model_.sampleSOR(s, a);
+            batch_.push(graph_, b, a, rew);
+
+            const auto [child, added] = addParticle(b, a, o, s1);
+
+            if ( added ) {
+                if ( child != Graph::NoNode ) ++stats_.nodesAdded;
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                // As rollout(), we do not evaluate past the horizon or
+                // from terminal states.
+                if ( depth + 1 < maxDepth_ && !model_.isTerminal(s1) )
+                    batch_.finish(s1, maxDepth_ - depth - 1);
+                else
+                    batch_.finish();
+                return;
+            }
+            if ( depth + 1 >= maxDepth_ || model_.isTerminal(s1) ) {
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                batch_.finish();
+                return;
+            }
+            if ( !expand(child) ) {
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                batch_.finish(s1, maxDepth_ - depth - 1);
+                return;
+            }
+            b = child;
+            s = s1;
+        }
+    }
+
+    template <typename M, typename Bonus>
+    double POMCP<M, Bonus>::rollout(size_t s, unsigned depth) {
+        AI_PROFILE_SCOPE(stats_.rolloutTime);
+
+        size_t key = 0;
+        if ( rolloutCache_.isEnabled() ) {
+            const auto first = history_.size() - std::min<size_t>(historyLength_, history_.size());
+            for ( auto i = first; i < history_.size(); ++i ) {
+                boost::hash_combine(key, history_[i].first);
+                boost::hash_combine(key, history_[i].second);
+            }
+            boost::hash_combine(key, (maxDepth_ - depth) / depthBucket_);
+            if ( const auto value = rolloutCache_.lookup(key) ) {
+                ++stats_.rolloutCacheHits;
+                return *value;
+            }
+        }
+
         double rew = 0.0, totalRew = 0.0, gamma = 1.0;
 
         std::uniform_int_distribution<size_t> generator(0, A-1);
@@ -431,95 +998,243 @@ namespace AIToolbox::POMDP {
             totalRew += gamma * rew;
 
             if (model_.isTerminal(s))
-                return totalRew;
+                break;
 
             gamma *= model_.getDiscount();
         }
+
+        if ( rolloutCache_.isEnabled() ) rolloutCache_.update(key, totalRew);
         return totalRew;
     }
 
-    template <typename M>
-    template <typename Iterator>
-    Iterator POMCP<M>::findBestA(Iterator begin, Iterator end) {
-        return std::max_element(begin, end, [](const ActionNode & lhs, const ActionNode & rhs){ return lhs.V < rhs.V; });
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::findBestA(const NodeId id) const {
+        const auto values = graph_.getValues(id);
+        return std::distance(values, std::max_element(values, values + A));
     }
 
-    template <typename M>
-    template <typename Iterator>
-    Iterator POMCP<M>::findBestBonusA(Iterator begin, Iterator end, const unsigned count) {
-        // Count here can be as low as 1.
-        // Since log(1) = 0, and 0/0 = error, we add 1.0.
-        const double logCount = std::log(count + 1.0);
-        // We use this function to produce a score for each action. This can be easily
-        // substituted with something else to produce different POMCP variants.
-        auto evaluationFunction = [this, logCount](const ActionNode & an){
-                return an.V + exploration_ * std::sqrt( logCount / an.N );
-        };
-
-        auto bestIterator = begin++;
-        double bestValue = evaluationFunction(*bestIterator);
+    template <typename M, typename Bonus>
+    std::pair<typename POMCP<M, Bonus>::NodeId, bool> POMCP<M, Bonus>::addParticle(const NodeId b, const size_t a, const size_t o, const size_t s1) {
+        AI_PROFILE_SCOPE(stats_.expansionTime);
+        if ( wideningK_ > 0.0 && graph_.getChild(b, a, o) == Graph::NoNode ) {
+            // The action count is updated after the simulation, so we
+            // include the current visit.
+            const auto children = graph_.getChildCount(b, a);
+            const auto visits = graph_.getAction(b, a).N + 1;
+            if ( children && children >= wideningK_ * std::pow(visits, wideningAlpha_) ) {
+                const auto child = findClosestChild(b, a, o);
+                graph_.getNode(child).belief.add(s1, 1, rand_);
+                ++stats_.mergedObservations;
+                return {child, false};
+            }
+        }
+        if ( isMemoryFull() && graph_.getChild(b, a, o) == Graph::NoNode ) {
+            ++stats_.memoryLimited;
+            return {Graph::NoNode, true};
+        }
+        const auto retval = graph_.addChild(b, a, o);
+        auto & belief = graph_.getNode(retval.first).belief;
+        if ( retval.second ) belief.setMaxSize(maxParticles_);
+        belief.add(s1, 1, rand_);
+        return retval;
+    }
 
-        for ( ; begin < end; ++begin ) {
-            const double actionValue = evaluationFunction(*begin);
-            if ( actionValue > bestValue ) {
-                bestValue = actionValue;
-                bestIterator = begin;
+    template <typename M, typename Bonus>
+    typename POMCP<M, Bonus>::NodeId POMCP<M, Bonus>::findClosestChild(const NodeId b, const size_t a, const size_t o) const {
+        auto retval = Graph::NoNode;
+        size_t bestKey = 0, bestDistance = 0;
+        graph_.forEachChild(b, a, [&](const size_t key, const NodeId child) {
+            const auto distance = key > o ? key - o : o - key;
+            if ( retval == Graph::NoNode || distance < bestDistance || (distance == bestDistance && key < bestKey) ) {
+                retval = child;
+                bestKey = key;
+                bestDistance = distance;
             }
+        });
+        return retval;
+    }
+
+    template <typename M, typename Bonus>
+    bool POMCP<M, Bonus>::expand(const NodeId b) {
+        AI_PROFILE_SCOPE(stats_.expansionTime);
+        // Since most memory is allocated on the leaves, we do not
+        // allocate on node creation but only when we are actually
+        // descending into a node. If the node already has memory this
+        // should not do anything in any case.
+        if ( !graph_.isExpanded(b) && isMemoryFull() ) {
+            ++stats_.memoryLimited;
+            return false;
         }
+        graph_.expand(b);
+        return true;
+    }
+
+    template <typename M, typename Bonus>
+    bool POMCP<M, Bonus>::isMemoryFull() const {
+        return maxMemory_ && graph_.getUsedMemory() >= maxMemory_;
+    }
 
-        return bestIterator;
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::flushBatch() {
+        AI_PROFILE_SCOPE(stats_.rolloutTime);
+        if constexpr (MDP::is_generative_model_batch_v<M>) {
+            if ( !evaluator_ ) {
+                batch_.flush(graph_, [this](const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values) {
+                    MDP::rolloutBatch(model_, states, horizons, values, &rolloutSamples_, rand_);
+                }, model_.getDiscount());
+                return;
+            }
+        }
+        batch_.flush(graph_, evaluator_, model_.getDiscount());
     }
 
-    template <typename M>
-    typename POMCP<M>::SampleBelief POMCP<M>::makeSampledBelief(const Belief & b) {
-        SampleBelief belief;
-        belief.reserve(beliefSize_);
+    template <typename M, typename Bonus>
+    bool POMCP<M, Bonus>::isQueueingLeaves() const {
+        if ( evaluator_ ) return true;
+        if constexpr (MDP::is_generative_model_batch_v<M>) return batchSize_ > 1;
+        return false;
+    }
 
-        for ( size_t i = 0; i < beliefSize_; ++i )
-            belief.push_back(sampleProbability(S, b, rand_));
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::findBestBonusA(const NodeId id, const unsigned count) {
+        AI_PROFILE_SCOPE(stats_.selectionTime);
+        return selectBonusAction(bonus_, exploration_, count, graph_.getValues(id), graph_.getCounts(id), graph_.getSquares(id), A, scores_);
+    }
 
-        return belief;
+    template <typename M, typename Bonus>
+    typename POMCP<M, Bonus>::SampleBelief POMCP<M, Bonus>::makeSampledBelief(const Belief & b) {
+        // The root belief is already bounded by beliefSize_, so we do
+        // not cap it.
+        return makeParticleBelief(b, beliefSize_, rand_);
     }
 
-    template <typename M>
-    void POMCP<M>::setBeliefSize(const size_t beliefSize) {
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setBeliefSize(const size_t beliefSize) {
         beliefSize_ = beliefSize;
     }
 
-    template <typename M>
-    void POMCP<M>::setIterations(const unsigned iter) {
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setMaxParticles(const size_t maxParticles) {
+        maxParticles_ = maxParticles;
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setMinParticles(const size_t minParticles) {
+        minParticles_ = minParticles;
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setIterations(const unsigned iter) {
         iterations_ = iter;
     }
 
-    template <typename M>
-    void POMCP<M>::setExploration(const double exp) {
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setExploration(const double exp) {
         exploration_ = exp;
     }
 
-    template <typename M>
-    const M& POMCP<M>::getModel() const {
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setLeafEvaluator(BatchEvaluator eval, const size_t batchSize) {
+        evaluator_ = std::move(eval);
+        batchSize_ = batchSize;
+    }
+
+    template <typename M, typename Bonus>
+    const M& POMCP<M, Bonus>::getModel() const {
         return model_;
     }
 
-    template <typename M>
-    const typename POMCP<M>::BeliefNode& POMCP<M>::getGraph() const {
+    template <typename M, typename Bonus>
+    const typename POMCP<M, Bonus>::Graph& POMCP<M, Bonus>::getGraph() const {
         return graph_;
     }
 
-    template <typename M>
-    size_t POMCP<M>::getBeliefSize() const {
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::getBeliefSize() const {
         return beliefSize_;
     }
 
-    template <typename M>
-    unsigned POMCP<M>::getIterations() const {
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::getMaxParticles() const {
+        return maxParticles_;
+    }
+
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::getMinParticles() const {
+        return minParticles_;
+    }
+
+    template <typename M, typename Bonus>
+    unsigned POMCP<M, Bonus>::getIterations() const {
         return iterations_;
     }
 
-    template <typename M>
-    double POMCP<M>::getExploration() const {
+    template <typename M, typename Bonus>
+    double POMCP<M, Bonus>::getExploration() const {
         return exploration_;
     }
+
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::getLeafBatchSize() const {
+        return batchSize_;
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setRolloutCache(RolloutCache cache, const unsigned historyLength, const unsigned depthBucket) {
+        rolloutCache_ = std::move(cache);
+        historyLength_ = historyLength;
+        depthBucket_ = std::max(1u, depthBucket);
+    }
+
+    template <typename M, typename Bonus>
+    const RolloutCache & POMCP<M, Bonus>::getRolloutCache() const {
+        return rolloutCache_;
+    }
+
+    template <typename M, typename Bonus>
+    unsigned POMCP<M, Bonus>::getRolloutCacheHistoryLength() const {
+        return historyLength_;
+    }
+
+    template <typename M, typename Bonus>
+    unsigned POMCP<M, Bonus>::getRolloutCacheDepthBucket() const {
+        return depthBucket_;
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setProgressiveWidening(const double k, const double alpha) {
+        wideningK_ = k;
+        wideningAlpha_ = alpha;
+    }
+
+    template <typename M, typename Bonus>
+    double POMCP<M, Bonus>::getWideningFactor() const {
+        return wideningK_;
+    }
+
+    template <typename M, typename Bonus>
+    double POMCP<M, Bonus>::getWideningExponent() const {
+        return wideningAlpha_;
+    }
+
+    template <typename M, typename Bonus>
+    void POMCP<M, Bonus>::setMaxMemory(const size_t bytes) {
+        maxMemory_ = bytes;
+    }
+
+    template <typename M, typename Bonus>
+    size_t POMCP<M, Bonus>::getMaxMemory() const {
+        return maxMemory_;
+    }
+
+    template <typename M, typename Bonus>
+    const SearchStatistics & POMCP<M, Bonus>::getSearchStatistics() const {
+        return stats_;
+    }
+
+    // Both common models are compiled in the library.
+    extern template class POMCP<Model<MDP::Model>>;
+    extern template class POMCP<SparseModel<MDP::SparseModel>>;
 }
 
 #endif
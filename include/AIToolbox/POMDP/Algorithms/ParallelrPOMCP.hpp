@@ -0,0 +1,536 @@
+#ifndef AI_TOOLBOX_POMDP_PARALLEL_rPOMCP_HEADER_FILE
+#define AI_TOOLBOX_POMDP_PARALLEL_rPOMCP_HEADER_FILE
+
+#include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+
+#include <AIToolbox/POMDP/Algorithms/Utils/rPOMCPGraph.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class represents the rPOMCP online planner, parallelized over multiple threads.
+     *
+     * This class implements the same algorithm as rPOMCP, but splits the
+     * rollouts between the threads of a ThreadPool, which all grow a
+     * single shared tree.
+     *
+     * The tree is made of the same nodes used by rPOMCP. Each belief node
+     * is protected by a lock, which guards its counters, its value
+     * estimates, its particle belief and entropy estimate, and the
+     * children maps of its action nodes. Locks are only held while
+     * selecting an action, while adding particles, and while updating
+     * the statistics, and a thread never holds more than one at a time.
+     * Since there is a lock per node, the particle beliefs are in effect
+     * sharded across the tree, so threads working on different parts of
+     * it do not contend. To avoid a mutex per node, nodes share a fixed
+     * number of locks, selected by hashing their address.
+     *
+     * rPOMCP backs up values by updating several estimates of each node
+     * together (see rPOMCP::simulate), which cannot be done with
+     * independent atomic operations; this is why the nodes are locked
+     * rather than using atomic counters.
+     *
+     * To keep threads from all following the same path, each thread
+     * counts its visit to an action as soon as it selects it, so that
+     * other threads see the action as already explored while its value is
+     * still being computed.
+     *
+     * Each search draws a seed from the internal RandomEngine, which is
+     * seeded from Impl::Seeder, and each thread uses the stream of that
+     * seed identified by its index (see makeEngineStream()). If the
+     * RandomEngine is counter-based (see AI_COUNTER_BASED_RNG), each
+     * rollout rather uses the stream identified by its iteration number.
+     * If the model supports sampling with an external random engine (see
+     * is_generative_model_rng), each thread samples it independently.
+     * Otherwise, calls to the model's sampleSOR() are serialized, which is
+     * correct but limits scaling.
+     *
+     * If no ThreadPool is set, this class runs all rollouts in the calling
+     * thread, and behaves like rPOMCP.
+     *
+     * Note that while each rollout samples the same random numbers, since
+     * threads interleave nondeterministically the tree they see, and thus
+     * the results, are not reproducible between runs unless a single
+     * thread is used.
+     */
+    template <typename M, bool UseEntropy>
+    class ParallelrPOMCP {
+        static_assert(is_generative_model_v<M>, "This class only works for generative POMDP models!");
+
+        public:
+            // Shorthands to avoid specifying UseEntropy everywhere.
+            using BNode = BeliefNode<UseEntropy>;
+            using ANode = ActionNode<UseEntropy>;
+            using HNode = HeadBeliefNode<UseEntropy>;
+
+            /// The number of locks shared by the belief nodes of the tree.
+            static constexpr size_t LockStripes = 256;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * @param m The POMDP model that ParallelrPOMCP will operate upon.
+             * @param beliefSize The size of the initial particle belief.
+             * @param iterations The number of episodes to run before completion.
+             * @param exp The exploration constant. This parameter is VERY important to determine the final rPOMCP performance.
+             * @param k The number of samples a belief node must have before it switches to MAX. If very very high is nearly equal to mean.
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            ParallelrPOMCP(const M& m, size_t beliefSize, unsigned iterations, double exp, unsigned k = 500, ThreadPool * pool = nullptr);
+
+            /**
+             * @brief This function resets the internal graph and samples for the provided belief and horizon.
+             *
+             * \sa rPOMCP::sampleAction(const Belief&, unsigned)
+             *
+             * @param b The initial belief for the environment.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best action.
+             */
+            size_t sampleAction(const Belief& b, unsigned horizon);
+
+            /**
+             * @brief This function uses the internal graph to plan.
+             *
+             * \sa rPOMCP::sampleAction(size_t, size_t, unsigned)
+             *
+             * @param a The action taken in the last timestep.
+             * @param o The observation received in the last timestep.
+             * @param horizon The horizon to plan for.
+             *
+             * @return The best action.
+             */
+            size_t sampleAction(size_t a, size_t o, unsigned horizon);
+
+            /**
+             * @brief This function sets the new size for initial beliefs created from sampleAction().
+             *
+             * \sa rPOMCP::setBeliefSize(size_t)
+             *
+             * @param beliefSize The new particle belief size.
+             */
+            void setBeliefSize(size_t beliefSize);
+
+            /**
+             * @brief This function sets the number of performed rollouts in ParallelrPOMCP.
+             *
+             * This is the total number of rollouts, which are split
+             * between all threads.
+             *
+             * @param iter The new number of rollouts.
+             */
+            void setIterations(unsigned iter);
+
+            /**
+             * @brief This function sets the new exploration constant for ParallelrPOMCP.
+             *
+             * \sa rPOMCP::setExploration(double)
+             *
+             * @param exp The new exploration constant.
+             */
+            void setExploration(double exp);
+
+            /**
+             * @brief This function sets the ThreadPool to use.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the POMDP generative model being used.
+             *
+             * @return The POMDP generative model.
+             */
+            const M& getModel() const;
+
+            /**
+             * @brief This function returns a reference to the internal graph structure holding the results of rollouts.
+             *
+             * @return The internal graph.
+             */
+            const HNode& getGraph() const;
+
+            /**
+             * @brief This function returns the initial particle size for converted Beliefs.
+             *
+             * @return The initial particle count.
+             */
+            size_t getBeliefSize() const;
+
+            /**
+             * @brief This function returns the number of iterations performed to plan for an action.
+             *
+             * @return The number of iterations.
+             */
+            unsigned getIterations() const;
+
+            /**
+             * @brief This function returns the currently set exploration constant.
+             *
+             * @return The exploration constant.
+             */
+            double getExploration() const;
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
+        private:
+            struct Worker {
+                // Reseeded at the start of each search.
+                RandomEngine rand;
+            };
+
+            const M& model_;
+            size_t S, A, beliefSize_;
+            unsigned iterations_, maxDepth_;
+            double exploration_;
+            unsigned k_;
+            ThreadPool * pool_;
+
+            // Only used to create head nodes and seed the workers, from
+            // the calling thread.
+            mutable RandomEngine rand_;
+
+            HNode graph_;
+            std::vector<Worker> workers_;
+
+            std::atomic<unsigned> nextIteration_;
+            mutable std::array<std::mutex, LockStripes> locks_;
+            mutable std::mutex modelMutex_;
+
+            // Private Methods
+            void resetGraph(const Belief & b);
+            void reuseGraph(size_t a, size_t o);
+            size_t runSimulation(unsigned horizon);
+            double simulate(BNode & b, size_t s, unsigned depth, RandomEngine & rnd);
+            std::tuple<size_t, size_t, double> sampleSOR(size_t s, size_t a, RandomEngine & rnd) const;
+            std::mutex & getLock(const BNode & b) const;
+
+            void maxBeliefNodeUpdate(BNode * bn, const ANode & aNode, size_t a);
+
+            template <typename Iterator>
+            Iterator findBestA(Iterator begin, Iterator end);
+
+            template <typename Iterator>
+            Iterator findBestBonusA(Iterator begin, Iterator end, unsigned count);
+    };
+
+    template <typename M, bool UseEntropy>
+    ParallelrPOMCP<M, UseEntropy>::ParallelrPOMCP(const M& m, const size_t beliefSize, const unsigned iter, const double exp, const unsigned k, ThreadPool * pool) :
+            model_(m), S(model_.getS()), A(model_.getA()),
+            beliefSize_(beliefSize), iterations_(iter),
+            exploration_(exp), k_(k), pool_(nullptr),
+            rand_(Impl::Seeder::getSeed()), graph_(A, rand_)
+    {
+        setThreadPool(pool);
+    }
+
+    template <typename M, bool UseEntropy>
+    size_t ParallelrPOMCP<M, UseEntropy>::sampleAction(const Belief& b, const unsigned horizon) {
+        resetGraph(b);
+        return runSimulation(horizon);
+    }
+
+    template <typename M, bool UseEntropy>
+    size_t ParallelrPOMCP<M, UseEntropy>::sampleAction(const size_t a, const size_t o, const unsigned horizon) {
+        reuseGraph(a, o);
+        return runSimulation(horizon);
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::resetGraph(const Belief & b) {
+        graph_ = HNode(A, beliefSize_, b, rand_);
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::reuseGraph(const size_t a, const size_t o) {
+        auto & obs = graph_.children[a].children;
+
+        auto it = obs.find(o);
+        if ( it == obs.end() ) {
+            AI_LOGGER(AI_SEVERITY_WARNING, "Observation " << o << " never experienced in simulation, restarting with uniform belief..");
+            auto b = Belief(S); b.fill(1.0/S);
+            resetGraph(b);
+            return;
+        }
+
+        // See rPOMCP::reuseGraph() on why we need a temporary.
+        { BNode tmp = std::move(it->second); graph_ = HNode(A, std::move(tmp), rand_); }
+
+        if ( graph_.isSampleBeliefEmpty() ) {
+            AI_LOGGER(AI_SEVERITY_WARNING, "ParallelrPOMCP lost track of the belief, restarting with uniform..");
+            auto b = Belief(S); b.fill(1.0/S);
+            resetGraph(b);
+        }
+    }
+
+    template <typename M, bool UseEntropy>
+    size_t ParallelrPOMCP<M, UseEntropy>::runSimulation(const unsigned horizon) {
+        if ( !horizon ) return 0;
+
+        maxDepth_ = horizon;
+        nextIteration_.store(0, std::memory_order_relaxed);
+
+        const size_t W = workers_.size();
+        const unsigned seed = rand_();
+
+        const auto work = [this, seed](const size_t begin, const size_t end) {
+            for ( size_t w = begin; w < end; ++w ) {
+                auto & rnd = workers_[w].rand;
+                if constexpr (!is_counter_based_engine_v<RandomEngine>)
+                    rnd = makeEngineStream<RandomEngine>(seed, w);
+
+                // The sample belief of the head is only read during the
+                // search, so it can be sampled without locking.
+                unsigned i;
+                while ( ( i = nextIteration_.fetch_add(1, std::memory_order_relaxed) ) < iterations_ ) {
+                    if constexpr (is_counter_based_engine_v<RandomEngine>)
+                        rnd = makeEngineStream<RandomEngine>(seed, i);
+                    simulate(graph_, graph_.sampleBelief(rnd), 0, rnd);
+                }
+            }
+        };
+        if ( pool_ ) pool_->parallelFor(W, work);
+        else work(0, W);
+
+        auto begin = std::begin(graph_.children);
+        size_t bestA = std::distance(begin, findBestA(begin, std::end(graph_.children)));
+
+        // Since we do not update the root value in simulate,
+        // we do it here.
+        graph_.V = graph_.children[bestA].V;
+        return bestA;
+    }
+
+    template <typename M, bool UseEntropy>
+    double ParallelrPOMCP<M, UseEntropy>::simulate(BNode & b, const size_t s, const unsigned depth, RandomEngine & rnd) {
+        std::unique_lock lock(getLock(b));
+
+        // Since most memory is allocated on the leaves, we do not
+        // allocate on node creation but only when we are actually
+        // descending into a node. This must be done under the lock, as
+        // other threads might be descending here too.
+        b.children.resize(A);
+        // We keep our own copies of the visit counts, since other
+        // threads may increase them while we are descending; this way
+        // our updates are performed as if no other thread was running.
+        const unsigned n = ++b.N;
+
+        // Select next action node
+        auto begin = std::begin(b.children);
+        size_t a = std::distance(begin, findBestBonusA(begin, std::end(b.children), n));
+        auto & aNode = b.children[a];
+        const unsigned an = ++aNode.N;
+
+        lock.unlock();
+
+        // Generate next step
+        size_t s1, o;
+        std::tie(s1, o, std::ignore) = sampleSOR(s, a, rnd);
+
+        BNode * child;
+        bool newNode = false;
+        {
+            lock.lock();
+
+            // The references to elements of an unordered_map are stable,
+            // so we can keep using child after releasing the lock.
+            auto ot = aNode.children.find(o);
+            if ( ot == aNode.children.end() ) {
+                newNode = true;
+                std::tie(ot, std::ignore) = aNode.children.insert(std::make_pair(o, BNode()));
+            }
+            child = &ot->second;
+
+            lock.unlock();
+        }
+
+        // We only go deeper if needed (maxDepth_ is always at least 1).
+        const bool descend = depth + 1 < maxDepth_ && !model_.isTerminal(s1) && !newNode;
+
+        double immAndFutureRew = 0.0;
+        {
+            // The belief of the child is guarded by the child's lock.
+            std::lock_guard childLock(getLock(*child));
+
+            // Compute knowledge for new observation node (entropy/max belief)
+            child->updateBeliefAndKnowledge(s1);
+
+            // Otherwise we increase the N for the bottom leaves, since they can't get it otherwise and is needed for entropy
+            if ( !descend ) {
+                child->N += 1;
+                // For leaves we still extract entropy
+                if ( depth + 1 >= maxDepth_ )
+                    immAndFutureRew = child->getKnowledgeMeasure();
+            }
+        }
+        if ( descend )
+            immAndFutureRew = simulate( *child, s1, depth + 1, rnd );
+
+        lock.lock();
+
+        // Action update
+        aNode.V += ( immAndFutureRew - aNode.V ) / static_cast<double>(an);
+
+        if ( depth == 0 ) return 0.0;
+
+        // See rPOMCP::simulate() for the rationale of this update.
+        if ( n >= k_ ) {
+            // Force looking out for best action
+            if ( n == k_ ) {
+                b.actionsV = HUGE_VAL;
+                b.bestAction = a;
+            }
+            maxBeliefNodeUpdate(&b, aNode, a);
+        }
+        else {
+            b.actionsV += ( immAndFutureRew - b.actionsV ) / static_cast<double>(n);
+        }
+
+        double oldV = b.V;
+        b.V = model_.getDiscount() * b.actionsV + b.getKnowledgeMeasure();
+        return (n - 1)*(b.V - oldV) + b.V;
+    }
+
+    template <typename M, bool UseEntropy>
+    std::tuple<size_t, size_t, double> ParallelrPOMCP<M, UseEntropy>::sampleSOR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        if constexpr (is_generative_model_rng_v<M>) {
+            return model_.sampleSOR(s, a, rnd);
+        } else {
+            std::lock_guard lock(modelMutex_);
+            return model_.sampleSOR(s, a);
+        }
+    }
+
+    template <typename M, bool UseEntropy>
+    std::mutex & ParallelrPOMCP<M, UseEntropy>::getLock(const BNode & b) const {
+        // Fibonacci hashing, so that nodes allocated close to each other
+        // get different locks.
+        const std::uint64_t h = reinterpret_cast<std::uintptr_t>(&b) * 0x9E3779B97F4A7C15ull;
+        return locks_[(h ^ (h >> 32)) % LockStripes];
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::maxBeliefNodeUpdate(BNode * bp, const ANode & aNode, const size_t a) {
+        auto & b = *bp;
+
+        if ( aNode.V >= b.actionsV ) {
+            b.actionsV   = aNode.V;
+            b.bestAction = a;
+        }
+        // Note: This is needed because the value may go down!
+        else if ( a == b.bestAction ) {
+            auto begin = std::begin(b.children);
+            auto it = findBestA(begin, std::end(b.children));
+            b.actionsV   = it->V;
+            b.bestAction = std::distance(begin, it);
+        }
+    }
+
+    template <typename M, bool UseEntropy>
+    template <typename Iterator>
+    Iterator ParallelrPOMCP<M, UseEntropy>::findBestA(const Iterator begin, const Iterator end) {
+        return std::max_element(begin, end, [](const ANode & lhs, const ANode & rhs){ return lhs.V < rhs.V; });
+    }
+
+    template <typename M, bool UseEntropy>
+    template <typename Iterator>
+    Iterator ParallelrPOMCP<M, UseEntropy>::findBestBonusA(Iterator begin, const Iterator end, const unsigned count) {
+        // Count here can be as low as 1.
+        // Since log(1) = 0, and 0/0 = error, we add 1.0.
+        double logCount = std::log(count + 1.0);
+        auto evaluationFunction = [this, logCount](const ANode & an){
+            return an.V + exploration_ * std::sqrt( logCount / an.N );
+        };
+
+        auto bestIterator = begin++;
+        double bestValue = evaluationFunction(*bestIterator);
+
+        for ( ; begin < end; ++begin ) {
+            double actionValue = evaluationFunction(*begin);
+            if ( actionValue > bestValue ) {
+                bestValue = actionValue;
+                bestIterator = begin;
+            }
+        }
+
+        return bestIterator;
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::setBeliefSize(const size_t beliefSize) {
+        beliefSize_ = beliefSize;
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::setIterations(const unsigned iter) {
+        iterations_ = iter;
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::setExploration(const double exp) {
+        exploration_ = exp;
+    }
+
+    template <typename M, bool UseEntropy>
+    void ParallelrPOMCP<M, UseEntropy>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+
+        workers_.clear();
+        workers_.resize(pool_ ? pool_->getThreadNumber() : 1);
+    }
+
+    template <typename M, bool UseEntropy>
+    const M& ParallelrPOMCP<M, UseEntropy>::getModel() const {
+        return model_;
+    }
+
+    template <typename M, bool UseEntropy>
+    const HeadBeliefNode<UseEntropy>& ParallelrPOMCP<M, UseEntropy>::getGraph() const {
+        return graph_;
+    }
+
+    template <typename M, bool UseEntropy>
+    size_t ParallelrPOMCP<M, UseEntropy>::getBeliefSize() const {
+        return beliefSize_;
+    }
+
+    template <typename M, bool UseEntropy>
+    unsigned ParallelrPOMCP<M, UseEntropy>::getIterations() const {
+        return iterations_;
+    }
+
+    template <typename M, bool UseEntropy>
+    double ParallelrPOMCP<M, UseEntropy>::getExploration() const {
+        return exploration_;
+    }
+
+    template <typename M, bool UseEntropy>
+    ThreadPool * ParallelrPOMCP<M, UseEntropy>::getThreadPool() const {
+        return pool_;
+    }
+}
+
+#endif
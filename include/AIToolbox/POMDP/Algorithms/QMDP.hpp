@@ -2,6 +2,7 @@
 #define AI_TOOLBOX_POMDP_QMDP_HEADER_FILE
 
 #include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/ModelContext.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
 
@@ -73,6 +74,26 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction, MDP::QFunction> operator()(const M & m);
 
+            /**
+             * @brief This function applies the QMDP algorithm on the input POMDP, reusing a ModelContext.
+             *
+             * The solution of the underlying MDP is taken from the
+             * context, which computes it only once for each horizon and
+             * tolerance.
+             *
+             * This function throws std::invalid_argument if the context
+             * does not match the size of the model.
+             *
+             * @param m The POMDP to be solved
+             * @param context The ModelContext of the input POMDP.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction, the computed ValueFunction and the
+             *         equivalent MDP::QFunction.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction, MDP::QFunction> operator()(const M & m, const ModelContext & context);
+
             /**
              * @brief This function converts an MDP::QFunction into the equivalent POMDP VList.
              *
@@ -141,6 +162,20 @@ namespace AIToolbox::POMDP {
 
         return std::make_tuple(std::get<0>(solution), v, std::move(std::get<2>(solution)));
     }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction, MDP::QFunction> QMDP::operator()(const M & m, const ModelContext & context) {
+        if ( context.getS() != m.getS() || context.getA() != m.getA() || context.getO() != m.getO() )
+            throw std::invalid_argument("The ModelContext does not match the model.");
+
+        const auto & [variation, mdpv, q] = context.getMDPSolution(getHorizon(), getTolerance());
+        (void)mdpv;
+
+        auto v = makeValueFunction(m.getS());
+        v.emplace_back(fromQFunction(m.getO(), q));
+
+        return std::make_tuple(variation, v, q);
+    }
 }
 
 #endif
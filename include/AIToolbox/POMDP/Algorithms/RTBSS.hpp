@@ -1,12 +1,22 @@
 #ifndef AI_TOOLBOX_POMDP_RTBSS_HEADER_FILE
 #define AI_TOOLBOX_POMDP_RTBSS_HEADER_FILE
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
 
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/POMDP/BeliefUpdateCache.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::POMDP {
     /**
@@ -18,20 +28,35 @@ namespace AIToolbox::POMDP {
      *
      * Additionally, it uses an heuristic function in order to prune
      * branches which cannot possibly help in determining which action is
-     * the actual best. Currently this heuristic is very crude, as it
-     * requires the user to manually input a maximum possible reward, and
-     * using it as an upper bound.
+     * the actual best. The upper bound used is the smaller between a
+     * crude bound based on a user-provided maximum reward, and the
+     * finite-horizon QMDP bound, which is computed once per horizon on the
+     * underlying MDP and cached. Actions are also explored from the most
+     * to the least promising according to this bound, to maximize pruning.
+     *
+     * Since different action-observation paths often lead to the same
+     * belief, the values of the subtrees are stored in a transposition
+     * table, keyed on the belief (quantized with a configurable
+     * resolution) and the remaining horizon. The table is kept between
+     * calls to sampleAction(), so that consecutive calls from nearby
+     * beliefs can reuse work. Its size can be bounded with
+     * setMaxTableSize(); once full, it is cleared.
+     *
+     * If a ThreadPool is set, the subtrees of the actions at the root are
+     * explored in parallel, each with its own transposition table.
+     * This gives up pruning between root actions, in exchange for using
+     * all threads.
      *
-     * Additionally, in theory one would want to explore branches from the
-     * most promising to the least promising, to maximize pruning. This is
-     * currently not done here, since an heuristic is intrinsically
-     * determined by a particular problem. At the same time, it is easy to
-     * add one, as the code specifies where one should be inserted.
+     * If a BeliefUpdateCache is set, belief updates are taken from it
+     * rather than computed. As it can be shared between threads and
+     * between planners, this avoids recomputing the updates of beliefs
+     * met again in later calls, or by other planners on the same model.
      *
      * This method is able to return not only the best available action,
      * but also the (in theory) true value of that action in the current
      * belief. Note that values computed in different methods may differ
-     * due to floating point approximation errors.
+     * due to floating point approximation errors, and (slightly) due to
+     * the quantization of the transposition table.
      */
     template <typename M>
     class RTBSS {
@@ -44,8 +69,9 @@ namespace AIToolbox::POMDP {
              *
              * @param m The POMDP model that POMCP will operate upon.
              * @param maxR The max reward obtainable in the model. This is used for the pruning heuristic.
+             * @param pool The ThreadPool to use for the root actions, or nullptr.
              */
-            RTBSS(const M& m, double maxR);
+            RTBSS(const M& m, double maxR, ThreadPool * pool = nullptr);
 
             /**
              * @brief This function computes the best value for a given belief and its value.
@@ -57,6 +83,80 @@ namespace AIToolbox::POMDP {
              */
             std::tuple<size_t, double> sampleAction(const Belief& b, unsigned horizon);
 
+            /**
+             * @brief This function sets the resolution used to quantize beliefs in the transposition table.
+             *
+             * Beliefs which quantize to the same values share the same
+             * entry. Larger values give more hits, but values become
+             * less precise. Changing the resolution clears the table.
+             *
+             * This function throws std::invalid_argument if the input is
+             * not positive.
+             *
+             * @param resolution The new resolution.
+             */
+            void setTableResolution(double resolution);
+
+            /**
+             * @brief This function returns the currently set table resolution.
+             */
+            double getTableResolution() const;
+
+            /**
+             * @brief This function sets the maximum number of entries of each transposition table.
+             *
+             * When a table is full it is cleared. Zero disables the table.
+             *
+             * @param size The new maximum size.
+             */
+            void setMaxTableSize(size_t size);
+
+            /**
+             * @brief This function returns the currently set maximum table size.
+             */
+            size_t getMaxTableSize() const;
+
+            /**
+             * @brief This function returns the number of entries in the transposition tables.
+             */
+            size_t getTableSize() const;
+
+            /**
+             * @brief This function clears the transposition tables.
+             */
+            void clearTable();
+
+            /**
+             * @brief This function sets the ThreadPool to use for the root actions.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * it (or be unset before being destroyed).
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             */
+            ThreadPool * getThreadPool() const;
+
+            /**
+             * @brief This function sets the cache to use for belief updates.
+             *
+             * The cache is not owned by this class, and must outlive it
+             * (or be unset before being destroyed). It must have been
+             * built for the same model.
+             *
+             * @param cache The cache to use, or nullptr.
+             */
+            void setBeliefUpdateCache(const BeliefUpdateCache * cache);
+
+            /**
+             * @brief This function returns the currently set belief update cache.
+             */
+            const BeliefUpdateCache * getBeliefUpdateCache() const;
+
             /**
              * @brief This function returns the POMDP model being used.
              *
@@ -65,97 +165,303 @@ namespace AIToolbox::POMDP {
             const M& getModel() const;
 
         private:
+            struct Key {
+                std::vector<long long> belief;
+                unsigned horizon;
+
+                bool operator==(const Key & other) const {
+                    return horizon == other.horizon && belief == other.belief;
+                }
+            };
+            struct KeyHash {
+                size_t operator()(const Key & k) const {
+                    size_t seed = k.horizon;
+                    boost::hash_range(seed, std::begin(k.belief), std::end(k.belief));
+                    return seed;
+                }
+            };
+            using Table = std::unordered_map<Key, double, KeyHash>;
+
             const M& model_;
             size_t S, A, O;
-            size_t maxA_, maxDepth_;
             double maxR_;
 
+            double resolution_;
+            size_t maxTableSize_;
+            ThreadPool * pool_;
+            const BeliefUpdateCache * beliefCache_;
+            // One table per root action when using a pool, otherwise a single one.
+            std::vector<Table> tables_;
+
+            // The QMDP QFunctions for each horizon, and the immediate rewards.
+            std::vector<Matrix2D> qmdp_;
+            Matrix2D ir_;
+
             /**
-             * @brief This function performs the actual work of computing the best action and its value.
-             *
-             * Note that the best action is saved through the class variable
-             * maxA_, and is not directly returned here. This is mostly because
-             * knowing the best action is only useful at the top level, and
-             * not in the lower levels.
+             * @brief This function performs the actual work of computing the best value of a belief.
              *
              * @param b The belief to plan for.
              * @param horizon The horizon to plan for.
+             * @param table The transposition table to use.
              *
              * @return The value of the best action.
              */
-            double simulate(const Belief & b, unsigned horizon);
+            double simulate(const Belief & b, unsigned horizon, Table & table);
+
+            /**
+             * @brief This function computes the value of a single action from a belief.
+             *
+             * @param b The belief to plan for.
+             * @param a The action to evaluate.
+             * @param horizon The horizon to plan for.
+             * @param table The transposition table to use.
+             *
+             * @return The value of the action.
+             */
+            double evaluate(const Belief & b, size_t a, unsigned horizon, Table & table);
+
+            /**
+             * @brief This function sorts the actions from the most to the least promising.
+             *
+             * @param b The belief where the actions are performed.
+             * @param horizon The timesteps remaining, including the current one.
+             * @param bounds The output bounds, indexed by action.
+             * @param order The output order of the actions.
+             */
+            void sortActions(const Belief & b, unsigned horizon, std::vector<double> * bounds, std::vector<size_t> * order) const;
 
             /**
              * @brief This function represents an heuristic to prune branches.
              *
-             * This function is currently very crude, and it needs to be
-             * improved for your particular problem. The idea is to return
-             * the *future* reward that can be gained from a particular belief
-             * after performing a specific action (so it needs to be discounted).
+             * The idea is to return the *total* reward that can be gained
+             * from a particular belief when performing a specific action,
+             * including the immediate reward.
              *
              * This upper bound must always overestimate the true value, but the
              * closer it is to the true value the more pruning will be possible
              * and the faster the method will run.
              *
-             * @param b The belief from where we want to guess the future reward.
+             * @param b The belief from where we want to guess the reward.
              * @param a The action performed from the belief.
-             * @param horizon The timesteps remaining till the end.
+             * @param horizon The timesteps remaining, including the current one.
              *
              * @return An overestimate of the reward that is possible to gain.
              */
             double upperBound(const Belief & b, size_t a, unsigned horizon) const;
+
+            /**
+             * @brief This function makes sure that the QMDP bounds are available up to the input horizon.
+             */
+            void computeBounds(unsigned horizon);
+
+            /**
+             * @brief This function creates the transposition table key for a belief.
+             */
+            Key makeKey(const Belief & b, unsigned horizon) const;
     };
 
     template <typename M>
-    RTBSS<M>::RTBSS(const M& m, const double maxR) :
+    RTBSS<M>::RTBSS(const M& m, const double maxR, ThreadPool * pool) :
             model_(m), S(model_.getS()), A(model_.getA()),
-            O(model_.getO()), maxR_(maxR) {}
+            O(model_.getO()), maxR_(maxR), resolution_(1e-9),
+            maxTableSize_(1000000), pool_(nullptr), beliefCache_(nullptr), tables_(1),
+            ir_(MDP::computeImmediateRewards(model_))
+    {
+        // The QMDP bound with no timesteps left is zero.
+        qmdp_.emplace_back(Matrix2D::Zero(S, A));
+        setThreadPool(pool);
+    }
 
     template <typename M>
     std::tuple<size_t, double> RTBSS<M>::sampleAction(const Belief& b, const unsigned horizon) {
-        maxA_ = 0; maxDepth_ = horizon;
+        if ( horizon == 0 ) return std::make_tuple(0, 0.0);
+        computeBounds(horizon);
 
-        const double value = simulate(b, horizon);
+        std::vector<double> bounds;
+        std::vector<size_t> actionList;
+        sortActions(b, horizon, &bounds, &actionList);
+
+        size_t maxA = actionList[0];
+        double max = -std::numeric_limits<double>::infinity();
 
-        return std::make_tuple(maxA_, value);
+        if ( pool_ ) {
+            // Each action is evaluated fully with its own table, so that
+            // concurrent blocks never share one.
+            std::vector<double> values(A);
+            pool_->parallelFor(A, 1, [&](const size_t begin, const size_t end) {
+                for ( size_t i = begin; i < end; ++i )
+                    values[i] = evaluate(b, actionList[i], horizon, tables_[actionList[i]]);
+            });
+            for ( size_t i = 0; i < A; ++i ) {
+                if ( values[i] > max ) {
+                    max = values[i];
+                    maxA = actionList[i];
+                }
+            }
+        } else {
+            for ( auto a : actionList ) {
+                if ( bounds[a] <= max ) break;
+                const double value = evaluate(b, a, horizon, tables_[0]);
+                if ( value > max ) {
+                    max = value;
+                    maxA = a;
+                }
+            }
+        }
+        return std::make_tuple(maxA, max);
     }
 
     template <typename M>
-    double RTBSS<M>::simulate(const Belief & b, const unsigned horizon) {
+    double RTBSS<M>::simulate(const Belief & b, const unsigned horizon, Table & table) {
         if ( horizon == 0 ) return 0;
 
-        std::vector<size_t> actionList(A);
+        const bool useTable = maxTableSize_ > 0;
+        Key key;
+        if ( useTable ) {
+            key = makeKey(b, horizon);
+            const auto it = table.find(key);
+            if ( it != std::end(table) ) return it->second;
+        }
 
-        // Here we use no heuristic to sort the actions. If you want one
-        // add it here!
-        std::iota(std::begin(actionList), std::end(actionList), 0);
+        std::vector<double> bounds;
+        std::vector<size_t> actionList;
+        sortActions(b, horizon, &bounds, &actionList);
 
         double max = -std::numeric_limits<double>::infinity();
-
         for ( auto a : actionList ) {
-            double rew = beliefExpectedReward(model_, b, a);
-
-            const double uBound = rew + upperBound(b, a, horizon - 1);
-            if ( uBound > max ) {
-                for ( size_t o = 0; o < O; ++o ) {
-                    const auto nextBelief = updateBeliefUnnormalized(model_, b, a, o);
-                    const double sum = nextBelief.sum();
-                    // Only work if it makes sense
-                    if ( checkDifferentSmall(sum, 0.0) )
-                        rew += model_.getDiscount() * sum * simulate(nextBelief / sum, horizon - 1);
-                }
+            // Actions are sorted by bound, so no later action can do better.
+            if ( bounds[a] <= max ) break;
+            max = std::max(max, evaluate(b, a, horizon, table));
+        }
+
+        if ( useTable ) {
+            if ( table.size() >= maxTableSize_ ) table.clear();
+            table.emplace(std::move(key), max);
+        }
+        return max;
+    }
+
+    template <typename M>
+    double RTBSS<M>::evaluate(const Belief & b, const size_t a, const unsigned horizon, Table & table) {
+        double rew = beliefExpectedReward(model_, b, a);
+        if ( horizon == 1 ) return rew;
+
+        if ( beliefCache_ ) {
+            for ( size_t o = 0; o < O; ++o ) {
+                const auto next = beliefCache_->update(b, a, o);
+                if ( checkDifferentSmall(next->probability, 0.0) )
+                    rew += model_.getDiscount() * next->probability * simulate(next->belief, horizon - 1, table);
             }
-            if ( rew > max ) {
-                max = rew;
-                if ( horizon == maxDepth_ ) maxA_ = a;
+            return rew;
+        }
+
+        Belief nextBelief(S);
+        for ( size_t o = 0; o < O; ++o ) {
+            updateBeliefUnnormalized(model_, b, a, o, &nextBelief);
+            const double sum = nextBelief.sum();
+            // Only work if it makes sense
+            if ( checkDifferentSmall(sum, 0.0) ) {
+                nextBelief /= sum;
+                rew += model_.getDiscount() * sum * simulate(nextBelief, horizon - 1, table);
             }
         }
-        return max;
+        return rew;
+    }
+
+    template <typename M>
+    void RTBSS<M>::sortActions(const Belief & b, const unsigned horizon, std::vector<double> * bounds, std::vector<size_t> * order) const {
+        bounds->resize(A);
+        for ( size_t a = 0; a < A; ++a )
+            (*bounds)[a] = upperBound(b, a, horizon);
+
+        order->resize(A);
+        std::iota(std::begin(*order), std::end(*order), 0);
+        // Stable, so that ties keep the order of the actions.
+        std::stable_sort(std::begin(*order), std::end(*order), [bounds](const size_t lhs, const size_t rhs) {
+            return (*bounds)[lhs] > (*bounds)[rhs];
+        });
+    }
+
+    template <typename M>
+    double RTBSS<M>::upperBound(const Belief & b, const size_t a, const unsigned horizon) const {
+        const double crude = b.dot(ir_.col(a)) + model_.getDiscount() * maxR_ * (horizon - 1);
+        return std::min(crude, b.dot(qmdp_[horizon].col(a)));
+    }
+
+    template <typename M>
+    void RTBSS<M>::computeBounds(const unsigned horizon) {
+        while ( qmdp_.size() <= horizon ) {
+            const MDP::Values v = qmdp_.back().rowwise().maxCoeff() * model_.getDiscount();
+            qmdp_.emplace_back(MDP::computeQFunction(model_, v, ir_));
+        }
+    }
+
+    template <typename M>
+    typename RTBSS<M>::Key RTBSS<M>::makeKey(const Belief & b, const unsigned horizon) const {
+        Key key{std::vector<long long>(S), horizon};
+        for ( size_t s = 0; s < S; ++s )
+            key.belief[s] = std::llround(b[s] / resolution_);
+        return key;
+    }
+
+    template <typename M>
+    void RTBSS<M>::setTableResolution(const double resolution) {
+        if ( resolution <= 0.0 ) throw std::invalid_argument("Table resolution must be positive");
+        resolution_ = resolution;
+        clearTable();
+    }
+
+    template <typename M>
+    double RTBSS<M>::getTableResolution() const {
+        return resolution_;
+    }
+
+    template <typename M>
+    void RTBSS<M>::setMaxTableSize(const size_t size) {
+        maxTableSize_ = size;
+        for ( auto & t : tables_ )
+            if ( t.size() > maxTableSize_ ) t.clear();
+    }
+
+    template <typename M>
+    size_t RTBSS<M>::getMaxTableSize() const {
+        return maxTableSize_;
+    }
+
+    template <typename M>
+    size_t RTBSS<M>::getTableSize() const {
+        size_t retval = 0;
+        for ( const auto & t : tables_ )
+            retval += t.size();
+        return retval;
+    }
+
+    template <typename M>
+    void RTBSS<M>::clearTable() {
+        for ( auto & t : tables_ )
+            t.clear();
+    }
+
+    template <typename M>
+    void RTBSS<M>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+        // With a pool each root action gets its own table.
+        tables_.resize(pool_ ? A : 1);
+    }
+
+    template <typename M>
+    ThreadPool * RTBSS<M>::getThreadPool() const {
+        return pool_;
+    }
+
+    template <typename M>
+    void RTBSS<M>::setBeliefUpdateCache(const BeliefUpdateCache * cache) {
+        beliefCache_ = cache;
     }
 
     template <typename M>
-    double RTBSS<M>::upperBound(const Belief &, const size_t, const unsigned horizon) const {
-        return model_.getDiscount() * maxR_ * horizon;
+    const BeliefUpdateCache * RTBSS<M>::getBeliefUpdateCache() const {
+        return beliefCache_;
     }
 
     template <typename M>
@@ -1,16 +1,40 @@
 #ifndef AI_TOOLBOX_POMDP_BELIEF_GENERATOR_HEADER_FILE
 #define AI_TOOLBOX_POMDP_BELIEF_GENERATOR_HEADER_FILE
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 
 #include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
 
 namespace AIToolbox::POMDP {
     /**
      * @brief This class generates reachable beliefs from a given Model.
+     *
+     * New beliefs are found by sampling successors of the beliefs already
+     * in the list, and keeping for each the one furthest away in L1
+     * distance from the list. The successors of a batch of beliefs are
+     * sampled and compared independently from each other, optionally in
+     * parallel (see setThreadPool()).
+     *
+     * To find the closest belief to a successor without comparing it to
+     * the whole list, the beliefs are kept sorted by a projection which
+     * bounds their L1 distance from below. The L1 distance of sparse
+     * successors, which are common in models with many states, is computed
+     * only over their support.
+     *
+     * If the model can sample whole batches of transitions (see
+     * is_generative_model_batch), all successors of a belief for the same
+     * action are sampled with a single sampleSORBatch() call. Models
+     * which can also be sampled with external random engines are instead
+     * sampled one transition at a time, so that the generated beliefs do
+     * not depend on the number of threads.
      */
     template <typename M>
     class BeliefGenerator {
@@ -57,7 +81,45 @@ namespace AIToolbox::POMDP {
              */
             void operator()(size_t beliefNumber, BeliefList * bl) const;
 
+            /**
+             * @brief This function sets the ThreadPool used to generate beliefs.
+             *
+             * The successors of the beliefs in the list are sampled and
+             * compared to the list in parallel. The generated beliefs are
+             * the same regardless of the number of threads used.
+             *
+             * The pool is only used if the model can be sampled with an
+             * external random engine (see is_generative_model_rng).
+             *
+             * The pool is not owned, and must outlive its use. A nullptr
+             * (the default) disables parallelism.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool);
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const;
+
         private:
+            using Index = std::vector<std::pair<double, size_t>>;
+
+            /**
+             * @brief This function projects a belief onto a line.
+             *
+             * The projection alternates the signs of the elements of the
+             * belief, so that the distance between the projections of two
+             * beliefs is never more than their L1 distance.
+             *
+             * @param b The belief to project.
+             *
+             * @return The projection of the belief.
+             */
+            static double project(const Belief & b);
 
             /**
              * @brief This function uses the model to generate new Beliefs, and adds them to the provided list.
@@ -70,17 +132,37 @@ namespace AIToolbox::POMDP {
              */
             void expandBeliefList(size_t max, size_t firstProductiveBelief, BeliefList * bl) const;
 
+            /**
+             * @brief This function samples successors of a belief, and returns the one furthest away from a list.
+             *
+             * @param b The belief to sample successors of.
+             * @param bl The list to compare successors against.
+             * @param index The projections of the elements of the list to compare against, sorted.
+             * @param rand The generator to sample with.
+             * @param best The output successor, only set if the returned distance is positive.
+             * @param helper1 A buffer of size S.
+             * @param helper2 A buffer of size S.
+             * @param support A buffer for the support of each successor.
+             *
+             * @return The L1 distance of the found successor from its closest belief in the list.
+             */
+            double findFurthestSuccessor(const Belief & b, const BeliefList & bl, const Index & index, RandomEngine & rand, Belief * best, Belief * helper1, Belief * helper2, std::vector<size_t> * support) const;
+
+            // Whether the successors are sampled in batches.
+            static constexpr bool SampleBatches = is_generative_model_batch_v<M> && !is_generative_model_rng_v<M>;
+
             const M& model_;
             size_t S, A;
-            mutable Belief helper1_, helper2_; // These are used to avoid reallocating memory all the time.
+            ThreadPool * pool_;
 
             mutable RandomEngine rand_;
+            mutable TransitionBatch samples_;
     };
 
     template <typename M>
     BeliefGenerator<M>::BeliefGenerator(const M& model) :
             model_(model), S(model_.getS()), A(model_.getA()),
-            helper1_(S), helper2_(S), rand_(Impl::Seeder::getSeed()) {}
+            pool_(nullptr), rand_(Impl::Seeder::getSeed()) {}
 
     template <typename M>
     typename BeliefGenerator<M>::BeliefList BeliefGenerator<M>::operator()(const size_t beliefNumber) const {
@@ -125,80 +207,195 @@ namespace AIToolbox::POMDP {
                 }
             }
             firstProductiveBelief = beliefs.size();
-            for ( size_t i = 0; currentSize < beliefNumber && i < bonusBeliefsToAdd; ++i, ++currentSize )
-                beliefs.emplace_back(makeRandomProbability(S, rand_));
+            const auto bonus = makeRandomProbabilities(std::min(bonusBeliefsToAdd, beliefNumber - currentSize), S, rand_);
+            for ( Eigen::Index i = 0; i < bonus.rows(); ++i, ++currentSize )
+                beliefs.emplace_back(bonus.row(i).transpose());
         }
     }
 
+    template <typename M>
+    void BeliefGenerator<M>::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    template <typename M>
+    ThreadPool * BeliefGenerator<M>::getThreadPool() const {
+        return pool_;
+    }
+
     template <typename M>
     void BeliefGenerator<M>::expandBeliefList(const size_t max, const size_t firstProductiveBelief, BeliefList * blp) const {
         assert(blp);
         auto & bl = *blp;
 
-        std::vector<Belief> newBeliefs(A);
-        std::vector<double> distances(A);
-        auto dBegin = std::begin(distances), dEnd = std::end(distances);
+        // We process the productive beliefs in fixed-size batches, so that
+        // the generated beliefs do not depend on the number of threads.
+        // Within a batch, each belief samples its candidates with its own
+        // generator, and compares them against the beliefs that existed
+        // before the batch started; the winners are then checked serially
+        // against each other before being added.
+        constexpr size_t BatchSize = 64;
+        std::vector<Belief> candidates(BatchSize);
+        std::vector<double> distances(BatchSize);
 
-        // L1 distance
-        const auto computeDistance = [this](const Belief & lhs, const Belief & rhs) {
-            return (lhs - rhs).cwiseAbs().sum();
-        };
+        // The beliefs sorted by their projection, to quickly find which are
+        // close to a candidate.
+        Index index;
+        index.reserve(max);
+        for ( size_t k = 0; k < bl.size(); ++k )
+            index.emplace_back(project(bl[k]), k);
+        std::sort(std::begin(index), std::end(index));
 
-        constexpr unsigned jMax = 20;
-        std::array<size_t, jMax> observationBuffer;
         // We apply the discovery process also to all beliefs we discover
         // along the way. We start from the first good one, since the others
         // have already produced as much as they can.
-        for (size_t i = firstProductiveBelief; i < bl.size(); ++i) {
-            // Compute all new beliefs
-            for ( size_t a = 0; a < A; ++a ) {
-                double distance = std::numeric_limits<double>::max();
-                distances[a] = 0.0;
-                size_t bufferFill = 0;
-                updateBeliefPartial(model_, bl[i], a, &helper1_);
-                for (unsigned j = 0; j < jMax; ++j) {
-                    const size_t s = sampleProbability(S, bl[i], rand_);
-
-                    size_t o;
-                    std::tie(std::ignore, o, std::ignore) = model_.sampleSOR(s, a);
-
-                    // Check the new observation against the ones we have already
-                    // produced this round. If it passes, add it to them.
-                    bool pass = true;
-                    for ( unsigned k = 0; k < bufferFill; ++k ) {
-                        if (o == observationBuffer[k]) {
-                            pass = false;
-                            break;
-                        }
-                    }
-                    if (!pass) continue;
+        for ( size_t i = firstProductiveBelief; i < bl.size(); i += BatchSize ) {
+            const size_t batch = std::min(BatchSize, bl.size() - i);
+            const size_t oldSize = bl.size();
 
-                    // If we haven't had this observation before, we can update the belief.
-                    observationBuffer[bufferFill++] = o;
-                    updateBeliefPartialNormalized(model_, helper1_, a, o, &helper2_);
+            const unsigned seed = rand_();
 
-                    // Now check the new belief's distance against all others.
-                    for (size_t k = 0; k < bl.size(); ++k) {
-                        distance = std::min(distance, computeDistance(helper2_, bl[k]));
-                        if (distance <= distances[a]) break;
-                    }
-                    // Select the best found over 20 times, or just set this one if
-                    // we hadn't set it before (this may speed up generation as the
-                    // one we have created gets instantly checked next round, possibly
-                    // saving us a lot of work).
-                    if ( distance > distances[a] || distances[a] == 0.0) {
-                        distances[a] = distance;
-                        newBeliefs[a] = helper2_;
-                    }
+            auto run = [&](const size_t begin, const size_t end) {
+                Belief helper1(S), helper2(S);
+                std::vector<size_t> support;
+                for ( size_t k = begin; k < end; ++k ) {
+                    auto rand = makeEngineStream<RandomEngine>(seed, k);
+                    distances[k] = findFurthestSuccessor(bl[i + k], bl, index, rand, &candidates[k], &helper1, &helper2, &support);
+                }
+            };
+            // Models which can't be sampled with external engines must be
+            // sampled from a single thread.
+            if ( pool_ && is_generative_model_rng_v<M> ) pool_->parallelFor(batch, run);
+            else run(0, batch);
+
+            for ( size_t k = 0; k < batch; ++k ) {
+                double distance = distances[k];
+                for ( size_t j = oldSize; j < bl.size() && checkDifferentSmall(distance, 0.0); ++j )
+                    distance = std::min(distance, (candidates[k] - bl[j]).template lpNorm<1>());
+
+                // Add the furthest away only if it is new.
+                if ( checkDifferentSmall(distance, 0.0) ) {
+                    bl.emplace_back(std::move(candidates[k]));
+                    if ( bl.size() >= max ) return;
                 }
             }
-            // Find furthest away, add only if it is new.
-            size_t id = std::distance( dBegin, std::max_element(dBegin, dEnd) );
-            if ( checkDifferentSmall(distances[id], 0.0) ) {
-                bl.emplace_back(std::move(newBeliefs[id]));
-                if ( bl.size() >= max ) break;
+
+            const auto middle = index.size();
+            for ( size_t k = oldSize; k < bl.size(); ++k )
+                index.emplace_back(project(bl[k]), k);
+            std::sort(std::begin(index) + middle, std::end(index));
+            std::inplace_merge(std::begin(index), std::begin(index) + middle, std::end(index));
+        }
+    }
+
+    template <typename M>
+    double BeliefGenerator<M>::project(const Belief & b) {
+        double retval = 0.0;
+        for ( Eigen::Index s = 0; s < b.size(); ++s )
+            retval += s % 2 ? -b[s] : b[s];
+        return retval;
+    }
+
+    template <typename M>
+    double BeliefGenerator<M>::findFurthestSuccessor(const Belief & b, const BeliefList & bl, const Index & index, RandomEngine & rand, Belief * best, Belief * helper1, Belief * helper2, std::vector<size_t> * support) const {
+        constexpr unsigned jMax = 20;
+        std::array<size_t, jMax> observationBuffer;
+
+        double bestDistance = 0.0;
+        for ( size_t a = 0; a < A; ++a ) {
+            size_t bufferFill = 0;
+            updateBeliefPartial(model_, b, a, helper1);
+            if constexpr (SampleBatches) {
+                // Batched models are never sampled from multiple threads
+                // (see expandBeliefList()), so the buffer can be shared.
+                samples_.states.resize(jMax);
+                samples_.actions.assign(jMax, a);
+                samples_.nextStates.resize(jMax);
+                samples_.observations.resize(jMax);
+                samples_.rewards.resize(jMax);
+                for ( auto & s : samples_.states )
+                    s = sampleProbability(S, b, rand);
+
+                model_.sampleSORBatch(&samples_);
+            }
+            for (unsigned j = 0; j < jMax; ++j) {
+                size_t o;
+                if constexpr (SampleBatches) {
+                    o = samples_.observations[j];
+                } else {
+                    const size_t s = sampleProbability(S, b, rand);
+                    if constexpr (is_generative_model_rng_v<M>)
+                        std::tie(std::ignore, o, std::ignore) = model_.sampleSOR(s, a, rand);
+                    else
+                        std::tie(std::ignore, o, std::ignore) = model_.sampleSOR(s, a);
+                }
+
+                // Check the new observation against the ones we have already
+                // produced this round. If it passes, add it to them.
+                bool pass = true;
+                for ( unsigned k = 0; k < bufferFill; ++k ) {
+                    if (o == observationBuffer[k]) {
+                        pass = false;
+                        break;
+                    }
+                }
+                if (!pass) continue;
+
+                // If we haven't had this observation before, we can update the belief.
+                observationBuffer[bufferFill++] = o;
+                updateBeliefPartialNormalized(model_, *helper1, a, o, helper2);
+                const auto & candidate = *helper2;
+
+                // For sparse beliefs, which are common in large models, we
+                // only look at the states in the support of the candidate.
+                // Since all beliefs sum to one, the L1 distance from a
+                // belief is then the distance over the support, plus the
+                // mass the belief puts outside of it.
+                support->clear();
+                for ( size_t s = 0; s < S; ++s )
+                    if ( candidate[s] != 0.0 ) support->push_back(s);
+                const bool sparse = support->size() * 4 <= S;
+
+                const auto computeDistance = [&](const Belief & other) {
+                    if ( !sparse ) return (candidate - other).template lpNorm<1>();
+
+                    double distance = 1.0;
+                    for ( const auto s : *support )
+                        distance += std::fabs(candidate[s] - other[s]) - other[s];
+                    return distance;
+                };
+
+                // We look for the candidate that is furthest away from its
+                // closest belief, so we can stop as soon as it gets closer
+                // to one than the best we have found so far. Successors
+                // tend to be close to their parent, so we start from it.
+                //
+                // Beliefs with a projection further than the current
+                // distance can't be closer, so we only visit the index
+                // outwards from the candidate's projection, until both
+                // sides are out of range.
+                double distance = computeDistance(b);
+                const double key = project(candidate);
+                auto up = std::lower_bound(std::begin(index), std::end(index), std::make_pair(key, size_t(0)));
+                auto down = up;
+                while ( distance > bestDistance ) {
+                    const bool canUp = up != std::end(index) && up->first - key < distance;
+                    const bool canDown = down != std::begin(index) && key - std::prev(down)->first < distance;
+                    if ( !canUp && !canDown ) break;
+
+                    if ( canUp && ( !canDown || up->first - key <= key - std::prev(down)->first ) )
+                        distance = std::min(distance, computeDistance(bl[(up++)->second]));
+                    else
+                        distance = std::min(distance, computeDistance(bl[(--down)->second]));
+                }
+
+                if ( distance > bestDistance ) {
+                    bestDistance = distance;
+                    *best = candidate;
+                }
             }
         }
+        return bestDistance;
     }
 }
 
@@ -0,0 +1,269 @@
+#ifndef AI_TOOLBOX_POMDP_PARTICLE_BELIEF_HEADER_FILE
+#define AI_TOOLBOX_POMDP_PARTICLE_BELIEF_HEADER_FILE
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <AIToolbox/POMDP/Types.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class represents a compact weighted particle belief.
+     *
+     * Rather than storing a copy of a state for every particle, this class
+     * stores each distinct state once, together with the number of
+     * particles that fell on it. Particles are kept sorted by state, so
+     * that adding a particle to an existing state is a binary search.
+     *
+     * The number of distinct states stored can be capped. A cap of zero
+     * means that the belief is unbounded. Once the cap is reached,
+     * particles for states that are already present are still counted,
+     * while particles for new states are merged with the stored state with
+     * the fewest particles: the merged particle takes the sum of the two
+     * counts, and either state with probability proportional to its count.
+     * Thus no particle is lost, and the expected count of every state is
+     * the same as in an unbounded belief, regardless of the order in which
+     * the states arrive.
+     */
+    class ParticleBelief {
+        public:
+            using Particle = std::pair<size_t, unsigned>;
+            using Particles = std::vector<Particle>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param maxSize The maximum number of distinct states to store, or zero for no limit.
+             */
+            ParticleBelief(size_t maxSize = 0);
+
+            /**
+             * @brief This function adds particles for the input state.
+             *
+             * If the belief is full and does not contain the input state,
+             * the particles are discarded.
+             *
+             * @param s The state of the particles.
+             * @param count The number of particles to add.
+             *
+             * @return Whether the particles were stored, or discarded since the belief is full.
+             */
+            bool add(size_t s, unsigned count = 1);
+
+            /**
+             * @brief This function adds particles for the input state, merging them if the belief is full.
+             *
+             * If the belief is full and does not contain the input state,
+             * the particles are merged with the stored state with the
+             * fewest particles (see the class description), so they are
+             * never discarded.
+             *
+             * @param s The state of the particles.
+             * @param count The number of particles to add.
+             * @param rnd The random engine to use.
+             */
+            template <typename Gen>
+            void add(size_t s, unsigned count, Gen & rnd);
+
+            /**
+             * @brief This function samples a state from the belief.
+             *
+             * States are sampled proportionally to their particle count.
+             * The belief must not be empty.
+             *
+             * @param rnd The random engine to use.
+             *
+             * @return A state sampled from the belief.
+             */
+            template <typename Gen>
+            size_t sample(Gen & rnd) const;
+
+            /**
+             * @brief This function removes all particles from the belief.
+             *
+             * The allocated memory is kept, so that the belief can be
+             * refilled cheaply.
+             */
+            void clear();
+
+            /**
+             * @brief This function sets the maximum number of distinct states to store.
+             *
+             * If the belief already contains more distinct states than the
+             * new cap they are kept; only new states are affected.
+             *
+             * @param maxSize The maximum number of distinct states, or zero for no limit.
+             */
+            void setMaxSize(size_t maxSize);
+
+            /**
+             * @brief This function returns the maximum number of distinct states to store.
+             *
+             * @return The maximum number of distinct states, or zero for no limit.
+             */
+            size_t getMaxSize() const;
+
+            /**
+             * @brief This function returns the number of distinct states in the belief.
+             *
+             * @return The number of distinct states.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the total number of particles in the belief.
+             *
+             * @return The sum of all particle counts.
+             */
+            unsigned getCount() const;
+
+            /**
+             * @brief This function returns whether the belief contains no particles.
+             *
+             * @return True if the belief is empty, false otherwise.
+             */
+            bool empty() const;
+
+            /**
+             * @brief This function returns the stored particles, sorted by state.
+             *
+             * @return The particles of the belief.
+             */
+            const Particles & getParticles() const;
+
+        private:
+            Particles particles_;
+            size_t maxSize_;
+            unsigned count_;
+    };
+
+    /**
+     * @brief This function creates a particle approximation of a belief.
+     *
+     * The particles are drawn with systematic resampling: a single random
+     * offset places the particles at evenly spaced points of the
+     * cumulative distribution of the belief. This takes a single pass
+     * over the belief, so it is O(S + particles), rather than the
+     * O(S * particles) of sampling each particle independently. Each
+     * state then receives either the floor or the ceiling of its expected
+     * number of particles, which also reduces the variance of the
+     * approximation.
+     *
+     * The returned belief is unbounded.
+     *
+     * @param b The belief to approximate.
+     * @param particles The number of particles to draw.
+     * @param rnd The random engine to use.
+     *
+     * @return A particle belief approximating the input belief.
+     */
+    template <typename Gen>
+    ParticleBelief makeParticleBelief(const Belief & b, size_t particles, Gen & rnd);
+
+    inline ParticleBelief::ParticleBelief(const size_t maxSize) : maxSize_(maxSize), count_(0) {}
+
+    inline bool ParticleBelief::add(const size_t s, const unsigned count) {
+        // Particles added in order of state do not need a search.
+        if ( particles_.empty() || particles_.back().first < s ) {
+            if ( maxSize_ && particles_.size() >= maxSize_ ) return false;
+            particles_.emplace_back(s, count);
+            count_ += count;
+            return true;
+        }
+        auto it = std::lower_bound(std::begin(particles_), std::end(particles_), s,
+                                   [](const Particle & p, size_t s){ return p.first < s; });
+
+        if ( it == std::end(particles_) || it->first != s ) {
+            if ( maxSize_ && particles_.size() >= maxSize_ ) return false;
+            it = particles_.emplace(it, s, 0);
+        }
+        it->second += count;
+        count_ += count;
+        return true;
+    }
+
+    template <typename Gen>
+    void ParticleBelief::add(const size_t s, const unsigned count, Gen & rnd) {
+        if ( add(s, count) ) return;
+
+        auto victim = std::min_element(std::begin(particles_), std::end(particles_),
+                                       [](const Particle & lhs, const Particle & rhs){ return lhs.second < rhs.second; });
+
+        const unsigned total = victim->second + count;
+        count_ += count;
+        if ( std::uniform_int_distribution<unsigned>(1, total)(rnd) > count ) {
+            victim->second = total;
+            return;
+        }
+        // The new state replaces the victim, so we move the slot where it
+        // belongs to keep the particles sorted.
+        auto it = std::lower_bound(std::begin(particles_), std::end(particles_), s,
+                                   [](const Particle & p, size_t s){ return p.first < s; });
+        if ( it <= victim ) {
+            std::rotate(it, victim, victim + 1);
+        } else {
+            std::rotate(victim, victim + 1, it);
+            --it;
+        }
+        *it = {s, total};
+    }
+
+    template <typename Gen>
+    size_t ParticleBelief::sample(Gen & rnd) const {
+        std::uniform_int_distribution<unsigned> generator(1, count_);
+        unsigned pick = generator(rnd);
+
+        size_t i = 0;
+        while ( pick > particles_[i].second ) {
+            pick -= particles_[i].second;
+            ++i;
+        }
+        return particles_[i].first;
+    }
+
+    inline void ParticleBelief::clear() {
+        particles_.clear();
+        count_ = 0;
+    }
+
+    inline void ParticleBelief::setMaxSize(const size_t maxSize) { maxSize_ = maxSize; }
+    inline size_t ParticleBelief::getMaxSize() const { return maxSize_; }
+    inline size_t ParticleBelief::size() const { return particles_.size(); }
+    inline unsigned ParticleBelief::getCount() const { return count_; }
+    inline bool ParticleBelief::empty() const { return count_ == 0; }
+    inline const ParticleBelief::Particles & ParticleBelief::getParticles() const { return particles_; }
+
+    template <typename Gen>
+    ParticleBelief makeParticleBelief(const Belief & b, const size_t particles, Gen & rnd) {
+        ParticleBelief retval;
+        if ( !particles ) return retval;
+
+        const double step = 1.0 / particles;
+        double point = std::uniform_real_distribution<double>(0.0, step)(rnd);
+        double cumulative = 0.0;
+
+        size_t taken = 0, last = 0;
+        for ( Eigen::Index s = 0; s < b.size() && taken < particles; ++s ) {
+            if ( b[s] <= 0.0 ) continue;
+            last = s;
+            cumulative += b[s];
+
+            unsigned count = 0;
+            while ( taken < particles && point < cumulative ) {
+                ++count;
+                ++taken;
+                point += step;
+            }
+            if ( count ) retval.add(s, count);
+        }
+        // Rounding can leave the last points past the end of the
+        // cumulative distribution; they belong to the last state.
+        if ( taken < particles ) retval.add(last, particles - taken);
+
+        return retval;
+    }
+}
+
+#endif
@@ -3,11 +3,35 @@
 
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/SOSACache.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
+
+#include <optional>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
 
 namespace AIToolbox::POMDP {
     /**
      * @brief This class offers projecting facilities for Models.
+     *
+     * This class reads the SOSA matrices of the model from a SOSACache,
+     * either its own or one shared with other algorithms. Each VList is
+     * then projected for each action and observation with a single matrix
+     * product, which for sparse matrices only touches the non-zero
+     * transitions.
+     *
+     * When projecting for all actions, the Projecter remembers the
+     * projections of the last VList it was given, one matrix per action
+     * and observation. Entries of the next VList with the same values
+     * reuse them, so that when a solver projects successive VLists only
+     * the entries which changed are projected again.
      */
     template <typename M>
     class Projecter {
@@ -24,13 +48,25 @@ namespace AIToolbox::POMDP {
              * table containing what are the possible observations for the model (this
              * may speed up the computation of the projections).
              *
+             * If no SOSACache is provided, the Projecter creates its own.
+             * Otherwise, the cache must have been created from the same
+             * model, and must outlive the Projecter.
+             *
              * @param model The model that is used as a base for all projections.
+             * @param sosa An optional cache of the SOSA matrices of the model.
              */
-            Projecter(const M & model);
+            Projecter(const M & model, const SOSACache * sosa = nullptr);
+
+            // The Projecter may point to its own cache.
+            Projecter(const Projecter &) = delete;
+            Projecter & operator=(const Projecter &) = delete;
 
             /**
              * @brief This function returns all possible projections for the provided VList.
              *
+             * Entries with the same values as an entry of the VList
+             * passed to the previous call are not projected again.
+             *
              * @param w The list that needs to be projected.
              *
              * @return A 2d array of projection lists.
@@ -47,9 +83,58 @@ namespace AIToolbox::POMDP {
              */
             ProjectionsRow operator()(const VList & w, size_t a);
 
+            /**
+             * @brief This function clears the projections remembered from the last VList.
+             */
+            void clearCache();
+
+            /**
+             * @brief This function returns how many entries of the last VList reused remembered projections.
+             *
+             * @return The number of entries which were not projected again.
+             */
+            size_t getCacheHits() const;
+
         private:
             using PossibleObservationsTable = boost::multi_array<bool,  2>;
 
+            /**
+             * @brief This function returns all possible projections for the provided action.
+             *
+             * @param values The values of the list to project, one per row.
+             * @param a The action used for projecting the list.
+             *
+             * @return A 1d array of projection lists.
+             */
+            ProjectionsRow project(const Matrix2D & values, size_t a);
+
+            /**
+             * @brief This function projects the input values for an action and a possible observation.
+             *
+             * @param values The values to project, one per row.
+             * @param a The action used for projecting.
+             * @param o The observation used for projecting.
+             *
+             * @return The projections, one per row.
+             */
+            Matrix2D projectValues(const Matrix2D & values, size_t a, size_t o) const;
+
+            /**
+             * @brief This function builds the projection list of an action and observation from their values.
+             *
+             * An empty matrix marks an impossible observation.
+             *
+             * @param projections The list to fill.
+             * @param vprojs The projections, one per row.
+             * @param a The action used for projecting.
+             */
+            void fillProjections(VList & projections, const Matrix2D & vprojs, size_t a) const;
+
+            /**
+             * @brief This function packs the values of the input list, one per row.
+             */
+            Matrix2D packValues(const VList & w) const;
+
             /**
              * @brief This function precomputes which observations are possible from specific actions.
              */
@@ -66,67 +151,174 @@ namespace AIToolbox::POMDP {
 
             Matrix2D immediateRewards_;
             PossibleObservationsTable possibleObservations_;
+            // Only set if no cache was provided.
+            std::optional<SOSACache> ownSosa_;
+            const SOSACache * sosa_;
+
+            // The values of the last projected VList, and their projections
+            // for each action and observation (empty for impossible ones).
+            // The index maps the hash of some values to their rows.
+            Matrix2D cachedValues_;
+            std::vector<Matrix2D> cachedProjections_;
+            std::unordered_multimap<size_t, size_t> cacheIndex_;
+            size_t cacheHits_;
     };
 
     template <typename M>
-    Projecter<M>::Projecter(const M& model) :
+    Projecter<M>::Projecter(const M& model, const SOSACache * sosa) :
             model_(model), S(model_.getS()), A(model_.getA()), O(model_.getO()),
-            discount_(model_.getDiscount()), possibleObservations_(boost::extents[A][O])
+            discount_(model_.getDiscount()), possibleObservations_(boost::extents[A][O]),
+            sosa_(sosa), cacheHits_(0)
     {
+        if ( !sosa_ ) sosa_ = &ownSosa_.emplace(model_);
+        assert(sosa_->getS() == S && sosa_->getA() == A && sosa_->getO() == O);
+
         computePossibleObservations();
         computeImmediateRewards();
     }
 
     template <typename M>
     typename Projecter<M>::ProjectionsTable Projecter<M>::operator()(const VList & w) {
+        AI_METRIC_TIME("POMDP::Projecter::project");
+
+        const auto hashRow = [](const auto & row) {
+            return boost::hash_range(row.data(), row.data() + row.size());
+        };
+
+        // We look for each entry in the last VList, and only pack the
+        // values of the ones we did not see.
+        auto values = packValues(w);
+        std::vector<size_t> oldRows(w.size()), newRows;
+        std::vector<size_t> hashes(w.size());
+        for ( size_t i = 0; i < w.size(); ++i ) {
+            hashes[i] = hashRow(values.row(i));
+            oldRows[i] = cachedValues_.rows();
+
+            const auto [begin, end] = cacheIndex_.equal_range(hashes[i]);
+            for ( auto it = begin; it != end; ++it ) {
+                if ( cachedValues_.row(it->second) == values.row(i) ) {
+                    oldRows[i] = it->second;
+                    break;
+                }
+            }
+            if ( oldRows[i] == static_cast<size_t>(cachedValues_.rows()) )
+                newRows.push_back(i);
+        }
+        cacheHits_ = w.size() - newRows.size();
+
+        Matrix2D newValues(newRows.size(), S);
+        for ( size_t j = 0; j < newRows.size(); ++j )
+            newValues.row(j) = values.row(newRows[j]);
+
         ProjectionsTable projections( boost::extents[A][O] );
+        std::vector<Matrix2D> allProjections(A * O);
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( size_t o = 0; o < O; ++o ) {
+                if ( !possibleObservations_[a][o] ) {
+                    fillProjections(projections[a][o], Matrix2D(), a);
+                    continue;
+                }
+                const auto newProjections = newRows.size() ? projectValues(newValues, a, o) : Matrix2D(0, S);
+                const auto & oldProjections = cachedProjections_[a * O + o];
 
-        for ( size_t a = 0; a < A; ++a )
-            projections[a] = operator()(w, a);
+                auto & vprojs = allProjections[a * O + o];
+                vprojs.resize(w.size(), S);
+                for ( size_t i = 0, j = 0; i < w.size(); ++i ) {
+                    if ( j < newRows.size() && newRows[j] == i )
+                        vprojs.row(i) = newProjections.row(j++);
+                    else
+                        vprojs.row(i) = oldProjections.row(oldRows[i]);
+                }
+                fillProjections(projections[a][o], vprojs, a);
+            }
+        }
+
+        // We only remember the last VList, as solvers project each one
+        // once, from the previous.
+        cachedValues_ = std::move(values);
+        cachedProjections_ = std::move(allProjections);
+        cacheIndex_.clear();
+        for ( size_t i = 0; i < w.size(); ++i )
+            cacheIndex_.emplace(hashes[i], i);
 
         return projections;
     }
 
+    template <typename M>
+    void Projecter<M>::clearCache() {
+        cachedValues_.resize(0, 0);
+        cachedProjections_.clear();
+        cacheIndex_.clear();
+        cacheHits_ = 0;
+    }
+
+    template <typename M>
+    size_t Projecter<M>::getCacheHits() const {
+        return cacheHits_;
+    }
+
     template <typename M>
     typename Projecter<M>::ProjectionsRow Projecter<M>::operator()(const VList & w, const size_t a) {
+        return project(packValues(w), a);
+    }
+
+    template <typename M>
+    Matrix2D Projecter<M>::packValues(const VList & w) const {
+        Matrix2D values(w.size(), S);
+        for ( size_t i = 0; i < w.size(); ++i )
+            values.row(i) = w[i].values.transpose();
+        return values;
+    }
+
+    template <typename M>
+    typename Projecter<M>::ProjectionsRow Projecter<M>::project(const Matrix2D & values, const size_t a) {
+        AI_METRIC_TIME("POMDP::Projecter::project");
+
         ProjectionsRow projections( boost::extents[O] );
 
         for ( size_t o = 0; o < O; ++o ) {
-            // Here we put in just the immediate rewards so that the cross-summing step in the main
-            // function works correctly. However we communicate via the boolean that pruning should
-            // not be done at this step (since adding constants shouldn't do anything anyway).
-            if ( !possibleObservations_[a][o] ) {
-                // We add a parent id anyway in order to keep the code that cross-sums simple. However
-                // note that this fake ID of 0 should never be used, so it should be safe to avoid
-                // setting it to a special value like -1. If one really wants to check, he/she can
-                // just look at the observation table and the belief and see if it makes sense.
-                projections[o].emplace_back(immediateRewards_.row(a), a, VObs(1,0));
-                continue;
-            }
-
-            // Otherwise we compute a projection for each ValueFunction supplied to us.
-            MDP::Values vproj(S);
-            for ( size_t i = 0; i < w.size(); ++i ) {
-                const auto & v = w[i].values;
-                // For each value function in the previous timestep, we compute the new value
-                // if we performed action a and obtained observation o.
-                // vproj_{a,o}[s] = R(s,a) / |O| + discount * sum_{s'} ( T(s,a,s') * O(s',a,o) * v_{t-1}(s') )
-                if constexpr(is_model_eigen_v<M>) {
-                    vproj = model_.getTransitionFunction(a) * (v.cwiseProduct(model_.getObservationFunction(a).col(o)));
-                } else {
-                    vproj.setZero();
-                    for ( size_t s = 0; s < S; ++s )
-                        for ( size_t s1 = 0; s1 < S; ++s1 )
-                            vproj[s] += model_.getTransitionProbability(s,a,s1) * model_.getObservationProbability(s1,a,o) * v[s1];
-                }
-                // Set new projection with found value and previous V id.
-                // projections[o].emplace_back(vproj, a, VObs(1,i));
-                projections[o].emplace_back(vproj * discount_ + immediateRewards_.row(a).transpose(), a, VObs(1,i));
-            }
+            if ( !possibleObservations_[a][o] )
+                fillProjections(projections[o], Matrix2D(), a);
+            else
+                fillProjections(projections[o], projectValues(values, a, o), a);
         }
         return projections;
     }
 
+    template <typename M>
+    Matrix2D Projecter<M>::projectValues(const Matrix2D & values, const size_t a, const size_t o) const {
+        // We compute a projection for each ValueFunction supplied to us.
+        //
+        // For each value function in the previous timestep, we compute the new value
+        // if we performed action a and obtained observation o.
+        // vproj_{a,o}[s] = R(s,a) / |O| + discount * sum_{s'} ( T(s,a,s') * O(s',a,o) * v_{t-1}(s') )
+        //
+        // Each row contains the projection of the matching row of values.
+        Matrix2D vprojs = sosa_->apply(a, o, [&](const auto & sosa) -> Matrix2D {
+            return values * sosa.transpose();
+        });
+        vprojs *= discount_;
+        vprojs.rowwise() += immediateRewards_.row(a);
+        return vprojs;
+    }
+
+    template <typename M>
+    void Projecter<M>::fillProjections(VList & projections, const Matrix2D & vprojs, const size_t a) const {
+        // For impossible observations, we put in just the immediate rewards so that the
+        // cross-summing step in the main function works correctly.
+        if ( vprojs.rows() == 0 && vprojs.cols() == 0 ) {
+            // We add a parent id anyway in order to keep the code that cross-sums simple. However
+            // note that this fake ID of 0 should never be used, so it should be safe to avoid
+            // setting it to a special value like -1. If one really wants to check, he/she can
+            // just look at the observation table and the belief and see if it makes sense.
+            projections.emplace_back(immediateRewards_.row(a), a, VObs(1,0));
+            return;
+        }
+        projections.reserve(vprojs.rows());
+        for ( size_t i = 0; i < static_cast<size_t>(vprojs.rows()); ++i )
+            projections.emplace_back(vprojs.row(i).transpose(), a, VObs(1,i));
+    }
+
     template <typename M>
     void Projecter<M>::computeImmediateRewards() {
         immediateRewards_ = [&]{
@@ -147,6 +339,10 @@ namespace AIToolbox::POMDP {
                 for ( size_t s = 0; s < S; ++s ) // This NEEDS to be last!
                     if ( checkDifferentSmall(model_.getObservationProbability(s,a,o), 0.0) ) { possibleObservations_[a][o] = true; break; } // We only break the S loop!
     }
+
+    // Both common models are compiled in the library.
+    extern template class Projecter<Model<MDP::Model>>;
+    extern template class Projecter<SparseModel<MDP::SparseModel>>;
 }
 
 #endif
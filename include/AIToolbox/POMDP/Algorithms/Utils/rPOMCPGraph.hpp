@@ -6,6 +6,7 @@
 
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/Algorithms/Utils/ParticleBelief.hpp>
 
 namespace AIToolbox::Impl::POMDP {
     struct EmptyStruct {};
@@ -124,6 +125,7 @@ namespace AIToolbox::POMDP {
 
             bool isSampleBeliefEmpty() const;     ///< Whether we have no particles in the sampling belief.
             size_t sampleBelief() const;          ///< Samples the internal sampling belief.
+            size_t sampleBelief(RandomEngine & rnd) const; ///< Samples the internal sampling belief with the input random engine.
             size_t getMostCommonParticle() const; ///< Useful if the agents wants a guess of what the current state is.
 
         private:
@@ -184,19 +186,7 @@ namespace AIToolbox::POMDP {
             BeliefNode<UseEntropy>(), rand_(&rand), beliefSize_(beliefSize)
     {
         this->children.resize(A);
-        std::unordered_map<size_t, unsigned> generatedSamples;
-
-        size_t S = b.size();
-        for ( size_t i = 0; i < beliefSize_; ++i )
-            generatedSamples[AIToolbox::sampleProbability(S, b, *rand_)] += 1;
-
-        sampleBelief_.reserve(beliefSize_);
-        for ( auto & pair : generatedSamples ) {
-            sampleBelief_.emplace_back(pair);
-            // Compute entropy here since we don't have a parent in this case (is it really needed?)
-            // double p = static_cast<double>(pair.second) / static_cast<double>(beliefSize_);
-            // negativeEntropy += p * std::log(p);
-        }
+        sampleBelief_ = makeParticleBelief(b, beliefSize_, *rand_).getParticles();
     }
 
     template <bool UseEntropy>
@@ -219,8 +209,13 @@ namespace AIToolbox::POMDP {
 
     template <bool UseEntropy>
     size_t HeadBeliefNode<UseEntropy>::sampleBelief() const {
+        return sampleBelief(*rand_);
+    }
+
+    template <bool UseEntropy>
+    size_t HeadBeliefNode<UseEntropy>::sampleBelief(RandomEngine & rnd) const {
         std::uniform_int_distribution<unsigned> generator(1, beliefSize_);
-        int pick = generator(*rand_);
+        int pick = generator(rnd);
 
         size_t index = 0;
         while (true) {
@@ -41,6 +41,13 @@ namespace AIToolbox::POMDP {
      * In addition, Witness will not add to the agenda any VEntry which it has
      * already added; it uses a set to keep track of which combinations of
      * subtrees it has already tried.
+     *
+     * The witness points found for an action at one timestep are usually
+     * close to those of the next. Thus, Witness keeps them, and at the next
+     * timestep it starts each action off with the optimal VEntries at all
+     * the points found at the previous one. These VEntries are added
+     * without solving any LP, and are marked as tried so that they are not
+     * checked again once they are generated as variations.
      */
     class Witness {
         public:
@@ -115,6 +122,33 @@ namespace AIToolbox::POMDP {
             template <typename M, typename = std::enable_if_t<is_model_v<M>>>
             std::tuple<double, ValueFunction> operator()(const M & model);
 
+            /**
+             * @brief This function solves a POMDP::Model starting from an initial VList.
+             *
+             * The initial VList is used in place of the horizon 0
+             * solution, and the solver performs up to horizon more
+             * backups from it. Starting from a solution to a shorter
+             * horizon, or to a slightly different model, can save most of
+             * the iterations needed to converge. To continue from a whole
+             * ValueFunction, pass its last VList.
+             *
+             * Only the values of the initial VEntries are used.
+             *
+             * This function throws an std::invalid_argument if the VList
+             * is empty, or its values do not match the model.
+             *
+             * @tparam M The type of POMDP model that needs to be solved.
+             *
+             * @param model The POMDP model that needs to be solved.
+             * @param initial The VList to start from.
+             *
+             * @return A tuple containing the maximum variation for the
+             *         ValueFunction and the computed ValueFunction, whose
+             *         first element is the initial VList.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            std::tuple<double, ValueFunction> operator()(const M & model, const VList & initial);
+
         private:
             /**
              * @brief This function adds a default cross-sum to the agenda, to start off the algorithm.
@@ -139,17 +173,32 @@ namespace AIToolbox::POMDP {
 
             std::vector<MDP::Values> agenda_;
             std::unordered_set<VObs, boost::hash<VObs>> triedVectors_;
+            std::unordered_set<VObs, boost::hash<VObs>> foundVectors_;
     };
 
     template <typename M, typename>
-    std::tuple<double, ValueFunction> Witness::operator()(const M& model) {
+    std::tuple<double, ValueFunction> Witness::operator()(const M & model) {
+        return operator()(model, makeValueFunction(model.getS())[0]);
+    }
+
+    template <typename M, typename>
+    std::tuple<double, ValueFunction> Witness::operator()(const M & model, const VList & initial) {
+        if ( initial.empty() )
+            throw std::invalid_argument("The initial VList must not be empty.");
+        for ( const auto & entry : initial )
+            if ( static_cast<size_t>(entry.values.size()) != model.getS() )
+                throw std::invalid_argument("The initial VList is not consistent with the model.");
+
         S = model.getS();
         A = model.getA();
         O = model.getO();
 
         std::vector<VList> U(A);
+        // The witness points of the entries in U, which are used to
+        // start off the search of the next timestep.
+        std::vector<std::vector<Belief>> witnesses(A);
 
-        auto v = makeValueFunction(S); // TODO: May take user input
+        auto v = ValueFunction{initial};
 
         unsigned timestep = 0;
 
@@ -183,22 +232,56 @@ namespace AIToolbox::POMDP {
                 lp.reset();
                 agenda_.clear();
                 triedVectors_.clear();
+                foundVectors_.clear();
                 size_t counter = 0;
 
                 lp.allocate(reserveSize);
 
-                // We add the VEntry to startoff the whole process. This
-                // VEntry does not even need to be optimal, as we are going
-                // to compute the optimal one for the witness point anyway.
-                addDefaultEntry(projections[a]);
+                // We first add the optimal VEntries for the witness points
+                // of the previous timestep. Since they are optimal at those
+                // points, they need no LP to be verified.
+                auto oldWitnesses = std::move(witnesses[a]);
+                witnesses[a].clear();
+                for ( auto & b : oldWitnesses ) {
+                    auto entry = crossSumBestAtBelief(b, projections[a], a);
+                    if ( !triedVectors_.insert(entry.observations).second ) continue;
+
+                    foundVectors_.insert(entry.observations);
+                    U[a].push_back(std::move(entry));
+                    lp.addOptimalRow(U[a].back().values);
+                    witnesses[a].push_back(std::move(b));
+                    if ( ++counter == reserveSize ) {
+                        reserveSize *= 2;
+                        lp.allocate(reserveSize);
+                    }
+                }
+
+                if ( U[a].empty() ) {
+                    // We add the VEntry to startoff the whole process. This
+                    // VEntry does not even need to be optimal, as we are going
+                    // to compute the optimal one for the witness point anyway.
+                    addDefaultEntry(projections[a]);
+                } else {
+                    // Otherwise the variations of the entries we already
+                    // have are all we need; note that only now the
+                    // triedVectors_ contains all of them.
+                    for ( const auto & entry : U[a] )
+                        addVariations(projections[a], entry);
+                }
 
                 // We check whether any element in the agenda improves what we have
                 while ( !agenda_.empty() ) {
                     const auto witness = lp.findWitness(agenda_.back());
-                    if ( witness ) {
-                        // If so, we generate the best vector for that particular belief point.
-                        U[a].push_back(crossSumBestAtBelief(*witness, projections[a], a));
+                    // If so, we generate the best vector for that particular belief point.
+                    auto entry = witness ? crossSumBestAtBelief(*witness, projections[a], a) : VEntry();
+                    // If the LP found a witness only due to numerical
+                    // errors, the best vector may be one we already have,
+                    // typically one which has the same values as the vector
+                    // we are testing. In that case there is nothing to add.
+                    if ( witness && foundVectors_.insert(entry.observations).second ) {
+                        U[a].push_back(std::move(entry));
                         lp.addOptimalRow(U[a].back().values);
+                        witnesses[a].push_back(*witness);
                         // We add to the agenda all possible "variations" of the VEntry found.
                         addVariations(projections[a], U[a].back());
                         // We manually check memory for the lp, since this method
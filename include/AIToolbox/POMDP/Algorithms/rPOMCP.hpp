@@ -6,6 +6,7 @@
 #include <AIToolbox/Impl/Logging.hpp>
 #include <AIToolbox/Impl/Seeder.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/SearchBudget.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 
@@ -111,6 +112,41 @@ namespace AIToolbox::POMDP {
              */
             size_t sampleAction(size_t a, size_t o, unsigned horizon);
 
+            /**
+             * @brief This function resets the internal graph and samples for the provided belief and horizon, within a time budget.
+             *
+             * Rather than performing a fixed number of rollouts, this
+             * function keeps performing rollouts until the input budget
+             * has been used up, and then returns the best action found so
+             * far. At least one rollout is always performed.
+             *
+             * \sa SearchDeadline
+             *
+             * @param b The initial belief for the environment.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(const Belief& b, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
+            /**
+             * @brief This function uses the internal graph to plan, within a time budget.
+             *
+             * \sa sampleAction(size_t, size_t, unsigned)
+             * \sa sampleAction(const Belief&, unsigned, std::chrono::duration<Rep, Period>)
+             *
+             * @param a The action taken in the last timestep.
+             * @param o The observation received in the last timestep.
+             * @param horizon The horizon to plan for.
+             * @param budget The time available to the search.
+             *
+             * @return The best action.
+             */
+            template <typename Rep, typename Period>
+            size_t sampleAction(size_t a, size_t o, unsigned horizon, std::chrono::duration<Rep, Period> budget);
+
             /**
              * @brief This function sets the new size for initial beliefs created from sampleAction().
              *
@@ -177,6 +213,13 @@ namespace AIToolbox::POMDP {
              */
             double getExploration() const;
 
+            /**
+             * @brief This function returns statistics about the last call to sampleAction().
+             *
+             * @return The statistics of the last search.
+             */
+            const SearchStatistics & getSearchStatistics() const;
+
         private:
             const M& model_;
             size_t S, A, beliefSize_;
@@ -187,9 +230,12 @@ namespace AIToolbox::POMDP {
             mutable RandomEngine rand_;
 
             HNode graph_;
+            SearchStatistics stats_;
 
             // Private Methods
-            size_t runSimulation(unsigned horizon);
+            void resetGraph(const Belief & b);
+            void reuseGraph(size_t a, size_t o);
+            size_t runSimulation(unsigned horizon, const SearchDeadline * deadline);
             double simulate(BNode & b, size_t s, unsigned horizon);
 
             void maxBeliefNodeUpdate(BNode * bn, const ANode & aNode, size_t a);
@@ -209,20 +255,48 @@ namespace AIToolbox::POMDP {
 
     template <typename M, bool UseEntropy>
     size_t rPOMCP<M, UseEntropy>::sampleAction(const Belief& b, const unsigned horizon) {
-        // Reset graph
-        graph_ = HNode(A, beliefSize_, b, rand_);
-
-        return runSimulation(horizon);
+        resetGraph(b);
+        return runSimulation(horizon, nullptr);
     }
 
     template <typename M, bool UseEntropy>
     size_t rPOMCP<M, UseEntropy>::sampleAction(const size_t a, const size_t o, const unsigned horizon) {
+        reuseGraph(a, o);
+        return runSimulation(horizon, nullptr);
+    }
+
+    template <typename M, bool UseEntropy>
+    template <typename Rep, typename Period>
+    size_t rPOMCP<M, UseEntropy>::sampleAction(const Belief& b, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
+
+        resetGraph(b);
+        return runSimulation(horizon, &deadline);
+    }
+
+    template <typename M, bool UseEntropy>
+    template <typename Rep, typename Period>
+    size_t rPOMCP<M, UseEntropy>::sampleAction(const size_t a, const size_t o, const unsigned horizon, const std::chrono::duration<Rep, Period> budget) {
+        const SearchDeadline deadline(budget);
+
+        reuseGraph(a, o);
+        return runSimulation(horizon, &deadline);
+    }
+
+    template <typename M, bool UseEntropy>
+    void rPOMCP<M, UseEntropy>::resetGraph(const Belief & b) {
+        graph_ = HNode(A, beliefSize_, b, rand_);
+    }
+
+    template <typename M, bool UseEntropy>
+    void rPOMCP<M, UseEntropy>::reuseGraph(const size_t a, const size_t o) {
         auto & obs = graph_.children[a].children;
 
         auto it = obs.find(o);
         if ( it == obs.end() ) {
             AI_LOGGER(AI_SEVERITY_WARNING, "Observation " << o << " never experienced in simulation, restarting with uniform belief..");
-            return sampleAction(Belief(S, 1.0 / S), horizon);
+            resetGraph(Belief(S, 1.0 / S));
+            return;
         }
 
         // Here we need an additional step, because *it is contained by graph_.
@@ -234,20 +308,28 @@ namespace AIToolbox::POMDP {
 
         if ( graph_.isSampleBeliefEmpty() ) {
             AI_LOGGER(AI_SEVERITY_WARNING, "rPOMCP lost track of the belief, restarting with uniform..");
-            return sampleAction(Belief(S, 1.0 / S), horizon);
+            resetGraph(Belief(S, 1.0 / S));
         }
-
-        return runSimulation(horizon);
     }
 
     template <typename M, bool UseEntropy>
-    size_t rPOMCP<M, UseEntropy>::runSimulation(const unsigned horizon) {
+    size_t rPOMCP<M, UseEntropy>::runSimulation(const unsigned horizon, const SearchDeadline * deadline) {
+        stats_ = SearchStatistics();
         if ( !horizon ) return 0;
 
+        const auto start = std::chrono::steady_clock::now();
         maxDepth_ = horizon;
 
-        for (unsigned i = 0; i < iterations_; ++i )
-            simulate(graph_, graph_.sampleBelief(), 0);
+        if ( deadline ) {
+            do simulate(graph_, graph_.sampleBelief(), 0);
+            while ( !deadline->expired(++stats_.rollouts) );
+        } else {
+            for (unsigned i = 0; i < iterations_; ++i )
+                simulate(graph_, graph_.sampleBelief(), 0);
+            stats_.rollouts = iterations_;
+        }
+        // The tree is not a SearchTree, so we only report the time taken.
+        stats_.elapsed = std::chrono::steady_clock::now() - start;
 
         auto begin = std::begin(graph_.children);
         size_t bestA = std::distance(begin, findBestA(begin, std::end(graph_.children)));
@@ -261,6 +343,7 @@ namespace AIToolbox::POMDP {
     template <typename M, bool UseEntropy>
     double rPOMCP<M, UseEntropy>::simulate(BNode & b, size_t s, unsigned depth) {
         b.N++;
+        if ( depth > stats_.maxDepth ) stats_.maxDepth = depth;
 
         // Select next action node
         auto begin = std::begin(b.children);
@@ -280,6 +363,7 @@ namespace AIToolbox::POMDP {
             ot = aNode.children.find(o);
             if ( ot == aNode.children.end() ) {
                 newNode = true;
+                ++stats_.nodesAdded;
                 std::tie(ot, std::ignore) = aNode.children.insert(std::make_pair(o, BNode()));
             }
 
@@ -424,6 +508,11 @@ namespace AIToolbox::POMDP {
     double rPOMCP<M, UseEntropy>::getExploration() const {
         return exploration_;
     }
+
+    template <typename M, bool UseEntropy>
+    const SearchStatistics & rPOMCP<M, UseEntropy>::getSearchStatistics() const {
+        return stats_;
+    }
 }
 
 #endif
@@ -0,0 +1,168 @@
+#ifndef AI_TOOLBOX_POMDP_BELIEF_UPDATE_CACHE_HEADER_FILE
+#define AI_TOOLBOX_POMDP_BELIEF_UPDATE_CACHE_HEADER_FILE
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class caches belief updates of a model, bounded in size with LRU eviction.
+     *
+     * Online planners like RTBSS, and agents executing a policy over many
+     * episodes, often update the same beliefs with the same actions and
+     * observations, and each update costs a product with the transition
+     * function. This class stores the results of these updates, so that
+     * only the first one is computed.
+     *
+     * Entries are keyed on the action, the observation, and the belief
+     * quantized with a configurable resolution: beliefs which quantize to
+     * the same values share the same entry, and thus the same successor.
+     * With the default resolution only (nearly) identical beliefs match.
+     *
+     * The cache can be queried by multiple threads at the same time. It
+     * is split in shards, each with its own lock and its own share of the
+     * maximum size, and when a shard is full its least recently used entry
+     * is evicted. Updates are computed outside the locks. Each query holds
+     * a reference to its entry, so entries evicted while in use are only
+     * freed afterwards.
+     *
+     * A cache with a maximum size of zero is disabled: all updates are
+     * computed, and nothing is stored.
+     *
+     * The model must outlive the cache.
+     */
+    class BeliefUpdateCache {
+        public:
+            /**
+             * @brief The result of a belief update.
+             */
+            struct Entry {
+                /// The updated belief, normalized if the observation is possible.
+                Belief belief;
+                /// The probability of the observation, given the belief and the action.
+                double probability;
+            };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This function throws std::invalid_argument if the resolution
+             * is not positive, or if there are no shards.
+             *
+             * @param model The model to update beliefs with.
+             * @param maxSize The maximum number of entries, or zero to disable the cache.
+             * @param resolution The resolution used to quantize beliefs.
+             * @param shards The number of independently locked shards.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            BeliefUpdateCache(const M & model, size_t maxSize, double resolution = 1e-9, size_t shards = 16);
+
+            /**
+             * @brief This function returns the update of the input belief, action and observation.
+             *
+             * If the probability of the observation is (nearly) zero, the
+             * returned belief is left unnormalized.
+             *
+             * @param b The belief to update.
+             * @param a The action performed.
+             * @param o The observation obtained.
+             *
+             * @return The update, computing it first if it isn't cached.
+             */
+            std::shared_ptr<const Entry> update(const Belief & b, size_t a, size_t o) const;
+
+            /**
+             * @brief This function removes all entries.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the maximum number of entries.
+             */
+            size_t getMaxSize() const;
+
+            /**
+             * @brief This function returns the resolution used to quantize beliefs.
+             */
+            double getResolution() const;
+
+            /**
+             * @brief This function returns the number of shards.
+             */
+            size_t getShards() const;
+
+            /**
+             * @brief This function returns the number of entries.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the number of updates found in the cache since the last clear().
+             */
+            size_t getHits() const;
+
+            /**
+             * @brief This function returns the number of updates computed since the last clear().
+             */
+            size_t getMisses() const;
+
+        private:
+            using Updater = std::function<void(const Belief &, size_t, size_t, Belief *)>;
+
+            /**
+             * @brief This constructor is delegated to with an updater for the model's beliefs.
+             */
+            BeliefUpdateCache(size_t S, size_t maxSize, double resolution, size_t shards, Updater updater);
+
+            /**
+             * @brief This function computes the update of the input belief, action and observation.
+             */
+            std::shared_ptr<const Entry> compute(const Belief & b, size_t a, size_t o) const;
+
+            struct Key {
+                std::vector<long long> belief;
+                size_t a, o;
+                size_t hash;
+
+                bool operator==(const Key & other) const {
+                    return a == other.a && o == other.o && belief == other.belief;
+                }
+            };
+            struct KeyHash {
+                size_t operator()(const Key & k) const { return k.hash; }
+            };
+            using LRU = std::list<std::pair<Key, std::shared_ptr<const Entry>>>;
+
+            struct Shard {
+                std::mutex mutex;
+                // Most recently used first.
+                LRU lru;
+                std::unordered_map<Key, LRU::iterator, KeyHash> entries;
+            };
+
+            size_t S;
+            size_t maxSize_, shardSize_;
+            double resolution_;
+            Updater updater_;
+
+            mutable std::vector<Shard> shards_;
+            mutable std::atomic<size_t> hits_, misses_;
+    };
+
+    template <typename M, typename>
+    BeliefUpdateCache::BeliefUpdateCache(const M & m, const size_t maxSize, const double resolution, const size_t shards) :
+            BeliefUpdateCache(m.getS(), maxSize, resolution, shards, [&m](const Belief & b, const size_t a, const size_t o, Belief * bRet) {
+                updateBeliefUnnormalized(m, b, a, o, bRet);
+            }) {}
+}
+
+#endif
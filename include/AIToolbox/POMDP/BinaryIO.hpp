@@ -0,0 +1,129 @@
+#ifndef AI_TOOLBOX_POMDP_BINARY_IO_HEADER_FILE
+#define AI_TOOLBOX_POMDP_BINARY_IO_HEADER_FILE
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace AIToolbox::POMDP {
+    struct IncrementalPruningCheckpoint;
+    struct PERSEUSCheckpoint;
+    struct GapMinCheckpoint;
+    class QuantizedPolicy;
+
+    /**
+     * @brief The version of the binary format of solver checkpoints.
+     *
+     * Files with a different version are rejected when read.
+     */
+    inline constexpr std::uint32_t CheckpointFormatVersion = 1;
+
+    /**
+     * @brief The kinds of checkpoints that can be stored in the binary format.
+     */
+    enum class CheckpointType : std::uint32_t {
+        IncrementalPruning = 1,
+        PERSEUS = 2,
+        GapMin = 3,
+    };
+
+    /**
+     * @brief This function writes an IncrementalPruning checkpoint to a stream in binary format.
+     *
+     * The binary format stores a versioned header followed by the raw
+     * values of the checkpoint, so that writing it takes little time
+     * compared to the timesteps of the solver. Checkpoints can be read
+     * back with readBinary().
+     *
+     * Values are stored in the native byte order. This is checked when
+     * the file is read, so files cannot be moved between machines with a
+     * different byte order.
+     *
+     * The stream should be opened in binary mode.
+     *
+     * @param os The output stream.
+     * @param checkpoint The checkpoint to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const IncrementalPruningCheckpoint & checkpoint);
+
+    /**
+     * @brief This function writes a PERSEUS checkpoint to a stream in binary format.
+     *
+     * \sa writeBinary(std::ostream &, const IncrementalPruningCheckpoint &)
+     *
+     * @param os The output stream.
+     * @param checkpoint The checkpoint to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const PERSEUSCheckpoint & checkpoint);
+
+    /**
+     * @brief This function writes a GapMin checkpoint to a stream in binary format.
+     *
+     * \sa writeBinary(std::ostream &, const IncrementalPruningCheckpoint &)
+     *
+     * @param os The output stream.
+     * @param checkpoint The checkpoint to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const GapMinCheckpoint & checkpoint);
+
+    /**
+     * @brief This function writes a QuantizedPolicy to a stream in binary format.
+     *
+     * The compressed data of the policy is written as it is kept in
+     * memory, so that the file can be loaded by mapping it with
+     * QuantizedPolicy(const std::string &).
+     *
+     * The stream should be opened in binary mode.
+     *
+     * @param os The output stream.
+     * @param policy The policy to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const QuantizedPolicy & policy);
+
+    /**
+     * @brief This function reads an IncrementalPruning checkpoint from a stream in binary format.
+     *
+     * If the file is invalid, or was written for a different type, the
+     * failbit of the stream is set and the input checkpoint is left
+     * untouched.
+     *
+     * @param is The input stream.
+     * @param checkpoint The checkpoint to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, IncrementalPruningCheckpoint & checkpoint);
+
+    /**
+     * @brief This function reads a PERSEUS checkpoint from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, IncrementalPruningCheckpoint &)
+     *
+     * @param is The input stream.
+     * @param checkpoint The checkpoint to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, PERSEUSCheckpoint & checkpoint);
+
+    /**
+     * @brief This function reads a GapMin checkpoint from a stream in binary format.
+     *
+     * \sa readBinary(std::istream &, IncrementalPruningCheckpoint &)
+     *
+     * @param is The input stream.
+     * @param checkpoint The checkpoint to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, GapMinCheckpoint & checkpoint);
+}
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef AI_TOOLBOX_POMDP_FIXED_MODEL_HEADER_FILE
+#define AI_TOOLBOX_POMDP_FIXED_MODEL_HEADER_FILE
+
+#include <AIToolbox/MDP/FixedModel.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class represents a POMDP whose sizes are known at compile time.
+     *
+     * This class is equivalent to POMDP::Model<MDP::Model>, but it builds
+     * on MDP::FixedModel and stores its observation function in fixed-size
+     * Eigen matrices, so that the whole model lives inside the object.
+     *
+     * Together with the FixedBelief overloads of the belief update
+     * functions in POMDP/Utils.hpp, this allows to track beliefs for tiny
+     * problems without any heap allocation.
+     *
+     * This class satisfies is_model_eigen, so it can be used with all
+     * solvers that work with POMDP::Model<MDP::Model>.
+     *
+     * @tparam S The number of states of the world.
+     * @tparam A The number of actions available to the agent.
+     * @tparam O The number of possible observations.
+     */
+    template <size_t S, size_t A, size_t O>
+    class FixedModel : public MDP::FixedModel<S, A> {
+        static_assert(O > 0, "FixedModel needs at least one observation!");
+
+        public:
+            using ObservationFunction = FixedMatrix2D<int(S), int(O)>;
+            using ObservationMatrix   = std::array<ObservationFunction, A>;
+            using Belief              = FixedBelief<int(S)>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor initializes the transition function as in
+             * MDP::FixedModel, and the observation function so that all
+             * actions will return observation 0.
+             *
+             * @param discount The discount factor for the POMDP.
+             */
+            FixedModel(double discount = 1.0);
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor takes three arbitrary three dimensional
+             * containers and tries to copy their contents into the
+             * observations, transitions and rewards matrices respectively.
+             *
+             * The containers need to support data access through
+             * operator[], with dimensions S,A,O for the observations and
+             * S,A,S for the others.
+             *
+             * This constructor throws an std::invalid_argument if the
+             * input does not contain valid probabilities, or if the
+             * discount is not in (0,1].
+             *
+             * @tparam ObFun The external observations container type.
+             * @tparam T The external transitions container type.
+             * @tparam R The external rewards container type.
+             * @param of The external observations container.
+             * @param t The external transitions container.
+             * @param r The external rewards container.
+             * @param d The discount factor for the POMDP.
+             */
+            template <typename ObFun, typename T, typename R>
+            FixedModel(const ObFun & of, const T & t, const R & r, double d = 1.0);
+
+            /**
+             * @brief Copy constructor from any valid POMDP model.
+             *
+             * This constructor throws an std::invalid_argument if the
+             * sizes of the input model do not match the ones of this
+             * class, or if it does not contain valid probabilities.
+             *
+             * @tparam PM The type of the other model.
+             * @param model The model that needs to be copied.
+             */
+            template <typename PM, typename = std::enable_if_t<is_model_v<PM>>>
+            FixedModel(const PM& model);
+
+            /**
+             * @brief This function replaces the observation function with the one provided.
+             *
+             * The container needs to support data access through
+             * operator[], with dimensions S,A,O.
+             *
+             * This function will throw a std::invalid_argument if the
+             * container does not contain valid probabilities.
+             *
+             * @tparam ObFun The external observations container type.
+             * @param of The external observations container.
+             */
+            template <typename ObFun>
+            void setObservationFunction(const ObFun & of);
+
+            /**
+             * @brief This function sets the observation function using fixed-size Eigen matrices.
+             *
+             * This function will throw a std::invalid_argument if the
+             * matrices do not contain valid probabilities.
+             *
+             * @param of The input observation function, one S'xO matrix per action.
+             */
+            void setObservationFunction(const ObservationMatrix & of);
+
+            /**
+             * @brief This function samples the POMDP for the specified state action pair.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             *
+             * @return A tuple containing a new state, observation and reward.
+             */
+            std::tuple<size_t, size_t, double> sampleSOR(size_t s, size_t a) const;
+
+            /**
+             * @brief This function samples the POMDP with the input random engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state, observation and reward.
+             */
+            std::tuple<size_t, size_t, double> sampleSOR(size_t s, size_t a, RandomEngine & rnd) const;
+
+            /**
+             * @brief This function samples the POMDP for the specified state action pair and final state.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param s1 The final state of the transition.
+             *
+             * @return A tuple containing a new observation and reward.
+             */
+            std::tuple<size_t, double> sampleOR(size_t s, size_t a, size_t s1) const;
+
+            /**
+             * @brief This function returns the stored observation probability for the specified state-action pair.
+             *
+             * @param s1 The final state of the transition.
+             * @param a The action performed in the transition.
+             * @param o The recorded observation for the transition.
+             *
+             * @return The probability of the specified observation.
+             */
+            double getObservationProbability(size_t s1, size_t a, size_t o) const;
+
+            /**
+             * @brief This function returns the observation function for a given action.
+             *
+             * @param a The action requested.
+             *
+             * @return The observation function for the input action.
+             */
+            const ObservationFunction & getObservationFunction(size_t a) const;
+
+            /**
+             * @brief This function returns the number of observations possible.
+             *
+             * @return The total number of observations.
+             */
+            size_t getO() const;
+
+            /**
+             * @brief This function returns the observation matrix for inspection.
+             *
+             * @return The observation matrix.
+             */
+            const ObservationMatrix & getObservationFunction() const;
+
+        private:
+            ObservationMatrix observations_;
+
+            mutable RandomEngine rand_;
+    };
+
+    template <size_t S, size_t A, size_t O>
+    FixedModel<S, A, O>::FixedModel(const double discount) :
+            MDP::FixedModel<S, A>(discount),
+            rand_(Impl::Seeder::getSeed())
+    {
+        for ( auto & of : observations_ ) {
+            of.setZero();
+            of.col(0).fill(1.0);
+        }
+    }
+
+    template <size_t S, size_t A, size_t O>
+    template <typename ObFun, typename T, typename R>
+    FixedModel<S, A, O>::FixedModel(const ObFun & of, const T & t, const R & r, const double d) :
+            MDP::FixedModel<S, A>(t, r, d),
+            rand_(Impl::Seeder::getSeed())
+    {
+        setObservationFunction(of);
+    }
+
+    template <size_t S, size_t A, size_t O>
+    template <typename PM, typename>
+    FixedModel<S, A, O>::FixedModel(const PM& model) :
+            MDP::FixedModel<S, A>(model),
+            rand_(Impl::Seeder::getSeed())
+    {
+        if ( model.getO() != O )
+            throw std::invalid_argument("Input model has different sizes than the FixedModel.");
+
+        for ( size_t a = 0; a < A; ++a )
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                for ( size_t o = 0; o < O; ++o )
+                    observations_[a](s1, o) = model.getObservationProbability(s1, a, o);
+                if ( !isProbability(O, observations_[a].row(s1)) )
+                    throw std::invalid_argument("Input observation matrix does not contain valid probabilities.");
+            }
+    }
+
+    template <size_t S, size_t A, size_t O>
+    template <typename ObFun>
+    void FixedModel<S, A, O>::setObservationFunction(const ObFun & of) {
+        for ( size_t s1 = 0; s1 < S; ++s1 )
+            for ( size_t a = 0; a < A; ++a )
+                if ( !isProbability(O, of[s1][a]) )
+                    throw std::invalid_argument("Input observation matrix does not contain valid probabilities.");
+
+        for ( size_t s1 = 0; s1 < S; ++s1 )
+            for ( size_t a = 0; a < A; ++a )
+                for ( size_t o = 0; o < O; ++o )
+                    observations_[a](s1, o) = of[s1][a][o];
+    }
+
+    template <size_t S, size_t A, size_t O>
+    void FixedModel<S, A, O>::setObservationFunction(const ObservationMatrix & of) {
+        for ( size_t a = 0; a < A; ++a )
+            for ( size_t s1 = 0; s1 < S; ++s1 )
+                if ( of[a].row(s1).minCoeff() < 0.0 || !checkEqualSmall(1.0, of[a].row(s1).sum()) )
+                    throw std::invalid_argument("Input observation matrix does not contain valid probabilities.");
+
+        observations_ = of;
+    }
+
+    template <size_t S, size_t A, size_t O>
+    std::tuple<size_t, size_t, double> FixedModel<S, A, O>::sampleSOR(const size_t s, const size_t a) const {
+        return sampleSOR(s, a, rand_);
+    }
+
+    template <size_t S, size_t A, size_t O>
+    std::tuple<size_t, size_t, double> FixedModel<S, A, O>::sampleSOR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const auto [s1, r] = this->sampleSR(s, a, rnd);
+        const auto o = sampleProbability(O, observations_[a].row(s1), rnd);
+        return std::make_tuple(s1, o, r);
+    }
+
+    template <size_t S, size_t A, size_t O>
+    std::tuple<size_t, double> FixedModel<S, A, O>::sampleOR(const size_t s, const size_t a, const size_t s1) const {
+        const size_t o = sampleProbability(O, observations_[a].row(s1), rand_);
+        return std::make_tuple(o, this->getExpectedReward(s, a, s1));
+    }
+
+    template <size_t S, size_t A, size_t O>
+    double FixedModel<S, A, O>::getObservationProbability(const size_t s1, const size_t a, const size_t o) const {
+        return observations_[a](s1, o);
+    }
+
+    template <size_t S, size_t A, size_t O>
+    const typename FixedModel<S, A, O>::ObservationFunction & FixedModel<S, A, O>::getObservationFunction(const size_t a) const {
+        return observations_[a];
+    }
+
+    template <size_t S, size_t A, size_t O>
+    size_t FixedModel<S, A, O>::getO() const {
+        return O;
+    }
+
+    template <size_t S, size_t A, size_t O>
+    const typename FixedModel<S, A, O>::ObservationMatrix & FixedModel<S, A, O>::getObservationFunction() const {
+        return observations_;
+    }
+}
+
+#endif
@@ -6,6 +6,7 @@
 
 #include <AIToolbox/MDP/IO.hpp>
 #include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
 #include <AIToolbox/POMDP/Model.hpp>
@@ -25,6 +26,23 @@ namespace AIToolbox::POMDP {
      */
     Model<MDP::Model> parseCassandra(std::istream & input);
 
+    /**
+     * @brief This function parses a sparse POMDP from a Cassandra formatted stream.
+     *
+     * The model is built directly from the sparse representation read by
+     * the parser, so that no dense transition or observation tables are
+     * ever allocated.
+     *
+     * This function may throw std::runtime_errors depending on whether the
+     * input is correctly formed or not, and std::invalid_argument if the
+     * parsed transition or observation functions are invalid.
+     *
+     * @param input The input stream.
+     *
+     * @return The parsed model.
+     */
+    SparseModel<MDP::SparseModel> parseCassandraSparse(std::istream & input);
+
     /**
      * @brief This function prints any POMDP model to a file.
      *
@@ -96,6 +114,7 @@ namespace AIToolbox::POMDP {
             }
         }
         // This guarantees that if input is invalid we still keep the old Model.
+        in.setObservationAliasSampling(m.getObservationAliasSampling());
         m = std::move(in);
 
         return is;
@@ -144,6 +163,7 @@ namespace AIToolbox::POMDP {
                     in.observations_[a].coeffRef(s1, 0) = 1.0;
             }
         }
+        in.setObservationColumnCache(m.getObservationColumnCache());
         // This guarantees that if input is invalid we still keep the old Model.
         m = std::move(in);
 
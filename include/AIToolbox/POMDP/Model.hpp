@@ -5,6 +5,7 @@
 
 #include <AIToolbox/Impl/Seeder.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/MemoryUsage.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
@@ -174,6 +175,33 @@ namespace AIToolbox::POMDP {
             template <typename ObFun>
             void setObservationFunction(const ObFun & of);
 
+            /**
+             * @brief This function sets whether observations are sampled with alias sampling.
+             *
+             * By default sampleSOR() and sampleOR() sample observations
+             * with a linear scan of the observation row, which is O(O).
+             * When alias sampling is enabled, the Model builds a
+             * VoseAliasSampler for each new state-action pair, so that
+             * each sample becomes O(1).
+             *
+             * The samplers are rebuilt every time the observation
+             * function is changed.
+             *
+             * Note that this only affects observations: if the parent MDP
+             * model supports alias sampling for transitions, it has to be
+             * enabled separately.
+             *
+             * @param enable Whether to use alias sampling.
+             */
+            void setObservationAliasSampling(bool enable);
+
+            /**
+             * @brief This function returns whether observations are sampled with alias sampling.
+             *
+             * @return Whether alias sampling is enabled for observations.
+             */
+            bool getObservationAliasSampling() const;
+
             /**
              * @brief This function samples the POMDP for the specified state action pair.
              *
@@ -195,6 +223,25 @@ namespace AIToolbox::POMDP {
              */
             std::tuple<size_t,size_t, double> sampleSOR(size_t s,size_t a) const;
 
+            /**
+             * @brief This function samples the POMDP with the input random engine.
+             *
+             * This function is equivalent to sampleSOR(size_t, size_t),
+             * but does not touch the internal random engines of the model.
+             * This allows multiple threads to sample the same model at the
+             * same time, as long as each uses its own engine.
+             *
+             * This function is only available if the underlying MDP model
+             * can also be sampled with an external random engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state, observation and reward.
+             */
+            std::tuple<size_t,size_t, double> sampleSOR(size_t s, size_t a, RandomEngine & rnd) const;
+
             /**
              * @brief This function samples the POMDP for the specified state action pair.
              *
@@ -247,6 +294,17 @@ namespace AIToolbox::POMDP {
              */
             const ObservationMatrix & getObservationFunction() const;
 
+            /**
+             * @brief This function returns the heap memory used by the model, in bytes.
+             *
+             * This includes the memory of the underlying MDP model, if it
+             * reports it, the observation tables and the alias tables if
+             * alias sampling is enabled.
+             *
+             * @return The memory allocated by the model.
+             */
+            size_t getMemoryUsage() const;
+
         private:
             size_t O;
             ObservationMatrix observations_;
@@ -254,6 +312,9 @@ namespace AIToolbox::POMDP {
             // and we wouldn't know how to access it!
             mutable RandomEngine rand_;
 
+            bool observationAliasSampling_;
+            VoseAliasTable observationSamplers_;
+
             friend std::istream& operator>> <M>(std::istream &is, Model<M> &);
     };
 
@@ -261,7 +322,7 @@ namespace AIToolbox::POMDP {
     template <typename... Args>
     Model<M>::Model(const size_t o, Args&&... params) :
             M(std::forward<Args>(params)...), O(o),
-            observations_(this->getA(), Matrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed())
+            observations_(this->getA(), Matrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed()), observationAliasSampling_(false)
     {
         for ( size_t a = 0; a < this->getA(); ++a ) {
             observations_[a].rightCols(O-1).setZero();
@@ -273,7 +334,7 @@ namespace AIToolbox::POMDP {
     template <typename ObFun, typename... Args, typename>
     Model<M>::Model(const size_t o, ObFun && of, Args&&... params) :
             M(std::forward<Args>(params)...), O(o),
-            observations_(this->getA(), Matrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed())
+            observations_(this->getA(), Matrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed()), observationAliasSampling_(false)
     {
         setObservationFunction(of);
     }
@@ -282,14 +343,14 @@ namespace AIToolbox::POMDP {
     template <typename... Args>
     Model<M>::Model(NoCheck, size_t o, ObservationMatrix && ot, Args&&... params) :
             M(std::forward<Args>(params)...), O(o),
-            observations_(std::move(ot))
+            observations_(std::move(ot)), observationAliasSampling_(false)
     {}
 
     template <typename M>
     template <typename PM, typename>
     Model<M>::Model(const PM& model) :
             M(model), O(model.getO()), observations_(this->getA(), Matrix2D(this->getS(), O)),
-            rand_(Impl::Seeder::getSeed())
+            rand_(Impl::Seeder::getSeed()), observationAliasSampling_(false)
     {
         for ( size_t a = 0; a < this->getA(); ++a )
             for ( size_t s1 = 0; s1 < this->getS(); ++s1 ) {
@@ -313,6 +374,20 @@ namespace AIToolbox::POMDP {
             for ( size_t a = 0; a < this->getA(); ++a )
                 for ( size_t o = 0; o < O; ++o )
                     observations_[a](s1, o) = of[s1][a][o];
+
+        if ( observationAliasSampling_ ) observationSamplers_ = VoseAliasTable(observations_);
+    }
+
+    template <typename M>
+    void Model<M>::setObservationAliasSampling(const bool enable) {
+        observationAliasSampling_ = enable;
+        if ( observationAliasSampling_ ) observationSamplers_ = VoseAliasTable(observations_);
+        else                             observationSamplers_ = VoseAliasTable();
+    }
+
+    template <typename M>
+    bool Model<M>::getObservationAliasSampling() const {
+        return observationAliasSampling_;
     }
 
     template <typename M>
@@ -335,16 +410,31 @@ namespace AIToolbox::POMDP {
         return observations_;
     }
 
+    template <typename M>
+    size_t Model<M>::getMemoryUsage() const {
+        return heapUsage(static_cast<const M &>(*this)) + heapUsage(observations_) + observationSamplers_.getMemoryUsage();
+    }
+
     template <typename M>
     std::tuple<size_t,size_t, double> Model<M>::sampleSOR(const size_t s, const size_t a) const {
         const auto [s1, r] = this->sampleSR(s, a);
-        const auto o = sampleProbability(O, observations_[a].row(s1), rand_);
+        const auto o = observationAliasSampling_ ? observationSamplers_.sampleProbability(a * this->getS() + s1, rand_)
+                                                 : sampleProbability(O, observations_[a].row(s1), rand_);
+        return std::make_tuple(s1, o, r);
+    }
+
+    template <typename M>
+    std::tuple<size_t,size_t, double> Model<M>::sampleSOR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const auto [s1, r] = this->sampleSR(s, a, rnd);
+        const auto o = observationAliasSampling_ ? observationSamplers_.sampleProbability(a * this->getS() + s1, rnd)
+                                                 : sampleProbability(O, observations_[a].row(s1), rnd);
         return std::make_tuple(s1, o, r);
     }
 
     template <typename M>
     std::tuple<size_t, double> Model<M>::sampleOR(const size_t s, const size_t a, const size_t s1) const {
-        const size_t o = sampleProbability(O, observations_[a].row(s1), rand_);
+        const size_t o = observationAliasSampling_ ? observationSamplers_.sampleProbability(a * this->getS() + s1, rand_)
+                                                   : sampleProbability(O, observations_[a].row(s1), rand_);
         const double r = this->getExpectedReward(s, a, s1);
         return std::make_tuple(o, r);
     }
@@ -0,0 +1,139 @@
+#ifndef AI_TOOLBOX_POMDP_MODEL_CONTEXT_HEADER_FILE
+#define AI_TOOLBOX_POMDP_MODEL_CONTEXT_HEADER_FILE
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/SOSACache.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class lazily computes and caches quantities derived from a POMDP model.
+     *
+     * Many POMDP algorithms start by computing the same things from the
+     * model: the immediate rewards R(s,a), the SOSA matrices (see
+     * SOSACache), and the solution of the underlying MDP. When several of
+     * them are run on the same model, as GapMin does internally with
+     * BlindStrategies and FastInformedBound, or as pipelines that also run
+     * QMDP do, these are recomputed each time.
+     *
+     * This class computes each of these quantities the first time it is
+     * requested, and keeps it for later requests. QMDP, BlindStrategies,
+     * FastInformedBound and GapMin all have overloads accepting a
+     * ModelContext.
+     *
+     * Solutions of the underlying MDP are cached separately for each
+     * (horizon, tolerance) pair they are requested with.
+     *
+     * The context can be queried by multiple threads at the same time.
+     * Quantities other than SOSA matrices are computed while holding a
+     * lock, so concurrent requests for them are serialized.
+     *
+     * The model must outlive the context, and must not change while the
+     * context is in use.
+     */
+    class ModelContext {
+        public:
+            using MDPSolution = std::tuple<double, MDP::ValueFunction, MDP::QFunction>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * Nothing is computed here.
+             *
+             * @param model The model to compute quantities of.
+             * @param maxSOSABytes The maximum memory the SOSA matrices may use, or 0 for no limit.
+             * @param maxSOSADensity The maximum fraction of non-zero elements for a SOSA matrix to be stored sparse.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            ModelContext(const M & model, size_t maxSOSABytes = 0, double maxSOSADensity = 0.1);
+
+            /**
+             * @brief This function returns the SOSACache of the model.
+             *
+             * @return The SOSACache, which itself computes matrices lazily.
+             */
+            const SOSACache & getSOSA() const;
+
+            /**
+             * @brief This function returns the immediate rewards of the model.
+             *
+             * @return The SxA matrix of immediate rewards, as from MDP::computeImmediateRewards().
+             */
+            const Matrix2D & getImmediateRewards() const;
+
+            /**
+             * @brief This function returns the solution of the underlying MDP.
+             *
+             * The solution is computed with MDP::ValueIteration with the
+             * input parameters, and cached for later calls with the same
+             * parameters.
+             *
+             * @param horizon The horizon of the ValueIteration.
+             * @param tolerance The tolerance of the ValueIteration.
+             *
+             * @return The bound, ValueFunction and QFunction of the underlying MDP.
+             */
+            const MDPSolution & getMDPSolution(unsigned horizon, double tolerance) const;
+
+            /**
+             * @brief This function returns the number of cached solutions of the underlying MDP.
+             *
+             * @return The number of MDP solutions cached.
+             */
+            size_t getMDPSolveCount() const;
+
+            /**
+             * @brief This function drops all cached quantities.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the number of states of the model.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of actions of the model.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the number of observations of the model.
+             */
+            size_t getO() const;
+
+        private:
+            using RewardsBuilder = std::function<Matrix2D()>;
+            using MDPSolver = std::function<MDPSolution(unsigned, double)>;
+
+            SOSACache sosa_;
+            RewardsBuilder rewardsBuilder_;
+            MDPSolver mdpSolver_;
+
+            mutable std::mutex mutex_;
+            mutable bool hasRewards_;
+            mutable Matrix2D rewards_;
+            mutable std::map<std::pair<unsigned, double>, MDPSolution> solutions_;
+    };
+
+    template <typename M, typename>
+    ModelContext::ModelContext(const M & m, const size_t maxSOSABytes, const double maxSOSADensity) :
+            sosa_(m, maxSOSABytes, maxSOSADensity),
+            rewardsBuilder_([&m]{ return Matrix2D(MDP::computeImmediateRewards(m)); }),
+            mdpSolver_([&m](const unsigned horizon, const double tolerance) {
+                MDP::ValueIteration solver(horizon, tolerance);
+                return solver(m);
+            }),
+            hasRewards_(false) {}
+}
+
+#endif
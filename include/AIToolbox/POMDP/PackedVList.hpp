@@ -0,0 +1,184 @@
+#ifndef AI_TOOLBOX_POMDP_PACKED_VLIST_HEADER_FILE
+#define AI_TOOLBOX_POMDP_PACKED_VLIST_HEADER_FILE
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class stores a VList with all its alphavectors in a single matrix.
+     *
+     * In a VList each VEntry owns its values, so that any search over the
+     * list, like finding the best alphavector for a belief, needs to follow
+     * a pointer per entry. This class instead packs all values as the rows
+     * of a single row-major Matrix2D, and keeps the actions and the
+     * observation indices of the entries in separate contiguous arrays.
+     *
+     * The best entry for a belief can then be found with a single
+     * matrix-vector product, followed by a scan of the resulting values.
+     *
+     * This class is meant as a read-mostly companion to VList: entries can
+     * be appended, but not removed. It is typically built from a VList
+     * once, and then queried for many beliefs.
+     */
+    class PackedVList {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor creates an empty list.
+             *
+             * @param S The number of states of the alphavectors.
+             * @param O The number of observation indices stored for each entry.
+             */
+            PackedVList(size_t S, size_t O);
+
+            /**
+             * @brief This constructor packs the input VList.
+             *
+             * The number of observations stored for each entry is the one
+             * of the first entry of the input, or zero if it is empty.
+             *
+             * @param S The number of states of the alphavectors.
+             * @param vlist The VList to pack.
+             */
+            PackedVList(size_t S, const VList & vlist);
+
+            /**
+             * @brief This function reserves space for the input number of entries.
+             *
+             * @param size The number of entries to reserve space for.
+             */
+            void reserve(size_t size);
+
+            /**
+             * @brief This function appends a VEntry to the list.
+             *
+             * Only the first getO() observation indices of the entry are
+             * stored.
+             *
+             * @param entry The VEntry to append.
+             */
+            void push_back(const VEntry & entry);
+
+            /**
+             * @brief This function returns the index of the best entry for the input belief.
+             *
+             * The list must not be empty. Ties are broken as in
+             * findBestAtPoint, so that the result matches searching the
+             * equivalent VList.
+             *
+             * @param b The belief to check.
+             * @param value A pointer to double, which gets set to the value of the belief with the found entry.
+             *
+             * @return The index of the best entry.
+             */
+            size_t findBestAtBelief(const Belief & b, double * value = nullptr) const;
+
+            /**
+             * @brief This function returns the indices of the best entries for the input beliefs.
+             *
+             * This function is equivalent to calling findBestAtBelief()
+             * for each belief, but computes the values of all entries at
+             * all beliefs with a single matrix-matrix product.
+             *
+             * The list must not be empty.
+             *
+             * @param beliefs The beliefs to check, one per row.
+             * @param values A pointer to Vector, which gets set to the value of each belief with its found entry.
+             *
+             * @return The index of the best entry for each belief.
+             */
+            std::vector<size_t> findBestAtBeliefs(const Matrix2D & beliefs, Vector * values = nullptr) const;
+
+            /**
+             * @brief This function returns the values of the input entry.
+             *
+             * @param i The index of the entry.
+             *
+             * @return The alphavector of the entry, as a row.
+             */
+            auto getValues(const size_t i) const { return values_.row(i); }
+
+            /**
+             * @brief This function returns the values of all entries.
+             *
+             * @return A view of the alphavectors, one per row.
+             */
+            auto getValues() const { return values_.topRows(size_); }
+
+            /**
+             * @brief This function returns the action of the input entry.
+             *
+             * @param i The index of the entry.
+             *
+             * @return The action of the entry.
+             */
+            size_t getAction(size_t i) const;
+
+            /**
+             * @brief This function returns an observation index of the input entry.
+             *
+             * @param i The index of the entry.
+             * @param o The observation.
+             *
+             * @return The index of the entry to look into for the input observation.
+             */
+            size_t getObservation(size_t i, size_t o) const;
+
+            /**
+             * @brief This function unpacks the input entry.
+             *
+             * @param i The index of the entry.
+             *
+             * @return A VEntry equal to the one that was packed.
+             */
+            VEntry getEntry(size_t i) const;
+
+            /**
+             * @brief This function unpacks the whole list.
+             *
+             * @return A VList equal to the one that was packed.
+             */
+            VList toVList() const;
+
+            /**
+             * @brief This function returns the number of entries in the list.
+             *
+             * @return The number of entries.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns whether the list is empty.
+             *
+             * @return True if the list has no entries, false otherwise.
+             */
+            bool empty() const;
+
+            /**
+             * @brief This function returns the number of states of the alphavectors.
+             *
+             * @return The number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of observation indices stored for each entry.
+             *
+             * @return The number of observations.
+             */
+            size_t getO() const;
+
+        private:
+            size_t S, O, size_;
+
+            // Only the first size_ rows are used.
+            Matrix2D values_;
+            std::vector<size_t> actions_;
+            // O indices per entry.
+            std::vector<size_t> observations_;
+    };
+}
+
+#endif
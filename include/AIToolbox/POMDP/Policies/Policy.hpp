@@ -2,8 +2,10 @@
 #define AI_TOOLBOX_POMDP_POLICY_HEADER_FILE
 
 #include <tuple>
+#include <vector>
 
 #include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/PackedVList.hpp>
 #include <AIToolbox/PolicyInterface.hpp>
 
 namespace AIToolbox::POMDP {
@@ -22,6 +24,11 @@ namespace AIToolbox::POMDP {
      * provides facilities to follow the chosen vector along the tree
      * (since future actions depend on the observations obtained by the
      * agent).
+     *
+     * In order to find the best vector quickly, this class also keeps a
+     * copy of each VList of the ValueFunction as a PackedVList. When many
+     * beliefs need to be queried at once, the sampleActions() functions
+     * find all their vectors with a single matrix-matrix product.
      */
     class Policy : public PolicyInterface<size_t, Belief, size_t> {
         public:
@@ -94,6 +101,35 @@ namespace AIToolbox::POMDP {
              */
             std::tuple<size_t, size_t> sampleAction(const Belief & b, unsigned horizon) const;
 
+            /**
+             * @brief This function chooses an action for each of the input beliefs.
+             *
+             * This function is equivalent to calling sampleAction(const
+             * Belief &) for each belief, but is much faster for many
+             * beliefs.
+             *
+             * @param beliefs The beliefs to sample actions for, one per row.
+             *
+             * @return The chosen action for each belief.
+             */
+            std::vector<size_t> sampleActions(const Matrix2D & beliefs) const;
+
+            /**
+             * @brief This function chooses an action for each of the input beliefs when horizon steps are missing.
+             *
+             * This function is equivalent to calling
+             * sampleAction(const Belief &, unsigned) for each belief, but
+             * is much faster for many beliefs.
+             *
+             * @param beliefs The beliefs to sample actions for, one per row.
+             * @param horizon The requested horizon, meaning the number of timesteps missing until
+             * the end of the "episode".
+             *
+             * @return A vector containing, for each belief, the chosen action plus an id useful to
+             * sample an action more efficiently at the next timestep.
+             */
+            std::vector<std::tuple<size_t, size_t>> sampleActions(const Matrix2D & beliefs, unsigned horizon) const;
+
             /**
              * @brief This function chooses a random action after performing a sampled action and observing observation o, for a particular horizon.
              *
@@ -191,10 +227,16 @@ namespace AIToolbox::POMDP {
             const ValueFunction & getValueFunction() const;
 
         private:
+            /**
+             * @brief This function packs all VLists of the ValueFunction.
+             */
+            void pack();
+
             // H holds the available max horizon for this Policy.
             size_t O, H;
 
             ValueFunction policy_;
+            std::vector<PackedVList> packed_;
 
             friend std::istream& operator>>(std::istream &is, Policy & p);
     };
@@ -0,0 +1,187 @@
+#ifndef AI_TOOLBOX_POMDP_POLICY_GRAPH_HEADER_FILE
+#define AI_TOOLBOX_POMDP_POLICY_GRAPH_HEADER_FILE
+
+#include <cstdint>
+#include <iosfwd>
+
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/POMDP/PackedVList.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief The version of the binary format written by writeBinary(std::ostream &, const PolicyGraph &).
+     *
+     * Files with a different version are rejected when read.
+     */
+    inline constexpr std::uint32_t PolicyGraphFormatVersion = 1;
+
+    /**
+     * @brief This class represents a POMDP policy as a finite state controller.
+     *
+     * Each VEntry of a ValueFunction links, for each observation, to the
+     * VEntry to follow in the VList of the previous horizon. Policy uses
+     * these links to act without tracking the belief, but only for as
+     * many steps as the ValueFunction has horizons.
+     *
+     * If the ValueFunction has converged, instead, its last two VLists
+     * contain the same alphavectors. This class uses the last VList as
+     * the nodes of a graph, and maps each link into the previous VList to
+     * the node with the closest alphavector. The result is a controller
+     * which can be run for any number of steps: the initial node is found
+     * from the initial belief, and afterwards each step only needs to
+     * read the action of the current node and the next node for the
+     * obtained observation.
+     *
+     * The nodes are stored in a single PackedVList, so that actions and
+     * links are in contiguous arrays. The graph can be stored in a small
+     * binary file with writeBinary(), and read back with readBinary().
+     */
+    class PolicyGraph {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor creates a graph with a single node, with
+             * zero values, action 0, and linking to itself for all
+             * observations. This is most useful if the graph needs to be
+             * read from a file.
+             *
+             * @param S The number of states of the world.
+             * @param O The number of possible observations the agent could make.
+             */
+            PolicyGraph(size_t S, size_t O);
+
+            /**
+             * @brief This constructor extracts the graph from a ValueFunction.
+             *
+             * The ValueFunction should have converged, as otherwise the
+             * alphavectors linked to may be different from the nodes they
+             * are mapped to. The largest such difference is returned by
+             * getLinkError().
+             *
+             * The ValueFunction must contain at least the horizon 0 and
+             * horizon 1 VLists, otherwise this constructor throws an
+             * std::invalid_argument.
+             *
+             * @param S The number of states of the world.
+             * @param O The number of possible observations the agent could make.
+             * @param vf The ValueFunction to extract the graph from.
+             */
+            PolicyGraph(size_t S, size_t O, const ValueFunction & vf);
+
+            /**
+             * @brief This function returns the best node for the input belief.
+             *
+             * This is the node to start executing the graph from.
+             *
+             * @param b The belief to find the node for.
+             *
+             * @return The node whose alphavector is best at the belief.
+             */
+            size_t getNode(const Belief & b) const;
+
+            /**
+             * @brief This function returns the action of the input node.
+             *
+             * @param node The node to get the action of.
+             *
+             * @return The action to take in the node.
+             */
+            size_t getAction(size_t node) const;
+
+            /**
+             * @brief This function returns the node to move to after obtaining an observation in the input node.
+             *
+             * @param node The current node.
+             * @param o The observation obtained after taking the action of the node.
+             *
+             * @return The next node.
+             */
+            size_t getNextNode(size_t node, size_t o) const;
+
+            /**
+             * @brief This function returns the alphavector of the input node.
+             *
+             * @param node The node to get the values of.
+             *
+             * @return The alphavector of the node, as a row.
+             */
+            auto getValues(const size_t node) const { return nodes_.getValues(node); }
+
+            /**
+             * @brief This function returns the largest difference between an alphavector linked to and the node it was mapped to.
+             *
+             * The difference is the largest absolute difference between
+             * the values of the two alphavectors. It is zero for graphs
+             * read from a file.
+             *
+             * @return The largest mapping difference.
+             */
+            double getLinkError() const;
+
+            /**
+             * @brief This function returns the number of nodes of the graph.
+             *
+             * @return The number of nodes.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the number of states of the world.
+             *
+             * @return The number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of possible observations.
+             *
+             * @return The number of observations.
+             */
+            size_t getO() const;
+
+        private:
+            size_t S, O;
+            double linkError_;
+
+            // The observations of each entry are the indeces of the next nodes.
+            PackedVList nodes_;
+
+            friend std::istream & readBinary(std::istream & is, PolicyGraph & graph);
+    };
+
+    /**
+     * @brief This function writes a PolicyGraph to a stream in binary format.
+     *
+     * The format stores a versioned header, followed by the raw values,
+     * actions and links of the nodes.
+     *
+     * Values are stored in the native byte order. This is checked when
+     * the file is read, so files cannot be moved between machines with a
+     * different byte order.
+     *
+     * The stream should be opened in binary mode.
+     *
+     * @param os The output stream.
+     * @param graph The graph to write.
+     *
+     * @return The input stream.
+     */
+    std::ostream & writeBinary(std::ostream & os, const PolicyGraph & graph);
+
+    /**
+     * @brief This function reads a PolicyGraph from a stream in binary format.
+     *
+     * The file must contain a graph with the same number of states and
+     * observations as the input one. If the file is invalid, the failbit
+     * of the stream is set and the input graph is left untouched.
+     *
+     * @param is The input stream.
+     * @param graph The graph to read into.
+     *
+     * @return The input stream.
+     */
+    std::istream & readBinary(std::istream & is, PolicyGraph & graph);
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef AI_TOOLBOX_POMDP_QUANTIZED_POLICY_HEADER_FILE
+#define AI_TOOLBOX_POMDP_QUANTIZED_POLICY_HEADER_FILE
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/PolicyInterface.hpp>
+
+namespace AIToolbox::MDP {
+    class MappedFile;
+}
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class represents a read-only POMDP Policy with compressed alphavectors.
+     *
+     * A Policy stores its whole ValueFunction in double precision, which
+     * for large problems can take a lot of memory. Most of it is not
+     * needed to act: to find the action for a belief only the values and
+     * actions of the alphavectors are used.
+     *
+     * This class stores, for each horizon, the actions of the
+     * alphavectors and their values compressed either as floats or as
+     * 16 bit integers. Each vector is stored relative to an offset (the
+     * middle of its range), and with its own scale when using integers,
+     * so that
+     *
+     *     alpha(s) ~= offset + scale * q(s)
+     *
+     * Since beliefs sum to one, the value of a vector at a belief is then
+     * the offset plus the scaled dot product of q with the belief, which
+     * is computed in float.
+     *
+     * At construction, the largest difference between the value of each
+     * vector at any belief and its computed approximation is bounded,
+     * including both the quantization and the float arithmetic errors.
+     * The vector selected for a belief is then guaranteed to have a true
+     * value at most getErrorBound() (twice the largest of these
+     * differences) below the best one. If this bound exceeds the input
+     * tolerance the constructor throws.
+     *
+     * The compressed data is laid out exactly as in its binary file (see
+     * writeBinary(std::ostream &, const QuantizedPolicy &)), so that
+     * policies can be loaded by mapping the file in memory, without
+     * reading or copying it. Pages are then shared between all the
+     * processes serving the same policy. Copies of this class share the
+     * same data.
+     *
+     * Observations are not stored, so the policy tree cannot be followed:
+     * actions can only be selected from beliefs.
+     */
+    class QuantizedPolicy : public PolicyInterface<size_t, Belief, size_t> {
+        public:
+            using Base = PolicyInterface<size_t, Belief, size_t>;
+
+            /**
+             * @brief The formats in which the values can be stored.
+             */
+            enum class Precision : std::uint32_t {
+                Float32 = 1,
+                Int16 = 2,
+            };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor compresses the input ValueFunction. If the
+             * resulting error bound is higher than the input tolerance,
+             * this constructor throws an std::invalid_argument.
+             *
+             * @param s The number of states of the world.
+             * @param a The number of actions available to the agent.
+             * @param o The number of possible observations the agent could make.
+             * @param v The ValueFunction to compress.
+             * @param precision The format in which to store the values.
+             * @param tolerance The maximum allowed error bound.
+             */
+            QuantizedPolicy(size_t s, size_t a, size_t o, const ValueFunction & v, Precision precision, double tolerance);
+
+            /**
+             * @brief This constructor uses a policy stored in a mapped binary file.
+             *
+             * This constructor throws an std::runtime_error if the file
+             * does not contain a QuantizedPolicy.
+             *
+             * @param file The mapped file to use.
+             */
+            QuantizedPolicy(std::shared_ptr<const MDP::MappedFile> file);
+
+            /**
+             * @brief This constructor maps the input file and uses it.
+             *
+             * @param filename The file to map.
+             */
+            QuantizedPolicy(const std::string & filename);
+
+            /**
+             * @brief This function chooses the action for belief b, using the highest horizon.
+             *
+             * @param b The sampled belief of the policy.
+             *
+             * @return The chosen action.
+             */
+            virtual size_t sampleAction(const Belief & b) const override;
+
+            /**
+             * @brief This function chooses the action for belief b when horizon steps are missing.
+             *
+             * The horizon must be at least one, and at most getH().
+             *
+             * @param b The sampled belief of the policy.
+             * @param horizon The requested horizon, meaning the number of timesteps missing until the end of the "episode".
+             *
+             * @return A tuple containing the chosen action, and the index of the selected alphavector.
+             */
+            std::tuple<size_t, size_t> sampleAction(const Belief & b, unsigned horizon) const;
+
+            /**
+             * @brief This function returns the index of the best alphavector for the input belief.
+             *
+             * @param b The belief to check.
+             * @param horizon The horizon to use.
+             * @param value A pointer to double, which gets set to the approximate value of the belief.
+             *
+             * @return The index of the best alphavector.
+             */
+            size_t findBestAtBelief(const Belief & b, unsigned horizon, double * value = nullptr) const;
+
+            /**
+             * @brief This function returns the probability of taking the specified action in the specified belief.
+             *
+             * @param b The selected belief.
+             * @param a The selected action.
+             *
+             * @return Either 1.0 or 0.0, as the policy is deterministic.
+             */
+            virtual double getActionProbability(const Belief & b, const size_t & a) const override;
+
+            /**
+             * @brief This function returns the number of observations possible for the agent.
+             *
+             * @return The total number of observations.
+             */
+            size_t getO() const;
+
+            /**
+             * @brief This function returns the highest horizon available within this Policy.
+             *
+             * @return The highest horizon.
+             */
+            size_t getH() const;
+
+            /**
+             * @brief This function returns the format in which the values are stored.
+             *
+             * @return The precision of the values.
+             */
+            Precision getPrecision() const;
+
+            /**
+             * @brief This function returns the maximum loss in value from selecting alphavectors with the compressed values.
+             *
+             * @return The error bound.
+             */
+            double getErrorBound() const;
+
+            /**
+             * @brief This function returns the number of alphavectors stored for the input horizon.
+             *
+             * @param horizon The horizon.
+             *
+             * @return The number of alphavectors.
+             */
+            size_t getSize(unsigned horizon) const;
+
+            /**
+             * @brief This function returns the number of bytes used by the compressed data.
+             *
+             * @return The size of the data, which is also the size of its binary file.
+             */
+            size_t getMemoryUsage() const;
+
+        private:
+            /**
+             * @brief This function sets up the views over the data, checking it.
+             *
+             * This function throws an std::runtime_error if the data is
+             * invalid.
+             */
+            void parse();
+
+            struct Horizon {
+                size_t size;
+                const std::uint32_t * actions;
+                const double * offsets;
+                const double * scales;
+                const void * values;
+            };
+
+            size_t O, H;
+            Precision precision_;
+            double errorBound_;
+
+            // Either the mapped file or the owned buffer.
+            std::shared_ptr<const void> storage_;
+            const char * data_;
+            size_t dataSize_;
+            std::vector<Horizon> horizons_;
+
+            friend std::ostream & writeBinary(std::ostream & os, const QuantizedPolicy & policy);
+    };
+}
+
+#endif
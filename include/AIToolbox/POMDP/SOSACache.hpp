@@ -0,0 +1,220 @@
+#ifndef AI_TOOLBOX_POMDP_SOSA_CACHE_HEADER_FILE
+#define AI_TOOLBOX_POMDP_SOSA_CACHE_HEADER_FILE
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <variant>
+#include <vector>
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+
+namespace AIToolbox::POMDP {
+    /**
+     * @brief This class lazily computes and caches the SOSA matrices of a model.
+     *
+     * The SOSA matrix of an action and an observation contains, for each
+     * pair of states s and s', the probability of getting to s' while
+     * obtaining the observation when starting from s (see makeSOSA()).
+     *
+     * Computing all SOSA matrices of a model up front can take a lot of
+     * memory, as there are A*O of them, each of size S*S. This class only
+     * computes each matrix the first time it is needed, so that matrices of
+     * observations that are never queried are never built. The cache can
+     * be shared between algorithms working on the same model, like
+     * FastInformedBound, Projecter and GapMin, so that each matrix is only
+     * computed once.
+     *
+     * Matrices where the fraction of non-zero elements is at most a
+     * density threshold are stored sparse, even for dense models, as
+     * products with them are then much faster. For sparse models they are
+     * always stored sparse.
+     *
+     * Optionally, the memory used by the cache can be capped. When adding
+     * a matrix would go over the cap, the least recently used matrices are
+     * evicted, and will be recomputed if needed again. The last matrix
+     * requested is always kept, even if it alone goes over the cap.
+     *
+     * The cache can be queried by multiple threads at the same time. Each
+     * query holds a reference to its matrix, so matrices evicted while in
+     * use are only freed afterwards. Matrices are computed outside the
+     * lock, so threads missing different matrices build them in parallel.
+     *
+     * The model must outlive the cache.
+     */
+    class SOSACache {
+        public:
+            using Block = std::variant<Matrix2D, SparseMatrix2D>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * No matrix is computed here.
+             *
+             * @param model The model to compute SOSA matrices of.
+             * @param maxBytes The maximum memory the cache may use, or 0 for no limit.
+             * @param maxDensity The maximum fraction of non-zero elements for a matrix to be stored sparse.
+             */
+            template <typename M, typename = std::enable_if_t<is_model_v<M>>>
+            SOSACache(const M & model, size_t maxBytes = 0, double maxDensity = 0.1);
+
+            /**
+             * @brief This function calls the input function with the SOSA matrix of the input action and observation.
+             *
+             * The function is called with either a const Matrix2D & or a
+             * const SparseMatrix2D &, depending on how the matrix is
+             * stored, so typically it should be a generic lambda. The
+             * matrix is computed first if it isn't cached.
+             *
+             * @param a The action of the matrix.
+             * @param o The observation of the matrix.
+             * @param f The function to call with the matrix.
+             *
+             * @return The return value of the input function.
+             */
+            template <typename F>
+            decltype(auto) apply(size_t a, size_t o, F && f) const;
+
+            /**
+             * @brief This function returns the SOSA matrix of the input action and observation.
+             *
+             * The returned pointer keeps the matrix alive even if it is
+             * evicted from the cache.
+             *
+             * @param a The action of the matrix.
+             * @param o The observation of the matrix.
+             *
+             * @return The matrix, computing it first if it isn't cached.
+             */
+            std::shared_ptr<const Block> get(size_t a, size_t o) const;
+
+            /**
+             * @brief This function sets the maximum memory the cache may use.
+             *
+             * If the cache currently uses more, matrices are evicted
+             * until it does not.
+             *
+             * @param maxBytes The maximum memory the cache may use, or 0 for no limit.
+             */
+            void setMaxBytes(size_t maxBytes);
+
+            /**
+             * @brief This function returns the maximum memory the cache may use.
+             *
+             * @return The maximum memory, or 0 for no limit.
+             */
+            size_t getMaxBytes() const;
+
+            /**
+             * @brief This function returns the memory currently used by the cached matrices.
+             *
+             * @return The memory used, in bytes.
+             */
+            size_t getBytes() const;
+
+            /**
+             * @brief This function returns the number of matrices computed so far.
+             *
+             * Matrices which have been evicted and computed again are
+             * counted once per computation.
+             *
+             * @return The number of matrices computed.
+             */
+            size_t getBuildCount() const;
+
+            /**
+             * @brief This function evicts all cached matrices.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the number of states of the model.
+             *
+             * @return The number of states.
+             */
+            size_t getS() const;
+
+            /**
+             * @brief This function returns the number of actions of the model.
+             *
+             * @return The number of actions.
+             */
+            size_t getA() const;
+
+            /**
+             * @brief This function returns the number of observations of the model.
+             *
+             * @return The number of observations.
+             */
+            size_t getO() const;
+
+        private:
+            using Builder = std::function<Block(size_t, size_t)>;
+
+            /**
+             * @brief This constructor is delegated to with a builder for the model's matrices.
+             */
+            SOSACache(size_t S, size_t A, size_t O, size_t maxBytes, double maxDensity, Builder builder);
+
+            /**
+             * @brief This function evicts least recently used matrices until the cache fits in the input memory.
+             *
+             * The lock must be held when calling this function.
+             *
+             * @param bytes The memory to fit in.
+             */
+            void evict(size_t bytes) const;
+
+            struct Entry {
+                std::shared_ptr<const Block> block;
+                size_t bytes;
+                std::list<size_t>::iterator lru;
+            };
+
+            size_t S, A, O;
+            size_t maxBytes_;
+            double maxDensity_;
+            Builder builder_;
+
+            mutable std::mutex mutex_;
+            mutable std::vector<Entry> entries_;
+            // Indeces of the cached entries, most recently used first.
+            mutable std::list<size_t> lru_;
+            mutable size_t bytes_, builds_;
+    };
+
+    template <typename M, typename>
+    SOSACache::SOSACache(const M & m, const size_t maxBytes, const double maxDensity) :
+            SOSACache(m.getS(), m.getA(), m.getO(), maxBytes, maxDensity, [&m](const size_t a, const size_t o) -> Block {
+                if constexpr(is_model_eigen_v<M>) {
+                    using T = remove_cv_ref_t<decltype(m.getTransitionFunction(a))>;
+                    const Vector obs = m.getObservationFunction(a).col(o);
+                    if constexpr(std::is_base_of_v<Eigen::SparseMatrixBase<T>, T>) {
+                        SparseMatrix2D retval = m.getTransitionFunction(a) * obs.asDiagonal();
+                        // Zero observation probabilities leave explicit zeros
+                        // in sparse products, so we remove them.
+                        retval.prune(0.0);
+                        return retval;
+                    } else {
+                        return Matrix2D(m.getTransitionFunction(a) * obs.asDiagonal());
+                    }
+                } else {
+                    Matrix2D retval(m.getS(), m.getS());
+                    for (size_t s = 0; s < m.getS(); ++s)
+                        for (size_t s1 = 0; s1 < m.getS(); ++s1)
+                            retval(s, s1) = m.getTransitionProbability(s, a, s1) * m.getObservationProbability(s1, a, o);
+                    return retval;
+                }
+            }) {}
+
+    template <typename F>
+    decltype(auto) SOSACache::apply(const size_t a, const size_t o, F && f) const {
+        const auto block = get(a, o);
+        return std::visit(std::forward<F>(f), *block);
+    }
+}
+
+#endif
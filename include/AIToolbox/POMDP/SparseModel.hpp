@@ -1,10 +1,12 @@
 #ifndef AI_TOOLBOX_POMDP_SPARSE_MODEL_HEADER_FILE
 #define AI_TOOLBOX_POMDP_SPARSE_MODEL_HEADER_FILE
 
+#include <cassert>
 #include <random>
 
 #include <AIToolbox/Impl/Seeder.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/MemoryUsage.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/MDP/Types.hpp>
 #include <AIToolbox/MDP/TypeTraits.hpp>
@@ -80,6 +82,7 @@ namespace AIToolbox::POMDP {
 
         public:
             using ObservationMatrix = SparseMatrix3D;
+            using ObservationColumns = Eigen::SparseMatrix<double, Eigen::ColMajor>;
 
             /**
              * @brief Basic constructor.
@@ -184,6 +187,34 @@ namespace AIToolbox::POMDP {
             template <typename ObFun>
             void setObservationFunction(const ObFun & of);
 
+            /**
+             * @brief This function sets whether a column-major copy of the observation function is kept.
+             *
+             * The observation function is stored row-major, one SxO
+             * matrix per action, which makes extracting the column of a
+             * given observation slow. Belief updates and makeSOSA() need
+             * exactly that column for each action-observation pair.
+             *
+             * When enabled, the SparseModel keeps an additional
+             * column-major copy of the observation function, so that
+             * those functions can visit only the new states with non-zero
+             * probability for the observation. This doubles the memory
+             * needed for the observation function.
+             *
+             * The copy is rebuilt every time the observation function is
+             * changed.
+             *
+             * @param enable Whether to keep the column-major copy.
+             */
+            void setObservationColumnCache(bool enable);
+
+            /**
+             * @brief This function returns whether a column-major copy of the observation function is kept.
+             *
+             * @return Whether the column-major copy is kept.
+             */
+            bool getObservationColumnCache() const;
+
             /**
              * @brief This function samples the POMDP for the specified state action pair.
              *
@@ -205,6 +236,25 @@ namespace AIToolbox::POMDP {
              */
             std::tuple<size_t,size_t, double> sampleSOR(size_t s,size_t a) const;
 
+            /**
+             * @brief This function samples the POMDP with the input random engine.
+             *
+             * This function is equivalent to sampleSOR(size_t, size_t),
+             * but does not touch the internal random engines of the model.
+             * This allows multiple threads to sample the same model at the
+             * same time, as long as each uses its own engine.
+             *
+             * This function is only available if the underlying MDP model
+             * can also be sampled with an external random engine.
+             *
+             * @param s The state that needs to be sampled.
+             * @param a The action that needs to be sampled.
+             * @param rnd The random engine to use.
+             *
+             * @return A tuple containing a new state, observation and reward.
+             */
+            std::tuple<size_t,size_t, double> sampleSOR(size_t s, size_t a, RandomEngine & rnd) const;
+
             /**
              * @brief This function samples the POMDP for the specified state action pair.
              *
@@ -254,6 +304,18 @@ namespace AIToolbox::POMDP {
              */
             const SparseMatrix2D & getObservationFunction(size_t a) const;
 
+            /**
+             * @brief This function returns the column-major observation function for a given action.
+             *
+             * This function must only be called when the column-major copy
+             * is kept (see setObservationColumnCache()).
+             *
+             * @param a The action requested.
+             *
+             * @return The column-major observation function for the input action.
+             */
+            const ObservationColumns & getObservationColumns(size_t a) const;
+
             /**
              * @brief This function returns the number of observations possible.
              *
@@ -268,9 +330,22 @@ namespace AIToolbox::POMDP {
              */
             const ObservationMatrix & getObservationFunction() const;
 
+            /**
+             * @brief This function returns the heap memory used by the model, in bytes.
+             *
+             * This includes the memory of the underlying MDP model, if it
+             * reports it, the sparse observation matrices and the cached
+             * observation columns.
+             *
+             * @return The memory allocated by the model.
+             */
+            size_t getMemoryUsage() const;
+
         private:
             size_t O;
             ObservationMatrix observations_;
+            std::vector<ObservationColumns> observationColumns_;
+            bool observationColumnCache_;
             // We need this because we don't know if our parent already has one,
             // and we wouldn't know how to access it!
             mutable RandomEngine rand_;
@@ -282,7 +357,7 @@ namespace AIToolbox::POMDP {
     template <typename... Args>
     SparseModel<M>::SparseModel(const size_t o, Args&&... params) :
             M(std::forward<Args>(params)...), O(o), observations_(this->getA(),
-            SparseMatrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed())
+            SparseMatrix2D(this->getS(), O)), observationColumnCache_(false), rand_(Impl::Seeder::getSeed())
     {
         for ( size_t a = 0; a < this->getA(); ++a ) {
             for ( size_t s1 = 0; s1 < this->getS(); ++s1 )
@@ -295,7 +370,8 @@ namespace AIToolbox::POMDP {
     template <typename ObFun, typename... Args, typename>
     SparseModel<M>::SparseModel(const size_t o, ObFun && of, Args&&... params) :
             M(std::forward<Args>(params)...), O(o),
-            observations_(this->getA(), SparseMatrix2D(this->getS(), O)), rand_(Impl::Seeder::getSeed())
+            observations_(this->getA(), SparseMatrix2D(this->getS(), O)), observationColumnCache_(false),
+            rand_(Impl::Seeder::getSeed())
     {
         setObservationFunction(of);
     }
@@ -304,14 +380,14 @@ namespace AIToolbox::POMDP {
     template <typename... Args>
     SparseModel<M>::SparseModel(NoCheck, size_t o, ObservationMatrix && ot, Args&&... params) :
             M(std::forward<Args>(params)...), O(o),
-            observations_(std::move(ot))
+            observations_(std::move(ot)), observationColumnCache_(false)
     {}
 
     template <typename M>
     template <typename PM, typename>
     SparseModel<M>::SparseModel(const PM& model) :
             M(model), O(model.getO()), observations_(this->getA(), SparseMatrix2D(this->getS(), O)),
-            rand_(Impl::Seeder::getSeed())
+            observationColumnCache_(false), rand_(Impl::Seeder::getSeed())
     {
         for ( size_t a = 0; a < this->getA(); ++a ) {
             for ( size_t s1 = 0; s1 < this->getS(); ++s1 ) {
@@ -337,6 +413,9 @@ namespace AIToolbox::POMDP {
                 if ( !isProbability(O, of[s1][a]) )
                     throw std::invalid_argument("Input observation matrix does not contain valid probabilities.");
 
+        for ( auto & of : observations_ )
+            of.setZero();
+
         for ( size_t s1 = 0; s1 < this->getS(); ++s1 )
             for ( size_t a = 0; a < this->getA(); ++a )
                 for ( size_t o = 0; o < O; ++o ) {
@@ -346,6 +425,26 @@ namespace AIToolbox::POMDP {
 
         for ( size_t a = 0; a < this->getA(); ++a )
             observations_[a].makeCompressed();
+
+        if ( observationColumnCache_ ) setObservationColumnCache(true);
+    }
+
+    template <typename M>
+    void SparseModel<M>::setObservationColumnCache(const bool enable) {
+        observationColumnCache_ = enable;
+        observationColumns_.clear();
+        if ( observationColumnCache_ ) {
+            observationColumns_.reserve(observations_.size());
+            for ( const auto & of : observations_ ) {
+                observationColumns_.emplace_back(of);
+                observationColumns_.back().makeCompressed();
+            }
+        }
+    }
+
+    template <typename M>
+    bool SparseModel<M>::getObservationColumnCache() const {
+        return observationColumnCache_;
     }
 
     template <typename M>
@@ -358,6 +457,12 @@ namespace AIToolbox::POMDP {
         return observations_[a];
     }
 
+    template <typename M>
+    const typename SparseModel<M>::ObservationColumns & SparseModel<M>::getObservationColumns(const size_t a) const {
+        assert(observationColumnCache_);
+        return observationColumns_[a];
+    }
+
     template <typename M>
     size_t SparseModel<M>::getO() const {
         return O;
@@ -368,6 +473,11 @@ namespace AIToolbox::POMDP {
         return observations_;
     }
 
+    template <typename M>
+    size_t SparseModel<M>::getMemoryUsage() const {
+        return heapUsage(static_cast<const M &>(*this)) + heapUsage(observations_) + heapUsage(observationColumns_);
+    }
+
     template <typename M>
     std::tuple<size_t,size_t, double> SparseModel<M>::sampleSOR(const size_t s, const size_t a) const {
         const auto [s1, r] = this->sampleSR(s, a);
@@ -375,6 +485,13 @@ namespace AIToolbox::POMDP {
         return std::make_tuple(s1, o, r);
     }
 
+    template <typename M>
+    std::tuple<size_t,size_t, double> SparseModel<M>::sampleSOR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const auto [s1, r] = this->sampleSR(s, a, rnd);
+        const auto o = sampleProbability(O, observations_[a].row(s1), rnd);
+        return std::make_tuple(s1, o, r);
+    }
+
     template <typename M>
     std::tuple<size_t, double> SparseModel<M>::sampleOR(const size_t s, const size_t a, const size_t s1) const {
         const size_t o = sampleProbability(O, observations_[a].row(s1), rand_);
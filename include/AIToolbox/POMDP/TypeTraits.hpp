@@ -45,6 +45,74 @@ namespace AIToolbox::POMDP {
     template <typename M>
     inline constexpr bool is_generative_model_v = is_generative_model<M>::value;
 
+    /**
+     * @brief This struct represents the required interface for a generative POMDP which can be sampled with external random engines.
+     *
+     * This struct is used to check whether the model can be sampled using
+     * a random engine provided by the caller, rather than its own internal
+     * ones. These models can be sampled concurrently by multiple threads,
+     * as long as each uses its own engine. The interface is the following:
+     *
+     * - std::tuple<size_t, size_t, double> sampleSOR(size_t s, size_t a, RandomEngine & rnd) const : Returns a sampled state-observation-reward tuple from (s,a) using rnd
+     *
+     * This is in addition to the is_generative_model interface, and to the
+     * MDP::is_generative_model_rng interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_generative_model_rng {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<std::tuple<size_t,size_t,double> (Z::*)(size_t,size_t,RandomEngine&) const>   (&Z::sampleSOR),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_generative_model_v<M> && MDP::is_generative_model_rng_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_generative_model_rng_v = is_generative_model_rng<M>::value;
+
+    /**
+     * @brief This struct represents the required interface for a generative POMDP which can sample many transitions at once.
+     *
+     * This struct is used to check whether the model can sample a whole
+     * batch of transitions in a single call, so that algorithms which need
+     * many independent samples can amortize the cost of each call (see
+     * MDP::is_generative_model_batch). The interface is the following:
+     *
+     * - void sampleSORBatch(TransitionBatch * batch) const : Samples a new state, observation and reward for each state-action pair in the batch, overwriting its nextStates, observations and rewards
+     *
+     * The output arrays are always resized to the number of pairs before
+     * the call. This is in addition to the is_generative_model interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct is_generative_model_batch {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<void (Z::*)(TransitionBatch *) const>                       (&Z::sampleSORBatch),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_generative_model_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool is_generative_model_batch_v = is_generative_model_batch<M>::value;
+
     /**
      * @brief This struct represents the required interface for a POMDP Model.
      *
@@ -147,6 +215,42 @@ namespace AIToolbox::POMDP {
     template <typename M>
     inline constexpr bool is_model_eigen_v = is_model_eigen<M>::value;
 
+    /**
+     * @brief This struct represents the interface of POMDP models which can keep a column-major copy of their observation function.
+     *
+     * Belief updates need, for a given action and observation, the
+     * probabilities of that observation across all new states; that is, a
+     * column of the observation function. Models with this interface can
+     * store those columns contiguously, so that only their non-zero
+     * entries need to be visited. The interface is the following:
+     *
+     * - bool getObservationColumnCache() const : Returns whether the column-major copy is currently kept.
+     * - getObservationColumns(size_t a) const : Returns the column-major observation function for action a.
+     *
+     * This is in addition to the is_model_eigen interface.
+     *
+     * @tparam M The class to test for the interface.
+     */
+    template <typename M>
+    struct has_observation_columns {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+
+                    static_cast<bool (Z::*)() const>(&Z::getObservationColumnCache),
+                    std::declval<const Z>().getObservationColumns(0).col(0),
+
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = is_model_eigen_v<M> && test<M>(0) };
+    };
+    template <typename M>
+    inline constexpr bool has_observation_columns_v = has_observation_columns<M>::value;
+
     /**
      * @brief This struct verifies that a class satisfies the is_model interface but not the is_model_eigen interface.
      *
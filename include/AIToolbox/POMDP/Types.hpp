@@ -11,6 +11,14 @@ namespace AIToolbox::POMDP {
      */
     using Belief            = ProbabilityVector;
 
+    /**
+     * @brief This represents a belief over a number of states known at compile time.
+     *
+     * Fixed beliefs live on the stack, and are used with POMDP::FixedModel.
+     */
+    template <int N>
+    using FixedBelief       = FixedVector<N>;
+
     /**
      * @name POMDP Value Types
      *
@@ -78,6 +86,21 @@ namespace AIToolbox::POMDP {
     using ValueFunction = std::vector<VList>;
 
     /** @}  */
+
+    /**
+     * @brief This struct represents a batch of POMDP transitions.
+     *
+     * As MDP::TransitionBatch, transitions are stored as a structure of
+     * arrays, and the i-th transition is made of the i-th element of each
+     * array. Each transition also contains the observation received.
+     */
+    struct TransitionBatch {
+        std::vector<size_t> states;
+        std::vector<size_t> actions;
+        std::vector<size_t> nextStates;
+        std::vector<size_t> observations;
+        std::vector<double> rewards;
+    };
 }
 
 #endif
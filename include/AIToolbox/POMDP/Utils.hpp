@@ -1,19 +1,125 @@
 #ifndef AI_TOOLBOX_POMDP_UTILS_HEADER_FILE
 #define AI_TOOLBOX_POMDP_UTILS_HEADER_FILE
 
+#include <cassert>
 #include <cstddef>
 #include <iterator>
 #include <numeric>
 
+#include <AIToolbox/Kernels.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Utils/Polytope.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/PackedVList.hpp>
 
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/functional/hash.hpp>
 
+namespace AIToolbox::Impl {
+    // Returns whether the model keeps a column-major copy of its
+    // observation function, which we can use to only visit the new states
+    // which can produce a given observation.
+    template <typename M>
+    bool hasObservationColumns(const M & model) {
+        if constexpr(POMDP::has_observation_columns_v<M>)
+            return model.getObservationColumnCache();
+        else
+            return false;
+    }
+
+    // Computes br = (b^T * T[a])^T with the vectorized kernels, if the
+    // model stores dense transitions and the belief is large enough.
+    // Returns whether it did.
+    template <typename M, typename B1, typename B2>
+    bool predictBeliefWithKernels(const M & model, const B1 & b, const size_t a, B2 & br) {
+        using TMatrix = remove_cv_ref_t<decltype(model.getTransitionFunction(a))>;
+        if constexpr(std::is_same_v<B1, Vector> && std::is_same_v<B2, Vector> && std::is_same_v<TMatrix, Matrix2D>) {
+            const size_t S = model.getS();
+            if ( S < Kernels::MinSize || &b == &br ) return false;
+
+            br.resize(S);
+            getKernels().gemvT(S, S, model.getTransitionFunction(a).data(), b.data(), br.data());
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    // These contain the actual belief update computations, so that they
+    // can be shared between the Belief and FixedBelief overloads.
+    template <typename M, typename B1, typename B2>
+    void updateBeliefUnnormalized(const M & model, const B1 & b, const size_t a, const size_t o, B2 & br) {
+        if constexpr(POMDP::has_observation_columns_v<M>) {
+            if (model.getObservationColumnCache()) {
+                using C = remove_cv_ref_t<decltype(model.getObservationColumns(a))>;
+                const auto & obs = model.getObservationColumns(a);
+                const B2 tmp = (b.transpose() * model.getTransitionFunction(a)).transpose();
+                br.setZero();
+                for (typename C::InnerIterator it(obs, o); it; ++it)
+                    br[it.index()] = it.value() * tmp[it.index()];
+                return;
+            }
+        }
+        if constexpr(POMDP::is_model_eigen_v<M>) {
+            using OMatrix = remove_cv_ref_t<decltype(model.getObservationFunction(a))>;
+            if constexpr(std::is_same_v<OMatrix, Matrix2D>) {
+                if ( predictBeliefWithKernels(model, b, a, br) ) {
+                    br.array() *= model.getObservationFunction(a).col(o).array();
+                    return;
+                }
+            }
+            br = model.getObservationFunction(a).col(o).cwiseProduct((b.transpose() * model.getTransitionFunction(a)).transpose());
+        } else {
+            const size_t S = model.getS();
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                double sum = 0.0;
+                for ( size_t s = 0; s < S; ++s )
+                    sum += model.getTransitionProbability(s,a,s1) * b[s];
+
+                br[s1] = model.getObservationProbability(s1,a,o) * sum;
+            }
+        }
+    }
+
+    template <typename M, typename B1, typename B2>
+    void updateBeliefPartial(const M & model, const B1 & b, const size_t a, B2 & br) {
+        if constexpr(POMDP::is_model_eigen_v<M>) {
+            if ( !predictBeliefWithKernels(model, b, a, br) )
+                br = (b.transpose() * model.getTransitionFunction(a)).transpose();
+        } else {
+            const size_t S = model.getS();
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                br[s1] = 0.0;
+                for ( size_t s = 0; s < S; ++s )
+                    br[s1] += model.getTransitionProbability(s,a,s1) * b[s];
+            }
+        }
+    }
+
+    template <typename M, typename B1, typename B2>
+    void updateBeliefPartialUnnormalized(const M & model, const B1 & b, const size_t a, const size_t o, B2 & br) {
+        if constexpr(POMDP::has_observation_columns_v<M>) {
+            if (model.getObservationColumnCache()) {
+                using C = remove_cv_ref_t<decltype(model.getObservationColumns(a))>;
+                br.setZero();
+                for (typename C::InnerIterator it(model.getObservationColumns(a), o); it; ++it)
+                    br[it.index()] = it.value() * b[it.index()];
+                return;
+            }
+        }
+        if constexpr(POMDP::is_model_eigen_v<M>) {
+            br = model.getObservationFunction(a).col(o).cwiseProduct(b);
+        } else {
+            const size_t S = model.getS();
+            for ( size_t s = 0; s < S; ++s )
+                br[s] = model.getObservationProbability(s, a, o) * b[s];
+        }
+    }
+}
+
 namespace AIToolbox::POMDP {
     /**
      * @brief This function lexicographically sorts VEntries.
@@ -72,6 +178,18 @@ namespace AIToolbox::POMDP {
      */
     ValueFunction makeValueFunction(size_t S);
 
+    /**
+     * @brief This function returns the heap memory used by a ValueFunction, in bytes.
+     *
+     * This includes the values and observation vectors of all VEntries
+     * in all VLists.
+     *
+     * @param v The ValueFunction to measure.
+     *
+     * @return The memory allocated by the ValueFunction.
+     */
+    size_t getMemoryUsage(const ValueFunction & v);
+
     /**
      * @brief This function returns a weak measure of distance between two VLists.
      *
@@ -83,12 +201,20 @@ namespace AIToolbox::POMDP {
      * We define distance between two ValueFunctions as the maximum between their
      * element-wise difference.
      *
+     * Between consecutive timesteps of a converging solver most vectors do not
+     * change, so new vectors with an identical old one are found by hashing
+     * and skipped. The remaining ones are compared with the old vectors, and
+     * each comparison stops as soon as it cannot change the result. If a
+     * ThreadPool is passed, these comparisons are split between its threads;
+     * the result does not depend on the number of threads.
+     *
      * @param oldV The fist VList to compare.
      * @param newV The second VList to compare.
+     * @param pool The ThreadPool to use to compare vectors, or nullptr.
      *
      * @return The weak bound distance between the two arguments.
      */
-    double weakBoundDistance(const VList & oldV, const VList & newV);
+    double weakBoundDistance(const VList & oldV, const VList & newV, ThreadPool * pool = nullptr);
 
     /**
      * @brief This function creates the SOSA matrix for the input POMDP.
@@ -111,10 +237,33 @@ namespace AIToolbox::POMDP {
     template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
     auto makeSOSA(const M & m) {
         if constexpr(is_model_eigen_v<M>) {
-            boost::multi_array<remove_cv_ref_t<decltype(m.getTransitionFunction(0))>, 2> retval( boost::extents[m.getA()][m.getO()] );
-            for (size_t a = 0; a < m.getA(); ++a)
-                for (size_t o = 0; o < m.getO(); ++o)
+            using T = remove_cv_ref_t<decltype(m.getTransitionFunction(0))>;
+            boost::multi_array<T, 2> retval( boost::extents[m.getA()][m.getO()] );
+            const bool useColumns = Impl::hasObservationColumns(m);
+            for (size_t a = 0; a < m.getA(); ++a) {
+                for (size_t o = 0; o < m.getO(); ++o) {
+                    if constexpr(has_observation_columns_v<M> && std::is_same_v<T, SparseMatrix2D>) {
+                        if (useColumns) {
+                            // Multiplying by a sparse diagonal only
+                            // produces entries for the new states which
+                            // can emit o, so there is nothing to prune.
+                            using C = remove_cv_ref_t<decltype(m.getObservationColumns(a))>;
+                            const auto & obs = m.getObservationColumns(a);
+                            SparseMatrix2D diag(m.getS(), m.getS());
+                            diag.reserve(Eigen::VectorXi::Constant(m.getS(), 1));
+                            for (typename C::InnerIterator it(obs, o); it; ++it)
+                                diag.insert(it.index(), it.index()) = it.value();
+                            retval[a][o] = m.getTransitionFunction(a) * diag;
+                            continue;
+                        }
+                    }
                     retval[a][o] = m.getTransitionFunction(a) * Vector(m.getObservationFunction(a).col(o)).asDiagonal();
+                    // Zero observation probabilities leave explicit zeros
+                    // in sparse products, so we remove them.
+                    if constexpr(std::is_same_v<T, SparseMatrix2D>)
+                        retval[a][o].prune(0.0);
+                }
+            }
             return retval;
         } else {
             Matrix4D retval( boost::extents[m.getA()][m.getO()] );
@@ -151,20 +300,7 @@ namespace AIToolbox::POMDP {
     void updateBeliefUnnormalized(const M & model, const Belief & b, const size_t a, const size_t o, Belief * bRet) {
         if (!bRet) return;
 
-        auto & br = *bRet;
-
-        if constexpr(is_model_eigen_v<M>) {
-            br = model.getObservationFunction(a).col(o).cwiseProduct((b.transpose() * model.getTransitionFunction(a)).transpose());
-        } else {
-            const size_t S = model.getS();
-            for ( size_t s1 = 0; s1 < S; ++s1 ) {
-                double sum = 0.0;
-                for ( size_t s = 0; s < S; ++s )
-                    sum += model.getTransitionProbability(s,a,s1) * b[s];
-
-                br[s1] = model.getObservationProbability(s1,a,o) * sum;
-            }
-        }
+        Impl::updateBeliefUnnormalized(model, b, a, o, *bRet);
     }
 
     /**
@@ -248,6 +384,168 @@ namespace AIToolbox::POMDP {
         return br;
     }
 
+    /**
+     * @brief Updates many beliefs with the same action and observation at once.
+     *
+     * This function is equivalent to calling updateBeliefUnnormalized()
+     * on each belief, but updates all of them with a single
+     * matrix-matrix product, which is much faster when there are many.
+     *
+     * The output matrix is resized as needed, and must not alias the input.
+     *
+     * @tparam M The type of the POMDP Model.
+     * @param model The model used to update the beliefs.
+     * @param beliefs The old beliefs, one per row.
+     * @param a The action taken during the transition.
+     * @param o The observation registered.
+     * @param bRet The output beliefs, one per row.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefsUnnormalized(const M & model, const Matrix2D & beliefs, const size_t a, const size_t o, Matrix2D * bRet) {
+        if (!bRet) return;
+
+        auto & br = *bRet;
+
+        if constexpr(is_model_eigen_v<M>) {
+            // Extracting a column is slow for row-major sparse matrices,
+            // so we only do it once.
+            Vector obs;
+            if constexpr(has_observation_columns_v<M>) {
+                if (model.getObservationColumnCache()) obs = model.getObservationColumns(a).col(o);
+                else                                   obs = model.getObservationFunction(a).col(o);
+            } else {
+                obs = model.getObservationFunction(a).col(o);
+            }
+            br.noalias() = beliefs * model.getTransitionFunction(a);
+            br.array().rowwise() *= obs.transpose().array();
+        } else {
+            const size_t S = model.getS();
+            br.resize(beliefs.rows(), S);
+
+            Belief b(S), tmp(S);
+            for ( Eigen::Index i = 0; i < beliefs.rows(); ++i ) {
+                b = beliefs.row(i).transpose();
+                updateBeliefUnnormalized(model, b, a, o, &tmp);
+                br.row(i) = tmp.transpose();
+            }
+        }
+    }
+
+    /**
+     * @brief Updates many beliefs, each with its own action and observation.
+     *
+     * This function is equivalent to calling updateBeliefUnnormalized()
+     * on each belief. Beliefs sharing the same action and observation are
+     * gathered and updated together, as in
+     * updateBeliefsUnnormalized(const M &, const Matrix2D &, size_t, size_t, Matrix2D *).
+     *
+     * The output matrix is resized as needed, and must not alias the input.
+     *
+     * @tparam M The type of the POMDP Model.
+     * @param model The model used to update the beliefs.
+     * @param beliefs The old beliefs, one per row.
+     * @param actions The action taken from each belief.
+     * @param observations The observation registered for each belief.
+     * @param bRet The output beliefs, one per row.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefsUnnormalized(const M & model, const Matrix2D & beliefs, const std::vector<size_t> & actions, const std::vector<size_t> & observations, Matrix2D * bRet) {
+        if (!bRet) return;
+
+        const size_t N = beliefs.rows();
+        const size_t O = model.getO();
+        assert(actions.size() == N && observations.size() == N);
+
+        auto & br = *bRet;
+        br.resize(N, model.getS());
+
+        // We sort the beliefs by (a,o) with a counting sort, so that each
+        // group can be gathered in order into a contiguous block.
+        std::vector<size_t> starts(model.getA() * O + 1, 0);
+        for ( size_t i = 0; i < N; ++i )
+            ++starts[actions[i] * O + observations[i] + 1];
+        for ( size_t g = 1; g < starts.size(); ++g )
+            starts[g] += starts[g - 1];
+
+        std::vector<size_t> order(N);
+        {
+            auto next = starts;
+            for ( size_t i = 0; i < N; ++i )
+                order[next[actions[i] * O + observations[i]]++] = i;
+        }
+
+        Matrix2D group, result;
+        for ( size_t g = 0; g + 1 < starts.size(); ++g ) {
+            const size_t begin = starts[g], size = starts[g + 1] - begin;
+            if ( !size ) continue;
+
+            group.resize(size, beliefs.cols());
+            for ( size_t i = 0; i < size; ++i )
+                group.row(i) = beliefs.row(order[begin + i]);
+
+            updateBeliefsUnnormalized(model, group, g / O, g % O, &result);
+
+            for ( size_t i = 0; i < size; ++i )
+                br.row(order[begin + i]) = result.row(i);
+        }
+    }
+
+    /**
+     * @brief Updates and normalizes many beliefs with the same action and observation at once.
+     *
+     * This function is equivalent to calling updateBelief() on each
+     * belief.
+     *
+     * NOTE: As for updateBelief(), this function assumes that the update
+     * and the normalization are possible for all beliefs.
+     *
+     * The output matrix is resized as needed, and must not alias the input.
+     *
+     * @tparam M The type of the POMDP Model.
+     * @param model The model used to update the beliefs.
+     * @param beliefs The old beliefs, one per row.
+     * @param a The action taken during the transition.
+     * @param o The observation registered.
+     * @param bRet The output beliefs, one per row.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefs(const M & model, const Matrix2D & beliefs, const size_t a, const size_t o, Matrix2D * bRet) {
+        if (!bRet) return;
+
+        updateBeliefsUnnormalized(model, beliefs, a, o, bRet);
+
+        auto & br = *bRet;
+        br.array().colwise() /= br.rowwise().sum().array();
+    }
+
+    /**
+     * @brief Updates and normalizes many beliefs, each with its own action and observation.
+     *
+     * This function is equivalent to calling updateBelief() on each
+     * belief.
+     *
+     * NOTE: As for updateBelief(), this function assumes that the update
+     * and the normalization are possible for all beliefs.
+     *
+     * The output matrix is resized as needed, and must not alias the input.
+     *
+     * @tparam M The type of the POMDP Model.
+     * @param model The model used to update the beliefs.
+     * @param beliefs The old beliefs, one per row.
+     * @param actions The action taken from each belief.
+     * @param observations The observation registered for each belief.
+     * @param bRet The output beliefs, one per row.
+     */
+    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefs(const M & model, const Matrix2D & beliefs, const std::vector<size_t> & actions, const std::vector<size_t> & observations, Matrix2D * bRet) {
+        if (!bRet) return;
+
+        updateBeliefsUnnormalized(model, beliefs, actions, observations, bRet);
+
+        auto & br = *bRet;
+        br.array().colwise() /= br.rowwise().sum().array();
+    }
+
     /**
      * @brief This function partially updates a belief.
      *
@@ -269,18 +567,7 @@ namespace AIToolbox::POMDP {
     void updateBeliefPartial(const M & model, const Belief & b, const size_t a, Belief * bRet) {
         if (!bRet) return;
 
-        auto & br = *bRet;
-
-        if constexpr(is_model_eigen_v<M>) {
-            br = (b.transpose() * model.getTransitionFunction(a)).transpose();
-        } else {
-            const size_t S = model.getS();
-            for ( size_t s1 = 0; s1 < S; ++s1 ) {
-                br[s1] = 0.0;
-                for ( size_t s = 0; s < S; ++s )
-                    br[s1] += model.getTransitionProbability(s,a,s1) * b[s];
-            }
-        }
+        Impl::updateBeliefPartial(model, b, a, *bRet);
     }
 
     /**
@@ -330,15 +617,7 @@ namespace AIToolbox::POMDP {
     void updateBeliefPartialUnnormalized(const M & model, const Belief & b, const size_t a, const size_t o, Belief * bRet) {
         if (!bRet) return;
 
-        auto & br = *bRet;
-
-        if constexpr(is_model_eigen_v<M>) {
-            br = model.getObservationFunction(a).col(o).cwiseProduct(b);
-        } else {
-            const size_t S = model.getS();
-            for ( size_t s = 0; s < S; ++s )
-                br[s] = model.getObservationProbability(s, a, o) * b[s];
-        }
+        Impl::updateBeliefPartialUnnormalized(model, b, a, o, *bRet);
     }
 
     /**
@@ -438,17 +717,103 @@ namespace AIToolbox::POMDP {
         return newB;
     }
 
+    /**
+     * @name FixedBelief updates
+     *
+     * These are the FixedBelief counterparts of the belief update functions
+     * above, and behave in the same way. They are meant to be used with
+     * models of known size such as POMDP::FixedModel, where the whole
+     * update is computed on the stack without allocating memory.
+     *
+     * @{
+     */
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefUnnormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o, FixedBelief<N> * bRet) {
+        if (!bRet) return;
+
+        Impl::updateBeliefUnnormalized(model, b, a, o, *bRet);
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    FixedBelief<N> updateBeliefUnnormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o) {
+        FixedBelief<N> br;
+        Impl::updateBeliefUnnormalized(model, b, a, o, br);
+        return br;
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBelief(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o, FixedBelief<N> * bRet) {
+        if (!bRet) return;
+
+        Impl::updateBeliefUnnormalized(model, b, a, o, *bRet);
+        *bRet /= bRet->sum();
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    FixedBelief<N> updateBelief(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o) {
+        FixedBelief<N> br;
+        updateBelief(model, b, a, o, &br);
+        return br;
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefPartial(const M & model, const FixedBelief<N> & b, const size_t a, FixedBelief<N> * bRet) {
+        if (!bRet) return;
+
+        Impl::updateBeliefPartial(model, b, a, *bRet);
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    FixedBelief<N> updateBeliefPartial(const M & model, const FixedBelief<N> & b, const size_t a) {
+        FixedBelief<N> br;
+        Impl::updateBeliefPartial(model, b, a, br);
+        return br;
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefPartialUnnormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o, FixedBelief<N> * bRet) {
+        if (!bRet) return;
+
+        Impl::updateBeliefPartialUnnormalized(model, b, a, o, *bRet);
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    FixedBelief<N> updateBeliefPartialUnnormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o) {
+        FixedBelief<N> br;
+        Impl::updateBeliefPartialUnnormalized(model, b, a, o, br);
+        return br;
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    void updateBeliefPartialNormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o, FixedBelief<N> * bRet) {
+        if (!bRet) return;
+
+        Impl::updateBeliefPartialUnnormalized(model, b, a, o, *bRet);
+        *bRet /= bRet->sum();
+    }
+
+    template <typename M, int N, std::enable_if_t<is_model_v<M>, int> = 0>
+    FixedBelief<N> updateBeliefPartialNormalized(const M & model, const FixedBelief<N> & b, const size_t a, const size_t o) {
+        FixedBelief<N> br;
+        updateBeliefPartialNormalized(model, b, a, o, &br);
+        return br;
+    }
+
+    /** @} */
+
     /**
      * @brief This function computes an immediate reward based on a belief rather than a state.
      *
+     * @tparam B The type of the belief, either a Belief or a FixedBelief.
      * @param model The POMDP model to use.
      * @param b The belief to use.
      * @param a The action performed from the belief.
      *
      * @return The immediate reward.
      */
-    template <typename M, std::enable_if_t<is_model_v<M>, int> = 0>
-    double beliefExpectedReward(const M& model, const Belief & b, const size_t a) {
+    template <typename M, typename B, std::enable_if_t<is_model_v<M> && std::is_base_of_v<Eigen::MatrixBase<B>, B>, int> = 0>
+    double beliefExpectedReward(const M& model, const B & b, const size_t a) {
         if constexpr (is_model_eigen_v<M>) {
             return model.getRewardFunction().col(a).dot(b);
         } else {
@@ -504,6 +869,44 @@ namespace AIToolbox::POMDP {
         return entry;
     }
 
+    /**
+     * @brief This function computes the best VEntry for the input belief from the input packed VLists.
+     *
+     * This function is equivalent to the one taking a list of VLists, but
+     * finds the best match for each observation with a single
+     * matrix-vector product. Each PackedVList must store at least one
+     * observation index per entry.
+     *
+     * @param b The belief to compute the VEntry for.
+     * @param row The list of PackedVLists, one per observation.
+     * @param a The action this Ventry stands for.
+     * @param value A pointer to double, which gets set to the value of the given belief with the generated VEntry.
+     *
+     * @return The best VEntry for the input belief.
+     */
+    VEntry crossSumBestAtBelief(const Belief & b, const std::vector<PackedVList> & row, size_t a, double * value = nullptr);
+
+    /**
+     * @brief This function computes the best VEntries for all the input beliefs from the input packed VLists.
+     *
+     * This function is equivalent to calling crossSumBestAtBelief() for
+     * each belief, but it finds the best matches of all beliefs for each
+     * observation with a single matrix-matrix product between the beliefs
+     * and the packed VList. This allows Eigen to use its blocked product
+     * kernels, rather than performing a matrix-vector product per belief.
+     *
+     * Each PackedVList must store at least one observation index per
+     * entry.
+     *
+     * @param beliefs The beliefs to compute the VEntries for, one per row.
+     * @param row The list of PackedVLists, one per observation.
+     * @param a The action the VEntries stand for.
+     * @param values A pointer to Vector, which gets set to the value of each belief with its generated VEntry.
+     *
+     * @return The best VEntry for each input belief, in order.
+     */
+    VList crossSumBestAtBeliefs(const Matrix2D & beliefs, const std::vector<PackedVList> & row, size_t a, Vector * values = nullptr);
+
     /**
      * @brief This function computes the best VEntry for the input belief across all actions.
      *
@@ -0,0 +1,377 @@
+#ifndef AI_TOOLBOX_EVALUATE_HEADER_FILE
+#define AI_TOOLBOX_EVALUATE_HEADER_FILE
+
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/Tools/Statistics.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/MDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/TypeTraits.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/Factored/Types.hpp>
+
+#include <mutex>
+#include <numeric>
+
+/**
+ * @file Evaluate.hpp
+ *
+ * This file contains functions to evaluate policies and online planners
+ * over many episodes, possibly in parallel.
+ *
+ * All functions take a factory, which is called once per episode with a
+ * seed and must return the agent to evaluate. The agent is a callable which
+ * takes what it can observe (a state, or a belief for POMDPs) and the
+ * number of timesteps left in the episode, and returns the action to take.
+ * For example, to evaluate an MDP::MCTS:
+ *
+ * ~~~{.cpp}
+ * auto stats = evaluateMDP(model, 0, [&](unsigned) {
+ *     return [mcts = MDP::MCTS<decltype(model)>(model, 1000, 5.0)](size_t s, unsigned h) mutable {
+ *         return mcts.sampleAction(s, h);
+ *     };
+ * }, 10000, 50, &pool);
+ * ~~~
+ *
+ * Each episode samples the environment with its own random engine, created
+ * from the input seed and the index of the episode (see
+ * makeEngineStream()), so that results only depend on the seed and on the
+ * number of threads. The engine is also used to draw the seed passed to
+ * the factory.
+ *
+ * If the model supports sampling with an external random engine (see
+ * MDP::is_generative_model_rng), the environment is sampled concurrently.
+ * Otherwise, calls to the model's sampling functions are serialized, which
+ * is correct but limits scaling. If such a model can instead sample
+ * whole batches of transitions (see MDP::is_generative_model_batch and
+ * POMDP::is_generative_model_batch), the episodes of each thread are run
+ * in lockstep in groups of up to EpisodeGroupSize, and each timestep of a
+ * group is sampled with a single call. Note that agents which sample the model
+ * themselves, like MDP::MCTS, use its internal engine: in that case the
+ * factory should give each agent its own copy of the model.
+ *
+ * The returned Statistics contain the reward obtained at each timestep.
+ * Once an episode reaches a terminal state, its remaining timesteps are
+ * recorded as zero, so that the cumulative mean is the mean undiscounted
+ * return of the agent.
+ */
+
+namespace AIToolbox {
+    /// The maximum number of episodes run in lockstep with models which sample in batches.
+    inline constexpr size_t EpisodeGroupSize = 64;
+
+    namespace Impl {
+        /**
+         * @brief This function runs episodes in parallel, merging their Statistics.
+         *
+         * The episodes are split in one contiguous chunk per thread, each
+         * with its own Statistics, which are merged in order at the end.
+         *
+         * @param episodes The number of episodes to run.
+         * @param horizon The number of timesteps of each episode.
+         * @param pool The ThreadPool to use, or nullptr.
+         * @param seed The seed of the random engines.
+         * @param run A function taking an episode's engine and Statistics.
+         *
+         * @return The merged Statistics.
+         */
+        template <typename Run>
+        Statistics runEpisodes(const size_t episodes, const unsigned horizon, ThreadPool * pool, const unsigned seed, Run && run) {
+            const size_t chunks = std::max(size_t(1), std::min(episodes, pool ? pool->getThreadNumber() : 1));
+            std::vector<Statistics> partials(chunks, Statistics(horizon));
+
+            const auto process = [&](const size_t begin, const size_t end) {
+                for (size_t c = begin; c < end; ++c) {
+                    for (size_t e = c * episodes / chunks; e < (c + 1) * episodes / chunks; ++e) {
+                        auto rnd = makeEngineStream<RandomEngine>(seed, e);
+                        run(rnd, partials[c]);
+                    }
+                }
+            };
+
+            if (pool) pool->parallelFor(chunks, process);
+            else process(0, chunks);
+
+            for (size_t c = 1; c < chunks; ++c)
+                partials[0].merge(partials[c]);
+
+            return std::move(partials[0]);
+        }
+
+        /**
+         * @brief This function runs episodes in parallel in lockstep groups, merging their Statistics.
+         *
+         * This works as runEpisodes(), but the episodes of each chunk are
+         * passed to the run function in groups of up to
+         * EpisodeGroupSize, each with its own engine.
+         *
+         * @param episodes The number of episodes to run.
+         * @param horizon The number of timesteps of each episode.
+         * @param pool The ThreadPool to use, or nullptr.
+         * @param seed The seed of the random engines.
+         * @param run A function taking the engines of a group of episodes and a Statistics.
+         *
+         * @return The merged Statistics.
+         */
+        template <typename Run>
+        Statistics runEpisodeGroups(const size_t episodes, const unsigned horizon, ThreadPool * pool, const unsigned seed, Run && run) {
+            const size_t chunks = std::max(size_t(1), std::min(episodes, pool ? pool->getThreadNumber() : 1));
+            std::vector<Statistics> partials(chunks, Statistics(horizon));
+
+            const auto process = [&](const size_t begin, const size_t end) {
+                std::vector<RandomEngine> rnds;
+                for (size_t c = begin; c < end; ++c) {
+                    const size_t last = (c + 1) * episodes / chunks;
+                    for (size_t e = c * episodes / chunks; e < last; e += EpisodeGroupSize) {
+                        rnds.clear();
+                        for (size_t g = e; g < std::min(last, e + EpisodeGroupSize); ++g)
+                            rnds.push_back(makeEngineStream<RandomEngine>(seed, g));
+                        run(rnds, partials[c]);
+                    }
+                }
+            };
+
+            if (pool) pool->parallelFor(chunks, process);
+            else process(0, chunks);
+
+            for (size_t c = 1; c < chunks; ++c)
+                partials[0].merge(partials[c]);
+
+            return std::move(partials[0]);
+        }
+    }
+
+    /**
+     * @brief This function evaluates an agent on an MDP over many episodes.
+     *
+     * @param model The generative MDP to evaluate the agent on.
+     * @param s0 The initial state of each episode.
+     * @param makeAgent A factory taking a seed and returning an agent.
+     * @param episodes The number of episodes to run.
+     * @param horizon The number of timesteps of each episode.
+     * @param pool The ThreadPool to use, or nullptr.
+     * @param seed The seed of the random engines.
+     *
+     * @return The Statistics of the rewards obtained at each timestep.
+     */
+    template <typename M, typename Factory>
+    Statistics evaluateMDP(const M & model, const size_t s0, Factory && makeAgent, const size_t episodes, const unsigned horizon,
+                           ThreadPool * pool = nullptr, const unsigned seed = Impl::Seeder::getSeed())
+    {
+        static_assert(MDP::is_generative_model_v<M>, "This function only works for generative MDP models!");
+
+        std::mutex modelMutex;
+        if constexpr (MDP::is_generative_model_batch_v<M> && !MDP::is_generative_model_rng_v<M>) {
+            return Impl::runEpisodeGroups(episodes, horizon, pool, seed, [&](std::vector<RandomEngine> & rnds, Statistics & stats) {
+                std::vector<decltype(makeAgent(0u))> agents;
+                agents.reserve(rnds.size());
+                for (auto & rnd : rnds)
+                    agents.push_back(makeAgent(static_cast<unsigned>(rnd())));
+
+                // The running episodes, and their current states.
+                std::vector<size_t> ids(rnds.size());
+                std::iota(std::begin(ids), std::end(ids), 0);
+                std::vector<size_t> states(rnds.size(), s0);
+
+                MDP::TransitionBatch batch;
+                for (unsigned t = 0; t < horizon && ids.size(); ++t) {
+                    size_t j = 0;
+                    for (const auto id : ids) {
+                        if (model.isTerminal(states[id])) {
+                            for (auto tt = t; tt < horizon; ++tt) stats.record(0.0, tt);
+                            continue;
+                        }
+                        ids[j++] = id;
+                    }
+                    ids.resize(j);
+                    if (!j) break;
+
+                    batch.states.resize(j);
+                    batch.actions.resize(j);
+                    batch.nextStates.resize(j);
+                    batch.rewards.resize(j);
+                    for (size_t i = 0; i < j; ++i) {
+                        batch.states[i] = states[ids[i]];
+                        batch.actions[i] = agents[ids[i]](states[ids[i]], horizon - t);
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(modelMutex);
+                        model.sampleSRBatch(&batch);
+                    }
+                    for (size_t i = 0; i < j; ++i) {
+                        states[ids[i]] = batch.nextStates[i];
+                        stats.record(batch.rewards[i], t);
+                    }
+                }
+            });
+        }
+        return Impl::runEpisodes(episodes, horizon, pool, seed, [&](RandomEngine & rnd, Statistics & stats) {
+            auto agent = makeAgent(static_cast<unsigned>(rnd()));
+
+            size_t s = s0;
+            for (unsigned t = 0; t < horizon; ++t) {
+                if (model.isTerminal(s)) {
+                    for (; t < horizon; ++t) stats.record(0.0, t);
+                    break;
+                }
+                const size_t a = agent(s, horizon - t);
+
+                double r;
+                if constexpr (MDP::is_generative_model_rng_v<M>) {
+                    std::tie(s, r) = model.sampleSR(s, a, rnd);
+                } else {
+                    std::lock_guard<std::mutex> lock(modelMutex);
+                    std::tie(s, r) = model.sampleSR(s, a);
+                }
+                stats.record(r, t);
+            }
+        });
+    }
+
+    /**
+     * @brief This function evaluates an agent on a POMDP over many episodes.
+     *
+     * The initial state of each episode is sampled from the initial belief.
+     * The belief of the agent is then tracked with POMDP::updateBelief(),
+     * and passed to it at each timestep.
+     *
+     * @param model The POMDP to evaluate the agent on.
+     * @param b0 The initial belief of each episode.
+     * @param makeAgent A factory taking a seed and returning an agent.
+     * @param episodes The number of episodes to run.
+     * @param horizon The number of timesteps of each episode.
+     * @param pool The ThreadPool to use, or nullptr.
+     * @param seed The seed of the random engines.
+     *
+     * @return The Statistics of the rewards obtained at each timestep.
+     */
+    template <typename M, typename Factory>
+    Statistics evaluatePOMDP(const M & model, const POMDP::Belief & b0, Factory && makeAgent, const size_t episodes, const unsigned horizon,
+                             ThreadPool * pool = nullptr, const unsigned seed = Impl::Seeder::getSeed())
+    {
+        static_assert(POMDP::is_model_v<M>, "This function only works for POMDP models!");
+
+        std::mutex modelMutex;
+        if constexpr (POMDP::is_generative_model_batch_v<M> && !POMDP::is_generative_model_rng_v<M>) {
+            return Impl::runEpisodeGroups(episodes, horizon, pool, seed, [&](std::vector<RandomEngine> & rnds, Statistics & stats) {
+                std::vector<decltype(makeAgent(0u))> agents;
+                agents.reserve(rnds.size());
+                for (auto & rnd : rnds)
+                    agents.push_back(makeAgent(static_cast<unsigned>(rnd())));
+
+                // The running episodes, and their current states and beliefs.
+                std::vector<size_t> ids(rnds.size()), states(rnds.size());
+                std::iota(std::begin(ids), std::end(ids), 0);
+                std::vector<POMDP::Belief> beliefs(rnds.size(), b0);
+                for (size_t i = 0; i < rnds.size(); ++i)
+                    states[i] = sampleProbability(model.getS(), b0, rnds[i]);
+
+                POMDP::TransitionBatch batch;
+                POMDP::Belief b1(model.getS());
+                for (unsigned t = 0; t < horizon && ids.size(); ++t) {
+                    size_t j = 0;
+                    for (const auto id : ids) {
+                        if (model.isTerminal(states[id])) {
+                            for (auto tt = t; tt < horizon; ++tt) stats.record(0.0, tt);
+                            continue;
+                        }
+                        ids[j++] = id;
+                    }
+                    ids.resize(j);
+                    if (!j) break;
+
+                    batch.states.resize(j);
+                    batch.actions.resize(j);
+                    batch.nextStates.resize(j);
+                    batch.observations.resize(j);
+                    batch.rewards.resize(j);
+                    for (size_t i = 0; i < j; ++i) {
+                        batch.states[i] = states[ids[i]];
+                        batch.actions[i] = agents[ids[i]](static_cast<const POMDP::Belief &>(beliefs[ids[i]]), horizon - t);
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(modelMutex);
+                        model.sampleSORBatch(&batch);
+                    }
+                    for (size_t i = 0; i < j; ++i) {
+                        const auto id = ids[i];
+                        states[id] = batch.nextStates[i];
+                        stats.record(batch.rewards[i], t);
+
+                        POMDP::updateBelief(model, beliefs[id], batch.actions[i], batch.observations[i], &b1);
+                        std::swap(beliefs[id], b1);
+                    }
+                }
+            });
+        }
+        return Impl::runEpisodes(episodes, horizon, pool, seed, [&](RandomEngine & rnd, Statistics & stats) {
+            auto agent = makeAgent(static_cast<unsigned>(rnd()));
+
+            size_t s = sampleProbability(model.getS(), b0, rnd), o;
+            POMDP::Belief b = b0, b1(model.getS());
+            for (unsigned t = 0; t < horizon; ++t) {
+                if (model.isTerminal(s)) {
+                    for (; t < horizon; ++t) stats.record(0.0, t);
+                    break;
+                }
+                const size_t a = agent(static_cast<const POMDP::Belief &>(b), horizon - t);
+
+                double r;
+                if constexpr (POMDP::is_generative_model_rng_v<M>) {
+                    std::tie(s, o, r) = model.sampleSOR(s, a, rnd);
+                } else {
+                    std::lock_guard<std::mutex> lock(modelMutex);
+                    std::tie(s, o, r) = model.sampleSOR(s, a);
+                }
+                stats.record(r, t);
+
+                POMDP::updateBelief(model, b, a, o, &b1);
+                std::swap(b, b1);
+            }
+        });
+    }
+
+    /**
+     * @brief This function evaluates an agent on a factored MDP over many episodes.
+     *
+     * The model must provide `double sampleSR(const State &, const Action
+     * &, State *) const`, as Factored::MDP::CooperativeModel does. Calls to
+     * it are always serialized.
+     *
+     * @param model The factored MDP to evaluate the agent on.
+     * @param s0 The initial state of each episode.
+     * @param makeAgent A factory taking a seed and returning an agent.
+     * @param episodes The number of episodes to run.
+     * @param horizon The number of timesteps of each episode.
+     * @param pool The ThreadPool to use, or nullptr.
+     * @param seed The seed of the random engines.
+     *
+     * @return The Statistics of the rewards obtained at each timestep.
+     */
+    template <typename M, typename Factory>
+    Statistics evaluateFactoredMDP(const M & model, const Factored::State & s0, Factory && makeAgent, const size_t episodes, const unsigned horizon,
+                                   ThreadPool * pool = nullptr, const unsigned seed = Impl::Seeder::getSeed())
+    {
+        std::mutex modelMutex;
+        return Impl::runEpisodes(episodes, horizon, pool, seed, [&](RandomEngine & rnd, Statistics & stats) {
+            auto agent = makeAgent(static_cast<unsigned>(rnd()));
+
+            Factored::State s = s0, s1 = s0;
+            for (unsigned t = 0; t < horizon; ++t) {
+                const Factored::Action a = agent(static_cast<const Factored::State &>(s), horizon - t);
+
+                double r;
+                {
+                    std::lock_guard<std::mutex> lock(modelMutex);
+                    r = model.sampleSR(s, a, &s1);
+                }
+                stats.record(r, t);
+                std::swap(s, s1);
+            }
+        });
+    }
+}
+
+#endif
@@ -1,10 +1,81 @@
 #ifndef AI_TOOLBOX_STATISTICS_HEADER_FILE
 #define AI_TOOLBOX_STATISTICS_HEADER_FILE
 
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <iosfwd>
 
 namespace AIToolbox {
+    /**
+     * @brief This class estimates the quantiles of a stream of values.
+     *
+     * This class stores values in logarithmically sized buckets, so that
+     * any quantile it returns is within a relative distance of `accuracy`
+     * of the true one, while its memory only grows with the logarithm of
+     * the range of the values recorded (about 1000 buckets for values up
+     * to 1e9 with 1% accuracy).
+     *
+     * Two sketches with the same accuracy can be merged by summing their
+     * buckets, and the result is the same as if all values had been
+     * recorded in a single sketch.
+     */
+    class QuantileSketch {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param accuracy The relative accuracy of the quantiles, in (0, 1).
+             */
+            QuantileSketch(double accuracy = 0.01);
+
+            /**
+             * @brief This function records a new value.
+             *
+             * @param value The value to record.
+             */
+            void record(double value);
+
+            /**
+             * @brief This function adds all values of another sketch to this one.
+             *
+             * @param other The sketch to merge, with the same accuracy as this one.
+             */
+            void merge(const QuantileSketch & other);
+
+            /**
+             * @brief This function returns an estimate of a quantile of the recorded values.
+             *
+             * If no values have been recorded, this function returns NaN.
+             *
+             * @param q The quantile to estimate, in [0, 1].
+             *
+             * @return The estimated quantile.
+             */
+            double getQuantile(double q) const;
+
+            /**
+             * @brief This function returns the number of recorded values.
+             */
+            size_t getCount() const;
+
+            /**
+             * @brief This function returns the relative accuracy of the sketch.
+             */
+            double getAccuracy() const;
+
+        private:
+            int getBucket(double value) const;
+            double getValue(int bucket) const;
+
+            double accuracy_, gamma_, logGamma_;
+            size_t zeros_, count_;
+            // Buckets of the absolute values of positive and negative values.
+            std::map<int, size_t> positives_, negatives_;
+    };
+
     /**
      * @brief This class registers sets of data and computes statistics about it.
      *
@@ -13,13 +84,15 @@ namespace AIToolbox {
      *
      * This can be used for example to easily compute statistics on reward/regret.
      *
-     * This class only performs basic bookkeeping during the recording of the
-     * data, as processing standard deviation requires all datapoints to be
-     * available.
-     *
      * For each timestep, this class only stores a summary of the number of
-     * points recorded there, their sum and the sum of their products. This
-     * class is not going to remember every single datapoint passed to it.
+     * points recorded there, their mean and the sum of their squared
+     * distances from the mean, updated with Welford's algorithm. This class
+     * is not going to remember every single datapoint passed to it.
+     *
+     * Instances can be merged, so that multiple threads or processes can
+     * each record their own data and combine it at the end. Optionally, each
+     * timestep can also keep a QuantileSketch to estimate the quantiles of
+     * its data.
      *
      * This class must know in advance the number of timesteps to consider, in
      * order to pre-allocate the data vector for maximum performance.
@@ -34,8 +107,9 @@ namespace AIToolbox {
              * @brief Basic constructor.
              *
              * @param timesteps The number of timesteps to process.
+             * @param quantileAccuracy The accuracy of the quantile sketches, or 0.0 to disable them.
              */
-            Statistics(size_t timesteps);
+            Statistics(size_t timesteps, double quantileAccuracy = 0.0);
 
             /**
              * @brief This function records a new datapoint for the specified timestep.
@@ -48,6 +122,34 @@ namespace AIToolbox {
              */
             void record(double value, size_t timestep);
 
+            /**
+             * @brief This function records a range of datapoints for consecutive timesteps.
+             *
+             * This is useful to record a whole episode at once, for example
+             * the rewards obtained at each of its timesteps.
+             *
+             * @param begin The beginning of the range of values.
+             * @param end The end of the range of values.
+             * @param timestep The timestep of the first value.
+             */
+            template <typename It, typename = std::enable_if_t<!std::is_arithmetic_v<It>>>
+            void record(It begin, It end, size_t timestep = 0);
+
+            /**
+             * @brief This function adds all datapoints of another Statistics to this one.
+             *
+             * The datapoints are combined with Chan's parallel algorithm, so
+             * the result is the same as if all of them had been recorded
+             * here. If the other Statistics has more timesteps, this one is
+             * extended to match.
+             *
+             * Both instances must either have quantile sketches with the
+             * same accuracy, or neither must have them.
+             *
+             * @param other The Statistics to merge.
+             */
+            void merge(const Statistics & other);
+
             /**
              * @brief This function computes mean and standard deviation for all timesteps.
              *
@@ -55,13 +157,38 @@ namespace AIToolbox {
              */
             Results process() const;
 
+            /**
+             * @brief This function returns an estimate of a quantile of the data of a timestep.
+             *
+             * This function requires the quantile sketches to be enabled.
+             *
+             * @param q The quantile to estimate, in [0, 1].
+             * @param timestep The timestep to consider.
+             *
+             * @return The estimated quantile.
+             */
+            double getQuantile(double q, size_t timestep) const;
+
+            /**
+             * @brief This function returns the number of timesteps.
+             */
+            size_t getTimesteps() const;
+
         private:
-            //                       Count,    sum,    sum squared
-            using Point = std::tuple<unsigned, double, double>;
+            //                       Count,  mean,   sum of squared distances
+            using Point = std::tuple<size_t, double, double>;
 
             std::vector<Point> data_;
+            double quantileAccuracy_;
+            std::vector<QuantileSketch> sketches_;
     };
 
+    template <typename It, typename>
+    void Statistics::record(It begin, It end, size_t timestep) {
+        for ( ; begin != end; ++begin, ++timestep )
+            record(*begin, timestep);
+    }
+
     /**
      * @brief This function writes the output of the Statistics to the stream.
      *
@@ -10,14 +10,34 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 
+#ifdef AI_COUNTER_BASED_RNG
+#include <AIToolbox/Utils/Philox.hpp>
+#endif
+
 namespace AIToolbox {
-    // This should have decent properties.
+    // This should have decent properties. The counter-based engine is
+    // smaller and cheap to fork into independent streams, which helps
+    // making parallel algorithms reproducible. Note that this changes the
+    // ABI of the library, so it must be set equally for the library and
+    // its users.
+#ifdef AI_COUNTER_BASED_RNG
+    using RandomEngine = Philox4x32;
+#else
     using RandomEngine = std::mt19937;
+#endif
 
     using Vector = Eigen::Matrix<double, Eigen::Dynamic, 1>;
 
-    using Matrix2D           = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::AutoAlign>;
-    using SparseMatrix2D     = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+    // These are used by classes which allow selecting the scalar type of
+    // their storage at compile time (for example to store large transition
+    // tables in float to save memory).
+    template <typename T>
+    using BasicMatrix2D       = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::AutoAlign>;
+    template <typename T>
+    using BasicSparseMatrix2D = Eigen::SparseMatrix<T, Eigen::RowMajor>;
+
+    using Matrix2D           = BasicMatrix2D<double>;
+    using SparseMatrix2D     = BasicSparseMatrix2D<double>;
 
     using Matrix3D           = std::vector<Matrix2D>;
     using SparseMatrix3D     = std::vector<SparseMatrix2D>;
@@ -25,6 +45,14 @@ namespace AIToolbox {
     using Matrix4D       = boost::multi_array<Matrix2D,       2>;
     using SparseMatrix4D = boost::multi_array<SparseMatrix2D, 2>;
 
+    // These are the fixed-size counterparts of Vector and Matrix2D, used by
+    // models whose sizes are known at compile time. Eigen does not allow
+    // row-major column vectors, so those fall back to column-major.
+    template <int N>
+    using FixedVector   = Eigen::Matrix<double, N, 1>;
+    template <int R, int C>
+    using FixedMatrix2D = Eigen::Matrix<double, R, C, (C == 1 && R != 1) ? Eigen::ColMajor : Eigen::RowMajor>;
+
     using Table2D = Eigen::Matrix<long, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::AutoAlign>;
     using Table3D = std::vector<Table2D>;
 
@@ -0,0 +1,122 @@
+#ifndef AI_TOOLBOX_UTILS_ASYNC_LOGGER_HEADER_FILE
+#define AI_TOOLBOX_UTILS_ASYNC_LOGGER_HEADER_FILE
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+namespace AIToolbox {
+    /**
+     * @brief This class moves log messages to a background thread.
+     *
+     * The library calls AIToolbox::AILogger synchronously from whichever
+     * thread produces a message. If the actual sink is slow (a file, a
+     * terminal, a network socket), this can stall the algorithms. This class
+     * copies each message in a bounded queue, and a single worker thread
+     * passes them in order to the sink. The sink is thus never called
+     * concurrently, and does not need to be thread-safe.
+     *
+     * Messages are stored in a single contiguous buffer, which is swapped
+     * out as a whole by the worker, so that producers only hold the lock
+     * for the time of a copy.
+     *
+     * If the queue is full, new messages are dropped rather than blocking
+     * the caller. The number of dropped messages can be read with
+     * getDropped().
+     *
+     * Since AILogger is a plain function pointer, you can install this
+     * class with a captureless function forwarding to a global instance:
+     *
+     *     AIToolbox::AsyncLogger logger(mySink);
+     *     AIToolbox::AILogger = [](int s, const char * m){ logger.log(s, m); };
+     *
+     * The instance must outlive any use of AILogger.
+     */
+    class AsyncLogger {
+        public:
+            using Sink = std::function<void(int, const char *)>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This spawns the worker thread.
+             *
+             * @param sink The function that receives the messages.
+             * @param capacity The max number of messages waiting in the queue.
+             */
+            AsyncLogger(Sink sink, size_t capacity = 4096);
+
+            /**
+             * @brief Basic destructor.
+             *
+             * This passes all queued messages to the sink, and joins the
+             * worker.
+             */
+            ~AsyncLogger();
+
+            AsyncLogger(const AsyncLogger &) = delete;
+            AsyncLogger & operator=(const AsyncLogger &) = delete;
+
+            /**
+             * @brief This function queues a message.
+             *
+             * This function is thread-safe, and never blocks on the sink.
+             * If the queue is full the message is dropped.
+             *
+             * @param severity The severity of the message.
+             * @param message The null-terminated message.
+             */
+            void log(int severity, const char * message);
+
+            /**
+             * @brief This function waits until all queued messages have been passed to the sink.
+             */
+            void flush();
+
+            /**
+             * @brief This function returns the number of messages dropped so far.
+             *
+             * @return The number of messages which found the queue full.
+             */
+            size_t getDropped() const;
+
+            /**
+             * @brief This function returns the max number of queued messages.
+             *
+             * @return The capacity of the queue.
+             */
+            size_t getCapacity() const;
+
+        private:
+            struct Batch {
+                std::vector<int> severities;
+                std::vector<size_t> offsets;
+                std::string text;
+
+                void clear();
+            };
+
+            void workerLoop();
+
+            Sink sink_;
+            size_t capacity_;
+
+            std::mutex mutex_;
+            std::condition_variable wakeUp_, done_;
+
+            Batch queue_;
+            // Number of messages taken by the worker and not yet written.
+            size_t writing_;
+            std::atomic<size_t> dropped_;
+            bool stop_;
+
+            std::thread worker_;
+    };
+}
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <AIToolbox/Types.hpp>
 
+#include <cstddef>
+#include <iterator>
+#include <limits>
 #include <utility>
 #include <type_traits>
 
@@ -268,6 +271,235 @@ namespace AIToolbox {
     template<class T, class Container>
     IndexMap(std::initializer_list<T> i, Container c) -> IndexMap<std::vector<T>, Container>;
 
+    namespace Impl {
+        /**
+         * @brief How many items ahead the gather functions prefetch.
+         */
+        constexpr std::ptrdiff_t GatherPrefetchDistance = 8;
+
+        /**
+         * @brief This function hints the processor to load the input address in cache.
+         */
+        inline void prefetch([[maybe_unused]] const void * p) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p);
+#endif
+        }
+    }
+
+    /**
+     * @brief This class is a simple iterator over an IndexSpan.
+     *
+     * This iterator only holds a pointer to the current id and a pointer to
+     * the first item, so dereferencing it costs a single indexed load.
+     *
+     * @tparam T The type of the items, possibly const.
+     */
+    template <typename T>
+    class IndexSpanIterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_const_t<T>;
+            using pointer = T *;
+            using reference = T &;
+            using difference_type = std::ptrdiff_t;
+
+            /**
+             * @brief Basic constructor to respect iterator interface.
+             */
+            IndexSpanIterator() : currentId_(nullptr), items_(nullptr) {}
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param id A pointer to the current id.
+             * @param items A pointer to the first item of the container.
+             */
+            IndexSpanIterator(const size_t * id, T * items) :
+                    currentId_(id), items_(items) {}
+
+            /**
+             * @brief This function returns the equivalent item id of this iterator in its container.
+             */
+            size_t toContainerId() const { return *currentId_; }
+
+            reference operator*() const { return items_[*currentId_]; }
+            pointer operator->() const { return items_ + *currentId_; }
+            reference operator[](difference_type diff) const { return items_[currentId_[diff]]; }
+
+            bool operator==(IndexSpanIterator other) const { return currentId_ == other.currentId_; }
+            bool operator!=(IndexSpanIterator other) const { return currentId_ != other.currentId_; }
+            bool operator<(IndexSpanIterator other) const  { return currentId_ < other.currentId_; }
+            bool operator>(IndexSpanIterator other) const  { return currentId_ > other.currentId_; }
+            bool operator<=(IndexSpanIterator other) const { return currentId_ <= other.currentId_; }
+            bool operator>=(IndexSpanIterator other) const { return currentId_ >= other.currentId_; }
+
+            IndexSpanIterator & operator++() { ++currentId_; return *this; }
+            IndexSpanIterator operator++(int) { auto tmp = *this; ++currentId_; return tmp; }
+            IndexSpanIterator & operator--() { --currentId_; return *this; }
+            IndexSpanIterator operator--(int) { auto tmp = *this; --currentId_; return tmp; }
+
+            IndexSpanIterator & operator+=(difference_type diff) { currentId_ += diff; return *this; }
+            IndexSpanIterator & operator-=(difference_type diff) { currentId_ -= diff; return *this; }
+            IndexSpanIterator operator+(difference_type diff) const { return IndexSpanIterator(currentId_ + diff, items_); }
+            IndexSpanIterator operator-(difference_type diff) const { return IndexSpanIterator(currentId_ - diff, items_); }
+            difference_type operator-(IndexSpanIterator other) const { return currentId_ - other.currentId_; }
+
+        private:
+            const size_t * currentId_;
+            T * items_;
+    };
+
+    /**
+     * @brief This class is a non-owning iterable over a contiguous range of ids on a given container.
+     *
+     * This class is a lighter alternative to IndexMap for when the ids are
+     * stored contiguously in memory (for example in an std::vector used as
+     * a buffer). It only stores two pointers to the ids and one to the
+     * items, and its iterators are plain pointers to the ids, so iterating
+     * over it does not go through the interface of any container.
+     *
+     * The ids are assumed to be already valid for the input container: no
+     * bound checking is ever performed. Ids produced by a Trie for its own
+     * FactoredContainer are valid by construction.
+     *
+     * The items container must store its items contiguously (i.e. it must
+     * provide a data() method), and it must not be resized while this class
+     * or its iterators are in use. The ids must outlive this class and must
+     * not change while it is in use.
+     *
+     * @tparam Container The type of the container to be iterated on, possibly const.
+     */
+    template <typename Container>
+    class IndexSpan {
+        public:
+            using value_type     = typename Container::value_type;
+            using Item           = std::conditional_t<std::is_const_v<Container>, const value_type, value_type>;
+
+            using iterator       = IndexSpanIterator<Item>;
+            using const_iterator = IndexSpanIterator<const value_type>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param ids A pointer to the first id.
+             * @param size The number of ids.
+             * @param items The items container.
+             */
+            IndexSpan(const size_t * ids, size_t size, Container & items) :
+                    begin_(ids), end_(ids + size), items_(items.data()) {}
+
+            /**
+             * @brief Constructor from an id vector.
+             *
+             * @param ids The ids to iterate over.
+             * @param items The items container.
+             */
+            IndexSpan(const std::vector<size_t> & ids, Container & items) :
+                    IndexSpan(ids.data(), ids.size(), items) {}
+
+            /**
+             * @brief This function returns an iterator to the beginning of this filtered range.
+             */
+            iterator begin() const { return iterator(begin_, items_); }
+
+            /**
+             * @brief This function returns a const_iterator to the beginning of this filtered range.
+             */
+            const_iterator cbegin() const { return const_iterator(begin_, items_); }
+
+            /**
+             * @brief This function returns an iterator to the end of this filtered range.
+             */
+            iterator end() const { return iterator(end_, items_); }
+
+            /**
+             * @brief This function returns a const_iterator to the end of this filtered range.
+             */
+            const_iterator cend() const { return const_iterator(end_, items_); }
+
+            /**
+             * @brief This function returns the size of the range covered.
+             */
+            size_t size() const { return end_ - begin_; }
+
+            /**
+             * @brief This function returns whether the range is empty.
+             */
+            bool empty() const { return begin_ == end_; }
+
+            /**
+             * @brief This function returns the item at the input position of the range.
+             */
+            Item & operator[](size_t i) const { return items_[begin_[i]]; }
+
+            /**
+             * @brief This function returns a pointer to the ids of the range.
+             */
+            const size_t * ids() const { return begin_; }
+
+            /**
+             * @brief This function returns a pointer to the first item of the underlying container.
+             */
+            Item * items() const { return items_; }
+
+        private:
+            const size_t * begin_;
+            const size_t * end_;
+            Item * items_;
+    };
+
+    /**
+     * @brief This function copies the items of an IndexSpan into contiguous storage.
+     *
+     * The items are written in the same order of the ids. While copying,
+     * the items a few positions ahead are prefetched, so that the random
+     * accesses into the container overlap with the copies.
+     *
+     * Gathering is convenient when the same filtered items must be read
+     * multiple times, as the following passes run over contiguous memory.
+     *
+     * @param span The range to gather.
+     * @param out The beginning of the output range, which must be at least span.size() long.
+     *
+     * @return The end of the output range.
+     */
+    template <typename Container, typename OutputIt>
+    OutputIt gather(const IndexSpan<Container> & span, OutputIt out) {
+        return gather(span, out, [](const auto & item) -> const auto & { return item; });
+    }
+
+    /**
+     * @brief This function writes a projection of the items of an IndexSpan into contiguous storage.
+     *
+     * This function is equivalent to gather(const IndexSpan<Container>&, OutputIt),
+     * but it writes f(item) rather than the items themselves. This allows
+     * to extract only the fields that are needed from large items.
+     *
+     * @param span The range to gather.
+     * @param out The beginning of the output range, which must be at least span.size() long.
+     * @param f The projection to apply to each item.
+     *
+     * @return The end of the output range.
+     */
+    template <typename Container, typename OutputIt, typename F>
+    OutputIt gather(const IndexSpan<Container> & span, OutputIt out, F f) {
+        const auto ids = span.ids();
+        const auto items = span.items();
+        const auto N = static_cast<std::ptrdiff_t>(span.size());
+        const auto ahead = N - Impl::GatherPrefetchDistance;
+
+        std::ptrdiff_t i = 0;
+        for (; i < ahead; ++i, ++out) {
+            Impl::prefetch(items + ids[i + Impl::GatherPrefetchDistance]);
+            *out = f(items[ids[i]]);
+        }
+        for (; i < N; ++i, ++out)
+            *out = f(items[ids[i]]);
+
+        return out;
+    }
+
     /**
      * @brief This class is a simple iterator to iterate over a container without the specified ids.
      */
@@ -289,6 +521,10 @@ namespace AIToolbox {
             IndexSkipMapIterator(size_type start, const IdsContainer & ids, Container & items) :
                     currentId_(start), currentSkipId_(0), ids_(ids), items_(items)
             {
+                // Ids before the start can never be skipped.
+                while (currentSkipId_ < ids_.size() && ids_[currentSkipId_] < start)
+                    ++currentSkipId_;
+                updateNextSkip();
                 // Skip initial unwanted elements
                 skip();
             }
@@ -318,17 +554,26 @@ namespace AIToolbox {
             bool operator!=(const IndexSkipMapIterator & other) const { return !(*this == other); }
 
         private:
+            // Here we only need to compare against the next id to skip,
+            // which is cached and is never out of the bounds of the
+            // container (otherwise it is set to a value that can never
+            // match).
             void skip() {
-                while (currentId_ < items_.size() &&
-                       currentSkipId_ < ids_.size() &&
-                       currentId_ == ids_[currentSkipId_])
-                {
+                while (currentId_ == nextSkip_) {
                     ++currentId_;
                     ++currentSkipId_;
+                    updateNextSkip();
                 }
             }
 
-            size_type currentId_;
+            void updateNextSkip() {
+                if (currentSkipId_ < ids_.size() && ids_[currentSkipId_] < items_.size())
+                    nextSkip_ = ids_[currentSkipId_];
+                else
+                    nextSkip_ = std::numeric_limits<size_type>::max();
+            }
+
+            size_type currentId_, nextSkip_;
             typename IdsContainer::size_type currentSkipId_;
             const IdsContainer & ids_;
             Container & items_;
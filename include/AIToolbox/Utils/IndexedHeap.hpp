@@ -0,0 +1,351 @@
+#ifndef AI_TOOLBOX_UTILS_INDEXED_HEAP_HEADER_FILE
+#define AI_TOOLBOX_UTILS_INDEXED_HEAP_HEADER_FILE
+
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/heap/fibonacci_heap.hpp>
+
+namespace AIToolbox {
+    /**
+     * @brief This class is a max-priority queue over a fixed range of keys, implemented as a d-ary heap.
+     *
+     * Each key in [0, N) can be in the queue at most once, and its position
+     * in the heap is tracked in a flat array. This allows checking whether
+     * a key is contained, reading its priority and increasing it in O(1)
+     * plus the sift cost, without any hashing or per-node allocation.
+     *
+     * All elements are kept in a single contiguous array, which makes this
+     * class much more cache friendly than node-based heaps. A higher arity
+     * makes the heap shallower, which speeds up increases at the cost of
+     * slightly more comparisons per pop.
+     *
+     * @tparam D The arity of the heap.
+     */
+    template <size_t D = 4>
+    class IndexedDaryHeap {
+        static_assert(D >= 2, "A heap must have an arity of at least 2!");
+
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param N The number of keys that can be stored in the queue.
+             */
+            IndexedDaryHeap(size_t N);
+
+            /**
+             * @brief This function adds a key to the queue.
+             *
+             * The key must not be already in the queue.
+             *
+             * @param key The key to add.
+             * @param priority The priority of the key.
+             */
+            void push(size_t key, double priority);
+
+            /**
+             * @brief This function increases the priority of a key already in the queue.
+             *
+             * The new priority must be greater or equal to the old one.
+             *
+             * @param key The key to update.
+             * @param priority The new priority of the key.
+             */
+            void increase(size_t key, double priority);
+
+            /**
+             * @brief This function removes the key with the highest priority from the queue.
+             *
+             * The queue must not be empty.
+             */
+            void pop();
+
+            /**
+             * @brief This function removes all keys from the queue.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the key with the highest priority.
+             *
+             * The queue must not be empty.
+             *
+             * @return The key with the highest priority.
+             */
+            size_t top() const;
+
+            /**
+             * @brief This function returns whether a key is in the queue.
+             *
+             * @param key The key to check.
+             *
+             * @return True if the key is in the queue, false otherwise.
+             */
+            bool contains(size_t key) const;
+
+            /**
+             * @brief This function returns the priority of a key in the queue.
+             *
+             * The key must be in the queue.
+             *
+             * @param key The key to check.
+             *
+             * @return The priority of the key.
+             */
+            double getPriority(size_t key) const;
+
+            /**
+             * @brief This function returns the number of keys in the queue.
+             *
+             * @return The number of keys in the queue.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns whether the queue is empty.
+             *
+             * @return True if the queue is empty, false otherwise.
+             */
+            bool empty() const;
+
+        private:
+            static constexpr size_t NotInHeap = std::numeric_limits<size_t>::max();
+
+            void siftUp(size_t i);
+            void siftDown(size_t i);
+
+            // Pairs of (priority, key).
+            std::vector<std::pair<double, size_t>> heap_;
+            std::vector<size_t> positions_;
+    };
+
+    /**
+     * @brief This class is a max-priority queue over a fixed range of keys, implemented as a Fibonacci heap.
+     *
+     * This class has the same interface as IndexedDaryHeap, but wraps a
+     * boost::heap::fibonacci_heap. The handles of the keys are tracked in
+     * a flat array, so that no hashing is needed.
+     *
+     * Fibonacci heaps have better asymptotic complexity for increases,
+     * but allocate each node separately.
+     */
+    class IndexedFibonacciHeap {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param N The number of keys that can be stored in the queue.
+             */
+            IndexedFibonacciHeap(size_t N);
+
+            /**
+             * @brief This function adds a key to the queue.
+             *
+             * The key must not be already in the queue.
+             *
+             * @param key The key to add.
+             * @param priority The priority of the key.
+             */
+            void push(size_t key, double priority);
+
+            /**
+             * @brief This function increases the priority of a key already in the queue.
+             *
+             * The new priority must be greater or equal to the old one.
+             *
+             * @param key The key to update.
+             * @param priority The new priority of the key.
+             */
+            void increase(size_t key, double priority);
+
+            /**
+             * @brief This function removes the key with the highest priority from the queue.
+             *
+             * The queue must not be empty.
+             */
+            void pop();
+
+            /**
+             * @brief This function removes all keys from the queue.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the key with the highest priority.
+             *
+             * The queue must not be empty.
+             *
+             * @return The key with the highest priority.
+             */
+            size_t top() const;
+
+            /**
+             * @brief This function returns whether a key is in the queue.
+             *
+             * @param key The key to check.
+             *
+             * @return True if the key is in the queue, false otherwise.
+             */
+            bool contains(size_t key) const;
+
+            /**
+             * @brief This function returns the priority of a key in the queue.
+             *
+             * The key must be in the queue.
+             *
+             * @param key The key to check.
+             *
+             * @return The priority of the key.
+             */
+            double getPriority(size_t key) const;
+
+            /**
+             * @brief This function returns the number of keys in the queue.
+             *
+             * @return The number of keys in the queue.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns whether the queue is empty.
+             *
+             * @return True if the queue is empty, false otherwise.
+             */
+            bool empty() const;
+
+        private:
+            // Pairs of (priority, key).
+            using Element = std::pair<double, size_t>;
+
+            struct ElementLess {
+                bool operator()(const Element & lhs, const Element & rhs) const { return lhs.first < rhs.first; }
+            };
+
+            using QueueType = boost::heap::fibonacci_heap<Element, boost::heap::compare<ElementLess>>;
+
+            QueueType queue_;
+            std::vector<typename QueueType::handle_type> handles_;
+            std::vector<bool> contained_;
+    };
+
+    template <size_t D>
+    IndexedDaryHeap<D>::IndexedDaryHeap(const size_t N) : positions_(N, NotInHeap) {}
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::push(const size_t key, const double priority) {
+        heap_.emplace_back(priority, key);
+        siftUp(heap_.size() - 1);
+    }
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::increase(const size_t key, const double priority) {
+        const auto i = positions_[key];
+        heap_[i].first = priority;
+        siftUp(i);
+    }
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::pop() {
+        positions_[heap_[0].second] = NotInHeap;
+        if (heap_.size() == 1) {
+            heap_.pop_back();
+            return;
+        }
+        heap_[0] = heap_.back();
+        heap_.pop_back();
+        siftDown(0);
+    }
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::clear() {
+        for (const auto & e : heap_)
+            positions_[e.second] = NotInHeap;
+        heap_.clear();
+    }
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::siftUp(size_t i) {
+        const auto e = heap_[i];
+        while (i > 0) {
+            const auto parent = (i - 1) / D;
+            if (heap_[parent].first >= e.first) break;
+            heap_[i] = heap_[parent];
+            positions_[heap_[i].second] = i;
+            i = parent;
+        }
+        heap_[i] = e;
+        positions_[e.second] = i;
+    }
+
+    template <size_t D>
+    void IndexedDaryHeap<D>::siftDown(size_t i) {
+        const auto e = heap_[i];
+        const auto N = heap_.size();
+        while (true) {
+            const auto first = i * D + 1;
+            if (first >= N) break;
+
+            const auto last = std::min(first + D, N);
+            auto best = first;
+            for (auto c = first + 1; c < last; ++c)
+                if (heap_[c].first > heap_[best].first)
+                    best = c;
+
+            if (heap_[best].first <= e.first) break;
+            heap_[i] = heap_[best];
+            positions_[heap_[i].second] = i;
+            i = best;
+        }
+        heap_[i] = e;
+        positions_[e.second] = i;
+    }
+
+    template <size_t D>
+    size_t IndexedDaryHeap<D>::top() const { return heap_[0].second; }
+
+    template <size_t D>
+    bool IndexedDaryHeap<D>::contains(const size_t key) const { return positions_[key] != NotInHeap; }
+
+    template <size_t D>
+    double IndexedDaryHeap<D>::getPriority(const size_t key) const { return heap_[positions_[key]].first; }
+
+    template <size_t D>
+    size_t IndexedDaryHeap<D>::size() const { return heap_.size(); }
+
+    template <size_t D>
+    bool IndexedDaryHeap<D>::empty() const { return heap_.empty(); }
+
+    inline IndexedFibonacciHeap::IndexedFibonacciHeap(const size_t N) : handles_(N), contained_(N, false) {}
+
+    inline void IndexedFibonacciHeap::push(const size_t key, const double priority) {
+        handles_[key] = queue_.push(std::make_pair(priority, key));
+        contained_[key] = true;
+    }
+
+    inline void IndexedFibonacciHeap::increase(const size_t key, const double priority) {
+        queue_.increase(handles_[key], std::make_pair(priority, key));
+    }
+
+    inline void IndexedFibonacciHeap::pop() {
+        contained_[queue_.top().second] = false;
+        queue_.pop();
+    }
+
+    inline void IndexedFibonacciHeap::clear() {
+        for (const auto & e : queue_)
+            contained_[e.second] = false;
+        queue_.clear();
+    }
+
+    inline size_t IndexedFibonacciHeap::top() const { return queue_.top().second; }
+    inline bool IndexedFibonacciHeap::contains(const size_t key) const { return contained_[key]; }
+    inline double IndexedFibonacciHeap::getPriority(const size_t key) const { return (*handles_[key]).first; }
+    inline size_t IndexedFibonacciHeap::size() const { return queue_.size(); }
+    inline bool IndexedFibonacciHeap::empty() const { return queue_.empty(); }
+}
+
+#endif
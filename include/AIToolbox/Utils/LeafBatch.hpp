@@ -0,0 +1,172 @@
+#ifndef AI_TOOLBOX_UTILS_LEAF_BATCH_HEADER_FILE
+#define AI_TOOLBOX_UTILS_LEAF_BATCH_HEADER_FILE
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This type represents a function that evaluates a batch of leaf states.
+     *
+     * The function receives the states to evaluate, and for each of them
+     * the number of timesteps left until the end of the search horizon. It
+     * must write into the values vector, which has already been resized to
+     * the number of states, an estimate of the discounted return obtainable
+     * from each state within its remaining horizon.
+     *
+     * The function is always called from the thread performing the search;
+     * it is free to split the work between multiple threads internally.
+     */
+    using BatchEvaluator = std::function<void(const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values)>;
+
+    /**
+     * @brief This class queues tree simulations waiting for the evaluation of their leaves.
+     *
+     * Online planners can delegate the evaluation of new leaves to a
+     * BatchEvaluator, rather than performing a rollout for each of them.
+     * To amortize the overhead of each evaluation, simulations stop at
+     * their leaf and are queued here, together with the path they followed
+     * in the tree. Once enough simulations are queued, the leaves are
+     * evaluated all at once and the values are backed up along each path.
+     *
+     * While in the queue, each simulation counts as a visit of the action
+     * nodes on its path, without affecting their values. This discourages
+     * queued simulations from all following the same path. The visits are
+     * replaced by the actual updates once the values are known, so that
+     * the final action values are the same averages computed without
+     * batching.
+     *
+     * @tparam Tree The SearchTree type holding the action nodes.
+     */
+    template <typename Tree>
+    class LeafBatch {
+        public:
+            using NodeId = typename Tree::NodeId;
+
+            /**
+             * @brief This function adds an action taken by the current simulation.
+             *
+             * The visit count of the action node is incremented.
+             *
+             * @param tree The tree where the simulation is performed.
+             * @param node The node where the action was taken.
+             * @param a The action taken.
+             * @param rew The reward obtained.
+             */
+            void push(Tree & tree, NodeId node, size_t a, double rew);
+
+            /**
+             * @brief This function ends the current simulation, without a leaf to evaluate.
+             *
+             * This is used when the simulation reached a terminal state or
+             * the end of the horizon.
+             */
+            void finish();
+
+            /**
+             * @brief This function ends the current simulation with a leaf to evaluate.
+             *
+             * @param s The state of the leaf.
+             * @param horizon The number of timesteps left from the leaf.
+             */
+            void finish(size_t s, unsigned horizon);
+
+            /**
+             * @brief This function evaluates all queued leaves and backs up their values.
+             *
+             * The evaluator is only called if at least one queued
+             * simulation has a leaf to evaluate. The queue is empty
+             * afterwards.
+             *
+             * @param tree The tree where the simulations were performed.
+             * @param eval The evaluator for the leaves.
+             * @param discount The discount of the problem.
+             */
+            void flush(Tree & tree, const BatchEvaluator & eval, double discount);
+
+            /**
+             * @brief This function returns the number of queued simulations.
+             *
+             * @return The number of queued simulations.
+             */
+            size_t size() const;
+
+        private:
+            struct Step {
+                NodeId node;
+                size_t a;
+                double rew;
+            };
+
+            // Index of the leaf value of each simulation, or NoLeaf.
+            static constexpr size_t NoLeaf = static_cast<size_t>(-1);
+
+            std::vector<Step> steps_;
+            std::vector<size_t> ends_, leaves_;
+
+            std::vector<size_t> states_;
+            std::vector<unsigned> horizons_;
+            std::vector<double> values_;
+    };
+
+    template <typename Tree>
+    void LeafBatch<Tree>::push(Tree & tree, const NodeId node, const size_t a, const double rew) {
+        ++tree.getCounts(node)[a];
+        steps_.push_back({node, a, rew});
+    }
+
+    template <typename Tree>
+    void LeafBatch<Tree>::finish() {
+        ends_.push_back(steps_.size());
+        leaves_.push_back(NoLeaf);
+    }
+
+    template <typename Tree>
+    void LeafBatch<Tree>::finish(const size_t s, const unsigned horizon) {
+        ends_.push_back(steps_.size());
+        leaves_.push_back(states_.size());
+        states_.push_back(s);
+        horizons_.push_back(horizon);
+    }
+
+    template <typename Tree>
+    void LeafBatch<Tree>::flush(Tree & tree, const BatchEvaluator & eval, const double discount) {
+        if ( states_.size() ) {
+            values_.resize(states_.size());
+            eval(states_, horizons_, values_);
+        }
+
+        // First we remove all the visits we added while queueing, and then
+        // we add them back one by one as we update the values: this way
+        // each update is weighted as if it happened without batching.
+        for ( const auto & step : steps_ )
+            --tree.getCounts(step.node)[step.a];
+
+        size_t begin = 0;
+        for ( size_t i = 0; i < ends_.size(); ++i ) {
+            double futureRew = leaves_[i] == NoLeaf ? 0.0 : values_[leaves_[i]];
+            for ( auto j = ends_[i]; j > begin; --j ) {
+                const auto & step = steps_[j - 1];
+                const double rew = step.rew + discount * futureRew;
+
+                tree.update(step.node, step.a, rew);
+                futureRew = rew;
+            }
+            begin = ends_[i];
+        }
+
+        steps_.clear();
+        ends_.clear();
+        leaves_.clear();
+        states_.clear();
+        horizons_.clear();
+    }
+
+    template <typename Tree>
+    size_t LeafBatch<Tree>::size() const {
+        return ends_.size();
+    }
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef AI_TOOLBOX_UTILS_MEMORY_USAGE_HEADER_FILE
+#define AI_TOOLBOX_UTILS_MEMORY_USAGE_HEADER_FILE
+
+#include <cstddef>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/multi_array.hpp>
+
+#include <AIToolbox/Types.hpp>
+
+/**
+ * \file
+ *
+ * These functions compute the heap memory owned by the containers used to
+ * store the data of models, experiences and value functions. They are the
+ * building blocks of the getMemoryUsage() functions of those classes.
+ *
+ * Memory is counted as allocated, so the spare capacity of vectors and of
+ * sparse matrices is included. The size of the object itself is not, so
+ * that the usage of members can simply be summed. The memory of the nodes
+ * of std::unordered_map is estimated, as it depends on the standard
+ * library; the estimate follows the layout of libstdc++ and libc++.
+ */
+
+namespace AIToolbox {
+    /**
+     * @brief This struct checks whether a class can report its own memory usage.
+     *
+     * has_memory_usage<T>::value is true if T has a member function
+     * `size_t getMemoryUsage() const`, and false otherwise.
+     *
+     * @tparam T The class to test.
+     */
+    template <typename T>
+    struct has_memory_usage {
+        private:
+            template <typename Z> static constexpr auto test(int) -> decltype(
+                    static_cast<size_t (Z::*)() const>(&Z::getMemoryUsage),
+                    bool()
+            ) { return true; }
+
+            template <typename Z> static constexpr auto test(...) -> bool
+            { return false; }
+
+        public:
+            enum { value = test<T>(0) };
+    };
+    template <typename T>
+    inline constexpr bool has_memory_usage_v = has_memory_usage<T>::value;
+
+    template <typename T>
+    size_t heapUsage(const T &);
+
+    template <typename Scalar, int R, int C, int O, int MR, int MC>
+    size_t heapUsage(const Eigen::Matrix<Scalar, R, C, O, MR, MC> & m);
+
+    template <typename Scalar, int O, typename Index>
+    size_t heapUsage(const Eigen::SparseMatrix<Scalar, O, Index> & m);
+
+    template <typename T, typename Alloc>
+    size_t heapUsage(const std::vector<T, Alloc> & v);
+
+    template <typename T, size_t N, typename Alloc>
+    size_t heapUsage(const boost::multi_array<T, N, Alloc> & m);
+
+    template <typename K, typename V, typename H, typename E, typename Alloc>
+    size_t heapUsage(const std::unordered_map<K, V, H, E, Alloc> & m);
+
+    template <typename A, typename B>
+    size_t heapUsage(const std::pair<A, B> & p);
+
+    /**
+     * @brief This function returns the heap memory owned by the input object.
+     *
+     * This is the fallback for types which own no heap memory, or whose
+     * memory cannot be inspected; it returns zero. Classes which provide a
+     * getMemoryUsage() member function are measured with it.
+     *
+     * @param t The object to measure.
+     *
+     * @return The bytes allocated by the object.
+     */
+    template <typename T>
+    size_t heapUsage([[maybe_unused]] const T & t) {
+        if constexpr (has_memory_usage_v<T>)
+            return t.getMemoryUsage();
+        else
+            return 0;
+    }
+
+    /**
+     * @brief This function returns the heap memory owned by the input dense Eigen matrix.
+     *
+     * @param m The matrix to measure.
+     *
+     * @return The bytes allocated by the matrix (zero for fixed-size matrices).
+     */
+    template <typename Scalar, int R, int C, int O, int MR, int MC>
+    size_t heapUsage(const Eigen::Matrix<Scalar, R, C, O, MR, MC> & m) {
+        if constexpr (R != Eigen::Dynamic && C != Eigen::Dynamic)
+            return 0;
+        else
+            return m.size() * sizeof(Scalar);
+    }
+
+    /**
+     * @brief This function returns the heap memory owned by the input sparse Eigen matrix.
+     *
+     * This counts the reserved space for the non-zero values and their
+     * indices, the outer index, and the inner sizes of uncompressed
+     * matrices.
+     *
+     * @param m The matrix to measure.
+     *
+     * @return The bytes allocated by the matrix.
+     */
+    template <typename Scalar, int O, typename Index>
+    size_t heapUsage(const Eigen::SparseMatrix<Scalar, O, Index> & m) {
+        size_t retval = m.data().allocatedSize() * (sizeof(Scalar) + sizeof(Index));
+        if (m.outerIndexPtr()) retval += (m.outerSize() + 1) * sizeof(Index);
+        if (m.innerNonZeroPtr()) retval += m.outerSize() * sizeof(Index);
+        return retval;
+    }
+
+    /**
+     * @brief This function returns the heap memory owned by the input vector and its elements.
+     *
+     * @param v The vector to measure.
+     *
+     * @return The bytes allocated by the vector and its elements.
+     */
+    template <typename T, typename Alloc>
+    size_t heapUsage(const std::vector<T, Alloc> & v) {
+        size_t retval = v.capacity() * sizeof(T);
+        if constexpr (!std::is_arithmetic_v<T>)
+            for (const auto & t : v)
+                retval += heapUsage(t);
+        return retval;
+    }
+
+    /**
+     * @brief This function returns the heap memory owned by the input boost::multi_array and its elements.
+     *
+     * @param m The array to measure.
+     *
+     * @return The bytes allocated by the array and its elements.
+     */
+    template <typename T, size_t N, typename Alloc>
+    size_t heapUsage(const boost::multi_array<T, N, Alloc> & m) {
+        size_t retval = m.num_elements() * sizeof(T);
+        if constexpr (!std::is_arithmetic_v<T>)
+            for (auto it = m.data(); it != m.data() + m.num_elements(); ++it)
+                retval += heapUsage(*it);
+        return retval;
+    }
+
+    /**
+     * @brief This function estimates the heap memory owned by the input unordered_map and its elements.
+     *
+     * Each node is assumed to store the element, its cached hash and a
+     * pointer to the next node; the bucket array stores one pointer per
+     * bucket.
+     *
+     * @param m The map to measure.
+     *
+     * @return The estimated bytes allocated by the map and its elements.
+     */
+    template <typename K, typename V, typename H, typename E, typename Alloc>
+    size_t heapUsage(const std::unordered_map<K, V, H, E, Alloc> & m) {
+        size_t retval = m.size() * (sizeof(std::pair<const K, V>) + sizeof(void*) + sizeof(size_t));
+        retval += m.bucket_count() * sizeof(void*);
+        if constexpr (!std::is_arithmetic_v<K> || !std::is_arithmetic_v<V>)
+            for (const auto & kv : m)
+                retval += heapUsage(kv.first) + heapUsage(kv.second);
+        return retval;
+    }
+
+    /**
+     * @brief This function returns the heap memory owned by the elements of the input pair.
+     *
+     * @param p The pair to measure.
+     *
+     * @return The bytes allocated by the elements of the pair.
+     */
+    template <typename A, typename B>
+    size_t heapUsage(const std::pair<A, B> & p) {
+        return heapUsage(p.first) + heapUsage(p.second);
+    }
+}
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef AI_TOOLBOX_UTILS_METRICS_HEADER_FILE
+#define AI_TOOLBOX_UTILS_METRICS_HEADER_FILE
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This class is a monotonic counter.
+     *
+     * All operations are thread-safe and lock-free.
+     */
+    class MetricCounter {
+        public:
+            MetricCounter() : value_(0) {}
+
+            /**
+             * @brief This function increments the counter.
+             *
+             * @param n The amount to add.
+             */
+            void add(std::uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+            /**
+             * @brief This function returns the current value of the counter.
+             */
+            std::uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function sets the counter back to zero.
+             */
+            void reset() { value_.store(0, std::memory_order_relaxed); }
+
+        private:
+            std::atomic<std::uint64_t> value_;
+    };
+
+    /**
+     * @brief This class accumulates the time spent in a section of code.
+     *
+     * All operations are thread-safe and lock-free.
+     */
+    class MetricTimer {
+        public:
+            MetricTimer() : calls_(0), total_(0) {}
+
+            /**
+             * @brief This function adds a duration to the total.
+             *
+             * @param elapsed The time to add.
+             * @param calls The number of calls the time refers to.
+             */
+            void add(std::chrono::nanoseconds elapsed, std::uint64_t calls = 1) {
+                calls_.fetch_add(calls, std::memory_order_relaxed);
+                total_.fetch_add(elapsed.count(), std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief This function returns the number of timed calls.
+             */
+            std::uint64_t getCalls() const { return calls_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function returns the total time of all calls.
+             */
+            std::chrono::nanoseconds getTotal() const { return std::chrono::nanoseconds(total_.load(std::memory_order_relaxed)); }
+
+            /**
+             * @brief This function sets the timer back to zero.
+             */
+            void reset() {
+                calls_.store(0, std::memory_order_relaxed);
+                total_.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::uint64_t> calls_;
+            std::atomic<std::int64_t> total_;
+    };
+
+    /**
+     * @brief This class is a histogram with power of two buckets.
+     *
+     * Bucket 0 counts the zeroes, and bucket i > 0 counts the values in
+     * [2^(i-1), 2^i). In this way the histogram has a fixed size, and
+     * recording a value needs no search.
+     *
+     * All operations are thread-safe and lock-free.
+     */
+    class MetricHistogram {
+        public:
+            /// The number of buckets, enough for any 64 bit value.
+            static constexpr size_t Buckets = 65;
+
+            MetricHistogram();
+
+            /**
+             * @brief This function records a value.
+             *
+             * @param value The value to record.
+             */
+            void record(std::uint64_t value);
+
+            /**
+             * @brief This function returns the number of recorded values in a bucket.
+             *
+             * @param i The bucket to read.
+             */
+            std::uint64_t getBucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function returns the number of recorded values.
+             */
+            std::uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function returns the sum of all recorded values.
+             */
+            std::uint64_t getSum() const { return sum_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function returns the largest recorded value.
+             */
+            std::uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief This function clears the histogram.
+             */
+            void reset();
+
+        private:
+            std::array<std::atomic<std::uint64_t>, Buckets> buckets_;
+            std::atomic<std::uint64_t> count_, sum_, max_;
+    };
+
+    /**
+     * @brief This struct contains a copy of all metrics at a point in time.
+     *
+     * All lists are sorted by name.
+     */
+    struct MetricsSnapshot {
+        struct Counter {
+            std::string name;
+            std::uint64_t value;
+        };
+        struct Timer {
+            std::string name;
+            std::uint64_t calls;
+            std::chrono::nanoseconds total;
+        };
+        struct Histogram {
+            std::string name;
+            std::uint64_t count, sum, max;
+            /// The buckets of the histogram, without the trailing empty ones.
+            std::vector<std::uint64_t> buckets;
+        };
+
+        std::vector<Counter> counters;
+        std::vector<Timer> timers;
+        std::vector<Histogram> histograms;
+
+        /**
+         * @brief This function returns the snapshot as a JSON object.
+         *
+         * The object has three members, "counters", "timers" and
+         * "histograms", each mapping the names of the metrics to their
+         * values. Times are in nanoseconds.
+         *
+         * @return A string containing the JSON object.
+         */
+        std::string toJSON() const;
+    };
+
+    /**
+     * @brief This class is the central registry of all metrics of the library.
+     *
+     * Metrics are created the first time their name is requested, and
+     * are never destroyed, so that references to them can be cached and
+     * remain valid for the whole program. Looking up a name takes a lock,
+     * so hot code should only do it once; the AI_METRIC macros in
+     * \ref Profiling do this automatically.
+     *
+     * Names are free-form, but the library uses the qualified name of the
+     * class and the section measured, as in "MDP::ValueIteration::sweep".
+     */
+    class MetricsRegistry {
+        public:
+            /**
+             * @brief This function returns the global registry.
+             */
+            static MetricsRegistry & instance();
+
+            /**
+             * @brief This function returns the counter with the input name, creating it if needed.
+             */
+            MetricCounter & counter(const std::string & name);
+
+            /**
+             * @brief This function returns the timer with the input name, creating it if needed.
+             */
+            MetricTimer & timer(const std::string & name);
+
+            /**
+             * @brief This function returns the histogram with the input name, creating it if needed.
+             */
+            MetricHistogram & histogram(const std::string & name);
+
+            /**
+             * @brief This function copies the current value of all metrics.
+             *
+             * Metrics updated concurrently with this call may be read
+             * partially updated.
+             *
+             * @return A snapshot of all metrics.
+             */
+            MetricsSnapshot snapshot() const;
+
+            /**
+             * @brief This function sets all metrics back to zero.
+             *
+             * Metrics are not removed, so cached references stay valid.
+             */
+            void reset();
+
+        private:
+            MetricsRegistry() = default;
+
+            mutable std::mutex mutex_;
+            std::map<std::string, std::unique_ptr<MetricCounter>> counters_;
+            std::map<std::string, std::unique_ptr<MetricTimer>> timers_;
+            std::map<std::string, std::unique_ptr<MetricHistogram>> histograms_;
+    };
+}
+
+#endif
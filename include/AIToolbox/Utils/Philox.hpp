@@ -0,0 +1,228 @@
+#ifndef AI_TOOLBOX_UTILS_PHILOX_HEADER_FILE
+#define AI_TOOLBOX_UTILS_PHILOX_HEADER_FILE
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+namespace AIToolbox {
+    /**
+     * @brief This class implements the Philox4x32-10 counter-based random engine.
+     *
+     * Counter-based engines compute each random number as a keyed hash of
+     * its position in the sequence, rather than by advancing a large
+     * internal state. This has a few advantages over std::mt19937:
+     *
+     * - The state is small (48 bytes rather than 5KB), so engines are
+     *   cheap to create, copy and store per thread or per task.
+     * - Jumping ahead with discard() is O(1).
+     * - Each seed provides 2^64 independent streams (see fork()), so that
+     *   parallel computations can give each unit of work its own stream,
+     *   identified by for example a worker or iteration number, and
+     *   obtain the same results regardless of how the work is scheduled.
+     *
+     * This class satisfies the requirements of a UniformRandomBitGenerator
+     * producing 32 bit values, like std::mt19937, so it can be used with
+     * all standard distributions. The algorithm is the one of Salmon et
+     * al., "Parallel random numbers: as easy as 1, 2, 3" (2011), and its
+     * output matches their reference implementation.
+     *
+     * It can be used as the library's RandomEngine by defining
+     * AI_COUNTER_BASED_RNG (see the AI_COUNTER_BASED_RNG CMake option).
+     */
+    class Philox4x32 {
+        public:
+            using result_type = std::uint32_t;
+
+            static constexpr std::uint64_t default_seed = 5489u;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param seed The seed of the engine, used as its key.
+             * @param stream The stream of the engine.
+             */
+            explicit Philox4x32(std::uint64_t seed = default_seed, std::uint64_t stream = 0);
+
+            /**
+             * @brief This function resets the engine with a new seed and stream.
+             *
+             * @param seed The new seed of the engine.
+             * @param stream The new stream of the engine.
+             */
+            void seed(std::uint64_t seed = default_seed, std::uint64_t stream = 0);
+
+            /**
+             * @brief This function returns a new engine with the same seed, set to the start of the input stream.
+             *
+             * Different streams of the same seed produce independent
+             * sequences. This operation is O(1).
+             *
+             * @param stream The stream of the new engine.
+             *
+             * @return A new engine.
+             */
+            Philox4x32 fork(std::uint64_t stream) const;
+
+            /**
+             * @brief This function returns the next random number of the sequence.
+             *
+             * @return A random number in [min(), max()].
+             */
+            result_type operator()();
+
+            /**
+             * @brief This function advances the sequence by the input amount of numbers.
+             *
+             * This operation is O(1).
+             *
+             * @param z The number of random numbers to skip.
+             */
+            void discard(unsigned long long z);
+
+            /**
+             * @brief This function returns the stream of the engine.
+             *
+             * @return The stream of the engine.
+             */
+            std::uint64_t getStream() const;
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            friend bool operator==(const Philox4x32 & lhs, const Philox4x32 & rhs);
+            friend bool operator!=(const Philox4x32 & lhs, const Philox4x32 & rhs);
+
+            /**
+             * @brief This function computes a single Philox4x32-10 block.
+             *
+             * @param counter The counter to hash.
+             * @param key The key to use.
+             *
+             * @return The four random numbers for the input counter and key.
+             */
+            static std::array<std::uint32_t, 4> block(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+        private:
+            void generate(std::uint64_t b);
+
+            std::array<std::uint32_t, 2> key_;
+            std::uint64_t stream_;
+            // The number of values consumed so far.
+            std::uint64_t position_;
+            // The block currently held in output_.
+            std::uint64_t cached_;
+            std::array<std::uint32_t, 4> output_;
+    };
+
+    /**
+     * @brief This variable is true if the input engine is a counter-based engine.
+     *
+     * Counter-based engines can cheaply create a new engine for every unit
+     * of work, rather than one per thread.
+     */
+    template <typename Engine>
+    inline constexpr bool is_counter_based_engine_v = std::is_same_v<Engine, Philox4x32>;
+
+    /**
+     * @brief This function creates an engine for the input seed and stream.
+     *
+     * The returned engine only depends on the seed and stream. Counter-based
+     * engines are simply set to the input stream; other engines are seeded
+     * from both values with an std::seed_seq, which is slower but still
+     * reproducible.
+     *
+     * @tparam Engine The type of engine to create.
+     * @param seed The seed of the engine.
+     * @param stream The stream of the engine, for example a worker id.
+     *
+     * @return A new engine.
+     */
+    template <typename Engine>
+    Engine makeEngineStream(unsigned seed, std::uint64_t stream);
+
+    inline Philox4x32::Philox4x32(const std::uint64_t s, const std::uint64_t stream) {
+        seed(s, stream);
+    }
+
+    inline void Philox4x32::seed(const std::uint64_t s, const std::uint64_t stream) {
+        key_ = {{static_cast<std::uint32_t>(s), static_cast<std::uint32_t>(s >> 32)}};
+        stream_ = stream;
+        position_ = 0;
+        cached_ = std::numeric_limits<std::uint64_t>::max();
+    }
+
+    inline Philox4x32 Philox4x32::fork(const std::uint64_t stream) const {
+        Philox4x32 retval(*this);
+        retval.stream_ = stream;
+        retval.position_ = 0;
+        retval.cached_ = std::numeric_limits<std::uint64_t>::max();
+        return retval;
+    }
+
+    inline Philox4x32::result_type Philox4x32::operator()() {
+        const auto b = position_ / 4;
+        if ( b != cached_ ) generate(b);
+        return output_[position_++ % 4];
+    }
+
+    inline void Philox4x32::discard(const unsigned long long z) {
+        position_ += z;
+    }
+
+    inline std::uint64_t Philox4x32::getStream() const {
+        return stream_;
+    }
+
+    inline bool operator==(const Philox4x32 & lhs, const Philox4x32 & rhs) {
+        return lhs.key_ == rhs.key_ && lhs.stream_ == rhs.stream_ && lhs.position_ == rhs.position_;
+    }
+
+    inline bool operator!=(const Philox4x32 & lhs, const Philox4x32 & rhs) {
+        return !(lhs == rhs);
+    }
+
+    inline void Philox4x32::generate(const std::uint64_t b) {
+        output_ = block({{
+            static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(b >> 32),
+            static_cast<std::uint32_t>(stream_), static_cast<std::uint32_t>(stream_ >> 32)
+        }}, key_);
+        cached_ = b;
+    }
+
+    inline std::array<std::uint32_t, 4> Philox4x32::block(std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key) {
+        constexpr std::uint64_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+        constexpr std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+        for ( unsigned r = 0; r < 10; ++r ) {
+            if ( r ) {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            const std::uint64_t p0 = M0 * ctr[0];
+            const std::uint64_t p1 = M1 * ctr[2];
+
+            ctr = {{
+                static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                static_cast<std::uint32_t>(p1),
+                static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                static_cast<std::uint32_t>(p0)
+            }};
+        }
+        return ctr;
+    }
+
+    template <typename Engine>
+    Engine makeEngineStream(const unsigned seed, const std::uint64_t stream) {
+        if constexpr (is_counter_based_engine_v<Engine>) {
+            return Engine(seed, stream);
+        } else {
+            std::seed_seq seq{seed, static_cast<unsigned>(stream), static_cast<unsigned>(stream >> 32)};
+            return Engine(seq);
+        }
+    }
+}
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef AI_TOOLBOX_UTILS_POLYTOPE_HEADER_FILE
 #define AI_TOOLBOX_UTILS_POLYTOPE_HEADER_FILE
 
+#include <AIToolbox/Kernels.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/TypeTraits.hpp>
 #include <AIToolbox/Utils/Combinatorics.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <Eigen/Dense>
 
 #include <AIToolbox/LP.hpp>
@@ -27,11 +29,20 @@ namespace AIToolbox {
      */
     template <typename Iterator>
     Iterator findBestAtPoint(const Point & p, Iterator begin, Iterator end, double * value = nullptr) {
+        // Large points use the vectorized kernels.
+        const auto & kernels = getKernels();
+        const bool useKernels = static_cast<size_t>(p.size()) >= Kernels::MinSize;
+        const auto dot = [&](const auto & h) {
+            if constexpr(std::is_same_v<remove_cv_ref_t<decltype(h)>, Hyperplane>)
+                if ( useKernels ) return kernels.dot(p.data(), h.data(), p.size());
+            return p.dot(h);
+        };
+
         auto bestMatch = begin;
-        double bestValue = p.dot(*bestMatch);
+        double bestValue = dot(*bestMatch);
 
         while ( (++begin) < end ) {
-            const double currValue = p.dot(*begin);
+            const double currValue = dot(*begin);
             if ( currValue > bestValue || ( currValue == bestValue && veccmp(*begin, *bestMatch) > 0 ) ) {
                 bestMatch = begin;
                 bestValue = currValue;
@@ -130,6 +141,134 @@ namespace AIToolbox {
         return bound;
     }
 
+    /**
+     * @brief This function finds and moves all best Hyperplanes for the given points at the beginning of the specified range.
+     *
+     * This function is equivalent to calling extractBestAtPoint for each
+     * row of the input matrix, but it computes the values of all
+     * hyperplanes at all points with a single matrix product, which is much
+     * faster when there are many points. Ties are broken as in
+     * findBestAtPoint.
+     *
+     * This function uses an already existing bound containing previously
+     * marked useful hyperplanes. The order is 'begin'->'bound'->'end', where
+     * bound may be equal to end where no previous bound exists. All found
+     * hyperplanes are added between 'begin' and 'bound', but only if they were
+     * not there previously.
+     *
+     * @param points The points to check, one per row.
+     * @param begin The begin of the search range.
+     * @param bound The begin of the 'useful' range.
+     * @param end The end of the search range. It is NOT included in the search.
+     *
+     * @return The new bound iterator.
+     */
+    template <typename Iterator>
+    Iterator extractBestAtPoints(const Matrix2D & points, Iterator begin, Iterator bound, Iterator end) {
+        if ( end == bound || points.rows() == 0 ) return bound;
+
+        const size_t N = std::distance(begin, end);
+        const size_t B = std::distance(begin, bound);
+
+        Matrix2D hyperplanes(points.cols(), N);
+        {
+            size_t i = 0;
+            for ( auto it = begin; it != end; ++it )
+                hyperplanes.col(i++) = *it;
+        }
+        const Matrix2D values = points * hyperplanes;
+
+        std::vector<char> found(N, 0);
+        for ( auto p = 0; p < values.rows(); ++p ) {
+            size_t best = 0;
+            for ( size_t i = 1; i < N; ++i ) {
+                const double v = values(p, i), bestV = values(p, best);
+                if ( v > bestV || ( v == bestV && veccmp(hyperplanes.col(i), hyperplanes.col(best)) > 0 ) )
+                    best = i;
+            }
+            found[best] = 1;
+        }
+
+        for ( auto i = B; i < N; ++i ) {
+            if ( !found[i] ) continue;
+            iter_swap(begin + i, bound);
+            ++bound;
+        }
+        return bound;
+    }
+
+    /**
+     * @brief This function finds the best Hyperplane for each of the given points.
+     *
+     * This function is equivalent to calling findBestAtPoint for each
+     * point, but it computes the values of all hyperplanes at the points
+     * with matrix products, which is much faster when there are many
+     * points. Ties are broken as in findBestAtPoint.
+     *
+     * The points are processed in blocks of blockSize, so that only a
+     * blockSize x N matrix of values is kept in memory at any time, which
+     * allows to stream over very large sets of points. If a ThreadPool is
+     * passed, the blocks are split between its threads.
+     *
+     * The range of hyperplanes must not be empty.
+     *
+     * @param pbegin The beginning of the Point range to check.
+     * @param pend The end of the Point range to check.
+     * @param begin The beginning of the Hyperplane range to check against.
+     * @param end The end of the Hyperplane range to check against.
+     * @param values A pointer to a vector, which gets set to the best value of each point.
+     * @param pool The ThreadPool to use, or nullptr.
+     * @param blockSize The number of points to process at once.
+     *
+     * @return For each point, the offset from begin of its best Hyperplane.
+     */
+    template <typename PIterator, typename VIterator>
+    std::vector<size_t> findBestAtPoints(PIterator pbegin, PIterator pend, VIterator begin, VIterator end,
+                                         std::vector<double> * values = nullptr, ThreadPool * pool = nullptr, size_t blockSize = 256)
+    {
+        const size_t P = std::distance(pbegin, pend);
+        const size_t N = std::distance(begin, end);
+
+        std::vector<size_t> ids(P, 0);
+        if ( values ) values->resize(P);
+        if ( P == 0 ) return ids;
+
+        const size_t S = (*begin).size();
+        Matrix2D hyperplanes(S, N);
+        {
+            size_t i = 0;
+            for ( auto it = begin; it != end; ++it )
+                hyperplanes.col(i++) = *it;
+        }
+
+        const auto run = [&](const size_t b, const size_t e) {
+            Matrix2D points(e - b, S);
+            for ( size_t p = b; p < e; ++p )
+                points.row(p - b) = (*(pbegin + p)).transpose();
+            const Matrix2D v = points * hyperplanes;
+
+            for ( size_t p = b; p < e; ++p ) {
+                const auto row = v.row(p - b);
+                size_t best = 0;
+                for ( size_t i = 1; i < N; ++i ) {
+                    if ( row[i] > row[best] || ( row[i] == row[best] && veccmp(hyperplanes.col(i), hyperplanes.col(best)) > 0 ) )
+                        best = i;
+                }
+                ids[p] = best;
+                if ( values ) (*values)[p] = row[best];
+            }
+        };
+
+        if ( blockSize == 0 ) blockSize = 1;
+        if ( pool ) {
+            pool->parallelFor(P, blockSize, run);
+        } else {
+            for ( size_t b = 0; b < P; b += blockSize )
+                run(b, std::min(P, b + blockSize));
+        }
+        return ids;
+    }
+
     /**
      * @brief This function finds and moves all non-useful points at the end of the input range.
      *
@@ -208,6 +347,57 @@ namespace AIToolbox {
         return maxBound;
     }
 
+    /**
+     * @brief This function finds and moves all non-useful points at the end of the input range, evaluating them in batches.
+     *
+     * This function selects the same points as
+     * extractBestUsefulPoints(PIterator, PIterator, VIterator, VIterator),
+     * but evaluates all of them at once with findBestAtPoints, optionally
+     * in parallel. When multiple Points have the same best value for a
+     * Hyperplane, the first in the range is kept, which may not be the one
+     * kept by the serial version.
+     *
+     * The useful points keep their relative order.
+     *
+     * @param pbegin The beginning of the Point range to check.
+     * @param pend The end of the Point range to check.
+     * @param begin The beginning of the Hyperplane range to check against.
+     * @param end The end of the Hyperplane range to check against.
+     * @param pool The ThreadPool to use, or nullptr.
+     * @param blockSize The number of points to process at once.
+     *
+     * @return An iterator pointing to the first non-useful Point.
+     */
+    template <typename PIterator, typename VIterator>
+    PIterator extractBestUsefulPoints(PIterator pbegin, PIterator pend, VIterator begin, VIterator end, ThreadPool * pool, const size_t blockSize = 256) {
+        const size_t pointsN = std::distance(pbegin, pend);
+        const size_t entriesN = std::distance(begin, end);
+        if ( pointsN == 0 || entriesN == 0 ) return pbegin;
+
+        std::vector<double> values;
+        const auto ids = findBestAtPoints(pbegin, pend, begin, end, &values, pool, blockSize);
+
+        // For each Hyperplane, the first Point with the best value for it.
+        std::vector<size_t> best(entriesN, pointsN);
+        for ( size_t p = 0; p < pointsN; ++p ) {
+            auto & b = best[ids[p]];
+            if ( b == pointsN || values[b] < values[p] )
+                b = p;
+        }
+
+        std::vector<char> useful(pointsN, 0);
+        for ( const auto p : best )
+            if ( p != pointsN ) useful[p] = 1;
+
+        size_t bound = 0;
+        for ( size_t p = 0; p < pointsN; ++p ) {
+            if ( !useful[p] ) continue;
+            if ( p != bound ) iter_swap(pbegin + p, pbegin + bound);
+            ++bound;
+        }
+        return pbegin + bound;
+    }
+
     /**
      * @brief This function implements a naive vertex enumeration algorithm.
      *
@@ -231,15 +421,22 @@ namespace AIToolbox {
      *
      * This function works on ranges of Vectors.
      *
+     * If a ThreadPool is passed, the combinations are enumerated serially in
+     * batches, and the linear systems of each batch are split between the
+     * threads of the pool, each with its own matrices and solver. The
+     * returned vertices, and their order, do not depend on the number of
+     * threads.
+     *
      * @param beginNew The beginning of the range of the planes to find vertices for.
      * @param endNew The end of the range of the planes to find vertices for.
      * @param alphasBegin The beginning of the range of all other planes.
      * @param alphasEnd The end of the range of all other planes.
+     * @param pool The ThreadPool to use to solve the systems, or nullptr.
      *
      * @return A non-unique list of all the vertices found.
      */
     template <typename NewIt, typename OldIt>
-    std::vector<std::pair<Point, double>> findVerticesNaive(NewIt beginNew, NewIt endNew, OldIt alphasBegin, OldIt alphasEnd) {
+    std::vector<std::pair<Point, double>> findVerticesNaive(NewIt beginNew, NewIt endNew, OldIt alphasBegin, OldIt alphasEnd, ThreadPool * pool = nullptr) {
         std::vector<std::pair<Point, double>> vertices;
 
         const size_t alphasSize = std::distance(alphasBegin, alphasEnd);
@@ -250,77 +447,202 @@ namespace AIToolbox {
         // elements. We use it on both the alphas, and the boundaries, thus the
         // number of elements we iterate over is alphasSize + S.
         SubsetEnumerator enumerator(S - 1, 0ul, alphasSize + S);
+        const size_t K = enumerator.size();
 
-        // This is the matrix on the left side of Ax = b (where A is m)
-        Matrix2D m(S + 1, S + 1);
-        m.row(0)[S] = -1; // First row is always a vector
+        // We enumerate the combinations serially in batches, and then solve
+        // all their systems at once. For each combination we store its
+        // indices, and the first index that changed from the previous one.
+        const size_t batchSize = 256 * (pool ? pool->getThreadNumber() : 1);
+        std::vector<size_t> ids, lasts;
+        ids.reserve(batchSize * K);
+        lasts.reserve(batchSize);
 
-        Vector boundary(S+1);
-        boundary[S] = 0.0; // The boundary doesn't care about the value
+        // Solutions for each combination in the batch, and whether they are
+        // a valid vertex.
+        Matrix2D results(batchSize, S + 1);
+        std::vector<char> valid(batchSize);
 
-        // This is the vector on the right side of Ax = b
-        Vector b(S+1); b.setZero();
+        for (auto newVIt = beginNew; newVIt != endNew; ++newVIt) {
+            const auto & newV = *newVIt;
+
+            // This solves the systems of the combinations in [begin, end) of
+            // the current batch. Each call keeps its own matrices and solver,
+            // so that the batch can be split between threads.
+            const auto solveBatch = [&](const size_t begin, const size_t end) {
+                // This is the matrix on the left side of Ax = b (where A is m)
+                Matrix2D m(S + 1, S + 1);
+                m.row(0).head(S) = newV;
+                m.row(0)[S] = -1; // First row is always a vector
+
+                Vector boundary(S+1);
+                boundary[S] = 0.0; // The boundary doesn't care about the value
+
+                // This is the vector on the right side of Ax = b
+                Vector b(S+1); b.setZero();
+
+                for (size_t c = begin; c < end; ++c) {
+                    const auto combination = ids.data() + c * K;
+
+                    // Reset boundaries to care about all dimensions
+                    boundary.head(S).fill(1.0);
+                    size_t counter = 1;
+                    // Note that we start from last to avoid re-copying vectors
+                    // that are already in the matrix in their correct place.
+                    for (auto i = lasts[c]; i < K; ++i) {
+                        // For each value in the enumerator, if it is less than
+                        // alphasSize it is referring to an alphaVector we need to
+                        // take into account.
+                        const auto index = combination[i];
+                        if (index < alphasSize) {
+                            // Copy the right vector in the matrix.
+                            m.row(counter).head(S) = *std::next(alphasBegin, index);
+                            m.row(counter)[S] = -1;
+                            ++counter;
+                        } else {
+                            // We limit the index-th dimension (minus alphasSize to scale in a 0-S range)
+                            boundary[index - alphasSize] = 0.0;
+                        }
+                    }
+                    m.row(counter) = boundary;
+                    b[counter] = 1.0;
+                    ++counter;
 
-        Vector result(S+1);
+                    // Note that we only need to consider the first "counter" rows,
+                    // as the boundaries get merged in a single one.
+                    results.row(c) = m.topRows(counter).colPivHouseholderQr().solve(b.head(counter)).transpose();
 
-        // Common matrix/vector setups
+                    b[counter-1] = 0.0;
 
-        for (auto newVIt = beginNew; newVIt != endNew; ++newVIt) {
-            m.row(0).head(S) = *newVIt;
+                    // Mark as found only if valid, otherwise skip.
+                    valid[c] = ((results.row(c).head(S).array() >= 0) && (results.row(c).head(S).array() <= 1.0)).all();
+                }
+            };
 
             enumerator.reset();
 
             // Get subset of planes, find corner with LU
             size_t last = 0;
-            while (enumerator.isValid()) {
-                // Reset boundaries to care about all dimensions
-                boundary.head(S).fill(1.0);
-                size_t counter = 1;
-                // Note that we start from last to avoid re-copying vectors
-                // that are already in the matrix in their correct place.
-                for (auto i = last; i < enumerator->size(); ++i) {
-                    // For each value in the enumerator, if it is less than
-                    // alphasSize it is referring to an alphaVector we need to
-                    // take into account.
-                    const auto index = (*enumerator)[i];
-                    if (index < alphasSize) {
-                        // Copy the right vector in the matrix.
-                        m.row(counter).head(S) = *std::next(alphasBegin, index);
-                        m.row(counter)[S] = -1;
-                        ++counter;
-                    } else {
-                        // We limit the index-th dimension (minus alphasSize to scale in a 0-S range)
-                        boundary[index - alphasSize] = 0.0;
+            bool done = false;
+            while (!done) {
+                ids.clear();
+                lasts.clear();
+                while (lasts.size() < batchSize) {
+                    ids.insert(std::end(ids), std::begin(*enumerator), std::end(*enumerator));
+                    lasts.push_back(last);
+
+                    // Advance, and take the id of the first index changed in the
+                    // next combination.
+                    last = enumerator.advance();
+
+                    // If the index went over the alpha list, then we'd only have
+                    // boundaries, but we don't care about those cases (since we
+                    // assume we already have the corners of the simplex computed).
+                    // Thus, terminate.
+                    if (!enumerator.isValid() || (*enumerator)[last] >= alphasSize) {
+                        done = true;
+                        break;
                     }
                 }
-                m.row(counter) = boundary;
-                b[counter] = 1.0;
-                ++counter;
-
-                // Note that we only need to consider the first "counter" rows,
-                // as the boundaries get merged in a single one.
-                result = m.topRows(counter).colPivHouseholderQr().solve(b.head(counter));
 
-                b[counter-1] = 0.0;
+                if ( pool ) pool->parallelFor(lasts.size(), solveBatch);
+                else        solveBatch(0, lasts.size());
 
-                // Add to found only if valid, otherwise skip.
-                if (((result.head(S).array() >= 0) && (result.head(S).array() <= 1.0)).all())
-                    vertices.emplace_back(result.head(S), result[S]);
-
-                // Advance, and take the id of the first index changed in the
-                // next combination.
-                last = enumerator.advance();
-
-                // If the index went over the alpha list, then we'd only have
-                // boundaries, but we don't care about those cases (since we
-                // assume we already have the corners of the simplex computed).
-                // Thus, terminate.
-                if ((*enumerator)[last] >= alphasSize) break;
+                for (size_t c = 0; c < lasts.size(); ++c)
+                    if (valid[c])
+                        vertices.emplace_back(results.row(c).head(S).transpose(), results(c, S));
             }
         }
         return vertices;
     }
 
+    /**
+     * @brief This class incrementally enumerates the vertices of the surface of a set of hyperplanes.
+     *
+     * The surface is the upper envelope of the hyperplanes over the
+     * simplex, and its vertices are the vertices of the polyhedron
+     *
+     *     { (b, v) : b in the simplex, v >= h * b for all hyperplanes h }
+     *
+     * Rather than solving a linear system for each subset of S hyperplanes
+     * as findVerticesNaive does, this class uses the double description
+     * method: each new hyperplane cuts away the vertices below it, and the
+     * new vertices are the points where it crosses the edges between cut
+     * and kept vertices. The cost of each addition is thus polynomial in
+     * the number of vertices, rather than exponential in S.
+     *
+     * For each vertex this class keeps the set of constraints (simplex
+     * boundaries and hyperplanes) tight at it. Two vertices are adjacent
+     * if they share at least S-1 tight constraints, and no other vertex
+     * (or the vertical ray at the corners of the simplex) has all of them
+     * tight as well. This test is purely combinatorial, so it is not
+     * affected by degenerate vertices, where more than S constraints meet.
+     *
+     * Unlike findVerticesNaive, the returned values are the values of the
+     * whole surface at each vertex, and no vertex is returned twice.
+     */
+    class VertexEnumerator {
+        public:
+            using Vertices = std::vector<std::pair<Point, double>>;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param S The number of dimensions of the simplex.
+             */
+            VertexEnumerator(size_t S);
+
+            /**
+             * @brief This function adds a hyperplane to the surface, updating its vertices.
+             *
+             * The first hyperplane added creates the vertices at the
+             * corners of the simplex. Hyperplanes which are nowhere above
+             * the surface do not change the vertices.
+             *
+             * @param h The hyperplane to add.
+             *
+             * @return The vertices created by the hyperplane, with their values.
+             */
+            Vertices addHyperplane(const Hyperplane & h);
+
+            /**
+             * @brief This function removes all hyperplanes and vertices.
+             */
+            void reset();
+
+            /**
+             * @brief This function returns the current vertices of the surface, with their values.
+             *
+             * @return The vertices.
+             */
+            const Vertices & getVertices() const;
+
+            /**
+             * @brief This function returns the number of hyperplanes added so far.
+             *
+             * @return The number of hyperplanes.
+             */
+            size_t getHyperplanesNum() const;
+
+        private:
+            /**
+             * @brief This function returns whether two vertices are adjacent.
+             *
+             * @param tight The constraints tight at both vertices.
+             * @param p The index of the first vertex.
+             * @param m The index of the second vertex.
+             *
+             * @return Whether the vertices are joined by an edge.
+             */
+            bool isEdge(const std::vector<size_t> & tight, size_t p, size_t m) const;
+
+            size_t S, hyperplanes_;
+            Vertices vertices_;
+            // For each vertex, the sorted ids of its tight constraints:
+            // s for the boundary b[s] >= 0, and S + i for the i-th
+            // hyperplane.
+            std::vector<std::vector<size_t>> tight_;
+    };
+
     /**
      * @brief This function computes the optimistic value of a point given known vertices and values.
      *
@@ -437,6 +759,10 @@ namespace AIToolbox {
              * successful returns the witness point which satisfies
              * the solution.
              *
+             * Each call re-solves the same LP with LP::resolve(), since
+             * it only changes by the optimal rows added and by the tested
+             * hyperplane.
+             *
              * @param v The Hyperplane to test against the optimal ones already added.
              *
              * @return If found, the Point witness to the set problem.
@@ -444,7 +770,7 @@ namespace AIToolbox {
             std::optional<Point> findWitness(const Hyperplane & v);
 
             /**
-             * @brief This function resets the internal LP to only the simplex constraint.
+             * @brief This function resets the internal LP to only the simplex and witness constraints.
              *
              * This function does not mess with the already allocated memory.
              */
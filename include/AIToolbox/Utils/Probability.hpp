@@ -97,6 +97,7 @@ namespace AIToolbox {
      * std::uniform_real_distribution<double>, since that is what is used
      * to obtain the random sample.
      *
+     * @tparam T The scalar type of the sparse matrix.
      * @tparam G The type of the generator used.
      * @param in The external probability container.
      * @param d The size of the supplied container.
@@ -104,11 +105,11 @@ namespace AIToolbox {
      *
      * @return An index in range [0,d-1].
      */
-    template <typename G>
-    size_t sampleProbability(const size_t d, const SparseMatrix2D::ConstRowXpr& in, G& generator) {
+    template <typename T, typename G>
+    size_t sampleProbability(const size_t d, const Eigen::Block<const BasicSparseMatrix2D<T>, 1, Eigen::Dynamic, true>& in, G& generator) {
         double p = probabilityDistribution(generator);
 
-        for ( SparseMatrix2D::ConstRowXpr::InnerIterator i(in, 0); ; ++i ) {
+        for ( typename BasicSparseMatrix2D<T>::ConstRowXpr::InnerIterator i(in, 0); ; ++i ) {
             if ( i.value() > p ) return i.col();
             p -= i.value();
         }
@@ -168,6 +169,55 @@ namespace AIToolbox {
         return b;
     }
 
+    /**
+     * @brief This function fills a matrix with random probability vectors, one per row.
+     *
+     * This function samples uniformly from the simplex space, as
+     * makeRandomProbability() does, but for many vectors at once.
+     *
+     * Rather than sorting uniform numbers, each entry is sampled from an
+     * exponential distribution, and each row is then normalized: this
+     * results in the same distribution, and apart from generating the
+     * uniform numbers all operations are done on the whole matrix, so that
+     * they can be vectorized.
+     *
+     * The matrix must already have the desired size, and at least one
+     * column or we don't guarantee any behaviour.
+     *
+     * @param out The matrix to fill.
+     * @param generator A random number generator.
+     */
+    template <typename T, typename G>
+    void makeRandomProbabilities(BasicMatrix2D<T> * out, G & generator) {
+        auto & m = *out;
+        T * data = m.data();
+
+        // We sample in (0,1] in double precision, so that even with floats
+        // we never take the logarithm of zero.
+        for ( Eigen::Index i = 0; i < m.size(); ++i )
+            data[i] = static_cast<T>(1.0 - probabilityDistribution(generator));
+
+        m.array() = -m.array().log();
+        m.array().colwise() /= m.rowwise().sum().array();
+    }
+
+    /**
+     * @brief This function generates a matrix of random probability vectors, one per row.
+     *
+     * @tparam T The scalar type of the output, for example float.
+     * @param N The number of vectors to generate.
+     * @param S The number of entries of each vector.
+     * @param generator A random number generator.
+     *
+     * @return A new N by S matrix, whose rows are random probability vectors.
+     */
+    template <typename T = double, typename G>
+    BasicMatrix2D<T> makeRandomProbabilities(const size_t N, const size_t S, G & generator) {
+        BasicMatrix2D<T> retval(N, S);
+        makeRandomProbabilities(&retval, generator);
+        return retval;
+    }
+
     /**
      * @brief This function checks whether two input ProbabilityVector are equal.
      *
@@ -255,6 +305,103 @@ namespace AIToolbox {
             std::vector<size_t> alias_;
             mutable std::uniform_real_distribution<double> sampleDistribution_;
     };
+
+    /**
+     * @brief This class stores many Alias samplers compactly, one per row of a set of matrices.
+     *
+     * This class is equivalent to a collection of VoseAliasSampler, one for
+     * each distribution, but stores all coins and aliases in two contiguous
+     * blocks of memory rather than one pair of allocations per distribution.
+     * All distributions must have the same size.
+     *
+     * This is used by models that sample from a large number of fixed
+     * distributions (e.g. one per state-action pair), to make each sample
+     * O(1).
+     */
+    class VoseAliasTable {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor creates an empty table, from which it is not
+             * possible to sample.
+             */
+            VoseAliasTable();
+
+            /**
+             * @brief Basic constructor.
+             *
+             * This constructor creates a sampler for each row of the input
+             * matrices. The rows of the matrices are numbered
+             * consecutively, so that row r of matrix i has index equal to
+             * r plus the number of rows of all matrices before it. If all
+             * matrices have the same size, this is i * m[i].rows() + r.
+             *
+             * All matrices must have the same number of columns, and each
+             * of their rows must be a valid probability distribution.
+             *
+             * @tparam Mat The type of the input matrices.
+             * @param m The matrices containing the probability distributions to sample from.
+             */
+            template <typename Mat>
+            explicit VoseAliasTable(const std::vector<Mat> & m);
+
+            /**
+             * @brief This function samples a number that follows the distribution of the input row.
+             *
+             * @param row The index of the distribution to sample from.
+             * @param generator A random number generator.
+             *
+             * @return A number between 0 and the size of the distributions.
+             */
+            template <typename G>
+            size_t sampleProbability(const size_t row, G & generator) const {
+                const auto x = sampleDistribution_(generator);
+                const size_t i = std::min(static_cast<size_t>(x), cols_ - 1);
+                const auto y = x - i;
+
+                if (y < prob_(row, i)) return i;
+                return alias_[row * cols_ + i];
+            }
+
+            /**
+             * @brief This function returns whether the table contains no distributions.
+             *
+             * @return True if the table is empty, false otherwise.
+             */
+            bool empty() const;
+
+            /**
+             * @brief This function returns the heap memory used by the table, in bytes.
+             *
+             * @return The memory allocated by the table.
+             */
+            size_t getMemoryUsage() const;
+
+        private:
+            void build();
+
+            size_t cols_;
+            Matrix2D prob_;
+            std::vector<unsigned> alias_;
+            mutable std::uniform_real_distribution<double> sampleDistribution_;
+    };
+
+    template <typename Mat>
+    VoseAliasTable::VoseAliasTable(const std::vector<Mat> & m) : cols_(0) {
+        if (m.empty()) return;
+
+        size_t rows = 0;
+        for (const auto & mi : m)
+            rows += mi.rows();
+
+        cols_ = m[0].cols();
+        prob_.resize(rows, cols_);
+        for (size_t i = 0, r = 0; i < m.size(); r += m[i].rows(), ++i)
+            prob_.middleRows(r, m[i].rows()) = m[i].template cast<double>();
+
+        build();
+    }
 }
 
 #endif
@@ -2,13 +2,92 @@
 #define AI_TOOLBOX_UTILS_PRUNE_HEADER_FILE
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
 
 #include <AIToolbox/Types.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Utils/TypeTraits.hpp>
 #include <AIToolbox/Utils/Polytope.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox {
+    /**
+     * @brief This function finds and moves all duplicate Vectors in the range.
+     *
+     * This function hashes each Vector, so that it runs in linear time,
+     * while extractDominated() and Pruner compare pairs of Vectors. It is
+     * thus useful to shrink ranges with many copies (as cross-sums) before
+     * calling them.
+     *
+     * If epsilon is zero, only exact copies are extracted. Otherwise, each
+     * value is quantized to a grid of size epsilon, and Vectors that fall
+     * in the same cell of the grid are considered duplicates. Each of the
+     * extracted Vectors then differs from the one kept by less than
+     * epsilon in every element; note that Vectors closer than epsilon but
+     * in different cells are not extracted.
+     *
+     * The first of each group of duplicates is kept, and the kept Vectors
+     * maintain their relative order. Duplicates are moved at the end of
+     * the range for safe removal.
+     *
+     * This function throws std::invalid_argument if epsilon is negative.
+     *
+     * @param N The number of elements in each Vector.
+     * @param begin The begin of the list that needs to be pruned.
+     * @param end The end of the list that needs to be pruned.
+     * @param epsilon The size of the quantization grid, or zero for exact comparisons.
+     *
+     * @return The iterator that separates duplicate elements with non-pruned.
+     */
+    template <typename Iterator>
+    Iterator extractDuplicates(const size_t N, Iterator begin, Iterator end, const double epsilon = 0.0) {
+        if ( epsilon < 0.0 ) throw std::invalid_argument("Epsilon must be >= 0");
+        if ( std::distance(begin, end) < 2 ) return end;
+
+        const auto cell = [epsilon](const double v) {
+            return epsilon > 0.0 ? std::floor(v / epsilon) : v;
+        };
+        const auto hash = [N, &cell](const auto & v) {
+            size_t seed = 0;
+            for ( size_t i = 0; i < N; ++i )
+                boost::hash_combine(seed, cell(v[i]));
+            return seed;
+        };
+        const auto equal = [N, &cell](const auto & lhs, const auto & rhs) {
+            for ( size_t i = 0; i < N; ++i )
+                if ( cell(lhs[i]) != cell(rhs[i]) ) return false;
+            return true;
+        };
+
+        // Kept Vectors, by hash, as offsets from begin. They are never
+        // moved once kept, so the offsets stay valid.
+        std::unordered_multimap<size_t, size_t> kept;
+        kept.reserve(std::distance(begin, end));
+
+        auto optEnd = begin;
+        for ( auto it = begin; it < end; ++it ) {
+            const auto h = hash(*it);
+            const auto [first, last] = kept.equal_range(h);
+            if ( std::any_of(first, last, [&](const auto & k) { return equal(*(begin + k.second), *it); }) )
+                continue;
+
+            kept.emplace(h, std::distance(begin, optEnd));
+            if ( it != optEnd ) iter_swap(it, optEnd);
+            ++optEnd;
+        }
+        return optEnd;
+    }
+
     /**
      * @brief This function finds and moves all Vectors in the range that are dominated by others.
      *
@@ -75,15 +154,103 @@ next:;
      * remove all hyperplanes which are completely dominated. It is much more
      * precise than extractDominated, but it is also a lot more expensive to
      * call.
+     *
+     * Before any other check, duplicate hyperplanes are removed by hashing
+     * them (see extractDuplicates()). Optionally (see
+     * setDuplicateTolerance()), hyperplanes which are almost equal are
+     * removed as well.
+     *
+     * Before solving any LP, the hyperplanes which are best at the corners
+     * of the simplex are extracted, as they are certainly part of the
+     * solution. Optionally (see setBeliefSamples()), the same is done with a
+     * set of random beliefs, which are generated once and cached. Their
+     * values are computed with a single matrix product, so that with enough
+     * samples most of the solution is found without solving any LP, and
+     * the remaining LPs have more rows to start from.
+     *
+     * If a ThreadPool is set (see setThreadPool()), large sets of
+     * hyperplanes are pruned in rounds. In each round the hyperplanes left
+     * to check are split between the threads of the pool, each with its own
+     * WitnessLP. When a thread finds a witness point, it locates the
+     * hyperplane that is best at that point and shares it with the other
+     * threads, which add it to their LP before their next solve. Hyperplanes
+     * without a witness are dominated and are discarded. The shared
+     * hyperplanes then join the solution, and the remaining hyperplanes are
+     * checked again in the next round. The pruned set is the same as in the
+     * serial case, but its order can vary between runs.
      */
     class Pruner {
         public:
+            /// The minimum number of hyperplanes left to check to use the ThreadPool.
+            static constexpr size_t ParallelThreshold = 64;
+
             /**
              * @brief Basic constructor.
              *
              * @param S The number of dimensions of the simplex to operate on.
              */
-            Pruner(const size_t s) : S(s), lp_(S) {}
+            Pruner(const size_t s) : S(s), lp_(S), pool_(nullptr), duplicateTolerance_(0.0) {}
+
+            /**
+             * @brief This function sets the ThreadPool to use to search for witness points in parallel.
+             *
+             * The ThreadPool is not owned by this class, and must outlive
+             * any calls to operator(). Since pools are not reentrant, it
+             * must not be the pool running the caller, if any. A
+             * nullptr (the default) disables parallelization.
+             *
+             * @param pool The ThreadPool to use, or nullptr.
+             */
+            void setThreadPool(ThreadPool * pool) { pool_ = pool; }
+
+            /**
+             * @brief This function returns the currently set ThreadPool.
+             *
+             * @return The currently set ThreadPool, or nullptr.
+             */
+            ThreadPool * getThreadPool() const { return pool_; }
+
+            /**
+             * @brief This function sets the number of random beliefs to check before solving LPs.
+             *
+             * The beliefs are sampled uniformly from the simplex when this
+             * function is called, and are reused for all subsequent prunes.
+             * More beliefs find more of the solution without LPs, but cost
+             * an extra S multiply-adds per belief and per hyperplane. Zero
+             * (the default) disables the check.
+             *
+             * @param samples The number of beliefs to sample.
+             */
+            void setBeliefSamples(size_t samples);
+
+            /**
+             * @brief This function returns the number of random beliefs checked before solving LPs.
+             *
+             * @return The number of sampled beliefs.
+             */
+            size_t getBeliefSamples() const { return beliefs_.rows(); }
+
+            /**
+             * @brief This function sets the tolerance to consider two hyperplanes duplicates.
+             *
+             * Hyperplanes are quantized to a grid of the input size, and
+             * only one per cell is kept (see extractDuplicates()). The
+             * pruned set can thus lose up to this much value at any
+             * belief. Zero (the default) only removes exact duplicates.
+             *
+             * This function throws std::invalid_argument if the tolerance
+             * is negative.
+             *
+             * @param tolerance The size of the quantization grid.
+             */
+            void setDuplicateTolerance(double tolerance);
+
+            /**
+             * @brief This function returns the tolerance to consider two hyperplanes duplicates.
+             *
+             * @return The size of the quantization grid.
+             */
+            double getDuplicateTolerance() const { return duplicateTolerance_; }
 
             /**
              * @brief This function prunes all non useful hyperplanes from the provided list.
@@ -94,16 +261,39 @@ next:;
             It operator()(It begin, It end);
 
         private:
+            /**
+             * @brief This function checks the hyperplanes in [bound, end) in parallel.
+             *
+             * @param begin The beginning of the hyperplanes known to be in the solution.
+             * @param bound The beginning of the hyperplanes to check.
+             * @param end The end of the hyperplanes to check.
+             *
+             * @return The end of the pruned range.
+             */
+            template <typename It>
+            It parallelPrune(It begin, It bound, It end);
+
             size_t S;
 
             WitnessLP lp_;
+            // The sampled beliefs, one per row.
+            Matrix2D beliefs_;
+            ThreadPool * pool_;
+            double duplicateTolerance_;
+            // One LP per thread of the pool.
+            std::vector<std::unique_ptr<WitnessLP>> lps_;
     };
 
     // The idea is that the input thing already has all the best vectors,
     // thus we only need to find them and discard the others.
     template <typename It>
     It Pruner::operator()(It begin, It end) {
-        // Remove easy ValueFunctions to avoid doing more work later.
+        AI_METRIC_TIME("Pruner::prune");
+        AI_METRIC_RECORD("Pruner::inputSize", std::distance(begin, end));
+
+        // Remove easy ValueFunctions to avoid doing more work later; the
+        // duplicates first, as they take linear time.
+        end = extractDuplicates(S, begin, end, duplicateTolerance_);
         end = extractDominated(S, begin, end);
 
         const size_t size = std::distance(begin, end);
@@ -115,7 +305,11 @@ next:;
 
         bound = extractBestAtSimplexCorners(S, begin, bound, end);
 
-        // Here we could do some random belief lookups..
+        // Then we also take the best hyperplanes at the sampled beliefs.
+        bound = extractBestAtPoints(beliefs_, begin, bound, end);
+
+        if ( pool_ && pool_->getThreadNumber() > 1 && static_cast<size_t>(std::distance(bound, end)) >= ParallelThreshold )
+            return parallelPrune(begin, bound, end);
 
         // If we actually have still work to do..
         if ( bound < end ) {
@@ -157,6 +351,101 @@ next:;
 
         return bound;
     }
+
+    inline void Pruner::setBeliefSamples(const size_t samples) {
+        RandomEngine rand(Impl::Seeder::getSeed());
+
+        beliefs_.resize(samples, S);
+        makeRandomProbabilities(&beliefs_, rand);
+    }
+
+    inline void Pruner::setDuplicateTolerance(const double tolerance) {
+        if ( tolerance < 0.0 ) throw std::invalid_argument("Tolerance must be >= 0");
+        duplicateTolerance_ = tolerance;
+    }
+
+    template <typename It>
+    It Pruner::parallelPrune(const It begin, It bound, It end) {
+        const size_t threads = pool_->getThreadNumber();
+        while ( lps_.size() < threads )
+            lps_.emplace_back(std::make_unique<WitnessLP>(S));
+
+        // For each hyperplane left to check, whether it is in the solution
+        // (it was the best at a witness point), and whether it has a
+        // witness point itself.
+        std::vector<char> found, witnessed;
+        // The solution hyperplanes found in the current round, as offsets
+        // from bound, shared between threads.
+        std::vector<size_t> shared;
+        std::mutex mutex;
+
+        while ( bound < end ) {
+            const size_t size = std::distance(bound, end);
+            const size_t blocks = std::min(threads, size);
+
+            found.assign(size, 0);
+            witnessed.assign(size, 0);
+            shared.clear();
+
+            const auto check = [&](const size_t block) {
+                auto & lp = *lps_[block];
+                lp.reset();
+                lp.allocate(std::distance(begin, end));
+                for ( auto it = begin; it != bound; ++it )
+                    lp.addOptimalRow(*it);
+
+                size_t seen = 0;
+                for ( size_t i = block * size / blocks; i < (block + 1) * size / blocks; ++i ) {
+                    // Add the solution hyperplanes found by other threads.
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        for ( ; seen < shared.size(); ++seen )
+                            lp.addOptimalRow(*(bound + shared[seen]));
+                    }
+                    const auto witness = lp.findWitness(*(bound + i));
+                    if ( !witness ) continue;
+
+                    witnessed[i] = 1;
+                    // The hyperplane is better than all current solution
+                    // hyperplanes at the witness point, so the best one
+                    // there is one we still have to check.
+                    const size_t best = std::distance(bound, findBestAtPoint(*witness, bound, end));
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if ( !found[best] ) {
+                        found[best] = 1;
+                        shared.push_back(best);
+                    }
+                }
+            };
+            pool_->parallelFor(blocks, [&check](const size_t b, const size_t e) {
+                for ( auto block = b; block < e; ++block )
+                    check(block);
+            });
+
+            const auto swapAt = [&](const size_t i, const size_t j) {
+                iter_swap(bound + i, bound + j);
+                std::swap(found[i], found[j]);
+                std::swap(witnessed[i], witnessed[j]);
+            };
+
+            // Move the new solution hyperplanes after the known ones..
+            size_t k = 0;
+            for ( size_t i = 0; i < size; ++i )
+                if ( found[i] ) swapAt(i, k++);
+
+            // ..and discard the ones without a witness.
+            size_t last = size;
+            for ( size_t i = k; i < last; ) {
+                if ( witnessed[i] ) ++i;
+                else swapAt(i, --last);
+            }
+
+            end = bound + last;
+            bound += k;
+        }
+        return bound;
+    }
 }
 
 #endif
@@ -0,0 +1,139 @@
+#ifndef AI_TOOLBOX_UTILS_ROLLOUT_CACHE_HEADER_FILE
+#define AI_TOOLBOX_UTILS_ROLLOUT_CACHE_HEADER_FILE
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace AIToolbox {
+    /**
+     * @brief This class caches the returns of rollouts, bounded in size with LRU eviction.
+     *
+     * Tree searches like MCTS and POMCP estimate the value of each new
+     * leaf with a random rollout. When many leaves are equivalent, for
+     * example because they share the same state, or the same recent
+     * history of actions and observations, their rollouts estimate the
+     * same quantity, and most of them can be skipped.
+     *
+     * Each entry keeps an exponentially decayed average of the returns
+     * added to it, together with its weight (the decayed number of
+     * returns). A lookup only succeeds when the weight is at least a
+     * minimum, and each successful lookup decays the weight, so that after
+     * a number of hits the entry stops answering until a new return is
+     * added. This keeps entries up to date with the search, whose policy
+     * changes over time.
+     *
+     * When the cache is full, the least recently used entry is evicted.
+     * A cache with a maximum size of zero is disabled: lookups always fail,
+     * and nothing is stored.
+     */
+    class RolloutCache {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param maxSize The maximum number of entries, or zero to disable the cache.
+             * @param decay The decay applied to the weight of an entry at each update and hit, in (0, 1).
+             * @param minWeight The minimum weight for an entry to be returned by lookup().
+             */
+            RolloutCache(size_t maxSize = 0, double decay = 0.99, double minWeight = 10.0);
+
+            /**
+             * @brief This function returns the cached return for the input key, if it is reliable enough.
+             *
+             * On success, the entry becomes the most recently used, and
+             * its weight is decayed.
+             *
+             * @param key The key to look up.
+             *
+             * @return The cached return, or nothing.
+             */
+            std::optional<double> lookup(size_t key);
+
+            /**
+             * @brief This function adds a rollout return to the entry of the input key.
+             *
+             * The entry is created if needed, evicting the least recently
+             * used entry if the cache is full.
+             *
+             * @param key The key of the entry.
+             * @param value The return of the rollout.
+             */
+            void update(size_t key, double value);
+
+            /**
+             * @brief This function removes all entries.
+             */
+            void clear();
+
+            /**
+             * @brief This function sets the maximum number of entries.
+             *
+             * Entries are evicted if there are more than the new maximum.
+             *
+             * @param maxSize The maximum number of entries, or zero to disable the cache.
+             */
+            void setMaxSize(size_t maxSize);
+
+            /**
+             * @brief This function sets the decay of the weights of the entries.
+             *
+             * @param decay The new decay, in (0, 1).
+             */
+            void setDecay(double decay);
+
+            /**
+             * @brief This function sets the minimum weight for an entry to be returned.
+             *
+             * @param minWeight The new minimum weight.
+             */
+            void setMinWeight(double minWeight);
+
+            /**
+             * @brief This function returns the maximum number of entries.
+             */
+            size_t getMaxSize() const;
+
+            /**
+             * @brief This function returns the decay of the weights of the entries.
+             */
+            double getDecay() const;
+
+            /**
+             * @brief This function returns the minimum weight for an entry to be returned.
+             */
+            double getMinWeight() const;
+
+            /**
+             * @brief This function returns whether the cache is enabled.
+             */
+            bool isEnabled() const;
+
+            /**
+             * @brief This function returns the number of entries.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the number of successful lookups since the last clear().
+             */
+            size_t getHits() const;
+
+        private:
+            struct Entry {
+                double value;
+                double weight;
+                std::list<size_t>::iterator lru;
+            };
+
+            size_t maxSize_;
+            double decay_, minWeight_;
+            size_t hits_;
+
+            std::unordered_map<size_t, Entry> entries_;
+            std::list<size_t> lru_;
+    };
+}
+
+#endif
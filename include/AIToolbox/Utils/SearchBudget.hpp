@@ -0,0 +1,126 @@
+#ifndef AI_TOOLBOX_UTILS_SEARCH_BUDGET_HEADER_FILE
+#define AI_TOOLBOX_UTILS_SEARCH_BUDGET_HEADER_FILE
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This struct contains statistics about the last search performed by an online planner.
+     *
+     * The timers and the depth histogram are only filled if the library
+     * is compiled with profiling enabled; see \ref Profiling.
+     */
+    struct SearchStatistics {
+        /// The number of rollouts performed.
+        unsigned rollouts = 0;
+        /// The number of nodes added to the tree.
+        size_t nodesAdded = 0;
+        /// The maximum depth reached within the tree, where the root has depth 0.
+        unsigned maxDepth = 0;
+        /// The number of rollouts answered by the rollout cache.
+        unsigned rolloutCacheHits = 0;
+        /// The number of existing nodes reached through a new path via a transposition table.
+        size_t transpositions = 0;
+        /// The number of samples merged into an existing observation branch by progressive widening.
+        size_t mergedObservations = 0;
+        /// The number of nodes not added or expanded because the tree had reached its memory limit.
+        size_t memoryLimited = 0;
+
+        /// The number of nodes in the tree at the end of the search.
+        size_t nodes = 0;
+        /// The memory allocated by the tree at the end of the search, in bytes.
+        size_t memoryUsage = 0;
+        /// The duration of the search.
+        std::chrono::nanoseconds elapsed{0};
+
+        /// The time spent selecting actions within the tree.
+        std::chrono::nanoseconds selectionTime{0};
+        /// The time spent adding and expanding nodes.
+        std::chrono::nanoseconds expansionTime{0};
+        /// The time spent in rollouts, or evaluating batches of leaves.
+        std::chrono::nanoseconds rolloutTime{0};
+        /// The number of simulations which left the tree at each depth.
+        std::vector<unsigned> depthHistogram;
+
+        /**
+         * @brief This function records a simulation which left the tree at the input depth.
+         *
+         * @param depth The depth of the last node of the simulation within the tree.
+         */
+        void addLeafDepth(unsigned depth);
+
+        /**
+         * @brief This function returns the number of rollouts performed per second.
+         *
+         * @return The rate of rollouts, or zero if no time was measured.
+         */
+        double getRolloutsPerSecond() const;
+    };
+
+    /**
+     * @brief This class represents a time budget for an anytime search.
+     *
+     * Online planners can be given a budget of time rather than a fixed
+     * number of rollouts. Reading the clock is cheap but not free, so this
+     * class only reads it once every CheckInterval rollouts; searches may
+     * thus overrun their budget by up to CheckInterval - 1 rollouts.
+     *
+     * The deadline is computed with std::chrono::steady_clock, so it is not
+     * affected by changes to the system time.
+     */
+    class SearchDeadline {
+        public:
+            /// The number of rollouts between each reading of the clock.
+            static constexpr unsigned CheckInterval = 8;
+
+            /**
+             * @brief Basic constructor.
+             *
+             * The deadline starts counting from the moment of construction.
+             *
+             * @param budget The time available to the search.
+             */
+            template <typename Rep, typename Period>
+            SearchDeadline(std::chrono::duration<Rep, Period> budget);
+
+            /**
+             * @brief This function returns whether the search should stop.
+             *
+             * The clock is only read when the input number of rollouts is
+             * a multiple of CheckInterval; otherwise this function returns
+             * false. Callers should perform at least one rollout before
+             * calling this function, so that they always have a result.
+             *
+             * @param rollouts The number of rollouts performed so far.
+             *
+             * @return True if the budget has been used up, false otherwise.
+             */
+            bool expired(unsigned rollouts) const;
+
+        private:
+            std::chrono::steady_clock::time_point deadline_;
+    };
+
+    inline void SearchStatistics::addLeafDepth(const unsigned depth) {
+        if ( depthHistogram.size() <= depth ) depthHistogram.resize(depth + 1);
+        ++depthHistogram[depth];
+    }
+
+    inline double SearchStatistics::getRolloutsPerSecond() const {
+        if ( elapsed.count() == 0 ) return 0.0;
+        return rollouts / std::chrono::duration<double>(elapsed).count();
+    }
+
+    template <typename Rep, typename Period>
+    SearchDeadline::SearchDeadline(const std::chrono::duration<Rep, Period> budget) :
+            deadline_(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget)) {}
+
+    inline bool SearchDeadline::expired(const unsigned rollouts) const {
+        if ( rollouts % CheckInterval ) return false;
+        return std::chrono::steady_clock::now() >= deadline_;
+    }
+}
+
+#endif
@@ -0,0 +1,644 @@
+#ifndef AI_TOOLBOX_UTILS_SEARCH_TREE_HEADER_FILE
+#define AI_TOOLBOX_UTILS_SEARCH_TREE_HEADER_FILE
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This struct is the default, empty, data of SearchTree nodes.
+     */
+    struct SearchTreeNoData {
+        void clear() {}
+    };
+
+    /**
+     * @brief This class is an arena-allocated tree for Monte Carlo tree search planners.
+     *
+     * The tree alternates between nodes (states or beliefs) and action
+     * nodes. Each expanded node owns A contiguous action nodes, and each
+     * action node maps the sampled outcomes (states or observations) to
+     * its children.
+     *
+     * All nodes, action nodes and child tables are stored in flat arrays,
+     * and are referred to by index. The statistics of the action nodes
+     * (values, squared values and visit counts) are stored as separate
+     * arrays, so that the statistics of all actions of a node are
+     * contiguous and can be scanned efficiently while selecting actions;
+     * see getValues() and getCounts(). Child tables are small
+     * open-addressing hash tables using linear probing, stored in blocks
+     * of another array; when a table grows its old block is abandoned
+     * until the tree is reset.
+     *
+     * Resetting the tree only rewinds the arrays, which is O(1) and keeps
+     * all memory (and the memory of the per-node data, if it can be
+     * cleared) for the next search. Making a node the new root is also
+     * O(1), as the rest of the tree is simply left unreachable. Once the
+     * arrays have doubled in size since the last compaction, rerooting
+     * copies the reachable subtree into a second set of arrays and drops
+     * the rest, so that the cost of compactions is amortized over the
+     * added nodes.
+     *
+     * A node can also be added as the child of more than one action node
+     * (see linkChild()), for example to share nodes between paths reaching
+     * the same state. The tree then becomes a graph, possibly with cycles;
+     * compactions preserve the sharing.
+     *
+     * Since the arrays grow as needed, references and pointers to nodes
+     * are invalidated by any function which adds nodes or action nodes to
+     * the tree; only NodeIds remain valid.
+     *
+     * @tparam Data Additional data to store in each node. It must be default constructible, and have a clear() method.
+     */
+    template <typename Data = SearchTreeNoData>
+    class SearchTree {
+        public:
+            using NodeId = std::uint32_t;
+            static constexpr NodeId NoNode = std::numeric_limits<NodeId>::max();
+
+            /**
+             * @brief This struct refers to the statistics of an action node.
+             */
+            struct ActionNode {
+                double & V;
+                unsigned & N;
+            };
+
+            /**
+             * @brief This struct refers to the statistics of a const action node.
+             */
+            struct ConstActionNode {
+                const double & V;
+                const unsigned & N;
+            };
+
+            struct Node : public Data {
+                unsigned N = 0;
+
+                // First action node in the action array, if expanded.
+                std::uint32_t actions = NoNode;
+            };
+
+            /**
+             * @brief Basic constructor.
+             *
+             * The tree starts with a single, unexpanded, root node.
+             *
+             * @param A The number of actions of each expanded node.
+             */
+            SearchTree(size_t A);
+
+            /**
+             * @brief This function resets the tree to a single, unexpanded, root node.
+             *
+             * This function runs in O(1), and keeps all allocated memory.
+             */
+            void reset();
+
+            /**
+             * @brief This function makes the input node the new root of the tree.
+             *
+             * The subtree of the node is kept, while everything else
+             * becomes unreachable. This runs in O(1), except when it
+             * triggers a compaction (see compact()): this happens when
+             * the tree has doubled in size since the last one.
+             *
+             * Note that a compaction changes the ids of all nodes.
+             *
+             * @param id The node to make root.
+             *
+             * @return Whether the tree has been compacted.
+             */
+            bool reroot(NodeId id);
+
+            /**
+             * @brief This function discards all nodes which are not reachable from the root.
+             *
+             * The reachable subtree is copied into a second set of arrays,
+             * which then replace the current ones. This runs in time linear
+             * in the size of the kept subtree. The data of the kept nodes
+             * is moved, not copied.
+             *
+             * Nodes reachable through more than one path are copied once.
+             *
+             * After this call the root has id 0, and the ids of all other
+             * nodes change.
+             */
+            void compact();
+
+            /**
+             * @brief This function allocates the action nodes of a node, if they are not already.
+             *
+             * @param id The node to expand.
+             */
+            void expand(NodeId id);
+
+            /**
+             * @brief This function returns the child of a node for the input action and outcome.
+             *
+             * @param id The parent node.
+             * @param a The action of the parent.
+             * @param key The outcome of the action.
+             *
+             * @return The id of the child, or NoNode if it does not exist.
+             */
+            NodeId getChild(NodeId id, size_t a, size_t key) const;
+
+            /**
+             * @brief This function returns the child of a node for the input action and outcome, adding it if needed.
+             *
+             * The node must be expanded. New children are not expanded.
+             *
+             * @param id The parent node.
+             * @param a The action of the parent.
+             * @param key The outcome of the action.
+             *
+             * @return The id of the child, and whether it was added.
+             */
+            std::pair<NodeId, bool> addChild(NodeId id, size_t a, size_t key);
+
+            /**
+             * @brief This function adds an existing node as the child of a node for the input action and outcome.
+             *
+             * The node must be expanded, and must not already have a child
+             * for the input action and outcome. The child can be any node
+             * of the tree, so that it is shared between its parents.
+             *
+             * @param id The parent node.
+             * @param a The action of the parent.
+             * @param key The outcome of the action.
+             * @param child The node to add as child.
+             */
+            void linkChild(NodeId id, size_t a, size_t key, NodeId child);
+
+            /**
+             * @brief This function calls the input function with all children of an action node.
+             *
+             * The function is called as f(key, childId), in an unspecified
+             * order. The function must not add nodes to the tree.
+             *
+             * @param id The parent node.
+             * @param a The action of the parent.
+             * @param f The function to call.
+             */
+            template <typename F>
+            void forEachChild(NodeId id, size_t a, F && f) const;
+
+            /**
+             * @brief This function returns the id of the root.
+             *
+             * @return The id of the root.
+             */
+            NodeId getRoot() const;
+
+            /**
+             * @brief This function returns the node with the input id.
+             *
+             * @param id The id of the node.
+             *
+             * @return A reference to the node.
+             */
+            Node & getNode(NodeId id);
+            const Node & getNode(NodeId id) const;
+
+            /**
+             * @brief This function returns whether a node has been expanded.
+             *
+             * @param id The id of the node.
+             *
+             * @return True if the node has its action nodes, false otherwise.
+             */
+            bool isExpanded(NodeId id) const;
+
+            /**
+             * @brief This function returns the A contiguous action values of an expanded node.
+             *
+             * @param id The id of the node.
+             *
+             * @return A pointer to the value of the first action.
+             */
+            double * getValues(NodeId id);
+            const double * getValues(NodeId id) const;
+
+            /**
+             * @brief This function returns the A contiguous action visit counts of an expanded node.
+             *
+             * @param id The id of the node.
+             *
+             * @return A pointer to the visit count of the first action.
+             */
+            unsigned * getCounts(NodeId id);
+            const unsigned * getCounts(NodeId id) const;
+
+            /**
+             * @brief This function returns the A contiguous mean squared returns of the actions of an expanded node.
+             *
+             * Together with the values, these can be used to compute the
+             * variance of the returns of each action.
+             *
+             * @param id The id of the node.
+             *
+             * @return A pointer to the mean squared return of the first action.
+             */
+            const double * getSquares(NodeId id) const;
+
+            /**
+             * @brief This function returns an action node of an expanded node.
+             *
+             * The returned struct refers to the statistics of the action
+             * node, and is invalidated as references to nodes are.
+             *
+             * @param id The id of the node.
+             * @param a The action.
+             *
+             * @return The action node.
+             */
+            ActionNode getAction(NodeId id, size_t a);
+            ConstActionNode getAction(NodeId id, size_t a) const;
+
+            /**
+             * @brief This function adds a return to the statistics of an action node.
+             *
+             * The visit count of the action is incremented, and its value
+             * and mean squared return are updated with the new sample.
+             *
+             * @param id The id of the node.
+             * @param a The action.
+             * @param rew The return obtained.
+             */
+            void update(NodeId id, size_t a, double rew);
+
+            /**
+             * @brief This function returns the number of children of an action node.
+             *
+             * @param id The id of the node.
+             * @param a The action.
+             *
+             * @return The number of children of the action node.
+             */
+            size_t getChildCount(NodeId id, size_t a) const;
+
+            /**
+             * @brief This function returns the number of nodes in the tree.
+             *
+             * This includes nodes which are no longer reachable from the
+             * root, but have not been compacted away yet.
+             *
+             * @return The number of nodes.
+             */
+            size_t size() const;
+
+            /**
+             * @brief This function returns the memory allocated by the tree, in bytes.
+             *
+             * This includes the memory kept for reuse after resets and
+             * compactions, but not memory owned by the per-node data
+             * (for example, heap memory of its members).
+             *
+             * @return The memory allocated by the tree.
+             */
+            size_t getMemoryUsage() const;
+
+            /**
+             * @brief This function returns the memory used by the nodes currently in the tree, in bytes.
+             *
+             * Unlike getMemoryUsage(), this does not include the memory
+             * kept for reuse, so it drops when the tree is reset or
+             * compacted. It is the measure used by online planners to
+             * limit the growth of the tree. As the buffers of the tree
+             * grow geometrically, the allocated memory can be up to
+             * twice this value.
+             *
+             * @return The memory used by the nodes in the tree.
+             */
+            size_t getUsedMemory() const;
+
+            /**
+             * @brief This function returns the number of actions of each expanded node.
+             *
+             * @return The number of actions.
+             */
+            size_t getA() const;
+
+        private:
+            struct Slot {
+                size_t key;
+                NodeId node;
+            };
+
+            // Block of the child table of an action node in the slot array.
+            struct ChildTable {
+                std::uint32_t table = 0, capacity = 0, size = 0;
+            };
+
+            struct Storage {
+                std::vector<Node> nodes;
+                // Action nodes, one element of each array per action.
+                std::vector<double> values, squares;
+                std::vector<unsigned> counts;
+                std::vector<ChildTable> tables;
+                std::vector<Slot> slots;
+                size_t nodesUsed = 0, actionsUsed = 0, slotsUsed = 0;
+
+                void rewind() { nodesUsed = actionsUsed = slotsUsed = 0; }
+                size_t memoryUsage() const;
+                NodeId allocNode();
+                std::uint32_t allocActions(size_t A);
+                std::uint32_t allocSlots(size_t n);
+            };
+
+            static size_t hash(size_t key);
+            static void insert(Storage & st, ChildTable & t, size_t key, NodeId node);
+            NodeId copySubtree(NodeId id);
+
+            size_t A;
+            NodeId root_;
+            // Number of nodes after the last reset or compaction.
+            size_t compactedSize_;
+            Storage storage_, spare_;
+            // The copy of each node during a compaction, if any.
+            std::vector<NodeId> copies_;
+    };
+
+    template <typename Data>
+    SearchTree<Data>::SearchTree(const size_t a) : A(a) {
+        reset();
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::reset() {
+        storage_.rewind();
+        root_ = storage_.allocNode();
+        compactedSize_ = 1;
+    }
+
+    template <typename Data>
+    bool SearchTree<Data>::reroot(const NodeId id) {
+        root_ = id;
+        if ( storage_.nodesUsed < 2 * compactedSize_ )
+            return false;
+        compact();
+        return true;
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::compact() {
+        spare_.rewind();
+        copies_.assign(storage_.nodesUsed, NoNode);
+        root_ = copySubtree(root_);
+        std::swap(storage_, spare_);
+        compactedSize_ = storage_.nodesUsed;
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::NodeId SearchTree<Data>::copySubtree(const NodeId id) {
+        // Shared nodes are only copied once.
+        if ( copies_[id] != NoNode ) return copies_[id];
+
+        const NodeId copy = spare_.allocNode();
+        copies_[id] = copy;
+        {
+            auto & src = storage_.nodes[id];
+            auto & dst = spare_.nodes[copy];
+            // We swap so that the old memory of dst is cleared and reused
+            // when storage_ is reset.
+            std::swap(static_cast<Data&>(src), static_cast<Data&>(dst));
+            dst.N = src.N;
+        }
+        if ( storage_.nodes[id].actions == NoNode ) return copy;
+
+        const auto actions = spare_.allocActions(A);
+        spare_.nodes[copy].actions = actions;
+
+        const auto srcActions = storage_.nodes[id].actions;
+        std::copy_n(storage_.values.begin() + srcActions, A, spare_.values.begin() + actions);
+        std::copy_n(storage_.squares.begin() + srcActions, A, spare_.squares.begin() + actions);
+        std::copy_n(storage_.counts.begin() + srcActions, A, spare_.counts.begin() + actions);
+
+        for ( size_t a = 0; a < A; ++a ) {
+            const auto src = storage_.tables[srcActions + a];
+            if ( src.size ) {
+                auto & dst = spare_.tables[actions + a];
+                dst.capacity = src.capacity;
+                dst.table = spare_.allocSlots(src.capacity);
+            }
+            for ( size_t i = 0; i < src.capacity; ++i ) {
+                const auto slot = storage_.slots[src.table + i];
+                if ( slot.node == NoNode ) continue;
+                const auto child = copySubtree(slot.node);
+                insert(spare_, spare_.tables[actions + a], slot.key, child);
+            }
+        }
+        return copy;
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::expand(const NodeId id) {
+        if ( storage_.nodes[id].actions != NoNode ) return;
+        const auto actions = storage_.allocActions(A);
+        storage_.nodes[id].actions = actions;
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::NodeId SearchTree<Data>::getChild(const NodeId id, const size_t a, const size_t key) const {
+        if ( !isExpanded(id) ) return NoNode;
+        const auto & t = storage_.tables[storage_.nodes[id].actions + a];
+        if ( !t.size ) return NoNode;
+
+        const size_t mask = t.capacity - 1;
+        for ( size_t i = hash(key) & mask; ; i = (i + 1) & mask ) {
+            const auto & slot = storage_.slots[t.table + i];
+            if ( slot.node == NoNode ) return NoNode;
+            if ( slot.key == key )     return slot.node;
+        }
+    }
+
+    template <typename Data>
+    std::pair<typename SearchTree<Data>::NodeId, bool> SearchTree<Data>::addChild(const NodeId id, const size_t a, const size_t key) {
+        if ( const auto child = getChild(id, a, key); child != NoNode )
+            return {child, false};
+
+        const auto child = storage_.allocNode();
+        insert(storage_, storage_.tables[storage_.nodes[id].actions + a], key, child);
+        return {child, true};
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::linkChild(const NodeId id, const size_t a, const size_t key, const NodeId child) {
+        insert(storage_, storage_.tables[storage_.nodes[id].actions + a], key, child);
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::insert(Storage & st, ChildTable & t, const size_t key, const NodeId node) {
+        // We keep the load factor at most 1/2.
+        if ( 2 * (t.size + 1) > t.capacity ) {
+            const auto oldTable = t.table, oldCapacity = t.capacity;
+            t.capacity = oldCapacity ? 2 * oldCapacity : 4;
+            t.table = st.allocSlots(t.capacity);
+            t.size = 0;
+            for ( size_t i = 0; i < oldCapacity; ++i ) {
+                const auto slot = st.slots[oldTable + i];
+                if ( slot.node != NoNode ) insert(st, t, slot.key, slot.node);
+            }
+        }
+        const size_t mask = t.capacity - 1;
+        size_t i = hash(key) & mask;
+        while ( st.slots[t.table + i].node != NoNode )
+            i = (i + 1) & mask;
+
+        st.slots[t.table + i] = Slot{key, node};
+        ++t.size;
+    }
+
+    template <typename Data>
+    template <typename F>
+    void SearchTree<Data>::forEachChild(const NodeId id, const size_t a, F && f) const {
+        if ( !isExpanded(id) ) return;
+        const auto & t = storage_.tables[storage_.nodes[id].actions + a];
+        for ( size_t i = 0; i < t.capacity; ++i ) {
+            const auto & slot = storage_.slots[t.table + i];
+            if ( slot.node != NoNode ) f(slot.key, slot.node);
+        }
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::hash(const size_t key) {
+        // Fibonacci hashing, folding the high bits into the low ones
+        // since we mask them.
+        std::uint64_t h = key * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::NodeId SearchTree<Data>::Storage::allocNode() {
+        if ( nodesUsed == nodes.size() ) {
+            nodes.emplace_back();
+        } else {
+            auto & n = nodes[nodesUsed];
+            n.clear();
+            n.N = 0;
+            n.actions = NoNode;
+        }
+        return nodesUsed++;
+    }
+
+    template <typename Data>
+    std::uint32_t SearchTree<Data>::Storage::allocActions(const size_t A) {
+        const auto begin = actionsUsed;
+        actionsUsed += A;
+        if ( tables.size() < actionsUsed ) {
+            values.resize(actionsUsed);
+            squares.resize(actionsUsed);
+            counts.resize(actionsUsed);
+            tables.resize(actionsUsed);
+        }
+        std::fill(values.begin() + begin, values.begin() + actionsUsed, 0.0);
+        std::fill(squares.begin() + begin, squares.begin() + actionsUsed, 0.0);
+        std::fill(counts.begin() + begin, counts.begin() + actionsUsed, 0u);
+        std::fill(tables.begin() + begin, tables.begin() + actionsUsed, ChildTable());
+        return begin;
+    }
+
+    template <typename Data>
+    std::uint32_t SearchTree<Data>::Storage::allocSlots(const size_t n) {
+        const auto begin = slotsUsed;
+        slotsUsed += n;
+        if ( slots.size() < slotsUsed ) slots.resize(slotsUsed);
+        std::fill(slots.begin() + begin, slots.begin() + slotsUsed, Slot{0, NoNode});
+        return begin;
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::NodeId SearchTree<Data>::getRoot() const { return root_; }
+
+    template <typename Data>
+    typename SearchTree<Data>::Node & SearchTree<Data>::getNode(const NodeId id) { return storage_.nodes[id]; }
+
+    template <typename Data>
+    const typename SearchTree<Data>::Node & SearchTree<Data>::getNode(const NodeId id) const { return storage_.nodes[id]; }
+
+    template <typename Data>
+    bool SearchTree<Data>::isExpanded(const NodeId id) const { return storage_.nodes[id].actions != NoNode; }
+
+    template <typename Data>
+    double * SearchTree<Data>::getValues(const NodeId id) {
+        return storage_.values.data() + storage_.nodes[id].actions;
+    }
+
+    template <typename Data>
+    const double * SearchTree<Data>::getValues(const NodeId id) const {
+        return storage_.values.data() + storage_.nodes[id].actions;
+    }
+
+    template <typename Data>
+    unsigned * SearchTree<Data>::getCounts(const NodeId id) {
+        return storage_.counts.data() + storage_.nodes[id].actions;
+    }
+
+    template <typename Data>
+    const unsigned * SearchTree<Data>::getCounts(const NodeId id) const {
+        return storage_.counts.data() + storage_.nodes[id].actions;
+    }
+
+    template <typename Data>
+    const double * SearchTree<Data>::getSquares(const NodeId id) const {
+        return storage_.squares.data() + storage_.nodes[id].actions;
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::ActionNode SearchTree<Data>::getAction(const NodeId id, const size_t a) {
+        const auto i = storage_.nodes[id].actions + a;
+        return {storage_.values[i], storage_.counts[i]};
+    }
+
+    template <typename Data>
+    typename SearchTree<Data>::ConstActionNode SearchTree<Data>::getAction(const NodeId id, const size_t a) const {
+        const auto i = storage_.nodes[id].actions + a;
+        return {storage_.values[i], storage_.counts[i]};
+    }
+
+    template <typename Data>
+    void SearchTree<Data>::update(const NodeId id, const size_t a, const double rew) {
+        const auto i = storage_.nodes[id].actions + a;
+        const double n = ++storage_.counts[i];
+        storage_.values[i] += ( rew - storage_.values[i] ) / n;
+        storage_.squares[i] += ( rew * rew - storage_.squares[i] ) / n;
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::getChildCount(const NodeId id, const size_t a) const {
+        return storage_.tables[storage_.nodes[id].actions + a].size;
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::size() const { return storage_.nodesUsed; }
+
+    template <typename Data>
+    size_t SearchTree<Data>::Storage::memoryUsage() const {
+        return nodes.capacity() * sizeof(Node) +
+               values.capacity() * sizeof(double) + squares.capacity() * sizeof(double) +
+               counts.capacity() * sizeof(unsigned) + tables.capacity() * sizeof(ChildTable) +
+               slots.capacity() * sizeof(Slot);
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::getMemoryUsage() const {
+        return storage_.memoryUsage() + spare_.memoryUsage() + copies_.capacity() * sizeof(NodeId);
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::getUsedMemory() const {
+        return storage_.nodesUsed * sizeof(Node) +
+               storage_.actionsUsed * (2 * sizeof(double) + sizeof(unsigned) + sizeof(ChildTable)) +
+               storage_.slotsUsed * sizeof(Slot);
+    }
+
+    template <typename Data>
+    size_t SearchTree<Data>::getA() const { return A; }
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef AI_TOOLBOX_UTILS_SOLVER_CONTROL_HEADER_FILE
+#define AI_TOOLBOX_UTILS_SOLVER_CONTROL_HEADER_FILE
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace AIToolbox {
+    /**
+     * @brief This class represents a request to stop a running solver.
+     *
+     * All copies of a token share the same state, so a token can be given
+     * to a solver, and then cancelled from any other thread.
+     */
+    class CancellationToken {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The new token is not cancelled.
+             */
+            CancellationToken();
+
+            /**
+             * @brief This function cancels the token and all its copies.
+             */
+            void cancel();
+
+            /**
+             * @brief This function returns whether the token has been cancelled.
+             *
+             * @return Whether cancel() has been called on this token or any of its copies.
+             */
+            bool isCancelled() const;
+
+        private:
+            std::shared_ptr<std::atomic<bool>> cancelled_;
+    };
+
+    /**
+     * @brief This struct contains the progress of a solver after an iteration.
+     */
+    struct SolverProgress {
+        /// The number of iterations completed.
+        unsigned timestep;
+        /// The distance to convergence: the variation between the last two iterations, or the gap between the bounds.
+        double gap;
+        /// The number of alphavectors of the current solution.
+        size_t size;
+        /// The time elapsed since the start of the solve.
+        std::chrono::nanoseconds elapsed;
+    };
+
+    using ProgressCallback = std::function<void(const SolverProgress &)>;
+
+    /**
+     * @brief This class adds progress reporting and cancellation to iterative solvers.
+     *
+     * Solvers which derive from this class check their CancellationToken
+     * once per iteration; if it has been cancelled, they stop and return
+     * the solution computed up to the last completed iteration, as if
+     * they had reached their horizon. The ProgressCallback, if set, is
+     * called at the end of each iteration, from the thread running the
+     * solver.
+     */
+    class SolverControl {
+        public:
+            /**
+             * @brief This function sets the callback that receives the progress of the solver.
+             *
+             * An empty callback (the default) disables progress reporting.
+             *
+             * @param callback The function to call after each iteration.
+             */
+            void setProgressCallback(ProgressCallback callback);
+
+            /**
+             * @brief This function sets the token checked to stop the solver.
+             *
+             * @param token The token to check.
+             */
+            void setCancellationToken(CancellationToken token);
+
+            /**
+             * @brief This function returns the currently set CancellationToken.
+             *
+             * @return The currently set token.
+             */
+            const CancellationToken & getCancellationToken() const;
+
+        protected:
+            /**
+             * @brief This function records the start of a solve.
+             */
+            void startProgress();
+
+            /**
+             * @brief This function returns whether the solver should stop.
+             *
+             * @return Whether the token has been cancelled.
+             */
+            bool isCancelled() const;
+
+            /**
+             * @brief This function reports the progress of the solver to the callback.
+             *
+             * @param timestep The number of iterations completed.
+             * @param gap The distance to convergence.
+             * @param size The number of alphavectors of the current solution.
+             */
+            void reportProgress(unsigned timestep, double gap, size_t size) const;
+
+        private:
+            ProgressCallback progress_;
+            CancellationToken token_;
+            std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * @brief This class represents a solve running in the background.
+     *
+     * This class wraps the future of the solve, together with the
+     * CancellationToken given to the solver. If it is destroyed before the
+     * solve is done, the solve is cancelled, and the destructor waits for
+     * the solver to stop (at its next iteration).
+     *
+     * @tparam R The type returned by the solver.
+     */
+    template <typename R>
+    class AsyncSolution {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param future The future of the solve.
+             * @param token The token given to the solver.
+             */
+            AsyncSolution(std::future<R> future, CancellationToken token);
+
+            AsyncSolution(AsyncSolution &&) = default;
+            AsyncSolution & operator=(AsyncSolution &&) = default;
+
+            /**
+             * @brief Basic destructor.
+             *
+             * If the solve has not been retrieved, it is cancelled and
+             * waited for.
+             */
+            ~AsyncSolution();
+
+            /**
+             * @brief This function waits for the solve, and returns its result.
+             *
+             * Any exception thrown by the solver is rethrown here. This
+             * function can only be called once.
+             *
+             * @return The result of the solver.
+             */
+            R get();
+
+            /**
+             * @brief This function asks the solver to stop at its next iteration.
+             *
+             * The result can still be retrieved with get(), and contains
+             * the solution up to the last completed iteration.
+             */
+            void cancel();
+
+            /**
+             * @brief This function returns whether the solve is done.
+             *
+             * @return Whether get() would not block.
+             */
+            bool isReady() const;
+
+        private:
+            std::future<R> future_;
+            CancellationToken token_;
+    };
+
+    /**
+     * @brief This function runs a solver in a background thread.
+     *
+     * The solver is given a new CancellationToken, which is cancelled if
+     * the returned AsyncSolution is cancelled or destroyed. When the solve
+     * ends, the solver gets back the token it had before, so that later
+     * synchronous calls are not affected. The solver and
+     * the arguments are used by reference, so they must outlive the
+     * returned AsyncSolution, and must not be used until it is done.
+     *
+     * Note that this function spawns a new thread (with std::async) for
+     * each call, which is the only place where the library does so. It
+     * cannot use a ThreadPool, as those are fork-join pools which block
+     * the caller until all their work is done. The solver can still be
+     * given a ThreadPool for its own work, which is then only used from
+     * the spawned thread.
+     *
+     * @param solver The solver to run; it must derive from SolverControl.
+     * @param args The arguments to pass to the solver's operator().
+     *
+     * @return The AsyncSolution of the solve.
+     */
+    template <typename Solver, typename... Args>
+    auto solveAsync(Solver & solver, const Args & ... args) -> AsyncSolution<decltype(solver(args...))> {
+        using R = decltype(solver(args...));
+
+        CancellationToken token;
+
+        auto future = std::async(std::launch::async, [&solver, &args..., token]() -> R {
+            // Puts back the previous token however the solve ends.
+            struct Restore {
+                ~Restore() { solver.setCancellationToken(std::move(previous)); }
+                Solver & solver;
+                CancellationToken previous;
+            } restore{solver, solver.getCancellationToken()};
+
+            solver.setCancellationToken(token);
+            return solver(args...);
+        });
+        return AsyncSolution<R>(std::move(future), std::move(token));
+    }
+
+    template <typename R>
+    AsyncSolution<R>::AsyncSolution(std::future<R> future, CancellationToken token) :
+            future_(std::move(future)), token_(std::move(token)) {}
+
+    template <typename R>
+    AsyncSolution<R>::~AsyncSolution() {
+        if (!future_.valid()) return;
+        token_.cancel();
+        future_.wait();
+    }
+
+    template <typename R>
+    R AsyncSolution<R>::get() {
+        return future_.get();
+    }
+
+    template <typename R>
+    void AsyncSolution<R>::cancel() {
+        token_.cancel();
+    }
+
+    template <typename R>
+    bool AsyncSolution<R>::isReady() const {
+        return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef AI_TOOLBOX_UTILS_STRIPED_SPIN_LOCK_HEADER_FILE
+#define AI_TOOLBOX_UTILS_STRIPED_SPIN_LOCK_HEADER_FILE
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace AIToolbox {
+    /**
+     * @brief This class is a set of spinlocks, each guarding a stripe of indeces.
+     *
+     * Index i is guarded by the spinlock i % getStripes(), so that a large
+     * number of indeces (for example, the rows of a table) can be locked
+     * independently with a fixed amount of memory. Each spinlock lives in
+     * its own cache line, to avoid false sharing between threads.
+     *
+     * Spinlocks are meant for critical sections of a few instructions. They
+     * are not reentrant, and a thread must not hold two of them at once
+     * (as two indeces may share the same stripe).
+     *
+     * Copying creates a new, unlocked set with the same number of stripes.
+     */
+    class StripedSpinLock {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * @param stripes The number of spinlocks; zero creates an empty set.
+             */
+            explicit StripedSpinLock(size_t stripes = 0) :
+                    stripes_(stripes), locks_(stripes ? new Stripe[stripes] : nullptr) {}
+
+            StripedSpinLock(const StripedSpinLock & other) : StripedSpinLock(other.stripes_) {}
+            StripedSpinLock & operator=(const StripedSpinLock & other) {
+                if (this != &other) *this = StripedSpinLock(other.stripes_);
+                return *this;
+            }
+            StripedSpinLock(StripedSpinLock &&) = default;
+            StripedSpinLock & operator=(StripedSpinLock &&) = default;
+
+            /**
+             * @brief This function acquires the spinlock guarding the input index.
+             *
+             * @param i The index to lock.
+             */
+            void lock(size_t i) {
+                auto & flag = locks_[i % stripes_].flag;
+                while (flag.exchange(true, std::memory_order_acquire))
+                    while (flag.load(std::memory_order_relaxed))
+                        std::this_thread::yield();
+            }
+
+            /**
+             * @brief This function releases the spinlock guarding the input index.
+             *
+             * @param i The index to unlock.
+             */
+            void unlock(size_t i) {
+                locks_[i % stripes_].flag.store(false, std::memory_order_release);
+            }
+
+            /**
+             * @brief This function returns the number of spinlocks.
+             */
+            size_t getStripes() const { return stripes_; }
+
+        private:
+            struct alignas(64) Stripe {
+                std::atomic<bool> flag{false};
+            };
+
+            size_t stripes_;
+            std::unique_ptr<Stripe[]> locks_;
+    };
+
+    /**
+     * @brief This class holds the spinlock of an index for its lifetime.
+     */
+    class StripeGuard {
+        public:
+            StripeGuard(StripedSpinLock & locks, size_t i) : locks_(locks), i_(i) { locks_.lock(i_); }
+            ~StripeGuard() { locks_.unlock(i_); }
+
+            StripeGuard(const StripeGuard &) = delete;
+            StripeGuard & operator=(const StripeGuard &) = delete;
+
+        private:
+            StripedSpinLock & locks_;
+            size_t i_;
+    };
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef AI_TOOLBOX_UTILS_SUM_TREE_HEADER_FILE
+#define AI_TOOLBOX_UTILS_SUM_TREE_HEADER_FILE
+
+#include <cstddef>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This class stores non-negative weights and samples them proportionally in O(log N).
+     *
+     * The weights are the leaves of a complete binary tree, where each
+     * internal node holds the sum of its children. Both updating a weight
+     * and finding the leaf for a given point of the cumulative
+     * distribution take a single walk between the root and a leaf.
+     *
+     * The tree is stored in a single array, with the children of node i at
+     * 2i and 2i+1, and the leaves at the end.
+     */
+    class SumTree {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * All weights start at zero.
+             *
+             * @param N The number of weights.
+             */
+            SumTree(size_t N);
+
+            /**
+             * @brief This function sets the weight of a leaf.
+             *
+             * @param i The leaf to update.
+             * @param weight The new weight, which must be non-negative.
+             */
+            void set(size_t i, double weight);
+
+            /**
+             * @brief This function returns the weight of a leaf.
+             *
+             * @param i The leaf to read.
+             *
+             * @return The weight of the leaf.
+             */
+            double get(size_t i) const;
+
+            /**
+             * @brief This function returns the sum of all weights.
+             *
+             * @return The total weight.
+             */
+            double getTotal() const;
+
+            /**
+             * @brief This function returns the leaf where the cumulative weight crosses the input.
+             *
+             * This returns the leaf i such that the sum of the weights
+             * before it is <= u, and adding its own weight gives more than
+             * u. Drawing u uniformly in [0, getTotal()) thus samples leaves
+             * proportionally to their weight.
+             *
+             * Leaves with zero weight are never returned, as long as the
+             * total is positive. Inputs outside of [0, getTotal()) are
+             * clamped to the first or last leaf with positive weight.
+             *
+             * @param u The point of the cumulative distribution to find.
+             *
+             * @return The leaf found.
+             */
+            size_t find(double u) const;
+
+            /**
+             * @brief This function sets all weights to zero.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns the number of weights.
+             *
+             * @return The number of leaves.
+             */
+            size_t size() const;
+
+        private:
+            size_t N, leaves_;
+            std::vector<double> nodes_;
+    };
+}
+
+#endif
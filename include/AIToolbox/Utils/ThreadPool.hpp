@@ -0,0 +1,184 @@
+#ifndef AI_TOOLBOX_UTILS_THREAD_POOL_HEADER_FILE
+#define AI_TOOLBOX_UTILS_THREAD_POOL_HEADER_FILE
+
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+namespace AIToolbox {
+    /**
+     * @brief This class is a simple fork-join pool of worker threads.
+     *
+     * This class is used by the algorithms of the library that can split
+     * their work into independent chunks. The pool is always owned by the
+     * user, and algorithms only receive a non-owning pointer to it: in this
+     * way the library never spawns threads on its own, and the same pool
+     * can be shared between multiple algorithms. The only exception is
+     * solveAsync() (see SolverControl.hpp), which explicitly asks for a
+     * background thread.
+     *
+     * The calling thread always participates in the work, so a pool of N
+     * threads only spawns N-1 workers. A pool of a single thread does not
+     * spawn any worker, and simply executes all work inline.
+     *
+     * This class is NOT reentrant: only a single thread at a time can
+     * submit work to the pool, and work functions must not submit work to
+     * the pool themselves.
+     *
+     * Not passing a pool to an algorithm (i.e. passing nullptr) always
+     * results in serial execution on the calling thread. A pool with a
+     * single thread behaves in the same way, and can be used where an
+     * actual pool object is required.
+     *
+     * Users that need to control where the workers run (for example to
+     * pin them to specific cores, or to lower their priority) can pass a
+     * start function to the constructor, which is called by each worker
+     * before it starts processing work.
+     */
+    class ThreadPool {
+        public:
+            /**
+             * @brief Basic constructor.
+             *
+             * The number of threads includes the calling thread, so this
+             * constructor spawns threads-1 workers. A value of zero is
+             * treated as one.
+             *
+             * @param threads The number of threads to use.
+             */
+            ThreadPool(size_t threads);
+
+            /**
+             * @brief Constructor with a start function for the workers.
+             *
+             * This constructor is equivalent to ThreadPool(size_t), but each
+             * worker calls the input function with its index (from 1 to
+             * threads-1; index 0 is the calling thread) as the first thing
+             * it does in its own thread. This can be used to set the
+             * affinity, priority or name of each worker.
+             *
+             * The constructor returns only after all workers have run the
+             * input function. The input function must not throw.
+             *
+             * @param threads The number of threads to use.
+             * @param onStart The function each worker calls when it starts.
+             */
+            ThreadPool(size_t threads, const std::function<void(size_t)> & onStart);
+
+            /**
+             * @brief Basic destructor.
+             *
+             * This joins all workers.
+             */
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool &) = delete;
+            ThreadPool & operator=(const ThreadPool &) = delete;
+
+            /**
+             * @brief This function splits a range of work between the threads of the pool.
+             *
+             * The range [0, N) is split in contiguous blocks, at most one per
+             * thread, and the input function is called once per block with
+             * its begin and end. The split only depends on N and on the
+             * number of threads, and not on scheduling, so that algorithms
+             * can produce identical results to their serial counterparts.
+             *
+             * This function returns only after all blocks have been
+             * processed. The input function must not throw.
+             *
+             * @param N The size of the range to process.
+             * @param f A function taking a (begin, end) pair of indeces.
+             */
+            template <typename F>
+            void parallelFor(size_t N, F && f);
+
+            /**
+             * @brief This function splits a range of work in blocks of fixed size between the threads of the pool.
+             *
+             * The range [0, N) is split in contiguous blocks of grain
+             * elements (the last one may be smaller), and the input
+             * function is called once per block with its begin and end.
+             * Blocks are handed to threads as they become free, so this
+             * function balances the load when the cost of each element
+             * varies widely.
+             *
+             * As with parallelFor(size_t, F&&), the blocks only depend on N
+             * and grain, but which thread processes each block depends on
+             * scheduling.
+             *
+             * This function returns only after all blocks have been
+             * processed. The input function must not throw.
+             *
+             * @param N The size of the range to process.
+             * @param grain The size of each block; zero is treated as one.
+             * @param f A function taking a (begin, end) pair of indeces.
+             */
+            template <typename F>
+            void parallelFor(size_t N, size_t grain, F && f);
+
+            /**
+             * @brief This function returns the number of threads of the pool.
+             *
+             * @return The number of threads, including the calling one.
+             */
+            size_t getThreadNumber() const;
+
+        private:
+            void execute(size_t jobs, const std::function<void(size_t)> & job);
+            void runJobs();
+            void workerLoop();
+            void spawn(size_t threads, const std::function<void(size_t)> * onStart);
+
+            std::vector<std::thread> workers_;
+
+            std::mutex mutex_;
+            std::condition_variable wakeUp_, done_;
+
+            const std::function<void(size_t)> * job_;
+            size_t jobs_;
+            std::atomic<size_t> nextJob_;
+            size_t finished_;
+            size_t generation_;
+            bool stop_;
+    };
+
+    template <typename F>
+    void ThreadPool::parallelFor(const size_t N, size_t grain, F && f) {
+        if (N == 0) return;
+        if (grain == 0) grain = 1;
+
+        const size_t blocks = (N + grain - 1) / grain;
+        if (blocks == 1 || getThreadNumber() == 1) {
+            for (size_t b = 0; b < N; b += grain)
+                f(b, std::min(N, b + grain));
+            return;
+        }
+
+        execute(blocks, [N, grain, &f](const size_t i) {
+            f(i * grain, std::min(N, (i + 1) * grain));
+        });
+    }
+
+    template <typename F>
+    void ThreadPool::parallelFor(const size_t N, F && f) {
+        if (N == 0) return;
+
+        const size_t blocks = std::min(N, getThreadNumber());
+        if (blocks == 1) {
+            f(size_t(0), N);
+            return;
+        }
+
+        execute(blocks, [N, blocks, &f](const size_t i) {
+            f(i * N / blocks, (i + 1) * N / blocks);
+        });
+    }
+}
+
+#endif
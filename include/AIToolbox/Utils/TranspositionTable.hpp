@@ -0,0 +1,117 @@
+#ifndef AI_TOOLBOX_UTILS_TRANSPOSITION_TABLE_HEADER_FILE
+#define AI_TOOLBOX_UTILS_TRANSPOSITION_TABLE_HEADER_FILE
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This class maps keys to the nodes of a search tree, bounded in size.
+     *
+     * Tree searches can reach the same state through different paths. A
+     * transposition table allows them to find the node already created
+     * for a state (and possibly a depth), so that the node and its
+     * statistics can be shared between all paths leading to it, turning
+     * the tree into a graph.
+     *
+     * The table has a fixed number of slots, rounded up to a power of two,
+     * and each key can only be stored in a single slot, chosen by its
+     * hash. When a new key falls in an occupied slot, it replaces the old
+     * entry: recently created nodes are the most likely to be reached
+     * again while the search deepens. This keeps both memory and the cost
+     * of each operation constant.
+     *
+     * A table with no slots is disabled: lookups always fail, and nothing
+     * is stored.
+     */
+    class TranspositionTable {
+        public:
+            using NodeId = std::uint32_t;
+            static constexpr NodeId NoNode = std::numeric_limits<NodeId>::max();
+
+            /**
+             * @brief Basic constructor.
+             *
+             * @param size The minimum number of slots, or zero to disable the table.
+             */
+            TranspositionTable(size_t size = 0);
+
+            /**
+             * @brief This function returns the node stored for the input key.
+             *
+             * @param key The key to look up.
+             *
+             * @return The node of the key, or NoNode if it is not stored.
+             */
+            NodeId lookup(size_t key) const;
+
+            /**
+             * @brief This function stores the node of the input key, replacing any other key in its slot.
+             *
+             * @param key The key of the node.
+             * @param node The node to store.
+             */
+            void insert(size_t key, NodeId node);
+
+            /**
+             * @brief This function removes all entries.
+             */
+            void clear();
+
+            /**
+             * @brief This function returns whether the table is enabled.
+             */
+            bool isEnabled() const;
+
+            /**
+             * @brief This function returns the number of slots of the table.
+             */
+            size_t getSize() const;
+
+        private:
+            struct Slot {
+                size_t key;
+                NodeId node;
+            };
+
+            size_t slot(size_t key) const;
+
+            std::vector<Slot> slots_;
+    };
+
+    inline TranspositionTable::TranspositionTable(const size_t size) {
+        if ( !size ) return;
+        size_t capacity = 1;
+        while ( capacity < size ) capacity *= 2;
+        slots_.resize(capacity, Slot{0, NoNode});
+    }
+
+    inline TranspositionTable::NodeId TranspositionTable::lookup(const size_t key) const {
+        if ( slots_.empty() ) return NoNode;
+        const auto & s = slots_[slot(key)];
+        return s.key == key ? s.node : NoNode;
+    }
+
+    inline void TranspositionTable::insert(const size_t key, const NodeId node) {
+        if ( slots_.empty() ) return;
+        slots_[slot(key)] = Slot{key, node};
+    }
+
+    inline void TranspositionTable::clear() {
+        std::fill(std::begin(slots_), std::end(slots_), Slot{0, NoNode});
+    }
+
+    inline bool TranspositionTable::isEnabled() const { return !slots_.empty(); }
+    inline size_t TranspositionTable::getSize() const { return slots_.size(); }
+
+    inline size_t TranspositionTable::slot(const size_t key) const {
+        // Fibonacci hashing, as in SearchTree.
+        std::uint64_t h = key * 0x9E3779B97F4A7C15ull;
+        return (h ^ (h >> 32)) & (slots_.size() - 1);
+    }
+}
+
+#endif
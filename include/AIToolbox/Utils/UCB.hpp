@@ -0,0 +1,172 @@
+#ifndef AI_TOOLBOX_UTILS_UCB_HEADER_FILE
+#define AI_TOOLBOX_UTILS_UCB_HEADER_FILE
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace AIToolbox {
+    /**
+     * @brief This class implements the UCB1 exploration bonus.
+     *
+     * Bonus classes compute the score of every action of a tree node, in
+     * order to select which one to try next. They are called as
+     *
+     *     bonus(exploration, count, V, N, Q, A, scores);
+     *
+     * where count is the number of visits of the node, and V, N and Q are
+     * the A contiguous values, visit counts and mean squared returns of
+     * its actions, as stored by SearchTree. All visit counts must be at
+     * most count. The scores are written in the scores array.
+     *
+     * Rather than calling std::log and std::sqrt for every action, bonus
+     * classes cache the functions of the counts they need in tables, which
+     * grow as the counts do. The score of each action is then a couple of
+     * lookups and a multiply-add over contiguous arrays.
+     *
+     * UCB1 scores each action as
+     *
+     *     V[a] + exploration * sqrt( log(count + 1) / N[a] )
+     *
+     * Actions which have never been tried have infinite score.
+     */
+    class UCB1 {
+        public:
+            void operator()(double exploration, unsigned count, const double * V, const unsigned * N, const double * Q, size_t A, double * scores);
+
+        private:
+            // sqrt(log(n + 1)) and 1 / sqrt(n).
+            std::vector<double> sqrtLog_, invSqrt_;
+    };
+
+    /**
+     * @brief This class implements the PUCT exploration bonus.
+     *
+     * PUCT, used by AlphaZero, scores each action as
+     *
+     *     V[a] + exploration * P[a] * sqrt(count) / (1 + N[a])
+     *
+     * Here there is no policy to provide priors, so P is uniform and it is
+     * folded into the exploration constant. Compared to UCB1, the bonus of
+     * untried actions is finite, so that they are not all necessarily
+     * tried before revisiting a good one.
+     */
+    class PUCT {
+        public:
+            void operator()(double exploration, unsigned count, const double * V, const unsigned * N, const double * Q, size_t A, double * scores);
+
+        private:
+            // sqrt(n) and 1 / (1 + n).
+            std::vector<double> sqrt_, inv_;
+    };
+
+    /**
+     * @brief This class implements the UCB-tuned exploration bonus.
+     *
+     * UCB-tuned (Auer et al., 2002) takes into account the variance of
+     * the returns of each action, scoring it as
+     *
+     *     V[a] + exploration * sqrt( L / N[a] * min(1/4, var[a] + sqrt(2 L / N[a])) )
+     *
+     * where L = log(count + 1) and var[a] = Q[a] - V[a]^2. The 1/4 bound
+     * is the maximum variance of returns in [0, 1]; for other ranges the
+     * exploration constant should be scaled accordingly.
+     *
+     * Since the bonus does not factor into a term for the node and one
+     * for the action, it still takes a square root for every action.
+     */
+    class UCBTuned {
+        public:
+            void operator()(double exploration, unsigned count, const double * V, const unsigned * N, const double * Q, size_t A, double * scores);
+
+        private:
+            // log(n + 1) and 1 / n.
+            std::vector<double> log_, inv_;
+    };
+
+    /**
+     * @brief This function selects the action with the highest exploration score.
+     *
+     * Ties are broken in favour of the lowest action.
+     *
+     * @param bonus The bonus used to score the actions.
+     * @param exploration The exploration constant.
+     * @param count The number of visits of the node.
+     * @param V The values of the actions of the node.
+     * @param N The visit counts of the actions of the node.
+     * @param Q The mean squared returns of the actions of the node.
+     * @param A The number of actions.
+     * @param scores A buffer for the scores, resized as needed.
+     *
+     * @return The selected action.
+     */
+    template <typename Bonus>
+    size_t selectBonusAction(Bonus & bonus, double exploration, unsigned count, const double * V, const unsigned * N, const double * Q, size_t A, std::vector<double> & scores);
+
+    namespace Impl {
+        /**
+         * @brief This function extends a table so that it contains f(i) for all i < size.
+         */
+        template <typename F>
+        void extendTable(std::vector<double> & table, const size_t size, F f) {
+            if ( table.size() >= size ) return;
+            // We grow geometrically so that tables are extended rarely.
+            const auto newSize = std::max(size, 2 * table.size());
+            table.reserve(newSize);
+            for ( auto i = table.size(); i < newSize; ++i )
+                table.push_back(f(static_cast<double>(i)));
+        }
+    }
+
+    inline void UCB1::operator()(const double exploration, const unsigned count, const double * V, const unsigned * N, const double *, const size_t A, double * scores) {
+        // Count here can be as low as 1.
+        // Since log(1) = 0, and 0/0 = error, we add 1.0.
+        Impl::extendTable(sqrtLog_, count + 1, [](double n){ return std::sqrt(std::log(n + 1.0)); });
+        Impl::extendTable(invSqrt_, count + 1, [](double n){ return 1.0 / std::sqrt(n); });
+
+        const double k = exploration * sqrtLog_[count];
+        const double * invSqrt = invSqrt_.data();
+        for ( size_t a = 0; a < A; ++a )
+            scores[a] = V[a] + k * invSqrt[N[a]];
+    }
+
+    inline void PUCT::operator()(const double exploration, const unsigned count, const double * V, const unsigned * N, const double *, const size_t A, double * scores) {
+        Impl::extendTable(sqrt_, count + 1, [](double n){ return std::sqrt(n); });
+        Impl::extendTable(inv_, count + 1, [](double n){ return 1.0 / (1.0 + n); });
+
+        const double k = exploration * sqrt_[count];
+        const double * inv = inv_.data();
+        for ( size_t a = 0; a < A; ++a )
+            scores[a] = V[a] + k * inv[N[a]];
+    }
+
+    inline void UCBTuned::operator()(const double exploration, const unsigned count, const double * V, const unsigned * N, const double * Q, const size_t A, double * scores) {
+        Impl::extendTable(log_, count + 1, [](double n){ return std::log(n + 1.0); });
+        Impl::extendTable(inv_, count + 1, [](double n){ return 1.0 / n; });
+
+        const double logCount = log_[count];
+        const double * inv = inv_.data();
+        for ( size_t a = 0; a < A; ++a ) {
+            // For untried actions x is infinite, and so is the score.
+            const double x = logCount * inv[N[a]];
+            const double var = Q[a] - V[a] * V[a];
+            scores[a] = V[a] + exploration * std::sqrt(x * std::min(0.25, var + std::sqrt(2.0 * x)));
+        }
+    }
+
+    template <typename Bonus>
+    size_t selectBonusAction(Bonus & bonus, const double exploration, const unsigned count, const double * V, const unsigned * N, const double * Q, const size_t A, std::vector<double> & scores) {
+        if ( scores.size() < A ) scores.resize(A);
+        bonus(exploration, count, V, N, Q, A, scores.data());
+
+        // We compute the scores first and look for the best one separately
+        // so that the loop above can be vectorized.
+        size_t best = 0;
+        for ( size_t a = 1; a < A; ++a )
+            if ( scores[a] > scores[best] ) best = a;
+        return best;
+    }
+}
+
+#endif
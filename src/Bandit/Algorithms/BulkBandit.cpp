@@ -0,0 +1,138 @@
+#include <AIToolbox/Bandit/Algorithms/BulkBandit.hpp>
+
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
+#include <AIToolbox/Bandit/Policies/Utils/QGreedyPolicyWrapper.hpp>
+#include <AIToolbox/Bandit/Policies/Utils/QSoftmaxPolicyWrapper.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace AIToolbox::Bandit {
+    BulkBandit::BulkBandit(const size_t n, const size_t a) :
+            N(n), A(a), q_(N, A), counts_(N * A, 0),
+            seed_(Impl::Seeder::getSeed()), batches_(0)
+    {
+        q_.setZero();
+    }
+
+    void BulkBandit::stepUpdateQ(const size_t i, const size_t a, const double rew) {
+        auto & count = counts_[i * A + a];
+        // Rolling average for this bandit arm, as in RollingAverage.
+        q_(i, a) = (count * q_(i, a) + rew) / (count + 1);
+        ++count;
+    }
+
+    void BulkBandit::stepUpdateQ(const std::vector<size_t> & bandits, const std::vector<size_t> & actions, const std::vector<double> & rewards, ThreadPool * pool) {
+        if ( bandits.size() != actions.size() || bandits.size() != rewards.size() )
+            throw std::invalid_argument("The batch of updates of BulkBandit has inputs of different sizes");
+
+        if ( !pool || pool->getThreadNumber() == 1 ) {
+            for ( size_t k = 0; k < bandits.size(); ++k )
+                stepUpdateQ(bandits[k], actions[k], rewards[k]);
+            return;
+        }
+
+        // We group the updates by bandit, keeping their order, so that
+        // each bandit can be updated by a single thread.
+        std::vector<size_t> order(bandits.size());
+        std::iota(std::begin(order), std::end(order), 0);
+        std::stable_sort(std::begin(order), std::end(order), [&bandits](const size_t lhs, const size_t rhs) {
+            return bandits[lhs] < bandits[rhs];
+        });
+
+        pool->parallelFor(order.size(), [&](size_t begin, size_t end) {
+            // Blocks are moved to the start of a bandit's updates, so that
+            // the updates of a bandit are all in the same block.
+            const auto sameBandit = [&](const size_t k) {
+                return k > 0 && k < order.size() && bandits[order[k]] == bandits[order[k-1]];
+            };
+            while ( sameBandit(begin) ) ++begin;
+            while ( sameBandit(end) ) ++end;
+
+            for ( size_t k = begin; k < end; ++k )
+                stepUpdateQ(bandits[order[k]], actions[order[k]], rewards[order[k]]);
+        });
+    }
+
+    template <typename F>
+    void BulkBandit::forEachBlock(const size_t size, ThreadPool * pool, F && f) {
+        const std::uint64_t batch = batches_++;
+        const auto run = [&](const size_t begin, const size_t end) {
+            auto rnd = makeEngineStream<RandomEngine>(seed_, (batch << 32) + begin / BlockSize);
+            f(rnd, begin, end);
+        };
+        if ( pool ) {
+            pool->parallelFor(size, BlockSize, run);
+        } else {
+            for ( size_t b = 0; b < size; b += BlockSize )
+                run(b, std::min(size, b + BlockSize));
+        }
+    }
+
+    void BulkBandit::sampleGreedyActions(const std::vector<size_t> & bandits, std::vector<size_t> * actions, ThreadPool * pool) {
+        actions->resize(bandits.size());
+        forEachBlock(bandits.size(), pool, [&](RandomEngine & rnd, const size_t begin, const size_t end) {
+            std::vector<size_t> buffer(A);
+            for ( size_t k = begin; k < end; ++k ) {
+                auto wrap = QGreedyPolicyWrapper(Eigen::Map<const Vector>(q_.row(bandits[k]).data(), A), buffer, rnd);
+                (*actions)[k] = wrap.sampleAction();
+            }
+        });
+    }
+
+    void BulkBandit::sampleSoftmaxActions(const std::vector<size_t> & bandits, const double temperature, std::vector<size_t> * actions, ThreadPool * pool) {
+        if ( temperature < 0.0 ) throw std::invalid_argument("Temperature must be >= 0");
+
+        actions->resize(bandits.size());
+        forEachBlock(bandits.size(), pool, [&](RandomEngine & rnd, const size_t begin, const size_t end) {
+            std::vector<size_t> buffer(A);
+            Vector vbuffer(A);
+            for ( size_t k = begin; k < end; ++k ) {
+                auto wrap = QSoftmaxPolicyWrapper(temperature, Eigen::Map<const Vector>(q_.row(bandits[k]).data(), A), vbuffer, buffer, rnd);
+                (*actions)[k] = wrap.sampleAction();
+            }
+        });
+    }
+
+    void BulkBandit::sampleThompsonActions(const std::vector<size_t> & bandits, std::vector<size_t> * actions, ThreadPool * pool) {
+        actions->resize(bandits.size());
+        forEachBlock(bandits.size(), pool, [&](RandomEngine & rnd, const size_t begin, const size_t end) {
+            std::normal_distribution<double> normal;
+            for ( size_t k = begin; k < end; ++k ) {
+                const auto i = bandits[k];
+                const auto counts = counts_.data() + i * A;
+
+                // Each arm is a Normal centered on its average, with a
+                // standard deviation of 1 / (count + 1).
+                size_t best = 0;
+                double bestValue = 0.0;
+                for ( size_t a = 0; a < A; ++a ) {
+                    const double v = q_(i, a) + normal(rnd) / (counts[a] + 1);
+                    if ( a == 0 || v > bestValue ) {
+                        best = a;
+                        bestValue = v;
+                    }
+                }
+                (*actions)[k] = best;
+            }
+        });
+    }
+
+    void BulkBandit::reset(const size_t i) {
+        q_.row(i).setZero();
+        std::fill(std::begin(counts_) + i * A, std::begin(counts_) + (i + 1) * A, 0);
+    }
+
+    void BulkBandit::reset() {
+        q_.setZero();
+        std::fill(std::begin(counts_), std::end(counts_), 0);
+    }
+
+    size_t BulkBandit::getN() const { return N; }
+    size_t BulkBandit::getA() const { return A; }
+    const Matrix2D & BulkBandit::getQFunctions() const { return q_; }
+    const std::vector<unsigned> & BulkBandit::getCounts() const { return counts_; }
+}
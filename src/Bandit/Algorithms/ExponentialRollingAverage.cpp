@@ -0,0 +1,37 @@
+#include <AIToolbox/Bandit/Algorithms/ExponentialRollingAverage.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace AIToolbox::Bandit {
+    ExponentialRollingAverage::ExponentialRollingAverage(const size_t A, const double decay) :
+            q_(A), weights_(A), counts_(A)
+    {
+        setDecay(decay);
+        q_.setZero();
+        weights_.setZero();
+    }
+
+    void ExponentialRollingAverage::stepUpdateQ(const size_t a, const double rew) {
+        weights_[a] = decay_ * weights_[a] + 1.0;
+        q_[a] += (rew - q_[a]) / weights_[a];
+        counts_[a] = weights_[a];
+    }
+
+    void ExponentialRollingAverage::reset() {
+        q_.setZero();
+        weights_.setZero();
+        std::fill(std::begin(counts_), std::end(counts_), 0);
+    }
+
+    void ExponentialRollingAverage::setDecay(const double decay) {
+        if ( decay <= 0.0 || decay > 1.0 ) throw std::invalid_argument("Decay must be in (0, 1]");
+        decay_ = decay;
+    }
+
+    double ExponentialRollingAverage::getDecay() const { return decay_; }
+    size_t ExponentialRollingAverage::getA() const { return counts_.size(); }
+    const QFunction & ExponentialRollingAverage::getQFunction() const { return q_; }
+    const std::vector<unsigned> & ExponentialRollingAverage::getCounts() const { return counts_; }
+    const Vector & ExponentialRollingAverage::getWeights() const { return weights_; }
+}
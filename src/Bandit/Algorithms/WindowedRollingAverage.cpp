@@ -0,0 +1,47 @@
+#include <AIToolbox/Bandit/Algorithms/WindowedRollingAverage.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace AIToolbox::Bandit {
+    WindowedRollingAverage::WindowedRollingAverage(const size_t A, const unsigned window) :
+            window_(window), q_(A), sums_(A), counts_(A),
+            rewards_(A, window), heads_(A)
+    {
+        if ( window_ == 0 ) throw std::invalid_argument("Window must be > 0");
+        reset();
+    }
+
+    void WindowedRollingAverage::stepUpdateQ(const size_t a, const double rew) {
+        auto & head = heads_[a];
+
+        if ( counts_[a] == window_ )
+            sums_[a] -= rewards_(a, head);
+        else
+            ++counts_[a];
+
+        rewards_(a, head) = rew;
+        sums_[a] += rew;
+
+        if ( ++head == window_ ) {
+            head = 0;
+            // Resync the sum to avoid accumulating rounding errors.
+            sums_[a] = rewards_.row(a).sum();
+        }
+
+        q_[a] = sums_[a] / counts_[a];
+    }
+
+    void WindowedRollingAverage::reset() {
+        q_.setZero();
+        sums_.setZero();
+        rewards_.setZero();
+        std::fill(std::begin(counts_), std::end(counts_), 0);
+        std::fill(std::begin(heads_), std::end(heads_), 0);
+    }
+
+    unsigned WindowedRollingAverage::getWindow() const { return window_; }
+    size_t WindowedRollingAverage::getA() const { return counts_.size(); }
+    const QFunction & WindowedRollingAverage::getQFunction() const { return q_; }
+    const std::vector<unsigned> & WindowedRollingAverage::getCounts() const { return counts_; }
+}
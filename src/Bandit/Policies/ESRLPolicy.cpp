@@ -9,21 +9,27 @@ namespace AIToolbox::Bandit {
         timestep_(0), N_(timesteps),
         explorations_(0), explorationPhases_(explorationPhases),
         average_(0.0), window_(window),
-        values_(A), allowedActions_(A),
+        values_(A), allowedActions_(A), positions_(A),
         lri_(A, a)
     {
         values_.setZero();
+        allowAll();
+    }
+
+    void ESRLPolicy::allowAll() {
+        allowedActions_.resize(A);
         std::iota(std::begin(allowedActions_), std::end(allowedActions_), 0);
+        std::iota(std::begin(positions_), std::end(positions_), 0);
     }
 
     void ESRLPolicy::stepUpdateP(size_t a, bool result) {
         if (explorations_ < explorationPhases_) {
             // Check that the action was in our allowed ones.
-            const auto it = std::find(std::begin(allowedActions_), std::end(allowedActions_), a);
-            if (it == std::end(allowedActions_))
+            const auto pos = positions_[a];
+            if (pos == A)
                 return;
             // Exploration phase
-            lri_.stepUpdateP(std::distance(std::begin(allowedActions_), it), result);
+            lri_.stepUpdateP(pos, result);
 
             ++timestep_;
             // Note that the paper contains an error here. It says that you
@@ -60,11 +66,13 @@ namespace AIToolbox::Bandit {
                 // If we have more than one allowed action, we remove it.
                 // Otherwise, we reset to allowing the whole spectrum.
                 if (allowedActions_.size() > 1) {
-                    std::swap(allowedActions_[convergedActionLri], allowedActions_[allowedActions_.size()-1]);
+                    const auto last = allowedActions_.back();
+                    allowedActions_[convergedActionLri] = last;
+                    positions_[last] = convergedActionLri;
+                    positions_[convergedAction] = A;
                     allowedActions_.pop_back();
                 } else {
-                    allowedActions_.resize(A);
-                    std::iota(std::begin(allowedActions_), std::end(allowedActions_), 0);
+                    allowAll();
                 }
 
                 lri_ = LRPPolicy(allowedActions_.size(), lri_.getAParam());
@@ -88,11 +96,11 @@ namespace AIToolbox::Bandit {
     double ESRLPolicy::getActionProbability(const size_t & a) const {
         if (exploit_) return a == bestAction_;
 
-        const auto it = std::find(std::begin(allowedActions_), std::end(allowedActions_), a);
-        if (it == std::end(allowedActions_))
+        const auto pos = positions_[a];
+        if (pos == A)
             return 0.0;
 
-        return lri_.getActionProbability(std::distance(std::begin(allowedActions_), it));
+        return lri_.getActionProbability(pos);
     }
 
     Vector ESRLPolicy::getPolicy() const {
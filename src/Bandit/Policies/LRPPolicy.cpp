@@ -3,41 +3,67 @@
 #include <AIToolbox/Utils/Probability.hpp>
 
 namespace AIToolbox::Bandit {
+    // Below this scale, we fold it into the weights to avoid underflows.
+    constexpr double MinScale = 1e-30;
+
     LRPPolicy::LRPPolicy(size_t A, double a, double b) :
         Base(A),
-        a_(a), invB_(1.0 - b), divB_(b / (A - 1)), policy_(A)
+        a_(a), weights_(A), scale_(1.0), offset_(0.0)
     {
-        policy_.fill(1.0 / A);
+        setBParam(b);
+        weights_.fill(1.0 / A);
     }
 
     void LRPPolicy::stepUpdateP(size_t act, bool result) {
         if (result) {
-            policy_[act] += a_ * (1.0 - policy_[act]);
-            for (size_t i = 0; i < static_cast<size_t>(policy_.size()); ++i)
-                if (i != act)
-                    policy_[i] -= a_ * policy_[i];
+            // All probabilities are scaled by (1-a), and the action taken
+            // gets an additional a.
+            scale_ *= 1.0 - a_;
+            offset_ *= 1.0 - a_;
+            weights_[act] += a_ / scale_;
         } else {
-            policy_[act] *= invB_;
-            for (size_t i = 0; i < static_cast<size_t>(policy_.size()); ++i)
-                if (i != act)
-                    policy_[i] = divB_ + invB_ * policy_[i];
+            // All probabilities are scaled by (1-b), and all actions except
+            // the one taken get an additional b / (|A|-1).
+            scale_ *= invB_;
+            offset_ = offset_ * invB_ + divB_;
+            weights_[act] -= divB_ / scale_;
         }
+
+        if (scale_ < MinScale) normalize();
+    }
+
+    void LRPPolicy::normalize() {
+        weights_ = (scale_ * weights_.array() + offset_).matrix();
+        scale_ = 1.0;
+        offset_ = 0.0;
     }
 
     size_t LRPPolicy::sampleAction() const {
-        return sampleProbability(A, policy_, rand_);
+        double p = probabilityDistribution(rand_);
+
+        for ( size_t i = 0; i < A; ++i ) {
+            const double v = scale_ * weights_[i] + offset_;
+            if ( v > p ) return i;
+            p -= v;
+        }
+        return A - 1;
     }
 
     double LRPPolicy::getActionProbability(const size_t & a) const {
-        return policy_[a];
+        return scale_ * weights_[a] + offset_;
     }
 
     Vector LRPPolicy::getPolicy() const {
-        return policy_;
+        return (scale_ * weights_.array() + offset_).matrix();
     }
 
     void LRPPolicy::setAParam(double a) { a_ = a; }
     double LRPPolicy::getAParam() const { return a_; }
-    void LRPPolicy::setBParam(double b) { invB_ = 1.0 - b; divB_ = b / (A - 1); }
+    void LRPPolicy::setBParam(double b) {
+        invB_ = 1.0 - b;
+        // With a single action the failure update has no other actions to
+        // distribute b to.
+        divB_ = A > 1 ? b / (A - 1) : 0.0;
+    }
     double LRPPolicy::getBParam() const { return 1.0 - invB_; }
 }
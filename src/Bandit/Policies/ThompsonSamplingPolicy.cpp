@@ -1,103 +1,140 @@
 #include <AIToolbox/Bandit/Policies/ThompsonSamplingPolicy.hpp>
 
-#include <random>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace AIToolbox::Bandit {
+    // Number of standard deviations after which we consider a Normal
+    // distribution to have no more mass.
+    constexpr double Width = 6.0;
+    // Number of grid points per standard deviation of the narrowest arm.
+    constexpr double GridResolution = 8.0;
+    // Upper bound on the grid size, to bound the cost of getPolicy().
+    constexpr size_t MaxGrid = 1 << 14;
+
+    constexpr double Sqrt2 = 1.41421356237309504880;
+    constexpr double InvSqrt2Pi = 0.39894228040143267794;
+
     ThompsonSamplingPolicy::ThompsonSamplingPolicy(const QFunction & q, const std::vector<unsigned> & counts) :
-            Base(q.size()), q_(q), counts_(counts) {}
+            Base(q.size()), q_(q), counts_(counts),
+            stdDevs_(A), values_(A), cached_(false) {}
 
-    size_t ThompsonSamplingPolicy::sampleAction() const {
-        size_t bestAction = 0;
-        double bestValue;
-        {
-            std::normal_distribution<double> dist(q_[0], 1.0 / (counts_[0] + 1));
-            bestValue = dist(rand_);
-        }
-        for ( size_t a = 1; a < A; ++a ) {
-            std::normal_distribution<double> dist(q_[a], 1.0 / (counts_[a] + 1));
-            const auto val = dist(rand_);
+    void ThompsonSamplingPolicy::computeStdDevs() const {
+        for ( size_t a = 0; a < A; ++a )
+            stdDevs_[a] = 1.0 / (counts_[a] + 1);
+    }
 
-            if ( val > bestValue ) {
-                bestAction = a;
-                bestValue = val;
-            }
-        }
+    size_t ThompsonSamplingPolicy::sampleWithStdDevs() const {
+        for ( size_t a = 0; a < A; ++a )
+            values_[a] = normal_(rand_);
 
+        values_ = q_ + values_.cwiseProduct(stdDevs_);
+
+        Eigen::Index bestAction;
+        values_.maxCoeff(&bestAction);
         return bestAction;
     }
 
+    size_t ThompsonSamplingPolicy::sampleAction() const {
+        computeStdDevs();
+        return sampleWithStdDevs();
+    }
+
+    void ThompsonSamplingPolicy::sampleActions(const size_t n, std::vector<size_t> * actions) const {
+        computeStdDevs();
+
+        actions->resize(n);
+        for ( size_t i = 0; i < n; ++i )
+            (*actions)[i] = sampleWithStdDevs();
+    }
+
     double ThompsonSamplingPolicy::getActionProbability(const size_t & a) const {
-        // The true formula here would be:
-        //
-        // \int_{-infty, +infty} PDF(N(a)) * CDF(N(0)) * ... * CDF(N(A-1))
-        //
-        // Where N(x) means the normal distribution obtained from the
-        // parameters of that action.
-        //
-        // Instead we sample, which is easier and possibly faster if we just
-        // want a rough approximation.
-        constexpr unsigned trials = 100000;
-        unsigned selected = 0;
-
-        // We avoid recreating the distributions thousands of times here.
-        std::vector<std::normal_distribution<double>> dists;
-        dists.reserve(A);
-
-        for (size_t aa = 0; aa < A; ++aa)
-            dists.emplace_back(q_[aa], 1.0 / (counts_[aa] + 1));
-
-        for (size_t i = 0; i < trials; ++i) {
-            size_t bestAction = 0;
-            double bestValue = dists[0](rand_);
-            for ( size_t aa = 1; aa < A; ++aa ) {
-                const auto val = dists[aa](rand_);
-
-                if ( val > bestValue ) {
-                    bestAction = aa;
-                    bestValue = val;
-                }
-            }
-            if (bestAction == a) ++selected;
-        }
-        return static_cast<double>(selected) / trials;
+        getPolicy();
+        return cachedPolicy_[a];
     }
 
     Vector ThompsonSamplingPolicy::getPolicy() const {
-        // The true formula here would be:
-        //
-        // \int_{-infty, +infty} PDF(N(a)) * CDF(N(0)) * ... * CDF(N(A-1))
-        //
-        // Where N(x) means the normal distribution obtained from the
-        // parameters of that action.
-        //
-        // Instead we sample, which is easier and possibly faster if we just
-        // want a rough approximation.
-        constexpr unsigned trials = 100000;
-
-        Vector retval{A};
+        if ( cached_ && cachedQ_ == q_ && cachedCounts_ == counts_ )
+            return cachedPolicy_;
+
+        computeStdDevs();
+
+        Vector retval(A);
         retval.setZero();
 
-        // We avoid recreating the distributions thousands of times here.
-        std::vector<std::normal_distribution<double>> dists;
-        dists.reserve(A);
+        // All values below this are beaten with high probability by at
+        // least one arm, so we can skip them.
+        const double lo = (q_ - Width * stdDevs_).maxCoeff();
 
-        for (size_t aa = 0; aa < A; ++aa)
-            dists.emplace_back(q_[aa], 1.0 / (counts_[aa] + 1));
+        std::vector<size_t> candidates;
+        double hi = lo, minStdDev = std::numeric_limits<double>::infinity();
+        for ( size_t a = 0; a < A; ++a ) {
+            const double top = q_[a] + Width * stdDevs_[a];
+            if ( top <= lo ) continue;
 
-        for (size_t i = 0; i < trials; ++i) {
-            size_t bestAction = 0;
-            double bestValue = dists[0](rand_);
-            for ( size_t aa = 1; aa < A; ++aa ) {
-                const auto val = dists[aa](rand_);
+            candidates.push_back(a);
+            hi = std::max(hi, top);
+            minStdDev = std::min(minStdDev, stdDevs_[a]);
+        }
 
-                if ( val > bestValue ) {
-                    bestAction = aa;
-                    bestValue = val;
+        if ( candidates.size() == 1 ) {
+            retval[candidates[0]] = 1.0;
+        } else {
+            const size_t G = std::clamp<size_t>(std::ceil((hi - lo) / minStdDev * GridResolution) + 1, 3, MaxGrid);
+            const double step = (hi - lo) / (G - 1);
+
+            const auto cdf = [&](const size_t a, const double x) {
+                return 0.5 * std::erfc((q_[a] - x) / (stdDevs_[a] * Sqrt2));
+            };
+
+            // For each grid point, the log of the product of the CDFs of
+            // all candidates, and the number of CDFs which are exactly zero
+            // (which we cannot take the log of).
+            std::vector<double> logProducts(G, 0.0);
+            std::vector<unsigned> zeros(G, 0);
+            for ( const auto a : candidates ) {
+                for ( size_t k = 0; k < G; ++k ) {
+                    const double c = cdf(a, lo + k * step);
+                    if ( c > 0.0 ) logProducts[k] += std::log(c);
+                    else ++zeros[k];
                 }
             }
-            retval[bestAction] += 1.0;
+
+            // Trapezoidal integration of PDF(a) times the product of all
+            // other CDFs.
+            for ( const auto a : candidates ) {
+                const double norm = InvSqrt2Pi / stdDevs_[a];
+                double p = 0.0;
+                for ( size_t k = 0; k < G; ++k ) {
+                    const double x = lo + k * step;
+                    const double c = cdf(a, x);
+
+                    double others;
+                    if ( c > 0.0 ) others = zeros[k] ? 0.0 : std::exp(logProducts[k] - std::log(c));
+                    else           others = zeros[k] > 1 ? 0.0 : std::exp(logProducts[k]);
+
+                    const double z = (x - q_[a]) / stdDevs_[a];
+                    const double v = norm * std::exp(-0.5 * z * z) * others;
+                    p += (k == 0 || k == G - 1) ? 0.5 * v : v;
+                }
+                retval[a] = p * step;
+            }
+
+            const double sum = retval.sum();
+            if ( sum > 0.0 ) {
+                retval /= sum;
+            } else {
+                for ( const auto a : candidates )
+                    retval[a] = 1.0 / candidates.size();
+            }
         }
-        retval /= retval.sum();
+
+        cachedQ_ = q_;
+        cachedCounts_ = counts_;
+        cachedPolicy_ = retval;
+        cached_ = true;
+
         return retval;
     }
 }
@@ -1,11 +1,10 @@
 #include <AIToolbox/Factored/Bandit/Algorithms/LLR.hpp>
 
 #include <AIToolbox/Factored/Utils/Core.hpp>
-#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
 
 namespace AIToolbox::Factored::Bandit {
     LLR::LLR(Action a, const std::vector<Factors> & dependencies) :
-            A(std::move(a)), L(1), timestep_(0), rules_(A)
+            A(std::move(a)), L(1), timestep_(0), rules_(A), ve_(A)
     {
         // Note: L = 1 since we only do 1 action at a time.
 
@@ -13,6 +12,10 @@ namespace AIToolbox::Factored::Bandit {
         // This allows us to allocate the rules_ only once, and to just
         // update their values at each timestep.
         for (const auto & agents : dependencies) {
+            groupKeys_.push_back(agents);
+            groupStrides_.push_back(FactorSpace(A, agents).getStrides());
+            groupOffsets_.push_back(rules_.size());
+
             PartialFactorsEnumerator enumerator(A, agents);
             while (enumerator.isValid()) {
                 const auto & pAction = *enumerator;
@@ -22,19 +25,22 @@ namespace AIToolbox::Factored::Bandit {
                 enumerator.advance();
             }
         }
-        averages_.resize(rules_.size());
+        means_.resize(rules_.size(), 0.0);
+        counts_.resize(rules_.size(), 0);
     }
 
     Action LLR::stepUpdateQ(const Action & a, const Rewards & rew) {
-        // We use the rules_'s Trie in order to obtain the ids of the
-        // actions we need to update. We keep in sync the rules_ container
-        // with the averages_ vector, so that we can use the Trie's ids for
-        // both.
-        const auto filtered = rules_.getTrie().filter(a, 0);
-        size_t i = 0;
-        // We update the averages/counts based on the obtained rewards.
-        for (const auto id : filtered)
-            averages_[id].value += (rew[i++] - averages_[id].value) / (++averages_[id].count);
+        // Each group has exactly one local joint action matching the
+        // input, and the rules of each group are stored contiguously in
+        // the order of their indeces. So we can directly compute the id of
+        // each matching rule, and update its average and count.
+        for (size_t g = 0; g < groupKeys_.size(); ++g) {
+            size_t id = groupOffsets_[g];
+            for (size_t k = 0; k < groupKeys_[g].size(); ++k)
+                id += a[groupKeys_[g][k]] * groupStrides_[g][k];
+
+            means_[id] += (rew[g] - means_[id]) / (++counts_[id]);
+        }
 
         ++timestep_;
         const auto LtLog = (L+1) * std::log(timestep_);
@@ -43,20 +49,19 @@ namespace AIToolbox::Factored::Bandit {
         // and counts.
         for (size_t i = 0; i < rules_.size(); ++i) {
             // We give rules we haven't seen yet a headstart so they'll get picked first
-            if (averages_[i].count == 0)
+            if (counts_[i] == 0)
                 rules_[i].value = 1000000.0;
             else
-                rules_[i].value = averages_[i].value + std::sqrt(LtLog / averages_[i].count);
+                rules_[i].value = means_[i] + std::sqrt(LtLog / counts_[i]);
         }
 
-        VariableElimination ve(A);
-        return std::get<0>(ve(rules_));
+        return std::get<0>(ve_(rules_));
     }
 
     FactoredContainer<QFunctionRule> LLR::getQFunctionRules() const {
         auto rulesCopy = rules_;
         for (size_t i = 0; i < rulesCopy.size(); ++i)
-            rulesCopy[i].value = averages_[i].value;
+            rulesCopy[i].value = means_[i];
         return rulesCopy;
     }
 }
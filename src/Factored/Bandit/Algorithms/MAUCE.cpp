@@ -7,7 +7,7 @@
 namespace AIToolbox::Factored::Bandit {
     MAUCE::MAUCE(Action aa, const std::vector<std::pair<double, std::vector<size_t>>> & rangesAndDependencies) :
             A(std::move(aa)), timestep_(0),
-            averages_(A), logA_(0.0)
+            logA_(0.0), ucve_(A, 0.0)
     {
         // Compute log(|A|) without needing to compute |A| which may be too
         // big. We'll use it later to obtain log(t |A|)
@@ -18,38 +18,47 @@ namespace AIToolbox::Factored::Bandit {
         // This allows us to allocate the rules_ only once, and to just
         // update their values at each timestep.
         for (const auto & dependency : rangesAndDependencies) {
-            PartialFactorsEnumerator enumerator(A, dependency.second);
+            PartialKeys agents(std::begin(dependency.second), std::end(dependency.second));
+
+            groupStrides_.push_back(FactorSpace(A, agents).getStrides());
+            groupOffsets_.push_back(rules_.size());
+
+            PartialFactorsEnumerator enumerator(A, agents);
             while (enumerator.isValid()) {
                 const auto & pAction = *enumerator;
 
-                averages_.emplace(pAction, Average{ 0.0, 0, dependency.first * dependency.first });
                 rules_.emplace_back(pAction, UCVE::V());
+                rangesSquared_.push_back(dependency.first * dependency.first);
 
                 enumerator.advance();
             }
+            groupKeys_.push_back(std::move(agents));
         }
+        means_.resize(rules_.size(), 0.0);
+        counts_.resize(rules_.size(), 0);
     }
 
     Action MAUCE::stepUpdateQ(const Action & a, const Rewards & rew) {
         AI_LOGGER(AI_SEVERITY_INFO, "Updating averages...");
 
-        // Update all averages with what we've learned this step.  Note: We
-        // know that the factors are going to be in the correct order when
-        // looping here since we are looping in the same order in which we
-        // have inserted them into the averages_ container, and filter
-        // returns sorted lists. So we can correctly match the rewards with
-        // the agent groups!
-        size_t i = 0;
-        auto filtered = averages_.filter(a);
-        for (auto & avg : filtered)
-            avg.value += (rew[i++] - avg.value) / (++avg.count);
+        // Update all averages with what we've learned this step. Each group
+        // has exactly one local joint action matching the input, and its
+        // rules are stored contiguously in the order of their indeces, so
+        // we can directly compute the id of each matching one.
+        for (size_t g = 0; g < groupKeys_.size(); ++g) {
+            size_t id = groupOffsets_[g];
+            for (size_t k = 0; k < groupKeys_[g].size(); ++k)
+                id += a[groupKeys_[g][k]] * groupStrides_[g][k];
+
+            means_[id] += (rew[g] - means_[id]) / (++counts_[id]);
+        }
 
         // Build the vectors to pass to UCVE
         AI_LOGGER(AI_SEVERITY_INFO, "Building vectors...");
-        for (size_t i = 0; i < averages_.size(); ++i) {
-            const double count = averages_[i].count ? averages_[i].count : 0.00001;
-            std::get<1>(rules_[i])[0] = averages_[i].value;
-            std::get<1>(rules_[i])[1] = averages_[i].rangeSquared / count;
+        for (size_t i = 0; i < rules_.size(); ++i) {
+            const double count = counts_[i] ? counts_[i] : 0.00001;
+            std::get<1>(rules_[i])[0] = means_[i];
+            std::get<1>(rules_[i])[1] = rangesSquared_[i] / count;
         }
 
         // Update the timestep, and finish computing log(t |A|) for this
@@ -57,10 +66,10 @@ namespace AIToolbox::Factored::Bandit {
         ++timestep_;
         const auto logtA = logA_ + std::log(timestep_);
 
-        // Create and run UCVE
+        // Run UCVE
         AI_LOGGER(AI_SEVERITY_INFO, "Now running UCVE...");
-        UCVE ucve(A, logtA);
-        auto a_v = ucve(rules_);
+        ucve_.setLogtA(logtA);
+        auto a_v = ucve_(rules_);
         AI_LOGGER(AI_SEVERITY_INFO, "Done.");
 
         // We convert the output (PartialAction) to a normal action.
@@ -68,12 +77,13 @@ namespace AIToolbox::Factored::Bandit {
     }
 
     FactoredContainer<QFunctionRule> MAUCE::getQFunctionRules() const {
-        FactoredContainer<QFunctionRule>::ItemsContainer container;
+        FactoredContainer<QFunctionRule> container(A);
+        container.reserve(rules_.size());
 
-        for (size_t i = 0; i < averages_.size(); ++i)
-            container.emplace_back(std::get<0>(rules_[i]), averages_[i].value);
+        for (size_t i = 0; i < rules_.size(); ++i)
+            container.emplace(std::get<0>(rules_[i]), std::get<0>(rules_[i]), means_[i]);
 
-        return FactoredContainer<QFunctionRule>(averages_.getTrie(), std::move(container));
+        return container;
     }
 
     unsigned MAUCE::getTimestep() const { return timestep_; }
@@ -1,15 +1,28 @@
 #include <AIToolbox/Factored/Bandit/Algorithms/Utils/MultiObjectiveVariableElimination.hpp>
 
 #include <algorithm>
-
-#include <boost/iterator/transform_iterator.hpp>
+#include <limits>
+#include <numeric>
 
 #include <AIToolbox/Utils/Core.hpp>
-#include <AIToolbox/Utils/Prune.hpp>
 
 namespace AIToolbox::Factored::Bandit {
     using MOVE = MultiObjectiveVariableElimination;
 
+    // The minimum number of joint actions enumerated in a single
+    // elimination for it to be split between the threads of the pool.
+    constexpr size_t ParallelWork = 64;
+
+    /**
+     * @brief This function removes all entries dominated by another on all objectives.
+     *
+     * Entries equal to a previous one are also removed. The remaining
+     * entries keep their relative order.
+     *
+     * @param entries The entries to prune.
+     */
+    void prune(MOVE::Entries * entries);
+
     /**
      * @brief This function cross-sums the input lists.
      *
@@ -66,25 +79,31 @@ namespace AIToolbox::Factored::Bandit {
 
     // -----------------------
 
-    MOVE::MultiObjectiveVariableElimination(Action a) : A(std::move(a)), graph_(A.size()) {}
+    MOVE::MultiObjectiveVariableElimination(Action a) : A(std::move(a)), graph_(A.size()), order_(A), pool_(nullptr) {}
+
+    void MOVE::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * MOVE::getThreadPool() const { return pool_; }
+
+    void MOVE::setEliminationHeuristic(const EliminationOrder::Heuristic heuristic) { order_.setHeuristic(heuristic); }
+    EliminationOrder::Heuristic MOVE::getEliminationHeuristic() const { return order_.getHeuristic(); }
 
     MOVE::Results MOVE::start() {
-        // This can possibly be improved with some heuristic ordering
-        while (graph_.variableSize())
-            removeAgent(graph_.variableSize() - 1);
+        for (const auto agent : order_(graph_))
+            removeAgent(agent);
+
+        // We reset the graph, so that this instance can be reused with the
+        // same cached elimination order and without reallocating factors.
+        const auto finalFactors = std::move(finalFactors_);
+        finalFactors_.clear();
+        graph_.reset();
 
         Results retval;
-        if (finalFactors_.size() == 0) return retval;
+        if (finalFactors.size() == 0) return retval;
 
-        for (const auto & fValue : finalFactors_)
+        for (const auto & fValue : finalFactors)
             retval = crossSum(retval, fValue);
 
-        // P1 pruning
-        const auto unwrap = +[](Entry & e) -> Rewards & {return std::get<1>(e);};
-        const auto rbegin = boost::make_transform_iterator(std::begin(retval), unwrap);
-        const auto rend   = boost::make_transform_iterator(std::end  (retval), unwrap);
-
-        retval.erase(AIToolbox::extractDominated(unwrap(retval[0]).size(), rbegin, rend).base(), std::end(retval));
+        prune(&retval);
 
         return retval;
     }
@@ -93,75 +112,117 @@ namespace AIToolbox::Factored::Bandit {
         const auto factors = graph_.getNeighbors(agent);
         auto agents = graph_.getNeighbors(factors);
 
-        Rules newRules;
-        PartialFactorsEnumerator jointActions(A, agents, agent);
+        const PartialFactorsEnumerator jointActions(A, agents, agent);
         const auto id = jointActions.getFactorToSkipId();
+        const size_t N = jointActions.size();
 
         const bool isFinalFactor = agents.size() == 1;
 
-        while (jointActions.isValid()) {
-            auto & jointAction = *jointActions;
-
-            Entries values;
-            for (size_t agentAction = 0; agentAction < A[agent]; ++agentAction) {
-                jointAction.second[id] = agentAction;
-
-                Entries newEntries;
-                // So the idea here is that we are computing results for
-                // this particular subset of agents. Here we are working
-                // with a single action. However, we may have eliminated
-                // agents already. This means that this factor will contain
-                // a certain number of rules, which depend on different
-                // "already taken" actions of the eliminated agents.
-                //
-                // During normal VE, we can simply add up all tags since
-                // they can't possibly conflict (due to the max operator
-                // which always makes us pick the best one). Here instead,
-                // payoffs returned by the getPayoffs function can't get
-                // squashed into a single one and summed, since their tags
-                // are no longer guaranteed unique.
-                //
-                // Thus we get them all, and during the cross/sum we create
-                // even more rules, joining their tags together, and
-                // possibly merge them if we see equal ones.
-                for (size_t i = 0; i < factors.size(); ++i) {
-                    newEntries = crossSum(newEntries, getPayoffs(factors[i]->getVariables(), factors[i]->getData().rules, jointAction));
-                    // p3.prune(&newEntries);
-                }
+        // The entries found for each joint action, in the order of the
+        // enumeration (skipping the agent to eliminate). Each joint action
+        // is independent, so they can be computed in parallel.
+        std::vector<Entries> results(N);
+
+        const auto process = [&](const size_t begin, const size_t end) {
+            // Decode the first joint action of the range.
+            PartialAction jointAction{agents, PartialValues(agents.size(), 0)};
+            for (size_t i = 0, n = begin; i < agents.size(); ++i) {
+                if (i == id) continue;
+                jointAction.second[i] = n % A[agents[i]];
+                n /= A[agents[i]];
+            }
+
+            for (size_t n = begin; n < end; ++n) {
+                auto & values = results[n];
+                for (size_t agentAction = 0; agentAction < A[agent]; ++agentAction) {
+                    jointAction.second[id] = agentAction;
+
+                    Entries newEntries;
+                    // So the idea here is that we are computing results for
+                    // this particular subset of agents. Here we are working
+                    // with a single action. However, we may have eliminated
+                    // agents already. This means that this factor will contain
+                    // a certain number of rules, which depend on different
+                    // "already taken" actions of the eliminated agents.
+                    //
+                    // During normal VE, we can simply add up all tags since
+                    // they can't possibly conflict (due to the max operator
+                    // which always makes us pick the best one). Here instead,
+                    // payoffs returned by the getPayoffs function can't get
+                    // squashed into a single one and summed, since their tags
+                    // are no longer guaranteed unique.
+                    //
+                    // Thus we get them all, and during the cross/sum we create
+                    // even more rules, joining their tags together. Since
+                    // they are all alternatives for the same joint action,
+                    // we can prune the dominated ones.
+                    for (size_t i = 0; i < factors.size(); ++i) {
+                        const auto size = newEntries.size();
+                        newEntries = crossSum(newEntries, getPayoffs(factors[i]->getVariables(), factors[i]->getData().rules, jointAction));
+                        if (newEntries.size() > size) prune(&newEntries);
+                    }
 
-                if (newEntries.size() != 0) {
-                    // Add tags
-                    for (auto & nv : newEntries) {
-                        auto & first  = std::get<0>(nv).first;
-                        auto & second = std::get<0>(nv).second;
+                    if (newEntries.size() != 0) {
+                        // Add tags
+                        for (auto & nv : newEntries) {
+                            auto & first  = std::get<0>(nv).first;
+                            auto & second = std::get<0>(nv).second;
 
-                        size_t i = 0;
-                        while (i < first.size() && first[i] < agent) ++i;
+                            size_t i = 0;
+                            while (i < first.size() && first[i] < agent) ++i;
 
-                        first.insert(std::begin(first) + i, agent);
-                        second.insert(std::begin(second) + i, agentAction);
+                            first.insert(std::begin(first) + i, agent);
+                            second.insert(std::begin(second) + i, agentAction);
+                        }
+                        values.insert(std::end(values), std::make_move_iterator(std::begin(newEntries)),
+                                                        std::make_move_iterator(std::end(newEntries)));
                     }
-                    values.insert(std::end(values), std::make_move_iterator(std::begin(newEntries)),
-                                                    std::make_move_iterator(std::end(newEntries)));
+                }
+                // The entries for the different actions of the agent are
+                // alternatives too.
+                prune(&values);
+
+                // Move to the next joint action.
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction.second[i] < A[agents[i]]) break;
+                    jointAction.second[i] = 0;
                 }
             }
+        };
+
+        // Only large eliminations are worth splitting between threads.
+        if (pool_ && N >= ParallelWork)
+            pool_->parallelFor(N, process);
+        else
+            process(0, N);
 
-            // p2.prune(&values);
-
-            if (values.size() != 0) {
-                // If this is a final factor we do the alternative path
-                // here, to avoid copying joint actions which we won't
-                // really need anymore.
-                if (!isFinalFactor) {
-                    newRules.emplace_back(PartialValues(), std::move(values));
-                    newRules.back().first.reserve(agents.size() - 1);
-                    for (size_t a = 0; a < agents.size(); ++a)
-                        if (a != id) newRules.back().first.push_back(jointAction.second[a]);
-                } else {
-                    finalFactors_.emplace_back(std::move(values));
+        Rules newRules;
+        {
+            // Rebuild the joint actions of the remaining agents, in the
+            // same order as they were enumerated.
+            PartialValues jointAction(agents.size(), 0);
+            for (size_t n = 0; n < N; ++n) {
+                auto & values = results[n];
+                if (values.size() != 0) {
+                    // If this is a final factor we do the alternative path
+                    // here, to avoid copying joint actions which we won't
+                    // really need anymore.
+                    if (!isFinalFactor) {
+                        newRules.emplace_back(PartialValues(), std::move(values));
+                        newRules.back().first.reserve(agents.size() - 1);
+                        for (size_t a = 0; a < agents.size(); ++a)
+                            if (a != id) newRules.back().first.push_back(jointAction[a]);
+                    } else {
+                        finalFactors_.emplace_back(std::move(values));
+                    }
+                }
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction[i] < A[agents[i]]) break;
+                    jointAction[i] = 0;
                 }
             }
-            jointActions.advance();
         }
 
         for (auto & it : factors)
@@ -209,6 +270,7 @@ namespace AIToolbox::Factored::Bandit {
                 retval.emplace_back(std::move(rhs[j++]));
             else {
                 retval.emplace_back(lhs[i].first, crossSum(lhs[i].second, rhs[j].second));
+                prune(&retval.back().second);
                 ++i; ++j;
             }
         }
@@ -262,4 +324,68 @@ namespace AIToolbox::Factored::Bandit {
         }
         return retval;
     }
+
+    void prune(MOVE::Entries * entriesp) {
+        auto & entries = *entriesp;
+        if (entries.size() < 2) return;
+
+        const auto O = std::get<1>(entries[0]).size();
+
+        // An entry can only be dominated by entries which come first in
+        // this order, as all their objectives are at least as large.
+        std::vector<size_t> order(entries.size());
+        std::iota(std::begin(order), std::end(order), 0);
+
+        std::vector<bool> keep(entries.size(), false);
+        if (O == 2) {
+            std::stable_sort(std::begin(order), std::end(order), [&entries](const size_t lhs, const size_t rhs) {
+                const auto & l = std::get<1>(entries[lhs]);
+                const auto & r = std::get<1>(entries[rhs]);
+                return l[0] > r[0] || (l[0] == r[0] && l[1] > r[1]);
+            });
+            // All previous entries are at least as good on the first
+            // objective, so an entry is only kept if it improves on the
+            // second.
+            double best = std::numeric_limits<double>::lowest();
+            for (const auto i : order) {
+                const auto v = std::get<1>(entries[i])[1];
+                if (v > best) {
+                    keep[i] = true;
+                    best = v;
+                }
+            }
+        } else {
+            std::vector<double> sums(entries.size());
+            for (size_t i = 0; i < entries.size(); ++i)
+                sums[i] = std::get<1>(entries[i]).sum();
+
+            std::stable_sort(std::begin(order), std::end(order), [&sums](const size_t lhs, const size_t rhs) {
+                return sums[lhs] > sums[rhs];
+            });
+
+            std::vector<size_t> front;
+            for (const auto i : order) {
+                const auto & v = std::get<1>(entries[i]);
+                bool dominated = false;
+                for (const auto j : front) {
+                    if ((std::get<1>(entries[j]).array() >= v.array()).all()) {
+                        dominated = true;
+                        break;
+                    }
+                }
+                if (!dominated) {
+                    keep[i] = true;
+                    front.push_back(i);
+                }
+            }
+        }
+
+        size_t j = 0;
+        for (size_t i = 0; i < entries.size(); ++i)
+            if (keep[i]) {
+                if (i != j) entries[j] = std::move(entries[i]);
+                ++j;
+            }
+        entries.resize(j);
+    }
 }
@@ -8,6 +8,10 @@
 #include <boost/iterator/transform_iterator.hpp>
 
 namespace AIToolbox::Factored::Bandit {
+    // The minimum number of joint actions enumerated in a single
+    // elimination for it to be split between the threads of the pool.
+    constexpr size_t ParallelWork = 256;
+
     /**
      * @brief This function cross-sums the input lists.
      *
@@ -63,22 +67,37 @@ namespace AIToolbox::Factored::Bandit {
     UCVE::Rules mergePayoffs(UCVE::Rules && lhs, UCVE::Rules && rhs);
 
     // We half the logtA since we always need to multiply it with 1/2 anyway.
-    UCVE::UCVE(Action a, double logtA) : A(std::move(a)), graph_(A.size()), logtA_(logtA * 0.5) {}
+    UCVE::UCVE(Action a, double logtA) : A(std::move(a)), graph_(A.size()), order_(A), logtA_(logtA * 0.5), pool_(nullptr) {}
+
+    void UCVE::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * UCVE::getThreadPool() const { return pool_; }
+
+    void UCVE::setEliminationHeuristic(const EliminationOrder::Heuristic heuristic) { order_.setHeuristic(heuristic); }
+    EliminationOrder::Heuristic UCVE::getEliminationHeuristic() const { return order_.getHeuristic(); }
+
+    void UCVE::setLogtA(const double logtA) { logtA_ = logtA * 0.5; }
+    double UCVE::getLogtA() const { return logtA_ * 2.0; }
 
     // We use this to compute the UCB value given a bound
     double computeValue(const UCVE::Entry & e, const double x, const double logtA);
 
     UCVE::Result UCVE::start() {
-        // This can possibly be improved with some heuristic ordering
-        while (graph_.variableSize())
-            removeAgent(graph_.variableSize() - 1);
+        for (const auto agent : order_(graph_))
+            removeAgent(agent);
 
         AI_LOGGER(AI_SEVERITY_DEBUG, "Done removing agents.");
-        if (finalFactors_.size() == 0) return {};
+
+        // We reset the graph, so that this instance can be reused with the
+        // same cached elimination order and without reallocating factors.
+        const auto finalFactors = std::move(finalFactors_);
+        finalFactors_.clear();
+        graph_.reset();
+
+        if (finalFactors.size() == 0) return {};
 
         AI_LOGGER(AI_SEVERITY_DEBUG, "Picking best final factors...");
         Result retval; std::get<1>(retval).setZero();
-        for (const auto & fValue : finalFactors_) {
+        for (const auto & fValue : finalFactors) {
             const auto begin = fValue.begin(), end = fValue.end();
 
             double max = computeValue(*begin, 0.0, logtA_);
@@ -145,17 +164,32 @@ namespace AIToolbox::Factored::Bandit {
         // Now that we are done computing the bounds, we perform the actual
         // cross-summing and related pruning. The pruning here uses the
         // bounds in order to do UCB and keep the most promising actions.
-        Rules newRules;
-        PartialFactorsEnumerator jointActions(A, agents, agent);
+        const PartialFactorsEnumerator jointActions(A, agents, agent);
         const auto id = jointActions.getFactorToSkipId();
-        while (jointActions.isValid()) {
-            auto & jointAction = *jointActions;
+        const size_t N = jointActions.size();
+
+        // The entries found for each joint action and action of the agent
+        // to eliminate, in the order of the enumeration (skipping the
+        // agent). Splitting on both allows to use the threads even when the
+        // agent has few neighbors.
+        const size_t agentActions = A[agent];
+        const size_t W = N * agentActions;
+        std::vector<Entries> candidates(W);
+
+        const auto process = [&](const size_t begin, const size_t end) {
+            // Decode the first joint action of the range.
+            PartialAction jointAction{agents, PartialValues(agents.size(), 0)};
+            for (size_t i = 0, n = begin / agentActions; i < agents.size(); ++i) {
+                if (i == id) continue;
+                jointAction.second[i] = n % A[agents[i]];
+                n /= A[agents[i]];
+            }
 
-            Entries values;
-            for (size_t agentAction = 0; agentAction < A[agent]; ++agentAction) {
+            for (size_t w = begin; w < end; ++w) {
+                const size_t agentAction = w % agentActions;
                 jointAction.second[id] = agentAction;
 
-                Entries newEntries;
+                auto & newEntries = candidates[w];
                 for (const auto p : getPayoffs(factors[0]->getVariables(), factors[0]->getData().rules, jointAction))
                     newEntries.insert(std::end(newEntries), std::begin(*p), std::end(*p));
 
@@ -169,39 +203,84 @@ namespace AIToolbox::Factored::Bandit {
                     }
                 }
 
-                if (newEntries.size() != 0) {
-                    AI_LOGGER(AI_SEVERITY_DEBUG, "Adding entries...");
-                    // Add tags for the current agent.
-                    for (auto & nv : newEntries) {
-                        auto & first  = std::get<0>(nv).first;
-                        auto & second = std::get<0>(nv).second;
-                        // Find where the current agent should be.
-                        size_t i = 0;
-                        while (i < first.size() && first[i] < agent) ++i;
-                        // Insert the agent and its action
-                        first.insert(std::begin(first) + i, agent);
-                        second.insert(std::begin(second) + i, agentAction);
-                    }
-                    values.insert(std::end(values), std::make_move_iterator(std::begin(newEntries)),
-                                                    std::make_move_iterator(std::end(newEntries)));
+                // Add tags for the current agent.
+                for (auto & nv : newEntries) {
+                    auto & first  = std::get<0>(nv).first;
+                    auto & second = std::get<0>(nv).second;
+                    // Find where the current agent should be.
+                    size_t i = 0;
+                    while (i < first.size() && first[i] < agent) ++i;
+                    // Insert the agent and its action
+                    first.insert(std::begin(first) + i, agent);
+                    second.insert(std::begin(second) + i, agentAction);
                 }
+
+                // Move to the next joint action.
+                if (agentAction + 1 < agentActions) continue;
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction.second[i] < A[agents[i]]) break;
+                    jointAction.second[i] = 0;
+                }
+            }
+        };
+
+        // The entries for each joint action, joined over all actions of the
+        // agent. Since they are all alternatives for the same joint action,
+        // we can prune them against each other: this removes both the
+        // Pareto-dominated ones and those which cannot beat the best one
+        // with the bounds.
+        std::vector<Entries> results(N);
+
+        const auto gather = [&](const size_t begin, const size_t end) {
+            for (size_t n = begin; n < end; ++n) {
+                auto & values = results[n];
+                for (size_t agentAction = 0; agentAction < agentActions; ++agentAction) {
+                    auto & c = candidates[n * agentActions + agentAction];
+                    values.insert(std::end(values), std::make_move_iterator(std::begin(c)),
+                                                    std::make_move_iterator(std::end(c)));
+                }
+                values.erase(boundPrune(std::begin(values), std::end(values), x_l, x_u), std::end(values));
             }
-            if (values.size() != 0) {
-                // If this is a final factor we do the alternative path
-                // here, to avoid copying joint actions which we won't
-                // really need anymore.
-                if (!isFinalFactor) {
-                    AI_LOGGER(AI_SEVERITY_DEBUG, "Found new rule...");
-                    newRules.emplace_back(PartialValues(), std::move(values));
-                    newRules.back().first.reserve(agents.size() - 1);
-                    for (size_t a = 0; a < agents.size(); ++a)
-                        if (a != id) newRules.back().first.push_back(jointAction.second[a]);
-                } else {
-                    AI_LOGGER(AI_SEVERITY_DEBUG, "Adding final factor...");
-                    finalFactors_.emplace_back(std::move(values));
+        };
+
+        // Only large eliminations are worth splitting between threads.
+        if (pool_ && W >= ParallelWork) {
+            pool_->parallelFor(W, process);
+            pool_->parallelFor(N, gather);
+        } else {
+            process(0, W);
+            gather(0, N);
+        }
+
+        Rules newRules;
+        {
+            // Rebuild the joint actions of the remaining agents, in the
+            // same order as they were enumerated.
+            PartialValues jointAction(agents.size(), 0);
+            for (size_t n = 0; n < N; ++n) {
+                auto & values = results[n];
+                if (values.size() != 0) {
+                    // If this is a final factor we do the alternative path
+                    // here, to avoid copying joint actions which we won't
+                    // really need anymore.
+                    if (!isFinalFactor) {
+                        AI_LOGGER(AI_SEVERITY_DEBUG, "Found new rule...");
+                        newRules.emplace_back(PartialValues(), std::move(values));
+                        newRules.back().first.reserve(agents.size() - 1);
+                        for (size_t a = 0; a < agents.size(); ++a)
+                            if (a != id) newRules.back().first.push_back(jointAction[a]);
+                    } else {
+                        AI_LOGGER(AI_SEVERITY_DEBUG, "Adding final factor...");
+                        finalFactors_.emplace_back(std::move(values));
+                    }
+                }
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction[i] < A[agents[i]]) break;
+                    jointAction[i] = 0;
                 }
             }
-            jointActions.advance();
         }
         AI_LOGGER(AI_SEVERITY_DEBUG, "Done. Erasing agent...");
 
@@ -325,7 +404,15 @@ namespace AIToolbox::Factored::Bandit {
             else if (first > 0)
                 retval.emplace_back(std::move(rhs[j++]));
             else {
-                retval.emplace_back(lhs[i].first, crossSum(lhs[i].second, rhs[j].second));
+                // All entries of a rule are alternatives, so we can drop
+                // those that are dominated.
+                auto entries = crossSum(lhs[i].second, rhs[j].second);
+                const auto unwrap = +[](UCVE::Entry & entry) -> UCVE::V & {return std::get<1>(entry);};
+                const auto end = extractDominated(2, boost::make_transform_iterator(std::begin(entries), unwrap),
+                                                     boost::make_transform_iterator(std::end(entries), unwrap)).base();
+                entries.erase(end, std::end(entries));
+
+                retval.emplace_back(lhs[i].first, std::move(entries));
                 ++i; ++j;
             }
         }
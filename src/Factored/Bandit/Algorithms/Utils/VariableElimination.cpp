@@ -1,11 +1,18 @@
 #include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
 
+#include <AIToolbox/Impl/Profiling.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
 
+#include <numeric>
+
 namespace AIToolbox::Factored::Bandit {
     using VE = VariableElimination;
 
+    // The minimum number of payoffs computed in a single elimination for
+    // it to be split between the threads of the pool.
+    constexpr size_t ParallelWork = 4096;
+
     /**
      * @brief This function returns the sum of values of all rules matching the input action.
      *
@@ -18,15 +25,78 @@ namespace AIToolbox::Factored::Bandit {
      */
     double getPayoff(const PartialKeys & keys, const VE::Rules & rules, const PartialAction & jointAction, PartialAction * tags = nullptr);
 
-    VE::VariableElimination(Action a) : A(std::move(a)), graph_(A.size()) {}
+    VE::VariableElimination(Action a) : A(std::move(a)), graph_(A.size()), order_(A), denseFillRatio_(0.5), pool_(nullptr) {}
+
+    void VE::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * VE::getThreadPool() const { return pool_; }
+
+    void VE::setDenseFillRatio(const double ratio) { denseFillRatio_ = ratio; }
+    double VE::getDenseFillRatio() const { return denseFillRatio_; }
+
+    void VE::setEliminationHeuristic(const EliminationOrder::Heuristic heuristic) { order_.setHeuristic(heuristic); }
+    EliminationOrder::Heuristic VE::getEliminationHeuristic() const { return order_.getHeuristic(); }
+
+    VE::Result VE::operator()(const FactoredVector & q) {
+        for (const auto & basis : q.bases) {
+            auto & data = graph_.getFactor(basis.tag)->getData();
+            if (data.values.empty()) {
+                data.values.resize(basis.values.size(), 0.0);
+                data.tags.resize(basis.values.size());
+            }
+            Eigen::Map<Vector>(data.values.data(), data.values.size()) += basis.values;
+        }
+        return start();
+    }
 
     VE::Result VE::start() {
-        // This can possibly be improved with some heuristic ordering
-        while (graph_.variableSize())
-            removeAgent(graph_.variableSize() - 1);
+        AI_METRIC_TIME("Factored::Bandit::VariableElimination::solve");
+
+        const auto & order = order_(graph_);
+
+        // When a pool is available, we split the graph in its connected
+        // components, and eliminate each one in a separate graph.
+        std::vector<size_t> components;
+        const size_t C = pool_ ? findComponents(&components) : 0;
+
+        if (C < 2) {
+            for (const auto agent : order)
+                removeAgent(graph_, finalFactors_, agent, pool_);
+        } else {
+            while (componentGraphs_.size() < C)
+                componentGraphs_.emplace_back(A.size());
+
+            for (auto & f : graph_) {
+                auto & graph = componentGraphs_[components[f.getVariables()[0]]];
+                graph.getFactor(f.getVariables())->getData() = std::move(f.getData());
+            }
+
+            // Each component keeps the relative order of its agents.
+            std::vector<std::vector<size_t>> orders(C);
+            for (const auto agent : order)
+                if (components[agent] < C) orders[components[agent]].push_back(agent);
+
+            std::vector<std::vector<Entry>> finals(C);
+            pool_->parallelFor(C, [&](const size_t begin, const size_t end) {
+                for (size_t c = begin; c < end; ++c)
+                    for (const auto agent : orders[c])
+                        removeAgent(componentGraphs_[c], finals[c], agent, nullptr);
+            });
+
+            for (size_t c = 0; c < C; ++c) {
+                finalFactors_.insert(std::end(finalFactors_), std::make_move_iterator(std::begin(finals[c])),
+                                                              std::make_move_iterator(std::end(finals[c])));
+                componentGraphs_[c].reset();
+            }
+        }
+
+        // We reset the graph, so that this instance can be reused with the
+        // same cached elimination order and without reallocating factors.
+        const auto finalFactors = std::move(finalFactors_);
+        finalFactors_.clear();
+        graph_.reset();
 
         auto a_v = std::make_pair(Action(A.size()), 0.0);
-        for (const auto & f : finalFactors_) {
+        for (const auto & f : finalFactors) {
             a_v.second += f.first;
             // Add tags together
             const auto & tags = f.second;
@@ -37,78 +107,193 @@ namespace AIToolbox::Factored::Bandit {
         return a_v;
     }
 
-    void VariableElimination::removeAgent(const size_t agent) {
-        const auto factors = graph_.getNeighbors(agent);
-        auto agents = graph_.getNeighbors(factors);
+    size_t VariableElimination::findComponents(std::vector<size_t> * componentsp) const {
+        auto & components = *componentsp;
+
+        // Union-find over the agents, joining all agents of each factor.
+        std::vector<size_t> parent(A.size());
+        std::iota(std::begin(parent), std::end(parent), 0);
+        const auto find = [&parent](size_t a) {
+            while (parent[a] != a) a = parent[a] = parent[parent[a]];
+            return a;
+        };
+        for (const auto & f : graph_) {
+            const auto & agents = f.getVariables();
+            const auto root = find(agents[0]);
+            for (size_t i = 1; i < agents.size(); ++i)
+                parent[find(agents[i])] = root;
+        }
+
+        // Components are numbered by their lowest agent. Agents without
+        // factors are not part of any component, and are marked with an
+        // id past the last one.
+        size_t C = 0;
+        components.assign(A.size(), A.size());
+        for (size_t a = 0; a < A.size(); ++a) {
+            if (graph_.getNeighbors(a).empty()) continue;
+            auto & c = components[find(a)];
+            if (c == A.size()) c = C++;
+            components[a] = c;
+        }
+        for (size_t a = 0; a < A.size(); ++a)
+            if (components[a] == A.size()) components[a] = C;
+
+        return C;
+    }
+
+    void VariableElimination::removeAgent(Graph & graph, std::vector<Entry> & finalFactors, const size_t agent, ThreadPool * pool) {
+        AI_METRIC_TIME("Factored::Bandit::VariableElimination::eliminate");
 
-        Rules newRules;
-        PartialFactorsEnumerator jointActions(A, agents, agent);
-        auto id = jointActions.getFactorToSkipId();
+        const auto factors = graph.getNeighbors(agent);
+        auto agents = graph.getNeighbors(factors);
+
+        // Agents without factors do not contribute to the solution.
+        if (agents.empty()) {
+            graph.erase(agent);
+            return;
+        }
+
+        const PartialFactorsEnumerator jointActions(A, agents, agent);
+        const auto id = jointActions.getFactorToSkipId();
+        const size_t N = jointActions.size();
 
         const bool isFinalFactor = agents.size() == 1;
 
-        while (jointActions.isValid()) {
-            auto & jointAction = *jointActions;
-            double bestPayoff = std::numeric_limits<double>::lowest();
-            PartialAction bestTag;
-
-            // So here we're trying to create a single rule with a value
-            // optimal for this particular joint action for this subset of
-            // agents, aside from the one we are going to eliminate.
-            //
-            // So we're going to try all actions of the agent to be
-            // eliminated, and see which one gives us the best return.
-            // Once we know, we pick that as the best rule, we add it, and
-            // we try the next joint action.
-            for (size_t agentAction = 0; agentAction < A[agent]; ++agentAction) {
-                jointAction.second[id] = agentAction;
-
-                double newPayoff = 0.0;
-                PartialAction newTag{{agent}, {agentAction}};
-                // The idea here is that we sum all values for all factors
-                // touching these agents. In doing so, we also track all
-                // actions of all other agents that contributed in the
-                // creation of those rules. Since those agents are
-                // necessarily all different (since if they weren't they
-                // would have resolved together to a single rule), we can
-                // create a tag with their action by simply writing in it.
-                for (const auto factor : factors)
-                    newPayoff += getPayoff(factor->getVariables(), factor->getData().rules, jointAction, &newTag);
-
-                // We only select the agent's best action.
-                if (newPayoff > bestPayoff) {
-                    bestPayoff = newPayoff;
-                    bestTag = std::move(newTag);
-                }
+        // Factors which are dense enough are converted to tables. For each
+        // table we compute the stride of each agent in the joint action, so
+        // that we can index it directly.
+        std::vector<FactorSpace> strides;
+        strides.reserve(factors.size());
+        for (const auto factor : factors) {
+            const auto & keys = factor->getVariables();
+            auto & data = factor->getData();
+
+            if (data.rules.size() && (data.values.size() || data.rules.size() >= denseFillRatio_ * factorSpacePartial(keys, A)))
+                makeDense(factor);
+
+            strides.emplace_back(A, keys, agents);
+        }
+
+        // The new factor contains one rule per joint action of the
+        // remaining agents, which are enumerated in the same order as
+        // their index in the table (skipping the agent to eliminate).
+        std::vector<double> newValues(N, 0.0);
+        std::vector<PartialAction> newTags(N);
+        std::vector<char> found(N, false);
+
+        const auto process = [&](const size_t begin, const size_t end) {
+            // Decode the first joint action of the range.
+            PartialAction jointAction{agents, PartialValues(agents.size(), 0)};
+            for (size_t i = 0, n = begin; i < agents.size(); ++i) {
+                if (i == id) continue;
+                jointAction.second[i] = n % A[agents[i]];
+                n /= A[agents[i]];
             }
-            if (checkDifferentGeneral(bestPayoff, std::numeric_limits<double>::lowest())) {
-                if (!isFinalFactor) {
-                    newRules.emplace_back(PartialValues(), Entry{bestPayoff, std::move(bestTag)});
-                    newRules.back().first.reserve(agents.size() - 1);
-                    for (size_t a = 0; a < agents.size(); ++a)
-                        if (a != id) newRules.back().first.push_back(jointAction.second[a]);
-                } else {
-                    finalFactors_.emplace_back(bestPayoff, std::move(bestTag));
+
+            for (size_t n = begin; n < end; ++n) {
+                double bestPayoff = std::numeric_limits<double>::lowest();
+                PartialAction bestTag;
+
+                // So here we're trying to create a single rule with a value
+                // optimal for this particular joint action for this subset of
+                // agents, aside from the one we are going to eliminate.
+                //
+                // So we're going to try all actions of the agent to be
+                // eliminated, and see which one gives us the best return.
+                // Once we know, we pick that as the best rule, we add it, and
+                // we try the next joint action.
+                for (size_t agentAction = 0; agentAction < A[agent]; ++agentAction) {
+                    jointAction.second[id] = agentAction;
+
+                    double newPayoff = 0.0;
+                    PartialAction newTag{{agent}, {agentAction}};
+                    // The idea here is that we sum all values for all factors
+                    // touching these agents. In doing so, we also track all
+                    // actions of all other agents that contributed in the
+                    // creation of those rules. Since those agents are
+                    // necessarily all different (since if they weren't they
+                    // would have resolved together to a single rule), we can
+                    // create a tag with their action by simply writing in it.
+                    for (size_t f = 0; f < factors.size(); ++f) {
+                        const auto & data = factors[f]->getData();
+                        if (data.values.size()) {
+                            const auto index = strides[f].toIndex(jointAction.second);
+
+                            newPayoff += data.values[index];
+                            unsafe_join(&newTag, data.tags[index]);
+                        }
+                        if (data.rules.size())
+                            newPayoff += getPayoff(factors[f]->getVariables(), data.rules, jointAction, &newTag);
+                    }
+
+                    // We only select the agent's best action.
+                    if (newPayoff > bestPayoff) {
+                        bestPayoff = newPayoff;
+                        bestTag = std::move(newTag);
+                    }
+                }
+                if (checkDifferentGeneral(bestPayoff, std::numeric_limits<double>::lowest())) {
+                    found[n] = true;
+                    newValues[n] = bestPayoff;
+                    newTags[n] = std::move(bestTag);
+                }
+
+                // Move to the next joint action.
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction.second[i] < A[agents[i]]) break;
+                    jointAction.second[i] = 0;
                 }
             }
-            jointActions.advance();
-        }
+        };
+
+        // Only large eliminations are worth splitting between threads.
+        if (pool && N * A[agent] * factors.size() >= ParallelWork)
+            pool->parallelFor(N, process);
+        else
+            process(0, N);
 
         for (const auto & it : factors)
-            graph_.erase(it);
-        graph_.erase(agent);
+            graph.erase(it);
+        graph.erase(agent);
 
-        if (newRules.size() == 0) return;
+        if (std::find(std::begin(found), std::end(found), true) == std::end(found)) return;
         if (!isFinalFactor) {
             agents.erase(std::remove(std::begin(agents), std::end(agents), agent), std::end(agents));
 
-            auto newFactor = graph_.getFactor(agents);
-            newFactor->getData().rules.insert(
-                    std::end(newFactor->getData().rules),
-                    std::make_move_iterator(std::begin(newRules)),
-                    std::make_move_iterator(std::end(newRules))
-            );
+            auto & data = graph.getFactor(agents)->getData();
+            if (data.values.empty()) {
+                data.values = std::move(newValues);
+                data.tags = std::move(newTags);
+            } else {
+                for (size_t i = 0; i < newValues.size(); ++i) {
+                    data.values[i] += newValues[i];
+                    unsafe_join(&data.tags[i], newTags[i]);
+                }
+            }
+        } else {
+            finalFactors.emplace_back(newValues[0], std::move(newTags[0]));
+        }
+    }
+
+    void VariableElimination::makeDense(const Graph::FactorIt factor) {
+        const auto & keys = factor->getVariables();
+        auto & data = factor->getData();
+
+        if (data.values.empty()) {
+            const auto space = factorSpacePartial(keys, A);
+            data.values.resize(space, 0.0);
+            data.tags.resize(space);
+        }
+        // Multiple rules for the same joint action are summed, as they
+        // would be when matching them.
+        const FactorSpace space(A, keys);
+        for (const auto & rule : data.rules) {
+            const auto index = space.toIndex(rule.first);
+            data.values[index] += rule.second.first;
+            unsafe_join(&data.tags[index], rule.second.second);
         }
+        data.rules.clear();
     }
 
     double getPayoff(const PartialKeys & keys, const VE::Rules & rules, const PartialAction & jointAction, PartialAction * tags) {
@@ -2,19 +2,113 @@
 
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
-#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+
+#include <algorithm>
+#include <numeric>
 
 namespace AIToolbox::Factored::Bandit {
     QGreedyPolicy::QGreedyPolicy(Action a, const FactoredContainer<QFunctionRule> & q) :
-            Base(std::move(a)), q_(q) {}
+            Base(std::move(a)), q_(q), ve_(A), valid_(false), action_(A.size(), 0), value_(0.0) {}
 
     Action QGreedyPolicy::sampleAction() const {
-        Bandit::VariableElimination ve(A);
-        return std::get<0>(ve(q_));
+        update();
+        return action_;
     }
 
     double QGreedyPolicy::getActionProbability(const Action & a) const {
         if (veccmp(a, sampleAction()) == 0) return 1.0;
         return 0.0;
     }
+
+    double QGreedyPolicy::getGreedyValue() const {
+        update();
+        return value_;
+    }
+
+    void QGreedyPolicy::invalidate() {
+        valid_ = false;
+    }
+
+    void QGreedyPolicy::invalidate(const PartialKeys & agents) {
+        if (!valid_) return;
+        for (const auto a : agents) {
+            // An agent without rules may have just got some, which could
+            // join different groups.
+            if (groups_[a] == dirty_.size()) {
+                valid_ = false;
+                return;
+            }
+            dirty_[groups_[a]] = true;
+        }
+    }
+
+    void QGreedyPolicy::update() const {
+        if (!valid_) {
+            // Union-find over the agents, joining all agents of each rule.
+            std::vector<size_t> parent(A.size());
+            std::iota(std::begin(parent), std::end(parent), 0);
+            const auto find = [&parent](size_t a) {
+                while (parent[a] != a) a = parent[a] = parent[parent[a]];
+                return a;
+            };
+            std::vector<char> used(A.size(), false);
+            for (const auto & rule : q_) {
+                const auto & agents = rule.action.first;
+                const auto root = find(agents[0]);
+                for (const auto a : agents) {
+                    parent[find(a)] = root;
+                    used[a] = true;
+                }
+            }
+
+            // Agents without rules are marked with an id past the last
+            // group; their action is always zero.
+            size_t G = 0;
+            groups_.assign(A.size(), A.size());
+            for (size_t a = 0; a < A.size(); ++a) {
+                if (!used[a]) continue;
+                auto & g = groups_[find(a)];
+                if (g == A.size()) g = G++;
+                groups_[a] = g;
+            }
+            for (auto & g : groups_)
+                if (g == A.size()) g = G;
+
+            dirty_.assign(G, true);
+            values_.assign(G, 0.0);
+            buffers_.resize(G);
+            std::fill(std::begin(action_), std::end(action_), 0);
+            valid_ = true;
+        }
+
+        const size_t G = dirty_.size();
+        const auto dirtyNum = std::count(std::begin(dirty_), std::end(dirty_), true);
+        if (!dirtyNum) return;
+
+        if (static_cast<size_t>(dirtyNum) == G) {
+            // All groups are solved together, as VariableElimination
+            // already splits them internally.
+            const auto [a, v] = ve_(q_);
+            action_ = a;
+            std::fill(std::begin(values_), std::end(values_), 0.0);
+            for (const auto & rule : q_)
+                if (match(action_, rule.action))
+                    values_[groups_[rule.action.first[0]]] += rule.value;
+        } else {
+            for (const auto & rule : q_) {
+                const auto g = groups_[rule.action.first[0]];
+                if (dirty_[g]) buffers_[g].push_back(rule);
+            }
+            for (size_t g = 0; g < G; ++g) {
+                if (!dirty_[g]) continue;
+                const auto [a, v] = ve_(buffers_[g]);
+                for (size_t i = 0; i < A.size(); ++i)
+                    if (groups_[i] == g) action_[i] = a[i];
+                values_[g] = v;
+                buffers_[g].clear();
+            }
+        }
+        value_ = std::accumulate(std::begin(values_), std::end(values_), 0.0);
+        std::fill(std::begin(dirty_), std::end(dirty_), false);
+    }
 }
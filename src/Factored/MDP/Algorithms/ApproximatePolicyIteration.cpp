@@ -0,0 +1,206 @@
+#include <AIToolbox/Factored/MDP/Algorithms/ApproximatePolicyIteration.hpp>
+
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace AIToolbox::Factored::MDP {
+    ApproximatePolicyIteration::ApproximatePolicyIteration(const unsigned maxIterations) :
+            maxIterations_(maxIterations), iterations_(0), pool_(nullptr) {}
+
+    std::tuple<Vector, QFunction, ApproximatePolicyIteration::Policy> ApproximatePolicyIteration::operator()(const CooperativeModel & m, const FactoredVector & h, Policy policy) {
+        const auto & S = m.getS();
+        const auto & A = m.getA();
+
+        if (policy.size() != A.size())
+            throw std::invalid_argument("Input policy has an incorrect number of local policies!");
+        for (size_t j = 0; j < A.size(); ++j) {
+            const auto & p = policy[j];
+            if (checkTag(S, p.tag).first != TagErrors::None)
+                throw std::invalid_argument("Input policy contains an invalid tag!");
+            if (p.actions.size() != factorSpacePartial(p.tag, S))
+                throw std::invalid_argument("Input policy has an incorrect number of actions for its tag!");
+            for (const auto a : p.actions)
+                if (a >= A[j])
+                    throw std::invalid_argument("Input policy contains an action too high for its action factor!");
+        }
+
+        std::tuple<Vector, QFunction, Policy> retval;
+        auto & [w, q, p] = retval;
+
+        // The back-projections do not depend on the policy, so we compute
+        // them once. Under a policy, each of them only needs to be indexed
+        // with the actions the policy takes.
+        const auto g = backProject(S, A, m.getTransitionFunction(), h, pool_);
+
+        // The scopes of all evaluations are the same, so the LP is only
+        // built at the first iteration, and then re-solved in place.
+        lp_ = std::make_unique<FactoredLP>(S);
+        lp_->setThreadPool(pool_);
+
+        FactoredVector C, b;
+        std::vector<std::vector<size_t>> improved(A.size());
+        iterations_ = 0;
+        while (true) {
+            ++iterations_;
+
+            makeEvaluation(m, h, g, policy, &C, &b);
+            auto weights = (*lp_)(C, b);
+            if (!weights)
+                throw std::runtime_error("Could not solve the LP for this MDP");
+            w = std::move(*weights);
+
+            q = g;
+            q *= m.getDiscount() * w;
+            plusEqual(S, A, q, m.getRewardFunction());
+
+            if (maxIterations_ && iterations_ >= maxIterations_) break;
+
+            // Each action factor is improved against the previous policy
+            // of the others, so they are all independent.
+            const auto improveRange = [&](const size_t begin, const size_t end) {
+                for (size_t j = begin; j < end; ++j)
+                    improved[j] = improve(m, q, policy, j);
+            };
+            if (pool_)
+                pool_->parallelFor(A.size(), 1, improveRange);
+            else
+                improveRange(0, A.size());
+
+            bool changed = false;
+            for (size_t j = 0; j < A.size(); ++j) {
+                if (improved[j] == policy[j].actions) continue;
+                policy[j].actions = std::move(improved[j]);
+                changed = true;
+            }
+            if (!changed) break;
+        }
+        p = std::move(policy);
+
+        return retval;
+    }
+
+    void ApproximatePolicyIteration::makeEvaluation(const CooperativeModel & m, const FactoredVector & h, const FactoredMatrix2D & g, const Policy & policy, FactoredVector * C, FactoredVector * b) const {
+        const auto & S = m.getS();
+        const auto & A = m.getA();
+        const auto discount = m.getDiscount();
+
+        Factors s(S.size()), a(A.size());
+
+        // Under the policy, a function of some action factors becomes a
+        // function of the state factors observed by their local policies.
+        const auto makeScope = [&policy](PartialKeys tag, const PartialKeys & actionTag) {
+            for (const auto j : actionTag)
+                tag = merge(tag, policy[j].tag);
+            return tag;
+        };
+        // Returns the index of the actions taken by the policy at s.
+        const auto actionId = [&](const PartialKeys & actionTag) {
+            for (const auto j : actionTag)
+                a[j] = policy[j].actions[toIndexPartial(policy[j].tag, S, s)];
+            return toIndexPartial(actionTag, A, a);
+        };
+
+        // C setup: h_k(s) - discount * g_k(s, pi(s))
+        C->bases.resize(h.bases.size());
+        for (size_t k = 0; k < h.bases.size(); ++k) {
+            const auto & hk = h.bases[k];
+            const auto & gk = g.bases[k];
+            auto & ck = C->bases[k];
+
+            ck.tag = makeScope(merge(hk.tag, gk.tag), gk.actionTag);
+            ck.values.resize(factorSpacePartial(ck.tag, S));
+
+            PartialFactorsEnumerator e(S, ck.tag);
+            for (size_t id = 0; e.isValid(); e.advance(), ++id) {
+                for (size_t i = 0; i < ck.tag.size(); ++i)
+                    s[ck.tag[i]] = e->second[i];
+
+                ck.values[id] = hk.values[toIndexPartial(hk.tag, S, s)] -
+                    discount * gk.values(toIndexPartial(gk.tag, S, s), actionId(gk.actionTag));
+            }
+        }
+
+        // b setup: R(s, pi(s))
+        const auto & R = m.getRewardFunction();
+        b->bases.resize(R.bases.size());
+        for (size_t k = 0; k < R.bases.size(); ++k) {
+            const auto & rk = R.bases[k];
+            auto & bk = b->bases[k];
+
+            bk.tag = makeScope(rk.tag, rk.actionTag);
+            bk.values.resize(factorSpacePartial(bk.tag, S));
+
+            PartialFactorsEnumerator e(S, bk.tag);
+            for (size_t id = 0; e.isValid(); e.advance(), ++id) {
+                for (size_t i = 0; i < bk.tag.size(); ++i)
+                    s[bk.tag[i]] = e->second[i];
+
+                bk.values[id] = rk.values(toIndexPartial(rk.tag, S, s), actionId(rk.actionTag));
+            }
+        }
+    }
+
+    std::vector<size_t> ApproximatePolicyIteration::improve(const CooperativeModel & m, const QFunction & q, const Policy & policy, const size_t j) const {
+        const auto & S = m.getS();
+        const auto & A = m.getA();
+        const auto & pj = policy[j];
+
+        Factors s(S.size()), a(A.size());
+
+        // For each value of the tag of the local policy, the average Q of
+        // each action over the state factors it does not observe. Only the
+        // bases which depend on the action factor matter.
+        Matrix2D scores = Matrix2D::Zero(pj.actions.size(), A[j]);
+        for (const auto & qk : q.bases) {
+            if (!std::binary_search(std::begin(qk.actionTag), std::end(qk.actionTag), j)) continue;
+
+            auto tag = merge(pj.tag, qk.tag);
+            for (const auto l : qk.actionTag)
+                if (l != j) tag = merge(tag, policy[l].tag);
+
+            // Each value of the policy tag is matched by the same number
+            // of values of the full tag.
+            const double weight = static_cast<double>(pj.actions.size()) / factorSpacePartial(tag, S);
+
+            PartialFactorsEnumerator e(S, tag);
+            for (; e.isValid(); e.advance()) {
+                for (size_t i = 0; i < tag.size(); ++i)
+                    s[tag[i]] = e->second[i];
+
+                for (const auto l : qk.actionTag)
+                    if (l != j) a[l] = policy[l].actions[toIndexPartial(policy[l].tag, S, s)];
+
+                const auto x = toIndexPartial(pj.tag, S, s);
+                const auto sId = toIndexPartial(qk.tag, S, s);
+                for (size_t aj = 0; aj < A[j]; ++aj) {
+                    a[j] = aj;
+                    scores(x, aj) += weight * qk.values(sId, toIndexPartial(qk.actionTag, A, a));
+                }
+            }
+        }
+
+        // We only switch action on a strict improvement, so that the
+        // process stops when the policy is stable.
+        std::vector<size_t> retval(pj.actions);
+        for (size_t x = 0; x < retval.size(); ++x) {
+            auto & best = retval[x];
+            for (size_t aj = 0; aj < A[j]; ++aj)
+                if (scores(x, aj) > scores(x, best) && checkDifferentGeneral(scores(x, aj), scores(x, best)))
+                    best = aj;
+        }
+        return retval;
+    }
+
+    void ApproximatePolicyIteration::setMaxIterations(const unsigned maxIterations) { maxIterations_ = maxIterations; }
+    unsigned ApproximatePolicyIteration::getMaxIterations() const { return maxIterations_; }
+    unsigned ApproximatePolicyIteration::getIterations() const { return iterations_; }
+    size_t ApproximatePolicyIteration::getLPBuildCount() const { return lp_ ? lp_->getBuildCount() : 0; }
+
+    void ApproximatePolicyIteration::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * ApproximatePolicyIteration::getThreadPool() const { return pool_; }
+}
@@ -0,0 +1,72 @@
+#include <AIToolbox/Factored/MDP/Algorithms/CooperativeQLearning.hpp>
+
+#include <AIToolbox/Factored/Utils/Core.hpp>
+
+#include <stdexcept>
+
+namespace AIToolbox::Factored::MDP {
+    CooperativeQLearning::CooperativeQLearning(State s, Action a, QFunction q, const double discount, const double alpha) :
+            S(std::move(s)), A(std::move(a)), discount_(discount), alpha_(alpha), q_(std::move(q)), ve_(A),
+            before_(A.size()), after_(A.size())
+    {
+        rows_.bases.resize(q_.bases.size());
+        for (size_t i = 0; i < q_.bases.size(); ++i) {
+            const auto & basis = q_.bases[i];
+            if (static_cast<size_t>(basis.values.rows()) != factorSpacePartial(basis.tag, S) ||
+                static_cast<size_t>(basis.values.cols()) != factorSpacePartial(basis.actionTag, A))
+                throw std::invalid_argument("QFunction basis has the wrong size for the input state and action spaces");
+
+            rows_.bases[i].tag = basis.actionTag;
+        }
+    }
+
+    Action CooperativeQLearning::stepUpdateQ(const State & s, const Action & a, const State & s1, const Rewards & rew) {
+        for (size_t i = 0; i < q_.bases.size(); ++i) {
+            const auto & basis = q_.bases[i];
+            rows_.bases[i].values = basis.values.row(toIndexPartial(basis.tag, S, s1)).transpose();
+        }
+        const auto a1 = std::get<0>(ve_(rows_));
+
+        // We compute the Q of each agent before and after the transition,
+        // splitting each cell evenly between the agents it covers.
+        std::fill(std::begin(before_), std::end(before_), 0.0);
+        std::fill(std::begin(after_), std::end(after_), 0.0);
+        for (const auto & basis : q_.bases) {
+            const double n = basis.actionTag.size();
+            const double b = basis.values(toIndexPartial(basis.tag, S, s), toIndexPartial(basis.actionTag, A, a)) / n;
+            const double f = basis.values(toIndexPartial(basis.tag, S, s1), toIndexPartial(basis.actionTag, A, a1)) / n;
+            for (const auto agent : basis.actionTag) {
+                before_[agent] += b;
+                after_[agent] += f;
+            }
+        }
+        // Since all per-agent values have already been computed, we can
+        // update the tables in place.
+        for (auto & basis : q_.bases) {
+            double sum = 0.0;
+            for (const auto agent : basis.actionTag)
+                sum += rew[agent] + discount_ * after_[agent] - before_[agent];
+
+            basis.values(toIndexPartial(basis.tag, S, s), toIndexPartial(basis.actionTag, A, a)) += alpha_ * sum;
+        }
+
+        return a1;
+    }
+
+    void CooperativeQLearning::setLearningRate(const double a) {
+        if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Learning rate parameter must be in (0,1]");
+        alpha_ = a;
+    }
+
+    double CooperativeQLearning::getLearningRate() const { return alpha_; }
+
+    void CooperativeQLearning::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    const State &  CooperativeQLearning::getS() const { return S; }
+    const Action & CooperativeQLearning::getA() const { return A; }
+    double CooperativeQLearning::getDiscount() const { return discount_; }
+    const QFunction & CooperativeQLearning::getQFunction() const { return q_; }
+}
@@ -1,62 +1,119 @@
 #include <AIToolbox/Factored/MDP/Algorithms/JointActionLearner.hpp>
 
 namespace AIToolbox::Factored::MDP {
+    namespace {
+        // Each expected value of the joint model is rebuilt from the
+        // counts after this many visits of its state, so that rounding
+        // errors from the incremental updates do not accumulate.
+        constexpr unsigned refreshInterval = 1024;
+    }
+
     JointActionLearner::JointActionLearner(const size_t ss, Action aa, const size_t i, const double d, const double al) :
-            A(std::move(aa)), id_(i),
+            A(std::move(aa)), id_(i), joint_(false), idStride_(1),
             stateCounters_(ss, 0),
-            stateActionCounts_(boost::extents[ss][A.size() - 1]),
+            stateActionCounts_(ss),
+            expectedQ_(ss, A[id_]),
             singleQFun_(ss, A[id_]),
-            jointActions_(A, id_),
             qLearning_(ss, factorSpace(A), d, al)
     {
-        singleQFun_.setZero();
-        for (size_t s = 0; s < qLearning_.getS(); ++s) {
-            for (size_t a = 0, i = 0; a < A.size() - 1; ++a, ++i) {
-                if (a == id_) ++i;
-                stateActionCounts_[s][a].resize(A[i]);
-            }
+        for (size_t a = 0; a < id_; ++a)
+            idStride_ *= A[a];
+
+        size_t offset = 0;
+        for (const auto a : A) {
+            agentOffsets_.push_back(offset);
+            offset += a;
         }
+        agentOffsets_.push_back(offset);
+        agentCounts_.resize(ss * offset, 0);
+
+        expectedQ_.setZero();
+        singleQFun_.setZero();
     }
 
     void JointActionLearner::stepUpdateQ(const size_t s, const Action & aa, const size_t s1, const double rew) {
-        // Update counts
-        stateCounters_[s] += 1;
-        for (size_t a = 0, i = 0; a < A.size() - 1; ++a, ++i) {
-            if (a == id_) ++i;
-            stateActionCounts_[s][a][aa[i]] += 1;
-        }
+        const auto & q = qLearning_.getQFunction();
 
-        // QLearning update
         const auto jointA = toIndex(A, aa);
+        const auto others = jointA - aa[id_] * idStride_;
+
+        // Update counts, for both models.
+        stateCounters_[s] += 1;
+        auto counts = agentCounts_.data() + s * agentOffsets_.back();
+        for (size_t j = 0; j < A.size(); ++j)
+            if (j != id_) ++counts[agentOffsets_[j] + aa[j]];
+
+        // Each expected value replaces the contribution of the observed
+        // joint action with its new count and value. Only our own action
+        // changes its value, via QLearning.
+        const auto count = ++stateActionCounts_[s][others];
+        for (size_t ai = 0; ai < A[id_]; ++ai)
+            if (ai != aa[id_]) expectedQ_(s, ai) += q(s, others + ai * idStride_);
+
+        expectedQ_(s, aa[id_]) -= q(s, jointA) * (count - 1);
         qLearning_.stepUpdateQ(s, jointA, s1, rew);
+        expectedQ_(s, aa[id_]) += q(s, jointA) * count;
 
-        // Single QFunction update
-        jointActions_.reset();
+        if (stateCounters_[s] % refreshInterval == 0)
+            refreshExpectedQ(s);
 
-        singleQFun_.row(s).setZero();
-        while (jointActions_.isValid()) {
-            auto & jointAction = *jointActions_;
+        updateSingleQ(s);
+    }
 
-            // Compute probability of other agents taking their actions
-            // (this doesn't change even if our action changes).
-            double p = 1.0;
-            for (size_t a = 0, i = 0; a < A.size() - 1; ++a, ++i) {
-                if (a == id_) ++i;
-                p *= stateActionCounts_[s][a][jointAction.second[i]];
-                p /= stateCounters_[s];
-            }
+    void JointActionLearner::refreshExpectedQ(const size_t s) {
+        const auto & q = qLearning_.getQFunction();
+
+        expectedQ_.row(s).setZero();
+        for (const auto & [others, count] : stateActionCounts_[s])
+            for (size_t ai = 0; ai < A[id_]; ++ai)
+                expectedQ_(s, ai) += q(s, others + ai * idStride_) * count;
+    }
+
+    void JointActionLearner::updateSingleQ(const size_t s) {
+        if (!stateCounters_[s]) return;
 
-            // Finally, update the row for the single QFunction.
-            for (size_t ai = 0; ai < A[id_]; ++ai) {
-                jointAction.second[id_] = ai;
-                const auto aa = toIndex(A, jointAction.second);
+        // With a single other agent the two models are the same.
+        if (joint_ || A.size() <= 2) {
+            singleQFun_.row(s) = expectedQ_.row(s) / stateCounters_[s];
+            return;
+        }
+
+        // We take the expectation over one agent at a time, starting from
+        // the last. Joint actions are indexed with the first agent changing
+        // fastest, so removing the agents after j does not change the
+        // stride of j.
+        const auto counts = agentCounts_.data() + s * agentOffsets_.back();
+        const double total = stateCounters_[s];
+
+        buffer_ = qLearning_.getQFunction().row(s).transpose();
+        size_t stride = factorSpace(A);
+        for (size_t j = A.size(); j-- > 0; ) {
+            stride /= A[j];
+            if (j == id_) continue;
 
-                singleQFun_(s, ai) += qLearning_.getQFunction()(s, aa) * p;
+            const size_t blocks = buffer_.size() / (stride * A[j]);
+            buffer2_.resize(buffer_.size() / A[j]);
+            buffer2_.setZero();
+            for (size_t a = 0; a < A[j]; ++a) {
+                const auto c = counts[agentOffsets_[j] + a];
+                if (!c) continue;
+                const double p = c / total;
+                for (size_t b = 0; b < blocks; ++b)
+                    buffer2_.segment(b * stride, stride) += p * buffer_.segment((b * A[j] + a) * stride, stride);
             }
-            jointActions_.advance();
+            std::swap(buffer_, buffer2_);
         }
+        singleQFun_.row(s) = buffer_.transpose();
     }
 
+    void JointActionLearner::setJointOpponentModel(const bool joint) {
+        joint_ = joint;
+        for (size_t s = 0; s < stateCounters_.size(); ++s)
+            updateSingleQ(s);
+    }
+
+    bool JointActionLearner::getJointOpponentModel() const { return joint_; }
+
     const AIToolbox::MDP::QFunction & JointActionLearner::getJointQFunction() const { return qLearning_.getQFunction(); }
     const AIToolbox::MDP::QFunction & JointActionLearner::getSingleQFunction() const { return singleQFun_; }
     void JointActionLearner::setLearningRate(double a) { qLearning_.setLearningRate(a); }
@@ -2,13 +2,23 @@
 
 #include <AIToolbox/LP.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::Factored::MDP {
+    // The minimum number of rule matches performed in a single elimination
+    // for it to be split between the threads of the pool.
+    constexpr size_t ParallelWork = 4096;
+
+    LinearProgramming::LinearProgramming() : pool_(nullptr) {}
+
+    void LinearProgramming::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * LinearProgramming::getThreadPool() const { return pool_; }
+
     std::tuple<Vector, QFunction> LinearProgramming::operator()(const CooperativeModel & m, const FactoredVector & h) const {
         std::tuple<Vector, QFunction> retval;
         auto & [v, g] = retval;
 
-        g = backProject(m.getS(), m.getA(), m.getTransitionFunction(), h);
+        g = backProject(m.getS(), m.getA(), m.getTransitionFunction(), h, pool_);
         auto values = solveLP(m, g, h);
 
         if (!values)
@@ -226,15 +236,57 @@ namespace AIToolbox::Factored::MDP {
 
         PartialFactorsEnumerator jointActions(F, variables, f);
         const auto id = jointActions.getFactorToSkipId();
+        const size_t N = jointActions.size();
         Rules newRules;
 
         // We'll now create new rules that represent the elimination of the
         // input variable for this round.
         const bool isFinalFactor = variables.size() == 1;
 
-        while (jointActions.isValid()) {
-            auto & jointAction = *jointActions;
+        // Finding the rules that match each assignment is the expensive
+        // part, and each assignment is independent. So we first collect the
+        // matches for all of them, possibly in parallel, and then we add
+        // the constraints to the LP serially in the usual order.
+        size_t rulesNum = 0;
+        for (const auto ruleIds : factors)
+            rulesNum += ruleIds->getData().size();
+
+        std::vector<std::vector<size_t>> matches(N * F[f]);
+        const auto process = [&](const size_t begin, const size_t end) {
+            // Decode the first joint action of the range.
+            PartialValues jointAction(variables.size(), 0);
+            for (size_t i = 0, n = begin; i < variables.size(); ++i) {
+                if (i == id) continue;
+                jointAction[i] = n % F[variables[i]];
+                n /= F[variables[i]];
+            }
+
+            for (size_t n = begin; n < end; ++n) {
+                for (size_t sAction = 0; sAction < F[f]; ++sAction) {
+                    auto & m = matches[n * F[f] + sAction];
+
+                    jointAction[id] = sAction;
+                    for (const auto ruleIds : factors)
+                        for (const auto & ruleId : ruleIds->getData())
+                            if (match(ruleIds->getVariables(), ruleId.first, variables, jointAction))
+                                m.push_back(ruleId.second);
+                }
+
+                // Move to the next joint action.
+                for (size_t i = 0; i < variables.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction[i] < F[variables[i]]) break;
+                    jointAction[i] = 0;
+                }
+            }
+        };
+
+        if (pool_ && N * F[f] * rulesNum >= ParallelWork)
+            pool_->parallelFor(N, process);
+        else
+            process(0, N);
 
+        for (size_t n = 0; jointActions.isValid(); jointActions.advance(), ++n) {
             const size_t newRuleId = lp.row.size();
 
             lp.addColumn();
@@ -243,21 +295,16 @@ namespace AIToolbox::Factored::MDP {
                 lp.row.setZero();
                 lp.row[newRuleId] = -1.0;
 
-                jointAction.second[id] = sAction;
-                for (const auto ruleIds : factors)
-                    for (const auto ruleId : ruleIds->getData())
-                        if (match(ruleIds->getVariables(), ruleId.first, jointAction.first, jointAction.second))
-                            lp.row[std::get<1>(ruleId)] = 1.0;
+                for (const auto ruleId : matches[n * F[f] + sAction])
+                    lp.row[ruleId] = 1.0;
 
                 lp.pushRow(LP::Constraint::LessEqual, 0.0);
             }
 
             if (!isFinalFactor)
-                newRules.emplace_back(jointAction.second, newRuleId);
+                newRules.emplace_back(jointActions->second, newRuleId);
             else
                 finalFactors.push_back(newRuleId);
-
-            jointActions.advance();
         }
 
         // And finally as usual in variable elimination remove the variable
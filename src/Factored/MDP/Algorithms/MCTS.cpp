@@ -0,0 +1,257 @@
+#include <AIToolbox/Factored/MDP/Algorithms/MCTS.hpp>
+
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Impl/Profiling.hpp>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace AIToolbox::Factored::MDP {
+    namespace {
+        std::vector<PartialKeys> getRewardGroups(const CooperativeModel & m) {
+            std::vector<PartialKeys> groups;
+            for (const auto & basis : m.getRewardFunction().bases)
+                if (basis.actionTag.size() && std::find(std::begin(groups), std::end(groups), basis.actionTag) == std::end(groups))
+                    groups.push_back(basis.actionTag);
+            return groups;
+        }
+
+        size_t getStatisticsNum(const Action & A, std::vector<PartialKeys> & groups) {
+            std::vector<bool> covered(A.size(), false);
+            for (const auto & group : groups) {
+                if (group.empty() || !std::is_sorted(std::begin(group), std::end(group)) ||
+                    std::adjacent_find(std::begin(group), std::end(group)) != std::end(group) ||
+                    group.back() >= A.size())
+                    throw std::invalid_argument("Each group of agents must be non-empty, sorted and within the action space");
+                for (const auto agent : group)
+                    covered[agent] = true;
+            }
+            for (size_t agent = 0; agent < A.size(); ++agent)
+                if (!covered[agent]) groups.push_back({agent});
+
+            size_t retval = 0;
+            for (const auto & group : groups)
+                retval += factorSpacePartial(group, A);
+            return retval;
+        }
+    }
+
+    MCTS::MCTS(const CooperativeModel & m, const unsigned iterations, const double exp) :
+            MCTS(m, getRewardGroups(m), iterations, exp) {}
+
+    MCTS::MCTS(const CooperativeModel & m, std::vector<PartialKeys> groups, const unsigned iterations, const double exp) :
+            model_(m), groups_(std::move(groups)), iterations_(iterations), maxDepth_(0), exploration_(exp), maxMemory_(0),
+            graph_(getStatisticsNum(model_.getA(), groups_)), ve_(model_.getA()),
+            rand_(Impl::Seeder::getSeed())
+    {
+        const auto & A = model_.getA();
+        size_t offset = 0;
+        scores_.bases.resize(groups_.size());
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            offsets_.push_back(offset);
+            scores_.bases[g].tag = groups_[g];
+            offset += factorSpacePartial(groups_[g], A);
+        }
+        offsets_.push_back(offset);
+        buffer_.resize(offset);
+
+        for (const auto & basis : model_.getRewardFunction().bases) {
+            const auto & aTag = basis.actionTag;
+            size_t best = 0, bestShared = 0;
+            for (size_t g = 0; g < groups_.size(); ++g) {
+                const auto & group = groups_[g];
+                if (std::includes(std::begin(group), std::end(group), std::begin(aTag), std::end(aTag))) {
+                    best = g;
+                    break;
+                }
+                size_t shared = 0;
+                for (const auto agent : aTag)
+                    shared += std::binary_search(std::begin(group), std::end(group), agent);
+                if (shared > bestShared) {
+                    best = g;
+                    bestShared = shared;
+                }
+            }
+            rewardGroups_.push_back(best);
+        }
+    }
+
+    Action MCTS::sampleAction(const State & s, const unsigned horizon) {
+        graph_.reset();
+        graph_.expand(graph_.getRoot());
+        return runSimulation(s, horizon);
+    }
+
+    Action MCTS::sampleAction(const Action & a, const State & s1, const unsigned horizon) {
+        const auto child = graph_.getChild(graph_.getRoot(), 0, getChildKey(a, s1));
+        if (child == Graph::NoNode) {
+            graph_.reset();
+        } else {
+            graph_.reroot(child);
+        }
+        // The new root may have never been simulated from.
+        graph_.expand(graph_.getRoot());
+        return runSimulation(s1, horizon);
+    }
+
+    Action MCTS::runSimulation(const State & s, const unsigned horizon) {
+        stats_ = SearchStatistics();
+        if (!horizon) return Action(model_.getA().size(), 0);
+
+        const auto start = std::chrono::steady_clock::now();
+        maxDepth_ = horizon;
+
+        for (unsigned i = 0; i < iterations_; ++i)
+            simulate(graph_.getRoot(), s, 0);
+        stats_.rollouts = iterations_;
+
+        stats_.nodes = graph_.size();
+        stats_.memoryUsage = graph_.getMemoryUsage();
+        stats_.elapsed = std::chrono::steady_clock::now() - start;
+
+        AI_METRIC_COUNT("Factored::MDP::MCTS::rollouts", stats_.rollouts);
+        AI_METRIC_ADD_TIME("Factored::MDP::MCTS::search", stats_.elapsed);
+
+        return findBestA(graph_.getRoot());
+    }
+
+    Vector MCTS::simulate(const NodeId b, const State & s, const unsigned depth) {
+        const auto count = ++graph_.getNode(b).N;
+        if (depth > stats_.maxDepth) stats_.maxDepth = depth;
+
+        const auto a = findBestBonusA(b, count);
+
+        State s1(s.size());
+        model_.sampleSR(s, a, &s1);
+
+        // We only go deeper if needed (maxDepth_ is always at least 1).
+        Vector rew;
+        if (depth + 1 < maxDepth_) {
+            // All children hang from the first action node. Once the tree
+            // has reached its memory limit, we only descend into nodes
+            // which have already been expanded.
+            const auto key = getChildKey(a, s1);
+            const auto child = graph_.getChild(b, 0, key);
+            const bool full = maxMemory_ && graph_.getUsedMemory() >= maxMemory_;
+
+            if (child != Graph::NoNode && (!full || graph_.isExpanded(child))) {
+                graph_.expand(child);
+                rew = simulate(child, s1, depth + 1);
+            } else {
+                if (full) {
+                    ++stats_.memoryLimited;
+                } else {
+                    graph_.addChild(b, 0, key);
+                    ++stats_.nodesAdded;
+                }
+                AI_PROFILE(stats_.addLeafDepth(depth));
+                rew = rollout(std::move(s1), depth + 1);
+            }
+            rew *= model_.getDiscount();
+        } else {
+            AI_PROFILE(stats_.addLeafDepth(depth));
+            rew = Vector::Zero(groups_.size());
+        }
+        addLocalRewards(s, a, 1.0, rew);
+
+        // Each group credits its local joint action with its own return.
+        const auto & A = model_.getA();
+        for (size_t g = 0; g < groups_.size(); ++g)
+            graph_.update(b, offsets_[g] + toIndexPartial(groups_[g], A, a), rew[g]);
+
+        return rew;
+    }
+
+    Vector MCTS::rollout(State s, unsigned depth) {
+        AI_PROFILE_SCOPE(stats_.rolloutTime);
+
+        const auto & A = model_.getA();
+        Action a(A.size());
+        State s1(s.size());
+
+        Vector totalRew = Vector::Zero(groups_.size());
+        double gamma = 1.0;
+        for ( ; depth < maxDepth_; ++depth) {
+            for (size_t i = 0; i < A.size(); ++i)
+                a[i] = std::uniform_int_distribution<size_t>(0, A[i] - 1)(rand_);
+
+            model_.sampleSR(s, a, &s1);
+            addLocalRewards(s, a, gamma, totalRew);
+            std::swap(s, s1);
+
+            gamma *= model_.getDiscount();
+        }
+        return totalRew;
+    }
+
+    void MCTS::addLocalRewards(const State & s, const Action & a, const double gamma, Vector & rew) const {
+        const auto & S = model_.getS();
+        const auto & A = model_.getA();
+        const auto & bases = model_.getRewardFunction().bases;
+        for (size_t k = 0; k < bases.size(); ++k) {
+            const auto & basis = bases[k];
+            rew[rewardGroups_[k]] += gamma * basis.values(toIndexPartial(basis.tag, S, s), toIndexPartial(basis.actionTag, A, a));
+        }
+    }
+
+    Action MCTS::findBestBonusA(const NodeId b, const unsigned count) {
+        AI_PROFILE_SCOPE(stats_.selectionTime);
+
+        const auto V = graph_.getValues(b);
+        const auto N = graph_.getCounts(b);
+        const auto Q = graph_.getSquares(b);
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            const auto o = offsets_[g], size = offsets_[g+1] - o;
+            // Untried local actions have infinite score, which
+            // VariableElimination handles like any other value.
+            bonus_(exploration_, count, V + o, N + o, Q + o, size, buffer_.data() + o);
+            scores_.bases[g].values = Eigen::Map<const Vector>(buffer_.data() + o, size);
+        }
+        return std::get<0>(ve_(scores_));
+    }
+
+    Action MCTS::findBestA(const NodeId b) {
+        const auto V = graph_.getValues(b);
+        const auto N = graph_.getCounts(b);
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            const auto o = offsets_[g], size = offsets_[g+1] - o;
+
+            // Untried local actions are put below all tried ones of their
+            // group; VariableElimination cannot select infinitely bad actions.
+            double worst = 0.0;
+            bool tried = false;
+            for (size_t i = o; i < o + size; ++i) {
+                if (!N[i]) continue;
+                worst = tried ? std::min(worst, V[i]) : V[i];
+                tried = true;
+            }
+            auto & values = scores_.bases[g].values;
+            values.resize(size);
+            for (size_t i = 0; i < size; ++i)
+                values[i] = N[o + i] ? V[o + i] : worst - 1.0;
+        }
+        return std::get<0>(ve_(scores_));
+    }
+
+    size_t MCTS::getChildKey(const Action & a, const State & s1) {
+        size_t key = boost::hash_range(std::begin(a), std::end(a));
+        boost::hash_range(key, std::begin(s1), std::end(s1));
+        return key;
+    }
+
+    void MCTS::setIterations(const unsigned iter) { iterations_ = iter; }
+    void MCTS::setExploration(const double exp) { exploration_ = exp; }
+    void MCTS::setMaxMemory(const size_t bytes) { maxMemory_ = bytes; }
+
+    const CooperativeModel & MCTS::getModel() const { return model_; }
+    const std::vector<PartialKeys> & MCTS::getGroups() const { return groups_; }
+    size_t MCTS::getGroupOffset(const size_t g) const { return offsets_[g]; }
+    const MCTS::Graph & MCTS::getGraph() const { return graph_; }
+    unsigned MCTS::getIterations() const { return iterations_; }
+    double MCTS::getExploration() const { return exploration_; }
+    size_t MCTS::getMaxMemory() const { return maxMemory_; }
+    const SearchStatistics & MCTS::getSearchStatistics() const { return stats_; }
+}
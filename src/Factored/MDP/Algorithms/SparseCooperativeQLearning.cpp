@@ -2,11 +2,36 @@
 
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
-#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::Factored::MDP {
+    namespace {
+        // Transitions of a batch are processed in chunks of this size,
+        // each with its own VariableElimination.
+        constexpr size_t BatchChunk = 64;
+
+        template <typename Iterable>
+        double computeQ(const size_t agent, const Iterable & rules) {
+            double sum = 0.0;
+            for (const auto & rule : rules)
+                sum += sequential_sorted_contains(rule.action.first, agent) ? rule.value / rule.action.first.size() : 0.0;
+            return sum;
+        }
+
+        template <typename Before, typename After, typename R>
+        double computeUpdate(const QFunctionRule & br, const Before & beforeRules, const After & afterRules, const R & rew, const double discount) {
+            double sum = 0;
+            for (const auto agent : br.action.first) {
+                sum += rew(agent);
+                sum += discount * computeQ(agent, afterRules);
+                sum -= computeQ(agent, beforeRules);
+            }
+            return sum;
+        }
+    }
+
     SparseCooperativeQLearning::SparseCooperativeQLearning(State s, Action a, const double discount, const double alpha) :
-            S(std::move(s)), A(std::move(a)), discount_(discount), alpha_(alpha), rules_(join(S, A)) {}
+            S(std::move(s)), A(std::move(a)), discount_(discount), alpha_(alpha), rules_(join(S, A)), version_(0), ve_(A) {}
 
     void SparseCooperativeQLearning::reserveRules(const size_t s) {
         rules_.reserve(s);
@@ -15,6 +40,7 @@ namespace AIToolbox::Factored::MDP {
     void SparseCooperativeQLearning::insertRule(QFunctionRule rule) {
         auto factor = join(S.size(), rule.state, rule.action);
         rules_.emplace(factor, std::move(rule));
+        ++version_;
     }
 
     size_t SparseCooperativeQLearning::rulesSize() const {
@@ -22,41 +48,80 @@ namespace AIToolbox::Factored::MDP {
     }
 
     Action SparseCooperativeQLearning::stepUpdateQ(const State & s, const Action & a, const State & s1, const Rewards & rew) {
-        Bandit::VariableElimination ve(A);
+        const auto rules = rules_.filter(s1, 0, &rulesIds_); // Partial filter using only s1
+        const auto a1 = std::get<0>(ve_(rules));
 
-        const auto rules = rules_.filter(s1, 0); // Partial filter using only s1
-        const auto a1 = std::get<0>(ve(rules));
+        auto beforeRules = rules_.filter(join(s, a), 0, &beforeIds_);
+        const auto afterRules = rules_.filter(join(s1, a1), 0, &afterIds_);
 
-        auto beforeRules = rules_.filter(join(s, a));
-        const auto afterRules = rules_.filter(join(s1, a1));
-
-        const auto computeQ = [](const size_t agent, const decltype(rules_)::Iterable & rules) {
-            double sum = 0.0;
-            for (const auto & rule : rules)
-                sum += sequential_sorted_contains(rule.action.first, agent) ? rule.value / rule.action.first.size() : 0.0;
-            return sum;
-        };
         // First we compute all updates since we don't want to risk
         // overwriting the rules before we are done.
-        std::vector<double> updates;
-        updates.reserve(beforeRules.size());
-        for (const auto & br : beforeRules) {
-            double sum = 0;
-            for (const auto agent : br.action.first) {
-                sum += rew[agent];
-                sum += discount_ * computeQ(agent, afterRules);
-                sum -= computeQ(agent, beforeRules);
-            }
-            updates.push_back(alpha_ * sum);
-        }
+        const auto r = [&rew](const size_t agent) { return rew[agent]; };
+        auto & updates = updates_;
+        updates.clear();
+        for (const auto & br : beforeRules)
+            updates.push_back(alpha_ * computeUpdate(br, beforeRules, afterRules, r, discount_));
+
         // Finally update the rules.
         size_t i = 0;
         for (auto & br : beforeRules)
             br.value += updates[i++];
+        ++version_;
 
         return a1;
     }
 
+    void SparseCooperativeQLearning::batchUpdateQ(const TransitionBatch & batch, ThreadPool * pool) {
+        const size_t SF = S.size(), AF = A.size();
+        const size_t N = batch.actions.size() / AF;
+        const size_t chunks = (N + BatchChunk - 1) / BatchChunk;
+
+        // The ids of the rules to update and their updates, for each
+        // chunk in the order of its transitions.
+        std::vector<std::vector<std::pair<size_t, double>>> updates(chunks);
+
+        const auto & rules = rules_;
+        const auto work = [&](const size_t cBegin, const size_t cEnd) {
+            Bandit::VariableElimination ve(A);
+            State s(SF), s1(SF);
+            Action a(AF);
+            std::vector<size_t> rulesIds, beforeIds, afterIds;
+
+            for (size_t c = cBegin; c < cEnd; ++c) {
+                const size_t end = std::min(N, (c + 1) * BatchChunk);
+                for (size_t n = c * BatchChunk; n < end; ++n) {
+                    for (size_t i = 0; i < SF; ++i) {
+                        s[i]  = batch.states[i * N + n];
+                        s1[i] = batch.nextStates[i * N + n];
+                    }
+                    for (size_t i = 0; i < AF; ++i)
+                        a[i] = batch.actions[i * N + n];
+
+                    const auto a1 = std::get<0>(ve(rules.filter(s1, 0, &rulesIds)));
+
+                    const auto beforeRules = rules.filter(join(s, a), 0, &beforeIds);
+                    const auto afterRules = rules.filter(join(s1, a1), 0, &afterIds);
+
+                    const auto r = [&batch, N, n](const size_t agent) { return batch.rewards[agent * N + n]; };
+                    size_t i = 0;
+                    for (const auto & br : beforeRules)
+                        updates[c].emplace_back(beforeIds[i++], alpha_ * computeUpdate(br, beforeRules, afterRules, r, discount_));
+                }
+            }
+        };
+
+        if (pool) pool->parallelFor(chunks, work);
+        else      work(0, chunks);
+
+        // Applying the updates serially in order keeps the result
+        // deterministic.
+        auto items = std::begin(rules_);
+        for (const auto & chunk : updates)
+            for (const auto & [id, update] : chunk)
+                items[id].value += update;
+        ++version_;
+    }
+
     void SparseCooperativeQLearning::setLearningRate(const double a) {
         if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Learning rate parameter must be in (0,1]");
         alpha_ = a;
@@ -73,4 +138,5 @@ namespace AIToolbox::Factored::MDP {
     const Action & SparseCooperativeQLearning::getA() const { return A; }
     double SparseCooperativeQLearning::getDiscount() const { return discount_; }
     const FactoredContainer<QFunctionRule> & SparseCooperativeQLearning::getQFunctionRules() const { return rules_; }
+    const unsigned long & SparseCooperativeQLearning::getVersion() const { return version_; }
 }
@@ -2,19 +2,62 @@
 
 #include <AIToolbox/LP.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace AIToolbox::Factored::MDP {
+    // The minimum number of rule matches performed in a single elimination
+    // for it to be split between the threads of the pool.
+    constexpr size_t ParallelWork = 4096;
+
     // Optimizations TODO:
     //     Use sparse pushRow to add rows.
     //     Add multiple columns at the same time.
     //     Reserve memory in advance for both rows and cols.
     //     Remove initial variables - "paste" them in.
 
+    FactoredLP::FactoredLP(State s) : S(std::move(s)), pool_(nullptr), constantBasis_(false), builds_(0) {}
+
+    FactoredLP::~FactoredLP() = default;
+
+    void FactoredLP::setThreadPool(ThreadPool * pool) { pool_ = pool; }
+    ThreadPool * FactoredLP::getThreadPool() const { return pool_; }
+    size_t FactoredLP::getBuildCount() const { return builds_; }
+
     std::optional<Vector> FactoredLP::operator()(const FactoredVector & C, const FactoredVector & b, bool addConstantBasis) {
+        const auto sameScopes = [](const FactoredVector & fv, const std::vector<PartialKeys> & tags) {
+            if (fv.bases.size() != tags.size()) return false;
+            for (size_t i = 0; i < tags.size(); ++i)
+                if (fv.bases[i].tag != tags[i]) return false;
+            return true;
+        };
+
+        const auto phiId = C.bases.size() + (addConstantBasis); // Skip ws since we want to extract those later.
+
+        // The structure of the LP only depends on the scopes of the input
+        // functions, while their values only appear in the initial rows. If
+        // the scopes are the same as in the last call we simply rewrite those
+        // rows in place and re-solve the same LP.
+        if (lp_ && addConstantBasis == constantBasis_ && sameScopes(C, cTags_) && sameScopes(b, bTags_)) {
+            lp_->row.setZero();
+            setRules(C, b, false);
+            return lp_->resolve(phiId);
+        }
+
+        buildLP(C, b, addConstantBasis);
+        return lp_->solve(phiId);
+    }
+
+    void FactoredLP::buildLP(const FactoredVector & C, const FactoredVector & b, const bool addConstantBasis) {
+        ++builds_;
+        constantBasis_ = addConstantBasis;
+        cTags_.clear();
+        for (const auto & f : C.bases) cTags_.push_back(f.tag);
+        bTags_.clear();
+        for (const auto & f : b.bases) bTags_.push_back(f.tag);
+
         // Clear everything so we can use this function multiple times.
         Graph graph(S.size());
         std::vector<size_t> finalFactors;
-
         // C = set of basis functions
         // B = set of target functions
 
@@ -52,66 +95,32 @@ namespace AIToolbox::Factored::MDP {
         for (const auto & f : b.bases) startingVars += f.values.size() * 2;
 
         // Init LP with starting variables
-        LP lp(startingVars);
+        lp_ = std::make_unique<LP>(startingVars);
+        auto & lp = *lp_;
         lp.setObjective(phiId, false); // Minimize phi
         lp.row.setZero();
 
-        // Compute constant basis useful values (only used if needed)
-        const auto constBasisId = phiId - 1;
-        const double constBasisCoeff = 1.0 / C.bases.size();
-
         // In this initial setup, we simply kind of give a "name"/"variable" to
         // each assignment of the original Cw and b functions - note that all
-        // operators are equalities here. In the first loop we do C (which is
-        // thus associated with the weights), and in the second b (which is
-        // not).
+        // operators are equalities here. These rules are the only ones which
+        // depend on the values of C and b, and they are pushed first so that
+        // setRules() can find them again.
         //
         // This is not strictly necessary and could be optimized away, but for
         // now it is like this to make the removeState() code uniform as it
         // just needs to reference the constraints in the graph.
-        size_t currentWeight = 0;
-        size_t currentRule = phiId + 1; // Skip ws + phi
-        for (const auto & f : C.bases) {
-            auto newFactor = graph.getFactor(f.tag);
-            PartialFactorsEnumerator s(S, f.tag);
-
-            for (size_t i = 0; s.isValid(); s.advance(), ++i) {
-                lp.row[currentRule] = -1.0;
-                lp.row[currentWeight] = f.values[i];
-                if (addConstantBasis) lp.row[constBasisId] = constBasisCoeff;
-                lp.pushRow(LP::Constraint::Equal, 0.0);
-                lp.row[currentRule] = 0.0;
+        setRules(C, b, true);
 
-                lp.row[currentRule+1] = -1.0;
-                lp.row[currentWeight] = -f.values[i];
-                if (addConstantBasis) lp.row[constBasisId] = -constBasisCoeff;
-                lp.pushRow(LP::Constraint::Equal, 0.0);
-                lp.row[currentRule+1] = 0.0;
-
-                newFactor->getData().emplace_back(s->second, currentRule);
-                currentRule += 2;
-            }
-            lp.row[currentWeight++] = 0.0;
-        }
-        lp.row[constBasisId] = 0.0;
-
-        // Here signs are opposite to those of C since we need to find (Cw - b)
-        // and (b - Cw)
-        for (const auto & f : b.bases) {
-            auto newFactor = graph.getFactor(f.tag);
-            PartialFactorsEnumerator s(S, f.tag);
-
-            for (size_t i = 0; s.isValid(); s.advance(), ++i) {
-                lp.row[currentRule] = 1.0;
-                lp.pushRow(LP::Constraint::Equal, -f.values[i]);
-                lp.row[currentRule] = 0.0;
-
-                lp.row[currentRule+1] = 1.0;
-                lp.pushRow(LP::Constraint::Equal, f.values[i]);
-                lp.row[currentRule+1] = 0.0;
-
-                newFactor->getData().emplace_back(s->second, currentRule);
-                currentRule += 2;
+        size_t currentRule = phiId + 1; // Skip ws + phi
+        for (const auto * fv : {&C, &b}) {
+            for (const auto & f : fv->bases) {
+                auto newFactor = graph.getFactor(f.tag);
+                PartialFactorsEnumerator s(S, f.tag);
+
+                for (; s.isValid(); s.advance()) {
+                    newFactor->getData().emplace_back(s->second, currentRule);
+                    currentRule += 2;
+                }
             }
         }
 
@@ -123,6 +132,9 @@ namespace AIToolbox::Factored::MDP {
         // is a vector) at a time, maximizing on one of the State components at
         // a time. We don't really do anything here aside from creating new
         // constraints in the LP, and giving them "names".
+        //
+        // The elimination order is fixed (last variable first), so that the
+        // same scopes always produce the same LP.
         while (graph.variableSize())
             removeState(graph, graph.variableSize() - 1, lp, finalFactors);
 
@@ -147,10 +159,62 @@ namespace AIToolbox::Factored::MDP {
         // be limited to positive (which may be the default).
         for (int i = 0; i < lp.row.size(); ++i)
             lp.setUnbounded(i);
+    }
 
-        // Finally, try to solve the LP and find out the coefficients to
-        // approximate b using C!
-        return lp.solve(phiId);
+    void FactoredLP::setRules(const FactoredVector & C, const FactoredVector & b, const bool push) {
+        auto & lp = *lp_;
+        size_t rowId = 0;
+        const auto writeRow = [&](const LP::Constraint c, const double value) {
+            if (push) lp.pushRow(c, value);
+            else      lp.setRow(rowId, c, value);
+            ++rowId;
+        };
+
+        const auto phiId = C.bases.size() + (constantBasis_);
+
+        // Compute constant basis useful values (only used if needed)
+        const auto constBasisId = phiId - 1;
+        const double constBasisCoeff = 1.0 / C.bases.size();
+
+        // In the first loop we do C (which is thus associated with the
+        // weights), and in the second b (which is not).
+        size_t currentWeight = 0;
+        size_t currentRule = phiId + 1; // Skip ws + phi
+        for (const auto & f : C.bases) {
+            for (int i = 0; i < f.values.size(); ++i) {
+                lp.row[currentRule] = -1.0;
+                lp.row[currentWeight] = f.values[i];
+                if (constantBasis_) lp.row[constBasisId] = constBasisCoeff;
+                writeRow(LP::Constraint::Equal, 0.0);
+                lp.row[currentRule] = 0.0;
+
+                lp.row[currentRule+1] = -1.0;
+                lp.row[currentWeight] = -f.values[i];
+                if (constantBasis_) lp.row[constBasisId] = -constBasisCoeff;
+                writeRow(LP::Constraint::Equal, 0.0);
+                lp.row[currentRule+1] = 0.0;
+
+                currentRule += 2;
+            }
+            lp.row[currentWeight++] = 0.0;
+        }
+        lp.row[constBasisId] = 0.0;
+
+        // Here signs are opposite to those of C since we need to find (Cw - b)
+        // and (b - Cw)
+        for (const auto & f : b.bases) {
+            for (int i = 0; i < f.values.size(); ++i) {
+                lp.row[currentRule] = 1.0;
+                writeRow(LP::Constraint::Equal, -f.values[i]);
+                lp.row[currentRule] = 0.0;
+
+                lp.row[currentRule+1] = 1.0;
+                writeRow(LP::Constraint::Equal, f.values[i]);
+                lp.row[currentRule+1] = 0.0;
+
+                currentRule += 2;
+            }
+        }
     }
 
     void FactoredLP::removeState(Graph & graph, size_t s, LP & lp, std::vector<size_t> & finalFactors) {
@@ -159,6 +223,7 @@ namespace AIToolbox::Factored::MDP {
 
         PartialFactorsEnumerator jointActions(S, variables, s);
         const auto id = jointActions.getFactorToSkipId();
+        const size_t N = jointActions.size();
         Rules newRules;
 
         // We'll now create new rules that represent the elimination of the
@@ -167,42 +232,78 @@ namespace AIToolbox::Factored::MDP {
         // Cw).
         const bool isFinalFactor = variables.size() == 1;
 
-        while (jointActions.isValid()) {
-            auto & jointAction = *jointActions;
+        // Finding the rules that match each assignment is the expensive
+        // part, and each assignment is independent. So we first collect the
+        // matches for all of them, possibly in parallel, and then we add
+        // the constraints to the LP serially in the usual order.
+        size_t rulesNum = 0;
+        for (const auto ruleIds : factors)
+            rulesNum += ruleIds->getData().size();
+
+        std::vector<std::vector<size_t>> matches(N * S[s]);
+        const auto process = [&](const size_t begin, const size_t end) {
+            // Decode the first joint action of the range.
+            PartialValues jointAction(variables.size(), 0);
+            for (size_t i = 0, n = begin; i < variables.size(); ++i) {
+                if (i == id) continue;
+                jointAction[i] = n % S[variables[i]];
+                n /= S[variables[i]];
+            }
+
+            for (size_t n = begin; n < end; ++n) {
+                for (size_t sAction = 0; sAction < S[s]; ++sAction) {
+                    auto & m = matches[n * S[s] + sAction];
 
+                    jointAction[id] = sAction;
+                    for (const auto ruleIds : factors)
+                        for (const auto & ruleId : ruleIds->getData())
+                            if (match(ruleIds->getVariables(), ruleId.first, variables, jointAction))
+                                m.push_back(ruleId.second);
+                }
+
+                // Move to the next joint action.
+                for (size_t i = 0; i < variables.size(); ++i) {
+                    if (i == id) continue;
+                    if (++jointAction[i] < S[variables[i]]) break;
+                    jointAction[i] = 0;
+                }
+            }
+        };
+
+        if (pool_ && N * S[s] * rulesNum >= ParallelWork)
+            pool_->parallelFor(N, process);
+        else
+            process(0, N);
+
+        for (size_t n = 0; jointActions.isValid(); jointActions.advance(), ++n) {
             const size_t newRuleId = lp.row.size();
 
             lp.addColumn();
             lp.addColumn();
 
             for (size_t sAction = 0; sAction < S[s]; ++sAction) {
+                const auto & m = matches[n * S[s] + sAction];
+
                 lp.row.setZero();
                 lp.row[newRuleId] = -1.0;
-
-                jointAction.second[id] = sAction;
-                for (const auto ruleIds : factors)
-                    for (const auto ruleId : ruleIds->getData())
-                        if (match(ruleIds->getVariables(), ruleId.first, jointAction.first, jointAction.second))
-                            lp.row[std::get<1>(ruleId)] = 1.0;
+                for (const auto ruleId : m)
+                    lp.row[ruleId] = 1.0;
 
                 lp.pushRow(LP::Constraint::LessEqual, 0.0);
 
                 // Now do the reverse for all opposite rules (same rules +1)
-                for (int i = lp.row.size() - 2; i >= 0; --i) {
-                    if (lp.row[i] != 0.0) {
-                        lp.row[i+1] = lp.row[i];
-                        lp.row[i] = 0.0;
-                    }
-                }
+                lp.row.setZero();
+                lp.row[newRuleId+1] = -1.0;
+                for (const auto ruleId : m)
+                    lp.row[ruleId+1] = 1.0;
+
                 lp.pushRow(LP::Constraint::LessEqual, 0.0);
             }
 
             if (!isFinalFactor)
-                newRules.emplace_back(jointAction.second, newRuleId);
+                newRules.emplace_back(jointActions->second, newRuleId);
             else
                 finalFactors.push_back(newRuleId);
-
-            jointActions.advance();
         }
 
         // And finally as usual in variable elimination remove the variable
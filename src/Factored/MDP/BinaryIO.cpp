@@ -0,0 +1,185 @@
+#include <AIToolbox/Factored/MDP/BinaryIO.hpp>
+
+#include <AIToolbox/Factored/MDP/CooperativeExperience.hpp>
+
+#include <AIToolbox/Impl/Logging.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace AIToolbox::Factored::MDP {
+    namespace {
+        constexpr char Magic[8] = {'A', 'I', 'T', 'B', 'X', 'F', 'M', 'D'};
+        constexpr std::uint32_t ByteOrderMark = 0x01020304;
+        constexpr std::uint32_t ExperienceTableType = 1;
+        // All arrays start at this alignment in the file.
+        constexpr size_t Alignment = 64;
+
+        // The columns of an experience table: factor, action, parent,
+        // next state, visits and rewards.
+        constexpr size_t Columns = 6;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t type;
+            std::uint32_t byteOrder;
+            std::uint32_t reserved0;
+            std::uint64_t stateFactors;
+            std::uint64_t actionFactors;
+            std::uint64_t rows;
+            std::uint64_t columns;
+            std::uint64_t reserved1;
+        };
+        static_assert(sizeof(Header) == Alignment);
+
+        struct Table {
+            std::vector<std::uint64_t> factors, actions, parents, nextStates;
+            std::vector<long> visits;
+            std::vector<double> rewards;
+        };
+
+        size_t padding(const size_t bytes) {
+            return (Alignment - bytes % Alignment) % Alignment;
+        }
+
+        std::istream & fail(std::istream & is, const char * error) {
+            AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Invalid experience table: " << error);
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+
+        template <typename T>
+        void writeArray(std::ostream & os, const T * data, const size_t n) {
+            static constexpr char zeros[Alignment] = {};
+            os.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+            os.write(zeros, padding(n * sizeof(T)));
+        }
+
+        template <typename T>
+        bool readArray(std::istream & is, T * data, const size_t n) {
+            if ( !is.read(reinterpret_cast<char *>(data), n * sizeof(T)) ) return false;
+            return static_cast<bool>(is.ignore(padding(n * sizeof(T))));
+        }
+
+        template <typename V>
+        std::vector<std::uint64_t> toSizes(const V & v) {
+            return std::vector<std::uint64_t>(std::begin(v), std::end(v));
+        }
+    }
+
+    std::ostream & writeExperienceTable(std::ostream & os, const CooperativeExperience & exp) {
+        const auto & S = exp.getS();
+        const auto & visits = exp.getVisitTable();
+        const auto & rewards = exp.getRewardMatrix();
+
+        Table t;
+        for ( size_t i = 0; i < S.size(); ++i ) {
+            for ( size_t a = 0; a < visits[i].size(); ++a ) {
+                const auto & v = visits[i][a];
+                const auto & r = rewards[i].nodes[a].matrix;
+                for ( long p = 0; p < v.rows(); ++p ) {
+                    // The last column contains the sums.
+                    if ( !v(p, S[i]) ) continue;
+                    for ( size_t s1 = 0; s1 < S[i]; ++s1 ) {
+                        if ( !v(p, s1) ) continue;
+                        t.factors.push_back(i);
+                        t.actions.push_back(a);
+                        t.parents.push_back(p);
+                        t.nextStates.push_back(s1);
+                        t.visits.push_back(v(p, s1));
+                        t.rewards.push_back(r(p, s1));
+                    }
+                }
+            }
+        }
+
+        const auto sSizes = toSizes(S);
+        const auto aSizes = toSizes(exp.getA());
+        const size_t rows = t.factors.size();
+
+        Header h;
+        std::memset(&h, 0, sizeof(Header));
+        std::memcpy(h.magic, Magic, sizeof(Magic));
+        h.version = BinaryFormatVersion;
+        h.type = ExperienceTableType;
+        h.byteOrder = ByteOrderMark;
+        h.stateFactors = sSizes.size();
+        h.actionFactors = aSizes.size();
+        h.rows = rows;
+        h.columns = Columns;
+
+        writeArray(os, &h, 1);
+        writeArray(os, sSizes.data(), sSizes.size());
+        writeArray(os, aSizes.data(), aSizes.size());
+        writeArray(os, t.factors.data(), rows);
+        writeArray(os, t.actions.data(), rows);
+        writeArray(os, t.parents.data(), rows);
+        writeArray(os, t.nextStates.data(), rows);
+        writeArray(os, t.visits.data(), rows);
+        writeArray(os, t.rewards.data(), rows);
+
+        return os;
+    }
+
+    std::istream & readExperienceTable(std::istream & is, CooperativeExperience & exp) {
+        const auto & S = exp.getS();
+
+        Header h;
+        if ( !readArray(is, &h, 1) )                            return fail(is, "could not read header");
+        if ( std::memcmp(h.magic, Magic, sizeof(Magic)) )       return fail(is, "not an AIToolbox factored binary file");
+        if ( h.version != BinaryFormatVersion )                 return fail(is, "unsupported binary format version");
+        if ( h.byteOrder != ByteOrderMark )                     return fail(is, "file was written with a different byte order");
+        if ( h.type != ExperienceTableType || h.columns != Columns )
+                                                                return fail(is, "file contains a different type of object");
+
+        std::vector<std::uint64_t> sSizes(h.stateFactors), aSizes(h.actionFactors);
+        if ( !readArray(is, sSizes.data(), sSizes.size()) ||
+             !readArray(is, aSizes.data(), aSizes.size()) )     return fail(is, "could not read the spaces");
+        if ( sSizes != toSizes(S) || aSizes != toSizes(exp.getA()) )
+                                                                return fail(is, "file was written for different spaces");
+
+        const size_t rows = h.rows;
+        Table t;
+        t.factors.resize(rows);
+        t.actions.resize(rows);
+        t.parents.resize(rows);
+        t.nextStates.resize(rows);
+        t.visits.resize(rows);
+        t.rewards.resize(rows);
+        if ( !readArray(is, t.factors.data(), rows) ||
+             !readArray(is, t.actions.data(), rows) ||
+             !readArray(is, t.parents.data(), rows) ||
+             !readArray(is, t.nextStates.data(), rows) ||
+             !readArray(is, t.visits.data(), rows) ||
+             !readArray(is, t.rewards.data(), rows) )          return fail(is, "could not read the columns");
+
+        // We check all rows before modifying the experience.
+        for ( size_t j = 0; j < rows; ++j ) {
+            const auto i = t.factors[j], a = t.actions[j];
+            if ( i >= S.size() || a >= exp.visits_[i].size() ||
+                 t.parents[j] >= static_cast<size_t>(exp.visits_[i][a].rows()) ||
+                 t.nextStates[j] >= S[i] || t.visits[j] < 0 )   return fail(is, "row out of range");
+        }
+
+        for ( size_t j = 0; j < rows; ++j ) {
+            const auto i = t.factors[j], a = t.actions[j], p = t.parents[j], s1 = t.nextStates[j];
+
+            auto & v = exp.visits_[i][a];
+            auto & r = exp.rewards_[i].nodes[a].matrix;
+            v(p, s1)   += t.visits[j];
+            v(p, S[i]) += t.visits[j];
+            r(p, s1)   += t.rewards[j];
+            r(p, S[i]) += t.rewards[j];
+
+            auto & dirty = exp.dirtyRows_[i][a][p];
+            if ( !dirty ) {
+                dirty = true;
+                exp.dirty_[i].emplace_back(a, p);
+            }
+        }
+
+        return is;
+    }
+}
@@ -9,6 +9,8 @@ namespace AIToolbox::Factored::MDP {
         // init visits with unsigned structure
         rewards_ = std::move(structure);
         visits_.resize(rewards_.size());
+        dirtyRows_.resize(rewards_.size());
+        dirty_.resize(rewards_.size());
 
         for (size_t i = 0; i < S.size(); ++i) {
             visits_[i].reserve(rewards_[i].nodes.size());
@@ -22,6 +24,7 @@ namespace AIToolbox::Factored::MDP {
                 rNode.matrix.setZero();
                 visits_[i].emplace_back(rows, S[i]+1);
                 visits_[i].back().setZero();
+                dirtyRows_[i].emplace_back(rows, false);
             }
         }
         indeces_.resize(S.size());
@@ -45,6 +48,12 @@ namespace AIToolbox::Factored::MDP {
 
             // Save indeces to return to avoid recomputation.
             indeces_[i] = {actionId, parentId};
+
+            auto & dirty = dirtyRows_[i][actionId][parentId];
+            if (!dirty) {
+                dirty = true;
+                dirty_[i].emplace_back(actionId, parentId);
+            }
         }
         return indeces_;
     }
@@ -56,6 +65,19 @@ namespace AIToolbox::Factored::MDP {
                 visits_[i][a].setZero();
             }
         }
+        clearDirty();
+    }
+
+    const CooperativeExperience::DirtyIndeces & CooperativeExperience::getDirtyIndeces() const {
+        return dirty_;
+    }
+
+    void CooperativeExperience::clearDirty() {
+        for (size_t i = 0; i < dirty_.size(); ++i) {
+            for (const auto & [a, p] : dirty_[i])
+                dirtyRows_[i][a][p] = false;
+            dirty_[i].clear();
+        }
     }
 
     const CooperativeExperience::VisitTable & CooperativeExperience::getVisitTable() const {
@@ -3,13 +3,19 @@
 #include <AIToolbox/Impl/Seeder.hpp>
 #include <AIToolbox/Utils/Probability.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/Philox.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <algorithm>
 
 namespace AIToolbox::Factored::MDP {
+    // The number of transitions of a batch sampled with the same engine.
+    constexpr size_t BatchChunk = 1024;
 
     CooperativeModel::CooperativeModel(State s, Action a, FactoredDDN transitions, FactoredMatrix2D rewards, const double discount) :
             S(std::move(s)), A(std::move(a)), discount_(discount),
             transitions_(std::move(transitions)), rewards_(std::move(rewards)),
-            rand_(Impl::Seeder::getSeed())
+            rand_(Impl::Seeder::getSeed()), aliasSampling_(false)
     {
         // Now we validate both the transition function and the rewards.
         if (transitions_.nodes.size() != S.size())
@@ -107,6 +113,38 @@ namespace AIToolbox::Factored::MDP {
             if (r.values.rows() != static_cast<long>(factorSpacePartial(r.tag, S)))
                 throw std::invalid_argument("Input reward function contains bases with incorrect number of rows!");
         }
+
+        actionStrides_.reserve(S.size());
+        parentStrides_.resize(S.size());
+        for (size_t s = 0; s < S.size(); ++s) {
+            const auto & node = transitions_.nodes[s];
+
+            actionStrides_.push_back(FactorSpace(A, node.actionTag).getStrides());
+            for (const auto & subnode : node.nodes)
+                parentStrides_[s].push_back(FactorSpace(S, subnode.tag).getStrides());
+        }
+
+        // The values of each basis are row-major, so the strides of the
+        // states are multiplied by the number of columns.
+        rewardBases_.reserve(rewards_.bases.size());
+        for (const auto & r : rewards_.bases) {
+            RewardBasis basis;
+            basis.offset = rewardValues_.size();
+            basis.scopeBegin = rewardScopes_.size();
+
+            const auto sStrides = FactorSpace(S, r.tag).getStrides();
+            for (size_t k = 0; k < r.tag.size(); ++k)
+                rewardScopes_.emplace_back(r.tag[k], sStrides[k] * r.values.cols());
+            basis.stateEnd = rewardScopes_.size();
+
+            const auto aStrides = FactorSpace(A, r.actionTag).getStrides();
+            for (size_t k = 0; k < r.actionTag.size(); ++k)
+                rewardScopes_.emplace_back(r.actionTag[k], aStrides[k]);
+            basis.actionEnd = rewardScopes_.size();
+
+            rewardValues_.insert(std::end(rewardValues_), r.values.data(), r.values.data() + r.values.size());
+            rewardBases_.push_back(basis);
+        }
     }
 
     std::tuple<State, double> CooperativeModel::sampleSR(const State & s, const Action & a) const {
@@ -125,20 +163,143 @@ namespace AIToolbox::Factored::MDP {
             const auto & node = transitions_[i].nodes[actionId];
             const auto parentId = toIndexPartial(node.tag, S, s);
 
-            const size_t newS = sampleProbability(S[i], node.matrix.row(parentId), rand_);
+            const size_t newS = aliasSampling_ ? samplers_[i].sampleProbability(samplerOffsets_[i][actionId] + parentId, rand_)
+                                               : sampleProbability(S[i], node.matrix.row(parentId), rand_);
 
             s1[i] = newS;
         }
 
-        return rewards_.getValue(S, A, s, a);
+        return getExpectedReward(s, a, s1);
+    }
+
+    void CooperativeModel::sampleSR(TransitionBatch * batchp, ThreadPool * pool) const {
+        auto & batch = *batchp;
+        const size_t N = batch.states.size() / S.size();
+
+        batch.nextStates.resize(N * S.size());
+        batch.rewards.resize(N);
+
+        // Each chunk has its own engine, so that the result does not
+        // depend on how chunks are split between threads.
+        const unsigned seed = rand_();
+        const size_t chunks = (N + BatchChunk - 1) / BatchChunk;
+
+        const auto process = [&](const size_t begin, const size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                auto rnd = makeEngineStream<RandomEngine>(seed, c);
+                const size_t nBegin = c * BatchChunk;
+                const size_t nEnd = std::min(N, nBegin + BatchChunk);
+
+                // We sample one factor at a time for all transitions of
+                // the chunk, as their parents are contiguous in the batch.
+                for (size_t i = 0; i < S.size(); ++i) {
+                    const auto & actionTag = transitions_[i].actionTag;
+                    const auto & aStrides = actionStrides_[i];
+                    auto * s1 = batch.nextStates.data() + i * N;
+
+                    for (size_t n = nBegin; n < nEnd; ++n) {
+                        size_t actionId = 0;
+                        for (size_t k = 0; k < actionTag.size(); ++k)
+                            actionId += aStrides[k] * batch.actions[actionTag[k] * N + n];
+
+                        const auto & node = transitions_[i].nodes[actionId];
+                        const auto & pStrides = parentStrides_[i][actionId];
+
+                        size_t parentId = 0;
+                        for (size_t k = 0; k < node.tag.size(); ++k)
+                            parentId += pStrides[k] * batch.states[node.tag[k] * N + n];
+
+                        s1[n] = aliasSampling_ ? samplers_[i].sampleProbability(samplerOffsets_[i][actionId] + parentId, rnd)
+                                               : sampleProbability(S[i], node.matrix.row(parentId), rnd);
+                    }
+                }
+
+                computeRewards(batch, N, nBegin, nEnd);
+            }
+        };
+
+        if (pool)
+            pool->parallelFor(chunks, process);
+        else
+            process(0, chunks);
+    }
+
+    void CooperativeModel::setAliasSampling(const bool enable) {
+        aliasSampling_ = enable;
+        samplers_.clear();
+        samplerOffsets_.clear();
+        if (!aliasSampling_) return;
+
+        samplers_.reserve(S.size());
+        samplerOffsets_.resize(S.size());
+        for (size_t s = 0; s < S.size(); ++s) {
+            std::vector<Matrix2D> matrices;
+            size_t offset = 0;
+            for (const auto & node : transitions_.nodes[s].nodes) {
+                matrices.push_back(node.matrix);
+                samplerOffsets_[s].push_back(offset);
+                offset += node.matrix.rows();
+            }
+            samplers_.emplace_back(matrices);
+        }
     }
 
+    bool CooperativeModel::getAliasSampling() const { return aliasSampling_; }
+
     double CooperativeModel::getTransitionProbability(const State & s, const Action & a, const State & s1) const {
         return transitions_.getTransitionProbability(S, A, s, a, s1);
     }
 
     double CooperativeModel::getExpectedReward(const State & s, const Action & a, const State &) const {
-        return rewards_.getValue(S, A, s, a);
+        double retval = 0.0;
+        for (const auto & basis : rewardBases_) {
+            size_t id = basis.offset;
+            size_t k = basis.scopeBegin;
+            for (; k < basis.stateEnd; ++k)
+                id += rewardScopes_[k].second * s[rewardScopes_[k].first];
+            for (; k < basis.actionEnd; ++k)
+                id += rewardScopes_[k].second * a[rewardScopes_[k].first];
+
+            retval += rewardValues_[id];
+        }
+        return retval;
+    }
+
+    void CooperativeModel::getExpectedRewards(TransitionBatch * batchp) const {
+        auto & batch = *batchp;
+        const size_t N = batch.states.size() / S.size();
+
+        batch.rewards.resize(N);
+        computeRewards(batch, N, 0, N);
+    }
+
+    void CooperativeModel::computeRewards(TransitionBatch & batch, const size_t N, const size_t begin, const size_t end) const {
+        auto * rewards = batch.rewards.data();
+        std::fill(rewards + begin, rewards + end, 0.0);
+
+        // We go over all transitions one basis at a time, so that the
+        // values of each basis stay in cache.
+        std::vector<size_t> ids(end - begin);
+        for (const auto & basis : rewardBases_) {
+            std::fill(std::begin(ids), std::end(ids), basis.offset);
+
+            size_t k = basis.scopeBegin;
+            for (; k < basis.stateEnd; ++k) {
+                const auto [factor, stride] = rewardScopes_[k];
+                const auto * values = batch.states.data() + factor * N;
+                for (size_t n = begin; n < end; ++n)
+                    ids[n - begin] += stride * values[n];
+            }
+            for (; k < basis.actionEnd; ++k) {
+                const auto [factor, stride] = rewardScopes_[k];
+                const auto * values = batch.actions.data() + factor * N;
+                for (size_t n = begin; n < end; ++n)
+                    ids[n - begin] += stride * values[n];
+            }
+
+            for (size_t n = begin; n < end; ++n)
+                rewards[n] += rewardValues_[ids[n - begin]];
+        }
     }
 
     const State & CooperativeModel::getS() const { return S; }
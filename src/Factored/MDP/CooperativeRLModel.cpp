@@ -1,9 +1,15 @@
 #include <AIToolbox/Factored/MDP/CooperativeRLModel.hpp>
 
 #include <AIToolbox/Utils/Probability.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 #include <iostream>
 
 namespace AIToolbox::Factored::MDP {
+    namespace {
+        // Minimum number of dirty rows before syncing in parallel.
+        constexpr size_t ParallelWork = 1024;
+    }
+
     CooperativeRLModel::CooperativeRLModel(const CooperativeExperience & exp, const double discount, const bool toSync)
             : experience_(exp), discount_(discount)
     {
@@ -116,6 +122,36 @@ namespace AIToolbox::Factored::MDP {
         }
     }
 
+    void CooperativeRLModel::syncDirty(ThreadPool * pool) {
+        const auto & vnodes = experience_.getVisitTable();
+        const auto & rnodes = experience_.getRewardMatrix();
+        const auto & dirty = experience_.getDirtyIndeces();
+
+        auto & tnodes = transitions_.nodes;
+        const auto & S = experience_.getS();
+
+        // Each state factor only writes to its own rows.
+        const auto work = [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                for (const auto & [aId, pId] : dirty[i]) {
+                    const double totalVisits = vnodes[i][aId](pId, S[i]);
+                    if (totalVisits == 0) continue;
+
+                    tnodes[i].nodes[aId].matrix.row(pId) = vnodes[i][aId].row(pId).head(S[i]).cast<double>() / totalVisits;
+
+                    rewards_[i][aId][pId] = rnodes[i].nodes[aId].matrix(pId, S[i]) / totalVisits;
+                }
+            }
+        };
+
+        size_t rows = 0;
+        for (const auto & d : dirty)
+            rows += d.size();
+
+        if (pool && rows >= ParallelWork) pool->parallelFor(S.size(), work);
+        else                              work(0, S.size());
+    }
+
     std::tuple<State, double> CooperativeRLModel::sampleSR(const State & s, const Action & a) const {
         State s1(s.size());
         const double reward = sampleSR(s, a, &s1);
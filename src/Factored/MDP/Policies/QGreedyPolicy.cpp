@@ -6,33 +6,73 @@
 
 namespace AIToolbox::Factored::MDP {
     QGreedyPolicy::QGreedyPolicy(State s, Action a, const FactoredContainer<QFunctionRule> & q) :
-            Base(std::move(s), std::move(a)), qc_(&q), qm_(nullptr) {}
+            Base(std::move(s), std::move(a)), qc_(&q), qm_(nullptr),
+            maxCacheSize_(0), version_(nullptr), cacheVersion_(0), hits_(0) {}
 
     QGreedyPolicy::QGreedyPolicy(State s, Action a, const FactoredMatrix2D & q) :
-            Base(std::move(s), std::move(a)), qc_(nullptr), qm_(&q) {}
+            Base(std::move(s), std::move(a)), qc_(nullptr), qm_(&q),
+            maxCacheSize_(0), version_(nullptr), cacheVersion_(0), hits_(0) {}
 
     Action QGreedyPolicy::sampleAction(const State & s) const {
+        if (!maxCacheSize_) return computeAction(s);
+
+        if (version_ && *version_ != cacheVersion_) {
+            cache_.clear();
+            lru_.clear();
+            cacheVersion_ = *version_;
+        }
+
+        if (const auto it = cache_.find(s); it != cache_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            return it->second.action;
+        }
+
+        auto a = computeAction(s);
+        if (cache_.size() == maxCacheSize_) {
+            cache_.erase(lru_.back());
+            lru_.pop_back();
+        }
+        lru_.push_front(s);
+        cache_.emplace(s, CacheEntry{a, lru_.begin()});
+
+        return a;
+    }
+
+    Action QGreedyPolicy::computeAction(const State & s) const {
         Bandit::VariableElimination ve(A);
         if (qc_) {
             const auto rules = qc_->filter(s, 0); // Partial filter
             return std::get<0>(ve(rules));
         } else {
-            std::vector<Bandit::QFunctionRule> rules;
-            for (const auto & basis : qm_->bases) {
-                PartialFactorsEnumerator se(S, basis.tag);
-                PartialFactorsEnumerator ae(A, basis.actionTag);
-                for (size_t x = 0; se.isValid(); se.advance(), ++x) {
-                    if (!match(s, *se)) continue;
-
-                    ae.reset();
-                    for (size_t y = 0; ae.isValid(); ae.advance(), ++y)
-                        rules.emplace_back(*ae, basis.values(x, y));
-                }
-            }
-            return std::get<0>(ve(rules));
+            // The rows for the current state can be passed directly as
+            // dense factors.
+            FactoredVector q;
+            q.bases.reserve(qm_->bases.size());
+            for (const auto & basis : qm_->bases)
+                q.bases.push_back({basis.actionTag, basis.values.row(toIndexPartial(basis.tag, S, s)).transpose()});
+
+            return std::get<0>(ve(q));
         }
     }
 
+    void QGreedyPolicy::setCacheSize(const size_t maxSize, const unsigned long * version) {
+        maxCacheSize_ = maxSize;
+        version_ = version;
+        if (version_) cacheVersion_ = *version_;
+        clearCache();
+    }
+
+    size_t QGreedyPolicy::getCacheSize() const { return maxCacheSize_; }
+
+    void QGreedyPolicy::clearCache() {
+        cache_.clear();
+        lru_.clear();
+        hits_ = 0;
+    }
+
+    size_t QGreedyPolicy::getCacheHits() const { return hits_; }
+
     double QGreedyPolicy::getActionProbability(const State & s, const Action & a) const {
         if (veccmp(a, sampleAction(s)) == 0) return 1.0;
         return 0.0;
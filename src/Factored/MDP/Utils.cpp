@@ -7,4 +7,9 @@ namespace AIToolbox::Factored::MDP {
         QFunction Q = backProject(m.getS(), m.getA(), m.getTransitionFunction(), v.values * (v.weights * m.getDiscount()));
         return plusEqual(m.getS(), m.getA(), Q, m.getRewardFunction());
     }
+
+    QFunction bellmanBackup(const CooperativeModel & m, const ValueFunction & v, BackProjectionCache & cache) {
+        QFunction Q = cache(v.values * (v.weights * m.getDiscount()));
+        return plusEqual(m.getS(), m.getA(), Q, m.getRewardFunction());
+    }
 }
@@ -0,0 +1,233 @@
+#include <AIToolbox/Factored/POMDP/FactoredBelief.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace AIToolbox::Factored::POMDP {
+    namespace {
+        std::vector<PartialKeys> makeSingletons(const size_t F) {
+            std::vector<PartialKeys> retval(F);
+            for (size_t i = 0; i < F; ++i)
+                retval[i].push_back(i);
+            return retval;
+        }
+
+        // Calls f(id, values) for every assignment of the keys, in index
+        // order. Unlike PartialFactorsEnumerator, this also works for empty
+        // keys, which have a single assignment.
+        template <typename Fun>
+        void forEachAssignment(const Factors & space, const PartialKeys & keys, Fun f) {
+            const FactorSpace fs(space, keys);
+            PartialValues values(keys.size());
+            for (size_t id = 0; id < fs.size(); ++id) {
+                fs.toFactors(id, &values);
+                f(id, values);
+            }
+        }
+    }
+
+    FactoredBelief::FactoredBelief(Factors space) :
+            FactoredBelief(space, makeSingletons(space.size())) {}
+
+    FactoredBelief::FactoredBelief(Factors space, const std::vector<PartialKeys> & clusters) :
+            S(std::move(space)), clusterOf_(S.size(), clusters.size())
+    {
+        clusters_.reserve(clusters.size());
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            const auto & tag = clusters[c];
+            if (tag.empty())
+                throw std::invalid_argument("FactoredBelief clusters cannot be empty");
+
+            for (size_t i = 0; i < tag.size(); ++i) {
+                if (tag[i] >= S.size())
+                    throw std::invalid_argument("FactoredBelief cluster contains a variable out of range");
+                if (i && tag[i] <= tag[i-1])
+                    throw std::invalid_argument("FactoredBelief clusters must be sorted");
+                if (clusterOf_[tag[i]] != clusters.size())
+                    throw std::invalid_argument("FactoredBelief clusters must not overlap");
+                clusterOf_[tag[i]] = c;
+            }
+            const auto size = factorSpacePartial(tag, S);
+            clusters_.push_back({tag, Vector::Constant(size, 1.0 / size)});
+        }
+        for (const auto c : clusterOf_)
+            if (c == clusters.size())
+                throw std::invalid_argument("FactoredBelief clusters must contain all state variables");
+    }
+
+    void FactoredBelief::setDistribution(const size_t i, const Vector & values) {
+        if (i >= clusters_.size())
+            throw std::invalid_argument("FactoredBelief cluster is out of range");
+        const auto size = static_cast<size_t>(clusters_[i].values.size());
+        if (static_cast<size_t>(values.size()) != size || !isProbability(size, values))
+            throw std::invalid_argument("Input is not a valid distribution for the FactoredBelief cluster");
+        clusters_[i].values = values;
+    }
+
+    void FactoredBelief::predict(const DBN & transitions) { predictImpl(transitions); }
+    void FactoredBelief::predict(const DBNRef & transitions) { predictImpl(transitions); }
+
+    void FactoredBelief::predict(const Factors & actions, const FactoredDDN & ddn, const Factors & a) {
+        if (ddn.nodes.size() != S.size())
+            throw std::invalid_argument("The FactoredDDN does not match the FactoredBelief state space");
+
+        DBNRef transitions;
+        transitions.nodes.reserve(S.size());
+        for (const auto & node : ddn.nodes)
+            transitions.nodes.emplace_back(node.nodes[toIndexPartial(node.actionTag, actions, a)]);
+
+        predictImpl(transitions);
+    }
+
+    template <typename DBNType>
+    void FactoredBelief::predictImpl(const DBNType & transitions) {
+        if (transitions.nodes.size() != S.size())
+            throw std::invalid_argument("The DBN does not match the FactoredBelief state space");
+
+        // All clusters must be computed from the old belief, so we can
+        // only replace them at the end.
+        std::vector<Vector> newValues;
+        newValues.reserve(clusters_.size());
+
+        for (const auto & c : clusters_) {
+            PartialKeys parents;
+            for (const auto i : c.tag)
+                parents = merge(parents, transitions[i].tag);
+
+            const Vector pParents = getMarginal(parents);
+
+            // Strides of each node's parents within the cluster's parents.
+            std::vector<FactorSpace> rows;
+            rows.reserve(c.tag.size());
+            for (const auto i : c.tag)
+                rows.emplace_back(S, transitions[i].tag, parents);
+
+            std::vector<PartialValues> children(c.values.size());
+            forEachAssignment(S, c.tag, [&](const size_t k, const PartialValues & v) { children[k] = v; });
+
+            Vector result = Vector::Zero(c.values.size());
+            std::vector<size_t> rowIds(c.tag.size());
+            forEachAssignment(S, parents, [&](const size_t id, const PartialValues & v) {
+                const double p = pParents[id];
+                if (p == 0.0) return;
+
+                for (size_t j = 0; j < c.tag.size(); ++j)
+                    rowIds[j] = rows[j].toIndex(v);
+
+                for (size_t k = 0; k < children.size(); ++k) {
+                    double prod = p;
+                    for (size_t j = 0; j < c.tag.size(); ++j)
+                        prod *= transitions[c.tag[j]].matrix(rowIds[j], children[k][j]);
+                    result[k] += prod;
+                }
+            });
+            newValues.emplace_back(std::move(result));
+        }
+
+        for (size_t c = 0; c < clusters_.size(); ++c)
+            clusters_[c].values = std::move(newValues[c]);
+    }
+
+    double FactoredBelief::observe(const DBN & observations, const Factors & o) {
+        if (observations.nodes.size() != o.size())
+            throw std::invalid_argument("The observation does not match the observation DBN");
+
+        // Observation variables are incorporated one at a time, so we keep
+        // the old belief in case a later one turns out to be impossible.
+        auto old = clusters_;
+
+        double likelihood = 1.0;
+        for (size_t j = 0; j < o.size(); ++j) {
+            const auto & node = observations[j];
+
+            const auto cs = findClusters(node.tag);
+            PartialKeys keys;
+            Vector joint = joinClusters(cs, &keys);
+
+            const FactorSpace row(S, node.tag, keys);
+            forEachAssignment(S, keys, [&](const size_t id, const PartialValues & v) {
+                joint[id] *= node.matrix(row.toIndex(v), o[j]);
+            });
+
+            const double norm = joint.sum();
+            if (norm <= 0.0) {
+                clusters_ = std::move(old);
+                return 0.0;
+            }
+            likelihood *= norm;
+            joint /= norm;
+
+            // Project the posterior back onto each cluster.
+            for (const auto c : cs) {
+                auto & cluster = clusters_[c];
+                const FactorSpace fs(S, cluster.tag, keys);
+                cluster.values.setZero();
+                forEachAssignment(S, keys, [&](const size_t id, const PartialValues & v) {
+                    cluster.values[fs.toIndex(v)] += joint[id];
+                });
+            }
+        }
+        return likelihood;
+    }
+
+    double FactoredBelief::update(const DBN & transitions, const DBN & observations, const Factors & o) {
+        predict(transitions);
+        return observe(observations, o);
+    }
+
+    double FactoredBelief::getProbability(const Factors & s) const {
+        double retval = 1.0;
+        for (const auto & c : clusters_)
+            retval *= c.values[toIndexPartial(c.tag, S, s)];
+        return retval;
+    }
+
+    Vector FactoredBelief::getMarginal(const PartialKeys & tag) const {
+        PartialKeys keys;
+        const Vector joint = joinClusters(findClusters(tag), &keys);
+        if (keys == tag) return joint;
+
+        Vector retval = Vector::Zero(factorSpacePartial(tag, S));
+        const FactorSpace fs(S, tag, keys);
+        forEachAssignment(S, keys, [&](const size_t id, const PartialValues & v) {
+            retval[fs.toIndex(v)] += joint[id];
+        });
+        return retval;
+    }
+
+    Vector FactoredBelief::joinClusters(const std::vector<size_t> & cs, PartialKeys * keysp) const {
+        auto & keys = *keysp;
+        keys.clear();
+        for (const auto c : cs)
+            keys = merge(keys, clusters_[c].tag);
+
+        std::vector<FactorSpace> spaces;
+        spaces.reserve(cs.size());
+        for (const auto c : cs)
+            spaces.emplace_back(S, clusters_[c].tag, keys);
+
+        Vector retval(factorSpacePartial(keys, S));
+        forEachAssignment(S, keys, [&](const size_t id, const PartialValues & v) {
+            double p = 1.0;
+            for (size_t i = 0; i < cs.size(); ++i)
+                p *= clusters_[cs[i]].values[spaces[i].toIndex(v)];
+            retval[id] = p;
+        });
+        return retval;
+    }
+
+    std::vector<size_t> FactoredBelief::findClusters(const PartialKeys & tag) const {
+        std::vector<size_t> retval;
+        retval.reserve(tag.size());
+        for (const auto k : tag)
+            retval.push_back(clusterOf_[k]);
+
+        std::sort(std::begin(retval), std::end(retval));
+        retval.erase(std::unique(std::begin(retval), std::end(retval)), std::end(retval));
+        return retval;
+    }
+
+    const Factors & FactoredBelief::getS() const { return S; }
+    const std::vector<FactoredBelief::Cluster> & FactoredBelief::getClusters() const { return clusters_; }
+    size_t FactoredBelief::getClusterOf(const size_t factor) const { return clusterOf_[factor]; }
+}
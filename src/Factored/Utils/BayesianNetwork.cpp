@@ -1,9 +1,46 @@
 #include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
 
 #include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cmath>
 
 namespace AIToolbox::Factored {
     namespace Impl {
+        // Accumulates the entries of a node's row for the child values of
+        // all final states. The loop over the final states is kept
+        // innermost and writes to a contiguous Vector, so that it can be
+        // vectorized by the compiler.
+        template <bool Log, typename Row>
+        void accumulateTransitions(Vector & out, const Row & row, const size_t child, const std::vector<Factors> & s1s) {
+            if constexpr (Log) {
+                // The node's row is small, so we take the logarithms only
+                // once per value of the child.
+                const Vector logRow = row.transpose().array().log();
+                for (size_t j = 0; j < s1s.size(); ++j)
+                    out[j] += logRow[s1s[j][child]];
+            } else {
+                for (size_t j = 0; j < s1s.size(); ++j)
+                    out[j] *= row[s1s[j][child]];
+            }
+        }
+
+        template <bool Log, typename DBN>
+        Vector getTransitionProbabilitiesDBN(const DBN & dbn, const Factors & space, const Factors & s, const std::vector<Factors> & s1s) {
+            Vector retval(s1s.size());
+            retval.fill(Log ? 0.0 : 1.0);
+
+            // For each node, the row which applies to the initial state is
+            // the same for all final states.
+            for (size_t i = 0; i < space.size(); ++i) {
+                const auto parentId = toIndexPartial(dbn[i].tag, space, s);
+                accumulateTransitions<Log>(retval, dbn[i].matrix.row(parentId), i, s1s);
+            }
+
+            return retval;
+        }
+
         template <typename DBN>
         double getTransitionProbabilityDBN(const DBN & dbn, const Factors & space, const Factors & s, const Factors & s1) {
             double retval = 1.0;
@@ -48,6 +85,14 @@ namespace AIToolbox::Factored {
         return Impl::getTransitionProbabilityDBN(*this, space, s, s1);
     }
 
+    Vector DBN::getTransitionProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDBN<false>(*this, space, s, s1s);
+    }
+
+    Vector DBN::getTransitionLogProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDBN<true>(*this, space, s, s1s);
+    }
+
     const DBN::Node & DBN::operator[](size_t i) const {
         return nodes[i];
     }
@@ -62,6 +107,14 @@ namespace AIToolbox::Factored {
         return Impl::getTransitionProbabilityDBN(*this, space, s, s1);
     }
 
+    Vector DBNRef::getTransitionProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDBN<false>(*this, space, s, s1s);
+    }
+
+    Vector DBNRef::getTransitionLogProbabilities(const Factors & space, const Factors & s, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDBN<true>(*this, space, s, s1s);
+    }
+
     const DBN::Node & DBNRef::operator[](size_t i) const {
         return nodes[i].get();
     }
@@ -71,22 +124,49 @@ namespace AIToolbox::Factored {
     CompactDDN::CompactDynamicDecisionNetwork(
                 std::vector<std::vector<Node>> diffs,
                 DynamicBayesianNetwork defaultTransition
-            ) : diffs_(std::move(diffs)), defaultTransition_(std::move(defaultTransition)) {}
+            ) : diffs_(std::move(diffs)), defaultTransition_(std::move(defaultTransition))
+    {
+        buildTransitions();
+    }
 
-    DBNRef CompactDDN::makeDiffTransition(const size_t a) const {
-        DBNRef retval;
-        retval.nodes.reserve(defaultTransition_.nodes.size());
+    CompactDDN::CompactDynamicDecisionNetwork(const CompactDynamicDecisionNetwork & other) :
+            diffs_(other.diffs_), defaultTransition_(other.defaultTransition_)
+    {
+        buildTransitions();
+    }
 
-        size_t j = 0;
-        for (size_t i = 0; i < defaultTransition_.nodes.size(); ++i) {
-            if (j < diffs_[a].size() && diffs_[a][j].id == i) {
-                retval.nodes.emplace_back(std::ref(diffs_[a][j].node));
-                ++j;
-            } else {
-                retval.nodes.emplace_back(std::ref(defaultTransition_.nodes[i]));
+    CompactDDN & CompactDDN::operator=(const CompactDynamicDecisionNetwork & other) {
+        if (this != &other) {
+            diffs_ = other.diffs_;
+            defaultTransition_ = other.defaultTransition_;
+            buildTransitions();
+        }
+        return *this;
+    }
+
+    void CompactDDN::buildTransitions() {
+        // Moving the containers does not move their nodes, so these
+        // references only need to be rebuilt on copies.
+        transitions_.clear();
+        transitions_.resize(diffs_.size());
+        for (size_t a = 0; a < diffs_.size(); ++a) {
+            auto & nodes = transitions_[a].nodes;
+            nodes.reserve(defaultTransition_.nodes.size());
+
+            size_t j = 0;
+            for (size_t i = 0; i < defaultTransition_.nodes.size(); ++i) {
+                if (j < diffs_[a].size() && diffs_[a][j].id == i) {
+                    nodes.emplace_back(std::ref(diffs_[a][j].node));
+                    ++j;
+                } else {
+                    nodes.emplace_back(std::ref(defaultTransition_.nodes[i]));
+                }
             }
         }
-        return retval;
+    }
+
+    const DBNRef & CompactDDN::makeDiffTransition(const size_t a) const {
+        return transitions_[a];
     }
 
     const DBN & CompactDDN::getDefaultTransition() const {
@@ -136,6 +216,32 @@ namespace AIToolbox::Factored {
         return retval;
     }
 
+    namespace Impl {
+        template <bool Log>
+        Vector getTransitionProbabilitiesDDN(const FactoredDDN & ddn, const Factors & space, const Factors & actions, const Factors & s, const Factors & a, const std::vector<Factors> & s1s) {
+            Vector retval(s1s.size());
+            retval.fill(Log ? 0.0 : 1.0);
+
+            for (size_t i = 0; i < space.size(); ++i) {
+                const auto & node = ddn.nodes[i];
+                const auto actionId = toIndexPartial(node.actionTag, actions, a);
+                const auto parentId = toIndexPartial(node.nodes[actionId].tag, space, s);
+
+                accumulateTransitions<Log>(retval, node.nodes[actionId].matrix.row(parentId), i, s1s);
+            }
+
+            return retval;
+        }
+    }
+
+    Vector FactoredDDN::getTransitionProbabilities(const Factors & space, const Factors & actions, const Factors & s, const Factors & a, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDDN<false>(*this, space, actions, s, a, s1s);
+    }
+
+    Vector FactoredDDN::getTransitionLogProbabilities(const Factors & space, const Factors & actions, const Factors & s, const Factors & a, const std::vector<Factors> & s1s) const {
+        return Impl::getTransitionProbabilitiesDDN<true>(*this, space, actions, s, a, s1s);
+    }
+
     const FactoredDDN::Node & FactoredDDN::operator[](size_t i) const {
         return nodes[i];
     }
@@ -183,17 +289,30 @@ namespace AIToolbox::Factored {
             return retval;
         }
 
+        template <typename Out, typename BackProject>
+        void backProjectBases(Out & retval, const FactoredVector & fv, ThreadPool * pool, BackProject bp) {
+            // Note that we don't do plusEqual since we don't necessarily
+            // want to merge entries here. Each output basis only depends on
+            // its input basis, so each thread can write its own.
+            retval.bases.resize(fv.bases.size());
+
+            const auto process = [&](const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                    retval.bases[i] = bp(fv.bases[i]);
+            };
+
+            if (pool)
+                pool->parallelFor(fv.bases.size(), process);
+            else
+                process(0, fv.bases.size());
+        }
+
         template <typename Net>
-        FactoredVector backProject(const Factors & space, const Net & dbn, const FactoredVector & fv) {
+        FactoredVector backProject(const Factors & space, const Net & dbn, const FactoredVector & fv, ThreadPool * pool) {
             FactoredVector retval;
-            retval.bases.reserve(fv.bases.size());
-
-            for (const auto & basis : fv.bases) {
-                // Note that we don't do plusEqual since we don't necessarily
-                // want to merge entries here.
-                retval.bases.emplace_back(backProject(space, dbn, basis));
-            }
-
+            backProjectBases(retval, fv, pool, [&](const BasisFunction & basis) {
+                return backProject(space, dbn, basis);
+            });
             return retval;
         }
     }
@@ -204,11 +323,68 @@ namespace AIToolbox::Factored {
     BasisFunction backProject(const Factors & space, const DBNRef & dbn, const BasisFunction & bf) {
         return Impl::backProject(space, dbn, bf);
     }
-    FactoredVector backProject(const Factors & space, const DBN & dbn, const FactoredVector & fv) {
-        return Impl::backProject(space, dbn, fv);
+    FactoredVector backProject(const Factors & space, const DBN & dbn, const FactoredVector & fv, ThreadPool * pool) {
+        return Impl::backProject(space, dbn, fv, pool);
     }
-    FactoredVector backProject(const Factors & space, const DBNRef & dbn, const FactoredVector & fv) {
-        return Impl::backProject(space, dbn, fv);
+    FactoredVector backProject(const Factors & space, const DBNRef & dbn, const FactoredVector & fv, ThreadPool * pool) {
+        return Impl::backProject(space, dbn, fv, pool);
+    }
+
+    std::vector<FactoredVector> backProject(const Factors & space, const CompactDDN & ddn, const FactoredVector & fv, ThreadPool * pool) {
+        const auto & diffs = ddn.getDiffNodes();
+        const size_t A = diffs.size();
+        const size_t B = fv.bases.size();
+
+        // The back-projection of a basis only depends on the nodes in its
+        // tag. If none of them is changed by an action, the result is the
+        // same as through the default transition. Both tags and diffs are
+        // sorted by id.
+        const auto isChanged = [&](const size_t a, const PartialKeys & tag) {
+            size_t j = 0;
+            for (const auto & d : diffs[a]) {
+                while (j < tag.size() && tag[j] < d.id) ++j;
+                if (j == tag.size()) return false;
+                if (tag[j] == d.id) return true;
+            }
+            return false;
+        };
+
+        std::vector<char> shared(B, false);
+        for (size_t i = 0; i < B; ++i)
+            for (size_t a = 0; a < A && !shared[i]; ++a)
+                shared[i] = !isChanged(a, fv.bases[i].tag);
+
+        // We first compute the shared back-projections, and then all the
+        // others, one per action and basis. Each output basis is written by
+        // a single job, so the result does not depend on the threads.
+        std::vector<BasisFunction> defaults(B);
+        std::vector<FactoredVector> retval(A);
+        for (auto & r : retval)
+            r.bases.resize(B);
+
+        const auto processDefaults = [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                if (shared[i])
+                    defaults[i] = Impl::backProject(space, ddn.getDefaultTransition(), fv.bases[i]);
+        };
+        const auto processActions = [&](const size_t begin, const size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                const size_t a = k / B, i = k % B;
+                if (isChanged(a, fv.bases[i].tag))
+                    retval[a].bases[i] = Impl::backProject(space, ddn.makeDiffTransition(a), fv.bases[i]);
+                else
+                    retval[a].bases[i] = defaults[i];
+            }
+        };
+
+        if (pool) {
+            pool->parallelFor(B, processDefaults);
+            pool->parallelFor(A * B, processActions);
+        } else {
+            processDefaults(0, B);
+            processActions(0, A * B);
+        }
+        return retval;
     }
 
     BasisMatrix backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const BasisFunction & rhs) {
@@ -252,16 +428,84 @@ namespace AIToolbox::Factored {
         return retval;
     }
 
-    FactoredMatrix2D backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const FactoredVector & fv) {
+    FactoredMatrix2D backProject(const Factors & space, const Factors & actions, const FactoredDDN & ddn, const FactoredVector & fv, ThreadPool * pool) {
         FactoredMatrix2D retval;
-        retval.bases.reserve(fv.bases.size());
+        Impl::backProjectBases(retval, fv, pool, [&](const BasisFunction & basis) {
+            return backProject(space, actions, ddn, basis);
+        });
+        return retval;
+    }
 
-        for (const auto & basis : fv.bases) {
-            // Note that we don't do plusEqual since we don't necessarily
-            // want to merge entries here.
-            retval.bases.emplace_back(backProject(space, actions, ddn, basis));
+    // BackProjectionCache
+
+    BackProjectionCache::BackProjectionCache(Factors space, Factors actions, const FactoredDDN & ddn) :
+            space_(std::move(space)), actions_(std::move(actions)), ddn_(ddn) {}
+
+    const BackProjectionCache::Entry & BackProjectionCache::getEntry(const PartialKeys & tag) {
+        const auto it = cache_.find(tag);
+        if (it != std::end(cache_)) return it->second;
+
+        Entry entry;
+        for (auto d : tag) {
+            entry.actionTag = merge(entry.actionTag, ddn_[d].actionTag);
+            for (const auto & n : ddn_[d].nodes)
+                entry.tag = merge(entry.tag, n.tag);
         }
 
+        entry.actionSize = factorSpacePartial(entry.actionTag, actions_);
+        const size_t sizeS = factorSpacePartial(entry.tag, space_);
+        const size_t sizeR = factorSpacePartial(tag, space_);
+
+        entry.projection.resize(sizeS * entry.actionSize, sizeR);
+
+        PartialFactorsEnumerator sDomain(space_, entry.tag);
+        PartialFactorsEnumerator aDomain(actions_, entry.actionTag);
+        PartialFactorsEnumerator rDomain(space_, tag);
+
+        // Each row is a (state, action) pair of the output, in the same
+        // order as the BasisMatrix values; each column a value of the basis.
+        for (size_t row = 0; sDomain.isValid(); sDomain.advance()) {
+            for (; aDomain.isValid(); aDomain.advance(), ++row) {
+                for (size_t rId = 0; rDomain.isValid(); rDomain.advance(), ++rId)
+                    entry.projection(row, rId) = ddn_.getTransitionProbability(space_, actions_, *sDomain, *aDomain, *rDomain);
+                rDomain.reset();
+            }
+            aDomain.reset();
+        }
+
+        return cache_.emplace(tag, std::move(entry)).first->second;
+    }
+
+    BasisMatrix BackProjectionCache::operator()(const BasisFunction & bf) {
+        const auto & entry = getEntry(bf.tag);
+
+        BasisMatrix retval;
+        retval.tag = entry.tag;
+        retval.actionTag = entry.actionTag;
+
+        const Vector values = entry.projection * bf.values;
+        retval.values = Eigen::Map<const Matrix2D>(values.data(), values.size() / entry.actionSize, entry.actionSize);
+
+        return retval;
+    }
+
+    FactoredMatrix2D BackProjectionCache::operator()(const FactoredVector & fv) {
+        FactoredMatrix2D retval;
+        retval.bases.reserve(fv.bases.size());
+        for (const auto & basis : fv.bases)
+            retval.bases.emplace_back((*this)(basis));
         return retval;
     }
+
+    void BackProjectionCache::invalidate(const size_t factor) {
+        for (auto it = std::begin(cache_); it != std::end(cache_); ) {
+            if (std::binary_search(std::begin(it->first), std::end(it->first), factor))
+                it = cache_.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void BackProjectionCache::clear() { cache_.clear(); }
+    size_t BackProjectionCache::size() const { return cache_.size(); }
 }
@@ -2,6 +2,8 @@
 
 #include <AIToolbox/Utils/Core.hpp>
 
+#include <limits>
+
 namespace AIToolbox::Factored {
     std::pair<TagErrors, size_t> checkTag(const Factors & space, const PartialKeys & tag) {
         // Check action tag size.
@@ -312,17 +314,58 @@ namespace AIToolbox::Factored {
         return result;
     }
 
+    // FactorSpace below.
+
+    FactorSpace::FactorSpace(const Factors & space) :
+            space_(space), strides_(space.size()), size_(1)
+    {
+        for (size_t i = 0; i < space_.size(); ++i) {
+            strides_[i] = size_;
+            size_ *= space_[i];
+        }
+    }
+
+    FactorSpace::FactorSpace(const Factors & space, const PartialKeys & keys) :
+            FactorSpace(space, keys, keys) {}
+
+    FactorSpace::FactorSpace(const Factors & space, const PartialKeys & keys, const PartialKeys & inputKeys) :
+            space_(inputKeys.size()), strides_(inputKeys.size(), 0), size_(1)
+    {
+        for (size_t i = 0, j = 0; i < keys.size(); ++i, ++j) {
+            while (inputKeys[j] != keys[i]) ++j;
+            space_[j] = space[keys[i]];
+            strides_[j] = size_;
+            size_ *= space_[j];
+        }
+    }
+
+    void FactorSpace::toFactors(size_t id, PartialValues * valuesp) const {
+        assert(valuesp);
+
+        auto & values = *valuesp;
+        for (size_t i = 0; i < strides_.size(); ++i) {
+            if (!strides_[i]) continue;
+            values[i] = id % space_[i];
+            id /= space_[i];
+        }
+    }
+
+    size_t FactorSpace::size() const { return size_; }
+    const std::vector<size_t> & FactorSpace::getStrides() const { return strides_; }
+
     // PartialFactorsEnumerator below.
 
     PartialFactorsEnumerator::PartialFactorsEnumerator(Factors f, PartialKeys factors) :
-        F(std::move(f)), factorToSkipId_(factors.size())
+        F(std::move(f)), factorToSkipId_(factors.size()),
+        step_(0), begin_(0), end_(std::numeric_limits<size_t>::max())
     {
         factors_.first = std::move(factors);
         factors_.second.resize(factors_.first.size());
     }
 
     PartialFactorsEnumerator::PartialFactorsEnumerator(Factors f) :
-        F(std::move(f)), factorToSkipId_(F.size())
+        F(std::move(f)), factorToSkipId_(F.size()),
+        step_(0), begin_(0), end_(std::numeric_limits<size_t>::max())
     {
         factors_.first.resize(F.size());
         std::iota(std::begin(factors_.first), std::end(factors_.first), 0);
@@ -348,15 +391,24 @@ namespace AIToolbox::Factored {
     }
 
     void PartialFactorsEnumerator::advance() {
+        if (++step_ == end_) {
+            factors_.second.clear();
+            return;
+        }
         // Start from 0 if skip is not zero, from 1 otherwise.
         size_t id = !factorToSkipId_;
         while (id < factors_.second.size()) {
             ++factors_.second[id];
             if (factors_.second[id] == F[factors_.first[id]]) {
                 factors_.second[id] = 0;
+                for (size_t t = 0; t < indeces_.size(); ++t)
+                    indeces_[t] -= strides_[t][id] * (F[factors_.first[id]] - 1);
                 if (++id == factorToSkipId_) ++id;
-            } else
+            } else {
+                for (size_t t = 0; t < indeces_.size(); ++t)
+                    indeces_[t] += strides_[t][id];
                 return;
+            }
         }
         factors_.second.clear();
     }
@@ -366,10 +418,52 @@ namespace AIToolbox::Factored {
     }
 
     void PartialFactorsEnumerator::reset() {
-        if (factors_.second.size() == 0)
-            factors_.second.resize(factors_.first.size());
-        else
-            std::fill(std::begin(factors_.second), std::end(factors_.second), 0);
+        seek(begin_);
+    }
+
+    void PartialFactorsEnumerator::setRange(const size_t begin, const size_t end) {
+        begin_ = begin;
+        end_ = std::min(end, size());
+        seek(begin_);
+    }
+
+    size_t PartialFactorsEnumerator::getStep() const { return step_; }
+
+    size_t PartialFactorsEnumerator::addTarget(const PartialKeys & keys) {
+        strides_.push_back(FactorSpace(F, keys, factors_.first).getStrides());
+        indeces_.push_back(0);
+
+        const auto & values = factors_.second;
+        for (size_t i = 0; i < values.size(); ++i)
+            if (i != factorToSkipId_)
+                indeces_.back() += strides_.back()[i] * values[i];
+
+        return indeces_.size() - 1;
+    }
+
+    void PartialFactorsEnumerator::seek(size_t step) {
+        step_ = step;
+        std::fill(std::begin(indeces_), std::end(indeces_), 0);
+        if (step_ >= end_) {
+            factors_.second.clear();
+            return;
+        }
+
+        auto & values = factors_.second;
+        values.resize(factors_.first.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i == factorToSkipId_) {
+                values[i] = 0;
+                continue;
+            }
+            const auto f = F[factors_.first[i]];
+            values[i] = step % f;
+            step /= f;
+            for (size_t t = 0; t < indeces_.size(); ++t)
+                indeces_[t] += strides_[t][i] * values[i];
+        }
+        // Past the end of the whole enumeration.
+        if (step) values.clear();
     }
 
     size_t PartialFactorsEnumerator::size() const {
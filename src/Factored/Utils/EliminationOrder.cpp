@@ -0,0 +1,113 @@
+#include <AIToolbox/Factored/Utils/EliminationOrder.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace AIToolbox::Factored {
+    EliminationOrder::EliminationOrder(Factors sizes, const Heuristic heuristic) :
+            sizes_(std::move(sizes)), heuristic_(heuristic), computes_(0) {}
+
+    const std::vector<size_t> & EliminationOrder::operator()(std::vector<PartialKeys> factors) {
+        // The order in which factors are listed does not matter.
+        std::sort(std::begin(factors), std::end(factors));
+
+        if (order_.empty() || factors != topology_) {
+            topology_ = std::move(factors);
+            compute();
+        }
+        return order_;
+    }
+
+    void EliminationOrder::compute() {
+        ++computes_;
+        const size_t N = sizes_.size();
+
+        order_.resize(N);
+        if (heuristic_ == Heuristic::Reverse) {
+            std::iota(std::rbegin(order_), std::rend(order_), 0);
+            return;
+        }
+
+        // We build the interaction graph, where two variables are neighbors
+        // if they share a factor. Neighbor lists are kept sorted.
+        std::vector<PartialKeys> neighbors(N);
+        const auto connect = [&neighbors](const size_t a, const size_t b) {
+            auto & n = neighbors[a];
+            const auto it = std::lower_bound(std::begin(n), std::end(n), b);
+            if (it == std::end(n) || *it != b) n.insert(it, b);
+        };
+        const auto connected = [&neighbors](const size_t a, const size_t b) {
+            return std::binary_search(std::begin(neighbors[a]), std::end(neighbors[a]), b);
+        };
+
+        for (const auto & f : topology_) {
+            for (size_t i = 0; i < f.size(); ++i) {
+                for (size_t j = i + 1; j < f.size(); ++j) {
+                    connect(f[i], f[j]);
+                    connect(f[j], f[i]);
+                }
+            }
+        }
+
+        const auto score = [&](const size_t v) {
+            const auto & n = neighbors[v];
+            if (heuristic_ == Heuristic::MinDegree)
+                return static_cast<double>(n.size());
+
+            double fill = 0.0;
+            for (size_t i = 0; i < n.size(); ++i) {
+                for (size_t j = i + 1; j < n.size(); ++j) {
+                    if (connected(n[i], n[j])) continue;
+                    if (heuristic_ == Heuristic::MinFill) fill += 1.0;
+                    else fill += static_cast<double>(sizes_[n[i]]) * sizes_[n[j]];
+                }
+            }
+            return fill;
+        };
+
+        std::vector<bool> eliminated(N, false);
+        for (size_t step = 0; step < N; ++step) {
+            size_t best = N;
+            double bestScore = 0.0;
+            for (size_t v = N; v-- > 0; ) {
+                if (eliminated[v]) continue;
+                const double s = score(v);
+                if (best == N || s < bestScore) {
+                    best = v;
+                    bestScore = s;
+                }
+            }
+            order_[step] = best;
+            eliminated[best] = true;
+
+            // Eliminating the variable joins all its neighbors into a
+            // single factor, so they all become neighbors of each other.
+            const auto n = std::move(neighbors[best]);
+            neighbors[best].clear();
+            for (const auto a : n) {
+                auto & na = neighbors[a];
+                na.erase(std::lower_bound(std::begin(na), std::end(na), best));
+                for (const auto b : n)
+                    if (a != b) connect(a, b);
+            }
+        }
+    }
+
+    void EliminationOrder::setHeuristic(const Heuristic heuristic) {
+        heuristic_ = heuristic;
+        topology_.clear();
+        order_.clear();
+    }
+
+    EliminationOrder::Heuristic EliminationOrder::getHeuristic() const {
+        return heuristic_;
+    }
+
+    const Factors & EliminationOrder::getSizes() const {
+        return sizes_;
+    }
+
+    size_t EliminationOrder::getComputeCount() const {
+        return computes_;
+    }
+}
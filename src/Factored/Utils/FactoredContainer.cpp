@@ -1,5 +1,8 @@
 #include <AIToolbox/Factored/Utils/FactoredContainer.hpp>
 
+#include <array>
+#include <numeric>
+
 namespace AIToolbox::Factored {
     namespace {
         /**
@@ -9,6 +12,13 @@ namespace AIToolbox::Factored {
             public:
                 using It = std::vector<size_t>::const_iterator;
 
+                /**
+                 * @brief Default constructor.
+                 *
+                 * This constructor creates an empty, invalid filter.
+                 */
+                Filter() = default;
+
                 /**
                  * @brief Basic constructor.
                  *
@@ -82,6 +92,47 @@ namespace AIToolbox::Factored {
                    (other.endNamedFilter - other.beginNamedFilter) + (other.endUnnamedFilter - other.beginUnnamedFilter);
         }
 
+        /**
+         * @brief This class stores the filters of a single call to Trie::filter.
+         *
+         * Filters are kept sorted by size. In the common case of few
+         * factors they are stored on the stack, so that filtering does not
+         * need to allocate.
+         */
+        class Filters {
+            public:
+                /**
+                 * @brief Basic constructor.
+                 *
+                 * @param size The maximum number of filters that will be added.
+                 */
+                Filters(size_t size) : size_(0) {
+                    if (size > StackSize) heap_.resize(size);
+                    data_ = size > StackSize ? heap_.data() : stack_.data();
+                }
+
+                /**
+                 * @brief This function adds a filter, keeping them sorted by size.
+                 */
+                void insert(const Filter & filter) {
+                    auto it = std::upper_bound(data_, data_ + size_, filter);
+                    std::move_backward(it, data_ + size_, data_ + size_ + 1);
+                    *it = filter;
+                    ++size_;
+                }
+
+                size_t size() const { return size_; }
+                Filter & operator[](size_t i) { return data_[i]; }
+
+            private:
+                static constexpr size_t StackSize = 32;
+
+                std::array<Filter, StackSize> stack_;
+                std::vector<Filter> heap_;
+                Filter * data_;
+                size_t size_;
+        };
+
         /**
          * @brief This function finds all common elements held by the input filters.
          *
@@ -91,18 +142,15 @@ namespace AIToolbox::Factored {
          * them.
          *
          * @param filters The input filters.
-         *
-         * @return A vector containing all common elements shared by the filters.
+         * @param matches The output vector where to append all common elements shared by the filters.
          */
-        std::vector<size_t> applyFilters(std::vector<Filter> & filters) {
-            std::vector<size_t> matches;
-
+        void applyFilters(Filters & filters, std::vector<size_t> & matches) {
             if (filters.size() == 1) {
                 while (filters[0].isValid()) {
                     matches.push_back(filters[0].getMin());
                     filters[0].stepAdvance();
                 }
-                return matches;
+                return;
             }
 
             size_t lastMaxFound = 0, counter = 1;
@@ -131,7 +179,6 @@ namespace AIToolbox::Factored {
                 } else if ( ++counter == lastMaxFound )
                     ++counter;
             }
-            return matches;
         }
     }
 
@@ -158,6 +205,10 @@ namespace AIToolbox::Factored {
         return counter_;
     }
 
+    size_t Trie::getMemoryUsage() const {
+        return heapUsage(partials_) + heapUsage(ids_);
+    }
+
     void Trie::insert(const PartialFactors & ps) {
         // We count all factors.
         size_t factor = 0;
@@ -188,14 +239,21 @@ namespace AIToolbox::Factored {
     }
 
     std::vector<size_t> Trie::filter(const Factors & f, size_t offset) const {
+        std::vector<size_t> retval;
+        filter(f, offset, &retval);
+        return retval;
+    }
+
+    void Trie::filter(const Factors & f, size_t offset, std::vector<size_t> * idsp) const {
+        auto & retval = *idsp;
+        retval.clear();
         if (!f.size()) {
             // If nothing to match, match all
-            std::vector<size_t> retval(counter_);
+            retval.resize(counter_);
             std::iota(std::begin(retval), std::end(retval), 0);
-            return retval;
+            return;
         }
-        std::vector<Filter> filters;
-        filters.reserve(f.size());
+        Filters filters(f.size());
         // For each factor
         for ( size_t i = offset; i < f.size() + offset; ++i ) {
             auto id = i - offset;
@@ -209,21 +267,28 @@ namespace AIToolbox::Factored {
                 std::end(ids_[i])
             );
             if (!filter.isValid())
-                return {};
-            filters.insert(std::upper_bound(std::begin(filters), std::end(filters), filter), filter);
+                return;
+            filters.insert(filter);
         }
-        return applyFilters(filters);
+        applyFilters(filters, retval);
     }
 
     std::vector<size_t> Trie::filter(const PartialFactors & pf) const {
+        std::vector<size_t> retval;
+        filter(pf, &retval);
+        return retval;
+    }
+
+    void Trie::filter(const PartialFactors & pf, std::vector<size_t> * idsp) const {
+        auto & retval = *idsp;
+        retval.clear();
         if (!pf.first.size()) {
             // If nothing to match, match all
-            std::vector<size_t> retval(counter_);
+            retval.resize(counter_);
             std::iota(std::begin(retval), std::end(retval), 0);
-            return retval;
+            return;
         }
-        std::vector<Filter> filters;
-        filters.reserve(pf.first.size());
+        Filters filters(pf.first.size());
         // For each factor
         for ( size_t i = 0; i < pf.first.size(); ++i ) {
             auto factor = pf.first[i];
@@ -238,9 +303,9 @@ namespace AIToolbox::Factored {
                 std::end(ids_[factor])
             );
             if (!filter.isValid())
-                return {};
-            filters.insert(std::upper_bound(std::begin(filters), std::end(filters), filter), filter);
+                return;
+            filters.insert(filter);
         }
-        return applyFilters(filters);
+        applyFilters(filters, retval);
     }
 }
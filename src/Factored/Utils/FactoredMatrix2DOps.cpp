@@ -19,13 +19,13 @@ namespace AIToolbox::Factored {
 
         PartialFactorsEnumerator se(space, retval.tag);
         PartialFactorsEnumerator ae(actions, retval.actionTag);
+        const auto sT = se.addTarget(rhs.tag);
+        const auto aT = ae.addTarget(rhs.actionTag);
         for (size_t x = 0; se.isValid(); se.advance(), ++x) {
-            const auto rX = toIndexPartial(rhs.tag, space, *se);
+            const auto rX = se.getIndex(sT);
 
-            for (size_t y = 0; ae.isValid(); ae.advance(), ++y) {
-                const auto rY = toIndexPartial(rhs.actionTag, actions, *ae);
-                retval.values(x, y) += rhs.values(rX, rY);
-            }
+            for (size_t y = 0; ae.isValid(); ae.advance(), ++y)
+                retval.values(x, y) += rhs.values(rX, ae.getIndex(aT));
             ae.reset();
         }
         return retval;
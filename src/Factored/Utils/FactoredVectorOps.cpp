@@ -14,13 +14,11 @@ namespace AIToolbox::Factored {
         // No need to zero fill
 
         PartialFactorsEnumerator e(space, retval.tag);
+        const auto lhsT = e.addTarget(lhs.tag), rhsT = e.addTarget(rhs.tag);
         for (size_t i = 0; e.isValid(); e.advance(), ++i) {
             // We don't need to compute the index for retval since it
             // increases sequentially anyway.
-            const auto lhsId = toIndexPartial(lhs.tag, space, *e);
-            const auto rhsId = toIndexPartial(rhs.tag, space, *e);
-
-            retval.values[i] = lhs.values[lhsId] * rhs.values[rhsId];
+            retval.values[i] = lhs.values[e.getIndex(lhsT)] * rhs.values[e.getIndex(rhsT)];
         }
         return retval;
     }
@@ -35,13 +33,11 @@ namespace AIToolbox::Factored {
         // No need to zero fill
 
         PartialFactorsEnumerator e(space, retval.tag);
+        const auto lhsT = e.addTarget(lhs.tag), rhsT = e.addTarget(rhs.tag);
         for (size_t i = 0; e.isValid(); e.advance(), ++i) {
             // We don't need to compute the index for retval since it
             // increases sequentially anyway.
-            const auto lhsId = toIndexPartial(lhs.tag, space, *e);
-            const auto rhsId = toIndexPartial(rhs.tag, space, *e);
-
-            retval.values[i] = lhs.values[lhsId] + rhs.values[rhsId];
+            retval.values[i] = lhs.values[e.getIndex(lhsT)] + rhs.values[e.getIndex(rhsT)];
         }
         return retval;
     }
@@ -56,13 +52,11 @@ namespace AIToolbox::Factored {
         // No need to zero fill
 
         PartialFactorsEnumerator e(space, retval.tag);
+        const auto lhsT = e.addTarget(lhs.tag), rhsT = e.addTarget(rhs.tag);
         for (size_t i = 0; e.isValid(); e.advance(), ++i) {
             // We don't need to compute the index for retval since it
             // increases sequentially anyway.
-            const auto lhsId = toIndexPartial(lhs.tag, space, *e);
-            const auto rhsId = toIndexPartial(rhs.tag, space, *e);
-
-            retval.values[i] = lhs.values[lhsId] - rhs.values[rhsId];
+            retval.values[i] = lhs.values[e.getIndex(lhsT)] - rhs.values[e.getIndex(rhsT)];
         }
         return retval;
     }
@@ -73,11 +67,9 @@ namespace AIToolbox::Factored {
             return retval;
         }
         PartialFactorsEnumerator e(space, retval.tag);
-        for (size_t i = 0; e.isValid(); e.advance(), ++i) {
-            const auto rhsId = toIndexPartial(rhs.tag, space, *e);
-
-            retval.values[i] += rhs.values[rhsId];
-        }
+        const auto rhsT = e.addTarget(rhs.tag);
+        for (size_t i = 0; e.isValid(); e.advance(), ++i)
+            retval.values[i] += rhs.values[e.getIndex(rhsT)];
         return retval;
     }
 
@@ -91,11 +83,9 @@ namespace AIToolbox::Factored {
             return retval;
         }
         PartialFactorsEnumerator e(space, retval.tag);
-        for (size_t i = 0; e.isValid(); e.advance(), ++i) {
-            const auto rhsId = toIndexPartial(rhs.tag, space, *e);
-
-            retval.values[i] -= rhs.values[rhsId];
-        }
+        const auto rhsT = e.addTarget(rhs.tag);
+        for (size_t i = 0; e.isValid(); e.advance(), ++i)
+            retval.values[i] -= rhs.values[e.getIndex(rhsT)];
         return retval;
     }
 
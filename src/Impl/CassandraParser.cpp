@@ -1,294 +1,334 @@
 #include <AIToolbox/Impl/CassandraParser.hpp>
 
-#include <numeric>
-#include <istream>
-#include <algorithm>
+#include <AIToolbox/Impl/Parsing.hpp>
+#include <AIToolbox/Utils/Core.hpp>
 
-#include <boost/tokenizer.hpp>
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <charconv>
+#include <istream>
+#include <stdexcept>
 
 namespace AIToolbox::Impl {
-    CassandraParser::CassandraParser() {
-        // Assign an action to parse each value for the preambles. Lines parsed
-        // in the preamble are parsed before the others.
-        initMap_["values"] = [](const std::string &){};
-        initMap_["states"] = [this](const std::string & line){
-            S = extractIDs(line, stateMap_);
-        };
-        initMap_["actions"] = [this](const std::string & line){
-            A = extractIDs(line, actionMap_);
-        };
-        initMap_["observations"] = [this](const std::string & line){
-            O = extractIDs(line, observationMap_);
-        };
-        initMap_["discount"] = [this](const std::string & line){
-            discount = std::stod(tokenize(line, ":").at(1));
-        };
-    }
-
-    CassandraParser::MDPVals CassandraParser::parseMDP(std::istream & input) {
-        // Parse preamble.
-        parseModelInfo(input);
-
-        if (!S || !A)
-            throw std::runtime_error("MDP definition is incomplete");
-
-        // Init matrices to store data.
-        initMatrices();
-
-        for (i_ = 0; i_ < lines_.size(); ++i_) {
-            const auto & line = lines_[i_];
-
-            if (boost::starts_with(line, "T")) {
-                processMatrix(T, stateMap_, stateMap_);
-                continue;
-            }
-
-            if (boost::starts_with(line, "R")) {
-                processReward();
-                continue;
-            }
+    namespace {
+        constexpr const char * Whitespace = " \t\r\n";
+
+        std::string_view trim(std::string_view str) {
+            const auto begin = str.find_first_not_of(Whitespace);
+            if (begin == std::string_view::npos) return {};
+            const auto end = str.find_last_not_of(Whitespace);
+            return str.substr(begin, end - begin + 1);
         }
 
-        return MDPVals(S, A, T, R, discount);
+        bool startsWith(std::string_view str, std::string_view prefix) {
+            return str.substr(0, prefix.size()) == prefix;
+        }
     }
 
-    CassandraParser::POMDPVals CassandraParser::parsePOMDP(std::istream & input) {
-        // Parse preamble.
-        parseModelInfo(input);
-
-        if (!S || !A || !O)
-            throw std::runtime_error("POMDP definition is incomplete");
+    CassandraParser::CassandraParser() : input_(nullptr), nextPending_(0), S(0), A(0), O(0), discount(1.0) {}
 
-        // Init matrices to store data.
-        initMatrices();
+    CassandraParser::MDPVals CassandraParser::parseMDP(std::istream & input) {
+        parse(input, false);
 
-        for (i_ = 0; i_< lines_.size(); ++i_) {
-            const auto & line = lines_[i_];
+        return MDPVals(S, A, makeMatrices(T, S, S), makeMatrices(R, S, S), discount);
+    }
 
-            if (boost::starts_with(line, "T")) {
-                processMatrix(T, stateMap_, stateMap_);
-                continue;
-            }
+    CassandraParser::POMDPVals CassandraParser::parsePOMDP(std::istream & input) {
+        parse(input, true);
 
-            if (boost::starts_with(line, "O")) {
-                processMatrix(W, stateMap_, observationMap_);
-                continue;
-            }
+        return POMDPVals(S, A, O, makeMatrices(T, S, S), makeMatrices(R, S, S), makeMatrices(W, S, O), discount);
+    }
 
-            if (boost::starts_with(line, "R")) {
-                processReward();
-                continue;
+    void CassandraParser::checkProbabilities(const SparseMatrix3D & M, const char * message) {
+        for (const auto & m : M) {
+            for (Eigen::Index i = 0; i < m.outerSize(); ++i) {
+                double sum = 0.0;
+                for (SparseMatrix2D::InnerIterator it(m, i); it; ++it) {
+                    if (it.value() < 0.0) throw std::invalid_argument(message);
+                    sum += it.value();
+                }
+                if (!checkEqualSmall(sum, 1.0)) throw std::invalid_argument(message);
             }
         }
-
-        return POMDPVals(S, A, O, T, R, W, discount);
     }
 
     // ############################
     // ####  PRIVATE FUNCTIONS  ###
     // ############################
 
-    void CassandraParser::parseModelInfo(std::istream & input) {
-        // This is the same for both MDP and POMDP, and we don't really care
-        // here what we find or not.
-
-        // Clear all variables that may have been setup. We don't have to clear
-        // the matrices since we do that later during initialization.
-        lines_.clear();
+    void CassandraParser::parse(std::istream & input, const bool pomdp) {
+        input_ = &input;
+        pending_.clear();
+        nextPending_ = 0;
         S = 0, A = 0, O = 0;
         discount = 1.0;
+        stateMap_.clear();
+        actionMap_.clear();
+        observationMap_.clear();
+
+        // Read the preamble. Any entry found before it is complete is
+        // buffered, since we can't store it without knowing the sizes.
+        while (!(S && A && (O || !pomdp)) && std::getline(input, line_)) {
+            const auto line = trim(line_);
+            if (line.empty() || processPreamble(line)) continue;
+            pending_.emplace_back(line);
+        }
 
-        for(std::string line; std::getline(input, line); ) {
-            boost::trim(line);
-            if (line == "") continue;
+        if (!S || !A || (pomdp && !O))
+            throw std::runtime_error(pomdp ? "POMDP definition is incomplete" : "MDP definition is incomplete");
 
-            bool parsed = false;
-            for (const auto & it : initMap_) {
-                if (boost::starts_with(line, it.first)) {
-                    it.second(line);
-                    parsed = true;
-                    break;
-                }
-            }
+        T.assign(A, {});
+        R.assign(A, {});
+        W.assign(pomdp ? A : 0, {});
+        wasEmpty_.resize(A);
+
+        std::string_view line;
+        while (nextLine(&line)) {
+            // Allow the discount to be specified after the entries.
+            if (processPreamble(line)) continue;
 
-            if (!parsed)
-                lines_.push_back(std::move(line));
+            switch (line[0]) {
+                case 'T': processMatrix(line, T, S, S, stateMap_, stateMap_); break;
+                case 'O': if (pomdp) processMatrix(line, W, S, O, stateMap_, observationMap_); break;
+                case 'R': processReward(line); break;
+                default:;
+            }
         }
     }
 
-    void CassandraParser::initMatrix(DumbMatrix3D & M, const size_t D1, const size_t D2, const size_t D3) {
-        M.resize(D1);
-        for (size_t i = 0; i < D1; ++i) {
-            M[i].resize(D2);
-            for (size_t j = 0; j < D2; ++j) {
-                M[i][j].resize(D3);
-                std::fill(std::begin(M[i][j]), std::end(M[i][j]), 0);
-            }
+    bool CassandraParser::nextLine(std::string_view * line) {
+        if (nextPending_ < pending_.size()) {
+            *line = pending_[nextPending_++];
+            return true;
         }
+        if (pending_.size()) {
+            pending_.clear();
+            pending_.shrink_to_fit();
+            nextPending_ = 0;
+        }
+        while (std::getline(*input_, line_)) {
+            *line = trim(line_);
+            if (!line->empty()) return true;
+        }
+        return false;
     }
 
-    void CassandraParser::initMatrices() {
-        if (S && A) {
-            initMatrix(T, S, A, S);
-            initMatrix(R, S, A, S);
-            if (O)
-                initMatrix(W, S, A, O);
+    bool CassandraParser::processPreamble(const std::string_view line) {
+        const auto setSize = [&](size_t & size, IDMap & map) {
+            if (size) throw std::runtime_error("Parsing error: redefinition in '" + std::string(line) + "'");
+            size = extractIDs(line, map);
+        };
+
+        if (startsWith(line, "states"))            setSize(S, stateMap_);
+        else if (startsWith(line, "actions"))      setSize(A, actionMap_);
+        else if (startsWith(line, "observations")) setSize(O, observationMap_);
+        else if (startsWith(line, "discount")) {
+            tokenize(line, ":", &tokens_);
+            if (tokens_.size() < 2) throw std::runtime_error("Parsing error: missing discount");
+            discount = parseNumber(tokens_[1]);
         }
+        else if (!startsWith(line, "values")) return false;
+
+        return true;
     }
 
-    size_t CassandraParser::extractIDs(const std::string & line, IDMap & map) {
+    size_t CassandraParser::extractIDs(const std::string_view line, IDMap & map) {
         map.clear();
 
-        const auto split = tokenize(line, ":");
-        const auto ids = tokenize(split.at(1), " ");
+        tokenize(line, ":", &tokens_);
+        if (tokens_.size() < 2) throw std::runtime_error("Parsing error: missing values in '" + std::string(line) + "'");
+        tokenize(tokens_[1], Whitespace, &vectorTokens_);
 
         // Try the number way
-        if (ids.size() == 1) {
-            try {
-                return std::stoul(ids[0]);
-            } catch (std::invalid_argument) {}
+        if (vectorTokens_.size() == 1) {
+            const auto str = vectorTokens_[0];
+            size_t val;
+            const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
+            if (ec == std::errc() && ptr == str.data() + str.size())
+                return val;
         }
 
-        for (size_t i = 0; i < ids.size(); ++i)
-            map[boost::trim_copy(ids[i])] = i;
+        for (size_t i = 0; i < vectorTokens_.size(); ++i)
+            map[std::string(vectorTokens_[i])] = i;
 
-        return ids.size();
+        return vectorTokens_.size();
     }
 
-    CassandraParser::Tokens CassandraParser::tokenize(const std::string & str, const char * list) {
-        using Tokenizer = boost::tokenizer<boost::char_separator<char>>;
-        boost::char_separator<char> sep(list);
-
-        Tokenizer parser(str, sep);
+    void CassandraParser::tokenize(const std::string_view str, const char * list, Tokens * tokensp) {
+        auto & tokens = *tokensp;
+        tokens.clear();
+
+        size_t begin = str.find_first_not_of(list);
+        while (begin != std::string_view::npos) {
+            const size_t end = str.find_first_of(list, begin);
+            const auto token = trim(str.substr(begin, end == std::string_view::npos ? end : end - begin));
+            if (!token.empty()) tokens.push_back(token);
+            if (end == std::string_view::npos) break;
+            begin = str.find_first_not_of(list, end);
+        }
+    }
 
-        Tokens tokens;
-        std::copy(std::begin(parser), std::end(parser), std::back_inserter(tokens));
-        for (auto & str : tokens)
-            boost::trim(str);
+    double CassandraParser::parseNumber(const std::string_view str) {
+        const char * ptr = str.data();
+        double val;
+        if (!parseDouble(ptr, str.data() + str.size(), val) || ptr != str.data() + str.size())
+            throw std::runtime_error("Parsing error: invalid number '" + std::string(str) + "'");
 
-        return tokens;
+        return val;
     }
 
-    std::vector<size_t> CassandraParser::parseIndeces(const std::string & str, const IDMap & map, const size_t max) {
-        std::vector<size_t> retval;
-
-        if (str == "*") {
-            retval.resize(max);
-            std::iota(std::begin(retval), std::end(retval), 0);
-        } else {
-            if (auto it = map.find(str); it != std::end(map)) {
-                retval.push_back(it->second);
-            } else {
-                const size_t val = std::stoul(str);
-                if (val >= max) throw std::runtime_error("Input value too high");
-                retval.push_back(val);
-            }
-        }
-        return retval;
+    std::pair<size_t, size_t> CassandraParser::parseIndeces(const std::string_view str, const IDMap & map, const size_t max) {
+        if (str == "*") return {0, max};
+
+        if (map.size())
+            if (const auto it = map.find(std::string(str)); it != std::end(map))
+                return {it->second, it->second + 1};
+
+        size_t val;
+        const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
+        if (ec != std::errc() || ptr != str.data() + str.size())
+            throw std::runtime_error("Parsing error: unknown index '" + std::string(str) + "'");
+        if (val >= max) throw std::runtime_error("Input value too high");
+
+        return {val, val + 1};
     }
 
-    CassandraParser::DumbMatrix1D CassandraParser::parseVector(Tokens::const_iterator begin, Tokens::const_iterator end, const size_t N) {
+    void CassandraParser::parseVector(Tokens::const_iterator begin, Tokens::const_iterator end, const size_t N) {
         if (std::distance(begin, end) != (int)N)
             throw std::runtime_error("Wrong number of elements when parsing vector.");
 
-        DumbMatrix1D retval;
-        for (; begin < end; ++begin)
-            retval.push_back(std::stod(*begin));
-
-        return retval;
+        vector_.resize(N);
+        for (size_t i = 0; begin < end; ++begin, ++i)
+            vector_[i] = parseNumber(*begin);
     }
 
-    CassandraParser::DumbMatrix1D CassandraParser::parseVector(const std::string & str, size_t N) {
-        const auto tokens = tokenize(str, " ");
-        return parseVector(std::begin(tokens), std::end(tokens), N);
+    void CassandraParser::startEntry(const std::vector<Triplets> & M) {
+        for (size_t a = 0; a < M.size(); ++a)
+            wasEmpty_[a] = M[a].empty();
     }
 
-    void CassandraParser::processMatrix(DumbMatrix3D & M, const IDMap & d1map, const IDMap & d3map) {
-        const std::string & str = lines_[i_];
+    void CassandraParser::addValue(std::vector<Triplets> & M, const size_t a, const size_t d1, const size_t d3, const double val) {
+        if (val == 0.0 && wasEmpty_[a]) return;
+        M[a].emplace_back(d1, d3, val);
+    }
 
-        const size_t D1 = M.size();
-        const size_t D3 = M[0][0].size();
+    void CassandraParser::processMatrix(const std::string_view str, std::vector<Triplets> & M, const size_t D1, const size_t D3, const IDMap & d1map, const IDMap & d3map) {
+        tokenize(str, ": ", &tokens_);
+        startEntry(M);
 
         switch (std::count(std::begin(str), std::end(str), ':')) {
             case 3: {
                 // M: <action> : <start-state> : <end-state> <prob>
-                const auto tokens = tokenize(str, ": ");
+                if (tokens_.size() != 5) throw std::runtime_error("Parsing error: wrong number of arguments in '" + std::string(str) + "'");
 
                 // Action is first both in transition and observation
-                const auto av  = parseIndeces(tokens.at(1), actionMap_, A);
-                const auto d1v = parseIndeces(tokens.at(2), d1map, D1);
-                const auto d3v = parseIndeces(tokens.at(3), d3map, D3);
-                const auto val = std::stod(tokens.at(4));
-
-                for (const auto d1 : d1v)
-                    for (const auto a : av)
-                        for (const auto d3 : d3v)
-                            M[d1][a][d3] = val;
+                const auto [a0, a1]   = parseIndeces(tokens_[1], actionMap_, A);
+                const auto [d10, d11] = parseIndeces(tokens_[2], d1map, D1);
+                const auto [d30, d31] = parseIndeces(tokens_[3], d3map, D3);
+                const auto val = parseNumber(tokens_[4]);
+
+                for (auto a = a0; a < a1; ++a)
+                    for (auto d1 = d10; d1 < d11; ++d1)
+                        for (auto d3 = d30; d3 < d31; ++d3)
+                            addValue(M, a, d1, d3, val);
                 break;
             }
             case 2: {
                 // M: <action> : <start-state>
                 // Here we need to read a vector
-                const auto tokens = tokenize(str, ": ");
+                if (tokens_.size() < 3) throw std::runtime_error("Parsing error: wrong number of arguments in '" + std::string(str) + "'");
 
-                const auto av  = parseIndeces(tokens.at(1), actionMap_, A);
-                const auto d1v = parseIndeces(tokens.at(2), d1map, D1);
+                const auto [a0, a1]   = parseIndeces(tokens_[1], actionMap_, A);
+                const auto [d10, d11] = parseIndeces(tokens_[2], d1map, D1);
 
-                DumbMatrix1D v;
-                if (tokens.size() == 3 + D3) {
+                if (tokens_.size() == 3 + D3) {
                     // Parse at the end
-                    v = parseVector(std::begin(tokens) + 3, std::end(tokens), D3);
-                } else if (tokens.size() == 3) {
-                    // Parse next line
-                    v = parseVector(lines_.at(++i_), D3);
+                    parseVector(std::begin(tokens_) + 3, std::end(tokens_), D3);
+                } else if (tokens_.size() == 3) {
+                    // Parse next line. This invalidates the tokens of the
+                    // current one, so we must not use them anymore.
+                    std::string_view next;
+                    if (!nextLine(&next)) throw std::runtime_error("Parsing error: missing vector");
+                    if (next == "uniform") {
+                        vector_.assign(D3, 1.0 / D3);
+                    } else {
+                        tokenize(next, Whitespace, &vectorTokens_);
+                        parseVector(std::begin(vectorTokens_), std::end(vectorTokens_), D3);
+                    }
                 } else {
-                    std::runtime_error("Parsing error: wrong number of arguments in '" + str + "'");
+                    throw std::runtime_error("Parsing error: wrong number of arguments in '" + std::string(str) + "'");
                 }
-                for (const auto d1 : d1v)
-                    for (const auto a : av)
-                        M[d1][a] = v;
+                for (auto a = a0; a < a1; ++a)
+                    for (auto d1 = d10; d1 < d11; ++d1)
+                        for (size_t d3 = 0; d3 < D3; ++d3)
+                            addValue(M, a, d1, d3, vector_[d3]);
                 break;
             }
             case 1: {
                 // M: <action>
-                // Here we need to read a whole 2D table
-                const auto tokens = tokenize(str, ": ");
-                const auto av  = parseIndeces(tokens.at(1), actionMap_, A);
+                // Here we need to read a whole 2D table, or a keyword.
+                if (tokens_.size() != 2) throw std::runtime_error("Parsing error: wrong number of arguments in '" + std::string(str) + "'");
+                const auto [a0, a1] = parseIndeces(tokens_[1], actionMap_, A);
 
                 for (size_t d1 = 0; d1 < D1; ++d1) {
-                    const auto v = parseVector(lines_.at(++i_), D3);
-
-                    for (const auto a : av)
-                        M[d1][a] = v;
+                    std::string_view next;
+                    if (!nextLine(&next)) throw std::runtime_error("Parsing error: missing matrix row");
+
+                    if (d1 == 0 && (next == "identity" || next == "uniform")) {
+                        const bool identity = next == "identity";
+                        if (identity && D1 != D3) throw std::runtime_error("Parsing error: identity of non-square matrix");
+                        for (auto a = a0; a < a1; ++a)
+                            for (size_t i = 0; i < D1; ++i)
+                                for (size_t d3 = 0; d3 < D3; ++d3)
+                                    addValue(M, a, i, d3, identity ? double(i == d3) : 1.0 / D3);
+                        break;
+                    }
+
+                    tokenize(next, Whitespace, &vectorTokens_);
+                    parseVector(std::begin(vectorTokens_), std::end(vectorTokens_), D3);
+
+                    for (auto a = a0; a < a1; ++a)
+                        for (size_t d3 = 0; d3 < D3; ++d3)
+                            addValue(M, a, d1, d3, vector_[d3]);
                 }
                 break;
             }
-            default: throw std::runtime_error("Parsing error: wrong number of ':' in '" + str + "'");
+            default: throw std::runtime_error("Parsing error: wrong number of ':' in '" + std::string(str) + "'");
         }
     }
 
-    void CassandraParser::processReward() {
-        const std::string & str = lines_[i_];
-
+    void CassandraParser::processReward(const std::string_view str) {
         switch (std::count(std::begin(str), std::end(str), ':')) {
             case 4: {
                 // R: <action> : <start-state> : <end-state> : <obs> <prob>
-                const auto tokens = tokenize(str, ": ");
-
-                // Action is first both in transition and observation
-                const auto av   = parseIndeces(tokens.at(1), actionMap_, A);
-                const auto sv   = parseIndeces(tokens.at(2), stateMap_,  S);
-                const auto s1v  = parseIndeces(tokens.at(3), stateMap_,  S);
-                const auto val = std::stod(tokens.at(5));
-
-                for (const auto s : sv)
-                    for (const auto a : av)
-                        for (const auto s1 : s1v)
-                            R[s][a][s1] = val;
+                tokenize(str, ": ", &tokens_);
+                if (tokens_.size() != 6) throw std::runtime_error("Parsing error: wrong number of arguments in '" + std::string(str) + "'");
+                startEntry(R);
+
+                const auto [a0, a1]   = parseIndeces(tokens_[1], actionMap_, A);
+                const auto [s0, s1]   = parseIndeces(tokens_[2], stateMap_,  S);
+                const auto [s10, s11] = parseIndeces(tokens_[3], stateMap_,  S);
+                const auto val = parseNumber(tokens_[5]);
+
+                for (auto a = a0; a < a1; ++a)
+                    for (auto s = s0; s < s1; ++s)
+                        for (auto s1 = s10; s1 < s11; ++s1)
+                            addValue(R, a, s, s1, val);
                 break;
             }
-            default: throw std::runtime_error("Parsing error: wrong number of ':' in '" + str + "'");
+            default: throw std::runtime_error("Parsing error: wrong number of ':' in '" + std::string(str) + "'");
         }
     }
+
+    SparseMatrix3D CassandraParser::makeMatrices(std::vector<Triplets> & M, const size_t D1, const size_t D3) {
+        SparseMatrix3D retval(M.size(), SparseMatrix2D(D1, D3));
+
+        for (size_t a = 0; a < M.size(); ++a) {
+            // Later entries overwrite earlier ones.
+            retval[a].setFromTriplets(std::begin(M[a]), std::end(M[a]), [](const double &, const double & b) { return b; });
+            retval[a].prune([](Eigen::Index, Eigen::Index, const double & v) { return v != 0.0; });
+            Triplets().swap(M[a]);
+        }
+
+        return retval;
+    }
 }
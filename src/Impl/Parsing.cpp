@@ -0,0 +1,33 @@
+#include <AIToolbox/Impl/Parsing.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace AIToolbox::Impl {
+    bool parseDouble(const char *& begin, const char * end, double & val) {
+        const size_t size = end - begin;
+
+        // Numbers are short, so we avoid allocating for all sensible inputs.
+        char buffer[64];
+        std::string longBuffer;
+        char * copy = buffer;
+        if (size >= sizeof(buffer)) {
+            longBuffer.assign(begin, size);
+            copy = longBuffer.data();
+        } else {
+            std::memcpy(buffer, begin, size);
+            buffer[size] = '\0';
+        }
+
+        char * ptr;
+        errno = 0;
+        const double v = std::strtod(copy, &ptr);
+        if (ptr == copy || errno == ERANGE) return false;
+
+        val = v;
+        begin += ptr - copy;
+        return true;
+    }
+}
@@ -0,0 +1,66 @@
+#include "KernelsImpl.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace AIToolbox {
+    namespace Impl {
+        const Kernels & getKernelsGeneric() {
+            static const Kernels kernels = makeKernels(Kernels::ISA::Generic);
+            return kernels;
+        }
+#ifdef AI_KERNELS_X86
+        // These are compiled in their own files, with their own flags.
+        const Kernels & getKernelsAVX2();
+        const Kernels & getKernelsAVX512();
+#endif
+    }
+
+    namespace {
+        const Kernels * getVariant(const Kernels::ISA isa) {
+            switch ( isa ) {
+                case Kernels::ISA::Generic:
+                    return &Impl::getKernelsGeneric();
+#ifdef AI_KERNELS_X86
+                case Kernels::ISA::AVX2:
+                    if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+                        return &Impl::getKernelsAVX2();
+                    break;
+                case Kernels::ISA::AVX512:
+                    if ( __builtin_cpu_supports("avx512f") )
+                        return &Impl::getKernelsAVX512();
+                    break;
+#endif
+                default:
+                    break;
+            }
+            return nullptr;
+        }
+
+        const Kernels * selectKernels() {
+            for ( auto isa : {Kernels::ISA::AVX512, Kernels::ISA::AVX2} )
+                if ( const auto k = getVariant(isa) )
+                    return k;
+            return getVariant(Kernels::ISA::Generic);
+        }
+
+        std::atomic<const Kernels *> & activeKernels() {
+            static std::atomic<const Kernels *> kernels(selectKernels());
+            return kernels;
+        }
+    }
+
+    const Kernels & getKernels() {
+        return *activeKernels().load(std::memory_order_relaxed);
+    }
+
+    bool isKernelsISASupported(const Kernels::ISA isa) {
+        return getVariant(isa) != nullptr;
+    }
+
+    void setKernelsISA(const Kernels::ISA isa) {
+        const auto k = getVariant(isa);
+        if ( !k ) throw std::invalid_argument("The requested kernels are not supported on this machine");
+        activeKernels().store(k, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,9 @@
+// This file is compiled with AVX2 and FMA enabled.
+#include "KernelsImpl.hpp"
+
+namespace AIToolbox::Impl {
+    const Kernels & getKernelsAVX2() {
+        static const Kernels kernels = makeKernels(Kernels::ISA::AVX2);
+        return kernels;
+    }
+}
@@ -0,0 +1,9 @@
+// This file is compiled with AVX-512F enabled.
+#include "KernelsImpl.hpp"
+
+namespace AIToolbox::Impl {
+    const Kernels & getKernelsAVX512() {
+        static const Kernels kernels = makeKernels(Kernels::ISA::AVX512);
+        return kernels;
+    }
+}
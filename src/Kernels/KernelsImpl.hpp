@@ -0,0 +1,128 @@
+#ifndef AI_TOOLBOX_KERNELS_IMPL_HEADER_FILE
+#define AI_TOOLBOX_KERNELS_IMPL_HEADER_FILE
+
+// This file contains the bodies of the kernels. It is included by each of
+// the Kernels*.cpp files, each compiled for a different instruction set, so
+// that the compiler can vectorize the same loops differently.
+//
+// Everything here MUST have internal linkage, and MUST NOT call Eigen or
+// other inline library code: otherwise the linker could merge functions
+// compiled for a wide instruction set into code that runs everywhere.
+//
+// The loops are written with independent accumulators, so the compiler can
+// vectorize the reductions without reordering floating point operations;
+// this is also why all variants produce identical results.
+
+#include <AIToolbox/Kernels.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr size_t Lanes = 8;
+
+    double sumLanes(const double * acc) {
+        return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+    }
+
+    double dot(const double * a, const double * b, const size_t n) {
+        double acc[Lanes] = {};
+        size_t i = 0;
+        for ( ; i + Lanes <= n; i += Lanes )
+            for ( size_t l = 0; l < Lanes; ++l )
+                acc[l] += a[i + l] * b[i + l];
+
+        double tail = 0.0;
+        for ( ; i < n; ++i )
+            tail += a[i] * b[i];
+
+        return sumLanes(acc) + tail;
+    }
+
+    void gemv(const size_t m, const size_t n, const double * a, const double * x, double * y, const size_t incy) {
+        for ( size_t i = 0; i < m; ++i )
+            y[i * incy] += dot(a + i * n, x, n);
+    }
+
+    void gemvT(const size_t m, const size_t n, const double * a, const double * x, double * __restrict y) {
+        for ( size_t j = 0; j < n; ++j )
+            y[j] = 0.0;
+
+        for ( size_t i = 0; i < m; ++i ) {
+            const double xi = x[i];
+            if ( xi == 0.0 ) continue;
+
+            const double * row = a + i * n;
+            for ( size_t j = 0; j < n; ++j )
+                y[j] += xi * row[j];
+        }
+    }
+
+    // exp(x) = 2^k * exp(r), with k = round(x / ln2) and |r| <= ln2 / 2.
+    // exp(r) is computed with its Taylor expansion up to degree 12, whose
+    // error is below one ulp in that range. 2^k is built directly from the
+    // bits of the rounding.
+    double expKernel(const double x) {
+        constexpr double log2e = 1.4426950408889634074;
+        constexpr double ln2hi = 6.93147180369123816490e-01;
+        constexpr double ln2lo = 1.90821492927058770002e-10;
+        // Adding this rounds to the nearest integer, which ends up in the
+        // low bits of the mantissa.
+        constexpr double shifter = 6755399441055744.0; // 1.5 * 2^52
+        constexpr std::int64_t shifterBits = 0x4338000000000000;
+
+        constexpr double minX = -708.0, maxX = 709.0;
+        const double xc = x < minX ? minX : (x > maxX ? maxX : x);
+
+        const double t = xc * log2e + shifter;
+        const double k = t - shifter;
+        const double r = (xc - k * ln2hi) - k * ln2lo;
+
+        double p = 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        std::int64_t bits;
+        std::memcpy(&bits, &t, sizeof(bits));
+        bits = (bits - shifterBits + 1023) << 52;
+        double scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+
+        const double retval = p * scale;
+        return x < minX ? 0.0 : (x > maxX ? std::numeric_limits<double>::infinity() : retval);
+    }
+
+    double expScaled(const size_t n, const double * x, const double scale, double * __restrict y) {
+        for ( size_t i = 0; i < n; ++i )
+            y[i] = expKernel(x[i] * scale);
+
+        double acc[Lanes] = {};
+        size_t i = 0;
+        for ( ; i + Lanes <= n; i += Lanes )
+            for ( size_t l = 0; l < Lanes; ++l )
+                acc[l] += y[i + l];
+
+        double tail = 0.0;
+        for ( ; i < n; ++i )
+            tail += y[i];
+
+        return sumLanes(acc) + tail;
+    }
+
+    AIToolbox::Kernels makeKernels(const AIToolbox::Kernels::ISA isa) {
+        return {isa, &dot, &gemv, &gemvT, &expScaled};
+    }
+}
+
+#endif
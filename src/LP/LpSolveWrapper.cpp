@@ -1,6 +1,7 @@
 #include <AIToolbox/LP.hpp>
 
 #include <type_traits>
+#include <vector>
 
 #include <lpsolve/lp_lib.h>
 
@@ -35,6 +36,10 @@ namespace AIToolbox {
 
         std::unique_ptr<lprec, void(*)(lprec*)> lp_;
         std::unique_ptr<double[]> data_;
+
+        // Buffers to pass the non-zero elements of sparse rows.
+        std::vector<int> colno_;
+        std::vector<REAL> values_;
     };
 
     LP::LP_impl::LP_impl(const size_t vars) :
@@ -73,7 +78,7 @@ namespace AIToolbox {
     // Row is initialized from 1 since lp_solve reads element from 1 onwards
     LP::LP(const size_t varNumber) :
             pimpl_(new LP_impl(varNumber)), row(pimpl_->data_.get()+1, varNumber),
-            varNumber_(varNumber), maximize_(false) {}
+            varNumber_(varNumber), maximize_(false), warmStart_(false) {}
 
     void LP::setObjective(const size_t n, const bool maximize) {
         set_obj(pimpl_->lp_.get(), n+1, 1.0);
@@ -98,15 +103,30 @@ namespace AIToolbox {
         add_constraint(pimpl_->lp_.get(), pimpl_->conversionData(), toLpSolveConstraint(c), static_cast<REAL>(value));
     }
 
-    // TODO: Implement this version of pushRow to improve performance.
-    // void LP::pushRow(const std::vector<int> & ids, const Constraint c, const double value) {
-    //     add_constraintex(pimpl_->lp_.get(), ids.size(), pimpl_->conversionData(), ids.data(), toLpSolveConstraint(c), static_cast<REAL>(value));
-    // }
+    void LP::pushRow(const std::vector<size_t> & ids, const Constraint c, const double value) {
+        auto & colno = pimpl_->colno_;
+        auto & values = pimpl_->values_;
+
+        colno.clear();
+        values.clear();
+        for ( const auto i : ids ) {
+            colno.push_back(static_cast<int>(i) + 1);
+            values.push_back(static_cast<REAL>(row[i]));
+        }
+        add_constraintex(pimpl_->lp_.get(), colno.size(), values.data(), colno.data(), toLpSolveConstraint(c), static_cast<REAL>(value));
+    }
 
     void LP::popRow() {
         del_constraint(pimpl_->lp_.get(), get_Nrows(pimpl_->lp_.get()));
     }
 
+    void LP::setRow(const size_t n, const Constraint c, const double value) {
+        auto lp = pimpl_->lp_.get();
+        set_row(lp, n+1, pimpl_->conversionData());
+        set_constr_type(lp, n+1, toLpSolveConstraint(c));
+        set_rh(lp, n+1, static_cast<REAL>(value));
+    }
+
     size_t LP::addColumn() {
         ++varNumber_;
         // Add element to row
@@ -123,17 +143,8 @@ namespace AIToolbox {
         set_unbounded(pimpl_->lp_.get(), n+1);
     }
 
-    std::optional<Vector> LP::solve(const size_t variables, double * objective) {
-        auto lp = pimpl_->lp_.get();
-        // lp_solve uses the result of the previous runs to bootstrap
-        // the new solution. Sometimes this breaks down for some reason,
-        // so we just avoid it - it does not really even give a performance
-        // boost..
-        default_basis(lp);
-
-        // print_lp(pimpl_->lp_.get());
-        const auto result = ::solve(lp);
-
+    // Extracts the solution after a call to ::solve.
+    static std::optional<Vector> getSolution(lprec * lp, const int result, const size_t variables, double * objective) {
         REAL * vp;
         get_ptr_variables(lp, &vp);
 
@@ -148,6 +159,36 @@ namespace AIToolbox {
         return solution;
     }
 
+    std::optional<Vector> LP::solve(const size_t variables, double * objective) {
+        auto lp = pimpl_->lp_.get();
+        // lp_solve uses the result of the previous runs to bootstrap
+        // the new solution. Sometimes this breaks down for some reason,
+        // so here we avoid it; resolve() can try it, with this as a fallback.
+        default_basis(lp);
+
+        // print_lp(pimpl_->lp_.get());
+        return getSolution(lp, ::solve(lp), variables, objective);
+    }
+
+    std::optional<Vector> LP::resolve(const size_t variables, double * objective) {
+        if ( !warmStart_ )
+            return solve(variables, objective);
+
+        auto lp = pimpl_->lp_.get();
+        const auto result = ::solve(lp);
+        // A bad warm start can make lp_solve stop early, or even wrongly
+        // report the LP as infeasible (see solve()). We only trust it when
+        // it reaches OPTIMAL; otherwise we redo the solve from scratch.
+        if ( result != OPTIMAL )
+            return solve(variables, objective);
+
+        return getSolution(lp, result, variables, objective);
+    }
+
+    void LP::setWarmStart(const bool warmStart) {
+        warmStart_ = warmStart;
+    }
+
     void LP::resize(const size_t rows) {
         resize_lp(pimpl_->lp_.get(), rows, row.size());
     }
@@ -163,4 +204,5 @@ namespace AIToolbox {
         // method though) would be:
         // return static_cast<double>(get_break_numeric_accuracy(pimpl_->lp_.get()));
     }
+
 }
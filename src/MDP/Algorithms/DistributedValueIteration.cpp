@@ -0,0 +1,145 @@
+#include <AIToolbox/MDP/Algorithms/DistributedValueIteration.hpp>
+
+namespace AIToolbox::MDP {
+    ModelPartition::ModelPartition(const size_t s, const size_t begin, const size_t end, const SparseMatrix3D & t, const Matrix2D & ir, const double discount) :
+            S(s), A(t.size()), begin_(begin), end_(end), discount_(discount), transitions_(A)
+    {
+        const size_t N = end_ - begin_;
+        if ( begin_ > end_ || end_ > S )
+            throw std::invalid_argument("Invalid partition range");
+        if ( A == 0 )
+            throw std::invalid_argument("Partition must have at least one action");
+        if ( static_cast<size_t>(ir.rows()) != N || static_cast<size_t>(ir.cols()) != A )
+            throw std::invalid_argument("Immediate rewards of the partition have the wrong size");
+        for ( const auto & m : t )
+            if ( static_cast<size_t>(m.rows()) != N || static_cast<size_t>(m.cols()) != S )
+                throw std::invalid_argument("Transitions of the partition have the wrong size");
+
+        // Find all states outside of the partition that we can reach.
+        for ( const auto & m : t )
+            for ( int k = 0; k < m.outerSize(); ++k )
+                for ( SparseMatrix2D::InnerIterator it(m, k); it; ++it )
+                    if ( static_cast<size_t>(it.col()) < begin_ || static_cast<size_t>(it.col()) >= end_ )
+                        ghosts_.push_back(it.col());
+
+        std::sort(std::begin(ghosts_), std::end(ghosts_));
+        ghosts_.erase(std::unique(std::begin(ghosts_), std::end(ghosts_)), std::end(ghosts_));
+
+        // Renumber the columns: owned states first, then the ghosts.
+        const auto column = [this, N](const size_t s1) -> size_t {
+            if ( s1 >= begin_ && s1 < end_ ) return s1 - begin_;
+            return N + (std::lower_bound(std::begin(ghosts_), std::end(ghosts_), s1) - std::begin(ghosts_));
+        };
+
+        std::vector<Eigen::Triplet<double>> triplets;
+        for ( size_t a = 0; a < A; ++a ) {
+            const auto & m = t[a];
+            triplets.clear();
+            triplets.reserve(m.nonZeros());
+            for ( int k = 0; k < m.outerSize(); ++k )
+                for ( SparseMatrix2D::InnerIterator it(m, k); it; ++it )
+                    triplets.emplace_back(it.row(), column(it.col()), it.value());
+
+            transitions_[a].resize(N, N + ghosts_.size());
+            transitions_[a].setFromTriplets(std::begin(triplets), std::end(triplets));
+            transitions_[a].makeCompressed();
+        }
+
+        rewards_ = ir;
+    }
+
+    size_t ModelPartition::getS() const { return S; }
+    size_t ModelPartition::getA() const { return A; }
+    size_t ModelPartition::getBegin() const { return begin_; }
+    size_t ModelPartition::getEnd() const { return end_; }
+    double ModelPartition::getDiscount() const { return discount_; }
+    const std::vector<size_t> & ModelPartition::getGhosts() const { return ghosts_; }
+    const SparseMatrix2D & ModelPartition::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    const Matrix2D & ModelPartition::getRewardFunction() const { return rewards_; }
+
+    LocalHub::LocalHub(const size_t nodes) :
+            nodes_(nodes), waiting_(0), generation_(0),
+            indeces_(nodes, std::vector<std::vector<size_t>>(nodes)),
+            values_(nodes, std::vector<std::vector<double>>(nodes)),
+            reduce_(nodes)
+    {
+        if ( nodes_ == 0 )
+            throw std::invalid_argument("A LocalHub needs at least one node");
+    }
+
+    size_t LocalHub::getNodes() const { return nodes_; }
+
+    void LocalHub::barrier() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const auto generation = generation_;
+        if ( ++waiting_ == nodes_ ) {
+            waiting_ = 0;
+            ++generation_;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [this, generation]{ return generation_ != generation; });
+        }
+    }
+
+    template <typename T>
+    void LocalHub::exchange(const size_t rank, std::vector<std::vector<std::vector<T>>> & boxes,
+                            const std::vector<std::vector<T>> & send, std::vector<std::vector<T>> * recv)
+    {
+        if ( send.size() != nodes_ )
+            throw std::invalid_argument("Exchange needs one message per node");
+
+        for ( size_t j = 0; j < nodes_; ++j )
+            boxes[j][rank] = send[j];
+        barrier();
+
+        recv->resize(nodes_);
+        for ( size_t j = 0; j < nodes_; ++j )
+            (*recv)[j] = boxes[rank][j];
+        // Nobody can write the next messages until everybody has read.
+        barrier();
+    }
+
+    LocalTransport::LocalTransport(LocalHub & hub, const size_t rank) :
+            hub_(hub), rank_(rank)
+    {
+        if ( rank_ >= hub_.getNodes() )
+            throw std::invalid_argument("Rank is out of the range of the hub");
+    }
+
+    size_t LocalTransport::getRank() const { return rank_; }
+    size_t LocalTransport::getNodes() const { return hub_.getNodes(); }
+
+    void LocalTransport::exchange(const std::vector<std::vector<size_t>> & send, std::vector<std::vector<size_t>> * recv) {
+        hub_.exchange(rank_, hub_.indeces_, send, recv);
+    }
+
+    void LocalTransport::exchange(const std::vector<std::vector<double>> & send, std::vector<std::vector<double>> * recv) {
+        hub_.exchange(rank_, hub_.values_, send, recv);
+    }
+
+    double LocalTransport::allReduceMax(const double value) {
+        hub_.reduce_[rank_] = value;
+        hub_.barrier();
+        const double retval = *std::max_element(std::begin(hub_.reduce_), std::end(hub_.reduce_));
+        hub_.barrier();
+        return retval;
+    }
+
+    DistributedValueIteration::DistributedValueIteration(const unsigned horizon, const double tolerance) :
+            horizon_(horizon)
+    {
+        setTolerance(tolerance);
+    }
+
+    void DistributedValueIteration::setTolerance(const double t) {
+        if ( t < 0.0 ) throw std::invalid_argument("Tolerance must be >= 0");
+        tolerance_ = t;
+    }
+
+    void DistributedValueIteration::setHorizon(const unsigned h) {
+        horizon_ = h;
+    }
+
+    double DistributedValueIteration::getTolerance() const { return tolerance_; }
+    unsigned DistributedValueIteration::getHorizon() const { return horizon_; }
+}
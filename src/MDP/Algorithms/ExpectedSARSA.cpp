@@ -2,20 +2,25 @@
 
 namespace AIToolbox::MDP {
     ExpectedSARSA::ExpectedSARSA(QFunction & qfun, const PolicyInterface & policy, const double discount, const double alpha) :
-            policy_(policy), S(policy_.getS()), A(policy_.getA()), q_(qfun)
+            policy_(policy), S(policy_.getS()), A(policy_.getA()), q_(qfun), probabilities_(A)
     {
         setDiscount(discount);
         setLearningRate(alpha);
     }
 
     void ExpectedSARSA::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
-        double expectedQ = 0.0;
-        for (size_t ai = 0; ai < A; ++ai)
-            expectedQ += policy_.getActionProbability(s1, ai) * q_(s1, ai);
+        policy_.getActionProbabilities(s1, &probabilities_);
+        const double expectedQ = q_.row(s1).dot(probabilities_);
 
         q_(s, a) += alpha_ * ( rew + discount_ * expectedQ - q_(s, a) );
     }
 
+    void ExpectedSARSA::batchUpdateQ(const TransitionBatch & batch) {
+        const size_t N = checkTransitionBatch(batch);
+        for ( size_t i = 0; i < N; ++i )
+            stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+    }
+
     void ExpectedSARSA::setLearningRate(const double a) {
         if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Learning rate parameter must be in (0,1]");
         alpha_ = a;
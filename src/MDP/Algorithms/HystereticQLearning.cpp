@@ -17,6 +17,18 @@ namespace AIToolbox::MDP {
             q_(s, a) += beta_ * delta;
     }
 
+    void HystereticQLearning::batchUpdateQ(const TransitionBatch & batch) {
+        const size_t N = checkTransitionBatch(batch);
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto s = batch.states[i], a = batch.actions[i];
+            const auto delta = batch.rewards[i] + discount_ * q_.row(batch.nextStates[i]).maxCoeff() - q_(s, a);
+            if (delta >= 0)
+                q_(s, a) += alpha_ * delta;
+            else
+                q_(s, a) += beta_ * delta;
+        }
+    }
+
     void HystereticQLearning::setPositiveLearningRate(const double a) {
         if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Positive learning rate parameter must be in (0,1]");
         alpha_ = a;
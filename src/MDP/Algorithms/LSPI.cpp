@@ -0,0 +1,151 @@
+#include <AIToolbox/MDP/Algorithms/LSPI.hpp>
+
+#include <stdexcept>
+
+#include <Eigen/LU>
+
+namespace AIToolbox::MDP {
+    LSPI::LSPI(SparseMatrix2D features, const size_t A, const double discount, const unsigned maxIterations, const double tolerance, const double regularization) :
+            features_(std::move(features)), A_(A), maxIterations_(maxIterations), pool_(nullptr),
+            weights_(Vector::Zero(features_.cols() * A))
+    {
+        if ( A_ == 0 ) throw std::invalid_argument("Number of actions must be > 0");
+        features_.makeCompressed();
+        setDiscount(discount);
+        setTolerance(tolerance);
+        setRegularization(regularization);
+    }
+
+    std::tuple<double, Vector> LSPI::operator()(const TransitionBatch & batch) {
+        const auto N = batch.states.size();
+        if ( batch.actions.size() != N || batch.nextStates.size() != N || batch.rewards.size() != N )
+            throw std::invalid_argument("TransitionBatch fields have different sizes");
+
+        std::vector<Sample> samples;
+        samples.reserve(N);
+        for ( size_t i = 0; i < N; ++i )
+            samples.push_back({batch.states[i], batch.actions[i], batch.nextStates[i], 1.0, batch.rewards[i]});
+
+        return solve(samples, discount_);
+    }
+
+    std::tuple<double, Vector> LSPI::solve(const std::vector<Sample> & samples, const double discount) {
+        const size_t K = features_.cols();
+        const size_t N = K * A_;
+
+        // Bucketing the samples by action lets each thread own the rows of
+        // the system of its actions, so no synchronization is needed.
+        std::vector<std::vector<const Sample *>> byAction(A_);
+        for ( const auto & sample : samples ) {
+            if ( sample.s >= size_t(features_.rows()) || sample.s1 >= size_t(features_.rows()) || sample.a >= A_ )
+                throw std::invalid_argument("Sample out of the bounds of the features");
+            byAction[sample.a].push_back(&sample);
+        }
+
+        Matrix2D system(N, N);
+        Vector b(N);
+        std::vector<size_t> nextActions(samples.size());
+
+        const auto accumulate = [&](const size_t aBegin, const size_t aEnd) {
+            const auto rows = (aEnd - aBegin) * K;
+            system.middleRows(aBegin * K, rows).setZero();
+            b.segment(aBegin * K, rows).setZero();
+
+            for ( size_t a = aBegin; a < aEnd; ++a ) {
+                for ( const auto * sample : byAction[a] ) {
+                    const auto a1 = nextActions[sample - samples.data()];
+                    for ( SparseMatrix2D::InnerIterator i(features_, sample->s); i; ++i ) {
+                        const auto row = a * K + i.col();
+                        const auto wv = sample->weight * i.value();
+
+                        b[row] += i.value() * sample->reward;
+                        for ( SparseMatrix2D::InnerIterator j(features_, sample->s); j; ++j )
+                            system(row, a * K + j.col()) += wv * j.value();
+                        for ( SparseMatrix2D::InnerIterator j(features_, sample->s1); j; ++j )
+                            system(row, a1 * K + j.col()) -= discount * wv * j.value();
+                    }
+                }
+            }
+        };
+
+        double delta = 0.0;
+        for ( unsigned iteration = 0; iteration < maxIterations_; ++iteration ) {
+            for ( size_t i = 0; i < samples.size(); ++i )
+                nextActions[i] = getGreedyAction(samples[i].s1);
+
+            if ( pool_ ) pool_->parallelFor(A_, accumulate);
+            else         accumulate(0, A_);
+
+            system.diagonal().array() += regularization_;
+            Vector newWeights = system.partialPivLu().solve(b);
+
+            delta = (newWeights - weights_).lpNorm<Eigen::Infinity>();
+            weights_ = std::move(newWeights);
+            if ( delta <= tolerance_ ) break;
+        }
+        return std::make_tuple(delta, weights_);
+    }
+
+    double LSPI::getQValue(const size_t s, const size_t a) const {
+        const size_t K = features_.cols();
+        double retval = 0.0;
+        for ( SparseMatrix2D::InnerIterator it(features_, s); it; ++it )
+            retval += it.value() * weights_[a * K + it.col()];
+        return retval;
+    }
+
+    Vector LSPI::getQValues(const size_t s) const {
+        const size_t K = features_.cols();
+        Vector retval = Vector::Zero(A_);
+        for ( SparseMatrix2D::InnerIterator it(features_, s); it; ++it )
+            for ( size_t a = 0; a < A_; ++a )
+                retval[a] += it.value() * weights_[a * K + it.col()];
+        return retval;
+    }
+
+    size_t LSPI::getGreedyAction(const size_t s) const {
+        const auto q = getQValues(s);
+        size_t retval = 0;
+        for ( size_t a = 1; a < A_; ++a )
+            if ( q[a] > q[retval] ) retval = a;
+        return retval;
+    }
+
+    void LSPI::setWeights(const Vector & w) {
+        if ( size_t(w.size()) != size_t(features_.cols()) * A_ )
+            throw std::invalid_argument("Weights must have size k*A");
+        weights_ = w;
+    }
+
+    void LSPI::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    void LSPI::setMaxIterations(const unsigned maxIterations) {
+        maxIterations_ = maxIterations;
+    }
+
+    void LSPI::setTolerance(const double t) {
+        if ( t < 0.0 ) throw std::invalid_argument("Tolerance must be >= 0");
+        tolerance_ = t;
+    }
+
+    void LSPI::setRegularization(const double r) {
+        if ( r < 0.0 ) throw std::invalid_argument("Regularization must be >= 0");
+        regularization_ = r;
+    }
+
+    void LSPI::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    const SparseMatrix2D & LSPI::getFeatures() const { return features_; }
+    const Vector & LSPI::getWeights() const { return weights_; }
+    size_t LSPI::getA() const { return A_; }
+    double LSPI::getDiscount() const { return discount_; }
+    unsigned LSPI::getMaxIterations() const { return maxIterations_; }
+    double LSPI::getTolerance() const { return tolerance_; }
+    double LSPI::getRegularization() const { return regularization_; }
+    ThreadPool * LSPI::getThreadPool() const { return pool_; }
+}
@@ -0,0 +1,9 @@
+#include <AIToolbox/MDP/Algorithms/LinearProgramming.hpp>
+
+namespace AIToolbox::MDP {
+    LinearProgramming::LinearProgramming(const Formulation formulation) :
+            formulation_(formulation) {}
+
+    void LinearProgramming::setFormulation(const Formulation formulation) { formulation_ = formulation; }
+    LinearProgramming::Formulation LinearProgramming::getFormulation() const { return formulation_; }
+}
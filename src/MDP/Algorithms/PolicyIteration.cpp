@@ -1,8 +1,8 @@
 #include <AIToolbox/MDP/Algorithms/PolicyIteration.hpp>
 
 namespace AIToolbox::MDP {
-    PolicyIteration::PolicyIteration(const unsigned horizon, const double tolerance) :
-            horizon_(horizon)
+    PolicyIteration::PolicyIteration(const unsigned horizon, const double tolerance, const unsigned maxIterations) :
+            horizon_(horizon), maxIterations_(maxIterations), modified_(false), pool_(nullptr)
     {
         setTolerance(tolerance);
     }
@@ -16,7 +16,25 @@ namespace AIToolbox::MDP {
         horizon_ = h;
     }
 
+    void PolicyIteration::setMaxIterations(const unsigned maxIterations) {
+        maxIterations_ = maxIterations;
+    }
+
+    void PolicyIteration::setModified(const bool modified) {
+        modified_ = modified;
+    }
+
+    void PolicyIteration::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     double PolicyIteration::getTolerance()   const { return tolerance_; }
 
     unsigned PolicyIteration::getHorizon() const { return horizon_; }
+
+    unsigned PolicyIteration::getMaxIterations() const { return maxIterations_; }
+
+    bool PolicyIteration::isModified() const { return modified_; }
+
+    ThreadPool * PolicyIteration::getThreadPool() const { return pool_; }
 }
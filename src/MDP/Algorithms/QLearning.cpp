@@ -1,5 +1,7 @@
 #include <AIToolbox/MDP/Algorithms/QLearning.hpp>
 
+#include <algorithm>
+
 namespace AIToolbox::MDP {
     QLearning::QLearning(const size_t ss, const size_t aa, const double discount, const double alpha) :
             S(ss), A(aa), discount_(discount), q_(makeQFunction(S, A))
@@ -9,7 +11,77 @@ namespace AIToolbox::MDP {
     }
 
     void QLearning::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
-        q_(s, a) += alpha_ * ( rew + discount_ * q_.row(s1).maxCoeff() - q_(s, a) );
+        if ( !locks_.getStripes() ) {
+            q_(s, a) += alpha_ * ( rew + discount_ * q_.row(s1).maxCoeff() - q_(s, a) );
+            return;
+        }
+        // We never hold both locks, as s and s1 may share a stripe.
+        double target;
+        {
+            StripeGuard guard(locks_, s1);
+            target = rew + discount_ * q_.row(s1).maxCoeff();
+        }
+        StripeGuard guard(locks_, s);
+        q_(s, a) += alpha_ * ( target - q_(s, a) );
+    }
+
+    void QLearning::setConcurrentUpdates(const size_t stripes) {
+        locks_ = StripedSpinLock(stripes);
+    }
+
+    size_t QLearning::getConcurrentUpdates() const { return locks_.getStripes(); }
+
+    void QLearning::batchUpdateQ(const TransitionBatch & batch, std::vector<double> * tdErrors) {
+        const size_t N = checkTransitionBatch(batch);
+        if ( tdErrors ) tdErrors->resize(N);
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto s = batch.states[i], a = batch.actions[i];
+            const double delta = batch.rewards[i] + discount_ * q_.row(batch.nextStates[i]).maxCoeff() - q_(s, a);
+            q_(s, a) += alpha_ * delta;
+            if ( tdErrors ) (*tdErrors)[i] = delta;
+        }
+    }
+
+    void QLearning::batchUpdateQ(const TransitionBatch & batch, ThreadPool & pool, std::vector<double> * tdErrors) {
+        const size_t N = checkTransitionBatch(batch);
+        if ( tdErrors ) tdErrors->resize(N);
+        if ( N == 0 ) return;
+
+        // We only need the values of the states we bootstrap from.
+        std::vector<size_t> next(std::begin(batch.nextStates), std::end(batch.nextStates));
+        std::sort(std::begin(next), std::end(next));
+        next.erase(std::unique(std::begin(next), std::end(next)), std::end(next));
+
+        Values v(S);
+        for ( const auto s1 : next )
+            v[s1] = q_.row(s1).maxCoeff();
+
+        // Each block of states owns the transitions starting from its
+        // states; we sort them by block (keeping their order) so that
+        // each thread only visits its own.
+        const size_t B = std::min(S, pool.getThreadNumber());
+        const auto block = [&](const size_t s) { return s * B / S; };
+
+        std::vector<size_t> offsets(B + 1, 0), order(N);
+        for ( const auto s : batch.states )
+            ++offsets[block(s) + 1];
+        for ( size_t b = 0; b < B; ++b )
+            offsets[b + 1] += offsets[b];
+        {
+            auto pos = offsets;
+            for ( size_t i = 0; i < N; ++i )
+                order[pos[block(batch.states[i])]++] = i;
+        }
+
+        pool.parallelFor(B, 1, [&](const size_t begin, const size_t end) {
+            for ( size_t j = offsets[begin]; j < offsets[end]; ++j ) {
+                const auto i = order[j];
+                const auto s = batch.states[i], a = batch.actions[i];
+                const double delta = batch.rewards[i] + discount_ * v[batch.nextStates[i]] - q_(s, a);
+                q_(s, a) += alpha_ * delta;
+                if ( tdErrors ) (*tdErrors)[i] = delta;
+            }
+        });
     }
 
     void QLearning::setLearningRate(const double a) {
@@ -9,7 +9,32 @@ namespace AIToolbox::MDP {
     }
 
     void SARSA::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const size_t a1, const double rew) {
-        q_(s, a) += alpha_ * ( rew + discount_ * q_(s1, a1) - q_(s, a) );
+        if ( !locks_.getStripes() ) {
+            q_(s, a) += alpha_ * ( rew + discount_ * q_(s1, a1) - q_(s, a) );
+            return;
+        }
+        // We never hold both locks, as s and s1 may share a stripe.
+        double target;
+        {
+            StripeGuard guard(locks_, s1);
+            target = rew + discount_ * q_(s1, a1);
+        }
+        StripeGuard guard(locks_, s);
+        q_(s, a) += alpha_ * ( target - q_(s, a) );
+    }
+
+    void SARSA::setConcurrentUpdates(const size_t stripes) {
+        locks_ = StripedSpinLock(stripes);
+    }
+
+    size_t SARSA::getConcurrentUpdates() const { return locks_.getStripes(); }
+
+    void SARSA::batchUpdateQ(const TransitionBatch & batch) {
+        const size_t N = checkTransitionBatch(batch, true);
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto s = batch.states[i], a = batch.actions[i];
+            q_(s, a) += alpha_ * ( batch.rewards[i] + discount_ * q_(batch.nextStates[i], batch.nextActions[i]) - q_(s, a) );
+        }
     }
 
     void SARSA::setLearningRate(const double a) {
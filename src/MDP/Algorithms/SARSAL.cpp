@@ -1,6 +1,12 @@
 #include <AIToolbox/MDP/Algorithms/SARSAL.hpp>
 
+#include <limits>
+
 namespace AIToolbox::MDP {
+    namespace {
+        constexpr auto NoTrace = std::numeric_limits<size_t>::max();
+    }
+
     SARSAL::SARSAL(const size_t ss, const size_t aa, const double discount, const double alpha, const double lambda, const double tolerance) :
             S(ss), A(aa), q_(makeQFunction(S, A))
     {
@@ -12,6 +18,40 @@ namespace AIToolbox::MDP {
 
     void SARSAL::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const size_t a1, const double rew) {
         const auto error = alpha_ * ( rew + discount_ * q_(s1, a1) - q_(s, a) );
+        if ( !traceIndex_.empty() ) {
+            // This is the same as the scan below, but we find the current
+            // pair through the index, and we keep the index in sync as traces
+            // are moved or removed.
+            auto pos = traceIndex_[s * A + a];
+            for (size_t i = 0; i < traces_.size(); ++i) {
+                auto & [ss, aa, el] = traces_[i];
+                if (i == pos) {
+                    el = 1.0;
+                } else {
+                    el *= gammaL_;
+                    if (el < tolerance_) {
+                        const auto last = traces_.size() - 1;
+                        traceIndex_[ss * A + aa] = NoTrace;
+                        if (i != last) {
+                            traces_[i] = traces_[last];
+                            traceIndex_[std::get<0>(traces_[i]) * A + std::get<1>(traces_[i])] = i;
+                            if (pos == last) pos = i;
+                        }
+                        traces_.pop_back();
+                        --i;
+                        continue;
+                    }
+                }
+                q_(ss, aa) += error * el;
+            }
+            if (pos == NoTrace) {
+                traceIndex_[s * A + a] = traces_.size();
+                traces_.emplace_back(s, a, 1.0);
+                q_(s, a) += error; // el is 1.0 here
+            }
+            return;
+        }
+
         bool newTrace = true;
 
         // So basically here we have in traces_ a non-ordered list of the old
@@ -48,6 +88,9 @@ namespace AIToolbox::MDP {
     }
 
     void SARSAL::clearTraces() {
+        if ( !traceIndex_.empty() )
+            for (const auto & t : traces_)
+                traceIndex_[std::get<0>(t) * A + std::get<1>(t)] = NoTrace;
         traces_.clear();
     }
 
@@ -56,7 +99,29 @@ namespace AIToolbox::MDP {
     }
 
     void SARSAL::setTraces(const Traces & t) {
+        if ( traceIndex_.empty() ) {
+            traces_ = t;
+            return;
+        }
+        clearTraces();
         traces_ = t;
+        for (size_t i = 0; i < traces_.size(); ++i)
+            traceIndex_[std::get<0>(traces_[i]) * A + std::get<1>(traces_[i])] = i;
+    }
+
+    void SARSAL::setTraceIndexing(const bool index) {
+        if ( !index ) {
+            traceIndex_.clear();
+            traceIndex_.shrink_to_fit();
+            return;
+        }
+        traceIndex_.assign(S * A, NoTrace);
+        for (size_t i = 0; i < traces_.size(); ++i)
+            traceIndex_[std::get<0>(traces_[i]) * A + std::get<1>(traces_[i])] = i;
+    }
+
+    bool SARSAL::getTraceIndexing() const {
+        return !traceIndex_.empty();
     }
 
     void SARSAL::setLearningRate(const double a) {
@@ -98,4 +163,5 @@ namespace AIToolbox::MDP {
 
     const QFunction & SARSAL::getQFunction() const { return q_; }
     void SARSAL::setQFunction(const QFunction & qfun) { q_ = qfun; }
+    void SARSAL::setQValue(const size_t s, const size_t a, const double v) { q_(s, a) = v; }
 }
@@ -0,0 +1,50 @@
+#include <AIToolbox/MDP/Algorithms/SparseQLearning.hpp>
+
+#include <AIToolbox/MDP/Utils.hpp>
+
+namespace AIToolbox::MDP {
+    SparseQLearning::SparseQLearning(const size_t ss, const size_t aa, const double discount, const double alpha, const double initialValue) :
+            S(ss), A(aa), q_(S, A, initialValue)
+    {
+        setDiscount(discount);
+        setLearningRate(alpha);
+    }
+
+    void SparseQLearning::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const double rew) {
+        // We read the next state first, as storing s may move all rows.
+        const double target = rew + discount_ * q_.getRow(s1).maxCoeff();
+        auto & q = q_.getValueRef(s, a);
+        q += alpha_ * ( target - q );
+    }
+
+    void SparseQLearning::batchUpdateQ(const TransitionBatch & batch, std::vector<double> * tdErrors) {
+        const size_t N = checkTransitionBatch(batch);
+        if ( tdErrors ) tdErrors->resize(N);
+        for ( size_t i = 0; i < N; ++i ) {
+            const double target = batch.rewards[i] + discount_ * q_.getRow(batch.nextStates[i]).maxCoeff();
+            auto & q = q_.getValueRef(batch.states[i], batch.actions[i]);
+            const double delta = target - q;
+            q += alpha_ * delta;
+            if ( tdErrors ) (*tdErrors)[i] = delta;
+        }
+    }
+
+    void SparseQLearning::setLearningRate(const double a) {
+        if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Learning rate parameter must be in (0,1]");
+        alpha_ = a;
+    }
+
+    double SparseQLearning::getLearningRate() const { return alpha_; }
+
+    void SparseQLearning::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    double SparseQLearning::getDiscount() const { return discount_; }
+
+    size_t SparseQLearning::getS() const { return S; }
+    size_t SparseQLearning::getA() const { return A; }
+
+    const SparseQFunction & SparseQLearning::getQFunction() const { return q_; }
+}
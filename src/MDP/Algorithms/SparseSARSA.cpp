@@ -0,0 +1,44 @@
+#include <AIToolbox/MDP/Algorithms/SparseSARSA.hpp>
+
+#include <AIToolbox/MDP/Utils.hpp>
+
+namespace AIToolbox::MDP {
+    SparseSARSA::SparseSARSA(const size_t ss, const size_t aa, const double discount, const double alpha, const double initialValue) :
+            S(ss), A(aa), q_(S, A, initialValue)
+    {
+        setDiscount(discount);
+        setLearningRate(alpha);
+    }
+
+    void SparseSARSA::stepUpdateQ(const size_t s, const size_t a, const size_t s1, const size_t a1, const double rew) {
+        // We read the next state first, as storing s may move all rows.
+        const double target = rew + discount_ * q_.getValue(s1, a1);
+        auto & q = q_.getValueRef(s, a);
+        q += alpha_ * ( target - q );
+    }
+
+    void SparseSARSA::batchUpdateQ(const TransitionBatch & batch) {
+        const size_t N = checkTransitionBatch(batch, true);
+        for ( size_t i = 0; i < N; ++i )
+            stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+    }
+
+    void SparseSARSA::setLearningRate(const double a) {
+        if ( a <= 0.0 || a > 1.0 ) throw std::invalid_argument("Learning rate parameter must be in (0,1]");
+        alpha_ = a;
+    }
+
+    double SparseSARSA::getLearningRate() const { return alpha_; }
+
+    void SparseSARSA::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    double SparseSARSA::getDiscount() const { return discount_; }
+
+    size_t SparseSARSA::getS() const { return S; }
+    size_t SparseSARSA::getA() const { return A; }
+
+    const SparseQFunction & SparseSARSA::getQFunction() const { return q_; }
+}
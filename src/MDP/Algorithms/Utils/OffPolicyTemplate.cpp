@@ -2,7 +2,13 @@
 
 #include <AIToolbox/MDP/Utils.hpp>
 
+#include <limits>
+
 namespace AIToolbox::MDP {
+    namespace {
+        constexpr auto NoTrace = std::numeric_limits<size_t>::max();
+    }
+
     OffPolicyBase::OffPolicyBase(const size_t s, const size_t a, const double discount, const double alpha, const double tolerance) :
             S(s), A(a), q_(makeQFunction(S, A))
     {
@@ -12,50 +18,105 @@ namespace AIToolbox::MDP {
     }
 
     void OffPolicyBase::updateTraces(const size_t s, const size_t a, const double error, const double traceDiscount) {
-        // So basically here we have in traces_ a non-ordered list of the old
-        // state/action pairs we have already seen. For each item in this list,
-        // we scale its "relevantness" back by gammaL_, and we update its
-        // q-value accordingly.
+        // Traces are kept as two parallel arrays: the flat QFunction ids of
+        // the state/action pairs we have already seen, and their eligibility.
+        // We scale the "relevantness" of each by the trace discount, and we
+        // update its q-value accordingly.
         //
         // If the current s-a are in the list already, their eligibility is
         // directly updated to 1.0. Otherwise, they are added to the list.
         //
         // If any element would become too far away temporally to still be
-        // relevant, we extract it from the list. As the order is not important
-        // (it is implicit in the "el" element), we can use swap+pop.
-        bool newTrace = true;
-        for (size_t i = 0; i < traces_.size(); ++i) {
-            auto & [ss, aa, el] = traces_[i];
-            if (ss == s && aa == a) {
-                el = 1.0;
-                newTrace = false;
-            } else {
-                el *= traceDiscount;
-                if (el < tolerance_) {
-                    std::swap(traces_[i], traces_[traces_.size() - 1]);
-                    traces_.pop_back();
-                    --i;
-                    continue;
+        // relevant, we extract it from the list. The work is split in
+        // separate passes without dependencies between elements, so that
+        // the decay can be vectorized by the compiler.
+        const size_t id = s * A + a;
+        const size_t N = traceIds_.size();
+
+        size_t pos = N;
+        if ( !traceIndex_.empty() ) {
+            if ( traceIndex_[id] != NoTrace ) pos = traceIndex_[id];
+        } else {
+            for (size_t i = 0; i < N; ++i) {
+                if (traceIds_[i] == id) {
+                    pos = i;
+                    break;
                 }
             }
-            q_(ss, aa) += error * el;
         }
-        if (newTrace) {
-            traces_.emplace_back(s, a, 1.0);
-            q_(s, a) += error; // el is 1.0 here
+
+        double * el = traceValues_.data();
+        for (size_t i = 0; i < N; ++i)
+            el[i] *= traceDiscount;
+
+        if (pos == N) {
+            traceIds_.push_back(id);
+            traceValues_.push_back(1.0);
+            if ( !traceIndex_.empty() ) traceIndex_[id] = pos;
+        } else {
+            traceValues_[pos] = 1.0;
+        }
+
+        // The QFunction is row-major, so the ids index its data directly.
+        // We compact the arrays in the same pass, keeping their order.
+        double * q = q_.data();
+        size_t j = 0;
+        for (size_t i = 0; i < traceIds_.size(); ++i) {
+            if (i != pos && traceValues_[i] < tolerance_) {
+                if ( !traceIndex_.empty() ) traceIndex_[traceIds_[i]] = NoTrace;
+                continue;
+            }
+            q[traceIds_[i]] += error * traceValues_[i];
+            if (i != j) {
+                traceIds_[j] = traceIds_[i];
+                traceValues_[j] = traceValues_[i];
+                if ( !traceIndex_.empty() ) traceIndex_[traceIds_[j]] = j;
+            }
+            ++j;
         }
+        traceIds_.resize(j);
+        traceValues_.resize(j);
     }
 
     void OffPolicyBase::clearTraces() {
-        traces_.clear();
+        if ( !traceIndex_.empty() )
+            for (const auto id : traceIds_)
+                traceIndex_[id] = NoTrace;
+        traceIds_.clear();
+        traceValues_.clear();
     }
 
-    const OffPolicyBase::Traces & OffPolicyBase::getTraces() const {
-        return traces_;
+    OffPolicyBase::Traces OffPolicyBase::getTraces() const {
+        Traces retval;
+        retval.reserve(traceIds_.size());
+        for (size_t i = 0; i < traceIds_.size(); ++i)
+            retval.emplace_back(traceIds_[i] / A, traceIds_[i] % A, traceValues_[i]);
+        return retval;
     }
 
     void OffPolicyBase::setTraces(const Traces & t) {
-        traces_ = t;
+        traceIds_.clear();
+        traceValues_.clear();
+        for (const auto & [s, a, el] : t) {
+            traceIds_.push_back(s * A + a);
+            traceValues_.push_back(el);
+        }
+        if ( !traceIndex_.empty() ) setTraceIndexing(true);
+    }
+
+    void OffPolicyBase::setTraceIndexing(const bool index) {
+        if ( !index ) {
+            traceIndex_.clear();
+            traceIndex_.shrink_to_fit();
+            return;
+        }
+        traceIndex_.assign(S * A, NoTrace);
+        for (size_t i = 0; i < traceIds_.size(); ++i)
+            traceIndex_[traceIds_[i]] = i;
+    }
+
+    bool OffPolicyBase::getTraceIndexing() const {
+        return !traceIndex_.empty();
     }
 
     void OffPolicyBase::setLearningRate(const double a) {
@@ -2,7 +2,9 @@
 
 namespace AIToolbox::MDP {
     ValueIteration::ValueIteration(unsigned horizon, double tolerance, ValueFunction v) :
-            horizon_(horizon), vParameter_(v)
+            horizon_(horizon), vParameter_(v), pool_(nullptr),
+            sweep_(Sweep::Jacobi), checkpointInterval_(1),
+            actionElimination_(false), eliminated_(0)
     {
         setTolerance(tolerance);
     }
@@ -20,9 +22,45 @@ namespace AIToolbox::MDP {
         vParameter_ = std::move(v);
     }
 
+    void ValueIteration::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    void ValueIteration::setSweep(const Sweep sweep) {
+        sweep_ = sweep;
+    }
+
+    void ValueIteration::setCheckpointCallback(CheckpointCallback callback, const unsigned interval) {
+        if ( interval == 0 ) throw std::invalid_argument("Checkpoint interval must be > 0");
+        checkpoint_ = std::move(callback);
+        checkpointInterval_ = interval;
+    }
+
+    void ValueIteration::setActionElimination(const bool eliminate) {
+        actionElimination_ = eliminate;
+    }
+
+    void ValueIteration::checkpoint(const unsigned timestep, const double variation, const Values & residuals) const {
+        if ( !checkpoint_ || timestep % checkpointInterval_ ) return;
+        checkpoint_(ValueIterationCheckpoint{timestep, variation, v1_, residuals});
+    }
+
     double ValueIteration::getTolerance()   const { return tolerance_; }
 
     unsigned ValueIteration::getHorizon() const { return horizon_; }
 
     const ValueFunction & ValueIteration::getValueFunction() const { return vParameter_; }
+
+    ThreadPool * ValueIteration::getThreadPool() const { return pool_; }
+
+    ValueIteration::Sweep ValueIteration::getSweep() const { return sweep_; }
+
+    unsigned ValueIteration::getCheckpointInterval() const { return checkpointInterval_; }
+
+    bool ValueIteration::getActionElimination() const { return actionElimination_; }
+
+    size_t ValueIteration::getEliminatedPairs() const { return eliminated_; }
+
+    template std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const Model &);
+    template std::tuple<double, ValueFunction, QFunction> ValueIteration::operator()(const SparseModel &);
 }
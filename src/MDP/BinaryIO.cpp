@@ -0,0 +1,995 @@
+#include <AIToolbox/MDP/BinaryIO.hpp>
+
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace AIToolbox::MDP {
+    namespace {
+        constexpr char Magic[8] = {'A', 'I', 'T', 'B', 'X', 'B', 'I', 'N'};
+        constexpr std::uint32_t ByteOrderMark = 0x01020304;
+        // All arrays start at this alignment, both in the file and in memory.
+        constexpr size_t Alignment = 64;
+
+        using StorageIndex = SparseMatrix2D::StorageIndex;
+        static_assert(std::is_same_v<StorageIndex, SparseTable2D::StorageIndex>);
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t type;
+            std::uint32_t byteOrder;
+            std::uint16_t scalarSize;
+            std::uint16_t countSize;
+            std::uint32_t indexSize;
+            std::uint32_t reserved0;
+            std::uint64_t S;
+            std::uint64_t A;
+            double discount;
+            std::uint64_t reserved1;
+        };
+        static_assert(sizeof(Header) == Alignment);
+
+        // Each sparse matrix starts with one of these, followed by its
+        // outer indices, inner indices and values.
+        struct SparseHeader {
+            std::uint64_t rows;
+            std::uint64_t cols;
+            std::uint64_t nonZeros;
+            std::uint64_t reserved[5];
+        };
+        static_assert(sizeof(SparseHeader) == Alignment);
+
+        // Solver checkpoints store their progress after the main header.
+        struct ProgressHeader {
+            std::uint64_t timestep;
+            double variation;
+            // The number of optional entries stored, if any.
+            std::uint64_t extra;
+            std::uint64_t reserved[5];
+        };
+        static_assert(sizeof(ProgressHeader) == Alignment);
+
+        // Columnar tables store this after the main header, followed by
+        // each column as a separate array.
+        struct TableHeader {
+            std::uint64_t rows;
+            std::uint64_t columns;
+            std::uint64_t reserved[6];
+        };
+        static_assert(sizeof(TableHeader) == Alignment);
+
+        // Index columns are written directly from our size_t vectors.
+        static_assert(sizeof(size_t) == sizeof(std::uint64_t));
+
+        // The columns of an experience table: s, a, s1, visits, rewards.
+        constexpr size_t ExperienceColumns = 5;
+
+        size_t padding(const size_t bytes) {
+            return (Alignment - bytes % Alignment) % Alignment;
+        }
+
+        Header makeHeader(const BinaryType type, const size_t S, const size_t A, const double discount) {
+            Header h;
+            std::memset(&h, 0, sizeof(Header));
+            std::memcpy(h.magic, Magic, sizeof(Magic));
+            h.version = BinaryFormatVersion;
+            h.type = static_cast<std::uint32_t>(type);
+            h.byteOrder = ByteOrderMark;
+            h.scalarSize = sizeof(double);
+            h.countSize = sizeof(long);
+            h.indexSize = sizeof(StorageIndex);
+            h.S = S;
+            h.A = A;
+            h.discount = discount;
+            return h;
+        }
+
+        // Returns an empty string if the header is valid, and the reason
+        // otherwise.
+        const char * checkHeader(const Header & h, const BinaryType type) {
+            if ( std::memcmp(h.magic, Magic, sizeof(Magic)) )  return "not an AIToolbox binary file";
+            if ( h.version != BinaryFormatVersion )             return "unsupported binary format version";
+            if ( h.byteOrder != ByteOrderMark )                 return "file was written with a different byte order";
+            if ( h.scalarSize != sizeof(double) ||
+                 h.countSize != sizeof(long) ||
+                 h.indexSize != sizeof(StorageIndex) )          return "file was written with different type sizes";
+            if ( h.type != static_cast<std::uint32_t>(type) )   return "file contains a different type of object";
+            return "";
+        }
+
+        // Writing helpers
+
+        void writeBytes(std::ostream & os, const void * data, const size_t bytes) {
+            static constexpr char zeros[Alignment] = {};
+            os.write(static_cast<const char *>(data), bytes);
+            os.write(zeros, padding(bytes));
+        }
+
+        template <typename T>
+        void writeArray(std::ostream & os, const T * data, const size_t n) {
+            writeBytes(os, data, n * sizeof(T));
+        }
+
+        template <typename T>
+        void writeSparse(std::ostream & os, const T & matrix) {
+            // We can only write the raw arrays of compressed matrices.
+            if ( !matrix.isCompressed() ) {
+                T copy = matrix;
+                copy.makeCompressed();
+                return writeSparse(os, copy);
+            }
+            SparseHeader h;
+            std::memset(&h, 0, sizeof(SparseHeader));
+            h.rows = matrix.rows();
+            h.cols = matrix.cols();
+            h.nonZeros = matrix.nonZeros();
+
+            writeBytes(os, &h, sizeof(SparseHeader));
+            writeArray(os, matrix.outerIndexPtr(), matrix.rows() + 1);
+            writeArray(os, matrix.innerIndexPtr(), matrix.nonZeros());
+            writeArray(os, matrix.valuePtr(), matrix.nonZeros());
+        }
+
+        // Checks that the arrays of a compressed sparse matrix are
+        // consistent, so that Eigen never indexes outside of them: the
+        // outer indices must go from 0 to nonZeros without decreasing, and
+        // the inner indices of each row must be sorted and within cols.
+        bool checkSparseIndices(const StorageIndex * outer, const StorageIndex * inner, const size_t rows, const size_t cols, const size_t nonZeros) {
+            if ( outer[0] != 0 || static_cast<size_t>(outer[rows]) != nonZeros ) return false;
+            for ( size_t r = 0; r < rows; ++r )
+                if ( outer[r + 1] < outer[r] ) return false;
+
+            for ( size_t r = 0; r < rows; ++r ) {
+                for ( auto i = outer[r]; i < outer[r + 1]; ++i ) {
+                    if ( inner[i] < 0 || static_cast<size_t>(inner[i]) >= cols ) return false;
+                    if ( i > outer[r] && inner[i] <= inner[i - 1] ) return false;
+                }
+            }
+            return true;
+        }
+
+        // Checks that a sparse matrix of the input size can hold the input
+        // number of non zeros, without computing rows * cols.
+        bool checkNonZeros(const size_t nonZeros, const size_t rows, const size_t cols) {
+            return nonZeros == 0 || (cols != 0 && (nonZeros - 1) / cols < rows);
+        }
+
+        // Checks what the checked constructors of the models would check,
+        // so that the read matrices can still be moved in the models.
+        bool checkTransitions(const std::vector<Matrix2D> & t) {
+            for ( const auto & m : t )
+                for ( Matrix2D::Index s = 0; s < m.rows(); ++s )
+                    if ( !isProbability(m.cols(), m.row(s)) ) return false;
+            return true;
+        }
+
+        bool checkTransitions(const std::vector<SparseMatrix2D> & t) {
+            for ( const auto & m : t ) {
+                for ( SparseMatrix2D::Index s = 0; s < m.rows(); ++s ) {
+                    double p = 0.0;
+                    for ( SparseMatrix2D::InnerIterator it(m, s); it; ++it ) {
+                        if ( it.value() < 0.0 ) return false;
+                        p += it.value();
+                    }
+                    if ( checkDifferentSmall(p, 1.0) ) return false;
+                }
+            }
+            return true;
+        }
+
+        bool checkDiscount(const double d) {
+            return d > 0.0 && d <= 1.0;
+        }
+
+        // Stream reading helpers
+
+        bool readBytes(std::istream & is, void * data, const size_t bytes) {
+            if ( !is.read(static_cast<char *>(data), bytes) ) return false;
+            return static_cast<bool>(is.ignore(padding(bytes)));
+        }
+
+        template <typename T>
+        bool readArray(std::istream & is, T * data, const size_t n) {
+            return readBytes(is, data, n * sizeof(T));
+        }
+
+        // Returns the number of bytes left in the stream. If the stream
+        // cannot seek we return the maximum size_t; the reads will then
+        // fail on their own when they reach its end.
+        size_t remainingBytes(std::istream & is) {
+            constexpr auto unknown = std::numeric_limits<size_t>::max();
+
+            const auto current = is.tellg();
+            if ( current < 0 ) return unknown;
+            is.seekg(0, std::ios::end);
+            const auto end = is.tellg();
+            if ( is.fail() || end < current ) {
+                is.clear();
+                is.seekg(current);
+                return unknown;
+            }
+            is.seekg(current);
+            return static_cast<size_t>(end - current);
+        }
+
+        bool readHeader(std::istream & is, const BinaryType type, Header & h) {
+            if ( !readBytes(is, &h, sizeof(Header)) ) {
+                AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Could not read binary header.");
+                return false;
+            }
+            const auto error = checkHeader(h, type);
+            if ( *error ) {
+                AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Invalid binary file: " << error);
+                return false;
+            }
+            return true;
+        }
+
+        template <typename T>
+        bool readSparse(std::istream & is, const size_t rows, const size_t cols, T & matrix) {
+            SparseHeader h;
+            if ( !readBytes(is, &h, sizeof(SparseHeader)) ) return false;
+            if ( h.rows != rows || h.cols != cols ) return false;
+
+            // The number of non zeros comes from the file, so we bound it
+            // before allocating anything for it.
+            constexpr size_t entryBytes = sizeof(StorageIndex) + sizeof(typename T::Scalar);
+            if ( !checkNonZeros(h.nonZeros, rows, cols) ||
+                 h.nonZeros > remainingBytes(is) / entryBytes )
+                return false;
+
+            // We read directly into the storage of the matrix, to avoid
+            // going through temporaries.
+            matrix.resize(rows, cols);
+            matrix.resizeNonZeros(h.nonZeros);
+            return readArray(is, matrix.outerIndexPtr(), rows + 1) &&
+                   readArray(is, matrix.innerIndexPtr(), h.nonZeros) &&
+                   readArray(is, matrix.valuePtr(), h.nonZeros) &&
+                   checkSparseIndices(matrix.outerIndexPtr(), matrix.innerIndexPtr(), rows, cols, h.nonZeros);
+        }
+
+        bool readTableHeader(std::istream & is, TableHeader & t) {
+            return readBytes(is, &t, sizeof(TableHeader));
+        }
+
+        // The columns of an experience table, as read from a stream.
+        struct ExperienceTable {
+            std::vector<size_t> states, actions, nextStates;
+            std::vector<long> visits;
+            std::vector<double> rewards;
+        };
+
+        // Reads an experience table, and checks that all its rows are
+        // within the input S and A.
+        bool readExperienceColumns(std::istream & is, const size_t S, const size_t A, ExperienceTable & table) {
+            Header h;
+            if ( !readHeader(is, BinaryType::ExperienceTable, h) ) return false;
+            if ( h.S != S || h.A != A ) return false;
+
+            TableHeader t;
+            if ( !readTableHeader(is, t) || t.columns != ExperienceColumns ) return false;
+
+            const size_t rows = t.rows;
+            // All columns have 8-byte entries; rows comes from the file, so
+            // we bound it before allocating.
+            if ( rows > remainingBytes(is) / (ExperienceColumns * sizeof(std::uint64_t)) ) return false;
+            table.states.resize(rows);
+            table.actions.resize(rows);
+            table.nextStates.resize(rows);
+            table.visits.resize(rows);
+            table.rewards.resize(rows);
+            if ( !readArray(is, table.states.data(), rows) ||
+                 !readArray(is, table.actions.data(), rows) ||
+                 !readArray(is, table.nextStates.data(), rows) ||
+                 !readArray(is, table.visits.data(), rows) ||
+                 !readArray(is, table.rewards.data(), rows) )
+                return false;
+
+            for ( size_t i = 0; i < rows; ++i )
+                if ( table.states[i] >= S || table.actions[i] >= A ||
+                     table.nextStates[i] >= S || table.visits[i] < 0 )
+                    return false;
+            return true;
+        }
+
+        std::ostream & writeExperienceColumns(std::ostream & os, const size_t S, const size_t A, const ExperienceTable & table) {
+            const auto h = makeHeader(BinaryType::ExperienceTable, S, A, 0.0);
+            writeBytes(os, &h, sizeof(Header));
+
+            const size_t rows = table.states.size();
+            TableHeader t;
+            std::memset(&t, 0, sizeof(TableHeader));
+            t.rows = rows;
+            t.columns = ExperienceColumns;
+            writeBytes(os, &t, sizeof(TableHeader));
+
+            writeArray(os, table.states.data(), rows);
+            writeArray(os, table.actions.data(), rows);
+            writeArray(os, table.nextStates.data(), rows);
+            writeArray(os, table.visits.data(), rows);
+            writeArray(os, table.rewards.data(), rows);
+            return os;
+        }
+
+        std::istream & fail(std::istream & is) {
+            AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Could not read binary data.");
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+
+        // Mapped reading helpers
+
+        class MappedReader {
+            public:
+                MappedReader(const MappedFile & file, const BinaryType type) :
+                        file_(file), offset_(0)
+                {
+                    const auto & h = *get<Header>(1);
+                    const auto error = checkHeader(h, type);
+                    if ( *error )
+                        throw std::runtime_error(std::string("Invalid binary file: ") + error);
+                    header_ = h;
+                }
+
+                template <typename T>
+                const T * get(const size_t n) {
+                    // n may come from the file, so we avoid computing
+                    // n * sizeof(T) before knowing it cannot overflow. The
+                    // padding of the last array may push offset_ past the
+                    // end of the file.
+                    if ( offset_ > file_.size() || n > (file_.size() - offset_) / sizeof(T) )
+                        throw std::runtime_error("Binary file is truncated.");
+
+                    const size_t bytes = n * sizeof(T);
+                    const T * retval = reinterpret_cast<const T *>(file_.data() + offset_);
+                    offset_ += bytes + padding(bytes);
+                    return retval;
+                }
+
+                template <typename T>
+                Eigen::Map<const T> getSparse(const size_t rows, const size_t cols) {
+                    const auto & h = *get<SparseHeader>(1);
+                    if ( h.rows != rows || h.cols != cols )
+                        throw std::runtime_error("Binary file contains a sparse matrix of the wrong size.");
+                    if ( !checkNonZeros(h.nonZeros, rows, cols) )
+                        throw std::runtime_error("Binary file contains an invalid sparse matrix.");
+
+                    const auto outer = get<StorageIndex>(rows + 1);
+                    const auto inner = get<StorageIndex>(h.nonZeros);
+                    const auto values = get<typename T::Scalar>(h.nonZeros);
+
+                    if ( !checkSparseIndices(outer, inner, rows, cols, h.nonZeros) )
+                        throw std::runtime_error("Binary file contains an invalid sparse matrix.");
+
+                    return Eigen::Map<const T>(rows, cols, h.nonZeros, outer, inner, values);
+                }
+
+                const Header & header() const { return header_; }
+
+            private:
+                const MappedFile & file_;
+                size_t offset_;
+                Header header_;
+        };
+    }
+
+    // Writers
+
+    std::ostream & writeBinary(std::ostream & os, const Model & model) {
+        const size_t S = model.getS(), A = model.getA();
+
+        const auto h = makeHeader(BinaryType::Model, S, A, model.getDiscount());
+        writeBytes(os, &h, sizeof(Header));
+
+        for ( size_t a = 0; a < A; ++a )
+            writeArray(os, model.getTransitionFunction(a).data(), S * S);
+        writeArray(os, model.getRewardFunction().data(), S * A);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const SparseModel & model) {
+        const size_t A = model.getA();
+
+        const auto h = makeHeader(BinaryType::SparseModel, model.getS(), A, model.getDiscount());
+        writeBytes(os, &h, sizeof(Header));
+
+        for ( size_t a = 0; a < A; ++a )
+            writeSparse(os, model.getTransitionFunction(a));
+        writeSparse(os, model.getRewardFunction());
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const Experience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+
+        const auto h = makeHeader(BinaryType::Experience, S, A, 0.0);
+        writeBytes(os, &h, sizeof(Header));
+
+        std::vector<long> visitsSum(S * A);
+        std::vector<double> rewardsSum(S * A);
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                visitsSum[s * A + a] = exp.getVisitsSum(s, a);
+                rewardsSum[s * A + a] = exp.getRewardSum(s, a);
+            }
+        }
+
+        writeArray(os, exp.getVisitTable().data(), S * A * S);
+        writeArray(os, visitsSum.data(), S * A);
+        writeArray(os, exp.getRewardMatrix().data(), S * A * S);
+        writeArray(os, rewardsSum.data(), S * A);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const SparseExperience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+
+        const auto h = makeHeader(BinaryType::SparseExperience, S, A, 0.0);
+        writeBytes(os, &h, sizeof(Header));
+
+        SparseTable2D visitsSum(S, A);
+        SparseMatrix2D rewardsSum(S, A);
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                if ( const auto v = exp.getVisitsSum(s, a); v ) visitsSum.insert(s, a) = v;
+                if ( const auto r = exp.getRewardSum(s, a); checkDifferentSmall(0.0, r) ) rewardsSum.insert(s, a) = r;
+            }
+        }
+
+        for ( size_t a = 0; a < A; ++a )
+            writeSparse(os, exp.getVisitTable()[a]);
+        writeSparse(os, visitsSum);
+        for ( size_t a = 0; a < A; ++a )
+            writeSparse(os, exp.getRewardMatrix()[a]);
+        writeSparse(os, rewardsSum);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const ValueIterationCheckpoint & c) {
+        const size_t S = c.v.values.size();
+
+        const auto h = makeHeader(BinaryType::ValueIterationCheckpoint, S, 0, 0.0);
+        writeBytes(os, &h, sizeof(Header));
+
+        ProgressHeader p;
+        std::memset(&p, 0, sizeof(ProgressHeader));
+        p.timestep = c.timestep;
+        p.variation = c.variation;
+        // The residuals are only stored if present.
+        p.extra = c.residuals.size();
+        writeBytes(os, &p, sizeof(ProgressHeader));
+
+        const std::vector<std::uint64_t> actions(std::begin(c.v.actions), std::end(c.v.actions));
+        writeArray(os, c.v.values.data(), S);
+        writeArray(os, actions.data(), S);
+        if ( c.residuals.size() ) writeArray(os, c.residuals.data(), S);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const TransitionBatch & batch) {
+        const size_t rows = batch.states.size();
+        if ( batch.actions.size() != rows || batch.nextStates.size() != rows || batch.rewards.size() != rows )
+            throw std::invalid_argument("The arrays of the TransitionBatch have different sizes");
+        if ( batch.nextActions.size() && batch.nextActions.size() != rows )
+            throw std::invalid_argument("The nextActions of the TransitionBatch have a different size");
+
+        const auto h = makeHeader(BinaryType::TransitionTable, 0, 0, 0.0);
+        writeBytes(os, &h, sizeof(Header));
+
+        TableHeader t;
+        std::memset(&t, 0, sizeof(TableHeader));
+        t.rows = rows;
+        t.columns = batch.nextActions.size() ? 5 : 4;
+        writeBytes(os, &t, sizeof(TableHeader));
+
+        writeArray(os, batch.states.data(), rows);
+        writeArray(os, batch.actions.data(), rows);
+        writeArray(os, batch.nextStates.data(), rows);
+        writeArray(os, batch.rewards.data(), rows);
+        if ( batch.nextActions.size() ) writeArray(os, batch.nextActions.data(), rows);
+
+        return os;
+    }
+
+    std::ostream & writeExperienceTable(std::ostream & os, const Experience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+
+        ExperienceTable table;
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                if ( !exp.getVisitsSum(s, a) ) continue;
+                for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                    const auto v = exp.getVisits(s, a, s1);
+                    if ( !v ) continue;
+                    table.states.push_back(s);
+                    table.actions.push_back(a);
+                    table.nextStates.push_back(s1);
+                    table.visits.push_back(v);
+                    table.rewards.push_back(exp.getReward(s, a, s1));
+                }
+            }
+        }
+        return writeExperienceColumns(os, S, A, table);
+    }
+
+    std::ostream & writeExperienceTable(std::ostream & os, const SparseExperience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+        const auto & visits = exp.getVisitTable();
+
+        ExperienceTable table;
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                for ( SparseTable2D::InnerIterator it(visits[a], s); it; ++it ) {
+                    if ( !it.value() ) continue;
+                    table.states.push_back(s);
+                    table.actions.push_back(a);
+                    table.nextStates.push_back(it.col());
+                    table.visits.push_back(it.value());
+                    table.rewards.push_back(exp.getReward(s, a, it.col()));
+                }
+            }
+        }
+        return writeExperienceColumns(os, S, A, table);
+    }
+
+    // Readers
+
+    std::istream & readBinary(std::istream & is, Model & model) {
+        Header h;
+        if ( !readHeader(is, BinaryType::Model, h) ) return fail(is);
+        const size_t S = h.S, A = h.A;
+
+        Model::TransitionMatrix t(A, Matrix2D(S, S));
+        Model::RewardMatrix r(S, A);
+
+        for ( size_t a = 0; a < A; ++a )
+            if ( !readArray(is, t[a].data(), S * S) ) return fail(is);
+        if ( !readArray(is, r.data(), S * A) ) return fail(is);
+        if ( !checkTransitions(t) || !checkDiscount(h.discount) ) return fail(is);
+
+        // This guarantees that if input is invalid we still keep the old Model.
+        Model in(NO_CHECK, S, A, std::move(t), std::move(r), h.discount);
+        in.setAliasSampling(model.getAliasSampling());
+        model = std::move(in);
+
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, SparseModel & model) {
+        Header h;
+        if ( !readHeader(is, BinaryType::SparseModel, h) ) return fail(is);
+        const size_t S = h.S, A = h.A;
+
+        SparseModel::TransitionMatrix t(A, SparseMatrix2D(S, S));
+        SparseModel::RewardMatrix r(S, A);
+
+        for ( size_t a = 0; a < A; ++a )
+            if ( !readSparse(is, S, S, t[a]) ) return fail(is);
+        if ( !readSparse(is, S, A, r) ) return fail(is);
+        if ( !checkTransitions(t) || !checkDiscount(h.discount) ) return fail(is);
+
+        model = SparseModel(NO_CHECK, S, A, std::move(t), std::move(r), h.discount);
+
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, Experience & exp) {
+        Header h;
+        if ( !readHeader(is, BinaryType::Experience, h) ) return fail(is);
+        const size_t S = h.S, A = h.A;
+
+        Experience e(S, A);
+
+        if ( !readArray(is, e.visits_.data(), S * A * S) ||
+             !readArray(is, e.visitsSum_.data(), S * A) ||
+             !readArray(is, e.rewards_.data(), S * A * S) ||
+             !readArray(is, e.rewardsSum_.data(), S * A) )
+            return fail(is);
+
+        // This guarantees that if input is invalid we still keep the old Exp.
+        // Note that boost::multi_array can only be assigned to arrays of the
+        // same shape, so we resize first.
+        exp.visits_.resize(boost::extents[S][A][S]);
+        exp.visitsSum_.resize(boost::extents[S][A]);
+        exp.rewards_.resize(boost::extents[S][A][S]);
+        exp.rewardsSum_.resize(boost::extents[S][A]);
+        exp = std::move(e);
+
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, SparseExperience & exp) {
+        Header h;
+        if ( !readHeader(is, BinaryType::SparseExperience, h) ) return fail(is);
+        const size_t S = h.S, A = h.A;
+
+        SparseExperience e(S, A);
+
+        for ( size_t a = 0; a < A; ++a )
+            if ( !readSparse(is, S, S, e.visits_[a]) ) return fail(is);
+        if ( !readSparse(is, S, A, e.visitsSum_) ) return fail(is);
+        for ( size_t a = 0; a < A; ++a )
+            if ( !readSparse(is, S, S, e.rewards_[a]) ) return fail(is);
+        if ( !readSparse(is, S, A, e.rewardsSum_) ) return fail(is);
+
+        // This guarantees that if input is invalid we still keep the old Exp.
+        exp = std::move(e);
+
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, ValueIterationCheckpoint & checkpoint) {
+        Header h;
+        if ( !readHeader(is, BinaryType::ValueIterationCheckpoint, h) ) return fail(is);
+        const size_t S = h.S;
+
+        ProgressHeader p;
+        if ( !readBytes(is, &p, sizeof(ProgressHeader)) ) return fail(is);
+
+        ValueIterationCheckpoint c{static_cast<unsigned>(p.timestep), p.variation, makeValueFunction(S), Values()};
+        std::vector<std::uint64_t> actions(S);
+        if ( !readArray(is, c.v.values.data(), S) ||
+             !readArray(is, actions.data(), S) )
+            return fail(is);
+        if ( p.extra ) {
+            if ( p.extra != S ) return fail(is);
+            c.residuals.resize(S);
+            if ( !readArray(is, c.residuals.data(), S) ) return fail(is);
+        }
+        std::copy(std::begin(actions), std::end(actions), std::begin(c.v.actions));
+
+        checkpoint = std::move(c);
+
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, TransitionBatch & batch) {
+        Header h;
+        if ( !readHeader(is, BinaryType::TransitionTable, h) ) return fail(is);
+
+        TableHeader t;
+        if ( !readTableHeader(is, t) || (t.columns != 4 && t.columns != 5) ) return fail(is);
+        const size_t rows = t.rows;
+        if ( rows > remainingBytes(is) / (t.columns * sizeof(std::uint64_t)) ) return fail(is);
+
+        TransitionBatch b;
+        b.states.resize(rows);
+        b.actions.resize(rows);
+        b.nextStates.resize(rows);
+        b.rewards.resize(rows);
+        if ( t.columns == 5 ) b.nextActions.resize(rows);
+
+        if ( !readArray(is, b.states.data(), rows) ||
+             !readArray(is, b.actions.data(), rows) ||
+             !readArray(is, b.nextStates.data(), rows) ||
+             !readArray(is, b.rewards.data(), rows) )
+            return fail(is);
+        if ( t.columns == 5 && !readArray(is, b.nextActions.data(), rows) ) return fail(is);
+
+        batch = std::move(b);
+
+        return is;
+    }
+
+    std::istream & readExperienceTable(std::istream & is, Experience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+
+        ExperienceTable table;
+        if ( !readExperienceColumns(is, S, A, table) ) return fail(is);
+
+        for ( size_t i = 0; i < table.states.size(); ++i ) {
+            const auto s = table.states[i], a = table.actions[i], s1 = table.nextStates[i];
+
+            exp.visits_[s][a][s1]  += table.visits[i];
+            exp.visitsSum_[s][a]   += table.visits[i];
+            exp.rewards_[s][a][s1] += table.rewards[i];
+            exp.rewardsSum_[s][a]  += table.rewards[i];
+
+            if ( !exp.isDirty_[s * A + a] ) {
+                exp.isDirty_[s * A + a] = true;
+                exp.dirty_.emplace_back(s, a);
+            }
+        }
+        return is;
+    }
+
+    std::istream & readExperienceTable(std::istream & is, SparseExperience & exp) {
+        const size_t S = exp.getS(), A = exp.getA();
+
+        ExperienceTable table;
+        if ( !readExperienceColumns(is, S, A, table) ) return fail(is);
+
+        // Duplicate triplets are summed when building the matrices.
+        std::vector<std::vector<Eigen::Triplet<long>>> visits(A);
+        std::vector<std::vector<Eigen::Triplet<double>>> rewards(A);
+        std::vector<Eigen::Triplet<long>> visitsSum;
+        std::vector<Eigen::Triplet<double>> rewardsSum;
+
+        for ( size_t i = 0; i < table.states.size(); ++i ) {
+            const auto s = table.states[i], a = table.actions[i], s1 = table.nextStates[i];
+
+            visits[a].emplace_back(s, s1, table.visits[i]);
+            visitsSum.emplace_back(s, a, table.visits[i]);
+            if ( checkDifferentSmall(0.0, table.rewards[i]) ) {
+                rewards[a].emplace_back(s, s1, table.rewards[i]);
+                rewardsSum.emplace_back(s, a, table.rewards[i]);
+            }
+
+            if ( !exp.isDirty_[s * A + a] ) {
+                exp.isDirty_[s * A + a] = true;
+                exp.dirty_.emplace_back(s, a);
+            }
+        }
+
+        SparseTable2D v(S, S);
+        SparseMatrix2D r(S, S);
+        for ( size_t a = 0; a < A; ++a ) {
+            v.setFromTriplets(std::begin(visits[a]), std::end(visits[a]));
+            exp.visits_[a] += v;
+            r.setFromTriplets(std::begin(rewards[a]), std::end(rewards[a]));
+            exp.rewards_[a] += r;
+        }
+        SparseTable2D vSum(S, A);
+        vSum.setFromTriplets(std::begin(visitsSum), std::end(visitsSum));
+        exp.visitsSum_ += vSum;
+
+        SparseMatrix2D rSum(S, A);
+        rSum.setFromTriplets(std::begin(rewardsSum), std::end(rewardsSum));
+        exp.rewardsSum_ += rSum;
+
+        return is;
+    }
+
+    // MappedFile
+
+    MappedFile::MappedFile(const std::string & filename) : data_(nullptr), size_(0) {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if ( fd < 0 )
+            throw std::runtime_error("Could not open file " + filename);
+
+        struct stat st;
+        if ( ::fstat(fd, &st) < 0 ) {
+            ::close(fd);
+            throw std::runtime_error("Could not read the size of file " + filename);
+        }
+        size_ = st.st_size;
+
+        if ( size_ > 0 ) {
+            void * ptr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if ( ptr == MAP_FAILED ) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file " + filename);
+            }
+            data_ = static_cast<const char *>(ptr);
+        }
+        // The mapping stays valid after the file is closed.
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if ( data_ ) ::munmap(const_cast<char *>(data_), size_);
+    }
+
+    const char * MappedFile::data() const { return data_; }
+    size_t MappedFile::size() const { return size_; }
+
+    void MappedFile::prefetch(const void * p, const size_t bytes) const {
+        if ( !data_ || !bytes ) return;
+        const size_t page = ::sysconf(_SC_PAGESIZE);
+
+        const size_t offset = static_cast<const char *>(p) - data_;
+        if ( offset >= size_ ) return;
+        const size_t begin = offset / page * page;
+        const size_t end = std::min(size_, offset + bytes);
+
+        ::madvise(const_cast<char *>(data_) + begin, end - begin, MADV_WILLNEED);
+    }
+
+    void MappedFile::evict(const void * p, const size_t bytes) const {
+        if ( !data_ || !bytes ) return;
+        const size_t page = ::sysconf(_SC_PAGESIZE);
+
+        const size_t offset = static_cast<const char *>(p) - data_;
+        if ( offset >= size_ ) return;
+        // The last page of the file can be evicted even if partial.
+        const size_t begin = (offset + page - 1) / page * page;
+        const size_t end = std::min(size_, offset + bytes) == size_ ? size_ : (offset + bytes) / page * page;
+        if ( begin >= end ) return;
+
+        ::madvise(const_cast<char *>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+
+    // MappedModel
+
+    MappedModel::MappedModel(std::shared_ptr<const MappedFile> file) :
+            file_(std::move(file)), S(0), A(0), discount_(1.0),
+            rewards_(nullptr, 0, 0), rand_(Impl::Seeder::getSeed())
+    {
+        MappedReader reader(*file_, BinaryType::Model);
+        S = reader.header().S;
+        A = reader.header().A;
+        discount_ = reader.header().discount;
+
+        transitions_.reserve(A);
+        for ( size_t a = 0; a < A; ++a )
+            transitions_.emplace_back(reader.get<double>(S * S), S, S);
+        // Placement new is the way Eigen offers to change the data of a Map.
+        new (&rewards_) RewardMatrix(reader.get<double>(S * A), S, A);
+    }
+
+    MappedModel::MappedModel(const std::string & filename) :
+            MappedModel(std::make_shared<const MappedFile>(filename)) {}
+
+    std::tuple<size_t, double> MappedModel::sampleSR(const size_t s, const size_t a) const {
+        const size_t s1 = sampleProbability(S, transitions_[a].row(s), rand_);
+
+        return std::make_tuple(s1, rewards_(s, a));
+    }
+
+    double MappedModel::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+        return transitions_[a](s, s1);
+    }
+
+    double MappedModel::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+        return rewards_(s, a);
+    }
+
+    bool MappedModel::isTerminal(const size_t s) const {
+        for ( size_t a = 0; a < A; ++a )
+            if ( !checkEqualSmall(1.0, transitions_[a](s, s)) )
+                return false;
+        return true;
+    }
+
+    size_t MappedModel::getS() const { return S; }
+    size_t MappedModel::getA() const { return A; }
+    double MappedModel::getDiscount() const { return discount_; }
+
+    const Eigen::Map<const Matrix2D> & MappedModel::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    const MappedModel::RewardMatrix & MappedModel::getRewardFunction() const { return rewards_; }
+
+    // MappedSparseModel
+
+    MappedSparseModel::MappedSparseModel(std::shared_ptr<const MappedFile> file) :
+            file_(std::move(file)), S(0), A(0), discount_(1.0), streamingBlock_(0),
+            rewards_(0, 0, 0, nullptr, nullptr, nullptr), rand_(Impl::Seeder::getSeed())
+    {
+        MappedReader reader(*file_, BinaryType::SparseModel);
+        S = reader.header().S;
+        A = reader.header().A;
+        discount_ = reader.header().discount;
+
+        transitions_.reserve(A);
+        for ( size_t a = 0; a < A; ++a )
+            transitions_.emplace_back(reader.getSparse<SparseMatrix2D>(S, S));
+        // Placement new is the way Eigen offers to change the data of a Map.
+        new (&rewards_) RewardMatrix(reader.getSparse<SparseMatrix2D>(S, A));
+    }
+
+    MappedSparseModel::MappedSparseModel(const std::string & filename) :
+            MappedSparseModel(std::make_shared<const MappedFile>(filename)) {}
+
+    std::tuple<size_t, double> MappedSparseModel::sampleSR(const size_t s, const size_t a) const {
+        double p = probabilityDistribution(rand_);
+
+        size_t s1 = S - 1;
+        for ( RewardMatrix::InnerIterator it(transitions_[a], s); it; ++it ) {
+            if ( it.value() > p ) {
+                s1 = it.col();
+                break;
+            }
+            p -= it.value();
+        }
+        return std::make_tuple(s1, rewards_.coeff(s, a));
+    }
+
+    double MappedSparseModel::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+        return transitions_[a].coeff(s, s1);
+    }
+
+    double MappedSparseModel::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+        return rewards_.coeff(s, a);
+    }
+
+    bool MappedSparseModel::isTerminal(const size_t s) const {
+        for ( size_t a = 0; a < A; ++a )
+            if ( !checkEqualSmall(1.0, transitions_[a].coeff(s, s)) )
+                return false;
+        return true;
+    }
+
+    size_t MappedSparseModel::getS() const { return S; }
+    size_t MappedSparseModel::getA() const { return A; }
+    double MappedSparseModel::getDiscount() const { return discount_; }
+
+    const Eigen::Map<const SparseMatrix2D> & MappedSparseModel::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    const MappedSparseModel::RewardMatrix & MappedSparseModel::getRewardFunction() const { return rewards_; }
+
+    void MappedSparseModel::setStreamingBlock(const size_t rows) { streamingBlock_ = rows; }
+    size_t MappedSparseModel::getStreamingBlock() const { return streamingBlock_; }
+
+    namespace {
+        // Applies f to the byte ranges of the values and column indeces of
+        // the input rows, which are contiguous in CSR form.
+        template <typename F>
+        void forRowRanges(const Eigen::Map<const SparseMatrix2D> & m, const size_t begin, const size_t end, F f) {
+            if ( begin >= end ) return;
+            const auto outer = m.outerIndexPtr();
+            const size_t from = outer[begin], to = outer[end];
+
+            using Index = SparseMatrix2D::StorageIndex;
+            f(outer + begin, (end - begin + 1) * sizeof(Index));
+            f(m.innerIndexPtr() + from, (to - from) * sizeof(Index));
+            f(m.valuePtr() + from, (to - from) * sizeof(double));
+        }
+    }
+
+    void MappedSparseModel::prefetchRows(const size_t a, const size_t begin, const size_t end) const {
+        forRowRanges(transitions_[a], begin, std::min(end, S), [this](const void * p, size_t bytes) { file_->prefetch(p, bytes); });
+    }
+
+    void MappedSparseModel::evictRows(const size_t a, const size_t begin, const size_t end) const {
+        forRowRanges(transitions_[a], begin, std::min(end, S), [this](const void * p, size_t bytes) { file_->evict(p, bytes); });
+    }
+
+    // MappedExperience
+
+    MappedExperience::MappedExperience(std::shared_ptr<const MappedFile> file) :
+            file_(std::move(file))
+    {
+        MappedReader reader(*file_, BinaryType::Experience);
+        S = reader.header().S;
+        A = reader.header().A;
+
+        visits_     = reader.get<long>(S * A * S);
+        visitsSum_  = reader.get<long>(S * A);
+        rewards_    = reader.get<double>(S * A * S);
+        rewardsSum_ = reader.get<double>(S * A);
+    }
+
+    MappedExperience::MappedExperience(const std::string & filename) :
+            MappedExperience(std::make_shared<const MappedFile>(filename)) {}
+
+    unsigned long MappedExperience::getVisits(const size_t s, const size_t a, const size_t s1) const {
+        return visits_[(s * A + a) * S + s1];
+    }
+
+    unsigned long MappedExperience::getVisitsSum(const size_t s, const size_t a) const {
+        return visitsSum_[s * A + a];
+    }
+
+    double MappedExperience::getReward(const size_t s, const size_t a, const size_t s1) const {
+        return rewards_[(s * A + a) * S + s1];
+    }
+
+    double MappedExperience::getRewardSum(const size_t s, const size_t a) const {
+        return rewardsSum_[s * A + a];
+    }
+
+    size_t MappedExperience::getS() const { return S; }
+    size_t MappedExperience::getA() const { return A; }
+}
@@ -0,0 +1,39 @@
+#include <AIToolbox/MDP/ConcurrentRecorder.hpp>
+
+#include <stdexcept>
+
+namespace AIToolbox::MDP {
+    ConcurrentRecorder::ConcurrentRecorder(const size_t s, const size_t a, const size_t shards) :
+            S(s), A(a), shards_(shards)
+    {
+        if ( shards == 0 ) throw std::invalid_argument("Number of shards must be at least 1");
+    }
+
+    void ConcurrentRecorder::record(const size_t shard, const size_t s, const size_t a, const size_t s1, const double rew) {
+        auto & sh = shards_[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+
+        sh.buffer.states.push_back(s);
+        sh.buffer.actions.push_back(a);
+        sh.buffer.nextStates.push_back(s1);
+        sh.buffer.rewards.push_back(rew);
+    }
+
+    void ConcurrentRecorder::swapShard(const size_t shard) {
+        // We clear before swapping, so that the shard receives back our
+        // old buffers (keeping their capacity) and we can replay its data
+        // outside of the lock.
+        merging_.states.clear();
+        merging_.actions.clear();
+        merging_.nextStates.clear();
+        merging_.rewards.clear();
+
+        auto & sh = shards_[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        std::swap(merging_, sh.buffer);
+    }
+
+    size_t ConcurrentRecorder::getShards() const { return shards_.size(); }
+    size_t ConcurrentRecorder::getS() const { return S; }
+    size_t ConcurrentRecorder::getA() const { return A; }
+}
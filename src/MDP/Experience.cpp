@@ -2,10 +2,13 @@
 
 #include <algorithm>
 
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+
 namespace AIToolbox::MDP {
     Experience::Experience(const size_t s, const size_t a) :
             S(s), A(a), visits_(boost::extents[S][A][S]), visitsSum_(boost::extents[S][A]),
-            rewards_(boost::extents[S][A][S]), rewardsSum_(boost::extents[S][A]) {}
+            rewards_(boost::extents[S][A][S]), rewardsSum_(boost::extents[S][A]),
+            isDirty_(S * A, false) {}
 
     void Experience::record(const size_t s, const size_t a, const size_t s1, const double rew) {
         visits_[s][a][s1]   += 1;
@@ -13,6 +16,11 @@ namespace AIToolbox::MDP {
 
         rewards_[s][a][s1]  += rew;
         rewardsSum_[s][a]   += rew;
+
+        if ( !isDirty_[s * A + a] ) {
+            isDirty_[s * A + a] = true;
+            dirty_.emplace_back(s, a);
+        }
     }
 
     void Experience::reset() {
@@ -21,6 +29,7 @@ namespace AIToolbox::MDP {
 
         std::fill(rewards_.data(), rewards_.data() + rewards_.num_elements(), 0.0);
         std::fill(rewardsSum_.data(), rewardsSum_.data() + rewardsSum_.num_elements(), 0.0);
+        clearDirtyPairs();
     }
 
     unsigned long Experience::getVisits(const size_t s, const size_t a, const size_t s1) const {
@@ -39,6 +48,16 @@ namespace AIToolbox::MDP {
         return rewardsSum_[s][a];
     }
 
+    const Experience::DirtyPairs & Experience::getDirtyPairs() const {
+        return dirty_;
+    }
+
+    void Experience::clearDirtyPairs() {
+        for ( const auto & [s, a] : dirty_ )
+            isDirty_[s * A + a] = false;
+        dirty_.clear();
+    }
+
     const Experience::VisitTable & Experience::getVisitTable() const {
         return visits_;
     }
@@ -54,4 +73,10 @@ namespace AIToolbox::MDP {
     size_t Experience::getA() const {
         return A;
     }
+
+    size_t Experience::getMemoryUsage() const {
+        return heapUsage(visits_) + heapUsage(visitsSum_) +
+               heapUsage(rewards_) + heapUsage(rewardsSum_) +
+               heapUsage(dirty_) + isDirty_.capacity() / 8;
+    }
 }
@@ -0,0 +1,108 @@
+#include <AIToolbox/MDP/FusedSparseModel.hpp>
+
+#include <algorithm>
+
+namespace AIToolbox::MDP {
+    FusedSparseModel::FusedSparseModel(NoCheck, const size_t s, const size_t a, TransitionMatrix && t, RewardMatrix && r, const double d) :
+            S(s), A(a), discount_(d), transitions_(std::move(t)), rewards_(std::move(r)), rand_(Impl::Seeder::getSeed())
+    {
+        transitions_.makeCompressed();
+        computeCumulatives();
+    }
+
+    FusedSparseModel::FusedSparseModel(const size_t s, const size_t a, const double discount) :
+            S(s), A(a), discount_(discount), transitions_(S * A, S),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    {
+        // Make transition matrix true probability
+        transitions_.reserve(S * A);
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                transitions_.insert(s * A + a, s) = 1.0;
+        transitions_.makeCompressed();
+        computeCumulatives();
+
+        rewards_.setZero();
+    }
+
+    void FusedSparseModel::setTransitionFunction(const TransitionMatrix & t) {
+        if ( static_cast<size_t>(t.rows()) != S * A || static_cast<size_t>(t.cols()) != S )
+            throw std::invalid_argument("Input transition matrix has the wrong size.");
+
+        // First we verify data, without modifying anything...
+        for ( size_t row = 0; row < S * A; ++row ) {
+            // Eigen sparse does not implement minCoeff so we can't check for negatives.
+            // So we force the matrix to its abs, and if then the sum goes haywire then
+            // we found an error.
+            if ( !checkEqualSmall(1.0, t.row(row).sum()) )
+                throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+            if ( !checkEqualSmall(1.0, t.row(row).cwiseAbs().sum()) )
+                throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
+        }
+        // Then we copy.
+        transitions_ = t;
+        transitions_.makeCompressed();
+        computeCumulatives();
+    }
+
+    void FusedSparseModel::setRewardFunction(const RewardMatrix & r) {
+        rewards_ = r;
+    }
+
+    void FusedSparseModel::computeCumulatives() {
+        // The cumulatives are aligned with the values of the compressed
+        // transition matrix, so that each row can be searched in place.
+        const auto outer = transitions_.outerIndexPtr();
+        const auto values = transitions_.valuePtr();
+
+        cumulatives_.resize(transitions_.nonZeros());
+        for ( size_t row = 0; row < S * A; ++row ) {
+            double sum = 0.0;
+            for ( auto i = outer[row]; i < outer[row + 1]; ++i ) {
+                sum += values[i];
+                cumulatives_[i] = sum;
+            }
+        }
+    }
+
+    std::tuple<size_t, double> FusedSparseModel::sampleSR(const size_t s, const size_t a) const {
+        const size_t row = s * A + a;
+        const auto begin = cumulatives_.data() + transitions_.outerIndexPtr()[row];
+        const auto end   = cumulatives_.data() + transitions_.outerIndexPtr()[row + 1];
+
+        const double p = probabilityDistribution(rand_);
+        // We exclude the last element from the search so that, if rounding
+        // errors make the total slightly less than 1, we still pick it.
+        const auto it = std::upper_bound(begin, end - 1, p);
+
+        const size_t s1 = transitions_.innerIndexPtr()[it - cumulatives_.data()];
+        return std::make_tuple(s1, rewards_(s, a));
+    }
+
+    double FusedSparseModel::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+        return transitions_.coeff(s * A + a, s1);
+    }
+
+    double FusedSparseModel::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+        return rewards_(s, a);
+    }
+
+    void FusedSparseModel::setDiscount(const double d) {
+        if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
+        discount_ = d;
+    }
+
+    bool FusedSparseModel::isTerminal(const size_t s) const {
+        for ( size_t a = 0; a < A; ++a )
+            if ( !checkEqualSmall(1.0, getTransitionProbability(s, a, s)) )
+                return false;
+        return true;
+    }
+
+    size_t FusedSparseModel::getS() const { return S; }
+    size_t FusedSparseModel::getA() const { return A; }
+    double FusedSparseModel::getDiscount() const { return discount_; }
+
+    const FusedSparseModel::TransitionMatrix & FusedSparseModel::getTransitionFunction() const { return transitions_; }
+    const FusedSparseModel::RewardMatrix &     FusedSparseModel::getRewardFunction()     const { return rewards_; }
+}
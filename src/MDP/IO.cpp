@@ -8,16 +8,155 @@
 
 #include <AIToolbox/Impl/CassandraParser.hpp>
 #include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Impl/Parsing.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 
 namespace AIToolbox::MDP {
+    namespace {
+        // Computes the expected rewards R(s,a) from the parsed R[a](s, s1).
+        Matrix2D expectedRewards(const size_t S, const size_t A, const SparseMatrix3D & T, const SparseMatrix3D & R) {
+            Matrix2D rewards(S, A);
+            for (size_t a = 0; a < A; ++a)
+                rewards.col(a) = T[a].cwiseProduct(R[a]) * Vector::Ones(S);
+            return rewards;
+        }
+
+        // The counts of a single transition in a log shard.
+        struct LogEntry {
+            unsigned long visits = 0;
+            double reward = 0.0;
+        };
+
+        // The transitions counted by a single thread, keyed on (s * A + a) * S + s1.
+        struct LogShard {
+            std::unordered_map<std::uint64_t, LogEntry> entries;
+            size_t transitions = 0;
+            std::string error;
+        };
+
+        template <typename T>
+        bool parseLogValue(const char *& begin, const char * end, T & val) {
+            while ( begin < end && (*begin == ' ' || *begin == '\t') ) ++begin;
+            if constexpr (std::is_same_v<T, double>) {
+                return Impl::parseDouble(begin, end, val);
+            } else {
+                const auto [ptr, ec] = std::from_chars(begin, end, val);
+                if ( ec != std::errc() ) return false;
+                begin = ptr;
+                return true;
+            }
+        }
+
+        // Parses the lines that start within [begin, end) of the file.
+        void parseLogChunk(const std::string & filename, const size_t begin, const size_t end, const size_t S, const size_t A, LogShard & shard) {
+            std::ifstream file(filename, std::ios::binary);
+            if ( !file ) {
+                shard.error = "Could not open file " + filename;
+                return;
+            }
+
+            std::string line;
+            size_t pos = begin;
+            // The line crossing the start of the chunk belongs to the
+            // previous one, so we skip to the first line starting after it.
+            if ( begin > 0 ) {
+                file.seekg(begin - 1);
+                std::getline(file, line);
+                pos += line.size();
+            }
+
+            while ( pos < end && std::getline(file, line) ) {
+                const size_t linePos = pos;
+                pos += line.size() + 1;
+
+                const char * ptr = line.data();
+                const char * lineEnd = ptr + line.size();
+                while ( ptr < lineEnd && (lineEnd[-1] == ' ' || lineEnd[-1] == '\t' || lineEnd[-1] == '\r') ) --lineEnd;
+                while ( ptr < lineEnd && (*ptr == ' ' || *ptr == '\t') ) ++ptr;
+                if ( ptr == lineEnd ) continue;
+
+                size_t s, a, s1;
+                double rew;
+                if ( !parseLogValue(ptr, lineEnd, s) || !parseLogValue(ptr, lineEnd, a) ||
+                     !parseLogValue(ptr, lineEnd, s1) || !parseLogValue(ptr, lineEnd, rew) || ptr != lineEnd )
+                {
+                    shard.error = "Malformed transition at byte " + std::to_string(linePos) + " of " + filename;
+                    return;
+                }
+                if ( s >= S || a >= A || s1 >= S ) {
+                    shard.error = "Transition out of range at byte " + std::to_string(linePos) + " of " + filename;
+                    return;
+                }
+
+                auto & entry = shard.entries[(std::uint64_t(s) * A + a) * S + s1];
+                entry.visits += 1;
+                entry.reward += rew;
+                ++shard.transitions;
+            }
+        }
+
+        // Parses the whole log, split between the threads of the pool.
+        std::vector<LogShard> parseLog(const std::string & filename, const size_t S, const size_t A, ThreadPool * pool) {
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if ( !file ) throw std::runtime_error("Could not open file " + filename);
+            const auto size = file.tellg();
+            if ( size < 0 ) throw std::runtime_error("Could not read the size of file " + filename);
+            file.close();
+
+            const size_t bytes = size;
+            const size_t chunks = pool ? std::max(size_t(1), std::min(pool->getThreadNumber(), bytes)) : 1;
+
+            std::vector<LogShard> shards(chunks);
+            const auto job = [&](const size_t b, const size_t e) {
+                for ( size_t i = b; i < e; ++i )
+                    parseLogChunk(filename, i * bytes / chunks, (i + 1) * bytes / chunks, S, A, shards[i]);
+            };
+            if ( pool ) pool->parallelFor(chunks, job);
+            else job(0, chunks);
+
+            for ( const auto & shard : shards )
+                if ( !shard.error.empty() ) throw std::runtime_error(shard.error);
+
+            return shards;
+        }
+    }
+
     Model parseCassandra(std::istream & input) {
         Impl::CassandraParser parser;
 
-        const auto & [S, A, T, R, discount] = parser.parseMDP(input);
+        auto [S, A, T, R, discount] = parser.parseMDP(input);
+        Impl::CassandraParser::checkProbabilities(T, "Input transition matrix does not contain valid probabilities.");
+
+        Model::TransitionMatrix t(A);
+        for (size_t a = 0; a < A; ++a)
+            t[a] = Matrix2D(T[a]);
+
+        Model retval(NO_CHECK, S, A, std::move(t), expectedRewards(S, A, T, R), 1.0);
+        retval.setDiscount(discount);
+
+        return retval;
+    }
+
+    SparseModel parseCassandraSparse(std::istream & input) {
+        Impl::CassandraParser parser;
+
+        auto [S, A, T, R, discount] = parser.parseMDP(input);
+        Impl::CassandraParser::checkProbabilities(T, "Input transition matrix does not contain valid probabilities.");
+
+        SparseModel::RewardMatrix r = expectedRewards(S, A, T, R).sparseView();
+        SparseModel retval(NO_CHECK, S, A, std::move(T), std::move(r), 1.0);
+        retval.setDiscount(discount);
 
-        return Model(S, A, T, R, discount);
+        return retval;
     }
 
     // Global discrete policy writer
@@ -110,6 +249,88 @@ namespace AIToolbox::MDP {
         return is;
     }
 
+    size_t readTransitionLog(const std::string & filename, Experience & exp, ThreadPool * pool) {
+        const size_t S = exp.getS();
+        const size_t A = exp.getA();
+
+        const auto shards = parseLog(filename, S, A, pool);
+
+        size_t transitions = 0;
+        for ( const auto & shard : shards ) {
+            for ( const auto & [key, entry] : shard.entries ) {
+                const size_t s1 = key % S;
+                const size_t a  = (key / S) % A;
+                const size_t s  = key / S / A;
+
+                exp.visits_[s][a][s1]  += entry.visits;
+                exp.visitsSum_[s][a]   += entry.visits;
+                exp.rewards_[s][a][s1] += entry.reward;
+                exp.rewardsSum_[s][a]  += entry.reward;
+
+                if ( !exp.isDirty_[s * A + a] ) {
+                    exp.isDirty_[s * A + a] = true;
+                    exp.dirty_.emplace_back(s, a);
+                }
+            }
+            transitions += shard.transitions;
+        }
+        return transitions;
+    }
+
+    size_t readTransitionLog(const std::string & filename, SparseExperience & exp, ThreadPool * pool) {
+        const size_t S = exp.getS();
+        const size_t A = exp.getA();
+
+        const auto shards = parseLog(filename, S, A, pool);
+
+        // Duplicate triplets are summed when building the matrices, so we
+        // don't need to merge the shards first.
+        std::vector<std::vector<Eigen::Triplet<long>>> visits(A);
+        std::vector<std::vector<Eigen::Triplet<double>>> rewards(A);
+        std::vector<Eigen::Triplet<long>> visitsSum;
+        std::vector<Eigen::Triplet<double>> rewardsSum;
+
+        size_t transitions = 0;
+        for ( const auto & shard : shards ) {
+            for ( const auto & [key, entry] : shard.entries ) {
+                const size_t s1 = key % S;
+                const size_t a  = (key / S) % A;
+                const size_t s  = key / S / A;
+
+                visits[a].emplace_back(s, s1, entry.visits);
+                visitsSum.emplace_back(s, a, entry.visits);
+                if ( checkDifferentSmall(0.0, entry.reward) ) {
+                    rewards[a].emplace_back(s, s1, entry.reward);
+                    rewardsSum.emplace_back(s, a, entry.reward);
+                }
+
+                if ( !exp.isDirty_[s * A + a] ) {
+                    exp.isDirty_[s * A + a] = true;
+                    exp.dirty_.emplace_back(s, a);
+                }
+            }
+            transitions += shard.transitions;
+        }
+
+        SparseTable2D v(S, S);
+        SparseMatrix2D r(S, S);
+        for ( size_t a = 0; a < A; ++a ) {
+            v.setFromTriplets(std::begin(visits[a]), std::end(visits[a]));
+            exp.visits_[a] += v;
+            r.setFromTriplets(std::begin(rewards[a]), std::end(rewards[a]));
+            exp.rewards_[a] += r;
+        }
+        SparseTable2D vSum(S, A);
+        vSum.setFromTriplets(std::begin(visitsSum), std::end(visitsSum));
+        exp.visitsSum_ += vSum;
+
+        SparseMatrix2D rSum(S, A);
+        rSum.setFromTriplets(std::begin(rewardsSum), std::end(rewardsSum));
+        exp.rewardsSum_ += rSum;
+
+        return transitions;
+    }
+
     // MDP::Model reader
     std::istream& operator>>(std::istream &is, Model & m) {
         const size_t S = m.getS();
@@ -139,6 +360,7 @@ namespace AIToolbox::MDP {
             }
         }
         // This guarantees that if input is invalid we still keep the old Model.
+        in.setAliasSampling(m.getAliasSampling());
         m = std::move(in);
 
         return is;
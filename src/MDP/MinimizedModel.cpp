@@ -0,0 +1,45 @@
+#include <AIToolbox/MDP/MinimizedModel.hpp>
+
+namespace AIToolbox::MDP {
+    const SparseModel & MinimizedModel::getModel() const { return model_; }
+    size_t MinimizedModel::getOriginalS() const { return blocks_.size(); }
+    const std::vector<size_t> & MinimizedModel::getBlocks() const { return blocks_; }
+    size_t MinimizedModel::getBlock(const size_t s) const { return blocks_[s]; }
+    const std::vector<size_t> & MinimizedModel::getRepresentatives() const { return representatives_; }
+
+    ValueFunction MinimizedModel::expand(const ValueFunction & vf) const {
+        if (static_cast<size_t>(vf.values.size()) != representatives_.size() || vf.actions.size() != representatives_.size())
+            throw std::invalid_argument("ValueFunction does not match the minimized states");
+
+        const size_t S = blocks_.size();
+        ValueFunction retval(Values::Zero(S), Actions(S, 0));
+        for (size_t s = 0; s < S; ++s) {
+            retval.values[s] = vf.values[blocks_[s]];
+            retval.actions[s] = vf.actions[blocks_[s]];
+        }
+        return retval;
+    }
+
+    QFunction MinimizedModel::expand(const QFunction & q) const {
+        if (static_cast<size_t>(q.rows()) != representatives_.size())
+            throw std::invalid_argument("QFunction does not match the minimized states");
+
+        QFunction retval(blocks_.size(), q.cols());
+        for (size_t s = 0; s < blocks_.size(); ++s)
+            retval.row(s) = q.row(blocks_[s]);
+        return retval;
+    }
+
+    ValueFunction MinimizedModel::compact(const ValueFunction & vf) const {
+        if (static_cast<size_t>(vf.values.size()) != blocks_.size() || vf.actions.size() != blocks_.size())
+            throw std::invalid_argument("ValueFunction does not match the original states");
+
+        const size_t B = representatives_.size();
+        ValueFunction retval(Values::Zero(B), Actions(B, 0));
+        for (size_t i = 0; i < B; ++i) {
+            retval.values[i] = vf.values[representatives_[i]];
+            retval.actions[i] = vf.actions[representatives_[i]];
+        }
+        return retval;
+    }
+}
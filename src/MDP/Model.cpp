@@ -1,15 +1,19 @@
 #include <AIToolbox/MDP/Model.hpp>
 
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+
 namespace AIToolbox::MDP {
-    Model::Model(NoCheck, const size_t s, const size_t a, TransitionMatrix && t, RewardMatrix && r, const double d) :
+    template <typename Scalar>
+    BasicModel<Scalar>::BasicModel(NoCheck, const size_t s, const size_t a, TransitionMatrix && t, RewardMatrix && r, const double d) :
             S(s), A(a), discount_(d),
             transitions_(std::move(t)),
             rewards_(std::move(r)),
-            rand_(Impl::Seeder::getSeed()) {}
+            rand_(Impl::Seeder::getSeed()), aliasSampling_(false) {}
 
-    Model::Model(const size_t s, const size_t a, const double discount) :
-            S(s), A(a), discount_(discount), transitions_(A, Matrix2D(S, S)),
-            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    template <typename Scalar>
+    BasicModel<Scalar>::BasicModel(const size_t s, const size_t a, const double discount) :
+            S(s), A(a), discount_(discount), transitions_(A, BasicMatrix2D<Scalar>(S, S)),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed()), aliasSampling_(false)
     {
         // Make transition matrix true probability
         for ( size_t a = 0; a < A; ++a )
@@ -18,12 +22,13 @@ namespace AIToolbox::MDP {
         rewards_.setZero();
     }
 
-    void Model::setTransitionFunction(const Matrix3D & t) {
+    template <typename Scalar>
+    void BasicModel<Scalar>::setTransitionFunction(const TransitionMatrix & t) {
         // First we verify data, without modifying anything...
         for ( size_t a = 0; a < A; ++a ) {
             for ( size_t s = 0; s < S; ++s ) {
                 if ( t[a].row(s).minCoeff() < 0.0 ||
-                     !checkEqualSmall(1.0, t[a].row(s).sum()) )
+                     !checkEqualSmall(1.0, t[a].row(s).template cast<double>().sum()) )
                 {
                     throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
                 }
@@ -31,44 +36,81 @@ namespace AIToolbox::MDP {
         }
         // Then we copy.
         transitions_ = t;
+
+        if ( aliasSampling_ ) samplers_ = VoseAliasTable(transitions_);
     }
 
-    void Model::setRewardFunction(const RewardMatrix & r) {
+    template <typename Scalar>
+    void BasicModel<Scalar>::setAliasSampling(const bool enable) {
+        aliasSampling_ = enable;
+        if ( aliasSampling_ ) samplers_ = VoseAliasTable(transitions_);
+        else                  samplers_ = VoseAliasTable();
+    }
+
+    template <typename Scalar>
+    void BasicModel<Scalar>::setRewardFunction(const RewardMatrix & r) {
         rewards_ = r;
     }
 
-    std::tuple<size_t, double> Model::sampleSR(const size_t s, const size_t a) const {
-        size_t s1 = sampleProbability(S, transitions_[a].row(s), rand_);
+    template <typename Scalar>
+    std::tuple<size_t, double> BasicModel<Scalar>::sampleSR(const size_t s, const size_t a) const {
+        return sampleSR(s, a, rand_);
+    }
+
+    template <typename Scalar>
+    std::tuple<size_t, double> BasicModel<Scalar>::sampleSR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const size_t s1 = aliasSampling_ ? samplers_.sampleProbability(a * S + s, rnd)
+                                         : sampleProbability(S, transitions_[a].row(s), rnd);
 
         return std::make_tuple(s1, rewards_(s, a));
     }
 
-    double Model::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+    template <typename Scalar>
+    double BasicModel<Scalar>::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
         return transitions_[a](s, s1);
     }
 
-    double Model::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+    template <typename Scalar>
+    double BasicModel<Scalar>::getExpectedReward(const size_t s, const size_t a, const size_t) const {
         return rewards_(s, a);
     }
 
-    void Model::setDiscount(const double d) {
+    template <typename Scalar>
+    void BasicModel<Scalar>::setDiscount(const double d) {
         if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
         discount_ = d;
     }
 
-    bool Model::isTerminal(const size_t s) const {
+    template <typename Scalar>
+    bool BasicModel<Scalar>::isTerminal(const size_t s) const {
         for ( size_t a = 0; a < A; ++a )
             if ( !checkEqualSmall(1.0, transitions_[a](s, s)) )
                 return false;
         return true;
     }
 
-    size_t Model::getS() const { return S; }
-    size_t Model::getA() const { return A; }
-    double Model::getDiscount() const { return discount_; }
+    template <typename Scalar>
+    size_t BasicModel<Scalar>::getMemoryUsage() const {
+        return heapUsage(transitions_) + heapUsage(rewards_) + samplers_.getMemoryUsage();
+    }
+
+    template <typename Scalar>
+    size_t BasicModel<Scalar>::getS() const { return S; }
+    template <typename Scalar>
+    size_t BasicModel<Scalar>::getA() const { return A; }
+    template <typename Scalar>
+    double BasicModel<Scalar>::getDiscount() const { return discount_; }
+    template <typename Scalar>
+    bool BasicModel<Scalar>::getAliasSampling() const { return aliasSampling_; }
+
+    template <typename Scalar>
+    const typename BasicModel<Scalar>::TransitionMatrix & BasicModel<Scalar>::getTransitionFunction() const { return transitions_; }
+    template <typename Scalar>
+    const typename BasicModel<Scalar>::RewardMatrix &     BasicModel<Scalar>::getRewardFunction()     const { return rewards_; }
 
-    const Model::TransitionMatrix & Model::getTransitionFunction() const { return transitions_; }
-    const Model::RewardMatrix &     Model::getRewardFunction()     const { return rewards_; }
+    template <typename Scalar>
+    const BasicMatrix2D<Scalar> & BasicModel<Scalar>::getTransitionFunction(const size_t a) const { return transitions_[a]; }
 
-    const Matrix2D & Model::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    template class BasicModel<double>;
+    template class BasicModel<float>;
 }
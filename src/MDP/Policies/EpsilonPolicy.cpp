@@ -5,6 +5,22 @@ namespace AIToolbox::MDP {
             PolicyInterface::Base(p.getS(), p.getA()), EpsilonBase(p, epsilon),
             randomDistribution_(0, this->A-1) {}
 
+    void EpsilonPolicy::sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+        const auto & wrapped = dynamic_cast<const PolicyInterface &>(policy_);
+        wrapped.sampleActions(states, actions);
+
+        for (auto & a : *actions)
+            if ( probabilityDistribution(rand_) <= epsilon_ )
+                a = randomDistribution_(rand_);
+    }
+
+    size_t EpsilonPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        if ( std::uniform_real_distribution<double>(0.0, 1.0)(gen) <= epsilon_ )
+            return std::uniform_int_distribution<size_t>(0, A-1)(gen);
+
+        return dynamic_cast<const PolicyInterface &>(policy_).sampleActionWith(s, gen);
+    }
+
     size_t EpsilonPolicy::sampleRandomAction() const {
         return randomDistribution_(rand_);
     }
@@ -14,12 +30,24 @@ namespace AIToolbox::MDP {
     }
 
     Matrix2D EpsilonPolicy::getPolicy() const {
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void EpsilonPolicy::getPolicyInto(Matrix2D * out) const {
         const auto & wrapped = dynamic_cast<const PolicyInterface &>(policy_);
-        auto p = wrapped.getPolicy();
+        wrapped.getPolicyInto(out);
 
-        p *= (1.0 - epsilon_);
-        p.array() += epsilon_ / A;
+        *out *= (1.0 - epsilon_);
+        out->array() += epsilon_ / A;
+    }
+
+    void EpsilonPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        const auto & wrapped = dynamic_cast<const PolicyInterface &>(policy_);
+        wrapped.getActionProbabilities(s, out);
 
-        return p;
+        *out *= (1.0 - epsilon_);
+        out->array() += epsilon_ / A;
     }
 }
@@ -0,0 +1,123 @@
+#include <AIToolbox/MDP/Policies/FrozenPolicy.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+#include <AIToolbox/Utils/Core.hpp>
+
+namespace AIToolbox::MDP {
+    // Up to this many actions in a state, the cumulative distribution is
+    // scanned linearly rather than with a binary search.
+    constexpr size_t LinearSearch = 8;
+
+    FrozenPolicy::FrozenPolicy(const PolicyInterface & p) :
+            PolicyInterface::Base(p.getS(), p.getA())
+    {
+        build(p.getPolicy());
+    }
+
+    FrozenPolicy::FrozenPolicy(const PolicyMatrix & p) :
+            PolicyInterface::Base(p.rows(), p.cols())
+    {
+        for ( size_t s = 0; s < S; ++s )
+            if (checkDifferentSmall(p.row(s).sum(), 1.0))
+                throw std::invalid_argument("Initializing FrozenPolicy with invalid PolicyMatrix");
+
+        build(p);
+    }
+
+    void FrozenPolicy::build(const PolicyMatrix & p) {
+        rows_.resize(S + 1);
+        rows_[0] = 0;
+
+        for ( size_t s = 0; s < S; ++s ) {
+            double sum = 0.0;
+            for ( size_t a = 0; a < A; ++a ) {
+                const double v = p(s, a);
+                if ( v == 0.0 ) continue;
+
+                sum += v;
+                actions_.push_back(a);
+                probs_.push_back(v);
+                cdf_.push_back(sum);
+            }
+            rows_[s + 1] = actions_.size();
+        }
+
+        actions_.shrink_to_fit();
+        probs_.shrink_to_fit();
+        cdf_.shrink_to_fit();
+    }
+
+    template <typename G>
+    size_t FrozenPolicy::sample(const size_t s, G & gen) const {
+        const size_t begin = rows_[s], end = rows_[s + 1];
+
+        // We sample up to the last value of the distribution, rather than
+        // 1.0, so that rounding errors in it do not bias the last action.
+        const float x = std::uniform_real_distribution<float>(0.0f, cdf_[end - 1])(gen);
+
+        size_t i;
+        if ( end - begin <= LinearSearch ) {
+            i = begin;
+            while ( i < end && cdf_[i] <= x ) ++i;
+        } else {
+            i = std::upper_bound(std::begin(cdf_) + begin, std::begin(cdf_) + end, x) - std::begin(cdf_);
+        }
+
+        // The distribution may return its upper bound due to rounding.
+        return actions_[std::min(i, end - 1)];
+    }
+
+    size_t FrozenPolicy::sampleAction(const size_t & s) const {
+        return sample(s, rand_);
+    }
+
+    size_t FrozenPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        return sample(s, gen);
+    }
+
+    void FrozenPolicy::sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+        actions->resize(states.size());
+        for (size_t i = 0; i < states.size(); ++i)
+            (*actions)[i] = sample(states[i], rand_);
+    }
+
+    double FrozenPolicy::getActionProbability(const size_t & s, const size_t & a) const {
+        const auto begin = std::begin(actions_) + rows_[s];
+        const auto end   = std::begin(actions_) + rows_[s + 1];
+
+        const auto it = std::lower_bound(begin, end, a);
+        if ( it == end || *it != a ) return 0.0;
+
+        return probs_[it - std::begin(actions_)];
+    }
+
+    Matrix2D FrozenPolicy::getPolicy() const {
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void FrozenPolicy::getPolicyInto(Matrix2D * out) const {
+        out->resize(S, A);
+        out->setZero();
+
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t i = rows_[s]; i < rows_[s + 1]; ++i )
+                (*out)(s, actions_[i]) = probs_[i];
+    }
+
+    void FrozenPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        out->resize(A);
+        out->setZero();
+
+        for ( size_t i = rows_[s]; i < rows_[s + 1]; ++i )
+            (*out)[actions_[i]] = probs_[i];
+    }
+
+    size_t FrozenPolicy::getNonZeros() const {
+        return actions_.size();
+    }
+}
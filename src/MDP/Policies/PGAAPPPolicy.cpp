@@ -7,7 +7,8 @@ namespace AIToolbox::MDP {
     PGAAPPPolicy::PGAAPPPolicy(const QFunction & q, const double lRate, const double predictionLength) :
             Base(q.rows(), q.cols()), QPolicyInterface(q),
             lRate_(lRate), predictionLength_(predictionLength),
-            policyMatrix_(S,A), policy_(policyMatrix_)
+            policyMatrix_(S,A), policy_(policyMatrix_),
+            isDirty_(S, false)
     {
         if ( lRate_ < 0.0 ) throw std::invalid_argument("Learning rate must be >= 0");
         if ( predictionLength_ < 0.0 ) throw std::invalid_argument("Prediction length must be >= 0");
@@ -16,6 +17,8 @@ namespace AIToolbox::MDP {
     }
 
     void PGAAPPPolicy::stepUpdateP(const size_t s) {
+        markDirty(s);
+
         const double avgR = policyMatrix_.row(s) * q_.row(s).transpose();
 
         for (size_t a = 0; a < A; ++a) {
@@ -36,6 +39,10 @@ namespace AIToolbox::MDP {
         return policy_.sampleAction(s);
     }
 
+    size_t PGAAPPPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        return policy_.sampleActionWith(s, gen);
+    }
+
     double PGAAPPPolicy::getActionProbability(const size_t & s, const size_t & a) const {
         return policy_.getActionProbability(s,a);
     }
@@ -44,6 +51,35 @@ namespace AIToolbox::MDP {
         return policy_.getPolicy();
     }
 
+    void PGAAPPPolicy::getPolicyInto(Matrix2D * out) const {
+        policy_.getPolicyInto(out);
+    }
+
+    void PGAAPPPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        policy_.getActionProbabilities(s, out);
+    }
+
+    const PolicyWrapper::PolicyMatrix & PGAAPPPolicy::getPolicyMatrix() const {
+        return policyMatrix_;
+    }
+
+    const PGAAPPPolicy::DirtyStates & PGAAPPPolicy::getDirtyStates() const {
+        return dirty_;
+    }
+
+    void PGAAPPPolicy::clearDirtyStates() {
+        for ( const auto s : dirty_ )
+            isDirty_[s] = false;
+        dirty_.clear();
+    }
+
+    void PGAAPPPolicy::markDirty(const size_t s) {
+        if ( !isDirty_[s] ) {
+            isDirty_[s] = true;
+            dirty_.push_back(s);
+        }
+    }
+
     void PGAAPPPolicy::setLearningRate(const double lRate) {
         if ( lRate < 0.0 ) throw std::invalid_argument("Learning rate must be >= 0");
         lRate_ = lRate;
@@ -13,6 +13,16 @@ namespace AIToolbox::MDP {
         return sampleProbability(A, policy_.row(s), rand_);
     }
 
+    size_t PolicyWrapper::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        return sampleProbability(A, policy_.row(s), gen);
+    }
+
+    void PolicyWrapper::sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+        actions->resize(states.size());
+        for (size_t i = 0; i < states.size(); ++i)
+            (*actions)[i] = sampleProbability(A, policy_.row(states[i]), rand_);
+    }
+
     double PolicyWrapper::getActionProbability(const size_t & s, const size_t & a) const {
         return policy_(s, a);
     }
@@ -24,4 +34,12 @@ namespace AIToolbox::MDP {
     Matrix2D PolicyWrapper::getPolicy() const {
         return policy_;
     }
+
+    void PolicyWrapper::getPolicyInto(Matrix2D * out) const {
+        *out = policy_;
+    }
+
+    void PolicyWrapper::getActionProbabilities(const size_t & s, Vector * out) const {
+        *out = policy_.row(s);
+    }
 }
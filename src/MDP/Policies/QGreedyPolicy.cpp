@@ -11,19 +11,46 @@ namespace AIToolbox::MDP {
         return wrap.sampleAction();
     }
 
+    size_t QGreedyPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        // Each thread has its own buffer, shared between all instances.
+        thread_local std::vector<size_t> buffer;
+        buffer.resize(A);
+
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.row(s), buffer, gen);
+        return wrap.sampleAction();
+    }
+
+    void QGreedyPolicy::sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+        actions->resize(states.size());
+        for (size_t i = 0; i < states.size(); ++i) {
+            auto wrap = Bandit::QGreedyPolicyWrapper(q_.row(states[i]), bestActions_, rand_);
+            (*actions)[i] = wrap.sampleAction();
+        }
+    }
+
     double QGreedyPolicy::getActionProbability(const size_t & s, const size_t & a) const {
         auto wrap = Bandit::QGreedyPolicyWrapper(q_.row(s), bestActions_, rand_);
         return wrap.getActionProbability(a);
     }
 
     Matrix2D QGreedyPolicy::getPolicy() const {
-        Matrix2D retval(S, A);
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void QGreedyPolicy::getPolicyInto(Matrix2D * out) const {
+        out->resize(S, A);
 
         for (size_t s = 0; s < S; ++s) {
             auto wrap = Bandit::QGreedyPolicyWrapper(q_.row(s), bestActions_, rand_);
-            wrap.getPolicy(retval.row(s));
+            wrap.getPolicy(out->row(s));
         }
+    }
 
-        return retval;
+    void QGreedyPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        out->resize(A);
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.row(s), bestActions_, rand_);
+        wrap.getPolicy(*out);
     }
 }
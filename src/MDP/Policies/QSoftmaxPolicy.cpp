@@ -2,41 +2,127 @@
 
 #include <AIToolbox/Bandit/Policies/Utils/QSoftmaxPolicyWrapper.hpp>
 
+#include <utility>
+
 namespace AIToolbox::MDP {
     QSoftmaxPolicy::QSoftmaxPolicy(const QFunction & q, const double t) :
             PolicyInterface::Base(q.rows(), q.cols()), QPolicyInterface(q),
-            temperature_(t), bestActions_(A), vbuffer_(A)
+            temperature_(t), caching_(false), version_(1), bestActions_(A), vbuffer_(A)
     {
         if ( temperature_ < 0.0 ) throw std::invalid_argument("Temperature must be >= 0");
     }
 
     size_t QSoftmaxPolicy::sampleAction(const size_t & s) const {
+        if (caching_) return sampleProbability(A, getCachedRow(s), rand_);
+
         auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer_, bestActions_, rand_);
         return wrap.sampleAction();
     }
 
+    size_t QSoftmaxPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        // Each thread has its own buffers, shared between all instances.
+        thread_local std::vector<size_t> buffer;
+        thread_local Vector vbuffer;
+        buffer.resize(A);
+        vbuffer.resize(A);
+
+        auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer, buffer, gen);
+        return wrap.sampleAction();
+    }
+
+    void QSoftmaxPolicy::sampleActions(const std::vector<size_t> & states, std::vector<size_t> * actions) const {
+        actions->resize(states.size());
+        if (caching_) {
+            for (size_t i = 0; i < states.size(); ++i)
+                (*actions)[i] = sampleProbability(A, getCachedRow(states[i]), rand_);
+            return;
+        }
+        for (size_t i = 0; i < states.size(); ++i) {
+            auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(states[i]), vbuffer_, bestActions_, rand_);
+            (*actions)[i] = wrap.sampleAction();
+        }
+    }
+
     double QSoftmaxPolicy::getActionProbability(const size_t & s, const size_t & a) const {
+        if (caching_) return getCachedRow(s)[a];
+
         auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer_, bestActions_, rand_);
         return wrap.getActionProbability(a);
     }
 
     Matrix2D QSoftmaxPolicy::getPolicy() const {
-        Matrix2D retval(S, A);
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void QSoftmaxPolicy::getPolicyInto(Matrix2D * out) const {
+        if (caching_) {
+            for (size_t s = 0; s < S; ++s)
+                getCachedRow(s);
+            *out = cache_;
+            return;
+        }
+
+        out->resize(S, A);
 
         for (size_t s = 0; s < S; ++s) {
             auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer_, bestActions_, rand_);
-            wrap.getPolicy(retval.row(s));
+            wrap.getPolicy(out->row(s));
+        }
+    }
+
+    void QSoftmaxPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        if (caching_) {
+            *out = getCachedRow(s);
+            return;
         }
 
-        return retval;
+        out->resize(A);
+        auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer_, bestActions_, rand_);
+        wrap.getPolicy(*out);
     }
 
     void QSoftmaxPolicy::setTemperature(const double t) {
         if ( t < 0.0 ) throw std::invalid_argument("Temperature must be >= 0");
         temperature_ = t;
+        invalidate();
     }
 
     double QSoftmaxPolicy::getTemperature() const {
         return temperature_;
     }
+
+    void QSoftmaxPolicy::setCaching(const bool caching) {
+        caching_ = caching;
+        if (caching_) {
+            cache_.resize(S, A);
+            cacheVersions_.assign(S, 0);
+        } else {
+            cache_.resize(0, 0);
+            cacheVersions_.clear();
+            cacheVersions_.shrink_to_fit();
+        }
+    }
+
+    bool QSoftmaxPolicy::isCaching() const {
+        return caching_;
+    }
+
+    void QSoftmaxPolicy::invalidate() {
+        ++version_;
+    }
+
+    void QSoftmaxPolicy::invalidate(const size_t s) {
+        if (caching_) cacheVersions_[s] = 0;
+    }
+
+    Matrix2D::ConstRowXpr QSoftmaxPolicy::getCachedRow(const size_t s) const {
+        if (cacheVersions_[s] != version_) {
+            auto wrap = Bandit::QSoftmaxPolicyWrapper(temperature_, q_.row(s), vbuffer_, bestActions_, rand_);
+            wrap.getPolicy(cache_.row(s));
+            cacheVersions_[s] = version_;
+        }
+        return std::as_const(cache_).row(s);
+    }
 }
@@ -9,13 +9,27 @@ namespace AIToolbox::MDP {
         return randomDistribution_(rand_);
     }
 
+    size_t RandomPolicy::sampleActionWith(const size_t &, RandomEngine & gen) const {
+        return std::uniform_int_distribution<size_t>(0, A-1)(gen);
+    }
+
     double RandomPolicy::getActionProbability(const size_t &, const size_t &) const {
         return 1.0/getA();
     }
 
     Matrix2D RandomPolicy::getPolicy() const {
-        Matrix2D p;
-        p.fill(1.0/getA());
-        return p;
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void RandomPolicy::getPolicyInto(Matrix2D * out) const {
+        out->resize(S, A);
+        out->fill(1.0/getA());
+    }
+
+    void RandomPolicy::getActionProbabilities(const size_t &, Vector * out) const {
+        out->resize(A);
+        out->fill(1.0/getA());
     }
 }
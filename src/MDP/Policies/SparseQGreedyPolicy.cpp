@@ -0,0 +1,52 @@
+#include <AIToolbox/MDP/Policies/SparseQGreedyPolicy.hpp>
+
+#include <AIToolbox/Bandit/Policies/Utils/QGreedyPolicyWrapper.hpp>
+
+namespace AIToolbox::MDP {
+    SparseQGreedyPolicy::SparseQGreedyPolicy(const SparseQFunction & q) :
+            PolicyInterface::Base(q.getS(), q.getA()), q_(q), bestActions_(getA()) {}
+
+    size_t SparseQGreedyPolicy::sampleAction(const size_t & s) const {
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.getRow(s), bestActions_, rand_);
+        return wrap.sampleAction();
+    }
+
+    size_t SparseQGreedyPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        // Each thread has its own buffer, shared between all instances.
+        thread_local std::vector<size_t> buffer;
+        buffer.resize(A);
+
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.getRow(s), buffer, gen);
+        return wrap.sampleAction();
+    }
+
+    double SparseQGreedyPolicy::getActionProbability(const size_t & s, const size_t & a) const {
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.getRow(s), bestActions_, rand_);
+        return wrap.getActionProbability(a);
+    }
+
+    void SparseQGreedyPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        out->resize(A);
+        auto wrap = Bandit::QGreedyPolicyWrapper(q_.getRow(s), bestActions_, rand_);
+        wrap.getPolicy(*out);
+    }
+
+    Matrix2D SparseQGreedyPolicy::getPolicy() const {
+        Matrix2D retval;
+        getPolicyInto(&retval);
+        return retval;
+    }
+
+    void SparseQGreedyPolicy::getPolicyInto(Matrix2D * out) const {
+        out->resize(S, A);
+
+        // States not stored all share the same (uniform) row.
+        out->fill(1.0 / A);
+        q_.forEachRow([&](const size_t s, const SparseQFunction::ConstRow & row) {
+            auto wrap = Bandit::QGreedyPolicyWrapper(row, bestActions_, rand_);
+            wrap.getPolicy(out->row(s));
+        });
+    }
+
+    const SparseQFunction & SparseQGreedyPolicy::getQFunction() const { return q_; }
+}
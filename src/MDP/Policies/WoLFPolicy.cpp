@@ -8,13 +8,16 @@ namespace AIToolbox::MDP {
             deltaW_(deltaw), deltaL_(deltal),
             scaling_(scaling), c_(S, 0),
             avgPolicyMatrix_(S,A), actualPolicyMatrix_(S,A),
-            avgPolicy_(avgPolicyMatrix_), actualPolicy_(actualPolicyMatrix_)
+            avgPolicy_(avgPolicyMatrix_), actualPolicy_(actualPolicyMatrix_),
+            bestActions_(A), isDirty_(S, false)
     {
         avgPolicyMatrix_.fill(1.0/A);
         actualPolicyMatrix_.fill(1.0/A);
     }
 
     void WoLFPolicy::stepUpdateP(const size_t s) {
+        markDirty(s);
+
         avgPolicyMatrix_.row(s) = avgPolicyMatrix_.row(s) * c_[s] + actualPolicyMatrix_.row(s);
         avgPolicyMatrix_.row(s) /= avgPolicyMatrix_.row(s).sum();
         ++c_[s];
@@ -22,18 +25,17 @@ namespace AIToolbox::MDP {
         size_t bestAction; double finalDelta;
         {
             unsigned bestActionCount = 1; double bestQValue = q_(s, 0);
-            // Automatically sets initial best action as bestAction[0] = 0
-            std::vector<size_t> bestActions(A,0);
+            bestActions_[0] = 0;
 
             for ( size_t a = 1; a < A; ++a ) {
                 const double qsa = q_(s, a);
 
                 if ( checkEqualGeneral(qsa, bestQValue) ) {
-                    bestActions[bestActionCount] = a;
+                    bestActions_[bestActionCount] = a;
                     ++bestActionCount;
                 }
                 else if ( qsa > bestQValue ) {
-                    bestActions[0] = a;
+                    bestActions_[0] = a;
                     bestActionCount = 1;
                     bestQValue = qsa;
                 }
@@ -44,7 +46,7 @@ namespace AIToolbox::MDP {
             auto pickDistribution = std::uniform_int_distribution<unsigned>(0, bestActionCount-1);
             const unsigned selection = pickDistribution(rand_);
 
-            bestAction = bestActions[selection];
+            bestAction = bestActions_[selection];
             finalDelta = actualValue > avgValue ? deltaW_ : deltaL_;
         }
 
@@ -60,6 +62,10 @@ namespace AIToolbox::MDP {
         return actualPolicy_.sampleAction(s);
     }
 
+    size_t WoLFPolicy::sampleActionWith(const size_t & s, RandomEngine & gen) const {
+        return actualPolicy_.sampleActionWith(s, gen);
+    }
+
     double WoLFPolicy::getActionProbability(const size_t & s, const size_t & a) const {
         return actualPolicy_.getActionProbability(s,a);
     }
@@ -68,6 +74,43 @@ namespace AIToolbox::MDP {
         return actualPolicy_.getPolicy();
     }
 
+    void WoLFPolicy::getPolicyInto(Matrix2D * out) const {
+        actualPolicy_.getPolicyInto(out);
+    }
+
+    void WoLFPolicy::getActionProbabilities(const size_t & s, Vector * out) const {
+        actualPolicy_.getActionProbabilities(s, out);
+    }
+
+    const PolicyWrapper::PolicyMatrix & WoLFPolicy::getPolicyMatrix() const {
+        return actualPolicyMatrix_;
+    }
+
+    const PolicyWrapper::PolicyMatrix & WoLFPolicy::getAveragePolicyMatrix() const {
+        return avgPolicyMatrix_;
+    }
+
+    const std::vector<unsigned> & WoLFPolicy::getUpdateCounts() const {
+        return c_;
+    }
+
+    const WoLFPolicy::DirtyStates & WoLFPolicy::getDirtyStates() const {
+        return dirty_;
+    }
+
+    void WoLFPolicy::clearDirtyStates() {
+        for ( const auto s : dirty_ )
+            isDirty_[s] = false;
+        dirty_.clear();
+    }
+
+    void WoLFPolicy::markDirty(const size_t s) {
+        if ( !isDirty_[s] ) {
+            isDirty_[s] = true;
+            dirty_.push_back(s);
+        }
+    }
+
     void WoLFPolicy::setDeltaW(const double deltaW) {
         deltaW_ = deltaW;
     }
@@ -0,0 +1,89 @@
+#include <AIToolbox/MDP/QFunctionPublisher.hpp>
+
+#include <stdexcept>
+
+namespace AIToolbox::MDP {
+    QFunctionPublisher::QFunctionPublisher(const QFunction & q, const unsigned cadence) :
+            q_(q), steps_(0), version_(0)
+    {
+        setCadence(cadence);
+        publish();
+    }
+
+    bool QFunctionPublisher::stepUpdate() {
+        if ( ++steps_ < cadence_ ) return false;
+
+        publish();
+        return true;
+    }
+
+    void QFunctionPublisher::publish() {
+        steps_ = 0;
+
+        // A buffer held only by us cannot be reached by readers anymore,
+        // since it is not current_, so we can overwrite it.
+        std::shared_ptr<QFunction> buffer;
+        for ( const auto & b : buffers_ ) {
+            if ( b.use_count() == 1 ) {
+                // Synchronizes with the release of the last reader which
+                // dropped the buffer, so its reads are done.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                buffer = b;
+                break;
+            }
+        }
+        if ( !buffer ) {
+            buffer = std::make_shared<QFunction>();
+            buffers_.push_back(buffer);
+        }
+
+        *buffer = q_;
+        std::atomic_store(&current_, std::shared_ptr<const QFunction>(std::move(buffer)));
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<const QFunction> QFunctionPublisher::getSnapshot() const {
+        return std::atomic_load(&current_);
+    }
+
+    unsigned long QFunctionPublisher::getVersion() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    void QFunctionPublisher::setCadence(const unsigned cadence) {
+        if ( cadence == 0 ) throw std::invalid_argument("Cadence must be > 0");
+        cadence_ = cadence;
+    }
+
+    unsigned QFunctionPublisher::getCadence() const {
+        return cadence_;
+    }
+
+    const QFunction & QFunctionPublisher::getQFunction() const {
+        return q_;
+    }
+
+    QFunctionReader::QFunctionReader(const QFunctionPublisher & publisher) :
+            publisher_(publisher), version_(publisher_.getVersion()),
+            q_(*publisher_.getSnapshot()) {}
+
+    bool QFunctionReader::refresh() {
+        const auto version = publisher_.getVersion();
+        if ( version == version_ ) return false;
+
+        // The snapshot may be newer than version; at worst we copy it
+        // again on the next refresh.
+        const auto snapshot = publisher_.getSnapshot();
+        q_ = *snapshot;
+        version_ = version;
+        return true;
+    }
+
+    const QFunction & QFunctionReader::getQFunction() const {
+        return q_;
+    }
+
+    unsigned long QFunctionReader::getVersion() const {
+        return version_;
+    }
+}
@@ -0,0 +1,42 @@
+#include <AIToolbox/MDP/ReachableModel.hpp>
+
+namespace AIToolbox::MDP {
+    const SparseModel & ReachableModel::getModel() const { return model_; }
+    size_t ReachableModel::getOriginalS() const { return originalS_; }
+    const std::vector<size_t> & ReachableModel::getStates() const { return states_; }
+    size_t ReachableModel::getCompactState(const size_t s) const { return index_[s]; }
+
+    ValueFunction ReachableModel::expand(const ValueFunction & vf) const {
+        if (static_cast<size_t>(vf.values.size()) != states_.size() || vf.actions.size() != states_.size())
+            throw std::invalid_argument("ValueFunction does not match the reachable states");
+
+        ValueFunction retval(Values::Zero(originalS_), Actions(originalS_, 0));
+        for (size_t i = 0; i < states_.size(); ++i) {
+            retval.values[states_[i]] = vf.values[i];
+            retval.actions[states_[i]] = vf.actions[i];
+        }
+        return retval;
+    }
+
+    QFunction ReachableModel::expand(const QFunction & q) const {
+        if (static_cast<size_t>(q.rows()) != states_.size())
+            throw std::invalid_argument("QFunction does not match the reachable states");
+
+        QFunction retval = QFunction::Zero(originalS_, q.cols());
+        for (size_t i = 0; i < states_.size(); ++i)
+            retval.row(states_[i]) = q.row(i);
+        return retval;
+    }
+
+    ValueFunction ReachableModel::compact(const ValueFunction & vf) const {
+        if (static_cast<size_t>(vf.values.size()) != originalS_ || vf.actions.size() != originalS_)
+            throw std::invalid_argument("ValueFunction does not match the original states");
+
+        ValueFunction retval(Values(states_.size()), Actions(states_.size()));
+        for (size_t i = 0; i < states_.size(); ++i) {
+            retval.values[i] = vf.values[states_[i]];
+            retval.actions[i] = vf.actions[states_[i]];
+        }
+        return retval;
+    }
+}
@@ -0,0 +1,98 @@
+#include <AIToolbox/MDP/ReplayBuffer.hpp>
+
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace AIToolbox::MDP {
+    ReplayBuffer::ReplayBuffer(const size_t capacity, const double exponent, const double epsilon) :
+            capacity_(capacity), size_(0), next_(0),
+            exponent_(exponent), epsilon_(epsilon), maxPriority_(1.0),
+            states_(capacity), actions_(capacity), nextStates_(capacity), rewards_(capacity),
+            priorities_(exponent > 0.0 ? capacity : 0),
+            rand_(Impl::Seeder::getSeed())
+    {
+        if ( capacity_ == 0 ) throw std::invalid_argument("Replay buffer capacity must be positive");
+        if ( exponent_ < 0.0 ) throw std::invalid_argument("Priority exponent must be >= 0");
+        if ( epsilon_ <= 0.0 ) throw std::invalid_argument("Priority epsilon must be > 0");
+    }
+
+    size_t ReplayBuffer::record(const size_t s, const size_t a, const size_t s1, const double rew) {
+        const auto id = next_;
+
+        states_[id] = s;
+        actions_[id] = a;
+        nextStates_[id] = s1;
+        rewards_[id] = rew;
+        if ( isPrioritized() ) priorities_.set(id, maxPriority_);
+
+        next_ = (next_ + 1) % capacity_;
+        if ( size_ < capacity_ ) ++size_;
+
+        return id;
+    }
+
+    void ReplayBuffer::sampleBatch(const size_t n, TransitionBatch * batch, std::vector<size_t> * ids) {
+        const size_t N = size_ ? n : 0;
+
+        batch->states.resize(N);
+        batch->actions.resize(N);
+        batch->nextStates.resize(N);
+        batch->nextActions.clear();
+        batch->rewards.resize(N);
+        if ( ids ) ids->resize(N);
+
+        if ( N == 0 ) return;
+
+        std::uniform_int_distribution<size_t> uniform(0, size_ - 1);
+        std::uniform_real_distribution<double> real(0.0, 1.0);
+        const double segment = isPrioritized() ? priorities_.getTotal() / N : 0.0;
+
+        for ( size_t i = 0; i < N; ++i ) {
+            const size_t id = isPrioritized() ? priorities_.find(segment * (i + real(rand_))) : uniform(rand_);
+
+            batch->states[i] = states_[id];
+            batch->actions[i] = actions_[id];
+            batch->nextStates[i] = nextStates_[id];
+            batch->rewards[i] = rewards_[id];
+            if ( ids ) (*ids)[i] = id;
+        }
+    }
+
+    void ReplayBuffer::updatePriorities(const std::vector<size_t> & ids, const std::vector<double> & tdErrors) {
+        if ( ids.size() != tdErrors.size() )
+            throw std::invalid_argument("Each updated transition must have a TD error");
+        if ( !isPrioritized() ) return;
+
+        for ( size_t i = 0; i < ids.size(); ++i ) {
+            const double p = std::pow(std::fabs(tdErrors[i]) + epsilon_, exponent_);
+            priorities_.set(ids[i], p);
+            maxPriority_ = std::max(maxPriority_, p);
+        }
+    }
+
+    double ReplayBuffer::getProbability(const size_t id) const {
+        if ( id >= size_ ) return 0.0;
+        if ( !isPrioritized() ) return 1.0 / size_;
+        return priorities_.get(id) / priorities_.getTotal();
+    }
+
+    void ReplayBuffer::clear() {
+        size_ = 0;
+        next_ = 0;
+        maxPriority_ = 1.0;
+        priorities_.clear();
+    }
+
+    size_t ReplayBuffer::size() const { return size_; }
+    size_t ReplayBuffer::getCapacity() const { return capacity_; }
+    double ReplayBuffer::getExponent() const { return exponent_; }
+    bool ReplayBuffer::isPrioritized() const { return exponent_ > 0.0; }
+
+    std::tuple<size_t, size_t, size_t, double> ReplayBuffer::getTransition(const size_t id) const {
+        return std::make_tuple(states_[id], actions_[id], nextStates_[id], rewards_[id]);
+    }
+}
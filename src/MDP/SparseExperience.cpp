@@ -1,49 +1,129 @@
 #include <AIToolbox/MDP/SparseExperience.hpp>
 
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+
 namespace AIToolbox::MDP {
+    namespace {
+        // Below this ratio between non-zeros and increments, adding the
+        // increments one by one is cheaper than rebuilding the matrix.
+        constexpr size_t MergeRatio = 16;
+
+        template <typename M, typename T>
+        void merge(M & matrix, const std::vector<Eigen::Triplet<T>> & increments) {
+            if ( increments.empty() ) return;
+            if ( increments.size() * MergeRatio < static_cast<size_t>(matrix.nonZeros()) ) {
+                for ( const auto & t : increments )
+                    matrix.coeffRef(t.row(), t.col()) += t.value();
+            } else {
+                M m(matrix.rows(), matrix.cols());
+                m.setFromTriplets(std::begin(increments), std::end(increments));
+                matrix += m;
+            }
+        }
+    }
+
     SparseExperience::SparseExperience(const size_t s, const size_t a) :
             S(s), A(a), visits_(A, SparseTable2D(S, S)),
             visitsSum_(SparseTable2D(S, A)), rewards_(A, SparseMatrix2D(S, S)),
-            rewardsSum_(SparseMatrix2D(S, A)) {}
+            rewardsSum_(SparseMatrix2D(S, A)),
+            isDirty_(S * A, false) {}
 
     void SparseExperience::record(const size_t s, const size_t a, const size_t s1, const double rew) {
-        visits_[a].coeffRef(s, s1)  += 1;
-        visitsSum_.coeffRef(s, a)   += 1;
+        auto & t = staged_[(a * S + s) * S + s1];
+        t.visits += 1;
+        t.reward += rew;
+
+        auto & sum = stagedSums_[s * A + a];
+        sum.visits += 1;
+        sum.reward += rew;
+
+        if ( !isDirty_[s * A + a] ) {
+            isDirty_[s * A + a] = true;
+            dirty_.emplace_back(s, a);
+        }
+    }
+
+    void SparseExperience::flush() const {
+        if ( staged_.empty() ) return;
+
+        std::vector<std::vector<Eigen::Triplet<long>>> visits(A);
+        std::vector<std::vector<Eigen::Triplet<double>>> rewards(A);
+        for ( const auto & [key, t] : staged_ ) {
+            const size_t s1 = key % S;
+            const size_t s  = (key / S) % S;
+            const size_t a  = key / S / S;
+            visits[a].emplace_back(s, s1, t.visits);
+            rewards[a].emplace_back(s, s1, t.reward);
+        }
+        for ( size_t a = 0; a < A; ++a ) {
+            merge(visits_[a], visits[a]);
+            merge(rewards_[a], rewards[a]);
+        }
 
-        rewards_[a].coeffRef(s, s1) += rew;
-        rewardsSum_.coeffRef(s, a)  += rew;
+        std::vector<Eigen::Triplet<long>> visitsSum;
+        std::vector<Eigen::Triplet<double>> rewardsSum;
+        visitsSum.reserve(stagedSums_.size());
+        rewardsSum.reserve(stagedSums_.size());
+        for ( const auto & [key, t] : stagedSums_ ) {
+            visitsSum.emplace_back(key / A, key % A, t.visits);
+            rewardsSum.emplace_back(key / A, key % A, t.reward);
+        }
+        merge(visitsSum_, visitsSum);
+        merge(rewardsSum_, rewardsSum);
+
+        staged_.clear();
+        stagedSums_.clear();
     }
 
     void SparseExperience::reset() {
+        staged_.clear();
+        stagedSums_.clear();
         for ( size_t a = 0; a < A; ++a ) {
             visits_[a].setZero();
             rewards_[a].setZero();
         }
         visitsSum_.setZero();
         rewardsSum_.setZero();
+        clearDirtyPairs();
     }
 
     unsigned long SparseExperience::getVisits(const size_t s, const size_t a, const size_t s1) const {
-        return visits_[a].coeff(s, s1);
+        const auto it = staged_.find((a * S + s) * S + s1);
+        return visits_[a].coeff(s, s1) + (it != staged_.end() ? it->second.visits : 0);
     }
 
     unsigned long SparseExperience::getVisitsSum(const size_t s, const size_t a) const {
-        return visitsSum_.coeff(s, a);
+        const auto it = stagedSums_.find(s * A + a);
+        return visitsSum_.coeff(s, a) + (it != stagedSums_.end() ? it->second.visits : 0);
     }
 
     double SparseExperience::getReward(const size_t s, const size_t a, const size_t s1) const {
-        return rewards_[a].coeff(s, s1);
+        const auto it = staged_.find((a * S + s) * S + s1);
+        return rewards_[a].coeff(s, s1) + (it != staged_.end() ? it->second.reward : 0.0);
     }
 
     double SparseExperience::getRewardSum(const size_t s, const size_t a) const {
-        return rewardsSum_.coeff(s, a);
+        const auto it = stagedSums_.find(s * A + a);
+        return rewardsSum_.coeff(s, a) + (it != stagedSums_.end() ? it->second.reward : 0.0);
+    }
+
+    const SparseExperience::DirtyPairs & SparseExperience::getDirtyPairs() const {
+        return dirty_;
+    }
+
+    void SparseExperience::clearDirtyPairs() {
+        for ( const auto & [s, a] : dirty_ )
+            isDirty_[s * A + a] = false;
+        dirty_.clear();
     }
 
     const SparseExperience::VisitTable & SparseExperience::getVisitTable() const {
+        flush();
         return visits_;
     }
 
     const SparseExperience::RewardMatrix & SparseExperience::getRewardMatrix() const {
+        flush();
         return rewards_;
     }
 
@@ -54,4 +134,11 @@ namespace AIToolbox::MDP {
     size_t SparseExperience::getA() const {
         return A;
     }
+
+    size_t SparseExperience::getMemoryUsage() const {
+        return heapUsage(visits_) + heapUsage(visitsSum_) +
+               heapUsage(rewards_) + heapUsage(rewardsSum_) +
+               heapUsage(staged_) + heapUsage(stagedSums_) +
+               heapUsage(dirty_) + isDirty_.capacity() / 8;
+    }
 }
@@ -1,11 +1,17 @@
 #include <AIToolbox/MDP/SparseModel.hpp>
 
+#include <algorithm>
+
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+
 namespace AIToolbox::MDP {
-    SparseModel::SparseModel(NoCheck, const size_t s, const size_t a, TransitionMatrix && t, RewardMatrix && r, const double d) :
+    template <typename Scalar>
+    BasicSparseModel<Scalar>::BasicSparseModel(NoCheck, const size_t s, const size_t a, TransitionMatrix && t, RewardMatrix && r, const double d) :
             S(s), A(a), discount_(d), transitions_(t), rewards_(r), rand_(Impl::Seeder::getSeed()) {}
 
-    SparseModel::SparseModel(const size_t s, const size_t a, const double discount) :
-            S(s), A(a), discount_(discount), transitions_(A, SparseMatrix2D(S, S)),
+    template <typename Scalar>
+    BasicSparseModel<Scalar>::BasicSparseModel(const size_t s, const size_t a, const double discount) :
+            S(s), A(a), discount_(discount), transitions_(A, BasicSparseMatrix2D<Scalar>(S, S)),
             rewards_(S, A), rand_(Impl::Seeder::getSeed())
     {
         // Make transition matrix true probability
@@ -13,16 +19,87 @@ namespace AIToolbox::MDP {
             transitions_[a].setIdentity();
     }
 
-    void SparseModel::setTransitionFunction(const SparseMatrix3D & t) {
+    template <typename Scalar>
+    BasicSparseModel<Scalar>::BasicSparseModel(const size_t s, const size_t a, const TransitionTriplets & t, const RewardTriplets & r, const double d, ThreadPool * pool) :
+            S(s), A(a), transitions_(A, BasicSparseMatrix2D<Scalar>(S, S)),
+            rewards_(S, A), rand_(Impl::Seeder::getSeed())
+    {
+        setDiscount(d);
+        if ( t.size() != A )
+            throw std::invalid_argument("There must be a list of transition triplets per action.");
+
+        for ( const auto & e : r )
+            if ( e.row() < 0 || static_cast<size_t>(e.row()) >= S || e.col() < 0 || static_cast<size_t>(e.col()) >= A )
+                throw std::invalid_argument("Reward triplet out of bounds.");
+
+        // Each action is built and checked independently; errors are
+        // rethrown once all threads are done.
+        std::vector<const char *> errors(A, nullptr);
+        const auto build = [&](const size_t begin, const size_t end) {
+            std::vector<char> hasRow;
+            for ( size_t a = begin; a < end; ++a ) {
+                hasRow.assign(S, false);
+                bool inBounds = true;
+                for ( const auto & e : t[a] ) {
+                    if ( e.row() < 0 || static_cast<size_t>(e.row()) >= S || e.col() < 0 || static_cast<size_t>(e.col()) >= S ) {
+                        inBounds = false;
+                        break;
+                    }
+                    hasRow[e.row()] = true;
+                }
+                if ( !inBounds ) {
+                    errors[a] = "Transition triplet out of bounds.";
+                    continue;
+                }
+
+                auto & m = transitions_[a];
+                // Rows without entries become self-loops; we only copy
+                // the list if there are any.
+                if ( std::find(std::begin(hasRow), std::end(hasRow), false) == std::end(hasRow) ) {
+                    m.setFromTriplets(std::begin(t[a]), std::end(t[a]));
+                } else {
+                    auto triplets = t[a];
+                    for ( size_t s = 0; s < S; ++s )
+                        if ( !hasRow[s] ) triplets.emplace_back(s, s, 1.0);
+                    m.setFromTriplets(std::begin(triplets), std::end(triplets));
+                }
+                m.makeCompressed();
+
+                for ( size_t s = 0; s < S; ++s ) {
+                    double sum = 0.0;
+                    bool negative = false;
+                    for ( typename BasicSparseMatrix2D<Scalar>::InnerIterator it(m, s); it; ++it ) {
+                        sum += it.value();
+                        negative |= it.value() < 0.0;
+                    }
+                    if ( negative || !checkEqualSmall(1.0, sum) ) {
+                        errors[a] = "Input transition matrix does not contain valid probabilities.";
+                        break;
+                    }
+                }
+            }
+        };
+        if ( pool ) pool->parallelFor(A, build);
+        else        build(0, A);
+
+        for ( const auto e : errors )
+            if ( e ) throw std::invalid_argument(e);
+
+        rewards_.setFromTriplets(std::begin(r), std::end(r));
+        rewards_.makeCompressed();
+    }
+
+    template <typename Scalar>
+    void BasicSparseModel<Scalar>::setTransitionFunction(const TransitionMatrix & t) {
         // First we verify data, without modifying anything...
         for ( size_t a = 0; a < A; ++a ) {
             // Eigen sparse does not implement minCoeff so we can't check for negatives.
             // So we force the matrix to its abs, and if then the sum goes haywire then
             // we found an error.
             for ( size_t s = 0; s < S; ++s ) {
-                if ( !checkEqualSmall(1.0, t[a].row(s).sum()) )
+                if ( !checkEqualSmall(1.0, t[a].row(s).template cast<double>().sum()) )
                     throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
-                if ( !checkEqualSmall(1.0, t[a].row(s).cwiseAbs().sum()) )
+                if ( !checkEqualSmall(1.0, t[a].row(s).cwiseAbs().template cast<double>().sum()) )
                     throw std::invalid_argument("Input transition matrix does not contain valid probabilities.");
             }
         }
@@ -30,42 +107,67 @@ namespace AIToolbox::MDP {
         transitions_ = t;
     }
 
-    void SparseModel::setRewardFunction(const RewardMatrix & r) {
+    template <typename Scalar>
+    void BasicSparseModel<Scalar>::setRewardFunction(const RewardMatrix & r) {
         rewards_ = r;
     }
 
-    std::tuple<size_t, double> SparseModel::sampleSR(const size_t s, const size_t a) const {
-        const size_t s1 = sampleProbability(S, transitions_[a].row(s), rand_);
+    template <typename Scalar>
+    std::tuple<size_t, double> BasicSparseModel<Scalar>::sampleSR(const size_t s, const size_t a) const {
+        return sampleSR(s, a, rand_);
+    }
+
+    template <typename Scalar>
+    std::tuple<size_t, double> BasicSparseModel<Scalar>::sampleSR(const size_t s, const size_t a, RandomEngine & rnd) const {
+        const size_t s1 = sampleProbability(S, transitions_[a].row(s), rnd);
 
         return std::make_tuple(s1, getExpectedReward(s, a, s1));
     }
 
-    double SparseModel::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
+    template <typename Scalar>
+    double BasicSparseModel<Scalar>::getTransitionProbability(const size_t s, const size_t a, const size_t s1) const {
         return transitions_[a].coeff(s, s1);
     }
 
-    double SparseModel::getExpectedReward(const size_t s, const size_t a, const size_t) const {
+    template <typename Scalar>
+    double BasicSparseModel<Scalar>::getExpectedReward(const size_t s, const size_t a, const size_t) const {
         return rewards_.coeff(s, a);
     }
 
-    void SparseModel::setDiscount(const double d) {
+    template <typename Scalar>
+    void BasicSparseModel<Scalar>::setDiscount(const double d) {
         if ( d <= 0.0 || d > 1.0 ) throw std::invalid_argument("Discount parameter must be in (0,1]");
         discount_ = d;
     }
 
-    bool SparseModel::isTerminal(const size_t s) const {
+    template <typename Scalar>
+    bool BasicSparseModel<Scalar>::isTerminal(const size_t s) const {
         for ( size_t a = 0; a < A; ++a )
             if ( !checkEqualSmall(1.0, getTransitionProbability(s, a, s)) )
                 return false;
         return true;
     }
 
-    size_t SparseModel::getS() const { return S; }
-    size_t SparseModel::getA() const { return A; }
-    double SparseModel::getDiscount() const { return discount_; }
+    template <typename Scalar>
+    size_t BasicSparseModel<Scalar>::getMemoryUsage() const {
+        return heapUsage(transitions_) + heapUsage(rewards_);
+    }
+
+    template <typename Scalar>
+    size_t BasicSparseModel<Scalar>::getS() const { return S; }
+    template <typename Scalar>
+    size_t BasicSparseModel<Scalar>::getA() const { return A; }
+    template <typename Scalar>
+    double BasicSparseModel<Scalar>::getDiscount() const { return discount_; }
+
+    template <typename Scalar>
+    const typename BasicSparseModel<Scalar>::TransitionMatrix & BasicSparseModel<Scalar>::getTransitionFunction() const { return transitions_; }
+    template <typename Scalar>
+    const typename BasicSparseModel<Scalar>::RewardMatrix &     BasicSparseModel<Scalar>::getRewardFunction()     const { return rewards_; }
 
-    const SparseModel::TransitionMatrix & SparseModel::getTransitionFunction() const { return transitions_; }
-    const SparseModel::RewardMatrix &     SparseModel::getRewardFunction()     const { return rewards_; }
+    template <typename Scalar>
+    const BasicSparseMatrix2D<Scalar> & BasicSparseModel<Scalar>::getTransitionFunction(const size_t a) const { return transitions_[a]; }
 
-    const SparseMatrix2D & SparseModel::getTransitionFunction(const size_t a) const { return transitions_[a]; }
+    template class BasicSparseModel<double>;
+    template class BasicSparseModel<float>;
 }
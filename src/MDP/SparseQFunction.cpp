@@ -0,0 +1,112 @@
+#include <AIToolbox/MDP/SparseQFunction.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace AIToolbox::MDP {
+    namespace {
+        constexpr size_t MinCapacity = 16;
+
+        // The splitmix64 finalizer, so that states which are close or
+        // share low bits still spread over the table.
+        size_t hashState(const size_t s) {
+            std::uint64_t x = s;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(x ^ (x >> 31));
+        }
+    }
+
+    SparseQFunction::SparseQFunction(const size_t s, const size_t a, const double initialValue) :
+            S(s), A(a), initialValue_(initialValue), size_(0), mask_(MinCapacity - 1),
+            keys_(MinCapacity, Empty), values_(MinCapacity * A),
+            defaultRow_(Vector::Constant(A, initialValue)) {}
+
+    size_t SparseQFunction::findSlot(const size_t s) const {
+        size_t i = hashState(s) & mask_;
+        while (keys_[i] != Empty && keys_[i] != s)
+            i = (i + 1) & mask_;
+        return i;
+    }
+
+    void SparseQFunction::rehash(const size_t capacity) {
+        std::vector<size_t> keys(capacity, Empty);
+        std::vector<double> values(capacity * A);
+
+        std::swap(keys, keys_);
+        std::swap(values, values_);
+        mask_ = capacity - 1;
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == Empty) continue;
+            const size_t slot = findSlot(keys[i]);
+            keys_[slot] = keys[i];
+            std::copy(values.data() + i * A, values.data() + (i + 1) * A, values_.data() + slot * A);
+        }
+    }
+
+    SparseQFunction::ConstRow SparseQFunction::getRow(const size_t s) const {
+        const size_t slot = findSlot(s);
+        if (keys_[slot] == Empty)
+            return ConstRow(defaultRow_.data(), A);
+        return ConstRow(values_.data() + slot * A, A);
+    }
+
+    SparseQFunction::Row SparseQFunction::getRowRef(const size_t s) {
+        size_t slot = findSlot(s);
+        if (keys_[slot] == Empty) {
+            // We keep the table at most half full, so probes stay short.
+            if (2 * (size_ + 1) > keys_.size()) {
+                rehash(2 * keys_.size());
+                slot = findSlot(s);
+            }
+            keys_[slot] = s;
+            std::fill(values_.data() + slot * A, values_.data() + (slot + 1) * A, initialValue_);
+            ++size_;
+        }
+        return Row(values_.data() + slot * A, A);
+    }
+
+    double SparseQFunction::getValue(const size_t s, const size_t a) const {
+        const size_t slot = findSlot(s);
+        return keys_[slot] == Empty ? initialValue_ : values_[slot * A + a];
+    }
+
+    double & SparseQFunction::getValueRef(const size_t s, const size_t a) {
+        return getRowRef(s)[a];
+    }
+
+    bool SparseQFunction::contains(const size_t s) const {
+        return keys_[findSlot(s)] != Empty;
+    }
+
+    void SparseQFunction::reserve(const size_t states) {
+        size_t capacity = keys_.size();
+        while (capacity < 2 * states) capacity *= 2;
+        if (capacity != keys_.size())
+            rehash(capacity);
+    }
+
+    void SparseQFunction::clear() {
+        std::fill(std::begin(keys_), std::end(keys_), Empty);
+        size_ = 0;
+    }
+
+    QFunction SparseQFunction::toDense() const {
+        QFunction retval = QFunction::Constant(S, A, initialValue_);
+        forEachRow([&](const size_t s, const ConstRow & row) {
+            retval.row(s) = row;
+        });
+        return retval;
+    }
+
+    size_t SparseQFunction::size() const { return size_; }
+
+    size_t SparseQFunction::getMemoryUsage() const {
+        return keys_.capacity() * sizeof(size_t) + values_.capacity() * sizeof(double) + A * sizeof(double);
+    }
+
+    double SparseQFunction::getInitialValue() const { return initialValue_; }
+    size_t SparseQFunction::getS() const { return S; }
+    size_t SparseQFunction::getA() const { return A; }
+}
@@ -2,7 +2,89 @@
 
 #include <AIToolbox/MDP/Policies/Policy.hpp>
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
 namespace AIToolbox::MDP {
+    namespace {
+        // Number of rows processed together by the max/argmax kernels.
+        constexpr size_t BellmanBlock = 8;
+
+        /**
+         * @brief This function computes the max and argmax of a range of rows of a QFunction with A actions.
+         *
+         * Since the QFunction is row-major, a block of rows is a contiguous
+         * chunk of memory. We transpose it into a small buffer so that each
+         * action becomes a contiguous column of BellmanBlock values, and
+         * then do the compare/select over all rows of the block at once,
+         * which the compiler turns into SIMD compares and blends.
+         *
+         * Ties are resolved in favour of the lowest action, as maxCoeff()
+         * does.
+         */
+        template <size_t A>
+        void bellmanRows(const double * q, const size_t begin, const size_t end, double * values, size_t * actions) {
+            size_t s = begin;
+            for ( ; s + BellmanBlock <= end; s += BellmanBlock ) {
+                const double * block = q + s * A;
+
+                double buffer[A][BellmanBlock];
+                for ( size_t i = 0; i < BellmanBlock; ++i )
+                    for ( size_t a = 0; a < A; ++a )
+                        buffer[a][i] = block[i * A + a];
+
+                double best[BellmanBlock];
+                size_t bestA[BellmanBlock];
+                for ( size_t i = 0; i < BellmanBlock; ++i ) {
+                    best[i] = buffer[0][i];
+                    bestA[i] = 0;
+                }
+                for ( size_t a = 1; a < A; ++a ) {
+                    for ( size_t i = 0; i < BellmanBlock; ++i ) {
+                        const bool greater = buffer[a][i] > best[i];
+                        best[i]  = greater ? buffer[a][i] : best[i];
+                        bestA[i] = greater ? a : bestA[i];
+                    }
+                }
+                for ( size_t i = 0; i < BellmanBlock; ++i ) {
+                    values[s + i] = best[i];
+                    actions[s + i] = bestA[i];
+                }
+            }
+            for ( ; s < end; ++s ) {
+                const double * row = q + s * A;
+                size_t bestA = 0;
+                for ( size_t a = 1; a < A; ++a )
+                    if ( row[a] > row[bestA] ) bestA = a;
+                values[s] = row[bestA];
+                actions[s] = bestA;
+            }
+        }
+
+        using BellmanKernel = void(*)(const double *, size_t, size_t, double *, size_t *);
+
+        template <size_t... As>
+        constexpr std::array<BellmanKernel, sizeof...(As)> makeBellmanKernels(std::index_sequence<As...>) {
+            return {{ &bellmanRows<As + 1>... }};
+        }
+
+        // Specialized kernels for 1 to 16 actions.
+        constexpr auto bellmanKernels = makeBellmanKernels(std::make_index_sequence<16>());
+
+        void bellmanOperatorRows(const QFunction & q, const size_t begin, const size_t end, Values & values, Actions & actions) {
+            const size_t A = q.cols();
+            if ( A > 0 && A <= bellmanKernels.size() ) {
+                bellmanKernels[A - 1](q.data(), begin, end, values.data(), actions.data());
+                return;
+            }
+            for ( size_t s = begin; s < end; ++s )
+                values(s) = q.row(s).maxCoeff(&actions[s]);
+        }
+    }
+
     QFunction makeQFunction(const size_t S, const size_t A) {
         auto retval = QFunction(S, A);
         retval.setZero();
@@ -23,11 +105,52 @@ namespace AIToolbox::MDP {
     }
 
     void bellmanOperatorInline(const QFunction & q, ValueFunction * v) {
+        assert(v);
+        bellmanOperatorRows(q, 0, v->actions.size(), v->values, v->actions);
+    }
+
+    void bellmanOperatorInline(const QFunction & q, ValueFunction * v, ThreadPool & pool) {
         assert(v);
         auto & values  = v->values;
         auto & actions = v->actions;
 
-        for ( size_t s = 0; s < actions.size(); ++s )
-            values(s) = q.row(s).maxCoeff(&actions[s]);
+        pool.parallelFor(actions.size(), [&](const size_t begin, const size_t end) {
+            bellmanOperatorRows(q, begin, end, values, actions);
+        });
+    }
+
+    size_t checkTransitionBatch(const TransitionBatch & batch, const bool withNextActions) {
+        const size_t N = batch.states.size();
+        if ( batch.actions.size() != N || batch.nextStates.size() != N || batch.rewards.size() != N )
+            throw std::invalid_argument("Transition batch arrays have different sizes.");
+        if ( withNextActions && batch.nextActions.size() != N )
+            throw std::invalid_argument("Transition batch does not contain the next actions.");
+        return N;
+    }
+
+    void sortTransitionBatch(TransitionBatch * batch) {
+        assert(batch);
+        const size_t N = checkTransitionBatch(*batch);
+        const bool withNextActions = batch->nextActions.size() == N;
+
+        std::vector<size_t> order(N);
+        std::iota(std::begin(order), std::end(order), 0);
+        std::stable_sort(std::begin(order), std::end(order), [batch](const size_t lhs, const size_t rhs) {
+            if ( batch->states[lhs] != batch->states[rhs] ) return batch->states[lhs] < batch->states[rhs];
+            return batch->actions[lhs] < batch->actions[rhs];
+        });
+
+        auto permute = [&order, N](auto & v) {
+            std::remove_reference_t<decltype(v)> sorted(N);
+            for ( size_t i = 0; i < N; ++i )
+                sorted[i] = v[order[i]];
+            v = std::move(sorted);
+        };
+
+        permute(batch->states);
+        permute(batch->actions);
+        permute(batch->nextStates);
+        permute(batch->rewards);
+        if ( withNextActions ) permute(batch->nextActions);
     }
 }
@@ -2,7 +2,7 @@
 
 namespace AIToolbox::POMDP {
     BlindStrategies::BlindStrategies(const unsigned horizon, const double tolerance) :
-            horizon_(horizon)
+            horizon_(horizon), pool_(nullptr)
     {
         setTolerance(tolerance);
     }
@@ -16,6 +16,11 @@ namespace AIToolbox::POMDP {
         horizon_ = h;
     }
 
+    void BlindStrategies::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     double BlindStrategies::getTolerance()   const { return tolerance_; }
     unsigned BlindStrategies::getHorizon() const { return horizon_; }
+    ThreadPool * BlindStrategies::getThreadPool() const { return pool_; }
 }
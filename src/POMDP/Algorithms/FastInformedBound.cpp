@@ -2,7 +2,7 @@
 
 namespace AIToolbox::POMDP {
     FastInformedBound::FastInformedBound(const unsigned horizon, const double tolerance) :
-            horizon_(horizon)
+            horizon_(horizon), pool_(nullptr)
     {
         setTolerance(tolerance);
     }
@@ -16,6 +16,11 @@ namespace AIToolbox::POMDP {
         horizon_ = h;
     }
 
+    void FastInformedBound::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     double FastInformedBound::getTolerance()   const { return tolerance_; }
     unsigned FastInformedBound::getHorizon() const { return horizon_; }
+    ThreadPool * FastInformedBound::getThreadPool() const { return pool_; }
 }
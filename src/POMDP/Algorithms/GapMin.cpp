@@ -1,10 +1,14 @@
 #include <AIToolbox/POMDP/Algorithms/GapMin.hpp>
 
+#include <atomic>
+#include <limits>
+
 #include <AIToolbox/LP.hpp>
 
 namespace AIToolbox::POMDP {
     GapMin::GapMin(const double initialTolerance, const unsigned digits) :
-        precisionDigits_(digits)
+        precisionDigits_(digits), interpolation_(Interpolation::LP), pool_(nullptr),
+        checkpointInterval_(1)
     {
         setInitialTolerance(initialTolerance);
     }
@@ -26,6 +30,32 @@ namespace AIToolbox::POMDP {
         return precisionDigits_;
     }
 
+    void GapMin::setInterpolation(const Interpolation interpolation) {
+        interpolation_ = interpolation;
+    }
+
+    GapMin::Interpolation GapMin::getInterpolation() const {
+        return interpolation_;
+    }
+
+    void GapMin::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    ThreadPool * GapMin::getThreadPool() const {
+        return pool_;
+    }
+
+    void GapMin::setCheckpointCallback(CheckpointCallback callback, const unsigned interval) {
+        if ( interval == 0 ) throw std::invalid_argument("Checkpoint interval must be > 0");
+        checkpoint_ = std::move(callback);
+        checkpointInterval_ = interval;
+    }
+
+    unsigned GapMin::getCheckpointInterval() const {
+        return checkpointInterval_;
+    }
+
     bool GapMin::QueueElementLess::operator() (const QueueElement& arg1, const QueueElement& arg2) const
     {
         return std::get<1>(arg1) < std::get<1>(arg2);
@@ -121,7 +151,31 @@ namespace AIToolbox::POMDP {
         fibQ = std::move(newFibQ);
     }
 
-    std::tuple<double, Vector> GapMin::UB(const Belief & belief, const MDP::QFunction & ubQ, const UbVType & ubV) {
+    std::vector<std::tuple<double, Vector>> GapMin::UB(const std::vector<Belief> & beliefs, const MDP::QFunction & ubQ, const UbVType & ubV) const {
+        std::vector<std::tuple<double, Vector>> retval(beliefs.size());
+
+        // Work passed to the ThreadPool must not throw, so we rethrow any
+        // LP failure once all beliefs are done.
+        std::atomic<bool> failed(false);
+        const auto bound = [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                try {
+                    retval[i] = UB(beliefs[i], ubQ, ubV);
+                } catch (const std::runtime_error &) {
+                    failed = true;
+                }
+            }
+        };
+        if ( pool_ ) pool_->parallelFor(beliefs.size(), bound);
+        else bound(0, beliefs.size());
+
+        if (failed)
+            throw std::runtime_error("GapMin UB process failed!");
+
+        return retval;
+    }
+
+    std::tuple<double, Vector> GapMin::UB(const Belief & belief, const MDP::QFunction & ubQ, const UbVType & ubV) const {
         // Here we find all beliefs that have the same "zeroes" as the input one.
         // This is done to reduce the amount of work the LP has to do.
         std::vector<size_t> zeroStates;
@@ -177,6 +231,31 @@ namespace AIToolbox::POMDP {
             result[0] = (belief.cwiseQuotient(compBelief)).minCoeff();
 
             unscaledValue = result[0] * (ubV.second[compatibleBeliefs[0]] - compBelief.transpose() * cornerVals);
+        } else if (interpolation_ == Interpolation::Sawtooth) {
+            /*
+             * Here we do the same as above for each compatible belief, and we
+             * keep the one which lowers the bound the most. If none lowers it,
+             * we only use the corners.
+             */
+            result.setZero(compatibleBeliefs.size());
+            unscaledValue = 0.0;
+
+            for (size_t i = 0; i < compatibleBeliefs.size(); ++i) {
+                const auto & compBelief = ubV.first[compatibleBeliefs[i]];
+
+                // Compatible beliefs are zero wherever the input is, so we
+                // only need to check the non-zero states.
+                double c = std::numeric_limits<double>::infinity();
+                for (const auto s : nonZeroStates)
+                    c = std::min(c, belief[s] / compBelief[s]);
+
+                const double v = c * (ubV.second[compatibleBeliefs[i]] - compBelief.transpose() * cornerVals);
+                if (v < unscaledValue) {
+                    result.setZero();
+                    result[i] = c;
+                    unscaledValue = v;
+                }
+            }
         } else {
             /*
              * Here we run the LP.
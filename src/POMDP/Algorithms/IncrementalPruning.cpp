@@ -1,8 +1,22 @@
 #include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
 
+#include <numeric>
+
 namespace AIToolbox::POMDP {
+    namespace {
+        // Views a row of the cross-sum arena as a Vector. This is not a
+        // lambda so that the transform iterators using it are assignable,
+        // as the Pruner requires.
+        struct ArenaRow {
+            const Matrix2D * arena;
+            Eigen::Map<const Vector> operator()(const size_t k) const {
+                return Eigen::Map<const Vector>(arena->row(k).data(), arena->cols());
+            }
+        };
+    }
+
     IncrementalPruning::IncrementalPruning(const unsigned h, const double t) :
-            horizon_(h)
+            horizon_(h), pool_(nullptr), checkpointInterval_(1)
     {
         setTolerance(t);
     }
@@ -14,6 +28,14 @@ namespace AIToolbox::POMDP {
         if ( t < 0.0 ) throw std::invalid_argument("Tolerance must be >= 0");
         tolerance_ = t;
     }
+    void IncrementalPruning::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+    void IncrementalPruning::setCheckpointCallback(CheckpointCallback callback, const unsigned interval) {
+        if ( interval == 0 ) throw std::invalid_argument("Checkpoint interval must be > 0");
+        checkpoint_ = std::move(callback);
+        checkpointInterval_ = interval;
+    }
 
     unsigned IncrementalPruning::getHorizon() const {
         return horizon_;
@@ -23,40 +45,60 @@ namespace AIToolbox::POMDP {
         return tolerance_;
     }
 
-    VList IncrementalPruning::crossSum(const VList & l1, const VList & l2, const size_t a, const bool order) {
+    ThreadPool * IncrementalPruning::getThreadPool() const {
+        return pool_;
+    }
+
+    unsigned IncrementalPruning::getCheckpointInterval() const {
+        return checkpointInterval_;
+    }
+
+    VList IncrementalPruning::crossSum(const VList & l1, const VList & l2, const size_t a, const bool order, Pruner & prune, Matrix2D & arena) {
         VList c;
 
         if ( !(l1.size() && l2.size()) ) return c;
 
+        const size_t N2 = l2.size();
+        const size_t N = l1.size() * N2;
+        if ( static_cast<size_t>(arena.rows()) < N || static_cast<size_t>(arena.cols()) != S )
+            arena.resize(std::max(N, static_cast<size_t>(arena.rows())), S);
+
+        // Cross sum; the row i*N2+j is the sum of l1[i] and l2[j].
+        for ( size_t i = 0, k = 0; i < l1.size(); ++i )
+            for ( size_t j = 0; j < N2; ++j, ++k )
+                arena.row(k) = (l1[i].values + l2[j].values).transpose();
+
+        // The prune only swaps the indices, while reading the rows.
+        std::vector<size_t> ids(N);
+        std::iota(std::begin(ids), std::end(ids), 0);
+        const ArenaRow row{&arena};
+        const auto begin = boost::make_transform_iterator(std::begin(ids), row);
+        const auto end   = boost::make_transform_iterator(std::end  (ids), row);
+        const auto kept  = std::distance(std::begin(ids), prune(begin, end).base());
+
         // We can get the sizes of the observation vectors
         // outside since all VEntries for our input VLists
         // are guaranteed to be sized equally.
         const auto O1size  = l1[0].observations.size();
         const auto O2size  = l2[0].observations.size();
-        for ( const auto & v1 : l1 ) {
-            const auto O1begin = std::begin(v1.observations);
-            const auto O1end   = std::end  (v1.observations);
-            for ( const auto & v2 : l2 ) {
-                const auto O2begin = std::begin(v2.observations);
-                const auto O2end   = std::end  (v2.observations);
-                // Cross sum
-                auto v = v1.values + v2.values;
-
-                // This step now depends on which order the two lists
-                // are. This function is only used in this class, so we
-                // know that the two lists are "adjacent"; however one
-                // is after the other. `order` tells us which one comes
-                // first, and we join the observation vectors accordingly.
-                VObs obs; obs.reserve(O1size + O2size);
-                if ( order ) {
-                    obs.insert(std::end(obs), O1begin, O1end);
-                    obs.insert(std::end(obs), O2begin, O2end);
-                } else {
-                    obs.insert(std::end(obs), O2begin, O2end);
-                    obs.insert(std::end(obs), O1begin, O1end);
-                }
-                c.emplace_back(std::move(v), a, std::move(obs));
-            }
+
+        c.reserve(kept);
+        for ( auto it = std::begin(ids); it != std::begin(ids) + kept; ++it ) {
+            const auto & v1 = l1[*it / N2];
+            const auto & v2 = l2[*it % N2];
+
+            // This step now depends on which order the two lists
+            // are. This function is only used in this class, so we
+            // know that the two lists are "adjacent"; however one
+            // is after the other. `order` tells us which one comes
+            // first, and we join the observation vectors accordingly.
+            VObs obs; obs.reserve(O1size + O2size);
+            const auto & first  = order ? v1 : v2;
+            const auto & second = order ? v2 : v1;
+            obs.insert(std::end(obs), std::begin(first.observations),  std::end(first.observations));
+            obs.insert(std::end(obs), std::begin(second.observations), std::end(second.observations));
+
+            c.emplace_back(row(*it), a, std::move(obs));
         }
 
         return c;
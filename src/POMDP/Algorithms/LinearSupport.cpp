@@ -9,7 +9,7 @@ namespace AIToolbox::POMDP {
 
     // -----
 
-    LinearSupport::LinearSupport(const unsigned h, const double t) : horizon_(h) {
+    LinearSupport::LinearSupport(const unsigned h, const double t) : horizon_(h), pool_(nullptr) {
         setTolerance(t);
     }
 
@@ -21,6 +21,10 @@ namespace AIToolbox::POMDP {
         tolerance_ = t;
     }
 
+    void LinearSupport::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     unsigned LinearSupport::getHorizon() const {
         return horizon_;
     }
@@ -28,4 +32,8 @@ namespace AIToolbox::POMDP {
     double LinearSupport::getTolerance() const {
         return tolerance_;
     }
+
+    ThreadPool * LinearSupport::getThreadPool() const {
+        return pool_;
+    }
 }
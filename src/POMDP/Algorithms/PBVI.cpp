@@ -4,7 +4,7 @@
 
 namespace AIToolbox::POMDP {
     PBVI::PBVI(const size_t nBeliefs, const unsigned h, const double t) :
-            beliefSize_(nBeliefs), horizon_(h), rand_(Impl::Seeder::getSeed())
+            beliefSize_(nBeliefs), horizon_(h), pool_(nullptr), rand_(Impl::Seeder::getSeed())
     {
         setTolerance(t);
     }
@@ -22,7 +22,15 @@ namespace AIToolbox::POMDP {
         beliefSize_ = nBeliefs;
     }
 
+    void PBVI::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
     double PBVI::getTolerance() const { return tolerance_; }
     unsigned PBVI::getHorizon() const { return horizon_; }
     size_t PBVI::getBeliefSize() const { return beliefSize_; }
+    ThreadPool * PBVI::getThreadPool() const { return pool_; }
+
+    template std::tuple<double, ValueFunction> PBVI::operator()(const Model<MDP::Model> &, ValueFunction);
+    template std::tuple<double, ValueFunction> PBVI::operator()(const SparseModel<MDP::SparseModel> &, ValueFunction);
 }
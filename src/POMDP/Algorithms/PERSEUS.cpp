@@ -4,7 +4,7 @@
 
 namespace AIToolbox::POMDP {
     PERSEUS::PERSEUS(const size_t nBeliefs, const unsigned h, const double t) :
-            beliefSize_(nBeliefs), horizon_(h),
+            beliefSize_(nBeliefs), horizon_(h), pool_(nullptr), checkpointInterval_(1),
             rand_(Impl::Seeder::getSeed())
     {
         setTolerance(t);
@@ -23,7 +23,19 @@ namespace AIToolbox::POMDP {
         beliefSize_ = nBeliefs;
     }
 
+    void PERSEUS::setThreadPool(ThreadPool * pool) {
+        pool_ = pool;
+    }
+
+    void PERSEUS::setCheckpointCallback(CheckpointCallback callback, const unsigned interval) {
+        if ( interval == 0 ) throw std::invalid_argument("Checkpoint interval must be > 0");
+        checkpoint_ = std::move(callback);
+        checkpointInterval_ = interval;
+    }
+
     double PERSEUS::getTolerance() const { return tolerance_; }
     unsigned PERSEUS::getHorizon() const { return horizon_; }
     size_t PERSEUS::getBeliefSize() const { return beliefSize_; }
+    ThreadPool * PERSEUS::getThreadPool() const { return pool_; }
+    unsigned PERSEUS::getCheckpointInterval() const { return checkpointInterval_; }
 }
@@ -0,0 +1,6 @@
+#include <AIToolbox/POMDP/Algorithms/POMCP.hpp>
+
+namespace AIToolbox::POMDP {
+    template class POMCP<Model<MDP::Model>>;
+    template class POMCP<SparseModel<MDP::SparseModel>>;
+}
@@ -0,0 +1,6 @@
+#include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
+
+namespace AIToolbox::POMDP {
+    template class Projecter<Model<MDP::Model>>;
+    template class Projecter<SparseModel<MDP::SparseModel>>;
+}
@@ -0,0 +1,95 @@
+#include <AIToolbox/POMDP/BeliefUpdateCache.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/functional/hash.hpp>
+
+namespace AIToolbox::POMDP {
+    BeliefUpdateCache::BeliefUpdateCache(const size_t s, const size_t maxSize, const double resolution, const size_t shards, Updater updater) :
+            S(s), maxSize_(maxSize), resolution_(resolution),
+            updater_(std::move(updater)), hits_(0), misses_(0)
+    {
+        if ( resolution_ <= 0.0 ) throw std::invalid_argument("Belief resolution must be positive");
+        if ( shards == 0 ) throw std::invalid_argument("BeliefUpdateCache needs at least one shard");
+
+        shards_ = std::vector<Shard>(shards);
+        shardSize_ = (maxSize_ + shards - 1) / shards;
+    }
+
+    std::shared_ptr<const BeliefUpdateCache::Entry> BeliefUpdateCache::update(const Belief & b, const size_t a, const size_t o) const {
+        if ( !maxSize_ ) {
+            ++misses_;
+            return compute(b, a, o);
+        }
+
+        Key key{std::vector<long long>(S), a, o, 0};
+        for ( size_t s = 0; s < S; ++s )
+            key.belief[s] = std::llround(b[s] / resolution_);
+        key.hash = boost::hash_range(std::begin(key.belief), std::end(key.belief));
+        boost::hash_combine(key.hash, a);
+        boost::hash_combine(key.hash, o);
+
+        auto & shard = shards_[key.hash % shards_.size()];
+        {
+            std::lock_guard lock(shard.mutex);
+            const auto it = shard.entries.find(key);
+            if ( it != std::end(shard.entries) ) {
+                ++hits_;
+                shard.lru.splice(std::begin(shard.lru), shard.lru, it->second);
+                return it->second->second;
+            }
+        }
+
+        ++misses_;
+        auto entry = compute(b, a, o);
+
+        std::lock_guard lock(shard.mutex);
+        // Another thread may have computed the same update in the meantime.
+        if ( shard.entries.find(key) != std::end(shard.entries) )
+            return entry;
+
+        if ( shard.lru.size() >= shardSize_ ) {
+            shard.entries.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+        }
+        shard.lru.emplace_front(key, entry);
+        shard.entries.emplace(std::move(key), std::begin(shard.lru));
+
+        return entry;
+    }
+
+    std::shared_ptr<const BeliefUpdateCache::Entry> BeliefUpdateCache::compute(const Belief & b, const size_t a, const size_t o) const {
+        auto entry = std::make_shared<Entry>();
+        updater_(b, a, o, &entry->belief);
+        entry->probability = entry->belief.sum();
+        if ( checkDifferentSmall(entry->probability, 0.0) )
+            entry->belief /= entry->probability;
+        return entry;
+    }
+
+    void BeliefUpdateCache::clear() {
+        for ( auto & shard : shards_ ) {
+            std::lock_guard lock(shard.mutex);
+            shard.entries.clear();
+            shard.lru.clear();
+        }
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+    size_t BeliefUpdateCache::size() const {
+        size_t retval = 0;
+        for ( auto & shard : shards_ ) {
+            std::lock_guard lock(shard.mutex);
+            retval += shard.lru.size();
+        }
+        return retval;
+    }
+
+    size_t BeliefUpdateCache::getMaxSize() const { return maxSize_; }
+    double BeliefUpdateCache::getResolution() const { return resolution_; }
+    size_t BeliefUpdateCache::getShards() const { return shards_.size(); }
+    size_t BeliefUpdateCache::getHits() const { return hits_; }
+    size_t BeliefUpdateCache::getMisses() const { return misses_; }
+}
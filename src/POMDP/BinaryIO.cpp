@@ -0,0 +1,255 @@
+#include <AIToolbox/POMDP/BinaryIO.hpp>
+
+#include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
+#include <AIToolbox/POMDP/Algorithms/PERSEUS.hpp>
+#include <AIToolbox/POMDP/Algorithms/GapMin.hpp>
+#include <AIToolbox/POMDP/Policies/QuantizedPolicy.hpp>
+
+#include <AIToolbox/Impl/Logging.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace AIToolbox::POMDP {
+    namespace {
+        constexpr char Magic[8] = {'A', 'I', 'T', 'B', 'X', 'C', 'K', 'P'};
+        constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t type;
+            std::uint32_t byteOrder;
+            std::uint32_t reserved0;
+            std::uint64_t S;
+            std::uint64_t timestep;
+            double variation;
+            std::uint64_t reserved1;
+        };
+        static_assert(sizeof(Header) == 56);
+
+        std::istream & fail(std::istream & is, const char * error) {
+            AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Invalid checkpoint binary file: " << error);
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+
+        // Writing helpers
+
+        template <typename T>
+        void writeArray(std::ostream & os, const T * data, const size_t n) {
+            os.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+        }
+
+        void writeSize(std::ostream & os, const size_t n) {
+            const std::uint64_t v = n;
+            writeArray(os, &v, 1);
+        }
+
+        void writeHeader(std::ostream & os, const CheckpointType type, const size_t S, const unsigned timestep, const double variation) {
+            Header h;
+            std::memset(&h, 0, sizeof(Header));
+            std::memcpy(h.magic, Magic, sizeof(Magic));
+            h.version = CheckpointFormatVersion;
+            h.type = static_cast<std::uint32_t>(type);
+            h.byteOrder = ByteOrderMark;
+            h.S = S;
+            h.timestep = timestep;
+            h.variation = variation;
+            writeArray(os, &h, 1);
+        }
+
+        // Each entry is stored as its action, its observations and its values.
+        void writeVList(std::ostream & os, const size_t S, const VList & vl) {
+            writeSize(os, vl.size());
+            for ( const auto & entry : vl ) {
+                writeSize(os, entry.action);
+                writeSize(os, entry.observations.size());
+                const std::vector<std::uint64_t> obs(std::begin(entry.observations), std::end(entry.observations));
+                writeArray(os, obs.data(), obs.size());
+                writeArray(os, entry.values.data(), S);
+            }
+        }
+
+        void writeValueFunction(std::ostream & os, const size_t S, const ValueFunction & v) {
+            writeSize(os, v.size());
+            for ( const auto & vl : v )
+                writeVList(os, S, vl);
+        }
+
+        void writeBeliefs(std::ostream & os, const size_t S, const std::vector<Belief> & beliefs) {
+            writeSize(os, beliefs.size());
+            for ( const auto & b : beliefs )
+                writeArray(os, b.data(), S);
+        }
+
+        // Reading helpers
+
+        template <typename T>
+        bool readArray(std::istream & is, T * data, const size_t n) {
+            return static_cast<bool>(is.read(reinterpret_cast<char *>(data), n * sizeof(T)));
+        }
+
+        bool readSize(std::istream & is, size_t * n) {
+            std::uint64_t v;
+            if ( !readArray(is, &v, 1) ) return false;
+            *n = v;
+            return true;
+        }
+
+        const char * readHeader(std::istream & is, const CheckpointType type, Header & h) {
+            if ( !readArray(is, &h, 1) )                        return "could not read header";
+            if ( std::memcmp(h.magic, Magic, sizeof(Magic)) )   return "not a checkpoint binary file";
+            if ( h.version != CheckpointFormatVersion )         return "unsupported binary format version";
+            if ( h.byteOrder != ByteOrderMark )                 return "file was written with a different byte order";
+            if ( h.type != static_cast<std::uint32_t>(type) )   return "file contains a different type of checkpoint";
+            return "";
+        }
+
+        // Entries are read one at a time, so that corrupted sizes make
+        // the read fail rather than allocate huge amounts of memory.
+        bool readVList(std::istream & is, const size_t S, VList * vl) {
+            size_t n, a, o;
+            if ( !readSize(is, &n) ) return false;
+            vl->clear();
+            for ( size_t i = 0; i < n; ++i ) {
+                if ( !readSize(is, &a) || !readSize(is, &o) ) return false;
+
+                std::vector<std::uint64_t> obs;
+                for ( size_t j = 0; j < o; ++j ) {
+                    if ( !readArray(is, &obs.emplace_back(), 1) ) return false;
+                }
+                MDP::Values values(S);
+                if ( !readArray(is, values.data(), S) ) return false;
+
+                vl->emplace_back(std::move(values), a, VObs(std::begin(obs), std::end(obs)));
+            }
+            return true;
+        }
+
+        bool readValueFunction(std::istream & is, const size_t S, ValueFunction * v) {
+            size_t n;
+            if ( !readSize(is, &n) ) return false;
+            v->clear();
+            for ( size_t i = 0; i < n; ++i )
+                if ( !readVList(is, S, &v->emplace_back()) ) return false;
+            return true;
+        }
+
+        bool readBeliefs(std::istream & is, const size_t S, std::vector<Belief> * beliefs) {
+            size_t n;
+            if ( !readSize(is, &n) ) return false;
+            beliefs->clear();
+            for ( size_t i = 0; i < n; ++i ) {
+                auto & b = beliefs->emplace_back(S);
+                if ( !readArray(is, b.data(), S) ) return false;
+            }
+            return true;
+        }
+    }
+
+    // Writers
+
+    std::ostream & writeBinary(std::ostream & os, const IncrementalPruningCheckpoint & c) {
+        const size_t S = c.v.empty() || c.v.back().empty() ? 0 : c.v.back()[0].values.size();
+
+        writeHeader(os, CheckpointType::IncrementalPruning, S, c.timestep, c.variation);
+        writeValueFunction(os, S, c.v);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const PERSEUSCheckpoint & c) {
+        const size_t S = c.v.empty() || c.v.back().empty() ? 0 : c.v.back()[0].values.size();
+
+        writeHeader(os, CheckpointType::PERSEUS, S, c.timestep, c.variation);
+        writeBeliefs(os, S, c.beliefs);
+        writeValueFunction(os, S, c.v);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const GapMinCheckpoint & c) {
+        const size_t S = c.initialBelief.size(), A = c.ubQ.cols();
+
+        writeHeader(os, CheckpointType::GapMin, S, c.iteration, c.ub - c.lb);
+        writeSize(os, A);
+        writeArray(os, c.initialBelief.data(), S);
+        writeArray(os, &c.lb, 1);
+        writeArray(os, &c.ub, 1);
+
+        writeVList(os, S, c.lbVList);
+        writeBeliefs(os, S, c.lbBeliefs);
+
+        writeArray(os, c.ubQ.data(), S * A);
+        writeBeliefs(os, S, c.ubBeliefs);
+        writeArray(os, c.ubValues.data(), c.ubBeliefs.size());
+        writeArray(os, c.fibQ.data(), (S + c.ubBeliefs.size()) * A);
+
+        return os;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const QuantizedPolicy & policy) {
+        return os.write(policy.data_, policy.dataSize_);
+    }
+
+    // Readers
+
+    std::istream & readBinary(std::istream & is, IncrementalPruningCheckpoint & checkpoint) {
+        Header h;
+        if ( const auto error = readHeader(is, CheckpointType::IncrementalPruning, h); *error ) return fail(is, error);
+
+        IncrementalPruningCheckpoint c{static_cast<unsigned>(h.timestep), h.variation, {}};
+        if ( !readValueFunction(is, h.S, &c.v) ) return fail(is, "file is truncated");
+
+        checkpoint = std::move(c);
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, PERSEUSCheckpoint & checkpoint) {
+        Header h;
+        if ( const auto error = readHeader(is, CheckpointType::PERSEUS, h); *error ) return fail(is, error);
+
+        PERSEUSCheckpoint c{static_cast<unsigned>(h.timestep), h.variation, {}, {}};
+        if ( !readBeliefs(is, h.S, &c.beliefs) ||
+             !readValueFunction(is, h.S, &c.v) )
+            return fail(is, "file is truncated");
+
+        checkpoint = std::move(c);
+        return is;
+    }
+
+    std::istream & readBinary(std::istream & is, GapMinCheckpoint & checkpoint) {
+        Header h;
+        if ( const auto error = readHeader(is, CheckpointType::GapMin, h); *error ) return fail(is, error);
+        const size_t S = h.S;
+
+        size_t A;
+        GapMinCheckpoint c;
+        c.iteration = h.timestep;
+        c.initialBelief.resize(S);
+        if ( !readSize(is, &A) ||
+             !readArray(is, c.initialBelief.data(), S) ||
+             !readArray(is, &c.lb, 1) ||
+             !readArray(is, &c.ub, 1) ||
+             !readVList(is, S, &c.lbVList) ||
+             !readBeliefs(is, S, &c.lbBeliefs) )
+            return fail(is, "file is truncated");
+
+        c.ubQ.resize(S, A);
+        if ( !readArray(is, c.ubQ.data(), S * A) ||
+             !readBeliefs(is, S, &c.ubBeliefs) )
+            return fail(is, "file is truncated");
+
+        const size_t N = c.ubBeliefs.size();
+        c.ubValues.resize(N);
+        c.fibQ.resize(S + N, A);
+        if ( !readArray(is, c.ubValues.data(), N) ||
+             !readArray(is, c.fibQ.data(), (S + N) * A) )
+            return fail(is, "file is truncated");
+
+        checkpoint = std::move(c);
+        return is;
+    }
+}
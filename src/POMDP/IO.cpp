@@ -5,12 +5,48 @@
 #include <AIToolbox/Impl/CassandraParser.hpp>
 
 namespace AIToolbox::POMDP {
+    namespace {
+        // Computes the expected rewards R(s,a) from the parsed R[a](s, s1).
+        Matrix2D expectedRewards(const size_t S, const size_t A, const SparseMatrix3D & T, const SparseMatrix3D & R) {
+            Matrix2D rewards(S, A);
+            for (size_t a = 0; a < A; ++a)
+                rewards.col(a) = T[a].cwiseProduct(R[a]) * Vector::Ones(S);
+            return rewards;
+        }
+    }
+
     Model<MDP::Model> parseCassandra(std::istream & input) {
         Impl::CassandraParser parser;
 
-        const auto & [S, A, O, T, R, W, discount] = parser.parsePOMDP(input);
+        auto [S, A, O, T, R, W, discount] = parser.parsePOMDP(input);
+        Impl::CassandraParser::checkProbabilities(T, "Input transition matrix does not contain valid probabilities.");
+        Impl::CassandraParser::checkProbabilities(W, "Input observation matrix does not contain valid probabilities.");
+
+        MDP::Model::TransitionMatrix t(A);
+        Model<MDP::Model>::ObservationMatrix w(A);
+        for (size_t a = 0; a < A; ++a) {
+            t[a] = Matrix2D(T[a]);
+            w[a] = Matrix2D(W[a]);
+        }
+
+        Model<MDP::Model> retval(NO_CHECK, O, std::move(w), NO_CHECK, S, A, std::move(t), expectedRewards(S, A, T, R), 1.0);
+        retval.setDiscount(discount);
+
+        return retval;
+    }
+
+    SparseModel<MDP::SparseModel> parseCassandraSparse(std::istream & input) {
+        Impl::CassandraParser parser;
+
+        auto [S, A, O, T, R, W, discount] = parser.parsePOMDP(input);
+        Impl::CassandraParser::checkProbabilities(T, "Input transition matrix does not contain valid probabilities.");
+        Impl::CassandraParser::checkProbabilities(W, "Input observation matrix does not contain valid probabilities.");
+
+        MDP::SparseModel::RewardMatrix r = expectedRewards(S, A, T, R).sparseView();
+        SparseModel<MDP::SparseModel> retval(NO_CHECK, O, std::move(W), NO_CHECK, S, A, std::move(T), std::move(r), 1.0);
+        retval.setDiscount(discount);
 
-        return Model<MDP::Model>(O, W, S, A, T, R, discount);
+        return retval;
     }
 
     std::ostream& operator<<(std::ostream &os, const Policy & p) {
@@ -102,6 +138,7 @@ namespace AIToolbox::POMDP {
 
         p.H = vf.size() - 1;
         p.policy_ = std::move(vf);
+        p.pack();
         return is;
 
 failure:
@@ -0,0 +1,41 @@
+#include <AIToolbox/POMDP/ModelContext.hpp>
+
+namespace AIToolbox::POMDP {
+    const SOSACache & ModelContext::getSOSA() const { return sosa_; }
+
+    const Matrix2D & ModelContext::getImmediateRewards() const {
+        std::lock_guard lock(mutex_);
+        if ( !hasRewards_ ) {
+            rewards_ = rewardsBuilder_();
+            hasRewards_ = true;
+        }
+        return rewards_;
+    }
+
+    const ModelContext::MDPSolution & ModelContext::getMDPSolution(const unsigned horizon, const double tolerance) const {
+        std::lock_guard lock(mutex_);
+        const auto key = std::make_pair(horizon, tolerance);
+
+        auto it = solutions_.find(key);
+        if ( it == std::end(solutions_) )
+            it = solutions_.emplace(key, mdpSolver_(horizon, tolerance)).first;
+        return it->second;
+    }
+
+    size_t ModelContext::getMDPSolveCount() const {
+        std::lock_guard lock(mutex_);
+        return solutions_.size();
+    }
+
+    void ModelContext::clear() {
+        std::lock_guard lock(mutex_);
+        sosa_.clear();
+        hasRewards_ = false;
+        rewards_.resize(0, 0);
+        solutions_.clear();
+    }
+
+    size_t ModelContext::getS() const { return sosa_.getS(); }
+    size_t ModelContext::getA() const { return sosa_.getA(); }
+    size_t ModelContext::getO() const { return sosa_.getO(); }
+}
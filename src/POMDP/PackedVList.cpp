@@ -0,0 +1,105 @@
+#include <AIToolbox/POMDP/PackedVList.hpp>
+
+#include <AIToolbox/Utils/Core.hpp>
+
+namespace AIToolbox::POMDP {
+    PackedVList::PackedVList(const size_t s, const size_t o) :
+            S(s), O(o), size_(0), values_(0, S) {}
+
+    PackedVList::PackedVList(const size_t s, const VList & vlist) :
+            PackedVList(s, vlist.size() ? vlist[0].observations.size() : 0)
+    {
+        reserve(vlist.size());
+        for ( const auto & entry : vlist )
+            push_back(entry);
+    }
+
+    void PackedVList::reserve(const size_t size) {
+        if ( size <= static_cast<size_t>(values_.rows()) ) return;
+
+        values_.conservativeResize(size, Eigen::NoChange);
+        actions_.reserve(size);
+        observations_.reserve(size * O);
+    }
+
+    void PackedVList::push_back(const VEntry & entry) {
+        // We grow geometrically, as std::vector does.
+        if ( size_ == static_cast<size_t>(values_.rows()) )
+            reserve(std::max<size_t>(1, 2 * size_));
+
+        values_.row(size_) = entry.values.transpose();
+        actions_.push_back(entry.action);
+        observations_.insert(std::end(observations_), std::begin(entry.observations), std::begin(entry.observations) + O);
+        ++size_;
+    }
+
+    size_t PackedVList::findBestAtBelief(const Belief & b, double * value) const {
+        const Vector values = values_.topRows(size_) * b;
+
+        size_t best = 0;
+        for ( size_t i = 1; i < size_; ++i ) {
+            if ( values[i] > values[best] || ( values[i] == values[best] && veccmp(values_.row(i), values_.row(best)) > 0 ) )
+                best = i;
+        }
+        if ( value ) *value = values[best];
+        return best;
+    }
+
+    std::vector<size_t> PackedVList::findBestAtBeliefs(const Matrix2D & beliefs, Vector * values) const {
+        const size_t N = beliefs.rows();
+        // One row per belief, so that each scan below is contiguous.
+        const Matrix2D products = beliefs * values_.topRows(size_).transpose();
+
+        std::vector<size_t> bests(N, 0);
+        for ( size_t n = 0; n < N; ++n ) {
+            auto & best = bests[n];
+            for ( size_t i = 1; i < size_; ++i ) {
+                if ( products(n, i) > products(n, best) || ( products(n, i) == products(n, best) && veccmp(values_.row(i), values_.row(best)) > 0 ) )
+                    best = i;
+            }
+        }
+        if ( values ) {
+            values->resize(N);
+            for ( size_t n = 0; n < N; ++n )
+                (*values)[n] = products(n, bests[n]);
+        }
+        return bests;
+    }
+
+    size_t PackedVList::getAction(const size_t i) const {
+        return actions_[i];
+    }
+
+    size_t PackedVList::getObservation(const size_t i, const size_t o) const {
+        return observations_[i * O + o];
+    }
+
+    VEntry PackedVList::getEntry(const size_t i) const {
+        const auto obs = std::begin(observations_) + i * O;
+        return VEntry(values_.row(i).transpose(), actions_[i], VObs(obs, obs + O));
+    }
+
+    VList PackedVList::toVList() const {
+        VList retval;
+        retval.reserve(size_);
+        for ( size_t i = 0; i < size_; ++i )
+            retval.emplace_back(getEntry(i));
+        return retval;
+    }
+
+    size_t PackedVList::size() const {
+        return size_;
+    }
+
+    bool PackedVList::empty() const {
+        return size_ == 0;
+    }
+
+    size_t PackedVList::getS() const {
+        return S;
+    }
+
+    size_t PackedVList::getO() const {
+        return O;
+    }
+}
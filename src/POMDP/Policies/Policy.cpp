@@ -4,38 +4,64 @@
 
 namespace AIToolbox::POMDP {
     Policy::Policy(const size_t s, const size_t a, const size_t o) :
-            Base(s, a), O(o), H(0), policy_(makeValueFunction(S)) {}
+            Base(s, a), O(o), H(0), policy_(makeValueFunction(S))
+    {
+        pack();
+    }
 
     Policy::Policy(const size_t s, const size_t a, const size_t o, const ValueFunction & v) :
             Base(s, a), O(o), H(v.size()-1), policy_(v)
     {
         if ( !v.size() ) throw std::invalid_argument("The ValueFunction supplied to POMDP::Policy is empty.");
+        pack();
+    }
+
+    void Policy::pack() {
+        packed_.clear();
+        packed_.reserve(policy_.size());
+        for ( const auto & vlist : policy_ )
+            packed_.emplace_back(S, vlist);
     }
 
     size_t Policy::sampleAction(const Belief & b) const {
         // We use the latest horizon here.
-        const auto & vlist = policy_.back();
+        const auto & vlist = packed_.back();
 
-        const auto begin = boost::make_transform_iterator(std::begin(vlist), unwrap);
-        const auto end   = boost::make_transform_iterator(std::end  (vlist), unwrap);
-        const auto bestMatch = findBestAtPoint(b, begin, end).base();
-
-        return bestMatch->action;
+        return vlist.getAction(vlist.findBestAtBelief(b));
     }
 
     std::tuple<size_t, size_t> Policy::sampleAction(const Belief & b, const unsigned horizon) const {
-        const auto & vlist = policy_[horizon];
-
-        const auto begin = boost::make_transform_iterator(std::begin(vlist), unwrap);
-        const auto end   = boost::make_transform_iterator(std::end  (vlist), unwrap);
-        const auto bestMatch = findBestAtPoint(b, begin, end);
+        const auto & vlist = packed_[horizon];
 
-        const size_t action = bestMatch.base()->action;
-        const size_t id     = std::distance(begin, bestMatch);
+        const size_t id     = vlist.findBestAtBelief(b);
+        const size_t action = vlist.getAction(id);
 
         return std::make_tuple(action, id);
     }
 
+    std::vector<size_t> Policy::sampleActions(const Matrix2D & beliefs) const {
+        const auto & vlist = packed_.back();
+
+        auto retval = vlist.findBestAtBeliefs(beliefs);
+        for ( auto & id : retval )
+            id = vlist.getAction(id);
+
+        return retval;
+    }
+
+    std::vector<std::tuple<size_t, size_t>> Policy::sampleActions(const Matrix2D & beliefs, const unsigned horizon) const {
+        const auto & vlist = packed_[horizon];
+
+        const auto ids = vlist.findBestAtBeliefs(beliefs);
+
+        std::vector<std::tuple<size_t, size_t>> retval;
+        retval.reserve(ids.size());
+        for ( const auto id : ids )
+            retval.emplace_back(vlist.getAction(id), id);
+
+        return retval;
+    }
+
     std::tuple<size_t, size_t> Policy::sampleAction(const size_t id, const size_t o, const unsigned horizon) const {
         // Horizon + 1 means one step in the past.
         // Note that the zero entry is never supposed to be used, and it's just
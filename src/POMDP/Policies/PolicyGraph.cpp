@@ -0,0 +1,166 @@
+#include <AIToolbox/POMDP/Policies/PolicyGraph.hpp>
+
+#include <AIToolbox/Impl/Logging.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace AIToolbox::POMDP {
+    namespace {
+        constexpr char Magic[8] = {'A', 'I', 'T', 'B', 'X', 'P', 'G', 'R'};
+        constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+            std::uint64_t S;
+            std::uint64_t O;
+            std::uint64_t nodes;
+            std::uint64_t reserved;
+        };
+        static_assert(sizeof(Header) == 48);
+
+        std::istream & fail(std::istream & is, const char * error) {
+            AI_LOGGER(AI_SEVERITY_ERROR, "AIToolbox: Invalid PolicyGraph binary file: " << error);
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+    }
+
+    PolicyGraph::PolicyGraph(const size_t s, const size_t o) :
+            S(s), O(o), linkError_(0.0), nodes_(S, O)
+    {
+        nodes_.push_back(VEntry(MDP::Values::Zero(S), 0, VObs(O, 0)));
+    }
+
+    PolicyGraph::PolicyGraph(const size_t s, const size_t o, const ValueFunction & vf) :
+            S(s), O(o), linkError_(0.0), nodes_(S, O)
+    {
+        if ( vf.size() < 2 ) throw std::invalid_argument("The ValueFunction supplied to POMDP::PolicyGraph has no horizon 1 VList.");
+
+        const auto & last = vf.back();
+        const auto & prev = vf[vf.size() - 2];
+
+        // We map each alphavector of the previous horizon to the node with
+        // the closest values.
+        std::vector<size_t> links(prev.size());
+        std::vector<double> errors(prev.size());
+        for ( size_t j = 0; j < prev.size(); ++j ) {
+            double best = std::numeric_limits<double>::infinity();
+            for ( size_t i = 0; i < last.size(); ++i ) {
+                const double error = (prev[j].values - last[i].values).cwiseAbs().maxCoeff();
+                if ( error < best ) {
+                    best = error;
+                    links[j] = i;
+                }
+            }
+            errors[j] = best;
+        }
+
+        nodes_.reserve(last.size());
+        VObs next(O);
+        for ( const auto & entry : last ) {
+            for ( size_t o = 0; o < O; ++o ) {
+                const auto j = entry.observations[o];
+                next[o] = links[j];
+                linkError_ = std::max(linkError_, errors[j]);
+            }
+            nodes_.push_back(VEntry(entry.values, entry.action, next));
+        }
+    }
+
+    size_t PolicyGraph::getNode(const Belief & b) const {
+        return nodes_.findBestAtBelief(b);
+    }
+
+    size_t PolicyGraph::getAction(const size_t node) const {
+        return nodes_.getAction(node);
+    }
+
+    size_t PolicyGraph::getNextNode(const size_t node, const size_t o) const {
+        return nodes_.getObservation(node, o);
+    }
+
+    double PolicyGraph::getLinkError() const {
+        return linkError_;
+    }
+
+    size_t PolicyGraph::size() const {
+        return nodes_.size();
+    }
+
+    size_t PolicyGraph::getS() const {
+        return S;
+    }
+
+    size_t PolicyGraph::getO() const {
+        return O;
+    }
+
+    std::ostream & writeBinary(std::ostream & os, const PolicyGraph & graph) {
+        const size_t S = graph.getS(), O = graph.getO(), N = graph.size();
+
+        Header h;
+        std::memset(&h, 0, sizeof(Header));
+        std::memcpy(h.magic, Magic, sizeof(Magic));
+        h.version = PolicyGraphFormatVersion;
+        h.byteOrder = ByteOrderMark;
+        h.S = S;
+        h.O = O;
+        h.nodes = N;
+        os.write(reinterpret_cast<const char *>(&h), sizeof(Header));
+
+        std::vector<double> values(N * S);
+        std::vector<std::uint64_t> actions(N), links(N * O);
+        for ( size_t i = 0; i < N; ++i ) {
+            Eigen::Map<Vector>(values.data() + i * S, S) = graph.getValues(i).transpose();
+            actions[i] = graph.getAction(i);
+            for ( size_t o = 0; o < O; ++o )
+                links[i * O + o] = graph.getNextNode(i, o);
+        }
+        os.write(reinterpret_cast<const char *>(values.data()),  values.size()  * sizeof(double));
+        os.write(reinterpret_cast<const char *>(actions.data()), actions.size() * sizeof(std::uint64_t));
+        os.write(reinterpret_cast<const char *>(links.data()),   links.size()   * sizeof(std::uint64_t));
+
+        return os;
+    }
+
+    std::istream & readBinary(std::istream & is, PolicyGraph & graph) {
+        const size_t S = graph.getS(), O = graph.getO();
+
+        Header h;
+        if ( !is.read(reinterpret_cast<char *>(&h), sizeof(Header)) ) return fail(is, "could not read header");
+        if ( std::memcmp(h.magic, Magic, sizeof(Magic)) )  return fail(is, "not a PolicyGraph binary file");
+        if ( h.version != PolicyGraphFormatVersion )        return fail(is, "unsupported binary format version");
+        if ( h.byteOrder != ByteOrderMark )                 return fail(is, "file was written with a different byte order");
+        if ( h.S != S || h.O != O )                         return fail(is, "graph has different dimensions");
+        if ( h.nodes == 0 )                                 return fail(is, "graph has no nodes");
+
+        const size_t N = h.nodes;
+        std::vector<double> values(N * S);
+        std::vector<std::uint64_t> actions(N), links(N * O);
+        if ( !is.read(reinterpret_cast<char *>(values.data()),  values.size()  * sizeof(double)) ||
+             !is.read(reinterpret_cast<char *>(actions.data()), actions.size() * sizeof(std::uint64_t)) ||
+             !is.read(reinterpret_cast<char *>(links.data()),   links.size()   * sizeof(std::uint64_t)) )
+            return fail(is, "file is truncated");
+
+        for ( const auto l : links )
+            if ( l >= N ) return fail(is, "graph links to a node which does not exist");
+
+        PackedVList nodes(S, O);
+        nodes.reserve(N);
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto obs = std::begin(links) + i * O;
+            nodes.push_back(VEntry(Eigen::Map<const Vector>(values.data() + i * S, S), actions[i], VObs(obs, obs + O)));
+        }
+
+        graph.nodes_ = std::move(nodes);
+        graph.linkError_ = 0.0;
+
+        return is;
+    }
+}
@@ -0,0 +1,263 @@
+#include <AIToolbox/POMDP/Policies/QuantizedPolicy.hpp>
+
+#include <AIToolbox/MDP/BinaryIO.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace AIToolbox::POMDP {
+    namespace {
+        constexpr char Magic[8] = {'A', 'I', 'T', 'B', 'X', 'Q', 'P', 'L'};
+        constexpr std::uint32_t ByteOrderMark = 0x01020304;
+        constexpr std::uint32_t FormatVersion = 1;
+        // All arrays start at this alignment within the data.
+        constexpr size_t Alignment = 64;
+        constexpr double FloatEpsilon = std::numeric_limits<float>::epsilon() / 2.0;
+        constexpr double Int16Max = std::numeric_limits<std::int16_t>::max();
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t precision;
+            std::uint32_t byteOrder;
+            std::uint32_t reserved0;
+            std::uint64_t S;
+            std::uint64_t A;
+            std::uint64_t O;
+            // The number of stored VLists, one more than the highest horizon.
+            std::uint64_t H;
+            double errorBound;
+        };
+        static_assert(sizeof(Header) == Alignment);
+
+        size_t aligned(const size_t bytes) {
+            return (bytes + Alignment - 1) / Alignment * Alignment;
+        }
+
+        size_t valueSize(const QuantizedPolicy::Precision p) {
+            return p == QuantizedPolicy::Precision::Float32 ? sizeof(float) : sizeof(std::int16_t);
+        }
+
+        const Header & getHeader(const char * data, const size_t size) {
+            if ( size < sizeof(Header) )
+                throw std::runtime_error("Binary file is truncated.");
+            const auto & h = *reinterpret_cast<const Header *>(data);
+            if ( std::memcmp(h.magic, Magic, sizeof(Magic)) )   throw std::runtime_error("Not a QuantizedPolicy binary file.");
+            if ( h.version != FormatVersion )                   throw std::runtime_error("Unsupported binary format version.");
+            if ( h.byteOrder != ByteOrderMark )                 throw std::runtime_error("File was written with a different byte order.");
+            if ( h.precision != static_cast<std::uint32_t>(QuantizedPolicy::Precision::Float32) &&
+                 h.precision != static_cast<std::uint32_t>(QuantizedPolicy::Precision::Int16) )
+                throw std::runtime_error("File contains an unknown precision.");
+            if ( !h.H )                                         throw std::runtime_error("File contains no horizons.");
+            return h;
+        }
+
+        const Header & getHeader(const MDP::MappedFile & file) {
+            return getHeader(file.data(), file.size());
+        }
+
+        // Bounds the error of computing the dot product of the stored
+        // values with a belief in float, given the largest stored value.
+        // The belief is rounded to float, and the S products are summed in
+        // any order; since the belief sums to one, both errors are
+        // proportional to the largest value.
+        double getEvaluationError(const size_t S, const double maxValue) {
+            const double n = (S + 1) * FloatEpsilon;
+            return maxValue * n / (1.0 - n);
+        }
+
+        // Returns the bound for a single vector.
+        template <typename T>
+        double quantize(const MDP::Values & alpha, const QuantizedPolicy::Precision p, double * offset, double * scale, T * out) {
+            const size_t S = alpha.size();
+            const double max = alpha.maxCoeff(), min = alpha.minCoeff();
+            *offset = (max + min) / 2.0;
+            *scale = 1.0;
+            if ( p == QuantizedPolicy::Precision::Int16 )
+                *scale = (max - min) / 2.0 / Int16Max;
+
+            double maxValue = 0.0, error = 0.0;
+            for ( size_t s = 0; s < S; ++s ) {
+                const double x = alpha[s] - *offset;
+                if constexpr (std::is_same_v<T, float>) {
+                    out[s] = static_cast<float>(x);
+                } else {
+                    out[s] = *scale > 0.0 ? static_cast<T>(std::clamp(std::round(x / *scale), -Int16Max, Int16Max)) : 0;
+                }
+                maxValue = std::max(maxValue, std::abs(static_cast<double>(out[s])));
+                error = std::max(error, std::abs(alpha[s] - (*offset + *scale * out[s])));
+            }
+            return error + *scale * getEvaluationError(S, maxValue);
+        }
+
+        template <typename T>
+        size_t findBest(const size_t S, const size_t N, const T * values, const double * offsets, const double * scales, const float * b, double * value) {
+            size_t bestId = 0;
+            double best = std::numeric_limits<double>::lowest();
+            for ( size_t i = 0; i < N; ++i ) {
+                const T * row = values + i * S;
+                float dot = 0.0f;
+                for ( size_t s = 0; s < S; ++s )
+                    dot += static_cast<float>(row[s]) * b[s];
+
+                const double v = offsets[i] + scales[i] * dot;
+                if ( v > best ) {
+                    best = v;
+                    bestId = i;
+                }
+            }
+            if ( value ) *value = best;
+            return bestId;
+        }
+    }
+
+    QuantizedPolicy::QuantizedPolicy(const size_t s, const size_t a, const size_t o, const ValueFunction & v, const Precision precision, const double tolerance) :
+            Base(s, a), O(o), H(v.size() - 1), precision_(precision), errorBound_(0.0)
+    {
+        if ( !v.size() ) throw std::invalid_argument("The ValueFunction supplied to POMDP::QuantizedPolicy is empty.");
+
+        // We first compute the layout, so that we can allocate the
+        // buffer only once.
+        const size_t valueBytes = valueSize(precision_);
+        size_t bytes = sizeof(Header) + aligned(v.size() * sizeof(std::uint64_t));
+        for ( const auto & vlist : v ) {
+            const size_t N = vlist.size();
+            bytes += aligned(N * sizeof(std::uint32_t)) + 2 * aligned(N * sizeof(double)) + aligned(N * S * valueBytes);
+        }
+
+        // The buffer is zeroed so that the padding is deterministic.
+        auto buffer = std::make_shared<std::vector<std::uint64_t>>(bytes / sizeof(std::uint64_t), 0);
+        char * data = reinterpret_cast<char *>(buffer->data());
+
+        size_t offset = sizeof(Header) + aligned(v.size() * sizeof(std::uint64_t));
+        double maxError = 0.0;
+        for ( size_t h = 0; h < v.size(); ++h ) {
+            const auto & vlist = v[h];
+            const size_t N = vlist.size();
+            reinterpret_cast<std::uint64_t *>(data + sizeof(Header))[h] = N;
+
+            auto actions = reinterpret_cast<std::uint32_t *>(data + offset);
+            offset += aligned(N * sizeof(std::uint32_t));
+            auto offsets = reinterpret_cast<double *>(data + offset);
+            offset += aligned(N * sizeof(double));
+            auto scales = reinterpret_cast<double *>(data + offset);
+            offset += aligned(N * sizeof(double));
+            char * values = data + offset;
+            offset += aligned(N * S * valueBytes);
+
+            for ( size_t i = 0; i < N; ++i ) {
+                if ( static_cast<size_t>(vlist[i].values.size()) != S )
+                    throw std::invalid_argument("The ValueFunction supplied to POMDP::QuantizedPolicy has vectors of the wrong size.");
+                actions[i] = vlist[i].action;
+                double error;
+                if ( precision_ == Precision::Float32 )
+                    error = quantize(vlist[i].values, precision_, offsets + i, scales + i, reinterpret_cast<float *>(values) + i * S);
+                else
+                    error = quantize(vlist[i].values, precision_, offsets + i, scales + i, reinterpret_cast<std::int16_t *>(values) + i * S);
+                maxError = std::max(maxError, error);
+            }
+        }
+        // The selected vector may be overestimated and the best one
+        // underestimated, each by at most maxError.
+        errorBound_ = 2.0 * maxError;
+        if ( errorBound_ > tolerance )
+            throw std::invalid_argument("The error bound of the QuantizedPolicy is higher than the tolerance.");
+
+        auto & header = *reinterpret_cast<Header *>(data);
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = FormatVersion;
+        header.precision = static_cast<std::uint32_t>(precision_);
+        header.byteOrder = ByteOrderMark;
+        header.S = S;
+        header.A = A;
+        header.O = O;
+        header.H = v.size();
+        header.errorBound = errorBound_;
+
+        data_ = data;
+        dataSize_ = bytes;
+        storage_ = std::move(buffer);
+        parse();
+    }
+
+    QuantizedPolicy::QuantizedPolicy(std::shared_ptr<const MDP::MappedFile> file) :
+            Base(getHeader(*file).S, getHeader(*file).A), O(getHeader(*file).O), H(getHeader(*file).H - 1),
+            precision_(static_cast<Precision>(getHeader(*file).precision)), errorBound_(getHeader(*file).errorBound),
+            data_(file->data()), dataSize_(file->size())
+    {
+        storage_ = std::move(file);
+        parse();
+    }
+
+    QuantizedPolicy::QuantizedPolicy(const std::string & filename) :
+            QuantizedPolicy(std::make_shared<const MDP::MappedFile>(filename)) {}
+
+    void QuantizedPolicy::parse() {
+        const auto check = [this](const size_t offset) {
+            if ( offset > dataSize_ ) throw std::runtime_error("Binary file is truncated.");
+        };
+        const size_t valueBytes = valueSize(precision_);
+
+        size_t offset = sizeof(Header) + aligned((H + 1) * sizeof(std::uint64_t));
+        check(offset);
+        const auto sizes = reinterpret_cast<const std::uint64_t *>(data_ + sizeof(Header));
+
+        horizons_.clear();
+        for ( size_t h = 0; h <= H; ++h ) {
+            Horizon horizon;
+            horizon.size = sizes[h];
+            // Sizes are checked one at a time, so corrupted values fail
+            // rather than overflow.
+            const size_t N = horizon.size;
+            if ( N > dataSize_ || (N && S > dataSize_ / N / valueBytes) )
+                throw std::runtime_error("Binary file is truncated.");
+
+            horizon.actions = reinterpret_cast<const std::uint32_t *>(data_ + offset);
+            offset += aligned(N * sizeof(std::uint32_t));
+            horizon.offsets = reinterpret_cast<const double *>(data_ + offset);
+            offset += aligned(N * sizeof(double));
+            horizon.scales = reinterpret_cast<const double *>(data_ + offset);
+            offset += aligned(N * sizeof(double));
+            horizon.values = data_ + offset;
+            offset += aligned(N * S * valueBytes);
+            check(offset);
+
+            horizons_.push_back(horizon);
+        }
+    }
+
+    size_t QuantizedPolicy::findBestAtBelief(const Belief & b, const unsigned horizon, double * value) const {
+        const auto & h = horizons_[horizon];
+
+        std::vector<float> bf(S);
+        for ( size_t s = 0; s < S; ++s )
+            bf[s] = static_cast<float>(b[s]);
+
+        if ( precision_ == Precision::Float32 )
+            return findBest(S, h.size, static_cast<const float *>(h.values), h.offsets, h.scales, bf.data(), value);
+        return findBest(S, h.size, static_cast<const std::int16_t *>(h.values), h.offsets, h.scales, bf.data(), value);
+    }
+
+    size_t QuantizedPolicy::sampleAction(const Belief & b) const {
+        return std::get<0>(sampleAction(b, H));
+    }
+
+    std::tuple<size_t, size_t> QuantizedPolicy::sampleAction(const Belief & b, const unsigned horizon) const {
+        const size_t id = findBestAtBelief(b, horizon);
+        return std::make_tuple(static_cast<size_t>(horizons_[horizon].actions[id]), id);
+    }
+
+    double QuantizedPolicy::getActionProbability(const Belief & b, const size_t & a) const {
+        return sampleAction(b) == a ? 1.0 : 0.0;
+    }
+
+    size_t QuantizedPolicy::getO() const { return O; }
+    size_t QuantizedPolicy::getH() const { return H; }
+    QuantizedPolicy::Precision QuantizedPolicy::getPrecision() const { return precision_; }
+    double QuantizedPolicy::getErrorBound() const { return errorBound_; }
+    size_t QuantizedPolicy::getSize(const unsigned horizon) const { return horizons_[horizon].size; }
+    size_t QuantizedPolicy::getMemoryUsage() const { return dataSize_; }
+}
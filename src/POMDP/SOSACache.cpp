@@ -0,0 +1,107 @@
+#include <AIToolbox/POMDP/SOSACache.hpp>
+
+namespace AIToolbox::POMDP {
+    namespace {
+        size_t blockBytes(const Matrix2D & m) {
+            return m.size() * sizeof(double);
+        }
+
+        size_t blockBytes(const SparseMatrix2D & m) {
+            using Index = SparseMatrix2D::StorageIndex;
+            return m.nonZeros() * (sizeof(double) + sizeof(Index)) + (m.outerSize() + 1) * sizeof(Index);
+        }
+    }
+
+    SOSACache::SOSACache(const size_t s, const size_t a, const size_t o, const size_t maxBytes, const double maxDensity, Builder builder) :
+            S(s), A(a), O(o), maxBytes_(maxBytes), maxDensity_(maxDensity),
+            builder_(std::move(builder)), entries_(A * O), bytes_(0), builds_(0) {}
+
+    std::shared_ptr<const SOSACache::Block> SOSACache::get(const size_t a, const size_t o) const {
+        const size_t id = a * O + o;
+        auto & entry = entries_[id];
+
+        {
+            std::lock_guard lock(mutex_);
+            if ( entry.block ) {
+                lru_.splice(std::begin(lru_), lru_, entry.lru);
+                return entry.block;
+            }
+        }
+
+        auto block = builder_(a, o);
+
+        // Dense products which are mostly zeros are much faster as sparse.
+        if ( const auto dense = std::get_if<Matrix2D>(&block) ) {
+            const auto nonZeros = static_cast<double>((dense->array() != 0.0).count());
+            if ( nonZeros <= maxDensity_ * dense->size() ) {
+                SparseMatrix2D sparse = dense->sparseView();
+                sparse.makeCompressed();
+                block = std::move(sparse);
+            }
+        }
+        const size_t bytes = std::visit([](const auto & m) { return blockBytes(m); }, block);
+
+        std::lock_guard lock(mutex_);
+        ++builds_;
+        // Another thread may have built the same matrix in the meantime.
+        if ( entry.block ) {
+            lru_.splice(std::begin(lru_), lru_, entry.lru);
+            return entry.block;
+        }
+
+        if ( maxBytes_ ) evict(bytes < maxBytes_ ? maxBytes_ - bytes : 0);
+
+        entry.block = std::make_shared<const Block>(std::move(block));
+        entry.bytes = bytes;
+        entry.lru = lru_.insert(std::begin(lru_), id);
+        bytes_ += bytes;
+
+        return entry.block;
+    }
+
+    void SOSACache::evict(const size_t bytes) const {
+        while ( bytes_ > bytes && !lru_.empty() ) {
+            auto & entry = entries_[lru_.back()];
+            bytes_ -= entry.bytes;
+            entry.block.reset();
+            lru_.pop_back();
+        }
+    }
+
+    void SOSACache::setMaxBytes(const size_t maxBytes) {
+        std::lock_guard lock(mutex_);
+        maxBytes_ = maxBytes;
+        if ( maxBytes_ ) evict(maxBytes_);
+    }
+
+    size_t SOSACache::getMaxBytes() const {
+        return maxBytes_;
+    }
+
+    size_t SOSACache::getBytes() const {
+        std::lock_guard lock(mutex_);
+        return bytes_;
+    }
+
+    size_t SOSACache::getBuildCount() const {
+        std::lock_guard lock(mutex_);
+        return builds_;
+    }
+
+    void SOSACache::clear() {
+        std::lock_guard lock(mutex_);
+        evict(0);
+    }
+
+    size_t SOSACache::getS() const {
+        return S;
+    }
+
+    size_t SOSACache::getA() const {
+        return A;
+    }
+
+    size_t SOSACache::getO() const {
+        return O;
+    }
+}
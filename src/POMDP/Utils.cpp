@@ -1,5 +1,9 @@
 #include <AIToolbox/POMDP/Utils.hpp>
 
+#include <algorithm>
+
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+
 namespace AIToolbox::POMDP {
     ValueFunction makeValueFunction(const size_t S) {
         auto values = MDP::Values(S);
@@ -8,6 +12,16 @@ namespace AIToolbox::POMDP {
         return ValueFunction(1, VList(1, {values, 0, VObs()}));
     }
 
+    size_t getMemoryUsage(const ValueFunction & v) {
+        size_t retval = v.capacity() * sizeof(VList);
+        for (const auto & vlist : v) {
+            retval += vlist.capacity() * sizeof(VEntry);
+            for (const auto & entry : vlist)
+                retval += heapUsage(entry.values) + heapUsage(entry.observations);
+        }
+        return retval;
+    }
+
     bool operator<(const VEntry & lhs, const VEntry & rhs) {
         auto cmp = veccmp(lhs.values, rhs.values);
         if (cmp != 0) return cmp < 0;
@@ -21,7 +35,48 @@ namespace AIToolbox::POMDP {
                lhs.observations == rhs.observations;
     }
 
-    double weakBoundDistance(const VList & oldV, const VList & newV) {
+    VEntry crossSumBestAtBelief(const Belief & b, const std::vector<PackedVList> & row, const size_t a, double * value) {
+        const size_t O = row.size();
+        VEntry entry(b.size(), a, O);
+        double v = 0.0, tmp;
+
+        for ( size_t o = 0; o < O; ++o ) {
+            const auto bestMatch = row[o].findBestAtBelief(b, &tmp);
+
+            entry.values += row[o].getValues(bestMatch).transpose();
+            v += tmp;
+
+            entry.observations[o] = row[o].getObservation(bestMatch, 0);
+        }
+        if (value) *value = v;
+        return entry;
+    }
+
+    VList crossSumBestAtBeliefs(const Matrix2D & beliefs, const std::vector<PackedVList> & row, const size_t a, Vector * values) {
+        const size_t N = beliefs.rows(), S = beliefs.cols(), O = row.size();
+
+        VList entries;
+        entries.reserve(N);
+        for ( size_t n = 0; n < N; ++n )
+            entries.emplace_back(S, a, O);
+
+        Vector v(N), tmp;
+        v.setZero();
+
+        for ( size_t o = 0; o < O; ++o ) {
+            const auto bestMatches = row[o].findBestAtBeliefs(beliefs, &tmp);
+
+            for ( size_t n = 0; n < N; ++n ) {
+                entries[n].values += row[o].getValues(bestMatches[n]).transpose();
+                entries[n].observations[o] = row[o].getObservation(bestMatches[n], 0);
+            }
+            v += tmp;
+        }
+        if (values) *values = std::move(v);
+        return entries;
+    }
+
+    double weakBoundDistance(const VList & oldV, const VList & newV, ThreadPool * pool) {
         // Here we implement a weak bound (can also be seen in Cassandra's code)
         // This is mostly because a strong bound is more costly (it requires performing
         // multiple LPs) and also the code at the moment does not support it cleanly, so
@@ -37,20 +92,54 @@ namespace AIToolbox::POMDP {
         // element-wise difference.
         if ( !oldV.size() ) return 0.0;
 
-        double distance = 0.0;
-        for ( const auto & newVE : newV ) {
-            // Initialize closest distance for newVE as infinity
-            double closestDistance = std::numeric_limits<double>::infinity();
-            for ( const auto & oldVE : oldV ) {
-                // Compute the distance, we pick the max
-                double distance = (newVE.values - oldVE.values).cwiseAbs().maxCoeff();
-
-                // Keep the closest, we pick the min
-                closestDistance = std::min(closestDistance, distance);
-            }
-            // Keep the maximum distance between a new VList and its closest old VList
-            distance = std::max(distance, closestDistance);
+        // New vectors which are also in the old VList have distance zero, so
+        // we only need to look at the others. We find them by hashing the
+        // values of the old VList.
+        std::vector<std::pair<size_t, size_t>> oldHashes;
+        oldHashes.reserve(oldV.size());
+        for ( size_t i = 0; i < oldV.size(); ++i )
+            oldHashes.emplace_back(hash_value(oldV[i].values), i);
+        std::sort(std::begin(oldHashes), std::end(oldHashes));
+
+        std::vector<size_t> changed;
+        for ( size_t i = 0; i < newV.size(); ++i ) {
+            const auto & values = newV[i].values;
+            const auto range = std::equal_range(std::begin(oldHashes), std::end(oldHashes),
+                                                std::make_pair(hash_value(values), size_t(0)),
+                                                [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+            const bool found = std::any_of(range.first, range.second, [&](const auto & h) { return oldV[h.second].values == values; });
+            if ( !found ) changed.push_back(i);
         }
+
+        // Since the result is a maximum, it does not depend on how the
+        // vectors are split, and each thread can stop comparing a vector as
+        // soon as its closest distance is below its own running maximum.
+        std::vector<double> distances(changed.size(), 0.0);
+        const auto compare = [&](const size_t begin, const size_t end) {
+            double distance = 0.0;
+            for ( size_t i = begin; i < end; ++i ) {
+                const auto & newVE = newV[changed[i]];
+                // Initialize closest distance for newVE as infinity
+                double closestDistance = std::numeric_limits<double>::infinity();
+                for ( const auto & oldVE : oldV ) {
+                    // Compute the distance, we pick the max
+                    const double d = (newVE.values - oldVE.values).cwiseAbs().maxCoeff();
+
+                    // Keep the closest, we pick the min
+                    closestDistance = std::min(closestDistance, d);
+                    if ( closestDistance <= distance ) break;
+                }
+                // Keep the maximum distance between a new VList and its closest old VList
+                distance = std::max(distance, closestDistance);
+            }
+            if ( begin < end ) distances[begin] = distance;
+        };
+        if ( pool ) pool->parallelFor(changed.size(), compare);
+        else compare(0, changed.size());
+
+        double distance = 0.0;
+        for ( const auto d : distances )
+            distance = std::max(distance, d);
         return distance;
     }
 }
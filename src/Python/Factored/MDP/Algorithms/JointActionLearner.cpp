@@ -112,6 +112,23 @@ void exportFactoredMDPJointActionLearner() {
                  "@return The currently set discount parameter."
         , (arg("self")))
 
+        .def("setJointOpponentModel",       &JointActionLearner::setJointOpponentModel,
+                 "This function sets whether the other agents are modeled with their joint distribution.\n"
+                 "\n"
+                 "By default, the policies of the other agents are estimated\n"
+                 "independently, and their joint policy is the product of\n"
+                 "them. When this is enabled, the empirical distribution of\n"
+                 "their joint actions is used instead.\n"
+                 "\n"
+                 "@param joint Whether to use the joint distribution of the other agents."
+        , (arg("self"), "joint"))
+
+        .def("getJointOpponentModel",       &JointActionLearner::getJointOpponentModel,
+                 "This function returns whether the other agents are modeled with their joint distribution.\n"
+                 "\n"
+                 "@return Whether the joint distribution of the other agents is used."
+        , (arg("self")))
+
         .def("getS",                        &JointActionLearner::getS,
                  "This function returns the number of states on which JointActionLearner is working.\n"
                  "\n"
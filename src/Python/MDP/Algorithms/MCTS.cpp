@@ -13,6 +13,14 @@
 
 #include <boost/python.hpp>
 
+// Planning with C++ models does not need the GIL, while Python models call
+// back into Python during the search.
+template <typename M, auto F>
+constexpr auto releasesGIL() {
+    if constexpr (std::is_same_v<M, AIToolbox::MDP::GenerativeModelPython>) return F;
+    else return &WithoutGIL<F>::call;
+}
+
 template <typename M>
 void exportMCTSByModel(std::string className) {
     using namespace AIToolbox::MDP;
@@ -20,8 +28,8 @@ void exportMCTSByModel(std::string className) {
 
     using V = MCTS<M>;
 
-    size_t (V::*sampleAction1)(size_t, unsigned) = &V::sampleAction;
-    size_t (V::*sampleAction2)(size_t, size_t, unsigned) = &V::sampleAction;
+    constexpr auto sampleAction1 = static_cast<size_t (V::*)(size_t, unsigned)>(&V::sampleAction);
+    constexpr auto sampleAction2 = static_cast<size_t (V::*)(size_t, size_t, unsigned)>(&V::sampleAction);
 
     class_<V>{("MCTS" + className).c_str(), (
 
@@ -62,7 +70,10 @@ void exportMCTSByModel(std::string className) {
          "multiple action requests are done in order. To do so, it simply asks\n"
          "for the action that has been performed and its respective new state.\n"
          "Then it simply makes that root branch the new root, and starts\n"
-         "again." ).c_str(), no_init}
+         "again.\n"
+         "\n"
+         "Except when planning on a GenerativeModelPython, the GIL is released\n"
+         "during sampleAction, so that other Python threads can run." ).c_str(), no_init}
 
         .def(init<const M&, unsigned, double>(
                  "Basic constructor.\n"
@@ -73,7 +84,7 @@ void exportMCTSByModel(std::string className) {
                  "           to determine the final MCTS performance."
         , (arg("self"), "m", "iterations", "exp")))
 
-        .def("sampleAction",            sampleAction1,
+        .def("sampleAction",            releasesGIL<M, sampleAction1>(),
                  "This function resets the internal graph and samples for the provided state and horizon.\n"
                  "\n"
                  "@param s The initial state for the environment.\n"
@@ -82,7 +93,7 @@ void exportMCTSByModel(std::string className) {
                  "@return The best action."
         , (arg("self"), "s", "horizon"))
 
-        .def("sampleAction",            sampleAction2,
+        .def("sampleAction",            releasesGIL<M, sampleAction2>(),
                  "This function uses the internal graph to plan.\n"
                  "\n"
                  "This function can be called after a previous call to\n"
@@ -9,6 +9,8 @@
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 
+#include "../../Utils.hpp"
+
 #include <boost/python.hpp>
 
 void exportMDPPolicyIteration() {
@@ -28,16 +30,20 @@ void exportMDPPolicyIteration() {
          "evaluated, and the process repeated.\n"
          "\n"
          "When the policy does not change anymore, it is guaranteed to be\n"
-         "optimal, and the found QFunction is returned.\n", no_init}
+         "optimal, and the found QFunction is returned.\n"
+         "\n"
+         "The GIL is released while solving, so that other Python threads can\n"
+         "run in the meantime.\n", no_init}
 
-        .def(init<unsigned, optional<double>>(
+        .def(init<unsigned, optional<double, unsigned>>(
                 "Basic constructor.\n"
                 "\n"
-                "@param horizon The horizon parameter to use during the PolicyEvaluation phase.\n"
-                "@param tolerance The tolerance parameter to use during the PolicyEvaluation phase."
-        , (arg("self"), "horizon", "tolerance")))
+                "@param horizon The maximum number of evaluation sweeps for each policy.\n"
+                "@param tolerance The tolerance parameter to use during the PolicyEvaluation phase.\n"
+                "@param maxIterations The maximum number of policies to evaluate, or 0 for no limit."
+        , (arg("self"), "horizon", "tolerance", "maxIterations")))
 
-        .def("__call__",                &PolicyIteration::operator()<Model>,
+        .def("__call__",                &WithoutGIL<&PolicyIteration::operator()<Model>>::call,
                 "This function applies policy iteration on an MDP to solve it.\n"
                 "\n"
                 "The algorithm is constrained by the currently set parameters.\n"
@@ -46,7 +52,7 @@ void exportMDPPolicyIteration() {
                 "@return The QFunction of the optimal policy found."
         , (arg("self"), "m"))
 
-        .def("__call__",                &PolicyIteration::operator()<SparseModel>,
+        .def("__call__",                &WithoutGIL<&PolicyIteration::operator()<SparseModel>>::call,
                 "This function applies policy iteration on an MDP to solve it.\n"
                 "\n"
                 "The algorithm is constrained by the currently set parameters.\n"
@@ -55,7 +61,7 @@ void exportMDPPolicyIteration() {
                 "@return The QFunction of the optimal policy found."
         , (arg("self"), "m"))
 
-        .def("__call__",                &PolicyIteration::operator()<RLModel<Experience>>,
+        .def("__call__",                &WithoutGIL<&PolicyIteration::operator()<RLModel<Experience>>>::call,
                 "This function applies policy iteration on an MDP to solve it.\n"
                 "\n"
                 "The algorithm is constrained by the currently set parameters.\n"
@@ -64,7 +70,7 @@ void exportMDPPolicyIteration() {
                 "@return The QFunction of the optimal policy found."
         , (arg("self"), "m"))
 
-        .def("__call__",                &PolicyIteration::operator()<SparseRLModel<SparseExperience>>,
+        .def("__call__",                &WithoutGIL<&PolicyIteration::operator()<SparseRLModel<SparseExperience>>>::call,
                 "This function applies policy iteration on an MDP to solve it.\n"
                 "\n"
                 "The algorithm is constrained by the currently set parameters.\n"
@@ -83,11 +89,31 @@ void exportMDPPolicyIteration() {
                  "This function sets the horizon parameter."
         , (arg("self"), "horizon"))
 
+        .def("setMaxIterations",        &PolicyIteration::setMaxIterations,
+                 "This function sets the maximum number of policies to evaluate, or 0 for no limit."
+        , (arg("self"), "maxIterations"))
+
+        .def("setModified",             &PolicyIteration::setModified,
+                 "This function sets whether to run modified policy iteration.\n"
+                 "\n"
+                 "In the modified mode, with a discount lower than 1, the\n"
+                 "algorithm does not stop when the policy is stable until the\n"
+                 "last evaluation has also converged within the tolerance."
+        , (arg("self"), "modified"))
+
         .def("getTolerance",            &PolicyIteration::getTolerance,
                  "This function will return the currently set tolerance parameter."
         , (arg("self")))
 
         .def("getHorizon",              &PolicyIteration::getHorizon,
                  "This function will return the current horizon parameter."
+        , (arg("self")))
+
+        .def("getMaxIterations",        &PolicyIteration::getMaxIterations,
+                 "This function will return the current maximum number of iterations."
+        , (arg("self")))
+
+        .def("isModified",              &PolicyIteration::isModified,
+                 "This function will return whether modified policy iteration is enabled."
         , (arg("self")));
 }
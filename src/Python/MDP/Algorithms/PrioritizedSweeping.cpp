@@ -66,7 +66,7 @@ void exportPrioritizedSweepingByModel(std::string className) {
                  "@param a The action performed."
         , (arg("self"), "s", "a"))
 
-        .def("batchUpdateQ",            &V::batchUpdateQ,
+        .def("batchUpdateQ",            static_cast<void (V::*)()>(&V::batchUpdateQ),
                  "This function updates a QFunction based on simulated experience.\n"
                  "\n"
                  "In PrioritizedSweepingEigen we sample from the queue at most N times for\n"
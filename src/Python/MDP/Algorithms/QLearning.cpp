@@ -9,6 +9,8 @@
 
 #include <boost/python.hpp>
 
+#include "../../Utils.hpp"
+
 void exportMDPQLearning() {
     using namespace boost::python;
     using namespace AIToolbox::MDP;
@@ -169,6 +171,35 @@ void exportMDPQLearning() {
                  "@param rew The reward obtained."
         , (arg("self"), "s", "a", "s1", "rew"))
 
+        .def("batchUpdateQ",                +[](QLearning & q, std::vector<size_t> states, std::vector<size_t> actions, std::vector<size_t> nextStates, std::vector<double> rewards) {
+                    TransitionBatch batch;
+                    batch.states = std::move(states);
+                    batch.actions = std::move(actions);
+                    batch.nextStates = std::move(nextStates);
+                    batch.rewards = std::move(rewards);
+
+                    checkPythonIndeces(batch.states, q.getS(), "states");
+                    checkPythonIndeces(batch.actions, q.getA(), "actions");
+                    checkPythonIndeces(batch.nextStates, q.getS(), "nextStates");
+
+                    ScopedGILRelease release;
+                    q.batchUpdateQ(batch);
+                 },
+                 "This function updates the internal QFunction with a batch of transitions.\n"
+                 "\n"
+                 "This function is equivalent to calling stepUpdateQ() on each\n"
+                 "transition of the batch in order, but the whole batch is\n"
+                 "processed in C++, and the GIL is released while it runs.\n"
+                 "\n"
+                 "The arguments can be lists or NumPy arrays, and must all have the\n"
+                 "same length; otherwise this function throws.\n"
+                 "\n"
+                 "@param states The previous states.\n"
+                 "@param actions The actions performed.\n"
+                 "@param nextStates The new states.\n"
+                 "@param rewards The rewards obtained."
+        , (arg("self"), "states", "actions", "nextStates", "rewards"))
+
         .def("getS",                        &QLearning::getS,
                  "This function returns the number of states on which QLearning is working."
         , (arg("self")))
@@ -9,6 +9,8 @@
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 
+#include "../../Utils.hpp"
+
 #include <boost/python.hpp>
 
 void exportMDPValueIteration() {
@@ -30,7 +32,10 @@ void exportMDPValueIteration() {
          "horizon requested is reached.\n"
          "\n"
          "This implementation in particular is ported from the MATLAB\n"
-         "MDPToolbox (although it is simplified).", no_init}
+         "MDPToolbox (although it is simplified).\n"
+         "\n"
+         "The GIL is released while solving, so that other Python threads can\n"
+         "run in the meantime.", no_init}
 
         .def(init<unsigned, optional<double>>(
                  "Basic constructor.\n"
@@ -47,7 +52,7 @@ void exportMDPValueIteration() {
                  "@param tolerance The tolerance factor to stop the value iteration loop."
         , (arg("self"), "horizon", "tolerance")))
 
-        .def("__call__",                &ValueIteration::operator()<Model>,
+        .def("__call__",                &WithoutGIL<&ValueIteration::operator()<Model>>::call,
                  "This function applies value iteration on an MDP to solve it.\n"
                  "\n"
                  "The algorithm is constrained by the currently set parameters.\n"
@@ -58,7 +63,7 @@ void exportMDPValueIteration() {
                  "        QFunction for the Model."
         , (arg("self"), "m"))
 
-        .def("__call__",                &ValueIteration::operator()<SparseModel>,
+        .def("__call__",                &WithoutGIL<&ValueIteration::operator()<SparseModel>>::call,
                  "This function applies value iteration on an MDP to solve it.\n"
                  "\n"
                  "The algorithm is constrained by the currently set parameters.\n"
@@ -69,7 +74,7 @@ void exportMDPValueIteration() {
                  "        QFunction for the Model."
         , (arg("self"), "m"))
 
-        .def("__call__",                &ValueIteration::operator()<RLModel<Experience>>,
+        .def("__call__",                &WithoutGIL<&ValueIteration::operator()<RLModel<Experience>>>::call,
                  "This function applies value iteration on an MDP to solve it.\n"
                  "\n"
                  "The algorithm is constrained by the currently set parameters.\n"
@@ -80,7 +85,7 @@ void exportMDPValueIteration() {
                  "        QFunction for the Model."
         , (arg("self"), "m"))
 
-        .def("__call__",                &ValueIteration::operator()<SparseRLModel<SparseExperience>>,
+        .def("__call__",                &WithoutGIL<&ValueIteration::operator()<SparseRLModel<SparseExperience>>>::call,
                  "This function applies value iteration on an MDP to solve it.\n"
                  "\n"
                  "The algorithm is constrained by the currently set parameters.\n"
@@ -11,7 +11,11 @@ void exportMDPGenerativeModelPython() {
          "\n"
          "This class wraps an instance of a Python class that provides generator\n"
          "methods to sample states and rewards from, so that one does not need to\n"
-         "always specify transition and reward functions from Python.", no_init}
+         "always specify transition and reward functions from Python.\n"
+         "\n"
+         "Calling into Python is expensive, so the number of states, number of\n"
+         "actions and discount are read once on construction, and the bound\n"
+         "methods of the instance are looked up only once.", no_init}
 
         .def(init<boost::python::object>(
                  "Basic constructor."
@@ -27,6 +31,15 @@ void exportMDPGenerativeModelPython() {
                  "- isTerminal(s): returns whether a given state is a terminal state.\n"
                  "- sampleSR(s, a): returns a tuple containing new state and reward, from the input state and action.\n"
                  "\n"
+                 "Optionally, the instance can also provide:\n"
+                 "\n"
+                 "- sampleSRBatch(states, actions): returns a tuple containing a\n"
+                 "  list of new states and a list of rewards, one per input\n"
+                 "  state-action pair. NumPy arrays can be returned as well.\n"
+                 "\n"
+                 "The values of getS(), getA() and getDiscount() are read here,\n"
+                 "and must not change afterwards.\n"
+                 "\n"
                  "@param instance The Python object instance to call methods on."
         , (arg("self"), "instance")))
 
@@ -61,6 +74,35 @@ void exportMDPGenerativeModelPython() {
                  "@return A tuple containing a new state and a reward."
         , (arg("self"), "s", "a"))
 
+        .def("sampleSRBatch",               +[](const GenerativeModelPython & m, std::vector<size_t> states, std::vector<size_t> actions) {
+                    if (states.size() != actions.size()) {
+                        PyErr_SetString(PyExc_ValueError, "states and actions must have the same length");
+                        throw_error_already_set();
+                    }
+                    TransitionBatch batch;
+                    batch.states = std::move(states);
+                    batch.actions = std::move(actions);
+                    m.sampleSRBatch(&batch);
+
+                    list nextStates, rewards;
+                    for (size_t i = 0; i < batch.states.size(); ++i) {
+                        nextStates.append(batch.nextStates[i]);
+                        rewards.append(batch.rewards[i]);
+                    }
+                    return make_tuple(nextStates, rewards);
+                 },
+                 "This function samples a new state and reward for each input state-action pair.\n"
+                 "\n"
+                 "If the wrapped instance provides sampleSRBatch(), it is called\n"
+                 "once for the whole batch. Otherwise sampleSR() is called once per\n"
+                 "pair.\n"
+                 "\n"
+                 "@param states The states that need to be sampled.\n"
+                 "@param actions The actions that need to be sampled.\n"
+                 "\n"
+                 "@return A tuple containing the new states and the rewards."
+        , (arg("self"), "states", "actions"))
+
         .def("isTerminal",                  &GenerativeModelPython::isTerminal,
                 "This function returns whether a given state is a terminal."
         , (arg("self"), "s"));
@@ -1,9 +1,14 @@
 #ifndef AI_TOOLBOX_MDP_GENERATIVE_MODEL_PYTHON_HEADER_FILE
 #define AI_TOOLBOX_MDP_GENERATIVE_MODEL_PYTHON_HEADER_FILE
 
+#include <AIToolbox/MDP/Types.hpp>
+
 #include <boost/python.hpp>
 #include <boost/python/object.hpp>
 
+#include <tuple>
+#include <vector>
+
 namespace AIToolbox::MDP {
     /**
      * @brief This class allows to import generative models from Python.
@@ -11,6 +16,10 @@ namespace AIToolbox::MDP {
      * This class wraps an instance of a Python class that provides generator
      * methods to sample states and rewards from, so that one does not need to
      * always specify transition and reward functions from Python.
+     *
+     * Calling into Python is expensive, so the number of states, number of
+     * actions and discount are read once on construction, and the bound
+     * methods of the instance are looked up only once.
      */
     class GenerativeModelPython {
         public:
@@ -28,40 +37,100 @@ namespace AIToolbox::MDP {
              * - isTerminal(s): returns whether a given state is a terminal state.
              * - sampleSR(s, a): returns a tuple containing new state and reward, from the input state and action.
              *
+             * Optionally, the instance can also provide:
+             *
+             * - sampleSRBatch(states, actions): returns a tuple containing a
+             *   list of new states and a list of rewards, one per input
+             *   state-action pair. NumPy arrays can be returned as well.
+             *
+             * The values of getS(), getA() and getDiscount() are read here,
+             * and must not change afterwards.
+             *
              * @param instance The Python object instance to call methods on.
              */
             GenerativeModelPython(boost::python::object instance) :
-                    instance_(instance) {}
+                    instance_(instance),
+                    S(boost::python::extract<size_t>(instance.attr("getS")())),
+                    A(boost::python::extract<size_t>(instance.attr("getA")())),
+                    discount_(boost::python::extract<double>(instance.attr("getDiscount")())),
+                    isTerminal_(instance.attr("isTerminal")),
+                    sampleSR_(instance.attr("sampleSR"))
+            {
+                if (PyObject_HasAttrString(instance.ptr(), "sampleSRBatch"))
+                    sampleSRBatch_ = instance.attr("sampleSRBatch");
+            }
 
             /**
              * @brief This function returns the number of states of the environment.
              */
-            size_t getS() const { return boost::python::extract<size_t>(instance_.attr("getS")()); }
+            size_t getS() const { return S; }
 
             /**
              * @brief This function returns the number of actions of the environment.
              */
-            size_t getA() const { return boost::python::extract<size_t>(instance_.attr("getA")()); }
+            size_t getA() const { return A; }
 
             /**
              * @brief This function returns the discount of the environment.
              */
-            double getDiscount() const { return boost::python::extract<double>(instance_.attr("getDiscount")()); }
+            double getDiscount() const { return discount_; }
 
             /**
              * @brief This function returns whether a given state is a terminal state.
              */
-            bool isTerminal(const size_t s) const { return boost::python::extract<bool>(instance_.attr("isTerminal")(s)); }
+            bool isTerminal(const size_t s) const { return boost::python::extract<bool>(isTerminal_(s)); }
 
             /**
              * @brief This function returns a tuple containing a new state and reward, from the input state and action.
              */
             std::tuple<size_t, double> sampleSR(const size_t s, const size_t a) const {
-                return boost::python::extract<std::tuple<size_t, double>>(instance_.attr("sampleSR")(s, a));
+                return boost::python::extract<std::tuple<size_t, double>>(sampleSR_(s, a));
+            }
+
+            /**
+             * @brief This function samples a new state and reward for each state-action pair in the batch.
+             *
+             * If the instance provides sampleSRBatch(), the whole batch is
+             * sampled with a single call into Python. Otherwise sampleSR()
+             * is called once per pair.
+             *
+             * The nextStates and rewards of the batch are resized and
+             * overwritten.
+             *
+             * @param batch The batch to sample.
+             */
+            void sampleSRBatch(TransitionBatch * batch) const {
+                const size_t N = batch->states.size();
+                batch->nextStates.resize(N);
+                batch->rewards.resize(N);
+
+                if (sampleSRBatch_.is_none()) {
+                    for (size_t i = 0; i < N; ++i)
+                        std::tie(batch->nextStates[i], batch->rewards[i]) = sampleSR(batch->states[i], batch->actions[i]);
+                    return;
+                }
+
+                boost::python::list states, actions;
+                for (size_t i = 0; i < N; ++i) {
+                    states.append(batch->states[i]);
+                    actions.append(batch->actions[i]);
+                }
+                const boost::python::object result = sampleSRBatch_(states, actions);
+
+                batch->nextStates = boost::python::extract<std::vector<size_t>>(result[0]);
+                batch->rewards = boost::python::extract<std::vector<double>>(result[1]);
+
+                if (batch->nextStates.size() != N || batch->rewards.size() != N) {
+                    PyErr_SetString(PyExc_ValueError, "sampleSRBatch must return one new state and reward per input pair");
+                    boost::python::throw_error_already_set();
+                }
             }
 
         private:
             boost::python::object instance_;
+            size_t S, A;
+            double discount_;
+            boost::python::object isTerminal_, sampleSR_, sampleSRBatch_;
     };
 }
 
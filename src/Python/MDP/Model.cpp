@@ -8,6 +8,8 @@
 
 #include <boost/python.hpp>
 
+#include "../Utils.hpp"
+
 void exportMDPModel() {
     using namespace AIToolbox::MDP;
     using namespace boost::python;
@@ -149,7 +151,7 @@ void exportMDPModel() {
                 "This function returns the currently set discount factor."
         , (arg("self")))
 
-        .def("sampleSR",                    &Model::sampleSR,
+        .def("sampleSR",                    static_cast<std::tuple<size_t, double>(Model::*)(size_t, size_t) const>(&Model::sampleSR),
                  "This function samples the MDP for the specified state action pair.\n"
                  "\n"
                  "This function samples the model for simulated experience.\n"
@@ -168,6 +170,23 @@ void exportMDPModel() {
                  "@return A tuple containing a new state and a reward."
         , (arg("self"), "s", "a"))
 
+        .def("sampleSRBatch",               &sampleSRBatchPython<Model>,
+                 "This function samples the MDP for many state action pairs.\n"
+                 "\n"
+                 "This function is equivalent to calling sampleSR() for each\n"
+                 "pair, but all samples are drawn in C++, and the GIL is\n"
+                 "released while they are.\n"
+                 "\n"
+                 "The arguments can be lists or NumPy arrays, and must have the\n"
+                 "same length.\n"
+                 "\n"
+                 "@param states The states that need to be sampled.\n"
+                 "@param actions The actions that need to be sampled.\n"
+                 "\n"
+                 "@return A tuple containing the new states and the rewards; both\n"
+                 "can be viewed as NumPy arrays without copies."
+        , (arg("self"), "states", "actions"))
+
         .def("getTransitionProbability",    &Model::getTransitionProbability,
                 "This function returns the stored transition probability for the specified transition."
         , (arg("self"), "s", "a", "s1"))
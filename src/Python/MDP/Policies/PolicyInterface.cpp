@@ -2,6 +2,8 @@
 
 #include <boost/python.hpp>
 
+#include "../../Utils.hpp"
+
 void exportMDPPolicyInterface() {
     using namespace AIToolbox;
     using namespace boost::python;
@@ -26,6 +28,28 @@ void exportMDPPolicyInterface() {
              "@return The chosen action."
         , (arg("self"), "s"))
 
+        .def("sampleActions",           +[](const MDP::PolicyInterface & p, const std::vector<size_t> & states) {
+                checkPythonIndeces(states, p.getS(), "states");
+
+                std::vector<size_t> actions;
+                {
+                    ScopedGILRelease release;
+                    p.sampleActions(states, &actions);
+                }
+                return actions;
+             },
+             "This function samples an action for each of the input states.\n"
+             "\n"
+             "This is equivalent to calling sampleAction() for each state, but\n"
+             "all actions are sampled in C++, and the GIL is released while\n"
+             "they are.\n"
+             "\n"
+             "@param states The states to sample actions for, as a list or a NumPy array.\n"
+             "\n"
+             "@return The chosen actions, which can be viewed as a NumPy array\n"
+             "without copies."
+        , (arg("self"), "states"))
+
         .def("getActionProbability",    &MDP::PolicyInterface::getActionProbability,
              "This function returns the probability of taking the specified action in the specified state.\n"
              "\n"
@@ -20,8 +20,9 @@ void exportPOMCPByModel(std::string className) {
 
     using V = POMCP<M>;
 
-    size_t (V::*sampleAction1)(const Belief &, unsigned) = &V::sampleAction;
-    size_t (V::*sampleAction2)(size_t, size_t, unsigned) = &V::sampleAction;
+    // Planning does not need the GIL, so we release it.
+    constexpr auto sampleAction1 = &WithoutGIL<static_cast<size_t (V::*)(const Belief &, unsigned)>(&V::sampleAction)>::call;
+    constexpr auto sampleAction2 = &WithoutGIL<static_cast<size_t (V::*)(size_t, size_t, unsigned)>(&V::sampleAction)>::call;
 
     class_<V>{("POMCP" + className).c_str(), (
 
@@ -68,14 +69,20 @@ void exportPOMCPByModel(std::string className) {
          "In order to avoid performing belief updates between each\n"
          "action/observation pair, which can be expensive, POMCP uses particle\n"
          "beliefs. These approximate the beliefs at every step, and are used\n"
-         "to select states in the rollouts.\n"
+         "to select states in the rollouts. Particles are stored as\n"
+         "(state, count) pairs, and the number of distinct states kept in each\n"
+         "node can be capped.\n"
          "\n"
-         "A weakness of this implementation is that, as every particle\n"
-         "approximation of continuous values, it will lose particles in time.\n"
-         "To fight this a possibility is to implement a particle\n"
-         "reinvigoration method, which would introduce noise in the particle\n"
-         "beliefs in order to keep them 'fresh' (possibly using domain\n"
-         "knowledge).").c_str(), no_init}
+         "A weakness of particle beliefs is that, as every particle\n"
+         "approximation of continuous values, they lose particles in time. To\n"
+         "fight this POMCP can reinvigorate the belief of the new root when\n"
+         "reusing the tree: if it contains too few particles, new ones are\n"
+         "generated by sampling transitions from the particles of the old\n"
+         "root, and keeping the ones that produce the observation actually\n"
+         "received.\n"
+         "\n"
+         "The GIL is released during sampleAction, so that other Python threads\n"
+         "can run.").c_str(), no_init}
 
         .def(init<const M&, size_t, unsigned, double>(
                  "Basic constructor.\n"
@@ -113,9 +120,11 @@ void exportPOMCPByModel(std::string className) {
                  "using the existing graph: this should make search faster,\n"
                  "and also not require any belief updates.\n"
                  "\n"
-                 "NOTE: Currently there is no particle reinvigoration\n"
-                 "implemented, so for long horizons you can expect\n"
-                 "progressively degrading performances.\n"
+                 "If the minimum number of particles is set (see\n"
+                 "setMinParticles()), the belief of the selected branch is\n"
+                 "reinvigorated before searching when it contains fewer\n"
+                 "particles than that. Otherwise, or if reinvigoration fails,\n"
+                 "the search is restarted from a uniform belief.\n"
                  "\n"
                  "@param a The action taken in the last timestep.\n"
                  "@param o The observation received in the last timestep.\n"
@@ -134,6 +143,27 @@ void exportPOMCPByModel(std::string className) {
                  "@param beliefSize The new particle belief size."
         , (arg("self"), "beliefSize"))
 
+        .def("setMaxParticles",         &V::setMaxParticles,
+                 "This function sets the maximum number of distinct states stored in each particle belief within the tree.\n"
+                 "\n"
+                 "Once a node's belief contains this many distinct states,\n"
+                 "further particles for new states are discarded. Beliefs of\n"
+                 "nodes already in the tree are not affected.\n"
+                 "\n"
+                 "@param maxParticles The new maximum number of distinct states, or zero for no limit."
+        , (arg("self"), "maxParticles"))
+
+        .def("setMinParticles",         &V::setMinParticles,
+                 "This function sets the minimum number of particles below which the new root belief is reinvigorated.\n"
+                 "\n"
+                 "Reinvigoration samples states from the old root belief,\n"
+                 "samples transitions from them with the action taken, and\n"
+                 "keeps the resulting states that produce the observation\n"
+                 "received.\n"
+                 "\n"
+                 "@param minParticles The new minimum number of particles, or zero to disable reinvigoration."
+        , (arg("self"), "minParticles"))
+
         .def("setIterations",           &V::setIterations,
                  "This function sets the number of performed rollouts in POMCP."
         , (arg("self"), "iterations"))
@@ -158,6 +188,14 @@ void exportPOMCPByModel(std::string className) {
                  "This function returns the initial particle size for converted Beliefs."
         , (arg("self")))
 
+        .def("getMaxParticles",         &V::getMaxParticles,
+                 "This function returns the maximum number of distinct states stored in each particle belief within the tree."
+        , (arg("self")))
+
+        .def("getMinParticles",         &V::getMinParticles,
+                 "This function returns the minimum number of particles below which the new root belief is reinvigorated."
+        , (arg("self")))
+
         .def("getIterations",           &V::getIterations,
                  "This function returns the number of iterations performed to plan for an action."
         , (arg("self")))
@@ -2,6 +2,8 @@
 
 #include <boost/python.hpp>
 
+#include "../../Utils.hpp"
+
 void exportPOMDPPolicy() {
     using namespace AIToolbox::POMDP;
     using namespace boost::python;
@@ -116,6 +118,27 @@ void exportPOMDPPolicy() {
                  "        next timestep, if required."
     , (arg("self"), "id", "o", "horizon"))
 
+    .def("sampleActions",   +[](const Policy & p, const AIToolbox::Matrix2D & beliefs) {
+                    if (static_cast<size_t>(beliefs.cols()) != p.getS()) {
+                        PyErr_SetString(PyExc_ValueError, "beliefs must have one column per state");
+                        throw_error_already_set();
+                    }
+                    ScopedGILRelease release;
+                    return p.sampleActions(beliefs);
+                 },
+                 "This function chooses an action for each of the input beliefs.\n"
+                 "\n"
+                 "This function is equivalent to calling sampleAction() for each\n"
+                 "belief, but all actions are chosen in C++ at once, and the GIL\n"
+                 "is released while they are.\n"
+                 "\n"
+                 "@param beliefs The beliefs to sample actions for, one per row,\n"
+                 "               as a Matrix2D or a 2D NumPy array.\n"
+                 "\n"
+                 "@return The chosen actions, which can be viewed as a NumPy array\n"
+                 "        without copies."
+    , (arg("self"), "beliefs"))
+
     .def("getActionProbability", static_cast<double(Policy::*)(const Belief&,size_t,unsigned) const>(&Policy::getActionProbability),
                  "This function returns the probability of taking the specified action in the specified belief.\n"
                  "\n"
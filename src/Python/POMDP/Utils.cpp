@@ -23,6 +23,23 @@ std::vector<std::pair<AIToolbox::Vector, double>> findVerticesNaiveWrapper(const
 using POMDPModelBinded = AIToolbox::POMDP::Model<AIToolbox::MDP::Model>;
 using POMDPSparseModelBinded = AIToolbox::POMDP::SparseModel<AIToolbox::MDP::SparseModel>;
 
+/// Wrapper for Python of the batched updateBeliefs, which checks its inputs and releases the GIL.
+template <typename M>
+AIToolbox::Matrix2D updateBeliefsWrapper(const M & model, const AIToolbox::Matrix2D & beliefs, const std::vector<size_t> & actions, const std::vector<size_t> & observations) {
+    const size_t N = beliefs.rows();
+    if (static_cast<size_t>(beliefs.cols()) != model.getS() || actions.size() != N || observations.size() != N) {
+        PyErr_SetString(PyExc_ValueError, "beliefs must have one column per state, and one action and observation per row");
+        boost::python::throw_error_already_set();
+    }
+    checkPythonIndeces(actions, model.getA(), "actions");
+    checkPythonIndeces(observations, model.getO(), "observations");
+
+    AIToolbox::Matrix2D retval;
+    ScopedGILRelease release;
+    AIToolbox::POMDP::updateBeliefs(model, beliefs, actions, observations, &retval);
+    return retval;
+}
+
 void exportPOMDPUtils() {
     using namespace boost::python;
     using namespace AIToolbox::POMDP;
@@ -49,6 +66,40 @@ void exportPOMDPUtils() {
         "@param o The observation registered"
     , (args("model"), "b", "a", "o")
     );
+    def("updateBeliefs", &updateBeliefsWrapper<POMDPModelBinded>,
+        "This function updates many beliefs at once, each with its own action and observation.\n"
+        "\n"
+        "This function is equivalent to calling updateBelief() on each\n"
+        "belief, but all beliefs are updated in C++ with a few matrix\n"
+        "products, and the GIL is released while they are.\n"
+        "\n"
+        "As for updateBelief(), the update must be possible for all beliefs.\n"
+        "\n"
+        "@param model The model used to update the beliefs\n"
+        "@param beliefs The old beliefs, one per row\n"
+        "@param actions The action taken from each belief\n"
+        "@param observations The observation registered for each belief\n"
+        "\n"
+        "@return The new beliefs, one per row."
+    , (args("model"), "beliefs", "actions", "observations")
+    );
+    def("updateBeliefs", &updateBeliefsWrapper<POMDPSparseModelBinded>,
+        "This function updates many beliefs at once, each with its own action and observation.\n"
+        "\n"
+        "This function is equivalent to calling updateBelief() on each\n"
+        "belief, but all beliefs are updated in C++ with a few matrix\n"
+        "products, and the GIL is released while they are.\n"
+        "\n"
+        "As for updateBelief(), the update must be possible for all beliefs.\n"
+        "\n"
+        "@param model The model used to update the beliefs\n"
+        "@param beliefs The old beliefs, one per row\n"
+        "@param actions The action taken from each belief\n"
+        "@param observations The observation registered for each belief\n"
+        "\n"
+        "@return The new beliefs, one per row."
+    , (args("model"), "beliefs", "actions", "observations")
+    );
 
     // We'll move the function below in another file at some point.
     using VVPair = std::pair<AIToolbox::Vector, double>;
@@ -25,17 +25,141 @@ int getVectorLen(const AIToolbox::Vector& v) {
 }
 
 double getMatrix2DItem(const AIToolbox::Matrix2D& m, boost::python::tuple i) {
-    return m(boost::python::extract<int>(i[0]), boost::python::extract<int>(i[1]));
+    return m(int(boost::python::extract<int>(i[0])), int(boost::python::extract<int>(i[1])));
 }
 
 void setMatrix2DItem(AIToolbox::Matrix2D & m, boost::python::tuple i, double value) {
-    m(boost::python::extract<int>(i[0]), boost::python::extract<int>(i[1])) = value;
+    m(int(boost::python::extract<int>(i[0])), int(boost::python::extract<int>(i[1]))) = value;
 }
 
 boost::python::tuple getMatrix2DShape(const AIToolbox::Matrix2D& m) {
     return boost::python::make_tuple(m.rows(), m.cols());
 }
 
+// Exports the memory of an Eigen dense matrix through the Python buffer
+// protocol, so that NumPy (or memoryview) can view it without copies.
+// Matrix2D is row-major, so views are C-contiguous.
+template <typename M>
+struct EigenBuffer {
+    static int getBuffer(PyObject * obj, Py_buffer * view, int flags) {
+        boost::python::extract<M&> e(obj);
+        if (!e.check()) {
+            PyErr_SetString(PyExc_BufferError, "object does not contain an Eigen matrix");
+            view->obj = nullptr;
+            return -1;
+        }
+        M & m = e();
+
+        constexpr int ndim = M::IsVectorAtCompileTime ? 1 : 2;
+        if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && ndim == 2 && m.rows() > 1 && m.cols() > 1) {
+            PyErr_SetString(PyExc_BufferError, "Eigen matrix is not Fortran contiguous");
+            view->obj = nullptr;
+            return -1;
+        }
+
+        // Shape and strides, freed in releaseBuffer.
+        auto sizes = new Py_ssize_t[2 * ndim];
+        if constexpr (ndim == 1) {
+            sizes[0] = m.size();
+            sizes[1] = sizeof(double);
+        } else {
+            sizes[0] = m.rows();
+            sizes[1] = m.cols();
+            sizes[2] = m.cols() * sizeof(double);
+            sizes[3] = sizeof(double);
+        }
+
+        view->obj = boost::python::incref(obj);
+        view->buf = m.data();
+        view->len = m.size() * sizeof(double);
+        view->readonly = 0;
+        view->itemsize = sizeof(double);
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>("d") : nullptr;
+        view->ndim = ndim;
+        view->shape = (flags & PyBUF_ND) == PyBUF_ND ? sizes : nullptr;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? sizes + ndim : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = sizes;
+        return 0;
+    }
+
+    static void releaseBuffer(PyObject *, Py_buffer * view) {
+        delete [] static_cast<Py_ssize_t *>(view->internal);
+    }
+
+    // Note that views point directly to the matrix data, and so they
+    // must not outlive the matrix.
+    static void enable(const boost::python::object & cls) {
+        static PyBufferProcs procs;
+        procs.bf_getbuffer = &getBuffer;
+        procs.bf_releasebuffer = &releaseBuffer;
+
+        auto type = reinterpret_cast<PyTypeObject *>(cls.ptr());
+        type->tp_as_buffer = &procs;
+#if PY_MAJOR_VERSION < 3
+        type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    }
+};
+
+// Exports the memory of a std::vector of integers through the Python buffer
+// protocol, as EigenBuffer does for Eigen matrices. This allows batched
+// functions to return indeces which NumPy can view without copies.
+template <typename T>
+struct StdVectorBuffer {
+    static const char * format() {
+        if constexpr (std::is_same_v<T, unsigned>)           return "I";
+        else if constexpr (std::is_same_v<T, unsigned long>) return "L";
+        else                                                 return "Q";
+    }
+
+    static int getBuffer(PyObject * obj, Py_buffer * view, int flags) {
+        boost::python::extract<std::vector<T>&> e(obj);
+        if (!e.check()) {
+            PyErr_SetString(PyExc_BufferError, "object does not contain a std::vector");
+            view->obj = nullptr;
+            return -1;
+        }
+        auto & v = e();
+
+        // Shape and strides, freed in releaseBuffer.
+        auto sizes = new Py_ssize_t[2];
+        sizes[0] = v.size();
+        sizes[1] = sizeof(T);
+
+        view->obj = boost::python::incref(obj);
+        view->buf = v.data();
+        view->len = v.size() * sizeof(T);
+        view->readonly = 0;
+        view->itemsize = sizeof(T);
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(format()) : nullptr;
+        view->ndim = 1;
+        view->shape = (flags & PyBUF_ND) == PyBUF_ND ? sizes : nullptr;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? sizes + 1 : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = sizes;
+        return 0;
+    }
+
+    static void releaseBuffer(PyObject *, Py_buffer * view) {
+        delete [] static_cast<Py_ssize_t *>(view->internal);
+    }
+
+    // Views point directly to the vector data, so they must not outlive
+    // the vector, nor be used after it is resized.
+    static void enable(const boost::python::object & cls) {
+        static PyBufferProcs procs;
+        procs.bf_getbuffer = &getBuffer;
+        procs.bf_releasebuffer = &releaseBuffer;
+
+        auto type = reinterpret_cast<PyTypeObject *>(cls.ptr());
+        type->tp_as_buffer = &procs;
+#if PY_MAJOR_VERSION < 3
+        type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    }
+};
+
 struct VectorPickle : boost::python::pickle_suite {
     static boost::python::tuple getinitargs(const AIToolbox::Vector& v) {
         using namespace boost::python;
@@ -120,30 +244,48 @@ void exportTypes() {
     using namespace AIToolbox;
     using namespace boost::python;
 
-    // Eigen Vector
-    class_<Vector>{"Vector", init<int>()}
-        .def("__getitem__", &getVectorItem)
-        .def("__setitem__", &setVectorItem)
-        .def("__len__",     &getVectorLen)
-        .def_pickle(VectorPickle());
+    // Eigen Vector. It supports the buffer protocol, so that
+    // numpy.asarray(v) is a view on its data.
+    EigenBuffer<Vector>::enable(
+        class_<Vector>{"Vector", init<int>()}
+            .def("__getitem__", &getVectorItem)
+            .def("__setitem__", &setVectorItem)
+            .def("__len__",     &getVectorLen)
+            .def_pickle(VectorPickle())
+    );
 
+    // Accepts lists and 1D NumPy arrays.
     EigenVectorFromPython();
 
-    // 2D Eigen matrix
-    class_<Matrix2D>{"Matrix2D", init<int, int>()}
-        .def("__getitem__", &getMatrix2DItem)
-        .def("__setitem__", &setMatrix2DItem)
-        .add_property("shape",       &getMatrix2DShape)
-        .def_pickle(Matrix2DPickle());
+    // 2D Eigen matrix (and QFunction). As Vector, it can be viewed from
+    // NumPy without copies.
+    EigenBuffer<Matrix2D>::enable(
+        class_<Matrix2D>{"Matrix2D", init<int, int>()}
+            .def("__getitem__", &getMatrix2DItem)
+            .def("__setitem__", &setMatrix2DItem)
+            .add_property("shape",       &getMatrix2DShape)
+            .def_pickle(Matrix2DPickle())
+    );
+
+    // Accepts 2D NumPy arrays.
+    EigenMatrix2DFromPython();
 
-    // std::vector<size_t> (actions...)
-    class_<std::vector<size_t>>{"vec_size_t"}
-        .def(vector_indexing_suite<std::vector<size_t>>());
+    // std::vector<size_t> (actions...). It supports the buffer protocol,
+    // so that the results of batched functions can be viewed from NumPy.
+    StdVectorBuffer<size_t>::enable(
+        class_<std::vector<size_t>>{"vec_size_t"}
+            .def(vector_indexing_suite<std::vector<size_t>>())
+    );
     VectorFromPython<size_t>();
 
+    // std::vector<double> (rewards...), only from Python
+    VectorFromPython<double>();
+
     // std::vector<unsigned> (counts...)
-    class_<std::vector<unsigned>>{"vec_uint"}
-        .def(vector_indexing_suite<std::vector<unsigned>>());
+    StdVectorBuffer<unsigned>::enable(
+        class_<std::vector<unsigned>>{"vec_uint"}
+            .def(vector_indexing_suite<std::vector<unsigned>>())
+    );
 
     // vector of Vectors, because why not
     class_<std::vector<Vector>>{"vec_eigen_v"}
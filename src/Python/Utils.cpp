@@ -2,6 +2,36 @@
 
 #include <AIToolbox/Types.hpp>
 
+PythonBuffer::PythonBuffer(PyObject * obj) : valid_(false), format_(0) {
+    if (!PyObject_CheckBuffer(obj)) return;
+    if (PyObject_GetBuffer(obj, &view_, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+        PyErr_Clear();
+        return;
+    }
+
+    const char * format = view_.format ? view_.format : "B";
+    // We only accept native byte order.
+    const unsigned short one = 1;
+    const char native = *reinterpret_cast<const char *>(&one) ? '<' : '>';
+    if (*format == '@' || *format == '=' || *format == native) ++format;
+
+    if (format[0] && !format[1] && std::strchr("dfbBhHiIlLqQ?", format[0]))
+        format_ = format[0];
+
+    // Unsupported buffers are released immediately.
+    if (!format_ || view_.ndim < 1) PyBuffer_Release(&view_);
+    else valid_ = true;
+}
+
+PythonBuffer::~PythonBuffer() {
+    if (valid_) PyBuffer_Release(&view_);
+}
+
+bool PythonBuffer::valid() const { return valid_; }
+int PythonBuffer::ndim() const { return valid_ ? view_.ndim : 0; }
+Py_ssize_t PythonBuffer::shape(const int d) const { return view_.shape[d]; }
+const void * PythonBuffer::data() const { return view_.buf; }
+
 EigenVectorFromPython::EigenVectorFromPython() {
     boost::python::converter::registry::push_back(
         &EigenVectorFromPython::convertible,
@@ -11,22 +41,66 @@ EigenVectorFromPython::EigenVectorFromPython() {
 }
 
 void* EigenVectorFromPython::convertible(PyObject* obj_ptr) {
-    if (!PyList_Check(obj_ptr)) return 0;
-    return obj_ptr;
+    if (PyList_Check(obj_ptr)) return obj_ptr;
+    if (PythonBuffer(obj_ptr).ndim() == 1) return obj_ptr;
+    return 0;
 }
 
-void EigenVectorFromPython::construct(PyObject* list, boost::python::converter::rvalue_from_python_stage1_data* data)
+void EigenVectorFromPython::construct(PyObject* obj, boost::python::converter::rvalue_from_python_stage1_data* data)
 {
     // Grab pointer to memory into which to construct the new Vector
     void* storage = ((boost::python::converter::rvalue_from_python_storage<AIToolbox::Vector>*)data)->storage.bytes;
 
     AIToolbox::Vector& v = *(new (storage) AIToolbox::Vector());
 
-    // Copy item by item the list
-    auto size = PyList_Size(list);
-    v.resize(size);
-    for(decltype(size) i = 0; i < size; ++i)
-        v[i] = boost::python::extract<double>(PyList_GetItem(list, i));
+    if (PyList_Check(obj)) {
+        // Copy item by item the list
+        auto size = PyList_Size(obj);
+        v.resize(size);
+        for(decltype(size) i = 0; i < size; ++i)
+            v[i] = boost::python::extract<double>(PyList_GetItem(obj, i));
+    } else {
+        PythonBuffer buffer(obj);
+        v.resize(buffer.shape(0));
+        if (buffer.isContiguous<double>())
+            std::memcpy(v.data(), buffer.data(), v.size() * sizeof(double));
+        else
+            for (Py_ssize_t i = 0; i < buffer.shape(0); ++i)
+                v[i] = buffer.get<double>(i);
+    }
+
+    // Stash the memory chunk pointer for later use by boost.python
+    data->convertible = storage;
+}
+
+EigenMatrix2DFromPython::EigenMatrix2DFromPython() {
+    boost::python::converter::registry::push_back(
+        &EigenMatrix2DFromPython::convertible,
+        &EigenMatrix2DFromPython::construct,
+        boost::python::type_id<AIToolbox::Matrix2D>(
+    ));
+}
+
+void* EigenMatrix2DFromPython::convertible(PyObject* obj_ptr) {
+    if (PythonBuffer(obj_ptr).ndim() == 2) return obj_ptr;
+    return 0;
+}
+
+void EigenMatrix2DFromPython::construct(PyObject* obj, boost::python::converter::rvalue_from_python_stage1_data* data)
+{
+    // Grab pointer to memory into which to construct the new Matrix2D
+    void* storage = ((boost::python::converter::rvalue_from_python_storage<AIToolbox::Matrix2D>*)data)->storage.bytes;
+
+    PythonBuffer buffer(obj);
+    AIToolbox::Matrix2D& m = *(new (storage) AIToolbox::Matrix2D(buffer.shape(0), buffer.shape(1)));
+
+    // Matrix2D is row-major, so C-contiguous arrays can be copied in bulk.
+    if (buffer.isContiguous<double>())
+        std::memcpy(m.data(), buffer.data(), m.size() * sizeof(double));
+    else
+        for (Py_ssize_t i = 0; i < buffer.shape(0); ++i)
+            for (Py_ssize_t j = 0; j < buffer.shape(1); ++j)
+                m(i, j) = buffer.get<double>(i, j);
 
     // Stash the memory chunk pointer for later use by boost.python
     data->convertible = storage;
@@ -2,11 +2,16 @@
 #define AI_TOOLBOX_PYTHON_UTILS_HEADER_FILE
 
 #include <cstddef>
+#include <cstring>
 #include <vector>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <boost/python.hpp>
 
+#include <AIToolbox/Types.hpp>
+
 // C++ to Python
 
 template <typename T>
@@ -51,6 +56,219 @@ struct PairToPython {
     }
 };
 
+// Releasing the GIL
+
+/**
+ * @brief This class releases the GIL for as long as it is alive.
+ *
+ * No Python object must be touched while the GIL is released.
+ */
+class ScopedGILRelease {
+    public:
+        ScopedGILRelease() : state_(PyEval_SaveThread()) {}
+        ~ScopedGILRelease() { PyEval_RestoreThread(state_); }
+
+        ScopedGILRelease(const ScopedGILRelease &) = delete;
+        ScopedGILRelease & operator=(const ScopedGILRelease &) = delete;
+
+    private:
+        PyThreadState * state_;
+};
+
+/**
+ * @brief This struct wraps a member function so that it runs without the GIL.
+ *
+ * This allows other Python threads to run while long C++ computations
+ * are in progress. It should be used as
+ *
+ *     .def("__call__", &WithoutGIL<&V::operator()>::call, ...)
+ *
+ * The wrapped function must not call back into Python. Arguments and
+ * results are converted while the GIL is held. The caller is responsible
+ * not to modify the objects used by the call from other threads while it
+ * runs.
+ */
+template <auto F>
+struct WithoutGIL;
+
+template <typename R, typename C, typename... Args, R (C::*F)(Args...)>
+struct WithoutGIL<F> {
+    static R call(C & c, Args... args) {
+        ScopedGILRelease release;
+        return (c.*F)(std::forward<Args>(args)...);
+    }
+};
+
+template <typename R, typename C, typename... Args, R (C::*F)(Args...) const>
+struct WithoutGIL<F> {
+    static R call(const C & c, Args... args) {
+        ScopedGILRelease release;
+        return (c.*F)(std::forward<Args>(args)...);
+    }
+};
+
+/**
+ * @brief This function raises a Python ValueError if any input index is out of range.
+ *
+ * Batched functions read many indeces at once from Python, and C++ does
+ * not check them, so this must be called before releasing the GIL.
+ *
+ * @param v The indeces to check.
+ * @param bound The number of valid indeces.
+ * @param name The name of the argument, for the error message.
+ */
+inline void checkPythonIndeces(const std::vector<size_t> & v, const size_t bound, const char * name) {
+    for (const auto i : v) {
+        if (i >= bound) {
+            PyErr_Format(PyExc_ValueError, "%s contains an out of range index", name);
+            boost::python::throw_error_already_set();
+        }
+    }
+}
+
+/**
+ * @brief This function samples a generative model for many state-action pairs at once.
+ *
+ * The indeces are checked with the GIL held, and the samples are then
+ * drawn without it.
+ *
+ * @param m The model to sample.
+ * @param states The states to sample.
+ * @param actions The actions to sample, one per state.
+ *
+ * @return A tuple containing the new states and the rewards.
+ */
+template <typename M>
+boost::python::tuple sampleSRBatchPython(const M & m, const std::vector<size_t> & states, const std::vector<size_t> & actions) {
+    if (states.size() != actions.size()) {
+        PyErr_SetString(PyExc_ValueError, "states and actions must have the same length");
+        boost::python::throw_error_already_set();
+    }
+    checkPythonIndeces(states, m.getS(), "states");
+    checkPythonIndeces(actions, m.getA(), "actions");
+
+    std::vector<size_t> nextStates(states.size());
+    AIToolbox::Vector rewards(states.size());
+    {
+        ScopedGILRelease release;
+        for (size_t i = 0; i < states.size(); ++i)
+            std::tie(nextStates[i], rewards[i]) = m.sampleSR(states[i], actions[i]);
+    }
+    return boost::python::make_tuple(std::move(nextStates), std::move(rewards));
+}
+
+// Python buffers
+
+/**
+ * @brief This class reads numbers from any Python object exporting a buffer.
+ *
+ * This allows to read NumPy arrays (and array.array, memoryview, ...)
+ * directly from their memory, rather than extracting their elements one
+ * by one through Python. Any strides are supported, and elements are
+ * converted to the requested type as they are read.
+ *
+ * The buffer is released on destruction.
+ */
+class PythonBuffer {
+    public:
+        /**
+         * @brief Basic constructor.
+         *
+         * If the object does not export a buffer of a supported numeric
+         * format, this class is not valid. No Python error is left set.
+         *
+         * @param obj The object to read.
+         */
+        PythonBuffer(PyObject * obj);
+
+        ~PythonBuffer();
+
+        PythonBuffer(const PythonBuffer &) = delete;
+        PythonBuffer & operator=(const PythonBuffer &) = delete;
+
+        /**
+         * @brief This function returns whether the buffer was acquired and can be read.
+         */
+        bool valid() const;
+
+        /**
+         * @brief This function returns the number of dimensions of the buffer.
+         */
+        int ndim() const;
+
+        /**
+         * @brief This function returns the size of the input dimension.
+         */
+        Py_ssize_t shape(int d) const;
+
+        /**
+         * @brief This function returns whether the buffer is C-contiguous and holds elements of type T.
+         *
+         * In that case its data can be copied in bulk.
+         */
+        template <typename T>
+        bool isContiguous() const;
+
+        /**
+         * @brief This function returns a pointer to the start of the buffer.
+         */
+        const void * data() const;
+
+        /**
+         * @brief This function reads an element of the buffer.
+         *
+         * @param i The indeces of the element, one per dimension.
+         */
+        template <typename T, typename... I>
+        T get(I... i) const;
+
+    private:
+        template <typename T>
+        T read(const char * ptr) const;
+
+        Py_buffer view_;
+        bool valid_;
+        char format_;
+};
+
+template <typename T>
+bool PythonBuffer::isContiguous() const {
+    if (!valid_ || view_.itemsize != sizeof(T) || !PyBuffer_IsContiguous(&view_, 'C')) return false;
+    if constexpr (std::is_same_v<T, double>) return format_ == 'd';
+    else if constexpr (std::is_floating_point_v<T>) return false;
+    else return format_ != 'd' && format_ != 'f' && format_ != '?' &&
+                bool(std::is_signed_v<T>) == (format_ >= 'a' && format_ <= 'z');
+}
+
+template <typename T, typename... I>
+T PythonBuffer::get(I... i) const {
+    const char * ptr = static_cast<const char *>(view_.buf);
+    int d = 0;
+    ((ptr += static_cast<Py_ssize_t>(i) * view_.strides[d++]), ...);
+    return read<T>(ptr);
+}
+
+template <typename T>
+T PythonBuffer::read(const char * ptr) const {
+    // memcpy avoids unaligned reads, as buffers are not required to be aligned.
+    const auto readAs = [ptr](auto v) { std::memcpy(&v, ptr, sizeof(v)); return static_cast<T>(v); };
+    switch (format_) {
+        case 'd': return readAs(double());
+        case 'f': return readAs(float());
+        case '?': return readAs(bool());
+        case 'b': return readAs((signed char)0);
+        case 'B': return readAs((unsigned char)0);
+        case 'h': return readAs(short());
+        case 'H': return readAs((unsigned short)0);
+        case 'i': return readAs(int());
+        case 'I': return readAs(0u);
+        case 'l': return readAs(0l);
+        case 'L': return readAs(0ul);
+        case 'q': return readAs(0ll);
+        default:  return readAs(0ull);
+    }
+}
+
 // Python to C++
 
 template <typename T>
@@ -119,11 +337,20 @@ struct PairFromPython {
     }
 };
 
+// Accepts lists and one dimensional buffers.
 struct EigenVectorFromPython {
     EigenVectorFromPython();
 
     static void* convertible(PyObject* obj_ptr);
-    static void construct(PyObject* list, boost::python::converter::rvalue_from_python_stage1_data* data);
+    static void construct(PyObject* obj, boost::python::converter::rvalue_from_python_stage1_data* data);
+};
+
+// Accepts two dimensional buffers.
+struct EigenMatrix2DFromPython {
+    EigenMatrix2DFromPython();
+
+    static void* convertible(PyObject* obj_ptr);
+    static void construct(PyObject* obj, boost::python::converter::rvalue_from_python_stage1_data* data);
 };
 
 template<typename T>
@@ -133,8 +360,10 @@ struct VectorFromPython {
     }
 
     static void* convertible(PyObject* obj_ptr) {
-        if (!PyList_Check(obj_ptr)) return 0;
-        return obj_ptr;
+        if (PyList_Check(obj_ptr)) return obj_ptr;
+        if constexpr (std::is_arithmetic_v<T>)
+            if (PythonBuffer(obj_ptr).ndim() == 1) return obj_ptr;
+        return 0;
     }
 
     static void construct(PyObject* list, boost::python::converter::rvalue_from_python_stage1_data* data) {
@@ -143,6 +372,21 @@ struct VectorFromPython {
 
         std::vector<T>& v = *(new (storage) std::vector<T>());
 
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (!PyList_Check(list)) {
+                PythonBuffer buffer(list);
+                v.resize(buffer.shape(0));
+                if (buffer.isContiguous<T>())
+                    std::memcpy(v.data(), buffer.data(), v.size() * sizeof(T));
+                else
+                    for (size_t i = 0; i < v.size(); ++i)
+                        v[i] = buffer.get<T>(i);
+
+                data->convertible = storage;
+                return;
+            }
+        }
+
         // Copy item by item the list
         auto size = PyList_Size(list);
         v.resize(size);
@@ -163,9 +407,12 @@ struct Vector3DFromPython {
     }
 
     static void* convertible(PyObject* obj_ptr) {
-        if (!PyList_Check(obj_ptr) ||
-            !PyList_Check(PyList_GetItem(obj_ptr,0)) ||
-            !PyList_Check(PyList_GetItem(PyList_GetItem(obj_ptr,0),0))) return 0;
+        if (PyList_Check(obj_ptr)) {
+            if (!PyList_Check(PyList_GetItem(obj_ptr,0)) ||
+                !PyList_Check(PyList_GetItem(PyList_GetItem(obj_ptr,0),0))) return 0;
+            return obj_ptr;
+        }
+        if (PythonBuffer(obj_ptr).ndim() != 3) return 0;
         return obj_ptr;
     }
 
@@ -175,6 +422,23 @@ struct Vector3DFromPython {
 
         V3D& v = *(new (storage) V3D());
 
+        if (!PyList_Check(list)) {
+            // Read the buffer directly, without going through Python.
+            PythonBuffer buffer(list);
+            v.resize(buffer.shape(0));
+            for (Py_ssize_t i = 0; i < buffer.shape(0); ++i) {
+                v[i].resize(buffer.shape(1));
+                for (Py_ssize_t j = 0; j < buffer.shape(1); ++j) {
+                    v[i][j].resize(buffer.shape(2));
+                    for (Py_ssize_t k = 0; k < buffer.shape(2); ++k)
+                        v[i][j][k] = buffer.get<T>(i, j, k);
+                }
+            }
+
+            data->convertible = storage;
+            return;
+        }
+
         // Copy item by item the list
         auto size3 = PyList_Size(list);
         v.resize(size3);
@@ -3,17 +3,115 @@
 #include <iostream>
 #include <tuple>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
 
 namespace AIToolbox {
-    Statistics::Statistics(size_t timesteps) :
-            data_(timesteps) {}
+    QuantileSketch::QuantileSketch(const double accuracy) :
+            accuracy_(accuracy), gamma_((1.0 + accuracy) / (1.0 - accuracy)),
+            logGamma_(std::log(gamma_)), zeros_(0), count_(0)
+    {
+        if (!(accuracy > 0.0 && accuracy < 1.0))
+            throw std::invalid_argument("Quantile accuracy must be in (0, 1)");
+    }
+
+    int QuantileSketch::getBucket(const double value) const {
+        return static_cast<int>(std::ceil(std::log(value) / logGamma_));
+    }
+
+    double QuantileSketch::getValue(const int bucket) const {
+        // Middle point, in relative terms, of (gamma^(b-1), gamma^b].
+        return 2.0 * std::pow(gamma_, bucket) / (gamma_ + 1.0);
+    }
+
+    void QuantileSketch::record(const double value) {
+        ++count_;
+        if (value > std::numeric_limits<double>::min())
+            ++positives_[getBucket(value)];
+        else if (value < -std::numeric_limits<double>::min())
+            ++negatives_[getBucket(-value)];
+        else
+            ++zeros_;
+    }
+
+    void QuantileSketch::merge(const QuantileSketch & other) {
+        if (accuracy_ != other.accuracy_)
+            throw std::invalid_argument("Cannot merge QuantileSketches with different accuracies");
+
+        for (const auto & [b, c] : other.positives_) positives_[b] += c;
+        for (const auto & [b, c] : other.negatives_) negatives_[b] += c;
+        zeros_ += other.zeros_;
+        count_ += other.count_;
+    }
+
+    double QuantileSketch::getQuantile(const double q) const {
+        if (count_ == 0) return std::numeric_limits<double>::quiet_NaN();
+
+        const auto rank = static_cast<size_t>(q * (count_ - 1));
+
+        // We go through the buckets from the lowest value to the highest,
+        // until we have passed enough values.
+        size_t seen = 0;
+        for (auto it = negatives_.rbegin(); it != negatives_.rend(); ++it) {
+            seen += it->second;
+            if (seen > rank) return -getValue(it->first);
+        }
+        seen += zeros_;
+        if (seen > rank) return 0.0;
+        for (const auto & [b, c] : positives_) {
+            seen += c;
+            if (seen > rank) return getValue(b);
+        }
+        return getValue(positives_.rbegin()->first);
+    }
+
+    size_t QuantileSketch::getCount() const { return count_; }
+    double QuantileSketch::getAccuracy() const { return accuracy_; }
+
+    Statistics::Statistics(const size_t timesteps, const double quantileAccuracy) :
+            data_(timesteps), quantileAccuracy_(quantileAccuracy)
+    {
+        if (quantileAccuracy_ > 0.0)
+            sketches_.resize(timesteps, QuantileSketch(quantileAccuracy_));
+    }
 
     void Statistics::record(const double v, const size_t t) {
-        auto & [count, sum, square] = data_[t];
+        auto & [count, mean, m2] = data_[t];
 
         ++count;
-        sum += v;
-        square += v * v;
+        const double delta = v - mean;
+        mean += delta / count;
+        m2 += delta * (v - mean);
+
+        if (sketches_.size())
+            sketches_[t].record(v);
+    }
+
+    void Statistics::merge(const Statistics & other) {
+        if (quantileAccuracy_ != other.quantileAccuracy_)
+            throw std::invalid_argument("Cannot merge Statistics with different quantile accuracies");
+
+        if (other.data_.size() > data_.size()) {
+            data_.resize(other.data_.size());
+            if (sketches_.size())
+                sketches_.resize(data_.size(), QuantileSketch(quantileAccuracy_));
+        }
+
+        for (size_t t = 0; t < other.data_.size(); ++t) {
+            auto & [count, mean, m2] = data_[t];
+            const auto & [oCount, oMean, oM2] = other.data_[t];
+
+            if (oCount == 0) continue;
+
+            const size_t newCount = count + oCount;
+            const double delta = oMean - mean;
+            mean += delta * oCount / newCount;
+            m2 += oM2 + delta * delta * count * oCount / newCount;
+            count = newCount;
+
+            if (sketches_.size())
+                sketches_[t].merge(other.sketches_[t]);
+        }
     }
 
     Statistics::Results Statistics::process() const {
@@ -23,10 +121,11 @@ namespace AIToolbox {
         double cumMean = 0.0;
         double cumVariance = 0.0;
         for (const auto & d : data_) {
-            const auto & [count, sum, square] = d;
+            const auto & [count, m, m2] = d;
 
-            const double mean = sum / count;
-            const double variance = square / count - mean * mean;
+            // Empty timesteps give NaN, as we can't say anything about them.
+            const double mean = count ? m : std::numeric_limits<double>::quiet_NaN();
+            const double variance = m2 / count;
             const double std = std::sqrt(variance);
             cumMean += mean;
             cumVariance += variance;
@@ -37,6 +136,15 @@ namespace AIToolbox {
         return retval;
     }
 
+    double Statistics::getQuantile(const double q, const size_t t) const {
+        if (sketches_.empty())
+            throw std::invalid_argument("Quantile sketches are not enabled in this Statistics");
+
+        return sketches_[t].getQuantile(q);
+    }
+
+    size_t Statistics::getTimesteps() const { return data_.size(); }
+
     std::ostream& operator<<(std::ostream& os, const Statistics & rh) {
         const auto data = rh.process();
 
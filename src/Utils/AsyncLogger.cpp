@@ -0,0 +1,86 @@
+#include <AIToolbox/Utils/AsyncLogger.hpp>
+
+#include <utility>
+
+namespace AIToolbox {
+    void AsyncLogger::Batch::clear() {
+        severities.clear();
+        offsets.clear();
+        text.clear();
+    }
+
+    AsyncLogger::AsyncLogger(Sink sink, const size_t capacity) :
+            sink_(std::move(sink)), capacity_(capacity), writing_(0),
+            dropped_(0), stop_(false)
+    {
+        queue_.severities.reserve(capacity_);
+        queue_.offsets.reserve(capacity_);
+
+        worker_ = std::thread([this]{ workerLoop(); });
+    }
+
+    AsyncLogger::~AsyncLogger() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wakeUp_.notify_one();
+        worker_.join();
+    }
+
+    void AsyncLogger::log(const int severity, const char * message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.severities.size() >= capacity_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            queue_.severities.push_back(severity);
+            queue_.offsets.push_back(queue_.text.size());
+            // We keep the terminators, so the sink can read the messages
+            // in place.
+            queue_.text.append(message);
+            queue_.text.push_back('\0');
+        }
+        wakeUp_.notify_one();
+    }
+
+    void AsyncLogger::flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]{ return queue_.severities.empty() && writing_ == 0; });
+    }
+
+    size_t AsyncLogger::getDropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    size_t AsyncLogger::getCapacity() const {
+        return capacity_;
+    }
+
+    void AsyncLogger::workerLoop() {
+        // We swap this with the queue, so that both buffers keep their
+        // memory and we don't allocate after warming up.
+        Batch batch;
+        batch.severities.reserve(capacity_);
+        batch.offsets.reserve(capacity_);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wakeUp_.wait(lock, [this]{ return stop_ || !queue_.severities.empty(); });
+            if (queue_.severities.empty()) break;
+
+            std::swap(batch, queue_);
+            writing_ = batch.severities.size();
+            lock.unlock();
+
+            for (size_t i = 0; i < batch.severities.size(); ++i)
+                sink_(batch.severities[i], batch.text.data() + batch.offsets[i]);
+            batch.clear();
+
+            lock.lock();
+            writing_ = 0;
+            done_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include <AIToolbox/Utils/Metrics.hpp>
+
+#include <sstream>
+
+namespace AIToolbox {
+    namespace {
+        template <typename T>
+        T & getOrCreate(std::map<std::string, std::unique_ptr<T>> & metrics, const std::string & name) {
+            auto & ptr = metrics[name];
+            if (!ptr) ptr = std::make_unique<T>();
+            return *ptr;
+        }
+
+        void writeString(std::ostream & os, const std::string & str) {
+            os << '"';
+            for (const char c : str) {
+                if (c == '"' || c == '\\') os << '\\';
+                os << c;
+            }
+            os << '"';
+        }
+    }
+
+    MetricHistogram::MetricHistogram() : count_(0), sum_(0), max_(0) {
+        for (auto & b : buckets_)
+            b.store(0, std::memory_order_relaxed);
+    }
+
+    void MetricHistogram::record(std::uint64_t value) {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        auto max = max_.load(std::memory_order_relaxed);
+        while (max < value && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed));
+
+        size_t bucket = 0;
+        for (; value; value >>= 1) ++bucket;
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void MetricHistogram::reset() {
+        for (auto & b : buckets_)
+            b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    std::string MetricsSnapshot::toJSON() const {
+        std::ostringstream os;
+
+        os << "{\"counters\":{";
+        for (size_t i = 0; i < counters.size(); ++i) {
+            if (i) os << ',';
+            writeString(os, counters[i].name);
+            os << ':' << counters[i].value;
+        }
+
+        os << "},\"timers\":{";
+        for (size_t i = 0; i < timers.size(); ++i) {
+            if (i) os << ',';
+            writeString(os, timers[i].name);
+            os << ":{\"calls\":" << timers[i].calls << ",\"total_ns\":" << timers[i].total.count() << '}';
+        }
+
+        os << "},\"histograms\":{";
+        for (size_t i = 0; i < histograms.size(); ++i) {
+            const auto & h = histograms[i];
+            if (i) os << ',';
+            writeString(os, h.name);
+            os << ":{\"count\":" << h.count << ",\"sum\":" << h.sum << ",\"max\":" << h.max << ",\"buckets\":[";
+            for (size_t b = 0; b < h.buckets.size(); ++b) {
+                if (b) os << ',';
+                os << h.buckets[b];
+            }
+            os << "]}";
+        }
+        os << "}}";
+
+        return os.str();
+    }
+
+    MetricsRegistry & MetricsRegistry::instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    MetricCounter & MetricsRegistry::counter(const std::string & name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return getOrCreate(counters_, name);
+    }
+
+    MetricTimer & MetricsRegistry::timer(const std::string & name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return getOrCreate(timers_, name);
+    }
+
+    MetricHistogram & MetricsRegistry::histogram(const std::string & name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return getOrCreate(histograms_, name);
+    }
+
+    MetricsSnapshot MetricsRegistry::snapshot() const {
+        MetricsSnapshot retval;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto & [name, c] : counters_)
+            retval.counters.push_back({name, c->get()});
+
+        for (const auto & [name, t] : timers_)
+            retval.timers.push_back({name, t->getCalls(), t->getTotal()});
+
+        for (const auto & [name, h] : histograms_) {
+            size_t last = MetricHistogram::Buckets;
+            while (last > 0 && h->getBucket(last - 1) == 0) --last;
+
+            std::vector<std::uint64_t> buckets(last);
+            for (size_t b = 0; b < last; ++b)
+                buckets[b] = h->getBucket(b);
+
+            retval.histograms.push_back({name, h->getCount(), h->getSum(), h->getMax(), std::move(buckets)});
+        }
+
+        return retval;
+    }
+
+    void MetricsRegistry::reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto & c : counters_) c.second->reset();
+        for (auto & t : timers_) t.second->reset();
+        for (auto & h : histograms_) h.second->reset();
+    }
+}
@@ -1,5 +1,10 @@
 #include <AIToolbox/Utils/Polytope.hpp>
 
+#include <AIToolbox/Impl/Profiling.hpp>
+
+#include <algorithm>
+#include <iterator>
+
 namespace AIToolbox {
     WitnessLP::WitnessLP(const size_t s) : S(s), lp_(s+2)
     {
@@ -57,6 +62,17 @@ namespace AIToolbox {
         // IMPORTANT: K is unbounded, since the value function may be negative.
         lp_.setUnbounded(S);
 
+        // CONSTRAINT: This is the witness constraint for the tested
+        // hyperplane. It sits right after the simplex, so that the optimal
+        // rows can be appended after it and it can be changed in place for
+        // each hyperplane. This keeps the LP structure the same between
+        // calls to findWitness, so that each solve could be warm started
+        // from the previous one (see LP::resolve()). Until we know the hyperplane it is the empty
+        // constraint 0 = 0.
+        for ( size_t i = 0; i < S; ++i )
+            lp_.row[i] = 0.0;
+        lp_.pushRow(LP::Constraint::Equal, 0.0);
+
         lp_.row[S]     = -1.0;
         lp_.row[S + 1] = +0.0;
     }
@@ -72,16 +88,15 @@ namespace AIToolbox {
     }
 
     std::optional<Point> WitnessLP::findWitness(const Hyperplane & v) {
-        // Add witness constraint
+        AI_METRIC_TIME("WitnessLP::findWitness");
+
+        // Set witness constraint
         for ( size_t i = 0; i < S; ++i )
             lp_.row[i] = v[i];
-        lp_.pushRow(LP::Constraint::Equal, 0.0);
+        lp_.setRow(1, LP::Constraint::Equal, 0.0);
 
         double deltaValue;
-        auto solution = lp_.solve(S, &deltaValue);
-
-        // Remove it
-        lp_.popRow();
+        auto solution = lp_.resolve(S, &deltaValue);
 
         // We have found a witness point if we have found a point where the
         // value of the supplied hyperplane is greater than ALL others. Thus we
@@ -94,10 +109,139 @@ namespace AIToolbox {
     }
 
     void WitnessLP::reset() {
-        lp_.resize(1);
+        lp_.resize(2);
     }
 
     void WitnessLP::allocate(const size_t rows) {
-        lp_.resize(rows+1);
+        lp_.resize(rows+2);
+    }
+
+    VertexEnumerator::VertexEnumerator(const size_t s) : S(s), hyperplanes_(0) {}
+
+    VertexEnumerator::Vertices VertexEnumerator::addHyperplane(const Hyperplane & h) {
+        AI_METRIC_TIME("VertexEnumerator::addHyperplane");
+
+        const size_t id = S + hyperplanes_++;
+        Vertices added;
+
+        // The first hyperplane touches the simplex at its corners; each is
+        // tight with the S-1 boundaries not containing the corner.
+        if ( vertices_.empty() ) {
+            for ( size_t s = 0; s < S; ++s ) {
+                Point corner(S);
+                corner.setZero();
+                corner[s] = 1.0;
+                vertices_.emplace_back(std::move(corner), h[s]);
+
+                auto & tight = tight_.emplace_back();
+                for ( size_t i = 0; i < S; ++i )
+                    if ( i != s ) tight.push_back(i);
+                tight.push_back(id);
+            }
+            return vertices_;
+        }
+
+        // The slack of each vertex with respect to the new hyperplane.
+        const size_t N = vertices_.size();
+        std::vector<double> slack(N, 0.0);
+        std::vector<size_t> plus, minus, zero;
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto & [b, v] = vertices_[i];
+            const double hv = h.dot(b);
+            if ( checkEqualGeneral(v, hv) ) {
+                zero.push_back(i);
+                continue;
+            }
+            slack[i] = v - hv;
+            if ( slack[i] > 0.0 ) plus.push_back(i);
+            else                  minus.push_back(i);
+        }
+
+        if ( minus.empty() ) {
+            for ( const auto i : zero )
+                tight_[i].push_back(id);
+            return added;
+        }
+
+        // The vertical ray is an extra generator; its tight constraints
+        // are all the simplex boundaries, and it is never cut.
+        const size_t Ray = N;
+        plus.push_back(Ray);
+
+        std::vector<std::vector<size_t>> addedTight;
+        std::vector<size_t> common;
+        for ( const auto m : minus ) {
+            for ( const auto p : plus ) {
+                common.clear();
+                if ( p == Ray )
+                    std::copy_if(std::begin(tight_[m]), std::end(tight_[m]), std::back_inserter(common), [this](const size_t c) { return c < S; });
+                else
+                    std::set_intersection(std::begin(tight_[p]), std::end(tight_[p]),
+                                          std::begin(tight_[m]), std::end(tight_[m]), std::back_inserter(common));
+
+                if ( !isEdge(common, p, m) ) continue;
+
+                // The new vertex is where the hyperplane crosses the edge.
+                Point b;
+                if ( p == Ray ) {
+                    b = vertices_[m].first;
+                } else {
+                    const double t = slack[p] / (slack[p] - slack[m]);
+                    b = vertices_[p].first + t * (vertices_[m].first - vertices_[p].first);
+                    for ( const auto c : common )
+                        if ( c < S ) b[c] = 0.0;
+                }
+                const double v = h.dot(b);
+                added.emplace_back(std::move(b), v);
+
+                common.push_back(id);
+                addedTight.push_back(common);
+            }
+        }
+
+        for ( const auto i : zero )
+            tight_[i].push_back(id);
+
+        // Remove the cut vertices, and add the new ones.
+        size_t kept = 0;
+        for ( size_t i = 0; i < N; ++i ) {
+            if ( slack[i] < 0.0 ) continue;
+            if ( kept != i ) {
+                vertices_[kept] = std::move(vertices_[i]);
+                tight_[kept] = std::move(tight_[i]);
+            }
+            ++kept;
+        }
+        vertices_.resize(kept);
+        tight_.resize(kept);
+
+        vertices_.insert(std::end(vertices_), std::begin(added), std::end(added));
+        tight_.insert(std::end(tight_), std::make_move_iterator(std::begin(addedTight)), std::make_move_iterator(std::end(addedTight)));
+
+        return added;
     }
+
+    bool VertexEnumerator::isEdge(const std::vector<size_t> & tight, const size_t p, const size_t m) const {
+        if ( tight.size() + 1 < S ) return false;
+
+        // Check whether the ray has all the common constraints tight.
+        if ( p != vertices_.size() && std::all_of(std::begin(tight), std::end(tight), [this](const size_t c) { return c < S; }) )
+            return false;
+
+        for ( size_t z = 0; z < vertices_.size(); ++z ) {
+            if ( z == p || z == m ) continue;
+            if ( std::includes(std::begin(tight_[z]), std::end(tight_[z]), std::begin(tight), std::end(tight)) )
+                return false;
+        }
+        return true;
+    }
+
+    void VertexEnumerator::reset() {
+        hyperplanes_ = 0;
+        vertices_.clear();
+        tight_.clear();
+    }
+
+    const VertexEnumerator::Vertices & VertexEnumerator::getVertices() const { return vertices_; }
+    size_t VertexEnumerator::getHyperplanesNum() const { return hyperplanes_; }
 }
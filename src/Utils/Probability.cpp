@@ -31,62 +31,97 @@ namespace AIToolbox {
         return retval;
     }
 
-    VoseAliasSampler::VoseAliasSampler(const ProbabilityVector & p) :
-            prob_(p), alias_(prob_.size()), sampleDistribution_(0, prob_.size())
-    {
-        // Here we do the Vose Alias setup in a way that avoids the creation of
-        // the small and large arrays.
-        //
-        // In practice what we do is we keep two pointers, one for large
-        // elements and one for the small ones, and we move them along the
-        // array as if we had already sorted the thing.
+    namespace {
+        /**
+         * @brief This function builds the Vose alias tables for a single distribution, in place.
+         *
+         * @param N The size of the distribution.
+         * @param prob The distribution, which gets replaced by the coin weights.
+         * @param alias The output aliases, of size N.
+         */
+        template <typename I>
+        void buildVoseAlias(const size_t N, double * prob, I * alias) {
+            // Here we do the Vose Alias setup in a way that avoids the creation of
+            // the small and large arrays.
+            //
+            // In practice what we do is we keep two pointers, one for large
+            // elements and one for the small ones, and we move them along the
+            // array as if we had already sorted the thing.
+            //
+            // Unassigned aliases are marked with N, since 0 is a valid alias.
+            std::fill(alias, alias + N, static_cast<I>(N));
 
-        const auto avg = 1.0 / prob_.size();
-        auto small = 0, large = 0;
-        while (small < prob_.size() && prob_[small] >= avg) ++small;
-        while (large < prob_.size() && prob_[large] < avg) ++large;
+            const auto avg = 1.0 / N;
+            size_t small = 0, large = 0;
+            while (small < N && prob[small] >= avg) ++small;
+            while (large < N && prob[large] < avg) ++large;
 
-        auto smallCheckpoint = small;
+            auto smallCheckpoint = small;
 
-        while (small < prob_.size() && large < prob_.size()) {
-            // Note: we do not do any assignments to prob_[small] here since if
-            // we scaled the values already we might trip the large counter (as
-            // it might be behind the small counter).
-            prob_[large] = (prob_[large] + prob_[small]) - avg;
-            alias_[small] = large;
+            while (small < N && large < N) {
+                // Note: we do not do any assignments to prob[small] here since if
+                // we scaled the values already we might trip the large counter (as
+                // it might be behind the small counter).
+                prob[large] = (prob[large] + prob[small]) - avg;
+                alias[small] = large;
 
-            // If the large became small, we temporarily move the small counter
-            // here, and look around for a new large element.
-            // Otherwise, we go back to our last small 'checkpoint', and we
-            // look for a new small element.
-            if (prob_[large] < avg) {
-                small = large;
-                ++large;
-                while (large < prob_.size() && prob_[large] < avg) ++large;
-            } else {
-                small = smallCheckpoint + 1;
-                while (small < prob_.size() && prob_[small] >= avg) ++small;
-                // Set the checkpoint again
-                smallCheckpoint = small;
+                // If the large became small, we temporarily move the small counter
+                // here, and look around for a new large element.
+                // Otherwise, we go back to our last small 'checkpoint', and we
+                // look for a new small element.
+                if (prob[large] < avg) {
+                    small = large;
+                    ++large;
+                    while (large < N && prob[large] < avg) ++large;
+                } else {
+                    // Here we must skip elements which became small after
+                    // being large, as they may have been paired already.
+                    small = smallCheckpoint + 1;
+                    while (small < N && (prob[small] >= avg || alias[small] != static_cast<I>(N))) ++small;
+                    // Set the checkpoint again
+                    smallCheckpoint = small;
+                }
             }
-        }
 
-        // Now, for each entry which remained unassigned (so it is still with
-        // the 0 default in the alias vector), we set it to just reference
-        // itself. This takes care of both large and small entries which have
-        // been left with no pairings.
-        auto x = std::min(large, small);
-        while (x < prob_.size()) {
-            prob_[x] = 1.0;
-            alias_[x] = x;
-            ++x;
-            while (x < prob_.size() && alias_[x] != 0) ++x;
+            // Now, for each entry which remained unassigned, we set it to just
+            // reference itself. This takes care of both large and small
+            // entries which have been left with no pairings.
+            //
+            // Here we also scale up the vector so that each entry can be
+            // correctly seen as a weighted coin. Note that all 1.0 entries
+            // will now be larger, but for those there's no choice so we don't
+            // care about the precise value anyway.
+            for (size_t x = 0; x < N; ++x) {
+                if (alias[x] == static_cast<I>(N)) {
+                    prob[x] = 1.0;
+                    alias[x] = x;
+                }
+                prob[x] *= N;
+            }
         }
+    }
+
+    VoseAliasSampler::VoseAliasSampler(const ProbabilityVector & p) :
+            prob_(p), alias_(prob_.size()), sampleDistribution_(0, prob_.size())
+    {
+        buildVoseAlias(prob_.size(), prob_.data(), alias_.data());
+    }
+
+    VoseAliasTable::VoseAliasTable() : cols_(0) {}
+
+    void VoseAliasTable::build() {
+        const size_t rows = prob_.rows();
+        alias_.resize(rows * cols_);
+        for (size_t r = 0; r < rows; ++r)
+            buildVoseAlias(cols_, prob_.row(r).data(), alias_.data() + r * cols_);
+        sampleDistribution_ = std::uniform_real_distribution<double>(0, cols_);
+    }
+
+    bool VoseAliasTable::empty() const {
+        return prob_.rows() == 0;
+    }
 
-        // Here we scale up the vector so that each entry can be correctly seen
-        // as a weighted coin. Note that all 1.0 entries will now be larger,
-        // but for those there's no choice so we don't care about the precise
-        // value anyway.
-        prob_ *= prob_.size();
+    size_t VoseAliasTable::getMemoryUsage() const {
+        return prob_.size() * sizeof(double) + alias_.capacity() * sizeof(unsigned);
     }
 }
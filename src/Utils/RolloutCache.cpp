@@ -0,0 +1,77 @@
+#include <AIToolbox/Utils/RolloutCache.hpp>
+
+#include <stdexcept>
+
+namespace AIToolbox {
+    RolloutCache::RolloutCache(const size_t maxSize, const double decay, const double minWeight) :
+            maxSize_(maxSize), hits_(0)
+    {
+        setDecay(decay);
+        setMinWeight(minWeight);
+    }
+
+    std::optional<double> RolloutCache::lookup(const size_t key) {
+        const auto it = entries_.find(key);
+        if ( it == std::end(entries_) ) return std::nullopt;
+
+        auto & entry = it->second;
+        if ( entry.weight < minWeight_ ) return std::nullopt;
+
+        entry.weight *= decay_;
+        lru_.splice(std::begin(lru_), lru_, entry.lru);
+        ++hits_;
+
+        return entry.value;
+    }
+
+    void RolloutCache::update(const size_t key, const double value) {
+        if ( !maxSize_ ) return;
+
+        auto it = entries_.find(key);
+        if ( it == std::end(entries_) ) {
+            if ( entries_.size() >= maxSize_ ) {
+                entries_.erase(lru_.back());
+                lru_.pop_back();
+            }
+            lru_.push_front(key);
+            entries_.emplace(key, Entry{value, 1.0, std::begin(lru_)});
+            return;
+        }
+
+        auto & entry = it->second;
+        entry.weight = entry.weight * decay_ + 1.0;
+        entry.value += (value - entry.value) / entry.weight;
+        lru_.splice(std::begin(lru_), lru_, entry.lru);
+    }
+
+    void RolloutCache::clear() {
+        entries_.clear();
+        lru_.clear();
+        hits_ = 0;
+    }
+
+    void RolloutCache::setMaxSize(const size_t maxSize) {
+        maxSize_ = maxSize;
+        while ( entries_.size() > maxSize_ ) {
+            entries_.erase(lru_.back());
+            lru_.pop_back();
+        }
+    }
+
+    void RolloutCache::setDecay(const double decay) {
+        if ( decay <= 0.0 || decay >= 1.0 )
+            throw std::invalid_argument("RolloutCache decay must be in (0, 1)");
+        decay_ = decay;
+    }
+
+    void RolloutCache::setMinWeight(const double minWeight) {
+        minWeight_ = minWeight;
+    }
+
+    size_t RolloutCache::getMaxSize() const { return maxSize_; }
+    double RolloutCache::getDecay() const { return decay_; }
+    double RolloutCache::getMinWeight() const { return minWeight_; }
+    bool RolloutCache::isEnabled() const { return maxSize_ > 0; }
+    size_t RolloutCache::size() const { return entries_.size(); }
+    size_t RolloutCache::getHits() const { return hits_; }
+}
@@ -0,0 +1,39 @@
+#include <AIToolbox/Utils/SolverControl.hpp>
+
+namespace AIToolbox {
+    CancellationToken::CancellationToken() :
+            cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void CancellationToken::cancel() {
+        cancelled_->store(true, std::memory_order_relaxed);
+    }
+
+    bool CancellationToken::isCancelled() const {
+        return cancelled_->load(std::memory_order_relaxed);
+    }
+
+    void SolverControl::setProgressCallback(ProgressCallback callback) {
+        progress_ = std::move(callback);
+    }
+
+    void SolverControl::setCancellationToken(CancellationToken token) {
+        token_ = std::move(token);
+    }
+
+    const CancellationToken & SolverControl::getCancellationToken() const {
+        return token_;
+    }
+
+    void SolverControl::startProgress() {
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    bool SolverControl::isCancelled() const {
+        return token_.isCancelled();
+    }
+
+    void SolverControl::reportProgress(const unsigned timestep, const double gap, const size_t size) const {
+        if (!progress_) return;
+        progress_(SolverProgress{timestep, gap, size, std::chrono::steady_clock::now() - start_});
+    }
+}
@@ -0,0 +1,53 @@
+#include <AIToolbox/Utils/SumTree.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace AIToolbox {
+    SumTree::SumTree(const size_t n) : N(n), leaves_(1) {
+        while ( leaves_ < N ) leaves_ *= 2;
+        nodes_.resize(2 * leaves_, 0.0);
+    }
+
+    void SumTree::set(size_t i, const double weight) {
+        assert(i < N && weight >= 0.0);
+        i += leaves_;
+        nodes_[i] = weight;
+        // Recomputing the sums, rather than adding the difference, avoids
+        // accumulating rounding errors over many updates.
+        for ( i /= 2; i > 0; i /= 2 )
+            nodes_[i] = nodes_[2 * i] + nodes_[2 * i + 1];
+    }
+
+    double SumTree::get(const size_t i) const {
+        return nodes_[leaves_ + i];
+    }
+
+    double SumTree::getTotal() const {
+        return nodes_[1];
+    }
+
+    size_t SumTree::find(double u) const {
+        size_t i = 1;
+        while ( i < leaves_ ) {
+            const auto left = nodes_[2 * i];
+            // We never descend in a subtree with zero weight, so that
+            // rounding errors can't select empty leaves.
+            if ( (u < left && left > 0.0) || nodes_[2 * i + 1] <= 0.0 ) {
+                i = 2 * i;
+            } else {
+                u -= left;
+                i = 2 * i + 1;
+            }
+        }
+        return std::min(i - leaves_, N ? N - 1 : 0);
+    }
+
+    void SumTree::clear() {
+        std::fill(std::begin(nodes_), std::end(nodes_), 0.0);
+    }
+
+    size_t SumTree::size() const {
+        return N;
+    }
+}
@@ -0,0 +1,105 @@
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+namespace AIToolbox {
+    ThreadPool::ThreadPool(const size_t threads) :
+            job_(nullptr), jobs_(0), nextJob_(0), finished_(0),
+            generation_(0), stop_(false)
+    {
+        spawn(threads, nullptr);
+    }
+
+    ThreadPool::ThreadPool(const size_t threads, const std::function<void(size_t)> & onStart) :
+            job_(nullptr), jobs_(0), nextJob_(0), finished_(0),
+            generation_(0), stop_(false)
+    {
+        spawn(threads, &onStart);
+    }
+
+    void ThreadPool::spawn(const size_t threads, const std::function<void(size_t)> * onStart) {
+        if (!onStart) {
+            for (size_t i = 1; i < threads; ++i)
+                workers_.emplace_back([this]{ workerLoop(); });
+            return;
+        }
+
+        // We wait for all workers to have called the start function, so
+        // that the caller knows its effects are in place and the function
+        // does not need to outlive the constructor.
+        size_t started = 0;
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this, i, onStart, &started]{
+                (*onStart)(i);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    ++started;
+                }
+                done_.notify_one();
+                workerLoop();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this, &started]{ return started == workers_.size(); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wakeUp_.notify_all();
+        for (auto & w : workers_)
+            w.join();
+    }
+
+    size_t ThreadPool::getThreadNumber() const {
+        return workers_.size() + 1;
+    }
+
+    void ThreadPool::execute(const size_t jobs, const std::function<void(size_t)> & job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            jobs_ = jobs;
+            nextJob_ = 0;
+            finished_ = 0;
+            ++generation_;
+        }
+        wakeUp_.notify_all();
+
+        runJobs();
+
+        // We wait for every worker to check out of this generation, so that
+        // no worker can ever see a stale job after we return.
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]{ return finished_ == workers_.size(); });
+        job_ = nullptr;
+    }
+
+    void ThreadPool::runJobs() {
+        size_t j;
+        while ((j = nextJob_.fetch_add(1)) < jobs_)
+            (*job_)(j);
+    }
+
+    void ThreadPool::workerLoop() {
+        size_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeUp_.wait(lock, [this, seen]{ return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+
+            runJobs();
+
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last = ++finished_ == workers_.size();
+            }
+            if (last) done_.notify_one();
+        }
+    }
+}
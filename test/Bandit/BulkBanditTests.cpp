@@ -0,0 +1,104 @@
+#define BOOST_TEST_MODULE Bandit_BulkBandit
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <AIToolbox/Bandit/Algorithms/BulkBandit.hpp>
+#include <AIToolbox/Bandit/Algorithms/RollingAverage.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+namespace aib = AIToolbox::Bandit;
+
+BOOST_AUTO_TEST_CASE( batched_updates ) {
+    constexpr size_t N = 50, A = 4, U = 5000;
+
+    AIToolbox::RandomEngine rand(1);
+    std::uniform_int_distribution<size_t> banditDist(0, N - 1), actionDist(0, A - 1);
+    std::uniform_real_distribution<double> rewardDist(0.0, 1.0);
+
+    std::vector<size_t> bandits, actions;
+    std::vector<double> rewards;
+    for (size_t k = 0; k < U; ++k) {
+        bandits.push_back(banditDist(rand));
+        actions.push_back(actionDist(rand));
+        rewards.push_back(rewardDist(rand));
+    }
+
+    std::vector<aib::RollingAverage> single(N, aib::RollingAverage(A));
+    for (size_t k = 0; k < U; ++k)
+        single[bandits[k]].stepUpdateQ(actions[k], rewards[k]);
+
+    AIToolbox::ThreadPool pool(3);
+    aib::BulkBandit serial(N, A), parallel(N, A);
+    serial.stepUpdateQ(bandits, actions, rewards);
+    parallel.stepUpdateQ(bandits, actions, rewards, &pool);
+
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t a = 0; a < A; ++a) {
+            // Updates of a bandit are applied in order, so the results are exact.
+            BOOST_CHECK_EQUAL(serial.getQFunctions()(i, a), single[i].getQFunction()[a]);
+            BOOST_CHECK_EQUAL(parallel.getQFunctions()(i, a), single[i].getQFunction()[a]);
+            BOOST_CHECK_EQUAL(serial.getCounts()[i * A + a], single[i].getCounts()[a]);
+            BOOST_CHECK_EQUAL(parallel.getCounts()[i * A + a], single[i].getCounts()[a]);
+        }
+    }
+
+    parallel.reset(3);
+    BOOST_CHECK(parallel.getQFunctions().row(3).isZero());
+    BOOST_CHECK_EQUAL(parallel.getCounts()[3 * A], 0);
+    BOOST_CHECK_EQUAL(parallel.getQFunctions()(4, 0), serial.getQFunctions()(4, 0));
+
+    rewards.pop_back();
+    BOOST_CHECK_THROW(serial.stepUpdateQ(bandits, actions, rewards), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( batched_selection ) {
+    constexpr size_t N = 3000, A = 5;
+
+    // Each bandit has a single best action, a % A.
+    aib::BulkBandit bb(N, A);
+    std::vector<size_t> bandits;
+    for (size_t i = 0; i < N; ++i) {
+        for (unsigned t = 0; t < 50; ++t)
+            bb.stepUpdateQ(i, (i + t) % A, (i + t) % A == i % A ? 1.0 : 0.0);
+        bandits.push_back(i);
+    }
+
+    std::vector<size_t> actions;
+    bb.sampleGreedyActions(bandits, &actions);
+    BOOST_REQUIRE_EQUAL(actions.size(), N);
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_EQUAL(actions[i], i % A);
+
+    bb.sampleSoftmaxActions(bandits, 0.0, &actions);
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_EQUAL(actions[i], i % A);
+    BOOST_CHECK_THROW(bb.sampleSoftmaxActions(bandits, -1.0, &actions), std::invalid_argument);
+
+    // With 10 pulls per arm Thompson sampling is almost always right.
+    bb.sampleThompsonActions(bandits, &actions);
+    size_t correct = 0;
+    for (size_t i = 0; i < N; ++i)
+        correct += actions[i] == i % A;
+    BOOST_CHECK(correct > N * 0.95);
+
+    // The selections do not depend on the number of threads.
+    AIToolbox::ThreadPool pool(4);
+    AIToolbox::Impl::Seeder::setRootSeed(42);
+    aib::BulkBandit serial(N, A);
+    AIToolbox::Impl::Seeder::setRootSeed(42);
+    aib::BulkBandit parallel(N, A);
+    std::vector<size_t> serialActions, parallelActions;
+    for (unsigned t = 0; t < 2; ++t) {
+        serial.sampleSoftmaxActions(bandits, 1.0, &serialActions);
+        parallel.sampleSoftmaxActions(bandits, 1.0, &parallelActions, &pool);
+        BOOST_CHECK(serialActions == parallelActions);
+
+        serial.sampleThompsonActions(bandits, &serialActions);
+        parallel.sampleThompsonActions(bandits, &parallelActions, &pool);
+        BOOST_CHECK(serialActions == parallelActions);
+    }
+}
@@ -77,3 +77,45 @@ BOOST_AUTO_TEST_CASE( randomish_game ) {
     BOOST_CHECK(p1.getActionProbability(2) > 0.9);
     BOOST_CHECK(p2.getActionProbability(2) > 0.9);
 }
+
+BOOST_AUTO_TEST_CASE( incremental_updates ) {
+    using namespace AIToolbox::Bandit;
+    constexpr size_t A = 7;
+    constexpr double a = 0.1, b = 0.05;
+
+    LRPPolicy p(A, a, b);
+
+    // The updates as written in the paper, over all actions.
+    AIToolbox::Vector expected(A);
+    expected.fill(1.0 / A);
+
+    AIToolbox::RandomEngine rand(AIToolbox::Impl::Seeder::getSeed());
+    std::uniform_int_distribution<size_t> actDist(0, A - 1);
+    std::bernoulli_distribution resultDist(0.6);
+
+    // Enough updates to trigger multiple renormalizations.
+    for (unsigned i = 0; i < 5000; ++i) {
+        const auto act = actDist(rand);
+        const bool result = resultDist(rand);
+
+        p.stepUpdateP(act, result);
+        for (size_t j = 0; j < A; ++j) {
+            if (result) expected[j] += j == act ? a * (1.0 - expected[j]) : -a * expected[j];
+            else        expected[j] = j == act ? (1.0 - b) * expected[j] : b / (A - 1) + (1.0 - b) * expected[j];
+        }
+    }
+
+    const auto policy = p.getPolicy();
+    BOOST_CHECK_CLOSE(policy.sum(), 1.0, 1e-6);
+    for (size_t j = 0; j < A; ++j) {
+        BOOST_CHECK_SMALL(policy[j] - expected[j], 1e-9);
+        BOOST_CHECK_EQUAL(p.getActionProbability(j), policy[j]);
+    }
+
+    // A single action always has probability one.
+    LRPPolicy single(1, a);
+    single.stepUpdateP(0, false);
+    single.stepUpdateP(0, true);
+    BOOST_CHECK_CLOSE(single.getActionProbability(0), 1.0, 1e-9);
+    BOOST_CHECK_EQUAL(single.sampleAction(), 0);
+}
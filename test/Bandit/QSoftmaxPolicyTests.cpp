@@ -65,3 +65,36 @@ BOOST_AUTO_TEST_CASE( sampling ) {
     BOOST_CHECK(p2 * samples - margin <= counts[2]);
     BOOST_CHECK(counts[2] <= p2 * samples + margin);
 }
+
+BOOST_AUTO_TEST_CASE( many_actions ) {
+    using namespace AIToolbox;
+    // Enough actions to go through the vectorized kernels.
+    constexpr size_t A = 50;
+    constexpr double d = 3.0;
+
+    Bandit::RollingAverage ra(A);
+    Bandit::QSoftmaxPolicy p(ra.getQFunction(), d);
+    for (size_t a = 0; a < A; ++a)
+        ra.stepUpdateQ(a, static_cast<double>(a % 7));
+
+    const Vector solution = (ra.getQFunction() / d).array().exp() / (ra.getQFunction() / d).array().exp().sum();
+
+    const auto pp = p.getPolicy();
+    for (size_t a = 0; a < A; ++a) {
+        BOOST_CHECK_CLOSE(p.getActionProbability(a), solution[a], 1e-10);
+        BOOST_CHECK_CLOSE(pp[a], solution[a], 1e-10);
+    }
+
+    // Count how often each value is sampled.
+    constexpr unsigned samples = 10000;
+    std::vector<unsigned> counts(7);
+    for (unsigned i = 0; i < samples; ++i)
+        ++counts[p.sampleAction() % 7];
+
+    for (size_t v = 0; v < 7; ++v) {
+        double expected = 0.0;
+        for (size_t a = v; a < A; a += 7)
+            expected += solution[a] * samples;
+        BOOST_CHECK(std::abs(counts[v] - expected) < 300);
+    }
+}
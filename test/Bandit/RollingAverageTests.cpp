@@ -0,0 +1,105 @@
+#define BOOST_TEST_MODULE Bandit_RollingAverage
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <AIToolbox/Bandit/Algorithms/RollingAverage.hpp>
+#include <AIToolbox/Bandit/Algorithms/ExponentialRollingAverage.hpp>
+#include <AIToolbox/Bandit/Algorithms/WindowedRollingAverage.hpp>
+#include <AIToolbox/Bandit/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/Bandit/Policies/ThompsonSamplingPolicy.hpp>
+
+namespace aib = AIToolbox::Bandit;
+
+BOOST_AUTO_TEST_CASE( exponential_no_decay ) {
+    constexpr size_t A = 3;
+    aib::RollingAverage ra(A);
+    aib::ExponentialRollingAverage era(A, 1.0);
+
+    const double rewards[] = {0.5, 1.0, 0.2, 0.7, 0.3, 0.9, 0.1};
+    for (size_t i = 0; i < std::size(rewards); ++i) {
+        ra.stepUpdateQ(i % 2, rewards[i]);
+        era.stepUpdateQ(i % 2, rewards[i]);
+    }
+
+    for (size_t a = 0; a < A; ++a) {
+        BOOST_CHECK_CLOSE(era.getQFunction()[a] + 1.0, ra.getQFunction()[a] + 1.0, 1e-9);
+        BOOST_CHECK_EQUAL(era.getCounts()[a], ra.getCounts()[a]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( exponential_decay ) {
+    aib::ExponentialRollingAverage era(2, 0.5);
+
+    era.stepUpdateQ(0, 1.0);
+    era.stepUpdateQ(0, 0.0);
+    era.stepUpdateQ(0, 4.0);
+
+    // Weights: 0.25, 0.5, 1.0
+    BOOST_CHECK_CLOSE(era.getWeights()[0], 1.75, 1e-9);
+    BOOST_CHECK_CLOSE(era.getQFunction()[0], (0.25 * 1.0 + 4.0) / 1.75, 1e-9);
+    BOOST_CHECK_EQUAL(era.getCounts()[0], 1);
+    BOOST_CHECK_EQUAL(era.getCounts()[1], 0);
+
+    // The effective counts never go beyond 1 / (1 - decay).
+    for (unsigned i = 0; i < 1000; ++i)
+        era.stepUpdateQ(1, 3.0);
+    BOOST_CHECK(era.getCounts()[1] <= 2);
+    BOOST_CHECK_CLOSE(era.getQFunction()[1], 3.0, 1e-9);
+
+    era.reset();
+    BOOST_CHECK_EQUAL(era.getQFunction()[0], 0.0);
+    BOOST_CHECK_EQUAL(era.getCounts()[1], 0);
+
+    BOOST_CHECK_THROW(aib::ExponentialRollingAverage(2, 0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(era.setDecay(1.5), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( windowed ) {
+    constexpr unsigned W = 4;
+    aib::WindowedRollingAverage wra(2, W);
+
+    wra.stepUpdateQ(0, 1.0);
+    wra.stepUpdateQ(0, 2.0);
+    BOOST_CHECK_CLOSE(wra.getQFunction()[0], 1.5, 1e-9);
+    BOOST_CHECK_EQUAL(wra.getCounts()[0], 2);
+
+    // After many updates, only the last W rewards count.
+    for (unsigned i = 0; i < 101; ++i)
+        wra.stepUpdateQ(0, i);
+    BOOST_CHECK_EQUAL(wra.getCounts()[0], W);
+    BOOST_CHECK_CLOSE(wra.getQFunction()[0], (97.0 + 98.0 + 99.0 + 100.0) / W, 1e-9);
+    BOOST_CHECK_EQUAL(wra.getCounts()[1], 0);
+    BOOST_CHECK_EQUAL(wra.getQFunction()[1], 0.0);
+
+    wra.reset();
+    BOOST_CHECK_EQUAL(wra.getCounts()[0], 0);
+    wra.stepUpdateQ(0, 5.0);
+    BOOST_CHECK_EQUAL(wra.getQFunction()[0], 5.0);
+
+    BOOST_CHECK_THROW(aib::WindowedRollingAverage(2, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( policies_track_drift ) {
+    aib::WindowedRollingAverage wra(2, 10);
+    aib::ExponentialRollingAverage era(2, 0.8);
+
+    aib::QGreedyPolicy greedy(wra.getQFunction());
+    aib::ThompsonSamplingPolicy thompson(era.getQFunction(), era.getCounts());
+
+    // Arm 0 is initially better, then arm 1 becomes better.
+    for (unsigned i = 0; i < 100; ++i) {
+        wra.stepUpdateQ(0, 1.0); wra.stepUpdateQ(1, 0.0);
+        era.stepUpdateQ(0, 1.0); era.stepUpdateQ(1, 0.0);
+    }
+    BOOST_CHECK_EQUAL(greedy.sampleAction(), 0);
+
+    for (unsigned i = 0; i < 20; ++i) {
+        wra.stepUpdateQ(0, 0.0); wra.stepUpdateQ(1, 1.0);
+        era.stepUpdateQ(0, 0.0); era.stepUpdateQ(1, 1.0);
+    }
+    BOOST_CHECK_EQUAL(greedy.sampleAction(), 1);
+    BOOST_CHECK(thompson.getActionProbability(1) > 0.99);
+}
@@ -82,3 +82,74 @@ BOOST_AUTO_TEST_CASE( probability ) {
     BOOST_CHECK(0.375 < pol[1] && pol[1] < 0.485);
     BOOST_CHECK(0.375 < pol[2] && pol[2] < 0.485);
 }
+
+BOOST_AUTO_TEST_CASE( batched_sampling ) {
+    using namespace AIToolbox;
+    constexpr size_t A = 3;
+
+    Bandit::RollingAverage ra(A);
+    for (unsigned i = 0; i < 5; ++i) {
+        ra.stepUpdateQ(1, 1.0);
+        ra.stepUpdateQ(2, 1.0);
+    }
+    Bandit::ThompsonSamplingPolicy p(ra.getQFunction(), ra.getCounts());
+
+    std::vector<size_t> actions;
+    p.sampleActions(1000, &actions);
+    BOOST_CHECK_EQUAL(actions.size(), 1000);
+
+    std::array<unsigned, A> counts{{0,0,0}};
+    for (auto a : actions) ++counts[a];
+
+    BOOST_CHECK(100 < counts[0] && counts[0] < 180);
+    BOOST_CHECK(375 < counts[1] && counts[1] < 485);
+    BOOST_CHECK(375 < counts[2] && counts[2] < 485);
+}
+
+BOOST_AUTO_TEST_CASE( analytic_policy ) {
+    using namespace AIToolbox;
+    constexpr size_t A = 5;
+
+    Bandit::QFunction q(A);
+    q << 0.2, 0.5, 0.45, 0.0, 0.5;
+    std::vector<unsigned> counts{3, 1, 0, 100, 1};
+
+    Bandit::ThompsonSamplingPolicy p(q, counts);
+
+    // Estimate the policy by sampling, which is what we are approximating.
+    constexpr unsigned N = 400000;
+    std::vector<size_t> actions;
+    p.sampleActions(N, &actions);
+    Vector estimate(A);
+    estimate.setZero();
+    for (auto a : actions) estimate[a] += 1.0 / N;
+
+    const auto policy = p.getPolicy();
+    BOOST_CHECK_CLOSE(policy.sum(), 1.0, 1e-9);
+    for (size_t a = 0; a < A; ++a) {
+        BOOST_TEST_INFO("a = " << a);
+        BOOST_CHECK_SMALL(policy[a] - estimate[a], 0.005);
+        BOOST_CHECK_EQUAL(p.getActionProbability(a), policy[a]);
+    }
+
+    // Identical arms have the same probability.
+    BOOST_CHECK_CLOSE(policy[1], policy[4], 1e-6);
+
+    // The cache is refreshed when the inputs change.
+    counts[3] = 0;
+    q[3] = 10.0;
+    const auto changed = p.getPolicy();
+    BOOST_CHECK_CLOSE(changed[3], 1.0, 1e-6);
+
+    // Many arms, almost all of which can be pruned.
+    constexpr size_t Many = 10000;
+    Bandit::QFunction qq(Many);
+    std::vector<unsigned> cc(Many, 50);
+    for (size_t a = 0; a < Many; ++a) qq[a] = static_cast<double>(a) / Many;
+
+    Bandit::ThompsonSamplingPolicy pp(qq, cc);
+    const auto manyPolicy = pp.getPolicy();
+    BOOST_CHECK_CLOSE(manyPolicy.sum(), 1.0, 1e-9);
+    BOOST_CHECK_EQUAL(manyPolicy[0], 0.0);
+    BOOST_CHECK(manyPolicy[Many - 1] > manyPolicy[Many - 100]);
+}
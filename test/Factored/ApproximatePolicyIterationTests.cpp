@@ -0,0 +1,118 @@
+#define BOOST_TEST_MODULE Factored_MDP_ApproximatePolicyIteration
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Factored/MDP/Algorithms/ApproximatePolicyIteration.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include "Utils/SysAdmin.hpp"
+
+using API = afm::ApproximatePolicyIteration;
+
+aif::FactoredVector makeBases(const afm::CooperativeModel & problem) {
+    aif::FactoredVector h;
+    for (size_t s = 0; s < problem.getS().size(); s += 2) {
+        for (size_t i = 0; i < 9; ++i) {
+            h.bases.emplace_back(aif::BasisFunction{{s, s+1}, ai::Vector(9)});
+            h.bases.back().values.setZero();
+            h.bases.back().values[i] = 1.0;
+        }
+    }
+    return h;
+}
+
+// Each agent observes its own status and load, and never reboots.
+API::Policy makePolicy(const afm::CooperativeModel & problem) {
+    API::Policy policy;
+    for (size_t a = 0; a < problem.getA().size(); ++a)
+        policy.emplace_back(API::LocalPolicy{{a * 2, a * 2 + 1}, std::vector<size_t>(9, 0)});
+    return policy;
+}
+
+BOOST_AUTO_TEST_CASE( solver ) {
+    const auto problem = makeSysAdminUniRing(3, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto h = makeBases(problem);
+
+    API solver;
+    const auto [weights, q, policy] = solver(problem, h, makePolicy(problem));
+
+    BOOST_CHECK_EQUAL(weights.size(), h.bases.size());
+    BOOST_CHECK_EQUAL(policy.size(), problem.getA().size());
+    BOOST_CHECK(solver.getIterations() > 1);
+    BOOST_CHECK(solver.getIterations() < solver.getMaxIterations());
+
+    // All evaluations share the same LP.
+    BOOST_CHECK_EQUAL(solver.getLPBuildCount(), 1);
+
+    // Dead machines (status 2) must be rebooted.
+    for (const auto & p : policy) {
+        for (size_t load = 0; load < 3; ++load)
+            BOOST_CHECK_EQUAL(p.actions[2 + load * 3], 1);
+    }
+
+    // The policy is stable, so starting from it we stop immediately.
+    const auto [weights2, q2, policy2] = solver(problem, h, policy);
+    BOOST_CHECK_EQUAL(solver.getIterations(), 1);
+    for (size_t a = 0; a < policy.size(); ++a)
+        BOOST_CHECK(policy2[a].actions == policy[a].actions);
+    for (int i = 0; i < weights.size(); ++i)
+        BOOST_CHECK_CLOSE(weights2[i], weights[i], 0.0001);
+}
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    const auto problem = makeSysAdminUniRing(4, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto h = makeBases(problem);
+
+    const auto [serialWeights, serialQ, serialPolicy] = API()(problem, h, makePolicy(problem));
+
+    ai::ThreadPool pool(3);
+    API solver;
+    solver.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+    // Each local policy is improved independently, so the result must be identical.
+    const auto [weights, q, policy] = solver(problem, h, makePolicy(problem));
+
+    BOOST_CHECK_EQUAL(weights, serialWeights);
+    for (size_t a = 0; a < policy.size(); ++a)
+        BOOST_CHECK(policy[a].actions == serialPolicy[a].actions);
+}
+
+BOOST_AUTO_TEST_CASE( max_iterations ) {
+    const auto problem = makeSysAdminUniRing(2, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto h = makeBases(problem);
+    const auto initial = makePolicy(problem);
+
+    API solver(1);
+    const auto [weights, q, policy] = solver(problem, h, initial);
+
+    // Only the initial policy is evaluated.
+    BOOST_CHECK_EQUAL(solver.getIterations(), 1);
+    for (size_t a = 0; a < policy.size(); ++a)
+        BOOST_CHECK(policy[a].actions == initial[a].actions);
+}
+
+BOOST_AUTO_TEST_CASE( exceptions ) {
+    const auto problem = makeSysAdminUniRing(2, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto h = makeBases(problem);
+
+    API solver;
+
+    auto policy = makePolicy(problem);
+    policy.pop_back();
+    BOOST_CHECK_THROW(solver(problem, h, policy), std::invalid_argument);
+
+    policy = makePolicy(problem);
+    policy[0].actions.pop_back();
+    BOOST_CHECK_THROW(solver(problem, h, policy), std::invalid_argument);
+
+    policy = makePolicy(problem);
+    policy[1].actions[0] = 2;
+    BOOST_CHECK_THROW(solver(problem, h, policy), std::invalid_argument);
+
+    policy = makePolicy(problem);
+    policy[1].tag = {3, 1};
+    BOOST_CHECK_THROW(solver(problem, h, policy), std::invalid_argument);
+}
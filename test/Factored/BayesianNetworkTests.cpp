@@ -6,6 +6,9 @@
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
 #include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include "Utils/SysAdmin.hpp"
 
 namespace ai = AIToolbox;
 namespace aif = AIToolbox::Factored;
@@ -112,4 +115,197 @@ BOOST_AUTO_TEST_CASE( compact_ddn ) {
             }
         }
     }
+
+    // The networks are built once, and copies reference their own nodes.
+    BOOST_CHECK_EQUAL(&T.makeDiffTransition(1), &T.makeDiffTransition(1));
+
+    const auto copy = T;
+    for (size_t a = 0; a < 3; ++a) {
+        for (size_t i = 0; i < 3; ++i) {
+            BOOST_CHECK_NE(&copy.makeDiffTransition(a)[i], &T.makeDiffTransition(a)[i]);
+            BOOST_CHECK_EQUAL(copy.makeDiffTransition(a)[i].matrix, T.makeDiffTransition(a)[i].matrix);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( compact_ddn_back_projection ) {
+    aif::State s{3,3,3,3};
+    ai::Matrix2D p1(9, 3);
+    p1 <<
+       0.90, 0.05, 0.05,
+       0.70, 0.20, 0.10,
+       0.20, 0.50, 0.30,
+       0.05, 0.90, 0.05,
+       0.10, 0.70, 0.20,
+       0.20, 0.50, 0.30,
+       0.05, 0.05, 0.90,
+       0.20, 0.10, 0.70,
+       0.50, 0.10, 0.40
+    ;
+    ai::Matrix2D p2(3, 3);
+    p2.setIdentity();
+
+    std::vector<aif::DBN::Node> f {
+        {{0,1}, p1},
+        {{1,2}, p1},
+        {{2,3}, p1},
+        {{0,3}, p1}
+    };
+
+    // The last action does not change anything.
+    const auto T = aif::CompactDDN({
+        {{0, {{0}, p2}}},
+        {{1, {{1}, p2}}, {3, {{3}, p2}}},
+        {}
+    }, {f});
+
+    aif::FactoredVector h;
+    for (size_t i = 0; i < s.size(); ++i) {
+        h.bases.emplace_back(aif::BasisFunction{{i, (i + 1) % s.size()}, ai::Vector(9)});
+        std::sort(h.bases.back().tag.begin(), h.bases.back().tag.end());
+        for (size_t j = 0; j < 9; ++j)
+            h.bases.back().values[j] = 1.0 + i + 0.5 * j;
+    }
+
+    const auto serial = aif::backProject(s, T, h);
+    BOOST_REQUIRE_EQUAL(serial.size(), 3);
+
+    ai::ThreadPool pool(3);
+    const auto parallel = aif::backProject(s, T, h, &pool);
+
+    for (size_t a = 0; a < 3; ++a) {
+        const auto check = aif::backProject(s, T.makeDiffTransition(a), h);
+
+        BOOST_TEST_INFO("Action: " << a);
+        BOOST_REQUIRE_EQUAL(serial[a].bases.size(), check.bases.size());
+        BOOST_REQUIRE_EQUAL(parallel[a].bases.size(), check.bases.size());
+        for (size_t i = 0; i < check.bases.size(); ++i) {
+            BOOST_CHECK_EQUAL(ai::veccmp(serial[a].bases[i].tag, check.bases[i].tag), 0);
+            BOOST_CHECK_EQUAL(serial[a].bases[i].values, check.bases[i].values);
+            BOOST_CHECK_EQUAL(ai::veccmp(parallel[a].bases[i].tag, check.bases[i].tag), 0);
+            BOOST_CHECK_EQUAL(parallel[a].bases[i].values, check.bases[i].values);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( back_projection_thread_pool ) {
+    const auto problem = makeSysAdminUniRing(6, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto & S = problem.getS();
+
+    aif::FactoredVector h;
+    for (size_t s = 0; s < S.size(); s += 2) {
+        for (size_t i = 0; i < 9; ++i) {
+            h.bases.emplace_back(aif::BasisFunction{{s, s+1}, ai::Vector(9)});
+            h.bases.back().values.setZero();
+            h.bases.back().values[i] = 1.0 + i;
+        }
+    }
+
+    const auto serial = aif::backProject(S, problem.getA(), problem.getTransitionFunction(), h);
+
+    for (const size_t threads : {1, 2, 5}) {
+        ai::ThreadPool pool(threads);
+        const auto parallel = aif::backProject(S, problem.getA(), problem.getTransitionFunction(), h, &pool);
+
+        BOOST_TEST_INFO("Threads: " << threads);
+        BOOST_REQUIRE_EQUAL(parallel.bases.size(), serial.bases.size());
+        for (size_t i = 0; i < serial.bases.size(); ++i) {
+            BOOST_CHECK_EQUAL(ai::veccmp(parallel.bases[i].tag, serial.bases[i].tag), 0);
+            BOOST_CHECK_EQUAL(ai::veccmp(parallel.bases[i].actionTag, serial.bases[i].actionTag), 0);
+            BOOST_CHECK_EQUAL(parallel.bases[i].values, serial.bases[i].values);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batched_transition_probabilities ) {
+    const auto problem = makeSysAdminUniRing(4, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto & S = problem.getS();
+    const auto & A = problem.getA();
+    const auto & ddn = problem.getTransitionFunction();
+
+    std::vector<aif::State> s1s;
+    aif::PartialFactorsEnumerator s1(S);
+    for (; s1.isValid(); s1.advance())
+        s1s.push_back((*s1).second);
+
+    const aif::State s{0, 1, 2, 0, 1, 2, 2, 1};
+    const aif::Action a{0, 1, 1, 0};
+
+    const auto p = ddn.getTransitionProbabilities(S, A, s, a, s1s);
+    const auto logp = ddn.getTransitionLogProbabilities(S, A, s, a, s1s);
+
+    BOOST_REQUIRE_EQUAL(p.size(), s1s.size());
+    BOOST_REQUIRE_EQUAL(logp.size(), s1s.size());
+    for (size_t j = 0; j < s1s.size(); ++j) {
+        const auto expected = ddn.getTransitionProbability(S, A, s, a, s1s[j]);
+        BOOST_CHECK_EQUAL(p[j], expected);
+        if (expected == 0.0) BOOST_CHECK(std::isinf(logp[j]) && logp[j] < 0.0);
+        else BOOST_CHECK_CLOSE(std::exp(logp[j]), expected, 0.000001);
+    }
+    BOOST_CHECK_CLOSE(p.sum(), 1.0, 0.000001);
+
+    // Same checks for the DBN of the default action.
+    aif::DBN dbn;
+    for (const auto & node : ddn.nodes)
+        dbn.nodes.push_back(node.nodes[0]);
+
+    const auto dp = dbn.getTransitionProbabilities(S, s, s1s);
+    const auto dlogp = dbn.getTransitionLogProbabilities(S, s, s1s);
+    for (size_t j = 0; j < s1s.size(); ++j) {
+        const auto expected = dbn.getTransitionProbability(S, s, s1s[j]);
+        BOOST_CHECK_EQUAL(dp[j], expected);
+        if (expected != 0.0) BOOST_CHECK_CLOSE(std::exp(dlogp[j]), expected, 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( back_projection_cache ) {
+    auto problem = makeSysAdminUniRing(4, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+    const auto & S = problem.getS();
+    const auto & A = problem.getA();
+
+    aif::FactoredVector h;
+    for (size_t s = 0; s < S.size(); s += 2) {
+        h.bases.emplace_back(aif::BasisFunction{{s, s+1}, ai::Vector(9)});
+        for (size_t i = 0; i < 9; ++i)
+            h.bases.back().values[i] = 1.0 + i;
+    }
+    h.bases.emplace_back(aif::BasisFunction{{1}, ai::Vector(3)});
+    h.bases.back().values << 1.0, -2.0, 3.0;
+
+    aif::FactoredDDN ddn = problem.getTransitionFunction();
+    aif::BackProjectionCache cache(S, A, ddn);
+
+    const auto check = [&](const aif::FactoredVector & fv) {
+        const auto expected = aif::backProject(S, A, ddn, fv);
+        const auto cached = cache(fv);
+
+        BOOST_REQUIRE_EQUAL(cached.bases.size(), expected.bases.size());
+        for (size_t i = 0; i < expected.bases.size(); ++i) {
+            BOOST_CHECK_EQUAL(ai::veccmp(cached.bases[i].tag, expected.bases[i].tag), 0);
+            BOOST_CHECK_EQUAL(ai::veccmp(cached.bases[i].actionTag, expected.bases[i].actionTag), 0);
+            BOOST_REQUIRE_EQUAL(cached.bases[i].values.rows(), expected.bases[i].values.rows());
+            BOOST_REQUIRE_EQUAL(cached.bases[i].values.cols(), expected.bases[i].values.cols());
+            for (int r = 0; r < expected.bases[i].values.rows(); ++r)
+                for (int c = 0; c < expected.bases[i].values.cols(); ++c)
+                    BOOST_CHECK(ai::checkEqualGeneral(cached.bases[i].values(r, c), expected.bases[i].values(r, c)));
+        }
+    };
+
+    check(h);
+    BOOST_CHECK_EQUAL(cache.size(), 5);
+
+    // Different values with the same tags reuse the cached entries.
+    check(h * 3.5);
+    BOOST_CHECK_EQUAL(cache.size(), 5);
+
+    // Changing a node only invalidates the entries which depend on it.
+    for (auto & node : ddn.nodes[1].nodes)
+        node.matrix.col(0).swap(node.matrix.col(2));
+    cache.invalidate(1);
+    BOOST_CHECK_EQUAL(cache.size(), 3);
+    check(h);
+    BOOST_CHECK_EQUAL(cache.size(), 5);
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.size(), 0);
 }
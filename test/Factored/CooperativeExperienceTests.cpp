@@ -6,6 +6,10 @@
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/MDP/CooperativeExperience.hpp>
 #include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
+#include <AIToolbox/Factored/MDP/BinaryIO.hpp>
+
+#include <random>
+#include <sstream>
 
 #include "Utils/SysAdmin.hpp"
 
@@ -252,3 +256,52 @@ BOOST_AUTO_TEST_CASE( recording ) {
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE( experienceTables ) {
+    auto model = makeSysAdminBiRing(7, 0.1, 0.2, 0.3, 0.4, 0.2, 0.2, 0.1);
+    const auto & S = model.getS();
+    const auto & A = model.getA();
+
+    afm::CooperativeExperience exp(S, A, model.getTransitionFunction().nodes);
+
+    ai::RandomEngine rnd(0);
+    aif::State s(S.size()), s1(S.size());
+    aif::Action a(A.size());
+    ai::Vector rew(S.size());
+    for (size_t t = 0; t < 200; ++t) {
+        for (size_t i = 0; i < S.size(); ++i) {
+            s[i] = std::uniform_int_distribution<size_t>(0, S[i]-1)(rnd);
+            s1[i] = std::uniform_int_distribution<size_t>(0, S[i]-1)(rnd);
+            rew[i] = std::uniform_int_distribution<int>(-2, 2)(rnd) * 0.5;
+        }
+        for (size_t i = 0; i < A.size(); ++i)
+            a[i] = std::uniform_int_distribution<size_t>(0, A[i]-1)(rnd);
+        exp.record(s, a, s1, rew);
+    }
+
+    std::stringstream stream;
+    BOOST_CHECK( afm::writeExperienceTable(stream, exp) );
+
+    afm::CooperativeExperience loaded(S, A, model.getTransitionFunction().nodes);
+    BOOST_CHECK( afm::readExperienceTable(stream, loaded) );
+
+    const auto & v = exp.getVisitTable();
+    const auto & lv = loaded.getVisitTable();
+    const auto & r = exp.getRewardMatrix();
+    const auto & lr = loaded.getRewardMatrix();
+    for (size_t i = 0; i < S.size(); ++i) {
+        BOOST_CHECK_EQUAL(exp.getDirtyIndeces()[i].size(), loaded.getDirtyIndeces()[i].size());
+        for (size_t j = 0; j < v[i].size(); ++j) {
+            BOOST_CHECK(v[i][j] == lv[i][j]);
+            BOOST_CHECK(r[i].nodes[j].matrix.isApprox(lr[i].nodes[j].matrix));
+        }
+    }
+
+    // Tables written for different spaces are rejected.
+    auto other = makeSysAdminBiRing(5, 0.1, 0.2, 0.3, 0.4, 0.2, 0.2, 0.1);
+    afm::CooperativeExperience wrong(other.getS(), other.getA(), other.getTransitionFunction().nodes);
+    std::stringstream again(stream.str());
+    BOOST_CHECK( !afm::readExperienceTable(again, wrong) );
+    for (const auto & d : wrong.getDirtyIndeces())
+        BOOST_CHECK(d.empty());
+}
@@ -4,6 +4,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/Factored/MDP/CooperativeModel.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include "Utils/SysAdmin.hpp"
 
@@ -93,3 +97,138 @@ BOOST_AUTO_TEST_CASE( sampling ) {
     BOOST_CHECK(totReward < 10000 * pDoneF + 100);
     BOOST_CHECK(totReward > 10000 * pDoneF - 100);
 }
+
+BOOST_AUTO_TEST_CASE( batch_sampling ) {
+    // Status transition params.
+    double pFailBase = 0.1, pFailBonus = 0.2, pDeadBase = 0.3, pDeadBonus = 0.4;
+    // Load transition params.
+    double pLoad = 0.2, pDoneG = 0.2, pDoneF = 0.1;
+
+    const auto makeModel = [&]() {
+        return makeSysAdminBiRing(5, pFailBase, pFailBonus, pDeadBase,
+                pDeadBonus, pLoad, pDoneG, pDoneF);
+    };
+
+    const aif::State s{0, 0, 1, 1, 1, 0, 2, 2, 0, 0};
+    const aif::Action a{0, 0, 0, 0, 0};
+
+    // Same transitions as in the sampling test, in structure of arrays form.
+    constexpr size_t trials = 10000;
+    afm::TransitionBatch batch;
+    for (const auto v : s) batch.states.insert(std::end(batch.states), trials, v);
+    for (const auto v : a) batch.actions.insert(std::end(batch.actions), trials, v);
+
+    for (const bool alias : {false, true}) {
+        BOOST_TEST_INFO("Alias sampling: " << alias);
+
+        AIToolbox::Impl::Seeder::setRootSeed(12345);
+        auto serialModel = makeModel();
+        AIToolbox::Impl::Seeder::setRootSeed(12345);
+        auto problem = makeModel();
+
+        serialModel.setAliasSampling(alias);
+        problem.setAliasSampling(alias);
+        BOOST_CHECK_EQUAL(problem.getAliasSampling(), alias);
+
+        auto serialBatch = batch;
+        serialModel.sampleSR(&serialBatch);
+
+        AIToolbox::ThreadPool pool(3);
+        problem.sampleSR(&batch, &pool);
+
+        // The result does not depend on the threads.
+        BOOST_CHECK(batch.nextStates == serialBatch.nextStates);
+        BOOST_CHECK(batch.rewards == serialBatch.rewards);
+
+        const auto factor = [&](const size_t i, const size_t n) { return batch.nextStates[i * trials + n]; };
+
+        std::vector<unsigned> counters{0,0,0,0,0};
+        double totReward = 0.0;
+        for (size_t n = 0; n < trials; ++n) {
+            totReward += batch.rewards[n];
+
+            counters[0] += factor(0, n);
+            BOOST_CHECK(factor(0, n) != 2);
+            counters[1] += factor(2, n);
+            BOOST_CHECK(factor(2, n) != 0);
+            counters[2] += factor(4, n);
+            BOOST_CHECK(factor(4, n) != 0);
+            BOOST_CHECK(factor(6, n) == 2);
+            counters[4] += factor(8, n);
+            BOOST_CHECK(factor(8, n) != 2);
+
+            BOOST_CHECK(factor(1, n) != 2);
+            BOOST_CHECK(factor(3, n) != 0);
+            BOOST_CHECK(factor(5, n) != 2);
+            BOOST_CHECK(factor(7, n) == 0);
+            BOOST_CHECK(factor(9, n) != 2);
+        }
+
+        constexpr auto tolerance = 300;
+        std::vector<double> solutions{
+            trials * (pFailBase + pFailBonus / 2),
+            trials + trials * (pDeadBase + pFailBonus / 2),
+            trials + trials * (pDeadBase + pFailBonus / 2 + pDeadBonus / 2),
+            0,
+            trials * (pFailBase + pDeadBonus / 2)
+        };
+
+        for (size_t i = 0; i < 4; ++i) {
+            BOOST_TEST_INFO("Counter " << i);
+            BOOST_CHECK(counters[i] < solutions[i] + tolerance);
+            BOOST_CHECK(counters[i] > solutions[i] - tolerance);
+        }
+
+        BOOST_CHECK(totReward < trials * pDoneF + 100);
+        BOOST_CHECK(totReward > trials * pDoneF - 100);
+
+        // The rewards are the same as the single sampleSR ones.
+        aif::State s1(s.size());
+        BOOST_CHECK_EQUAL(batch.rewards[0], problem.sampleSR(s, a, &s1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( expected_rewards ) {
+    const auto problem = makeSysAdminBiRing(4, 0.1, 0.2, 0.3, 0.4, 0.2, 0.2, 0.1);
+    const auto & S = problem.getS();
+    const auto & A = problem.getA();
+
+    // We compare the flattened rewards with the FactoredMatrix2D on all
+    // actions and on a set of states.
+    constexpr size_t states = 50;
+    std::vector<aif::State> ss;
+    std::vector<aif::Action> as;
+    AIToolbox::RandomEngine rand(12345);
+    for (size_t i = 0; i < states; ++i) {
+        ss.emplace_back(S.size());
+        for (size_t f = 0; f < S.size(); ++f)
+            ss.back()[f] = std::uniform_int_distribution<size_t>(0, S[f] - 1)(rand);
+    }
+    for (aif::PartialFactorsEnumerator e(A); e.isValid(); e.advance())
+        as.emplace_back((*e).second);
+
+    const size_t N = ss.size() * as.size();
+    afm::TransitionBatch batch;
+    batch.states.resize(S.size() * N);
+    batch.actions.resize(A.size() * N);
+    size_t n = 0;
+    for (const auto & s : ss) {
+        for (const auto & a : as) {
+            for (size_t f = 0; f < S.size(); ++f) batch.states[f * N + n] = s[f];
+            for (size_t f = 0; f < A.size(); ++f) batch.actions[f * N + n] = a[f];
+            ++n;
+        }
+    }
+    problem.getExpectedRewards(&batch);
+    BOOST_REQUIRE_EQUAL(batch.rewards.size(), N);
+
+    n = 0;
+    for (const auto & s : ss) {
+        for (const auto & a : as) {
+            const double expected = problem.getRewardFunction().getValue(S, A, s, a);
+            BOOST_CHECK(AIToolbox::checkEqualGeneral(problem.getExpectedReward(s, a, s), expected));
+            BOOST_CHECK(AIToolbox::checkEqualGeneral(batch.rewards[n], expected));
+            ++n;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#define BOOST_TEST_MODULE Factored_MDP_CooperativeQLearning
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/CooperativeQLearning.hpp>
+#include <AIToolbox/Factored/MDP/Algorithms/SparseCooperativeQLearning.hpp>
+#include <AIToolbox/Factored/MDP/Policies/QGreedyPolicy.hpp>
+
+namespace ai = AIToolbox;
+namespace aif = AIToolbox::Factored;
+namespace fm = AIToolbox::Factored::MDP;
+
+BOOST_AUTO_TEST_CASE( same_as_sparse ) {
+    const aif::State S{2, 3};
+    const aif::Action A{2, 2, 3};
+
+    // State tag, action tag
+    const std::vector<std::pair<aif::PartialKeys, aif::PartialKeys>> domains {
+        {{0},    {0, 1}},
+        {{1},    {1, 2}},
+        {{0, 1}, {2}},
+        {{1},    {0}},
+    };
+
+    // Random initial values, so that there are no ties between actions.
+    ai::RandomEngine rand(0);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    fm::QFunction q;
+    for (const auto & [stateTag, actionTag] : domains) {
+        aif::BasisMatrix basis{stateTag, actionTag, ai::Matrix2D(aif::factorSpacePartial(stateTag, S), aif::factorSpacePartial(actionTag, A))};
+        for (size_t x = 0; x < static_cast<size_t>(basis.values.rows()); ++x)
+            for (size_t y = 0; y < static_cast<size_t>(basis.values.cols()); ++y)
+                basis.values(x, y) = dist(rand);
+        q.bases.push_back(std::move(basis));
+    }
+
+    const double alpha = 0.3, gamma = 0.9;
+    fm::CooperativeQLearning dense(S, A, q, gamma, alpha);
+    fm::SparseCooperativeQLearning sparse(S, A, gamma, alpha);
+
+    // One rule for each cell of the tables.
+    for (const auto & basis : q.bases) {
+        aif::PartialFactorsEnumerator se(S, basis.tag);
+        for (size_t x = 0; se.isValid(); se.advance(), ++x) {
+            aif::PartialFactorsEnumerator ae(A, basis.actionTag);
+            for (size_t y = 0; ae.isValid(); ae.advance(), ++y)
+                sparse.insertRule({*se, *ae, basis.values(x, y)});
+        }
+    }
+
+    const auto randomValue = [&rand](const aif::Factors & space) {
+        aif::Factors f(space.size());
+        for (size_t i = 0; i < space.size(); ++i)
+            f[i] = std::uniform_int_distribution<size_t>(0, space[i] - 1)(rand);
+        return f;
+    };
+
+    aif::State s = randomValue(S);
+    for (size_t t = 0; t < 200; ++t) {
+        const auto a = randomValue(A);
+        const auto s1 = randomValue(S);
+        aif::Rewards rew(A.size());
+        for (size_t i = 0; i < A.size(); ++i)
+            rew[i] = static_cast<double>((s[i % S.size()] * 3 + a[i] * 5 + i) % 7) - 2.0;
+
+        const auto a1 = dense.stepUpdateQ(s, a, s1, rew);
+        const auto a2 = sparse.stepUpdateQ(s, a, s1, rew);
+        BOOST_CHECK_EQUAL(ai::veccmp(a1, a2), 0);
+
+        s = s1;
+    }
+
+    // Finally, all cells must have been learned the same way.
+    const auto & qf = dense.getQFunction();
+    for (const auto & rule : sparse.getQFunctionRules().getContainer()) {
+        double value = 0.0;
+        bool found = false;
+        for (const auto & basis : qf.bases) {
+            if (basis.tag != rule.state.first || basis.actionTag != rule.action.first) continue;
+            value = basis.values(aif::toIndexPartial(S, rule.state), aif::toIndexPartial(A, rule.action));
+            found = true;
+        }
+        BOOST_CHECK(found);
+        BOOST_CHECK_SMALL(value - rule.value, 0.000001);
+    }
+
+    // The greedy policy uses the dense tables directly.
+    fm::QGreedyPolicy p(S, A, qf);
+    const auto a = p.sampleAction(s);
+    double best = 0.0;
+    for (const auto & basis : qf.bases)
+        best += basis.values(aif::toIndexPartial(basis.tag, S, s), aif::toIndexPartial(basis.actionTag, A, a));
+    aif::PartialFactorsEnumerator all(A);
+    for (; all.isValid(); all.advance()) {
+        double v = 0.0;
+        for (const auto & basis : qf.bases)
+            v += basis.values(aif::toIndexPartial(basis.tag, S, s), aif::toIndexPartial(basis.actionTag, A, all->second));
+        BOOST_CHECK(v <= best + 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( wrong_sizes ) {
+    const aif::State S{2, 3};
+    const aif::Action A{2, 2};
+
+    fm::QFunction q;
+    q.bases.push_back({{1}, {0}, ai::Matrix2D::Zero(2, 2)});
+
+    BOOST_CHECK_THROW(fm::CooperativeQLearning(S, A, q, 0.9, 0.1), std::invalid_argument);
+}
@@ -5,6 +5,7 @@
 
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/MDP/CooperativeRLModel.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include "Utils/SysAdmin.hpp"
 
@@ -160,3 +161,73 @@ BOOST_AUTO_TEST_CASE( syncing ) {
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE( syncing_dirty ) {
+    auto model = makeSysAdminBiRing(30, 0.1, 0.2, 0.3, 0.4, 0.2, 0.2, 0.1);
+    const auto & S = model.getS();
+    const auto & A = model.getA();
+
+    afm::CooperativeExperience exp(S, A, model.getTransitionFunction().nodes);
+    afm::CooperativeRLModel rl1(exp, 0.9, false);
+    afm::CooperativeRLModel rl2(exp, 0.9, false);
+
+    AIToolbox::ThreadPool pool(3);
+    ai::RandomEngine rand(0);
+    const auto randomValue = [&rand](const aif::Factors & space) {
+        aif::Factors f(space.size());
+        for (size_t i = 0; i < space.size(); ++i)
+            f[i] = std::uniform_int_distribution<size_t>(0, space[i] - 1)(rand);
+        return f;
+    };
+
+    aif::State s1(S.size());
+    aif::Rewards rew(S.size());
+    for (size_t round = 0; round < 2; ++round) {
+        for (size_t t = 0; t < 2000; ++t) {
+            const auto s = randomValue(S);
+            const auto a = randomValue(A);
+            model.sampleSR(s, a, &s1);
+            for (size_t i = 0; i < S.size(); ++i)
+                rew[i] = static_cast<double>(s1[i]);
+
+            exp.record(s, a, s1, rew);
+        }
+
+        // Each dirty row is listed once, and all visited rows are dirty.
+        const auto & dirty = exp.getDirtyIndeces();
+        const auto & visits = exp.getVisitTable();
+        BOOST_CHECK_EQUAL(dirty.size(), S.size());
+        size_t rows = 0;
+        for (size_t i = 0; i < S.size(); ++i) {
+            auto d = dirty[i];
+            std::sort(std::begin(d), std::end(d));
+            BOOST_CHECK(std::adjacent_find(std::begin(d), std::end(d)) == std::end(d));
+
+            size_t visited = 0;
+            for (const auto & v : visits[i])
+                for (int p = 0; p < v.rows(); ++p)
+                    visited += v(p, S[i]) > 0;
+            // In the second round only the rows visited since the clear are dirty.
+            if (round == 0) BOOST_CHECK_EQUAL(d.size(), visited);
+            else            BOOST_CHECK(d.size() <= visited);
+            rows += d.size();
+        }
+        BOOST_CHECK(rows > 1024);
+
+        rl1.sync();
+        rl2.syncDirty(&pool);
+        exp.clearDirty();
+
+        for (const auto & d : exp.getDirtyIndeces())
+            BOOST_CHECK(d.empty());
+
+        const auto & t1 = rl1.getTransitionFunction();
+        const auto & t2 = rl2.getTransitionFunction();
+        for (size_t i = 0; i < t1.nodes.size(); ++i) {
+            for (size_t j = 0; j < t1.nodes[i].nodes.size(); ++j) {
+                BOOST_CHECK_EQUAL(t1.nodes[i].nodes[j].matrix, t2.nodes[i].nodes[j].matrix);
+                BOOST_CHECK_EQUAL(rl1.getRewardFunction()[i][j], rl2.getRewardFunction()[i][j]);
+            }
+        }
+    }
+}
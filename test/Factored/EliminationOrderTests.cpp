@@ -0,0 +1,75 @@
+#define BOOST_TEST_MODULE Factored_EliminationOrder
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Factored/Utils/EliminationOrder.hpp>
+
+namespace aif = AIToolbox::Factored;
+using EO = aif::EliminationOrder;
+
+BOOST_AUTO_TEST_CASE( reverse ) {
+    EO order(aif::Factors{2, 2, 2, 2});
+    BOOST_CHECK(order.getHeuristic() == EO::Heuristic::Reverse);
+
+    const auto & o = order({{0, 1}, {1, 2}, {2, 3}});
+    const std::vector<size_t> solution{3, 2, 1, 0};
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(o), std::end(o), std::begin(solution), std::end(solution));
+}
+
+BOOST_AUTO_TEST_CASE( star ) {
+    // The hub is the last variable, so the reverse order would eliminate
+    // it first, joining all leaves in a single factor.
+    const std::vector<aif::PartialKeys> star{{0, 5}, {1, 5}, {2, 5}, {3, 5}, {4, 5}};
+
+    for (const auto h : {EO::Heuristic::MinDegree, EO::Heuristic::MinFill, EO::Heuristic::WeightedMinFill}) {
+        EO order(aif::Factors(6, 3), h);
+        const auto & o = order(star);
+
+        // The hub is only eliminated once a single leaf is left.
+        BOOST_REQUIRE_EQUAL(o.size(), 6);
+        BOOST_CHECK(o[4] == 5 || o[5] == 5);
+
+        auto sorted = o;
+        std::sort(std::begin(sorted), std::end(sorted));
+        for (size_t i = 0; i < sorted.size(); ++i)
+            BOOST_CHECK_EQUAL(sorted[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( weighted ) {
+    // Two 4-cycles, where every variable needs a single fill edge. The
+    // first cycle has much smaller variables than the second.
+    const std::vector<aif::PartialKeys> cycles{
+        {0, 1}, {1, 2}, {2, 3}, {0, 3},
+        {4, 5}, {5, 6}, {6, 7}, {4, 7},
+    };
+    const aif::Factors sizes{2, 2, 2, 2, 10, 10, 10, 10};
+
+    EO minFill(sizes, EO::Heuristic::MinFill);
+    BOOST_CHECK_EQUAL(minFill(cycles)[0], 7);
+
+    EO weighted(sizes, EO::Heuristic::WeightedMinFill);
+    BOOST_CHECK_EQUAL(weighted(cycles)[0], 3);
+}
+
+BOOST_AUTO_TEST_CASE( caching ) {
+    EO order(aif::Factors{2, 2, 2}, EO::Heuristic::MinFill);
+    BOOST_CHECK_EQUAL(order.getComputeCount(), 0);
+
+    const auto first = order({{0, 1}, {1, 2}});
+    BOOST_CHECK_EQUAL(order.getComputeCount(), 1);
+
+    // The order of the factors does not matter.
+    const auto second = order({{1, 2}, {0, 1}});
+    BOOST_CHECK_EQUAL(order.getComputeCount(), 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(first), std::end(first), std::begin(second), std::end(second));
+
+    order({{0, 1, 2}});
+    BOOST_CHECK_EQUAL(order.getComputeCount(), 2);
+
+    order.setHeuristic(EO::Heuristic::MinDegree);
+    order({{0, 1, 2}});
+    BOOST_CHECK_EQUAL(order.getComputeCount(), 3);
+}
@@ -43,7 +43,7 @@ BOOST_AUTO_TEST_CASE( adding_rules ) {
 }
 
 BOOST_AUTO_TEST_CASE( erase_factor ) {
-    std::vector<size_t> rule{0, 1};
+    aif::PartialKeys rule{0, 1};
 
     const size_t agentsNum = 3;
     aif::FactorGraph<EmptyFactor> graph(agentsNum);
@@ -93,3 +93,43 @@ BOOST_AUTO_TEST_CASE( neighbors ) {
     auto a = graph.getNeighbors(f);
     BOOST_CHECK_EQUAL(a.size(), 5);
 }
+
+BOOST_AUTO_TEST_CASE( reset_and_reuse ) {
+    const size_t agentsNum = 3;
+    aif::FactorGraph<std::vector<int>> graph(agentsNum);
+
+    auto f01 = graph.getFactor({0, 1});
+    auto f12 = graph.getFactor({1, 2});
+    f01->getData().push_back(1);
+    f12->getData().push_back(2);
+
+    graph.erase(f01);
+    graph.erase(0);
+    BOOST_CHECK_EQUAL(graph.factorSize(), 1);
+
+    // Erased factors are reused, with their data cleared.
+    auto again = graph.getFactor({0, 1});
+    BOOST_CHECK(again == f01);
+    BOOST_CHECK(again->getData().empty());
+    BOOST_CHECK_EQUAL(graph.getNeighbors(0).size(), 1);
+
+    graph.reset();
+    BOOST_CHECK_EQUAL(graph.factorSize(), 0);
+    BOOST_CHECK_EQUAL(graph.variableSize(), agentsNum);
+    for (size_t a = 0; a < agentsNum; ++a)
+        BOOST_CHECK_EQUAL(graph.getNeighbors(a).size(), 0);
+
+    // After a reset the same nodes are used for the same topology.
+    BOOST_CHECK(graph.getFactor({1, 2}) == f12);
+    BOOST_CHECK(graph.getFactor({1, 2})->getData().empty());
+    BOOST_CHECK(graph.getFactor({0, 1}) == f01);
+    BOOST_CHECK_EQUAL(graph.factorSize(), 2);
+    BOOST_CHECK_EQUAL(graph.getNeighbors(1).size(), 2);
+
+    // Iteration follows the order in which factors were requested.
+    BOOST_CHECK(graph.begin() == f12);
+
+    auto f02 = graph.getFactor({0, 2});
+    BOOST_CHECK_EQUAL(graph.factorSize(), 3);
+    BOOST_CHECK(f02 != f01 && f02 != f12);
+}
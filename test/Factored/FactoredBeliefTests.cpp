@@ -0,0 +1,238 @@
+#define BOOST_TEST_MODULE Factored_FactoredBelief
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Impl/Seeder.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Factored/Utils/BayesianNetwork.hpp>
+#include <AIToolbox/Factored/POMDP/FactoredBelief.hpp>
+
+namespace ai = AIToolbox;
+namespace aif = AIToolbox::Factored;
+
+namespace {
+    // Exact filtering over the flat joint of all state variables.
+    ai::Vector exactUpdate(const aif::Factors & space, const ai::Vector & b, const aif::DBN & t, const aif::DBN & obs, const aif::Factors & o) {
+        const size_t S = aif::factorSpace(space);
+        ai::Vector retval = ai::Vector::Zero(S);
+        for (size_t s1 = 0; s1 < S; ++s1) {
+            const auto f1 = aif::toFactors(space, s1);
+            for (size_t s = 0; s < S; ++s)
+                retval[s1] += b[s] * t.getTransitionProbability(space, aif::toFactors(space, s), f1);
+            for (size_t j = 0; j < obs.nodes.size(); ++j)
+                retval[s1] *= obs[j].matrix(aif::toIndexPartial(obs[j].tag, space, f1), o[j]);
+        }
+        return retval / retval.sum();
+    }
+
+    // Two binary variables; the second depends on both.
+    aif::DBN makeTransitions() {
+        ai::Matrix2D t0(2, 2);
+        t0 << 0.8, 0.2,
+              0.3, 0.7;
+        ai::Matrix2D t1(4, 2);
+        t1 << 0.9, 0.1,
+              0.4, 0.6,
+              0.2, 0.8,
+              0.5, 0.5;
+        return aif::DBN{{ {{0}, t0}, {{0, 1}, t1} }};
+    }
+
+    // A single observation which depends on both variables.
+    aif::DBN makeObservations() {
+        ai::Matrix2D o(4, 2);
+        o << 0.9, 0.1,
+             0.6, 0.4,
+             0.3, 0.7,
+             0.2, 0.8;
+        return aif::DBN{{ {{0, 1}, o} }};
+    }
+}
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    const aif::Factors space{2, 3, 2};
+
+    aif::POMDP::FactoredBelief b(space);
+    BOOST_CHECK_EQUAL(b.getClusters().size(), 3);
+    BOOST_CHECK_CLOSE(b.getProbability({1, 2, 0}), 1.0 / 12.0, 0.0001);
+
+    aif::POMDP::FactoredBelief b2(space, {{0, 2}, {1}});
+    BOOST_CHECK_EQUAL(b2.getClusterOf(0), 0);
+    BOOST_CHECK_EQUAL(b2.getClusterOf(1), 1);
+    BOOST_CHECK_EQUAL(b2.getClusterOf(2), 0);
+    BOOST_CHECK_EQUAL(b2.getClusters()[0].values.size(), 4);
+
+    BOOST_CHECK_THROW(aif::POMDP::FactoredBelief(space, {{0, 1}}), std::invalid_argument);
+    BOOST_CHECK_THROW(aif::POMDP::FactoredBelief(space, {{0, 1}, {1, 2}}), std::invalid_argument);
+    BOOST_CHECK_THROW(aif::POMDP::FactoredBelief(space, {{1, 0}, {2}}), std::invalid_argument);
+    BOOST_CHECK_THROW(aif::POMDP::FactoredBelief(space, {{0, 1}, {3}}), std::invalid_argument);
+
+    ai::Vector bad(2); bad << 0.5, 0.6;
+    BOOST_CHECK_THROW(b.setDistribution(0, bad), std::invalid_argument);
+    BOOST_CHECK_THROW(b.setDistribution(1, ai::Vector::Constant(2, 0.5)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( marginals ) {
+    const aif::Factors space{2, 3};
+    aif::POMDP::FactoredBelief b(space);
+
+    ai::Vector p0(2); p0 << 0.25, 0.75;
+    ai::Vector p1(3); p1 << 0.5, 0.3, 0.2;
+    b.setDistribution(0, p0);
+    b.setDistribution(1, p1);
+
+    BOOST_CHECK(b.getMarginal({1}).isApprox(p1));
+
+    const auto joint = b.getMarginal({0, 1});
+    for (size_t x = 0; x < 2; ++x)
+        for (size_t y = 0; y < 3; ++y)
+            BOOST_CHECK_CLOSE(joint[x + 2 * y], p0[x] * p1[y], 0.0001);
+
+    BOOST_CHECK_CLOSE(b.getProbability({1, 2}), 0.75 * 0.2, 0.0001);
+}
+
+BOOST_AUTO_TEST_CASE( exact_with_single_cluster ) {
+    const aif::Factors space{2, 2};
+    const auto t = makeTransitions();
+    const auto obs = makeObservations();
+
+    // With a single cluster no projection happens, so the update is exact.
+    aif::POMDP::FactoredBelief b(space, {{0, 1}});
+    ai::Vector flat = ai::Vector::Constant(4, 0.25);
+
+    const std::vector<aif::Factors> observations{{0}, {1}, {1}, {0}};
+    for (const auto & o : observations) {
+        const double p = b.update(t, obs, o);
+        flat = exactUpdate(space, flat, t, obs, o);
+
+        BOOST_CHECK(p > 0.0 && p <= 1.0);
+        BOOST_CHECK(b.getMarginal({0, 1}).isApprox(flat));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( exact_with_independent_variables ) {
+    const aif::Factors space{2, 3};
+
+    ai::Matrix2D t0(2, 2);
+    t0 << 0.7, 0.3,
+          0.1, 0.9;
+    ai::Matrix2D t1(3, 3);
+    t1 << 0.6, 0.3, 0.1,
+          0.2, 0.5, 0.3,
+          0.1, 0.1, 0.8;
+    const aif::DBN t{{ {{0}, t0}, {{1}, t1} }};
+
+    ai::Matrix2D o0(2, 2);
+    o0 << 0.8, 0.2,
+          0.3, 0.7;
+    ai::Matrix2D o1(3, 2);
+    o1 << 0.9, 0.1,
+          0.5, 0.5,
+          0.2, 0.8;
+    const aif::DBN obs{{ {{0}, o0}, {{1}, o1} }};
+
+    // Variables never interact, so the fully factored belief is exact.
+    aif::POMDP::FactoredBelief b(space);
+    ai::Vector flat = ai::Vector::Constant(6, 1.0 / 6.0);
+
+    const std::vector<aif::Factors> observations{{0, 1}, {1, 1}, {0, 0}, {1, 0}};
+    for (const auto & o : observations) {
+        b.update(t, obs, o);
+        flat = exactUpdate(space, flat, t, obs, o);
+        BOOST_CHECK(b.getMarginal({0, 1}).isApprox(flat));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( projection_keeps_marginals_close ) {
+    const aif::Factors space{2, 2};
+    const auto t = makeTransitions();
+    const auto obs = makeObservations();
+
+    aif::POMDP::FactoredBelief b(space);
+    ai::Vector flat = ai::Vector::Constant(4, 0.25);
+
+    const std::vector<aif::Factors> observations{{0}, {1}, {1}, {0}, {0}, {1}};
+    for (const auto & o : observations) {
+        b.update(t, obs, o);
+        flat = exactUpdate(space, flat, t, obs, o);
+
+        const auto approx = b.getMarginal({0, 1});
+        BOOST_CHECK_CLOSE(approx.sum(), 1.0, 0.0001);
+        // The marginals of the variables are approximated, not the joint.
+        BOOST_CHECK_SMALL(std::abs((approx[1] + approx[3]) - (flat[1] + flat[3])), 0.1);
+        BOOST_CHECK_SMALL(std::abs((approx[2] + approx[3]) - (flat[2] + flat[3])), 0.1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( impossible_observation ) {
+    const aif::Factors space{2};
+
+    ai::Matrix2D t0(2, 2);
+    t0 << 1.0, 0.0,
+          0.0, 1.0;
+    const aif::DBN t{{ {{0}, t0} }};
+
+    ai::Matrix2D o0(2, 2);
+    o0 << 1.0, 0.0,
+          1.0, 0.0;
+    const aif::DBN obs{{ {{0}, o0} }};
+
+    aif::POMDP::FactoredBelief b(space);
+    ai::Vector p(2); p << 0.3, 0.7;
+    b.setDistribution(0, p);
+
+    b.predict(t);
+    BOOST_CHECK_EQUAL(b.observe(obs, {1}), 0.0);
+    BOOST_CHECK(b.getClusters()[0].values.isApprox(p));
+
+    BOOST_CHECK_CLOSE(b.observe(obs, {0}), 1.0, 0.0001);
+    BOOST_CHECK(b.getClusters()[0].values.isApprox(p));
+}
+
+BOOST_AUTO_TEST_CASE( factored_actions ) {
+    const aif::Factors space{2, 2};
+    const aif::Factors actions{2};
+
+    const auto t = makeTransitions();
+    ai::Matrix2D stay(2, 2);
+    stay << 1.0, 0.0,
+            0.0, 1.0;
+
+    aif::FactoredDDN ddn;
+    ddn.nodes.push_back({{0}, {{{0}, stay}, t[0]}});
+    ddn.nodes.push_back({{}, {t[1]}});
+
+    aif::POMDP::FactoredBelief b1(space), b2(space);
+    ai::Vector p(2); p << 0.1, 0.9;
+    b1.setDistribution(0, p);
+    b2.setDistribution(0, p);
+
+    b1.predict(actions, ddn, {1});
+    b2.predict(t);
+    BOOST_CHECK(b1.getMarginal({0, 1}).isApprox(b2.getMarginal({0, 1})));
+
+    b1.predict(actions, ddn, {0});
+    b2.predict(aif::DBN{{ {{0}, stay}, t[1] }});
+    BOOST_CHECK(b1.getMarginal({0, 1}).isApprox(b2.getMarginal({0, 1})));
+}
+
+BOOST_AUTO_TEST_CASE( sampling ) {
+    const aif::Factors space{2, 3};
+    aif::POMDP::FactoredBelief b(space, {{0, 1}});
+
+    ai::Vector p(6); p << 0.1, 0.0, 0.2, 0.3, 0.0, 0.4;
+    b.setDistribution(0, p);
+
+    ai::Impl::Seeder::setRootSeed(0);
+    ai::RandomEngine rnd(ai::Impl::Seeder::getSeed());
+
+    const unsigned N = 20000;
+    ai::Vector counts = ai::Vector::Zero(6);
+    for (unsigned i = 0; i < N; ++i)
+        counts[aif::toIndex(space, b.sampleState(rnd))] += 1.0;
+
+    counts /= N;
+    for (size_t s = 0; s < 6; ++s)
+        BOOST_CHECK_SMALL(counts[s] - p[s], 0.02);
+}
@@ -176,3 +176,49 @@ BOOST_AUTO_TEST_CASE( empty_filter ) {
         BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(filtered), std::end(filtered), std::begin(solution), std::end(solution));
     }
 }
+
+BOOST_AUTO_TEST_CASE( buffered_filtering ) {
+    using namespace AIToolbox::Factored;
+
+    // More factors than the filters stored on the stack.
+    Factors F(40, 3);
+
+    FactoredContainer<size_t> f(F);
+    for (size_t i = 0; i < 200; ++i) {
+        PartialFactors key;
+        for (size_t j = 0; j < F.size(); ++j) {
+            if ((i * 7 + j * 3) % 5 == 0) {
+                key.first.push_back(j);
+                key.second.push_back((i + j) % 3);
+            }
+        }
+        f.emplace(key, i);
+    }
+
+    std::vector<size_t> buffer;
+    for (size_t i = 0; i < 50; ++i) {
+        Factors filter(F.size());
+        for (size_t j = 0; j < F.size(); ++j)
+            filter[j] = (i * 11 + j * j) % 3;
+
+        const auto expected = f.filter(filter);
+        const auto filtered = f.filter(filter, 0, &buffer);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(filtered), std::end(filtered), std::begin(expected), std::end(expected));
+
+        const Factors half(std::begin(filter), std::begin(filter) + 5);
+        const auto expectedHalf = f.filter(half, 10);
+        const auto filteredHalf = f.filter(half, 10, &buffer);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(filteredHalf), std::end(filteredHalf), std::begin(expectedHalf), std::end(expectedHalf));
+
+        const PartialFactors partial{{1, 4, 9}, {filter[1], filter[4], filter[9]}};
+        const auto expectedPartial = f.filter(partial);
+        const auto filteredPartial = f.filter(partial, &buffer);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(filteredPartial), std::end(filteredPartial), std::begin(expectedPartial), std::end(expectedPartial));
+    }
+
+    // The buffer is cleared before being written.
+    buffer.assign(5, 0);
+    const auto & cf = f;
+    const auto all = cf.filter(Factors{}, 0, &buffer);
+    BOOST_CHECK_EQUAL(all.size(), f.size());
+}
@@ -6,7 +6,9 @@
 #include <AIToolbox/LP.hpp>
 //#include <AIToolbox/Factored/MDP/Algorithms/FactoredValueIteration.hpp>
 #include <AIToolbox/Factored/MDP/Algorithms/Utils/FactoredLP.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
+namespace ai = AIToolbox;
 namespace aif = AIToolbox::Factored;
 namespace fm = AIToolbox::Factored::MDP;
 using FLP = fm::FactoredLP;
@@ -160,3 +162,104 @@ BOOST_AUTO_TEST_CASE( test_constant_basis ) {
         BOOST_CHECK(std::fabs(solution[i] - (*result)[i]) < AIToolbox::LP::getPrecision());
     }
 }
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    // Large enough that the eliminations are split between threads.
+    aif::State s{4,4,4,4,4};
+
+    const auto makeBases = [](const std::vector<aif::PartialKeys> & tags, double offset) {
+        aif::FactoredVector retval;
+        for (const auto & tag : tags) {
+            aif::BasisFunction f{tag, ai::Vector(16)};
+            for (size_t i = 0; i < 16; ++i)
+                f.values[i] = offset + (i * 7) % 11;
+            retval.bases.emplace_back(std::move(f));
+            offset += 1.0;
+        }
+        return retval;
+    };
+
+    const auto C = makeBases({{0,1}, {1,2}, {2,3}, {3,4}, {0,4}}, 0.0);
+    const auto b = makeBases({{0,2}, {1,3}, {2,4}}, 3.0);
+
+    fm::FactoredLP serial(s);
+    const auto solution = serial(C, b, true);
+    BOOST_REQUIRE(solution);
+
+    for (const size_t threads : {2, 5}) {
+        ai::ThreadPool pool(threads);
+
+        fm::FactoredLP l(s);
+        l.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(l.getThreadPool(), &pool);
+
+        const auto result = l(C, b, true);
+
+        BOOST_TEST_INFO("Threads: " << threads);
+        BOOST_REQUIRE(result);
+        BOOST_CHECK_EQUAL(*result, *solution);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( reuse_structure ) {
+    aif::State s{2,2,2};
+
+    aif::FactoredVector C;
+    C.bases.emplace_back(aif::BasisFunction{{0,1}, ai::Vector(4)});
+    C.bases.back().values << 1.0, 3.0, 2.0, 4.0;
+    C.bases.emplace_back(aif::BasisFunction{{0,2}, ai::Vector(4)});
+    C.bases.back().values << 7.0, 9.0, 8.0, 10.0;
+
+    aif::FactoredVector b;
+    b.bases.emplace_back(aif::BasisFunction{{1,2}, ai::Vector(4)});
+    b.bases.back().values << 7.0, 10.0, 6.0, 9.0;
+    b.bases.emplace_back(aif::BasisFunction{{0,2}, ai::Vector(4)});
+    b.bases.back().values << 10.0, 20.0, 13.0, 23.0;
+
+    const auto check = [](const std::optional<ai::Vector> & result, const ai::Vector & solution) {
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE_EQUAL(result->size(), solution.size());
+        for (int i = 0; i < solution.size(); ++i) {
+            BOOST_TEST_INFO("Element " << i);
+            BOOST_TEST_INFO("Solution: " << solution[i] << "; Result: " << (*result)[i]);
+            BOOST_CHECK(std::fabs(solution[i] - (*result)[i]) < AIToolbox::LP::getPrecision());
+        }
+    };
+
+    fm::FactoredLP l(s);
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 0);
+
+    check(l(C, b), (ai::Vector(2) << 3.0, 2.0).finished());
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 1);
+
+    // Same scopes, different values: the LP is only updated.
+    b.bases[0].values << 6.0, 9.0, 5.0, 8.0;
+    b.bases[1].values << 9.0, 19.0, 12.0, 22.0;
+    C.bases[1].values *= 2.0;
+
+    const auto fresh = fm::FactoredLP(s)(C, b);
+    BOOST_REQUIRE(fresh);
+    check(l(C, b), *fresh);
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 1);
+
+    // Going back to the original values must give the original solution,
+    // even though the solver now starts from a different basis.
+    b.bases[0].values << 7.0, 10.0, 6.0, 9.0;
+    b.bases[1].values << 10.0, 20.0, 13.0, 23.0;
+    C.bases[1].values /= 2.0;
+    check(l(C, b), (ai::Vector(2) << 3.0, 2.0).finished());
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 1);
+
+    // The constant basis changes the structure.
+    b.bases[0].values << 6.0, 9.0, 5.0, 8.0;
+    b.bases[1].values << 9.0, 19.0, 12.0, 22.0;
+    check(l(C, b, true), (ai::Vector(3) << 3.0, 2.0, -2.0).finished());
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 2);
+
+    // And so do different scopes.
+    b.bases[0].tag = {0,1};
+    const auto freshScopes = fm::FactoredLP(s)(C, b, true);
+    BOOST_REQUIRE(freshScopes);
+    check(l(C, b, true), *freshScopes);
+    BOOST_CHECK_EQUAL(l.getBuildCount(), 3);
+}
@@ -30,10 +30,101 @@ BOOST_AUTO_TEST_CASE( simple_test ) {
     a[1] = 1;
     l.stepUpdateQ(0, a, 1, 6.0);
 
-    BOOST_CHECK_EQUAL(l.getSingleQFunction()(0,0), (1.9 * 2.0 + 0.6) / 3.0);
+    BOOST_CHECK_CLOSE(l.getSingleQFunction()(0,0), (1.9 * 2.0 + 0.6) / 3.0, 0.000001);
 
     l.stepUpdateQ(2, a, 0, 10.0);
 
     BOOST_CHECK_EQUAL(l.getSingleQFunction()(2,0), 1.0 + 0.09 * 1.9);
 }
 
+
+BOOST_AUTO_TEST_CASE( marginal_expected_values ) {
+    constexpr size_t S = 4;
+    const aif::Action A{2, 3, 2, 3};
+    constexpr size_t id = 1;
+
+    fm::JointActionLearner l(S, A, id, 0.9, 0.3);
+    BOOST_CHECK(!l.getJointOpponentModel());
+
+    // We recompute the expected values from scratch, using the product of
+    // the empirical distributions of the actions of each other agent.
+    std::vector<std::vector<std::vector<unsigned>>> counts(S, std::vector<std::vector<unsigned>>(A.size()));
+    for (auto & c : counts)
+        for (size_t i = 0; i < A.size(); ++i)
+            c[i].resize(A[i], 0);
+    std::vector<unsigned> totals(S, 0);
+
+    AIToolbox::RandomEngine rand(0);
+    for (size_t t = 0; t < 500; ++t) {
+        aif::Action a(A.size());
+        for (size_t i = 0; i < A.size(); ++i)
+            a[i] = std::uniform_int_distribution<size_t>(0, A[i] - 1)(rand);
+        const size_t s = t % S, s1 = (t * 7 + 1) % S;
+
+        l.stepUpdateQ(s, a, s1, static_cast<double>((t * 13) % 7) - 2.0);
+
+        for (size_t i = 0; i < A.size(); ++i)
+            counts[s][i][a[i]] += 1;
+        totals[s] += 1;
+
+        const auto & q = l.getJointQFunction();
+        for (size_t ai = 0; ai < A[id]; ++ai) {
+            double expected = 0.0;
+            aif::PartialFactorsEnumerator e(A, id);
+            for (; e.isValid(); e.advance()) {
+                auto joint = e->second;
+                double p = 1.0;
+                for (size_t i = 0; i < A.size(); ++i)
+                    if (i != id) p *= static_cast<double>(counts[s][i][joint[i]]) / totals[s];
+                joint[id] = ai;
+                expected += q(s, aif::toIndex(A, joint)) * p;
+            }
+            BOOST_CHECK_SMALL(l.getSingleQFunction()(s, ai) - expected, 1e-9);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( incremental_expected_values ) {
+    constexpr size_t S = 4;
+    const aif::Action A{2, 3, 2, 3};
+    constexpr size_t id = 1;
+
+    fm::JointActionLearner l(S, A, id, 0.9, 0.3);
+    l.setJointOpponentModel(true);
+    BOOST_CHECK(l.getJointOpponentModel());
+
+    // We recompute the expected values from scratch, using the empirical
+    // distribution of the joint actions of the other agents.
+    std::vector<std::vector<unsigned>> counts(S, std::vector<unsigned>(aif::factorSpace(A), 0));
+
+    AIToolbox::RandomEngine rand(0);
+    // Enough steps for the expected values to be refreshed from the counts.
+    for (size_t t = 0; t < 5000; ++t) {
+        aif::Action a(A.size());
+        for (size_t i = 0; i < A.size(); ++i)
+            a[i] = std::uniform_int_distribution<size_t>(0, A[i] - 1)(rand);
+        const size_t s = t % S, s1 = (t * 7 + 1) % S;
+
+        l.stepUpdateQ(s, a, s1, static_cast<double>((t * 13) % 7) - 2.0);
+
+        a[id] = 0;
+        counts[s][aif::toIndex(A, a)] += 1;
+
+        unsigned total = 0;
+        for (const auto c : counts[s]) total += c;
+
+        const auto & q = l.getJointQFunction();
+        for (size_t ai = 0; ai < A[id]; ++ai) {
+            double expected = 0.0;
+            aif::PartialFactorsEnumerator e(A, id);
+            for (; e.isValid(); e.advance()) {
+                auto joint = e->second;
+                joint[id] = 0;
+                const auto c = counts[s][aif::toIndex(A, joint)];
+                joint[id] = ai;
+                expected += q(s, aif::toIndex(A, joint)) * c / total;
+            }
+            BOOST_CHECK_CLOSE(l.getSingleQFunction()(s, ai), expected, 0.000001);
+        }
+    }
+}
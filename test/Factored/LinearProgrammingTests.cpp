@@ -7,6 +7,7 @@
 #include <AIToolbox/Factored/MDP/Policies/QGreedyPolicy.hpp>
 #include <AIToolbox/Factored/MDP/Utils.hpp>
 #include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include "Utils/SysAdmin.hpp"
 
@@ -94,3 +95,31 @@ BOOST_AUTO_TEST_CASE( solver ) {
         BOOST_CHECK_EQUAL(sb.values, qb.values);
     }
 }
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    auto problem = makeSysAdminUniRing(4, 0.1, 0.2, 0.3, 0.4, 0.4, 0.4, 0.3);
+
+    aif::FactoredVector h;
+    for (size_t s = 0; s < problem.getS().size(); s += 2) {
+        for (size_t i = 0; i < 9; ++i) {
+            h.bases.emplace_back(aif::BasisFunction{{s, s+1}, ai::Vector(9)});
+            h.bases.back().values.setZero();
+            h.bases.back().values[i] = 1.0;
+        }
+    }
+
+    const auto [serialWeights, serialQ] = afm::LinearProgramming()(problem, h);
+
+    ai::ThreadPool pool(3);
+    auto solver = afm::LinearProgramming();
+    solver.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+    // The LP is built in the same order, so the result must be identical.
+    const auto [weights, q] = solver(problem, h);
+
+    BOOST_CHECK_EQUAL(weights, serialWeights);
+    BOOST_REQUIRE_EQUAL(q.bases.size(), serialQ.bases.size());
+    for (size_t i = 0; i < q.bases.size(); ++i)
+        BOOST_CHECK_EQUAL(q.bases[i].values, serialQ.bases[i].values);
+}
@@ -8,6 +8,7 @@
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Factored/Bandit/Algorithms/MAUCE.hpp>
 #include <AIToolbox/Factored/Bandit/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
 
 namespace fm = AIToolbox::Factored;
 namespace fb = fm::Bandit;
@@ -71,3 +72,39 @@ BOOST_AUTO_TEST_CASE( simple_example_small ) {
     BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(solution), std::end(solution),
                                   std::begin(greedyAction), std::end(greedyAction));
 }
+
+BOOST_AUTO_TEST_CASE( learned_rules ) {
+    const fm::Action A{2, 3, 2};
+    fb::MAUCE x(A, {{1.0, {0, 1}}, {1.0, {1, 2}}});
+
+    // Each local action gets a fixed reward, so its average is known.
+    const auto reward = [](size_t g, size_t a1, size_t a2) {
+        return static_cast<double>(g * 10 + a1 * 3 + a2) / 20.0;
+    };
+
+    fm::Rewards rew(2);
+    fm::Action action{0, 0, 0};
+    for (unsigned t = 0; t < 200; ++t) {
+        action = {t % 2, (t / 2) % 3, (t / 6) % 2};
+        rew[0] = reward(0, action[0], action[1]);
+        rew[1] = reward(1, action[1], action[2]);
+        x.stepUpdateQ(action, rew);
+    }
+
+    const auto rules = x.getQFunctionRules();
+    BOOST_CHECK_EQUAL(rules.size(), 2 * 3 + 3 * 2);
+
+    fm::PartialFactorsEnumerator e(A);
+    for (; e.isValid(); e.advance()) {
+        const auto & a = e->second;
+        const auto filtered = rules.filter(a);
+
+        std::vector<double> values;
+        for (const auto & rule : filtered)
+            values.push_back(rule.value);
+
+        BOOST_REQUIRE_EQUAL(values.size(), 2);
+        BOOST_CHECK_CLOSE(values[0], reward(0, a[0], a[1]), 0.000001);
+        BOOST_CHECK_CLOSE(values[1], reward(1, a[1], a[2]), 0.000001);
+    }
+}
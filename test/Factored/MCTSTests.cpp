@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE Factored_MDP_MCTS
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Factored/MDP/Algorithms/MCTS.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+namespace aif = AIToolbox::Factored;
+namespace afm = AIToolbox::Factored::MDP;
+
+// A chain of agents, where each pair of neighbors gets 0.5 if both choose
+// action 0, 1 if both choose action 1, and nothing otherwise. The state of
+// each agent is its last action.
+afm::CooperativeModel makeCoordinationChain(const size_t agents) {
+    aif::State S(agents, 2);
+    aif::Action A(agents, 2);
+
+    aif::FactoredDDN ddn;
+    for (size_t i = 0; i < agents; ++i) {
+        aif::FactoredDDN::Node node{{i}, {}};
+        for (size_t a = 0; a < 2; ++a) {
+            AIToolbox::Matrix2D m(2, 2);
+            m.setZero();
+            m.col(a).fill(1.0);
+            node.nodes.push_back({{i}, m});
+        }
+        ddn.nodes.emplace_back(std::move(node));
+    }
+
+    aif::FactoredMatrix2D rewards;
+    for (size_t i = 0; i + 1 < agents; ++i) {
+        aif::BasisMatrix basis;
+        basis.tag = {i};
+        basis.actionTag = {i, i + 1};
+        basis.values.resize(2, 4);
+        // Joint actions are indexed with the first agent changing fastest.
+        basis.values.row(0) << 0.5, 0.0, 0.0, 1.0;
+        basis.values.row(1) = basis.values.row(0);
+        rewards.bases.emplace_back(std::move(basis));
+    }
+
+    return afm::CooperativeModel(std::move(S), std::move(A), std::move(ddn), std::move(rewards), 0.9);
+}
+
+BOOST_AUTO_TEST_CASE( coordination ) {
+    constexpr size_t agents = 8;
+    AIToolbox::Impl::Seeder::setRootSeed(0);
+    const auto model = makeCoordinationChain(agents);
+
+    afm::MCTS solver(model, 2000, 1.0);
+
+    // One group per reward basis, with 4 local joint actions each.
+    BOOST_CHECK_EQUAL(solver.getGroups().size(), agents - 1);
+    BOOST_CHECK_EQUAL(solver.getGraph().getA(), (agents - 1) * 4);
+    BOOST_CHECK_EQUAL(solver.getGroupOffset(2), 8);
+
+    const aif::State s(agents, 0);
+    const aif::Action best(agents, 1);
+
+    auto a = solver.sampleAction(s, 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(a), std::end(a), std::begin(best), std::end(best));
+    // With horizon one no children are added.
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().nodes, 1);
+
+    a = solver.sampleAction(s, 3);
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(a), std::end(a), std::begin(best), std::end(best));
+    BOOST_CHECK(solver.getSearchStatistics().nodesAdded > 0);
+
+    // Transitions are deterministic, so the tree can be reused.
+    const auto & graph = solver.getGraph();
+    a = solver.sampleAction(best, best, 2);
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(a), std::end(a), std::begin(best), std::end(best));
+    BOOST_CHECK(graph.getNode(graph.getRoot()).N > solver.getIterations());
+}
+
+BOOST_AUTO_TEST_CASE( groups ) {
+    const auto model = makeCoordinationChain(4);
+
+    // Agents missing from the groups get their own.
+    afm::MCTS solver(model, {{0, 1}}, 100, 1.0);
+    BOOST_CHECK_EQUAL(solver.getGroups().size(), 3);
+    BOOST_CHECK(solver.getGroups()[1] == aif::PartialKeys{2});
+    BOOST_CHECK_EQUAL(solver.getGraph().getA(), 4 + 2 + 2);
+
+    const auto a = solver.sampleAction(aif::State(4, 0), 1);
+    BOOST_CHECK_EQUAL(a.size(), 4);
+
+    BOOST_CHECK_THROW(afm::MCTS(model, {{1, 0}}, 100, 1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(afm::MCTS(model, {{}}, 100, 1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(afm::MCTS(model, {{3, 4}}, 100, 1.0), std::invalid_argument);
+}
@@ -4,6 +4,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/Factored/Bandit/Algorithms/Utils/MultiObjectiveVariableElimination.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/Prune.hpp>
 
@@ -161,3 +163,87 @@ BOOST_AUTO_TEST_CASE( radu_marinescu_graph ) {
         BOOST_CHECK_EQUAL(std::get<1>(solutions[i]), std::get<1>(bestActions[i]));
     }
 }
+
+BOOST_AUTO_TEST_CASE( pareto_front_bruteforce ) {
+    const aif::Action A{5,4,5,4,5,4};
+
+    AIToolbox::ThreadPool pool(3);
+    AIToolbox::RandomEngine rand(0);
+    // Integer values, so that ties and equal vectors are common.
+    std::uniform_int_distribution<int> vDist(0, 4);
+
+    const auto lexLess = [](const aif::Rewards & lhs, const aif::Rewards & rhs) {
+        return std::lexicographical_compare(lhs.data(), lhs.data() + lhs.size(), rhs.data(), rhs.data() + rhs.size());
+    };
+
+    for (const size_t O : {2, 4}) {
+        for (size_t round = 0; round < 5; ++round) {
+            std::vector<fb::MOQFunctionRule> rules;
+            for (const auto & keys : {aif::PartialKeys{0,1,2}, aif::PartialKeys{1,3}, aif::PartialKeys{2,3,4}, aif::PartialKeys{0,5}, aif::PartialKeys{4,5}, aif::PartialKeys{0,2,4}}) {
+                aif::PartialFactorsEnumerator e(A, keys);
+                for (; e.isValid(); e.advance()) {
+                    aif::Rewards v(O);
+                    for (size_t o = 0; o < O; ++o) v[o] = vDist(rand);
+                    rules.emplace_back(fb::MOQFunctionRule{*e, v});
+                }
+            }
+
+            const auto evaluate = [&](const aif::PartialAction & a) {
+                aif::Rewards v(O); v.setZero();
+                for (const auto & r : rules)
+                    if (aif::match(r.action, a))
+                        v += r.values;
+                return v;
+            };
+
+            // Brute-force Pareto front, without duplicates.
+            std::vector<aif::Rewards> all;
+            aif::PartialFactorsEnumerator jointActions(A);
+            for (; jointActions.isValid(); jointActions.advance())
+                all.push_back(evaluate(*jointActions));
+
+            std::vector<aif::Rewards> front;
+            for (const auto & v : all) {
+                bool dominated = false;
+                for (const auto & w : all) {
+                    if (w != v && (w.array() >= v.array()).all()) {
+                        dominated = true;
+                        break;
+                    }
+                }
+                if (!dominated) front.push_back(v);
+            }
+            std::sort(std::begin(front), std::end(front), lexLess);
+            front.erase(std::unique(std::begin(front), std::end(front)), std::end(front));
+
+            MOVE serial(A);
+            MOVE parallel(A);
+            parallel.setThreadPool(&pool);
+            BOOST_CHECK(parallel.getThreadPool() == &pool);
+
+            const auto serialResults = serial(rules);
+            const auto parallelResults = parallel(rules);
+
+            std::vector<aif::Rewards> found;
+            for (const auto & [a, v] : serialResults) {
+                BOOST_CHECK_EQUAL(a.first.size(), A.size());
+                BOOST_CHECK_EQUAL(evaluate(a), v);
+                found.push_back(v);
+            }
+            std::sort(std::begin(found), std::end(found), lexLess);
+
+            BOOST_REQUIRE_EQUAL(found.size(), front.size());
+            for (size_t i = 0; i < front.size(); ++i)
+                BOOST_CHECK_EQUAL(found[i], front[i]);
+
+            // The thread pool does not change the results, or their order.
+            BOOST_REQUIRE_EQUAL(parallelResults.size(), serialResults.size());
+            for (size_t i = 0; i < serialResults.size(); ++i) {
+                const auto & [sa, sv] = serialResults[i];
+                const auto & [pa, pv] = parallelResults[i];
+                BOOST_CHECK(sa == pa);
+                BOOST_CHECK_EQUAL(sv, pv);
+            }
+        }
+    }
+}
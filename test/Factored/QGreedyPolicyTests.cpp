@@ -0,0 +1,66 @@
+#define BOOST_TEST_MODULE Factored_Bandit_QGreedyPolicy
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Factored/Bandit/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+
+namespace aif = AIToolbox::Factored;
+namespace fb = AIToolbox::Factored::Bandit;
+
+void addRule(aif::FactoredContainer<fb::QFunctionRule> & rules, const aif::PartialAction & a, const double v) {
+    rules.emplace(a, a, v);
+}
+
+BOOST_AUTO_TEST_CASE( cached_action ) {
+    // Two groups: {0, 1} and {2, 3}; agent 4 has no rules.
+    const aif::Action A{2, 2, 3, 2, 2};
+
+    aif::FactoredContainer<fb::QFunctionRule> rules(A);
+    addRule(rules, aif::PartialAction{{0, 1}, {1, 0}}, 3.0);
+    addRule(rules, aif::PartialAction{{0, 1}, {0, 1}}, 2.0);
+    addRule(rules, aif::PartialAction{{1}, {1}}, 0.5);
+    addRule(rules, aif::PartialAction{{2, 3}, {2, 1}}, 4.0);
+    addRule(rules, aif::PartialAction{{2}, {0}}, 1.0);
+    addRule(rules, aif::PartialAction{{3}, {0}}, 3.5);
+
+    fb::QGreedyPolicy p(A, rules);
+
+    const auto check = [&]() {
+        fb::VariableElimination ve(A);
+        const auto [action, value] = ve(rules);
+        BOOST_CHECK_EQUAL(AIToolbox::veccmp(p.sampleAction(), action), 0);
+        BOOST_CHECK_CLOSE(p.getGreedyValue(), value, 1e-9);
+        BOOST_CHECK_EQUAL(p.getActionProbability(action), 1.0);
+    };
+    check();
+    BOOST_CHECK_EQUAL(AIToolbox::veccmp(p.sampleAction(), aif::Action{1, 0, 0, 0, 0}), 0);
+
+    // Without invalidation the cached action is kept.
+    rules[0].value = 0.0;
+    BOOST_CHECK_EQUAL(AIToolbox::veccmp(p.sampleAction(), aif::Action{1, 0, 0, 0, 0}), 0);
+
+    // Only the first group is recomputed.
+    p.invalidate({0});
+    check();
+    BOOST_CHECK_EQUAL(AIToolbox::veccmp(p.sampleAction(), aif::Action{0, 1, 0, 0, 0}), 0);
+
+    rules[3].value = 1.0;
+    p.invalidate({3});
+    check();
+
+    // A new rule joins the two groups, and uses the last agent.
+    addRule(rules, aif::PartialAction{{1, 2, 4}, {1, 0, 1}}, 10.0);
+    p.invalidate({4});
+    check();
+
+    rules[0].value = 20.0;
+    p.invalidate({1});
+    check();
+
+    addRule(rules, aif::PartialAction{{3}, {1}}, 7.0);
+    p.invalidate();
+    check();
+}
@@ -4,7 +4,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
 #include <AIToolbox/Factored/MDP/Algorithms/SparseCooperativeQLearning.hpp>
+#include <AIToolbox/Factored/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 namespace aif = AIToolbox::Factored;
 namespace fm = AIToolbox::Factored::MDP;
@@ -52,3 +55,109 @@ BOOST_AUTO_TEST_CASE( simple_rule_update ) {
     BOOST_CHECK_EQUAL(container[4].value, v5 + alpha * (R2 + gamma * (v3 / 2.0) - v5 / 2.0 + R3 + gamma * v6 - v5 / 2.0));
     BOOST_CHECK_EQUAL(container[5].value,  v6);
 }
+
+BOOST_AUTO_TEST_CASE( batch_update ) {
+    const aif::State S{2, 3};
+    const aif::Action A{2, 2, 3};
+
+    const auto makeSolver = [&] {
+        fm::SparseCooperativeQLearning solver(S, A, 0.9, 0.3);
+        size_t i = 0;
+        for (const auto & [stateTag, actionTag] : std::vector<std::pair<aif::PartialKeys, aif::PartialKeys>>{{{0}, {0, 1}}, {{1}, {1, 2}}, {{0, 1}, {2}}}) {
+            aif::PartialFactorsEnumerator se(S, stateTag);
+            for (; se.isValid(); se.advance()) {
+                aif::PartialFactorsEnumerator ae(A, actionTag);
+                for (; ae.isValid(); ae.advance())
+                    solver.insertRule({*se, *ae, static_cast<double>((i++ * 7) % 11) / 10.0});
+            }
+        }
+        return solver;
+    };
+
+    // A batch of a single transition is the same as stepUpdateQ.
+    {
+        auto step = makeSolver();
+        auto batched = makeSolver();
+
+        aif::Rewards rew(3); rew << 1.0, -2.0, 0.5;
+        step.stepUpdateQ({1, 2}, {0, 1, 2}, {0, 1}, rew);
+
+        fm::TransitionBatch batch{{1, 2}, {0, 1, 2}, {0, 1}, {1.0, -2.0, 0.5}};
+        batched.batchUpdateQ(batch);
+
+        const auto & c1 = step.getQFunctionRules().getContainer();
+        const auto & c2 = batched.getQFunctionRules().getContainer();
+        for (size_t i = 0; i < c1.size(); ++i)
+            BOOST_CHECK_EQUAL(c1[i].value, c2[i].value);
+    }
+
+    // Large batches give the same result with and without threads.
+    {
+        constexpr size_t N = 500;
+        fm::TransitionBatch batch;
+        for (size_t i = 0; i < S.size(); ++i)
+            for (size_t n = 0; n < N; ++n) {
+                batch.states.push_back((n * 7 + i) % S[i]);
+                batch.nextStates.push_back((n * 3 + i * 5) % S[i]);
+            }
+        for (size_t i = 0; i < A.size(); ++i)
+            for (size_t n = 0; n < N; ++n) {
+                batch.actions.push_back((n * 11 + i) % A[i]);
+                batch.rewards.push_back(static_cast<double>((n * 13 + i * 3) % 9) - 4.0);
+            }
+
+        auto serial = makeSolver();
+        auto parallel = makeSolver();
+        AIToolbox::ThreadPool pool(3);
+
+        for (size_t i = 0; i < 3; ++i) {
+            serial.batchUpdateQ(batch);
+            parallel.batchUpdateQ(batch, &pool);
+        }
+
+        const auto & c1 = serial.getQFunctionRules().getContainer();
+        const auto & c2 = parallel.getQFunctionRules().getContainer();
+        for (size_t i = 0; i < c1.size(); ++i)
+            BOOST_CHECK_EQUAL(c1[i].value, c2[i].value);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( cached_greedy_policy ) {
+    const aif::State S{2};
+    const aif::Action A{2, 2, 2};
+
+    fm::SparseCooperativeQLearning solver(S, A, 0.9, 0.3);
+    solver.insertRule({{{0}, {0}}, {{0},    {1}},  1.0});
+    solver.insertRule({{{0}, {1}}, {{0, 1}, {0, 1}}, 2.0});
+    solver.insertRule({{{0}, {1}}, {{0, 1}, {1, 0}}, 3.0});
+    solver.insertRule({{{0}, {0}}, {{1, 2}, {1, 1}}, 5.0});
+
+    fm::QGreedyPolicy policy(S, A, solver.getQFunctionRules());
+    fm::QGreedyPolicy uncached(S, A, solver.getQFunctionRules());
+    policy.setCacheSize(1, &solver.getVersion());
+
+    for (size_t s = 0; s < 2; ++s)
+        BOOST_CHECK_EQUAL(AIToolbox::veccmp(policy.sampleAction({s}), uncached.sampleAction({s})), 0);
+    BOOST_CHECK_EQUAL(policy.getCacheHits(), 0);
+
+    // Only the last state fits in the cache.
+    policy.sampleAction({1});
+    BOOST_CHECK_EQUAL(policy.getCacheHits(), 1);
+    policy.sampleAction({0});
+    BOOST_CHECK_EQUAL(policy.getCacheHits(), 1);
+
+    // Updating the rules changes the greedy action in state 1, and
+    // invalidates the cache.
+    aif::Rewards rew(3); rew << -10.0, -10.0, -10.0;
+    for (size_t i = 0; i < 10; ++i)
+        solver.stepUpdateQ({1}, {0, 1, 0}, {1}, rew);
+
+    policy.setCacheSize(4, &solver.getVersion());
+    policy.sampleAction({1});
+    policy.sampleAction({1});
+    BOOST_CHECK_EQUAL(policy.getCacheHits(), 1);
+
+    solver.stepUpdateQ({1}, uncached.sampleAction({1}), {1}, rew);
+    BOOST_CHECK_EQUAL(AIToolbox::veccmp(policy.sampleAction({1}), uncached.sampleAction({1})), 0);
+    BOOST_CHECK_EQUAL(policy.getCacheHits(), 1);
+}
@@ -72,3 +72,75 @@ BOOST_AUTO_TEST_CASE( testing ) {
                                   std::begin(bestAction.second), std::end(bestAction.second));
     BOOST_CHECK_EQUAL(v, bestValue);
 }
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    const fm::Action A{4,4,4,4,4};
+    constexpr double logtA = 9.5;
+
+    // The first elimination enumerates 256 joint actions, which is
+    // enough to split it between threads.
+    fb::UCVE::Entries ucveVectors;
+    for (const auto & keys : {fm::PartialKeys{0,1,2,3,4}, fm::PartialKeys{0,1}, fm::PartialKeys{2,4}}) {
+        fm::PartialFactorsEnumerator e(A, keys);
+        for (size_t i = 0; e.isValid(); ++i, e.advance())
+            ucveVectors.emplace_back(*e, fb::UCVE::V{((i * 37) % 101) / 100.0, ((i * 13) % 17 + 1) / 1000.0});
+    }
+
+    fb::UCVE serial(A, logtA);
+    const auto [sa, sv] = serial(ucveVectors);
+
+    AIToolbox::ThreadPool pool(3);
+    fb::UCVE parallel(A, logtA);
+    parallel.setThreadPool(&pool);
+    BOOST_CHECK(parallel.getThreadPool() == &pool);
+
+    // The same instance can be reused.
+    for (size_t i = 0; i < 2; ++i) {
+        const auto [pa, pv] = parallel(ucveVectors);
+
+        BOOST_CHECK_EQUAL(pv[0], sv[0]);
+        BOOST_CHECK_EQUAL(pv[1], sv[1]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(pa.first), std::end(pa.first), std::begin(sa.first), std::end(sa.first));
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(pa.second), std::end(pa.second), std::begin(sa.second), std::end(sa.second));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( pruning_bruteforce ) {
+    const fm::Action A{3,2,3,2,3,2};
+    constexpr double logtA = 10.0;
+
+    AIToolbox::ThreadPool pool(3);
+    AIToolbox::RandomEngine rand(0);
+    std::uniform_real_distribution<double> vDist(0.0, 1.0), bDist(0.0001, 0.05);
+
+    for (size_t round = 0; round < 10; ++round) {
+        // Overlapping groups, so that eliminated agents have several
+        // factors and neighbors.
+        fb::UCVE::Entries ucveVectors;
+        for (const auto & keys : {fm::PartialKeys{0,1,2}, fm::PartialKeys{1,3}, fm::PartialKeys{2,3,4}, fm::PartialKeys{0,5}, fm::PartialKeys{4,5}}) {
+            fm::PartialFactorsEnumerator e(A, keys);
+            for (; e.isValid(); e.advance())
+                ucveVectors.emplace_back(*e, fb::UCVE::V{vDist(rand), bDist(rand)});
+        }
+
+        double bestV = std::numeric_limits<double>::lowest();
+        fm::PartialFactorsEnumerator jointActions(A);
+        for (; jointActions.isValid(); jointActions.advance()) {
+            fb::UCVE::V helper; helper.setZero();
+            for (const auto & e : ucveVectors)
+                if (fm::match(std::get<0>(e), *jointActions))
+                    helper += std::get<1>(e);
+            bestV = std::max(bestV, helper[0] + std::sqrt(0.5 * helper[1] * logtA));
+        }
+
+        fb::UCVE serial(A, logtA);
+        fb::UCVE parallel(A, logtA);
+        parallel.setThreadPool(&pool);
+
+        for (auto * ucve : {&serial, &parallel}) {
+            const auto [a, v] = (*ucve)(ucveVectors);
+            BOOST_CHECK_CLOSE(v[0] + std::sqrt(0.5 * v[1] * logtA), bestV, 0.000001);
+            BOOST_CHECK_EQUAL(a.first.size(), A.size());
+        }
+    }
+}
@@ -319,6 +319,78 @@ afm::CooperativeModel makeSysAdminUniRing(unsigned agents,
     return afm::CooperativeModel(std::move(S), std::move(A), std::move(ddn), std::move(rewards), 0.95);
 }
 
+// In the star topology agent 0 is the server, and is the only neighbor of
+// all other agents. The status of the server depends on all other agents, so
+// its transition matrix grows exponentially with the number of agents.
+afm::CooperativeModel makeSysAdminStar(unsigned agents,
+    // Status transition params.
+    double pFailBase, double pFailBonus, double pDeadBase, double pDeadBonus,
+    // Load transition params.
+    double pLoad, double pDoneG, double pDoneF)
+{
+    aif::State S(agents * 2);
+    std::fill(std::begin(S), std::end(S), 3);
+
+    aif::Action A(agents);
+    std::fill(std::begin(A), std::end(A), 2);
+
+    const auto sa1Matrix = makeA1MatrixStatus();
+    const auto la0Matrix = makeA0MatrixLoad(pLoad, pDoneG, pDoneF);
+    const auto la1Matrix = makeA1MatrixStatus();
+
+    auto ddn = aif::FactoredDDN();
+    for (size_t a = 0; a < agents; ++a) {
+        aif::FactoredDDN::Node nodeStatus{{a}, {}};
+
+        aif::DBN::Node sa0{{}, {}};
+        if (a == 0) {
+            for (size_t n = 0; n < agents; ++n)
+                sa0.tag.push_back(n * 2);
+            sa0.matrix = makeA0MatrixStatus(agents - 1, 0, pFailBase, pFailBonus, pDeadBase, pDeadBonus);
+        } else {
+            sa0.tag = {0, a * 2};
+            sa0.matrix = makeA0MatrixStatus(1, 1, pFailBase, pFailBonus, pDeadBase, pDeadBonus);
+        }
+
+        aif::DBN::Node sa1{{a * 2}, sa1Matrix};
+
+        nodeStatus.nodes.emplace_back(std::move(sa0));
+        nodeStatus.nodes.emplace_back(std::move(sa1));
+
+        aif::FactoredDDN::Node nodeLoad{{a}, {}};
+
+        aif::DBN::Node la0{{a * 2, (a * 2) + 1}, la0Matrix};
+        aif::DBN::Node la1{{(a * 2) + 1}, la1Matrix};
+
+        nodeLoad.nodes.emplace_back(std::move(la0));
+        nodeLoad.nodes.emplace_back(std::move(la1));
+
+        ddn.nodes.emplace_back(std::move(nodeStatus));
+        ddn.nodes.emplace_back(std::move(nodeLoad));
+    }
+
+    // Rewards are the same as in the rings.
+    ai::Matrix2D rewardMatrix(3 * 3, 2);
+    constexpr double finishReward = 1.0;
+    rewardMatrix.setZero();
+
+    rewardMatrix(Load * 3 + Good, 0) = la0Matrix(Load * 3 + Good, Done) * finishReward;
+    rewardMatrix(Load * 3 + Fail, 0) = la0Matrix(Load * 3 + Fail, Done) * finishReward;
+    rewardMatrix(Load * 3 + Dead, 0) = la0Matrix(Load * 3 + Dead, Done) * finishReward;
+
+    aif::FactoredMatrix2D rewards;
+    for (size_t a = 0; a < agents; ++a) {
+        aif::BasisMatrix basis;
+        basis.tag = {a * 2, a * 2 + 1};
+        basis.actionTag = {a};
+        basis.values = rewardMatrix;
+
+        rewards.bases.emplace_back(std::move(basis));
+    }
+
+    return afm::CooperativeModel(std::move(S), std::move(A), std::move(ddn), std::move(rewards), 0.95);
+}
+
 unsigned ceil(unsigned x, unsigned y) {
     return (x + y - 1) / y;
 }
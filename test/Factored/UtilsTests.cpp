@@ -113,7 +113,7 @@ BOOST_AUTO_TEST_CASE( to_index_full_partial_factors ) {
 BOOST_AUTO_TEST_CASE( to_index_partial_ids_factors ) {
     aif::Factors state = {3,2,5,4};
     std::vector<size_t> unusedids = {0, 2};
-    std::vector<size_t> ids = {1, 3};
+    aif::PartialKeys ids = {1, 3};
 
     std::vector<size_t> solution;
     solution.resize(2*4);
@@ -337,3 +337,106 @@ BOOST_AUTO_TEST_CASE( partial_factor_enumerator_api_compatibility ) {
         BOOST_CHECK_EQUAL(cCmp, counter);
     }
 }
+
+BOOST_AUTO_TEST_CASE( factor_space ) {
+    const aif::Factors space{2, 3, 4, 2, 5};
+
+    // Full space.
+    const aif::FactorSpace full(space);
+    BOOST_CHECK_EQUAL(full.size(), aif::factorSpace(space));
+
+    aif::PartialFactorsEnumerator all(space);
+    aif::Factors values(space.size());
+    for (size_t counter = 0; all.isValid(); all.advance(), ++counter) {
+        BOOST_CHECK_EQUAL(full.toIndex(all->second), aif::toIndex(space, all->second));
+
+        full.toFactors(counter, &values);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(values), std::end(values),
+                                      std::begin(all->second), std::end(all->second));
+    }
+
+    // Keys aligned with a superset.
+    const aif::PartialKeys keys{1, 4}, inputKeys{0, 1, 3, 4};
+    const aif::FactorSpace partial(space, keys, inputKeys);
+    BOOST_CHECK_EQUAL(partial.size(), aif::factorSpacePartial(keys, space));
+
+    const std::vector<size_t> strides{0, 1, 0, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(partial.getStrides()), std::end(partial.getStrides()),
+                                  std::begin(strides), std::end(strides));
+
+    aif::PartialFactorsEnumerator e(space, inputKeys);
+    for (; e.isValid(); e.advance()) {
+        const auto id = partial.toIndex(e->second);
+        BOOST_CHECK_EQUAL(id, aif::toIndexPartial(keys, space, *e));
+
+        // Values for keys not in the index are left alone.
+        aif::PartialValues v(inputKeys.size(), 7);
+        partial.toFactors(id, &v);
+        BOOST_CHECK_EQUAL(v[0], 7);
+        BOOST_CHECK_EQUAL(v[1], e->second[1]);
+        BOOST_CHECK_EQUAL(v[2], 7);
+        BOOST_CHECK_EQUAL(v[3], e->second[3]);
+    }
+
+    // Keys aligned with themselves.
+    const aif::FactorSpace self(space, keys);
+    aif::PartialFactorsEnumerator se(space, keys);
+    for (size_t counter = 0; se.isValid(); se.advance(), ++counter)
+        BOOST_CHECK_EQUAL(self.toIndex(se->second), counter);
+}
+
+BOOST_AUTO_TEST_CASE( partial_factor_enumerator_targets_and_ranges ) {
+    const aif::Factors space{2, 3, 4, 2, 5};
+    const aif::PartialKeys keys{0, 1, 3, 4};
+    const aif::PartialKeys t1{1, 4}, t2{0, 3}, t3{3};
+
+    aif::PartialFactorsEnumerator e(space, keys);
+    const auto id1 = e.addTarget(t1);
+    const auto id2 = e.addTarget(t2);
+    const auto id3 = e.addTarget(t3);
+    const auto size = e.size();
+
+    for (size_t counter = 0; e.isValid(); e.advance(), ++counter) {
+        BOOST_CHECK_EQUAL(e.getStep(), counter);
+        BOOST_CHECK_EQUAL(e.getIndex(id1), aif::toIndexPartial(t1, space, *e));
+        BOOST_CHECK_EQUAL(e.getIndex(id2), aif::toIndexPartial(t2, space, *e));
+        BOOST_CHECK_EQUAL(e.getIndex(id3), aif::toIndexPartial(t3, space, *e));
+    }
+
+    // Splitting the enumeration in chunks gives the same steps.
+    aif::PartialFactorsEnumerator all(space, keys);
+    const size_t chunk = 7;
+    for (size_t begin = 0; begin < size; begin += chunk) {
+        aif::PartialFactorsEnumerator c(space, keys);
+        const auto cid = c.addTarget(t1);
+        c.setRange(begin, begin + chunk);
+        for (; c.isValid(); c.advance(), all.advance()) {
+            BOOST_CHECK(all.isValid());
+            BOOST_CHECK(c->second == all->second);
+            BOOST_CHECK_EQUAL(c.getIndex(cid), aif::toIndexPartial(t1, space, *c));
+        }
+        BOOST_CHECK_EQUAL(c.getStep(), std::min(begin + chunk, size));
+
+        // Reset goes back to the beginning of the range.
+        c.reset();
+        BOOST_CHECK(c.isValid());
+        BOOST_CHECK_EQUAL(c.getStep(), begin);
+    }
+    BOOST_CHECK(!all.isValid());
+
+    aif::PartialFactorsEnumerator empty(space, keys);
+    empty.setRange(size, size + 10);
+    BOOST_CHECK(!empty.isValid());
+
+    // The factorToSkip is included in the indeces even when edited.
+    aif::PartialFactorsEnumerator s(space, keys, 1);
+    const auto sid = s.addTarget(t1);
+    size_t count = 0;
+    for (; s.isValid(); s.advance(), ++count) {
+        for (size_t v = 0; v < space[1]; ++v) {
+            s->second[s.getFactorToSkipId()] = v;
+            BOOST_CHECK_EQUAL(s.getIndex(sid), aif::toIndexPartial(t1, space, *s));
+        }
+    }
+    BOOST_CHECK_EQUAL(count, s.size());
+}
@@ -4,7 +4,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/Factored/Bandit/Algorithms/Utils/VariableElimination.hpp>
+#include <AIToolbox/Factored/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
+namespace ai = AIToolbox;
 namespace aif = AIToolbox::Factored;
 namespace fb = AIToolbox::Factored::Bandit;
 using VE = fb::VariableElimination;
@@ -116,3 +119,147 @@ BOOST_AUTO_TEST_CASE( negative_graph_2 ) {
     BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(std::get<0>(bestAction_v)), std::end(std::get<0>(bestAction_v)),
                                   std::begin(std::get<0>(solution)),     std::end(std::get<0>(solution)));
 }
+
+BOOST_AUTO_TEST_CASE( elimination_heuristics ) {
+    const std::vector<fb::QFunctionRule> rules {
+        // Actions,                     Value
+        {  {{0, 2}, {1, 0}},            4.0},
+        {  {{0, 1}, {1, 0}},            5.0},
+        {  {{1},    {0}},               2.0},
+        {  {{1, 2}, {1, 1}},            5.0},
+        {  {{2, 3}, {0, 1}},            1.0},
+        {  {{3, 4}, {1, 1}},            3.0},
+    };
+
+    const auto solution = std::make_pair(aif::Action{1, 0, 0, 1, 1}, 15.0);
+
+    const aif::Action a{2, 2, 2, 2, 2};
+
+    for (const auto h : {aif::EliminationOrder::Heuristic::Reverse, aif::EliminationOrder::Heuristic::MinDegree,
+                         aif::EliminationOrder::Heuristic::MinFill, aif::EliminationOrder::Heuristic::WeightedMinFill}) {
+        VE v(a);
+        v.setEliminationHeuristic(h);
+        BOOST_CHECK(v.getEliminationHeuristic() == h);
+
+        // The same instance can be reused.
+        for (size_t i = 0; i < 2; ++i) {
+            const auto bestAction_v = v(rules);
+
+            BOOST_CHECK_EQUAL(std::get<1>(bestAction_v), std::get<1>(solution));
+            BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(std::get<0>(bestAction_v)), std::end(std::get<0>(bestAction_v)),
+                                          std::begin(std::get<0>(solution)),     std::end(std::get<0>(solution)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( dense_factors ) {
+    const aif::Action a{3, 2, 4, 2, 3};
+
+    // Full tables over overlapping agents, with a few sparse rules on top.
+    std::vector<fb::QFunctionRule> rules;
+    for (const auto & keys : {aif::PartialKeys{0, 1}, aif::PartialKeys{1, 2, 3}, aif::PartialKeys{2, 4}, aif::PartialKeys{0, 4}}) {
+        aif::PartialFactorsEnumerator e(a, keys);
+        for (size_t i = 0; e.isValid(); ++i, e.advance())
+            rules.emplace_back(*e, static_cast<double>((i * 7 + keys.size() * 3) % 11) - 4.0);
+    }
+    rules.emplace_back(aif::PartialAction{{3}, {1}}, 2.5);
+    rules.emplace_back(aif::PartialAction{{0, 2}, {2, 3}}, 6.0);
+
+    const auto evaluate = [&](const aif::Action & action) {
+        double result = 0.0;
+        for (const auto & rule : rules)
+            if (aif::match(action, rule.action)) result += rule.value;
+        return result;
+    };
+
+    double bestValue = std::numeric_limits<double>::lowest();
+    aif::PartialFactorsEnumerator all(a);
+    for (; all.isValid(); all.advance())
+        bestValue = std::max(bestValue, evaluate(all->second));
+
+    for (const auto ratio : {0.0, 0.5, 2.0}) {
+        VE v(a);
+        v.setDenseFillRatio(ratio);
+        BOOST_CHECK_EQUAL(v.getDenseFillRatio(), ratio);
+
+        const auto bestAction_v = v(rules);
+
+        BOOST_CHECK_CLOSE(std::get<1>(bestAction_v), bestValue, 0.000001);
+        BOOST_CHECK_CLOSE(evaluate(std::get<0>(bestAction_v)), bestValue, 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    AIToolbox::ThreadPool pool(3);
+
+    const auto check = [&pool](const aif::Action & a, const std::vector<fb::QFunctionRule> & rules) {
+        const auto evaluate = [&](const aif::Action & action) {
+            double result = 0.0;
+            for (const auto & rule : rules)
+                if (aif::match(action, rule.action)) result += rule.value;
+            return result;
+        };
+
+        double bestValue = std::numeric_limits<double>::lowest();
+        aif::PartialFactorsEnumerator all(a);
+        for (; all.isValid(); all.advance())
+            bestValue = std::max(bestValue, evaluate(all->second));
+
+        VE v(a);
+        v.setThreadPool(&pool);
+        BOOST_CHECK(v.getThreadPool() == &pool);
+
+        // The same instance can be reused.
+        for (size_t i = 0; i < 2; ++i) {
+            const auto bestAction_v = v(rules);
+
+            BOOST_CHECK_CLOSE(std::get<1>(bestAction_v), bestValue, 0.000001);
+            BOOST_CHECK_CLOSE(evaluate(std::get<0>(bestAction_v)), bestValue, 0.000001);
+        }
+    };
+
+    const auto fill = [](const aif::Action & a, const std::vector<aif::PartialKeys> & factors) {
+        std::vector<fb::QFunctionRule> rules;
+        for (const auto & keys : factors) {
+            aif::PartialFactorsEnumerator e(a, keys);
+            for (size_t i = 0; e.isValid(); ++i, e.advance())
+                rules.emplace_back(*e, static_cast<double>((i * 37 + keys[0] * 5) % 23));
+        }
+        return rules;
+    };
+
+    // Three separate components, plus an agent without rules.
+    const aif::Action a1{2, 3, 2, 2, 3, 2, 2};
+    check(a1, fill(a1, {{0, 1}, {1, 3}, {2, 4}, {4, 6}, {5}}));
+
+    // A single component, where the first elimination is split between
+    // the threads.
+    const aif::Action a2{4, 4, 4, 4, 4, 4, 4};
+    check(a2, fill(a2, {{0, 1, 2, 3, 4, 5, 6}, {0, 6}, {3, 5}}));
+}
+
+BOOST_AUTO_TEST_CASE( dense_input ) {
+    const aif::Action a{3, 2, 4, 2, 3};
+
+    // Two of the tables share the same agents, so they must be summed.
+    aif::FactoredVector q;
+    std::vector<fb::QFunctionRule> rules;
+    for (const auto & keys : {aif::PartialKeys{0, 1}, aif::PartialKeys{1, 2, 3}, aif::PartialKeys{2, 4}, aif::PartialKeys{0, 1}}) {
+        aif::BasisFunction basis{keys, ai::Vector(aif::factorSpacePartial(keys, a))};
+        aif::PartialFactorsEnumerator e(a, keys);
+        for (size_t i = 0; e.isValid(); ++i, e.advance()) {
+            basis.values[i] = static_cast<double>((i * 13 + q.bases.size() * 5) % 17) - 6.0;
+            rules.emplace_back(*e, basis.values[i]);
+        }
+        q.bases.push_back(std::move(basis));
+    }
+
+    VE v(a);
+    const auto bestAction_r = v(rules);
+    for (size_t i = 0; i < 2; ++i) {
+        const auto bestAction_d = v(q);
+
+        BOOST_CHECK_CLOSE(std::get<1>(bestAction_d), std::get<1>(bestAction_r), 0.000001);
+        BOOST_CHECK_CLOSE(q.getValue(a, std::get<0>(bestAction_d)), std::get<1>(bestAction_r), 0.000001);
+    }
+}
@@ -0,0 +1,426 @@
+#define BOOST_TEST_MODULE MDP_BinaryIO
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/BinaryIO.hpp>
+#include <AIToolbox/MDP/IO.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/RLModel.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Utils/CornerProblem.hpp"
+
+template <typename T>
+void writeFile(const std::string & filename, const T & t) {
+    std::ofstream file(filename, std::ios::binary);
+    if ( !file ) BOOST_FAIL("Could not open file for writing: " + filename);
+    BOOST_CHECK( AIToolbox::MDP::writeBinary(file, t) );
+}
+
+template <typename M1, typename M2>
+void checkSameModel(const M1 & lhs, const M2 & rhs) {
+    BOOST_CHECK_EQUAL(lhs.getS(), rhs.getS());
+    BOOST_CHECK_EQUAL(lhs.getA(), rhs.getA());
+    BOOST_CHECK_EQUAL(lhs.getDiscount(), rhs.getDiscount());
+
+    for ( size_t s = 0; s < lhs.getS(); ++s ) {
+        BOOST_CHECK_EQUAL(lhs.isTerminal(s), rhs.isTerminal(s));
+        for ( size_t a = 0; a < lhs.getA(); ++a )
+            for ( size_t s1 = 0; s1 < lhs.getS(); ++s1 ) {
+                BOOST_CHECK_EQUAL(lhs.getTransitionProbability(s, a, s1), rhs.getTransitionProbability(s, a, s1));
+                BOOST_CHECK_EQUAL(lhs.getExpectedReward(s, a, s1), rhs.getExpectedReward(s, a, s1));
+            }
+    }
+}
+
+template <typename E1, typename E2>
+void checkSameExperience(const E1 & lhs, const E2 & rhs) {
+    BOOST_CHECK_EQUAL(lhs.getS(), rhs.getS());
+    BOOST_CHECK_EQUAL(lhs.getA(), rhs.getA());
+
+    for ( size_t s = 0; s < lhs.getS(); ++s )
+        for ( size_t a = 0; a < lhs.getA(); ++a ) {
+            BOOST_CHECK_EQUAL(lhs.getVisitsSum(s, a), rhs.getVisitsSum(s, a));
+            BOOST_CHECK_EQUAL(lhs.getRewardSum(s, a), rhs.getRewardSum(s, a));
+            for ( size_t s1 = 0; s1 < lhs.getS(); ++s1 ) {
+                BOOST_CHECK_EQUAL(lhs.getVisits(s, a, s1), rhs.getVisits(s, a, s1));
+                BOOST_CHECK_EQUAL(lhs.getReward(s, a, s1), rhs.getReward(s, a, s1));
+            }
+        }
+}
+
+BOOST_AUTO_TEST_CASE( models ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const SparseModel sparseModel(model);
+
+    const std::string filename = "./binaryModel.bin";
+    const std::string sparseFilename = "./binarySparseModel.bin";
+    writeFile(filename, model);
+    writeFile(sparseFilename, sparseModel);
+
+    {
+        Model loaded(1, 1);
+        std::ifstream file(filename, std::ios::binary);
+        BOOST_CHECK( readBinary(file, loaded) );
+        checkSameModel(model, loaded);
+
+        SparseModel sparseLoaded(1, 1);
+        std::ifstream sparseFile(sparseFilename, std::ios::binary);
+        BOOST_CHECK( readBinary(sparseFile, sparseLoaded) );
+        checkSameModel(sparseModel, sparseLoaded);
+    }
+    {
+        const MappedModel mapped(filename);
+        const MappedSparseModel sparseMapped(sparseFilename);
+
+        BOOST_CHECK(is_model_eigen_v<MappedModel>);
+        BOOST_CHECK(is_model_eigen_v<MappedSparseModel>);
+
+        checkSameModel(model, mapped);
+        checkSameModel(sparseModel, sparseMapped);
+
+        // The mapped models work directly with the Eigen planners.
+        ValueIteration solver(1000000, 0.001);
+        const auto [bound, vfun, qfun] = solver(model);
+        const auto [mBound, mVFun, mQFun] = solver(mapped);
+        const auto [sBound, sVFun, sQFun] = solver(sparseMapped);
+
+        BOOST_CHECK( vfun.values == mVFun.values );
+        BOOST_CHECK( qfun == mQFun );
+        BOOST_CHECK( vfun.values.isApprox(sVFun.values) );
+
+        for ( size_t s = 0; s < model.getS(); ++s )
+            for ( size_t a = 0; a < model.getA(); ++a ) {
+                const auto s1 = std::get<0>(sparseMapped.sampleSR(s, a));
+                BOOST_CHECK( model.getTransitionProbability(s, a, s1) > 0.0 );
+            }
+    }
+    std::remove(filename.c_str());
+    std::remove(sparseFilename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( streamed_model ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const SparseModel model(makeCornerProblem(grid));
+
+    const std::string filename = "./binaryStreamedModel.bin";
+    writeFile(filename, model);
+    {
+        MappedSparseModel mapped(filename);
+        BOOST_CHECK(is_model_streamed_v<MappedSparseModel>);
+        BOOST_CHECK(!is_model_streamed_v<SparseModel>);
+        BOOST_CHECK_EQUAL(mapped.getStreamingBlock(), 0);
+
+        ValueIteration solver(1000000, 0.001);
+        const auto [bound, vfun, qfun] = solver(mapped);
+
+        AIToolbox::ThreadPool pool(2);
+        for ( const size_t block : {1, 3, 5, 16, 100} ) {
+            mapped.setStreamingBlock(block);
+            BOOST_CHECK_EQUAL(mapped.getStreamingBlock(), block);
+
+            for ( const auto p : {static_cast<AIToolbox::ThreadPool *>(nullptr), &pool} ) {
+                solver.setThreadPool(p);
+                const auto [sBound, sVFun, sQFun] = solver(mapped);
+
+                // Streaming computes each row as before.
+                BOOST_CHECK_EQUAL(sBound, bound);
+                BOOST_CHECK( sVFun.values == vfun.values );
+                BOOST_CHECK( sQFun == qfun );
+            }
+        }
+
+        // Evicted rows are read again from the file when accessed.
+        for ( size_t a = 0; a < mapped.getA(); ++a )
+            mapped.evictRows(a, 0, mapped.getS());
+        checkSameModel(model, mapped);
+    }
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( experiences ) {
+    using namespace AIToolbox::MDP;
+    const size_t S = 96, A = 2;
+
+    Experience exp(S, A);
+    {
+        std::ifstream inputFile("./data/experience.txt");
+        if ( !inputFile ) BOOST_FAIL("Data to perform test could not be loaded: ./data/experience.txt");
+        BOOST_CHECK( inputFile >> exp );
+    }
+    SparseExperience sparseExp(S, A);
+    {
+        std::ifstream inputFile("./data/experience.txt");
+        BOOST_CHECK( inputFile >> sparseExp );
+    }
+
+    const std::string filename = "./binaryExperience.bin";
+    const std::string sparseFilename = "./binarySparseExperience.bin";
+    writeFile(filename, exp);
+    writeFile(sparseFilename, sparseExp);
+
+    {
+        Experience loaded(1, 1);
+        std::ifstream file(filename, std::ios::binary);
+        BOOST_CHECK( readBinary(file, loaded) );
+        checkSameExperience(exp, loaded);
+
+        SparseExperience sparseLoaded(1, 1);
+        std::ifstream sparseFile(sparseFilename, std::ios::binary);
+        BOOST_CHECK( readBinary(sparseFile, sparseLoaded) );
+        checkSameExperience(sparseExp, sparseLoaded);
+    }
+    {
+        const MappedExperience mapped(filename);
+        BOOST_CHECK(is_experience_v<MappedExperience>);
+        checkSameExperience(exp, mapped);
+
+        RLModel model(exp, 0.9, true);
+        RLModel mappedModel(mapped, 0.9, true);
+        checkSameModel(model, mappedModel);
+    }
+    std::remove(filename.c_str());
+    std::remove(sparseFilename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( transitionTables ) {
+    using namespace AIToolbox::MDP;
+
+    TransitionBatch batch;
+    for ( size_t i = 0; i < 100; ++i ) {
+        batch.states.push_back(i % 7);
+        batch.actions.push_back(i % 3);
+        batch.nextStates.push_back((i * 5) % 7);
+        batch.rewards.push_back(i * 0.25 - 3.0);
+    }
+
+    std::stringstream stream;
+    BOOST_CHECK( writeBinary(stream, batch) );
+
+    // Columns are stored separately, each at a 64 byte boundary.
+    const std::string data = stream.str();
+    const size_t column = 832; // 100 * 8 bytes, padded.
+    BOOST_CHECK_EQUAL(data.size(), 128 + 4 * column);
+    double reward;
+    std::memcpy(&reward, data.data() + 128 + 3 * column + 8 * 10, sizeof(double));
+    BOOST_CHECK_EQUAL(reward, batch.rewards[10]);
+
+    TransitionBatch loaded;
+    BOOST_CHECK( readBinary(stream, loaded) );
+    BOOST_CHECK(loaded.states == batch.states);
+    BOOST_CHECK(loaded.actions == batch.actions);
+    BOOST_CHECK(loaded.nextStates == batch.nextStates);
+    BOOST_CHECK(loaded.rewards == batch.rewards);
+    BOOST_CHECK(loaded.nextActions.empty());
+
+    batch.nextActions = batch.actions;
+    std::stringstream withNext;
+    BOOST_CHECK( writeBinary(withNext, batch) );
+    BOOST_CHECK( readBinary(withNext, loaded) );
+    BOOST_CHECK(loaded.nextActions == batch.nextActions);
+
+    batch.rewards.pop_back();
+    std::stringstream invalid;
+    BOOST_CHECK_THROW(writeBinary(invalid, batch), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( experienceTables ) {
+    using namespace AIToolbox::MDP;
+    const size_t S = 96, A = 2;
+
+    Experience exp(S, A);
+    {
+        std::ifstream inputFile("./data/experience.txt");
+        if ( !inputFile ) BOOST_FAIL("Data to perform test could not be loaded: ./data/experience.txt");
+        BOOST_CHECK( inputFile >> exp );
+    }
+    SparseExperience sparseExp(S, A);
+    {
+        std::ifstream inputFile("./data/experience.txt");
+        BOOST_CHECK( inputFile >> sparseExp );
+    }
+
+    std::stringstream dense, sparse;
+    BOOST_CHECK( writeExperienceTable(dense, exp) );
+    BOOST_CHECK( writeExperienceTable(sparse, sparseExp) );
+    // Both experiences produce the same table.
+    BOOST_CHECK(dense.str() == sparse.str());
+
+    Experience loaded(S, A);
+    BOOST_CHECK( readExperienceTable(dense, loaded) );
+    checkSameExperience(exp, loaded);
+    BOOST_CHECK(!loaded.getDirtyPairs().empty());
+
+    SparseExperience sparseLoaded(S, A);
+    BOOST_CHECK( readExperienceTable(sparse, sparseLoaded) );
+    checkSameExperience(exp, sparseLoaded);
+
+    // Tables are added to the existing data.
+    std::stringstream again(dense.str());
+    BOOST_CHECK( readExperienceTable(again, loaded) );
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+            BOOST_CHECK_EQUAL(loaded.getVisitsSum(s, a), 2 * exp.getVisitsSum(s, a));
+
+    // A table for a different space is rejected, and nothing is added.
+    Experience other(S + 1, A);
+    std::stringstream wrongSize(dense.str());
+    BOOST_CHECK( !readExperienceTable(wrongSize, other) );
+    BOOST_CHECK_EQUAL(other.getDirtyPairs().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( checkpoints ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    ValueIteration solver(1000000, 0.00001);
+    solver.setSweep(ValueIteration::Sweep::Prioritized);
+    const auto [bound, vfun, qfun] = solver(model);
+
+    ValueIterationCheckpoint checkpoint;
+    solver.setCheckpointCallback([&](const ValueIterationCheckpoint & c) {
+        if ( c.timestep == 2 ) checkpoint = c;
+    });
+    solver(model);
+
+    std::stringstream stream;
+    writeBinary(stream, checkpoint);
+
+    ValueIterationCheckpoint in;
+    BOOST_REQUIRE(readBinary(stream, in));
+
+    BOOST_CHECK_EQUAL(in.timestep, checkpoint.timestep);
+    BOOST_CHECK_EQUAL(in.variation, checkpoint.variation);
+    BOOST_CHECK(in.v.values == checkpoint.v.values);
+    BOOST_CHECK(in.v.actions == checkpoint.v.actions);
+    BOOST_CHECK(in.residuals == checkpoint.residuals);
+
+    const auto [rbound, rvfun, rqfun] = solver(model, in);
+    BOOST_CHECK_EQUAL(rbound, bound);
+    BOOST_CHECK(rvfun.values == vfun.values);
+
+    // A checkpoint is not a model.
+    std::stringstream again;
+    writeBinary(again, checkpoint);
+    Model m(1, 1);
+    BOOST_CHECK(!readBinary(again, m));
+}
+
+BOOST_AUTO_TEST_CASE( invalidInput ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    std::stringstream buffer;
+    writeBinary(buffer, model);
+    const auto data = buffer.str();
+
+    // Reading the wrong type fails and leaves the input untouched.
+    {
+        std::istringstream input(data);
+        SparseModel wrong(2, 3);
+        BOOST_CHECK( !readBinary(input, wrong) );
+        BOOST_CHECK_EQUAL(wrong.getS(), 2);
+        BOOST_CHECK_EQUAL(wrong.getA(), 3);
+    }
+    // Truncated data fails.
+    {
+        std::istringstream input(data.substr(0, data.size() / 2));
+        Model truncated(2, 3);
+        BOOST_CHECK( !readBinary(input, truncated) );
+        BOOST_CHECK_EQUAL(truncated.getS(), 2);
+    }
+    // Text data fails.
+    {
+        std::stringstream text;
+        text << model;
+        Model fromText(2, 3);
+        BOOST_CHECK( !readBinary(text, fromText) );
+    }
+
+    const std::string filename = "./binaryInvalid.bin";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(data.data(), data.size() / 2);
+    }
+    BOOST_CHECK_THROW(MappedModel{filename}, std::runtime_error);
+    BOOST_CHECK_THROW(MappedSparseModel{filename}, std::runtime_error);
+    BOOST_CHECK_THROW(MappedModel{"./doesNotExist.bin"}, std::runtime_error);
+
+    // Transitions which are not probabilities fail.
+    {
+        auto bad = data;
+        const double p = 2.0;
+        // The first transition is right after the 64-byte header.
+        std::memcpy(&bad[64], &p, sizeof(double));
+        std::istringstream input(bad);
+        Model invalid(2, 3);
+        BOOST_CHECK( !readBinary(input, invalid) );
+        BOOST_CHECK_EQUAL(invalid.getS(), 2);
+    }
+    // Sparse matrices with out of range indices fail.
+    {
+        std::stringstream sparseBuffer;
+        writeBinary(sparseBuffer, SparseModel(model));
+        auto bad = sparseBuffer.str();
+
+        // The inner indices of the first matrix follow the header, the
+        // sparse header and the padded S + 1 outer indices.
+        const int col = model.getS();
+        std::memcpy(&bad[64 + 64 + 128], &col, sizeof(int));
+
+        std::istringstream input(bad);
+        SparseModel invalid(2, 3);
+        BOOST_CHECK( !readBinary(input, invalid) );
+        BOOST_CHECK_EQUAL(invalid.getS(), 2);
+
+        {
+            std::ofstream file(filename, std::ios::binary);
+            file.write(bad.data(), bad.size());
+        }
+        BOOST_CHECK_THROW(MappedSparseModel{filename}, std::runtime_error);
+    }
+    // Sparse matrices claiming more non zeros than fit in the matrix, or
+    // so many that their size in bytes overflows, fail without allocating.
+    {
+        std::stringstream sparseBuffer;
+        writeBinary(sparseBuffer, SparseModel(model));
+        auto bad = sparseBuffer.str();
+
+        // The non zeros are the third field of the first sparse header.
+        for ( const std::uint64_t nonZeros : {std::uint64_t(model.getS() * model.getS() + 1), std::uint64_t(1) << 62} ) {
+            std::memcpy(&bad[64 + 16], &nonZeros, sizeof(std::uint64_t));
+
+            std::istringstream input(bad);
+            SparseModel invalid(2, 3);
+            BOOST_CHECK( !readBinary(input, invalid) );
+            BOOST_CHECK_EQUAL(invalid.getS(), 2);
+
+            {
+                std::ofstream file(filename, std::ios::binary);
+                file.write(bad.data(), bad.size());
+            }
+            BOOST_CHECK_THROW(MappedSparseModel{filename}, std::runtime_error);
+        }
+    }
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,115 @@
+#define BOOST_TEST_MODULE MDP_CompactExperience
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/CompactExperience.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/RLModel.hpp>
+
+#include <random>
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    const size_t S = 5, A = 6;
+
+    AIToolbox::MDP::CompactExperience<> exp(S, A);
+
+    BOOST_CHECK(AIToolbox::MDP::is_experience_v<decltype(exp)>);
+    BOOST_CHECK(!exp.getTrackVariance());
+
+    BOOST_CHECK_EQUAL(exp.getS(), S);
+    BOOST_CHECK_EQUAL(exp.getA(), A);
+
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a ) {
+            BOOST_CHECK_EQUAL(exp.getVisitsSum(s, a), 0ul);
+            BOOST_CHECK_EQUAL(exp.getRewardSum(s, a), 0.0);
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(exp.getVisits(s, a, s1), 0ul);
+                BOOST_CHECK_EQUAL(exp.getReward(s, a, s1), 0.0);
+            }
+        }
+}
+
+BOOST_AUTO_TEST_CASE( matchesExperience ) {
+    const size_t S = 8, A = 3;
+
+    AIToolbox::MDP::Experience exp(S, A);
+    AIToolbox::MDP::CompactExperience<std::uint16_t> cexp(S, A);
+
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<size_t> sDist(0, S - 1), aDist(0, A - 1);
+    std::uniform_real_distribution<double> rDist(-5.0, 5.0);
+
+    for ( size_t i = 0; i < 5000; ++i ) {
+        const auto s = sDist(rand), a = aDist(rand), s1 = sDist(rand);
+        const auto r = rDist(rand);
+        exp.record(s, a, s1, r);
+        cexp.record(s, a, s1, r);
+    }
+
+    BOOST_CHECK( exp.getDirtyPairs() == cexp.getDirtyPairs() );
+
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a ) {
+            BOOST_CHECK_EQUAL(exp.getVisitsSum(s, a), cexp.getVisitsSum(s, a));
+            BOOST_CHECK_EQUAL(exp.getRewardSum(s, a), cexp.getRewardSum(s, a));
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(exp.getVisits(s, a, s1), cexp.getVisits(s, a, s1));
+                BOOST_CHECK_EQUAL(exp.getReward(s, a, s1), cexp.getReward(s, a, s1));
+            }
+        }
+
+    // The experience plugs directly into RLModel.
+    AIToolbox::MDP::RLModel model(exp, 0.9, true);
+    AIToolbox::MDP::RLModel cmodel(cexp, 0.9, true);
+
+    for ( size_t a = 0; a < A; ++a )
+        BOOST_CHECK( model.getTransitionFunction(a) == cmodel.getTransitionFunction(a) );
+    BOOST_CHECK( model.getRewardFunction() == cmodel.getRewardFunction() );
+
+    cexp.reset();
+    BOOST_CHECK(cexp.getDirtyPairs().empty());
+    BOOST_CHECK_EQUAL(cexp.getVisitsSum(0, 0), 0ul);
+    BOOST_CHECK_EQUAL(cexp.getVisits(0, 0, 0), 0ul);
+    BOOST_CHECK_EQUAL(cexp.getRewardSum(0, 0), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( variance ) {
+    AIToolbox::MDP::CompactExperience<> exp(2, 2, true);
+    AIToolbox::MDP::CompactExperience<> noVarExp(2, 2);
+
+    const std::vector<double> rewards{2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+    for ( size_t i = 0; i < rewards.size(); ++i ) {
+        exp.record(1, 0, i % 2, rewards[i]);
+        noVarExp.record(1, 0, i % 2, rewards[i]);
+    }
+
+    BOOST_CHECK(exp.getTrackVariance());
+    // Mean is 5, sum of squared deviations is 32.
+    BOOST_CHECK_CLOSE(exp.getRewardVariance(1, 0), 32.0 / 7.0, 0.000001);
+    BOOST_CHECK_EQUAL(exp.getRewardVariance(0, 0), 0.0);
+    BOOST_CHECK_EQUAL(noVarExp.getRewardVariance(1, 0), 0.0);
+
+    exp.record(0, 1, 0, 3.0);
+    BOOST_CHECK_EQUAL(exp.getRewardVariance(0, 1), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( overflow ) {
+    AIToolbox::MDP::CompactExperience<std::uint8_t> exp(2, 1);
+
+    for ( size_t i = 0; i < 255; ++i )
+        exp.record(0, 0, 1, 1.0);
+
+    BOOST_CHECK_EQUAL(exp.getVisits(0, 0, 1), 255ul);
+    BOOST_CHECK_THROW(exp.record(0, 0, 1, 1.0), std::overflow_error);
+
+    // Nothing is recorded on failure.
+    BOOST_CHECK_EQUAL(exp.getVisits(0, 0, 1), 255ul);
+    BOOST_CHECK_EQUAL(exp.getVisitsSum(0, 0), 255ul);
+    BOOST_CHECK_EQUAL(exp.getRewardSum(0, 0), 255.0);
+
+    // Other transitions are still fine.
+    exp.record(0, 0, 0, 1.0);
+    BOOST_CHECK_EQUAL(exp.getVisitsSum(0, 0), 256ul);
+}
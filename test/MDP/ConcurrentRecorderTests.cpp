@@ -0,0 +1,84 @@
+#define BOOST_TEST_MODULE MDP_ConcurrentRecorder
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/ConcurrentRecorder.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+
+#include <atomic>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    AIToolbox::MDP::ConcurrentRecorder recorder(5, 3, 4);
+
+    BOOST_CHECK_EQUAL(recorder.getS(), 5);
+    BOOST_CHECK_EQUAL(recorder.getA(), 3);
+    BOOST_CHECK_EQUAL(recorder.getShards(), 4);
+
+    BOOST_CHECK_THROW(AIToolbox::MDP::ConcurrentRecorder(5, 3, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( merging ) {
+    const size_t S = 4, A = 2;
+    AIToolbox::MDP::ConcurrentRecorder recorder(S, A, 2);
+    AIToolbox::MDP::SparseExperience exp(S, A);
+
+    recorder.record(0, 0, 1, 2, 1.0);
+    recorder.record(1, 0, 1, 2, 2.0);
+    recorder.record(1, 3, 0, 0, -1.0);
+
+    BOOST_CHECK_EQUAL(recorder.merge(exp), 3);
+    BOOST_CHECK_EQUAL(exp.getVisits(0, 1, 2), 2);
+    BOOST_CHECK_EQUAL(exp.getReward(0, 1, 2), 3.0);
+    BOOST_CHECK_EQUAL(exp.getVisits(3, 0, 0), 1);
+    BOOST_CHECK_EQUAL(exp.getRewardSum(3, 0), -1.0);
+
+    // Transitions are merged only once.
+    BOOST_CHECK_EQUAL(recorder.merge(exp), 0);
+    BOOST_CHECK_EQUAL(exp.getVisitsSum(0, 1), 2);
+
+    recorder.record(0, 2, 1, 3, 0.5);
+    BOOST_CHECK_EQUAL(recorder.merge(exp), 1);
+    BOOST_CHECK_EQUAL(exp.getVisits(2, 1, 3), 1);
+}
+
+BOOST_AUTO_TEST_CASE( concurrentActors ) {
+    const size_t S = 10, A = 3, actors = 8, steps = 20000;
+    AIToolbox::MDP::ConcurrentRecorder recorder(S, A, actors);
+    AIToolbox::MDP::Experience exp(S, A);
+
+    std::atomic<size_t> done(0);
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < actors; ++t ) {
+        threads.emplace_back([&, t]{
+            for ( size_t i = 0; i < steps; ++i )
+                recorder.record(t, i % S, t % A, (i + t) % S, 1.0);
+            ++done;
+        });
+    }
+
+    // The learner merges while actors are still running.
+    size_t merged = 0;
+    while ( done < actors )
+        merged += recorder.merge(exp);
+    for ( auto & t : threads ) t.join();
+    merged += recorder.merge(exp);
+
+    BOOST_CHECK_EQUAL(merged, actors * steps);
+
+    unsigned long visits = 0;
+    double rewards = 0.0;
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a ) {
+            visits += exp.getVisitsSum(s, a);
+            rewards += exp.getRewardSum(s, a);
+        }
+    BOOST_CHECK_EQUAL(visits, actors * steps);
+    BOOST_CHECK_EQUAL(rewards, static_cast<double>(actors * steps));
+
+    // Each actor records every state equally often.
+    for ( size_t s = 0; s < S; ++s )
+        BOOST_CHECK_EQUAL(exp.getVisitsSum(s, 0), 3 * steps / S);
+}
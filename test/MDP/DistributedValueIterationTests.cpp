@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE MDP_DistributedValueIteration
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Algorithms/DistributedValueIteration.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+#include <thread>
+
+namespace {
+    using namespace AIToolbox::MDP;
+    using Result = std::tuple<double, ValueFunction, QFunction>;
+
+    // Solves the model with one thread per partition, each with the
+    // range [bounds[i], bounds[i+1]).
+    template <typename M>
+    std::vector<Result> solveDistributed(const M & model, const std::vector<size_t> & bounds, const unsigned horizon, const double tolerance) {
+        const size_t nodes = bounds.size() - 1;
+        LocalHub hub(nodes);
+
+        std::vector<Result> results(nodes);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < nodes; ++i) {
+            threads.emplace_back([&, i]{
+                LocalTransport transport(hub, i);
+                DistributedValueIteration solver(horizon, tolerance);
+                results[i] = solver(makeModelPartition(model, bounds[i], bounds[i+1]), transport);
+            });
+        }
+        for (auto & t : threads) t.join();
+
+        return results;
+    }
+
+    template <typename M>
+    void checkAgainstValueIteration(const M & model, const std::vector<size_t> & bounds, const unsigned horizon, const double tolerance) {
+        ValueIteration vi(horizon, tolerance);
+        const auto [bound, vf, qf] = vi(model);
+
+        const auto results = solveDistributed(model, bounds, horizon, tolerance);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto & [dbound, dvf, dqf] = results[i];
+            const size_t begin = bounds[i], N = bounds[i+1] - bounds[i];
+
+            BOOST_CHECK_CLOSE(dbound, bound, 1e-6);
+            BOOST_REQUIRE_EQUAL(dvf.values.size(), N);
+            for (size_t s = 0; s < N; ++s) {
+                BOOST_CHECK_CLOSE(dvf.values[s], vf.values[begin + s], 1e-9);
+                BOOST_CHECK_EQUAL(dvf.actions[s], vf.actions[begin + s]);
+                for (size_t a = 0; a < model.getA(); ++a)
+                    BOOST_CHECK_CLOSE(dqf(s, a), qf(begin + s, a), 1e-9);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( transport_interface ) {
+    BOOST_CHECK(is_value_transport_v<LocalTransport>);
+    BOOST_CHECK(!is_value_transport_v<ValueIteration>);
+}
+
+BOOST_AUTO_TEST_CASE( partition_renumbering ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    // Rows 1 and 2 of the grid.
+    const auto p = makeModelPartition(model, 4, 12);
+    BOOST_CHECK_EQUAL(p.getS(), model.getS());
+    BOOST_CHECK_EQUAL(p.getA(), model.getA());
+
+    // Moving up and down reaches rows 0 and 3.
+    const std::vector<size_t> ghosts{0, 1, 2, 3, 12, 13, 14, 15};
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(p.getGhosts()), std::end(p.getGhosts()),
+                                  std::begin(ghosts), std::end(ghosts));
+
+    for (size_t a = 0; a < model.getA(); ++a) {
+        const auto & t = p.getTransitionFunction(a);
+        BOOST_CHECK_EQUAL(t.rows(), 8);
+        BOOST_CHECK_EQUAL(t.cols(), 16);
+        for (size_t s = 0; s < 8; ++s) {
+            for (size_t s1 = 0; s1 < model.getS(); ++s1) {
+                const size_t col = (s1 >= 4 && s1 < 12) ? s1 - 4 :
+                    8 + (std::find(std::begin(ghosts), std::end(ghosts), s1) - std::begin(ghosts));
+                BOOST_CHECK_EQUAL(t.coeff(s, col), model.getTransitionProbability(s + 4, a, s1));
+            }
+        }
+    }
+
+    BOOST_CHECK_THROW(makeModelPartition(model, 5, 17), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( same_as_value_iteration ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const SparseModel sparse(model);
+
+    checkAgainstValueIteration(model, {0, 16}, 1000000, 0.001);
+    checkAgainstValueIteration(model, {0, 5, 11, 16}, 1000000, 0.001);
+    checkAgainstValueIteration(sparse, {0, 1, 1, 13, 16}, 1000000, 0.001);
+    // With no tolerance we perform exactly the horizon.
+    checkAgainstValueIteration(sparse, {0, 10, 16}, 7, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( inconsistent_partitions ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    // A gap between the partitions makes all nodes throw.
+    LocalHub hub(2);
+    std::vector<int> threw(2, 0);
+    std::vector<std::thread> threads;
+    const std::vector<std::pair<size_t, size_t>> ranges{{0, 8}, {9, 16}};
+    for (size_t i = 0; i < 2; ++i) {
+        threads.emplace_back([&, i]{
+            LocalTransport transport(hub, i);
+            DistributedValueIteration solver(100, 0.001);
+            try {
+                solver(makeModelPartition(model, ranges[i].first, ranges[i].second), transport);
+            } catch (const std::runtime_error &) {
+                threw[i] = 1;
+            }
+        });
+    }
+    for (auto & t : threads) t.join();
+
+    BOOST_CHECK(threw[0]);
+    BOOST_CHECK(threw[1]);
+}
@@ -108,3 +108,34 @@ BOOST_AUTO_TEST_CASE( escapeToCorners ) {
     BOOST_CHECK_EQUAL( p1.sampleAction(13), RIGHT);
     BOOST_CHECK_EQUAL( p1.sampleAction(14), RIGHT);
 }
+
+BOOST_AUTO_TEST_CASE( transientReset ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    Dyna2 solver(model, 0.1, 0.9, 0.001, 20);
+
+    AIToolbox::RandomEngine rand(1);
+    std::uniform_int_distribution<size_t> sDist(0, model.getS() - 1), aDist(0, model.getA() - 1);
+
+    for (size_t e = 0; e < 50; ++e) {
+        size_t s = sDist(rand), a = aDist(rand);
+        for (size_t t = 0; t < 20; ++t) {
+            const auto [s1, r] = model.sampleSR(s, a);
+            const auto a1 = aDist(rand);
+
+            solver.stepUpdateQ(s, a, s1, a1, r);
+            solver.batchUpdateQ(s1);
+
+            s = s1;
+            a = a1;
+        }
+        // The partial reset must restore exactly the permanent QFunction.
+        BOOST_CHECK( solver.getTransientQFunction() != solver.getPermanentQFunction() );
+        solver.resetTransientLearning();
+        BOOST_CHECK( solver.getTransientQFunction() == solver.getPermanentQFunction() );
+    }
+}
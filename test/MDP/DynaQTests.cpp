@@ -43,3 +43,134 @@ BOOST_AUTO_TEST_CASE( updates ) {
         BOOST_CHECK_EQUAL( solver.getQFunction()(1, 1), 0.0  );
     }
 }
+
+BOOST_AUTO_TEST_CASE( parallelPlanning ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+
+    auto model = makeCliffProblem(grid);
+    model.setDiscount(0.9);
+
+    AIToolbox::ThreadPool pool(3);
+
+    mdp::DynaQ serial(model, 0.5, 200);
+    mdp::DynaQ parallel(model, 0.5, 200);
+
+    BOOST_CHECK( parallel.getThreadPool() == nullptr );
+    parallel.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL( parallel.getThreadPool(), &pool );
+
+    // We give some experience to both, and then we plan until convergence.
+    // The two versions update in a different order, but converge to the
+    // same QFunction.
+    for ( size_t s = 0; s < model.getS(); ++s ) {
+        for ( size_t a = 0; a < model.getA(); ++a ) {
+            const auto [s1, rew] = model.sampleSR(s, a);
+            serial.stepUpdateQ(s, a, s1, rew);
+            parallel.stepUpdateQ(s, a, s1, rew);
+        }
+    }
+
+    for ( int i = 0; i < 2000; ++i ) {
+        serial.batchUpdateQ();
+        parallel.batchUpdateQ();
+    }
+
+    const auto & sq = serial.getQFunction();
+    const auto & pq = parallel.getQFunction();
+    for ( size_t s = 0; s < model.getS(); ++s )
+        for ( size_t a = 0; a < model.getA(); ++a )
+            BOOST_CHECK_SMALL( sq(s, a) - pq(s, a), 0.001 );
+}
+
+// Forwards to a Model, but also supports sampling in batches.
+struct BatchModel {
+    const AIToolbox::MDP::Model & m;
+    mutable unsigned batches = 0;
+
+    size_t getS() const { return m.getS(); }
+    size_t getA() const { return m.getA(); }
+    double getDiscount() const { return m.getDiscount(); }
+    bool isTerminal(size_t s) const { return m.isTerminal(s); }
+    std::tuple<size_t, double> sampleSR(size_t s, size_t a) const { return m.sampleSR(s, a); }
+
+    void sampleSRBatch(AIToolbox::MDP::TransitionBatch * batch) const {
+        ++batches;
+        for ( size_t i = 0; i < batch->states.size(); ++i )
+            std::tie(batch->nextStates[i], batch->rewards[i]) = m.sampleSR(batch->states[i], batch->actions[i]);
+    }
+};
+
+BOOST_AUTO_TEST_CASE( batchSampling ) {
+    namespace mdp = AIToolbox::MDP;
+    static_assert(mdp::is_generative_model_batch_v<BatchModel>);
+    static_assert(!mdp::is_generative_model_batch_v<mdp::Model>);
+
+    GridWorld grid(12, 3);
+
+    auto model = makeCliffProblem(grid);
+    model.setDiscount(0.9);
+    BatchModel batchModel{model};
+
+    AIToolbox::ThreadPool pool(3);
+
+    mdp::DynaQ serial(model, 0.5, 200);
+    mdp::DynaQ<BatchModel> parallel(batchModel, 0.5, 200);
+    parallel.setThreadPool(&pool);
+
+    for ( size_t s = 0; s < model.getS(); ++s ) {
+        for ( size_t a = 0; a < model.getA(); ++a ) {
+            const auto [s1, rew] = model.sampleSR(s, a);
+            serial.stepUpdateQ(s, a, s1, rew);
+            parallel.stepUpdateQ(s, a, s1, rew);
+        }
+    }
+
+    for ( int i = 0; i < 2000; ++i ) {
+        serial.batchUpdateQ();
+        parallel.batchUpdateQ();
+    }
+    // A single call per planning phase.
+    BOOST_CHECK_EQUAL( batchModel.batches, 2000 );
+
+    const auto & sq = serial.getQFunction();
+    const auto & pq = parallel.getQFunction();
+    for ( size_t s = 0; s < model.getS(); ++s )
+        for ( size_t a = 0; a < model.getA(); ++a )
+            BOOST_CHECK_SMALL( sq(s, a) - pq(s, a), 0.001 );
+}
+
+BOOST_AUTO_TEST_CASE( serialBatchSampling ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+
+    auto model = makeCliffProblem(grid);
+    model.setDiscount(0.9);
+    BatchModel batchModel{model};
+
+    mdp::DynaQ serial(model, 0.5, 200);
+    mdp::DynaQ<BatchModel> batched(batchModel, 0.5, 200);
+
+    for ( size_t s = 0; s < model.getS(); ++s ) {
+        for ( size_t a = 0; a < model.getA(); ++a ) {
+            const auto [s1, rew] = model.sampleSR(s, a);
+            serial.stepUpdateQ(s, a, s1, rew);
+            batched.stepUpdateQ(s, a, s1, rew);
+        }
+    }
+
+    for ( int i = 0; i < 2000; ++i ) {
+        serial.batchUpdateQ();
+        batched.batchUpdateQ();
+    }
+    // The updates are still applied one at a time, but sampled together.
+    BOOST_CHECK_EQUAL( batchModel.batches, 2000 );
+
+    const auto & sq = serial.getQFunction();
+    const auto & bq = batched.getQFunction();
+    for ( size_t s = 0; s < model.getS(); ++s )
+        for ( size_t a = 0; a < model.getA(); ++a )
+            BOOST_CHECK_SMALL( sq(s, a) - bq(s, a), 0.001 );
+}
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE MDP_Evaluate
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Tools/Evaluate.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Policies/RandomPolicy.hpp>
+
+#include "Utils/CornerProblem.hpp"
+#include "Utils/BatchModel.hpp"
+
+namespace {
+    // Exposes only the basic generative interface, so that sampling has to
+    // be serialized.
+    struct SerialModel {
+        const AIToolbox::MDP::Model & m;
+
+        size_t getS() const { return m.getS(); }
+        size_t getA() const { return m.getA(); }
+        double getDiscount() const { return m.getDiscount(); }
+        std::tuple<size_t, double> sampleSR(size_t s, size_t a) const { return m.sampleSR(s, a); }
+        bool isTerminal(size_t s) const { return m.isTerminal(s); }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( optimalReturn ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    // With no uncertainty, the optimal policy from cell 5 always takes two
+    // steps to reach the corner.
+    auto model = makeCornerProblem(grid, 1.0);
+
+    ValueIteration solver(1000000, 0.001);
+    const auto qfun = std::get<2>(solver(model));
+
+    constexpr unsigned Horizon = 10;
+    AIToolbox::ThreadPool pool(4);
+    const auto stats = AIToolbox::evaluateMDP(model, 5, [&](unsigned) {
+        return [p = QGreedyPolicy(qfun)](size_t s, unsigned) { return p.sampleAction(s); };
+    }, 100, Horizon, &pool);
+
+    const auto results = stats.process();
+    BOOST_CHECK_EQUAL(results.size(), Horizon);
+
+    for (unsigned t = 0; t < Horizon; ++t) {
+        const auto & [mean, cumMean, std, cumStd] = results[t];
+        BOOST_CHECK_EQUAL(mean, t < 2 ? -1.0 : 0.0);
+        BOOST_CHECK_EQUAL(cumMean, t < 1 ? -1.0 : -2.0);
+        BOOST_CHECK_SMALL(std, 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( threadIndependence ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    auto model = makeCornerProblem(grid);
+
+    constexpr unsigned Seed = 12345, Episodes = 1000, Horizon = 20;
+    // The agent samples with the seed it gets, so the results only depend
+    // on the input seed.
+    auto makeAgent = [&](unsigned seed) {
+        return [p = RandomPolicy(model.getS(), model.getA()),
+                rnd = AIToolbox::makeEngineStream<AIToolbox::RandomEngine>(seed, 0)](size_t s, unsigned) mutable {
+            return p.sampleActionWith(s, rnd);
+        };
+    };
+
+    const auto serial = AIToolbox::evaluateMDP(model, 6, makeAgent, Episodes, Horizon, nullptr, Seed).process();
+
+    AIToolbox::ThreadPool pool(4);
+    const auto parallel = AIToolbox::evaluateMDP(model, 6, makeAgent, Episodes, Horizon, &pool, Seed).process();
+    const auto locked = AIToolbox::evaluateMDP(SerialModel{model}, 6, makeAgent, Episodes, Horizon, &pool, Seed).process();
+
+    for (unsigned t = 0; t < Horizon; ++t) {
+        BOOST_CHECK_CLOSE(std::get<1>(serial[t]), std::get<1>(parallel[t]), 1e-9);
+        BOOST_CHECK_CLOSE(std::get<2>(serial[t]), std::get<2>(parallel[t]), 1e-6);
+    }
+    // Reaching a corner from cell 6 takes at least 3 steps, and each move
+    // costs between 0.8 and 1 on average (bumping into walls costs 1).
+    BOOST_CHECK(std::get<1>(serial[2]) <= -2.4 && std::get<1>(serial[2]) >= -3.0);
+    BOOST_CHECK(std::get<1>(serial[Horizon-1]) < -2.4);
+
+    // The serialized model samples with its internal engine, so we can
+    // only check that it sees the same problem.
+    BOOST_CHECK(std::get<1>(locked[2]) <= -2.4 && std::get<1>(locked[2]) >= -3.0);
+    BOOST_CHECK(std::get<1>(locked[Horizon-1]) < -2.4);
+}
+
+BOOST_AUTO_TEST_CASE( batchedSampling ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 1.0);
+    const BatchModel batchModel(model);
+
+    ValueIteration solver(1000000, 0.001);
+    const auto qfun = std::get<2>(solver(model));
+
+    constexpr unsigned Horizon = 10;
+    AIToolbox::ThreadPool pool(4);
+    const auto results = AIToolbox::evaluateMDP(batchModel, 5, [&](unsigned) {
+        return [p = QGreedyPolicy(qfun)](size_t s, unsigned) { return p.sampleAction(s); };
+    }, 100, Horizon, &pool).process();
+
+    // Episodes stop being sampled once they reach the corner.
+    for (unsigned t = 0; t < Horizon; ++t) {
+        const auto & [mean, cumMean, std, cumStd] = results[t];
+        BOOST_CHECK_EQUAL(mean, t < 2 ? -1.0 : 0.0);
+        BOOST_CHECK_EQUAL(cumMean, t < 1 ? -1.0 : -2.0);
+    }
+    BOOST_CHECK_EQUAL(batchModel.samples, 100 * 2);
+    BOOST_CHECK_EQUAL(batchModel.batches, 4 * 2);
+}
@@ -9,8 +9,10 @@
 
 #include <AIToolbox/MDP/Policies/EpsilonPolicy.hpp>
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Policies/QSoftmaxPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
+#include "Utils/TransitionBatch.hpp"
 
 BOOST_AUTO_TEST_CASE( cliff ) {
     namespace mdp = AIToolbox::MDP;
@@ -82,3 +84,68 @@ BOOST_AUTO_TEST_CASE( cliff ) {
 //     BOOST_CHECK_EXCEPTION(mdp::SARSA(1,1,0.3,-0.5),  std::invalid_argument, [](const std::invalid_argument &){return true;});
 //     BOOST_CHECK_EXCEPTION(mdp::SARSA(1,1,0.3,1.1),   std::invalid_argument, [](const std::invalid_argument &){return true;});
 // }
+
+BOOST_AUTO_TEST_CASE( batchUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+    auto model = makeCliffProblem(grid);
+    const size_t S = model.getS(), A = model.getA();
+
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    auto stepQ = mdp::makeQFunction(S, A);
+    mdp::QGreedyPolicy stepPolicy(stepQ);
+    mdp::ExpectedSARSA step(stepQ, stepPolicy, model, 0.3);
+
+    auto batchQ = mdp::makeQFunction(S, A);
+    mdp::QGreedyPolicy batchPolicy(batchQ);
+    mdp::ExpectedSARSA batched(batchQ, batchPolicy, model, 0.3);
+
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        step.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+    batched.batchUpdateQ(batch);
+
+    BOOST_CHECK( stepQ == batchQ );
+}
+
+BOOST_AUTO_TEST_CASE( actionProbabilities ) {
+    namespace mdp = AIToolbox::MDP;
+
+    constexpr size_t S = 5, A = 4;
+
+    auto q = mdp::makeQFunction(S, A);
+    q << 1.0, 2.0, 2.0, 0.0,
+         0.0, 0.0, 0.0, 0.0,
+        -1.0, 3.0, 0.5, 0.2,
+         4.0, 4.0, 4.0, 1.0,
+         0.1, 0.2, 0.3, 0.4;
+
+    mdp::QGreedyPolicy greedy(q);
+    mdp::QSoftmaxPolicy softmax(q, 0.7);
+    mdp::EpsilonPolicy epsilon(softmax, 0.2);
+
+    const auto check = [&](const mdp::PolicyInterface & p) {
+        AIToolbox::Vector probs;
+        for ( size_t s = 0; s < S; ++s ) {
+            p.getActionProbabilities(s, &probs);
+            BOOST_REQUIRE_EQUAL( probs.size(), A );
+            for ( size_t a = 0; a < A; ++a )
+                BOOST_CHECK_CLOSE( probs[a], p.getActionProbability(s, a), 0.000001 );
+        }
+    };
+    check(greedy);
+    check(softmax);
+    check(epsilon);
+
+    // The expectation is computed with the whole distribution at once.
+    auto q2 = q;
+    mdp::QSoftmaxPolicy policy2(q2, 0.7);
+    mdp::ExpectedSARSA solver(q2, policy2, 0.9, 0.5);
+    solver.stepUpdateQ(0, 1, 2, 1.0);
+
+    double expected = 0.0;
+    for ( size_t a = 0; a < A; ++a )
+        expected += softmax.getActionProbability(2, a) * q(2, a);
+    BOOST_CHECK_CLOSE( q2(0, 1), q(0, 1) + 0.5 * (1.0 + 0.9 * expected - q(0, 1)), 0.000001 );
+}
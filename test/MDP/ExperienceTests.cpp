@@ -5,11 +5,13 @@
 
 #include <AIToolbox/MDP/Experience.hpp>
 #include <AIToolbox/MDP/IO.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include <array>
 #include <algorithm>
 #include <fstream>
 #include <cstdio>
+#include <random>
 
 BOOST_AUTO_TEST_CASE( construction ) {
     const int S = 5, A = 6;
@@ -138,3 +140,81 @@ BOOST_AUTO_TEST_CASE( files ) {
         std::remove(outputFilename.c_str());
     }
 }
+
+BOOST_AUTO_TEST_CASE( dirtyPairs ) {
+    const size_t S = 5, A = 3;
+
+    AIToolbox::MDP::Experience exp(S, A);
+    BOOST_CHECK( exp.getDirtyPairs().empty() );
+
+    exp.record(1, 2, 3, 1.0);
+    exp.record(4, 0, 0, 2.0);
+    exp.record(1, 2, 4, 3.0);
+
+    using Pairs = AIToolbox::MDP::Experience::DirtyPairs;
+    BOOST_CHECK( exp.getDirtyPairs() == (Pairs{{1, 2}, {4, 0}}) );
+
+    exp.clearDirtyPairs();
+    BOOST_CHECK( exp.getDirtyPairs().empty() );
+
+    // Pairs are dirty again after a clear.
+    exp.record(1, 2, 3, 1.0);
+    BOOST_CHECK( exp.getDirtyPairs() == (Pairs{{1, 2}}) );
+
+    exp.reset();
+    BOOST_CHECK( exp.getDirtyPairs().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( transitionLog ) {
+    const size_t S = 7, A = 3, N = 5000;
+
+    AIToolbox::MDP::Experience recorded(S, A), loaded(S, A);
+
+    std::string filename = "./transitionLog.txt";
+    {
+        std::mt19937 rand(42);
+        std::uniform_int_distribution<size_t> sDist(0, S-1), aDist(0, A-1);
+        std::uniform_int_distribution<int> rDist(-5, 5);
+
+        std::ofstream file(filename);
+        if ( !file ) BOOST_FAIL("Could not open file for writing: " + filename);
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto s = sDist(rand), a = aDist(rand), s1 = sDist(rand);
+            const double r = rDist(rand) * 0.5;
+            recorded.record(s, a, s1, r);
+            // Mix up the formatting a bit.
+            if ( i % 7 == 0 ) file << "\n";
+            if ( i % 3 == 0 ) file << "  " << s << "\t" << a << " " << s1 << "  " << r << "\r\n";
+            else file << s << ' ' << a << ' ' << s1 << ' ' << r << '\n';
+        }
+    }
+
+    AIToolbox::ThreadPool pool(4);
+    BOOST_CHECK_EQUAL(AIToolbox::MDP::readTransitionLog(filename, loaded, &pool), N);
+
+    for ( size_t s = 0; s < S; ++s ) {
+        for ( size_t a = 0; a < A; ++a ) {
+            BOOST_CHECK_EQUAL(recorded.getVisitsSum(s, a), loaded.getVisitsSum(s, a));
+            BOOST_CHECK_EQUAL(recorded.getRewardSum(s, a), loaded.getRewardSum(s, a));
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(recorded.getVisits(s, a, s1), loaded.getVisits(s, a, s1));
+                BOOST_CHECK_EQUAL(recorded.getReward(s, a, s1), loaded.getReward(s, a, s1));
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(loaded.getDirtyPairs().size(), recorded.getDirtyPairs().size());
+
+    // Loading again without a pool adds to the existing counts.
+    BOOST_CHECK_EQUAL(AIToolbox::MDP::readTransitionLog(filename, loaded), N);
+    BOOST_CHECK_EQUAL(loaded.getVisits(0, 0, 0), 2 * recorded.getVisits(0, 0, 0));
+
+    {
+        std::ofstream file(filename);
+        file << "0 0 1 1.0\n0 " << A << " 1 1.0\n";
+    }
+    AIToolbox::MDP::Experience copy(S, A);
+    BOOST_CHECK_THROW(AIToolbox::MDP::readTransitionLog(filename, copy, &pool), std::runtime_error);
+    BOOST_CHECK_EQUAL(copy.getVisitsSum(0, 0), 0);
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,90 @@
+#define BOOST_TEST_MODULE MDP_FixedModel
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/FixedModel.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+BOOST_AUTO_TEST_CASE( eigen_model ) {
+    BOOST_CHECK((AIToolbox::MDP::is_model_eigen_v<AIToolbox::MDP::FixedModel<8, 3>>));
+}
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    using namespace AIToolbox::MDP;
+    FixedModel<5, 6> m(0.9);
+
+    BOOST_CHECK_EQUAL(m.getS(), 5);
+    BOOST_CHECK_EQUAL(m.getA(), 6);
+    BOOST_CHECK_EQUAL(m.getDiscount(), 0.9);
+
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,0,0), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,1,1), 0.0);
+    BOOST_CHECK_EQUAL(m.getExpectedReward(0,0,0), 0.0);
+
+    for (size_t s = 0; s < 5; ++s)
+        BOOST_CHECK(m.isTerminal(s));
+
+    BOOST_CHECK_THROW((FixedModel<5, 6>(1.5)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( copy_construction ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    FixedModel<16, 4> fixed(model);
+    for (size_t s = 0; s < 16; ++s)
+        for (size_t a = 0; a < 4; ++a)
+            for (size_t s1 = 0; s1 < 16; ++s1) {
+                BOOST_CHECK_EQUAL(fixed.getTransitionProbability(s, a, s1), model.getTransitionProbability(s, a, s1));
+                BOOST_CHECK_EQUAL(fixed.getExpectedReward(s, a, s1), model.getExpectedReward(s, a, s1));
+            }
+
+    BOOST_CHECK_THROW((FixedModel<15, 4>(model)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( transitions ) {
+    using namespace AIToolbox::MDP;
+    using M = FixedModel<2, 1>;
+
+    M::TransitionMatrix t;
+    t[0] << 0.5, 0.5,
+            0.0, 1.0;
+
+    M m;
+    m.setTransitionFunction(t);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0, 0, 1), 0.5);
+    BOOST_CHECK(!m.isTerminal(0));
+    BOOST_CHECK(m.isTerminal(1));
+
+    t[0](1, 1) = 0.5;
+    BOOST_CHECK_THROW(m.setTransitionFunction(t), std::invalid_argument);
+
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(std::get<0>(m.sampleSR(1, 0)), 1);
+}
+
+BOOST_AUTO_TEST_CASE( solving ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    auto model = makeCornerProblem(grid);
+    model.setDiscount(0.9);
+
+    FixedModel<16, 4> fixed(model);
+
+    ValueIteration solver(1000000, 0.001);
+    const auto [bound, vf, q] = solver(model);
+    const auto [fbound, fvf, fq] = solver(fixed);
+
+    BOOST_CHECK_EQUAL(bound, fbound);
+    for (size_t s = 0; s < 16; ++s) {
+        BOOST_CHECK_CLOSE(vf.values[s], fvf.values[s], 1e-9);
+        BOOST_CHECK_EQUAL(vf.actions[s], fvf.actions[s]);
+    }
+}
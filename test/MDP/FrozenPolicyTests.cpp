@@ -0,0 +1,90 @@
+#define BOOST_TEST_MODULE MDP_FrozenPolicy
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Policies/FrozenPolicy.hpp>
+#include <AIToolbox/MDP/Policies/Policy.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <stdexcept>
+
+namespace ai = AIToolbox;
+namespace aim = AIToolbox::MDP;
+
+aim::Policy::PolicyMatrix makeSparsePolicy() {
+    constexpr size_t S = 3, A = 12;
+    aim::Policy::PolicyMatrix p(S, A);
+    p.setZero();
+
+    // A deterministic state.
+    p(0, 4) = 1.0;
+    // Few non-zero actions, searched linearly.
+    p(1, 0) = 0.2; p(1, 5) = 0.5; p(1, 11) = 0.3;
+    // Many non-zero actions, searched with a binary search.
+    for (size_t a = 0; a < A; ++a)
+        p(2, a) = static_cast<double>(a + 1) / (A * (A + 1) / 2);
+
+    return p;
+}
+
+BOOST_AUTO_TEST_CASE( exact_probabilities ) {
+    const auto p = makeSparsePolicy();
+    aim::FrozenPolicy policy(p);
+
+    BOOST_CHECK_EQUAL(policy.getS(), p.rows());
+    BOOST_CHECK_EQUAL(policy.getA(), p.cols());
+    BOOST_CHECK_EQUAL(policy.getNonZeros(), 1 + 3 + 12);
+
+    for (size_t s = 0; s < policy.getS(); ++s)
+        for (size_t a = 0; a < policy.getA(); ++a)
+            BOOST_CHECK_EQUAL(policy.getActionProbability(s, a), p(s, a));
+
+    BOOST_CHECK(policy.getPolicy() == p);
+
+    aim::Policy original(p);
+    aim::FrozenPolicy copy(original);
+    BOOST_CHECK(copy.getPolicy() == p);
+}
+
+BOOST_AUTO_TEST_CASE( sampling_frequencies ) {
+    const auto p = makeSparsePolicy();
+    aim::FrozenPolicy policy(p);
+
+    constexpr size_t N = 100000;
+    ai::RandomEngine gen(ai::Impl::Seeder::getSeed());
+
+    for (size_t s = 0; s < policy.getS(); ++s) {
+        ai::Vector counts(policy.getA()), countsWith(policy.getA());
+        counts.setZero(); countsWith.setZero();
+
+        std::vector<size_t> states(N, s), actions;
+        policy.sampleActions(states, &actions);
+        for (auto a : actions) counts[a] += 1.0;
+
+        for (size_t i = 0; i < N; ++i)
+            countsWith[policy.sampleActionWith(s, gen)] += 1.0;
+
+        for (size_t a = 0; a < policy.getA(); ++a) {
+            BOOST_TEST_INFO("s = " << s << ", a = " << a);
+            if (p(s, a) == 0.0) {
+                BOOST_CHECK_EQUAL(counts[a], 0.0);
+                BOOST_CHECK_EQUAL(countsWith[a], 0.0);
+            } else {
+                BOOST_CHECK_SMALL(counts[a] / N - p(s, a), 0.01);
+                BOOST_CHECK_SMALL(countsWith[a] / N - p(s, a), 0.01);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(policy.sampleAction(0), 4);
+}
+
+BOOST_AUTO_TEST_CASE( invalid_matrix ) {
+    aim::Policy::PolicyMatrix p(2, 3);
+    p << 0.5, 0.5, 0.0,
+         0.5, 0.4, 0.0;
+
+    BOOST_CHECK_THROW(aim::FrozenPolicy{p}, std::invalid_argument);
+}
@@ -0,0 +1,165 @@
+#define BOOST_TEST_MODULE MDP_FusedSparseModel
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/FusedSparseModel.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+BOOST_AUTO_TEST_CASE( fused_model ) {
+    using namespace AIToolbox::MDP;
+
+    BOOST_CHECK(is_model_v<FusedSparseModel>);
+    BOOST_CHECK(is_model_fused_v<FusedSparseModel>);
+    BOOST_CHECK(!is_model_eigen_v<FusedSparseModel>);
+
+    BOOST_CHECK(!is_model_fused_v<Model>);
+    BOOST_CHECK(!is_model_fused_v<SparseModel>);
+}
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    const size_t S = 5, A = 6;
+
+    AIToolbox::MDP::FusedSparseModel m(S, A);
+
+    BOOST_CHECK_EQUAL(m.getS(), S);
+    BOOST_CHECK_EQUAL(m.getA(), A);
+
+    BOOST_CHECK_EQUAL(static_cast<size_t>(m.getTransitionFunction().rows()), S * A);
+    BOOST_CHECK_EQUAL(static_cast<size_t>(m.getTransitionFunction().cols()), S);
+
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,0,0), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,1,0), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,0,1), 0.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,1,1), 0.0);
+
+    BOOST_CHECK_EQUAL(m.getExpectedReward(0,0,0), 0.0);
+
+    for (size_t s = 0; s < S; ++s) {
+        BOOST_CHECK(m.isTerminal(s));
+        BOOST_CHECK_EQUAL(std::get<0>(m.sampleSR(s, 0)), s);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( copy_construction ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    auto model = makeCornerProblem(grid);
+    size_t S = model.getS(), A = model.getA();
+
+    FusedSparseModel copy(model);
+
+    BOOST_CHECK_EQUAL(model.getDiscount(), copy.getDiscount());
+    BOOST_CHECK_EQUAL(S, copy.getS());
+    BOOST_CHECK_EQUAL(A, copy.getA());
+
+    for ( size_t s = 0; s < S; ++s ) {
+        BOOST_CHECK_EQUAL(model.isTerminal(s), copy.isTerminal(s));
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(model.getTransitionProbability(s, a, s1), copy.getTransitionProbability(s, a, s1));
+                BOOST_CHECK_EQUAL(model.getExpectedReward(s, a, s1), copy.getExpectedReward(s, a, s1));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( setTransitionFunction ) {
+    const size_t S = 5, A = 6;
+
+    AIToolbox::MDP::FusedSparseModel m(S, A);
+
+    AIToolbox::SparseMatrix2D newT(S * A, S);
+
+    for ( size_t s = 0; s < S; ++s ) {
+        for ( size_t a = 0; a < A; ++a ) {
+            newT.insert(s * A + a, 0) = 0.8;
+            newT.insert(s * A + a, 1) = 0.2;
+        }
+    }
+
+    m.setTransitionFunction(newT);
+
+    for ( size_t a = 0; a < A; ++a ) {
+        for ( size_t s = 0; s < S; ++s ) {
+            BOOST_CHECK_EQUAL(m.getTransitionProbability(s,a,0), 0.8);
+            BOOST_CHECK_EQUAL(m.getTransitionProbability(s,a,1), 0.2);
+        }
+    }
+
+    AIToolbox::SparseMatrix2D wrongSize(S, S);
+    BOOST_CHECK_THROW(m.setTransitionFunction(wrongSize), std::invalid_argument);
+
+    newT.coeffRef(0, 0) = 0.5;
+    BOOST_CHECK_THROW(m.setTransitionFunction(newT), std::invalid_argument);
+
+    // The model is left untouched on failure.
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0,0,0), 0.8);
+}
+
+BOOST_AUTO_TEST_CASE( sampling ) {
+    const size_t S = 4, A = 2;
+
+    AIToolbox::MDP::FusedSparseModel m(S, A);
+
+    AIToolbox::SparseMatrix2D newT(S * A, S);
+    for ( size_t s = 0; s < S; ++s ) {
+        newT.insert(s * A + 0, s) = 1.0;
+
+        newT.insert(s * A + 1, 0) = 0.1;
+        newT.insert(s * A + 1, 2) = 0.3;
+        newT.insert(s * A + 1, 3) = 0.6;
+    }
+    m.setTransitionFunction(newT);
+
+    const unsigned samples = 100000;
+    std::vector<unsigned> counts(S, 0);
+    for ( unsigned i = 0; i < samples; ++i ) {
+        BOOST_CHECK_EQUAL(std::get<0>(m.sampleSR(2, 0)), 2);
+        ++counts[std::get<0>(m.sampleSR(1, 1))];
+    }
+
+    BOOST_CHECK_EQUAL(counts[1], 0);
+    BOOST_CHECK_CLOSE(counts[0] / double(samples), 0.1, 5);
+    BOOST_CHECK_CLOSE(counts[2] / double(samples), 0.3, 5);
+    BOOST_CHECK_CLOSE(counts[3] / double(samples), 0.6, 5);
+}
+
+BOOST_AUTO_TEST_CASE( valueIteration ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    auto model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+    FusedSparseModel fusedModel(model);
+
+    AIToolbox::ThreadPool pool(3);
+
+    ValueIteration solver(1000000, 0.001);
+    const auto [bound, vfun, qfun] = solver(sparseModel);
+
+    for ( auto usePool : {false, true} ) {
+        solver.setThreadPool(usePool ? &pool : nullptr);
+        const auto [fBound, fVFun, fQFun] = solver(fusedModel);
+
+        BOOST_CHECK_EQUAL( bound, fBound );
+        BOOST_CHECK( vfun.values == fVFun.values );
+        BOOST_CHECK( vfun.actions == fVFun.actions );
+        BOOST_CHECK( qfun == fQFun );
+    }
+
+    solver.setThreadPool(nullptr);
+    solver.setSweep(ValueIteration::Sweep::GaussSeidel);
+    const auto [gBound, gVFun, gQFun] = solver(sparseModel);
+    const auto [fBound, fVFun, fQFun] = solver(fusedModel);
+
+    BOOST_CHECK_EQUAL( gBound, fBound );
+    BOOST_CHECK( gVFun.values == fVFun.values );
+    BOOST_CHECK( gQFun == fQFun );
+}
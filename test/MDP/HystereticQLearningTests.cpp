@@ -6,6 +6,8 @@
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/MDP/Algorithms/HystereticQLearning.hpp>
 
+#include "Utils/TransitionBatch.hpp"
+
 BOOST_AUTO_TEST_CASE( updates ) {
     namespace mdp = AIToolbox::MDP;
 
@@ -52,3 +54,19 @@ BOOST_AUTO_TEST_CASE( updates ) {
         BOOST_CHECK_EQUAL( solver.getQFunction()(1, 1), 0.0  );
     }
 }
+
+BOOST_AUTO_TEST_CASE( batchUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::HystereticQLearning step(S, A, 0.9, 0.3, 0.1);
+    mdp::HystereticQLearning batched(S, A, 0.9, 0.3, 0.1);
+
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        step.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+    batched.batchUpdateQ(batch);
+
+    BOOST_CHECK( step.getQFunction() == batched.getQFunction() );
+}
@@ -0,0 +1,161 @@
+#define BOOST_TEST_MODULE MDP_LSPI
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Algorithms/LSPI.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/RLModel.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+namespace ai = AIToolbox;
+namespace aim = AIToolbox::MDP;
+
+namespace {
+    ai::SparseMatrix2D oneHot(const size_t S) {
+        ai::SparseMatrix2D retval(S, S);
+        retval.setIdentity();
+        return retval;
+    }
+
+    template <typename M>
+    void checkMatchesValueIteration(const aim::LSPI & lspi, const M & m) {
+        aim::ValueIteration vi(1000000, 1e-9);
+        const auto [bound, v, q] = vi(m);
+        (void)bound; (void)v;
+
+        for (size_t s = 0; s < m.getS(); ++s)
+            for (size_t a = 0; a < m.getA(); ++a)
+                BOOST_CHECK_SMALL(lspi.getQValue(s, a) - q(s, a), 1e-4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( exact_with_one_hot_features ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    // With one feature per state LSPI is exact policy iteration.
+    aim::LSPI lspi(oneHot(S), A, 0.5, 50, 1e-9, 0.0);
+    const auto [delta, w] = lspi(model);
+
+    BOOST_CHECK(delta <= 1e-9);
+    BOOST_CHECK_EQUAL(w.size(), S * A);
+    checkMatchesValueIteration(lspi, model);
+
+    aim::LSPI sparse(oneHot(S), A, 0.5, 50, 1e-9, 0.0);
+    sparse(aim::SparseModel(model));
+    BOOST_CHECK(sparse.getWeights().isApprox(lspi.getWeights()));
+}
+
+BOOST_AUTO_TEST_CASE( experiences_and_batches ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    ai::Impl::Seeder::setRootSeed(0);
+    ai::RandomEngine rnd(ai::Impl::Seeder::getSeed());
+
+    aim::Experience exp(S, A);
+    aim::SparseExperience sexp(S, A);
+    aim::TransitionBatch batch;
+    for (size_t s = 0; s < S; ++s) {
+        for (size_t a = 0; a < A; ++a) {
+            for (unsigned i = 0; i < 20; ++i) {
+                const auto [s1, r] = model.sampleSR(s, a);
+                exp.record(s, a, s1, r);
+                sexp.record(s, a, s1, r);
+                batch.states.push_back(s);
+                batch.actions.push_back(a);
+                batch.nextStates.push_back(s1);
+                batch.rewards.push_back(r);
+            }
+        }
+    }
+
+    aim::LSPI lspi(oneHot(S), A, 0.95, 50, 1e-9, 0.0);
+    lspi(exp);
+    // The solution is the one of the maximum likelihood model.
+    checkMatchesValueIteration(lspi, aim::RLModel(exp, 0.95, true));
+
+    aim::LSPI sparse(oneHot(S), A, 0.95, 50, 1e-9, 0.0);
+    sparse(sexp);
+    BOOST_CHECK(sparse.getWeights().isApprox(lspi.getWeights()));
+
+    aim::LSPI fromBatch(oneHot(S), A, 0.95, 50, 1e-9, 0.0);
+    fromBatch(batch);
+    BOOST_CHECK(fromBatch.getWeights().isApprox(lspi.getWeights()));
+}
+
+BOOST_AUTO_TEST_CASE( approximate_features ) {
+    GridWorld grid(8, 8);
+    const auto model = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    // Features: a bias, one-hot rows and columns, and the two corners.
+    const size_t K = 1 + grid.getSizeX() + grid.getSizeY() + 2;
+    ai::SparseMatrix2D features(S, K);
+    for (size_t s = 0; s < S; ++s) {
+        const auto cell = grid(s);
+        features.insert(s, 0) = 1.0;
+        features.insert(s, 1 + cell.getX()) = 1.0;
+        features.insert(s, 1 + grid.getSizeX() + cell.getY()) = 1.0;
+    }
+    features.insert(0, K - 2) = 1.0;
+    features.insert(S - 1, K - 1) = 1.0;
+
+    aim::LSPI lspi(features, A, 0.95);
+    const auto [delta, w] = lspi(model);
+    (void)delta;
+
+    // Memory only depends on the number of features.
+    BOOST_CHECK_EQUAL(w.size(), K * A);
+    BOOST_CHECK(w.allFinite());
+
+    // The corners are worth more than any other state.
+    for (size_t s = 1; s < S - 1; ++s) {
+        BOOST_CHECK(lspi.getQValues(0).maxCoeff() > lspi.getQValues(s).maxCoeff());
+        BOOST_CHECK(lspi.getQValues(S - 1).maxCoeff() > lspi.getQValues(s).maxCoeff());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( thread_pool ) {
+    GridWorld grid(6, 6);
+    const auto model = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    aim::LSPI serial(oneHot(S), A, 0.95);
+    serial(model);
+
+    ai::ThreadPool pool(3);
+    aim::LSPI parallel(oneHot(S), A, 0.95);
+    parallel.setThreadPool(&pool);
+    parallel(model);
+
+    BOOST_CHECK(serial.getWeights() == parallel.getWeights());
+}
+
+BOOST_AUTO_TEST_CASE( invalid_arguments ) {
+    BOOST_CHECK_THROW(aim::LSPI(oneHot(4), 0, 0.9), std::invalid_argument);
+    BOOST_CHECK_THROW(aim::LSPI(oneHot(4), 2, 0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(aim::LSPI(oneHot(4), 2, 0.9, 10, -1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(aim::LSPI(oneHot(4), 2, 0.9, 10, 0.1, -1.0), std::invalid_argument);
+
+    aim::LSPI lspi(oneHot(4), 2, 0.9);
+    BOOST_CHECK_THROW(lspi.setWeights(ai::Vector::Zero(4)), std::invalid_argument);
+
+    aim::TransitionBatch batch;
+    batch.states = {0};
+    batch.actions = {2};
+    batch.nextStates = {1};
+    batch.rewards = {0.0};
+    BOOST_CHECK_THROW(lspi(batch), std::invalid_argument);
+
+    batch.actions = {0, 1};
+    BOOST_CHECK_THROW(lspi(batch), std::invalid_argument);
+}
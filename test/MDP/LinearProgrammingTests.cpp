@@ -45,7 +45,7 @@ BOOST_AUTO_TEST_CASE( escapeToCornersSparse ) {
 
     GridWorld grid(4, 4);
 
-    Model model = makeCornerProblem(grid);
+    SparseModel model = makeCornerProblem(grid);
     size_t S = model.getS(), A = model.getA();
 
     double tolerance = 0.0001;
@@ -97,3 +97,84 @@ BOOST_AUTO_TEST_CASE( escapeToCornersNonEigen ) {
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE( escapeToCornersDual ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    SparseModel model = makeCornerProblem(grid);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+    size_t S = model.getS(), A = model.getA();
+
+    double tolerance = 0.0001;
+    ValueIteration solver(1000000, tolerance);
+    LinearProgramming solver2(LinearProgramming::Formulation::Dual);
+    BOOST_CHECK( solver2.getFormulation() == LinearProgramming::Formulation::Dual );
+
+    auto [bound, vfun, qfun] = solver(model);
+    (void)bound;
+
+    auto check = [&](const auto & solution) {
+        const auto & [bound2, vfun2, qfun2] = solution;
+        (void)bound2;
+        for ( size_t s = 0; s < S; ++s ) {
+            BOOST_CHECK_EQUAL( vfun.actions[s], vfun2.actions[s] );
+
+            BOOST_TEST_INFO(s << " : " << vfun.values[s] << " --- " << vfun2.values[s]);
+            BOOST_CHECK( std::fabs(vfun.values[s] - vfun2.values[s]) <= tolerance );
+
+            for ( size_t a = 0; a < A; ++a ) {
+                BOOST_TEST_INFO(s << " & " << a << " : " << qfun(s, a) << " --- " << qfun2(s, a));
+                BOOST_CHECK( std::fabs(qfun(s,a) - qfun2(s,a)) <= tolerance );
+            }
+        }
+    };
+    check(solver2(model));
+    check(solver2(oldModel));
+}
+
+BOOST_AUTO_TEST_CASE( dualRejectsUndiscounted ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    model.setDiscount(1.0);
+
+    LinearProgramming solver(LinearProgramming::Formulation::Dual);
+    BOOST_CHECK_THROW( solver(model), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( dualResolveChangedRewards ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    const size_t S = model.getS(), A = model.getA();
+
+    double tolerance = 0.0001;
+    ValueIteration solver(1000000, tolerance);
+    LinearProgramming solver2(LinearProgramming::Formulation::Dual);
+
+    // The first solve builds the LP, the following ones only change its
+    // objective.
+    for ( int i = 0; i < 3; ++i ) {
+        AIToolbox::Matrix2D rewards = model.getRewardFunction();
+        rewards.col(i).array() -= 0.5;
+        model.setRewardFunction(rewards);
+
+        auto [bound, vfun, qfun] = solver(model);
+        auto [bound2, vfun2, qfun2] = solver2(model);
+        (void)bound; (void)bound2;
+
+        for ( size_t s = 0; s < S; ++s ) {
+            BOOST_TEST_INFO(s << " : " << vfun.values[s] << " --- " << vfun2.values[s]);
+            BOOST_CHECK( std::fabs(vfun.values[s] - vfun2.values[s]) <= tolerance );
+
+            for ( size_t a = 0; a < A; ++a )
+                BOOST_CHECK( std::fabs(qfun(s,a) - qfun2(s,a)) <= tolerance );
+        }
+    }
+}
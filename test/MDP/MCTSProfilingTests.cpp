@@ -0,0 +1,56 @@
+#define BOOST_TEST_MODULE MDP_MCTSProfiling
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// This must be set before including any library header.
+#define AI_PROFILING_ENABLED 1
+
+#include <AIToolbox/MDP/Algorithms/MCTS.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+
+#include <numeric>
+
+#include "Utils/CornerProblem.hpp"
+
+BOOST_AUTO_TEST_CASE( profiledSearch ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 2000, 5.0);
+    BOOST_CHECK_EQUAL(solver.sampleAction(1, 10), LEFT);
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.selectionTime.count() > 0);
+    BOOST_CHECK(stats.expansionTime.count() > 0);
+    BOOST_CHECK(stats.rolloutTime.count() > 0);
+    BOOST_CHECK(stats.selectionTime + stats.expansionTime + stats.rolloutTime <= stats.elapsed);
+
+    // Every simulation leaves the tree exactly once.
+    const auto & histogram = stats.depthHistogram;
+    BOOST_CHECK_EQUAL(std::accumulate(std::begin(histogram), std::end(histogram), 0u), stats.rollouts);
+    BOOST_CHECK_EQUAL(histogram.size(), stats.maxDepth + 1);
+}
+
+BOOST_AUTO_TEST_CASE( profiledBatches ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 1000, 5.0);
+    solver.setLeafEvaluator([](const std::vector<size_t> &, const std::vector<unsigned> &, std::vector<double> & values) {
+        std::fill(std::begin(values), std::end(values), 0.0);
+    }, 16);
+    solver.sampleAction(1, 10);
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.rolloutTime.count() > 0);
+
+    const auto & histogram = stats.depthHistogram;
+    BOOST_CHECK_EQUAL(std::accumulate(std::begin(histogram), std::end(histogram), 0u), stats.rollouts);
+}
@@ -7,6 +7,7 @@
 #include <AIToolbox/MDP/Model.hpp>
 
 #include "Utils/CornerProblem.hpp"
+#include "Utils/BatchModel.hpp"
 
 BOOST_AUTO_TEST_CASE( escapeToCorners ) {
     using namespace AIToolbox::MDP;
@@ -75,6 +76,32 @@ BOOST_AUTO_TEST_CASE( escapeToCorners ) {
     BOOST_CHECK_EQUAL( solver.sampleAction(14,10), RIGHT);
 }
 
+template <typename Bonus>
+void checkStraightCorners(const double exploration) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS<decltype(model), Bonus> solver(model, 10000, exploration);
+
+    // See escapeToCorners; these cells have a single best action.
+    BOOST_CHECK_EQUAL( solver.sampleAction(1,10), LEFT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(2,10), LEFT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(4,10), UP);
+    BOOST_CHECK_EQUAL( solver.sampleAction(8,10), UP);
+    BOOST_CHECK_EQUAL( solver.sampleAction(7, 10), DOWN);
+    BOOST_CHECK_EQUAL( solver.sampleAction(11,10), DOWN);
+    BOOST_CHECK_EQUAL( solver.sampleAction(13,10), RIGHT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(14,10), RIGHT);
+}
+
+BOOST_AUTO_TEST_CASE( otherBonuses ) {
+    checkStraightCorners<AIToolbox::PUCT>(5.0);
+    checkStraightCorners<AIToolbox::UCBTuned>(5.0);
+}
+
 BOOST_AUTO_TEST_CASE( sampleOneTime ) {
     using namespace AIToolbox::MDP;
 
@@ -96,9 +123,292 @@ BOOST_AUTO_TEST_CASE( sampleOneTime ) {
 
     auto & graph_ = solver.getGraph();
     // We find the leaf we just produced
-    auto it = graph_.children[0].children.begin();
-    auto s1 = it->first;
+    size_t s1 = 0;
+    unsigned leaves = 0;
+    graph_.forEachChild(graph_.getRoot(), 0, [&](size_t key, auto){ s1 = key; ++leaves; });
+    BOOST_CHECK_EQUAL(leaves, 1);
 
     // We make a,o the new head
     solver.sampleAction( 0, s1, horizon - 1);
 }
+
+BOOST_AUTO_TEST_CASE( treeReuse ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 1000, 5.0);
+
+    const auto a = solver.sampleAction(6, 10);
+
+    // We find the most visited successor of the chosen action.
+    const auto & graph_ = solver.getGraph();
+    size_t s1 = 0;
+    unsigned visits = 0;
+    graph_.forEachChild(graph_.getRoot(), a, [&](size_t key, auto child) {
+        if ( graph_.getNode(child).N > visits ) {
+            visits = graph_.getNode(child).N;
+            s1 = key;
+        }
+    });
+    BOOST_REQUIRE(visits > 0);
+
+    // The statistics of the subtree are kept, and new rollouts added.
+    solver.setIterations(500);
+    solver.sampleAction(a, s1, 9);
+    BOOST_CHECK_EQUAL(graph_.getNode(graph_.getRoot()).N, visits + 500);
+}
+
+BOOST_AUTO_TEST_CASE( timeBudget ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 10000, 5.0);
+
+    solver.sampleAction(1, 10);
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().rollouts, 10000);
+
+    // The number of iterations is ignored.
+    solver.setIterations(1);
+    BOOST_CHECK_EQUAL( solver.sampleAction(1, 10, std::chrono::milliseconds(50)), LEFT);
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.rollouts > 1);
+    BOOST_CHECK_EQUAL(stats.rollouts % AIToolbox::SearchDeadline::CheckInterval, 0);
+    BOOST_CHECK(stats.nodesAdded > 0);
+    BOOST_CHECK(stats.maxDepth > 0 && stats.maxDepth < 10);
+
+    // Even without time, we do some work.
+    solver.sampleAction(1, 10, std::chrono::seconds(0));
+    BOOST_CHECK_EQUAL(stats.rollouts, AIToolbox::SearchDeadline::CheckInterval);
+
+    // The tree can be reused with budgets too.
+    const auto & graph = solver.getGraph();
+    size_t s1 = 0;
+    graph.forEachChild(graph.getRoot(), LEFT, [&](size_t key, auto){ s1 = key; });
+    solver.sampleAction(LEFT, s1, 9, std::chrono::milliseconds(5));
+    BOOST_CHECK(stats.rollouts > 0);
+}
+
+BOOST_AUTO_TEST_CASE( searchStatistics ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 1000, 5.0);
+    solver.sampleAction(6, 10);
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK_EQUAL(stats.nodes, solver.getGraph().size());
+    BOOST_CHECK_EQUAL(stats.memoryUsage, solver.getGraph().getMemoryUsage());
+    BOOST_CHECK(stats.memoryUsage > 0);
+    BOOST_CHECK(stats.elapsed.count() > 0);
+    BOOST_CHECK(stats.getRolloutsPerSecond() > 0.0);
+
+    // Without profiling, no timers are collected.
+    BOOST_CHECK_EQUAL(stats.selectionTime.count(), 0);
+    BOOST_CHECK_EQUAL(stats.rolloutTime.count(), 0);
+    BOOST_CHECK(stats.depthHistogram.empty());
+}
+
+BOOST_AUTO_TEST_CASE( batchedLeafEvaluation ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    unsigned iterations = 1000, calls = 0;
+    size_t evaluated = 0;
+
+    MCTS solver(model, iterations, 5.0);
+    solver.setLeafEvaluator([&](const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values) {
+        ++calls;
+        evaluated += states.size();
+        BOOST_CHECK(states.size() <= 256);
+        BOOST_CHECK_EQUAL(states.size(), horizons.size());
+        BOOST_CHECK_EQUAL(states.size(), values.size());
+        for ( size_t i = 0; i < states.size(); ++i ) {
+            BOOST_CHECK(horizons[i] > 0 && horizons[i] < 10);
+            values[i] = 0.0;
+        }
+    }, 256);
+    BOOST_CHECK_EQUAL(solver.getLeafBatchSize(), 256);
+
+    BOOST_CHECK_EQUAL( solver.sampleAction(1,10), LEFT);
+
+    // Every new leaf is evaluated exactly once, and the queued visits
+    // have been replaced by the actual ones.
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK_EQUAL(evaluated, stats.nodesAdded);
+    BOOST_CHECK(calls >= 4);
+
+    const auto & graph = solver.getGraph();
+    unsigned visits = 0;
+    for ( size_t a = 0; a < model.getA(); ++a )
+        visits += graph.getAction(graph.getRoot(), a).N;
+    BOOST_CHECK_EQUAL(visits, iterations);
+    BOOST_CHECK_EQUAL(graph.getNode(graph.getRoot()).N, iterations);
+
+    BOOST_CHECK_EQUAL( solver.sampleAction(4,10), UP);
+
+    // Removing the evaluator restores rollouts.
+    solver.setLeafEvaluator({}, 1);
+    calls = 0;
+    BOOST_CHECK_EQUAL( solver.sampleAction(2,10), LEFT);
+    BOOST_CHECK_EQUAL(calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE( rolloutCache ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 10000, 5.0);
+    BOOST_CHECK(!solver.getRolloutCache().isEnabled());
+
+    solver.setRolloutCache(AIToolbox::RolloutCache(1000, 0.99, 5.0), 2);
+    BOOST_CHECK(solver.getRolloutCache().isEnabled());
+    BOOST_CHECK_EQUAL(solver.getRolloutCacheDepthBucket(), 2);
+
+    // The grid has few states, so most rollouts are answered by the cache,
+    // while the policy stays the same.
+    BOOST_CHECK_EQUAL( solver.sampleAction(1, 10), LEFT);
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.rolloutCacheHits > 0);
+    BOOST_CHECK(stats.rolloutCacheHits < stats.nodesAdded);
+    BOOST_CHECK(solver.getRolloutCache().size() <= 1000);
+
+    BOOST_CHECK_EQUAL( solver.sampleAction(4, 10), UP);
+
+    // Disabling the cache restores rollouts.
+    solver.setRolloutCache(AIToolbox::RolloutCache());
+    solver.sampleAction(1, 10);
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().rolloutCacheHits, 0);
+}
+
+BOOST_AUTO_TEST_CASE( transpositions ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    MCTS solver(model, 10000, 5.0);
+    BOOST_CHECK(!solver.getTranspositionTable().isEnabled());
+
+    solver.sampleAction(6, 10);
+    const auto treeNodes = solver.getSearchStatistics().nodes;
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().transpositions, 0);
+
+    // Paths to the same state at the same depth share their node, so the
+    // graph is much smaller than the tree, while the policy stays the same.
+    solver.setTranspositionTable(AIToolbox::TranspositionTable(1000));
+    BOOST_CHECK(solver.getTranspositionTable().isEnabled());
+    BOOST_CHECK_EQUAL(solver.getTranspositionTable().getSize(), 1024);
+    BOOST_CHECK(solver.getTranspositionUsesDepth());
+
+    BOOST_CHECK_EQUAL( solver.sampleAction(1, 10), LEFT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(4, 10), UP);
+    BOOST_CHECK_EQUAL( solver.sampleAction(14, 10), RIGHT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(11, 10), DOWN);
+
+    solver.sampleAction(6, 10);
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.transpositions > 0);
+    BOOST_CHECK(stats.nodes < treeNodes);
+    // With 16 states and 10 depths there cannot be more nodes.
+    BOOST_CHECK(stats.nodes <= 16 * 10);
+
+    // Keying on the state alone merges all depths.
+    solver.setTranspositionTable(AIToolbox::TranspositionTable(64), false);
+    BOOST_CHECK_EQUAL( solver.sampleAction(1, 10), LEFT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(4, 10), UP);
+    BOOST_CHECK(solver.getSearchStatistics().nodes <= 16);
+
+    // Reusing the graph keeps the shared nodes.
+    const auto a = solver.sampleAction(6, 10);
+    const auto & graph = solver.getGraph();
+    size_t s1 = 0;
+    unsigned visits = 0;
+    graph.forEachChild(graph.getRoot(), a, [&](size_t key, auto child) {
+        if ( graph.getNode(child).N > visits ) {
+            visits = graph.getNode(child).N;
+            s1 = key;
+        }
+    });
+    BOOST_REQUIRE(visits > 0);
+    solver.setIterations(500);
+    solver.sampleAction(a, s1, 9);
+    BOOST_CHECK(graph.getNode(graph.getRoot()).N >= visits + 500);
+}
+
+BOOST_AUTO_TEST_CASE( memoryLimit ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(8,8);
+
+    auto model = makeCornerProblem(grid);
+
+    MCTS unlimited(model, 5000, 5.0);
+    unlimited.sampleAction(27, 20);
+    const auto fullMemory = unlimited.getGraph().getUsedMemory();
+    BOOST_CHECK_EQUAL(unlimited.getMaxMemory(), 0);
+    BOOST_CHECK_EQUAL(unlimited.getSearchStatistics().memoryLimited, 0);
+
+    MCTS solver(model, 5000, 5.0);
+    const auto limit = fullMemory / 4;
+    solver.setMaxMemory(limit);
+    BOOST_CHECK_EQUAL(solver.getMaxMemory(), limit);
+
+    const auto a = solver.sampleAction(27, 20);
+    BOOST_CHECK(a < model.getA());
+
+    // The tree stops growing once it reaches the limit; the last node
+    // added may exceed it by the size of a single expansion.
+    const auto & graph = solver.getGraph();
+    BOOST_CHECK(graph.getUsedMemory() < limit + limit / 10);
+    BOOST_CHECK(graph.size() < unlimited.getGraph().size());
+    BOOST_CHECK(solver.getSearchStatistics().memoryLimited > 0);
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().rollouts, 5000);
+
+    // Reusing the tree keeps the subtree within the same limit.
+    solver.sampleAction(a, 27, 19);
+    BOOST_CHECK(solver.getGraph().getUsedMemory() < limit + limit / 10);
+}
+
+BOOST_AUTO_TEST_CASE( batchedRollouts ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    const auto model = makeCornerProblem(grid);
+    const BatchModel batchModel(model);
+    static_assert(is_generative_model_batch_v<BatchModel<Model>>);
+
+    unsigned iterations = 1000;
+    MCTS solver(batchModel, iterations, 5.0);
+
+    // Without queueing, rollouts are performed one at a time.
+    BOOST_CHECK_EQUAL( solver.sampleAction(1,10), LEFT);
+    BOOST_CHECK_EQUAL(batchModel.batches, 0);
+
+    solver.setLeafEvaluator({}, 64);
+    BOOST_CHECK_EQUAL( solver.sampleAction(1,10), LEFT);
+    BOOST_CHECK(batchModel.batches > 0);
+    // Each batch advances all running rollouts by one step.
+    BOOST_CHECK(batchModel.samples > batchModel.batches);
+
+    const auto & graph = solver.getGraph();
+    unsigned visits = 0;
+    for ( size_t a = 0; a < model.getA(); ++a )
+        visits += graph.getAction(graph.getRoot(), a).N;
+    BOOST_CHECK_EQUAL(visits, iterations);
+
+    BOOST_CHECK_EQUAL( solver.sampleAction(4,10), UP);
+}
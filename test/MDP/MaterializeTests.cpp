@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE MDP_Materialize
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Materialize.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+#include "Utils/OldMDPModel.hpp"
+
+#include <type_traits>
+
+BOOST_AUTO_TEST_CASE( density ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+
+    const auto S = model.getS(), A = model.getA();
+
+    size_t nonZeros = 0;
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+            for ( size_t s1 = 0; s1 < S; ++s1 )
+                if ( model.getTransitionProbability(s, a, s1) != 0.0 ) ++nonZeros;
+
+    const double density = static_cast<double>(nonZeros) / (S * A * S);
+
+    BOOST_CHECK_EQUAL( computeTransitionDensity(model), density );
+    BOOST_CHECK_EQUAL( computeTransitionDensity(sparseModel), density );
+    BOOST_CHECK_EQUAL( computeTransitionDensity(oldModel), density );
+}
+
+BOOST_AUTO_TEST_CASE( snapshotType ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+
+    const auto getType = [](const auto & m) {
+        using T = std::remove_cv_t<std::remove_reference_t<decltype(m)>>;
+        if constexpr (std::is_same_v<T, Model>) return 0;
+        else if constexpr (std::is_same_v<T, SparseModel>) return 1;
+        else return 2;
+    };
+
+    // Eigen models are passed as they are.
+    BOOST_CHECK_EQUAL( withEigenModel(model, getType, 0.0), 0 );
+
+    // The corner problem has at most two successors per state-action pair, out of 16.
+    BOOST_CHECK_EQUAL( withEigenModel(oldModel, getType, 0.125), 1 );
+    BOOST_CHECK_EQUAL( withEigenModel(oldModel, getType, 0.0), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( solving ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+
+    ValueIteration solver(1000000, 0.001);
+    const auto [bound, vfun, qfun] = solver(model);
+
+    for ( const double maxDensity : {0.0, 1.0} ) {
+        const auto [mBound, mVFun, mQFun] = withEigenModel(oldModel, [&](const auto & m) {
+            static_assert(is_model_eigen_v<std::remove_cv_t<std::remove_reference_t<decltype(m)>>>);
+            return solver(m);
+        }, maxDensity);
+
+        BOOST_CHECK_CLOSE( bound, mBound, 0.0001 );
+        BOOST_CHECK( vfun.actions == mVFun.actions );
+        for ( size_t s = 0; s < model.getS(); ++s )
+            BOOST_CHECK_CLOSE( vfun.values[s], mVFun.values[s], 0.0001 );
+    }
+}
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE MDP_MinimizedModel
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/MinimizedModel.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+#include "Utils/OldMDPModel.hpp"
+
+namespace aim = AIToolbox::MDP;
+
+// A corridor of N states; each can move left or right, the ends are
+// absorbing and give a reward when entered. States at the same distance
+// from the nearest end only differ in the direction of their actions.
+aim::SparseModel makeCorridor(const size_t N) {
+    const size_t A = 2;
+    aim::SparseModel::TransitionMatrix t(A, AIToolbox::SparseMatrix2D(N, N));
+    aim::SparseModel::RewardMatrix r(N, A);
+    for (size_t s = 0; s < N; ++s) {
+        if (s == 0 || s == N - 1) {
+            t[0].insert(s, s) = 1.0;
+            t[1].insert(s, s) = 1.0;
+            continue;
+        }
+        t[0].insert(s, s - 1) = 1.0;
+        t[1].insert(s, s + 1) = 1.0;
+        if (s == 1) r.insert(s, 0) = 1.0;
+        if (s == N - 2) r.insert(s, 1) = 1.0;
+    }
+    for (auto & m : t) m.makeCompressed();
+    r.makeCompressed();
+    return aim::SparseModel(AIToolbox::NO_CHECK, N, A, std::move(t), std::move(r), 0.9);
+}
+
+// Two copies of the input model which do not communicate.
+aim::SparseModel makeDoubleModel(const aim::Model & model) {
+    const auto S = model.getS(), A = model.getA();
+
+    aim::SparseModel::TransitionMatrix t(A, AIToolbox::SparseMatrix2D(2*S, 2*S));
+    aim::SparseModel::RewardMatrix r(2*S, A);
+    for (size_t a = 0; a < A; ++a) {
+        for (size_t s = 0; s < S; ++s) {
+            for (size_t s1 = 0; s1 < S; ++s1) {
+                const double p = model.getTransitionProbability(s, a, s1);
+                if (p == 0.0) continue;
+                t[a].insert(s, s1) = p;
+                t[a].insert(S + s, S + s1) = p;
+            }
+            const double rew = model.getRewardFunction()(s, a);
+            if (rew == 0.0) continue;
+            r.insert(s, a) = rew;
+            r.insert(S + s, a) = rew;
+        }
+        t[a].makeCompressed();
+    }
+    r.makeCompressed();
+    return aim::SparseModel(AIToolbox::NO_CHECK, 2*S, A, std::move(t), std::move(r), model.getDiscount());
+}
+
+BOOST_AUTO_TEST_CASE( copiesAreMerged ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 0.9);
+    const auto doubleModel = makeDoubleModel(model);
+    const auto S = model.getS();
+
+    const auto blocks = aim::computeBisimulation(doubleModel);
+    BOOST_CHECK_EQUAL(blocks.size(), 2*S);
+    for (size_t s = 0; s < S; ++s)
+        BOOST_CHECK_EQUAL(blocks[s], blocks[S + s]);
+
+    // The copy adds no blocks.
+    aim::MinimizedModel minimized(doubleModel);
+    BOOST_CHECK_EQUAL(minimized.getModel().getS(), aim::MinimizedModel(model).getModel().getS());
+    BOOST_CHECK_EQUAL(minimized.getOriginalS(), 2*S);
+
+    // Non-eigen models give the same partition.
+    OldMDPModel oldModel = makeCornerProblem(grid, 0.9);
+    BOOST_CHECK(aim::computeBisimulation(oldModel) == aim::computeBisimulation(model));
+
+    BOOST_CHECK_THROW(aim::computeBisimulation(model, 0.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( solveMinimized ) {
+    const size_t N = 11;
+    const auto model = makeCorridor(N);
+
+    aim::MinimizedModel minimized(model);
+    const auto & small = minimized.getModel();
+
+    // Left and right halves are not bisimilar, as actions are not
+    // permuted; but the absorbing ends are.
+    BOOST_CHECK(small.getS() < N);
+    BOOST_CHECK_EQUAL(minimized.getBlock(0), minimized.getBlock(N - 1));
+    BOOST_CHECK_EQUAL(minimized.getRepresentatives().front(), 0);
+    for (size_t b = 0; b < small.getS(); ++b)
+        BOOST_CHECK_EQUAL(minimized.getBlock(minimized.getRepresentatives()[b]), b);
+
+    aim::ValueIteration vi(1000000, 1e-9);
+    const auto [bound, vf, q] = vi(model);
+    const auto [mbound, mvf, mq] = vi(small);
+    (void)bound; (void)mbound;
+
+    const auto fullVf = minimized.expand(mvf);
+    const auto fullQ = minimized.expand(mq);
+    for (size_t s = 0; s < N; ++s) {
+        BOOST_CHECK_SMALL(fullVf.values[s] - vf.values[s], 1e-6);
+        for (size_t a = 0; a < model.getA(); ++a)
+            BOOST_CHECK_SMALL(fullQ(s, a) - q(s, a), 1e-6);
+    }
+
+    const auto back = minimized.compact(fullVf);
+    BOOST_CHECK(back.values == mvf.values);
+    BOOST_CHECK(back.actions == mvf.actions);
+
+    BOOST_CHECK_THROW(minimized.expand(aim::ValueFunction(aim::Values::Zero(N), aim::Actions(N))), std::invalid_argument);
+    BOOST_CHECK_THROW(minimized.compact(mvf), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( approximate ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 0.9);
+    const auto doubleModel = makeDoubleModel(model);
+    const auto S = model.getS(), A = model.getA();
+
+    // Slightly perturb the rewards of the second copy.
+    aim::SparseModel::TransitionMatrix t(A);
+    for (size_t a = 0; a < A; ++a) t[a] = doubleModel.getTransitionFunction(a);
+    aim::SparseModel::RewardMatrix r = doubleModel.getRewardFunction();
+    for (size_t s = S; s < 2*S; ++s)
+        r.coeffRef(s, 0) += 1e-4;
+    const aim::SparseModel perturbed(AIToolbox::NO_CHECK, 2*S, A, std::move(t), std::move(r), 0.9);
+
+    aim::MinimizedModel exact(perturbed);
+    aim::MinimizedModel coarse(perturbed, 1e-2);
+    BOOST_CHECK(coarse.getModel().getS() < exact.getModel().getS());
+
+    aim::ValueIteration vi(1000000, 1e-9);
+    const auto [bound, vf, q] = vi(perturbed);
+    const auto [cbound, cvf, cq] = vi(coarse.getModel());
+    (void)bound; (void)cbound; (void)q; (void)cq;
+
+    const auto fullVf = coarse.expand(cvf);
+    for (size_t s = 0; s < 2*S; ++s)
+        BOOST_CHECK_SMALL(fullVf.values[s] - vf.values[s], 1e-2);
+}
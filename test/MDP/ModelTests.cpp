@@ -9,6 +9,7 @@
 #include "Utils/CornerProblem.hpp"
 
 #include <fstream>
+#include <sstream>
 
 BOOST_AUTO_TEST_CASE( eigen_model ) {
     BOOST_CHECK(AIToolbox::MDP::is_model_eigen_v<AIToolbox::MDP::Model>);
@@ -124,3 +125,128 @@ BOOST_AUTO_TEST_CASE( cassandraCorner ) {
         BOOST_CHECK(AIToolbox::checkEqualGeneral(m.getExpectedReward(s, a, s1), m2.getExpectedReward(s, a, s1)));
     }
 }
+
+BOOST_AUTO_TEST_CASE( cassandraOverrides ) {
+    // Later entries overwrite earlier ones, wildcards included, and the
+    // preamble may come after the entries.
+    std::istringstream input(
+        "T: * : * : * 0.0\n"
+        "T: * : * : 0 1.0\n"
+        "T: right : s0\n"
+        "0.0 1.0 \n"
+        "T: right : s1 : s1 1.0\n"
+        "T: right : s1 : s0 0\n"
+        "R: * : * : * : * -1\n"
+        "R: right : s0 : s1 : * +2.5\n"
+        "\n"
+        "states: s0 s1\n"
+        "actions: left right\n"
+        "discount: 0.5\n"
+    );
+
+    auto m = AIToolbox::MDP::parseCassandra(input);
+
+    BOOST_CHECK_EQUAL(m.getS(), 2);
+    BOOST_CHECK_EQUAL(m.getA(), 2);
+    BOOST_CHECK_EQUAL(m.getDiscount(), 0.5);
+
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0, 0, 0), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(1, 0, 0), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(0, 1, 1), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(1, 1, 1), 1.0);
+    BOOST_CHECK_EQUAL(m.getTransitionProbability(1, 1, 0), 0.0);
+
+    BOOST_CHECK_EQUAL(m.getExpectedReward(0, 0, 0), -1.0);
+    BOOST_CHECK_EQUAL(m.getExpectedReward(0, 1, 1), 2.5);
+    BOOST_CHECK_EQUAL(m.getExpectedReward(1, 1, 1), -1.0);
+
+    std::istringstream invalid(
+        "states: 2\n"
+        "actions: 1\n"
+        "T: 0 : 0 : 1 0.5\n"
+        "T: 0 : 1 : 1 1.0\n"
+    );
+    BOOST_CHECK_THROW(AIToolbox::MDP::parseCassandra(invalid), std::invalid_argument);
+
+    std::istringstream malformed(
+        "states: 2\n"
+        "actions: 1\n"
+        "T: 0 : 0 : 1 0.5x\n"
+    );
+    BOOST_CHECK_THROW(AIToolbox::MDP::parseCassandra(malformed), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( float_model ) {
+    using namespace AIToolbox::MDP;
+
+    BOOST_CHECK(is_model_eigen_v<FloatModel>);
+
+    GridWorld grid(4, 4);
+
+    auto model = makeCornerProblem(grid);
+    size_t S = model.getS(), A = model.getA();
+
+    FloatModel copy(model);
+
+    BOOST_CHECK_EQUAL(model.getDiscount(), copy.getDiscount());
+    BOOST_CHECK_EQUAL(S, copy.getS());
+    BOOST_CHECK_EQUAL(A, copy.getA());
+
+    for ( size_t s = 0; s < S; ++s ) {
+        BOOST_CHECK_EQUAL(model.isTerminal(s), copy.isTerminal(s));
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(static_cast<float>(model.getTransitionProbability(s, a, s1)), copy.getTransitionProbability(s, a, s1));
+                BOOST_CHECK_EQUAL(model.getExpectedReward(s, a, s1), copy.getExpectedReward(s, a, s1));
+            }
+        }
+    }
+
+    for ( size_t i = 0; i < 100; ++i ) {
+        const auto [s1, r] = copy.sampleSR(5, 0);
+        BOOST_CHECK(s1 < S);
+        BOOST_CHECK_EQUAL(r, copy.getExpectedReward(5, 0, s1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( alias_sampling ) {
+    using namespace AIToolbox::MDP;
+
+    const size_t S = 4, A = 2;
+    Model m(S, A);
+
+    BOOST_CHECK(!m.getAliasSampling());
+    m.setAliasSampling(true);
+    BOOST_CHECK(m.getAliasSampling());
+
+    // The identity transitions are sampled correctly.
+    for ( size_t s = 0; s < S; ++s )
+        BOOST_CHECK_EQUAL(std::get<0>(m.sampleSR(s, 1)), s);
+
+    // Setting a new transition function rebuilds the samplers.
+    AIToolbox::Matrix3D t(A, AIToolbox::Matrix2D(S, S));
+    for ( size_t a = 0; a < A; ++a ) {
+        t[a].setZero();
+        for ( size_t s = 0; s < S; ++s ) {
+            t[a](s, 0) = 0.1;
+            t[a](s, 2) = 0.3;
+            t[a](s, 3) = 0.6;
+        }
+    }
+    m.setTransitionFunction(t);
+
+    constexpr size_t trials = 100'000;
+    std::vector<size_t> counters(S);
+    for ( size_t i = 0; i < trials; ++i )
+        ++counters[std::get<0>(m.sampleSR(1, 1))];
+
+    BOOST_CHECK_EQUAL(counters[1], 0);
+    for ( auto s1 : {0, 2, 3} ) {
+        const auto exactAmount = t[1](1, s1) * trials;
+        BOOST_CHECK(std::abs(counters[s1] - exactAmount) < 0.05 * exactAmount);
+    }
+
+    m.setAliasSampling(false);
+    BOOST_CHECK(!m.getAliasSampling());
+    BOOST_CHECK(std::get<0>(m.sampleSR(1, 1)) != 1);
+}
@@ -88,3 +88,25 @@ BOOST_AUTO_TEST_CASE( matching_pennies ) {
     BOOST_CHECK(policy.getActionProbability(0,0) < 0.6);
     BOOST_CHECK(policy.getActionProbability(0,0) > 0.4);
 }
+
+BOOST_AUTO_TEST_CASE( views_and_dirty_states ) {
+    using namespace AIToolbox;
+    constexpr size_t S = 3, A = 2;
+
+    auto q = MDP::makeQFunction(S, A);
+    q.row(2) << 0.0, 1.0;
+
+    MDP::PGAAPPPolicy policy(q, 0.1);
+    const auto & current = policy.getPolicyMatrix();
+
+    policy.stepUpdateP(2);
+    policy.stepUpdateP(0);
+    policy.stepUpdateP(2);
+
+    BOOST_CHECK((policy.getDirtyStates() == MDP::PGAAPPPolicy::DirtyStates{2, 0}));
+    BOOST_CHECK(current == policy.getPolicy());
+    BOOST_CHECK(current(2, 1) > 0.5);
+
+    policy.clearDirtyStates();
+    BOOST_CHECK(policy.getDirtyStates().empty());
+}
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE MDP_ParallelMCTS
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Algorithms/ParallelMCTS.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+template <typename M>
+void checkCorners(AIToolbox::MDP::ParallelMCTS<M> & solver) {
+    using namespace AIToolbox::MDP;
+
+    // See MCTSTests for the expected solution of the problem.
+
+    // Middle top cells want to go left to the absorbing state:
+    BOOST_CHECK_EQUAL( solver.sampleAction(1,10), LEFT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(2,10), LEFT);
+
+    // Middle cells of first column want to go up
+    BOOST_CHECK_EQUAL( solver.sampleAction(4,10), UP);
+    BOOST_CHECK_EQUAL( solver.sampleAction(8,10), UP);
+
+    // Cell in 1,1 wants left + up
+    auto a = solver.sampleAction(5,10);
+    BOOST_CHECK( a == LEFT || a == UP );
+
+    // Middle cells of last column want to go down
+    BOOST_CHECK_EQUAL( solver.sampleAction(7, 10), DOWN);
+    BOOST_CHECK_EQUAL( solver.sampleAction(11,10), DOWN);
+
+    // Cell in 2,2 wants right + down
+    a = solver.sampleAction(10,10);
+    BOOST_CHECK( a == RIGHT || a == DOWN );
+
+    // Finally, bottom middle cells want just right
+    BOOST_CHECK_EQUAL( solver.sampleAction(13,10), RIGHT);
+    BOOST_CHECK_EQUAL( solver.sampleAction(14,10), RIGHT);
+}
+
+template <typename M>
+unsigned countRootVisits(const typename AIToolbox::MDP::ParallelMCTS<M>::StateNode & sn) {
+    unsigned visits = 0;
+    for ( const auto & an : sn.children ) {
+        visits += an.N;
+        BOOST_CHECK_EQUAL(an.pending, 0);
+    }
+    return visits;
+}
+
+BOOST_AUTO_TEST_CASE( escapeToCornersSerial ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    ParallelMCTS solver(model, 10000, 5.0);
+    BOOST_CHECK(!solver.getThreadPool());
+
+    checkCorners(solver);
+}
+
+BOOST_AUTO_TEST_CASE( escapeToCornersTree ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    AIToolbox::ThreadPool pool(4);
+    ParallelMCTS solver(model, 10000, 5.0, ParallelMCTS<Model>::Mode::Tree, &pool);
+
+    checkCorners(solver);
+
+    // All rollouts have been backed up, and all virtual losses removed.
+    solver.sampleAction(5, 10);
+    BOOST_CHECK_EQUAL(solver.getGraph().N, 10000);
+    BOOST_CHECK_EQUAL(countRootVisits<Model>(solver.getGraph()), 10000);
+}
+
+BOOST_AUTO_TEST_CASE( escapeToCornersRoot ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    AIToolbox::ThreadPool pool(4);
+    ParallelMCTS solver(model, 10000, 5.0, ParallelMCTS<Model>::Mode::Root, &pool);
+
+    checkCorners(solver);
+
+    // The merged root contains the rollouts of all trees.
+    solver.sampleAction(5, 10);
+    BOOST_CHECK_EQUAL(solver.getGraph().N, 10000);
+    BOOST_CHECK_EQUAL(countRootVisits<Model>(solver.getGraph()), 10000);
+}
+
+BOOST_AUTO_TEST_CASE( treeReuse ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+
+    AIToolbox::ThreadPool pool(4);
+    for ( auto mode : {ParallelMCTS<SparseModel>::Mode::Tree, ParallelMCTS<SparseModel>::Mode::Root} ) {
+        ParallelMCTS solver(sparseModel, 1000, 5.0, mode, &pool);
+
+        solver.sampleAction(6, 5);
+        // We reuse the tree for all possible branches, existing or not.
+        for ( size_t s1 = 0; s1 < model.getS(); ++s1 ) {
+            solver.sampleAction(6, 5);
+            solver.sampleAction(LEFT, s1, 4);
+            BOOST_CHECK(solver.getGraph().N >= 1000);
+        }
+        // Changing the pool resets the graph.
+        solver.setThreadPool(nullptr);
+        BOOST_CHECK_EQUAL(solver.getGraph().N, 0);
+        BOOST_CHECK_EQUAL( solver.sampleAction(13, 10), RIGHT);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( reproducibleRoot ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4,4);
+    auto model = makeCornerProblem(grid);
+
+    AIToolbox::ThreadPool pool(4);
+
+    const auto search = [&]{
+        AIToolbox::Impl::Seeder::setRootSeed(12345);
+        ParallelMCTS solver(model, 2000, 5.0, ParallelMCTS<Model>::Mode::Root, &pool);
+        solver.sampleAction(5, 10);
+        solver.sampleAction(LEFT, 4, 9);
+
+        std::vector<double> values;
+        for ( const auto & an : solver.getGraph().children )
+            values.push_back(an.V);
+        return values;
+    };
+
+    // With root parallelism each worker uses its own stream, so the
+    // results only depend on the seed.
+    BOOST_CHECK(search() == search());
+}
@@ -6,6 +6,9 @@
 #include <AIToolbox/MDP/Algorithms/Utils/PolicyEvaluation.hpp>
 #include <AIToolbox/MDP/Policies/Policy.hpp>
 #include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/FusedSparseModel.hpp>
+#include <AIToolbox/MDP/Policies/PolicyWrapper.hpp>
 
 #include "Utils/CornerProblem.hpp"
 #include "Utils/OldMDPModel.hpp"
@@ -74,3 +77,127 @@ BOOST_AUTO_TEST_CASE( escapeToCorners ) {
     solution = ev(randomPolicy);
     checkSolution(truthHorizon10, std::get<1>(solution));
 }
+
+BOOST_AUTO_TEST_CASE( floatModel ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid, 1.0);
+    model.setDiscount(1.0);
+    FloatModel floatModel(model);
+    size_t S = model.getS(), A = model.getA();
+
+    Policy randomPolicy(S, A);
+
+    PolicyEvaluation ev(model, 10, 0.0);
+    PolicyEvaluation fev(floatModel, 10, 0.0);
+
+    const auto values = std::get<1>(ev(randomPolicy));
+    const auto fValues = std::get<1>(fev(randomPolicy));
+
+    for (size_t s = 0; s < S; ++s)
+        BOOST_CHECK_SMALL(values[s] - fValues[s], 0.0001);
+}
+
+BOOST_AUTO_TEST_CASE( parallelMatchesSerial ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid, 0.9);
+    OldMDPModel oldModel = makeCornerProblem(grid, 0.9);
+    size_t S = model.getS(), A = model.getA();
+
+    Policy randomPolicy(S, A);
+    AIToolbox::ThreadPool pool(3);
+
+    const auto check = [&](const auto & m) {
+        PolicyEvaluation ev(m, 1000, 0.0001);
+        BOOST_CHECK(ev.getThreadPool() == nullptr);
+        const auto [bound, values, qfun] = ev(randomPolicy);
+
+        ev.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(ev.getThreadPool(), &pool);
+        const auto [pBound, pValues, pQFun] = ev(randomPolicy);
+
+        BOOST_CHECK_EQUAL(bound, pBound);
+        BOOST_CHECK(values == pValues);
+        BOOST_CHECK(qfun == pQFun);
+    };
+
+    check(model);
+    check(oldModel);
+}
+
+BOOST_AUTO_TEST_CASE( manyPolicies ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid, 0.9);
+    SparseModel sparseModel(model);
+    FusedSparseModel fusedModel(model);
+    OldMDPModel oldModel = makeCornerProblem(grid, 0.9);
+    size_t S = model.getS(), A = model.getA();
+
+    // A few stochastic and deterministic policies.
+    std::vector<AIToolbox::Matrix2D> matrices;
+    std::vector<Actions> actions;
+    for (size_t k = 0; k < 7; ++k) {
+        Actions acts(S);
+        AIToolbox::Matrix2D m(S, A);
+        m.setZero();
+        for (size_t s = 0; s < S; ++s) {
+            acts[s] = (s + k) % A;
+            m(s, acts[s]) = 1.0;
+        }
+        actions.push_back(std::move(acts));
+        matrices.push_back(m);
+    }
+    matrices.push_back(Policy(S, A).getPolicyMatrix());
+
+    AIToolbox::ThreadPool pool(3);
+
+    const auto check = [&](const auto & m) {
+        PolicyEvaluation ev(m, 1000, 0.0001);
+        const auto fromMatrices = ev(matrices);
+        const auto fromActions = ev(actions);
+        BOOST_REQUIRE_EQUAL(fromMatrices.size(), matrices.size());
+        BOOST_REQUIRE_EQUAL(fromActions.size(), actions.size());
+
+        ev.setThreadPool(&pool);
+        const auto parallel = ev(matrices);
+        ev.setThreadPool(nullptr);
+
+        for (size_t k = 0; k < matrices.size(); ++k) {
+            const auto [bound, values, qfun] = ev(PolicyWrapper(matrices[k]));
+            const auto & [mBound, mValues, mQFun] = fromMatrices[k];
+            const auto & [pBound, pValues, pQFun] = parallel[k];
+
+            BOOST_CHECK_SMALL(bound - mBound, 1e-9);
+            BOOST_CHECK(values.isApprox(mValues, 1e-9));
+            BOOST_CHECK(qfun.isApprox(mQFun, 1e-9));
+            BOOST_CHECK(pValues.isApprox(mValues, 1e-9));
+            BOOST_CHECK(pQFun.isApprox(mQFun, 1e-9));
+
+            if (k < actions.size()) {
+                const auto & [aBound, aValues, aQFun] = fromActions[k];
+                BOOST_CHECK_SMALL(aBound - mBound, 1e-9);
+                BOOST_CHECK(aValues.isApprox(mValues, 1e-9));
+                BOOST_CHECK(aQFun.isApprox(mQFun, 1e-9));
+            }
+        }
+    };
+
+    check(model);
+    check(sparseModel);
+    check(fusedModel);
+    check(oldModel);
+
+    PolicyEvaluation ev(model, 10);
+    BOOST_CHECK(ev(std::vector<AIToolbox::Matrix2D>{}).empty());
+    BOOST_CHECK_THROW(ev(std::vector<AIToolbox::Matrix2D>{AIToolbox::Matrix2D(S, A + 1)}), std::invalid_argument);
+    BOOST_CHECK_THROW(ev(std::vector<Actions>{Actions(S - 1)}), std::invalid_argument);
+    BOOST_CHECK_THROW(ev(std::vector<Actions>{Actions(S, A)}), std::invalid_argument);
+}
@@ -91,3 +91,74 @@ BOOST_AUTO_TEST_CASE( escapeToCorners ) {
     BOOST_CHECK_EQUAL( policy.getActionProbability(13, RIGHT), 1.0);
     BOOST_CHECK_EQUAL( policy.getActionProbability(14, RIGHT), 1.0);
 }
+
+BOOST_AUTO_TEST_CASE( modifiedAndParallel ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+    const auto S = model.getS(), A = model.getA();
+
+    PolicyIteration solver(1000000, 0.001);
+    const auto qfun = solver(model);
+    QGreedyPolicy policy(qfun);
+
+    AIToolbox::ThreadPool pool(3);
+
+    const auto check = [&](const auto & m) {
+        // Few evaluation sweeps per policy still find the optimal policy.
+        PolicyIteration modified(5, 0.001);
+        modified.setModified(true);
+        BOOST_CHECK(modified.isModified());
+        const auto mQFun = modified(m);
+        QGreedyPolicy mPolicy(mQFun);
+
+        // While parallel evaluation gives the same exact results.
+        modified.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(modified.getThreadPool(), &pool);
+        const auto pQFun = modified(m);
+        BOOST_CHECK( mQFun == pQFun );
+
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                BOOST_CHECK_SMALL( qfun(s, a) - mQFun(s, a), 0.01 );
+                BOOST_CHECK_EQUAL( policy.getActionProbability(s, a), mPolicy.getActionProbability(s, a) );
+            }
+        }
+    };
+
+    check(model);
+    check(sparseModel);
+}
+
+BOOST_AUTO_TEST_CASE( undiscountedAndMaxIterations ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    // A single evaluation sweep from zero values only sees the rewards.
+    PolicyIteration capped(1, 0.001, 1);
+    BOOST_CHECK_EQUAL(capped.getMaxIterations(), 1);
+    const auto rewards = computeImmediateRewards(model);
+    const auto cQFun = capped(model);
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+            BOOST_CHECK_CLOSE( cQFun(s, a), rewards(s, a), 0.0001 );
+
+    // Without discount the truncated evaluations never converge, so the
+    // modified mode must stop as soon as the policy is stable, like the
+    // normal one.
+    model.setDiscount(1.0);
+    PolicyIteration modified(5, 0.001);
+    modified.setModified(true);
+    const auto mQFun = modified(model);
+
+    PolicyIteration normal(5, 0.001);
+    BOOST_CHECK(!normal.isModified());
+    BOOST_CHECK( mQFun == normal(model) );
+}
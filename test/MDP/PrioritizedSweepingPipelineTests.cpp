@@ -0,0 +1,170 @@
+#define BOOST_TEST_MODULE MDP_PrioritizedSweepingPipeline
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Algorithms/PrioritizedSweepingPipeline.hpp>
+
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/Policies/EpsilonPolicy.hpp>
+#include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+
+#include "Utils/CliffProblem.hpp"
+
+namespace mdp = AIToolbox::MDP;
+
+BOOST_AUTO_TEST_CASE( matches_manual_pipeline ) {
+    GridWorld grid(12, 3);
+    mdp::Model model = makeCliffProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    mdp::SparseExperience exp(S, A);
+    mdp::SparseRLModel<mdp::SparseExperience> learnedModel(exp, 1.0, false);
+    mdp::PrioritizedSweeping<decltype(learnedModel)> solver(learnedModel);
+
+    mdp::PrioritizedSweepingPipeline<> pipeline(S, A);
+
+    mdp::QGreedyPolicy gPolicy(solver.getQFunction());
+    mdp::EpsilonPolicy ePolicy(gPolicy, 0.1);
+
+    const size_t start = S - 2;
+    for ( int episode = 0; episode < 5; ++episode ) {
+        size_t s = start;
+        for ( int i = 0; i < 1000; ++i ) {
+            const auto a = ePolicy.sampleAction(s);
+            const auto [s1, rew] = model.sampleSR(s, a);
+
+            exp.record(s, a, s1, rew);
+            learnedModel.sync(s, a);
+            solver.stepUpdateQ(s, a);
+            solver.batchUpdateQ();
+
+            pipeline.stepUpdateQ(s, a, s1, rew);
+
+            if ( s1 == S - 1 ) break;
+            s = s1;
+        }
+    }
+
+    BOOST_CHECK(pipeline.getQFunction() == solver.getQFunction());
+    BOOST_CHECK(pipeline.getValueFunction().values == solver.getValueFunction().values);
+    BOOST_CHECK_EQUAL(pipeline.getSolver().getQueueLength(), solver.getQueueLength());
+
+    // The index contains all pairs which can lead to each state.
+    const auto & preds = pipeline.getSolver().getPredecessors();
+    for ( size_t s1 = 0; s1 < S; ++s1 ) {
+        size_t count = 0;
+        for ( size_t s = 0; s < S; ++s ) {
+            for ( size_t a = 0; a < A; ++a ) {
+                if ( pipeline.getModel().getTransitionProbability(s, a, s1) > 0.0 ) {
+                    ++count;
+                    BOOST_CHECK(std::binary_search(std::begin(preds[s1]), std::end(preds[s1]), std::make_pair(s, a)));
+                }
+            }
+        }
+        // Pairs whose transitions disappeared are only dropped once their
+        // state is popped from the queue, so here we can't be exact.
+        BOOST_CHECK(preds[s1].size() >= count);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( predecessors_cleanup ) {
+    const size_t S = 3, A = 1;
+
+    // Pairs which have never been seen self-loop in the learned model.
+    mdp::PrioritizedSweepingPipeline<> pipeline(S, A, 0.9);
+    const auto & preds = pipeline.getSolver().getPredecessors();
+    BOOST_CHECK_EQUAL(preds[0].size(), 1);
+
+    // The self-loop of (0, 0) disappears, and as the value of 0 changes
+    // state 0 is popped from the queue and its stale entry dropped.
+    pipeline.stepUpdateQ(0, 0, 1, 10.0);
+    BOOST_CHECK_EQUAL(pipeline.getSolver().getQueueLength(), 0);
+
+    for ( size_t s1 = 0; s1 < S; ++s1 ) {
+        std::vector<std::pair<size_t, size_t>> truth;
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                if ( pipeline.getModel().getTransitionProbability(s, a, s1) > 0.0 )
+                    truth.emplace_back(s, a);
+
+        BOOST_TEST_INFO("State " << s1);
+        BOOST_CHECK(preds[s1] == truth);
+    }
+    BOOST_CHECK(preds[0].empty());
+    BOOST_CHECK_EQUAL(preds[1].size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( batches ) {
+    GridWorld grid(12, 3);
+    mdp::Model model = makeCliffProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    mdp::SparseExperience exp(S, A);
+    mdp::SparseRLModel<mdp::SparseExperience> learnedModel(exp, 1.0, false);
+    mdp::PrioritizedSweeping<decltype(learnedModel)> solver(learnedModel);
+
+    mdp::PrioritizedSweepingPipeline<> pipeline(S, A);
+
+    // Each batch updates each touched pair once, before sweeping.
+    for ( unsigned b = 0; b < 50; ++b ) {
+        mdp::TransitionBatch batch;
+        for ( size_t i = 0; i < 20; ++i ) {
+            const size_t s = (b * 7 + i * 5) % S, a = (b + i) % A;
+            const auto [s1, rew] = model.sampleSR(s, a);
+            batch.states.push_back(s);
+            batch.actions.push_back(a);
+            batch.nextStates.push_back(s1);
+            batch.rewards.push_back(rew);
+            exp.record(s, a, s1, rew);
+        }
+        for ( const auto & [s, a] : exp.getDirtyPairs() ) {
+            learnedModel.sync(s, a);
+            solver.stepUpdateQ(s, a);
+        }
+        exp.clearDirtyPairs();
+        solver.batchUpdateQ();
+
+        pipeline.batchUpdateQ(batch);
+    }
+
+    BOOST_CHECK(pipeline.getQFunction() == solver.getQFunction());
+    BOOST_CHECK(pipeline.getExperience().getVisitsSum(0, 0) == exp.getVisitsSum(0, 0));
+
+    mdp::TransitionBatch bad;
+    bad.states = {0, 1};
+    bad.actions = {0};
+    BOOST_CHECK_THROW(pipeline.batchUpdateQ(bad), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( cliff ) {
+    GridWorld grid(12, 3);
+    mdp::Model model = makeCliffProblem(grid);
+
+    mdp::PrioritizedSweepingPipeline<> pipeline(model.getS(), model.getA());
+
+    mdp::QGreedyPolicy gPolicy(pipeline.getQFunction());
+    mdp::EpsilonPolicy ePolicy(gPolicy, 0.1);
+
+    const size_t start = model.getS() - 2;
+    for ( int episode = 0; episode < 10; ++episode ) {
+        size_t s = start;
+        for ( int i = 0; i < 10000; ++i ) {
+            const auto a = ePolicy.sampleAction(s);
+            const auto [s1, rew] = model.sampleSR(s, a);
+            pipeline.stepUpdateQ(s, a, s1, rew);
+
+            if ( s1 == model.getS() - 1 ) break;
+            s = s1;
+        }
+    }
+
+    BOOST_CHECK_EQUAL( gPolicy.getActionProbability(start, UP), 1.0 );
+
+    auto state = grid(0, 2);
+    for ( int i = 0; i < 11; ++i ) {
+        BOOST_CHECK_EQUAL( gPolicy.getActionProbability(state, RIGHT), 1.0 );
+        state.setAdjacent(RIGHT);
+    }
+    BOOST_CHECK_EQUAL( gPolicy.getActionProbability(state, DOWN), 1.0 );
+}
@@ -8,13 +8,17 @@
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/MDP/Experience.hpp>
 #include <AIToolbox/MDP/RLModel.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/SparseRLModel.hpp>
 
 #include <AIToolbox/MDP/Policies/EpsilonPolicy.hpp>
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
 
-BOOST_AUTO_TEST_CASE( cliff ) {
+template <typename Queue>
+void testCliff() {
     namespace mdp = AIToolbox::MDP;
 
     GridWorld grid(12, 3);
@@ -24,7 +28,7 @@ BOOST_AUTO_TEST_CASE( cliff ) {
     mdp::Experience exp(model.getS(), model.getA());
     mdp::RLModel<mdp::Experience> learnedModel(exp, 1.0, false);
 
-    mdp::PrioritizedSweeping solver(learnedModel);
+    mdp::PrioritizedSweeping<decltype(learnedModel), Queue> solver(learnedModel);
 
     mdp::QGreedyPolicy gPolicy(solver.getQFunction());
     mdp::EpsilonPolicy ePolicy(gPolicy, 0.1);
@@ -64,3 +68,89 @@ BOOST_AUTO_TEST_CASE( cliff ) {
         state.setAdjacent(DOWN);
     }
 }
+
+BOOST_AUTO_TEST_CASE( cliff ) {
+    testCliff<AIToolbox::IndexedDaryHeap<>>();
+}
+
+BOOST_AUTO_TEST_CASE( cliffFibonacci ) {
+    testCliff<AIToolbox::IndexedFibonacciHeap>();
+}
+
+BOOST_AUTO_TEST_CASE( defaultQueue ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+    mdp::Model model = makeCliffProblem(grid);
+
+    // Class template argument deduction still works with the default queue.
+    mdp::PrioritizedSweeping solver(model);
+    static_assert(std::is_same_v<decltype(solver), mdp::PrioritizedSweeping<mdp::Model, AIToolbox::IndexedDaryHeap<>>>);
+
+    BOOST_CHECK_EQUAL( solver.getQueueLength(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( predecessorIndex ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+    mdp::SparseModel model(makeCliffProblem(grid));
+    const auto S = model.getS(), A = model.getA();
+
+    mdp::PrioritizedSweeping solver(model);
+    const auto & preds = solver.getPredecessors();
+    for ( size_t s1 = 0; s1 < S; ++s1 ) {
+        std::vector<std::pair<size_t, size_t>> expected;
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                if ( model.getTransitionProbability(s, a, s1) > 0.0 )
+                    expected.emplace_back(s, a);
+        BOOST_CHECK(preds[s1] == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( predecessorIndexMatchesScan ) {
+    namespace mdp = AIToolbox::MDP;
+
+    GridWorld grid(12, 3);
+    mdp::Model model = makeCliffProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    mdp::SparseExperience exp(S, A);
+    mdp::SparseRLModel<mdp::SparseExperience> learnedModel(exp, 1.0, false);
+
+    // The first solver uses its own index, the second one the result of
+    // a full scan of the model, like the original algorithm.
+    mdp::PrioritizedSweeping<decltype(learnedModel)> solver(learnedModel), scanSolver(learnedModel);
+
+    mdp::QGreedyPolicy gPolicy(solver.getQFunction());
+    mdp::EpsilonPolicy ePolicy(gPolicy, 0.1);
+
+    std::vector<std::vector<std::pair<size_t, size_t>>> scan(S);
+    size_t s = S - 2;
+    for ( int i = 0; i < 2000; ++i ) {
+        const auto a = ePolicy.sampleAction( s );
+        const auto [s1, rew] = model.sampleSR( s, a );
+
+        exp.record(s, a, s1, rew);
+        learnedModel.sync(s, a, s1);
+
+        solver.stepUpdateQ(s, a);
+        solver.batchUpdateQ();
+
+        for ( auto & p : scan ) p.clear();
+        for ( size_t x = 0; x < S; ++x )
+            for ( size_t y = 0; y < A; ++y )
+                for ( size_t x1 = 0; x1 < S; ++x1 )
+                    if ( AIToolbox::checkDifferentSmall(learnedModel.getTransitionProbability(x, y, x1), 0.0) )
+                        scan[x1].emplace_back(x, y);
+
+        scanSolver.stepUpdateQ(s, a);
+        scanSolver.batchUpdateQ(scan);
+
+        s = ( s1 == S - 1 ) ? S - 2 : s1;
+    }
+
+    BOOST_CHECK(solver.getQFunction() == scanSolver.getQFunction());
+    BOOST_CHECK_EQUAL(solver.getQueueLength(), scanSolver.getQueueLength());
+}
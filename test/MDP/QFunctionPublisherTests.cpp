@@ -0,0 +1,98 @@
+#define BOOST_TEST_MODULE MDP_QFunctionPublisher
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+
+#include <AIToolbox/MDP/QFunctionPublisher.hpp>
+#include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Utils.hpp>
+
+namespace aim = AIToolbox::MDP;
+
+BOOST_AUTO_TEST_CASE( cadence ) {
+    auto q = aim::makeQFunction(2, 2);
+    aim::QFunctionPublisher publisher(q, 3);
+    aim::QFunctionReader reader(publisher);
+
+    BOOST_CHECK_EQUAL(publisher.getVersion(), 1);
+    BOOST_CHECK(!reader.refresh());
+
+    q(0, 1) = 5.0;
+    BOOST_CHECK(!publisher.stepUpdate());
+    BOOST_CHECK(!publisher.stepUpdate());
+    BOOST_CHECK(!reader.refresh());
+    BOOST_CHECK_EQUAL(reader.getQFunction()(0, 1), 0.0);
+
+    BOOST_CHECK(publisher.stepUpdate());
+    BOOST_CHECK_EQUAL(publisher.getVersion(), 2);
+    BOOST_CHECK(reader.refresh());
+    BOOST_CHECK_EQUAL(reader.getVersion(), 2);
+    BOOST_CHECK_EQUAL(reader.getQFunction()(0, 1), 5.0);
+
+    // Held snapshots are never modified.
+    const auto snapshot = publisher.getSnapshot();
+    q(1, 0) = 3.0;
+    publisher.publish();
+    BOOST_CHECK_EQUAL((*snapshot)(1, 0), 0.0);
+    BOOST_CHECK_EQUAL((*publisher.getSnapshot())(1, 0), 3.0);
+
+    BOOST_CHECK_THROW(publisher.setCadence(0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( concurrent_serving ) {
+    constexpr size_t S = 8, A = 4;
+    constexpr unsigned Updates = 20000;
+
+    auto q = aim::makeQFunction(S, A);
+    aim::QFunctionPublisher publisher(q, 10);
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned> torn(0), started(0), upToDate(0);
+
+    // The policies are built here, since seeding is not thread-safe.
+    std::deque<aim::QFunctionReader> readers;
+    std::deque<aim::QGreedyPolicy> policies;
+    for (unsigned t = 0; t < 3; ++t) {
+        readers.emplace_back(publisher);
+        policies.emplace_back(readers.back().getQFunction());
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 3; ++t) {
+        threads.emplace_back([&, t] {
+            auto & reader = readers[t];
+            auto & policy = policies[t];
+            ++started;
+            while (!done) {
+                reader.refresh();
+
+                // The learner writes the same value everywhere, so any
+                // other snapshot would be a torn read.
+                const auto & rq = reader.getQFunction();
+                if ((rq.array() != rq(0, 0)).any()) ++torn;
+
+                policy.sampleAction(0);
+            }
+            reader.refresh();
+            if (reader.getQFunction()(0, 0) == Updates) ++upToDate;
+        });
+    }
+
+    while (started < 3) std::this_thread::yield();
+    for (unsigned i = 1; i <= Updates; ++i) {
+        q.fill(i);
+        publisher.stepUpdate();
+    }
+    done = true;
+    for (auto & t : threads) t.join();
+
+    BOOST_CHECK_EQUAL(torn, 0);
+    BOOST_CHECK_EQUAL(upToDate, 3);
+    BOOST_CHECK_EQUAL(publisher.getVersion(), Updates / 10 + 1);
+    BOOST_CHECK_EQUAL((*publisher.getSnapshot())(S - 1, A - 1), Updates);
+}
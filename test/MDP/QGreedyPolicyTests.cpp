@@ -4,9 +4,14 @@
 #include <boost/test/unit_test.hpp>
 
 #include <array>
+#include <thread>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/MDP/Utils.hpp>
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Policies/EpsilonPolicy.hpp>
+#include <AIToolbox/MDP/Policies/QSoftmaxPolicy.hpp>
+#include <AIToolbox/MDP/Policies/RandomPolicy.hpp>
+#include <AIToolbox/MDP/Policies/PolicyWrapper.hpp>
 
 BOOST_AUTO_TEST_CASE( sampling ) {
     using namespace AIToolbox;
@@ -118,3 +123,209 @@ BOOST_AUTO_TEST_CASE( getPolicy ) {
     BOOST_CHECK(checkEqualSmall(matrix(2,1), 1.0/3.0));
     BOOST_CHECK(checkEqualSmall(matrix(2,2), 1.0/3.0));
 }
+
+BOOST_AUTO_TEST_CASE( batched_sampling ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::MDP;
+    constexpr size_t S = 3, A = 3;
+
+    auto q = makeQFunction(S, A);
+    q(0,0) = 45;
+    q(0,1) = 14;
+    q(0,2) = -15;
+
+    q(1,0) = 1001;
+    q(1,1) = 1000.99;
+    q(1,2) = 1001;
+
+    q(2,0) = 3;
+    q(2,1) = 4;
+    q(2,2) = 42;
+
+    QGreedyPolicy p(q);
+
+    std::vector<size_t> states;
+    for (unsigned i = 0; i < 1000; ++i)
+        states.push_back(i % S);
+
+    std::vector<size_t> actions{7};
+    p.sampleActions(states, &actions);
+    BOOST_REQUIRE_EQUAL(actions.size(), states.size());
+
+    std::array<unsigned, A> counts{{0,0,0}};
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (states[i] == 0) BOOST_CHECK_EQUAL(actions[i], 0);
+        else if (states[i] == 2) BOOST_CHECK_EQUAL(actions[i], 2);
+        else ++counts[actions[i]];
+    }
+    BOOST_CHECK_EQUAL(counts[1], 0);
+    BOOST_CHECK(counts[0] > 100);
+    BOOST_CHECK(counts[2] > 100);
+
+    // Through the base interface and an EpsilonPolicy.
+    EpsilonPolicy greedy(p, 0.0);
+    const AIToolbox::MDP::PolicyInterface & base = greedy;
+    base.sampleActions(states, &actions);
+    for (size_t i = 0; i < states.size(); ++i)
+        if (states[i] != 1) BOOST_CHECK_EQUAL(actions[i], states[i] == 0 ? 0 : 2);
+
+    EpsilonPolicy random(p, 1.0);
+    random.sampleActions(states, &actions);
+    std::fill(std::begin(counts), std::end(counts), 0);
+    for (size_t i = 0; i < states.size(); ++i)
+        if (states[i] == 0) ++counts[actions[i]];
+    BOOST_CHECK(counts[0] > 50);
+    BOOST_CHECK(counts[1] > 50);
+    BOOST_CHECK(counts[2] > 50);
+}
+
+BOOST_AUTO_TEST_CASE( thread_safe_sampling ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::MDP;
+    constexpr size_t S = 2, A = 3;
+
+    auto q = makeQFunction(S, A);
+    q(0,0) = 45;
+    q(0,1) = 14;
+    q(0,2) = -15;
+
+    q(1,0) = 1001;
+    q(1,1) = 1000.99;
+    q(1,2) = 1001;
+
+    const QGreedyPolicy greedy(q);
+    const QSoftmaxPolicy softmax(q, 100.0);
+    const EpsilonPolicy epsilon(greedy, 0.5);
+
+    constexpr unsigned Threads = 4, Samples = 3000;
+    std::vector<std::array<unsigned, 3 * A>> counts(Threads);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < Threads; ++t) {
+        threads.emplace_back([&, t] {
+            // Each thread uses its own generator, and shares the policies.
+            RandomEngine gen(t);
+            auto & c = counts[t];
+            std::fill(std::begin(c), std::end(c), 0);
+            for (unsigned i = 0; i < Samples; ++i) {
+                ++c[greedy.sampleActionWith(1, gen)];
+                ++c[A + softmax.sampleActionWith(0, gen)];
+                ++c[2 * A + epsilon.sampleActionWith(0, gen)];
+            }
+        });
+    }
+    for (auto & t : threads) t.join();
+
+    for (const auto & c : counts) {
+        // Greedy: never action 1, the others approximately equally.
+        BOOST_CHECK_EQUAL(c[1], 0);
+        BOOST_CHECK(c[0] > 1200);
+        BOOST_CHECK(c[2] > 1200);
+
+        // Softmax: all actions, in order of value.
+        BOOST_CHECK(c[A + 0] > c[A + 1]);
+        BOOST_CHECK(c[A + 1] > c[A + 2]);
+        BOOST_CHECK(c[A + 2] > 0);
+
+        // Epsilon: half greedy, the rest uniform.
+        BOOST_CHECK(c[2 * A + 0] > 1800);
+        BOOST_CHECK(c[2 * A + 1] > 300);
+        BOOST_CHECK(c[2 * A + 2] > 300);
+    }
+
+    // The same generator seed gives the same actions.
+    RandomEngine gen1(42), gen2(42);
+    for (unsigned i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(softmax.sampleActionWith(0, gen1), softmax.sampleActionWith(0, gen2));
+}
+
+BOOST_AUTO_TEST_CASE( softmax_caching ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::MDP;
+    constexpr size_t S = 3, A = 4;
+
+    auto q = makeQFunction(S, A);
+    q << 1.0,  2.0,  3.0,  4.0,
+        -5.0,  0.5,  0.5, -1.0,
+       800.0, 800.0, 1.0, 2.0;
+
+    QSoftmaxPolicy reference(q, 2.0);
+    QSoftmaxPolicy cached(q, 2.0);
+    BOOST_CHECK(!cached.isCaching());
+    cached.setCaching(true);
+    BOOST_CHECK(cached.isCaching());
+
+    const auto checkEqual = [&] {
+        const auto p = reference.getPolicy();
+        for (size_t s = 0; s < S; ++s)
+            for (size_t a = 0; a < A; ++a)
+                BOOST_CHECK_CLOSE(cached.getActionProbability(s, a), p(s, a), 1e-9);
+        BOOST_CHECK(cached.getPolicy().isApprox(p));
+    };
+    checkEqual();
+
+    // Cached values are kept until invalidated.
+    q(0, 0) = 10.0;
+    BOOST_CHECK(cached.getActionProbability(0, 0) < reference.getActionProbability(0, 0));
+
+    cached.invalidate(0);
+    checkEqual();
+
+    q(1, 3) = 7.0;
+    q(2, 2) = 900.0;
+    cached.invalidate();
+    checkEqual();
+
+    // Changing the temperature invalidates automatically.
+    reference.setTemperature(0.5);
+    cached.setTemperature(0.5);
+    checkEqual();
+
+    // Sampling from the cache follows the same distribution.
+    std::vector<size_t> states(20000, 1), actions;
+    cached.sampleActions(states, &actions);
+    std::array<double, A> counts{};
+    for (auto a : actions) counts[a] += 1.0;
+    for (size_t a = 0; a < A; ++a)
+        BOOST_CHECK_SMALL(counts[a] / states.size() - reference.getActionProbability(1, a), 0.02);
+
+    // Overflowing values are picked uniformly, and the others never.
+    for (unsigned i = 0; i < 100; ++i)
+        BOOST_CHECK(cached.sampleAction(2) != 3);
+}
+
+BOOST_AUTO_TEST_CASE( policy_into_workspace ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::MDP;
+    constexpr size_t S = 4, A = 3;
+
+    auto q = makeQFunction(S, A);
+    q << 1.0, 2.0, 0.0,
+         5.0, 5.0, 5.0,
+        -1.0, 0.0, 3.0,
+         0.0, 0.0, 0.0;
+
+    const QGreedyPolicy greedy(q);
+    const QSoftmaxPolicy softmax(q, 2.0);
+    const EpsilonPolicy epsilon(greedy, 0.3);
+    const RandomPolicy random(S, A);
+    const Matrix2D matrix = softmax.getPolicy();
+    const PolicyWrapper wrapper(matrix);
+
+    Matrix2D out(S, A);
+    const double * data = out.data();
+    for (const AIToolbox::MDP::PolicyInterface * p : std::initializer_list<const AIToolbox::MDP::PolicyInterface *>{&greedy, &softmax, &epsilon, &random, &wrapper}) {
+        p->getPolicyInto(&out);
+        BOOST_CHECK(out.isApprox(p->getPolicy()));
+        // A workspace of the right size is never reallocated.
+        BOOST_CHECK_EQUAL(out.data(), data);
+    }
+
+    BOOST_CHECK_EQUAL(random.getPolicy().rows(), S);
+    BOOST_CHECK_CLOSE(random.getPolicy()(2, 1), 1.0 / A, 1e-9);
+
+    // A workspace of the wrong size is resized.
+    Matrix2D empty;
+    greedy.getPolicyInto(&empty);
+    BOOST_CHECK(empty == greedy.getPolicy());
+}
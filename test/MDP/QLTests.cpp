@@ -12,6 +12,9 @@
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
+#include "Utils/TransitionBatch.hpp"
+
+#include <set>
 
 BOOST_AUTO_TEST_CASE( cliff ) {
     namespace mdp = AIToolbox::MDP;
@@ -57,3 +60,73 @@ BOOST_AUTO_TEST_CASE( cliff ) {
         state.setAdjacent(DOWN);
     }
 }
+
+BOOST_AUTO_TEST_CASE( traceIndexing ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 20, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 2000);
+
+    mdp::QL scan(S, A, 0.9, 0.1, 0.9, 0.01);
+    mdp::QL indexed(S, A, 0.9, 0.1, 0.9, 0.01);
+
+    indexed.setTraceIndexing(true);
+    BOOST_CHECK( indexed.getTraceIndexing() );
+
+    for ( size_t i = 0; i < batch.states.size(); ++i ) {
+        scan.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+        indexed.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+        if ( i == 1000 ) {
+            scan.clearTraces();
+            indexed.clearTraces();
+        }
+    }
+
+    // Results must be exactly the same, not just approximately.
+    BOOST_CHECK( scan.getQFunction() == indexed.getQFunction() );
+    BOOST_CHECK( scan.getTraces() == indexed.getTraces() );
+
+    indexed.setTraceIndexing(false);
+    BOOST_CHECK( !indexed.getTraceIndexing() );
+}
+
+BOOST_AUTO_TEST_CASE( traceStorage ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 20, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 200);
+
+    mdp::QL solver(S, A, 0.9, 0.1, 0.9, 0.01);
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        solver.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+
+    const auto traces = solver.getTraces();
+    BOOST_CHECK( !traces.empty() );
+
+    // The last pair is always the freshest, and all others have decayed
+    // but are still above tolerance.
+    std::set<std::pair<size_t, size_t>> pairs;
+    for ( const auto & [s, a, el] : traces ) {
+        BOOST_CHECK( pairs.emplace(s, a).second );
+        if ( s == batch.states.back() && a == batch.actions.back() )
+            BOOST_CHECK_EQUAL( el, 1.0 );
+        else {
+            BOOST_CHECK( el < 1.0 );
+            BOOST_CHECK( el >= solver.getTolerance() );
+        }
+    }
+
+    const auto replace = mdp::QL::Traces{{3, 1, 0.5}, {7, 2, 0.25}};
+    solver.setTraces(replace);
+    BOOST_CHECK( solver.getTraces() == replace );
+
+    // A new update starts from the set traces.
+    const auto q = solver.getQFunction();
+    solver.stepUpdateQ(3, 1, 3, 1.0);
+    const auto & newQ = solver.getQFunction();
+    const auto error = newQ(3, 1) - q(3, 1);
+    BOOST_CHECK_CLOSE( newQ(7, 2) - q(7, 2), error * 0.25 * solver.getDiscount() * solver.getLambda(), 0.0001 );
+
+    solver.clearTraces();
+    BOOST_CHECK( solver.getTraces().empty() );
+}
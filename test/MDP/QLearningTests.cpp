@@ -11,6 +11,12 @@
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
+#include "Utils/TransitionBatch.hpp"
+
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE( updates ) {
     namespace mdp = AIToolbox::MDP;
@@ -95,3 +101,140 @@ BOOST_AUTO_TEST_CASE( exceptions ) {
     BOOST_CHECK_EXCEPTION(mdp::QLearning(1,1,0.3,-0.5),  std::invalid_argument, [](const std::invalid_argument &){return true;});
     BOOST_CHECK_EXCEPTION(mdp::QLearning(1,1,0.3,1.1),   std::invalid_argument, [](const std::invalid_argument &){return true;});
 }
+
+BOOST_AUTO_TEST_CASE( batchUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::QLearning step(S, A, 0.9, 0.3);
+    mdp::QLearning batched(S, A, 0.9, 0.3);
+
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        step.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+    batched.batchUpdateQ(batch);
+
+    BOOST_CHECK( step.getQFunction() == batched.getQFunction() );
+
+    batch.rewards.pop_back();
+    BOOST_CHECK_THROW( batched.batchUpdateQ(batch), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( sortBatch ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    auto sorted = batch;
+    mdp::sortTransitionBatch(&sorted);
+
+    BOOST_CHECK_EQUAL( sorted.states.size(), batch.states.size() );
+    BOOST_CHECK_EQUAL( sorted.nextActions.size(), batch.nextActions.size() );
+
+    // Sorted by state-action, and transitions are kept together.
+    std::multiset<std::tuple<size_t, size_t, size_t, size_t, double>> original, result;
+    for ( size_t i = 0; i < batch.states.size(); ++i ) {
+        original.emplace(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+        result.emplace(sorted.states[i], sorted.actions[i], sorted.nextStates[i], sorted.nextActions[i], sorted.rewards[i]);
+        if ( i > 0 ) {
+            const auto prev = std::make_pair(sorted.states[i-1], sorted.actions[i-1]);
+            BOOST_CHECK( prev <= std::make_pair(sorted.states[i], sorted.actions[i]) );
+        }
+    }
+    BOOST_CHECK( original == result );
+}
+
+BOOST_AUTO_TEST_CASE( parallelBatchUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::QLearning reference(S, A, 0.9, 0.3);
+    reference.batchUpdateQ(makeRandomTransitionBatch(S, A, 100, 1));
+
+    // All updates bootstrap from the initial values.
+    auto q = reference.getQFunction();
+    const mdp::Values v = q.rowwise().maxCoeff();
+    for ( size_t i = 0; i < batch.states.size(); ++i ) {
+        const auto s = batch.states[i], a = batch.actions[i];
+        q(s, a) += 0.3 * ( batch.rewards[i] + 0.9 * v[batch.nextStates[i]] - q(s, a) );
+    }
+
+    for ( const size_t threads : {1, 2, 3} ) {
+        AIToolbox::ThreadPool pool(threads);
+
+        auto solver = reference;
+        solver.batchUpdateQ(batch, pool);
+
+        BOOST_CHECK( solver.getQFunction() == q );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batchTDErrors ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    auto batch = makeRandomTransitionBatch(S, A, 200);
+
+    mdp::QLearning step(S, A, 0.9, 0.3);
+    mdp::QLearning batched(S, A, 0.9, 0.3);
+
+    std::vector<double> tdErrors;
+    batched.batchUpdateQ(batch, &tdErrors);
+    BOOST_CHECK_EQUAL( tdErrors.size(), batch.states.size() );
+
+    // Each error is computed before its own update.
+    for ( size_t i = 0; i < batch.states.size(); ++i ) {
+        const auto s = batch.states[i], a = batch.actions[i];
+        const auto before = step.getQFunction()(s, a);
+        step.stepUpdateQ(s, a, batch.nextStates[i], batch.rewards[i]);
+        BOOST_CHECK_CLOSE( (step.getQFunction()(s, a) - before) / 0.3, tdErrors[i], 1e-6 );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( concurrentUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 12, A = 3, threads = 4;
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::QLearning solver(S, A, 0.9, 0.3);
+    BOOST_CHECK_EQUAL(solver.getConcurrentUpdates(), 0);
+
+    // With a single thread, locks do not change the results.
+    auto reference = solver;
+    reference.batchUpdateQ(batch);
+
+    solver.setConcurrentUpdates(5);
+    BOOST_CHECK_EQUAL(solver.getConcurrentUpdates(), 5);
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        solver.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.rewards[i]);
+
+    BOOST_CHECK( solver.getQFunction() == reference.getQFunction() );
+
+    // Each thread only touches its own states, so the results do not
+    // depend on the interleaving, even if the states share stripes.
+    mdp::QLearning serial(S, A, 0.9, 0.3), concurrent(S, A, 0.9, 0.3);
+    concurrent.setConcurrentUpdates(3);
+
+    const auto update = [&](mdp::QLearning & q, const size_t t) {
+        for ( size_t i = 0; i < batch.states.size(); ++i ) {
+            const auto s = batch.states[i];
+            if ( s % threads != t ) continue;
+            q.stepUpdateQ(s, batch.actions[i], s, batch.rewards[i]);
+        }
+    };
+    for ( size_t t = 0; t < threads; ++t )
+        update(serial, t);
+
+    std::vector<std::thread> workers;
+    for ( size_t t = 0; t < threads; ++t )
+        workers.emplace_back(update, std::ref(concurrent), t);
+    for ( auto & w : workers )
+        w.join();
+
+    BOOST_CHECK( concurrent.getQFunction() == serial.getQFunction() );
+}
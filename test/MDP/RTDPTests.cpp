@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE MDP_RTDP
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Algorithms/RTDP.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include "Utils/CornerProblem.hpp"
+#include "Utils/OldMDPModel.hpp"
+
+namespace aim = AIToolbox::MDP;
+
+BOOST_AUTO_TEST_CASE( lrtdpCornerProblem ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const aim::SparseModel sparseModel(model);
+
+    aim::ValueIteration vi(1000000, 0.00001);
+    const auto [bound, vf, q] = vi(model);
+    (void)bound; (void)q;
+
+    const size_t start = 5;
+
+    aim::LRTDP lrtdp(model, 0.00001);
+    const auto trials = lrtdp(start);
+    BOOST_CHECK(trials < lrtdp.getMaxTrials());
+    BOOST_CHECK(lrtdp.isSolved(start));
+    BOOST_CHECK_CLOSE(lrtdp.getValueFunction().values[start], vf.values[start], 0.01);
+
+    // All solved states have converged, and follow the optimal policy.
+    for (size_t s = 0; s < model.getS(); ++s) {
+        if (!lrtdp.isSolved(s) || model.isTerminal(s)) continue;
+        BOOST_CHECK_CLOSE(lrtdp.getValueFunction().values[s], vf.values[s], 0.01);
+        BOOST_CHECK_CLOSE(q(s, lrtdp.getValueFunction().actions[s]), vf.values[s], 0.01);
+    }
+
+    // Solved states are not visited again.
+    BOOST_CHECK_EQUAL(lrtdp(start), 0);
+
+    aim::LRTDP sparse(sparseModel, 0.00001);
+    sparse(start);
+    BOOST_CHECK(sparse.isSolved(start));
+    BOOST_CHECK_CLOSE(sparse.getValueFunction().values[start], vf.values[start], 0.01);
+
+    OldMDPModel oldModel = makeCornerProblem(grid);
+    aim::LRTDP generic(oldModel, 0.00001);
+    generic(start);
+    BOOST_CHECK(generic.isSolved(start));
+    BOOST_CHECK_CLOSE(generic.getValueFunction().values[start], vf.values[start], 0.01);
+}
+
+BOOST_AUTO_TEST_CASE( rtdpCornerProblem ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    aim::ValueIteration vi(1000000, 0.00001);
+    const auto [bound, vf, q] = vi(model);
+    (void)bound; (void)q;
+
+    aim::RTDP rtdp(model, 0.00001);
+    rtdp(6);
+    BOOST_CHECK_CLOSE(rtdp.getValueFunction().values[6], vf.values[6], 0.1);
+}
+
+BOOST_AUTO_TEST_CASE( heuristic ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+
+    aim::ValueIteration vi(1000000, 0.00001);
+    const auto [bound, vf, q] = vi(model);
+    (void)bound; (void)q;
+
+    // With the exact values as heuristic, the start state is solved immediately.
+    aim::LRTDP lrtdp(model, 0.00001);
+    lrtdp.setHeuristic(vf.values);
+    BOOST_CHECK_EQUAL(lrtdp(5), 1);
+    BOOST_CHECK(lrtdp.isSolved(5));
+
+    BOOST_CHECK_THROW(lrtdp.setHeuristic(aim::Values::Zero(3)), std::invalid_argument);
+    BOOST_CHECK_THROW(lrtdp.setEpsilon(0.0), std::invalid_argument);
+}
@@ -0,0 +1,124 @@
+#define BOOST_TEST_MODULE MDP_ReachableModel
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/ReachableModel.hpp>
+#include <AIToolbox/MDP/SparseExperience.hpp>
+#include <AIToolbox/MDP/SparseRLModel.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+#include "Utils/OldMDPModel.hpp"
+
+namespace aim = AIToolbox::MDP;
+
+// Builds a model with two copies of the input one, which do not communicate.
+aim::SparseModel makeDoubleModel(const aim::Model & model) {
+    const auto S = model.getS(), A = model.getA();
+
+    aim::SparseModel::TransitionMatrix t(A, AIToolbox::SparseMatrix2D(2*S, 2*S));
+    aim::SparseModel::RewardMatrix r(2*S, A);
+    for (size_t a = 0; a < A; ++a) {
+        for (size_t s = 0; s < S; ++s) {
+            for (size_t s1 = 0; s1 < S; ++s1) {
+                const double p = model.getTransitionProbability(s, a, s1);
+                if (p == 0.0) continue;
+                t[a].insert(s, s1) = p;
+                t[a].insert(S + s, S + s1) = p;
+            }
+            const double rew = model.getRewardFunction()(s, a);
+            if (rew == 0.0) continue;
+            r.insert(s, a) = rew;
+            r.insert(S + s, a) = rew;
+        }
+        t[a].makeCompressed();
+    }
+    r.makeCompressed();
+    return aim::SparseModel(AIToolbox::NO_CHECK, 2*S, A, std::move(t), std::move(r), model.getDiscount());
+}
+
+BOOST_AUTO_TEST_CASE( reachableStates ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const auto doubleModel = makeDoubleModel(model);
+    const auto S = model.getS();
+
+    // Corners are absorbing.
+    BOOST_CHECK(aim::findReachableStates(model, {0}) == std::vector<size_t>{0});
+
+    const auto reachable = aim::findReachableStates(doubleModel, {S + 5});
+    BOOST_CHECK_EQUAL(reachable.size(), S);
+    BOOST_CHECK_EQUAL(reachable.front(), S);
+    BOOST_CHECK_EQUAL(reachable.back(), 2*S - 1);
+
+    OldMDPModel oldModel = makeCornerProblem(grid);
+    BOOST_CHECK(aim::findReachableStates(oldModel, {5}) == aim::findReachableStates(model, {5}));
+
+    BOOST_CHECK_THROW(aim::findReachableStates(model, {S}), std::invalid_argument);
+    BOOST_CHECK_THROW(aim::ReachableModel(model, {}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( solveCompacted ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid);
+    const auto doubleModel = makeDoubleModel(model);
+    const auto S = model.getS(), A = model.getA();
+
+    aim::ReachableModel reachable(doubleModel, {S + 5});
+    const auto & compact = reachable.getModel();
+
+    BOOST_CHECK_EQUAL(compact.getS(), S);
+    BOOST_CHECK_EQUAL(compact.getA(), A);
+    BOOST_CHECK_EQUAL(reachable.getOriginalS(), 2*S);
+    BOOST_CHECK_EQUAL(reachable.getCompactState(S + 3), 3);
+    BOOST_CHECK_EQUAL(reachable.getCompactState(3), aim::ReachableModel::Unreachable);
+
+    aim::ValueIteration vi(1000000, 0.001);
+    const auto [bound, vf, q] = vi(model);
+    const auto [cbound, cvf, cq] = vi(compact);
+    (void)bound; (void)cbound;
+
+    const auto fullVf = reachable.expand(cvf);
+    const auto fullQ = reachable.expand(cq);
+
+    BOOST_CHECK_EQUAL(fullQ.rows(), 2*S);
+    for (size_t s = 0; s < S; ++s) {
+        BOOST_CHECK_EQUAL(fullVf.values[s], 0.0);
+        BOOST_CHECK_EQUAL(fullVf.values[S + s], vf.values[s]);
+        BOOST_CHECK_EQUAL(fullVf.actions[S + s], vf.actions[s]);
+        BOOST_CHECK(fullQ.row(s).isZero());
+        BOOST_CHECK(fullQ.row(S + s) == q.row(s));
+    }
+
+    const auto back = reachable.compact(fullVf);
+    BOOST_CHECK(back.values == cvf.values);
+    BOOST_CHECK(back.actions == cvf.actions);
+
+    BOOST_CHECK_THROW(reachable.expand(aim::ValueFunction(aim::Values::Zero(2), aim::Actions(2))), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( sparseRLModel ) {
+    const size_t S = 10, A = 2;
+
+    // A chain among even states, odd states are never visited.
+    aim::SparseExperience exp(S, A);
+    for (size_t s = 0; s < S; s += 2) {
+        exp.record(s, 0, s, 0.0);
+        exp.record(s, 1, (s + 2) % S, s == S - 2 ? 1.0 : 0.0);
+    }
+    aim::SparseRLModel<aim::SparseExperience> rl(exp, 0.9, true);
+
+    aim::ReachableModel reachable(rl, {0});
+    BOOST_CHECK(reachable.getStates() == (std::vector<size_t>{0, 2, 4, 6, 8}));
+
+    aim::ValueIteration vi(1000000, 0.0001);
+    const auto [b1, vf, q] = vi(rl);
+    const auto [b2, cvf, cq] = vi(reachable.getModel());
+    (void)b1; (void)b2;
+
+    const auto fullQ = reachable.expand(cq);
+    for (size_t s = 0; s < S; s += 2)
+        for (size_t a = 0; a < A; ++a)
+            BOOST_CHECK_CLOSE(fullQ(s, a), q(s, a), 0.0001);
+}
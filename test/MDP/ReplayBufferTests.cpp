@@ -0,0 +1,156 @@
+#define BOOST_TEST_MODULE MDP_ReplayBuffer
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/ReplayBuffer.hpp>
+#include <AIToolbox/MDP/Algorithms/DynaQ.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+
+#include "Utils/CliffProblem.hpp"
+
+#include <cmath>
+
+namespace mdp = AIToolbox::MDP;
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    mdp::ReplayBuffer uniform(10);
+    BOOST_CHECK_EQUAL(uniform.getCapacity(), 10);
+    BOOST_CHECK_EQUAL(uniform.size(), 0);
+    BOOST_CHECK(!uniform.isPrioritized());
+
+    mdp::ReplayBuffer prioritized(10, 0.6);
+    BOOST_CHECK(prioritized.isPrioritized());
+    BOOST_CHECK_EQUAL(prioritized.getExponent(), 0.6);
+
+    BOOST_CHECK_THROW(mdp::ReplayBuffer(0), std::invalid_argument);
+    BOOST_CHECK_THROW(mdp::ReplayBuffer(10, -1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(mdp::ReplayBuffer(10, 0.5, 0.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( ring ) {
+    mdp::ReplayBuffer buffer(3);
+
+    for (size_t i = 0; i < 5; ++i)
+        BOOST_CHECK_EQUAL(buffer.record(i, i + 1, i + 2, double(i)), i % 3);
+
+    BOOST_CHECK_EQUAL(buffer.size(), 3);
+
+    // The oldest two transitions have been overwritten.
+    const auto [s, a, s1, rew] = buffer.getTransition(0);
+    BOOST_CHECK_EQUAL(s, 3);
+    BOOST_CHECK_EQUAL(a, 4);
+    BOOST_CHECK_EQUAL(s1, 5);
+    BOOST_CHECK_EQUAL(rew, 3.0);
+    BOOST_CHECK_EQUAL(std::get<0>(buffer.getTransition(2)), 2);
+
+    mdp::TransitionBatch batch;
+    std::vector<size_t> ids;
+    buffer.sampleBatch(20, &batch, &ids);
+    BOOST_CHECK_EQUAL(batch.states.size(), 20);
+    BOOST_CHECK_EQUAL(ids.size(), 20);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        BOOST_CHECK(ids[i] < 3);
+        BOOST_CHECK_EQUAL(batch.states[i], std::get<0>(buffer.getTransition(ids[i])));
+        BOOST_CHECK_EQUAL(batch.actions[i], batch.states[i] + 1);
+        BOOST_CHECK_EQUAL(batch.nextStates[i], batch.states[i] + 2);
+    }
+
+    buffer.clear();
+    BOOST_CHECK_EQUAL(buffer.size(), 0);
+    buffer.sampleBatch(5, &batch, &ids);
+    BOOST_CHECK(batch.states.empty());
+    BOOST_CHECK(ids.empty());
+}
+
+BOOST_AUTO_TEST_CASE( uniform_sampling ) {
+    constexpr size_t N = 4;
+    mdp::ReplayBuffer buffer(N);
+    for (size_t i = 0; i < N; ++i)
+        buffer.record(i, 0, 0, 0.0);
+
+    // Updates are ignored without prioritization.
+    buffer.updatePriorities({0}, {100.0});
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_CLOSE(buffer.getProbability(i), 1.0 / N, 1e-6);
+
+    mdp::TransitionBatch batch;
+    std::vector<size_t> ids;
+    std::vector<unsigned> counts(N, 0);
+    for (unsigned i = 0; i < 1000; ++i) {
+        buffer.sampleBatch(40, &batch, &ids);
+        for (auto id : ids) ++counts[id];
+    }
+    for (auto c : counts)
+        BOOST_CHECK_SMALL(c / 40000.0 - 1.0 / N, 0.01);
+}
+
+BOOST_AUTO_TEST_CASE( prioritized_sampling ) {
+    constexpr size_t N = 4;
+    mdp::ReplayBuffer buffer(N, 1.0, 1e-6);
+    for (size_t i = 0; i < N; ++i)
+        buffer.record(i, 0, 0, 0.0);
+
+    // New transitions all have the same priority.
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_CLOSE(buffer.getProbability(i), 1.0 / N, 1e-6);
+
+    buffer.updatePriorities({0, 1, 2, 3}, {1.0, -2.0, 0.0, 5.0});
+    const std::vector<double> expected{1.0 / 8.0, 2.0 / 8.0, 0.0, 5.0 / 8.0};
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_SMALL(buffer.getProbability(i) - expected[i], 1e-5);
+
+    mdp::TransitionBatch batch;
+    std::vector<size_t> ids;
+    std::vector<unsigned> counts(N, 0);
+    for (unsigned i = 0; i < 1000; ++i) {
+        buffer.sampleBatch(40, &batch, &ids);
+        for (auto id : ids) ++counts[id];
+    }
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_SMALL(counts[i] / 40000.0 - expected[i], 0.01);
+
+    // New transitions get the max priority seen so far.
+    buffer.record(4, 0, 0, 0.0);
+    BOOST_CHECK_SMALL(buffer.getProbability(0) - 5.0 / 12.0, 1e-5);
+
+    BOOST_CHECK_THROW(buffer.updatePriorities({0, 1}, {1.0}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( dynaq_planning ) {
+    GridWorld grid(12, 3);
+
+    auto model = makeCliffProblem(grid);
+    model.setDiscount(0.9);
+
+    mdp::DynaQ reference(model, 0.5, 200);
+    mdp::DynaQ solver(model, 0.5, 200);
+
+    mdp::ReplayBuffer buffer(model.getS() * model.getA(), 0.6);
+    BOOST_CHECK(solver.getReplayBuffer() == nullptr);
+    solver.setReplayBuffer(&buffer);
+    BOOST_CHECK_EQUAL(solver.getReplayBuffer(), &buffer);
+
+    // Planning with an empty buffer does nothing.
+    solver.batchUpdateQ();
+
+    for ( size_t s = 0; s < model.getS(); ++s ) {
+        for ( size_t a = 0; a < model.getA(); ++a ) {
+            const auto [s1, rew] = model.sampleSR(s, a);
+            reference.stepUpdateQ(s, a, s1, rew);
+            solver.stepUpdateQ(s, a, s1, rew);
+        }
+    }
+    BOOST_CHECK_EQUAL(buffer.size(), model.getS() * model.getA());
+
+    for ( int i = 0; i < 2000; ++i ) {
+        reference.batchUpdateQ();
+        solver.batchUpdateQ();
+    }
+
+    const auto & rq = reference.getQFunction();
+    const auto & sq = solver.getQFunction();
+    for ( size_t s = 0; s < model.getS(); ++s )
+        for ( size_t a = 0; a < model.getA(); ++a )
+            BOOST_CHECK_SMALL( rq(s, a) - sq(s, a), 0.001 );
+}
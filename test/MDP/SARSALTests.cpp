@@ -11,6 +11,7 @@
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
+#include "Utils/TransitionBatch.hpp"
 
 BOOST_AUTO_TEST_CASE( cliff ) {
     namespace mdp = AIToolbox::MDP;
@@ -70,3 +71,36 @@ BOOST_AUTO_TEST_CASE( exceptions ) {
     BOOST_CHECK_EXCEPTION(mdp::SARSAL(1,1,0.3,-0.5),  std::invalid_argument, [](const std::invalid_argument &){return true;});
     BOOST_CHECK_EXCEPTION(mdp::SARSAL(1,1,0.3,1.1),   std::invalid_argument, [](const std::invalid_argument &){return true;});
 }
+
+BOOST_AUTO_TEST_CASE( traceIndexing ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 20, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 2000);
+
+    mdp::SARSAL scan(S, A, 0.9, 0.1, 0.9, 0.01);
+    mdp::SARSAL indexed(S, A, 0.9, 0.1, 0.9, 0.01);
+
+    BOOST_CHECK( !indexed.getTraceIndexing() );
+    indexed.setTraceIndexing(true);
+    BOOST_CHECK( indexed.getTraceIndexing() );
+
+    for ( size_t i = 0; i < batch.states.size(); ++i ) {
+        scan.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+        indexed.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+
+        // Check that the index survives trace manipulation.
+        if ( i == 500 ) {
+            scan.clearTraces();
+            indexed.clearTraces();
+        } else if ( i == 1000 ) {
+            const auto traces = scan.getTraces();
+            scan.setTraces(traces);
+            indexed.setTraces(traces);
+        }
+    }
+
+    // Results must be exactly the same, not just approximately.
+    BOOST_CHECK( scan.getQFunction() == indexed.getQFunction() );
+    BOOST_CHECK( scan.getTraces() == indexed.getTraces() );
+}
@@ -11,6 +11,7 @@
 #include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
 
 #include "Utils/CliffProblem.hpp"
+#include "Utils/TransitionBatch.hpp"
 
 BOOST_AUTO_TEST_CASE( cliff ) {
     namespace mdp = AIToolbox::MDP;
@@ -82,3 +83,40 @@ BOOST_AUTO_TEST_CASE( exceptions ) {
     BOOST_CHECK_EXCEPTION(mdp::SARSA(1,1,0.3,-0.5),  std::invalid_argument, [](const std::invalid_argument &){return true;});
     BOOST_CHECK_EXCEPTION(mdp::SARSA(1,1,0.3,1.1),   std::invalid_argument, [](const std::invalid_argument &){return true;});
 }
+
+BOOST_AUTO_TEST_CASE( batchUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 10, A = 3;
+    auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::SARSA step(S, A, 0.9, 0.3);
+    mdp::SARSA batched(S, A, 0.9, 0.3);
+
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        step.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+    batched.batchUpdateQ(batch);
+
+    BOOST_CHECK( step.getQFunction() == batched.getQFunction() );
+
+    batch.nextActions.clear();
+    BOOST_CHECK_THROW( batched.batchUpdateQ(batch), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( concurrentUpdates ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 12, A = 3;
+    const auto batch = makeRandomTransitionBatch(S, A, 1000);
+
+    mdp::SARSA reference(S, A, 0.9, 0.3);
+    auto solver = reference;
+    reference.batchUpdateQ(batch);
+
+    solver.setConcurrentUpdates(5);
+    BOOST_CHECK_EQUAL(solver.getConcurrentUpdates(), 5);
+    for ( size_t i = 0; i < batch.states.size(); ++i )
+        solver.stepUpdateQ(batch.states[i], batch.actions[i], batch.nextStates[i], batch.nextActions[i], batch.rewards[i]);
+
+    BOOST_CHECK( solver.getQFunction() == reference.getQFunction() );
+}
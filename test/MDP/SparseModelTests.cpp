@@ -121,3 +121,111 @@ BOOST_AUTO_TEST_CASE( setTransitionFunction ) {
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE( float_model ) {
+    using namespace AIToolbox::MDP;
+
+    BOOST_CHECK(is_model_eigen_v<FloatSparseModel>);
+
+    GridWorld grid(4, 4);
+
+    auto model = makeCornerProblem(grid);
+    size_t S = model.getS(), A = model.getA();
+
+    FloatSparseModel copy(model);
+
+    BOOST_CHECK_EQUAL(model.getDiscount(), copy.getDiscount());
+    BOOST_CHECK_EQUAL(S, copy.getS());
+    BOOST_CHECK_EQUAL(A, copy.getA());
+
+    for ( size_t s = 0; s < S; ++s ) {
+        BOOST_CHECK_EQUAL(model.isTerminal(s), copy.isTerminal(s));
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(static_cast<float>(model.getTransitionProbability(s, a, s1)), copy.getTransitionProbability(s, a, s1));
+                BOOST_CHECK_EQUAL(model.getExpectedReward(s, a, s1), copy.getExpectedReward(s, a, s1));
+            }
+        }
+    }
+
+    for ( size_t i = 0; i < 100; ++i ) {
+        const auto [s1, r] = copy.sampleSR(5, 0);
+        BOOST_CHECK(s1 < S);
+        BOOST_CHECK_EQUAL(r, copy.getExpectedReward(5, 0, s1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( cassandraSparseCorner ) {
+    GridWorld grid(2, 2);
+
+    auto m = makeCornerProblem(grid);
+    size_t S = m.getS(), A = m.getA();
+
+    std::string inputFilename  = "./data/corner.MDP";
+
+    std::ifstream inputFile(inputFilename);
+    if ( !inputFile ) BOOST_FAIL("Data to perform test could not be loaded: " + inputFilename);
+
+    auto m2 = AIToolbox::MDP::parseCassandraSparse(inputFile);
+
+    BOOST_CHECK_EQUAL(m.getS(), m2.getS());
+    BOOST_CHECK_EQUAL(m.getA(), m2.getA());
+
+    for ( size_t a = 0; a < A; ++a )
+    for ( size_t s = 0; s < S; ++s )
+    for ( size_t s1 = 0; s1 < S; ++s1 ) {
+        BOOST_CHECK(AIToolbox::checkEqualSmall(m.getTransitionProbability(s, a, s1), m2.getTransitionProbability(s, a, s1)));
+        BOOST_CHECK(AIToolbox::checkEqualGeneral(m.getExpectedReward(s, a, s1), m2.getExpectedReward(s, a, s1)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( triplet_construction ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 0.9);
+    const size_t S = model.getS(), A = model.getA();
+
+    // Triplets are listed backwards, with some entries split in two, and
+    // without the rows of the corners, which are self-loops.
+    SparseModel::TransitionTriplets t(A);
+    SparseModel::RewardTriplets r;
+    for (size_t a = 0; a < A; ++a) {
+        for (size_t s = S; s-- > 0; ) {
+            if (s == 0 || s == S - 1) continue;
+            for (size_t s1 = 0; s1 < S; ++s1) {
+                const double p = model.getTransitionProbability(s, a, s1);
+                if (p == 0.0) continue;
+                t[a].emplace_back(s, s1, p / 2.0);
+                t[a].emplace_back(s, s1, p / 2.0);
+            }
+            if (const double rew = model.getExpectedReward(s, a, 0); rew != 0.0)
+                r.emplace_back(s, a, rew);
+        }
+    }
+
+    const SparseModel copy(model);
+    AIToolbox::ThreadPool pool(3);
+    for (auto * p : {static_cast<AIToolbox::ThreadPool*>(nullptr), &pool}) {
+        const SparseModel bulk(S, A, t, r, model.getDiscount(), p);
+        BOOST_CHECK_EQUAL(bulk.getDiscount(), model.getDiscount());
+        for (size_t a = 0; a < A; ++a)
+            BOOST_CHECK(bulk.getTransitionFunction(a).isApprox(copy.getTransitionFunction(a)));
+        BOOST_CHECK(bulk.getRewardFunction().isApprox(copy.getRewardFunction()));
+    }
+
+    // Invalid inputs.
+    BOOST_CHECK_THROW(SparseModel(S, A, SparseModel::TransitionTriplets(A - 1), r, 0.9), std::invalid_argument);
+    BOOST_CHECK_THROW(SparseModel(S, A, t, r, 0.0), std::invalid_argument);
+
+    auto badT = t;
+    badT[0].emplace_back(1, 2, 0.5);
+    BOOST_CHECK_THROW(SparseModel(S, A, badT, r, 0.9, &pool), std::invalid_argument);
+    badT = t;
+    badT[1].emplace_back(S, 0, 1.0);
+    BOOST_CHECK_THROW(SparseModel(S, A, badT, r, 0.9), std::invalid_argument);
+
+    auto badR = r;
+    badR.emplace_back(0, A, 1.0);
+    BOOST_CHECK_THROW(SparseModel(S, A, t, badR, 0.9), std::invalid_argument);
+}
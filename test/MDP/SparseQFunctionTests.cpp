@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE MDP_SparseQFunction
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/SparseQFunction.hpp>
+#include <AIToolbox/MDP/Algorithms/QLearning.hpp>
+#include <AIToolbox/MDP/Algorithms/SARSA.hpp>
+#include <AIToolbox/MDP/Algorithms/SparseQLearning.hpp>
+#include <AIToolbox/MDP/Algorithms/SparseSARSA.hpp>
+#include <AIToolbox/MDP/Policies/QGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Policies/SparseQGreedyPolicy.hpp>
+#include <AIToolbox/MDP/Policies/EpsilonPolicy.hpp>
+
+#include "Utils/TransitionBatch.hpp"
+
+BOOST_AUTO_TEST_CASE( storage ) {
+    namespace mdp = AIToolbox::MDP;
+
+    // A state space which could never be allocated densely.
+    const size_t S = 1000000000000, A = 3;
+    mdp::SparseQFunction q(S, A, 0.5);
+
+    BOOST_CHECK_EQUAL( q.size(), 0 );
+    BOOST_CHECK_EQUAL( q.getValue(123456789, 2), 0.5 );
+    BOOST_CHECK( !q.contains(123456789) );
+    BOOST_CHECK_EQUAL( q.getRow(S - 1).sum(), 1.5 );
+
+    // Enough states to make the table grow several times.
+    for ( size_t i = 0; i < 1000; ++i ) {
+        auto row = q.getRowRef(i * 1000003);
+        BOOST_CHECK_EQUAL( row[1], 0.5 );
+        row[0] = i;
+        q.getValueRef(i * 1000003, 2) = -1.0 * i;
+    }
+    BOOST_CHECK_EQUAL( q.size(), 1000 );
+
+    for ( size_t i = 0; i < 1000; ++i ) {
+        BOOST_CHECK( q.contains(i * 1000003) );
+        BOOST_CHECK_EQUAL( q.getValue(i * 1000003, 0), i );
+        BOOST_CHECK_EQUAL( q.getValue(i * 1000003, 1), 0.5 );
+        BOOST_CHECK_EQUAL( q.getValue(i * 1000003, 2), -1.0 * i );
+    }
+    BOOST_CHECK( !q.contains(1) );
+
+    size_t visited = 0;
+    q.forEachRow([&](const size_t s, const mdp::SparseQFunction::ConstRow & row) {
+        BOOST_CHECK_EQUAL( s % 1000003, 0 );
+        BOOST_CHECK_EQUAL( row[0], s / 1000003 );
+        ++visited;
+    });
+    BOOST_CHECK_EQUAL( visited, 1000 );
+
+    q.clear();
+    BOOST_CHECK_EQUAL( q.size(), 0 );
+    BOOST_CHECK_EQUAL( q.getValue(1000003, 0), 0.5 );
+}
+
+BOOST_AUTO_TEST_CASE( sameAsDense ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 50, A = 4;
+    const auto batch = makeRandomTransitionBatch(S, A, 5000);
+
+    mdp::QLearning dense(S, A, 0.9, 0.3);
+    mdp::SparseQLearning sparse(S, A, 0.9, 0.3);
+
+    std::vector<double> denseErrors, sparseErrors;
+    dense.batchUpdateQ(batch, &denseErrors);
+    sparse.batchUpdateQ(batch, &sparseErrors);
+
+    BOOST_CHECK( dense.getQFunction() == sparse.getQFunction().toDense() );
+    BOOST_CHECK( denseErrors == sparseErrors );
+
+    mdp::SARSA denseSarsa(S, A, 0.9, 0.3);
+    mdp::SparseSARSA sparseSarsa(S, A, 0.9, 0.3);
+    denseSarsa.batchUpdateQ(batch);
+    sparseSarsa.batchUpdateQ(batch);
+
+    BOOST_CHECK( denseSarsa.getQFunction() == sparseSarsa.getQFunction().toDense() );
+
+    mdp::QGreedyPolicy densePolicy(dense.getQFunction());
+    mdp::SparseQGreedyPolicy sparsePolicy(sparse.getQFunction());
+    BOOST_CHECK( densePolicy.getPolicy() == sparsePolicy.getPolicy() );
+
+    AIToolbox::Vector probs;
+    for ( size_t s = 0; s < S; ++s ) {
+        sparsePolicy.getActionProbabilities(s, &probs);
+        for ( size_t a = 0; a < A; ++a )
+            BOOST_CHECK_EQUAL( probs[a], densePolicy.getActionProbability(s, a) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( epsilonGreedy ) {
+    namespace mdp = AIToolbox::MDP;
+
+    const size_t S = 1000000000, A = 4;
+    mdp::SparseQLearning solver(S, A, 0.9, 1.0);
+    solver.stepUpdateQ(777, 2, 778, 10.0);
+
+    mdp::SparseQGreedyPolicy greedy(solver.getQFunction());
+    mdp::EpsilonPolicy policy(greedy, 0.1);
+
+    BOOST_CHECK_EQUAL( greedy.sampleAction(777), 2 );
+    BOOST_CHECK_CLOSE( policy.getActionProbability(777, 2), 0.9 + 0.1 / A, 0.000001 );
+    // Unvisited states are uniform.
+    BOOST_CHECK_CLOSE( policy.getActionProbability(778, 0), 1.0 / A, 0.000001 );
+    BOOST_CHECK_EQUAL( solver.getQFunction().size(), 1 );
+}
@@ -3,9 +3,12 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
+#include <AIToolbox/MDP/Experience.hpp>
 #include <AIToolbox/MDP/SparseExperience.hpp>
 #include <AIToolbox/MDP/SparseRLModel.hpp>
 
+#include <random>
+
 // #include <AIToolbox/MDP/IO.hpp>
 // #include <fstream>
 
@@ -169,6 +172,66 @@ BOOST_AUTO_TEST_CASE( sampling ) {
     BOOST_CHECK_MESSAGE( k > 2000 && k < 4000, "This test may fail from time to time as it is based on sampling. k should be ~3333. k is " << k ); // Hopefully
 }
 
+template <typename E>
+void testBatchSync() {
+    namespace mdp = AIToolbox::MDP;
+    const size_t S = 20, A = 3;
+
+    E exp(S, A);
+    mdp::SparseRLModel<E> model(exp, 1.0, false);
+
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<size_t> sDist(0, S - 1), aDist(0, A - 1);
+
+    for ( size_t round = 0; round < 10; ++round ) {
+        for ( size_t i = 0; i < 30; ++i ) {
+            const auto s = sDist(rand);
+            exp.record(s, aDist(rand), (s + sDist(rand) % 3) % S, static_cast<double>(sDist(rand)));
+        }
+
+        model.sync(exp.getDirtyPairs());
+        exp.clearDirtyPairs();
+
+        mdp::SparseRLModel<E> fullModel(exp, 1.0, true);
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a ) {
+                BOOST_CHECK_EQUAL( model.getExpectedReward(s, a, 0), fullModel.getExpectedReward(s, a, 0) );
+                for ( size_t s1 = 0; s1 < S; ++s1 )
+                    BOOST_CHECK_EQUAL( model.getTransitionProbability(s, a, s1), fullModel.getTransitionProbability(s, a, s1) );
+            }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batchSync ) {
+    testBatchSync<AIToolbox::MDP::Experience>();
+    testBatchSync<AIToolbox::MDP::SparseExperience>();
+}
+
+BOOST_AUTO_TEST_CASE( rowSlack ) {
+    namespace mdp = AIToolbox::MDP;
+    const size_t S = 50, A = 2;
+
+    mdp::SparseExperience exp(S, A);
+    mdp::SparseRLModel model(exp, 1.0, false);
+
+    // The matrices are kept uncompressed so that experience can be
+    // inserted one row at a time.
+    for ( size_t a = 0; a < A; ++a )
+        BOOST_CHECK( !model.getTransitionFunction(a).isCompressed() );
+
+    // Grow a single row well past its initial slack.
+    for ( size_t s1 = 0; s1 < S; ++s1 ) {
+        exp.record(7, 1, s1, 1.0);
+        model.sync(7, 1, s1);
+    }
+
+    for ( size_t s1 = 0; s1 < S; ++s1 )
+        BOOST_CHECK_CLOSE( model.getTransitionProbability(7, 1, s1), 1.0 / S, 0.0001 );
+    BOOST_CHECK_EQUAL( model.getTransitionProbability(6, 1, 6), 1.0 );
+    BOOST_CHECK_EQUAL( model.getTransitionProbability(8, 1, 8), 1.0 );
+    BOOST_CHECK_CLOSE( model.getExpectedReward(7, 1, 0), 1.0, 0.0001 );
+}
+
 /*
 BOOST_AUTO_TEST_CASE( IO ) {
     const int S = 10, A = 8;
@@ -0,0 +1,107 @@
+#define BOOST_TEST_MODULE MDP_Sparsify
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/MDP/Sparsify.hpp>
+#include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/RLModel.hpp>
+#include <AIToolbox/MDP/Algorithms/ValueIteration.hpp>
+
+#include "Utils/CornerProblem.hpp"
+
+namespace aim = AIToolbox::MDP;
+
+// The corner problem, where each transition leaks a tiny probability to
+// all other states, as in a model learned with a prior.
+aim::Model makeNoisyModel(const GridWorld & grid, const double noise) {
+    const auto model = makeCornerProblem(grid, 0.9);
+    const size_t S = model.getS(), A = model.getA();
+
+    aim::Model::TransitionMatrix t(A, AIToolbox::Matrix2D(S, S));
+    for (size_t a = 0; a < A; ++a) {
+        t[a] = model.getTransitionFunction(a) * (1.0 - noise * S);
+        t[a].array() += noise;
+    }
+    aim::Model::RewardMatrix r = model.getRewardFunction();
+    return aim::Model(AIToolbox::NO_CHECK, S, A, std::move(t), std::move(r), 0.9);
+}
+
+BOOST_AUTO_TEST_CASE( dropsSmallTransitions ) {
+    GridWorld grid(6, 6);
+    const auto model = makeNoisyModel(grid, 1e-4);
+    const size_t S = model.getS(), A = model.getA();
+
+    const auto [sparse, bound, dropped] = aim::sparsifyModel(model, 1e-3);
+
+    size_t nonZeros = 0;
+    for (size_t a = 0; a < A; ++a) {
+        nonZeros += sparse.getTransitionFunction(a).nonZeros();
+        for (size_t s = 0; s < S; ++s)
+            BOOST_CHECK_CLOSE(sparse.getTransitionFunction(a).row(s).sum(), 1.0, 1e-9);
+    }
+    // Only the original successors survive, at most two per row.
+    BOOST_CHECK(nonZeros <= 2 * S * A);
+    BOOST_CHECK_SMALL(dropped - (S - 1) * 1e-4, 1e-9);
+    BOOST_CHECK(sparse.getRewardFunction().isApprox(AIToolbox::SparseMatrix2D(model.getRewardFunction().sparseView())));
+
+    aim::ValueIteration vi(1000000, 1e-10);
+    const auto [b1, vf, q] = vi(model);
+    const auto [b2, svf, sq] = vi(sparse);
+    (void)b1; (void)b2; (void)q; (void)sq;
+
+    const double error = (vf.values - svf.values).cwiseAbs().maxCoeff();
+    BOOST_CHECK(error > 0.0);
+    BOOST_CHECK(error <= bound);
+}
+
+BOOST_AUTO_TEST_CASE( topSuccessors ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 0.9);
+    const size_t S = model.getS(), A = model.getA();
+
+    aim::Experience exp(S, A);
+    for (size_t s = 0; s < S; ++s)
+        for (size_t a = 0; a < A; ++a)
+            for (size_t s1 = 0; s1 < S; ++s1)
+                exp.record(s, a, s1, 0.0);
+    for (size_t s = 0; s < S; ++s)
+        for (size_t a = 0; a < A; ++a)
+            for (unsigned i = 0; i < 100; ++i) {
+                const auto [s1, r] = model.sampleSR(s, a);
+                exp.record(s, a, s1, r);
+            }
+    aim::RLModel rl(exp, 0.9, true);
+
+    const auto [sparse, bound, dropped] = aim::sparsifyModel(rl, 0.0, 2);
+    for (size_t a = 0; a < A; ++a)
+        for (size_t s = 0; s < S; ++s)
+            BOOST_CHECK(AIToolbox::SparseMatrix2D(sparse.getTransitionFunction(a).row(s)).nonZeros() <= 2);
+    BOOST_CHECK(dropped > 0.0);
+
+    aim::ValueIteration vi(1000000, 1e-10);
+    const auto [b1, vf, q] = vi(rl);
+    const auto [b2, svf, sq] = vi(sparse);
+    (void)b1; (void)b2; (void)q; (void)sq;
+    BOOST_CHECK((vf.values - svf.values).cwiseAbs().maxCoeff() <= bound);
+}
+
+BOOST_AUTO_TEST_CASE( noLoss ) {
+    GridWorld grid(4, 4);
+    const auto model = makeCornerProblem(grid, 0.9);
+
+    // Nothing is dropped, so the model is unchanged and the bound is 0.
+    const auto [sparse, bound, dropped] = aim::sparsifyModel(model, 0.0);
+    BOOST_CHECK_EQUAL(bound, 0.0);
+    BOOST_CHECK_EQUAL(dropped, 0.0);
+    for (size_t a = 0; a < model.getA(); ++a)
+        BOOST_CHECK(AIToolbox::Matrix2D(sparse.getTransitionFunction(a)) == model.getTransitionFunction(a));
+
+    // Without discount any loss gives an infinite bound.
+    auto undiscounted = makeNoisyModel(grid, 1e-4);
+    undiscounted.setDiscount(1.0);
+    BOOST_CHECK_EQUAL(std::get<1>(aim::sparsifyModel(undiscounted, 1e-3)), std::numeric_limits<double>::infinity());
+
+    BOOST_CHECK_THROW(aim::sparsifyModel(model, -1.0), std::invalid_argument);
+}
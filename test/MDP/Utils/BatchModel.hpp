@@ -0,0 +1,28 @@
+#ifndef AI_TOOLBOX_TEST_MDP_BATCH_MODEL_HEADER_FILE
+#define AI_TOOLBOX_TEST_MDP_BATCH_MODEL_HEADER_FILE
+
+#include <AIToolbox/MDP/Types.hpp>
+
+#include <tuple>
+
+// Wraps a model so that it also samples in batches, counting the calls.
+// The overloads taking an external engine are hidden, so that algorithms
+// which prefer them use the batches instead.
+template <typename M>
+struct BatchModel : M {
+    BatchModel(const M & m) : M(m) {}
+
+    std::tuple<size_t, double> sampleSR(size_t s, size_t a) const { return M::sampleSR(s, a); }
+
+    void sampleSRBatch(AIToolbox::MDP::TransitionBatch * batch) const {
+        ++batches;
+        samples += batch->states.size();
+        for ( size_t i = 0; i < batch->states.size(); ++i )
+            std::tie(batch->nextStates[i], batch->rewards[i]) = M::sampleSR(batch->states[i], batch->actions[i]);
+    }
+
+    mutable unsigned batches = 0;
+    mutable size_t samples = 0;
+};
+
+#endif
@@ -49,8 +49,8 @@ inline AIToolbox::MDP::Model makeCornerProblem(const GridWorld & grid, double st
     AIToolbox::DumbMatrix3D transitions(boost::extents[S][A][S]);
     AIToolbox::DumbMatrix3D rewards(boost::extents[S][A][S]);
 
-    for ( int x = 0; x < 4; ++x ) {
-        for ( int y = 0; y < 4; ++y ) {
+    for ( int x = 0; x < static_cast<int>(grid.getSizeX()); ++x ) {
+        for ( int y = 0; y < static_cast<int>(grid.getSizeY()); ++y ) {
             auto s = grid(x,y);
             if ( s == 0 || s == S-1 ) {
                 // Self absorbing states
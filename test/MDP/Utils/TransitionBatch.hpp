@@ -0,0 +1,24 @@
+#ifndef AI_TOOLBOX_TEST_MDP_TRANSITION_BATCH_HEADER_FILE
+#define AI_TOOLBOX_TEST_MDP_TRANSITION_BATCH_HEADER_FILE
+
+#include <AIToolbox/MDP/Types.hpp>
+
+#include <random>
+
+inline AIToolbox::MDP::TransitionBatch makeRandomTransitionBatch(const size_t S, const size_t A, const size_t N, const unsigned seed = 0) {
+    std::mt19937 rand(seed);
+    std::uniform_int_distribution<size_t> sDist(0, S - 1), aDist(0, A - 1);
+    std::uniform_real_distribution<double> rDist(-10.0, 10.0);
+
+    AIToolbox::MDP::TransitionBatch batch;
+    for ( size_t i = 0; i < N; ++i ) {
+        batch.states.push_back(sDist(rand));
+        batch.actions.push_back(aDist(rand));
+        batch.nextStates.push_back(sDist(rand));
+        batch.nextActions.push_back(aDist(rand));
+        batch.rewards.push_back(rDist(rand));
+    }
+    return batch;
+}
+
+#endif
@@ -9,8 +9,12 @@
 #include "Utils/CornerProblem.hpp"
 
 #include <AIToolbox/MDP/SparseModel.hpp>
+#include <AIToolbox/MDP/FusedSparseModel.hpp>
+#include <AIToolbox/MDP/Experience.hpp>
+#include <AIToolbox/MDP/RLModel.hpp>
 #include "Utils/OldMDPModel.hpp"
 
+#include <random>
 #include <type_traits>
 
 BOOST_AUTO_TEST_CASE( escapeToCorners ) {
@@ -294,3 +298,558 @@ BOOST_AUTO_TEST_CASE( escapeToCornersNonEigen ) {
         BOOST_CHECK_EQUAL( qfun.row(s).maxCoeff(), values[s] );
     }
 }
+
+BOOST_AUTO_TEST_CASE( parallelMatchesSerial ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+
+    AIToolbox::ThreadPool pool(3);
+
+    ValueIteration serial(1000000, 0.001);
+    ValueIteration parallel(1000000, 0.001);
+    parallel.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL( parallel.getThreadPool(), &pool );
+
+    const auto check = [&](const auto & m) {
+        auto [sBound, sVFun, sQFun] = serial(m);
+        auto [pBound, pVFun, pQFun] = parallel(m);
+
+        // Results must be exactly the same, not just approximately.
+        BOOST_CHECK_EQUAL( sBound, pBound );
+        BOOST_CHECK( sVFun.values == pVFun.values );
+        BOOST_CHECK( sVFun.actions == pVFun.actions );
+        BOOST_CHECK( sQFun == pQFun );
+    };
+
+    check(model);
+    check(sparseModel);
+    check(oldModel);
+
+    // Large enough to go through the vectorized kernels.
+    GridWorld bigGrid(6, 6);
+    Model bigModel = makeCornerProblem(bigGrid);
+    check(bigModel);
+
+    const auto [bound, vfun, qfun] = serial(bigModel);
+    const auto [sBound, sVFun, sQFun] = serial(SparseModel(bigModel));
+    BOOST_CHECK( vfun.values.isApprox(sVFun.values) );
+    BOOST_CHECK( vfun.actions == sVFun.actions );
+}
+
+BOOST_AUTO_TEST_CASE( inPlaceSweeps ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    SparseModel sparseModel(model);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+
+    ValueIteration jacobi(1000000, 0.00001);
+    const auto jVFun = std::get<1>(jacobi(model));
+
+    const auto check = [&](const auto & m, ValueIteration::Sweep sweep) {
+        ValueIteration solver(1000000, 0.00001);
+        solver.setSweep(sweep);
+        BOOST_CHECK( solver.getSweep() == sweep );
+
+        auto [bound, vfun, qfun] = solver(m);
+        BOOST_CHECK( bound <= solver.getTolerance() );
+
+        // In-place sweeps converge to the same fixed point.
+        for ( size_t s = 0; s < m.getS(); ++s ) {
+            BOOST_CHECK_SMALL( vfun.values[s] - jVFun.values[s], 0.001 );
+            BOOST_CHECK_EQUAL( qfun(s, vfun.actions[s]), vfun.values[s] );
+            BOOST_CHECK_EQUAL( qfun.row(s).maxCoeff(), vfun.values[s] );
+        }
+    };
+
+    for ( auto sweep : {ValueIteration::Sweep::GaussSeidel, ValueIteration::Sweep::Prioritized} ) {
+        check(model, sweep);
+        check(sparseModel, sweep);
+        check(oldModel, sweep);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( checkpoints ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+    Model model = makeCornerProblem(grid);
+
+    for ( auto sweep : {ValueIteration::Sweep::Jacobi, ValueIteration::Sweep::Prioritized} ) {
+        ValueIteration solver(1000000, 0.00001);
+        solver.setSweep(sweep);
+        const auto [bound, vfun, qfun] = solver(model);
+
+        // We keep the checkpoint of timestep 3, as if we were stopped then.
+        std::vector<ValueIterationCheckpoint> checkpoints;
+        solver.setCheckpointCallback([&](const ValueIterationCheckpoint & c) {
+            checkpoints.push_back(c);
+        }, 3);
+        BOOST_CHECK_EQUAL(solver.getCheckpointInterval(), 3);
+
+        solver(model);
+        BOOST_REQUIRE(checkpoints.size() > 1);
+        for ( size_t i = 0; i < checkpoints.size(); ++i )
+            BOOST_CHECK_EQUAL(checkpoints[i].timestep, 3 * (i + 1));
+
+        const auto [rbound, rvfun, rqfun] = solver(model, checkpoints[0]);
+
+        BOOST_CHECK_EQUAL(rbound, bound);
+        BOOST_CHECK(rvfun.values == vfun.values);
+        BOOST_CHECK(rvfun.actions == vfun.actions);
+        BOOST_CHECK(rqfun == qfun);
+    }
+
+    ValueIteration solver(10, 0.0);
+    ValueIterationCheckpoint wrong{1, 0.0, makeValueFunction(3), {}};
+    BOOST_CHECK_THROW(solver(model, wrong), std::invalid_argument);
+    BOOST_CHECK_THROW(solver.setCheckpointCallback([](const auto &){}, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( inlineQFunction ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    OldMDPModel oldModel = makeCornerProblem(grid);
+    const auto S = model.getS(), A = model.getA();
+
+    Values v(S);
+    for ( size_t s = 0; s < S; ++s ) v[s] = 0.5 * s;
+
+    const auto ir = computeImmediateRewards(model);
+    const auto check = [&](const auto & m) {
+        const QFunction truth = computeQFunction(m, v, ir);
+
+        // The workspace is reused, and it starts from garbage.
+        QFunction q(S, A);
+        q.fill(42.0);
+        computeQFunctionInline(m, v, ir, &q);
+        BOOST_CHECK( q == truth );
+
+        AIToolbox::ThreadPool pool(2);
+        q.fill(42.0);
+        computeQFunctionInline(m, v, ir, &q, pool);
+        BOOST_CHECK( q == truth );
+
+        // Input and output can alias.
+        QFunction q2 = ir;
+        computeQFunctionInline(m, v, q2, &q2);
+        BOOST_CHECK( q2 == truth );
+    };
+
+    check(model);
+    check(oldModel);
+}
+
+BOOST_AUTO_TEST_CASE( floatModels ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    Model model = makeCornerProblem(grid);
+    FloatModel floatModel(model);
+    FloatSparseModel floatSparseModel(model);
+
+    ValueIteration solver(1000000, 0.00001);
+    const auto vfun = std::get<1>(solver(model));
+
+    const auto check = [&](const auto & m, ValueIteration::Sweep sweep) {
+        solver.setSweep(sweep);
+        auto [fBound, fVFun, fQFun] = solver(m);
+        BOOST_CHECK( fBound <= solver.getTolerance() );
+
+        // Products are done in float, so we only expect approximately the
+        // same values; corner problem policies are unambiguous anyway.
+        for ( size_t s = 0; s < m.getS(); ++s ) {
+            BOOST_CHECK_SMALL( fVFun.values[s] - vfun.values[s], 0.001 );
+            BOOST_CHECK_EQUAL( fQFun.row(s).maxCoeff(), fVFun.values[s] );
+        }
+    };
+
+    for ( auto sweep : {ValueIteration::Sweep::Jacobi, ValueIteration::Sweep::GaussSeidel} ) {
+        check(floatModel, sweep);
+        check(floatSparseModel, sweep);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batchSolving ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(4, 4);
+
+    std::vector<Model> models;
+    for ( size_t i = 0; i < 7; ++i ) {
+        models.emplace_back(makeCornerProblem(grid, 0.6 + 0.05 * i));
+        models.back().setDiscount(0.8 + 0.02 * i);
+    }
+
+    AIToolbox::ThreadPool pool(3);
+
+    ValueIteration solver(1000000, 0.001);
+
+    for ( auto usePool : {false, true} ) {
+        solver.setThreadPool(usePool ? &pool : nullptr);
+        const auto results = solver.solveBatch(std::begin(models), std::end(models));
+        BOOST_CHECK_EQUAL( results.size(), models.size() );
+
+        // The pool is still available after the batch.
+        BOOST_CHECK_EQUAL( solver.getThreadPool(), usePool ? &pool : nullptr );
+
+        ValueIteration single(1000000, 0.001);
+        for ( size_t i = 0; i < models.size(); ++i ) {
+            const auto [bound, vfun, qfun] = single(models[i]);
+            const auto & [bBound, bVFun, bQFun] = results[i];
+
+            BOOST_CHECK_EQUAL( bound, bBound );
+            BOOST_CHECK( vfun.values == bVFun.values );
+            BOOST_CHECK( vfun.actions == bVFun.actions );
+            BOOST_CHECK( qfun == bQFun );
+        }
+    }
+
+    BOOST_CHECK( solver.solveBatch(std::begin(models), std::begin(models)).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( bellman_operator_kernels ) {
+    namespace mdp = AIToolbox::MDP;
+
+    AIToolbox::RandomEngine rand(42);
+    std::uniform_int_distribution<int> dist(0, 5);
+    AIToolbox::ThreadPool pool(3);
+
+    // Covers the specialized kernels, the generic fallback and leftover rows.
+    for ( const size_t A : {1, 2, 3, 4, 7, 16, 17, 20} ) {
+        for ( const size_t S : {1, 8, 13, 100} ) {
+            // Small integer values to get plenty of ties.
+            mdp::QFunction q(S, A);
+            for ( size_t s = 0; s < S; ++s )
+                for ( size_t a = 0; a < A; ++a )
+                    q(s, a) = dist(rand);
+
+            auto v = mdp::makeValueFunction(S);
+            auto pv = mdp::makeValueFunction(S);
+            mdp::bellmanOperatorInline(q, &v);
+            mdp::bellmanOperatorInline(q, &pv, pool);
+
+            for ( size_t s = 0; s < S; ++s ) {
+                size_t best;
+                const double max = q.row(s).maxCoeff(&best);
+                BOOST_CHECK_EQUAL( v.values[s], max );
+                BOOST_CHECK_EQUAL( v.actions[s], best );
+                BOOST_CHECK_EQUAL( pv.values[s], max );
+                BOOST_CHECK_EQUAL( pv.actions[s], best );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( actionElimination ) {
+    using namespace AIToolbox::MDP;
+
+    // Many actions, of which only a few are competitive in each state.
+    const size_t S = 20, A = 50;
+    AIToolbox::RandomEngine rand(7);
+    std::uniform_real_distribution<double> noise(0.0, 1.0);
+    std::uniform_int_distribution<size_t> next(0, S - 1);
+
+    AIToolbox::DumbMatrix3D transitions(boost::extents[S][A][S]);
+    AIToolbox::DumbMatrix3D rewards(boost::extents[S][A][S]);
+    for ( size_t s = 0; s < S; ++s ) {
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( unsigned i = 0; i < 3; ++i )
+                transitions[s][a][next(rand)] += 1.0 / 3.0;
+            for ( size_t s1 = 0; s1 < S; ++s1 )
+                rewards[s][a][s1] = noise(rand) - 0.2 * a;
+        }
+    }
+    Model model(S, A, transitions, rewards, 0.9);
+    SparseModel sparseModel(model);
+
+    // Elimination needs a tolerance, as it only applies when converging to V*.
+    const double tolerance = 1e-5;
+    ValueIteration full(1000000, tolerance);
+    ValueIteration pruned(1000000, tolerance);
+    pruned.setActionElimination(true);
+    BOOST_CHECK( pruned.getActionElimination() );
+
+    AIToolbox::ThreadPool pool(3);
+    ValueIteration parallel(1000000, tolerance);
+    parallel.setActionElimination(true);
+    parallel.setThreadPool(&pool);
+
+    const auto check = [&](const auto & m) {
+        const auto [bound, vfun, qfun] = full(m);
+        BOOST_CHECK_EQUAL( full.getEliminatedPairs(), 0 );
+
+        const auto [pBound, pVFun, pQFun] = pruned(m);
+        BOOST_CHECK( pBound <= tolerance );
+        BOOST_CHECK( pruned.getEliminatedPairs() > S * A / 2 );
+
+        BOOST_CHECK( vfun.actions == pVFun.actions );
+        for ( size_t s = 0; s < S; ++s ) {
+            // Both are within discount / (1 - discount) * tolerance of V*.
+            BOOST_CHECK_SMALL( vfun.values[s] - pVFun.values[s], 1e-3 );
+            // The QFunction is complete, including eliminated pairs.
+            for ( size_t a = 0; a < A; ++a )
+                BOOST_CHECK_SMALL( qfun(s, a) - pQFun(s, a), 1e-3 );
+        }
+
+        const auto [tBound, tVFun, tQFun] = parallel(m);
+        BOOST_CHECK_EQUAL( pBound, tBound );
+        BOOST_CHECK( pVFun.values == tVFun.values );
+        BOOST_CHECK( pQFun == tQFun );
+        BOOST_CHECK_EQUAL( pruned.getEliminatedPairs(), parallel.getEliminatedPairs() );
+    };
+    check(model);
+    check(sparseModel);
+
+    // Finite-horizon solves are not converging to V*, so the bounds do not
+    // apply and the results must be identical.
+    ValueIteration finite(5, 0.0);
+    ValueIteration finitePruned(5, 0.0);
+    finitePruned.setActionElimination(true);
+    const auto [fBound, fVFun, fQFun] = finite(model);
+    const auto [fpBound, fpVFun, fpQFun] = finitePruned(model);
+    BOOST_CHECK_EQUAL( finitePruned.getEliminatedPairs(), 0 );
+    BOOST_CHECK_EQUAL( fBound, fpBound );
+    BOOST_CHECK( fVFun.values == fpVFun.values );
+    BOOST_CHECK( fVFun.actions == fpVFun.actions );
+    BOOST_CHECK( fQFun == fpQFun );
+
+    // Without discount there are no bounds, so nothing is eliminated.
+    model.setDiscount(1.0);
+    pruned.setHorizon(50);
+    pruned(model);
+    BOOST_CHECK_EQUAL( pruned.getEliminatedPairs(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( topologicalSweeps ) {
+    using namespace AIToolbox::MDP;
+
+    // A chain of rooms with two states each, which can only move forward
+    // to the next room. The last room is absorbing.
+    const size_t rooms = 10, S = rooms * 2, A = 3;
+    AIToolbox::DumbMatrix3D transitions(boost::extents[S][A][S]);
+    AIToolbox::DumbMatrix3D rewards(boost::extents[S][A][S]);
+    for ( size_t s = 0; s < S; ++s ) {
+        const size_t room = s / 2;
+        if ( room == rooms - 1 ) {
+            for ( size_t a = 0; a < A; ++a )
+                transitions[s][a][s] = 1.0;
+            continue;
+        }
+        const size_t next = (room + 1) * 2;
+        transitions[s][0][s] = 1.0;
+        transitions[s][1][next] = 0.5;
+        transitions[s][1][s] = 0.5;
+        transitions[s][2][next + 1] = 1.0;
+        for ( size_t s1 = 0; s1 < S; ++s1 )
+            for ( size_t a = 0; a < A; ++a )
+                rewards[s][a][s1] = -1.0 - 0.1 * a - 0.05 * (s % 2);
+    }
+    Model model(S, A, transitions, rewards, 0.95);
+    SparseModel sparseModel(model);
+
+    const auto components = computeStronglyConnectedComponents(sparseModel);
+    BOOST_CHECK_EQUAL( components.size(), S );
+    {
+        // Each state is its own component; successors come first.
+        std::vector<size_t> position(S);
+        for ( size_t c = 0; c < components.size(); ++c ) {
+            BOOST_CHECK_EQUAL( components[c].size(), 1 );
+            position[components[c][0]] = c;
+        }
+        for ( size_t s = 0; s + 2 < S; ++s )
+            BOOST_CHECK( position[(s / 2 + 1) * 2] < position[s] );
+    }
+
+    // Make the two states of each room strongly connected.
+    model.setTransitionFunction([&]{
+        AIToolbox::DumbMatrix3D t = transitions;
+        for ( size_t s = 0; s + 2 < S; ++s ) {
+            t[s][0][s] = 0.0;
+            t[s][0][s ^ 1] = 1.0;
+        }
+        return t;
+    }());
+    sparseModel = SparseModel(model);
+
+    const auto roomComponents = computeStronglyConnectedComponents(model);
+    BOOST_CHECK_EQUAL( roomComponents.size(), rooms + 1 );
+    BOOST_CHECK( roomComponents == computeStronglyConnectedComponents(sparseModel) );
+    // The two absorbing states come first, then rooms from the last.
+    for ( size_t c = 2; c < roomComponents.size(); ++c ) {
+        BOOST_CHECK_EQUAL( roomComponents[c].size(), 2 );
+        BOOST_CHECK_EQUAL( roomComponents[c][0] ^ 1, roomComponents[c][1] );
+        BOOST_CHECK( roomComponents[c][0] < roomComponents[c - 1][0] );
+    }
+
+    ValueIteration jacobi(1000000, 0.00001);
+    ValueIteration topological(1000000, 0.00001);
+    topological.setSweep(ValueIteration::Sweep::Topological);
+
+    AIToolbox::ThreadPool pool(3);
+    ValueIteration parallel(1000000, 0.00001);
+    parallel.setSweep(ValueIteration::Sweep::Topological);
+    parallel.setThreadPool(&pool);
+
+    const auto check = [&](const auto & m) {
+        const auto [bound, vfun, qfun] = jacobi(m);
+        const auto [tBound, tVFun, tQFun] = topological(m);
+
+        BOOST_CHECK( tBound <= 0.00001 );
+        // Actions with the same value may be chosen differently, so we
+        // only check that the chosen ones are optimal.
+        for ( size_t s = 0; s < m.getS(); ++s ) {
+            BOOST_CHECK_SMALL( vfun.values[s] - tVFun.values[s], 0.001 );
+            BOOST_CHECK_SMALL( vfun.values[s] - qfun(s, tVFun.actions[s]), 0.001 );
+        }
+
+        const auto [pBound, pVFun, pQFun] = parallel(m);
+        BOOST_CHECK_EQUAL( tBound, pBound );
+        BOOST_CHECK( tVFun.values == pVFun.values );
+        BOOST_CHECK( tQFun == pQFun );
+    };
+    check(model);
+    check(sparseModel);
+
+    // A single large component, plus the two absorbing corners.
+    GridWorld grid(4, 4);
+    check(makeCornerProblem(grid));
+}
+
+BOOST_AUTO_TEST_CASE( multipleRewards ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(6, 6);
+    const Model base = makeCornerProblem(grid);
+    const size_t S = base.getS(), A = base.getA();
+
+    AIToolbox::RandomEngine rand(3);
+    std::uniform_real_distribution<double> dist(-1.0, 0.0);
+
+    const size_t K = 6;
+    AIToolbox::Matrix3D rewards(K, AIToolbox::Matrix2D(S, A));
+    std::vector<double> discounts;
+    for ( size_t k = 0; k < K; ++k ) {
+        for ( size_t s = 0; s < S; ++s )
+            for ( size_t a = 0; a < A; ++a )
+                rewards[k](s, a) = dist(rand);
+        discounts.push_back(0.5 + 0.08 * k);
+    }
+
+    AIToolbox::ThreadPool pool(3);
+    ValueIteration solver(1000000, 0.00001);
+
+    const auto check = [&](const auto & m, const std::vector<double> & d, bool usePool) {
+        solver.setThreadPool(usePool ? &pool : nullptr);
+        const auto results = solver.solveRewards(m, rewards, d);
+        BOOST_CHECK_EQUAL( results.size(), K );
+
+        for ( size_t k = 0; k < K; ++k ) {
+            Model single(base);
+            single.setRewardFunction(rewards[k]);
+            single.setDiscount(d.empty() ? base.getDiscount() : d.size() == 1 ? d[0] : d[k]);
+
+            const auto [bound, vfun, qfun] = ValueIteration(1000000, 0.00001)(single);
+            const auto & [mBound, mVFun, mQFun] = results[k];
+
+            BOOST_CHECK_SMALL( bound - mBound, 1e-9 );
+            BOOST_CHECK( vfun.actions == mVFun.actions );
+            BOOST_CHECK( vfun.values.isApprox(mVFun.values, 1e-9) );
+            BOOST_CHECK( qfun.isApprox(mQFun, 1e-9) );
+        }
+    };
+
+    for ( const auto usePool : {false, true} ) {
+        check(base, discounts, usePool);
+        check(SparseModel(base), discounts, usePool);
+        check(FusedSparseModel(base), discounts, usePool);
+        check(OldMDPModel(base), {0.9}, usePool);
+        check(base, {}, usePool);
+    }
+
+    BOOST_CHECK_THROW( solver.solveRewards(base, rewards, {0.9, 0.8}), std::invalid_argument );
+    BOOST_CHECK_THROW( solver.solveRewards(base, rewards, {1.5}), std::invalid_argument );
+    BOOST_CHECK_THROW( solver.solveRewards(base, {AIToolbox::Matrix2D(S, A + 1)}), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( incrementalResolve ) {
+    using namespace AIToolbox::MDP;
+
+    GridWorld grid(8, 8);
+    const auto cornerModel = makeCornerProblem(grid, 0.9);
+    const size_t S = cornerModel.getS(), A = cornerModel.getA();
+
+    Experience exp(S, A);
+    for ( size_t s = 0; s < S; ++s )
+        for ( size_t a = 0; a < A; ++a )
+            for ( unsigned i = 0; i < 5; ++i ) {
+                const auto [s1, r] = cornerModel.sampleSR(s, a);
+                exp.record(s, a, s1, r);
+            }
+    RLModel model(exp, 0.9, true);
+
+    const double tolerance = 0.00001;
+    ValueIteration solver(1000000, tolerance);
+    const auto [bound, vfun, qfun] = solver(model);
+    (void)bound; (void)qfun;
+
+    // Nothing changed, nothing to do.
+    {
+        const auto [rBound, rVFun, rQFun] = solver.resolve(model, vfun, {});
+        BOOST_CHECK( rBound <= tolerance );
+        for ( size_t s = 0; s < S; ++s )
+            BOOST_CHECK_SMALL( rVFun.values[s] - vfun.values[s], 0.001 );
+    }
+
+    // A couple of pairs now lead, with a large reward, to a state in the
+    // middle of the grid.
+    const size_t middle = grid(4, 4);
+    const std::vector<std::pair<size_t, size_t>> changed{{grid(3, 4), RIGHT}, {grid(5, 4), LEFT}};
+    for ( const auto & [s, a] : changed ) {
+        for ( unsigned i = 0; i < 20; ++i )
+            exp.record(s, a, middle, 5.0);
+        model.sync(s, a);
+    }
+
+    const auto [fBound, fVFun, fQFun] = solver(model);
+    (void)fBound;
+
+    AIToolbox::ThreadPool pool(3);
+    ValueIteration parallel(1000000, tolerance);
+    parallel.setThreadPool(&pool);
+
+    for ( auto * vi : {&solver, &parallel} ) {
+        const auto [rBound, rVFun, rQFun] = vi->resolve(model, vfun, changed);
+        // Changes below the tolerance are not propagated, so the
+        // residual can be somewhat larger than it.
+        BOOST_CHECK( rBound <= 10 * tolerance );
+        for ( size_t s = 0; s < S; ++s ) {
+            BOOST_CHECK_SMALL( rVFun.values[s] - fVFun.values[s], 0.001 );
+            // Ties in the grid may be broken differently.
+            BOOST_CHECK_SMALL( fQFun(s, rVFun.actions[s]) - fVFun.values[s], 0.001 );
+            for ( size_t a = 0; a < A; ++a )
+                BOOST_CHECK_SMALL( rQFun(s, a) - fQFun(s, a), 0.001 );
+        }
+    }
+
+    // Sparse models give the same results.
+    const auto [sBound, sVFun, sQFun] = solver.resolve(SparseModel(model), vfun, changed);
+    (void)sBound; (void)sQFun;
+    for ( size_t s = 0; s < S; ++s )
+        BOOST_CHECK_SMALL( sVFun.values[s] - fVFun.values[s], 0.001 );
+
+    BOOST_CHECK_THROW( solver.resolve(model, makeValueFunction(S - 1), changed), std::invalid_argument );
+    BOOST_CHECK_THROW( solver.resolve(model, vfun, {{S, 0}}), std::invalid_argument );
+    BOOST_CHECK_THROW( solver.resolve(model, vfun, {{0, A}}), std::invalid_argument );
+}
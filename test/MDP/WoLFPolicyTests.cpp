@@ -85,3 +85,39 @@ BOOST_AUTO_TEST_CASE( matching_pennies ) {
     BOOST_CHECK(policy.getActionProbability(0,0) < 0.6);
     BOOST_CHECK(policy.getActionProbability(0,0) > 0.4);
 }
+
+BOOST_AUTO_TEST_CASE( views_and_dirty_states ) {
+    using namespace AIToolbox;
+    constexpr size_t S = 4, A = 3;
+
+    auto q = MDP::makeQFunction(S, A);
+    q.row(1) << 1.0, 0.0, 0.0;
+    q.row(3) << 0.0, 0.0, 2.0;
+
+    MDP::WoLFPolicy policy(q);
+    const auto & current = policy.getPolicyMatrix();
+    const auto & average = policy.getAveragePolicyMatrix();
+    BOOST_CHECK(policy.getDirtyStates().empty());
+
+    policy.stepUpdateP(3);
+    policy.stepUpdateP(1);
+    policy.stepUpdateP(3);
+
+    BOOST_CHECK((policy.getDirtyStates() == MDP::WoLFPolicy::DirtyStates{3, 1}));
+    BOOST_CHECK_EQUAL(policy.getUpdateCounts()[3], 2);
+    BOOST_CHECK_EQUAL(policy.getUpdateCounts()[0], 0);
+
+    // The views reflect the updates without copying.
+    BOOST_CHECK(current == policy.getPolicy());
+    BOOST_CHECK(current(3, 2) > 1.0 / A);
+    BOOST_CHECK(average(3, 2) > 1.0 / A);
+    for (size_t s : {0, 2})
+        for (size_t a = 0; a < A; ++a)
+            BOOST_CHECK_EQUAL(current(s, a), 1.0 / A);
+
+    policy.clearDirtyStates();
+    BOOST_CHECK(policy.getDirtyStates().empty());
+
+    policy.stepUpdateP(1);
+    BOOST_CHECK((policy.getDirtyStates() == MDP::WoLFPolicy::DirtyStates{1}));
+}
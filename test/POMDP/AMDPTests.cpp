@@ -93,3 +93,42 @@ BOOST_AUTO_TEST_CASE( discountedHorizonSparse ) {
     for ( auto i = 0; i < beliefs.rows(); ++i )
         BOOST_CHECK_EQUAL( truthPolicy.sampleAction(beliefs.row(i)), policy.sampleAction( beliefConverter(beliefs.row(i)) ) );
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::AMDP converter(4000, 70);
+    BOOST_CHECK_EQUAL(converter.getThreadPool(), nullptr);
+
+    Impl::Seeder::setRootSeed(12345);
+    const auto [denseModel, denseConverter] = converter.discretizeDense(model);
+    (void)denseConverter;
+
+    ThreadPool pool(4);
+    converter.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL(converter.getThreadPool(), &pool);
+
+    // The same beliefs are sampled, and blocks are merged in order, so the
+    // result must not depend on the threads.
+    Impl::Seeder::setRootSeed(12345);
+    const auto [parallelModel, parallelConverter] = converter.discretizeDense(model);
+    Impl::Seeder::setRootSeed(12345);
+    const auto [sparseModel, sparseConverter] = converter.discretizeSparse(model);
+    (void)parallelConverter; (void)sparseConverter;
+
+    BOOST_CHECK_EQUAL(denseModel.getS(), parallelModel.getS());
+    BOOST_CHECK_EQUAL(denseModel.getS(), sparseModel.getS());
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        BOOST_CHECK(denseModel.getTransitionFunction(a) == parallelModel.getTransitionFunction(a));
+        BOOST_CHECK(denseModel.getTransitionFunction(a).isApprox(Matrix2D(sparseModel.getTransitionFunction(a))));
+    }
+    BOOST_CHECK(denseModel.getRewardFunction() == parallelModel.getRewardFunction());
+    BOOST_CHECK(denseModel.getRewardFunction().isApprox(Matrix2D(sparseModel.getRewardFunction())));
+
+    for ( size_t a = 0; a < model.getA(); ++a )
+        for ( size_t s = 0; s < denseModel.getS(); ++s )
+            BOOST_CHECK_CLOSE(denseModel.getTransitionFunction(a).row(s).sum(), 1.0, 0.0001);
+}
@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE POMDP_BeliefGenerator
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/Algorithms/Utils/BeliefGenerator.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include "Utils/Models.hpp"
+#include "Utils/BatchModel.hpp"
+
+BOOST_AUTO_TEST_CASE( generation ) {
+    using namespace AIToolbox;
+
+    const auto model = chengD35();
+
+    constexpr size_t beliefNumber = 500;
+    POMDP::BeliefGenerator bGen(model);
+    const auto beliefs = bGen(beliefNumber);
+
+    BOOST_CHECK_EQUAL(beliefs.size(), beliefNumber);
+    for ( size_t i = 0; i < beliefs.size(); ++i ) {
+        BOOST_CHECK(isProbability(model.getS(), beliefs[i]));
+        for ( size_t j = 0; j < i; ++j )
+            BOOST_CHECK(checkDifferentSmall((beliefs[i] - beliefs[j]).lpNorm<1>(), 0.0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    const auto model = chengD35();
+
+    constexpr size_t beliefNumber = 2000;
+
+    Impl::Seeder::setRootSeed(12345);
+    POMDP::BeliefGenerator sGen(model);
+    const auto serial = sGen(beliefNumber);
+
+    // Successors are sampled in fixed batches, each with its own streams,
+    // so the number of threads does not change what we find.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+
+        Impl::Seeder::setRootSeed(12345);
+        POMDP::BeliefGenerator pGen(model);
+        pGen.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(pGen.getThreadPool(), &pool);
+        const auto parallel = pGen(beliefNumber);
+
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t i = 0; i < serial.size(); ++i )
+            BOOST_CHECK_EQUAL(parallel[i], serial[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batchedSampling ) {
+    using namespace AIToolbox;
+
+    const BatchModel model(chengD35());
+
+    constexpr size_t beliefNumber = 500;
+    POMDP::BeliefGenerator bGen(model);
+    const auto beliefs = bGen(beliefNumber);
+
+    BOOST_CHECK(model.sorBatches > 0);
+    BOOST_CHECK_EQUAL(beliefs.size(), beliefNumber);
+    for ( size_t i = 0; i < beliefs.size(); ++i ) {
+        BOOST_CHECK(isProbability(model.getS(), beliefs[i]));
+        for ( size_t j = 0; j < i; ++j )
+            BOOST_CHECK(checkDifferentSmall((beliefs[i] - beliefs[j]).lpNorm<1>(), 0.0));
+    }
+}
@@ -0,0 +1,99 @@
+#define BOOST_TEST_MODULE POMDP_BeliefUpdateCache
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/BeliefUpdateCache.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include "Utils/TigerProblem.hpp"
+
+#include <vector>
+
+BOOST_AUTO_TEST_CASE( matchesUpdateBelief ) {
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    const POMDP::BeliefUpdateCache cache(model, 100);
+
+    const POMDP::Belief b = (POMDP::Belief(2) << 0.3, 0.7).finished();
+    for (size_t a = 0; a < model.getA(); ++a) {
+        for (size_t o = 0; o < model.getO(); ++o) {
+            const auto entry = cache.update(b, a, o);
+            const auto unnormalized = POMDP::updateBeliefUnnormalized(model, b, a, o);
+
+            BOOST_CHECK_CLOSE(entry->probability, unnormalized.sum(), 0.000001);
+            BOOST_CHECK(entry->belief.isApprox(unnormalized / unnormalized.sum()));
+        }
+    }
+    BOOST_CHECK_EQUAL(cache.getMisses(), model.getA() * model.getO());
+    BOOST_CHECK_EQUAL(cache.getHits(), 0);
+
+    // The same belief, up to the resolution, hits the cache.
+    const POMDP::Belief close = (POMDP::Belief(2) << 0.3 + 1e-12, 0.7 - 1e-12).finished();
+    const auto first = cache.update(b, 0, 1);
+    const auto second = cache.update(close, 0, 1);
+    BOOST_CHECK_EQUAL(first, second);
+    BOOST_CHECK_EQUAL(cache.getHits(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( eviction ) {
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    POMDP::BeliefUpdateCache cache(model, 2, 1e-9, 1);
+
+    const POMDP::Belief b = (POMDP::Belief(2) << 0.5, 0.5).finished();
+    const auto kept = cache.update(b, 0, 0);
+    cache.update(b, 0, 1);
+
+    // (0,0) was used most recently, so (0,1) gets evicted.
+    cache.update(b, 0, 0);
+    cache.update(b, 1, 0);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    BOOST_CHECK_EQUAL(cache.update(b, 0, 0), kept);
+    const auto misses = cache.getMisses();
+    cache.update(b, 0, 1);
+    BOOST_CHECK_EQUAL(cache.getMisses(), misses + 1);
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    BOOST_CHECK_EQUAL(cache.getHits(), 0);
+
+    // A disabled cache stores nothing.
+    POMDP::BeliefUpdateCache disabled(model, 0);
+    disabled.update(b, 0, 0);
+    disabled.update(b, 0, 0);
+    BOOST_CHECK_EQUAL(disabled.size(), 0);
+    BOOST_CHECK_EQUAL(disabled.getMisses(), 2);
+
+    BOOST_CHECK_THROW(POMDP::BeliefUpdateCache(model, 10, 0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(POMDP::BeliefUpdateCache(model, 10, 1e-9, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( concurrentUpdates ) {
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    const POMDP::BeliefUpdateCache cache(model, 1000, 1e-9, 4);
+
+    // Boost.Test checks are not thread-safe, so we check afterwards.
+    std::vector<char> correct(400);
+    ThreadPool pool(4);
+    pool.parallelFor(400, 1, [&](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const double p = (i % 10) / 10.0;
+            const size_t o = (i / 10) % 2;
+            const POMDP::Belief b = (POMDP::Belief(2) << p, 1.0 - p).finished();
+            const auto entry = cache.update(b, 0, o);
+            correct[i] = entry->belief.isApprox(POMDP::updateBelief(model, b, 0, o));
+        }
+    });
+
+    for (const auto c : correct)
+        BOOST_CHECK(c);
+    BOOST_CHECK_EQUAL(cache.size(), 20);
+    BOOST_CHECK_EQUAL(cache.getHits() + cache.getMisses(), 400);
+}
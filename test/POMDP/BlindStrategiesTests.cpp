@@ -8,6 +8,7 @@
 #include <AIToolbox/POMDP/SparseModel.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include "Utils/TigerProblem.hpp"
 
@@ -86,3 +87,31 @@ BOOST_AUTO_TEST_CASE( infiniteHorizonSpeededUp ) {
         vlistNormal[A_RIGHT].values[TIG_RIGHT]
     ) <= (2 * tolerance) / (1 - discount));
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::BlindStrategies solver(1000, 0.0001);
+    BOOST_CHECK_EQUAL(solver.getThreadPool(), nullptr);
+
+    const auto [var, vlist] = solver(model, false);
+
+    // Each action is solved on its own, so the result must not depend on
+    // the threads.
+    for ( const unsigned threads : {1u, 2u, 4u} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        const auto [pVar, pVList] = solver(model, false);
+        BOOST_CHECK_EQUAL(var, pVar);
+        BOOST_CHECK_EQUAL(vlist.size(), pVList.size());
+        for ( size_t a = 0; a < vlist.size(); ++a ) {
+            BOOST_CHECK_EQUAL(pVList[a].action, a);
+            BOOST_CHECK(vlist[a].values == pVList[a].values);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#define BOOST_TEST_MODULE POMDP_Evaluate
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Tools/Evaluate.hpp>
+
+#include "Utils/TigerProblem.hpp"
+#include "Utils/BatchModel.hpp"
+
+BOOST_AUTO_TEST_CASE( beliefTracking ) {
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    const POMDP::Belief b0 = POMDP::Belief::Constant(2, 0.5);
+
+    constexpr unsigned Episodes = 2000, Horizon = 10;
+
+    // Always listening costs 1 per timestep, and the agent should see the
+    // initial belief at the start of each episode, and then its updates.
+    bool sawInitial = true, sawUpdated = false, normalized = true;
+    const auto listen = evaluatePOMDP(model, b0, [&](unsigned) {
+        return [&](const POMDP::Belief & b, unsigned h) {
+            if (h == Horizon) sawInitial = sawInitial && b.isApprox(b0);
+            else sawUpdated = sawUpdated || !b.isApprox(b0);
+            normalized = normalized && checkEqualSmall(b.sum(), 1.0);
+            return size_t(A_LISTEN);
+        };
+    }, 100, Horizon).process();
+
+    BOOST_CHECK(sawInitial);
+    BOOST_CHECK(sawUpdated);
+    BOOST_CHECK(normalized);
+    BOOST_CHECK_CLOSE(std::get<1>(listen.back()), -double(Horizon), 1e-9);
+
+    // Opening a door only when confident should do better than listening,
+    // which is only possible if the belief is tracked correctly.
+    ThreadPool pool(4);
+    const auto smart = evaluatePOMDP(model, b0, [](unsigned) {
+        return [](const POMDP::Belief & b, unsigned) {
+            if (b[TIG_LEFT] > 0.9) return size_t(A_RIGHT);
+            if (b[TIG_RIGHT] > 0.9) return size_t(A_LEFT);
+            return size_t(A_LISTEN);
+        };
+    }, Episodes, Horizon, &pool).process();
+
+    BOOST_CHECK(std::get<1>(smart.back()) > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( batchedSampling ) {
+    using namespace AIToolbox;
+
+    const BatchModel model(makeTigerProblem());
+    const POMDP::Belief b0 = POMDP::Belief::Constant(2, 0.5);
+
+    constexpr unsigned Episodes = 2000, Horizon = 10;
+
+    ThreadPool pool(4);
+    const auto smart = evaluatePOMDP(model, b0, [](unsigned) {
+        return [](const POMDP::Belief & b, unsigned) {
+            if (b[TIG_LEFT] > 0.9) return size_t(A_RIGHT);
+            if (b[TIG_RIGHT] > 0.9) return size_t(A_LEFT);
+            return size_t(A_LISTEN);
+        };
+    }, Episodes, Horizon, &pool).process();
+
+    BOOST_CHECK(std::get<1>(smart.back()) > 0.0);
+
+    // Each thread runs its 500 episodes in 8 groups, with one batch per timestep.
+    BOOST_CHECK_EQUAL(model.sorSamples, Episodes * Horizon);
+    BOOST_CHECK_EQUAL(model.sorBatches, 4 * 8 * Horizon);
+}
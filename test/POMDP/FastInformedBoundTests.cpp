@@ -8,8 +8,10 @@
 #include <AIToolbox/POMDP/SparseModel.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
 
 #include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
 
 BOOST_AUTO_TEST_CASE( horizon1 ) {
     using namespace AIToolbox;
@@ -35,4 +37,34 @@ BOOST_AUTO_TEST_CASE( horizon1 ) {
             BOOST_CHECK(checkEqualGeneral(solution(s, a), qfun(s,a)));
 }
 
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = chengD35();
+    model.setDiscount(0.95);
 
+    constexpr unsigned horizon = 1000000;
+    constexpr double tolerance = 0.001;
+    POMDP::FastInformedBound solver(horizon, tolerance);
+
+    const auto sosa = POMDP::makeSOSA(model);
+    const auto [var, qfun] = solver(model, sosa);
+
+    // The terms are summed in the same order regardless of threads.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        const auto [pvar, pqfun] = solver(model, sosa);
+        BOOST_CHECK_EQUAL(var, pvar);
+        BOOST_CHECK_EQUAL(qfun, pqfun);
+
+        const POMDP::SOSACache cache(model);
+        const auto [cvar, cqfun] = solver(model, cache);
+        BOOST_CHECK(cvar < tolerance);
+        for (size_t s = 0; s < model.getS(); ++s)
+            for (size_t a = 0; a < model.getA(); ++a)
+                BOOST_CHECK(checkEqualGeneral(qfun(s, a), cqfun(s, a)));
+    }
+}
@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE POMDP_FixedModel
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/FixedModel.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/POMDP/Algorithms/BlindStrategies.hpp>
+
+#include "Utils/TigerProblem.hpp"
+
+using Tiger = AIToolbox::POMDP::FixedModel<2, 3, 2>;
+
+BOOST_AUTO_TEST_CASE( eigen_model ) {
+    BOOST_CHECK(AIToolbox::POMDP::is_model_eigen_v<Tiger>);
+}
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    using namespace AIToolbox::POMDP;
+
+    const auto model = makeTigerProblem();
+    const Tiger fixed(model);
+
+    BOOST_CHECK_EQUAL(fixed.getS(), 2);
+    BOOST_CHECK_EQUAL(fixed.getA(), 3);
+    BOOST_CHECK_EQUAL(fixed.getO(), 2);
+    BOOST_CHECK_EQUAL(fixed.getDiscount(), model.getDiscount());
+
+    for (size_t s1 = 0; s1 < 2; ++s1)
+        for (size_t a = 0; a < 3; ++a)
+            for (size_t o = 0; o < 2; ++o)
+                BOOST_CHECK_EQUAL(fixed.getObservationProbability(s1, a, o), model.getObservationProbability(s1, a, o));
+
+    BOOST_CHECK_THROW((FixedModel<2, 3, 3>(model)), std::invalid_argument);
+
+    const Tiger empty;
+    BOOST_CHECK_EQUAL(empty.getObservationProbability(1, 2, 0), 1.0);
+    BOOST_CHECK_EQUAL(std::get<1>(empty.sampleSOR(0, 0)), 0);
+}
+
+BOOST_AUTO_TEST_CASE( belief_updates ) {
+    using namespace AIToolbox::POMDP;
+
+    const auto model = makeTigerProblem();
+    const Tiger fixed(model);
+
+    Belief b(2); b << 0.3, 0.7;
+    FixedBelief<2> fb(b);
+
+    for (size_t a = 0; a < 3; ++a) {
+        BOOST_CHECK_CLOSE(beliefExpectedReward(model, b, a), beliefExpectedReward(fixed, fb, a), 1e-9);
+
+        const FixedBelief<2> partial = updateBeliefPartial(fixed, fb, a);
+        for (size_t o = 0; o < 2; ++o) {
+            const Belief truth = updateBelief(model, b, a, o);
+            const Belief truthU = updateBeliefUnnormalized(model, b, a, o);
+
+            const FixedBelief<2> nb = updateBelief(fixed, fb, a, o);
+            const FixedBelief<2> nbU = updateBeliefUnnormalized(fixed, fb, a, o);
+            const FixedBelief<2> nbP = updateBeliefPartialNormalized(fixed, partial, a, o);
+            FixedBelief<2> nbPU;
+            updateBeliefPartialUnnormalized(fixed, partial, a, o, &nbPU);
+
+            for (size_t s = 0; s < 2; ++s) {
+                BOOST_CHECK_CLOSE(truth[s], nb[s], 1e-9);
+                BOOST_CHECK_CLOSE(truthU[s], nbU[s], 1e-9);
+                BOOST_CHECK_CLOSE(truth[s], nbP[s], 1e-9);
+                BOOST_CHECK_CLOSE(truthU[s], nbPU[s], 1e-9);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( solving ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+    const Tiger fixed(model);
+
+    POMDP::BlindStrategies solver(1000, 0.0001);
+    const auto [var, vlist] = solver(model, true);
+    const auto [fvar, fvlist] = solver(fixed, true);
+
+    BOOST_CHECK_CLOSE(var, fvar, 1e-9);
+    BOOST_CHECK_EQUAL(vlist.size(), fvlist.size());
+    for (size_t i = 0; i < std::min(vlist.size(), fvlist.size()); ++i) {
+        BOOST_CHECK_EQUAL(vlist[i].action, fvlist[i].action);
+        for (size_t s = 0; s < 2; ++s)
+            BOOST_CHECK_CLOSE(vlist[i].values[s], fvlist[i].values[s], 1e-9);
+    }
+}
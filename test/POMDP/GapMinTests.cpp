@@ -4,7 +4,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/POMDP/Algorithms/GapMin.hpp>
+#include <AIToolbox/POMDP/BinaryIO.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <sstream>
 
 #include "Utils/Models.hpp"
 
@@ -24,3 +28,98 @@ BOOST_AUTO_TEST_CASE( discountedHorizon ) {
     (void)vlist;
     (void)qfun;
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto model = chengD35();
+
+    Belief initialBelief(model.getS());
+    initialBelief.fill(1.0 / model.getS());
+
+    GapMin gm(0.005, 3);
+    const auto [lb, ub, vlist, qfun] = gm(model, initialBelief);
+
+    ThreadPool pool(4);
+    gm.setThreadPool(&pool);
+    BOOST_CHECK_EQUAL(gm.getThreadPool(), &pool);
+
+    const auto [plb, pub, pvlist, pqfun] = gm(model, initialBelief);
+    BOOST_CHECK_EQUAL(lb, plb);
+    BOOST_CHECK_EQUAL(ub, pub);
+    BOOST_CHECK_EQUAL(vlist.size(), pvlist.size());
+    BOOST_CHECK_EQUAL(qfun, pqfun);
+}
+
+BOOST_AUTO_TEST_CASE( sawtoothInterpolation ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto model = chengD35();
+
+    Belief initialBelief(model.getS());
+    initialBelief.fill(1.0 / model.getS());
+
+    GapMin gm(0.005, 3);
+    BOOST_CHECK(gm.getInterpolation() == GapMin::Interpolation::LP);
+    const auto [lb, ub, vlist, qfun] = gm(model, initialBelief);
+
+    gm.setInterpolation(GapMin::Interpolation::Sawtooth);
+    BOOST_CHECK(gm.getInterpolation() == GapMin::Interpolation::Sawtooth);
+    const auto [slb, sub, svlist, sqfun] = gm(model, initialBelief);
+
+    // Both runs bound the same optimal value.
+    BOOST_CHECK(slb <= sub);
+    BOOST_CHECK(slb <= ub + 1e-6);
+    BOOST_CHECK(lb <= sub + 1e-6);
+
+    ThreadPool pool(4);
+    gm.setThreadPool(&pool);
+
+    const auto [plb, pub, pvlist, pqfun] = gm(model, initialBelief);
+    BOOST_CHECK_EQUAL(slb, plb);
+    BOOST_CHECK_EQUAL(sub, pub);
+    BOOST_CHECK_EQUAL(svlist.size(), pvlist.size());
+    BOOST_CHECK_EQUAL(sqfun, pqfun);
+    (void)vlist; (void)qfun;
+}
+
+BOOST_AUTO_TEST_CASE( checkpoints ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto model = chengD35();
+
+    Belief initialBelief(model.getS());
+    initialBelief.fill(1.0 / model.getS());
+
+    GapMin gm(0.005, 3);
+    gm.setInterpolation(GapMin::Interpolation::Sawtooth);
+
+    std::vector<std::string> checkpoints;
+    gm.setCheckpointCallback([&](const GapMinCheckpoint & c) {
+        std::stringstream stream;
+        writeBinary(stream, c);
+        checkpoints.push_back(stream.str());
+    });
+    const auto [lb, ub, vlist, qfun] = gm(model, initialBelief);
+    BOOST_REQUIRE(checkpoints.size() > 0);
+
+    std::stringstream stream(checkpoints[0]);
+    GapMinCheckpoint checkpoint;
+    BOOST_REQUIRE(readBinary(stream, checkpoint));
+    BOOST_CHECK_EQUAL(checkpoint.iteration, 1);
+    BOOST_CHECK(checkpoint.initialBelief == initialBelief);
+    BOOST_CHECK(checkpoint.lb <= checkpoint.ub);
+
+    gm.setCheckpointCallback(nullptr);
+    const auto [rlb, rub, rvlist, rqfun] = gm(model, checkpoint);
+    BOOST_CHECK_EQUAL(lb, rlb);
+    BOOST_CHECK_EQUAL(ub, rub);
+    BOOST_CHECK_EQUAL(vlist.size(), rvlist.size());
+    BOOST_CHECK_EQUAL(qfun, rqfun);
+
+    checkpoint.fibQ.resize(1, 1);
+    BOOST_CHECK_THROW(gm(model, checkpoint), std::invalid_argument);
+}
@@ -4,11 +4,14 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
+#include <AIToolbox/POMDP/BinaryIO.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/POMDP/SparseModel.hpp>
 #include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 
+#include <sstream>
+
 #include "Utils/TigerProblem.hpp"
 
 BOOST_AUTO_TEST_CASE( discountedHorizon ) {
@@ -302,3 +305,93 @@ BOOST_AUTO_TEST_CASE( undiscountedHorizonSparse ) {
         BOOST_CHECK_EQUAL(values, truthValues);
     }
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    constexpr unsigned horizon = 10;
+    POMDP::IncrementalPruning solver(horizon, 0.0);
+    const auto serial = std::get<1>(solver(model));
+
+    // Actions are split between threads, but the result is the same.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        const auto parallel = std::get<1>(solver(model));
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t t = 0; t < serial.size(); ++t ) {
+            BOOST_REQUIRE_EQUAL(parallel[t].size(), serial[t].size());
+            for ( size_t i = 0; i < serial[t].size(); ++i ) {
+                BOOST_CHECK_EQUAL(parallel[t][i].action, serial[t][i].action);
+                BOOST_CHECK(parallel[t][i].values == serial[t][i].values);
+                BOOST_CHECK(parallel[t][i].observations == serial[t][i].observations);
+            }
+        }
+    }
+    solver.setThreadPool(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( checkpoints ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::IncrementalPruning solver(8, 0.0);
+    const auto full = std::get<1>(solver(model));
+
+    // We store the checkpoint of timestep 4, as if we were stopped then.
+    std::stringstream stream;
+    solver.setCheckpointCallback([&](const POMDP::IncrementalPruningCheckpoint & c) {
+        if ( c.timestep == 4 ) POMDP::writeBinary(stream, c);
+    }, 2);
+    BOOST_CHECK_EQUAL(solver.getCheckpointInterval(), 2);
+    solver(model);
+
+    POMDP::IncrementalPruningCheckpoint checkpoint;
+    BOOST_REQUIRE(POMDP::readBinary(stream, checkpoint));
+    BOOST_CHECK_EQUAL(checkpoint.timestep, 4);
+    BOOST_CHECK_EQUAL(checkpoint.v.size(), 5);
+
+    const auto resumed = std::get<1>(solver(model, checkpoint));
+    BOOST_REQUIRE_EQUAL(resumed.size(), full.size());
+    for ( size_t t = 0; t < full.size(); ++t ) {
+        BOOST_REQUIRE_EQUAL(resumed[t].size(), full[t].size());
+        for ( size_t i = 0; i < full[t].size(); ++i ) {
+            BOOST_CHECK_EQUAL(resumed[t][i].action, full[t][i].action);
+            BOOST_CHECK(resumed[t][i].values == full[t][i].values);
+            BOOST_CHECK(resumed[t][i].observations == full[t][i].observations);
+        }
+    }
+
+    checkpoint.timestep = 2;
+    BOOST_CHECK_THROW(solver(model, checkpoint), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( warmStart ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::IncrementalPruning solver(6, 0.0);
+    const auto full = std::get<1>(solver(model));
+
+    // Continuing from the solution for an horizon of 3 for 3 more steps
+    // gives the same solution as solving for an horizon of 6.
+    solver.setHorizon(3);
+    const auto half = std::get<1>(solver(model));
+    const auto warm = std::get<1>(solver(model, half.back()));
+
+    BOOST_CHECK_EQUAL(warm.size(), 4);
+    BOOST_CHECK_EQUAL(warm.back().size(), full.back().size());
+    BOOST_CHECK(POMDP::weakBoundDistance(warm.back(), full.back()) < 1e-6);
+
+    BOOST_CHECK_THROW(solver(model, POMDP::VList()), std::invalid_argument);
+    BOOST_CHECK_THROW(solver(model, POMDP::makeValueFunction(3)[0]), std::invalid_argument);
+}
@@ -10,6 +10,7 @@
 #include <AIToolbox/Utils/Core.hpp>
 
 #include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
 
 BOOST_AUTO_TEST_CASE( discountedHorizon ) {
     using namespace AIToolbox;
@@ -154,3 +155,55 @@ BOOST_AUTO_TEST_CASE( undiscountedHorizon ) {
         BOOST_CHECK_EQUAL(values, truthValues);
     }
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = chengD35();
+
+    constexpr unsigned horizon = 5;
+    POMDP::LinearSupport solver(horizon, 0.0);
+    const auto serial = std::get<1>(solver(model));
+
+    // Vertices are found and evaluated in parallel, but the result is the same.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        const auto parallel = std::get<1>(solver(model));
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t t = 0; t < serial.size(); ++t ) {
+            BOOST_REQUIRE_EQUAL(parallel[t].size(), serial[t].size());
+            for ( size_t i = 0; i < serial[t].size(); ++i ) {
+                BOOST_CHECK_EQUAL(parallel[t][i].action, serial[t][i].action);
+                BOOST_CHECK(parallel[t][i].values == serial[t][i].values);
+                BOOST_CHECK(parallel[t][i].observations == serial[t][i].observations);
+            }
+        }
+    }
+    solver.setThreadPool(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( warmStart ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::LinearSupport solver(6, 0.0);
+    const auto full = std::get<1>(solver(model));
+
+    // Continuing from the solution for an horizon of 3 for 3 more steps
+    // gives the same solution as solving for an horizon of 6.
+    solver.setHorizon(3);
+    const auto half = std::get<1>(solver(model));
+    const auto warm = std::get<1>(solver(model, half.back()));
+
+    BOOST_CHECK_EQUAL(warm.size(), 4);
+    BOOST_CHECK_EQUAL(warm.back().size(), full.back().size());
+    BOOST_CHECK(POMDP::weakBoundDistance(warm.back(), full.back()) < 1e-6);
+
+    BOOST_CHECK_THROW(solver(model, POMDP::VList()), std::invalid_argument);
+    BOOST_CHECK_THROW(solver(model, POMDP::makeValueFunction(3)[0]), std::invalid_argument);
+}
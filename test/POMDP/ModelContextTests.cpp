@@ -0,0 +1,94 @@
+#define BOOST_TEST_MODULE POMDP_ModelContext
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/ModelContext.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Algorithms/QMDP.hpp>
+#include <AIToolbox/POMDP/Algorithms/BlindStrategies.hpp>
+#include <AIToolbox/POMDP/Algorithms/FastInformedBound.hpp>
+#include <AIToolbox/POMDP/Algorithms/GapMin.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
+
+BOOST_AUTO_TEST_CASE( lazyQuantities ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    const POMDP::ModelContext context(model);
+    BOOST_CHECK_EQUAL(context.getS(), model.getS());
+    BOOST_CHECK_EQUAL(context.getA(), model.getA());
+    BOOST_CHECK_EQUAL(context.getO(), model.getO());
+    BOOST_CHECK_EQUAL(context.getSOSA().getBuildCount(), 0);
+    BOOST_CHECK_EQUAL(context.getMDPSolveCount(), 0);
+
+    BOOST_CHECK_EQUAL(context.getImmediateRewards(), MDP::computeImmediateRewards(model));
+
+    POMDP::QMDP qmdp(1000, 0.001);
+    const auto [var, vf, q] = qmdp(model);
+    const auto [cvar, cvf, cq] = qmdp(model, context);
+    BOOST_CHECK_EQUAL(var, cvar);
+    BOOST_CHECK_EQUAL(q, cq);
+    BOOST_CHECK_EQUAL(vf.size(), cvf.size());
+    BOOST_CHECK_EQUAL(context.getMDPSolveCount(), 1);
+
+    // Same parameters reuse the solution, new ones solve again.
+    qmdp(model, context);
+    BOOST_CHECK_EQUAL(context.getMDPSolveCount(), 1);
+    qmdp.setHorizon(10);
+    qmdp(model, context);
+    BOOST_CHECK_EQUAL(context.getMDPSolveCount(), 2);
+
+    const auto wrong = POMDP::Model<MDP::Model>(3, 2, 2);
+    BOOST_CHECK_THROW(qmdp(wrong, context), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( sharedBetweenAlgorithms ) {
+    using namespace AIToolbox;
+
+    auto model = chengD35();
+    model.setDiscount(0.95);
+    const POMDP::SparseModel<MDP::SparseModel> sparseModel(model);
+
+    for ( size_t i = 0; i < 2; ++i ) {
+        const POMDP::ModelContext context = i == 0 ? POMDP::ModelContext(model) : POMDP::ModelContext(sparseModel);
+        const auto run = [&](const auto & m) {
+            POMDP::BlindStrategies bs(1000000, 0.001);
+            const auto [bvar, bvlist] = bs(m, true);
+            const auto [cbvar, cbvlist] = bs(m, true, context);
+            BOOST_CHECK(checkEqualGeneral(bvar, cbvar));
+            BOOST_CHECK_EQUAL(bvlist.size(), cbvlist.size());
+            for ( size_t j = 0; j < bvlist.size(); ++j )
+                BOOST_CHECK(bvlist[j].values.isApprox(cbvlist[j].values));
+
+            POMDP::FastInformedBound fib(1000000, 0.001);
+            const auto [fvar, fq] = fib(m);
+            const auto [cfvar, cfq] = fib(m, context);
+            BOOST_CHECK(checkEqualGeneral(fvar, cfvar));
+            BOOST_CHECK(fq.isApprox(cfq));
+            BOOST_CHECK_EQUAL(context.getSOSA().getBuildCount(), m.getA() * m.getO());
+
+            POMDP::Belief initialBelief(m.getS());
+            initialBelief.fill(1.0 / m.getS());
+
+            POMDP::GapMin gm(0.005, 3);
+            gm.setInterpolation(POMDP::GapMin::Interpolation::Sawtooth);
+            const auto [lb, ub, vlist, q] = gm(m, initialBelief);
+            const auto [clb, cub, cvlist, cq] = gm(m, initialBelief, context);
+            BOOST_CHECK(checkEqualGeneral(lb, clb));
+            BOOST_CHECK(checkEqualGeneral(ub, cub));
+            BOOST_CHECK_EQUAL(vlist.size(), cvlist.size());
+            BOOST_CHECK(q.isApprox(cq));
+            // GapMin found all SOSA matrices already computed.
+            BOOST_CHECK_EQUAL(context.getSOSA().getBuildCount(), m.getA() * m.getO());
+        };
+        if ( i == 0 ) run(model);
+        else run(sparseModel);
+    }
+}
@@ -185,3 +185,37 @@ BOOST_AUTO_TEST_CASE( cassandraEjs4 ) {
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE( alias_sampling ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    const size_t S = model.getS(), A = model.getA(), O = model.getO();
+
+    BOOST_CHECK(!model.getObservationAliasSampling());
+    model.setAliasSampling(true);
+    model.setObservationAliasSampling(true);
+    BOOST_CHECK(model.getAliasSampling());
+    BOOST_CHECK(model.getObservationAliasSampling());
+
+    constexpr size_t trials = 50'000;
+    for ( size_t a = 0; a < A; ++a ) {
+        for ( size_t s1 = 0; s1 < S; ++s1 ) {
+            std::vector<size_t> counters(O);
+            for ( size_t i = 0; i < trials; ++i )
+                ++counters[std::get<0>(model.sampleOR(0, a, s1))];
+
+            for ( size_t o = 0; o < O; ++o ) {
+                const auto exactAmount = model.getObservationProbability(s1, a, o) * trials;
+                BOOST_CHECK(std::abs(counters[o] - exactAmount) < 0.05 * exactAmount);
+            }
+        }
+    }
+
+    for ( size_t i = 0; i < 100; ++i ) {
+        const auto [s1, o, r] = model.sampleSOR(0, 0);
+        BOOST_CHECK(s1 < S);
+        BOOST_CHECK(o < O);
+        BOOST_CHECK_EQUAL(r, model.getExpectedReward(0, 0, s1));
+    }
+}
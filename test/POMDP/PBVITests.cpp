@@ -7,8 +7,15 @@
 #include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 #include <AIToolbox/Utils/Core.hpp>
+#include <AIToolbox/Utils/SolverControl.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
 
 #include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
+
+#include <atomic>
+#include <thread>
 
 BOOST_AUTO_TEST_CASE( discountedHorizon ) {
     using namespace AIToolbox;
@@ -100,3 +107,174 @@ BOOST_AUTO_TEST_CASE( undiscountedHorizon ) {
             BOOST_CHECK_EQUAL(vlist[i].action, it->action);
     }
 }
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    Impl::Seeder::setRootSeed(12345);
+
+    auto model = chengD35();
+    model.setDiscount(0.95);
+
+    POMDP::BeliefGenerator bGen(model);
+    const auto beliefs = bGen(500);
+
+    constexpr unsigned horizon = 20;
+    POMDP::PBVI solver(beliefs.size(), horizon, 0.0);
+    const auto serial = std::get<1>(solver(model, beliefs));
+
+    // Beliefs are split between threads, but the result is the same.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        const auto parallel = std::get<1>(solver(model, beliefs));
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t t = 0; t < serial.size(); ++t ) {
+            BOOST_REQUIRE_EQUAL(parallel[t].size(), serial[t].size());
+            for ( size_t i = 0; i < serial[t].size(); ++i ) {
+                BOOST_CHECK_EQUAL(parallel[t][i].action, serial[t][i].action);
+                BOOST_CHECK(parallel[t][i].values == serial[t][i].values);
+                BOOST_CHECK(parallel[t][i].observations == serial[t][i].observations);
+            }
+        }
+    }
+    solver.setThreadPool(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( progressAndCancellation ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::BeliefGenerator bGen(model);
+    const auto beliefs = bGen(100);
+
+    constexpr unsigned horizon = 10;
+    POMDP::PBVI solver(beliefs.size(), horizon, 0.0);
+
+    std::vector<SolverProgress> progress;
+    solver.setProgressCallback([&](const SolverProgress & p) { progress.push_back(p); });
+
+    const auto full = std::get<1>(solver(model, beliefs));
+    BOOST_REQUIRE_EQUAL(progress.size(), horizon);
+    for ( unsigned t = 0; t < horizon; ++t ) {
+        BOOST_CHECK_EQUAL(progress[t].timestep, t + 1);
+        BOOST_CHECK_EQUAL(progress[t].size, full[t + 1].size());
+        if (t) BOOST_CHECK(progress[t].elapsed >= progress[t-1].elapsed);
+    }
+
+    // Cancelling from the callback stops the solver after the current
+    // iteration, and returns what was computed so far.
+    constexpr unsigned stopAt = 3;
+    CancellationToken token;
+    solver.setCancellationToken(token);
+    solver.setProgressCallback([&](const SolverProgress & p) {
+        if (p.timestep == stopAt) token.cancel();
+    });
+    BOOST_CHECK(solver.getCancellationToken().isCancelled() == false);
+
+    const auto partial = std::get<1>(solver(model, beliefs));
+    BOOST_CHECK(solver.getCancellationToken().isCancelled());
+    BOOST_REQUIRE_EQUAL(partial.size(), stopAt + 1);
+    for ( size_t t = 0; t < partial.size(); ++t ) {
+        BOOST_REQUIRE_EQUAL(partial[t].size(), full[t].size());
+        for ( size_t i = 0; i < partial[t].size(); ++i )
+            BOOST_CHECK(partial[t][i].values == full[t][i].values);
+    }
+
+    // A cancelled token stops the solver before the first iteration.
+    solver.setProgressCallback({});
+    const auto none = std::get<1>(solver(model, beliefs));
+    BOOST_CHECK_EQUAL(none.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( solveAsync ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::BeliefGenerator bGen(model);
+    const auto beliefs = bGen(100);
+
+    constexpr unsigned horizon = 10;
+    POMDP::PBVI solver(beliefs.size(), horizon, 0.0);
+    const auto serial = std::get<1>(solver(model, beliefs));
+
+    {
+        auto async = AIToolbox::solveAsync(solver, model, beliefs);
+        const auto parallel = std::get<1>(async.get());
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t i = 0; i < serial.back().size(); ++i )
+            BOOST_CHECK(parallel.back()[i].values == serial.back()[i].values);
+    }
+
+    // A solve that never ends is stopped by cancel().
+    POMDP::PBVI endless(beliefs.size(), 1000000000, 0.0);
+    std::atomic<unsigned> iterations = 0;
+    endless.setProgressCallback([&](const SolverProgress & p) { iterations = p.timestep; });
+
+    auto async = AIToolbox::solveAsync(endless, model, beliefs);
+    while (iterations < 5) std::this_thread::yield();
+    async.cancel();
+
+    const auto partial = std::get<1>(async.get());
+    BOOST_CHECK(partial.size() >= 6);
+    BOOST_CHECK(partial.size() < 1000000000);
+
+    // Destroying an unfinished solve cancels it and waits for it.
+    iterations = 0;
+    {
+        auto dropped = AIToolbox::solveAsync(endless, model, beliefs);
+        while (iterations < 2) std::this_thread::yield();
+    }
+
+    // The solvers get their own tokens back, so that later synchronous
+    // solves are not cancelled.
+    BOOST_CHECK(!endless.getCancellationToken().isCancelled());
+    { auto dropped = AIToolbox::solveAsync(solver, model, beliefs); }
+    BOOST_CHECK(!solver.getCancellationToken().isCancelled());
+    BOOST_CHECK_EQUAL(std::get<1>(solver(model, beliefs)).size(), horizon + 1);
+}
+
+BOOST_AUTO_TEST_CASE( projecterCache ) {
+    using namespace AIToolbox::POMDP;
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    Projecter projecter(model);
+
+    const VList first{
+        {Vector::Constant(2, 1.0), 0, VObs(3, 0)},
+        {(Vector(2) << 2.0, -1.0).finished(), 1, VObs(3, 0)},
+    };
+    VList second{
+        {(Vector(2) << -3.0, 4.0).finished(), 2, VObs(3, 0)},
+        first[1],
+    };
+
+    projecter(first);
+    BOOST_CHECK_EQUAL(projecter.getCacheHits(), 0);
+
+    // Only the first entry of the second list is new.
+    const auto cached = projecter(second);
+    BOOST_CHECK_EQUAL(projecter.getCacheHits(), 1);
+
+    projecter.clearCache();
+    const auto fresh = projecter(second);
+    BOOST_CHECK_EQUAL(projecter.getCacheHits(), 0);
+
+    for (size_t a = 0; a < model.getA(); ++a) {
+        for (size_t o = 0; o < model.getO(); ++o) {
+            BOOST_REQUIRE_EQUAL(cached[a][o].size(), fresh[a][o].size());
+            for (size_t i = 0; i < fresh[a][o].size(); ++i) {
+                BOOST_CHECK(cached[a][o][i].values.isApprox(fresh[a][o][i].values));
+                BOOST_CHECK_EQUAL(cached[a][o][i].action, fresh[a][o][i].action);
+                BOOST_CHECK_EQUAL(cached[a][o][i].observations[0], fresh[a][o][i].observations[0]);
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE POMDP_PERSEUS
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/Algorithms/PERSEUS.hpp>
+#include <AIToolbox/POMDP/BinaryIO.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <sstream>
+
+#include "Utils/Models.hpp"
+
+BOOST_AUTO_TEST_CASE( threadPool ) {
+    using namespace AIToolbox;
+
+    auto model = ejs4();
+    model.setDiscount(0.95);
+    const double minReward = model.getRewardFunction().minCoeff();
+
+    constexpr unsigned horizon = 100;
+    POMDP::PERSEUS solver(1000, horizon, 0.0);
+
+    // PERSEUS samples its beliefs every time, so we reseed to get the same.
+    Impl::Seeder::setRootSeed(12345);
+    const auto serial = std::get<1>(solver(model, minReward));
+
+    // Beliefs are backed up in parallel batches, but we keep the same
+    // VEntries we would have found going through them one at a time.
+    for ( const size_t threads : {2, 4} ) {
+        ThreadPool pool(threads);
+        solver.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+        Impl::Seeder::setRootSeed(12345);
+        const auto parallel = std::get<1>(solver(model, minReward));
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for ( size_t t = 0; t < serial.size(); ++t ) {
+            BOOST_REQUIRE_EQUAL(parallel[t].size(), serial[t].size());
+            for ( size_t i = 0; i < serial[t].size(); ++i ) {
+                BOOST_CHECK_EQUAL(parallel[t][i].action, serial[t][i].action);
+                BOOST_CHECK(parallel[t][i].values == serial[t][i].values);
+                BOOST_CHECK(parallel[t][i].observations == serial[t][i].observations);
+            }
+        }
+    }
+    solver.setThreadPool(nullptr);
+    BOOST_CHECK(serial.back().size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE( checkpoints ) {
+    using namespace AIToolbox;
+
+    auto model = ejs4();
+    model.setDiscount(0.95);
+    const double minReward = model.getRewardFunction().minCoeff();
+
+    POMDP::PERSEUS solver(200, 30, 0.0);
+
+    // We store the checkpoint of timestep 10, as if we were stopped then.
+    std::stringstream stream;
+    solver.setCheckpointCallback([&](const POMDP::PERSEUSCheckpoint & c) {
+        if ( c.timestep == 10 ) POMDP::writeBinary(stream, c);
+    }, 5);
+    const auto full = std::get<1>(solver(model, minReward));
+
+    POMDP::PERSEUSCheckpoint checkpoint;
+    BOOST_REQUIRE(POMDP::readBinary(stream, checkpoint));
+    BOOST_CHECK_EQUAL(checkpoint.timestep, 10);
+    BOOST_CHECK_EQUAL(checkpoint.beliefs.size(), 200);
+
+    // The beliefs come from the checkpoint, so we don't need to reseed.
+    solver.setCheckpointCallback(nullptr);
+    const auto resumed = std::get<1>(solver(model, checkpoint));
+    BOOST_REQUIRE_EQUAL(resumed.size(), full.size());
+    for ( size_t t = 0; t < full.size(); ++t ) {
+        BOOST_REQUIRE_EQUAL(resumed[t].size(), full[t].size());
+        for ( size_t i = 0; i < full[t].size(); ++i ) {
+            BOOST_CHECK_EQUAL(resumed[t][i].action, full[t][i].action);
+            BOOST_CHECK(resumed[t][i].values == full[t][i].values);
+            BOOST_CHECK(resumed[t][i].observations == full[t][i].observations);
+        }
+    }
+
+    // Truncated checkpoints are rejected.
+    std::stringstream truncated(stream.str().substr(0, stream.str().size() / 2));
+    BOOST_CHECK(!POMDP::readBinary(truncated, checkpoint));
+    BOOST_CHECK_EQUAL(checkpoint.timestep, 10);
+}
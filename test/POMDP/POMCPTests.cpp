@@ -12,6 +12,7 @@
 #include <AIToolbox/Utils/Probability.hpp>
 
 #include "Utils/TigerProblem.hpp"
+#include "Utils/BatchModel.hpp"
 
 BOOST_AUTO_TEST_CASE( discountedHorizon ) {
     using namespace AIToolbox;
@@ -87,10 +88,10 @@ BOOST_AUTO_TEST_CASE( horizonOneBelief ) {
         auto & graph = solver.getGraph();
 
         unsigned particleCount = 0;
-        for ( auto & a : graph.children ) {
-            for ( auto & b : a.children ) {
-                particleCount += b.second.belief.size();
-            }
+        for ( size_t a = 0; a < model.getA(); ++a ) {
+            graph.forEachChild(graph.getRoot(), a, [&](size_t, auto child) {
+                particleCount += graph.getNode(child).belief.getCount();
+            });
         }
 
         BOOST_CHECK_EQUAL( particleCount, count );
@@ -121,9 +122,383 @@ BOOST_AUTO_TEST_CASE( sampleOneTime ) {
 
     auto & graph_ = solver.getGraph();
     // We find the leaf we just produced
-    auto it = graph_.children[0].children.begin();
-    auto o = it->first;
+    size_t o = 0;
+    unsigned leaves = 0;
+    graph_.forEachChild(graph_.getRoot(), 0, [&](size_t key, auto){ o = key; ++leaves; });
+    BOOST_CHECK_EQUAL(leaves, 1);
 
     // We make a,o the new head
     solver.sampleAction( 0, o, horizon-1);
 }
+
+BOOST_AUTO_TEST_CASE( timeBudget ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    POMDP::POMCP solver(model, 1000, 1, 10000.0);
+
+    // With the tiger uncertain, listening is the best action.
+    BOOST_CHECK_EQUAL(solver.sampleAction(belief, 5, std::chrono::milliseconds(100)), A_LISTEN);
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.rollouts > 1);
+    BOOST_CHECK(stats.nodesAdded > 0);
+    BOOST_CHECK(stats.maxDepth > 0 && stats.maxDepth < 5);
+
+    solver.sampleAction(belief, 5, std::chrono::seconds(0));
+    BOOST_CHECK_EQUAL(stats.rollouts, AIToolbox::SearchDeadline::CheckInterval);
+
+    // The final size of the tree is reported.
+    BOOST_CHECK_EQUAL(stats.nodes, solver.getGraph().size());
+    BOOST_CHECK(stats.memoryUsage > 0);
+    BOOST_CHECK(stats.elapsed.count() > 0);
+}
+
+BOOST_AUTO_TEST_CASE( cappedParticles ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    unsigned count = 10000;
+    POMDP::POMCP solver(model, 1000, count, 10000.0);
+    solver.setMaxParticles(1);
+
+    solver.sampleAction(belief, 2);
+
+    // The root is sampled from the true belief, so it is not capped.
+    auto & graph = solver.getGraph();
+    BOOST_CHECK_EQUAL(graph.getNode(graph.getRoot()).belief.size(), 2);
+    BOOST_CHECK_EQUAL(graph.getNode(graph.getRoot()).belief.getCount(), 1000);
+
+    unsigned particleCount = 0;
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        graph.forEachChild(graph.getRoot(), a, [&](size_t, auto child) {
+            const auto & b = graph.getNode(child).belief;
+            BOOST_CHECK_EQUAL(b.size(), 1);
+            BOOST_CHECK_EQUAL(b.getParticles()[0].second, b.getCount());
+            particleCount += b.getCount();
+        });
+    }
+    // Particles for new states are merged rather than discarded, so every
+    // simulation leaves its particle in a child of the root.
+    BOOST_CHECK_EQUAL(particleCount, count);
+}
+
+BOOST_AUTO_TEST_CASE( cappedParticleMerging ) {
+    using namespace AIToolbox;
+
+    RandomEngine rand(Impl::Seeder::getSeed());
+
+    // Merging keeps each state with probability proportional to its
+    // particles, whichever arrives first.
+    const unsigned trials = 10000;
+    unsigned kept = 0;
+    for ( unsigned i = 0; i < trials; ++i ) {
+        POMDP::ParticleBelief b(1);
+        if ( i % 2 ) {
+            b.add(0, 1, rand);
+            b.add(1, 3, rand);
+        } else {
+            b.add(1, 3, rand);
+            b.add(0, 1, rand);
+        }
+        BOOST_CHECK_EQUAL(b.size(), 1);
+        BOOST_CHECK_EQUAL(b.getCount(), 4);
+        kept += b.getParticles()[0].first == 1;
+    }
+    BOOST_CHECK_CLOSE(static_cast<double>(kept) / trials, 0.75, 5.0);
+
+    // The merged state is moved where it belongs.
+    POMDP::ParticleBelief b(3);
+    b.add(5, 100, rand);
+    b.add(7, 1, rand);
+    b.add(9, 100, rand);
+    while ( b.getParticles()[1].first == 7 )
+        b.add(1, 1, rand);
+
+    BOOST_CHECK_EQUAL(b.size(), 3);
+    BOOST_CHECK(std::is_sorted(std::begin(b.getParticles()), std::end(b.getParticles())));
+    BOOST_CHECK_EQUAL(b.getParticles()[0].first, 1);
+    BOOST_CHECK_EQUAL(b.getCount(), b.getParticles()[0].second + 200);
+}
+
+BOOST_AUTO_TEST_CASE( reinvigoration ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    unsigned horizon = 5;
+    POMDP::POMCP solver(model, 1000, 1, 10000.0);
+    solver.setMinParticles(100);
+
+    // A single rollout creates a single child with a single particle.
+    solver.sampleAction(belief, horizon);
+
+    auto & graph = solver.getGraph();
+    size_t o = 0;
+    graph.forEachChild(graph.getRoot(), A_LISTEN, [&](size_t key, auto){ o = key; });
+
+    // We step down into the observation we never saw; rather than
+    // restarting from a uniform belief of 1000 particles, the belief is
+    // rebuilt from the old root.
+    const size_t missing = 1 - o;
+    solver.sampleAction(A_LISTEN, missing, horizon - 1);
+
+    const auto & b = graph.getNode(graph.getRoot()).belief;
+    BOOST_CHECK_EQUAL(b.getCount(), 100);
+
+    // Listening is accurate, so most particles agree with the observation.
+    unsigned agreeing = 0;
+    for ( const auto & [s, n] : b.getParticles() )
+        if ( s == missing ) agreeing += n;
+    BOOST_CHECK(agreeing > 70);
+}
+
+BOOST_AUTO_TEST_CASE( batchedLeafEvaluation ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    unsigned iterations = 2000, calls = 0;
+    size_t evaluated = 0;
+
+    POMDP::POMCP solver(model, 1000, iterations, 10000.0);
+    solver.setLeafEvaluator([&](const std::vector<size_t> & states, const std::vector<unsigned> & horizons, std::vector<double> & values) {
+        ++calls;
+        evaluated += states.size();
+        BOOST_CHECK(states.size() <= 64);
+        for ( size_t i = 0; i < states.size(); ++i ) {
+            BOOST_CHECK(horizons[i] > 0 && horizons[i] < 5);
+            values[i] = 0.0;
+        }
+    }, 64);
+
+    // With the tiger uncertain, listening is the best action.
+    BOOST_CHECK_EQUAL(solver.sampleAction(belief, 5), A_LISTEN);
+    BOOST_CHECK(calls > 0);
+    BOOST_CHECK(evaluated <= solver.getSearchStatistics().nodesAdded);
+
+    const auto & graph = solver.getGraph();
+    unsigned visits = 0, particles = 0;
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        visits += graph.getAction(graph.getRoot(), a).N;
+        graph.forEachChild(graph.getRoot(), a, [&](size_t, auto child) {
+            particles += graph.getNode(child).belief.getCount();
+        });
+    }
+    BOOST_CHECK_EQUAL(visits, iterations);
+    // Beliefs are still updated on every simulation.
+    BOOST_CHECK_EQUAL(particles, iterations);
+}
+
+BOOST_AUTO_TEST_CASE( particleBeliefInput ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::POMCP solver(model, 1000, 10000, 100.0);
+
+    // The particles say the tiger is certainly behind the first door.
+    POMDP::ParticleBelief particles;
+    particles.add(0, 30);
+
+    POMDP::Belief b(2); b << 1.0, 0.0;
+
+    const auto a = solver.sampleAction(particles, 1);
+    BOOST_CHECK_EQUAL(a, solver.sampleAction(b, 1));
+
+    solver.sampleAction(particles, 1);
+    const auto & root = solver.getGraph().getNode(solver.getGraph().getRoot());
+    BOOST_CHECK_EQUAL(root.belief.getCount(), 30);
+    BOOST_CHECK_EQUAL(root.belief.size(), 1);
+
+    BOOST_CHECK_THROW(solver.sampleAction(POMDP::ParticleBelief(), 1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( rolloutCache ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::POMCP solver(model, 1000, 10000, 100.0);
+    BOOST_CHECK(!solver.getRolloutCache().isEnabled());
+
+    solver.setRolloutCache(RolloutCache(1000, 0.99, 5.0), 1, 1);
+    BOOST_CHECK_EQUAL(solver.getRolloutCacheHistoryLength(), 1);
+    BOOST_CHECK_EQUAL(solver.getRolloutCacheDepthBucket(), 1);
+
+    // The tiger problem has very few distinct histories.
+    POMDP::Belief b(2); b << 0.5, 0.5;
+    BOOST_CHECK_EQUAL(solver.sampleAction(b, 5), A_LISTEN);
+    BOOST_CHECK(solver.getSearchStatistics().rolloutCacheHits > 0);
+    BOOST_CHECK(solver.getRolloutCache().size() > 0);
+
+    // Disabling the cache restores rollouts.
+    solver.setRolloutCache(RolloutCache());
+    BOOST_CHECK_EQUAL(solver.sampleAction(b, 5), A_LISTEN);
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().rolloutCacheHits, 0);
+}
+
+BOOST_AUTO_TEST_CASE( progressiveWidening ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::POMCP solver(model, 1000, 1000, 100.0);
+    BOOST_CHECK_EQUAL(solver.getWideningFactor(), 0.0);
+
+    // With a zero exponent each action keeps a single observation branch.
+    solver.setProgressiveWidening(1.0, 0.0);
+    BOOST_CHECK_EQUAL(solver.getWideningFactor(), 1.0);
+    BOOST_CHECK_EQUAL(solver.getWideningExponent(), 0.0);
+
+    POMDP::Belief b(2); b << 0.5, 0.5;
+    solver.sampleAction(b, 3);
+    BOOST_CHECK(solver.getSearchStatistics().mergedObservations > 0);
+
+    const auto & graph = solver.getGraph();
+    const auto root = graph.getRoot();
+    size_t merged = 0;
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        BOOST_CHECK(graph.getChildCount(root, a) <= 1);
+        size_t particles = 0;
+        graph.forEachChild(root, a, [&](size_t, auto child) { particles += graph.getNode(child).belief.getCount(); });
+        merged += particles;
+    }
+    // Every simulation leaves a particle in a root child.
+    BOOST_CHECK_EQUAL(merged, 1000);
+
+    // A real observation without a branch uses the closest one.
+    size_t missing = 0;
+    while ( graph.getChild(root, A_LISTEN, missing) != std::decay_t<decltype(graph)>::NoNode ) ++missing;
+    solver.sampleAction(A_LISTEN, missing, 2);
+    BOOST_CHECK(!solver.getGraph().getNode(solver.getGraph().getRoot()).belief.empty());
+
+    // Disabling widening lets every observation have its own branch.
+    solver.setProgressiveWidening(0.0);
+    solver.sampleAction(b, 3);
+    BOOST_CHECK_EQUAL(solver.getSearchStatistics().mergedObservations, 0);
+    BOOST_CHECK_EQUAL(solver.getGraph().getChildCount(solver.getGraph().getRoot(), A_LISTEN), 2);
+}
+
+BOOST_AUTO_TEST_CASE( memoryLimit ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    POMDP::POMCP unlimited(model, 1000, 5000, 10.0);
+    unlimited.sampleAction(belief, 10);
+    const auto fullMemory = unlimited.getGraph().getUsedMemory();
+    BOOST_CHECK_EQUAL(unlimited.getSearchStatistics().memoryLimited, 0);
+
+    POMDP::POMCP solver(model, 1000, 5000, 10.0);
+    const auto limit = fullMemory / 4;
+    solver.setMaxMemory(limit);
+    BOOST_CHECK_EQUAL(solver.getMaxMemory(), limit);
+
+    solver.sampleAction(belief, 10);
+
+    const auto & graph = solver.getGraph();
+    BOOST_CHECK(graph.getUsedMemory() < limit + limit / 10);
+    BOOST_CHECK(graph.size() < unlimited.getGraph().size());
+    BOOST_CHECK(solver.getSearchStatistics().memoryLimited > 0);
+
+    // The limit also holds when leaves are evaluated in batches.
+    solver.setLeafEvaluator([](const std::vector<size_t> & states, const std::vector<unsigned> &, std::vector<double> & values) {
+        values.assign(states.size(), 0.0);
+    }, 16);
+    solver.sampleAction(belief, 10);
+    BOOST_CHECK(solver.getGraph().getUsedMemory() < limit + limit / 10);
+}
+
+BOOST_AUTO_TEST_CASE( batchedSampling ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+    const BatchModel batchModel(model);
+    static_assert(MDP::is_generative_model_batch_v<decltype(batchModel)>);
+    static_assert(POMDP::is_generative_model_batch_v<decltype(batchModel)>);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    unsigned iterations = 2000;
+    POMDP::POMCP solver(batchModel, 1000, iterations, 10000.0);
+    solver.setLeafEvaluator({}, 64);
+
+    BOOST_CHECK_EQUAL(solver.sampleAction(belief, 5), A_LISTEN);
+    BOOST_CHECK(batchModel.srBatches > 0);
+
+    const auto & graph = solver.getGraph();
+    unsigned visits = 0;
+    for ( size_t a = 0; a < model.getA(); ++a )
+        visits += graph.getAction(graph.getRoot(), a).N;
+    BOOST_CHECK_EQUAL(visits, iterations);
+
+    // Reinvigoration samples the missing particles in batches, without
+    // overshooting the minimum.
+    POMDP::POMCP reinvigorating(batchModel, 1000, 1, 10000.0);
+    reinvigorating.setMinParticles(100);
+    reinvigorating.sampleAction(belief, 5);
+
+    size_t o = 0;
+    const auto & rgraph = reinvigorating.getGraph();
+    rgraph.forEachChild(rgraph.getRoot(), A_LISTEN, [&](size_t key, auto){ o = key; });
+
+    reinvigorating.sampleAction(A_LISTEN, 1 - o, 4);
+    BOOST_CHECK(batchModel.sorBatches > 0);
+    BOOST_CHECK_EQUAL(rgraph.getNode(rgraph.getRoot()).belief.getCount(), 100);
+}
+
+BOOST_AUTO_TEST_CASE( particleSampling ) {
+    using namespace AIToolbox;
+
+    RandomEngine rand(Impl::Seeder::getSeed());
+
+    POMDP::Belief b(4); b << 0.5, 0.25, 0.0, 0.25;
+    const auto particles = POMDP::makeParticleBelief(b, 1000, rand);
+
+    BOOST_CHECK_EQUAL(particles.getCount(), 1000);
+    BOOST_REQUIRE_EQUAL(particles.size(), 3);
+    BOOST_CHECK_EQUAL(particles.getParticles()[0].first, 0);
+    BOOST_CHECK_EQUAL(particles.getParticles()[0].second, 500);
+    BOOST_CHECK_EQUAL(particles.getParticles()[1].first, 1);
+    BOOST_CHECK_EQUAL(particles.getParticles()[1].second, 250);
+    BOOST_CHECK_EQUAL(particles.getParticles()[2].first, 3);
+    BOOST_CHECK_EQUAL(particles.getParticles()[2].second, 250);
+
+    // Each state gets the floor or the ceiling of its expected count.
+    const size_t S = 100, N = 997;
+    for ( unsigned i = 0; i < 10; ++i ) {
+        const POMDP::Belief random = makeRandomProbability(S, rand);
+        const auto approx = POMDP::makeParticleBelief(random, N, rand);
+        BOOST_CHECK_EQUAL(approx.getCount(), N);
+
+        Vector counts = Vector::Zero(S);
+        for ( const auto & [s, n] : approx.getParticles() )
+            counts[s] = n;
+        for ( size_t s = 0; s < S; ++s )
+            BOOST_CHECK(std::fabs(counts[s] - random[s] * N) < 1.0 + 1e-6);
+    }
+
+    BOOST_CHECK(POMDP::makeParticleBelief(b, 0, rand).empty());
+}
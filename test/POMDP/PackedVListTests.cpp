@@ -0,0 +1,198 @@
+#define BOOST_TEST_MODULE POMDP_PackedVList
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/PackedVList.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
+#include <AIToolbox/POMDP/Algorithms/PBVI.hpp>
+#include <AIToolbox/POMDP/Algorithms/Utils/BeliefGenerator.hpp>
+
+#include "Utils/TigerProblem.hpp"
+
+namespace {
+    AIToolbox::POMDP::VList makeRandomVList(const size_t S, const size_t A, const size_t O, const size_t N, AIToolbox::RandomEngine & rand) {
+        using namespace AIToolbox::POMDP;
+
+        std::uniform_real_distribution<double> dist(-10.0, 10.0);
+        std::uniform_int_distribution<size_t> action(0, A - 1), obs(0, N - 1);
+
+        VList vlist;
+        for ( size_t i = 0; i < N; ++i ) {
+            AIToolbox::MDP::Values values(S);
+            for ( size_t s = 0; s < S; ++s )
+                values[s] = dist(rand);
+            VObs observations(O);
+            for ( auto & o : observations )
+                o = obs(rand);
+            vlist.emplace_back(std::move(values), action(rand), std::move(observations));
+        }
+        return vlist;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    RandomEngine rand(1);
+    const auto vlist = makeRandomVList(4, 3, 2, 50, rand);
+
+    const PackedVList packed(4, vlist);
+    BOOST_CHECK_EQUAL(packed.getS(), 4);
+    BOOST_CHECK_EQUAL(packed.getO(), 2);
+    BOOST_CHECK_EQUAL(packed.size(), vlist.size());
+    BOOST_CHECK(!packed.empty());
+
+    for ( size_t i = 0; i < vlist.size(); ++i ) {
+        BOOST_CHECK_EQUAL(packed.getAction(i), vlist[i].action);
+        for ( size_t o = 0; o < 2; ++o )
+            BOOST_CHECK_EQUAL(packed.getObservation(i, o), vlist[i].observations[o]);
+        BOOST_CHECK(packed.getEntry(i) == vlist[i]);
+    }
+    BOOST_CHECK(packed.toVList() == vlist);
+
+    // Appending one by one gives the same result.
+    PackedVList incremental(4, 2);
+    BOOST_CHECK(incremental.empty());
+    for ( const auto & entry : vlist )
+        incremental.push_back(entry);
+    BOOST_CHECK(incremental.toVList() == vlist);
+    BOOST_CHECK(incremental.getValues() == packed.getValues());
+
+    const PackedVList empty(4, VList());
+    BOOST_CHECK(empty.empty());
+    BOOST_CHECK_EQUAL(empty.getO(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( findBestAtBelief ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    constexpr size_t S = 5;
+    RandomEngine rand(2);
+    auto vlist = makeRandomVList(S, 3, 2, 200, rand);
+    // Add a duplicate to check ties.
+    vlist.push_back(vlist[17]);
+
+    const PackedVList packed(S, vlist);
+
+    const auto begin = boost::make_transform_iterator(std::begin(vlist), unwrap);
+    const auto end   = boost::make_transform_iterator(std::end  (vlist), unwrap);
+
+    for ( size_t i = 0; i < 100; ++i ) {
+        const Belief b = makeRandomProbability(S, rand);
+
+        double value, packedValue;
+        const auto best = findBestAtPoint(b, begin, end, &value);
+        const auto packedBest = packed.findBestAtBelief(b, &packedValue);
+
+        BOOST_CHECK_EQUAL(packedBest, static_cast<size_t>(std::distance(begin, best)));
+        BOOST_CHECK_CLOSE(packedValue, value, 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( findBestAtBeliefs ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    constexpr size_t S = 5, N = 100;
+    RandomEngine rand(3);
+    auto vlist = makeRandomVList(S, 3, 2, 200, rand);
+    // Add a duplicate to check ties.
+    vlist.push_back(vlist[17]);
+
+    const PackedVList packed(S, vlist);
+
+    Matrix2D beliefs(N, S);
+    for ( size_t i = 0; i < N; ++i )
+        beliefs.row(i) = makeRandomProbability(S, rand).transpose();
+
+    Vector values;
+    const auto bests = packed.findBestAtBeliefs(beliefs, &values);
+    BOOST_REQUIRE_EQUAL(bests.size(), N);
+    BOOST_REQUIRE_EQUAL(values.size(), N);
+
+    for ( size_t i = 0; i < N; ++i ) {
+        double value;
+        const auto best = packed.findBestAtBelief(beliefs.row(i).transpose(), &value);
+
+        BOOST_CHECK_EQUAL(bests[i], best);
+        BOOST_CHECK_CLOSE(values[i], value, 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( crossSum ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    // We build a reasonable VList to project from.
+    PBVI solver(20, 4, 0.0);
+    const auto vf = std::get<1>(solver(model));
+
+    Projecter projecter(model);
+    const auto projs = projecter(vf.back());
+
+    std::vector<std::vector<PackedVList>> packed(model.getA());
+    for ( size_t a = 0; a < model.getA(); ++a )
+        for ( size_t o = 0; o < model.getO(); ++o )
+            packed[a].emplace_back(model.getS(), projs[a][o]);
+
+    BeliefGenerator bGen(model);
+    for ( const auto & b : bGen(20) ) {
+        double value, packedValue;
+        const auto entry = crossSumBestAtBelief(b, projs, &value);
+        const auto packedEntry = crossSumBestAtBelief(b, packed, &packedValue);
+
+        BOOST_CHECK_EQUAL(packedEntry.action, entry.action);
+        BOOST_CHECK(packedEntry.observations == entry.observations);
+        BOOST_CHECK_CLOSE(packedValue, value, 0.000001);
+        for ( size_t s = 0; s < model.getS(); ++s )
+            BOOST_CHECK_CLOSE(packedEntry.values[s], entry.values[s], 0.000001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( crossSumBeliefs ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    PBVI solver(20, 4, 0.0);
+    const auto vf = std::get<1>(solver(model));
+
+    Projecter projecter(model);
+    const auto projs = projecter(vf.back());
+
+    BeliefGenerator bGen(model);
+    const auto bl = bGen(50);
+    Matrix2D beliefs(bl.size(), model.getS());
+    for ( size_t i = 0; i < bl.size(); ++i )
+        beliefs.row(i) = bl[i].transpose();
+
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        std::vector<PackedVList> packed;
+        for ( size_t o = 0; o < model.getO(); ++o )
+            packed.emplace_back(model.getS(), projs[a][o]);
+
+        Vector values;
+        const auto entries = crossSumBestAtBeliefs(beliefs, packed, a, &values);
+        BOOST_REQUIRE_EQUAL(entries.size(), bl.size());
+
+        for ( size_t i = 0; i < bl.size(); ++i ) {
+            double value;
+            const auto entry = crossSumBestAtBelief(bl[i], packed, a, &value);
+
+            BOOST_CHECK_EQUAL(entries[i].action, entry.action);
+            BOOST_CHECK(entries[i].observations == entry.observations);
+            BOOST_CHECK_CLOSE(values[i], value, 0.000001);
+            for ( size_t s = 0; s < model.getS(); ++s )
+                BOOST_CHECK_CLOSE(entries[i].values[s], entry.values[s], 0.000001);
+        }
+    }
+}
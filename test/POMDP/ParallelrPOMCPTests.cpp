@@ -0,0 +1,155 @@
+#define BOOST_TEST_MODULE POMDP_ParallelrPOMCP
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/Algorithms/ParallelrPOMCP.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+
+#include "Utils/TigerProblem.hpp"
+
+/**
+ * @brief The model for rPOMCP tests
+ *
+ * See rPOMCPTests for a description of this model.
+ *
+ * This version can also be sampled with an external random engine, so
+ * that threads can sample it concurrently.
+ */
+class Model {
+    public:
+        size_t getS() const { return 4; }
+        size_t getA() const { return 2; }
+        double getDiscount() const { return 0.9; }
+        std::tuple<size_t, double> sampleSR(const size_t s, const size_t a) const {
+            return sampleSR(s, a, rand_);
+        }
+        std::tuple<size_t, double> sampleSR(const size_t s, const size_t a, AIToolbox::RandomEngine & rnd) const {
+            std::uniform_real_distribution<double> dist(0.0, 1.0);
+            if (dist(rnd) > 0.17)
+                return std::make_tuple(s, a);
+
+            auto p = dist(rnd);
+            auto swap = dist(rnd) < 0.5;
+
+            auto ss = s;
+
+            if (a == 0 && (s == 0 || s == 1)) {
+                if (p > 0.3)
+                    ss = swap;
+            } else if (a == 1 && (s == 2 || s == 3)) {
+                if (p > 0.3)
+                    ss = swap + 2;
+            } else {
+                if (s > 1)
+                    ss = swap;
+                else
+                    ss = swap + 2;
+            }
+
+            return std::make_tuple(ss, 0.0);
+        }
+
+        std::tuple<size_t,size_t,double> sampleSOR(const size_t s, const size_t a) const {
+            return sampleSOR(s, a, rand_);
+        }
+        std::tuple<size_t,size_t,double> sampleSOR(const size_t s, const size_t a, AIToolbox::RandomEngine & rnd) const {
+            const auto [s1, r] = sampleSR(s, a, rnd);
+            return std::make_tuple(s1, 0, r);
+        }
+        bool isTerminal(size_t) const { return false; }
+
+    private:
+        mutable AIToolbox::RandomEngine rand_;
+};
+
+/**
+ * @brief The same model, which can only be sampled with its own random engine.
+ */
+class SerialModel {
+    public:
+        size_t getS() const { return model_.getS(); }
+        size_t getA() const { return model_.getA(); }
+        double getDiscount() const { return model_.getDiscount(); }
+        std::tuple<size_t, double> sampleSR(const size_t s, const size_t a) const { return model_.sampleSR(s, a); }
+        std::tuple<size_t,size_t,double> sampleSOR(const size_t s, const size_t a) const { return model_.sampleSOR(s, a); }
+        bool isTerminal(size_t s) const { return model_.isTerminal(s); }
+
+    private:
+        Model model_;
+};
+
+static_assert(AIToolbox::POMDP::is_generative_model_rng_v<Model>);
+static_assert(!AIToolbox::POMDP::is_generative_model_rng_v<SerialModel>);
+static_assert(AIToolbox::POMDP::is_generative_model_rng_v<AIToolbox::POMDP::Model<AIToolbox::MDP::Model>>);
+
+template <typename M, bool UseEntropy>
+void checkSolutions(const M & model, AIToolbox::ThreadPool * pool, const std::vector<size_t> & solutions) {
+    using namespace AIToolbox;
+
+    Matrix2D beliefs(2, 4);
+    beliefs << 0.2, 0.2, 0.0, 0.6,
+               0.6, 0.0, 0.2, 0.2;
+
+    unsigned iterations = 50000;
+    for ( auto i = 0; i < beliefs.rows(); ++i ) {
+        POMDP::ParallelrPOMCP<M, UseEntropy> solver(model, 1000, iterations, 200.0, 500, pool);
+
+        BOOST_CHECK_EQUAL(solver.sampleAction(beliefs.row(i), 2), solutions[i]);
+
+        // All rollouts have been backed up into the root.
+        unsigned visits = 0;
+        for ( const auto & an : solver.getGraph().children )
+            visits += an.N;
+        BOOST_CHECK_EQUAL(visits, iterations);
+        BOOST_CHECK_EQUAL(solver.getGraph().N, iterations);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( entropy ) {
+    Model model;
+    AIToolbox::ThreadPool pool(4);
+
+    checkSolutions<Model, true>(model, nullptr, {0, 1});
+    checkSolutions<Model, true>(model, &pool, {0, 1});
+}
+
+BOOST_AUTO_TEST_CASE( max_belief ) {
+    Model model;
+    AIToolbox::ThreadPool pool(4);
+
+    checkSolutions<Model, false>(model, nullptr, {1, 0});
+    checkSolutions<Model, false>(model, &pool, {1, 0});
+}
+
+BOOST_AUTO_TEST_CASE( serializedSampling ) {
+    SerialModel model;
+    AIToolbox::ThreadPool pool(4);
+
+    checkSolutions<SerialModel, true>(model, &pool, {0, 1});
+}
+
+BOOST_AUTO_TEST_CASE( treeReuse ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    POMDP::Belief belief(2); belief.fill(0.5);
+
+    ThreadPool pool(4);
+    POMDP::ParallelrPOMCP<decltype(model), true> solver(model, 1000, 5000, 10.0, 500, &pool);
+    BOOST_CHECK_EQUAL(solver.getThreadPool(), &pool);
+
+    solver.sampleAction(belief, 5);
+    for ( size_t o = 0; o < model.getO(); ++o ) {
+        solver.sampleAction(belief, 5);
+        BOOST_CHECK_EQUAL(solver.getGraph().N, 5000);
+
+        // Listening always creates both observation branches.
+        solver.sampleAction(A_LISTEN, o, 4);
+        BOOST_CHECK(solver.getGraph().N >= 5000);
+        BOOST_CHECK(!solver.getGraph().isSampleBeliefEmpty());
+    }
+}
@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE POMDP_Policy
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/Policies/Policy.hpp>
+#include <AIToolbox/POMDP/Policies/PolicyGraph.hpp>
+#include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
+#include <AIToolbox/POMDP/Algorithms/PBVI.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+
+#include <sstream>
+#include <AIToolbox/Utils/Probability.hpp>
+
+#include "Utils/TigerProblem.hpp"
+
+BOOST_AUTO_TEST_CASE( sampleActions ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    constexpr unsigned horizon = 5;
+    constexpr size_t N = 200;
+
+    const auto model = makeTigerProblem();
+    IncrementalPruning solver(horizon, 0.0);
+    const auto vf = std::get<1>(solver(model));
+
+    const Policy policy(model.getS(), model.getA(), model.getO(), vf);
+
+    RandomEngine rand(5);
+    Matrix2D beliefs(N, model.getS());
+    for ( size_t i = 0; i < N; ++i )
+        beliefs.row(i) = makeRandomProbability(model.getS(), rand).transpose();
+
+    const auto actions = policy.sampleActions(beliefs);
+    BOOST_REQUIRE_EQUAL(actions.size(), N);
+    for ( size_t i = 0; i < N; ++i )
+        BOOST_CHECK_EQUAL(actions[i], policy.sampleAction(beliefs.row(i).transpose()));
+
+    for ( unsigned h = 1; h <= horizon; ++h ) {
+        const auto results = policy.sampleActions(beliefs, h);
+        BOOST_REQUIRE_EQUAL(results.size(), N);
+
+        for ( size_t i = 0; i < N; ++i ) {
+            const auto [action, id] = policy.sampleAction(beliefs.row(i).transpose(), h);
+            BOOST_CHECK_EQUAL(std::get<0>(results[i]), action);
+            BOOST_CHECK_EQUAL(std::get<1>(results[i]), id);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( policyGraphLinks ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    constexpr size_t S = 2, O = 2;
+
+    const auto values = [](double a, double b) { MDP::Values v(2); v << a, b; return v; };
+
+    // The last two horizons contain the same alphavectors, in a different
+    // order.
+    auto vf = makeValueFunction(S);
+    vf.push_back({
+        VEntry(values(1.0, 0.0), 0, VObs(O, 0)),
+        VEntry(values(0.0, 1.0), 1, VObs(O, 0)),
+    });
+    vf.push_back({
+        VEntry(values(0.0, 1.0), 1, VObs{0, 1}),
+        VEntry(values(1.0, 0.0), 0, VObs{1, 1}),
+    });
+
+    const PolicyGraph graph(S, O, vf);
+    BOOST_REQUIRE_EQUAL(graph.size(), 2);
+    BOOST_CHECK_EQUAL(graph.getLinkError(), 0.0);
+
+    BOOST_CHECK_EQUAL(graph.getAction(0), 1);
+    BOOST_CHECK_EQUAL(graph.getAction(1), 0);
+
+    // Horizon 1 entry 0 is node 1, and entry 1 is node 0.
+    BOOST_CHECK_EQUAL(graph.getNextNode(0, 0), 1);
+    BOOST_CHECK_EQUAL(graph.getNextNode(0, 1), 0);
+    BOOST_CHECK_EQUAL(graph.getNextNode(1, 0), 0);
+    BOOST_CHECK_EQUAL(graph.getNextNode(1, 1), 0);
+
+    Belief b(S); b << 0.8, 0.2;
+    BOOST_CHECK_EQUAL(graph.getNode(b), 1);
+
+    BOOST_CHECK_THROW(PolicyGraph(S, O, makeValueFunction(S)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( policyGraphBinary ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    const auto model = makeTigerProblem();
+    auto discountedModel = model;
+    discountedModel.setDiscount(0.95);
+
+    PBVI solver(100, 1000000, 0.0001);
+    const auto vf = std::get<1>(solver(discountedModel));
+
+    const PolicyGraph graph(model.getS(), model.getO(), vf);
+    BOOST_CHECK(graph.getLinkError() < 0.01);
+
+    for ( size_t i = 0; i < graph.size(); ++i ) {
+        BOOST_CHECK_EQUAL(graph.getAction(i), vf.back()[i].action);
+        for ( size_t o = 0; o < graph.getO(); ++o )
+            BOOST_CHECK(graph.getNextNode(i, o) < graph.size());
+    }
+
+    std::stringstream stream;
+    writeBinary(stream, graph);
+
+    PolicyGraph read(model.getS(), model.getO());
+    BOOST_CHECK_EQUAL(read.size(), 1);
+    BOOST_REQUIRE(readBinary(stream, read));
+
+    BOOST_REQUIRE_EQUAL(read.size(), graph.size());
+    for ( size_t i = 0; i < graph.size(); ++i ) {
+        BOOST_CHECK_EQUAL(read.getAction(i), graph.getAction(i));
+        BOOST_CHECK_EQUAL(read.getValues(i), graph.getValues(i));
+        for ( size_t o = 0; o < graph.getO(); ++o )
+            BOOST_CHECK_EQUAL(read.getNextNode(i, o), graph.getNextNode(i, o));
+    }
+
+    // Graphs with different dimensions are rejected.
+    std::stringstream again;
+    writeBinary(again, graph);
+    PolicyGraph wrong(model.getS() + 1, model.getO());
+    BOOST_CHECK(!readBinary(again, wrong));
+    BOOST_CHECK_EQUAL(wrong.size(), 1);
+}
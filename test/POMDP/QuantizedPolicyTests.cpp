@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE POMDP_QuantizedPolicy
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/Policies/QuantizedPolicy.hpp>
+#include <AIToolbox/POMDP/Policies/Policy.hpp>
+#include <AIToolbox/POMDP/BinaryIO.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+
+#include <AIToolbox/Utils/Probability.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+namespace aip = AIToolbox::POMDP;
+
+// A ValueFunction with random alphavectors, as the solvers would produce
+// for a large problem.
+aip::ValueFunction makeRandomValueFunction(const size_t S, const size_t A, const size_t H, const size_t N, AIToolbox::RandomEngine & rand) {
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+
+    auto vf = aip::makeValueFunction(S);
+    for ( size_t h = 1; h <= H; ++h ) {
+        auto & vlist = vf.emplace_back();
+        for ( size_t i = 0; i < N; ++i ) {
+            AIToolbox::MDP::Values v(S);
+            for ( size_t s = 0; s < S; ++s ) v[s] = dist(rand);
+            vlist.emplace_back(std::move(v), i % A, aip::VObs());
+        }
+    }
+    return vf;
+}
+
+BOOST_AUTO_TEST_CASE( bounded_error ) {
+    using namespace AIToolbox;
+    constexpr size_t S = 50, A = 4, O = 2, H = 3, N = 100;
+
+    RandomEngine rand(3);
+    const auto vf = makeRandomValueFunction(S, A, H, N, rand);
+    const aip::Policy policy(S, A, O, vf);
+
+    for ( const auto precision : {aip::QuantizedPolicy::Precision::Float32, aip::QuantizedPolicy::Precision::Int16} ) {
+        const aip::QuantizedPolicy qpolicy(S, A, O, vf, precision, 1.0);
+        BOOST_CHECK_EQUAL(qpolicy.getH(), H);
+        BOOST_CHECK_EQUAL(qpolicy.getSize(H), N);
+        BOOST_CHECK(qpolicy.getErrorBound() > 0.0);
+        BOOST_CHECK(qpolicy.getErrorBound() < 1.0);
+
+        const size_t valueSize = precision == aip::QuantizedPolicy::Precision::Float32 ? 4 : 2;
+        BOOST_CHECK(qpolicy.getMemoryUsage() < H * N * S * valueSize * 1.2 + 4096);
+
+        size_t same = 0;
+        for ( size_t i = 0; i < 200; ++i ) {
+            const aip::Belief b = makeRandomProbability(S, rand);
+            for ( unsigned h = 1; h <= H; ++h ) {
+                const auto [action, id] = qpolicy.sampleAction(b, h);
+                const auto [trueAction, trueId] = policy.sampleAction(b, h);
+                BOOST_CHECK_EQUAL(action, vf[h][id].action);
+                (void)trueAction;
+
+                // The selected vector loses at most the bound.
+                const double loss = vf[h][trueId].values.dot(b) - vf[h][id].values.dot(b);
+                BOOST_CHECK(loss <= qpolicy.getErrorBound());
+                same += id == trueId;
+            }
+        }
+        BOOST_CHECK(same > 500);
+    }
+
+    // Integers cannot represent these vectors within a tight tolerance.
+    BOOST_CHECK_THROW(aip::QuantizedPolicy(S, A, O, vf, aip::QuantizedPolicy::Precision::Int16, 1e-3), std::invalid_argument);
+    BOOST_CHECK_THROW(aip::QuantizedPolicy(S, A, O, aip::ValueFunction(), aip::QuantizedPolicy::Precision::Float32, 1.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( mapped_file ) {
+    using namespace AIToolbox;
+    constexpr size_t S = 20, A = 3, O = 2, H = 2, N = 30;
+
+    RandomEngine rand(4);
+    const auto vf = makeRandomValueFunction(S, A, H, N, rand);
+    const aip::QuantizedPolicy qpolicy(S, A, O, vf, aip::QuantizedPolicy::Precision::Int16, 1.0);
+
+    const std::string filename = "./quantizedPolicy.bin";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        aip::writeBinary(file, qpolicy);
+    }
+
+    {
+        const aip::QuantizedPolicy mapped(filename);
+        BOOST_CHECK_EQUAL(mapped.getS(), S);
+        BOOST_CHECK_EQUAL(mapped.getA(), A);
+        BOOST_CHECK_EQUAL(mapped.getO(), O);
+        BOOST_CHECK_EQUAL(mapped.getH(), H);
+        BOOST_CHECK(mapped.getPrecision() == aip::QuantizedPolicy::Precision::Int16);
+        BOOST_CHECK_EQUAL(mapped.getErrorBound(), qpolicy.getErrorBound());
+        BOOST_CHECK_EQUAL(mapped.getMemoryUsage(), qpolicy.getMemoryUsage());
+
+        // Copies share the mapping.
+        const auto copy = mapped;
+        for ( size_t i = 0; i < 100; ++i ) {
+            const aip::Belief b = makeRandomProbability(S, rand);
+            double v1, v2;
+            BOOST_CHECK_EQUAL(copy.findBestAtBelief(b, H, &v1), qpolicy.findBestAtBelief(b, H, &v2));
+            BOOST_CHECK_EQUAL(v1, v2);
+            BOOST_CHECK_EQUAL(copy.sampleAction(b), qpolicy.sampleAction(b));
+        }
+    }
+
+    // Truncated files are rejected.
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "AITBXQPL";
+    }
+    BOOST_CHECK_THROW(aip::QuantizedPolicy{filename}, std::runtime_error);
+
+    std::remove(filename.c_str());
+}
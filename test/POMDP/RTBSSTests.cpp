@@ -117,3 +117,113 @@ BOOST_AUTO_TEST_CASE( discountedHorizonSparse ) {
         }
     }
 }
+
+// Exhaustive search, without pruning nor caching.
+template <typename M>
+double bruteForce(const M & model, const AIToolbox::POMDP::Belief & b, unsigned horizon) {
+    using namespace AIToolbox;
+    if ( horizon == 0 ) return 0.0;
+
+    double max = -std::numeric_limits<double>::infinity();
+    for ( size_t a = 0; a < model.getA(); ++a ) {
+        double rew = POMDP::beliefExpectedReward(model, b, a);
+        for ( size_t o = 0; o < model.getO(); ++o ) {
+            const POMDP::Belief next = POMDP::updateBeliefUnnormalized(model, b, a, o);
+            const double sum = next.sum();
+            if ( checkDifferentSmall(sum, 0.0) )
+                rew += model.getDiscount() * sum * bruteForce(model, POMDP::Belief(next / sum), horizon - 1);
+        }
+        max = std::max(max, rew);
+    }
+    return max;
+}
+
+BOOST_AUTO_TEST_CASE( transpositionTable ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    Matrix2D beliefs(5, 2);
+    beliefs << 0.5,     0.5,
+               1.0,     0.0,
+               0.25,    0.75,
+               0.98,    0.02,
+               0.33,    0.66;
+
+    const unsigned horizon = 6;
+
+    POMDP::RTBSS cached(model, 10.0);
+    POMDP::RTBSS uncached(model, 10.0);
+    uncached.setMaxTableSize(0);
+
+    ThreadPool pool(3);
+    POMDP::RTBSS parallel(model, 10.0, &pool);
+    BOOST_CHECK_EQUAL(parallel.getThreadPool(), &pool);
+
+    for ( auto i = 0; i < beliefs.rows(); ++i ) {
+        const POMDP::Belief b = beliefs.row(i);
+        const double truth = bruteForce(model, b, horizon);
+
+        const auto [ca, cv] = cached.sampleAction(b, horizon);
+        const auto [ua, uv] = uncached.sampleAction(b, horizon);
+        const auto [pa, pv] = parallel.sampleAction(b, horizon);
+
+        BOOST_CHECK_CLOSE(cv, truth, 0.000001);
+        BOOST_CHECK_CLOSE(uv, truth, 0.000001);
+        BOOST_CHECK_CLOSE(pv, truth, 0.000001);
+        BOOST_CHECK_EQUAL(ca, ua);
+        BOOST_CHECK_EQUAL(ca, pa);
+    }
+
+    BOOST_CHECK(cached.getTableSize() > 0);
+    BOOST_CHECK_EQUAL(uncached.getTableSize(), 0);
+
+    // Repeating a call only needs the table.
+    const POMDP::Belief b = beliefs.row(0);
+    BOOST_CHECK_EQUAL(std::get<1>(cached.sampleAction(b, horizon)), std::get<1>(cached.sampleAction(b, horizon)));
+
+    cached.setMaxTableSize(10);
+    BOOST_CHECK(cached.getTableSize() <= 10);
+    cached.clearTable();
+    BOOST_CHECK_EQUAL(cached.getTableSize(), 0);
+
+    BOOST_CHECK_THROW(cached.setTableResolution(0.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( beliefUpdateCache ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.85);
+
+    Matrix2D beliefs(3, 2);
+    beliefs << 0.5,     0.5,
+               0.25,    0.75,
+               0.98,    0.02;
+
+    const unsigned horizon = 5;
+
+    POMDP::BeliefUpdateCache cache(model, 10000);
+    ThreadPool pool(3);
+
+    // Two planners share the same cache, one of them from multiple threads.
+    POMDP::RTBSS serial(model, 10.0), parallel(model, 10.0, &pool);
+    serial.setBeliefUpdateCache(&cache);
+    parallel.setBeliefUpdateCache(&cache);
+    BOOST_CHECK_EQUAL(serial.getBeliefUpdateCache(), &cache);
+
+    for ( auto i = 0; i < beliefs.rows(); ++i ) {
+        const POMDP::Belief b = beliefs.row(i);
+        const double truth = bruteForce(model, b, horizon);
+
+        const auto [sa, sv] = serial.sampleAction(b, horizon);
+        const auto [pa, pv] = parallel.sampleAction(b, horizon);
+
+        BOOST_CHECK_CLOSE(sv, truth, 0.000001);
+        BOOST_CHECK_CLOSE(pv, truth, 0.000001);
+        BOOST_CHECK_EQUAL(sa, pa);
+    }
+    BOOST_CHECK(cache.size() > 0);
+    BOOST_CHECK(cache.getHits() > 0);
+}
@@ -0,0 +1,112 @@
+#define BOOST_TEST_MODULE POMDP_SOSACache
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/POMDP/SOSACache.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Algorithms/FastInformedBound.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
+
+#include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
+
+template <typename M>
+void checkMatchesSOSA(const M & model) {
+    using namespace AIToolbox;
+
+    const auto sosa = POMDP::makeSOSA(model);
+    const POMDP::SOSACache cache(model);
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), 0);
+
+    for (size_t a = 0; a < model.getA(); ++a) {
+        for (size_t o = 0; o < model.getO(); ++o) {
+            const Matrix2D expected = sosa[a][o];
+            const Matrix2D block = cache.apply(a, o, [](const auto & m) { return Matrix2D(m); });
+            BOOST_CHECK_EQUAL(block, expected);
+        }
+    }
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), model.getA() * model.getO());
+
+    // Everything is cached now.
+    cache.get(0, 0);
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), model.getA() * model.getO());
+}
+
+BOOST_AUTO_TEST_CASE( matchesSOSA ) {
+    using namespace AIToolbox;
+
+    const auto model = chengD35();
+    const auto tiger = makeTigerProblem();
+    const POMDP::SparseModel<MDP::SparseModel> sparseTiger = tiger;
+
+    checkMatchesSOSA(model);
+    checkMatchesSOSA(tiger);
+    checkMatchesSOSA(sparseTiger);
+}
+
+BOOST_AUTO_TEST_CASE( sparseStorage ) {
+    using namespace AIToolbox;
+
+    const auto model = makeTigerProblem();
+    // Listening keeps the state, so its matrices are diagonal.
+    const POMDP::SOSACache cache(model, 0, 0.5);
+    BOOST_CHECK(std::holds_alternative<SparseMatrix2D>(*cache.get(0, 0)));
+    BOOST_CHECK(std::holds_alternative<Matrix2D>(*cache.get(1, 0)));
+
+    const POMDP::SOSACache denseCache(model, 0, 0.0);
+    BOOST_CHECK(std::holds_alternative<Matrix2D>(*denseCache.get(0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE( eviction ) {
+    using namespace AIToolbox;
+
+    const auto model = chengD35();
+    const size_t S = model.getS();
+    const size_t blockBytes = S * S * sizeof(double);
+
+    POMDP::SOSACache cache(model, 2 * blockBytes, 0.0);
+    BOOST_CHECK_EQUAL(cache.getMaxBytes(), 2 * blockBytes);
+
+    cache.get(0, 0);
+    cache.get(0, 1);
+    BOOST_CHECK_EQUAL(cache.getBytes(), 2 * blockBytes);
+
+    // (0,0) was used most recently, so (0,1) gets evicted.
+    cache.get(0, 0);
+    cache.get(0, 2);
+    BOOST_CHECK_EQUAL(cache.getBytes(), 2 * blockBytes);
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), 3);
+
+    cache.get(0, 0);
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), 3);
+    cache.get(0, 1);
+    BOOST_CHECK_EQUAL(cache.getBuildCount(), 4);
+
+    cache.setMaxBytes(blockBytes);
+    BOOST_CHECK_EQUAL(cache.getBytes(), blockBytes);
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.getBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( fastInformedBound ) {
+    using namespace AIToolbox;
+
+    auto model = chengD35();
+    model.setDiscount(0.95);
+
+    POMDP::FastInformedBound solver(1000000, 0.001);
+    const auto [var, qfun] = solver(model, POMDP::makeSOSA(model));
+
+    const POMDP::SOSACache cache(model);
+    const auto [cvar, cqfun] = solver(model, cache);
+
+    BOOST_CHECK(cvar < 0.001);
+    BOOST_CHECK(checkEqualGeneral(var, cvar));
+    for (size_t s = 0; s < model.getS(); ++s)
+        for (size_t a = 0; a < model.getA(); ++a)
+            BOOST_CHECK(checkEqualGeneral(qfun(s, a), cqfun(s, a)));
+}
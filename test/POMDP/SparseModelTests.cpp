@@ -6,6 +6,8 @@
 #include <AIToolbox/POMDP/IO.hpp>
 #include <AIToolbox/MDP/Model.hpp>
 #include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/Utils.hpp>
 
 #include "Utils/TigerProblem.hpp"
 
@@ -128,3 +130,94 @@ BOOST_AUTO_TEST_CASE( files ) {
         std::remove(outputFilename.c_str());
     }
 }
+
+BOOST_AUTO_TEST_CASE( cassandraSparseEjs4 ) {
+    std::string inputFilename  = "./data/ejs4.POMDP";
+
+    std::ifstream inputFile(inputFilename);
+    if ( !inputFile ) BOOST_FAIL("Data to perform test could not be loaded: " + inputFilename);
+    auto m = AIToolbox::POMDP::parseCassandra(inputFile);
+
+    std::ifstream inputFile2(inputFilename);
+    auto m2 = AIToolbox::POMDP::parseCassandraSparse(inputFile2);
+
+    const size_t S = m.getS(), A = m.getA(), O = m.getO();
+
+    BOOST_CHECK_EQUAL(S, m2.getS());
+    BOOST_CHECK_EQUAL(A, m2.getA());
+    BOOST_CHECK_EQUAL(O, m2.getO());
+    BOOST_CHECK_EQUAL(m.getDiscount(), m2.getDiscount());
+
+    for ( size_t s = 0; s < S; ++s ) {
+        for ( size_t a = 0; a < A; ++a ) {
+            for ( size_t s1 = 0; s1 < S; ++s1 ) {
+                BOOST_CHECK_EQUAL(m.getTransitionProbability(s, a, s1), m2.getTransitionProbability(s, a, s1));
+                BOOST_CHECK(AIToolbox::checkEqualGeneral(m.getExpectedReward(s, a, s1), m2.getExpectedReward(s, a, s1)));
+            }
+            for ( size_t o = 0; o < O; ++o ) {
+                BOOST_CHECK_EQUAL(m.getObservationProbability(s, a, o), m2.getObservationProbability(s, a, o));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( observationColumnCache ) {
+    using namespace AIToolbox;
+
+    std::string inputFilename  = "./data/ejs4.POMDP";
+    std::ifstream inputFile(inputFilename);
+    if ( !inputFile ) BOOST_FAIL("Data to perform test could not be loaded: " + inputFilename);
+    auto m = POMDP::parseCassandraSparse(inputFile);
+    auto m2 = m;
+
+    BOOST_CHECK(POMDP::has_observation_columns_v<decltype(m)>);
+    BOOST_CHECK(!POMDP::has_observation_columns_v<POMDP::Model<MDP::Model>>);
+
+    BOOST_CHECK(!m2.getObservationColumnCache());
+    m2.setObservationColumnCache(true);
+    BOOST_CHECK(m2.getObservationColumnCache());
+
+    const size_t S = m.getS(), A = m.getA(), O = m.getO();
+
+    for ( size_t a = 0; a < A; ++a )
+        BOOST_CHECK(Matrix2D(m2.getObservationColumns(a)) == Matrix2D(m.getObservationFunction(a)));
+
+    const auto sosa = POMDP::makeSOSA(m);
+    const auto sosa2 = POMDP::makeSOSA(m2);
+
+    Matrix2D beliefs(3, S);
+    beliefs.row(0).fill(1.0 / S);
+    beliefs.row(1).setZero(); beliefs(1, 0) = 1.0;
+    beliefs.row(2).setLinSpaced(S, 1.0, S);
+    beliefs.row(2) /= beliefs.row(2).sum();
+
+    for ( size_t a = 0; a < A; ++a ) {
+        for ( size_t o = 0; o < O; ++o ) {
+            BOOST_CHECK(Matrix2D(sosa[a][o]).isApprox(Matrix2D(sosa2[a][o])));
+            BOOST_CHECK_EQUAL(sosa[a][o].nonZeros(), sosa2[a][o].nonZeros());
+
+            for ( auto i = 0; i < beliefs.rows(); ++i ) {
+                const POMDP::Belief b = beliefs.row(i).transpose();
+                BOOST_CHECK(POMDP::updateBeliefUnnormalized(m, b, a, o).isApprox(POMDP::updateBeliefUnnormalized(m2, b, a, o)));
+                BOOST_CHECK(POMDP::updateBeliefPartialUnnormalized(m, b, a, o).isApprox(POMDP::updateBeliefPartialUnnormalized(m2, b, a, o)));
+            }
+
+            Matrix2D br, br2;
+            POMDP::updateBeliefsUnnormalized(m, beliefs, a, o, &br);
+            POMDP::updateBeliefsUnnormalized(m2, beliefs, a, o, &br2);
+            BOOST_CHECK(br.isApprox(br2));
+        }
+    }
+
+    // The cache follows changes to the observation function.
+    std::vector<std::vector<std::vector<double>>> of(S, std::vector<std::vector<double>>(A, std::vector<double>(O, 0.0)));
+    for ( size_t s1 = 0; s1 < S; ++s1 )
+        for ( size_t a = 0; a < A; ++a )
+            of[s1][a][(s1 + a) % O] = 1.0;
+    m2.setObservationFunction(of);
+    for ( size_t a = 0; a < A; ++a )
+        BOOST_CHECK(Matrix2D(m2.getObservationColumns(a)) == Matrix2D(m2.getObservationFunction(a)));
+
+    m2.setObservationColumnCache(false);
+    BOOST_CHECK(!m2.getObservationColumnCache());
+}
@@ -0,0 +1,36 @@
+#ifndef AI_TOOLBOX_TEST_POMDP_BATCH_MODEL_HEADER_FILE
+#define AI_TOOLBOX_TEST_POMDP_BATCH_MODEL_HEADER_FILE
+
+#include <AIToolbox/MDP/Types.hpp>
+#include <AIToolbox/POMDP/Types.hpp>
+
+#include <tuple>
+
+// Wraps a model so that it also samples in batches, counting the calls.
+// The overloads taking an external engine are hidden, so that algorithms
+// which prefer them use the batches instead.
+template <typename M>
+struct BatchModel : M {
+    BatchModel(const M & m) : M(m) {}
+
+    std::tuple<size_t, double> sampleSR(size_t s, size_t a) const { return M::sampleSR(s, a); }
+    std::tuple<size_t, size_t, double> sampleSOR(size_t s, size_t a) const { return M::sampleSOR(s, a); }
+
+    void sampleSRBatch(AIToolbox::MDP::TransitionBatch * batch) const {
+        ++srBatches;
+        for ( size_t i = 0; i < batch->states.size(); ++i )
+            std::tie(batch->nextStates[i], batch->rewards[i]) = M::sampleSR(batch->states[i], batch->actions[i]);
+    }
+
+    void sampleSORBatch(AIToolbox::POMDP::TransitionBatch * batch) const {
+        ++sorBatches;
+        sorSamples += batch->states.size();
+        for ( size_t i = 0; i < batch->states.size(); ++i )
+            std::tie(batch->nextStates[i], batch->observations[i], batch->rewards[i]) = M::sampleSOR(batch->states[i], batch->actions[i]);
+    }
+
+    mutable unsigned srBatches = 0, sorBatches = 0;
+    mutable size_t sorSamples = 0;
+};
+
+#endif
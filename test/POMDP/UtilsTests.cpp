@@ -6,7 +6,12 @@
 #include <AIToolbox/POMDP/Utils.hpp>
 #include "Utils/OldPOMDPModel.hpp"
 #include <AIToolbox/MDP/Model.hpp>
+#include <AIToolbox/MDP/SparseModel.hpp>
 #include <AIToolbox/POMDP/Model.hpp>
+#include <AIToolbox/POMDP/SparseModel.hpp>
+#include <AIToolbox/POMDP/Algorithms/Utils/Projecter.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
 
 #include "Utils/TigerProblem.hpp"
 
@@ -110,3 +115,194 @@ BOOST_AUTO_TEST_CASE( beliefUpdatePartial ) {
         BOOST_CHECK(checkEqualProbability(resultEigen2, partialEigen2));
     }
 }
+
+template <typename M>
+void checkBatchedUpdates(const M & model, const AIToolbox::Matrix2D & beliefs) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    const size_t N = beliefs.rows();
+    Matrix2D result;
+
+    for (size_t a = 0; a < model.getA(); ++a) {
+        for (size_t o = 0; o < model.getO(); ++o) {
+            updateBeliefs(model, beliefs, a, o, &result);
+            BOOST_REQUIRE_EQUAL(result.rows(), N);
+            for (size_t i = 0; i < N; ++i)
+                BOOST_CHECK(checkEqualProbability(Belief(result.row(i).transpose()), updateBelief(model, Belief(beliefs.row(i).transpose()), a, o)));
+
+            updateBeliefsUnnormalized(model, beliefs, a, o, &result);
+            for (size_t i = 0; i < N; ++i)
+                BOOST_CHECK(checkEqualProbability(Belief(result.row(i).transpose()), updateBeliefUnnormalized(model, Belief(beliefs.row(i).transpose()), a, o)));
+        }
+    }
+
+    std::vector<size_t> actions(N), observations(N);
+    for (size_t i = 0; i < N; ++i) {
+        actions[i] = (i * 7) % model.getA();
+        observations[i] = (i * 3) % model.getO();
+    }
+
+    updateBeliefs(model, beliefs, actions, observations, &result);
+    BOOST_REQUIRE_EQUAL(result.rows(), N);
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK(checkEqualProbability(Belief(result.row(i).transpose()), updateBelief(model, Belief(beliefs.row(i).transpose()), actions[i], observations[i])));
+
+    updateBeliefsUnnormalized(model, beliefs, actions, observations, &result);
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK(checkEqualProbability(Belief(result.row(i).transpose()), updateBeliefUnnormalized(model, Belief(beliefs.row(i).transpose()), actions[i], observations[i])));
+}
+
+BOOST_AUTO_TEST_CASE( beliefUpdateBatched ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto problem = makeTigerProblem();
+    OldPOMDPModel<MDP::Model> oldProblem = problem;
+    SparseModel<MDP::SparseModel> sparseProblem = problem;
+
+    constexpr size_t N = 50;
+    Matrix2D beliefs(N, problem.getS());
+    for (size_t i = 0; i < N; ++i) {
+        const double p = (i + 1.0) / (N + 1.0);
+        beliefs.row(i) << p, 1.0 - p;
+    }
+
+    checkBatchedUpdates(problem, beliefs);
+    checkBatchedUpdates(oldProblem, beliefs);
+    checkBatchedUpdates(sparseProblem, beliefs);
+}
+
+BOOST_AUTO_TEST_CASE( projecter ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    auto problem = makeTigerProblem();
+    problem.setDiscount(0.95);
+    OldPOMDPModel<MDP::Model> oldProblem = problem;
+    SparseModel<MDP::SparseModel> sparseProblem = problem;
+
+    static_assert(!is_model_eigen_v<OldPOMDPModel<MDP::Model>>);
+
+    VList w;
+    w.emplace_back((MDP::Values(2) << 1.0, -2.0).finished(), 0, VObs(2, 0));
+    w.emplace_back((MDP::Values(2) << -3.0, 4.5).finished(), 1, VObs(2, 0));
+    w.emplace_back((MDP::Values(2) << 0.5, 0.5).finished(), 2, VObs(2, 0));
+
+    Projecter projecter(problem);
+    Projecter oldProjecter(oldProblem);
+    Projecter sparseProjecter(sparseProblem);
+
+    const auto projs = projecter(w);
+    const auto oldProjs = oldProjecter(w);
+    const auto sparseProjs = sparseProjecter(w);
+
+    for (size_t a = 0; a < problem.getA(); ++a) {
+        for (size_t o = 0; o < problem.getO(); ++o) {
+            BOOST_CHECK_EQUAL(projs[a][o].size(), oldProjs[a][o].size());
+            BOOST_CHECK_EQUAL(projs[a][o].size(), sparseProjs[a][o].size());
+
+            for (size_t i = 0; i < projs[a][o].size(); ++i) {
+                const auto & entry = projs[a][o][i];
+                for (const auto & other : {oldProjs[a][o][i], sparseProjs[a][o][i]}) {
+                    BOOST_CHECK_EQUAL(other.action, entry.action);
+                    BOOST_CHECK(other.observations == entry.observations);
+                    for (size_t s = 0; s < problem.getS(); ++s)
+                        BOOST_CHECK_CLOSE(other.values[s], entry.values[s], 0.000001);
+                }
+            }
+            // The single action projection matches the full table.
+            const auto row = sparseProjecter(w, a);
+            BOOST_CHECK(row[o] == sparseProjs[a][o]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( weakBoundDistance ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    constexpr size_t S = 4;
+
+    RandomEngine rand(7);
+    std::uniform_real_distribution<double> dist(-5.0, 5.0);
+
+    const auto makeEntry = [&]{
+        MDP::Values v(S);
+        for ( size_t s = 0; s < S; ++s ) v[s] = dist(rand);
+        return VEntry(std::move(v), 0, VObs());
+    };
+
+    // The straightforward all-pairs distance.
+    const auto naive = [](const VList & oldV, const VList & newV) {
+        double distance = 0.0;
+        for ( const auto & n : newV ) {
+            double closest = std::numeric_limits<double>::infinity();
+            for ( const auto & o : oldV )
+                closest = std::min(closest, (n.values - o.values).cwiseAbs().maxCoeff());
+            distance = std::max(distance, closest);
+        }
+        return distance;
+    };
+
+    VList oldV, newV;
+    for ( size_t i = 0; i < 100; ++i ) oldV.push_back(makeEntry());
+
+    // Identical lists have no distance.
+    BOOST_CHECK_EQUAL(AIToolbox::POMDP::weakBoundDistance(oldV, oldV), 0.0);
+    BOOST_CHECK_EQUAL(AIToolbox::POMDP::weakBoundDistance(VList(), oldV), 0.0);
+
+    // Most vectors are kept, some change and some are new.
+    for ( size_t i = 0; i < oldV.size(); i += 2 ) newV.push_back(oldV[i]);
+    for ( size_t i = 1; i < oldV.size(); i += 10 ) {
+        newV.push_back(oldV[i]);
+        newV.back().values[i % S] += 0.01 * i;
+    }
+    for ( size_t i = 0; i < 20; ++i ) newV.push_back(makeEntry());
+
+    const double expected = naive(oldV, newV);
+    BOOST_CHECK(expected > 0.0);
+    BOOST_CHECK_EQUAL(AIToolbox::POMDP::weakBoundDistance(oldV, newV), expected);
+
+    ThreadPool pool(4);
+    BOOST_CHECK_EQUAL(AIToolbox::POMDP::weakBoundDistance(oldV, newV, &pool), expected);
+}
+
+BOOST_AUTO_TEST_CASE( beliefUpdateLarge ) {
+    using namespace AIToolbox;
+    using namespace AIToolbox::POMDP;
+
+    // Enough states to go through the vectorized kernels.
+    constexpr size_t S = 40, A = 2, O = 3;
+    RandomEngine rand(Impl::Seeder::getSeed());
+
+    DumbMatrix3D tt(boost::extents[S][A][S]), oo(boost::extents[S][A][O]);
+    Matrix3D t(A, Matrix2D(S, S)), obs(A, Matrix2D(S, O));
+    for (size_t a = 0; a < A; ++a) {
+        for (size_t s = 0; s < S; ++s) {
+            t[a].row(s) = makeRandomProbability(S, rand).transpose();
+            obs[a].row(s) = makeRandomProbability(O, rand).transpose();
+            for (size_t s1 = 0; s1 < S; ++s1) tt[s][a][s1] = t[a](s, s1);
+            for (size_t o = 0; o < O; ++o) oo[s][a][o] = obs[a](s, o);
+        }
+    }
+    Model<MDP::Model> model(O, S, A);
+    model.setTransitionFunction(tt);
+    model.setObservationFunction(oo);
+    OldPOMDPModel<MDP::Model> oldModel = model;
+
+    Belief b = makeRandomProbability(S, rand);
+    b[3] = 0.0;
+    b /= b.sum();
+
+    for (size_t a = 0; a < A; ++a) {
+        const Belief partial = (b.transpose() * t[a]).transpose();
+        BOOST_CHECK(updateBeliefPartial(model, b, a).isApprox(partial));
+
+        for (size_t o = 0; o < O; ++o) {
+            const auto result = updateBeliefUnnormalized(model, b, a, o);
+            BOOST_CHECK(result.isApprox(updateBeliefUnnormalized(oldModel, b, a, o)));
+            BOOST_CHECK(result.isApprox(partial.cwiseProduct(obs[a].col(o))));
+        }
+    }
+}
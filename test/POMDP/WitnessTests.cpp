@@ -4,9 +4,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <AIToolbox/POMDP/Algorithms/Witness.hpp>
+#include <AIToolbox/POMDP/Algorithms/IncrementalPruning.hpp>
 #include <AIToolbox/POMDP/Types.hpp>
 
 #include "Utils/TigerProblem.hpp"
+#include "Utils/Models.hpp"
 
 BOOST_AUTO_TEST_CASE( discountedHorizon ) {
     using namespace AIToolbox;
@@ -151,3 +153,57 @@ BOOST_AUTO_TEST_CASE( undiscountedHorizon ) {
         BOOST_CHECK_EQUAL(values, truthValues);
     }
 }
+
+BOOST_AUTO_TEST_CASE( cachedWitnesses ) {
+    using namespace AIToolbox;
+
+    auto model = chengD35();
+
+    // Past the first timestep, each action starts from the witness points
+    // found at the previous one. The solution must still be complete.
+    constexpr unsigned horizon = 6;
+    POMDP::Witness solver(horizon, 0.0);
+    auto vf = std::get<1>(solver(model));
+
+    POMDP::IncrementalPruning ip(horizon, 0.0);
+    auto truth = std::get<1>(ip(model));
+
+    const auto comparer = [](const POMDP::VEntry & lhs, const POMDP::VEntry & rhs) {
+        return veccmp(lhs.values, rhs.values) < 0;
+    };
+
+    BOOST_REQUIRE_EQUAL(vf.size(), truth.size());
+    for ( size_t t = 0; t < vf.size(); ++t ) {
+        std::sort(std::begin(vf[t]), std::end(vf[t]), comparer);
+        std::sort(std::begin(truth[t]), std::end(truth[t]), comparer);
+
+        BOOST_REQUIRE_EQUAL(vf[t].size(), truth[t].size());
+        for ( size_t i = 0; i < vf[t].size(); ++i ) {
+            BOOST_CHECK_EQUAL(vf[t][i].action, truth[t][i].action);
+            BOOST_CHECK(veccmpSmall(vf[t][i].values, truth[t][i].values) == 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( warmStart ) {
+    using namespace AIToolbox;
+
+    auto model = makeTigerProblem();
+    model.setDiscount(0.95);
+
+    POMDP::Witness solver(6, 0.0);
+    const auto full = std::get<1>(solver(model));
+
+    // Continuing from the solution for an horizon of 3 for 3 more steps
+    // gives the same solution as solving for an horizon of 6.
+    solver.setHorizon(3);
+    const auto half = std::get<1>(solver(model));
+    const auto warm = std::get<1>(solver(model, half.back()));
+
+    BOOST_CHECK_EQUAL(warm.size(), 4);
+    BOOST_CHECK_EQUAL(warm.back().size(), full.back().size());
+    BOOST_CHECK(POMDP::weakBoundDistance(warm.back(), full.back()) < 1e-6);
+
+    BOOST_CHECK_THROW(solver(model, POMDP::VList()), std::invalid_argument);
+    BOOST_CHECK_THROW(solver(model, POMDP::makeValueFunction(3)[0]), std::invalid_argument);
+}
@@ -126,3 +126,24 @@ BOOST_AUTO_TEST_CASE( max_belief ) {
         BOOST_CHECK_EQUAL(solver.sampleAction(beliefs.row(i), 2), solutions[i]);
     }
 }
+
+BOOST_AUTO_TEST_CASE( timeBudget ) {
+    using namespace AIToolbox;
+
+    Model model;
+
+    POMDP::Belief belief(4);
+    belief << 0.2, 0.2, 0.0, 0.6;
+
+    POMDP::rPOMCP<decltype(model), true> solver(model, 1000, 1, 200.0);
+
+    solver.sampleAction(belief, 2, std::chrono::milliseconds(20));
+
+    const auto & stats = solver.getSearchStatistics();
+    BOOST_CHECK(stats.rollouts > 1);
+    BOOST_CHECK(stats.nodesAdded > 0);
+    BOOST_CHECK(stats.maxDepth < 2);
+
+    solver.sampleAction(belief, 2, std::chrono::seconds(0));
+    BOOST_CHECK_EQUAL(stats.rollouts, AIToolbox::SearchDeadline::CheckInterval);
+}
@@ -95,6 +95,11 @@ class MDPPythonMCTSTests(unittest.TestCase):
         #     def getDiscount(self): pass       # Returns discount
         #     def isTerminal(self, s): pass     # Returns whether the input state is terminal
         #     def sampleSR(self, s, a): pass    # Samples a new state-reward *tuple* from the input
+        #
+        # Optionally, it can also provide a method to sample many transitions
+        # with a single call:
+        #
+        #     def sampleSRBatch(self, states, actions): pass # Returns a tuple of lists of new states and rewards
 
         # In our case we use the MDP.Model as if it was a Python object to wrap
         # all along, but you can use this to wrap any library you want.
@@ -131,6 +136,37 @@ class MDPPythonMCTSTests(unittest.TestCase):
         self.assertEqual(mcts.sampleAction(13, 10), RIGHT)
         self.assertEqual(mcts.sampleAction(14, 10), RIGHT)
 
+    def testGenerativeModelBatch(self):
+        class Chain:
+            def __init__(self):
+                self.calls = 0
+            def getS(self): return 4
+            def getA(self): return 2
+            def getDiscount(self): return 0.9
+            def isTerminal(self, s): return s == 3
+            def sampleSR(self, s, a): return (min(s + a, 3), float(a))
+
+        chain = Chain()
+        mm = MDP.GenerativeModelPython(chain)
+        self.assertEqual(mm.getS(), 4)
+        self.assertEqual(mm.getDiscount(), 0.9)
+
+        # Without sampleSRBatch, sampleSR is called once per pair.
+        s1s, rews = mm.sampleSRBatch([0, 1, 3], [1, 0, 1])
+        self.assertEqual(list(s1s), [1, 1, 3])
+        self.assertEqual(list(rews), [1.0, 0.0, 1.0])
+
+        def sampleSRBatch(states, actions):
+            chain.calls += 1
+            return ([min(s + a, 3) for s, a in zip(states, actions)], [float(a) for a in actions])
+        chain.sampleSRBatch = sampleSRBatch
+
+        mm = MDP.GenerativeModelPython(chain)
+        s1s, rews = mm.sampleSRBatch([0, 1, 3], [1, 0, 1])
+        self.assertEqual(list(s1s), [1, 1, 3])
+        self.assertEqual(list(rews), [1.0, 0.0, 1.0])
+        self.assertEqual(chain.calls, 1)
+
 if __name__ == '__main__':
     unittest.main(verbosity=2)
 
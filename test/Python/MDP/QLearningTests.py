@@ -1,6 +1,7 @@
 import unittest
 import sys
 import os
+import struct
 
 sys.path.append(os.getcwd())
 from AIToolbox import MDP
@@ -31,5 +32,39 @@ class MDPPythonQLearningTests(unittest.TestCase):
         self.assertEqual( solver.getQFunction()[1, 0], 0.0  )
         self.assertEqual( solver.getQFunction()[1, 1], 0.0  )
 
+    def testQFunctionView(self):
+        solver = MDP.QLearning(5, 3, 0.9, 0.5)
+
+        # The buffer is a view on the QFunction, so it sees updates.
+        view = memoryview(solver.getQFunction())
+        self.assertEqual( view.shape, (5, 3) )
+
+        solver.stepUpdateQ(4, 2, 4, 10)
+        values = struct.unpack('15d', view.tobytes())
+        self.assertEqual( values[4 * 3 + 2], 5.0 )
+        self.assertEqual( sum(values), 5.0 )
+
+    def testBatchUpdates(self):
+        serial = MDP.QLearning(5, 3, 0.9, 0.5)
+        batched = MDP.QLearning(5, 3, 0.9, 0.5)
+
+        states     = [0, 0, 3, 3, 0, 4]
+        actions    = [0, 0, 0, 0, 1, 2]
+        nextStates = [0, 0, 4, 4, 1, 4]
+        rewards    = [10.0, 10.0, 10.0, 10.0, 10.0, -5.0]
+
+        for t in zip(states, actions, nextStates, rewards):
+            serial.stepUpdateQ(*t)
+
+        # The batch is applied in order, so the result is the same.
+        batched.batchUpdateQ(states, actions, nextStates, rewards)
+        for s in range(5):
+            for a in range(3):
+                self.assertEqual( batched.getQFunction()[s, a], serial.getQFunction()[s, a] )
+
+        # Out of range indeces are rejected before anything is updated.
+        with self.assertRaises(ValueError):
+            batched.batchUpdateQ([5], [0], [0], [1.0])
+
 if __name__ == '__main__':
     unittest.main(verbosity=2)
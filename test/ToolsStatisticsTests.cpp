@@ -0,0 +1,108 @@
+#define BOOST_TEST_MODULE ToolsStatistics
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Tools/Statistics.hpp>
+
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace ai = AIToolbox;
+
+BOOST_AUTO_TEST_CASE( mean_and_std ) {
+    ai::Statistics stats(2);
+
+    const std::vector<double> episode1{1.0, 10.0}, episode2{3.0, 20.0};
+    stats.record(std::begin(episode1), std::end(episode1));
+    stats.record(std::begin(episode2), std::end(episode2));
+
+    const auto results = stats.process();
+    BOOST_CHECK_EQUAL(results.size(), 2);
+
+    const auto & [mean0, cumMean0, std0, cumStd0] = results[0];
+    BOOST_CHECK_CLOSE(mean0, 2.0, 1e-9);
+    BOOST_CHECK_CLOSE(cumMean0, 2.0, 1e-9);
+    BOOST_CHECK_CLOSE(std0, 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(cumStd0, 1.0, 1e-9);
+
+    const auto & [mean1, cumMean1, std1, cumStd1] = results[1];
+    BOOST_CHECK_CLOSE(mean1, 15.0, 1e-9);
+    BOOST_CHECK_CLOSE(cumMean1, 17.0, 1e-9);
+    BOOST_CHECK_CLOSE(std1, 5.0, 1e-9);
+    BOOST_CHECK_CLOSE(cumStd1, std::sqrt(26.0), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE( parallel_merge ) {
+    constexpr size_t Timesteps = 5, Workers = 8, Episodes = 1000;
+
+    // Large offsets would make the naive sum of squares lose precision.
+    auto value = [](size_t w, size_t e, size_t t) {
+        return 1e8 + double((w * 7919 + e * 104729 + t * 31) % 1000);
+    };
+
+    ai::Statistics serial(Timesteps);
+    for (size_t w = 0; w < Workers; ++w)
+        for (size_t e = 0; e < Episodes; ++e)
+            for (size_t t = 0; t < Timesteps; ++t)
+                serial.record(value(w, e, t), t);
+
+    std::vector<ai::Statistics> local(Workers, ai::Statistics(Timesteps));
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < Workers; ++w)
+        threads.emplace_back([&, w]{
+            for (size_t e = 0; e < Episodes; ++e)
+                for (size_t t = 0; t < Timesteps; ++t)
+                    local[w].record(value(w, e, t), t);
+        });
+    for (auto & t : threads) t.join();
+
+    // Start with fewer timesteps to check that merging extends them.
+    ai::Statistics merged(1);
+    for (const auto & l : local)
+        merged.merge(l);
+    BOOST_CHECK_EQUAL(merged.getTimesteps(), Timesteps);
+
+    const auto s = serial.process();
+    const auto m = merged.process();
+    for (size_t t = 0; t < Timesteps; ++t) {
+        BOOST_CHECK_CLOSE(std::get<0>(s[t]), std::get<0>(m[t]), 1e-9);
+        BOOST_CHECK_CLOSE(std::get<2>(s[t]), std::get<2>(m[t]), 1e-6);
+        // The true std of uniform values in [0, 1000) is about 288.
+        BOOST_CHECK_CLOSE(std::get<2>(m[t]), 288.0, 2.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( quantiles ) {
+    constexpr double Accuracy = 0.01;
+    // BOOST_CHECK_CLOSE is relative to both values, so it's slightly stricter.
+    constexpr double Tolerance = 110 * Accuracy;
+
+    ai::QuantileSketch a(Accuracy), b(Accuracy);
+    for (int i = 1; i <= 1000; ++i)
+        (i % 2 ? a : b).record(i);
+
+    a.merge(b);
+    BOOST_CHECK_EQUAL(a.getCount(), 1000);
+    BOOST_CHECK_CLOSE(a.getQuantile(0.5), 500.0, Tolerance);
+    BOOST_CHECK_CLOSE(a.getQuantile(0.9), 900.0, Tolerance);
+    BOOST_CHECK_CLOSE(a.getQuantile(0.0), 1.0, Tolerance);
+    BOOST_CHECK_CLOSE(a.getQuantile(1.0), 1000.0, Tolerance);
+
+    BOOST_CHECK_THROW(a.merge(ai::QuantileSketch(0.05)), std::invalid_argument);
+    BOOST_CHECK(std::isnan(ai::QuantileSketch().getQuantile(0.5)));
+
+    ai::Statistics stats(1, Accuracy), other(1, Accuracy);
+    for (int i = -50; i < 50; ++i)
+        (i < 0 ? stats : other).record(i, 0);
+    stats.merge(other);
+
+    BOOST_CHECK_CLOSE(stats.getQuantile(0.5, 0), -1.0, Tolerance);
+    BOOST_CHECK_CLOSE(stats.getQuantile(0.0, 0), -50.0, Tolerance);
+    BOOST_CHECK_CLOSE(stats.getQuantile(0.75, 0), 24.0, Tolerance);
+
+    BOOST_CHECK_THROW(ai::Statistics(1).getQuantile(0.5, 0), std::invalid_argument);
+    BOOST_CHECK_THROW(stats.merge(ai::Statistics(1)), std::invalid_argument);
+}
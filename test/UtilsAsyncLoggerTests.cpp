@@ -0,0 +1,137 @@
+#define BOOST_TEST_MODULE UtilsAsyncLogger
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// We enable logging in this file so we can test the header-only logger.
+#define AI_LOGGING_ENABLED 1
+
+#include <AIToolbox/Impl/Logging.hpp>
+#include <AIToolbox/Utils/AsyncLogger.hpp>
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ai = AIToolbox;
+
+namespace {
+    std::vector<std::pair<int, std::string>> received;
+
+    // This is only ever called by the AsyncLogger worker thread.
+    void sink(const int severity, const char * message) {
+        received.emplace_back(severity, message);
+    }
+
+    ai::AsyncLogger * globalLogger = nullptr;
+}
+
+BOOST_AUTO_TEST_CASE( in_order_delivery ) {
+    received.clear();
+    {
+        ai::AsyncLogger logger(sink);
+        for (int i = 0; i < 100; ++i)
+            logger.log(i % 4, std::to_string(i).c_str());
+
+        logger.flush();
+        BOOST_CHECK_EQUAL(received.size(), 100);
+        BOOST_CHECK_EQUAL(logger.getDropped(), 0);
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(received[i].first, i % 4);
+        BOOST_CHECK_EQUAL(received[i].second, std::to_string(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( drops_when_full ) {
+    received.clear();
+
+    std::mutex blocker;
+    std::unique_lock<std::mutex> lock(blocker);
+
+    size_t delivered = 0;
+    {
+        // The sink blocks until we release it, so the queue fills up.
+        ai::AsyncLogger logger([&](int, const char *){
+            std::lock_guard<std::mutex> l(blocker);
+            ++delivered;
+        }, 10);
+
+        for (int i = 0; i < 100; ++i)
+            logger.log(AI_SEVERITY_INFO, "message");
+
+        // At most one batch of 10 can be taken by the worker, and another
+        // 10 can wait in the queue.
+        BOOST_CHECK(logger.getDropped() >= 80);
+        BOOST_CHECK(logger.getDropped() <= 90);
+
+        lock.unlock();
+        logger.flush();
+        BOOST_CHECK_EQUAL(delivered + logger.getDropped(), 100);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( macro_from_many_threads ) {
+    received.clear();
+
+    ai::AsyncLogger logger(sink, 1 << 16);
+    globalLogger = &logger;
+    ai::AILogger = [](int s, const char * m){ globalLogger->log(s, m); };
+
+    constexpr int Threads = 4, Messages = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < Threads; ++t)
+        threads.emplace_back([t]{
+            for (int i = 0; i < Messages; ++i)
+                AI_LOGGER(AI_SEVERITY_WARNING, "thread " << t << " message " << i);
+        });
+    for (auto & t : threads) t.join();
+
+    logger.flush();
+    BOOST_CHECK_EQUAL(logger.getDropped(), 0);
+    BOOST_REQUIRE_EQUAL(received.size(), Threads * Messages);
+
+    // Messages of each thread must arrive intact and in order.
+    std::vector<int> next(Threads, 0);
+    for (const auto & [sev, msg] : received) {
+        BOOST_CHECK_EQUAL(sev, AI_SEVERITY_WARNING);
+        int t, i;
+        BOOST_REQUIRE_EQUAL(std::sscanf(msg.c_str(), "thread %d message %d", &t, &i), 2);
+        BOOST_CHECK_EQUAL(i, next[t]++);
+    }
+
+    ai::AILogger = nullptr;
+}
+
+BOOST_AUTO_TEST_CASE( min_severity_and_truncation ) {
+    static std::vector<std::string> direct;
+    direct.clear();
+    ai::AILogger = [](int, const char * m){ direct.emplace_back(m); };
+
+    ai::AILoggerMinSeverity = AI_SEVERITY_WARNING;
+
+    int formatted = 0;
+    const auto count = [&]{ ++formatted; return 0; };
+    AI_LOGGER(AI_SEVERITY_INFO, "skipped " << count());
+    AI_LOGGER(AI_SEVERITY_ERROR, "kept " << count());
+
+    // Discarded messages are never formatted.
+    BOOST_CHECK_EQUAL(formatted, 1);
+    BOOST_REQUIRE_EQUAL(direct.size(), 1);
+    BOOST_CHECK_EQUAL(direct[0], "kept 0");
+
+    ai::AILoggerMinSeverity = AI_SEVERITY_DEBUG;
+
+    const std::string longMessage(2 * ai::Impl::LogBufferSize, 'x');
+    AI_LOGGER(AI_SEVERITY_DEBUG, longMessage);
+    AI_LOGGER(AI_SEVERITY_DEBUG, "short");
+
+    BOOST_REQUIRE_EQUAL(direct.size(), 3);
+    BOOST_CHECK_EQUAL(direct[1], std::string(ai::Impl::LogBufferSize - 1, 'x'));
+    BOOST_CHECK_EQUAL(direct[2], "short");
+
+    ai::AILogger = nullptr;
+}
@@ -98,6 +98,90 @@ BOOST_AUTO_TEST_CASE( index_skip_map ) {
     }
 }
 
+BOOST_AUTO_TEST_CASE( index_skip_map_out_of_bounds ) {
+    std::vector<std::string> test{"aaa", "bbb", "ccc", "ddd"};
+    const std::vector<size_t> ids{2, 3, 4, 10};
+
+    AIToolbox::IndexSkipMap e(ids, test);
+    const std::vector<std::string> solution{"aaa", "bbb"};
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(e), std::end(e),
+                                  std::begin(solution), std::end(solution));
+}
+
+BOOST_AUTO_TEST_CASE( index_span ) {
+    std::vector<std::string> test{"aaa", "bbb", "ccc", "ddd"};
+    std::vector<std::vector<size_t>> lists {
+        {},
+        {3},
+        {0, 3},
+        {0, 2, 3},
+        {3, 1, 1, 0}
+    };
+
+    for (const auto & list : lists) {
+        const AIToolbox::IndexMap expected(list, test);
+        const AIToolbox::IndexSpan<const std::vector<std::string>> e(list, test);
+
+        BOOST_CHECK_EQUAL(e.size(), list.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(e), std::end(e),
+                                      std::begin(expected), std::end(expected));
+
+        constexpr auto v = std::is_same_v<std::iterator_traits<decltype(e)::iterator>::iterator_category, std::random_access_iterator_tag>;
+        BOOST_CHECK(v);
+
+        for (size_t i = 0; i < list.size(); ++i) {
+            BOOST_CHECK_EQUAL(e[i], test[list[i]]);
+            BOOST_CHECK_EQUAL((std::begin(e) + i).toContainerId(), list[i]);
+        }
+        BOOST_CHECK_EQUAL(std::end(e) - std::begin(e), static_cast<std::ptrdiff_t>(list.size()));
+    }
+
+    // Items can be modified through a non-const span.
+    const std::vector<size_t> ids{1, 2};
+    AIToolbox::IndexSpan<std::vector<std::string>> m(ids, test);
+    for (auto & item : m) item += "x";
+
+    BOOST_CHECK_EQUAL(test[0], "aaa");
+    BOOST_CHECK_EQUAL(test[1], "bbbx");
+    BOOST_CHECK_EQUAL(test[2], "cccx");
+    BOOST_CHECK_EQUAL(test[3], "ddd");
+}
+
+BOOST_AUTO_TEST_CASE( index_span_gather ) {
+    std::vector<std::pair<int, double>> items;
+    for (int i = 0; i < 50; ++i)
+        items.emplace_back(i, i * 0.5);
+
+    // Long enough to use the prefetching loop.
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < 30; ++i)
+        ids.push_back((i * 7) % 50);
+
+    const AIToolbox::IndexSpan<const decltype(items)> span(ids, items);
+
+    std::vector<std::pair<int, double>> copies(ids.size());
+    const auto end = AIToolbox::gather(span, std::begin(copies));
+    BOOST_CHECK(end == std::end(copies));
+
+    std::vector<double> values(ids.size());
+    AIToolbox::gather(span, std::begin(values), [](const auto & p) { return p.second; });
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        BOOST_CHECK(copies[i] == items[ids[i]]);
+        BOOST_CHECK_EQUAL(values[i], items[ids[i]].second);
+    }
+
+    // Short ranges skip the prefetching loop entirely.
+    const std::vector<size_t> shortIds{4, 2};
+    std::vector<double> shortValues;
+    AIToolbox::gather(AIToolbox::IndexSpan<const decltype(items)>(shortIds, items), std::back_inserter(shortValues),
+                      [](const auto & p) { return p.second; });
+    BOOST_CHECK_EQUAL(shortValues.size(), 2);
+    BOOST_CHECK_EQUAL(shortValues[0], 2.0);
+    BOOST_CHECK_EQUAL(shortValues[1], 1.0);
+}
+
 BOOST_AUTO_TEST_CASE( subset_enumeration_number ) {
     std::vector<std::vector<int>> solutions {
         {0, 1},
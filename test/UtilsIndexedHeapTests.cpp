@@ -0,0 +1,90 @@
+#define BOOST_TEST_MODULE UtilsIndexedHeap
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/IndexedHeap.hpp>
+
+#include <random>
+#include <vector>
+
+template <typename Heap>
+void testAgainstReference() {
+    constexpr size_t N = 50;
+    Heap heap(N);
+
+    // Reference: priority of each key, negative if not in the heap.
+    std::vector<double> reference(N, -1.0);
+
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<size_t> keyDist(0, N - 1);
+    std::uniform_real_distribution<double> priorityDist(0.0, 100.0);
+    std::uniform_int_distribution<int> opDist(0, 3);
+
+    for ( size_t i = 0; i < 10000; ++i ) {
+        const auto key = keyDist(rand);
+        const auto op = opDist(rand);
+
+        if ( op < 2 ) {
+            const auto p = priorityDist(rand);
+            if ( !heap.contains(key) ) {
+                heap.push(key, p);
+                reference[key] = p;
+            } else if ( heap.getPriority(key) < p ) {
+                heap.increase(key, p);
+                reference[key] = p;
+            }
+        } else if ( op == 2 && !heap.empty() ) {
+            const auto top = heap.top();
+            for ( size_t k = 0; k < N; ++k )
+                BOOST_CHECK( reference[k] <= reference[top] );
+            heap.pop();
+            reference[top] = -1.0;
+        }
+
+        size_t size = 0;
+        for ( size_t k = 0; k < N; ++k ) {
+            BOOST_CHECK_EQUAL( heap.contains(k), reference[k] >= 0.0 );
+            if ( reference[k] >= 0.0 ) {
+                BOOST_CHECK_EQUAL( heap.getPriority(k), reference[k] );
+                ++size;
+            }
+        }
+        BOOST_CHECK_EQUAL( heap.size(), size );
+        BOOST_CHECK_EQUAL( heap.empty(), size == 0 );
+    }
+
+    heap.clear();
+    BOOST_CHECK( heap.empty() );
+    for ( size_t k = 0; k < N; ++k )
+        BOOST_CHECK( !heap.contains(k) );
+}
+
+BOOST_AUTO_TEST_CASE( binaryHeap ) {
+    testAgainstReference<AIToolbox::IndexedDaryHeap<2>>();
+}
+
+BOOST_AUTO_TEST_CASE( quaternaryHeap ) {
+    testAgainstReference<AIToolbox::IndexedDaryHeap<4>>();
+}
+
+BOOST_AUTO_TEST_CASE( fibonacciHeap ) {
+    testAgainstReference<AIToolbox::IndexedFibonacciHeap>();
+}
+
+BOOST_AUTO_TEST_CASE( popOrder ) {
+    AIToolbox::IndexedDaryHeap<3> heap(10);
+
+    const std::vector<double> priorities{3.0, 1.0, 4.0, 1.5, 5.0, 9.0, 2.0, 6.0, 5.5, 3.5};
+    for ( size_t k = 0; k < priorities.size(); ++k )
+        heap.push(k, priorities[k]);
+
+    heap.increase(1, 10.0);
+
+    const std::vector<size_t> expected{1, 5, 7, 8, 4, 2, 9, 0, 6, 3};
+    for ( const auto k : expected ) {
+        BOOST_CHECK_EQUAL( heap.top(), k );
+        heap.pop();
+    }
+    BOOST_CHECK( heap.empty() );
+}
@@ -0,0 +1,148 @@
+#define BOOST_TEST_MODULE UtilsKernels
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Kernels.hpp>
+#include <AIToolbox/Types.hpp>
+#include <AIToolbox/Utils/Polytope.hpp>
+#include <AIToolbox/Impl/Seeder.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace ai = AIToolbox;
+
+namespace {
+    std::vector<ai::Kernels::ISA> supportedISAs() {
+        std::vector<ai::Kernels::ISA> retval;
+        for ( auto isa : {ai::Kernels::ISA::Generic, ai::Kernels::ISA::AVX2, ai::Kernels::ISA::AVX512} )
+            if ( ai::isKernelsISASupported(isa) )
+                retval.push_back(isa);
+        return retval;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( selection ) {
+    BOOST_CHECK(ai::isKernelsISASupported(ai::Kernels::ISA::Generic));
+
+    // By default we use the widest supported variant.
+    const auto isas = supportedISAs();
+    BOOST_CHECK(ai::getKernels().isa == isas.back());
+
+    for ( auto isa : isas ) {
+        ai::setKernelsISA(isa);
+        BOOST_CHECK(ai::getKernels().isa == isa);
+    }
+    for ( auto isa : {ai::Kernels::ISA::AVX2, ai::Kernels::ISA::AVX512} )
+        if ( !ai::isKernelsISASupported(isa) )
+            BOOST_CHECK_THROW(ai::setKernelsISA(isa), std::invalid_argument);
+
+    ai::setKernelsISA(isas.back());
+}
+
+BOOST_AUTO_TEST_CASE( products ) {
+    ai::Impl::Seeder::setRootSeed(0);
+
+    // Odd sizes exercise the remainder loops.
+    constexpr size_t M = 37, N = 53, A = 3;
+    const ai::Matrix2D a = ai::Matrix2D::Random(M, N);
+    const ai::Vector x = ai::Vector::Random(N);
+    ai::Vector xt = ai::Vector::Random(M);
+    xt[4] = xt[10] = 0.0;
+
+    const ai::Vector yRef = a * x;
+    const ai::Vector ytRef = a.transpose() * xt;
+
+    std::vector<ai::Vector> dots, gemvs, gemvTs;
+    for ( auto isa : supportedISAs() ) {
+        ai::setKernelsISA(isa);
+        const auto & k = ai::getKernels();
+
+        BOOST_CHECK_CLOSE(k.dot(a.data(), x.data(), N), a.row(0).dot(x), 1e-10);
+
+        // Writes in the second column of a row-major matrix.
+        ai::Matrix2D y = ai::Matrix2D::Ones(M, A);
+        k.gemv(M, N, a.data(), x.data(), y.data() + 1, A);
+        for ( size_t i = 0; i < M; ++i ) {
+            BOOST_CHECK_EQUAL(y(i, 0), 1.0);
+            BOOST_CHECK_SMALL(y(i, 1) - 1.0 - yRef[i], 1e-12);
+            BOOST_CHECK_EQUAL(y(i, 2), 1.0);
+        }
+
+        ai::Vector yt = ai::Vector::Constant(N, 5.0);
+        k.gemvT(M, N, a.data(), xt.data(), yt.data());
+        BOOST_CHECK(yt.isApprox(ytRef, 1e-12));
+
+        dots.emplace_back(ai::Vector::Constant(1, k.dot(a.data(), x.data(), N)));
+        gemvs.emplace_back(y.col(1));
+        gemvTs.emplace_back(yt);
+    }
+
+    // All variants return exactly the same results.
+    for ( size_t i = 1; i < dots.size(); ++i ) {
+        BOOST_CHECK(dots[i] == dots[0]);
+        BOOST_CHECK(gemvs[i] == gemvs[0]);
+        BOOST_CHECK(gemvTs[i] == gemvTs[0]);
+    }
+    ai::setKernelsISA(supportedISAs().back());
+}
+
+BOOST_AUTO_TEST_CASE( exponentials ) {
+    constexpr size_t N = 1001;
+    ai::Vector x(N);
+    for ( size_t i = 0; i < N; ++i )
+        x[i] = -700.0 + 1.4 * i;
+
+    std::vector<ai::Vector> results;
+    for ( auto isa : supportedISAs() ) {
+        ai::setKernelsISA(isa);
+        ai::Vector y(N);
+        const double sum = ai::getKernels().expScaled(N, x.data(), 1.0, y.data());
+
+        for ( size_t i = 0; i < N; ++i )
+            BOOST_CHECK_CLOSE(y[i], std::exp(x[i]), 1e-12);
+        BOOST_CHECK_CLOSE(sum, y.sum(), 1e-12);
+
+        ai::Vector scaled(N);
+        ai::getKernels().expScaled(N, x.data(), 0.01, scaled.data());
+        BOOST_CHECK(scaled.isApprox((x * 0.01).array().exp().matrix(), 1e-13));
+
+        results.push_back(y);
+    }
+    for ( size_t i = 1; i < results.size(); ++i )
+        BOOST_CHECK(results[i] == results[0]);
+
+    // Out of range values.
+    ai::Vector extremes(4); extremes << -1000.0, -709.0, 710.0, 1000.0;
+    ai::Vector y(4);
+    const double sum = ai::getKernels().expScaled(4, extremes.data(), 1.0, y.data());
+    BOOST_CHECK_EQUAL(y[0], 0.0);
+    BOOST_CHECK_EQUAL(y[1], 0.0);
+    BOOST_CHECK(std::isinf(y[2]) && std::isinf(y[3]));
+    BOOST_CHECK(std::isinf(sum));
+
+    ai::setKernelsISA(supportedISAs().back());
+}
+
+BOOST_AUTO_TEST_CASE( best_at_point ) {
+    ai::Impl::Seeder::setRootSeed(1);
+    constexpr size_t S = 64;
+
+    std::vector<ai::Hyperplane> planes;
+    for ( size_t i = 0; i < 20; ++i )
+        planes.emplace_back(ai::Vector::Random(S));
+
+    const ai::Point p = ai::Vector::Constant(S, 1.0 / S);
+
+    size_t best = 0;
+    for ( size_t i = 1; i < planes.size(); ++i )
+        if ( p.dot(planes[i]) > p.dot(planes[best]) )
+            best = i;
+
+    double value;
+    const auto it = ai::findBestAtPoint(p, std::begin(planes), std::end(planes), &value);
+    BOOST_CHECK_EQUAL(std::distance(std::begin(planes), it), best);
+    BOOST_CHECK_CLOSE(value, p.dot(planes[best]), 1e-10);
+}
@@ -0,0 +1,63 @@
+#define BOOST_TEST_MODULE UtilsMemoryUsage
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/MemoryUsage.hpp>
+#include <AIToolbox/Utils/Probability.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE( containers ) {
+    using namespace AIToolbox;
+
+    BOOST_CHECK_EQUAL(heapUsage(5), 0);
+    BOOST_CHECK_EQUAL(heapUsage(FixedVector<4>()), 0);
+
+    Matrix2D m(3, 7);
+    BOOST_CHECK_EQUAL(heapUsage(m), 21 * sizeof(double));
+
+    std::vector<int> v;
+    v.reserve(10);
+    BOOST_CHECK_EQUAL(heapUsage(v), 10 * sizeof(int));
+
+    // Nested containers are counted recursively.
+    Matrix3D m3(2, Matrix2D(4, 5));
+    BOOST_CHECK_EQUAL(heapUsage(m3), m3.capacity() * sizeof(Matrix2D) + 2 * 20 * sizeof(double));
+
+    DumbTable3D t(boost::extents[2][3][4]);
+    BOOST_CHECK_EQUAL(heapUsage(t), 24 * sizeof(long));
+
+    // Sparse matrices count their reserved space, not just the non-zeros.
+    SparseMatrix2D sm(10, 10);
+    const auto empty = heapUsage(sm);
+    sm.reserve(50);
+    sm.insert(3, 4) = 1.0;
+    BOOST_CHECK(heapUsage(sm) >= empty + 50 * (sizeof(double) + sizeof(int)));
+    sm.makeCompressed();
+    sm.data().squeeze();
+    BOOST_CHECK_EQUAL(heapUsage(sm), sizeof(double) + sizeof(int) + 11 * sizeof(int));
+
+    std::unordered_map<size_t, std::vector<double>> map;
+    map[1].resize(100);
+    map[2].resize(50);
+    const auto mapUsage = heapUsage(map);
+    BOOST_CHECK(mapUsage >= 150 * sizeof(double) + 2 * sizeof(std::pair<const size_t, std::vector<double>>));
+    BOOST_CHECK(mapUsage >= map.bucket_count() * sizeof(void*));
+}
+
+BOOST_AUTO_TEST_CASE( memberFunctions ) {
+    using namespace AIToolbox;
+
+    static_assert(has_memory_usage_v<VoseAliasTable>);
+    static_assert(!has_memory_usage_v<Matrix2D>);
+
+    const std::vector<Matrix2D> distributions{Matrix2D::Constant(3, 4, 0.25)};
+    VoseAliasTable table(distributions);
+    BOOST_CHECK_EQUAL(table.getMemoryUsage(), 12 * sizeof(double) + 12 * sizeof(unsigned));
+
+    // Classes are measured through their member function.
+    std::vector<VoseAliasTable> tables(2, table);
+    BOOST_CHECK_EQUAL(heapUsage(tables), 2 * sizeof(VoseAliasTable) + 2 * table.getMemoryUsage());
+}
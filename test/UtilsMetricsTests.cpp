@@ -0,0 +1,122 @@
+#define BOOST_TEST_MODULE UtilsMetrics
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// We enable profiling in this file so we can test the header-only macros.
+#define AI_PROFILING_ENABLED 1
+
+#include <AIToolbox/Impl/Profiling.hpp>
+#include <AIToolbox/Utils/Metrics.hpp>
+#include <AIToolbox/Utils/Prune.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace ai = AIToolbox;
+
+template <typename List>
+const auto & find(const List & list, const std::string & name) {
+    for (const auto & m : list)
+        if (m.name == name) return m;
+    BOOST_FAIL("Metric " + name + " not found");
+    return list.front();
+}
+
+BOOST_AUTO_TEST_CASE( histogram_buckets ) {
+    ai::MetricHistogram h;
+    for (const std::uint64_t v : {0, 1, 2, 3, 4, 7, 8, 1000})
+        h.record(v);
+
+    BOOST_CHECK_EQUAL(h.getCount(), 8);
+    BOOST_CHECK_EQUAL(h.getSum(), 1025);
+    BOOST_CHECK_EQUAL(h.getMax(), 1000);
+
+    BOOST_CHECK_EQUAL(h.getBucket(0), 1);  // 0
+    BOOST_CHECK_EQUAL(h.getBucket(1), 1);  // 1
+    BOOST_CHECK_EQUAL(h.getBucket(2), 2);  // 2, 3
+    BOOST_CHECK_EQUAL(h.getBucket(3), 2);  // 4, 7
+    BOOST_CHECK_EQUAL(h.getBucket(4), 1);  // 8
+    BOOST_CHECK_EQUAL(h.getBucket(10), 1); // 1000
+
+    h.record(~std::uint64_t(0));
+    BOOST_CHECK_EQUAL(h.getBucket(ai::MetricHistogram::Buckets - 1), 1);
+
+    h.reset();
+    BOOST_CHECK_EQUAL(h.getCount(), 0);
+    BOOST_CHECK_EQUAL(h.getBucket(2), 0);
+}
+
+BOOST_AUTO_TEST_CASE( macros_and_snapshot ) {
+    auto & registry = ai::MetricsRegistry::instance();
+    registry.reset();
+
+    constexpr unsigned Threads = 4, Calls = 1000;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < Threads; ++t)
+        threads.emplace_back([]{
+            for (unsigned i = 0; i < Calls; ++i) {
+                AI_METRIC_TIME("test::timer");
+                AI_METRIC_COUNT("test::counter", 2);
+                AI_METRIC_RECORD("test::histogram", i);
+            }
+        });
+    for (auto & t : threads) t.join();
+
+    AI_METRIC_ADD_TIME("test::added", std::chrono::milliseconds(5));
+
+    // The macros and the registry must refer to the same metrics.
+    BOOST_CHECK_EQUAL(registry.counter("test::counter").get(), 2 * Threads * Calls);
+
+    const auto snapshot = registry.snapshot();
+    BOOST_CHECK_EQUAL(find(snapshot.counters, "test::counter").value, 2 * Threads * Calls);
+    BOOST_CHECK_EQUAL(find(snapshot.timers, "test::timer").calls, Threads * Calls);
+    BOOST_CHECK_EQUAL(find(snapshot.timers, "test::added").total.count(), 5000000);
+
+    const auto & h = find(snapshot.histograms, "test::histogram");
+    BOOST_CHECK_EQUAL(h.count, Threads * Calls);
+    BOOST_CHECK_EQUAL(h.max, Calls - 1);
+    // 999 is in the bucket [512, 1024), and trailing buckets are dropped.
+    BOOST_CHECK_EQUAL(h.buckets.size(), 11);
+
+    // Resetting keeps the metrics, so cached references stay valid.
+    registry.reset();
+    BOOST_CHECK_EQUAL(registry.counter("test::counter").get(), 0);
+    AI_METRIC_COUNT("test::counter", 1);
+    BOOST_CHECK_EQUAL(registry.counter("test::counter").get(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( json_export ) {
+    ai::MetricsSnapshot snapshot;
+    snapshot.counters.push_back({"a\"b", 3});
+    snapshot.timers.push_back({"t", 2, std::chrono::nanoseconds(10)});
+    snapshot.histograms.push_back({"h", 2, 3, 2, {0, 1, 1}});
+
+    BOOST_CHECK_EQUAL(snapshot.toJSON(),
+        "{\"counters\":{\"a\\\"b\":3},"
+        "\"timers\":{\"t\":{\"calls\":2,\"total_ns\":10}},"
+        "\"histograms\":{\"h\":{\"count\":2,\"sum\":3,\"max\":2,\"buckets\":[0,1,1]}}}");
+
+    BOOST_CHECK_EQUAL(ai::MetricsSnapshot().toJSON(), "{\"counters\":{},\"timers\":{},\"histograms\":{}}");
+}
+
+BOOST_AUTO_TEST_CASE( pruner_metrics ) {
+    using namespace AIToolbox;
+
+    auto & registry = MetricsRegistry::instance();
+    registry.reset();
+
+    std::vector<Vector> data {
+        (Vector(2) <<  1.0, 0.0).finished(),
+        (Vector(2) <<  0.0, 1.0).finished(),
+        (Vector(2) <<  0.6, 0.6).finished(),
+        (Vector(2) <<  0.4, 0.4).finished(),
+    };
+
+    Pruner prune(2);
+    data.erase(prune(std::begin(data), std::end(data)), std::end(data));
+    BOOST_CHECK_EQUAL(data.size(), 3);
+
+    BOOST_CHECK_EQUAL(registry.timer("Pruner::prune").getCalls(), 1);
+    BOOST_CHECK_EQUAL(registry.histogram("Pruner::inputSize").getSum(), 4);
+}
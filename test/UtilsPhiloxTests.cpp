@@ -0,0 +1,104 @@
+#define BOOST_TEST_MODULE UtilsPhilox
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/Philox.hpp>
+
+#include <random>
+#include <vector>
+
+using AIToolbox::Philox4x32;
+
+BOOST_AUTO_TEST_CASE( knownAnswers ) {
+    // Test vectors from the Random123 reference implementation.
+    using Block = std::array<std::uint32_t, 4>;
+
+    auto out = Philox4x32::block({{0, 0, 0, 0}}, {{0, 0}});
+    BOOST_CHECK(out == (Block{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}));
+
+    out = Philox4x32::block({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}, {{0xffffffff, 0xffffffff}});
+    BOOST_CHECK(out == (Block{{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}));
+
+    out = Philox4x32::block({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}, {{0xa4093822, 0x299f31d0}});
+    BOOST_CHECK(out == (Block{{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}));
+}
+
+BOOST_AUTO_TEST_CASE( sequence ) {
+    Philox4x32 rnd(0);
+
+    // The engine returns the blocks of consecutive counters in order.
+    const auto b0 = Philox4x32::block({{0, 0, 0, 0}}, {{0, 0}});
+    const auto b1 = Philox4x32::block({{1, 0, 0, 0}}, {{0, 0}});
+    for ( auto v : b0 ) BOOST_CHECK_EQUAL(rnd(), v);
+    for ( auto v : b1 ) BOOST_CHECK_EQUAL(rnd(), v);
+
+    // Reseeding restarts the sequence.
+    rnd.seed(0);
+    BOOST_CHECK_EQUAL(rnd(), b0[0]);
+    BOOST_CHECK(rnd != Philox4x32(0));
+    rnd.seed(0);
+    BOOST_CHECK(rnd == Philox4x32(0));
+}
+
+BOOST_AUTO_TEST_CASE( discard ) {
+    Philox4x32 a(42), b(42);
+
+    for ( unsigned skip : {0u, 1u, 3u, 4u, 5u, 1000u} ) {
+        for ( unsigned i = 0; i < skip; ++i ) a();
+        b.discard(skip);
+        BOOST_CHECK(a == b);
+        BOOST_CHECK_EQUAL(a(), b());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( streams ) {
+    Philox4x32 base(7);
+    base.discard(13);
+
+    // Forks start from the beginning of their stream, regardless of the
+    // state of the original engine.
+    auto f1 = base.fork(1);
+    auto f1b = Philox4x32(7, 1);
+    BOOST_CHECK(f1 == f1b);
+    BOOST_CHECK_EQUAL(f1.getStream(), 1);
+
+    auto f2 = base.fork(2);
+    unsigned equal = 0;
+    for ( unsigned i = 0; i < 1000; ++i ) {
+        const auto v = f1();
+        BOOST_CHECK_EQUAL(v, f1b());
+        equal += v == f2();
+    }
+    BOOST_CHECK(equal < 5);
+
+    // Streams are created the same way for other engines.
+    auto m1 = AIToolbox::makeEngineStream<std::mt19937>(7, 1);
+    auto m1b = AIToolbox::makeEngineStream<std::mt19937>(7, 1);
+    auto m2 = AIToolbox::makeEngineStream<std::mt19937>(7, 2);
+    BOOST_CHECK(m1 == m1b);
+    BOOST_CHECK(m1 != m2);
+
+    BOOST_CHECK(AIToolbox::makeEngineStream<Philox4x32>(7, 1) == f1.fork(1));
+    static_assert(AIToolbox::is_counter_based_engine_v<Philox4x32>);
+    static_assert(!AIToolbox::is_counter_based_engine_v<std::mt19937>);
+}
+
+BOOST_AUTO_TEST_CASE( distributions ) {
+    Philox4x32 rnd(3);
+
+    std::uniform_int_distribution<unsigned> dist(0, 9);
+    std::vector<unsigned> counts(10, 0);
+    const unsigned N = 100000;
+    for ( unsigned i = 0; i < N; ++i )
+        ++counts[dist(rnd)];
+
+    for ( auto c : counts )
+        BOOST_CHECK(c > N / 10 * 0.95 && c < N / 10 * 1.05);
+
+    std::uniform_real_distribution<double> real(0.0, 1.0);
+    double sum = 0.0;
+    for ( unsigned i = 0; i < N; ++i )
+        sum += real(rnd);
+    BOOST_CHECK_CLOSE(sum / N, 0.5, 1.0);
+}
@@ -6,6 +6,9 @@
 #include <AIToolbox/Types.hpp>
 #include <AIToolbox/Utils/Core.hpp>
 #include <AIToolbox/Utils/Polytope.hpp>
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <random>
 
 BOOST_AUTO_TEST_CASE( extractBestUsefulPointsTest ) {
     using namespace AIToolbox;
@@ -37,6 +40,99 @@ BOOST_AUTO_TEST_CASE( extractBestUsefulPointsTest ) {
     BOOST_CHECK(checkEqualSmall((*bound)[0], 0.969799) || checkEqualSmall((*bound)[0], 0.0302013));
 }
 
+BOOST_AUTO_TEST_CASE( extractBestAtPointsTest ) {
+    using namespace AIToolbox;
+
+    Matrix2D points(5, 2);
+    points << 0.5 , 0.5,
+              0.85, 0.15,
+              0.15, 0.85,
+              0.6 , 0.4,
+              0.99, 0.01;
+
+    const std::vector<Hyperplane> vl = {
+        (Hyperplane(2) << 3, 3).finished(),
+        (Hyperplane(2) << 4, 1).finished(),
+        (Hyperplane(2) << 1, 4).finished(),
+        (Hyperplane(2) << 5, -5).finished(),
+        (Hyperplane(2) << -5, 5).finished(),
+        (Hyperplane(2) << 0, 0).finished(),
+    };
+
+    const auto comparer = [](const auto & lhs, const auto & rhs) {
+        return veccmp(lhs, rhs) < 0;
+    };
+
+    // We check against extracting each point separately, both with and
+    // without an existing bound.
+    for ( size_t b = 0; b < 2; ++b ) {
+        auto serial = vl, batch = vl;
+
+        auto serialBound = std::begin(serial) + b;
+        for ( auto p = 0; p < points.rows(); ++p )
+            serialBound = extractBestAtPoint(points.row(p).transpose(), std::begin(serial), serialBound, std::end(serial));
+
+        auto batchBound = extractBestAtPoints(points, std::begin(batch), std::begin(batch) + b, std::end(batch));
+
+        BOOST_CHECK_EQUAL(std::distance(std::begin(batch), batchBound), std::distance(std::begin(serial), serialBound));
+
+        std::sort(std::begin(serial), serialBound, comparer);
+        std::sort(std::begin(batch), batchBound, comparer);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(serial), serialBound,
+                                      std::begin(batch), batchBound);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( batchedBestAtPoints ) {
+    using namespace AIToolbox;
+
+    constexpr size_t S = 4;
+    RandomEngine rand(5);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    std::vector<Hyperplane> vl;
+    for (size_t i = 0; i < 40; ++i) {
+        Hyperplane h(S);
+        for (size_t s = 0; s < S; ++s)
+            h[s] = dist(rand);
+        vl.emplace_back(std::move(h));
+    }
+    std::vector<Point> points;
+    for (size_t i = 0; i < 1000; ++i) {
+        Point p(S);
+        for (size_t s = 0; s < S; ++s)
+            p[s] = dist(rand);
+        points.emplace_back(p / p.sum());
+    }
+
+    std::vector<size_t> serialIds;
+    for (const auto & p : points)
+        serialIds.push_back(std::distance(std::begin(vl), findBestAtPoint(p, std::begin(vl), std::end(vl))));
+
+    ThreadPool pool(3);
+    for (auto poolPtr : {static_cast<ThreadPool*>(nullptr), &pool}) {
+        // Small blocks, so that the points are streamed over many of them.
+        std::vector<double> values;
+        const auto ids = findBestAtPoints(std::begin(points), std::end(points), std::begin(vl), std::end(vl), &values, poolPtr, 64);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(ids), std::end(ids), std::begin(serialIds), std::end(serialIds));
+        for (size_t p = 0; p < points.size(); ++p)
+            BOOST_CHECK(checkEqualSmall(values[p], points[p].dot(vl[ids[p]])));
+
+        // Batched extraction keeps the same useful points as the serial one.
+        auto serial = points, batch = points;
+        const auto serialBound = extractBestUsefulPoints(std::begin(serial), std::end(serial), std::begin(vl), std::end(vl));
+        const auto batchBound = extractBestUsefulPoints(std::begin(batch), std::end(batch), std::begin(vl), std::end(vl), poolPtr, 64);
+
+        const auto comparer = [](const auto & lhs, const auto & rhs) {
+            return veccmp(lhs, rhs) < 0;
+        };
+        std::sort(std::begin(serial), serialBound, comparer);
+        std::sort(std::begin(batch), batchBound, comparer);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(serial), serialBound, std::begin(batch), batchBound);
+    }
+}
+
 BOOST_AUTO_TEST_CASE( naive_vertex_enumeration ) {
     using namespace AIToolbox;
 
@@ -84,6 +180,109 @@ BOOST_AUTO_TEST_CASE( naive_vertex_enumeration ) {
     }
 }
 
+BOOST_AUTO_TEST_CASE( parallel_vertex_enumeration ) {
+    using namespace AIToolbox;
+
+    constexpr size_t S = 3;
+    RandomEngine rand(3);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    // Enough planes that the combinations span multiple batches.
+    std::vector<Vector> alphas;
+    for (size_t i = 0; i < 1200; ++i) {
+        Vector v(S);
+        for (size_t s = 0; s < S; ++s)
+            v[s] = dist(rand);
+        alphas.emplace_back(std::move(v));
+    }
+
+    const auto serial = findVerticesNaive(std::begin(alphas), std::begin(alphas) + 2, std::begin(alphas) + 2, std::end(alphas));
+    BOOST_REQUIRE(serial.size() > 0);
+
+    for (const size_t threads : {2, 3}) {
+        ThreadPool pool(threads);
+        const auto parallel = findVerticesNaive(std::begin(alphas), std::begin(alphas) + 2, std::begin(alphas) + 2, std::end(alphas), &pool);
+
+        BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+        for (size_t i = 0; i < serial.size(); ++i) {
+            BOOST_CHECK(parallel[i].first == serial[i].first);
+            BOOST_CHECK_EQUAL(parallel[i].second, serial[i].second);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( incremental_vertex_enumeration ) {
+    using namespace AIToolbox;
+
+    RandomEngine rand(11);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    for (const size_t S : {2, 3, 4}) {
+        std::vector<Hyperplane> alphas;
+        VertexEnumerator enumerator(S);
+        for (size_t i = 0; i < 12; ++i) {
+            Hyperplane h(S);
+            for (size_t s = 0; s < S; ++s)
+                h[s] = dist(rand);
+            alphas.push_back(h);
+
+            const auto added = enumerator.addHyperplane(h);
+            BOOST_CHECK_EQUAL(enumerator.getHyperplanesNum(), alphas.size());
+
+            // The new vertices are all on the new hyperplane.
+            for (const auto & [b, v] : added)
+                BOOST_CHECK(checkEqualSmall(v, h.dot(b)));
+        }
+
+        // We find all vertices by brute force, solving the system for
+        // each subset of S constraints (simplex boundaries and
+        // hyperplanes), plus the simplex itself.
+        const size_t C = S + alphas.size();
+        std::vector<Point> naive;
+        SubsetEnumerator subsets(S, 0ul, C);
+        for (; subsets.isValid(); subsets.advance()) {
+            Matrix2D m(S + 1, S + 1);
+            Vector rhs(S + 1); rhs.setZero();
+            m.row(0).head(S).fill(1.0);
+            m(0, S) = 0.0;
+            rhs[0] = 1.0;
+            for (size_t i = 0; i < S; ++i) {
+                const auto c = (*subsets)[i];
+                m.row(i + 1).setZero();
+                if (c < S) m(i + 1, c) = 1.0;
+                else {
+                    m.row(i + 1).head(S) = alphas[c - S].transpose();
+                    m(i + 1, S) = -1.0;
+                }
+            }
+            const auto lu = m.fullPivLu();
+            if (lu.rank() < static_cast<Eigen::Index>(S + 1)) continue;
+            const Vector x = lu.solve(rhs);
+            const Point b = x.head(S);
+            if ((b.array() < -1e-9).any()) continue;
+
+            double best;
+            findBestAtPoint(b, std::begin(alphas), std::end(alphas), &best);
+            if (checkDifferentSmall(x[S], best)) continue;
+            if (std::none_of(std::begin(naive), std::end(naive), [&b](const Point & p) { return (p - b).cwiseAbs().maxCoeff() < 1e-8; }))
+                naive.push_back(b);
+        }
+
+        const auto & vertices = enumerator.getVertices();
+        BOOST_CHECK_EQUAL(vertices.size(), naive.size());
+        for (const auto & [b, v] : vertices) {
+            double best;
+            findBestAtPoint(b, std::begin(alphas), std::end(alphas), &best);
+            BOOST_CHECK(checkEqualSmall(v, best));
+            BOOST_CHECK(std::any_of(std::begin(naive), std::end(naive), [&b = b](const Point & p) { return (p - b).cwiseAbs().maxCoeff() < 1e-8; }));
+        }
+
+        enumerator.reset();
+        BOOST_CHECK_EQUAL(enumerator.getHyperplanesNum(), 0);
+        BOOST_CHECK_EQUAL(enumerator.getVertices().size(), 0);
+    }
+}
+
 BOOST_AUTO_TEST_CASE( optimistic_value_discovery ) {
     using namespace AIToolbox;
 
@@ -102,3 +301,55 @@ BOOST_AUTO_TEST_CASE( optimistic_value_discovery ) {
 
     BOOST_CHECK(checkEqualGeneral(v, solution));
 }
+
+BOOST_AUTO_TEST_CASE( witnessLPReuse ) {
+    using namespace AIToolbox;
+
+    constexpr size_t S = 3;
+    RandomEngine rand(3);
+    std::uniform_real_distribution<double> dist(-5.0, 5.0);
+
+    const auto makeHyperplane = [&]{
+        Hyperplane v(S);
+        for (size_t s = 0; s < S; ++s)
+            v[s] = dist(rand);
+        return v;
+    };
+
+    std::vector<Hyperplane> optimal;
+    for (size_t i = 0; i < 5; ++i)
+        optimal.push_back(makeHyperplane());
+
+    // A WitnessLP reused for many hyperplanes must give the same answers
+    // as a new one for each of them.
+    WitnessLP reused(S);
+    reused.allocate(optimal.size() + 1);
+    for (const auto & v : optimal)
+        reused.addOptimalRow(v);
+
+    for (size_t i = 0; i < 50; ++i) {
+        const auto v = makeHyperplane();
+
+        WitnessLP fresh(S);
+        for (const auto & o : optimal)
+            fresh.addOptimalRow(o);
+
+        const auto w1 = reused.findWitness(v);
+        const auto w2 = fresh.findWitness(v);
+
+        BOOST_CHECK_EQUAL(bool(w1), bool(w2));
+        if (w1 && w2) {
+            // Both must be witnesses, even if they are not the same point.
+            for (const auto & o : optimal) {
+                BOOST_CHECK(w1->dot(v) > w1->dot(o));
+                BOOST_CHECK(w2->dot(v) > w2->dot(o));
+            }
+        }
+    }
+
+    // After a reset the LP is as new.
+    reused.reset();
+    reused.addOptimalRow(optimal[0]);
+    const auto w = reused.findWitness(optimal[0]);
+    BOOST_CHECK(!w);
+}
@@ -18,6 +18,41 @@ BOOST_AUTO_TEST_CASE( probGeneration ) {
     }
 }
 
+BOOST_AUTO_TEST_CASE( batchProbGeneration ) {
+    using namespace AIToolbox;
+
+    RandomEngine rand(Impl::Seeder::getSeed());
+
+    constexpr size_t N = 20000, S = 5;
+    const auto m = makeRandomProbabilities(N, S, rand);
+    BOOST_CHECK_EQUAL(m.rows(), N);
+    BOOST_CHECK_EQUAL(m.cols(), S);
+
+    for (size_t i = 0; i < N; ++i) {
+        BOOST_CHECK((m.row(i).array() >= 0.0).all() && (m.row(i).array() <= 1.0).all());
+        BOOST_CHECK(checkEqualSmall(m.row(i).sum(), 1.0));
+    }
+
+    // Points uniform on the simplex have each entry with mean 1/S and
+    // variance (S-1) / (S^2 (S+1)).
+    const Vector mean = m.colwise().mean().transpose();
+    const Vector variance = (m.rowwise() - mean.transpose()).array().square().colwise().mean().transpose();
+    for (size_t s = 0; s < S; ++s) {
+        BOOST_CHECK_CLOSE(mean[s], 1.0 / S, 3.0);
+        BOOST_CHECK_CLOSE(variance[s], (S - 1.0) / (S * S * (S + 1.0)), 5.0);
+    }
+
+    const auto f = makeRandomProbabilities<float>(100, 1000, rand);
+    for (size_t i = 0; i < 100; ++i) {
+        BOOST_CHECK((f.row(i).array() >= 0.0f).all());
+        BOOST_CHECK_CLOSE(f.row(i).sum(), 1.0f, 1e-3);
+    }
+
+    // A single column is always certain.
+    const auto one = makeRandomProbabilities(10, 1, rand);
+    BOOST_CHECK((one.array() == 1.0).all());
+}
+
 BOOST_AUTO_TEST_CASE( probProjection ) {
     using namespace AIToolbox;
 
@@ -62,3 +97,58 @@ BOOST_AUTO_TEST_CASE( vose_alias_sampling ) {
         BOOST_CHECK(std::abs(counters[i] - exactAmount) < percentageErrorAllowed * exactAmount);
     }
 }
+
+BOOST_AUTO_TEST_CASE( vose_alias_sampling_alias_zero ) {
+    AIToolbox::RandomEngine rand(AIToolbox::Impl::Seeder::getSeed());
+
+    // Here all small elements get the first element as their alias.
+    AIToolbox::ProbabilityVector p(4);
+    p << 0.7, 0.1, 0.1, 0.1;
+
+    AIToolbox::VoseAliasSampler vose(p);
+
+    constexpr size_t trials = 100'000;
+    std::vector<size_t> counters(p.size());
+    for (size_t i = 0; i < trials; ++i)
+        ++counters[vose.sampleProbability(rand)];
+
+    constexpr double percentageErrorAllowed = 0.05;
+
+    for (size_t i = 0; i < counters.size(); ++i) {
+        const auto exactAmount = p[i] * trials;
+        BOOST_CHECK(std::abs(counters[i] - exactAmount) < percentageErrorAllowed * exactAmount);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( vose_alias_table ) {
+    AIToolbox::RandomEngine rand(AIToolbox::Impl::Seeder::getSeed());
+
+    AIToolbox::Matrix3D m(2, AIToolbox::Matrix2D(2, 5));
+    m[0] << 0.2, 0.2, 0.2, 0.2, 0.2,
+            0.0, 0.5, 0.0, 0.0, 0.5;
+    m[1] << 1.0, 0.0, 0.0, 0.0, 0.0,
+            0.1, 0.2, 0.3, 0.3, 0.1;
+
+    AIToolbox::VoseAliasTable empty;
+    BOOST_CHECK(empty.empty());
+
+    AIToolbox::VoseAliasTable table(m);
+    BOOST_CHECK(!table.empty());
+
+    constexpr size_t trials = 100'000;
+    constexpr double percentageErrorAllowed = 0.05;
+
+    for (size_t r = 0; r < 4; ++r) {
+        const auto p = m[r / 2].row(r % 2);
+
+        std::vector<size_t> counters(p.size());
+        for (size_t i = 0; i < trials; ++i)
+            ++counters[table.sampleProbability(r, rand)];
+
+        for (size_t i = 0; i < counters.size(); ++i) {
+            const auto exactAmount = p[i] * trials;
+            if (p[i] == 0.0) BOOST_CHECK_EQUAL(counters[i], 0);
+            else BOOST_CHECK(std::abs(counters[i] - exactAmount) < percentageErrorAllowed * exactAmount);
+        }
+    }
+}
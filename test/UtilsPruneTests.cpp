@@ -83,3 +83,129 @@ BOOST_AUTO_TEST_CASE( dominationPrune ) {
                                       std::begin(d), test);
     }
 }
+
+BOOST_AUTO_TEST_CASE( duplicatesPrune ) {
+    using namespace AIToolbox;
+
+    const std::vector<Vector> data {
+        (Vector(3) << 1.0, 2.0, 3.0).finished(),
+        (Vector(3) << 3.0, 2.0, 1.0).finished(),
+        (Vector(3) << 1.0, 2.0, 3.0).finished(),
+        (Vector(3) << 1.0, 2.0, 3.05).finished(),
+        (Vector(3) << 3.0, 2.0, 1.0).finished(),
+        (Vector(3) << 0.0, 0.0, 0.0).finished(),
+    };
+
+    // Exact copies only, keeping the first of each in order.
+    auto exact = data;
+    auto end = extractDuplicates(3, std::begin(exact), std::end(exact));
+    BOOST_REQUIRE_EQUAL(std::distance(std::begin(exact), end), 4);
+    BOOST_CHECK_EQUAL(exact[0], data[0]);
+    BOOST_CHECK_EQUAL(exact[1], data[1]);
+    BOOST_CHECK_EQUAL(exact[2], data[3]);
+    BOOST_CHECK_EQUAL(exact[3], data[5]);
+
+    // With a grid of 0.5, 3.0 and 3.05 fall in the same cell.
+    auto near = data;
+    end = extractDuplicates(3, std::begin(near), std::end(near), 0.5);
+    BOOST_REQUIRE_EQUAL(std::distance(std::begin(near), end), 3);
+    BOOST_CHECK_EQUAL(near[0], data[0]);
+    BOOST_CHECK_EQUAL(near[1], data[1]);
+    BOOST_CHECK_EQUAL(near[2], data[5]);
+
+    BOOST_CHECK_THROW(extractDuplicates(3, std::begin(near), std::end(near), -1.0), std::invalid_argument);
+
+    Pruner prune(3);
+    BOOST_CHECK_EQUAL(prune.getDuplicateTolerance(), 0.0);
+    prune.setDuplicateTolerance(0.5);
+    BOOST_CHECK_EQUAL(prune.getDuplicateTolerance(), 0.5);
+    BOOST_CHECK_THROW(prune.setDuplicateTolerance(-1.0), std::invalid_argument);
+
+    // Copies of a single hyperplane are pruned without any LP.
+    std::vector<Vector> copies(50, data[0]);
+    BOOST_CHECK_EQUAL(std::distance(std::begin(copies), prune(std::begin(copies), std::end(copies))), 1);
+}
+
+BOOST_AUTO_TEST_CASE( parallelWitnessPrune ) {
+    using namespace AIToolbox;
+
+    constexpr size_t S = 3;
+    RandomEngine rand(42);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::uniform_real_distribution<double> radius(0.9, 1.0);
+
+    // Points near the positive part of the unit sphere are rarely
+    // pointwise dominated, so that many need an LP to be checked.
+    std::vector<Vector> data;
+    for (size_t i = 0; i < 500; ++i) {
+        Vector v(S);
+        for (size_t s = 0; s < S; ++s)
+            v[s] = dist(rand);
+        data.push_back(v.normalized() * radius(rand));
+    }
+
+    auto comparer = [](const auto & lhs, const auto & rhs) {
+        return veccmp(lhs, rhs) < 0;
+    };
+
+    auto serial = data;
+    Pruner prune(S);
+    BOOST_CHECK_EQUAL(prune.getThreadPool(), nullptr);
+    serial.erase(prune(std::begin(serial), std::end(serial)), std::end(serial));
+    std::sort(std::begin(serial), std::end(serial), comparer);
+
+    for (size_t threads : {2, 4}) {
+        ThreadPool pool(threads);
+        prune.setThreadPool(&pool);
+        BOOST_CHECK_EQUAL(prune.getThreadPool(), &pool);
+
+        // Prune twice to check that the per-thread LPs are correctly reset.
+        for (size_t run = 0; run < 2; ++run) {
+            auto parallel = data;
+            parallel.erase(prune(std::begin(parallel), std::end(parallel)), std::end(parallel));
+            std::sort(std::begin(parallel), std::end(parallel), comparer);
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(serial), std::end(serial),
+                                          std::begin(parallel), std::end(parallel));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( sampledBeliefsPrune ) {
+    using namespace AIToolbox;
+
+    constexpr size_t S = 3;
+    RandomEngine rand(7);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::uniform_real_distribution<double> radius(0.9, 1.0);
+
+    std::vector<Vector> data;
+    for (size_t i = 0; i < 500; ++i) {
+        Vector v(S);
+        for (size_t s = 0; s < S; ++s)
+            v[s] = dist(rand);
+        data.push_back(v.normalized() * radius(rand));
+    }
+
+    auto comparer = [](const auto & lhs, const auto & rhs) {
+        return veccmp(lhs, rhs) < 0;
+    };
+
+    auto plain = data;
+    Pruner prune(S);
+    BOOST_CHECK_EQUAL(prune.getBeliefSamples(), 0);
+    plain.erase(prune(std::begin(plain), std::end(plain)), std::end(plain));
+    std::sort(std::begin(plain), std::end(plain), comparer);
+
+    for (size_t samples : {10, 1000}) {
+        prune.setBeliefSamples(samples);
+        BOOST_CHECK_EQUAL(prune.getBeliefSamples(), samples);
+
+        auto sampled = data;
+        sampled.erase(prune(std::begin(sampled), std::end(sampled)), std::end(sampled));
+        std::sort(std::begin(sampled), std::end(sampled), comparer);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(plain), std::end(plain),
+                                      std::begin(sampled), std::end(sampled));
+    }
+}
@@ -0,0 +1,65 @@
+#define BOOST_TEST_MODULE UtilsRolloutCache
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/RolloutCache.hpp>
+
+BOOST_AUTO_TEST_CASE( disabled ) {
+    AIToolbox::RolloutCache cache;
+
+    BOOST_CHECK(!cache.isEnabled());
+    cache.update(1, 5.0);
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    BOOST_CHECK(!cache.lookup(1));
+}
+
+BOOST_AUTO_TEST_CASE( minimum_weight_and_decay ) {
+    AIToolbox::RolloutCache cache(10, 0.5, 1.5);
+
+    // A single return is not enough.
+    cache.update(3, 4.0);
+    BOOST_CHECK(!cache.lookup(3));
+
+    // Weight is now 0.5 * 1 + 1 = 1.5, and the value the weighted mean.
+    cache.update(3, 7.0);
+    const auto v = cache.lookup(3);
+    BOOST_REQUIRE(v);
+    BOOST_CHECK_CLOSE(*v, 4.0 + 3.0 / 1.5, 0.0001);
+    BOOST_CHECK_EQUAL(cache.getHits(), 1);
+
+    // The hit decayed the weight to 0.75, so the entry needs new returns.
+    BOOST_CHECK(!cache.lookup(3));
+    cache.update(3, 6.0);
+    BOOST_CHECK(!cache.lookup(3));
+    cache.update(3, 6.0);
+    BOOST_CHECK(cache.lookup(3));
+
+    BOOST_CHECK(!cache.lookup(4));
+
+    BOOST_CHECK_THROW(cache.setDecay(1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(AIToolbox::RolloutCache(10, 0.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( lru_eviction ) {
+    AIToolbox::RolloutCache cache(2, 0.5, 0.0);
+
+    cache.update(1, 1.0);
+    cache.update(2, 2.0);
+    // Touching 1 makes 2 the least recently used.
+    BOOST_CHECK(cache.lookup(1));
+    cache.update(3, 3.0);
+
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.lookup(1));
+    BOOST_CHECK(!cache.lookup(2));
+    BOOST_CHECK(cache.lookup(3));
+
+    cache.setMaxSize(1);
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    BOOST_CHECK(cache.lookup(3));
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    BOOST_CHECK_EQUAL(cache.getHits(), 0);
+}
@@ -0,0 +1,234 @@
+#define BOOST_TEST_MODULE UtilsSearchTree
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/SearchTree.hpp>
+
+#include <map>
+#include <random>
+#include <vector>
+
+struct TestData {
+    void clear() { values.clear(); }
+    std::vector<int> values;
+};
+
+using Tree = AIToolbox::SearchTree<TestData>;
+
+BOOST_AUTO_TEST_CASE( construction ) {
+    Tree tree(3);
+
+    BOOST_CHECK_EQUAL(tree.getA(), 3);
+    BOOST_CHECK_EQUAL(tree.size(), 1);
+
+    const auto root = tree.getRoot();
+    BOOST_CHECK(!tree.isExpanded(root));
+    BOOST_CHECK_EQUAL(tree.getNode(root).N, 0);
+    BOOST_CHECK_EQUAL(tree.getChild(root, 0, 5), Tree::NoNode);
+
+    tree.expand(root);
+    BOOST_CHECK(tree.isExpanded(root));
+    for ( size_t a = 0; a < 3; ++a ) {
+        BOOST_CHECK_EQUAL(tree.getAction(root, a).N, 0);
+        BOOST_CHECK_EQUAL(tree.getAction(root, a).V, 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( childTables ) {
+    constexpr size_t A = 2;
+    Tree tree(A);
+    const auto root = tree.getRoot();
+    tree.expand(root);
+
+    // Reference: children of each action by key.
+    std::map<size_t, Tree::NodeId> reference[A];
+
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<size_t> keyDist(0, 1000);
+
+    // Enough keys to make the tables grow several times.
+    for ( size_t i = 0; i < 500; ++i ) {
+        const size_t a = i % A;
+        const size_t key = keyDist(rand);
+
+        const auto [child, added] = tree.addChild(root, a, key);
+        const auto it = reference[a].find(key);
+        BOOST_CHECK_EQUAL(added, it == reference[a].end());
+        if ( added ) {
+            reference[a][key] = child;
+            tree.getNode(child).values.push_back(key);
+        } else {
+            BOOST_CHECK_EQUAL(child, it->second);
+        }
+    }
+
+    for ( size_t a = 0; a < A; ++a ) {
+        BOOST_CHECK_EQUAL(tree.getChildCount(root, a), reference[a].size());
+        for ( const auto & [key, child] : reference[a] ) {
+            BOOST_CHECK_EQUAL(tree.getChild(root, a, key), child);
+            BOOST_CHECK_EQUAL(tree.getNode(child).values.at(0), key);
+        }
+        size_t count = 0;
+        tree.forEachChild(root, a, [&](size_t key, Tree::NodeId child) {
+            BOOST_CHECK_EQUAL(reference[a].at(key), child);
+            ++count;
+        });
+        BOOST_CHECK_EQUAL(count, reference[a].size());
+    }
+    BOOST_CHECK_EQUAL(tree.size(), 1 + reference[0].size() + reference[1].size());
+}
+
+BOOST_AUTO_TEST_CASE( resetAndReroot ) {
+    Tree tree(2);
+    auto root = tree.getRoot();
+    tree.expand(root);
+
+    // Build root -(0, 7)-> n1 -(1, 3)-> n2, and root -(1, 4)-> n3.
+    const auto n1 = tree.addChild(root, 0, 7).first;
+    tree.expand(n1);
+    tree.getNode(n1).N = 10;
+    tree.getNode(n1).values = {1, 2, 3};
+    tree.getAction(n1, 1).V = 5.0;
+    tree.getAction(n1, 1).N = 4;
+
+    const auto n2 = tree.addChild(n1, 1, 3).first;
+    tree.getNode(n2).values = {4};
+
+    tree.addChild(root, 1, 4);
+    BOOST_CHECK_EQUAL(tree.size(), 4);
+
+    tree.reroot(n1);
+    root = tree.getRoot();
+    // The tree has grown since the last reset, so this compacts.
+    BOOST_CHECK_EQUAL(root, 0);
+    BOOST_CHECK_EQUAL(tree.size(), 2);
+
+    BOOST_CHECK_EQUAL(tree.getNode(root).N, 10);
+    BOOST_CHECK(tree.getNode(root).values == std::vector<int>({1, 2, 3}));
+    BOOST_CHECK_EQUAL(tree.getAction(root, 1).V, 5.0);
+    BOOST_CHECK_EQUAL(tree.getAction(root, 1).N, 4);
+    BOOST_CHECK_EQUAL(tree.getChild(root, 0, 7), Tree::NoNode);
+
+    const auto child = tree.getChild(root, 1, 3);
+    BOOST_REQUIRE(child != Tree::NoNode);
+    BOOST_CHECK(!tree.isExpanded(child));
+    BOOST_CHECK(tree.getNode(child).values == std::vector<int>({4}));
+
+    // Resetting leaves a clean, unexpanded, root.
+    tree.reset();
+    root = tree.getRoot();
+    BOOST_CHECK_EQUAL(tree.size(), 1);
+    BOOST_CHECK(!tree.isExpanded(root));
+    BOOST_CHECK_EQUAL(tree.getNode(root).N, 0);
+    BOOST_CHECK(tree.getNode(root).values.empty());
+
+    // Reused nodes are cleared too.
+    tree.expand(root);
+    const auto reused = tree.addChild(root, 0, 1).first;
+    BOOST_CHECK(tree.getNode(reused).values.empty());
+    BOOST_CHECK(!tree.isExpanded(reused));
+    BOOST_CHECK_EQUAL(tree.getAction(root, 0).N, 0);
+}
+
+BOOST_AUTO_TEST_CASE( lazyCompaction ) {
+    Tree tree(1);
+    const auto root = tree.getRoot();
+    tree.expand(root);
+
+    // A chain root -> n1 -> n2, and two siblings of n1.
+    const auto n1 = tree.addChild(root, 0, 1).first;
+    tree.expand(n1);
+    const auto n2 = tree.addChild(n1, 0, 2).first;
+    tree.getNode(n2).N = 3;
+    tree.addChild(root, 0, 3);
+    tree.addChild(root, 0, 4);
+
+    tree.compact();
+    BOOST_CHECK_EQUAL(tree.size(), 5);
+
+    // Rerooting right after a compaction does not copy anything.
+    const auto newRoot = tree.getChild(tree.getRoot(), 0, 1);
+    tree.reroot(newRoot);
+    BOOST_CHECK_EQUAL(tree.getRoot(), newRoot);
+    BOOST_CHECK_EQUAL(tree.size(), 5);
+
+    const auto child = tree.getChild(newRoot, 0, 2);
+    BOOST_REQUIRE(child != Tree::NoNode);
+    BOOST_CHECK_EQUAL(tree.getNode(child).N, 3);
+
+    // An explicit compaction drops the unreachable nodes.
+    tree.compact();
+    BOOST_CHECK_EQUAL(tree.getRoot(), 0);
+    BOOST_CHECK_EQUAL(tree.size(), 2);
+    BOOST_CHECK_EQUAL(tree.getNode(tree.getChild(0, 0, 2)).N, 3);
+}
+
+BOOST_AUTO_TEST_CASE( actionStatistics ) {
+    Tree tree(3);
+    auto root = tree.getRoot();
+    tree.expand(root);
+
+    const std::vector<double> returns = {1.0, 4.0, -2.0, 3.0};
+    for ( const auto r : returns )
+        tree.update(root, 1, r);
+
+    // Statistics of the actions of a node are contiguous.
+    BOOST_CHECK_EQUAL(tree.getCounts(root)[1], 4);
+    BOOST_CHECK_EQUAL(tree.getCounts(root)[0], 0);
+    BOOST_CHECK_CLOSE(tree.getValues(root)[1], 1.5, 1e-10);
+    BOOST_CHECK_CLOSE(tree.getSquares(root)[1], 7.5, 1e-10);
+    BOOST_CHECK_EQUAL(tree.getAction(root, 1).N, 4);
+    BOOST_CHECK_EQUAL(&tree.getAction(root, 2).V, tree.getValues(root) + 2);
+
+    // They are kept when compacting.
+    tree.addChild(root, 0, 1);
+    const auto n1 = tree.addChild(root, 2, 5).first;
+    tree.expand(n1);
+    tree.getAction(root, 2).N = 2;
+    tree.update(n1, 0, 2.0);
+    tree.compact();
+    root = tree.getRoot();
+
+    BOOST_CHECK_EQUAL(tree.getCounts(root)[1], 4);
+    BOOST_CHECK_CLOSE(tree.getValues(root)[1], 1.5, 1e-10);
+    BOOST_CHECK_CLOSE(tree.getSquares(root)[1], 7.5, 1e-10);
+    BOOST_CHECK_EQUAL(tree.getCounts(root)[2], 2);
+
+    const auto child = tree.getChild(root, 2, 5);
+    BOOST_REQUIRE(child != Tree::NoNode);
+    BOOST_CHECK_EQUAL(tree.getCounts(child)[0], 1);
+    BOOST_CHECK_EQUAL(tree.getValues(child)[0], 2.0);
+    BOOST_CHECK_EQUAL(tree.getSquares(child)[0], 4.0);
+}
+
+BOOST_AUTO_TEST_CASE( sharedChildren ) {
+    Tree tree(2);
+    const auto root = tree.getRoot();
+    tree.expand(root);
+
+    // Both actions of the root lead to the same node, which loops back
+    // to the root.
+    const auto n1 = tree.addChild(root, 0, 1).first;
+    tree.expand(n1);
+    tree.linkChild(root, 1, 5, n1);
+    tree.linkChild(n1, 0, 0, root);
+    tree.getNode(n1).N = 7;
+    tree.getNode(n1).values.push_back(42);
+    tree.update(n1, 1, 2.0);
+
+    BOOST_CHECK_EQUAL(tree.getChild(root, 1, 5), n1);
+    BOOST_CHECK_EQUAL(tree.getChild(n1, 0, 0), root);
+    BOOST_CHECK_EQUAL(tree.size(), 2);
+
+    // The shared node is copied once, and the cycle is kept.
+    tree.compact();
+    BOOST_CHECK_EQUAL(tree.size(), 2);
+    const auto c1 = tree.getChild(0, 0, 1);
+    BOOST_REQUIRE(c1 != Tree::NoNode);
+    BOOST_CHECK_EQUAL(tree.getChild(0, 1, 5), c1);
+    BOOST_CHECK_EQUAL(tree.getChild(c1, 0, 0), 0);
+    BOOST_CHECK_EQUAL(tree.getNode(c1).N, 7);
+    BOOST_CHECK_EQUAL(tree.getNode(c1).values.size(), 1);
+    BOOST_CHECK_EQUAL(tree.getAction(c1, 1).N, 1);
+}
@@ -0,0 +1,64 @@
+#define BOOST_TEST_MODULE UtilsSumTree
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/SumTree.hpp>
+
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE( totals ) {
+    AIToolbox::SumTree tree(5);
+
+    BOOST_CHECK_EQUAL(tree.size(), 5);
+    BOOST_CHECK_EQUAL(tree.getTotal(), 0.0);
+
+    tree.set(0, 1.0);
+    tree.set(3, 2.5);
+    tree.set(4, 0.5);
+    BOOST_CHECK_EQUAL(tree.getTotal(), 4.0);
+    BOOST_CHECK_EQUAL(tree.get(3), 2.5);
+
+    tree.set(3, 1.0);
+    BOOST_CHECK_EQUAL(tree.getTotal(), 2.5);
+
+    tree.clear();
+    BOOST_CHECK_EQUAL(tree.getTotal(), 0.0);
+    BOOST_CHECK_EQUAL(tree.get(0), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( find ) {
+    AIToolbox::SumTree tree(6);
+    tree.set(1, 1.0);
+    tree.set(2, 2.0);
+    tree.set(5, 1.0);
+
+    BOOST_CHECK_EQUAL(tree.find(0.0), 1);
+    BOOST_CHECK_EQUAL(tree.find(0.99), 1);
+    BOOST_CHECK_EQUAL(tree.find(1.0), 2);
+    BOOST_CHECK_EQUAL(tree.find(2.99), 2);
+    BOOST_CHECK_EQUAL(tree.find(3.5), 5);
+    // Values at or past the total still return a valid, non-zero leaf.
+    BOOST_CHECK_EQUAL(tree.find(4.0), 5);
+    BOOST_CHECK_EQUAL(tree.find(10.0), 5);
+}
+
+BOOST_AUTO_TEST_CASE( sampling ) {
+    constexpr size_t N = 7;
+    AIToolbox::SumTree tree(N);
+    std::vector<double> weights{0.0, 1.0, 3.0, 0.0, 2.0, 0.5, 1.5};
+    for (size_t i = 0; i < N; ++i)
+        tree.set(i, weights[i]);
+
+    std::mt19937 rand(12345);
+    std::uniform_real_distribution<double> dist(0.0, tree.getTotal());
+
+    constexpr unsigned samples = 100000;
+    std::vector<unsigned> counts(N, 0);
+    for (unsigned i = 0; i < samples; ++i)
+        ++counts[tree.find(dist(rand))];
+
+    for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK_SMALL(counts[i] / double(samples) - weights[i] / tree.getTotal(), 0.01);
+}
@@ -0,0 +1,89 @@
+#define BOOST_TEST_MODULE UtilsThreadPool
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/ThreadPool.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE( parallel_for_covers_range ) {
+    for (const size_t threads : {1, 2, 4}) {
+        AIToolbox::ThreadPool pool(threads);
+        BOOST_CHECK_EQUAL(pool.getThreadNumber(), threads);
+
+        for (const size_t N : {0, 1, 3, 17, 100}) {
+            std::vector<int> hits(N, 0);
+            pool.parallelFor(N, [&hits](const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i) ++hits[i];
+            });
+            for (const auto h : hits)
+                BOOST_CHECK_EQUAL(h, 1);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_for_grain ) {
+    for (const size_t threads : {1, 3}) {
+        AIToolbox::ThreadPool pool(threads);
+
+        for (const size_t grain : {0, 1, 4, 7, 200}) {
+            constexpr size_t N = 50;
+            std::vector<int> hits(N, 0);
+            std::mutex mutex;
+            std::vector<std::pair<size_t, size_t>> blocks;
+
+            pool.parallelFor(N, grain, [&](const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i) ++hits[i];
+                std::lock_guard<std::mutex> lock(mutex);
+                blocks.emplace_back(begin, end);
+            });
+
+            for (const auto h : hits)
+                BOOST_CHECK_EQUAL(h, 1);
+
+            // Blocks only depend on N and the grain.
+            const size_t g = std::max(grain, size_t(1));
+            BOOST_CHECK_EQUAL(blocks.size(), (N + g - 1) / g);
+            for (const auto & [begin, end] : blocks) {
+                BOOST_CHECK_EQUAL(begin % g, 0);
+                BOOST_CHECK_EQUAL(end, std::min(N, begin + g));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( start_function ) {
+    constexpr size_t threads = 4;
+
+    std::mutex mutex;
+    std::set<size_t> indeces;
+    std::set<std::thread::id> ids;
+    {
+        AIToolbox::ThreadPool pool(threads, [&](const size_t i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            indeces.insert(i);
+            ids.insert(std::this_thread::get_id());
+        });
+
+        // All workers have started once the constructor returns.
+        std::lock_guard<std::mutex> lock(mutex);
+        BOOST_CHECK_EQUAL(indeces.size(), threads - 1);
+        BOOST_CHECK_EQUAL(*indeces.begin(), 1);
+        BOOST_CHECK_EQUAL(*indeces.rbegin(), threads - 1);
+        BOOST_CHECK_EQUAL(ids.size(), threads - 1);
+        BOOST_CHECK(!ids.count(std::this_thread::get_id()));
+    }
+
+    // The pool still works normally after a start function.
+    AIToolbox::ThreadPool pool(2, [](size_t) {});
+    std::atomic<size_t> sum = 0;
+    pool.parallelFor(10, [&sum](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) sum += i;
+    });
+    BOOST_CHECK_EQUAL(sum.load(), 45);
+}
@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE UtilsUCB
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <AIToolbox/Utils/UCB.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+    constexpr size_t A = 5;
+    constexpr unsigned count = 40;
+
+    const std::vector<double> V = {1.0, -2.0, 0.5, 3.0, 0.0};
+    const std::vector<unsigned> N = {10, 3, 17, 10, 0};
+    const std::vector<double> Q = {2.0, 5.0, 0.5, 9.5, 0.0};
+}
+
+BOOST_AUTO_TEST_CASE( ucb1 ) {
+    AIToolbox::UCB1 bonus;
+    std::vector<double> scores(A);
+    bonus(2.0, count, V.data(), N.data(), Q.data(), A, scores.data());
+
+    for ( size_t a = 0; a < A - 1; ++a )
+        BOOST_CHECK_CLOSE(scores[a], V[a] + 2.0 * std::sqrt(std::log(count + 1.0) / N[a]), 1e-10);
+
+    // Untried actions are always selected first.
+    BOOST_CHECK_EQUAL(scores[A - 1], std::numeric_limits<double>::infinity());
+    BOOST_CHECK_EQUAL(AIToolbox::selectBonusAction(bonus, 2.0, count, V.data(), N.data(), Q.data(), A, scores), A - 1);
+}
+
+BOOST_AUTO_TEST_CASE( puct ) {
+    AIToolbox::PUCT bonus;
+    std::vector<double> scores(A);
+    bonus(2.0, count, V.data(), N.data(), Q.data(), A, scores.data());
+
+    for ( size_t a = 0; a < A; ++a )
+        BOOST_CHECK_CLOSE(scores[a], V[a] + 2.0 * std::sqrt(count) / (1.0 + N[a]), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( ucbTuned ) {
+    AIToolbox::UCBTuned bonus;
+    std::vector<double> scores(A);
+    bonus(2.0, count, V.data(), N.data(), Q.data(), A, scores.data());
+
+    const double l = std::log(count + 1.0);
+    for ( size_t a = 0; a < A - 1; ++a ) {
+        const double var = Q[a] - V[a] * V[a];
+        const double bound = std::min(0.25, var + std::sqrt(2.0 * l / N[a]));
+        BOOST_CHECK_CLOSE(scores[a], V[a] + 2.0 * std::sqrt(l / N[a] * bound), 1e-10);
+    }
+    BOOST_CHECK_EQUAL(scores[A - 1], std::numeric_limits<double>::infinity());
+
+    // Actions with the same value and count, but lower variance, get a
+    // smaller bonus.
+    const std::vector<double> v = {1.0, 1.0};
+    const std::vector<unsigned> n = {1000, 1000};
+    const std::vector<double> q = {1.0, 1.2};
+    bonus(1.0, 2000, v.data(), n.data(), q.data(), 2, scores.data());
+    BOOST_CHECK(scores[0] < scores[1]);
+}
+
+BOOST_AUTO_TEST_CASE( growingCounts ) {
+    // Tables grow as the counts do; results must not depend on the
+    // calls made before.
+    AIToolbox::UCB1 bonus, fresh;
+    std::vector<double> scores, expected;
+
+    for ( unsigned c = 1; c < 5000; c = c * 3 + 1 ) {
+        const std::vector<unsigned> n = {c, (c + 1) / 2, 0};
+        const std::vector<double> v = {0.5, 0.25, 0.0}, q(3, 0.0);
+        const auto a = AIToolbox::selectBonusAction(bonus, 1.0, c, v.data(), n.data(), q.data(), 3, scores);
+        BOOST_CHECK_EQUAL(a, 2);
+
+        fresh = AIToolbox::UCB1();
+        AIToolbox::selectBonusAction(fresh, 1.0, c, v.data(), n.data(), q.data(), 3, expected);
+        for ( size_t i = 0; i < 2; ++i )
+            BOOST_CHECK_EQUAL(scores[i], expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( ties ) {
+    AIToolbox::UCB1 bonus;
+    std::vector<double> scores;
+
+    const std::vector<double> v = {1.0, 2.0, 2.0, 1.0};
+    const std::vector<unsigned> n(4, 3);
+    const std::vector<double> q(4, 0.0);
+
+    BOOST_CHECK_EQUAL(AIToolbox::selectBonusAction(bonus, 1.0, 12, v.data(), n.data(), q.data(), 4, scores), 1);
+}